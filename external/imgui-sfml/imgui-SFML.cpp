@@ -10,6 +10,7 @@
 #include <SFML/Graphics/Texture.hpp>
 #include <SFML/OpenGL.hpp>
 #include <SFML/Window/Clipboard.hpp>
+#include <SFML/Window/Context.hpp>
 #include <SFML/Window/Cursor.hpp>
 #include <SFML/Window/Event.hpp>
 #include <SFML/Window/Touch.hpp>
@@ -17,6 +18,8 @@
 
 #include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
 
 #include <algorithm>
@@ -176,6 +179,9 @@ struct SpriteTextureData
 }
 
 void RenderDrawLists(ImDrawData* draw_data); // rendering callback function prototype
+// Buffer object path of RenderDrawLists; false if GL 2.0 or the shader isn't available
+bool RenderDrawListsBuffered(ImDrawData* draw_data, int fb_width, int fb_height);
+void DestroyBufferRenderer();
 
 // Default mapping is XInput gamepad mapping
 void initDefaultJoystickMapping();
@@ -284,6 +290,7 @@ struct WindowContext
 
 std::vector<std::unique_ptr<WindowContext>> s_windowContexts;
 WindowContext*                              s_currWindowCtx = nullptr;
+ImGui::SFML::Renderer                       s_renderer      = ImGui::SFML::Renderer::Legacy;
 
 } // end of anonymous namespace
 
@@ -585,6 +592,24 @@ void Render()
     RenderDrawLists(ImGui::GetDrawData());
 }
 
+void RenderDrawData(sf::RenderTarget& target, ImDrawData* drawData)
+{
+    target.resetGLStates();
+    target.pushGLStates();
+    RenderDrawLists(drawData);
+    target.popGLStates();
+}
+
+void SetRenderer(Renderer renderer)
+{
+    s_renderer = renderer;
+}
+
+Renderer GetRenderer()
+{
+    return s_renderer;
+}
+
 void Shutdown(const sf::Window& window)
 {
     const bool needReplacement = (s_currWindowCtx->window->getNativeHandle() == window.getNativeHandle());
@@ -619,6 +644,7 @@ void Shutdown(const sf::Window& window)
 
 void Shutdown()
 {
+    DestroyBufferRenderer();
     s_currWindowCtx = nullptr;
     ImGui::SetCurrentContext(nullptr);
 
@@ -963,6 +989,13 @@ void RenderDrawLists(ImDrawData* draw_data)
         return;
     draw_data->ScaleClipRects(io.DisplayFramebufferScale);
 
+    if (s_renderer == ImGui::SFML::Renderer::BufferObjects)
+    {
+        if (RenderDrawListsBuffered(draw_data, fb_width, fb_height))
+            return;
+        s_renderer = ImGui::SFML::Renderer::Legacy;
+    }
+
     // Backup GL state
     // Backup GL state
     GLint last_texture = 0;
@@ -1075,6 +1108,374 @@ void RenderDrawLists(ImDrawData* draw_data)
 #endif
 }
 
+#ifndef GL_VERSION_ES_CL_1_1
+// Buffer object renderer. The GL 1.5/2.0 entry points aren't in every platform's gl.h,
+// so they are fetched through SFML once, together with the few enums used here.
+#ifdef _WIN32
+#define IMGUI_SFML_GLAPI __stdcall
+#else
+#define IMGUI_SFML_GLAPI
+#endif
+
+constexpr GLenum kArrayBuffer               = 0x8892; // GL_ARRAY_BUFFER
+constexpr GLenum kElementArrayBuffer        = 0x8893; // GL_ELEMENT_ARRAY_BUFFER
+constexpr GLenum kArrayBufferBinding        = 0x8894; // GL_ARRAY_BUFFER_BINDING
+constexpr GLenum kElementArrayBufferBinding = 0x8895; // GL_ELEMENT_ARRAY_BUFFER_BINDING
+constexpr GLenum kStreamDraw                = 0x88E0; // GL_STREAM_DRAW
+constexpr GLenum kFragmentShader            = 0x8B30; // GL_FRAGMENT_SHADER
+constexpr GLenum kVertexShader              = 0x8B31; // GL_VERTEX_SHADER
+constexpr GLenum kCompileStatus             = 0x8B81; // GL_COMPILE_STATUS
+constexpr GLenum kLinkStatus                = 0x8B82; // GL_LINK_STATUS
+constexpr GLenum kCurrentProgram            = 0x8B8D; // GL_CURRENT_PROGRAM
+
+struct GlBufferFunctions
+{
+    void(IMGUI_SFML_GLAPI* GenBuffers)(GLsizei, GLuint*);
+    void(IMGUI_SFML_GLAPI* DeleteBuffers)(GLsizei, const GLuint*);
+    void(IMGUI_SFML_GLAPI* BindBuffer)(GLenum, GLuint);
+    void(IMGUI_SFML_GLAPI* BufferData)(GLenum, std::ptrdiff_t, const void*, GLenum);
+    void(IMGUI_SFML_GLAPI* BufferSubData)(GLenum, std::ptrdiff_t, std::ptrdiff_t, const void*);
+    GLuint(IMGUI_SFML_GLAPI* CreateShader)(GLenum);
+    void(IMGUI_SFML_GLAPI* ShaderSource)(GLuint, GLsizei, const char* const*, const GLint*);
+    void(IMGUI_SFML_GLAPI* CompileShader)(GLuint);
+    void(IMGUI_SFML_GLAPI* GetShaderiv)(GLuint, GLenum, GLint*);
+    void(IMGUI_SFML_GLAPI* DeleteShader)(GLuint);
+    GLuint(IMGUI_SFML_GLAPI* CreateProgram)();
+    void(IMGUI_SFML_GLAPI* AttachShader)(GLuint, GLuint);
+    void(IMGUI_SFML_GLAPI* BindAttribLocation)(GLuint, GLuint, const char*);
+    void(IMGUI_SFML_GLAPI* LinkProgram)(GLuint);
+    void(IMGUI_SFML_GLAPI* GetProgramiv)(GLuint, GLenum, GLint*);
+    void(IMGUI_SFML_GLAPI* DeleteProgram)(GLuint);
+    void(IMGUI_SFML_GLAPI* UseProgram)(GLuint);
+    GLint(IMGUI_SFML_GLAPI* GetUniformLocation)(GLuint, const char*);
+    void(IMGUI_SFML_GLAPI* Uniform1i)(GLint, GLint);
+    void(IMGUI_SFML_GLAPI* UniformMatrix4fv)(GLint, GLsizei, GLboolean, const GLfloat*);
+    void(IMGUI_SFML_GLAPI* EnableVertexAttribArray)(GLuint);
+    void(IMGUI_SFML_GLAPI* DisableVertexAttribArray)(GLuint);
+    void(IMGUI_SFML_GLAPI* VertexAttribPointer)(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*);
+};
+
+struct BufferRenderer
+{
+    GlBufferFunctions gl{};
+    bool              ready{false};
+    bool              failed{false}; // Setup failed once; not retried
+    GLuint            program{0};
+    GLuint            vertexBuffer{0};
+    GLuint            indexBuffer{0};
+    GLint             projectionLocation{-1};
+    GLint             textureLocation{-1};
+    std::size_t       vertexCapacity{0}; // Bytes
+    std::size_t       indexCapacity{0};
+};
+
+BufferRenderer s_bufferRenderer;
+
+// Generic attributes and uniforms only, no fixed-function built-ins, so the same shader
+// carries over to a core profile by swapping attribute/varying for in/out. GLSL 1.20
+// because SFML's compatibility contexts can be GL 2.1 (macOS).
+const char* const kVertexShaderSource =
+    "#version 120\n"
+    "uniform mat4 Projection;\n"
+    "attribute vec2 Position;\n"
+    "attribute vec2 UV;\n"
+    "attribute vec4 Color;\n"
+    "varying vec2 FragUV;\n"
+    "varying vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "    FragUV = UV;\n"
+    "    FragColor = Color;\n"
+    "    gl_Position = Projection * vec4(Position.xy, 0.0, 1.0);\n"
+    "}\n";
+
+const char* const kFragmentShaderSource =
+    "#version 120\n"
+    "uniform sampler2D Texture;\n"
+    "varying vec2 FragUV;\n"
+    "varying vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_FragColor = FragColor * texture2D(Texture, FragUV);\n"
+    "}\n";
+
+enum : GLuint
+{
+    kPositionAttribute,
+    kUVAttribute,
+    kColorAttribute
+};
+
+template <typename Function>
+bool loadGlFunction(Function& function, const char* name)
+{
+    function = reinterpret_cast<Function>(sf::Context::getFunction(name));
+    return function != nullptr;
+}
+
+bool loadGlBufferFunctions(GlBufferFunctions& gl)
+{
+    return loadGlFunction(gl.GenBuffers, "glGenBuffers") && loadGlFunction(gl.DeleteBuffers, "glDeleteBuffers") &&
+           loadGlFunction(gl.BindBuffer, "glBindBuffer") && loadGlFunction(gl.BufferData, "glBufferData") &&
+           loadGlFunction(gl.BufferSubData, "glBufferSubData") && loadGlFunction(gl.CreateShader, "glCreateShader") &&
+           loadGlFunction(gl.ShaderSource, "glShaderSource") && loadGlFunction(gl.CompileShader, "glCompileShader") &&
+           loadGlFunction(gl.GetShaderiv, "glGetShaderiv") && loadGlFunction(gl.DeleteShader, "glDeleteShader") &&
+           loadGlFunction(gl.CreateProgram, "glCreateProgram") && loadGlFunction(gl.AttachShader, "glAttachShader") &&
+           loadGlFunction(gl.BindAttribLocation, "glBindAttribLocation") &&
+           loadGlFunction(gl.LinkProgram, "glLinkProgram") && loadGlFunction(gl.GetProgramiv, "glGetProgramiv") &&
+           loadGlFunction(gl.DeleteProgram, "glDeleteProgram") && loadGlFunction(gl.UseProgram, "glUseProgram") &&
+           loadGlFunction(gl.GetUniformLocation, "glGetUniformLocation") &&
+           loadGlFunction(gl.Uniform1i, "glUniform1i") && loadGlFunction(gl.UniformMatrix4fv, "glUniformMatrix4fv") &&
+           loadGlFunction(gl.EnableVertexAttribArray, "glEnableVertexAttribArray") &&
+           loadGlFunction(gl.DisableVertexAttribArray, "glDisableVertexAttribArray") &&
+           loadGlFunction(gl.VertexAttribPointer, "glVertexAttribPointer");
+}
+
+GLuint compileShader(const GlBufferFunctions& gl, GLenum type, const char* source)
+{
+    const GLuint shader = gl.CreateShader(type);
+    gl.ShaderSource(shader, 1, &source, nullptr);
+    gl.CompileShader(shader);
+    GLint status = GL_FALSE;
+    gl.GetShaderiv(shader, kCompileStatus, &status);
+    if (status != GL_TRUE)
+    {
+        gl.DeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+bool CreateBufferRenderer()
+{
+    BufferRenderer& r = s_bufferRenderer;
+    if (r.failed)
+        return false;
+    r.failed = true; // Until everything below has worked
+
+    if (!loadGlBufferFunctions(r.gl))
+        return false;
+    const GlBufferFunctions& gl = r.gl;
+
+    const GLuint vertexShader   = compileShader(gl, kVertexShader, kVertexShaderSource);
+    const GLuint fragmentShader = compileShader(gl, kFragmentShader, kFragmentShaderSource);
+    if (vertexShader == 0 || fragmentShader == 0)
+    {
+        if (vertexShader != 0)
+            gl.DeleteShader(vertexShader);
+        if (fragmentShader != 0)
+            gl.DeleteShader(fragmentShader);
+        return false;
+    }
+
+    r.program = gl.CreateProgram();
+    gl.AttachShader(r.program, vertexShader);
+    gl.AttachShader(r.program, fragmentShader);
+    gl.BindAttribLocation(r.program, kPositionAttribute, "Position");
+    gl.BindAttribLocation(r.program, kUVAttribute, "UV");
+    gl.BindAttribLocation(r.program, kColorAttribute, "Color");
+    gl.LinkProgram(r.program);
+    gl.DeleteShader(vertexShader); // Freed with the program
+    gl.DeleteShader(fragmentShader);
+    GLint status = GL_FALSE;
+    gl.GetProgramiv(r.program, kLinkStatus, &status);
+    if (status != GL_TRUE)
+    {
+        gl.DeleteProgram(r.program);
+        r.program = 0;
+        return false;
+    }
+    r.projectionLocation = gl.GetUniformLocation(r.program, "Projection");
+    r.textureLocation    = gl.GetUniformLocation(r.program, "Texture");
+
+    gl.GenBuffers(1, &r.vertexBuffer);
+    gl.GenBuffers(1, &r.indexBuffer);
+    r.failed = false;
+    r.ready  = true;
+    return true;
+}
+
+void DestroyBufferRenderer()
+{
+    BufferRenderer& r = s_bufferRenderer;
+    // Without a current context the objects go with the context
+    if (r.ready && sf::Context::getActiveContextId() != 0)
+    {
+        r.gl.DeleteBuffers(1, &r.vertexBuffer);
+        r.gl.DeleteBuffers(1, &r.indexBuffer);
+        r.gl.DeleteProgram(r.program);
+    }
+    r = BufferRenderer{};
+}
+
+// Orphans the bound buffer so the driver can hand out fresh storage instead of waiting
+// for draws still reading last frame's; grows it by half again when the frame needs more
+void orphanBuffer(const GlBufferFunctions& gl, GLenum target, std::size_t& capacity, std::size_t bytes)
+{
+    if (bytes > capacity)
+        capacity = std::max(bytes, capacity + capacity / 2);
+    gl.BufferData(target, static_cast<std::ptrdiff_t>(capacity), nullptr, kStreamDraw);
+}
+
+void SetupBufferRenderState(ImDrawData* draw_data, int fb_width, int fb_height)
+{
+    const BufferRenderer&    r  = s_bufferRenderer;
+    const GlBufferFunctions& gl = r.gl;
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_STENCIL_TEST);
+    glEnable(GL_SCISSOR_TEST);
+    glViewport(0, 0, (GLsizei)fb_width, (GLsizei)fb_height);
+
+    // Same projection as the legacy path's glOrtho
+    const float   L             = draw_data->DisplayPos.x;
+    const float   R             = draw_data->DisplayPos.x + draw_data->DisplaySize.x;
+    const float   T             = draw_data->DisplayPos.y;
+    const float   B             = draw_data->DisplayPos.y + draw_data->DisplaySize.y;
+    const GLfloat ortho[4][4] = {
+        {2.0f / (R - L), 0.0f, 0.0f, 0.0f},
+        {0.0f, 2.0f / (T - B), 0.0f, 0.0f},
+        {0.0f, 0.0f, -1.0f, 0.0f},
+        {(R + L) / (L - R), (T + B) / (B - T), 0.0f, 1.0f},
+    };
+    gl.UseProgram(r.program);
+    gl.Uniform1i(r.textureLocation, 0);
+    gl.UniformMatrix4fv(r.projectionLocation, 1, GL_FALSE, &ortho[0][0]);
+
+    gl.BindBuffer(kArrayBuffer, r.vertexBuffer);
+    gl.BindBuffer(kElementArrayBuffer, r.indexBuffer);
+    gl.EnableVertexAttribArray(kPositionAttribute);
+    gl.EnableVertexAttribArray(kUVAttribute);
+    gl.EnableVertexAttribArray(kColorAttribute);
+}
+
+bool RenderDrawListsBuffered(ImDrawData* draw_data, int fb_width, int fb_height)
+{
+    BufferRenderer& r = s_bufferRenderer;
+    if (!r.ready && !CreateBufferRenderer())
+        return false;
+    const GlBufferFunctions& gl = r.gl;
+
+    // Backup GL state
+    GLint last_program = 0;
+    glGetIntegerv(kCurrentProgram, &last_program);
+    GLint last_texture = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
+    GLint last_array_buffer = 0;
+    glGetIntegerv(kArrayBufferBinding, &last_array_buffer);
+    GLint last_element_array_buffer = 0;
+    glGetIntegerv(kElementArrayBufferBinding, &last_element_array_buffer);
+    GLint last_viewport[4];
+    glGetIntegerv(GL_VIEWPORT, last_viewport);
+    GLint last_scissor_box[4];
+    glGetIntegerv(GL_SCISSOR_BOX, last_scissor_box);
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT);
+    // SFML leaves the fixed-function arrays enabled; some drivers alias them with generic attributes
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+
+    SetupBufferRenderState(draw_data, fb_width, fb_height);
+
+    // Upload the whole frame with one orphaning call per buffer, then every list's data
+    // at its running offset
+    orphanBuffer(gl, kArrayBuffer, r.vertexCapacity, (std::size_t)draw_data->TotalVtxCount * sizeof(ImDrawVert));
+    orphanBuffer(gl, kElementArrayBuffer, r.indexCapacity, (std::size_t)draw_data->TotalIdxCount * sizeof(ImDrawIdx));
+    std::size_t vtx_bytes = 0;
+    std::size_t idx_bytes = 0;
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList*  cmd_list = draw_data->CmdLists[n];
+        const std::size_t  vsize    = (std::size_t)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert);
+        const std::size_t  isize    = (std::size_t)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx);
+        gl.BufferSubData(kArrayBuffer, (std::ptrdiff_t)vtx_bytes, (std::ptrdiff_t)vsize, cmd_list->VtxBuffer.Data);
+        gl.BufferSubData(kElementArrayBuffer, (std::ptrdiff_t)idx_bytes, (std::ptrdiff_t)isize, cmd_list->IdxBuffer.Data);
+        vtx_bytes += vsize;
+        idx_bytes += isize;
+    }
+
+    // Will project scissor/clipping rectangles into framebuffer space
+    const ImVec2 clip_off   = draw_data->DisplayPos;
+    const ImVec2 clip_scale = draw_data->FramebufferScale;
+
+    vtx_bytes = 0;
+    idx_bytes = 0;
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        // Indices are relative to their list, so the attributes start at the list's vertices
+        const char* vtx_base = reinterpret_cast<const char*>(static_cast<std::uintptr_t>(vtx_bytes));
+        gl.VertexAttribPointer(kPositionAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), vtx_base + offsetof(ImDrawVert, pos));
+        gl.VertexAttribPointer(kUVAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), vtx_base + offsetof(ImDrawVert, uv));
+        gl.VertexAttribPointer(kColorAttribute, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), vtx_base + offsetof(ImDrawVert, col));
+
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
+        {
+            const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
+            if (pcmd->UserCallback)
+            {
+                if (pcmd->UserCallback == ImDrawCallback_ResetRenderState)
+                    SetupBufferRenderState(draw_data, fb_width, fb_height);
+                else
+                    pcmd->UserCallback(cmd_list, pcmd);
+                continue;
+            }
+
+            ImVec4 clip_rect;
+            clip_rect.x = (pcmd->ClipRect.x - clip_off.x) * clip_scale.x;
+            clip_rect.y = (pcmd->ClipRect.y - clip_off.y) * clip_scale.y;
+            clip_rect.z = (pcmd->ClipRect.z - clip_off.x) * clip_scale.x;
+            clip_rect.w = (pcmd->ClipRect.w - clip_off.y) * clip_scale.y;
+            if (clip_rect.x < static_cast<float>(fb_width) && clip_rect.y < static_cast<float>(fb_height) &&
+                clip_rect.z >= 0.0f && clip_rect.w >= 0.0f)
+            {
+                glScissor((int)clip_rect.x,
+                          (int)(static_cast<float>(fb_height) - clip_rect.w),
+                          (int)(clip_rect.z - clip_rect.x),
+                          (int)(clip_rect.w - clip_rect.y));
+                glBindTexture(GL_TEXTURE_2D, convertImTextureIDToGLTextureHandle(pcmd->TextureId));
+                const std::size_t idx_offset = idx_bytes + pcmd->IdxOffset * sizeof(ImDrawIdx);
+                glDrawElements(GL_TRIANGLES,
+                               (GLsizei)pcmd->ElemCount,
+                               sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+                               reinterpret_cast<const void*>(static_cast<std::uintptr_t>(idx_offset)));
+            }
+        }
+        vtx_bytes += (std::size_t)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert);
+        idx_bytes += (std::size_t)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx);
+    }
+
+    // Restore modified GL state
+    gl.DisableVertexAttribArray(kPositionAttribute);
+    gl.DisableVertexAttribArray(kUVAttribute);
+    gl.DisableVertexAttribArray(kColorAttribute);
+    gl.BindBuffer(kArrayBuffer, (GLuint)last_array_buffer);
+    gl.BindBuffer(kElementArrayBuffer, (GLuint)last_element_array_buffer);
+    gl.UseProgram((GLuint)last_program);
+    glBindTexture(GL_TEXTURE_2D, (GLuint)last_texture);
+    glPopClientAttrib();
+    glPopAttrib();
+    glViewport(last_viewport[0], last_viewport[1], (GLsizei)last_viewport[2], (GLsizei)last_viewport[3]);
+    glScissor(last_scissor_box[0], last_scissor_box[1], (GLsizei)last_scissor_box[2], (GLsizei)last_scissor_box[3]);
+    return true;
+}
+#else
+// No shaders on GLES 1
+bool RenderDrawListsBuffered(ImDrawData*, int, int)
+{
+    return false;
+}
+
+void DestroyBufferRenderer()
+{
+}
+#endif
+
 void initDefaultJoystickMapping()
 {
     ImGui::SFML::SetJoystickMapping(ImGuiKey_GamepadFaceDown, 0);
@@ -22,6 +22,8 @@ class Texture;
 class Window;
 } // namespace sf
 
+struct ImDrawData;
+
 namespace ImGui
 {
 namespace SFML
@@ -40,6 +42,22 @@ IMGUI_SFML_API void Update(const sf::Vector2i& mousePos, const sf::Vector2f& dis
 IMGUI_SFML_API void Render(sf::RenderWindow& window);
 IMGUI_SFML_API void Render(sf::RenderTarget& target);
 IMGUI_SFML_API void Render();
+// Draws lists produced by an earlier ImGui::Render(), e.g. copied for another thread.
+// Doesn't touch the ImGui context beyond reading io.Fonts and io.DisplayFramebufferScale.
+IMGUI_SFML_API void RenderDrawData(sf::RenderTarget& target, ImDrawData* drawData);
+
+// How draw lists reach GL. Legacy (the default) draws from client-side arrays, which the
+// driver copies on every draw call. BufferObjects streams each frame's vertices and indices
+// into two reused buffer objects (orphaned once per frame) and draws them with a small
+// shader; it needs GL 2.0 and is set up on the first draw. GetRenderer() reports Legacy
+// again if that setup failed.
+enum class Renderer
+{
+    Legacy,
+    BufferObjects
+};
+IMGUI_SFML_API void     SetRenderer(Renderer renderer);
+IMGUI_SFML_API Renderer GetRenderer();
 
 IMGUI_SFML_API void Shutdown(const sf::Window& window);
 // Shuts down all ImGui contexts
@@ -0,0 +1,143 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "Profiler.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class SimSnapshot;
+
+// Time-sliced scheduler for AI decisions. Agents are dense indices 0..n-1
+// owned by the caller. Each update classifies every agent by distance to the
+// focus (the camera), and an agent becomes due once its LOD's think interval
+// has passed: near agents every update, farther ones at reduced rates. Due
+// agents are then visited round-robin from where the last update stopped, at
+// most thinkBudget per update, so a crowd never costs more than the budget
+// and nobody starves. New agents get staggered first decisions so a freshly
+// loaded level doesn't think in lockstep.
+class AIScheduler {
+public:
+    enum class Lod : uint8_t {
+        Near,
+        Mid,
+        Far
+    };
+
+    struct Settings {
+        size_t thinkBudget = 128;      // Decisions per update
+        float nearDistance = 800.0f;   // From the focus; closer agents are Near
+        float farDistance = 1600.0f;   // Beyond this agents are Far
+        float distanceScale = 1.0f;    // Of both distances; quality settings lower it
+        float nearInterval = 0.0f;     // Seconds between decisions per LOD (0 = every update)
+        float midInterval = 0.25f;
+        float farInterval = 1.0f;
+    };
+
+    struct Stats {
+        size_t agents = 0;
+        size_t nearAgents = 0;
+        size_t midAgents = 0;
+        size_t farAgents = 0;
+        size_t thinks = 0;
+        size_t deferred = 0;      // Due but over budget, first in line next update
+        uint64_t thinkNs = 0;     // Time spent in the think callbacks
+    };
+
+    void resize(size_t count);
+    void clear();
+    // Swap-removes an agent, as the caller did with its records: the last agent
+    // moves to 'agent' and keeps its clock
+    void remove(size_t agent);
+
+    // Without a focus every agent is Near
+    void setFocus(const sf::Vector2f& position) { focus = position; hasFocus = true; }
+    void clearFocus() { hasFocus = false; }
+
+    Settings& getSettings() { return settings; }
+    const Settings& getSettings() const { return settings; }
+    Lod getLod(size_t agent) const { return lods[agent]; }
+
+    // position(agent) -> sf::Vector2f; think(agent, secondsSinceLastThink)
+    template <typename PositionFn, typename ThinkFn>
+    void update(float deltaTime, PositionFn&& position, ThinkFn&& think);
+
+    // Save states: the decision clocks, LODs, cursor and focus
+    void saveState(SimSnapshot& snapshot) const;
+    bool loadState(SimSnapshot& snapshot);
+
+    const Stats& getStats() const { return stats; }        // Last update
+    Stats takeFrameTotals();                               // Sums since the last call (several updates per frame)
+
+private:
+    Settings settings;
+    sf::Vector2f focus;
+    bool hasFocus = false;
+    std::vector<float> sinceThink; // Seconds since each agent's last decision
+    std::vector<Lod> lods;
+    size_t cursor = 0;             // Round-robin start for the next update
+    Stats stats;
+    Stats frameTotals;
+};
+
+template <typename PositionFn, typename ThinkFn>
+void AIScheduler::update(float deltaTime, PositionFn&& position, ThinkFn&& think) {
+    PROFILE_ZONE("AIScheduler::update");
+    const size_t count = sinceThink.size();
+    stats = Stats();
+    stats.agents = count;
+    if (count == 0) {
+        return;
+    }
+
+    // Classify and age every agent; this is the only per-agent work outside the budget
+    const float nearDistance = settings.nearDistance * settings.distanceScale;
+    const float farDistance = settings.farDistance * settings.distanceScale;
+    const float nearSquared = nearDistance * nearDistance;
+    const float farSquared = farDistance * farDistance;
+    const float intervals[3] = {settings.nearInterval, settings.midInterval, settings.farInterval};
+    size_t due = 0;
+    for (size_t i = 0; i < count; ++i) {
+        Lod lod = Lod::Near;
+        if (hasFocus) {
+            const sf::Vector2f p = position(i);
+            const float dx = p.x - focus.x;
+            const float dy = p.y - focus.y;
+            const float distanceSquared = dx * dx + dy * dy;
+            lod = distanceSquared > farSquared ? Lod::Far : distanceSquared > nearSquared ? Lod::Mid : Lod::Near;
+        }
+        lods[i] = lod;
+        stats.nearAgents += lod == Lod::Near;
+        stats.midAgents += lod == Lod::Mid;
+        stats.farAgents += lod == Lod::Far;
+        sinceThink[i] += deltaTime;
+        due += sinceThink[i] >= intervals[static_cast<size_t>(lod)];
+    }
+
+    // Round-robin over the due agents until the budget runs out
+    {
+        PROFILE_ZONE("AIScheduler::think");
+        const uint64_t start = Profiler::now();
+        if (cursor >= count) {
+            cursor = 0;
+        }
+        size_t visited = 0;
+        for (; visited < count && stats.thinks < settings.thinkBudget; ++visited) {
+            const size_t agent = (cursor + visited) % count;
+            if (sinceThink[agent] < intervals[static_cast<size_t>(lods[agent])]) continue;
+            think(agent, sinceThink[agent]);
+            sinceThink[agent] = 0.0f;
+            stats.thinks++;
+        }
+        cursor = (cursor + visited) % count;
+        stats.thinkNs = Profiler::now() - start;
+    }
+    stats.deferred = due - stats.thinks;
+
+    frameTotals.agents = stats.agents;
+    frameTotals.nearAgents = stats.nearAgents;
+    frameTotals.midAgents = stats.midAgents;
+    frameTotals.farAgents = stats.farAgents;
+    frameTotals.thinks += stats.thinks;
+    frameTotals.deferred = stats.deferred;
+    frameTotals.thinkNs += stats.thinkNs;
+}
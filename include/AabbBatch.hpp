@@ -0,0 +1,46 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cstdint>
+
+// Batch AABB overlap tests: one query box against many boxes at once.
+// Boxes are stored as min/max corners in separate arrays so the kernel can
+// compare four boxes per instruction (SSE2 or NEON, scalar fallback otherwise).
+// All tests use strict edges, matching the rectsIntersect helpers.
+namespace AabbBatch {
+
+struct BoxArray {
+    std::vector<float> minX, minY, maxX, maxY;
+
+    void clear() { minX.clear(); minY.clear(); maxX.clear(); maxY.clear(); }
+    void reserve(size_t n) { minX.reserve(n); minY.reserve(n); maxX.reserve(n); maxY.reserve(n); }
+    size_t size() const { return minX.size(); }
+    bool empty() const { return minX.empty(); }
+
+    void push(const sf::FloatRect& rect) {
+        minX.push_back(rect.position.x);
+        minY.push_back(rect.position.y);
+        maxX.push_back(rect.position.x + rect.size.x);
+        maxY.push_back(rect.position.y + rect.size.y);
+    }
+};
+
+// Name of the kernel compiled into this build ("SSE2", "NEON" or "Scalar")
+const char* kernelName();
+
+// Append the indices of all boxes overlapping 'box' to 'hits' (cleared first),
+// in ascending order. Returns the number of hits.
+size_t overlapList(const sf::FloatRect& box, const BoxArray& boxes, std::vector<uint32_t>& hits);
+
+// Same as overlapList but always uses the one-pair-at-a-time scalar path
+size_t overlapListScalar(const sf::FloatRect& box, const BoxArray& boxes, std::vector<uint32_t>& hits);
+
+// Single pair test, shared by the scalar paths
+inline bool overlaps(const sf::FloatRect& a, const sf::FloatRect& b) {
+    return a.position.x < b.position.x + b.size.x &&
+           a.position.x + a.size.x > b.position.x &&
+           a.position.y < b.position.y + b.size.y &&
+           a.position.y + a.size.y > b.position.y;
+}
+
+} // namespace AabbBatch
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Process-wide heap allocation counters, fed by the global operator new/delete
+// replacements in AllocationTracker.cpp. Counting is a relaxed atomic add per
+// call, from any thread. The profiler samples the totals at every frame mark to
+// get per-frame figures.
+//
+// With GAME_MEMORY_TAGS (cmake -DGAME_MEMORY_TAGS=OFF to drop it) every block
+// also carries a 16-byte header holding its size and the tag that was current
+// on the allocating thread, so live bytes can be charged to the subsystem that
+// allocated them, wherever they are freed. A ScopedTag sets the tag for the
+// rest of a scope; threads that belong to one subsystem set it once at start.
+// Memory the subsystems reach through other allocators (malloc in libraries,
+// driver memory) is not seen here; the memory dashboard adds their estimates.
+#ifndef GAME_MEMORY_TAGS
+#define GAME_MEMORY_TAGS 1
+#endif
+
+namespace AllocationTracker {
+
+struct Counts {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;       // Requested, not what malloc rounded up to
+    uint64_t frees = 0;
+};
+
+Counts getTotals();
+
+enum class Tag : uint8_t {
+    Untagged,
+    Physics,
+    Npcs,
+    Animation,
+    Tiles,
+    Backgrounds,
+    Audio,
+    ImGui,
+    Logging,
+    Level,   // Level data, sectors, caches and the preloader
+    Count
+};
+constexpr size_t TAG_COUNT = static_cast<size_t>(Tag::Count);
+
+const char* getTagName(Tag tag);
+// Bytes allocated under 'tag' and not yet freed; 0 without GAME_MEMORY_TAGS
+uint64_t getLiveBytes(Tag tag);
+uint64_t getLiveBytes(); // All tags
+
+Tag getThreadTag();
+void setThreadTag(Tag tag); // For threads owned by one subsystem
+
+class ScopedTag {
+public:
+    explicit ScopedTag(Tag tag) : previous(getThreadTag()) { setThreadTag(tag); }
+    ~ScopedTag() { setThreadTag(previous); }
+
+    ScopedTag(const ScopedTag&) = delete;
+    ScopedTag& operator=(const ScopedTag&) = delete;
+
+private:
+    Tag previous;
+};
+
+// For libraries with their own allocator hooks (ImGui): counted and tagged
+// like operator new, and released with taggedFree
+void* taggedAlloc(size_t size, Tag tag);
+void taggedFree(void* pointer);
+
+} // namespace AllocationTracker
@@ -1,9 +1,13 @@
 #pragma once
 #include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <vector>
 #include <string>
-#include <unordered_map>
 #include <memory>
+#include "AnimationClip.hpp"
 
 enum class AnimationState {
     Idle,
@@ -14,10 +18,62 @@ enum class AnimationState {
     Die
 };
 
+constexpr size_t ANIMATION_STATE_COUNT = 6;  // Entries in AnimationState; clips are indexed by it
+
+// The per-frame playback step, on plain fields so a system can keep the state
+// of every character in parallel arrays and advance them all in one loop.
+namespace AnimationPlayback {
+    // Shortest frame duration accepted; zero would divide by zero in step()
+    constexpr float MIN_FRAME_TIME = 0.001f;
+
+    // Idle and walking cycle; the rest play once and hold their last frame
+    constexpr bool loopsByDefault(AnimationState state) {
+        return state == AnimationState::Idle || state == AnimationState::Walking;
+    }
+
+    // Adds 'deltaTime' (while playing) and advances one frame per whole
+    // 'frameDuration' elapsed, so a long hitch skips several frames and the
+    // remainder carries over. Looping clips wrap; one-shot clips hold their last
+    // frame and clear 'playing' once they run past it. 'frameCount' must be > 0.
+    inline void step(float& time, int32_t& frame, uint8_t& playing, float deltaTime,
+                     float frameDuration, int32_t frameCount, bool loop) {
+        time += playing ? deltaTime : 0.0f;
+        const int32_t advance = static_cast<int32_t>(time / frameDuration);
+        time -= static_cast<float>(advance) * frameDuration;
+        const int32_t next = frame + advance;
+        frame = loop ? next % frameCount : std::min(next, frameCount - 1);
+        playing = static_cast<uint8_t>(playing & (loop || next < frameCount));
+    }
+
+    // The frame step() would have reached 'elapsed' seconds after starting a
+    // clip at frame 0, as a pure function of the elapsed time: looping clips
+    // wrap, one-shot clips hold their last frame. 'frameCount' must be > 0.
+    inline int32_t frameAt(double elapsed, float frameDuration, int32_t frameCount, bool loop) {
+        if (!(elapsed > 0.0)) return 0;
+        const double frames = elapsed / frameDuration;
+        if (loop) {
+            return static_cast<int32_t>(std::fmod(std::floor(frames), static_cast<double>(frameCount)));
+        }
+        return static_cast<int32_t>(std::min(frames, static_cast<double>(frameCount - 1)));
+    }
+
+    // Whether a one-shot clip started 'elapsed' seconds ago has run past its
+    // last frame (step() clearing 'playing'); looping clips never do
+    inline bool finishedAt(double elapsed, float frameDuration, int32_t frameCount, bool loop) {
+        return !loop && elapsed / frameDuration >= static_cast<double>(frameCount);
+    }
+
+    // step() over 'count' playbacks held as parallel arrays
+    void stepAll(size_t count, float* time, int32_t* frame, uint8_t* playing, const float* frameDuration,
+                 const int32_t* frameCount, const uint8_t* loop, float deltaTime);
+}
+
 class Animation {
 public:
     Animation();
     ~Animation();
+    Animation(Animation&&) = default;            // Lets owners keep animations in a vector
+    Animation& operator=(Animation&&) = default;
     
     // Load animation frames from directory
     bool loadAnimation(AnimationState state, const std::string& directory);
@@ -38,7 +94,8 @@ public:
     bool hasAnimation(AnimationState state) const;
     
     // Animation settings
-    void setFrameTime(float time) { frameTime = time; }
+    void setFrameTime(float time);                        // Every clip, and clips loaded later
+    void setFrameTime(AnimationState state, float time);  // One clip
     void setLoop(bool loop) { shouldLoop = loop; }
     void setScale(float scaleX, float scaleY);
     void setOrigin(const sf::Vector2f& origin);
@@ -50,31 +107,30 @@ public:
     bool isFinished() const;
 
 private:
-    struct AnimationData {
-        std::vector<std::unique_ptr<sf::Texture>> textures;
-        std::vector<std::unique_ptr<sf::Sprite>> sprites;
-        bool isLoaded = false;
+    // Frame data is shared through AnimationClipCache; the count and duration
+    // the playback step needs are copied out when the clip is loaded
+    struct ClipSlot {
+        std::shared_ptr<const AnimationClip> clip;
+        int32_t frameCount = 0;       // 0 = nothing loaded
+        float frameDuration = 0.1f;   // Seconds per frame
     };
-    
-    std::unordered_map<AnimationState, AnimationData> animations;
+    std::array<ClipSlot, ANIMATION_STATE_COUNT> clips;
     
     AnimationState currentState;
     AnimationState previousState;
     
-    float frameTime;        // Time per frame in seconds
-    float currentTime;      // Current elapsed time
-    int currentFrame;       // Current frame index
+    float frameTime;        // Seconds per frame for clips loaded from now on
+    float currentTime;      // Time into the current frame
+    int32_t currentFrame;   // Current frame index
     bool shouldLoop;        // Whether animation should loop
-    bool isPlaying;         // Whether animation is currently playing
+    uint8_t isPlaying;      // Whether animation is currently playing (0/1, as AnimationPlayback::step takes it)
     
-    std::unique_ptr<sf::Sprite> emptySprite; // Fallback sprite when no animation is loaded
-    std::unique_ptr<sf::Texture> emptyTexture; // Texture for empty sprite
-    sf::Vector2f spriteOrigin; // Store the origin for all sprites
+    // One sprite per instance carries scale and origin; getCurrentSprite() points it
+    // at the current frame (or the fallback texture when nothing is loaded)
+    std::unique_ptr<sf::Sprite> sprite;
+    sf::Vector2f origin; // In untrimmed frame pixels; the sprite's is shifted by the frame's trim offset
     
     // Helper methods
     void switchToState(AnimationState newState);
-    std::vector<std::string> getFrameFiles(const std::string& directory);
-    bool loadFramesFromDirectory(const std::string& directory, AnimationData& animData);
-    void createEmptySprite();
-    void applyOriginToSprite(sf::Sprite& sprite) const; // Helper to apply origin to a sprite
+    const ClipSlot& getSlot(AnimationState state) const { return clips[static_cast<size_t>(state)]; }
 }; 
\ No newline at end of file
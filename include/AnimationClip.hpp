@@ -0,0 +1,93 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "TextureAtlas.hpp"
+
+// Immutable frame data for one animation. Shared by every Animation that plays
+// it; playback state (frame, time, scale, origin) lives in Animation. Frames come
+// either from a directory of images packed into the clip's own atlas, or as rects
+// sliced from a spritesheet texture shared with the sheet's other clips.
+//
+// Directory frames are trimmed to their non-transparent pixels before packing,
+// and pixel-identical trimmed frames share one region. A frame's rect is then
+// smaller than its image: draw it at getFrameOffset() inside the image's bounds
+// (Animation and AnimationSystem do) and it looks exactly as the untrimmed one.
+struct AnimationClip {
+    // Where a trimmed frame sat in its source image
+    struct Trim {
+        sf::Vector2i offset;     // Of the rect's top-left corner
+        sf::Vector2u sourceSize; // The untrimmed image
+    };
+
+    std::string directory;                      // Or "sheet.json#clip"
+    TextureAtlas atlas;                         // Directory clips: distinct trimmed frames packed into pages
+    std::shared_ptr<const sf::Texture> sheet;   // Spritesheet clips: the whole sheet; 'page' is unused
+    std::vector<TextureAtlas::Region> frames;   // In playback order; duplicates repeat a region
+    std::vector<Trim> trims;                    // Directory clips: one per frame (empty for sheets)
+    std::vector<std::string> frameFiles;        // Directory clips: the image of each frame
+
+    size_t getFrameCount() const { return frames.size(); }
+    const sf::Texture& getFrameTexture(size_t frame) const {
+        return sheet ? *sheet : atlas.getPageTexture(frames[frame].page);
+    }
+    const sf::IntRect& getFrameRect(size_t frame) const { return frames[frame].rect; }
+    sf::Vector2i getFrameOffset(size_t frame) const { return trims.empty() ? sf::Vector2i() : trims[frame].offset; }
+};
+
+// Process-wide cache of animation clips keyed by directory. The first request
+// walks the directory, decodes and packs the frames; later requests (every other
+// NPC, a reloaded level) get the same clip. Failed loads are cached too, so a
+// missing directory is only probed once.
+//
+// A path of the form "sheet.json#clip" names a clip in a spritesheet instead.
+// The JSON sidecar gives the image (relative to the sidecar), the frame size and
+// each clip's run of frames, counted row-major across the sheet:
+//   { "image": "FinnSprite.png", "frame_width": 32, "frame_height": 32,
+//     "clips": { "idle": { "first": 0, "count": 9 }, ... } }
+// The first request decodes the sheet once and caches all of its clips.
+class AnimationClipCache {
+public:
+    static AnimationClipCache& instance();
+
+    // Returns nullptr if the directory (or sheet clip) is missing or has no loadable frames
+    std::shared_ptr<const AnimationClip> load(const std::string& directory);
+
+    // Shown by animations with nothing loaded; loaded once on first use
+    const sf::Texture& getFallbackTexture();
+
+    size_t getClipCount() const;
+    // Directory frames loaded, and how many of them reuse another frame's region
+    size_t getFrameCount() const;
+    size_t getDuplicateFrameCount() const;
+    size_t getTextureCount() const; // Atlas pages and spritesheets uploaded across all clips
+    size_t getTextureBytes() const; // Their GPU size (RGBA8)
+
+    // Hot reload: rewrites the pixels of every frame or spritesheet loaded from
+    // 'path' in place. A file whose size changed, a frame drawn outside its old
+    // trimmed rect, or one sharing its region with another file's frame is left
+    // alone (the atlas would need repacking) and reported. Returns how many
+    // frames and sheets were updated.
+    size_t reloadFile(const std::string& path);
+
+    // Drop cached clips; animations holding one keep it alive until they let go
+    void clear();
+
+    AnimationClipCache(const AnimationClipCache&) = delete;
+    AnimationClipCache& operator=(const AnimationClipCache&) = delete;
+
+private:
+    AnimationClipCache() = default;
+
+    std::shared_ptr<AnimationClip> loadClip(const std::string& directory);
+    void loadSheet(const std::string& sidecar); // Caches every clip of the sheet under "sidecar#clip"
+    static std::vector<std::string> getFrameFiles(const std::string& directory);
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<AnimationClip>> clips; // Handed out as const
+    std::unordered_map<std::string, std::shared_ptr<sf::Texture>> sheets; // By image path, for reloadFile
+    std::unique_ptr<sf::Texture> fallbackTexture;
+};
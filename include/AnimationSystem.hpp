@@ -0,0 +1,97 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Animation.hpp"
+
+class JobSystem;
+
+// Playback state for many animated characters, stored as parallel arrays and
+// advanced together in one loop by update(). Characters of one type share a
+// clip set, so an instance is only a handful of scalars addressed by the index
+// add() returns. update() lists the instances whose frame changed; only their
+// frame rects are refreshed, so only those need new texture coordinates.
+//
+// Clocked instances are not stepped at all. update() only advances a global
+// clock; an instance remembers when its clip started, and evaluate() works out
+// its frame from the two when the character is drawn (AnimationPlayback::frameAt),
+// so characters nobody draws cost no animation work.
+class AnimationSystem {
+public:
+    using ClipSet = uint32_t;
+    enum class Playback : uint8_t {
+        Stepped, // Advanced by every update()
+        Clocked, // Evaluated from the clock on demand
+    };
+    static constexpr ClipSet NO_CLIP_SET = UINT32_MAX;
+    static constexpr size_t UPDATE_GRAIN = 512; // Instances per job chunk
+
+    // A clip per AnimationState, loaded through AnimationClipCache
+    ClipSet createClipSet(float frameTime);
+    bool loadClip(ClipSet set, AnimationState state, const std::string& directory);
+
+    // Instances; remove() swap-removes, so the last instance moves to 'index'
+    uint32_t add(ClipSet set, AnimationState state = AnimationState::Idle, Playback playback = Playback::Stepped);
+    void remove(uint32_t index);
+    void clear(); // Instances only; clip sets stay loaded
+    size_t size() const { return time.size(); }
+
+    // Restarts playback (and refreshes the frame) unless already in 'state'
+    void setState(uint32_t index, AnimationState state);
+    AnimationState getState(uint32_t index) const { return states[index]; }
+    // 0 freezes a stepped instance; clocked ones always play at the clock's rate
+    void setTimeScale(uint32_t index, float scale) { timeScale[index] = scale; }
+    bool isFinished(uint32_t index) const;
+
+    // Advances the clock and every stepped instance; chunks run on 'jobs' when given
+    void update(float deltaTime, JobSystem* jobs = nullptr);
+    const std::vector<uint32_t>& getChangedFrames() const { return changed; } // From the last update()
+    double getClock() const { return clock; }
+
+    // Brings a clocked instance's frame up to the clock; nothing for stepped ones.
+    // Call before reading the frame of an instance about to be drawn.
+    void evaluate(uint32_t index);
+
+    // The current frame: its atlas page (the fallback texture when the state has no clip), rect,
+    // and where that (trimmed) rect sits in the frame's untrimmed image
+    const sf::Texture& getFramePage(uint32_t index) const { return *framePages[index]; }
+    const sf::IntRect& getFrameRect(uint32_t index) const { return frameRects[index]; }
+    sf::Vector2i getFrameOffset(uint32_t index) const { return frameOffsets[index]; }
+
+private:
+    struct Clip {
+        std::shared_ptr<const AnimationClip> clip;
+        int32_t frameCount = 0;     // 0 = nothing loaded
+        float frameDuration = 0.1f;
+    };
+    using ClipArray = std::array<Clip, ANIMATION_STATE_COUNT>;
+
+    void start(uint32_t index, AnimationState state); // Playback from the clip's first frame
+    void refreshFrame(uint32_t index);
+
+    std::vector<ClipArray> clipSets;
+
+    // Hot: read and written by the step
+    std::vector<float> time;
+    std::vector<float> frameDuration;
+    std::vector<float> timeScale;
+    std::vector<int32_t> frame;
+    std::vector<int32_t> frameCount; // At least 1; a state without a clip holds frame 0
+    std::vector<uint8_t> playing;
+    std::vector<uint8_t> loop;
+    std::vector<uint8_t> frameChanged;
+    std::vector<uint8_t> clocked;
+
+    // Cold
+    std::vector<double> startTime; // Clocked instances: the clock when the clip started
+    std::vector<ClipSet> clipSetOf;
+    std::vector<AnimationState> states;
+    std::vector<const sf::Texture*> framePages;
+    std::vector<sf::IntRect> frameRects;
+    std::vector<sf::Vector2i> frameOffsets;
+    std::vector<uint32_t> changed;
+    double clock = 0.0; // Seconds of update() since the system was created
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+#include "AssetIndex.hpp"
+#include "AssetSearchIndex.hpp"
+#include "ThumbnailCache.hpp"
+
+// Editor tooling (the Asset Manager window, the ImGui demo). ON by default;
+// cmake -DGAME_EDITOR=OFF builds a player-only game without it.
+#ifndef GAME_EDITOR
+#define GAME_EDITOR 1
+#endif
+
+class AssetManager;
+
+// Image asset info structure
+struct ImageAssetInfo {
+    std::string path;
+    std::string name;
+    sf::Vector2u dimensions;
+    size_t fileSize;
+    bool isLoaded;
+    sf::Time loadTime;
+};
+
+// The Asset Manager window: browses the asset directories with thumbnails and
+// a full-size preview, and loads a picked image into the game. Game creates it
+// the first time the window opens, so the index cache, the thumbnail atlas
+// pages and their jobs cost nothing in sessions that never look.
+class AssetBrowser {
+public:
+    // Scans and thumbnails run on 'jobs'
+    AssetBrowser(AssetManager& assets, JobSystem& jobs)
+        : assets(assets), assetIndex(jobs, "asset_index.cache"), thumbnails(jobs) {}
+
+    // Once per frame while open; rescans the asset root each time it is opened
+    void draw(bool* open);
+
+private:
+    void scanDirectory(const std::string& directory); // Starts a background scan
+    void collectScanResults();                        // Merges what the scan found so far
+
+    AssetManager& assets;
+    bool scanned = false; // Since the window was last opened
+    std::vector<ImageAssetInfo> imageAssets;          // In scan order; the list shows search's view of it
+    AssetSearchIndex search;                          // Filter and sort orders over imageAssets
+    char filterText[128] = {};
+    AssetIndex assetIndex;                            // Persisted next to the executable's working dir
+    std::vector<AssetIndex::Entry> assetScanResults;  // Scratch for collectScanResults
+    ImageAssetInfo* selectedAsset = nullptr;
+    ThumbnailCache thumbnails;          // Row thumbnails, and the async full-size preview load
+    static constexpr float THUMBNAIL_ROW_HEIGHT = 32.0f;
+    sf::Image previewImage;             // Handed over by thumbnails, uploaded to previewTexture
+    sf::Texture previewTexture;
+    bool previewAvailable = false;
+    bool previewLoading = false;
+};
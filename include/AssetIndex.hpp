@@ -0,0 +1,100 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "JobSystem.hpp"
+
+// Persistent index of the asset files shown by the Asset Manager window.
+//
+// scan() walks a directory in a job on the Cooking lane: its top-level entries, plus
+// every image below its "images" subdirectories. A file whose size and mtime
+// match its index entry is reused as is; new or changed files are mapped once to
+// read their dimensions from the image header (PNG, JPEG, BMP, TGA) and hash the
+// contents. Entries are handed over in batches through takeResults(), so the
+// window fills in while the scan runs. The index is saved when a scan finds
+// changes and loaded again on construction.
+//
+// File layout (little-endian): FileHeader, then per entry a FileEntry followed
+// by its path (pathLength bytes, no terminator).
+class AssetIndex {
+public:
+    struct Entry {
+        std::string path;
+        uint64_t fileSize = 0;
+        int64_t modifiedTime = 0;   // file_time_type ticks
+        uint64_t contentHash = 0;   // FNV-1a of the contents; 0 for directories
+        sf::Vector2u dimensions;    // 0x0 unless a readable image
+        bool isDirectory = false;
+        bool isImage = false;       // By extension
+        bool reused = false;        // Came from the index without touching the file
+        float probeMilliseconds = 0.0f;
+    };
+
+    static constexpr char MAGIC[4] = {'A', 'I', 'D', 'X'};
+    static constexpr uint32_t VERSION = 1;
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t entryCount;
+    };
+
+    struct FileEntry {
+        uint64_t fileSize;
+        int64_t modifiedTime;
+        uint64_t contentHash;
+        uint32_t width;
+        uint32_t height;
+        uint32_t pathLength;
+        uint32_t padding;
+    };
+
+    // 'jobs' must outlive the index
+    AssetIndex(JobSystem& jobs, std::string indexPath);
+    ~AssetIndex(); // Cancels a running scan and waits for its job
+
+    AssetIndex(const AssetIndex&) = delete;
+    AssetIndex& operator=(const AssetIndex&) = delete;
+
+    // Starts a background scan of 'directory', cancelling one in progress
+    void scan(const std::string& directory);
+    bool isScanning() const { return scanning.load(std::memory_order_acquire); }
+
+    // Appends the entries found since the last call to 'out'; returns how many
+    size_t takeResults(std::vector<Entry>& out);
+
+    // Last scan: files served from the index vs probed from disk
+    size_t getReusedCount() const { return reusedCount.load(std::memory_order_relaxed); }
+    size_t getProbedCount() const { return probedCount.load(std::memory_order_relaxed); }
+
+    // Image size from the file header alone; false for unknown or truncated data
+    static bool probeImageSize(const char* data, size_t size, const std::string& extension, sf::Vector2u& out);
+    static bool isImageExtension(const std::string& extension); // Lowercase, with the dot
+
+private:
+    void run(std::string directory);
+    void addFile(const std::string& path, uint64_t fileSize, int64_t modifiedTime, std::vector<Entry>& batch);
+    void publish(std::vector<Entry>& batch);
+    void waitForJob(); // Until the submitted scan, if any, has returned
+    bool load();
+    bool save() const;
+
+    JobSystem& jobs;
+    std::string indexPath;
+    std::unordered_map<std::string, Entry> entries; // Keyed by path; guarded by mutex
+    bool dirty = false;                             // Entries changed since the last save
+
+    mutable std::mutex mutex;
+    std::vector<Entry> pending; // Found by the scan, not yet taken
+    std::condition_variable jobDone;
+    bool jobQueued = false;     // A scan job was submitted and hasn't returned
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> scanning{false};
+    std::atomic<size_t> reusedCount{0};
+    std::atomic<size_t> probedCount{0};
+};
@@ -5,41 +5,322 @@
 #include <string>
 #include <memory>
 #include <stdexcept>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string_view>
+#include <vector>
+#include "MappedFile.hpp"
 
+class JobSystem;
+
+// Asset name with its hash, computed at compile time for literals:
+//   static constexpr AssetKey NPC_IDLE("npc_idle");
+// Interning through a key hashes the name once instead of on every lookup.
+struct AssetKey {
+    std::string_view name;
+    uint64_t hash;
+    
+    constexpr AssetKey(std::string_view name) : name(name), hash(hashOf(name)) {}
+    constexpr AssetKey(const char* name) : AssetKey(std::string_view(name)) {}
+    AssetKey(const std::string& name) : AssetKey(std::string_view(name)) {}
+    
+    // FNV-1a, as AssetPack::hashName
+    static constexpr uint64_t hashOf(std::string_view name) {
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : name) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+};
+
+// Interned asset name: an index into one of AssetManager's slot tables. Stays
+// valid for the manager's lifetime whether or not the asset is currently loaded.
+template <typename Asset>
+class AssetHandle {
+public:
+    static constexpr uint32_t INVALID = UINT32_MAX;
+    
+    AssetHandle() = default;
+    bool isValid() const { return index != INVALID; }
+    uint32_t getIndex() const { return index; }
+    bool operator==(const AssetHandle& other) const { return index == other.index; }
+    bool operator!=(const AssetHandle& other) const { return index != other.index; }
+private:
+    friend class AssetManager;
+    explicit AssetHandle(uint32_t index) : index(index) {}
+    uint32_t index = INVALID;
+};
+
+// Textures are resident under a GPU memory budget: each load evicts the least
+// recently used textures that nothing references until the total fits again.
+// Hold a TextureRef for as long as a sprite points at a texture; getTexture()
+// alone only marks it used.
+//
+// Lookups by handle are array indexing and report a missing asset with nullptr.
+// The get*/load* string API throws when an asset is missing or fails to load;
+// find*(name) and the try* loads report it with nullptr/false instead, for
+// callers where a miss is expected (fallback chains, optional assets).
 class AssetManager {
 public:
+    using TextureHandle = AssetHandle<sf::Texture>;
+    using FontHandle = AssetHandle<sf::Font>;
+    using SoundHandle = AssetHandle<sf::SoundBuffer>;
+    
+    enum class TextureCategory : uint8_t { Character, Background, Tile, UI, Other, Count };
+    static const char* toString(TextureCategory category);
+    
+    static constexpr size_t DEFAULT_TEXTURE_BUDGET = 256ull * 1024 * 1024;
+    
+    struct TextureEntry {
+        std::unique_ptr<sf::Texture> texture;
+        std::string source;    // File it was loaded from
+        TextureCategory category = TextureCategory::Other;
+        size_t bytes = 0;      // Estimated GPU size (RGBA8)
+        uint64_t lastUse = 0;  // Ticks of the manager's use clock
+    };
+    
+    // Ref-counted hold on a resident texture; a held texture is never evicted.
+    // Copyable; the entry stays valid even if the manager goes first.
+    class TextureRef {
+    public:
+        TextureRef() = default;
+        explicit operator bool() const { return entry != nullptr; }
+        sf::Texture& get() const { return *entry->texture; }
+        void reset() { entry.reset(); }
+    private:
+        friend class AssetManager;
+        explicit TextureRef(std::shared_ptr<TextureEntry> entry) : entry(std::move(entry)) {}
+        std::shared_ptr<TextureEntry> entry;
+    };
+    
+    struct TextureStats {
+        std::array<size_t, static_cast<size_t>(TextureCategory::Count)> bytes{};
+        std::array<size_t, static_cast<size_t>(TextureCategory::Count)> counts{};
+        size_t residentBytes = 0;
+        size_t referencedBytes = 0; // Pinned by TextureRefs, not evictable
+        size_t evictions = 0;       // Since the manager was created
+    };
+    
+    // Shared state of one async texture request
+    struct TextureRequest {
+        enum class Status { Queued, Decoded, Ready, Failed };
+        
+        std::string name;
+        TextureHandle texture;
+        std::string filename;
+        bool repeated = false;
+        TextureCategory category = TextureCategory::Other;
+        sf::Vector2u coverSize;      // Load-time processing settings at request time
+        std::string cacheDirectory;
+        std::atomic<Status> status{Status::Queued};
+        sf::Image image;    // Filled by a worker; released after upload
+        std::string error;  // Set before status becomes Failed
+    };
+    
+    // Returned by loadTextureAsync. Copyable; check it from the main thread.
+    class TextureLoad {
+    public:
+        TextureLoad() = default;
+        bool isValid() const { return request != nullptr; }
+        bool isReady() const { return request && request->status == TextureRequest::Status::Ready; }
+        bool isFailed() const { return request && request->status == TextureRequest::Status::Failed; }
+        bool isDone() const { return isReady() || isFailed(); }
+        const std::string& getName() const { return request->name; }
+        TextureHandle getTexture() const { return request->texture; }
+        const std::string& getError() const { return request->error; }
+    private:
+        friend class AssetManager;
+        explicit TextureLoad(std::shared_ptr<TextureRequest> request) : request(std::move(request)) {}
+        std::shared_ptr<TextureRequest> request;
+    };
+    
+    // Requests finished out of those issued since the manager was last idle
+    struct LoadProgress {
+        size_t requested = 0;
+        size_t completed = 0; // Uploaded or failed
+        size_t failed = 0;
+        float getFraction() const { return requested ? static_cast<float>(completed) / requested : 1.0f; }
+    };
+    
     AssetManager() = default;
-    ~AssetManager() = default;
+    ~AssetManager();
     
     // Disable copying
     AssetManager(const AssetManager&) = delete;
     AssetManager& operator=(const AssetManager&) = delete;
     
-    // Load a texture from a file
-    void loadTexture(const std::string& name, const std::string& filename);
+    // Load a texture from a file. Reloading a name that is resident keeps the
+    // same sf::Texture object, so sprites pointing at it stay valid.
+    void loadTexture(const std::string& name, const std::string& filename,
+                     TextureCategory category = TextureCategory::Other);
+    // As loadTexture; false with the reason in 'error' instead of throwing
+    bool tryLoadTexture(const std::string& name, const std::string& filename, TextureCategory category,
+                        std::string& error);
     
-    // Get a texture by name
+    // Decodes run on this job system's Streaming lane; without one (tools,
+    // the bench) loadTextureAsync decodes inline. Set before the first load;
+    // 'jobs' must outlive the manager.
+    void setJobSystem(JobSystem* jobs) { jobSystem = jobs; }
+    
+    // Decode on a worker thread; the texture appears under 'name' once
+    // processUploads() has uploaded it on the main thread
+    TextureLoad loadTextureAsync(const std::string& name, const std::string& filename, bool repeated = false,
+                                   TextureCategory category = TextureCategory::Other);
+    
+    // Upload decoded images until the time budget runs out (at least one per call).
+    // Must be called from the thread that owns the GL context. Returns uploads done.
+    size_t processUploads(std::chrono::microseconds budget = std::chrono::microseconds(4000));
+    
+    // Queue an async reload of every resident texture loaded from 'path' (hot
+    // reload); each is swapped in place by processUploads. Returns how many.
+    size_t reloadTextureFile(const std::string& path);
+    
+    // Block until every async request has been decoded and uploaded
+    void finishPendingLoads();
+    
+    bool hasPendingLoads() const;
+    LoadProgress getLoadProgress() const;
+    
+    // Name -> handle, adding the name if it is new. Main thread only, like loading.
+    TextureHandle internTexture(const AssetKey& key);
+    FontHandle internFont(const AssetKey& key);
+    SoundHandle internSound(const AssetKey& key);
+    
+    // nullptr while the asset is not loaded (or was evicted); textures are marked used
+    sf::Texture* findTexture(TextureHandle handle);
+    sf::Font* findFont(FontHandle handle);
+    sf::SoundBuffer* findSoundBuffer(SoundHandle handle);
+    // By name, without interning it
+    sf::Texture* findTexture(const std::string& name);
+    sf::Font* findFont(const std::string& name);
+    sf::SoundBuffer* findSoundBuffer(const std::string& name);
+    bool hasTexture(TextureHandle handle) const;
+    // Empty if the texture is not loaded
+    TextureRef acquireTexture(TextureHandle handle);
+    
+    // Get a texture by name (marks it used)
     sf::Texture& getTexture(const std::string& name);
+    bool hasTexture(const std::string& name) const;
+    // Pin a texture while something draws it; throws like getTexture
+    TextureRef acquireTexture(const std::string& name);
     
-    // Load a font from a file
+    // Load-time processing. Textures of a category with a display size are
+    // resampled when decoded to the smallest size that still covers it (aspect
+    // kept, never enlarged), so they aren't sampled at source resolution every
+    // frame. With a cache directory the resampled images are
+    // also written there, keyed by the source (name, size, mtime) and the
+    // target size, and later loads decode that copy instead. Both apply to
+    // loads requested after the change.
+    void setDisplaySize(TextureCategory category, const sf::Vector2u& size);
+    sf::Vector2u getDisplaySize(TextureCategory category) const {
+        return displaySizes[static_cast<size_t>(category)];
+    }
+    void setProcessedCacheDirectory(const std::string& directory) { processedCacheDirectory = directory; }
+    
+    // Residency budget for the textures owned here; lowering it evicts at once
+    void setTextureBudget(size_t bytes);
+    size_t getTextureBudget() const { return textureBudget; }
+    TextureStats getTextureStats() const;
+    
+    // Fonts are opened once, from the asset pack or a mapping of the file kept
+    // alive with the font (FreeType reads glyphs from it lazily); loading a
+    // name that is resident does nothing. Share them by handle.
     void loadFont(const std::string& name, const std::string& filename);
+    bool tryLoadFont(const std::string& name, const std::string& filename, std::string& error);
+    // The first of 'candidates' that opens; throws if none does
+    FontHandle loadFirstFont(const std::string& name, const std::vector<std::string>& candidates);
+    // Invalid handle and every candidate's error if none opens
+    FontHandle tryLoadFirstFont(const std::string& name, const std::vector<std::string>& candidates,
+                                std::string& error);
+    // Rasterize 'characters' (UTF-8) into the font's glyph page at this size,
+    // filled and, if given, outlined, so text using them doesn't add glyphs
+    // (and texture uploads) mid-frame. Call where the GL context is current.
+    void prewarmGlyphs(FontHandle handle, const std::string& characters, unsigned characterSize,
+                       float outlineThickness = 0.f);
+    static const std::string& getAsciiGlyphs(); // Printable ASCII, for prewarmGlyphs
     
     // Get a font by name
     sf::Font& getFont(const std::string& name);
     
     // Load a sound buffer from a file
     void loadSoundBuffer(const std::string& name, const std::string& filename);
+    bool tryLoadSoundBuffer(const std::string& name, const std::string& filename, std::string& error);
     
     // Get a sound buffer by name
     sf::SoundBuffer& getSoundBuffer(const std::string& name);
     
-    // Clear all resources
+    // Clear all resources (referenced textures stay until their last TextureRef goes)
     void clear();
     
-    // Make containers public for error handling
-    std::unordered_map<std::string, std::unique_ptr<sf::Texture>> textures;
-    
 private:
-    std::unordered_map<std::string, std::unique_ptr<sf::Font>> fonts;
-    std::unordered_map<std::string, std::unique_ptr<sf::SoundBuffer>> soundBuffers;
+    // Interned names and their slots; a slot is empty until loaded and after eviction
+    template <typename Slot>
+    struct SlotTable {
+        static constexpr uint32_t NONE = UINT32_MAX;
+        
+        std::vector<std::string> names;
+        std::vector<Slot> slots;
+        std::unordered_map<uint64_t, uint32_t> ids; // By AssetKey hash
+        
+        uint32_t find(const AssetKey& key) const {
+            auto found = ids.find(key.hash);
+            return found != ids.end() && names[found->second] == key.name ? found->second : NONE;
+        }
+        uint32_t intern(const AssetKey& key) {
+            auto [found, added] = ids.emplace(key.hash, static_cast<uint32_t>(names.size()));
+            if (added) {
+                names.emplace_back(key.name);
+                slots.emplace_back();
+            } else if (names[found->second] != key.name) {
+                throw std::runtime_error("AssetManager - Name hash collision: " + names[found->second] + " / " +
+                                         std::string(key.name));
+            }
+            return found->second;
+        }
+    };
+    
+    struct FontEntry {
+        sf::Font font;
+        MappedFile file;      // Backs 'font' unless it came from the asset pack
+        std::string source;
+    };
+    
+    // An entry's use_count above one means a TextureRef holds it
+    SlotTable<std::shared_ptr<TextureEntry>> textures;
+    SlotTable<std::unique_ptr<FontEntry>> fonts;
+    SlotTable<std::unique_ptr<sf::SoundBuffer>> soundBuffers;
+    size_t textureBudget = DEFAULT_TEXTURE_BUDGET;
+    std::array<sf::Vector2u, static_cast<size_t>(TextureCategory::Count)> displaySizes{};
+    std::string processedCacheDirectory;
+    uint64_t useClock = 0;
+    size_t evictionCount = 0;
+    
+    void storeTexture(TextureHandle handle, std::unique_ptr<sf::Texture> texture, const std::string& source,
+                      TextureCategory category);
+    void enforceTextureBudget(const TextureEntry* keep);
+    
+    // Async decode pipeline: a job per request turns it into an image, the main
+    // thread uploads them from 'decodedRequests' in processUploads()
+    void decodeRequest(std::shared_ptr<TextureRequest> request);
+    void uploadRequest(TextureRequest& request);
+    static bool decodeImage(const std::string& filename, sf::Image& image, std::string& error);
+    // decodeImage plus the load-time processing above; 'coverSize' 0x0 for none
+    static bool decodeProcessed(const std::string& filename, const sf::Vector2u& coverSize,
+                                const std::string& cacheDirectory, sf::Image& image, std::string& error);
+    
+    JobSystem* jobSystem = nullptr;
+    mutable std::mutex loadMutex;
+    std::condition_variable decodedCondition; // finishPendingLoads and the destructor wait for decodes
+    std::deque<std::shared_ptr<TextureRequest>> decodedRequests;
+    size_t pendingRequests = 0; // Queued, decoding or awaiting upload
+    size_t runningDecodes = 0;  // Jobs submitted and not yet finished
+    LoadProgress progress;
+    bool stopWorkers = false;
 }; 
\ No newline at end of file
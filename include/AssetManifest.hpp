@@ -0,0 +1,55 @@
+#pragma once
+#include "AssetPack.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Every file under assets/ as of the last build, generated by the asset_manifest
+// tool into AssetManifestData.hpp in the build tree. Files go by the names the
+// game and the pack already use ("assets/images/characters/player.png"); an
+// asset's ID is the FNV-1a hash of that name (the pack's hash), so the ID of a
+// literal path is a compile-time constant.
+//
+// Lookups go through an open-addressed table the generator fills at most half
+// full: one hash, usually one probe and no filesystem access. The directory
+// holding the files is found once at startup (resolveRoot); resolve() turns a
+// listed name into the path to open. A file added since the last build isn't
+// listed until the next build regenerates the manifest.
+namespace AssetManifest {
+
+struct Entry {
+    std::string_view path;
+    uint64_t id;
+    uint64_t size;
+    AssetPack::Format format;
+    uint32_t width;     // Images only, read from the file header; 0 otherwise
+    uint32_t height;
+};
+
+constexpr std::string_view PREFIX = "assets/";
+
+constexpr uint64_t idOf(std::string_view path) {
+    // FNV-1a, as AssetPack::hashName
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : path) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// 'path' as listed (normalized, "assets/..."); nullptr if it isn't
+const Entry* find(std::string_view path);
+inline bool contains(std::string_view path) { return find(path) != nullptr; }
+size_t getEntryCount();
+
+// Picks the directory the listed files are in: the working directory's
+// assets/, one or two levels up (build trees), then the source tree's. With a
+// pack mounted the names are looked up as they are. False if none holds them.
+bool resolveRoot();
+const std::string& getRoot(); // "assets" until resolved
+// The file to open for a listed name
+std::string resolve(std::string_view path);
+
+} // namespace AssetManifest
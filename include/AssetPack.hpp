@@ -0,0 +1,129 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "MappedFile.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Read-only archive of the assets folder, memory-mapped at startup.
+//
+// Layout (little-endian): FileHeader, FileEntry[entryCount] sorted by nameHash,
+// BundleEntry[bundleCount] sorted by level, the bundles' file lists (uint32
+// entry indices, bundleFileCount in all), a string table with every entry's
+// name, then the file payloads. Names are the paths the game already uses
+// ("assets/images/tiles/tile_01.png"), so callers look files up by the same
+// string and fall back to loose files when the pack is missing or doesn't
+// contain them. Build it with the asset_pack target.
+//
+// Payloads are laid out for the level bundles (see LevelBundle.hpp): the files
+// no level names first, then those several levels share, then each level's
+// own files back to back, so a bundle's range is one sequential read.
+class AssetPack {
+public:
+    // RawImage: an image asset_packer decoded ahead of time (ImageCodec's raw payload)
+    enum class Format : uint16_t { Unknown, Png, Jpeg, Wav, Font, Ogg, Flac, Json, RawImage };
+
+    // A file inside the mapping; valid while the pack stays mounted
+    struct Blob {
+        const char* data = nullptr;
+        size_t size = 0;
+        Format format = Format::Unknown;
+        explicit operator bool() const { return data != nullptr; }
+    };
+
+    static constexpr char MAGIC[4] = {'A', 'P', 'A', 'K'};
+    static constexpr uint32_t VERSION = 3;
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t stringTableSize;
+        uint32_t bundleCount;
+        uint32_t bundleFileCount;
+    };
+
+    struct FileEntry {
+        uint64_t nameHash;
+        uint64_t offset;     // From the start of the file
+        uint64_t size;
+        uint32_t nameOffset; // Into the string table
+        uint16_t nameLength;
+        uint16_t format;
+    };
+
+    struct BundleEntry {
+        uint32_t level;
+        uint32_t firstFile;  // Into the bundle file lists
+        uint32_t fileCount;  // Every file the level needs, shared ones included
+        uint32_t reserved;
+        uint64_t offset;     // The level's own files, contiguous
+        uint64_t size;
+    };
+
+    // One level's bundle; valid while the pack stays mounted
+    struct Bundle {
+        int level = 0;
+        uint64_t offset = 0;            // Range holding the files only this level uses
+        uint64_t size = 0;
+        const uint32_t* files = nullptr; // Entry indices (getFile), sorted by offset
+        size_t fileCount = 0;
+        explicit operator bool() const { return files != nullptr; }
+    };
+
+    // An entry by index, for the bundle file lists
+    struct FileRange {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    // Process-wide pack used by the loaders
+    static AssetPack& instance();
+
+    bool mount(const std::string& path);
+    void unmount();
+    bool isMounted() const { return mapping.isOpen(); }
+    size_t getEntryCount() const { return entryCount; }
+    const std::string& getPath() const { return mountedPath; }
+
+    Blob find(const std::string& name) const;
+
+    size_t getBundleCount() const { return bundleCount; }
+    Bundle findBundle(int level) const; // Empty if the pack has none for it
+    FileRange getFile(uint32_t index) const;
+    std::string_view getFileName(uint32_t index) const;
+    // Paging hints for a range of the pack (MappedFile::willNeed / dontNeed)
+    void willNeed(uint64_t offset, uint64_t size) const { mapping.willNeed(offset, size); }
+    void dontNeed(uint64_t offset, uint64_t size) const { mapping.dontNeed(offset, size); }
+    const char* getData() const { return base; }
+
+    // Names of the files directly inside 'directory', sorted
+    std::vector<std::string> listDirectory(const std::string& directory) const;
+    bool hasDirectory(const std::string& directory) const;
+
+    // Shared with the packer so both sides agree on names and hashes
+    static std::string normalizeName(const std::string& path);
+    static uint64_t hashName(std::string_view name);
+    static Format formatFromExtension(const std::string& path);
+
+    ~AssetPack();
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+private:
+    AssetPack() = default;
+
+    std::string_view entryName(const FileEntry& entry) const;
+
+    MappedFile mapping;
+    const char* base = nullptr; // mapping.data()
+    size_t mappedSize = 0;
+    const FileEntry* entries = nullptr;
+    size_t entryCount = 0;
+    const BundleEntry* bundles = nullptr;
+    size_t bundleCount = 0;
+    const uint32_t* bundleFiles = nullptr;
+    const char* stringTable = nullptr;
+    std::string mountedPath;
+};
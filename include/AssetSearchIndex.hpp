@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Filtering and sorting for the Asset Manager's list, so neither costs a pass
+// over the names, let alone a sort, per frame. Names are indexed by trigram as
+// they're added: a query of three or more characters only checks the entries
+// holding its rarest trigram, a shorter one scans the pre-lowered names. Each
+// sort key's permutation is built once per batch of additions and read in
+// either direction. The view is rebuilt only when the query, the order or the
+// entries change, by walking one permutation.
+class AssetSearchIndex {
+public:
+    enum class SortKey { Name, Size, Dimensions, Count };
+
+    void clear();
+    // Entries are numbered in the order they're added; directories sort ahead
+    // of files by name
+    void add(const std::string& name, bool isDirectory, uint64_t size, uint64_t pixels);
+
+    void setQuery(const std::string& query); // Case-insensitive substring; empty matches everything
+    void setSort(SortKey key, bool ascending);
+
+    // The entries matching the query, in sort order
+    const std::vector<uint32_t>& getView();
+    size_t size() const { return names.size(); }
+
+private:
+    const std::vector<uint32_t>& getOrder(SortKey key);
+    void match();
+
+    std::vector<std::string> names;       // Lowered
+    std::vector<uint8_t> directories;
+    std::vector<uint64_t> sizes;
+    std::vector<uint64_t> pixels;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> trigrams; // Ascending entries per trigram
+
+    std::string query;                    // Lowered
+    std::vector<uint8_t> matches;         // Per entry, for the current query
+    std::vector<uint32_t> orders[static_cast<size_t>(SortKey::Count)];
+    bool orderValid[static_cast<size_t>(SortKey::Count)] = {};
+    SortKey sortKey = SortKey::Name;
+    bool ascending = true;
+    std::vector<uint32_t> view;
+    bool matchesDirty = true;
+    bool viewDirty = true;
+};
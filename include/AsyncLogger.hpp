@@ -0,0 +1,168 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "LogFormat.hpp"
+
+// Game's and RenderingSystem's logs go to binary files for tools/LogDecode.cpp
+// with -DGAME_BINARY_LOG=ON
+#ifndef GAME_BINARY_LOG
+#define GAME_BINARY_LOG 0
+#endif
+
+// Shared file logger for Game and RenderingSystem.
+// Producers copy the message into a fixed-size slot of a bounded lock-free MPSC
+// ring buffer together with a raw steady_clock tick. A background thread drains
+// the ring, formats timestamps and writes each file in batches. When the ring is
+// full the record is dropped and counted; the caller never waits on disk I/O.
+//
+// Format-string records (LOG_FORMAT) skip building the message altogether: the
+// slot gets the call site's format id and the raw arguments, and the text is
+// made by the drain thread, or for a binary sink not at all (logdecode makes it
+// when the file is read; see LogFormat.hpp for the file layout).
+class AsyncLogger {
+public:
+    enum class Level : uint8_t { Debug, Info, Warning, Error };
+    enum class SinkFormat : uint8_t { Text, Binary };
+    using SinkId = uint8_t;
+    using FormatId = uint32_t;
+
+    static constexpr size_t MAX_FORMATS = 2048; // Call sites; later ones log "{format table full}"
+
+    static AsyncLogger& instance();
+
+    // Register an output file (appends). Call at init time; opening is synchronous.
+    SinkId openSink(const std::string& path, SinkFormat format = SinkFormat::Text);
+
+    // Queue a record. Returns false if it was dropped because the ring was full.
+    bool log(SinkId sink, Level level, std::string_view message);
+
+    // 'format' ("{}" per argument) must outlive the logger: a string literal.
+    // Each call registers a new id, so call once per site (LOG_FORMAT does).
+    FormatId registerFormat(const char* format);
+
+    // Queue a format-string record: integers, floats, bools and strings are
+    // copied as they are, nothing is formatted. Returns false if dropped.
+    template <typename... Args>
+    bool logFormat(SinkId sink, Level level, FormatId format, const Args&... args);
+
+    // Queue a request to truncate the file; ordered with the surrounding records
+    bool truncate(SinkId sink);
+
+    // Block until everything queued so far has been written (shutdown, tests)
+    void flush();
+
+    uint64_t getDroppedCount() const { return droppedCount.load(std::memory_order_relaxed); }
+    uint64_t getWrittenCount() const { return writtenCount.load(std::memory_order_relaxed); }
+
+    ~AsyncLogger();
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+private:
+    AsyncLogger();
+
+    static constexpr size_t RING_CAPACITY = 4096; // Power of two
+    static constexpr size_t MESSAGE_CAPACITY = 224; // Keeps a slot at 256 bytes
+    static constexpr auto IDLE_WAIT = std::chrono::milliseconds(10);
+
+    enum class Command : uint8_t { Write, WriteFormatted, Truncate };
+
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        std::chrono::steady_clock::rep tick = 0;
+        FormatId format = 0;    // WriteFormatted
+        uint16_t length = 0;
+        SinkId sink = 0;
+        Level level = Level::Info;
+        Command command = Command::Write;
+        bool truncated = false; // WriteFormatted: arguments were cut to fit
+        std::array<char, MESSAGE_CAPACITY> text{}; // The message, or the packed arguments
+    };
+
+    struct Sink {
+        std::string path;
+        SinkFormat format = SinkFormat::Text;
+        std::ofstream file;
+        std::string buffer; // Formatted lines (or binary records) waiting for the next batched write
+        std::vector<bool> formatsWritten; // Binary: format ids already in this session of the file
+    };
+
+    // Reserves the next slot and fills in its header; nullptr (counted) when the ring is full.
+    // The record is published by storing pos + 1 into its sequence.
+    Slot* claim(SinkId sink, Level level, Command command, size_t& pos);
+    bool push(SinkId sink, Level level, Command command, std::string_view message);
+    bool pop(Slot& out);
+    void drainLoop();
+    size_t drainBatch();
+    void formatTimestamp(std::chrono::steady_clock::rep tick, std::string& out);
+    int64_t toWallNs(std::chrono::steady_clock::rep tick) const;
+    void writeSession(Sink& sink);
+    void writeBinaryRecord(Sink& sink, const Slot& record);
+    const char* getFormat(FormatId format) const;
+
+    std::unique_ptr<Slot[]> ring;
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) std::atomic<size_t> dequeuePos{0};
+
+    std::atomic<uint64_t> droppedCount{0};
+    std::atomic<uint64_t> writtenCount{0};
+
+    // Sinks are only added at init; the drain thread holds this while writing
+    std::mutex sinkMutex;
+    std::vector<std::unique_ptr<Sink>> sinks;
+
+    // Registered format literals, indexed by id. A record's id was registered
+    // before the record was queued, so the drain thread reads without the lock.
+    std::mutex formatMutex;
+    std::array<const char*, MAX_FORMATS> formats{};
+    FormatId formatCount = 0;
+
+    // Wall clock anchor so timestamps can be rebuilt from steady ticks off-thread
+    std::chrono::system_clock::time_point wallAnchor;
+    std::chrono::steady_clock::time_point steadyAnchor;
+    std::time_t cachedSecond = -1;
+    std::string cachedSecondText;
+
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable drainedCondition;
+    bool stopping = false;
+    std::thread drainThread;
+};
+
+template <typename... Args>
+bool AsyncLogger::logFormat(SinkId sink, Level level, FormatId format, const Args&... args) {
+    size_t pos = 0;
+    Slot* slot = claim(sink, level, Command::WriteFormatted, pos);
+    if (!slot) {
+        return false;
+    }
+    slot->format = format;
+    LogFormat::Encoder encoder(slot->text.data(), MESSAGE_CAPACITY);
+    (LogFormat::encode(encoder, args), ...);
+    slot->length = static_cast<uint16_t>(encoder.getSize());
+    slot->truncated = encoder.isTruncated();
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+// LOG_FORMAT(sink, Info, "Loaded {} platforms in {} ms", count, ms): registers
+// the literal the first time the line runs, then queues its id and the
+// arguments. Takes at least one argument; plain messages go through log().
+#define LOG_FORMAT(sink, level, format, ...) \
+    do { \
+        static const AsyncLogger::FormatId logFormatId = AsyncLogger::instance().registerFormat(format); \
+        AsyncLogger::instance().logFormat(sink, AsyncLogger::Level::level, logFormatId, __VA_ARGS__); \
+    } while (0)
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+
+// What a body or broadphase proxy is, as one bit of a mask. Each carries its
+// own layer and a mask of the layers it interacts with; a pair is considered
+// only when each side's mask has the other's layer, so pairs that can never
+// interact are dropped in the broadphase, before any narrowphase test.
+enum class CollisionLayer : uint8_t {
+    Player,
+    Enemy,
+    NPC,
+    Solid,      // Platforms
+    OneWay,     // Platforms passed through from below
+    Trigger,    // Zones that only report the player entering them
+    Decoration  // Scenery (trees, cabin, snowman): takes part in nothing
+};
+
+using CollisionMask = uint8_t;
+
+constexpr CollisionMask collisionBit(CollisionLayer layer) {
+    return static_cast<CollisionMask>(1u << static_cast<unsigned>(layer));
+}
+
+constexpr CollisionMask COLLIDE_NOTHING = 0;
+constexpr CollisionMask COLLIDE_TERRAIN = collisionBit(CollisionLayer::Solid) | collisionBit(CollisionLayer::OneWay);
+
+// The pairs the game handles: the player against everything but scenery, and
+// enemies and NPCs against the player and the terrain (not each other)
+constexpr CollisionMask defaultCollisionMask(CollisionLayer layer) {
+    switch (layer) {
+        case CollisionLayer::Player:
+            return collisionBit(CollisionLayer::Enemy) | collisionBit(CollisionLayer::NPC) | COLLIDE_TERRAIN |
+                   collisionBit(CollisionLayer::Trigger);
+        case CollisionLayer::Enemy:
+        case CollisionLayer::NPC:
+            return collisionBit(CollisionLayer::Player) | COLLIDE_TERRAIN;
+        case CollisionLayer::Solid:
+        case CollisionLayer::OneWay:
+            return collisionBit(CollisionLayer::Player) | collisionBit(CollisionLayer::Enemy) |
+                   collisionBit(CollisionLayer::NPC);
+        case CollisionLayer::Trigger:
+            return collisionBit(CollisionLayer::Player);
+        default:
+            return COLLIDE_NOTHING;
+    }
+}
+
+// The pair filter: both sides have to accept the other
+constexpr bool canCollide(CollisionLayer a, CollisionMask maskA, CollisionLayer b, CollisionMask maskB) {
+    return (maskA & collisionBit(b)) != 0 && (maskB & collisionBit(a)) != 0;
+}
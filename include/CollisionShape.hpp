@@ -0,0 +1,57 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+
+// Collision box of a body archetype (the player, enemies, NPCs) relative to
+// its sprite, in fractions of the sprite size. Bodies don't work the box out
+// every step: a ShapeCache holds the local box derived for one sprite size,
+// and placing a body is that box plus the sprite's position. Changing the
+// shape bumps 'version', so each cache derives its box again once, on its
+// next use.
+struct CollisionShape {
+    sf::Vector2f scale{1.f, 1.f};  // Box size over sprite size
+    sf::Vector2f offset{0.f, 0.f}; // Box top-left from the sprite's, over sprite size
+    bool centered = false;         // Centre the box on the sprite; 'offset' is ignored
+    uint32_t version = 1;
+
+    void setScale(float x, float y) {
+        if (scale.x != x || scale.y != y) {
+            scale = sf::Vector2f(x, y);
+            version++;
+        }
+    }
+    void setOffset(float x, float y) {
+        if (offset.x != x || offset.y != y) {
+            offset = sf::Vector2f(x, y);
+            version++;
+        }
+    }
+
+    sf::FloatRect getLocalBox(const sf::Vector2f& spriteSize) const {
+        const sf::Vector2f size(spriteSize.x * scale.x, spriteSize.y * scale.y);
+        const sf::Vector2f position = centered ? (spriteSize - size) / 2.f
+                                               : sf::Vector2f(spriteSize.x * offset.x, spriteSize.y * offset.y);
+        return sf::FloatRect(position, size);
+    }
+};
+
+// A shape's box for one sprite size (one body, or every body of an enemy type)
+struct ShapeCache {
+    uint32_t version = 0; // Of the shape it was derived from; 0 = not yet
+    sf::Vector2f spriteSize;
+    sf::FloatRect localBox;
+
+    // Derives the box again if the shape changed or the sprite resized; true if it did
+    bool update(const CollisionShape& shape, const sf::Vector2f& size) {
+        if (version == shape.version && spriteSize == size) {
+            return false;
+        }
+        version = shape.version;
+        spriteSize = size;
+        localBox = shape.getLocalBox(size);
+        return true;
+    }
+    sf::FloatRect at(const sf::Vector2f& spritePosition) const {
+        return sf::FloatRect(spritePosition + localBox.position, localBox.size);
+    }
+};
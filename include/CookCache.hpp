@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+// The record of what asset_cooker has built into its cache directory, read
+// back by asset_packer to take cooked payloads instead of cooking again.
+//
+// Each output is keyed by its source's pack name ("assets/images/...") and
+// remembers the source's size, mtime and content hash, and the version of the
+// cook that built it. An output is current while its source still has the
+// recorded size and mtime and the cook version is unchanged; a source that
+// was only touched hashes the same and keeps its output.
+//
+// File layout (little-endian): FileHeader, then per entry a FileEntry
+// followed by its name (nameLength bytes, no terminator).
+class CookCache {
+public:
+    struct Entry {
+        uint64_t sourceSize = 0;
+        int64_t sourceTime = 0;  // file_time_type ticks
+        uint64_t sourceHash = 0; // FNV-1a of the contents
+        uint64_t outputSize = 0;
+        uint32_t cookVersion = 0;
+    };
+
+    static constexpr char MAGIC[4] = {'C', 'O', 'O', 'K'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr const char* DATABASE_NAME = "cook.db";
+    // Bump when ImageCodec::encodeRaw's output changes
+    static constexpr uint32_t RAW_IMAGE_VERSION = 1;
+    // Bump when the TileLayout split changes; its outputs sit next to the source
+    static constexpr uint32_t TILE_SPLIT_VERSION = 1;
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t entryCount;
+    };
+
+    struct FileEntry {
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        uint64_t sourceHash;
+        uint64_t outputSize;
+        uint32_t cookVersion;
+        uint32_t nameLength;
+    };
+
+    explicit CookCache(std::string directory) : directory(std::move(directory)) {}
+
+    // False when there's no database yet or it's from another version; it starts empty then
+    bool load();
+    bool save(std::string& error) const;
+
+    const Entry* find(const std::string& name) const;
+    void set(const std::string& name, const Entry& entry) { entries[name] = entry; }
+    void erase(const std::string& name) { entries.erase(name); }
+    const std::unordered_map<std::string, Entry>& getEntries() const { return entries; }
+
+    // Where the output cooked from 'name' lives
+    std::string getOutputPath(const std::string& name) const;
+    // Whether that output was cooked by 'cookVersion' from a source of this size and mtime
+    bool isCurrent(const std::string& name, uint64_t sourceSize, int64_t sourceTime, uint32_t cookVersion) const;
+
+private:
+    std::string directory;
+    std::unordered_map<std::string, Entry> entries;
+};
@@ -0,0 +1,113 @@
+#pragma once
+#include <cstdint>
+
+// Binary level format written by the level_cooker tool and read in place by
+// LevelLoader. Little-endian, no pointers: a Header followed by flat record
+// arrays (each 16-byte aligned) and a string table. Every offset is from the
+// start of the file, so the loader reads records straight out of a mapping.
+namespace CookedLevel {
+
+constexpr char MAGIC[4] = {'L', 'V', 'L', 'B'};
+constexpr uint32_t VERSION = 8;
+constexpr uint32_t ALIGNMENT = 16;
+
+struct ArrayRef {
+    uint32_t offset = 0;
+    uint32_t count = 0;
+};
+
+struct StringRef {
+    uint32_t offset = 0; // Into the string table
+    uint32_t length = 0;
+};
+
+struct PlatformRecord {
+    float x, y, width, height;
+    uint8_t slope; // LevelData::Slope
+    uint8_t padding[3];
+};
+
+struct LadderRecord {
+    float x, y, width, height;
+};
+
+struct DecorationRecord {
+    float x, y, height;
+    uint8_t kind; // LevelData::DecorationKind
+    uint8_t padding[3];
+};
+
+struct DecorationQuadRecord {
+    float x, y, width, height;
+    uint8_t kind;  // LevelData::DecorationKind
+    uint8_t part;  // LevelData::DecorationPart
+    uint8_t depth;
+    uint8_t padding;
+};
+
+struct EnemyTypeRecord {
+    StringRef name;
+    float width, height;
+    float speed, gravity, patrolWidth;
+    uint8_t color[4];
+};
+
+struct EnemyRecord {
+    float x, y, patrolWidth;
+    uint16_t type; // Index into the enemy types
+    uint8_t padding[2];
+};
+
+struct NpcRecord {
+    StringRef id;
+    StringRef texture;
+    float x, y;
+};
+
+struct TriggerRecord {
+    StringRef id;
+    float x, y, width, height;
+    uint8_t action;   // LevelData::TriggerAction
+    uint8_t grounded;
+    uint8_t padding[2];
+};
+
+struct LightRecord {
+    float x, y, radius;
+    uint8_t color[4];
+};
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    float width, height;
+    float tileSize;
+    float spawn[2];
+    float entryLeft[2];
+    float entryRight[2];
+    uint8_t platformColor[4];
+    float gravity;
+    float jumpForce;
+    float enemySpeed;
+    StringRef name;
+    StringRef background;
+    ArrayRef backgroundFallbacks; // StringRef[]
+    StringRef music;
+    StringRef colorGrade;
+    uint8_t gradeTint[4];
+    float dayLength;
+    uint8_t ambientLight[4];
+    ArrayRef platforms;
+    ArrayRef ladders;
+    ArrayRef decorations;
+    ArrayRef decorationQuads;
+    ArrayRef enemyTypes;
+    ArrayRef enemies;
+    ArrayRef npcs;
+    ArrayRef triggers;
+    ArrayRef lights;
+    uint32_t stringTableOffset;
+    uint32_t stringTableSize;
+};
+
+} // namespace CookedLevel
@@ -0,0 +1,64 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "RenderStats.hpp"
+#include <cstdint>
+#include <vector>
+
+class RenderSnapshot;
+class RenderQueue;
+enum class RenderLayer : uint8_t;
+
+// Draws crowds of characters (enemies, NPCs) as axis-aligned quads: every quad
+// added between begin() and end() goes into its page's vertex array, and each
+// (page, category) is one draw call. Callers pass world rects and texture
+// rects directly, so no sf::Sprite is built per character; facing left is a
+// swap of the U coordinates rather than a negative scale. A null page draws
+// untextured, vertex-coloured quads.
+//
+// With split screen each quad also carries the mask of views that see it
+// (ViewCulling::ViewSet), and pages are kept per mask, so the crowd is built
+// once and every view records only the pages it sees.
+class CrowdRenderer {
+public:
+    struct Stats {
+        size_t characters = 0;
+        size_t drawCalls = 0;   // One per non-empty (page, category)
+        size_t vertices = 0;
+    };
+
+    static constexpr uint8_t ALL_VIEWS = 0xFF;
+
+    void begin();
+    // 'bounds' is the world rect; 'textureRect' follows sf::Sprite (negative sizes flip)
+    void add(const sf::Texture* page, RenderCategory category, const sf::FloatRect& bounds,
+             const sf::IntRect& textureRect, bool flipX, const sf::Color& color = sf::Color::White,
+             uint8_t views = 1);
+    void end(sf::RenderTarget& target, RenderStats& renderStats);
+    // Records the pages seen by any of 'views' instead of drawing them; split
+    // screen calls it once per view, after that view's setView
+    void end(RenderSnapshot& snapshot, uint8_t views = ALL_VIEWS);
+    // Queues every page in 'layer', each with the views that see it
+    void end(RenderQueue& queue, RenderLayer layer);
+    bool isActive() const { return active; }
+
+    // Totals for the frame in progress; endFrame() moves them to getLastFrameStats()
+    void endFrame();
+    const Stats& getFrameStats() const { return frameStats; }
+    const Stats& getLastFrameStats() const { return lastFrameStats; }
+
+private:
+    struct Page {
+        const sf::Texture* texture;
+        RenderCategory category;
+        uint8_t views;
+        std::vector<sf::Vertex> vertices; // Triangles; capacity kept across frames
+    };
+
+    Page& findPage(const sf::Texture* texture, RenderCategory category, uint8_t views);
+
+    bool active = false;
+    std::vector<Page> pages;
+    size_t lastPage = 0; // Consecutive adds usually hit the same page
+    Stats frameStats;
+    Stats lastFrameStats;
+};
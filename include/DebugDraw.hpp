@@ -0,0 +1,53 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "RenderStats.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class RenderSnapshot;
+class RenderQueue;
+enum class RenderLayer : uint8_t;
+
+// Immediate-mode debug geometry. Lines, rects and circles recorded during a
+// frame go into one triangle list (lines become thin quads) and flush() draws
+// it with a single call, so outlining thousands of boxes costs one draw
+// instead of several per sf::RectangleShape. Coordinates are in whatever view
+// is active when flush() is called.
+class DebugDraw {
+public:
+    struct Stats {
+        size_t primitives = 0; // Lines, rects and circles recorded
+        size_t vertices = 0;
+    };
+
+    void line(const sf::Vector2f& from, const sf::Vector2f& to, const sf::Color& color, float thickness = 1.f);
+
+    // Outline drawn inside the rect, like a shape's negative outline thickness
+    void rect(const sf::FloatRect& bounds, const sf::Color& fill, const sf::Color& outline, float thickness = 1.f);
+    void rectOutline(const sf::FloatRect& bounds, const sf::Color& outline, float thickness = 1.f);
+
+    void circle(const sf::Vector2f& center, float radius, const sf::Color& fill, const sf::Color& outline,
+                float thickness = 1.f, unsigned segments = 16);
+
+    bool isEmpty() const { return vertices.empty(); }
+
+    // Draws everything recorded since the last flush in one call, then clears
+    // (the buffer keeps its capacity)
+    void flush(sf::RenderTarget& target, RenderStats& renderStats, RenderCategory category = RenderCategory::Debug);
+    void flush(RenderSnapshot& snapshot, RenderCategory category = RenderCategory::Debug);
+    void flush(RenderQueue& queue, RenderLayer layer, RenderCategory category = RenderCategory::Debug);
+    void clear();
+
+    // Totals of the last flush
+    const Stats& getLastFlushStats() const { return lastFlushStats; }
+
+private:
+    void quad(const sf::Vector2f& a, const sf::Vector2f& b, const sf::Vector2f& c, const sf::Vector2f& d,
+              const sf::Color& color);
+    void outlineQuads(const sf::FloatRect& bounds, const sf::Color& outline, float thickness);
+
+    std::vector<sf::Vertex> vertices; // Triangles
+    size_t primitives = 0;
+    Stats lastFlushStats;
+};
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+
+// Lightweight diagnostics for hot paths (per-frame physics, animation, player state).
+// Two filters:
+//   - GAME_LOG_LEVEL is fixed at compile time. Anything above it expands to nothing,
+//     so release builds pay no cost for trace output.
+//   - A runtime category mask picks which subsystems actually print (toggled from the
+//     ImGui Debug tab). Everything is off by default.
+// Output goes to stdout with '\n' rather than std::endl, so nothing is flushed per line.
+
+#define GAME_LOG_LEVEL_NONE  0
+#define GAME_LOG_LEVEL_ERROR 1
+#define GAME_LOG_LEVEL_WARN  2
+#define GAME_LOG_LEVEL_INFO  3
+#define GAME_LOG_LEVEL_TRACE 4
+
+#ifndef GAME_LOG_LEVEL
+#ifdef NDEBUG
+#define GAME_LOG_LEVEL GAME_LOG_LEVEL_INFO
+#else
+#define GAME_LOG_LEVEL GAME_LOG_LEVEL_TRACE
+#endif
+#endif
+
+namespace DebugLog {
+
+enum Category : uint32_t {
+    Physics   = 1u << 0,
+    Animation = 1u << 1,
+    Player    = 1u << 2,
+    All       = 0xFFFFFFFFu
+};
+
+inline uint32_t categoryMask = 0;
+
+inline bool isEnabled(Category category) { return (categoryMask & category) != 0; }
+
+inline void setEnabled(Category category, bool enabled) {
+    if (enabled) {
+        categoryMask |= category;
+    } else {
+        categoryMask &= ~static_cast<uint32_t>(category);
+    }
+}
+
+} // namespace DebugLog
+
+// True when trace output for the category is compiled in and switched on
+#if GAME_LOG_LEVEL >= GAME_LOG_LEVEL_TRACE
+#define GAME_TRACE_ENABLED(category) DebugLog::isEnabled(DebugLog::category)
+#else
+#define GAME_TRACE_ENABLED(category) false
+#endif
+
+// Usage: GAME_TRACE(Physics, "velocity: " << v.y);
+// The stream expression is not evaluated unless the category is enabled.
+#if GAME_LOG_LEVEL >= GAME_LOG_LEVEL_TRACE
+#define GAME_TRACE(category, message) \
+    do { \
+        if (DebugLog::isEnabled(DebugLog::category)) { \
+            std::cout << message << '\n'; \
+        } \
+    } while (0)
+#else
+#define GAME_TRACE(category, message) do { } while (0)
+#endif
@@ -0,0 +1,121 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+#include "CrowdRenderer.hpp"
+#include "LevelGeometry.hpp"
+#include "LevelLoader.hpp"
+#include "ViewCulling.hpp"
+
+class SimSnapshot;
+
+// Structure-of-arrays storage for every enemy. Enemies are dense indices
+// 0..size()-1; PhysicsSystem's enemy bodies and the entity broadphase use the
+// same indices. The patrol step is one branch-free loop over the contiguous
+// position/velocity/patrol arrays, so the compiler can vectorize it; the
+// platform edge check that needs the level runs as a second, scalar pass.
+// Nothing here is a transformable: vertices are built at draw time. These
+// arrays are also the enemies' physics state: PhysicsSystem sweeps them in
+// place rather than mirroring them in bodies of its own.
+class EnemyStore {
+public:
+    size_t size() const { return posX.size(); }
+    size_t capacity() const { return posX.capacity(); } // clear() keeps it, so respawning a level reuses it
+    bool empty() const { return posX.empty(); }
+    void clear();
+    void reserve(size_t count);
+
+    // Appends an enemy of 'type' (typeIndex into the level's enemyTypes)
+    // patrolling right from 'position'; speed is scaled by 'speedScale'
+    uint32_t spawn(const LevelData::EnemyType& type, uint16_t typeIndex, const sf::Vector2f& position,
+                   float patrolWidth, float speedScale = 1.0f);
+    // Copy one enemy between stores (LevelStreamer parks and restores them)
+    void append(const EnemyStore& from, size_t fromIndex);
+    void assign(size_t index, const EnemyStore& from, size_t fromIndex);
+
+    // Patrol and move [begin, end); PhysicsSystem then resolves the moves
+    // against the level. 'platforms' is only read for the edge check. Enemies
+    // with 'awake' cleared are left untouched.
+    void update(size_t begin, size_t end, float deltaTime, const LevelGeometry& platforms);
+    void storePreviousState();
+
+    sf::Vector2f getPosition(size_t i) const { return sf::Vector2f(posX[i], posY[i]); }
+    void setPosition(size_t i, const sf::Vector2f& position) { posX[i] = position.x; posY[i] = position.y; }
+    sf::Vector2f getSize(size_t i) const { return sf::Vector2f(width[i], height[i]); }
+    sf::FloatRect getBounds(size_t i) const { return sf::FloatRect(getPosition(i), getSize(i)); }
+    sf::Vector2f getVelocity(size_t i) const { return sf::Vector2f(velX[i], velY[i]); }
+    void setVelocity(size_t i, const sf::Vector2f& velocity) { velX[i] = velocity.x; velY[i] = velocity.y; }
+
+    // Collision results, set by PhysicsSystem after it sweeps this step's move
+    sf::Vector2f getStepStart(size_t i) const { return sf::Vector2f(stepStartX[i], stepStartY[i]); }
+    void markStepResolved(size_t i) { stepStartX[i] = posX[i]; stepStartY[i] = posY[i]; }
+    bool isOnGround(size_t i) const { return onGround[i] != 0; }
+    void setOnGround(size_t i, bool grounded) { onGround[i] = grounded ? 1 : 0; }
+    void turnAround(size_t i, int wall); // Walked into a wall on that side (-1 left, 1 right)
+    void setAwake(size_t i, bool isAwake) { awake[i] = isAwake ? 1 : 0; }
+
+    // Activation regions (PhysicsSystem::updateRegions). A coarse enemy is
+    // out of the simulation: no patrol step, sweep or sleeping, and 'awake'
+    // stays cleared. Its patrol goes on as a function of the clock instead,
+    // back and forth over [left, left + range] (its patrol, cut to the floor it
+    // stood on), and promote() puts it where that patrol has got to. posX/posY
+    // keep where it was demoted until then.
+    void advanceClock(float deltaTime) { clock += static_cast<double>(deltaTime) * TUNED_STEP_RATE; }
+    void demote(size_t i, float left, float range);
+    void promote(size_t i);
+    bool isCoarse(size_t i) const { return coarse[i] != 0; }
+    sf::Vector2f getCoarsePosition(size_t i) const;
+    // Where it is now, coarse or not (the mini-map)
+    sf::Vector2f getCurrentPosition(size_t i) const { return coarse[i] ? getCoarsePosition(i) : getPosition(i); }
+
+    // Render interpolation between the previous and current simulation step
+    sf::Vector2f getRenderPosition(size_t i, float alpha) const {
+        return sf::Vector2f(prevX[i] + (posX[i] - prevX[i]) * alpha, prevY[i] + (posY[i] - prevY[i]) * alpha);
+    }
+    // Adds a solid quad per enemy some view sees to the crowd, tagged with those views; returns how many
+    size_t addToCrowd(CrowdRenderer& crowd, const ViewCulling::ViewSet& views, float alpha) const;
+
+    // Save states: what a step changes. Patrol, size, speed, type and colour are
+    // fixed at spawn, and a restore needs the same enemies; between steps the
+    // step start and previous position are the position itself.
+    void saveState(SimSnapshot& snapshot) const;
+    bool loadState(SimSnapshot& snapshot);
+    // Positions and velocities onto the fixed-point grid (GAME_FIXED_POINT), after a step
+    void snapState();
+
+    // Hot data: the patrol loop reads and writes only these
+    std::vector<float> posX, posY;
+    std::vector<float> velX, velY;            // Per-step values tuned at TUNED_STEP_RATE
+    std::vector<float> direction;             // +1 right, -1 left
+    std::vector<float> patrolStart, patrolWidth;
+    std::vector<float> speed, gravity;
+    std::vector<uint8_t> awake;               // Cleared while PhysicsSystem has it asleep
+
+    // Warm data: collision and interpolation
+    std::vector<float> width, height;
+    std::vector<float> stepStartX, stepStartY;
+    std::vector<float> prevX, prevY;
+    std::vector<uint8_t> onGround;
+    std::vector<uint16_t> restTicks;          // Consecutive resting steps, for sleeping
+    std::vector<int32_t> support;             // Platform the last sweep stood it on, -1 for none
+
+    // Coarse patrol: the walked span, and the patrol phase at clock 0 (see getCoarsePosition)
+    std::vector<uint8_t> coarse;
+    std::vector<float> coarseLeft, coarseRange;
+    std::vector<float> coarsePhase;
+
+    // Cold data
+    std::vector<uint16_t> type;               // Index into the level's enemyTypes
+    std::vector<sf::Color> color;
+
+    static constexpr float TUNED_STEP_RATE = 60.0f;
+    static constexpr float MIN_X = 10.0f;             // Enemies never walk past the level's left edge
+    static constexpr float MIN_PATROL_START = 20.0f;
+
+private:
+    double clock = 0.0; // Steps at TUNED_STEP_RATE the coarse patrols have walked; clear() keeps it
+    double getCoarsePhase(size_t i) const; // 0..2 * coarseRange, as of 'clock'
+    void updatePatrol(size_t begin, size_t end, float stepScale);
+    void updateEdges(size_t begin, size_t end, const LevelGeometry& platforms);
+    void resize(size_t count);
+};
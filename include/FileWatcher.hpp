@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Watches a directory tree on a background thread and reports files that were
+// written or moved in. Linux uses inotify; elsewhere (or if inotify can't be
+// set up) the tree is polled for size and mtime changes every POLL_INTERVAL.
+// Editors often save in several steps, so a path is reported once it has been
+// quiet for SETTLE_TIME, and only once per burst of writes.
+class FileWatcher {
+public:
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{500};
+    static constexpr std::chrono::milliseconds SETTLE_TIME{200};
+
+    FileWatcher() = default;
+    ~FileWatcher(); // Stops the watch
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Watches 'root' recursively, replacing an earlier watch; false if it is not a directory
+    bool start(const std::string& root);
+    void stop();
+    bool isWatching() const { return worker.joinable(); }
+    bool isPolling() const { return polling.load(std::memory_order_relaxed); }
+
+    // Appends the settled changes since the last call (paths start with the root
+    // as given to start()); returns how many
+    size_t takeChanges(std::vector<std::string>& out);
+
+    // Both paths name the same existing file, however they are spelled
+    static bool isSameFile(const std::string& a, const std::string& b);
+
+private:
+    void run();
+    bool watchNative(); // False if the platform watcher is unavailable
+    void watchPolling();
+    void noteChange(const std::string& path);
+
+    std::string root;
+    std::thread worker;
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> polling{false};
+
+    std::mutex mutex;
+    std::condition_variable wake; // Interrupts the polling sleep on stop()
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> pending; // Path -> last event
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Fixed-point quantization of the simulation's float state. OFF by default;
+// with cmake -DGAME_FIXED_POINT=ON every step snaps the positions and
+// velocities it hands on to a grid of 1/65536 px steps (FixedPoint::snap).
+// This is not a fixed-point number type: state stays in floats and a step's
+// arithmetic is float arithmetic; only what a step leaves behind is rounded.
+// Differences below the grid (another compiler's rounding, a fused
+// multiply-add) no longer build up from step to step, which is what replays
+// and rollback netplay need from two machines. The option also turns off
+// multiply-add contraction, the usual source of those differences.
+//
+// The grid has no upper bound, so levels of any width (the streamed wide
+// levels included) work with the option on: a float of magnitude EXACT_FROM
+// or more is a multiple of 1/65536 already, and only smaller ones round.
+#ifndef GAME_FIXED_POINT
+#define GAME_FIXED_POINT 0
+#endif
+
+namespace FixedPoint {
+
+constexpr bool ENABLED = GAME_FIXED_POINT != 0;
+
+// The grid: steps of 1/ONE
+constexpr int FRACTION_BITS = 16;
+constexpr int32_t ONE = 1 << FRACTION_BITS;
+// From here up a float's spacing is 2^-16 or coarser (24-bit significand)
+constexpr float EXACT_FROM = 128.0f;
+
+// Rounds a float to the nearest grid value; the float itself when the option
+// is off. Idempotent: a snapped value snaps to itself, so state written to a
+// snapshot and read back is the state that was running. Below EXACT_FROM the
+// value scaled by ONE fits an int32 exactly; it rounds half away from zero
+// with a truncation and a compare, not nearbyint, and the large case is a
+// select, so a loop of these vectorizes on plain SSE2.
+inline float snap(float value) {
+    if constexpr (ENABLED) {
+        const float scaled = std::min(std::max(value, -EXACT_FROM), EXACT_FROM) * static_cast<float>(ONE);
+        const int32_t whole = static_cast<int32_t>(scaled);
+        const float fraction = scaled - static_cast<float>(whole); // Exact
+        const int32_t raw = whole + (fraction >= 0.5f) - (fraction <= -0.5f);
+        const float snapped = static_cast<float>(raw) * (1.0f / static_cast<float>(ONE));
+        return std::fabs(value) >= EXACT_FROM ? value : snapped;
+    } else {
+        return value;
+    }
+}
+
+// The same over an array: one branch-free loop (clamp, round, convert and
+// back), which the compiler vectorizes once trapping math is off (the
+// option's -fno-trapping-math; nothing here enables FP traps)
+inline void snap(float* values, size_t count) {
+    if constexpr (ENABLED) {
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = snap(values[i]);
+        }
+    } else {
+        (void)values;
+        (void)count;
+    }
+}
+
+} // namespace FixedPoint
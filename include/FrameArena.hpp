@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Linear allocator for data that only lives for the current frame: scratch
+// vectors, layout results and the like. Game::update resets it at the top of
+// every frame, so nothing allocated from it may be kept past that. Main thread
+// only.
+//
+// Allocation bumps an offset in the current block. When a block runs out, a
+// bigger one is taken from the heap. reset() folds the blocks into a single one
+// sized for the whole frame, so steady-state frames never touch the heap.
+//
+// level() is a second arena with the resident level's lifetime: the tables
+// built once per level (LevelStreamer's sectors, the NavGraph). Game releases
+// those containers and resets it when it switches levels, so a level's
+// storage goes in one step and the next level reuses the same block.
+class FrameArena {
+public:
+    struct Stats {
+        size_t bytesUsed = 0;      // This frame so far
+        size_t peakBytes = 0;      // Most used by any frame
+        size_t capacity = 0;       // Across all blocks
+        size_t blockAllocations = 0; // Heap blocks taken since startup
+    };
+
+    static constexpr size_t DEFAULT_CAPACITY = 256 * 1024;
+    static constexpr size_t LEVEL_CAPACITY = 64 * 1024; // First block of level(); grows to the largest level
+
+    // The per-frame arena Game::update resets
+    static FrameArena& instance();
+    // The per-level arena Game::initializeSectors resets
+    static FrameArena& level();
+
+    explicit FrameArena(size_t capacity = DEFAULT_CAPACITY);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+    // Only the most recent allocation is given back (a vector growing in place)
+    void deallocate(void* pointer, size_t bytes);
+    void reset();
+
+    Stats getStats() const;
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size = 0;
+    };
+
+    void addBlock(size_t minimumSize);
+
+    std::vector<Block> blocks;
+    size_t offset = 0;        // Into blocks.back()
+    size_t usedInFullBlocks = 0;
+    size_t peakBytes = 0;
+    size_t blockAllocations = 0;
+};
+
+// STL allocator over a FrameArena (the per-frame one by default)
+template <typename T>
+class FrameAllocator {
+public:
+    using value_type = T;
+
+    FrameAllocator() noexcept : arena(&FrameArena::instance()) {}
+    explicit FrameAllocator(FrameArena& arena) noexcept : arena(&arena) {}
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>& other) noexcept : arena(other.getArena()) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+    }
+    void deallocate(T* pointer, size_t count) noexcept {
+        arena->deallocate(pointer, count * sizeof(T));
+    }
+
+    FrameArena* getArena() const noexcept { return arena; }
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>& other) const noexcept { return arena == other.getArena(); }
+    template <typename U>
+    bool operator!=(const FrameAllocator<U>& other) const noexcept { return arena != other.getArena(); }
+
+private:
+    FrameArena* arena;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+// The same over the per-level arena
+template <typename T>
+class LevelAllocator : public FrameAllocator<T> {
+public:
+    using value_type = T;
+    template <typename U>
+    struct rebind {
+        using other = LevelAllocator<U>;
+    };
+
+    LevelAllocator() noexcept : FrameAllocator<T>(FrameArena::level()) {}
+    template <typename U>
+    LevelAllocator(const LevelAllocator<U>& other) noexcept : FrameAllocator<T>(*other.getArena()) {}
+};
+
+template <typename T>
+using LevelVector = std::vector<T, LevelAllocator<T>>;
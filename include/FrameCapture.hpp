@@ -0,0 +1,132 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Screenshots and gameplay recordings read back without stalling. Each frame
+// that is wanted is copied by glReadPixels into one of a ring of PBO_COUNT
+// pixel buffer objects, which returns as soon as the copy is queued. The
+// buffer is mapped on a later frame, once its GL_ARB_sync fence says the copy
+// is done (PBO_COUNT - 1 frames later without fences), and its pixels handed
+// to a worker thread that flips them upright and encodes them: PNG for
+// screenshots, raw RGBA frames appended to one file for recordings (with a
+// sidecar giving the ffmpeg line to turn it into a video). Should a buffer
+// still be busy when its turn in the ring comes round, the frame is skipped
+// rather than waited for; when the worker falls more than MAX_QUEUED frames
+// behind, recorded frames are dropped. Both are counted.
+//
+// Requests come from the game thread; captureFrame() runs on the render
+// thread (whichever holds the window's context), after the frame is drawn and
+// before display(). Without pixel buffer objects (GL 2.1 or
+// GL_ARB_pixel_buffer_object) isAvailable() is false and requests are ignored.
+class FrameCapture {
+public:
+    static constexpr size_t PBO_COUNT = 3;   // Readbacks in flight
+    static constexpr size_t MAX_QUEUED = 8;  // Frames waiting for the encoder
+
+    struct Stats {
+        uint64_t screenshots = 0;    // Written
+        uint64_t recordedFrames = 0; // Of the current (or last) recording
+        uint64_t droppedFrames = 0;  // Skipped or dropped while recording
+        uint64_t failedWrites = 0;
+        size_t queued = 0;           // Waiting for the encoder
+    };
+
+    FrameCapture() = default;
+    ~FrameCapture(); // Finishes every queued write
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // Game thread. The screenshot is the next frame captured; 'trace' (if
+    // any) is written to 'tracePath' alongside it by the worker.
+    void requestScreenshot(const std::string& path, const std::string& tracePath = {}, std::string trace = {});
+    // Records every presented frame to 'path' until stopRecording(); false
+    // if a recording is already running
+    bool startRecording(const std::string& path);
+    void stopRecording();
+    bool isRecording() const { return recording.load(std::memory_order_relaxed); }
+    bool isAvailable() const { return available.load(std::memory_order_relaxed); }
+    Stats getStats() const;
+    std::string getLastPath() const; // Of the last screenshot or recording written
+
+    // Render thread, with the window's context active. Collects finished
+    // readbacks and, if this frame is wanted, starts its own.
+    void captureFrame(sf::Vector2u size);
+
+private:
+    enum class Kind : uint8_t { Screenshot, Recording };
+
+    struct Readback {
+        unsigned int buffer = 0;
+        void* fence = nullptr;        // GLsync, when the driver has them
+        sf::Vector2u size;
+        size_t capacity = 0;          // Bytes allocated for the buffer
+        Kind kind = Kind::Screenshot;
+        std::string path;
+        std::string tracePath;
+        std::string trace;
+        uint64_t frame = 0;           // When the copy was issued
+        bool pending = false;
+    };
+
+    // One frame on its way to the encoder
+    struct Job {
+        Kind kind = Kind::Screenshot;
+        sf::Vector2u size;
+        std::vector<uint8_t> pixels;  // Bottom row first, as GL reads them
+        std::string path;
+        std::string tracePath;
+        std::string trace;
+        bool finish = false;          // Closes the recording instead (no pixels)
+        uint64_t frames = 0;          // With 'finish': frames recorded
+        double seconds = 0.0;         // With 'finish': recording length
+    };
+
+    bool initialize();
+    bool collect(Readback& readback); // False while the copy isn't done
+    void push(Job&& job);
+    void workerLoop();
+    void encode(Job& job);
+
+    // Render thread
+    bool initialized = false;
+    std::array<Readback, PBO_COUNT> readbacks{};
+    size_t current = 0;
+    uint64_t frameCounter = 0;
+    std::string recordingPath;    // Of the recording the render thread is feeding
+    sf::Vector2u recordingSize;   // Frames of another size are skipped
+    uint64_t recordingFrames = 0;
+    std::chrono::steady_clock::time_point recordingStart;
+    std::chrono::steady_clock::time_point recordingLast;
+
+    // Requests, game thread to render thread
+    mutable std::mutex requestMutex;
+    bool screenshotRequested = false;
+    std::string screenshotPath;
+    std::string screenshotTracePath;
+    std::string screenshotTrace;
+    std::string requestedRecordingPath; // Empty when not recording
+    std::atomic<bool> recording{false};
+    std::atomic<bool> available{false};
+
+    // Worker
+    mutable std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::deque<Job> jobs;
+    std::vector<std::vector<uint8_t>> spareBuffers; // Recycled pixel storage
+    std::thread worker;
+    bool stopping = false;
+    std::ofstream recordingFile;  // Worker only
+    Stats stats;                  // Guarded by jobMutex
+    std::string lastPath;         // Likewise
+};
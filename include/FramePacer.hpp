@@ -0,0 +1,91 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Frame pacing for the main loop. endFrame() closes each frame: the Limiter
+// sleeps most of the remaining budget and spins the last stretch, so frames
+// start on time instead of whenever a coarse sleep wakes up. Adaptive limits
+// the same way but halves the rate while frames keep overrunning the budget,
+// and returns to the full rate once they fit again with room to spare. VSync
+// leaves the wait to the driver (Game turns it on for the window). A throttle
+// caps any mode lower still, for a window in the background.
+//
+// smooth() turns the raw frame time into the dt the simulation advances by,
+// averaged over the last few frames so one hitch doesn't show up as a jump.
+class FramePacer {
+public:
+    enum class Mode : uint8_t {
+        VSync,
+        Limiter,
+        Uncapped,
+        Adaptive
+    };
+
+    struct Stats {
+        double targetMs = 0.0;     // Current budget, 0 when not limiting
+        double workMs = 0.0;       // Last frame before the wait
+        double meanMs = 0.0;       // Frame intervals over the history
+        double varianceMs2 = 0.0;
+        double stdDevMs = 0.0;
+        double worstMs = 0.0;
+        size_t samples = 0;
+        bool reduced = false;      // Adaptive running at half rate
+        bool throttled = false;    // Held to the throttle
+    };
+
+    static constexpr size_t HISTORY = 120;             // Frames in the stats
+    static constexpr size_t SMOOTH_FRAMES = 8;         // Frames averaged by smooth()
+    static constexpr double SPIN_MS = 1.5;             // Busy-wait before the deadline (sleep overshoot)
+    static constexpr double ADAPTIVE_DROP = 0.95;      // Work over this share of the full-rate budget drops...
+    static constexpr double ADAPTIVE_RECOVER = 0.7;    // ...and under this share for RECOVER_FRAMES restores
+    static constexpr size_t ADAPTIVE_RECOVER_FRAMES = 60;
+
+    void setMode(Mode newMode);
+    Mode getMode() const { return mode; }
+    void setTargetFps(unsigned fps);
+    unsigned getTargetFps() const { return targetFps; }
+    // A cap over every mode, VSync and Uncapped included; 0 lifts it
+    void setThrottleFps(unsigned fps) { throttleFps = fps; }
+    unsigned getThrottleFps() const { return throttleFps; }
+    // The rate endFrame holds to: the target, half of it while Adaptive backs
+    // off, or the throttle when lower; 0 for none
+    unsigned getCurrentFps() const;
+    bool wantsVSync() const { return mode == Mode::VSync; }
+
+    void setSmoothing(bool enabled) { smoothing = enabled; }
+    bool isSmoothing() const { return smoothing; }
+    float smooth(float rawSeconds);
+    void resetSmoothing() { dtCount = 0; } // Forget frames that shouldn't be averaged in (a pause)
+
+    // Call once per frame, last thing in the loop
+    void endFrame();
+
+    Stats getStats() const;
+    static const char* modeName(Mode mode);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void waitUntil(Clock::time_point deadline) const;
+    void updateAdaptive(double workMs);
+
+    Mode mode = Mode::Limiter;
+    unsigned targetFps = 60;
+    unsigned throttleFps = 0;
+    bool reduced = false;
+    size_t recoverFrames = 0;
+    double workAverageMs = 0.0;    // Moving average Adaptive decides on
+
+    Clock::time_point frameStart = Clock::now();
+    double lastWorkMs = 0.0;
+    std::array<double, HISTORY> intervalsMs{};
+    size_t intervalCount = 0;
+    size_t intervalNext = 0;
+
+    bool smoothing = true;
+    std::array<float, SMOOTH_FRAMES> recentDt{};
+    size_t dtCount = 0;
+    size_t dtNext = 0;
+};
@@ -1,17 +1,53 @@
 #pragma once
 #include <SFML/Graphics.hpp>
+#include <array>
+#include <chrono>
 #include <vector>
 #include <string>
 #include <filesystem>
 #include <fstream>
 #include "Player.hpp"
-#include "Enemy.hpp"
+#include "InputSystem.hpp"
+#include "InputReplay.hpp"
+#include "SimSnapshot.hpp"
+#include "RollbackSession.hpp"
+#include "NetTransport.hpp"
+#include "EnemyStore.hpp"
 #include "NPC.hpp"
 #include "SoundSystem.h"
 
 #include "AssetManager.hpp"
 #include "Physics.hpp"
+#include "Simulation.hpp"
+#include "JobSystem.hpp"
+#include "AsyncLogger.hpp"
+#include "LevelGeometry.hpp"
+#include "LevelLoader.hpp"
+#include "LevelStreamer.hpp"
+#include "LevelCache.hpp"
+#include "LevelPreloader.hpp"
+#include "LevelBundles.hpp"
+#include "SceneGenerator.hpp"
+#include "NavGraph.hpp"
+#include "NavPathfinder.hpp"
+#include "TimerWheel.hpp"
+#include "GameEvents.hpp"
+#include "ProjectileSystem.hpp"
+#include "HudLayer.hpp"
+#include "ViewCulling.hpp"
 #include "RenderingSystem.hpp"
+#include "RenderThread.hpp"
+#include "FrameCapture.hpp"
+#include "HitchDetector.hpp"
+#include "FramePacer.hpp"
+#include "QualityGovernor.hpp"
+#include "Telemetry.hpp"
+#include "MemoryStats.hpp"
+#include "StartupProfile.hpp"
+#include "SweepAndPrune.hpp"
+#include "AssetBrowser.hpp"
+#include "LevelEditor.hpp"
+#include "FileWatcher.hpp"
 #include "imgui.h"
 #include "imgui-SFML.h"
 
@@ -23,58 +59,104 @@ enum class GameState {
     DebugPanel // New state for showing debug/settings UI
 };
 
-// Image asset info structure
-struct ImageAssetInfo {
-    std::string path;
-    std::string name;
-    sf::Vector2u dimensions;
-    size_t fileSize;
-    bool isLoaded;
-    sf::Time loadTime;
-};
-
 // BackgroundLayer is now defined in RenderingSystem.hpp
 
+// In Game's members: GAME_LOG(Debug, "Synchronized {} platforms", count) queues
+// the format's id and the raw arguments, so no string is built (see LOG_FORMAT)
+#define GAME_LOG(level, format, ...) \
+    do { \
+        if (loggingEnabled) { \
+            LOG_FORMAT(gameLogSink, level, format, __VA_ARGS__); \
+        } \
+    } while (0)
+
 class Game {
 public:
     Game();
     ~Game();
     void run();
+    // Plays a recorded session from its level start; false (logged) if it can't be loaded
+    bool playReplay(const std::string& path);
+    // Netplay: wait for a peer on 'port', or join a host. The match starts
+    // (from the host's level) once the two are connected.
+    bool hostNetplay(unsigned short port);
+    bool joinNetplay(const std::string& address, unsigned short port);
 
 private:
-    void handleEvents();
+    void handleEvents();                // Blocks for the first event while isBackgroundPaused (and sleeping is on)
+    void handleEvent(const sf::Event& event);
     void update();
-    void draw();
-    void initializePlatforms();
+    void fixedUpdate(float deltaTime);  // One fixed simulation step
+    void storePreviousState();          // Snapshot positions for render interpolation
+    void draw();                        // Records the frame and submits it to renderThread
+    void recordWorld(RenderSnapshot& snapshot); // Everything drawn before the PresentScene pass
+    void recordViewPasses(RenderSnapshot& snapshot, const sf::View& view, uint32_t slot); // Per-view passes
+    void recordLighting(RenderSnapshot& snapshot, uint32_t slot); // The Lighting pass, when the level is lit
+    void setSplitScreen(bool enabled);          // The partner camera starts where the player's is
+    void updateSplitViews(float frameTime);     // Places both halves; the partner camera pans here
+    ViewCulling::ViewSet getWorldViews(float margin) const; // gameView, or split screen's two views
+    void presentFrame(RenderThread::Frame& frame); // Draws and displays a recorded frame
+    void plotFrameCounters();           // Last presented frame's counters, for the profiler
+    void updateQuality(float frameTime); // Feeds the quality governor; after plotFrameCounters
+    void applyQuality(size_t level);     // One of QUALITY_PRESETS (Game.cpp)
+    void initializeSectors(bool decorationsRestored = false); // Streams in the sectors around the player
+    void applyActiveSectors();    // Rebuilds platforms, enemies, physics and mini-map from them
+    float getCameraX(float playerX, float halfWidth = WINDOW_WIDTH / 2.f) const; // Keeps the view in the level
     void initializeNPCs();  // New method
-    void initializeEnemies();
+    void createHud();
     void initializeUI();
     void initializeMiniMap();
     void initializeAudio(); // New method for audio initialization
+    void runStartupTasks(); // Audio, level file and tile decode at once on the job system
     void updateMiniMap();
     void syncPlatformsWithPhysics();
+    void updateEntityBroadphase();   // Refreshes the entity proxies and pair list for the contact checks
     void checkPlayerEnemyCollision();
+    void hitPlayer(float fromX, float value); // Invulnerability, the PlayerHit event and a knock away from 'fromX'
+    void stepProjectiles(float deltaTime);    // Moves the shots and applies what they and the hitboxes hit
+    void fireTestVolley();                    // Debug panel: a fan of shots from the player
     void checkPlayerNPCCollision();  // New method for NPC collision detection
+    // Trigger enter/stay/exit events from the pair list, and the level exits and fall zone they act on
+    void updateTriggers();
     void updateUI();
-    void checkGameOver();
+    void dispatchGameEvents();       // Audio, UI text and counts for the frame's events, in one batch
+    void centerText(HudLayer::WidgetId text, float offsetY); // In the window, 'offsetY' below the middle
     void resetGame();
     void nextLevel();
     void previousLevel();  // Method to go back to the previous level
     void jumpToLevel(int level);  // New method for jumping to specific levels
-    void checkLevelCompletion();
+    
+    // Where the player appears when a level is (re)loaded; Reload leaves them in place
+    enum class LevelEntry { Spawn, FromLeft, FromRight, Reload };
+    void loadLevel(int level, LevelEntry entry); // Shared body of the three level switches
+    bool loadLevelData(int level);               // Falls back to a bare ground strip on failure
+    // Stress scenes (Gameplay tab): sceneConfig's level in place of the current one until the next level change
+    void loadGeneratedScene();
+    void generateScene();
+    void loadLevelBackground();
+    void applyColorGrade(); // The level's LUT and tint to the renderer
     void loadAssets();
-    void drawDebugBoxes();
+    void reloadChangedAssets(); // Hot reload of what assetWatcher saw change, at the frame boundary
+    void drawDebugBoxes(RenderSnapshot& snapshot);
+    void drawNavGraph(DebugDraw& debugDraw, const sf::FloatRect& viewBounds);
+    void collectVisiblePlatforms(const sf::FloatRect& viewBounds);
 
     
     // Background layer methods
     void initializeBackgroundLayers();
-    void loadBackgroundLayers();
-    
-    // Level-specific layouts (removed for puzzle-focused gameplay)
-    
-    // Level-specific enemy patterns
-    void initializeSnowEnemies();
-    void initializeSnowForestEnemies();
+    void loadBackgroundLayers(bool reloadFromDisk = false); // Otherwise reuses prefetched textures
+    std::string getBackgroundLayerPath(const std::string& layerName, int level) const;
+    std::string getTiledLayerDirectory(const std::string& layerName, int level) const; // Empty without one
+    void prefetchBackgroundLayers(int level);
+    // Background images are resampled at load to the pixels the world view
+    // covers (render scale target or window); a change reloads the layers
+    void updateBackgroundDisplaySize();
+    // Neighbouring level's data and textures, loaded while the player walks to its edge
+    void preloadLevel(int level);
+    void parkLevel(int level); // Moves the current level's data, decorations and backgrounds into levelCache
+    void collectLevelAssets(); // levelAssets for the level just loaded
+    void updateLevelPreload();
+    void updateLoadingText();
     
     // ImGui methods
     void initializeImGui();
@@ -84,11 +166,63 @@ private:
     
     // Asset manager window
     void showAssetManagerWindow();
-    void scanAssetDirectory(const std::string& directory);
+    // Level editor window; its edits update the derived level data in place
+    void showLevelEditorWindow();
+    void applyLevelEdits();
+    void redrawMiniMap(const sf::FloatRect& area); // Re-bakes the part of miniMapTexture showing 'area'
+    // Any ImGui window open; otherwise the ImGui frame is skipped altogether
+    bool isToolingVisible() const {
+        return useImGuiInterface || showProfiler || showMemory || showAssetManager || showLevelEditor || showImGuiDemo;
+    }
+    
+    // Frame profiler window (F2) and Chrome trace capture (F5)
+    void showProfilerWindow();
+    void startProfilerCapture();
+    void stopProfilerCapture();
+    // Screenshots (F12) and recordings (Shift+F12), read back by frameCapture
+    void takeScreenshot();
+    void toggleRecording();
+    // After the frame mark: a hitch's trace once its window is in, and the toast saying so
+    void checkHitches();
+    void showHitchToast();
     
     // FPS counter methods
     void updateFPS();
-    void drawFPS();
+    void drawHud(RenderSnapshot& snapshot); // Shows the widgets the state calls for, in uiView
+    void applyFramePacing(); // Window vsync for framePacer's mode
+    
+    // Session telemetry (Telemetry tab): a report next to the log on exit, compared with a saved baseline
+    void recordTelemetry();                              // Once per frame, after the profiler's frame mark
+    std::string getTelemetryPath(const char* fileName) const; // In the log file's directory
+    void showTelemetryTab();
+    
+    // Memory dashboard: heap bytes by subsystem tag plus the texture and audio
+    // estimates, with this level's and the session's high-water marks
+    void sampleMemory(); // Into memorySample; recordTelemetry keeps the peaks
+    void showMemoryWindow();
+    
+    // Session replays: recording restarts the current level with a new tile seed
+    void startReplayRecording();
+    void stopReplayRecording();  // Saves to replayPath
+    void stopReplayPlayback();  // Checks the end state once every frame has played
+    InputReplay::EndState getReplayEndState() const;
+    
+    // Save states (F6 save, F9 restore), kept in memory: the simulation as of
+    // the last step. Restoring needs the same level and active sectors.
+    bool saveSimState();
+    bool restoreSimState();
+    enum class SimStateRead { Restored, OtherSectors, Truncated };
+    void writeSimState(SimSnapshot& out);    // Shared by save states and netplay's per-tick snapshots
+    SimStateRead readSimState(SimSnapshot& in); // Truncated leaves systems half-restored
+    
+    // Netplay (RollbackSession over NetTransport). Both peers' buttons drive
+    // the one player; the whole level stays streamed in while it runs.
+    void stopNetplay();
+    void updateNetplay();                       // Once per frame: packets in, a match start, a lost peer
+    void startNetplayMatch(const NetTransport::MatchSettings& match);
+    PlayerInput beginNetplayTick(const PlayerInput& local); // Snapshot, then local + remote controls
+    void rollbackNetplay(uint32_t from);        // Restores 'from' and runs the ticks since again
+    void sendNetplayInputs();
     
     // Logging methods
     void logDebug(const std::string& message);
@@ -98,42 +232,114 @@ private:
     void setLoggingEnabled(bool enabled) { loggingEnabled = enabled; }
     bool isLoggingEnabled() const { return loggingEnabled; }
     void clearGameLogFile();
-    std::string getCurrentTimestamp();
 
+    // First member, so its clock covers creating the window too
+    StartupProfile startupProfile;
+    // Tile PNGs decoded by runStartupTasks, packed and uploaded by the first loadAssets
+    struct DecodedTiles {
+        std::string directory;
+        std::vector<std::string> files;
+        std::vector<sf::Image> images;
+    };
+    DecodedTiles startupTiles;
+    
     sf::RenderWindow window;
     sf::View gameView;
     sf::View uiView; // Separate view for UI elements that don't scroll
+    // Split screen: the world is drawn through two half-width views, the left
+    // following the player and the right a partner camera panned with A/D or a
+    // second gamepad. The simulation runs once and culls over both (getWorldViews);
+    // gameView keeps following the player for everything else.
+    bool splitScreen = false;
+    float partnerCameraX = WINDOW_WIDTH / 2.f;
+    std::array<sf::View, ViewCulling::ViewSet::MAX_VIEWS> splitViews;
+    sf::RectangleShape splitDivider;
+    static constexpr float PARTNER_PAN_SPEED = 600.f; // World px per second at full stick
     sf::View miniMapView; // View for the mini-map
     sf::Clock clock;
     sf::Clock imguiClock; // Clock for ImGui updates
     Player player;
-    std::vector<sf::RectangleShape> platforms;
-    std::vector<sf::RectangleShape> ladders;
-    std::vector<Enemy> enemies;
+    InputSystem inputSystem;  // Key events from handleEvents, handed out per fixed step
+    PlayerInput tickInput;    // The player's controls for the step being run
+    std::string inputRecordingPath = "input_recording.txt";
+    enum class ReplayMode { Off, Recording, Playing };
+    ReplayMode replayMode = ReplayMode::Off;
+    InputReplay replay;
+    std::string replayPath = "session.replay";
+    SimSnapshot quickSave;
+    RollbackSession netplay;
+    NetTransport netTransport;
+    std::array<uint8_t, RollbackSession::MAX_PACKET> netplayPacket{};
+    char netplayAddress[64] = "127.0.0.1";
+    int netplayPort = NetTransport::DEFAULT_PORT;
+    int netplayInputDelay = 2;
+    double quickSaveMs = 0.0;     // Time the last save/restore took
+    double quickRestoreMs = 0.0;
+    LevelGeometry platforms;
+    LevelGeometry ladders;
+    EnemyStore enemies;
+    ProjectileSystem projectiles;        // Shots and attack hitboxes, stepped after the entity broadphase
+    SweepAndPrune entityBroadphase;      // Player, enemy and NPC contacts, and the level's triggers
+    size_t entityProxyEnemies = 0;       // Entity counts the proxies were built for
+    size_t entityProxyNPCs = 0;
+    std::vector<uint32_t> contactHits;   // Scratch for the contact handlers
+    std::vector<uint32_t> playerTriggers; // Triggers the player was in after the last step, ascending
+    std::vector<uint32_t> triggerHits;    // Scratch for updateTriggers
     std::unique_ptr<NPC> npcManager;  // NPC manager
+    AIScheduler::Stats aiFrameStats;  // NPC AI work over the last frame's steps
     bool playerHit;
-    float playerHitCooldown;
+    TimerWheel::TimerId hitCooldownTimer = TimerWheel::NO_TIMER; // Clears playerHit when it fires
+    
+    // Gameplay timers on simulation time, advanced and handled in fixedUpdate
+    enum class GameTimer : uint32_t {
+        HitCooldown,
+        LevelTransition
+    };
+    TimerWheel gameTimers;
+    std::vector<TimerWheel::Expired> expiredTimers;
+    GameEventQueue gameEvents;       // Emitted during the frame's steps, drained by dispatchGameEvents
     
     // Level system
     int currentLevel;
-    float transitionTimer;
-    sf::Text levelText;
+    int levelCount = 1;  // assets/levels/level1..N.json found at startup
+    SceneGenerator::Config sceneConfig = SceneGenerator::getPreset(0).config;
+    bool sceneActive = false; // levelData is a generated scene standing in for currentLevel
+    LevelData levelData; // Reused across level loads
+    LevelStreamer levelStreamer; // 'platforms', 'ladders' and 'enemies' hold its active sectors
+    LevelPreloader levelPreloader;
+    LevelCache levelCache;       // Levels recently left, swapped back in on return
+    std::vector<std::string> levelAssets; // The current level's dependency manifest (LevelAssets::collect)
+    NavGraph navGraph;           // The whole level's platforms, built with the sectors
+    NavPathfinder pathfinder;    // Agents' path requests against navGraph
+    bool showNavGraph = false;
+    int preloadedBackgroundLevel = 0; // Level whose main background preloadLevel has requested
+    TimerWheel::TimerId transitionTimer = TimerWheel::NO_TIMER; // The transition screen's minimum time
+    int transitionLevel = 0; // Where the transition in progress goes
+    HudLayer::WidgetId levelText = HudLayer::NO_WIDGET;
+    HudLayer::WidgetId loadingText = HudLayer::NO_WIDGET; // Prefetch progress on the level transition screen
     
 
     
+    // Worker pool for parallel enemy passes (declared before the systems that use it)
+    JobSystem jobSystem;
+    
+    // Pack bundles of the level played and the one being approached; read on jobSystem
+    LevelBundles levelBundles;
+    
     // Physics system
     PhysicsSystem physicsSystem;
     
     // Rendering system (includes tile rendering)
     RenderingSystem renderingSystem;
     
-    // Mini-map elements
-    sf::RectangleShape miniMapBorder;
-    sf::RectangleShape miniMapPlayerIcon;
-    std::vector<sf::RectangleShape> miniMapPlatforms;
-    std::vector<sf::RectangleShape> miniMapLadders;
-    std::vector<sf::RectangleShape> miniMapEnemies;
+    // Mini-map: border, platforms and ladders are baked into miniMapTexture by
+    // initializeMiniMap; only the markers (player, enemies, NPCs) change per frame
+    sf::RenderTexture miniMapTexture;
+    bool miniMapTextureValid = false;
+    sf::VertexArray miniMapMarkers{sf::PrimitiveType::Triangles}; // Screen space, rebuilt by updateMiniMap
     bool showMiniMap; // Flag to toggle minimap visibility
+    float miniMapLeft = 0.f;                // World x range the mini-map shows (the active sectors)
+    float miniMapSpan = LEVEL_WIDTH;
     
     // Game state
     GameState currentState;
@@ -141,9 +347,11 @@ private:
     
     // UI elements
     sf::Font defaultFont; // Default font for initialization
-    sf::Font font;        // Game font that will be loaded
-    sf::Text gameOverText;
-    sf::Text restartText;
+    AssetManager::FontHandle uiFont;    // HUD texts; opened and prewarmed once by loadAssets
+    AssetManager::FontHandle debugFont; // Player debug overlay
+    HudLayer hud;                       // Every HUD text below, baked once and redrawn as is
+    HudLayer::WidgetId gameOverText = HudLayer::NO_WIDGET;
+    HudLayer::WidgetId restartText = HudLayer::NO_WIDGET;
     
     // Settings variables
     bool showBoundingBoxes;
@@ -155,6 +363,30 @@ private:
     float boundaryBoxHeight;
     bool showEnemies;  // Toggle to show/hide enemies for testing
     
+    // Fixed-timestep simulation
+    float fixedTimeStep = 1.0f / 60.0f;  // Simulation step in seconds
+    int maxSubSteps = 5;                 // Cap on steps per rendered frame
+    float timeAccumulator = 0.0f;        // Unsimulated time carried to the next frame
+    float interpolationAlpha = 1.0f;     // Blend between previous and current state when drawing
+    int lastSubStepCount = 0;
+    FramePacer framePacer;               // Frame rate mode, and the dt the steps are fed
+    
+    // Power modes for a window in the background (Gameplay tab). Unfocused,
+    // frames are throttled and the simulation optionally pauses (never in
+    // netplay, which the peer would stall on); minimized, nothing is drawn.
+    // SFML has no minimize event: a window resized to nothing counts as one.
+    enum class BackgroundSim : int { Run, Pause };
+    BackgroundSim backgroundSim = BackgroundSim::Pause;
+    int backgroundFps = 15;              // Frame cap while unfocused, 0 for none
+    bool skipDrawWhenMinimized = true;
+    bool sleepWhenPaused = true;         // Wait for events instead of polling while background-paused
+    bool windowFocused = true;
+    bool windowMinimized = false;
+    void applyBackgroundMode();          // After focus or one of the settings changes
+    bool isBackgroundPaused() const {
+        return !windowFocused && backgroundSim == BackgroundSim::Pause && !netplay.isActive();
+    }
+    
     // Debug grid variables
     bool showDebugGrid;
     float gridSize;
@@ -165,44 +397,93 @@ private:
     // ImGui UI state variables
     bool showImGuiDemo;
     bool useImGuiInterface;
+    bool imguiFrameActive = false; // updateImGui ran this frame, so draw() renders it
     bool showAssetManager; // Flag to show/hide the asset manager window
+    bool showLevelEditor = false;
+    bool showProfiler = false;
+    bool showMemory = false;
+    size_t profilerSelectedAge = 0;        // Inspected frame, 0 = newest
+    std::vector<float> profilerFrameTimes; // Histogram scratch, oldest first
+    std::vector<float> profilerFrameAllocations;
+    float captureSeconds = 5.0f;           // Trace captures stop themselves after this long
+    std::string lastCapturePath;
+    bool screenshotTrace = true;           // Write the profiler history next to each screenshot
+    int screenshotTraceFrames = 120;
+    HitchDetector hitchDetector;
+    static constexpr float HITCH_TOAST_SECONDS = 4.0f;
+    std::chrono::steady_clock::time_point hitchToastStart; // Of the last trace written
+    bool hitchToast = false;
+    
+    // Render stats tab
+    int renderStatsFrameAge = 0;             // Frame shown in the table, 0 = last finished
+    std::vector<float> renderStatsDrawCalls; // Plot scratch, oldest first
     
-    // Asset manager variables
-    std::vector<ImageAssetInfo> imageAssets;
+    // Asset manager window, created the first time it opens
+#if GAME_EDITOR
+    std::unique_ptr<AssetBrowser> assetBrowser;
+    std::unique_ptr<LevelEditor> levelEditor;   // Created the first time it opens too
+    std::vector<LevelEditor::Edit> levelEdits;  // Scratch for applyLevelEdits
+#endif
     std::string assetRootDir = "assets";
-    ImageAssetInfo* selectedAsset = nullptr;
-    sf::Texture previewTexture;
-    bool previewAvailable = false;
+    FileWatcher assetWatcher;                  // Only while loose files are used (no pack mounted)
+    std::vector<std::string> changedAssetFiles; // Scratch for reloadChangedAssets
+    size_t hotReloadCount = 0;
     
     // FPS tracking variables
     sf::Clock fpsClock;
-    sf::Text fpsText;
-    sf::RectangleShape fpsBackground;
+    HudLayer::WidgetId fpsText = HudLayer::NO_WIDGET;
+    HudLayer::WidgetId fpsBackground = HudLayer::NO_WIDGET;
     float fpsUpdateTime;
     int frameCount;
     float currentFPS;
     
+    // View culling: drawn/culled counts per category from the last frame
+    HudLayer::WidgetId cullText = HudLayer::NO_WIDGET;
+    ViewCulling::CullStats platformCullStats;
+    ViewCulling::CullStats enemyCullStats;
+    ViewCulling::CullStats debugBoxCullStats;
+    std::vector<size_t> visiblePlatforms; // Scratch for grid view queries
+    std::vector<sf::Vertex> levelVertices; // Scratch for the untextured platform and ladder quads
+    RenderQueue renderQueue;               // The world's layered draws, rebuilt every recorded frame
+    static constexpr float CULL_MARGIN = 32.f; // Slack for interpolation and sprite overhang
+    static constexpr size_t NAV_EXPANSIONS_PER_FRAME = 2048; // A* node budget shared by all path requests
+    
     static constexpr int WINDOW_WIDTH = 800;
     static constexpr int WINDOW_HEIGHT = 600;
-    static constexpr int LEVEL_WIDTH = 1500; // Reduced from 3000 to make the level shorter
+    static constexpr int LEVEL_WIDTH = 1500; // Fallback level width; real levels use levelData.size
     static constexpr int FPS = 60;
     static constexpr float HIT_COOLDOWN = 1.5f; // 1.5 seconds invulnerability
     static constexpr float LEVEL_TRANSITION_DURATION = 1.0f; // Duration of level transition in seconds
+    static constexpr float LEVEL_PRELOAD_DISTANCE = 600.f; // From an edge; the next level starts loading
+    static constexpr float LEVEL_MUSIC_CROSSFADE = 2.0f; // Seconds from one level's music to the next's
     static constexpr float GROUND_HEIGHT = 100.f; // Height of the ground platform from bottom of screen
+    static constexpr float MAX_FRAME_TIME = 0.25f; // Clamp long frames (breakpoints, window drags)
+    static constexpr int BACKGROUND_WAKE_MS = 100; // Longest event wait while background-paused (uploads, reloads)
+    static constexpr std::chrono::microseconds ASSET_UPLOAD_BUDGET{4000}; // GPU uploads per frame
     
     // Mini-map constants
     static constexpr int MINI_MAP_WIDTH = 200;
     static constexpr int MINI_MAP_HEIGHT = 100;
     static constexpr int MINI_MAP_MARGIN = 10;
+    static constexpr float MINI_MAP_OUTLINE = 2.f; // Border thickness, outside MINI_MAP_WIDTH x HEIGHT
+    static constexpr float MINI_MAP_INSET = 4.f;   // Gap between the border and the map contents
+    inline static const sf::Color MINI_MAP_FILL{0, 0, 0, 100}; // Semi-transparent black
 
     AssetManager assets;
     // Use pointers for sprites to avoid constructor issues
     std::unique_ptr<sf::Sprite> playerSprite;
     std::unique_ptr<sf::Sprite> enemySprite;
+    AssetManager::TextureRef playerTexture; // Pinned while the sprites above draw them
+    AssetManager::TextureRef enemyTexture;
+    AssetManager::TextureRef colorGradeTexture; // The level's LUT, while the renderer grades with it
     
     // Layered background system
     std::vector<BackgroundLayer> backgroundLayers;
     
+    // Weather, drawn over the background by renderingSystem
+    ParticleSystem::EmitterId snowEmitter = 0;
+    static constexpr size_t SNOW_BUDGET = 20000;
+    
     // Placeholder shapes to draw when textures are missing
     sf::RectangleShape backgroundPlaceholder;
     sf::RectangleShape playerPlaceholder;
@@ -218,9 +499,26 @@ private:
     bool isRunning;
     
     // Logging system
-    std::ofstream gameLogFile;
+    AsyncLogger::SinkId gameLogSink = 0;
     bool loggingEnabled = true;
-    std::string gameLogFileName = "game_debug.log";
+    std::string gameLogFileName = GAME_BINARY_LOG ? "game_debug.blog" : "game_debug.log";
+    
+    // Session telemetry
+    SessionTelemetry telemetry;
+    SessionTelemetry::Summary telemetryBaseline;
+    bool hasTelemetryBaseline = false;
+    std::string telemetryStatus;             // Result of the last save/load, for the tab
+    MemoryStats::Sample memorySample;        // This frame's, from sampleMemory
+    RenderStats::Counters presentedRenderTotals; // Set in plotFrameCounters, when the render thread is idle
+    GpuTimer::Frame presentedGpuFrame;           // Likewise; the newest frame the GPU timer has read back
+    // Job lanes: totals at the last sample, and the share of the pool's threads
+    // each kept busy since the one before (plotFrameCounters)
+    std::array<JobSystem::LaneStats, JobSystem::LANE_COUNT> laneSamples;
+    std::array<float, JobSystem::LANE_COUNT> laneUtilization{};
+    std::chrono::steady_clock::time_point laneSampleTime;
+    static constexpr double LANE_SAMPLE_SECONDS = 0.5;
+    static constexpr const char* TELEMETRY_FILE = "game_telemetry.json";
+    static constexpr const char* TELEMETRY_BASELINE_FILE = "game_telemetry_baseline.json";
 
     // Debug properties
     bool showPlayerDebug = false;
@@ -229,6 +527,19 @@ private:
     bool isFullscreen = false;
     sf::VideoMode previousVideoMode;  // Store previous window size/mode
     sf::Vector2i previousPosition;    // Store previous window position
+    size_t renderScaleMode = 0;       // Into RENDER_SCALE_MODES (Game.cpp)
+    QualityGovernor qualityGovernor;  // Levels index QUALITY_PRESETS (Game.cpp)
+    size_t qualityLevel = 0;          // Applied last
+    RenderThread::Stats renderThreadStats; // Taken each frame by updateQuality
+    double displayMs = 0.0;           // window.display() of the last presented frame
+    
+    // The world frame kept while paused (DebugPanel, GameOver) and shown again
+    // in place of the world; dirty after input or anything that changes it
+    bool sceneCached = false;
+    bool sceneCacheDirty = true;
+    bool isWorldPaused() const {
+        return currentState == GameState::DebugPanel || currentState == GameState::GameOver || isBackgroundPaused();
+    }
 
     // Sound system
     SoundSystem soundSystem;
@@ -236,4 +547,13 @@ private:
     bool isSoundEffectsEnabled;
     float musicVolume;
     float soundEffectVolume;
+
+    // Fed by presentFrame, so it must outlive the render thread
+    FrameCapture frameCapture;
+
+    // Draws and presents recorded frames; off by default (frames are then
+    // presented inline by submit). Declared last so it stops before anything
+    // it reads is destroyed.
+    bool useRenderThread = false;
+    RenderThread renderThread{[this](RenderThread::Frame& frame) { presentFrame(frame); }};
 }; 
\ No newline at end of file
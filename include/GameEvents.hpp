@@ -0,0 +1,90 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Gameplay events, emitted by the system where the thing happens (the player
+// jumping, physics landing it, Game's rules) and handled in one batch per
+// frame by audio, UI and the debug panel's counts (Game::dispatchGameEvents),
+// instead of each consumer comparing state every step. Emit from the
+// simulation thread only; the queue is not synchronized.
+enum class GameEventType : uint8_t {
+    Jumped,         // Player left the ground by jumping
+    Landed,         // Player touched down; value is the fall speed
+    PlayerHit,      // value is the enemy's index, -1 for a shot
+    PlayerDied,     // Fell off the level
+    LevelComplete,  // Reached the right edge; value is the next level
+    LevelExitBack,  // Reached the left edge; value is the previous level
+    GameComplete,   // Reached the end of the last level
+    TriggerEnter,   // Player entered a trigger; value is its index in the level's triggers
+    TriggerStay,    // Once per step while the player is in it
+    TriggerExit,
+    PlayerStruck,   // By a projectile or hitbox (ProjectileSystem); value is the player's index (0)
+    EnemyStruck,    // value is the enemy's index
+    NPCStruck,      // value is the NPC's index
+    Count
+};
+
+inline const char* toString(GameEventType type) {
+    switch (type) {
+        case GameEventType::Jumped: return "jumped";
+        case GameEventType::Landed: return "landed";
+        case GameEventType::PlayerHit: return "player hit";
+        case GameEventType::PlayerDied: return "player died";
+        case GameEventType::LevelComplete: return "level complete";
+        case GameEventType::LevelExitBack: return "level exit back";
+        case GameEventType::GameComplete: return "game complete";
+        case GameEventType::TriggerEnter: return "trigger enter";
+        case GameEventType::TriggerStay: return "trigger stay";
+        case GameEventType::TriggerExit: return "trigger exit";
+        case GameEventType::PlayerStruck: return "player struck";
+        case GameEventType::EnemyStruck: return "enemy struck";
+        case GameEventType::NPCStruck: return "NPC struck";
+        default: return "?";
+    }
+}
+
+struct GameEvent {
+    GameEventType type;
+    sf::Vector2f position;  // Where it happened
+    float value;
+};
+
+class GameEventQueue {
+public:
+    static constexpr size_t TYPE_COUNT = static_cast<size_t>(GameEventType::Count);
+
+    void emit(GameEventType type, const sf::Vector2f& position, float value = 0.0f) {
+        events.push_back(GameEvent{type, position, value});
+        totals[static_cast<size_t>(type)]++;
+    }
+
+    // Everything emitted since the last clear, in order
+    const std::vector<GameEvent>& getEvents() const { return events; }
+    // Once the consumers have seen this frame's events; the buffer keeps its capacity
+    void clear() {
+        lastFrameCount = events.size();
+        events.clear();
+    }
+
+    // Drops what was emitted after the first 'count' events (steps a rollback ran again)
+    void discardFrom(size_t count) {
+        for (size_t i = count; i < events.size(); ++i) {
+            totals[static_cast<size_t>(events[i].type)]--;
+        }
+        if (count < events.size()) {
+            events.resize(count);
+        }
+    }
+
+    size_t getLastFrameCount() const { return lastFrameCount; }
+    uint64_t getTotal(GameEventType type) const { return totals[static_cast<size_t>(type)]; }
+    void resetTotals() { totals.fill(0); }
+
+private:
+    std::vector<GameEvent> events;
+    std::array<uint64_t, TYPE_COUNT> totals{};
+    size_t lastFrameCount = 0;
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// GPU time per render pass from OpenGL timer queries (GL_TIME_ELAPSED, core
+// in GL 3.3 or ARB_timer_query; the entry points are looked up through SFML,
+// so nothing links against GL directly). Elapsed-time queries can't nest, so
+// a frame is a run of spans, each charged to one pass: begin() ends the span
+// in flight and opens the next one only when the pass changes. Each frame
+// records into its own query set and a set is read back FRAME_LATENCY frames
+// later, when the GPU has long finished it, so reading never stalls the
+// pipeline. Should a set's results still not be in by then, the frame that
+// would reuse it goes unmeasured rather than waiting.
+//
+// Render thread only (whichever thread holds the window's context); the game
+// thread reads getLastFrame() once that thread is idle, as it does the render
+// stats. Without timer queries every call is a no-op and isAvailable() is false.
+class GpuTimer {
+public:
+    enum class Pass : uint8_t {
+        Background,
+        Tiles,    // Decorations, platforms, ladders
+        Entities, // Player, enemies, NPCs, particles
+        Debug,
+        MiniMap,
+        UI,
+        ImGui,
+        Lighting, // Lightmap accumulation and its composite
+        Present,  // Scaling the scene target up to the window
+        Count
+    };
+    static constexpr size_t PASS_COUNT = static_cast<size_t>(Pass::Count);
+    static constexpr size_t FRAME_LATENCY = 3; // Query sets in flight
+    static constexpr size_t MAX_SPANS = 64;    // Per frame; switches past that stay in the last span
+
+    static const char* getPassName(Pass pass);
+
+    struct Frame {
+        uint64_t index = 0;                // Of the frame measured; 0 until one is in
+        std::array<float, PASS_COUNT> ms{};
+        float totalMs = 0.0f;
+    };
+
+    ~GpuTimer() = default; // Queries are left to the context's own teardown
+
+    // Collects the results of the frame FRAME_LATENCY frames back. The first
+    // call (with a context active) loads the GL entry points.
+    void beginFrame();
+    void begin(Pass pass);
+    void endFrame(); // Ends the span in flight
+
+    bool isAvailable() const { return available; }
+    const Frame& getLastFrame() const { return lastFrame; }
+    // Exponential average of recent frames, steadier to read than the last one
+    const Frame& getAverage() const { return average; }
+
+private:
+    struct Span {
+        uint32_t query = 0;
+        Pass pass = Pass::Background;
+    };
+    struct QuerySet {
+        std::array<Span, MAX_SPANS> spans{};
+        size_t used = 0;
+        uint64_t frame = 0;
+        bool pending = false; // Recorded but not yet read back
+    };
+
+    bool initialize();
+    bool collect(QuerySet& set); // False while the results aren't available
+    void closeSpan();
+
+    bool initialized = false;
+    bool available = false;
+    uint64_t contextId = 0;
+    std::array<QuerySet, FRAME_LATENCY> sets{};
+    size_t current = 0;
+    uint64_t frameCounter = 0;
+    bool recording = false; // This frame has a free query set
+    bool spanOpen = false;
+    Pass openPass = Pass::Background;
+    Frame lastFrame;
+    Frame average;
+};
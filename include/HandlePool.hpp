@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class SimSnapshot;
+
+// Generational handles for records the caller keeps densely packed (and
+// swap-removes) in its own arrays. A handle names a slot; the slot holds the
+// record's current dense index and a generation that is bumped on release, so
+// a handle kept past its record's removal finds nothing rather than whichever
+// record reused the slot. Released slots go on a free list and are taken
+// before the table grows, so once warmed up acquire, release and find are
+// constant time and never allocate.
+class HandlePool {
+public:
+    using Handle = uint32_t; // Slot in the low SLOT_BITS, generation above; always fits an int
+    static constexpr uint32_t SLOT_BITS = 20;
+    static constexpr uint32_t GENERATION_BITS = 11;
+    static constexpr Handle INVALID = UINT32_MAX;
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+    struct Stats {
+        size_t live = 0;
+        size_t capacity = 0;  // Slots ever created (live + free)
+        size_t peak = 0;      // Most live at once since the last clear
+    };
+
+    void reserve(size_t count);
+    void clear(); // Invalidates every handle; the slots stay for reuse
+
+    // A handle for the record now at dense 'index'; INVALID once every slot is taken
+    Handle acquire(uint32_t index);
+    // Frees the handle's slot and returns the record's dense index (NOT_FOUND if stale)
+    uint32_t release(Handle handle);
+    // The record's dense index, NOT_FOUND if the handle is stale or invalid
+    uint32_t find(Handle handle) const;
+    // The record moved to dense 'index' (the survivor of a swap-remove)
+    void relocate(Handle handle, uint32_t index);
+
+    size_t size() const { return live; }
+    Stats getStats() const { return Stats{live, slots.size(), peak}; }
+
+    // Save states: the slot table and free list as they are
+    void saveState(SimSnapshot& snapshot) const;
+    bool loadState(SimSnapshot& snapshot);
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static constexpr uint32_t SLOT_MASK = (1u << SLOT_BITS) - 1;
+    static constexpr uint32_t GENERATION_MASK = (1u << GENERATION_BITS) - 1;
+
+    struct Slot {
+        uint32_t index = NONE;     // Dense index while live, next free slot otherwise
+        uint32_t generation = 0;
+        bool live = false;
+    };
+
+    static uint32_t slotOf(Handle handle) { return handle & SLOT_MASK; }
+    static uint32_t generationOf(Handle handle) { return (handle >> SLOT_BITS) & GENERATION_MASK; }
+
+    std::vector<Slot> slots;
+    uint32_t freeHead = NONE;
+    size_t live = 0;
+    size_t peak = 0;
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include "Profiler.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+// Catches hitches with nobody at the profiler. The profiler already keeps the
+// last Profiler::FRAME_HISTORY frames in memory: their zones, events and the
+// counters plotted with them (render, audio, job lanes). update() looks at
+// each frame as it closes; one that took over getFactor() times the frame
+// budget is a hitch. FRAMES_AFTER frames later, write() copies the whole
+// history, the hitch and what led up to it and followed, and a worker thread
+// formats it as Chrome Trace JSON and writes it. Nothing touches the disk
+// until then.
+//
+// Detection arms once the history is full, so startup doesn't count and every
+// trace has its lead-up. Hitches within COOLDOWN_SECONDS of the last one
+// written are counted but not written: a bad patch makes one trace, and the
+// copy never sets off the next. Everything but the worker runs on the main
+// thread.
+class HitchDetector {
+public:
+    static constexpr double DEFAULT_FACTOR = 2.0;
+    static constexpr size_t FRAMES_AFTER = 60;      // Of the history; the rest is before the hitch
+    static constexpr double COOLDOWN_SECONDS = 10.0;
+
+    struct Hitch {
+        uint64_t frame = 0;   // Profiler frame index
+        double ms = 0.0;
+        double budgetMs = 0.0;
+        std::string path;     // Of its trace, once write() has been called
+    };
+
+    struct Stats {
+        uint64_t hitches = 0;
+        uint64_t written = 0;
+        uint64_t skipped = 0; // In a cooldown, or while another trace was pending
+        uint64_t failed = 0;  // Writes that didn't make it to disk
+    };
+
+    HitchDetector() = default;
+    ~HitchDetector(); // Finishes every queued write
+
+    HitchDetector(const HitchDetector&) = delete;
+    HitchDetector& operator=(const HitchDetector&) = delete;
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled; }
+    void setFactor(double value) { factor = value; }
+    double getFactor() const { return factor; }
+
+    // After PROFILE_FRAME, with what a frame is meant to take. True when a
+    // hitch's window is complete; write() it then.
+    bool update(double budgetMs);
+    // Queues the history for the worker to write to 'path'
+    void write(const std::string& path);
+
+    bool isPending() const { return pending; }
+    const Hitch& getLastHitch() const { return lastHitch; } // Written or pending
+    Stats getStats() const;
+
+private:
+    void workerLoop();
+
+    bool enabled = true;
+    double factor = DEFAULT_FACTOR;
+    uint64_t lastFrame = 0;   // Newest profiler frame seen
+    bool seenFrame = false;
+    bool pending = false;     // A hitch waiting for its FRAMES_AFTER
+    uint64_t lastWrittenNs = 0;
+    bool hasWritten = false;
+    Hitch lastHitch;
+
+    // Worker
+    mutable std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::deque<std::pair<std::string, Profiler::HistorySnapshot>> jobs;
+    std::thread worker;
+    bool stopping = false;
+    Stats stats; // Guarded by jobMutex
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "RenderSnapshot.hpp"
+
+// Retained screen-space HUD: texts and boxes laid out once and baked into one
+// triangle list, drawn in the UI view. A widget is only re-laid out when its
+// string, style, placement or the view size changes; setters given the value
+// a widget already has do nothing, so callers can set every frame.
+//
+// Glyphs are placed the way sf::Text places them (outline quads under the
+// fill), sampling the font's glyph page for their character size; boxes use
+// the white texel at (1, 1) of a page, like MessageBubbleCache. Consecutive
+// visible widgets on the same page become one draw.
+class HudLayer {
+public:
+    using WidgetId = uint32_t;
+    static constexpr WidgetId NO_WIDGET = UINT32_MAX;
+
+    enum class Placement : uint8_t {
+        Absolute,   // Text origin at the position, as sf::Text::setPosition
+        TopCentred, // Centred across the view, position.y from the top
+        Centred,    // Centred in the view, moved by the position
+    };
+
+    struct TextStyle {
+        unsigned characterSize = 30;
+        sf::Color fill = sf::Color::White;
+        sf::Color outline = sf::Color::Black;
+        float outlineThickness = 0.f;
+        float letterSpacing = 1.f; // sf::Text's factor
+    };
+
+    // 'font' must outlive the layer (or be replaced with setFont)
+    explicit HudLayer(const sf::Font& font);
+
+    // Widgets draw in the order they were added
+    WidgetId addText(const std::string& text, const TextStyle& style, Placement placement, const sf::Vector2f& position);
+    // A box samples the glyph page of 'characterSize'; give it the size of the
+    // texts drawn next to it so they share a draw
+    WidgetId addBox(const sf::FloatRect& rect, const sf::Color& fill, const sf::Color& outline, float outlineThickness,
+                    unsigned characterSize);
+
+    void setString(WidgetId id, const std::string& text); // UTF-8
+    void setFillColor(WidgetId id, const sf::Color& color);
+    void setPlacement(WidgetId id, Placement placement, const sf::Vector2f& position);
+    void setVisible(WidgetId id, bool visible);
+    void setFont(const sf::Font& font);
+    void setViewSize(const sf::Vector2f& size);
+
+    // Rebuilds what changed, then records one drawTriangles per run of same-page widgets
+    void draw(RenderSnapshot& snapshot, RenderCategory category);
+
+    size_t getRebuildCount() const { return rebuilds; } // Widget layouts redone since creation
+
+private:
+    struct Widget {
+        bool isText = true;
+        bool visible = true;
+        bool dirty = true;       // Glyphs or box need rebuilding
+        std::string text;
+        TextStyle style;
+        Placement placement = Placement::Absolute;
+        sf::Vector2f position;
+        sf::FloatRect box;       // Boxes
+        sf::FloatRect bounds;    // Texts: local bounds, as sf::Text::getLocalBounds
+        std::vector<sf::Vertex> vertices; // Texts relative to their origin, boxes in view pixels
+    };
+
+    void buildText(Widget& widget) const;
+    void buildBox(Widget& widget) const;
+    sf::Vector2f getOrigin(const Widget& widget) const;
+
+    const sf::Font* font;
+    std::vector<Widget> widgets;
+    sf::Vector2f viewSize;
+    std::vector<sf::Vertex> baked;          // Every visible widget, placed
+    std::vector<size_t> runEnds;            // Per run of one page: its end in 'baked'
+    std::vector<const sf::Texture*> runPages;
+    bool bakeDirty = true;
+    size_t rebuilds = 0;
+};
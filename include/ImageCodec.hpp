@@ -0,0 +1,63 @@
+#pragma once
+#include <SFML/Graphics/Image.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Image decoding shared by every loader (AssetManager, TextureAtlas, the
+// thumbnails). Pack entries that asset_packer stored pre-decoded
+// (AssetPack::Format::RawImage) are RGBA pixels in LZ4's block format, so
+// loading one is a bounds-checked decompress straight into the pixel buffer;
+// PNG and everything else goes through SFML's decoder. Both paths are timed
+// for the startup breakdown.
+//
+// Raw image payload (little-endian): RawHeader, then 'storedSize' bytes of
+// LZ4 block data, or the plain pixels when storedSize == width * height * 4.
+namespace ImageCodec {
+
+constexpr char MAGIC[4] = {'R', 'I', 'M', 'G'};
+
+struct RawHeader {
+    char magic[4];
+    uint32_t width;
+    uint32_t height;
+    uint32_t storedSize;
+};
+
+// Decoded bytes (RGBA) and thread time per path since startup; any thread
+struct Stats {
+    uint64_t rawImages = 0;
+    uint64_t rawBytes = 0;
+    uint64_t rawNs = 0;
+    uint64_t codecImages = 0;
+    uint64_t codecBytes = 0;
+    uint64_t codecNs = 0;
+};
+
+// 'path' from the mounted asset pack, else the loose file
+bool load(const std::string& path, sf::Image& image);
+// A raw image, or any file format SFML reads
+bool decode(const char* data, size_t size, sf::Image& image);
+
+// Raw images without an sf::Image: the size from the header, then the pixels
+// into a caller buffer of at least width * height * 4 bytes
+bool isRaw(const char* data, size_t size);
+bool readRawSize(const char* data, size_t size, sf::Vector2u& out);
+bool decodeRaw(const char* data, size_t size, uint8_t* pixels, size_t capacity);
+// The payload asset_packer stores for 'pixels' (RGBA, size.x * size.y * 4 bytes)
+std::vector<char> encodeRaw(const uint8_t* pixels, const sf::Vector2u& size);
+
+// LZ4 block format, no frame. compress needs compressBound(size) bytes of
+// room and returns the compressed size; decompress fails unless the input
+// decodes to exactly 'outSize' bytes without reading or writing out of bounds.
+size_t compressBound(size_t size);
+size_t compress(const uint8_t* source, size_t size, uint8_t* destination);
+bool decompress(const uint8_t* source, size_t size, uint8_t* destination, size_t outSize);
+
+Stats getStats();
+inline double getMegabytesPerSecond(uint64_t bytes, uint64_t ns) {
+    return ns > 0 ? (bytes / (1024.0 * 1024.0)) / (ns / 1e9) : 0.0;
+}
+
+} // namespace ImageCodec
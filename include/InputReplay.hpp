@@ -0,0 +1,90 @@
+#pragma once
+#include "InputSystem.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A recorded play session: the level and tile seed it started from, and for
+// every rendered frame how many fixed steps ran, the interpolation alpha the
+// camera used and the controls of each step. Playing it back runs the same
+// steps in the same frames, so streaming, AI level of detail and everything
+// else that follows the camera line up with the original run, whatever the
+// playback machine's frame rate. The recording also keeps the state it ended
+// in (EndState), so a playback that reaches the last frame can check it ended
+// in the same one.
+//
+// Files are little-endian, written from the structs as they are: a FileHeader,
+// then the per-frame step counts (a byte each), the per-frame alphas (uint16,
+// scaled to 0..65535) and the buttons of every step (a byte each).
+class InputReplay {
+public:
+    struct Header {
+        int level = 1;
+        uint32_t tileSeed = 0;      // RenderingSystem::setRandomSeed
+        float fixedTimeStep = 1.0f / 60.0f;
+    };
+
+    static constexpr char MAGIC[4] = {'R', 'P', 'L', 'Y'};
+    static constexpr uint32_t VERSION = 2;
+
+    // Where the player and enemies were when recording stopped. The enemies
+    // are one FNV-1a (32-bit) hash of their positions and velocities.
+    struct EndState {
+        float playerX = 0.0f, playerY = 0.0f;
+        float playerVelX = 0.0f, playerVelY = 0.0f;
+        uint32_t enemyCount = 0;
+        uint32_t enemyHash = 0;
+
+        bool operator==(const EndState& other) const {
+            return playerX == other.playerX && playerY == other.playerY && playerVelX == other.playerVelX &&
+                   playerVelY == other.playerVelY && enemyCount == other.enemyCount && enemyHash == other.enemyHash;
+        }
+        bool operator!=(const EndState& other) const { return !(*this == other); }
+    };
+    static constexpr uint32_t HASH_SEED = 2166136261u;
+    static uint32_t hashFloats(uint32_t hash, const float* values, size_t count); // Mixes their bits into 'hash'
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t level;
+        uint32_t tileSeed;
+        float fixedTimeStep;
+        uint32_t frameCount;
+        uint32_t tickCount;
+        EndState endState;
+    };
+
+    void begin(const Header& header);
+    void addTick(uint8_t buttons) { tickButtons.push_back(buttons); frameTickCount++; }
+    void endFrame(float alpha);
+    void setEndState(const EndState& state) { endState = state; }
+
+    bool save(const std::string& path, std::string& error) const;
+    bool load(const std::string& path, std::string& error); // Replaces what was recorded, rewinds
+
+    // Playback: false once every frame has been handed out
+    bool nextFrame(uint8_t& ticks, float& alpha);
+    uint8_t nextTick() { return tickButtons[tickCursor++]; }
+    void rewind() { frameCursor = tickCursor = 0; }
+
+    // The steps' controls as a game_bench script
+    void toScript(std::vector<InputSystem::ScriptStep>& script) const;
+
+    const Header& getHeader() const { return header; }
+    size_t getFrameCount() const { return frameTicks.size(); }
+    size_t getTickCount() const { return tickButtons.size(); }
+    size_t getFrameCursor() const { return frameCursor; }
+    bool isFinished() const { return frameCursor >= frameTicks.size(); } // Every frame played
+    const EndState& getEndState() const { return endState; }
+
+private:
+    Header header;
+    EndState endState;
+    std::vector<uint8_t> frameTicks;
+    std::vector<uint16_t> frameAlphas;
+    std::vector<uint8_t> tickButtons;
+    uint8_t frameTickCount = 0;  // Steps added since the last endFrame
+    size_t frameCursor = 0;
+    size_t tickCursor = 0;
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <SFML/Window.hpp>
+#include "Player.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Player controls, fed from window events rather than polled inside the step.
+// handleEvents passes every event here; key events for the controls are
+// stamped and queued, and each fixed step takes what arrived before it. A
+// step takes at most one change per button, so a tap shorter than a step
+// still holds the button for one. Late latch also samples the keyboard right
+// before each step, which picks up presses the event queue hasn't delivered.
+//
+// The controls of every step can be recorded and saved in game_bench's script
+// format ("<ticks> <keys>" lines), which the bench replays deterministically.
+class InputSystem {
+public:
+    enum Button : uint8_t {
+        Left = 1 << 0,
+        Right = 1 << 1,
+        Up = 1 << 2,
+        Down = 1 << 3,
+        Jump = 1 << 4
+    };
+
+    // 'buttons' held for 'ticks' fixed steps
+    struct ScriptStep {
+        size_t ticks = 0;
+        uint8_t buttons = 0;
+    };
+
+    struct Stats {
+        size_t events = 0;          // Key events steps took since the last takeStats
+        double meanLatencyMs = 0.0; // From capture to the step that took the event
+        double maxLatencyMs = 0.0;
+    };
+
+    static constexpr size_t MAX_PENDING = 64; // Older events are applied at once (no steps while paused)
+
+    // True for the keys the controls use. Focus loss releases everything, as
+    // the window never sees those keys come up.
+    bool handleEvent(const sf::Event& event);
+    void releaseAll();
+
+    // Controls for the next fixed step
+    PlayerInput takeTick();
+
+    void setLateLatch(bool enabled) { lateLatch = enabled; }
+    bool isLateLatch() const { return lateLatch; }
+
+    // Recording starts empty; the buffer keeps its capacity across recordings
+    void startRecording();
+    void stopRecording() { recording = false; }
+    bool isRecording() const { return recording; }
+    size_t getRecordedTicks() const { return recorded.size(); }
+    bool saveRecording(const std::string& path, std::string& error) const;
+
+    Stats takeStats();
+
+    static PlayerInput toPlayerInput(uint8_t buttons);
+    static uint8_t fromPlayerInput(const PlayerInput& input);
+    // Script keys: any of L R U D J, or - for none
+    static uint8_t parseButtons(const std::string& keys);
+    static std::string formatButtons(uint8_t buttons);
+    static bool loadScript(const std::string& path, std::vector<ScriptStep>& script, std::string& error);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct KeyEvent {
+        Clock::time_point time;
+        uint8_t button;
+        bool pressed;
+    };
+
+    static uint8_t buttonFor(sf::Keyboard::Key key);
+    void apply(const KeyEvent& event);
+
+    std::vector<KeyEvent> pending; // [pendingHead, size) not yet taken by a step
+    size_t pendingHead = 0;
+    uint8_t held = 0;              // After the events steps have taken
+    uint8_t queued = 0;            // After every queued event; drops key repeats
+    bool lateLatch = false;
+
+    bool recording = false;
+    std::vector<uint8_t> recorded; // One entry per step
+
+    size_t statEvents = 0;
+    double statLatencyMs = 0.0;
+    double statMaxLatencyMs = 0.0;
+};
@@ -0,0 +1,129 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pin each worker to its own core (worker i on core i, leaving core 0 to the
+// main thread). Linux only; cmake -DGAME_PIN_WORKERS=ON
+#ifndef GAME_PIN_WORKERS
+#define GAME_PIN_WORKERS 0
+#endif
+
+// Small work-stealing job system, and the one pool background work runs on.
+// A fixed pool of workers (hardware_concurrency - 1 by default, at least one;
+// the calling thread is the extra worker) each own a task deque. parallelFor
+// splits a range into chunks, deals them out across the deques, and the caller
+// helps execute until every chunk is done. Idle workers steal from the front
+// of other deques.
+//
+// Which thread runs which chunk is timing dependent, so bodies must only write to
+// the elements of their own range; then the result matches a serial loop exactly.
+// Tasks must not throw. parallelFor should be called from one thread at a time.
+//
+// Background jobs go through submit() into a priority lane. A worker only
+// takes one when no frame chunk is waiting, picks the highest lane first, and
+// at most getWorkerCount() - 1 of them run at once (with two or more workers),
+// so a PNG decode never holds up a parallelFor: the caller and the spare worker
+// take the chunks dealt to a busy worker. A running job is never interrupted.
+class JobSystem {
+public:
+    using RangeFunction = std::function<void(size_t begin, size_t end)>;
+    using Job = std::function<void()>;
+
+    // Highest priority first. Frame is parallelFor's; the rest take submit()
+    enum class Lane : uint8_t {
+        Frame,     // Physics, animation and other per-frame chunks
+        Streaming, // Texture decodes the game is waiting on
+        Cooking,   // Background processing (asset index scans)
+        Thumbnail, // Editor previews
+        Count
+    };
+    static constexpr size_t LANE_COUNT = static_cast<size_t>(Lane::Count);
+
+    // Since construction; sample twice for a rate (see getLaneName for labels)
+    struct LaneStats {
+        size_t queued = 0;      // Waiting to run; always 0 for Frame
+        uint64_t completed = 0; // Jobs, or chunks for Frame
+        uint64_t busyNs = 0;    // Thread time spent running them
+    };
+
+    explicit JobSystem(unsigned workerCount = 0); // 0 = hardware_concurrency - 1
+    ~JobSystem(); // Jobs still queued are dropped; their owners wait for their own
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Run fn over [0, count) in chunks of at least 'grain' items.
+    // Runs inline when the range is a single chunk or there are no workers.
+    void parallelFor(size_t count, size_t grain, const RangeFunction& fn);
+
+    // Queue 'job' on a background lane (not Frame); any thread. Jobs of one
+    // lane start in submission order, but several may run at once.
+    void submit(Lane lane, Job job);
+
+    unsigned getWorkerCount() const { return static_cast<unsigned>(workers.size()); }
+    unsigned getThreadCount() const { return getWorkerCount() + 1; }
+
+    // Stats for the debug panel
+    size_t getLastChunkCount() const { return lastChunkCount; }
+    size_t getStealCount() const { return stealCount.load(std::memory_order_relaxed); }
+    LaneStats getLaneStats(Lane lane) const;
+    static const char* getLaneName(Lane lane);
+
+private:
+    struct Batch {
+        const RangeFunction* fn = nullptr;
+        std::atomic<size_t> remaining{0};
+    };
+
+    struct Task {
+        Batch* batch;
+        size_t begin;
+        size_t end;
+    };
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    struct LaneCounters {
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> busyNs{0};
+    };
+
+    void workerLoop(unsigned index);
+    bool popOwn(unsigned index, Task& task);
+    bool steal(unsigned thief, Task& task);
+    void execute(const Task& task);
+    bool popJob(Job& job, Lane& lane);
+    void runJob(Job& job, Lane lane);
+    bool canStartJob() const; // wakeMutex held
+
+    // Queue 0 belongs to the calling thread, 1..N to the workers
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+
+    mutable std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::atomic<size_t> pendingTasks{0};
+    std::atomic<bool> stopping{false};
+
+    // Background lanes, guarded by wakeMutex; index 0 (Frame) stays empty
+    std::array<std::deque<Job>, LANE_COUNT> laneJobs;
+    size_t queuedJobs = 0;
+    unsigned runningJobs = 0;
+    unsigned maxRunningJobs = 1;
+
+    std::array<LaneCounters, LANE_COUNT> laneCounters;
+    size_t lastChunkCount = 0;
+    std::atomic<size_t> stealCount{0};
+};
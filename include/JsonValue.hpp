@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Minimal read-only JSON document for data files (levels). Supports the full
+// JSON grammar except that \u escapes outside ASCII are stored as UTF-8.
+// Lookups never throw: missing keys and wrong types return a shared null value
+// or the supplied default, so loaders can read optional fields directly.
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    // Parse a whole document. On failure 'error' says what went wrong and where.
+    static bool parse(std::string_view text, JsonValue& out, std::string& error);
+
+    Type getType() const { return type; }
+    bool isNull() const { return type == Type::Null; }
+    bool isNumber() const { return type == Type::Number; }
+    bool isString() const { return type == Type::String; }
+    bool isArray() const { return type == Type::Array; }
+    bool isObject() const { return type == Type::Object; }
+
+    bool asBool(bool fallback = false) const { return type == Type::Bool ? boolValue : fallback; }
+    double asNumber(double fallback = 0.0) const { return type == Type::Number ? numberValue : fallback; }
+    float asFloat(float fallback = 0.0f) const { return type == Type::Number ? static_cast<float>(numberValue) : fallback; }
+    const std::string& asString() const { return stringValue; } // Empty unless a string
+    std::string asString(const std::string& fallback) const { return type == Type::String ? stringValue : fallback; }
+
+    // Arrays
+    size_t size() const { return type == Type::Array ? elements.size() : 0; }
+    const JsonValue& operator[](size_t index) const;
+    const std::vector<JsonValue>& getElements() const { return elements; }
+
+    // Objects (members keep file order)
+    bool has(std::string_view key) const;
+    const JsonValue& operator[](std::string_view key) const;
+    const std::vector<std::pair<std::string, JsonValue>>& getMembers() const { return members; }
+
+private:
+    friend class JsonParser;
+
+    Type type = Type::Null;
+    bool boolValue = false;
+    double numberValue = 0.0;
+    std::string stringValue;
+    std::vector<JsonValue> elements;
+    std::vector<std::pair<std::string, JsonValue>> members;
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include "LevelLoader.hpp"
+#include "TileLayout.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+
+// A level's dependency manifest: the asset files loading it reads, derived
+// from its data the way the game picks them. That is the level file (cooked
+// and JSON), the main background (the first of it and its fallbacks that
+// exists), each background layer (or its tiles), the colour grade, the music track, the
+// platform tiles and, for a level with NPCs, their animation frames. Player,
+// enemy, font and sound assets every level uses are loaded at startup and
+// aren't listed.
+//
+// Which files exist is the caller's: the game asks the asset manifest,
+// asset_packer the files it packs, so both resolve the same candidates. The
+// game's loaders take their paths from here too, so the manifest can't drift
+// from what they load.
+namespace LevelAssets {
+
+using Exists = std::function<bool(const std::string& path)>;
+// Appends the files directly inside 'directory' to 'files'
+using ListDirectory = std::function<void(const std::string& directory, std::vector<std::string>& files)>;
+
+// Layer names, back to front (Game::initializeBackgroundLayers)
+constexpr const char* BACKGROUND_LAYERS[] = {"background1", "background2", "background3", "background4"};
+constexpr const char* TILES_DIRECTORY = "assets/images/platformer/tiles";
+constexpr const char* NPC_IDLE_CLIP = "assets/images/npc/separated/idle";
+constexpr const char* NPC_WALKING_CLIP = "assets/images/npc/separated/walking";
+constexpr const char* DEFAULT_MUSIC = "assets/audio/music/background";
+
+// The first of 'candidates' that exists; empty if none does
+std::string findFirst(const std::vector<std::string>& candidates, const Exists& exists);
+
+// As the game resolves them; empty when nothing exists
+std::string getBackgroundPath(const LevelData& data, const Exists& exists);
+std::string getBackgroundLayerPath(const std::string& layer, int level, const Exists& exists);
+// The level's tiled version of 'layer' (a TileLayout directory), which the
+// game prefers over the layer's single image; empty when it has none
+std::string getTiledLayerPath(const std::string& layer, int level, const Exists& exists);
+std::string getMusicStem(const LevelData& data);
+std::string getMusicPath(const LevelData& data, const Exists& exists); // The stem's first existing variant
+
+// Every file 'level' needs, sorted and without duplicates; directories are
+// expanded to the files directly inside them through 'list'
+void collect(const LevelData& data, int level, const Exists& exists, const ListDirectory& list,
+             std::vector<std::string>& out);
+
+} // namespace LevelAssets
@@ -0,0 +1,72 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+class JobSystem;
+
+// Keeps the asset pack's level bundles (see AssetPack.hpp) of the level being
+// played and the one being approached resident. Holding a level reads its
+// bundle ahead of the loaders: the range of the level's own files in one
+// sequential pass, plus the shared files no other held level had already
+// brought in. Shared files are reference counted per file across the held
+// bundles; what the last holder lets go of is handed back to the OS, and is
+// read again from the pack if a later level needs it.
+//
+// Reads run as one Streaming job per hold, queued ahead of the texture
+// decodes that follow, and don't block the caller. Without a mounted pack, or
+// for a level the pack has no bundle for, holding does nothing and the
+// loaders read files as they go.
+class LevelBundles {
+public:
+    struct Stats {
+        size_t heldLevels = 0;
+        size_t files = 0;        // Referenced by a held bundle
+        uint64_t bytes = 0;      // Their payloads
+        uint64_t readBytes = 0;  // By the reads so far
+        size_t reads = 0;        // Finished
+        double lastReadMs = 0.0;
+    };
+
+    LevelBundles() = default;
+    ~LevelBundles(); // Waits for reads in progress
+
+    LevelBundles(const LevelBundles&) = delete;
+    LevelBundles& operator=(const LevelBundles&) = delete;
+
+    // Reads go through this job system's Streaming lane; without one they run
+    // inline. Set before the first hold; 'jobs' must outlive this.
+    void setJobSystem(JobSystem* jobs) { jobSystem = jobs; }
+
+    // Holds the bundles of 'current' and 'next' (0 for none), releasing the rest
+    void hold(int current, int next = 0);
+    void releaseAll() { hold(0); }
+
+    bool isHeld(int level) const;
+    bool isReading() const;
+    Stats getStats() const;
+
+private:
+    struct Range {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    void acquire(int level, std::vector<Range>& reads);
+    void release(int level);
+    void read(std::vector<Range> ranges); // On a worker
+
+    JobSystem* jobSystem = nullptr;
+    std::vector<int> held;
+    std::vector<uint32_t> fileRefs; // Per pack entry
+
+    mutable std::mutex mutex;
+    std::condition_variable idle; // The destructor waits for reads
+    size_t runningReads = 0;
+    bool stopping = false;
+    uint64_t readBytes = 0;
+    size_t readCount = 0;
+    double lastReadMs = 0.0;
+};
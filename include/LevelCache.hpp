@@ -0,0 +1,73 @@
+#pragma once
+#include "AssetManager.hpp"
+#include "LevelLoader.hpp"
+#include "RenderingSystem.hpp"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// The last few levels the player left, kept built so walking back over a
+// boundary swaps one in instead of loading it again: the level data, the
+// renderer's decoration chunks and TextureRefs that keep the level's
+// backgrounds resident (unreferenced, they are the first the texture budget
+// evicts). The least recently left level goes first once more than
+// MAX_LEVELS are held or the textures they pin pass the budget. Main thread only.
+class LevelCache {
+public:
+    static constexpr size_t MAX_LEVELS = 3;
+    static constexpr size_t DEFAULT_BUDGET = 64ull * 1024 * 1024; // Pinned texture bytes
+
+    struct Entry {
+        int level = 0;
+        LevelData data;
+        std::shared_ptr<RenderingSystem::DecorationCache> decorations;
+        std::vector<AssetManager::TextureRef> textures; // Duplicates are fine; counted once each
+    };
+
+    struct Stats {
+        size_t levels = 0;
+        size_t textureBytes = 0;
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+    };
+
+    // Keeps 'entry' as the most recent, replacing one for the same level
+    void store(Entry&& entry);
+    // Moves the entry for 'level' out (it leaves the cache); false if none
+    bool take(int level, Entry& out);
+    const LevelData* peek(int level) const;
+    bool has(int level) const { return peek(level) != nullptr; }
+
+    void erase(int level);
+    template <typename Predicate>
+    void eraseIf(Predicate predicate) {
+        for (size_t i = entries.size(); i-- > 0;) {
+            if (predicate(entries[i].entry.level)) {
+                removeAt(i);
+            }
+        }
+    }
+    void clear();
+
+    void setBudget(size_t bytes);
+    size_t getBudget() const { return budget; }
+    Stats getStats() const;
+
+private:
+    struct Slot {
+        Entry entry;
+        size_t textureBytes = 0;
+    };
+
+    static size_t measure(const Entry& entry);
+    void removeAt(size_t index);
+    void enforceBudget();
+
+    std::vector<Slot> entries; // Least recently stored first
+    size_t budget = DEFAULT_BUDGET;
+    size_t textureBytes = 0;
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+};
@@ -0,0 +1,87 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "LevelLoader.hpp"
+
+class DebugDraw;
+
+// The Level Editor window (GAME_EDITOR builds): the current level's platforms,
+// ladders, decorations and spawn points, picked and dragged in the world or
+// typed into the panel, and saved back to the level's JSON. Edits go straight
+// into the LevelData and are also queued as Edit records (which record, and
+// its footprint before and after), so Game can update just what the record
+// touches (broadphase cells, tile chunks, the mini-map region, nav graph
+// edges) rather than rebuild the level.
+//
+// Spawn points are one list: the player spawn, the two entries, then the
+// enemy spawns and the NPCs. Nothing is derived from them while playing, so
+// moving one takes effect once saved, the next time the level starts.
+class LevelEditor {
+public:
+    enum class Layer : uint8_t { Platforms, Ladders, Decorations, Spawns };
+    static constexpr size_t SPAWN_POINTS = 3; // Spawn, entry left, entry right
+    static constexpr float MARKER_SIZE = 20.f; // Spawn points without a size of their own, world pixels
+
+    struct Edit {
+        enum class Type : uint8_t { Change, Add, Remove };
+        Type type = Type::Change;
+        Layer layer = Layer::Platforms;
+        size_t index = 0;      // Into the layer's records
+        sf::FloatRect before;  // World footprint; empty for an Add
+        sf::FloatRect after;   // Empty for a Remove
+    };
+
+    // A level was entered: drops the selection and saves to 'path' from now on
+    void reset(const std::string& path);
+
+    // Once per frame while open. 'mouseWorld' is the cursor in world pixels;
+    // clicks that ImGui doesn't take pick and drag in the world. 'locked'
+    // (netplay, replays) shows the level but allows no edits.
+    void draw(bool* open, LevelData& level, const sf::Vector2f& mouseWorld, bool locked);
+    // The selection and the record under the cursor, and the spawn points
+    void drawOverlay(DebugDraw& debugDraw, const LevelData& level) const;
+
+    // Moves the edits made since the last call into 'out' (cleared first)
+    void takeEdits(std::vector<Edit>& out);
+    // True once after each save, so the file watcher's report of it can be ignored
+    bool takeSaved();
+    bool hasUnsavedChanges() const { return unsaved; }
+
+    static size_t getCount(const LevelData& level, Layer layer);
+    static sf::FloatRect getBounds(const LevelData& level, Layer layer, size_t index);
+
+private:
+    static void setBounds(LevelData& level, Layer layer, size_t index, const sf::FloatRect& bounds);
+    static std::string getLabel(const LevelData& level, Layer layer, size_t index);
+
+    void drawList(const LevelData& level);
+    void drawProperties(LevelData& level);
+    int pick(const LevelData& level, const sf::Vector2f& point) const; // Topmost record there, -1 if none
+    float snap(float value) const;
+    sf::Vector2f snap(const sf::Vector2f& point) const { return sf::Vector2f(snap(point.x), snap(point.y)); }
+
+    // Each records the edit and marks the level unsaved
+    void change(LevelData& level, size_t index, const sf::FloatRect& bounds);
+    void touch(LevelData& level, size_t index); // A property other than the bounds changed
+    void add(LevelData& level, const sf::Vector2f& position, int copyOf);
+    void remove(LevelData& level, size_t index);
+    void save(const LevelData& level);
+
+    Layer layer = Layer::Platforms;
+    int selected = -1;
+    int hovered = -1;
+    bool dragging = false;
+    sf::Vector2f dragOffset; // Cursor to the dragged record's top-left
+    sf::Vector2f lastWorldMouse; // Where Add puts new records
+    bool snapping = true;
+    float gridSize = 0.f; // 0 until the level's tile size picks one
+
+    std::vector<Edit> edits;
+    std::string savePath;
+    std::string status;
+    bool unsaved = false;
+    bool saved = false;
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <vector>
+#include "LevelLoader.hpp"
+
+// The resident level's platforms or ladders as parallel plain arrays: world
+// pixel bounds, collision type and fill colour (the material). This is the one
+// copy physics, the platform tile cache, the mini-map and culling read; the
+// collision loops walk 'bounds' directly instead of recomposing a shape's
+// transform per getGlobalBounds() call, and drawing batches plain quads
+// (appendQuad) rather than keeping a shape per box.
+class LevelGeometry {
+public:
+    void clear();
+    void reserve(size_t count);
+    void add(const sf::FloatRect& bounds, const sf::Color& color, LevelData::Slope slope = LevelData::Slope::None);
+
+    size_t size() const { return bounds.size(); }
+    bool empty() const { return bounds.empty(); }
+
+    const std::vector<sf::FloatRect>& getBounds() const { return bounds; }
+    const sf::FloatRect& getBounds(size_t i) const { return bounds[i]; }
+    void setBounds(size_t i, const sf::FloatRect& box) { bounds[i] = box; }
+    LevelData::Slope getSlope(size_t i) const { return slopes[i]; }
+    void setSlope(size_t i, LevelData::Slope slope) { slopes[i] = slope; }
+    const sf::Color& getColor(size_t i) const { return colors[i]; }
+
+    // Two triangles filling box 'i', for drawing many boxes in one call
+    void appendQuad(size_t i, const sf::Color& color, std::vector<sf::Vertex>& out) const;
+
+private:
+    std::vector<sf::FloatRect> bounds;
+    std::vector<LevelData::Slope> slopes;
+    std::vector<sf::Color> colors;
+};
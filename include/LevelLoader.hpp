@@ -0,0 +1,162 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Everything Game needs to build one level, in flat plain-data arrays. All
+// positions are world pixels. LevelLoader clears rather than frees the arrays,
+// so reloading into the same LevelData reuses their storage.
+struct LevelData {
+    enum class Slope : uint8_t { None, Left, Right };
+    enum class DecorationKind : uint8_t { Other, Tree, Cabin, Snowman };
+    enum class DecorationPart : uint8_t { Whole, Top, Middle, Bottom };
+
+    struct Platform {
+        sf::FloatRect bounds;
+        Slope slope = Slope::None; // Collides as a ramp (see Narrowphase); drawn as a box
+    };
+    struct Ladder {
+        sf::FloatRect bounds;
+    };
+    struct Decoration {
+        sf::Vector2f position;
+        float height = 0.f;
+        DecorationKind kind = DecorationKind::Other;
+    };
+    // What one textured quad of a decoration covers: a tree is a column of
+    // cells (top, middle..., bottom), anything else a single quad
+    struct DecorationQuad {
+        sf::FloatRect bounds;
+        DecorationKind kind = DecorationKind::Other;
+        DecorationPart part = DecorationPart::Whole;
+        uint8_t depth = 0;          // Draw layer, 0 the farthest back
+    };
+    // Enemy archetype; enemyTypes[0] is the built-in patroller
+    struct EnemyType {
+        std::string name = "patroller";
+        sf::Vector2f size = sf::Vector2f(30.f, 30.f);
+        float speed = 2.f;          // Per step at 60 Hz
+        float gravity = 0.8f;       // Per step at 60 Hz
+        float patrolWidth = 100.f;  // Default for spawns that don't give one
+        sf::Color color = sf::Color(0, 100, 0);
+    };
+    struct EnemySpawn {
+        sf::Vector2f position;
+        float patrolWidth = 100.f;
+        uint16_t type = 0;          // Index into enemyTypes
+    };
+    struct NpcSpawn {
+        std::string id;
+        std::string texture;
+        sf::Vector2f position;
+    };
+    // A zone that reports the player entering, staying in and leaving it
+    // (Game::updateTriggers); the action is what Game does while they're in it
+    enum class TriggerAction : uint8_t {
+        Event,     // Nothing beyond the events, for scripts and effects
+        ExitNext,  // On to the next level (or the end of the game)
+        ExitBack,  // Back to the previous level
+        Kill,      // The player dies (fell off the level)
+    };
+    struct Trigger {
+        std::string id;              // Names it in logs and scripts; may be empty
+        sf::FloatRect bounds;
+        TriggerAction action = TriggerAction::Event;
+        bool grounded = false;       // Acts only while the player stands on the ground
+    };
+    // A torch or lamp: brightens the ambient light within 'radius', fading to its edge
+    struct Light {
+        sf::Vector2f position;
+        float radius = 120.f;
+        sf::Color color = sf::Color(255, 190, 120);
+    };
+
+    std::string name;
+    std::string source;         // File it was loaded from
+    sf::Vector2f size;          // Level extent in pixels
+    float tileSize = 30.f;      // Pixels per grid unit the level was drawn in
+    sf::Vector2f spawn;         // Start / respawn position
+    sf::Vector2f entryLeft;     // Arriving from the previous level
+    sf::Vector2f entryRight;    // Arriving back from the next level
+
+    std::string background;     // Main background texture and its fallbacks
+    std::vector<std::string> backgroundFallbacks;
+    std::string music;          // Track stem (SoundSystem::resolveAudioPath); empty for the default
+    sf::Color platformColor = sf::Color(200, 220, 255);
+    // Colour grading (RenderingSystem::setColorGrade): a LUT strip, and a tint
+    // over it that comes and goes once per dayLength seconds (0: always on)
+    std::string colorGrade;
+    sf::Color gradeTint = sf::Color::White;
+    float dayLength = 0.f;
+    // Light left where no Light reaches (RenderingSystem::setLights); white leaves the level unlit
+    sf::Color ambientLight = sf::Color::White;
+
+    float gravity = 15.f;
+    float jumpForce = 200.f;
+    float enemySpeed = 1.f;     // Scales the enemies' starting patrol speed
+
+    std::vector<Platform> platforms;
+    std::vector<Ladder> ladders;
+    std::vector<Decoration> decorations;
+    std::vector<DecorationQuad> decorationQuads; // Back to front; see LevelLoader::resolveDecorations
+    std::vector<EnemyType> enemyTypes = std::vector<EnemyType>(1);
+    std::vector<EnemySpawn> enemies;
+    std::vector<NpcSpawn> npcs;
+    std::vector<Trigger> triggers;
+    std::vector<Light> lights;
+
+    void clear();
+};
+
+// Reads level descriptions from assets/levels (asset pack first, then disk).
+// Cooked .lvl files (see CookedLevel.hpp) are preferred over the JSON they were
+// made from, unless the loose JSON is newer than its loose cooked file.
+//
+// Layout: "width"/"height" plus "layers" with "terrain", "ladders", "decoration",
+// "enemies", "npcs", "triggers" and "lights" arrays. Coordinates are in units of "tile_size" pixels
+// (default 30, the grid winter_level.json was drawn on). Optional "theme"
+// (with "background", "background_fallbacks", "platform_color", "music",
+// "color_grade", "grade_tint", "day_length" and "ambient_light"),
+// "physics", "enemy_speed", "spawn", "entry_left" and "entry_right" override defaults.
+// "enemy_types" maps archetype names to "width"/"height" (tiles), "speed",
+// "gravity", "patrol" and "color"; an enemy's "type" picks one ("patroller",
+// the built-in default, may be overridden). A trigger is a box with an "id",
+// an "action" ("event", "exit_next", "exit_back" or "kill") and "grounded";
+// a level without a "triggers" layer gets addDefaultTriggers(). A light has
+// "x", "y", "radius" (tiles) and "color".
+namespace LevelLoader {
+
+std::string getLevelPath(int level);       // assets/levels/level<N>.json
+std::string getCookedLevelPath(int level); // assets/levels/level<N>.lvl
+bool levelExists(int level);
+
+// Cooked file if usable, else the JSON. On failure 'error' says why and 'out' is left cleared.
+bool loadLevel(int level, LevelData& out, std::string& error);
+
+// JSON
+bool loadFromFile(const std::string& path, LevelData& out, std::string& error);
+bool loadFromMemory(const char* data, size_t size, LevelData& out, std::string& error);
+
+// Writes the level back as JSON in the layout above, coordinates divided by
+// its tile_size again (the level editor's save). Written to a temporary file
+// first and renamed over 'path', so a failed save leaves the old file intact.
+// Terrain entries other than platforms were dropped on load and are not kept.
+bool saveToFile(const LevelData& level, const std::string& path, std::string& error);
+
+// Cooked binary: records are validated and copied out of the mapping, nothing is parsed
+bool loadCookedFromFile(const std::string& path, LevelData& out, std::string& error);
+bool loadCookedFromMemory(const char* data, size_t size, LevelData& out, std::string& error);
+
+// Cuts the decorations into quads and sorts them back to front by depth (the
+// cabin, then trees, then snowmen). The JSON loader runs it; cooked files
+// store its result.
+void resolveDecorations(LevelData& level);
+// The exits and the fall zone every level used to have built into Game: exit
+// to the next level past 50 px from the right edge and back within 10 px of
+// the left, both while on the ground, and death 200 px below the level
+void addDefaultTriggers(LevelData& level);
+// World footprint of one decoration, the quads resolveDecorations cuts it into together
+sf::FloatRect getDecorationBounds(const LevelData& level, const LevelData::Decoration& decoration);
+
+} // namespace LevelLoader
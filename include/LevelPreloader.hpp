@@ -0,0 +1,56 @@
+#pragma once
+#include "LevelLoader.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Loads one level's data on a background thread ahead of the transition into
+// it. Game requests the neighbouring level as the player nears an edge; the
+// load at the end of the transition then takes the data over by swapping it
+// into place instead of reading and parsing the file.
+class LevelPreloader {
+public:
+    LevelPreloader();
+    ~LevelPreloader(); // Waits for a load in progress
+
+    LevelPreloader(const LevelPreloader&) = delete;
+    LevelPreloader& operator=(const LevelPreloader&) = delete;
+
+    // Starts loading 'level' unless it is the one already held; true if started.
+    // Drops a different level loaded (or loading) before.
+    bool request(int level);
+    void cancel();
+
+    bool has(int level) const { return heldLevel != 0 && heldLevel == level; }
+    int getLevel() const { return heldLevel; }
+    bool isReady() const;
+    // The loaded data, nullptr while 'level' is still loading, failed or isn't held
+    const LevelData* peek(int level) const;
+    double getLoadMs() const;
+
+    // Swaps the data of 'level' into 'out', waiting for the load if needed;
+    // returns and reports like LevelLoader::loadLevel. 'out's previous
+    // contents are kept for reuse by the next request.
+    bool take(int level, LevelData& out, std::string& error);
+
+private:
+    void loaderLoop();
+    void waitIdle(std::unique_lock<std::mutex>& lock);
+
+    int heldLevel = 0;              // Requested and not taken; 0 for none (main thread)
+
+    // Loader thread; 'data', 'loadError', 'loaded' and 'loadMs' belong to it
+    // while a load is queued or running
+    mutable std::mutex mutex;
+    std::condition_variable loadCondition; // Loader waits for a request
+    std::condition_variable idleCondition; // take/cancel wait for the loader
+    int queuedLevel = 0;
+    bool busy = false;
+    bool stopping = false;
+    LevelData data;
+    std::string loadError;
+    bool loaded = false;
+    double loadMs = 0.0;
+    std::thread loader;
+};
@@ -0,0 +1,155 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "EnemyStore.hpp"
+#include "FrameArena.hpp"
+#include "LevelGeometry.hpp"
+#include "LevelLoader.hpp"
+
+// Splits a level into fixed-width horizontal sectors and keeps only the ones
+// around the camera resident. Sector contents (enemies) are built on a loader
+// thread and adopted by the main thread in update(); platforms and ladders are
+// copied straight from the level's bounds when collected.
+//
+// A sector is requested once the camera comes within LOAD_MARGIN of it and
+// evicted only when it is more than EVICT_MARGIN away, so walking back and
+// forth over a boundary doesn't thrash. Platforms spanning several sectors are
+// resident while any of them is. Enemies belong to the sector they spawned in
+// and keep their state while it is evicted.
+class LevelStreamer {
+public:
+    struct Stats {
+        size_t sectorCount = 0;
+        size_t activeSectors = 0;
+        size_t pendingSectors = 0;  // Queued or being built
+        size_t loads = 0;           // Since setLevel
+        size_t evictions = 0;
+        float activeLeft = 0.f;     // World x range covered by active sectors
+        float activeRight = 0.f;
+    };
+
+    static constexpr float SECTOR_WIDTH = 1024.f;
+    static constexpr float LOAD_MARGIN = SECTOR_WIDTH * 0.5f;
+    static constexpr float EVICT_MARGIN = SECTOR_WIDTH * 1.5f;
+    static constexpr sf::Color LADDER_COLOR{139, 90, 43};
+
+    LevelStreamer();
+    ~LevelStreamer();
+
+    LevelStreamer(const LevelStreamer&) = delete;
+    LevelStreamer& operator=(const LevelStreamer&) = delete;
+
+    // Drops every sector (and pending load) and buckets the new level's records.
+    // The level is copied, so 'level' may change afterwards.
+    void setLevel(const LevelData& level, const sf::Color& platformColor);
+    // Drops every sector and pending load and lets go of the level's tables,
+    // which live in the level arena (FrameArena::level()), so it can be reset
+    void clear();
+
+    // Builds the sectors covering [left, right] (plus LOAD_MARGIN) on the calling
+    // thread, so a freshly entered level has ground under the player.
+    void loadNow(float left, float right);
+
+    // Adopts finished loads, requests sectors near [left, right] and evicts far
+    // ones. Sectors [left, right] itself overlaps are built inline if still
+    // missing. Returns true when the active set changed and collect() is due.
+    bool update(float left, float right);
+
+    // Writes the previous active enemies back to their sectors, then fills the
+    // geometry and enemies with the active sectors' contents (in sector order)
+    void collect(LevelGeometry& platforms, LevelGeometry& ladders, EnemyStore& enemies);
+
+    // Level editor edits to the level copy. The move calls re-bucket one
+    // record and return true when it entered or left the active sectors, so
+    // collect() is due; otherwise it is where the last collect() put it, if
+    // anywhere (findActive*, -1 when not resident).
+    bool movePlatform(uint32_t index, const sf::FloatRect& bounds, LevelData::Slope slope);
+    bool moveLadder(uint32_t index, const sf::FloatRect& bounds);
+    int findActivePlatform(uint32_t index) const;
+    int findActiveLadder(uint32_t index) const;
+    // After records were added or removed: buckets every platform and ladder
+    // again, keeping the sectors and their enemies. collect() is due.
+    void setGeometry(const LevelData& level);
+
+    Stats getStats() const;
+
+private:
+    enum class SectorState { Unloaded, Pending, Active };
+
+    // What a sector holds, bucketed on the main thread in setLevel
+    struct SectorSource {
+        LevelVector<uint32_t> platforms; // Indices into platformBounds
+        LevelVector<uint32_t> ladders;   // Indices into ladderBounds
+        LevelVector<LevelData::EnemySpawn> enemies;
+    };
+
+    // Built by the loader thread
+    struct SectorContent {
+        EnemyStore enemies;
+    };
+
+    struct Sector {
+        SectorState state = SectorState::Unloaded;
+        std::unique_ptr<SectorContent> content;
+        EnemyStore enemies; // Spawned on first load, kept across evictions
+        bool enemiesSpawned = false;
+    };
+
+    struct FinishedLoad {
+        uint32_t sector;
+        std::unique_ptr<SectorContent> content;
+    };
+
+    void loaderLoop();
+    std::unique_ptr<SectorContent> buildSector(uint32_t sector) const;
+    void adopt(uint32_t sector, std::unique_ptr<SectorContent> content);
+    void evict(uint32_t sector);
+    int sectorIndex(float x) const;
+    void bucketGeometry(const LevelData& level);
+    bool isResident(const sf::FloatRect& bounds) const; // Any sector it spans is active
+    void rebucket(LevelVector<uint32_t> SectorSource::*list, uint32_t index, const sf::FloatRect& from,
+                  const sf::FloatRect& to);
+
+    // Level copy; read by the loader thread only while a load is in flight,
+    // and rewritten by setLevel only once the loader is idle. The tables from
+    // here to ladderStamps are in the level arena.
+    LevelVector<sf::FloatRect> platformBounds;
+    LevelVector<LevelData::Slope> platformSlopes;
+    LevelVector<sf::FloatRect> ladderBounds;
+    LevelVector<SectorSource> sources;
+    sf::Color platformColor;
+    LevelVector<LevelData::EnemyType> enemyTypes;
+    float enemySpeed = 1.f;
+    float levelWidth = 0.f;
+
+    // Main thread only
+    LevelVector<Sector> sectors;
+    LevelVector<uint32_t> platformStamps; // Dedupes spanning platforms in collect()
+    LevelVector<uint32_t> ladderStamps;
+    uint32_t collectStamp = 0;
+    struct EnemyOrigin {
+        uint32_t sector;
+        uint32_t slot;
+    };
+    std::vector<EnemyOrigin> activeEnemyOrigins; // Parallel to the last collected enemies
+    std::vector<uint32_t> activePlatforms;       // Level index of each collected platform
+    std::vector<uint32_t> activeLadders;
+    size_t loads = 0;
+    size_t evictions = 0;
+
+    // Loader thread
+    mutable std::mutex loadMutex;
+    std::condition_variable loadCondition; // Loader waits for requests
+    std::condition_variable idleCondition; // setLevel waits for the loader
+    std::deque<uint32_t> requests;
+    std::vector<FinishedLoad> finished;
+    bool loaderBusy = false;
+    bool stopping = false;
+    std::thread loader;
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Format-string log records: a call site's "{}" format literal is registered
+// once for a small id, and each record carries only that id and its raw
+// arguments, packed here into the logger's slot. Text is built later, by the
+// logger thread for a text sink or by logdecode for a binary one.
+//
+// Binary log files (AsyncLogger::SinkFormat::Binary) are a stream of records,
+// little-endian, each starting with a RecordKind byte:
+//   Session    magic "GLOG", uint32 version; starts each process's records
+//   Format     uint32 id, uint16 length, the format text
+//   Text       int64 wall ns, uint8 level, uint16 length, the message
+//   Structured int64 wall ns, uint8 level, uint8 truncated, uint32 format id, uint16 length,
+//              the packed arguments
+// A format is written before the first record that uses it; ids restart with each session.
+namespace LogFormat {
+
+constexpr char MAGIC[4] = {'G', 'L', 'O', 'G'};
+constexpr uint32_t VERSION = 1;
+
+enum class RecordKind : uint8_t { Session = 1, Format, Text, Structured };
+
+// One type byte per argument, then its value
+enum class ArgType : uint8_t { Int, Uint, Double, Bool, String };
+
+// Packs arguments into a fixed buffer. An argument that doesn't fit (or the
+// rest of a long string) is cut and the record marked truncated.
+class Encoder {
+public:
+    Encoder(char* data, size_t capacity) : data(data), capacity(capacity) {}
+
+    void put(int64_t value) { putValue(ArgType::Int, &value, sizeof(value)); }
+    void put(uint64_t value) { putValue(ArgType::Uint, &value, sizeof(value)); }
+    void put(double value) { putValue(ArgType::Double, &value, sizeof(value)); }
+    void put(bool value) { putValue(ArgType::Bool, &value, sizeof(value)); }
+    void put(std::string_view text) {
+        if (size + 3 > capacity) {
+            truncated = true;
+            return;
+        }
+        const uint16_t length = static_cast<uint16_t>(std::min(text.size(), capacity - size - 3));
+        truncated = truncated || length < text.size();
+        data[size++] = static_cast<char>(ArgType::String);
+        std::memcpy(data + size, &length, sizeof(length));
+        std::memcpy(data + size + sizeof(length), text.data(), length);
+        size += sizeof(length) + length;
+    }
+
+    size_t getSize() const { return size; }
+    bool isTruncated() const { return truncated; }
+
+private:
+    void putValue(ArgType type, const void* value, size_t bytes) {
+        if (size + 1 + bytes > capacity) {
+            truncated = true;
+            return;
+        }
+        data[size] = static_cast<char>(type);
+        std::memcpy(data + size + 1, value, bytes);
+        size += 1 + bytes;
+    }
+
+    char* data;
+    size_t capacity;
+    size_t size = 0;
+    bool truncated = false;
+};
+
+// Integers widen to 64 bits, floats to double; anything string-like is copied
+template <typename T>
+void encode(Encoder& encoder, const T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        encoder.put(value);
+    } else if constexpr (std::is_enum_v<T>) {
+        encoder.put(static_cast<int64_t>(value));
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        encoder.put(static_cast<int64_t>(value));
+    } else if constexpr (std::is_integral_v<T>) {
+        encoder.put(static_cast<uint64_t>(value));
+    } else if constexpr (std::is_floating_point_v<T>) {
+        encoder.put(static_cast<double>(value));
+    } else {
+        encoder.put(std::string_view(value));
+    }
+}
+
+// Replaces each "{}" in 'format' with the next packed argument ("{{" and "}}"
+// are literal braces) and appends the result to 'out'. Missing arguments show
+// as "{?}"; a truncated record ends in "...".
+void appendFormatted(const char* format, const char* payload, size_t size, bool truncated, std::string& out);
+
+} // namespace LogFormat
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <utility>
+
+// Read-only memory mapping of a whole file (mmap / MapViewOfFile).
+// Movable, not copyable; the view stays valid until close() or destruction.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Fails for missing, unreadable and empty files
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return base != nullptr; }
+    const char* data() const { return base; }
+    size_t size() const { return mappedSize; }
+
+    // Paging hints for a range of the view: start reading it ahead, or drop the
+    // pages wholly inside it (read again on the next touch). No-ops on Windows.
+    void willNeed(size_t offset, size_t size) const;
+    void dontNeed(size_t offset, size_t size) const;
+
+private:
+    const char* base = nullptr;
+    size_t mappedSize = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "AllocationTracker.hpp"
+
+// One reading of the memory dashboard: the live heap bytes of every
+// AllocationTracker tag, then estimates of what the subsystems hold outside
+// the heap (textures at 4 bytes a texel, OpenAL's buffers). Game takes one a
+// frame; SessionTelemetry keeps the session and per-level peaks.
+namespace MemoryStats {
+
+enum class Estimate : uint8_t {
+    CharacterTextures,  // AssetManager, by texture category
+    BackgroundTextures,
+    TileTextures,
+    UiTextures,
+    OtherTextures,
+    AnimationFrames,    // AnimationClipCache atlases and sheets
+    TileAtlas,          // RenderingSystem's platform tiles
+    RenderTargets,      // Background caches, scene target and mini-map
+    FontAtlas,          // ImGui's
+    AudioBuffers,       // SoundSystem::getBufferBytes
+    Count
+};
+constexpr size_t ESTIMATE_COUNT = static_cast<size_t>(Estimate::Count);
+constexpr size_t SLOT_COUNT = AllocationTracker::TAG_COUNT + ESTIMATE_COUNT;
+
+struct Sample {
+    std::array<uint64_t, SLOT_COUNT> bytes{}; // Tags first, then estimates
+
+    uint64_t& operator[](AllocationTracker::Tag tag) { return bytes[static_cast<size_t>(tag)]; }
+    uint64_t& operator[](Estimate estimate) {
+        return bytes[AllocationTracker::TAG_COUNT + static_cast<size_t>(estimate)];
+    }
+    uint64_t getHeapTotal() const;
+    uint64_t getEstimateTotal() const;
+    uint64_t getTotal() const { return getHeapTotal() + getEstimateTotal(); }
+};
+
+// The heap slots from AllocationTracker; estimates are left at 0 for the caller
+Sample sampleHeap();
+
+const char* getSlotName(size_t slot);
+inline bool isEstimate(size_t slot) { return slot >= AllocationTracker::TAG_COUNT; }
+
+} // namespace MemoryStats
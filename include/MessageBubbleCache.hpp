@@ -0,0 +1,76 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Speech bubble layouts (box, outline and glyph quads) built once per
+// distinct (string, character size) and kept in an LRU cache. Every vertex
+// samples the font's own glyph page: the box uses the white texel SFML
+// reserves at (1, 1) of each page, so a bubble is a single triangle list and
+// all visible bubbles batch into one draw. Vertices are relative to the
+// bubble's anchor, the point it floats above.
+class MessageBubbleCache {
+public:
+    struct Layout {
+        std::vector<sf::Vertex> vertices; // Triangles
+        sf::FloatRect bounds;             // Including the outline, for culling
+        unsigned characterSize = 0;
+    };
+
+    // Names a cached layout; stale once the layout is evicted, after which
+    // get() rebuilds it
+    struct Handle {
+        uint32_t slot = UINT32_MAX;
+        uint32_t generation = 0;
+    };
+
+    struct Stats {
+        size_t entries = 0;
+        size_t hits = 0;
+        size_t misses = 0;     // Layouts built
+        size_t evictions = 0;
+    };
+
+    static constexpr size_t DEFAULT_CAPACITY = 64;
+
+    // 'font' must outlive the cache; call clear() if it is reloaded
+    explicit MessageBubbleCache(const sf::Font& font, size_t capacity = DEFAULT_CAPACITY);
+
+    // 'message' is UTF-8. Marks the layout most recently used.
+    Handle acquire(const std::string& message, unsigned characterSize);
+    // Layout for 'handle', re-acquired from 'message' if it was evicted
+    const Layout& get(Handle& handle, const std::string& message, unsigned characterSize);
+
+    // Glyph page the layouts of this size sample
+    const sf::Texture& getTexture(unsigned characterSize) const { return font.getTexture(characterSize); }
+
+    void clear();
+    const Stats& getStats() const { return stats; }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Entry {
+        std::string key;
+        Layout layout;
+        uint32_t generation = 0;
+        uint32_t newer = NONE; // LRU links
+        uint32_t older = NONE;
+    };
+
+    void buildLayout(const std::string& message, unsigned characterSize, Layout& layout) const;
+    void makeKey(const std::string& message, unsigned characterSize);
+    void unlink(uint32_t slot);
+    void pushNewest(uint32_t slot);
+
+    const sf::Font& font;
+    size_t capacity;
+    std::vector<Entry> entries;
+    std::unordered_map<std::string, uint32_t> slotsByKey;
+    uint32_t newest = NONE;
+    uint32_t oldest = NONE;
+    std::string keyScratch; // Reused so lookups don't allocate
+    Stats stats;
+};
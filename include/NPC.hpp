@@ -2,31 +2,78 @@
 
 #include <vector>
 #include <string>
-#include <memory>
+#include <cstdint>
 #include <SFML/Graphics.hpp>
 #include "Physics.hpp"
-#include "Animation.hpp"
+#include "AnimationSystem.hpp"
 #include "AssetManager.hpp"
 #include "RenderingSystem.hpp"
+#include "PointGrid.hpp"
+#include "HandlePool.hpp"
+#include "AIScheduler.hpp"
+#include "TimerWheel.hpp"
+#include "NPCScript.hpp"
+#include "MessageBubbleCache.hpp"
+#include "RenderSnapshot.hpp"
+
+class SimSnapshot;
 
 // Forward declarations and types in NPCSystem namespace
 namespace NPCSystem {
+    enum class NPCState : uint8_t {
+        Idle,
+        Walking,
+        Talking
+    };
+
+    // Name used by setNPCState(id, string) and debug output
+    const char* toString(NPCState state);
+    bool parseNPCState(const std::string& name, NPCState& state);
+
+    constexpr uint32_t NO_ANIMATION = UINT32_MAX;
+    constexpr uint32_t NO_MESSAGE = UINT32_MAX;
+    constexpr uint32_t NO_SCRIPT = UINT32_MAX;
+
+    // Hot per-NPC record: everything the per-frame passes read, stored
+    // contiguously with no owned heap memory. Names, animations and messages
+    // live in the NPC manager's side tables.
     struct NPCData {
-        int id;
-        std::string name;
-        float x, y;           // Position
-        float health;
-        bool isActive;
-        std::string currentState;  // e.g., "idle", "walking", "talking"
-        std::unique_ptr<sf::Sprite> sprite;
-        bool facingLeft;
-        std::unique_ptr<Animation> animation;  // Add animation support
-        bool isInteracting;  // Flag to indicate if NPC is interacting with player
-        std::string currentMessage;  // Current message being displayed
-        float messageTimer;  // Timer for how long to show the message
-        std::unique_ptr<sf::RectangleShape> messageBox;  // Shape for message background
-        std::unique_ptr<sf::Text> messageText;  // Text object for rendering message
-        sf::FloatRect collisionBounds;  // Collision bounds for interaction
+        int id = 0;
+        float x = 0.0f, y = 0.0f;           // Position (sprite centre)
+        float prevX = 0.0f, prevY = 0.0f;   // Position at the previous simulation step (render interpolation)
+        float homeX = 0.0f;                 // Walks back and forth around this
+        float stateTimer = 0.0f;            // Time in the current idle/walking state
+        float health = 100.0f;
+        float spriteWidth = 0.0f;           // Scaled size of the NPC's texture; 0 without one
+        float spriteHeight = 0.0f;
+        sf::FloatRect collisionBounds;      // Collision bounds for interaction
+        ShapeCache box;                     // Physics collision box, local to the sprite bounds
+        int32_t support = -1;               // Platform it stood on last step (PhysicsSystem::isOnGroundAt)
+        uint16_t restTicks = 0;             // Physics steps spent resting
+        uint32_t animation = NO_ANIMATION;  // Index into the animation pool
+        uint32_t message = NO_MESSAGE;      // Index into the message table while one is shown
+        uint32_t script = NO_SCRIPT;        // Handle of the script it runs (NPC::runScript)
+        NPCState state = NPCState::Idle;
+        bool isActive = true;
+        bool facingLeft = false;
+        bool isInteracting = false;         // Flag to indicate if NPC is interacting with player
+        bool awake = true;                  // Cleared by physics sleeping, see PhysicsSystem::SLEEP_TICKS
+
+        bool hasSprite() const { return spriteWidth > 0.0f; }
+        // What the old per-NPC sf::Sprite reported: texture size around the centre
+        sf::FloatRect getSpriteBounds() const {
+            return sf::FloatRect(sf::Vector2f(x - spriteWidth / 2.0f, y - spriteHeight / 2.0f),
+                                 sf::Vector2f(spriteWidth, spriteHeight));
+        }
+    };
+
+    // Cold data for a speech bubble, only allocated while it is on screen.
+    // The geometry is shared through the bubble cache.
+    struct NPCMessage {
+        int npcId;
+        std::string message;
+        TimerWheel::TimerId timer = TimerWheel::NO_TIMER; // Takes the message down when it fires
+        MessageBubbleCache::Handle bubble;
     };
 }
 
@@ -34,46 +81,178 @@ class NPC {
 public:
     using NPCData = NPCSystem::NPCData;  // Alias for convenience
 
+    // Pool occupancy for the debug panel
+    struct PoolStats {
+        HandlePool::Stats handles;   // NPC ids
+        size_t npcCapacity = 0;      // Records that fit without growing
+        size_t messages = 0;         // Speech bubbles showing
+        size_t messageCapacity = 0;  // Message entries kept, live and spare
+    };
+
     NPC(AssetManager& assetManager, RenderingSystem& renderSystem);
     ~NPC();
 
-    // Instance management
+    // Instance management. NPCs are pooled: ids are generational handles, so
+    // lookups and removal are constant time and a removed NPC's id stays dead;
+    // removal swap-removes, moving the last NPC's index. Nothing allocates
+    // once the pool has held as many NPCs and messages before.
     int createNPC(const std::string& name, const std::string& textureName, float x, float y);
     void addNPC(const std::string& name, float x, float y);
     void removeNPC(int id);
     void updateAll(float deltaTime);
-    void renderAll();
+    void renderAll(RenderSnapshot& snapshot, const sf::FloatRect& viewBounds, float alpha = 1.0f);  // Skips NPCs outside the view
+    // renderAll in two halves, so enemies and NPCs can share one crowd pass:
+    // sprites into 'crowd', then (after the crowd is recorded) the speech bubbles
+    void addToCrowd(CrowdRenderer& crowd, const ViewCulling::ViewSet& views, float alpha);
+    void renderMessages(RenderSnapshot& snapshot);
+    const ViewCulling::CullStats& getCullStats() const { return cullStats; }
+    void storePreviousPositions();
+    void updateSpatialIndex();  // Re-buckets NPCs moved outside the manager (physics); call once per step
     void clearNPCs(); // New method to clear all NPCs
 
+    // Save states: NPC records, scheduler, messages on screen, running scripts
+    // and their timers. Names, animations and script definitions stay as they
+    // are, so restore into the same set of NPCs.
+    void saveState(SimSnapshot& snapshot) const;
+    bool loadState(SimSnapshot& snapshot);
+    void snapState(); // Positions onto the fixed-point grid (GAME_FIXED_POINT), after a step
+
     // Individual NPC controls
     void setNPCPosition(int id, float x, float y);
-    void setNPCState(int id, const std::string& state);
+    void setNPCState(int id, NPCSystem::NPCState state);
+    void setNPCState(int id, const std::string& state);  // Unknown names are ignored
     void setNPCHealth(int id, float health);
     void setNPCActive(int id, bool active);
     void setNPCTexture(int id, const std::string& textureName);
     void setNPCFacing(int id, bool facingLeft);
-    void setFont(const sf::Font& font) { messageFont = font; }  // New method to set font
 
     // Getters
     const std::vector<NPCData>& getAllNPCs() const;
+    std::vector<NPCData>& getAllNPCs() { return npcs; } // The physics sweep moves the records in place
     NPCData* getNPCById(int id);
-    std::vector<std::reference_wrapper<const NPCData>> getNPCsInRange(float x, float y, float radius) const;
+    const std::string& getNPCName(size_t index) const { return names[index]; }
+    const MessageBubbleCache::Stats& getBubbleStats() const { return bubbles.getStats(); }
+    size_t getActiveMessageCount() const { return messageCount; }
+    const TimerWheel::Stats& getTimerStats() const { return timers.getStats(); }
+    PoolStats getPoolStats() const;
+    // Active NPCs whose position is within 'radius' of (x, y), by index into
+    // getAllNPCs(). The visitor form takes (size_t index, const NPCData&); the
+    // buffer form clears 'out' first and returns the count.
+    template <typename Visitor>
+    void forEachNPCInRange(float x, float y, float radius, Visitor&& visit) const;
+    size_t getNPCsInRange(float x, float y, float radius, std::vector<uint32_t>& out) const;
 
-    // AI and behavior
-    void updateAI(float deltaTime);
+    // AI and behavior. State decisions run through the scheduler (budgeted,
+    // round-robin, slower for NPCs far from the focus); movement still runs
+    // every update, and Far NPCs keep their clip. Frames are evaluated from the
+    // animation clock only for the NPCs drawn.
+    void setAIFocus(const sf::Vector2f& position) { aiScheduler.setFocus(position); }
+    // Stepped animation ticking is split across 'jobs' when set
+    void setJobSystem(JobSystem* jobs) { jobSystem = jobs; }
+    const AnimationSystem& getAnimationSystem() const { return animations; }
+    AIScheduler& getAIScheduler() { return aiScheduler; }
     void handleInteraction(int npcId, const sf::FloatRect& playerBounds);  // Updated to use collision bounds
+    // handleInteraction for the NPCs near the player and those already talking
+    void updateInteractions(const sf::FloatRect& playerBounds);
     void displayMessage(int npcId, const std::string& message, float duration = 3.0f);
 
+    // Scripted sequences (see NPCScript), one running per NPC; running
+    // another replaces it. Define scripts at load time, before
+    // prewarmMessageGlyphs, which rasterizes their lines too. NPCs from
+    // createNPC run the greeting script until given another.
+    using ScriptId = uint32_t;                   // A defined script
+    using ScriptHandle = HandlePool::Handle;     // A running one; NPCSystem::NO_SCRIPT for none
+    struct ScriptStats {
+        size_t defined = 0;
+        size_t running = 0;
+        size_t waitingOnTimer = 0;
+        size_t waitingOnPlayer = 0;
+    };
+    ScriptId defineScript(const NPCScript& script);
+    // Runs up to the first wait before returning; NO_SCRIPT for an unknown NPC or script
+    ScriptHandle runScript(int npcId, ScriptId script);
+    void stopScript(int npcId);
+    ScriptStats getScriptStats() const;
+    // Rasterize the glyphs the dialogue uses (ASCII and its CJK characters) at
+    // load time, so showing a bubble doesn't add glyphs mid-frame
+    void prewarmMessageGlyphs();
+
 private:
     std::vector<NPCData> npcs;
-    int nextId;
+    std::vector<std::string> names;              // Parallel to npcs; entries past npcs.size() are spare buffers
+    HandlePool handles;                          // NPCData::id -> index into npcs
+    AnimationSystem animations;                  // Instances indexed by NPCData::animation, ticked together
+    std::vector<uint32_t> animationOwners;       // Index into npcs per animation instance
+    AnimationSystem::ClipSet npcClips = AnimationSystem::NO_CLIP_SET; // Loaded by the first createNPC
+    JobSystem* jobSystem = nullptr;
+    std::vector<NPCSystem::NPCMessage> messages; // Indexed by NPCData::message; entries past messageCount are spare
+    size_t messageCount = 0;
+    TimerWheel timers;                           // Message expiry and script waits, see TimerEvent
+    std::vector<TimerWheel::Expired> expiredTimers;
+    AIScheduler aiScheduler;                     // Agents are indices into npcs
+    PointGrid spatialIndex;                      // NPC positions, items are indices into npcs
+    float maxCollisionHalfExtent = 0.0f;         // Largest collision box half-size seen, pads interaction queries
+    std::vector<uint32_t> talkingNPCs;           // Indices with isInteracting set
+    std::vector<uint32_t> interactionScratch;
     AssetManager& assetManager;
     RenderingSystem& renderSystem;
-    sf::Font messageFont;  // Font for rendering messages
+    const sf::Font& messageFont;  // Shared through the asset manager, glyphs prewarmed
+    MessageBubbleCache bubbles{messageFont};  // Laid-out bubbles, sampling messageFont's glyph pages
+    ViewCulling::CullStats cullStats;  // Drawn/culled NPCs in the last renderAll
+    struct VisibleBubble {
+        const MessageBubbleCache::Layout* layout;
+        sf::Vector2f anchor;
+    };
+    std::vector<VisibleBubble> visibleBubbles;  // From addToCrowd, drawn by renderMessages
+
+    // What a timer's data names: the NPC id for a message, the script handle for a script
+    enum class TimerEvent : uint32_t {
+        MessageExpired,
+        ScriptResume
+    };
+    enum class ScriptWait : uint8_t {
+        None,
+        Timer,
+        PlayerNear,
+        PlayerAway
+    };
+    struct RunningScript {
+        ScriptHandle handle;
+        ScriptId script;
+        int npcId;
+        uint32_t step;                           // Next step to run
+        TimerWheel::TimerId timer;               // While waiting on one
+        ScriptWait wait;
+    };
+    std::vector<NPCScript> scripts;              // By ScriptId; kept across levels
+    std::vector<RunningScript> running;          // Dense, swap-removed
+    HandlePool scriptHandles;                    // NPCData::script -> index into running
+    ScriptId greetingScript = 0;
 
     // Helper functions
-    void updateNPCState(NPCData& npc);
-    void updateNPCAnimation(NPCData& npc, float deltaTime);
+    void updateNPCState(NPCData& npc, float elapsed);  // One scheduled decision
+    void updateNPCAnimation(const NPCData& npc, bool animate);  // Picks the clip; addToCrowd() evaluates its frame
     void updateCollisionBounds(NPCData& npc);  // New helper function
-    float calculateDistance(float x1, float y1, float x2, float y2) const;  // Added missing declaration
-}; 
\ No newline at end of file
+    void interactAt(size_t index, const sf::FloatRect& playerBounds);
+    uint32_t spawn(NPCData& npc, const std::string& name);  // Assigns the id and appends; returns the index
+    void rebuildSpatialIndex();  // After a save state replaced the records
+    void releaseMessage(NPCData& npc);
+    void resumeScript(NPCData& npc);  // Runs steps until the next wait or the end
+    void notifyScript(NPCData& npc, ScriptWait event);  // Resumes it if it waits on 'event'
+    void endScript(NPCData& npc);
+    void setSpriteSize(NPCData& npc, const std::string& textureName);
+};
+
+template <typename Visitor>
+void NPC::forEachNPCInRange(float x, float y, float radius, Visitor&& visit) const {
+    const float radiusSquared = radius * radius;
+    const sf::FloatRect area(sf::Vector2f(x - radius, y - radius), sf::Vector2f(radius * 2.0f, radius * 2.0f));
+    spatialIndex.forEachCandidate(area, [&](uint32_t index) {
+        const NPCData& npc = npcs[index];
+        const float dx = npc.x - x;
+        const float dy = npc.y - y;
+        if (npc.isActive && dx * dx + dy * dy <= radiusSquared) {
+            visit(static_cast<size_t>(index), npc);
+        }
+    });
+} 
\ No newline at end of file
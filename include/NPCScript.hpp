@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace NPCSystem {
+    enum class NPCState : uint8_t; // NPC.hpp
+}
+
+// A scripted sequence for one NPC: dialogue lines, pauses and waits on the
+// player, written top to bottom the way a coroutine would be,
+//
+//     NPCScript()
+//         .waitPlayerNear()               // co_await playerNear(id)
+//         .say("Hello", 2.f).wait(2.f)    // co_await seconds(2)
+//         .say("Mind the ice")
+//         .waitPlayerAway()
+//         .loop();
+//
+// but stackless and C++17: a script is a list of steps and a running copy is
+// the NPC, a step index and what it waits on (see NPC::runScript). A waiting
+// script is resumed by the NPC timer wheel or by the player arriving or
+// leaving, so it costs nothing on the frames in between.
+class NPCScript {
+public:
+    enum class Op : uint8_t {
+        Say,            // Show a bubble for 'seconds'; doesn't wait for it
+        Wait,           // Resume after 'seconds'
+        WaitPlayerNear, // Resume once the player is in talking range
+        WaitPlayerAway, // Resume once the player has left it
+        SetState,       // Idle, walking or talking
+        Loop            // Back to the first step
+    };
+
+    struct Step {
+        Op op = Op::Wait;
+        float seconds = 0.0f;
+        uint32_t line = 0;                 // Say: index into getLines()
+        NPCSystem::NPCState state{};       // SetState
+    };
+
+    NPCScript& say(const std::string& line, float seconds = 3.0f);
+    NPCScript& wait(float seconds);
+    NPCScript& waitPlayerNear();
+    NPCScript& waitPlayerAway();
+    NPCScript& setState(NPCSystem::NPCState state);
+    NPCScript& loop();
+
+    const std::vector<Step>& getSteps() const { return steps; }
+    const std::vector<std::string>& getLines() const { return lines; }
+
+private:
+    std::vector<Step> steps;
+    std::vector<std::string> lines;
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Swept AABB-vs-level collision, the one routine every moving body resolves
+// through. A body moves against three kinds of surface:
+//   - Solid boxes block from every side.
+//   - One-way platforms are only solid from above, for bodies that start the
+//     step above them.
+//   - Slopes fill their box diagonally. Bodies walk up and down the ramp and
+//     pass through it from below and from the sides.
+// Boxes are handled by time of impact: the body advances to the first face
+// its path touches, drops the blocked part of the move and slides on with the
+// rest, so a body at any speed (or any direction) stops at the first surface
+// instead of tunnelling through thin platforms. A support pass then settles it
+// onto whatever it stands on, which is also where slopes are resolved.
+namespace Narrowphase {
+
+enum class SurfaceType : uint8_t {
+    Solid,
+    OneWay,
+    SlopeUpRight, // Ramp from the bottom-left corner up to the top-right
+    SlopeUpLeft   // Ramp from the bottom-right corner up to the top-left
+};
+
+struct Surface {
+    sf::FloatRect bounds;
+    SurfaceType type = SurfaceType::Solid;
+};
+
+struct SweepResult {
+    sf::Vector2f position;   // Resolved top-left of the body
+    bool onGround = false;   // Standing on (or landed on) a surface
+    bool hitCeiling = false;
+    int wall = 0;            // -1 stopped moving left, 1 stopped moving right
+    int ground = -1;         // Surface stood on, index into the surfaces array
+};
+
+constexpr float LANDING_TOLERANCE = 5.f; // A top this far above the feet at the start still catches them
+constexpr float CONTACT_DISTANCE = 2.f;  // Support this far below the feet still counts as standing
+constexpr float SKIN = 0.1f;             // Gap left after resolving so resting bodies don't overlap
+constexpr int MAX_SLIDES = 3;            // Faces one sweep may hit before the rest of the move is dropped
+
+// Earliest fraction of 'move' (0..1) at which 'body' touches 'box', and the
+// face's outward normal. False if the path misses, only grazes a corner, or
+// the body already overlaps the box.
+bool timeOfImpact(const sf::FloatRect& body, const sf::Vector2f& move, const sf::FloatRect& box,
+                  float& time, sf::Vector2f& normal);
+
+// Walkable height of 's' at x (clamped to its box); the box top unless it is a slope
+float getSurfaceTop(const Surface& surface, float x);
+
+// Area to query the broadphase with for a sweep from 'body' by 'move'
+sf::FloatRect getSweepBounds(const sf::FloatRect& body, const sf::Vector2f& move);
+
+// Moves 'body' by 'move' against surfaces[candidates]. 'wasGrounded' lets the
+// body follow a slope down instead of stepping off it into the air; with
+// 'solidsAreOneWay' solid boxes behave as one-way platforms.
+SweepResult sweep(const sf::FloatRect& body, const sf::Vector2f& move, bool wasGrounded,
+                  const std::vector<Surface>& surfaces, const std::vector<size_t>& candidates,
+                  bool solidsAreOneWay = false);
+
+// The same with 'solidsAreOneWay' fixed at compile time, for callers that
+// know it for a whole level (both are instantiated in Narrowphase.cpp)
+template <bool SolidsAreOneWay>
+SweepResult sweep(const sf::FloatRect& body, const sf::Vector2f& move, bool wasGrounded,
+                  const std::vector<Surface>& surfaces, const std::vector<size_t>& candidates);
+
+} // namespace Narrowphase
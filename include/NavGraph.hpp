@@ -0,0 +1,105 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "FrameArena.hpp"
+#include "LevelLoader.hpp"
+#include "SpatialGrid.hpp"
+
+// Where agents can get to on the level's platforms, built once per level from
+// the whole level (not just the streamed-in sectors). Every platform top is a
+// node; slopes keep their ramp, so a node's height varies across it. Edges
+// leave a node from one of its ends (or, for a platform floating above it,
+// from just beside that platform) and are one of:
+//   - Walk: onto a surface that continues at about the same height
+//   - Jump: up to maxJumpHeight, across up to maxJumpDistance
+//   - Fall: off the end onto a lower surface within maxFallReach sideways
+// Reachability ignores headroom and what lies in the arc; it is the cheap
+// precomputation that makes per-agent pathing a graph search.
+class NavGraph {
+public:
+    static constexpr uint32_t NO_NODE = UINT32_MAX;
+
+    enum class EdgeType : uint8_t {
+        Walk,
+        Jump,
+        Fall
+    };
+
+    struct Settings {
+        float maxJumpHeight = 110.f;   // Rise a jump can make, pixels
+        float maxJumpDistance = 150.f; // Horizontal gap a jump clears
+        float maxFallReach = 120.f;    // Sideways drift while falling off an end
+        float walkGap = 4.f;           // Gaps up to this wide are stepped over
+        float stepHeight = 8.f;        // Rises up to this high are walked
+        float clearance = 20.f;        // Takeoff distance beside a platform jumped onto from below
+        float jumpCostScale = 1.5f;    // Jumps cost more than their length, so walking wins ties
+    };
+
+    struct Node {
+        float left = 0.f, right = 0.f;
+        float topLeft = 0.f, topRight = 0.f; // Surface height at each end (differ on slopes)
+        uint32_t platform = 0;               // Index into the platforms built from
+        uint32_t firstEdge = 0;              // Edges of this node: [firstEdge, firstEdge + edgeCount)
+        uint32_t edgeCount = 0;
+
+        float topAt(float x) const;
+        sf::Vector2f center() const { return sf::Vector2f((left + right) * 0.5f, topAt((left + right) * 0.5f)); }
+    };
+
+    struct Edge {
+        uint32_t to = NO_NODE;
+        EdgeType type = EdgeType::Walk;
+        sf::Vector2f takeoff;  // Leaves the node here (on its surface)
+        sf::Vector2f landing;  // Arrives here, on the target's surface
+        float cost = 0.f;      // Centre to takeoff, the transition, landing to the target's centre
+    };
+
+    struct Stats {
+        size_t nodes = 0;
+        size_t walkEdges = 0;
+        size_t jumpEdges = 0;
+        size_t fallEdges = 0;
+        double buildMs = 0.0;
+        size_t updatedNodes = 0; // Whose edges the last updatePlatform worked out again
+        double updateMs = 0.0;
+    };
+
+    void build(const std::vector<LevelData::Platform>& platforms);
+    void build(const std::vector<LevelData::Platform>& platforms, const Settings& settings);
+    void clear();
+    // Platform 'platform' changed bounds or slope (the editor): its node and
+    // the edges of every node whose reach covers its old or new surface are
+    // worked out again, the rest are kept. Adding or removing platforms
+    // renumbers them and needs a build().
+    void updatePlatform(const std::vector<LevelData::Platform>& platforms, uint32_t platform);
+
+    bool empty() const { return nodes.empty(); }
+    size_t getNodeCount() const { return nodes.size(); }
+    const Node& getNode(uint32_t node) const { return nodes[node]; }
+    const Edge* edgesBegin(uint32_t node) const { return edges.data() + nodes[node].firstEdge; }
+    const Edge* edgesEnd(uint32_t node) const { return edgesBegin(node) + nodes[node].edgeCount; }
+    const LevelVector<Edge>& getEdges() const { return edges; }
+    const Settings& getSettings() const { return settings; }
+    const Stats& getStats() const { return stats; }
+
+    // The surface an agent whose feet are at 'feet' stands on: the node under
+    // it whose top is nearest, within 'tolerance'; NO_NODE if airborne
+    uint32_t findNode(const sf::Vector2f& feet, float tolerance = 8.f) const;
+
+private:
+    void addEdges(uint32_t from, std::vector<size_t>& candidates);
+    void addEdge(uint32_t from, uint32_t to, const sf::Vector2f& takeoff, const sf::Vector2f& landing);
+    static Node makeNode(const LevelData::Platform& platform, uint32_t index);
+    static sf::FloatRect surfaceOf(const Node& node);
+    void countEdges();
+
+    Settings settings;
+    LevelVector<Node> nodes;   // Both in the level arena; clear() lets go of them
+    LevelVector<Edge> edges;   // Grouped by source node
+    SpatialGrid grid{256.f};   // Over the node surfaces, for building and findNode
+    mutable std::vector<size_t> queryScratch;
+    std::vector<Edge> edgeScratch; // The previous edges, while updatePlatform regroups them
+    Stats stats;
+};
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "NavGraph.hpp"
+
+// A* over a NavGraph, shared by every agent. Agents queue requests and poll
+// for the path; update() expands at most 'budget' nodes per call, resuming a
+// search cut short last frame, so a crowd asking at once spreads over frames
+// instead of spiking one. The search state is pooled: per-node costs are
+// reset lazily by a search stamp and the open list is a heap that keeps its
+// storage, so searching allocates nothing once warm. Recent answers are kept
+// in a small direct-mapped cache, since agents on the same platforms keep
+// asking the same question.
+class NavPathfinder {
+public:
+    using RequestId = uint32_t;
+    static constexpr RequestId NO_REQUEST = 0;
+
+    enum class Status : uint8_t {
+        Pending,
+        Found,
+        NotFound,
+        Unknown   // Never issued, already taken, or dropped by setGraph
+    };
+
+    struct Stats {
+        size_t requests = 0;     // Issued since the graph was set
+        size_t pending = 0;      // Queued or being searched
+        size_t solved = 0;       // Found or not found, by search
+        size_t cacheHits = 0;
+        size_t expansions = 0;   // Last update
+        size_t maxExpansions = 0;
+    };
+
+    static constexpr size_t CACHE_SIZE = 64;
+    static constexpr size_t MAX_RESULTS = 1024; // Untaken results beyond this drop the oldest
+
+    // Drops every request, result and cached path
+    void setGraph(const NavGraph* graph);
+
+    // Immediate search, bounded by 'maxExpansions'; 'path' gets the nodes from
+    // start to goal inclusive. False if unreachable or over the bound.
+    bool findPath(uint32_t start, uint32_t goal, std::vector<uint32_t>& path,
+                  size_t maxExpansions = SIZE_MAX);
+
+    // Budgeted searches: request() answers from the cache at once when it can
+    RequestId request(uint32_t start, uint32_t goal);
+    void update(size_t budget);
+    // Pending until the search finishes; a finished result is handed out once
+    Status poll(RequestId id, std::vector<uint32_t>& path);
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct Query {
+        RequestId id;
+        uint32_t start;
+        uint32_t goal;
+    };
+    struct Result {
+        RequestId id = NO_REQUEST;
+        Status status = Status::Unknown;
+        std::vector<uint32_t> path; // Keeps its capacity when the slot is reused
+    };
+    struct CacheEntry {
+        uint32_t start = NavGraph::NO_NODE;
+        uint32_t goal = NavGraph::NO_NODE;
+        bool found = false;
+        std::vector<uint32_t> path;
+    };
+    struct OpenEntry {
+        float f;
+        uint32_t node;
+        bool operator<(const OpenEntry& other) const { return f > other.f; } // Min-heap through std::push_heap
+    };
+
+    void beginSearch(uint32_t start, uint32_t goal);
+    // Expands up to 'budget' nodes; true once the search is over (found or exhausted)
+    bool stepSearch(size_t& budget, bool& found);
+    void tracePath(std::vector<uint32_t>& path) const;
+    float heuristic(uint32_t node) const;
+    CacheEntry& cacheSlot(uint32_t start, uint32_t goal);
+    void finish(RequestId id, bool found, const std::vector<uint32_t>& path);
+
+    const NavGraph* graph = nullptr;
+
+    // Search state, indexed by node; valid where stamp matches the search
+    std::vector<float> costSoFar;
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> stamp;
+    std::vector<uint32_t> closed;   // Equal to the search stamp once expanded
+    uint32_t searchStamp = 0;
+    std::vector<OpenEntry> open;
+    uint32_t searchGoal = NavGraph::NO_NODE;
+    sf::Vector2f goalCenter;
+
+    std::vector<Query> queue;     // Waiting from queueHead on; the head is the one being searched
+    size_t queueHead = 0;
+    bool searching = false;       // The head's search has begun
+    std::vector<Result> results;  // By id % MAX_RESULTS
+    std::vector<uint32_t> pathScratch;
+    CacheEntry cache[CACHE_SIZE];
+    RequestId nextRequest = 1;
+    Stats stats;
+};
@@ -0,0 +1,75 @@
+#pragma once
+#include <SFML/Network.hpp>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+// The UDP link of a netplay session: one non-blocking socket and one peer.
+// The host binds a port and takes the first peer that says hello; the joining
+// side says hello until the host welcomes it with the match settings (level,
+// tile seed, step and input delay), which both then start from. After that,
+// every datagram is a RollbackSession input payload behind a type byte.
+// Nothing is retransmitted here: each input packet repeats what the peer
+// hasn't acknowledged, so the next one covers a lost one.
+class NetTransport {
+public:
+    static constexpr unsigned short DEFAULT_PORT = 47800;
+    static constexpr size_t MAX_DATAGRAM = 512;
+    static constexpr double TIMEOUT_SECONDS = 5.0;    // Silence before the peer counts as gone
+    static constexpr double HELLO_INTERVAL_SECONDS = 0.25;
+
+    struct MatchSettings {
+        uint32_t level = 1;
+        uint32_t tileSeed = 0;
+        float fixedTimeStep = 1.0f / 60.0f;
+        uint32_t inputDelay = 2;
+    };
+
+    enum class State { Closed, Hosting, Joining, Connected };
+
+    // What receive() handed back
+    enum class Message { None, Welcome, Inputs, Bye };
+
+    bool host(unsigned short port, const MatchSettings& settings, std::string& error);
+    bool join(const std::string& address, unsigned short port, std::string& error);
+    void close(); // Tells a connected peer
+
+    // Call once per frame: resends a pending hello, notices a silent peer
+    void update();
+    // One waiting datagram; repeat until None. A host is Connected after the
+    // first hello; a joiner after Welcome (getSettings() then holds the match).
+    Message receive();
+    const uint8_t* getPayload() const { return buffer.data() + 1; }
+    size_t getPayloadSize() const { return received > 0 ? received - 1 : 0; }
+
+    bool sendInputs(const uint8_t* payload, size_t size);
+
+    State getState() const { return state; }
+    bool isConnected() const { return state == State::Connected; }
+    const MatchSettings& getSettings() const { return settings; }
+    std::string getPeerName() const;
+    const std::string& getLastError() const { return lastError; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    enum Type : uint8_t { Hello = 1, Welcome = 2, Inputs = 3, Bye = 4 };
+
+    bool sendRaw(const void* data, size_t size);
+    void sendHello();
+    void sendWelcome();
+
+    sf::UdpSocket socket;
+    State state = State::Closed;
+    std::optional<sf::IpAddress> peer;
+    unsigned short peerPort = 0;
+    MatchSettings settings;
+    std::array<uint8_t, MAX_DATAGRAM> buffer{};
+    size_t received = 0;
+    Clock::time_point lastHeard{};
+    Clock::time_point lastHello{};
+    std::string lastError;
+};
@@ -0,0 +1,126 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "RenderStats.hpp"
+
+// Weather particles (snow). Each emitter keeps its particles in SoA arrays,
+// integrated four at a time (SSE2 or NEON, scalar otherwise), and is drawn as
+// one vertex array holding only the particles inside the view. Emitters follow
+// the view: particles spawn above it, wrap around its sides and die below it,
+// so the camera always sees a full field without simulating the whole level.
+//
+// An emitter can instead be simulated on the GPU: its settled field (the same
+// count the CPU path levels off at) is baked once into a static vertex buffer and
+// a vertex shader moves every particle from a time uniform, so the CPU cost is a
+// few uniforms and one draw per frame.
+class ParticleSystem {
+public:
+    using EmitterId = size_t;
+
+    struct EmitterConfig {
+        std::string name;
+        size_t budget = 1000;                        // Live particles at most
+        float rate = 200.f;                          // Spawned per second while under budget
+        sf::Vector2f velocityMin = sf::Vector2f(-10.f, 25.f); // Pixels per second
+        sf::Vector2f velocityMax = sf::Vector2f(10.f, 70.f);
+        float swayAmplitude = 20.f;                  // Peak sideways speed, pixels per second
+        float swayFrequency = 0.8f;                  // Radians per second
+        float sizeMin = 1.f;                         // Radius in pixels; small ones are drawn fainter
+        float sizeMax = 3.f;
+        sf::Color color = sf::Color::White;
+        bool gpuSimulated = false;                   // Falls back to the CPU without shaders
+    };
+
+    struct Stats {
+        size_t emitters = 0;
+        size_t simulated = 0;      // Live on the CPU
+        size_t gpu = 0;            // Animated by the shader
+        size_t spawned = 0;        // Last update
+        size_t drawn = 0;          // Last draw, CPU and GPU
+        size_t culled = 0;         // CPU particles outside the view
+        double updateMs = 0.0;
+    };
+
+    static constexpr float TIME_WRAP = 600.f; // Seconds of shader time before it restarts
+
+    ParticleSystem();
+    ~ParticleSystem();
+
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+    EmitterId addEmitter(const EmitterConfig& config);
+    void clear();
+    size_t getEmitterCount() const { return emitters.size(); }
+    const EmitterConfig& getConfig(EmitterId id) const { return emitters[id]->config; }
+    void setActive(EmitterId id, bool active);
+    bool isActive(EmitterId id) const { return emitters[id]->active; }
+    void setGpuSimulated(EmitterId id, bool gpu);
+    // Effective path: needs the config flag, shaders allowed on the last draw, and a GPU that has them
+    bool isGpuSimulated(EmitterId id) const;
+    // Replaces one emitter's budget (before the budget scale); the same
+    // trimming and GPU rebuild as setBudgetScale
+    void setBudget(EmitterId id, size_t budget);
+    // Scales every emitter's budget (quality settings); live particles over
+    // the new budget go at once and GPU fields are rebuilt on their next draw
+    void setBudgetScale(float scale);
+    float getBudgetScale() const { return budgetScale; }
+
+    // Spawns, integrates and retires the CPU particles for a frame of 'dt' seconds
+    void update(float dt, const sf::FloatRect& view);
+    // One draw per active emitter; 'allowShaders' is the renderer's shader toggle
+    void draw(sf::RenderTarget& target, RenderStats& renderStats, bool allowShaders);
+
+    const Stats& getStats() const { return stats; }
+    static const char* kernelName(); // "SSE2", "NEON" or "Scalar"
+
+private:
+    // Particles of one emitter, one array per attribute
+    struct Particles {
+        std::vector<float> x, y;
+        std::vector<float> velocityX, velocityY;
+        std::vector<float> phase;  // Sway phase in [-pi, pi)
+        std::vector<float> size;
+
+        size_t count() const { return x.size(); }
+        void reserve(size_t n);
+        void clear();
+        void swapRemove(size_t i);
+    };
+
+    struct Emitter {
+        EmitterConfig config;
+        Particles particles;
+        sf::VertexArray vertices{sf::PrimitiveType::Triangles};
+        sf::VertexBuffer gpuVertices{sf::PrimitiveType::Triangles, sf::VertexBuffer::Usage::Static};
+        float spawnDebt = 0.f;
+        bool active = true;
+        bool warmed = false;       // CPU field filled since it was (re)started
+        bool gpuStale = false;     // Vertex buffer baked for another budget
+    };
+
+    size_t getBudget(const EmitterConfig& config) const;
+    void initializeGpu();
+    bool buildGpuVertices(Emitter& emitter, const sf::Vector2f& viewSize);
+    void spawn(Emitter& emitter, size_t count, const sf::FloatRect& view, bool anywhere);
+    void retire(Emitter& emitter, const sf::FloatRect& view);
+    void drawCpu(Emitter& emitter, sf::RenderTarget& target, RenderStats& renderStats, const sf::FloatRect& view);
+    void drawGpu(Emitter& emitter, sf::RenderTarget& target, RenderStats& renderStats, const sf::View& view);
+
+    std::vector<std::unique_ptr<Emitter>> emitters;
+    std::mt19937 random;
+    Stats stats;
+    float budgetScale = 1.f;
+
+    // Set up on the first draw, when a GL context is current
+    sf::Texture flakeTexture;      // Soft round dot for CPU particles
+    sf::Shader gpuShader;
+    sf::Clock gpuClock;
+    bool gpuInitialized = false;
+    bool gpuReady = false;         // Shader compiled and vertex buffers available
+    bool shadersAllowed = true;
+};
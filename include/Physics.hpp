@@ -2,24 +2,50 @@
 #include <SFML/Graphics.hpp>
 #include <vector>
 #include "Player.hpp"
-#include "Enemy.hpp"
+#include "EnemyStore.hpp"
+#include "SpatialGrid.hpp"
+#include "PhysicsBodyStore.hpp"
+#include "CollisionShape.hpp"
+#include "AabbBatch.hpp"
+#include "JobSystem.hpp"
+#include "LevelGeometry.hpp"
+#include "LevelLoader.hpp"
+#include "Narrowphase.hpp"
+#include "TileMap.hpp"
+#include <mutex>
 
 // Forward declarations
 namespace NPCSystem {
     struct NPCData;
 }
+class SimSnapshot;
+class GameEventQueue;
 
-// Physics component to store collision properties
-struct PhysicsComponent {
-    sf::FloatRect collisionBox;
-    sf::Vector2f velocity;
-    bool hasGravity;
-    bool isStatic;
-    float bounceFactor;
-    float friction;
-    
-    PhysicsComponent() : velocity(0.0f, 0.0f), hasGravity(true), isStatic(false), 
-                         bounceFactor(0.0f), friction(0.0f) {}
+// Broadphase counters, published once per physics update for the debug panel
+struct BroadphaseStats {
+    size_t queries = 0;             // Grid queries issued
+    size_t candidates = 0;          // Platforms returned by those queries
+    size_t lastQueryCandidates = 0; // Candidates returned by the most recent query
+    size_t filtered = 0;            // Candidates dropped by the collision layer masks
+    size_t supportHits = 0;         // Ground checks a body's cached support settled without a query
+    size_t supportMisses = 0;       // Grounded bodies that moved or lost their support, so queried
+};
+
+// Nearest platform hit by a raycast or box sweep
+struct QueryHit {
+    size_t platform = 0;     // Index into the platforms given to initializePlatforms
+    float distance = 0.0f;   // Along the ray or the move, in pixels
+    sf::Vector2f point;      // The ray's hit point, or the swept box's top-left at impact
+    sf::Vector2f normal;     // Outward normal of the face hit
+};
+
+// Awake/asleep body counts, published once per physics update for the debug panel
+struct SleepStats {
+    size_t awakeEnemies = 0;
+    size_t sleepingEnemies = 0;
+    size_t awakeNPCs = 0;
+    size_t sleepingNPCs = 0;
+    size_t coarseEnemies = 0;  // Beyond the simulation region (counted in neither above)
 };
 
 class PhysicsSystem {
@@ -30,16 +56,42 @@ public:
     // Initialization
     void initialize();
     void initializePlayer(Player& player);
-    void initializePlatforms(const std::vector<sf::RectangleShape>& platforms);
-    void initializeEnemies(const std::vector<Enemy>& enemies);
-    void initializeNPCs(const std::vector<NPCSystem::NPCData>& npcs);
+    void initializePlatforms(const LevelGeometry& platforms);
+    // Enemies are not bodies in the store: the sweep reads and writes the
+    // EnemyStore's own arrays, and its awake/restTicks hold the sleep state.
+    // The store stays bound (for wakeEnemy/wakeAll) until the next call.
+    void initializeEnemies(EnemyStore& enemies);
+    // NPCs likewise: updateNPCs sweeps the NPC records, which carry their own
+    // box, support and sleep state. The vector stays bound for wakeNPC/wakeAll.
+    void initializeNPCs(std::vector<NPCSystem::NPCData>& npcs);
+    
+    // Tile layer (see TileMap). Platforms and ladders lying exactly on the
+    // level's grid are found per cell touched, through bitsets; the rest stay
+    // rectangles in a grid of their own. setTileGrid sizes it for the level
+    // (a tile size of 0 turns it off) and empties it, so call it before
+    // initializePlatforms and initializeLadders. Grid platforms are on the
+    // Solid layer; scene queries and the debug overlay still use platformGrid.
+    void setTileGrid(float tileSize, const sf::Vector2f& levelSize);
+    void initializeLadders(const LevelGeometry& ladders);
+    // Editor edits: one platform gets new bounds and slope, or one ladder moves
+    // ('ladders' already holding its new bounds), touching only the grid cells
+    // and tiles under the old and new footprint instead of rebuilding
+    void updatePlatform(size_t index, const sf::FloatRect& bounds, LevelData::Slope slope);
+    void updateLadder(const LevelGeometry& ladders, const sf::FloatRect& from, const sf::FloatRect& to);
+    const TileMap& getTileMap() const { return tileMap; }
+    size_t getLoosePlatformCount() const { return loosePlatforms.size(); }
+    // Whether 'box' touches a ladder (edges inclusive)
+    bool isOnLadder(const sf::FloatRect& box) const;
     
     // Update physics
-    void update(float deltaTime, Player& player, std::vector<Enemy>& enemies);
-    void updateNPCs(std::vector<NPCSystem::NPCData>& npcs);
+    void update(float deltaTime, Player& player, EnemyStore& enemies);
+    void updateNPCs(std::vector<NPCSystem::NPCData>& npcs, float deltaTime);
     
-    // Ground detection
-    bool isEntityOnGround(const PhysicsComponent& entityPhysics, const sf::Vector2f& position, float checkDistance) const;
+    // Ground detection. 'support' (optional) is a slot the caller keeps per
+    // body: the platform found last time is tried first, and the one found is
+    // stored (-1 for the ground line, the tile layer or nothing)
+    bool isEntityOnGround(const PhysicsComponent& entityPhysics, const sf::Vector2f& position, float checkDistance,
+                          int32_t* support = nullptr) const;
     
     // Getters and setters for physics properties
     void setGravity(float g) { gravity = g; }
@@ -51,122 +103,302 @@ public:
     void setJumpForce(float f) { jumpForce = f; }
     float getJumpForce() const { return jumpForce; }
     
-    void setPlayerCollisionSize(float width, float height) { 
-        playerCollisionWidth = width; 
-        playerCollisionHeight = height; 
-    }
-    float getPlayerCollisionWidth() const { return playerCollisionWidth; }
-    float getPlayerCollisionHeight() const { return playerCollisionHeight; }
+    // Collision shapes, in fractions of the sprite size (see CollisionShape).
+    // A change is picked up by each body once, not recomputed every step.
+    void setPlayerCollisionSize(float width, float height) { playerShape.setScale(width, height); }
+    float getPlayerCollisionWidth() const { return playerShape.scale.x; }
+    float getPlayerCollisionHeight() const { return playerShape.scale.y; }
     
-    void setPlayerCollisionOffset(float offsetX, float offsetY) { 
-        playerOffsetX = offsetX; 
-        playerOffsetY = offsetY; 
+    // The player's box is centred on the sprite; the offset is only kept for the panel
+    void setPlayerCollisionOffset(float offsetX, float offsetY) { playerShape.setOffset(offsetX, offsetY); }
+    float getPlayerOffsetX() const { return playerShape.offset.x; }
+    float getPlayerOffsetY() const { return playerShape.offset.y; }
+    // The box the player's next step collides with, for its current bounds
+    sf::FloatRect getPlayerCollisionBox(const Player& player) const {
+        const sf::FloatRect bounds = player.getGlobalBounds();
+        const sf::FloatRect local = playerShape.getLocalBox(bounds.size);
+        return sf::FloatRect(bounds.position + local.position, local.size);
     }
-    float getPlayerOffsetX() const { return playerOffsetX; }
-    float getPlayerOffsetY() const { return playerOffsetY; }
     
-    void setPlayerBounceFactor(float f) { playerBounceFactor = f; }
+    void setPlayerBounceFactor(float f);
     float getPlayerBounceFactor() const { return playerBounceFactor; }
     
-    void setEnemyCollisionSize(float width, float height) { 
-        enemyCollisionWidth = width; 
-        enemyCollisionHeight = height; 
-    }
-    float getEnemyCollisionWidth() const { return enemyCollisionWidth; }
-    float getEnemyCollisionHeight() const { return enemyCollisionHeight; }
+    void setEnemyCollisionSize(float width, float height) { enemyShape.setScale(width, height); }
+    float getEnemyCollisionWidth() const { return enemyShape.scale.x; }
+    float getEnemyCollisionHeight() const { return enemyShape.scale.y; }
     
-    void setEnemyCollisionOffset(float offsetX, float offsetY) { 
-        enemyOffsetX = offsetX; 
-        enemyOffsetY = offsetY; 
-    }
-    float getEnemyOffsetX() const { return enemyOffsetX; }
-    float getEnemyOffsetY() const { return enemyOffsetY; }
+    void setEnemyCollisionOffset(float offsetX, float offsetY) { enemyShape.setOffset(offsetX, offsetY); }
+    float getEnemyOffsetX() const { return enemyShape.offset.x; }
+    float getEnemyOffsetY() const { return enemyShape.offset.y; }
     
-    void setEnemyBounceFactor(float f) { enemyBounceFactor = f; }
+    void setEnemyBounceFactor(float f);
     float getEnemyBounceFactor() const { return enemyBounceFactor; }
     
+    // The player falls (a step specialization setting, see selectStep)
+    void setPlayerGravity(bool enabled);
+    bool hasPlayerGravity() const { return playerGravity; }
+    
+    // Collision layers: each body only meets platforms whose layer its mask has
+    // (and whose mask has its layer). Only platforms are bodies, so the
+    // player's, the enemies' and the NPCs' masks are kept here.
+    void setPlayerCollisionMask(CollisionMask mask) { playerCollisionMask = mask; }
+    CollisionMask getPlayerCollisionMask() const { return playerCollisionMask; }
+    void setEnemyCollisionMask(CollisionMask mask) { enemyCollisionMask = mask; }
+    CollisionMask getEnemyCollisionMask() const { return enemyCollisionMask; }
+    void setNPCCollisionMask(CollisionMask mask) { npcCollisionMask = mask; }
+    CollisionMask getNPCCollisionMask() const { return npcCollisionMask; }
+    void setBodyCollisionMask(PhysicsBodyStore::Handle body, CollisionMask mask) { bodies.mask[body] = mask; }
+    
+    // Where the player touching down is reported; nullptr (the default) reports nothing
+    void setEventQueue(GameEventQueue* queue) { events = queue; }
+    
     void setPlatformFriction(float f) { platformFriction = f; }
     float getPlatformFriction() const { return platformFriction; }
     
-    void setUseOneWayPlatforms(bool use) { useOneWayPlatforms = use; }
+    void setUseOneWayPlatforms(bool use);
     bool getUseOneWayPlatforms() const { return useOneWayPlatforms; }
 
     void setPlayerAcceleration(float a) { playerAcceleration = a; }
     float getPlayerAcceleration() const { return playerAcceleration; }
     
-    // Access to physics components for rendering/debugging
-    const PhysicsComponent& getPlayerPhysicsComponent() const { return playerPhysics; }
-    const PhysicsComponent& getEnemyPhysicsComponent(size_t index) const { 
-        return (index < enemyPhysics.size()) ? enemyPhysics[index] : playerPhysics; // Fallback to player if out of bounds
+    // An enemy's collision box, from its bounds and the enemy collision settings
+    sf::FloatRect getEnemyCollisionBox(const EnemyStore& enemies, size_t index) const {
+        const uint16_t type = enemies.type[index];
+        if (type < enemyBoxes.size() && enemyBoxes[type].version == enemyShape.version) {
+            return enemyBoxes[type].at(enemies.getPosition(index));
+        }
+        const sf::FloatRect local = enemyShape.getLocalBox(enemies.getSize(index));
+        return sf::FloatRect(enemies.getPosition(index) + local.position, local.size);
     }
-    size_t getEnemyPhysicsCount() const { return enemyPhysics.size(); }
     
     // Access to platform physics components for visualization
-    const PhysicsComponent& getPlatformPhysicsComponent(size_t index) const {
-        return (index < platformPhysics.size()) ? platformPhysics[index] : playerPhysics; // Fallback to player if out of bounds
+    PhysicsComponent getPlatformPhysicsComponent(size_t index) const {
+        return index < platformBodies.size() ? bodies.get(platformBodies[index]) : PhysicsComponent();
     }
-    size_t getPlatformPhysicsCount() const { return platformPhysics.size(); }
+    size_t getPlatformPhysicsCount() const { return platformBodies.size(); }
+    const Narrowphase::Surface& getPlatformSurface(size_t index) const { return platformSurfaces[index]; }
     
     // NPC collision settings
-    void setNPCCollisionSize(float width, float height) { 
-        npcCollisionWidth = width; 
-        npcCollisionHeight = height; 
-    }
-    float getNPCCollisionWidth() const { return npcCollisionWidth; }
-    float getNPCCollisionHeight() const { return npcCollisionHeight; }
+    void setNPCCollisionSize(float width, float height) { npcShape.setScale(width, height); }
+    float getNPCCollisionWidth() const { return npcShape.scale.x; }
+    float getNPCCollisionHeight() const { return npcShape.scale.y; }
     
-    void setNPCCollisionOffset(float offsetX, float offsetY) { 
-        npcOffsetX = offsetX; 
-        npcOffsetY = offsetY; 
-    }
-    float getNPCOffsetX() const { return npcOffsetX; }
-    float getNPCOffsetY() const { return npcOffsetY; }
+    void setNPCCollisionOffset(float offsetX, float offsetY) { npcShape.setOffset(offsetX, offsetY); }
+    float getNPCOffsetX() const { return npcShape.offset.x; }
+    float getNPCOffsetY() const { return npcShape.offset.y; }
     
     void setNPCBounceFactor(float f) { npcBounceFactor = f; }
     float getNPCBounceFactor() const { return npcBounceFactor; }
     
-    // Access to NPC physics components
-    const PhysicsComponent& getNPCPhysicsComponent(size_t index) const {
-        return (index < npcPhysics.size()) ? npcPhysics[index] : playerPhysics;
-    }
-    size_t getNPCPhysicsCount() const { return npcPhysics.size(); }
+    // Raw body storage (the platforms)
+    const PhysicsBodyStore& getBodyStore() const { return bodies; }
+    
+    // Broadphase (uniform grid over platforms)
+    void setBroadphaseCellSize(float size);
+    float getBroadphaseCellSize() const { return platformGrid.getCellSize(); }
+    const SpatialGrid& getPlatformGrid() const { return platformGrid; }
+    const BroadphaseStats& getBroadphaseStats() const { return lastBroadphaseStats; }
+    
+    // Scene queries against the platforms, through the grid: a ray visits only
+    // the cells it crosses, boxes the cells they cover. 'mask' picks the
+    // platform layers that count, and platforms are tested as their boxes
+    // (slopes and one-way platforms included). Main thread only; they share
+    // the serial query scratch and count in the broadphase stats.
+    // Nearest platform the segment from 'origin' to origin + direction * maxDistance
+    // enters ('direction' need not be normalized); boxes containing 'origin' are ignored
+    bool raycast(const sf::Vector2f& origin, const sf::Vector2f& direction, float maxDistance, QueryHit& hit,
+                 CollisionMask mask = COLLIDE_TERRAIN) const;
+    // Platforms overlapping 'box' (strict edges) into 'out', ascending; returns the count
+    size_t overlapBox(const sf::FloatRect& box, std::vector<uint32_t>& out, CollisionMask mask = COLLIDE_TERRAIN) const;
+    // First platform 'box' touches while moving by 'move'; false if the path is clear
+    bool sweepBox(const sf::FloatRect& box, const sf::Vector2f& move, QueryHit& hit,
+                  CollisionMask mask = COLLIDE_TERRAIN) const;
+    
+    // Body sleeping. An enemy or NPC that has rested on a platform (no vertical
+    // motion) for SLEEP_TICKS steps while outside the activation radius around
+    // the player is skipped, AI included for enemies, until something wakes it:
+    // the player coming within the radius or touching it, its NPC logic moving
+    // it, new platforms, or wakeEnemy/wakeNPC/wakeAll from a script.
+    static constexpr uint16_t SLEEP_TICKS = 60;
+    static constexpr float SLEEP_VELOCITY = 0.05f; // Per-step vertical speed that still counts as resting
+    void setSleepingEnabled(bool enabled);         // Disabling wakes everything
+    bool isSleepingEnabled() const { return sleepingEnabled; }
+    void setActivationRadius(float radius) { activationRadius = radius; }
+    float getActivationRadius() const { return activationRadius; }
+    bool isEnemyAsleep(size_t index) const { return enemyStore && index < enemyStore->size() && !enemyStore->awake[index]; }
+    bool isNPCAsleep(size_t index) const;
+    void wakeEnemy(size_t index);
+    void wakeNPC(size_t index);
+    void wakeAll();
+    const SleepStats& getSleepStats() const { return lastSleepStats; }
+    
+    // Simulation regions (physics level of detail). Enemies farther than the
+    // region radius from 'focus' turn coarse (see EnemyStore::demote): they
+    // leave the patrol step, the sweep and sleeping, and walk their patrol as
+    // a function of time, without collisions. They come back into the full
+    // simulation, where that patrol has got them, once within the radius
+    // again; REGION_HYSTERESIS keeps one on the border from flipping every
+    // step. Only grounded enemies go coarse, so a fall always plays out.
+    // Run once per step before the enemy update, on the main thread; 0 turns
+    // regions off and promotes everything.
+    static constexpr float REGION_HYSTERESIS = 1.25f; // Demotion radius over promotion radius
+    void updateRegions(EnemyStore& enemies, const sf::Vector2f& focus, float deltaTime);
+    void setRegionRadius(float radius) { regionRadius = radius; }
+    float getRegionRadius() const { return regionRadius; }
+    
+    // Step specialization. initialize() (once per level) picks a step compiled
+    // for the level's settings: whether the player falls, one-way solids and
+    // whether any ceiling bounce is nonzero, so the sweeps don't test them per
+    // body. Changing one of those afterwards (the debug panel) runs the generic
+    // step, which reads them every time, until the next level.
+    void setStepSpecialization(bool enabled); // Off: always the generic step
+    bool isStepSpecialization() const { return stepSpecialization; }
+    const char* getStepName() const { return stepName; }
+    
+    // Optional worker pool for the per-enemy passes (serial when null)
+    void setJobSystem(JobSystem* jobs) { jobSystem = jobs; }
+    
+    // Platform bounds in platform order, for batch overlap tests outside the physics system
+    const AabbBatch::BoxArray& getPlatformBoxes() const { return platformBoxes; }
+    
+    // Save states: platform bodies, the player's box that sleeping compares
+    // against and the player acceleration the input sets each step. Enemy and
+    // NPC sleep state is saved with their records. Tuning stays as it is.
+    void saveState(SimSnapshot& snapshot) const;
+    bool loadState(SimSnapshot& snapshot);
+    void snapState() { bodies.snapState(); } // Platform positions (GAME_FIXED_POINT)
     
 private:
     // Helper methods
-    void resolveCollisions(Player& player, std::vector<Enemy>& enemies);
-    bool checkCollision(const PhysicsComponent& a, const PhysicsComponent& b);
-    void applyPhysicsToEntities(Player& player, std::vector<Enemy>& enemies);
+    bool isOnGroundAt(const sf::Vector2f& position, const sf::Vector2f& size, float checkDistance,
+                      CollisionLayer layer, CollisionMask mask, int32_t* support) const;
+    // Ground contact caching. A body remembers the platform it stands on; the
+    // next check compares against that platform alone and only falls back to
+    // the broadphase once it no longer holds the body up.
+    bool isStandingOn(size_t platform, const sf::Vector2f& position, const sf::Vector2f& size,
+                      float checkDistance) const; // isOnGroundAt's test against one platform
+    // A flat platform 'box' rests on exactly as a sweep leaves it, so a sweep
+    // that doesn't move the body would only settle it there again
+    bool isRestingOn(int32_t platform, const sf::FloatRect& box) const;
+    void forgetSupports(); // The level geometry changed
+    void releaseBodies(std::vector<PhysicsBodyStore::Handle>& handles);
+    void applyPhysicsToEntities(EnemyStore& enemies);
+    void rebuildPlatformGrid();
+    // Per-thread query buffers and counters
+    struct QueryScratch {
+        std::vector<size_t> candidates;
+        std::vector<size_t> loose;   // Loose grid hits, before mapping to platform indices
+        AabbBatch::BoxArray boxes;   // Candidate boxes gathered for the batch kernel
+        std::vector<uint32_t> hits;
+        BroadphaseStats stats;
+    };
+    // Platforms near 'area' that a body of 'layer' with 'mask' can touch, ascending;
+    // without 'withTiles' the tile layer's platforms are left out
+    const std::vector<size_t>& queryPlatforms(const sf::FloatRect& area, CollisionLayer layer, CollisionMask mask,
+                                              QueryScratch& scratch, bool withTiles = true) const;
+    // Sweeps a body that ended the step at 'end' after moving by 'move'
+    template <class Policy>
+    Narrowphase::SweepResult sweepBody(const sf::FloatRect& end, const sf::Vector2f& move, bool wasGrounded,
+                                       CollisionLayer layer, CollisionMask mask, QueryScratch& scratch) const;
+    // sweepBody, skipped for a grounded body that didn't move and still rests
+    // on 'support'; otherwise sweeps and caches the surface it stood on
+    template <class Policy>
+    Narrowphase::SweepResult resolveBody(const sf::FloatRect& end, const sf::Vector2f& move, bool wasGrounded,
+                                         int32_t& support, CollisionLayer layer, CollisionMask mask,
+                                         QueryScratch& scratch) const;
+    const std::vector<uint32_t>& findPlatformHits(const sf::FloatRect& box, CollisionLayer layer, CollisionMask mask,
+                                                  QueryScratch& scratch) const;
+    void filterCandidates(CollisionMask mask, QueryScratch& scratch) const; // Keeps platforms on 'mask' layers
+    void forEachEnemyRange(size_t count, const JobSystem::RangeFunction& fn);
+    // Sleeping helpers; each only touches one entity, so enemy ranges can call them in parallel
+    bool isNearPlayer(const sf::FloatRect& box) const; // Within the activation radius or touching
+    void updateEnemyRest(EnemyStore& enemies, size_t index, bool resting);
+    void updateNPCRest(NPCSystem::NPCData& npc, bool resting);
+    void demoteEnemy(EnemyStore& enemies, size_t index); // Finds the floor its coarse patrol keeps to
+    void mergeStats(const BroadphaseStats& stats);
+    
+    // Compile-time step configurations (Physics.cpp); GENERIC reads the settings instead
+    template <bool Generic, bool Gravity, bool OneWay, bool Bounce>
+    struct StepPolicy;
+    using StepFunction = void (PhysicsSystem::*)(float, Player&, EnemyStore&);
+    void selectStep();
+    void useGenericStep(); // After a setting a specialized step fixed has changed
+    template <class Policy>
+    void step(float deltaTime, Player& player, EnemyStore& enemies);
+    template <class Policy>
+    void resolvePlayer(Player& player, sf::Vector2f& velocity);
+    template <class Policy>
+    void resolveEnemies(EnemyStore& enemies, size_t begin, size_t end, QueryScratch& scratch);
     
     // Physics parameters
     float gravity;
     float terminalVelocity;
     float jumpForce;
-    float playerCollisionWidth;
-    float playerCollisionHeight;
-    float playerOffsetX;
-    float playerOffsetY;
+    CollisionShape playerShape;
     float playerBounceFactor;
-    float enemyCollisionWidth;
-    float enemyCollisionHeight;
-    float enemyOffsetX;
-    float enemyOffsetY;
+    bool playerGravity = true;
+    CollisionMask playerCollisionMask = defaultCollisionMask(CollisionLayer::Player);
+    CollisionShape enemyShape;
     float enemyBounceFactor;
+    CollisionMask enemyCollisionMask = defaultCollisionMask(CollisionLayer::Enemy);
+    GameEventQueue* events = nullptr;
     float platformFriction;
     float playerAcceleration;
     bool useOneWayPlatforms;
     
     // NPC physics parameters
-    float npcCollisionWidth;
-    float npcCollisionHeight;
-    float npcOffsetX;
-    float npcOffsetY;
+    CollisionShape npcShape;
     float npcBounceFactor;
+    CollisionMask npcCollisionMask = defaultCollisionMask(CollisionLayer::NPC);
+    
+    // Local collision boxes derived from the shapes (each NPC keeps its own in NPCData::box)
+    ShapeCache playerBox;
+    std::vector<ShapeCache> enemyBoxes; // By enemy type; every enemy of a type has its size
+    sf::FloatRect playerCollisionBox;   // Where the player's box is, as of its last sweep
+    
+    // Cached ground contacts (see isRestingOn); enemies and NPCs keep theirs in their records
+    int32_t playerSupport = -1;
+    
+    // Physics bodies: the platforms, platform index -> store handle. The player,
+    // enemies and NPCs have none (see initializeEnemies and initializeNPCs).
+    PhysicsBodyStore bodies;
+    std::vector<PhysicsBodyStore::Handle> platformBodies;
+    EnemyStore* enemyStore = nullptr;
+    std::vector<NPCSystem::NPCData>* npcStore = nullptr;
+    
+    // Platform broadphase; serial queries reuse mainScratch, parallel passes
+    // use thread-local scratch and merge their counters under statsMutex
+    SpatialGrid platformGrid;
+    AabbBatch::BoxArray platformBoxes;
+    std::vector<Narrowphase::SurfaceType> platformTypes;  // Parallel to platformBodies
+    std::vector<Narrowphase::Surface> platformSurfaces;   // Narrowphase copy, rebuilt with the grid
+    mutable QueryScratch mainScratch;
+    
+    // Tile layer, and what didn't fit on it
+    TileMap tileMap;
+    SpatialGrid looseGrid;
+    std::vector<uint32_t> loosePlatforms;   // Platform index of each looseGrid item (removed ones stay listed)
+    std::vector<sf::FloatRect> looseLadders;
+    std::mutex statsMutex;
+    BroadphaseStats lastBroadphaseStats;
+    
+    // Sleeping
+    bool sleepingEnabled = true;
+    float activationRadius = 800.0f;
+    sf::Vector2f playerCenter;  // Player box centre as of the last update
+    SleepStats sleepStats;      // In progress (updateNPCs runs before update)
+    SleepStats lastSleepStats;
+    float regionRadius = 2400.0f;
+    std::vector<uint32_t> floorHits;      // demoteEnemy's scratch: platforms at its feet,
+    std::vector<sf::Vector2f> floorSpans; // and their left and right edges
+    
+    // Step dispatch (selectStep)
+    StepFunction stepFunction = nullptr;
+    const char* stepName = "";
+    bool stepSpecialization = true;
     
-    // Physics components
-    PhysicsComponent playerPhysics;
-    std::vector<PhysicsComponent> enemyPhysics;
-    std::vector<PhysicsComponent> platformPhysics;
-    std::vector<PhysicsComponent> npcPhysics;
+    JobSystem* jobSystem = nullptr;
+    static constexpr size_t ENEMY_GRAIN = 64; // Enemies per parallel chunk (minimum)
     
     // Window dimensions (needed for ground collision)
     int windowWidth;
@@ -0,0 +1,104 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cstdint>
+#include "CollisionLayers.hpp"
+
+class SimSnapshot;
+
+// Physics component to store collision properties
+// (AoS view of a single body, used by the inspector and for initialization)
+struct PhysicsComponent {
+    sf::FloatRect collisionBox;
+    sf::Vector2f velocity;
+    bool hasGravity;
+    bool isStatic;
+    float bounceFactor;
+    float friction;
+    CollisionLayer layer;
+    CollisionMask mask;   // Layers this body interacts with
+
+    PhysicsComponent() : velocity(0.0f, 0.0f), hasGravity(true), isStatic(false),
+                         bounceFactor(0.0f), friction(0.0f), layer(CollisionLayer::Solid),
+                         mask(defaultCollisionMask(CollisionLayer::Solid)) {}
+};
+
+// Structure-of-arrays storage for every physics body (player, enemies, NPCs, platforms).
+// Hot loops walk the contiguous position/size/velocity arrays directly; material data
+// lives in separate arrays so it stays out of the cache unless a collision needs it.
+// Handles are slot indices and stay valid until the body is destroyed.
+class PhysicsBodyStore {
+public:
+    using Handle = uint32_t;
+    static constexpr Handle InvalidHandle = 0xFFFFFFFFu;
+
+    enum Flags : uint8_t {
+        FlagAlive   = 1 << 0,
+        FlagGravity = 1 << 1,
+        FlagStatic  = 1 << 2,
+        FlagAsleep  = 1 << 3  // Skipped by PhysicsSystem until woken
+    };
+
+    Handle create(const PhysicsComponent& init = PhysicsComponent());
+    void destroy(Handle handle);
+    void clear();
+
+    bool isValid(Handle handle) const { return handle < flags.size() && (flags[handle] & FlagAlive); }
+    size_t size() const { return liveCount; }
+    size_t capacity() const { return flags.size(); }
+
+    // Conversion to/from the AoS view
+    PhysicsComponent get(Handle handle) const;
+    void set(Handle handle, const PhysicsComponent& component);
+
+    sf::FloatRect getBox(Handle handle) const {
+        return sf::FloatRect(sf::Vector2f(posX[handle], posY[handle]), sf::Vector2f(width[handle], height[handle]));
+    }
+    void setBox(Handle handle, const sf::FloatRect& box) {
+        posX[handle] = box.position.x;
+        posY[handle] = box.position.y;
+        width[handle] = box.size.x;
+        height[handle] = box.size.y;
+    }
+    sf::Vector2f getVelocity(Handle handle) const { return sf::Vector2f(velX[handle], velY[handle]); }
+    void setVelocity(Handle handle, const sf::Vector2f& v) { velX[handle] = v.x; velY[handle] = v.y; }
+
+    bool hasGravity(Handle handle) const { return (flags[handle] & FlagGravity) != 0; }
+    bool isStatic(Handle handle) const { return (flags[handle] & FlagStatic) != 0; }
+    bool isAsleep(Handle handle) const { return (flags[handle] & FlagAsleep) != 0; }
+    bool canCollide(Handle a, Handle b) const { return ::canCollide(layer[a], mask[a], layer[b], mask[b]); }
+    void setFlag(Handle handle, Flags flag, bool enabled) {
+        flags[handle] = enabled ? static_cast<uint8_t>(flags[handle] | flag)
+                                : static_cast<uint8_t>(flags[handle] & ~flag);
+    }
+
+    // Save states: boxes, velocities, flags, the free list and live count, so
+    // handles stay valid. Materials and layers are set when a body is created,
+    // and a restore needs the same bodies, so they aren't saved.
+    void saveState(SimSnapshot& snapshot) const;
+    bool loadState(SimSnapshot& snapshot);
+    // Positions and velocities onto the fixed-point grid (GAME_FIXED_POINT)
+    void snapState();
+
+    // AABB overlap test straight off the SoA arrays (strict edges)
+    bool overlaps(Handle a, Handle b) const {
+        return posX[a] < posX[b] + width[b] && posX[a] + width[a] > posX[b] &&
+               posY[a] < posY[b] + height[b] && posY[a] + height[a] > posY[b];
+    }
+
+    // Hot data: collision box and velocity
+    std::vector<float> posX, posY, width, height;
+    std::vector<float> velX, velY;
+
+    // Cold data: flags and material
+    std::vector<uint8_t> flags;
+    std::vector<float> bounce;
+    std::vector<float> friction;
+    std::vector<uint16_t> restTicks; // Consecutive resting steps, for sleeping
+    std::vector<CollisionLayer> layer;
+    std::vector<CollisionMask> mask;
+
+private:
+    std::vector<Handle> freeList;
+    size_t liveCount = 0;
+};
@@ -2,17 +2,40 @@
 #include <SFML/Graphics.hpp>
 #include <vector>
 #include "Animation.hpp"
+#include "LevelGeometry.hpp"
 
 // Forward declaration to avoid circular includes
+class GameEventQueue;
 class PhysicsSystem;
+class RenderSnapshot;
+class RenderQueue;
+class SimSnapshot;
+
+// Controls held during one simulation step
+struct PlayerInput {
+    bool left = false;
+    bool right = false;
+    bool up = false;
+    bool down = false;
+    bool jump = false;
+    
+    static PlayerInput fromKeyboard();
+};
 
 class Player {
 public:
-    Player(float x, float y, PhysicsSystem& physics);
-    void update(float deltaTime, const std::vector<sf::RectangleShape>& platforms, const std::vector<sf::RectangleShape>& ladders);
-    void draw(sf::RenderWindow& window);
+    // loadAnimations = false skips the sprite frames (headless runs have no textures)
+    Player(float x, float y, PhysicsSystem& physics, bool loadAnimations = true);
+    void update(float deltaTime, const LevelGeometry& platforms); // Ladders come from PhysicsSystem::isOnLadder
+    void draw(RenderQueue& queue, float alpha = 1.0f); // The sprite, in RenderLayer::Player
     void handleInput();
     
+    // Drive the player from 'input' (must outlive the player) instead of polling the keyboard; nullptr restores it
+    // (Game points it at the controls InputSystem hands each step)
+    void setScriptedInput(const PlayerInput* input) { scriptedInput = input; }
+    // Where the player reports jumping; nullptr (the default) reports nothing
+    void setEventQueue(GameEventQueue* queue) { events = queue; }
+    
     // Getter for player position
     sf::Vector2f getPosition() const { return position; }
     sf::Vector2f getSize() const { return collisionBox.getSize(); }
@@ -24,6 +47,14 @@ public:
     // Setter for player position (used when pushed by enemies)
     void setPosition(const sf::Vector2f& pos);
     
+    // Where update() started this step; PhysicsSystem sweeps the move from here
+    sf::Vector2f getStepStart() const { return stepStart; }
+    void markStepResolved() { stepStart = position; }
+    
+    // Render interpolation between the previous and current simulation step
+    void storePreviousState() { previousPosition = position; }
+    sf::Vector2f getRenderPosition(float alpha) const { return previousPosition + (position - previousPosition) * alpha; }
+    
     // Collision box settings
     void setCollisionBoxSize(const sf::Vector2f& size);
     void setCollisionBoxOffset(const sf::Vector2f& offset);
@@ -40,6 +71,12 @@ public:
     // Reset player to initial state
     void reset(float x, float y);
     
+    // Save states: movement state and collision box; the animation carries on
+    void saveState(SimSnapshot& snapshot) const;
+    bool loadState(SimSnapshot& snapshot);
+    // Position and velocity onto the fixed-point grid (GAME_FIXED_POINT), after a step
+    void snapState();
+    
     // Animation methods
     void initializeAnimations();
     void updateAnimation(float deltaTime);
@@ -47,12 +84,17 @@ public:
     bool hasAnimations() const;
 
     // Debug methods
-    void drawDebugInfo(sf::RenderWindow& window);
+    void drawDebugInfo(RenderSnapshot& snapshot);
+    void drawDebugBounds(RenderSnapshot& snapshot, float alpha = 1.0f); // Sprite and collision box outlines
     void toggleDebugInfo() { showDebugInfo = !showDebugInfo; }
+    void setDebugFont(const sf::Font* font) { debugFont = font; } // Owned by the asset manager; null hides the text
+    static constexpr unsigned DEBUG_TEXT_SIZE = 14;
     bool isDebugInfoEnabled() const { return showDebugInfo; }
 
 private:
     sf::Vector2f position;           // Player's position in the world
+    sf::Vector2f previousPosition;   // Position at the previous simulation step
+    sf::Vector2f stepStart;          // Position before this step's move
     sf::RectangleShape collisionBox; // Collision box for physics
     sf::Vector2f collisionOffset;    // Offset of collision box from position
     sf::Vector2f velocity;
@@ -60,6 +102,9 @@ private:
     bool onGround;
     bool onLadder;
     bool facingLeft;                 // Track which direction player is facing
+    PlayerInput input;               // Sampled at the start of each update
+    const PlayerInput* scriptedInput = nullptr;
+    GameEventQueue* events = nullptr;
     
     // Debug properties
     bool showDebugInfo = false;
@@ -71,6 +116,7 @@ private:
         bool prevIsJumping = false;
         float lastGroundY = 0.0f;
     } debugInfo;
+    const sf::Font* debugFont = nullptr; // Snapshot text points at it, so it must outlive the frame
     
     // Reference to physics system
     PhysicsSystem& physicsSystem;
@@ -78,12 +124,12 @@ private:
     // Animation system
     Animation playerAnimation;
     bool animationsLoaded;
+    sf::Sprite makeRenderSprite(float alpha) const; // Current frame, scaled, flipped and placed
     
+    // CLIMB_SPEED, JUMP_FORCE and GRAVITY are per-step values tuned at TUNED_STEP_RATE
+    static constexpr float TUNED_STEP_RATE = 60.0f;
     static constexpr float PLAYER_SPEED = 300.0f;
     static constexpr float CLIMB_SPEED = 3.0f;
     static constexpr float JUMP_FORCE = -15.0f;
     static constexpr float GRAVITY = 0.6f;
-    
-    // Helper method for platform checks
-    bool checkPlatformAbove(const std::vector<sf::RectangleShape>& platforms);
 }; 
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Sparse bucket grid over moving points (NPC positions). Items are dense ids
+// 0..n-1 owned by the caller; each remembers its cell, so move() is a no-op
+// unless the point crossed into another cell, and buckets are swap-removed in
+// constant time. Only occupied cells exist, so wide levels cost nothing extra.
+class PointGrid {
+public:
+    explicit PointGrid(float cellSize = 256.0f);
+
+    void clear();
+    void insert(uint32_t item, const sf::Vector2f& position);
+    void move(uint32_t item, const sf::Vector2f& position);
+    void remove(uint32_t item);
+
+    size_t getItemCount() const { return itemCount; }
+    size_t getCellCount() const { return cells.size(); }
+    float getCellSize() const { return cellSize; }
+
+    // Calls visit(item) for every item in a cell touching 'area' (the caller
+    // does the exact test)
+    template <typename Visitor>
+    void forEachCandidate(const sf::FloatRect& area, Visitor&& visit) const {
+        const int32_t minX = cellCoord(area.position.x);
+        const int32_t maxX = cellCoord(area.position.x + area.size.x);
+        const int32_t minY = cellCoord(area.position.y);
+        const int32_t maxY = cellCoord(area.position.y + area.size.y);
+        for (int32_t cy = minY; cy <= maxY; ++cy) {
+            for (int32_t cx = minX; cx <= maxX; ++cx) {
+                auto it = cells.find(key(cx, cy));
+                if (it == cells.end()) continue;
+                for (uint32_t item : it->second) {
+                    visit(item);
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    int32_t cellCoord(float value) const;
+    static uint64_t key(int32_t cx, int32_t cy) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+    }
+    void link(uint32_t item, uint64_t cell);
+    void unlink(uint32_t item);
+
+    float cellSize;
+    size_t itemCount = 0;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells; // Emptied buckets keep their capacity
+    std::vector<uint64_t> itemCell;                           // Indexed by item
+    std::vector<uint32_t> itemSlot;                           // Position in its bucket, NONE if absent
+};
@@ -0,0 +1,155 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Frame CPU profiler built from scoped zones.
+//   - PROFILE_ZONE("name") times the rest of the enclosing scope. Names must be
+//     string literals (only the pointer is stored).
+//   - Each thread records finished zones into its own ring buffer; the buffer's
+//     lock is only contended while PROFILE_FRAME() drains it once per frame.
+//   - PROFILE_FRAME() (main thread, once per frame) closes the previous frame
+//     and files every zone finished since into the frame history.
+//   - PROFILE_EVENT("name") marks a moment (a log flush, a stolen voice) on
+//     the calling thread's track: a zone with no duration.
+//   - startCapture()/stopCapture() record every zone, frame and counter in
+//     between into preallocated buffers and write them as Chrome Trace Event
+//     JSON (chrome://tracing, Perfetto) once the capture has ended.
+// Everything expands to nothing when GAME_PROFILER is 0 (cmake -DGAME_PROFILER=OFF).
+// With GAME_TRACY (cmake -DGAME_TRACY=ON) the same zones also stream to Tracy.
+
+#ifndef GAME_PROFILER
+#define GAME_PROFILER 1
+#endif
+
+#ifndef GAME_TRACY
+#define GAME_TRACY 0
+#endif
+
+#if GAME_PROFILER && GAME_TRACY
+#include <tracy/Tracy.hpp>
+#endif
+
+namespace Profiler {
+
+struct ZoneEvent {
+    const char* name;
+    uint64_t startNs;     // Since the profiler started
+    uint64_t endNs;
+    uint32_t threadIndex; // See getThreadNames()
+    uint32_t depth;       // Nesting level on its thread
+};
+
+struct CounterSample {
+    const char* name;
+    uint64_t ns;
+    double value;
+};
+
+struct FrameRecord {
+    uint64_t index = 0;
+    uint64_t startNs = 0;
+    uint64_t endNs = 0;
+    std::vector<ZoneEvent> zones; // Grouped by thread, then in start order
+    std::vector<CounterSample> counters; // plotCounter calls since the previous frame mark
+    uint64_t allocations = 0;     // Heap allocations during the frame, all threads
+    uint64_t allocatedBytes = 0;
+    double getMs() const { return (endNs - startNs) / 1e6; }
+};
+
+struct CaptureStats {
+    bool capturing = false;
+    size_t zones = 0;        // Recorded so far
+    size_t capacity = 0;     // Preallocated at startCapture
+    size_t counters = 0;
+    uint64_t frames = 0;
+    uint64_t dropped = 0;    // Zones or counters that didn't fit
+    double seconds = 0.0;
+};
+
+constexpr size_t THREAD_BUFFER_EVENTS = 4096; // Zones a thread may finish between frame marks
+constexpr size_t FRAME_HISTORY = 300;
+constexpr size_t CAPTURE_EVENTS = 1 << 20;    // Default capture capacity (32 MB of zones)
+
+uint64_t now();
+
+// Labels the calling thread in the profiler views
+void setThreadName(const char* name);
+
+// Main thread only, as are the frame accessors below
+void frameMark();
+void setPaused(bool paused); // Keeps the history still for inspection
+bool isPaused();
+
+size_t getFrameCount();                  // Recorded frames, up to FRAME_HISTORY
+const FrameRecord& getFrame(size_t age); // 0 = newest
+uint64_t getDroppedZones();              // Overwritten before a frame mark drained them
+std::vector<std::string> getThreadNames();
+
+// Per-frame value (draw calls, ...) shown as a counter track. Main thread;
+// 'name' must be a string literal. Kept with the frame history, and in the
+// capture while one runs.
+void plotCounter(const char* name, double value);
+// See PROFILE_EVENT; any thread
+void markEvent(const char* name);
+
+// Capture, main thread only. startCapture allocates the buffers up front and
+// fails if a capture is already running; stopCapture writes the trace to the
+// path given at the start and returns false if the file couldn't be written.
+bool startCapture(const std::string& path, size_t maxEvents = CAPTURE_EVENTS);
+bool stopCapture();
+bool isCapturing();
+bool isCaptureFull();
+// A copy of the newest frames of the history, oldest first, for formatting
+// off the main thread. Main thread.
+struct HistorySnapshot {
+    std::vector<FrameRecord> frames;
+    std::vector<std::string> threadNames;
+    uint32_t mainThread = 0; // Track of the frames themselves
+};
+HistorySnapshot snapshotHistory(size_t frames);
+// The snapshot as Chrome Trace JSON (empty without frames); any thread
+std::string formatHistory(const HistorySnapshot& snapshot);
+// The newest 'frames' of the frame history as Chrome Trace JSON, for a trace
+// of the moments around a screenshot. Main thread.
+std::string formatHistory(size_t frames);
+const std::string& getCapturePath(); // Of the running (or last) capture
+CaptureStats getCaptureStats();
+
+class ScopedZone {
+public:
+    explicit ScopedZone(const char* name);
+    ~ScopedZone();
+
+    ScopedZone(const ScopedZone&) = delete;
+    ScopedZone& operator=(const ScopedZone&) = delete;
+
+private:
+    const char* name;
+    uint64_t startNs;
+    uint32_t depth;
+};
+
+} // namespace Profiler
+
+#if GAME_PROFILER && GAME_TRACY
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) Profiler::ScopedZone PROFILE_CONCAT(profileZone_, __LINE__)(name); ZoneScopedN(name)
+#define PROFILE_FRAME() do { Profiler::frameMark(); FrameMark; } while (0)
+#define PROFILE_EVENT(name) do { Profiler::markEvent(name); TracyMessageL(name); } while (0)
+#define PROFILE_THREAD(name) do { Profiler::setThreadName(name); tracy::SetThreadName(name); } while (0)
+#elif GAME_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) Profiler::ScopedZone PROFILE_CONCAT(profileZone_, __LINE__)(name)
+#define PROFILE_FRAME() Profiler::frameMark()
+#define PROFILE_EVENT(name) Profiler::markEvent(name)
+#define PROFILE_THREAD(name) Profiler::setThreadName(name)
+#else
+#define PROFILE_ZONE(name) do { } while (0)
+#define PROFILE_FRAME() do { } while (0)
+#define PROFILE_EVENT(name) do { } while (0)
+#define PROFILE_THREAD(name) do { } while (0)
+#endif
@@ -0,0 +1,140 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+#include "CollisionLayers.hpp"
+#include "CrowdRenderer.hpp"
+#include "ViewCulling.hpp"
+
+class SweepAndPrune;
+class SpatialGrid;
+class LevelGeometry;
+class JobSystem;
+class GameEventQueue;
+class SimSnapshot;
+
+// What a projectile step tests against. The terrain grid is PhysicsSystem's
+// platform grid over 'terrain'; 'entities' is the entity broadphase, sorted
+// by this step's updatePairs.
+struct ProjectileWorld {
+    const SweepAndPrune& entities;
+    const SpatialGrid& terrainGrid;
+    const LevelGeometry& terrain;
+    sf::FloatRect levelBounds;   // Projectiles leaving it expire
+    JobSystem* jobs = nullptr;   // Optional
+    GameEventQueue* events = nullptr; // Optional
+};
+
+// Projectiles and attack hitboxes. Projectiles are structure-of-arrays
+// storage like EnemyStore: dense indices 0..size()-1, with spawn() appending
+// and the step compacting away the ones that hit, were blocked or ran out,
+// in order, so the arrays keep their capacity and no shot allocates once
+// they have grown. Each step moves every projectile and sweeps its box along
+// the move against the terrain (every platform as its box, through the
+// static grid) and against the entities on its target layers (through the
+// sort-and-sweep's query); the earliest contact wins, and a wall in front
+// of a target shields it. The sweeps run in parallel chunks; only the
+// results are handled serially, in index order, so hits are deterministic.
+//
+// A hitbox (a melee swing) is tested by the next step only, and hits every
+// target it overlaps then. Hits are listed for the game's rules (getHits)
+// and emitted as PlayerStruck / EnemyStruck / NPCStruck events, projectiles
+// first, in index order, then hitboxes.
+class ProjectileSystem {
+public:
+    static constexpr uint32_t NO_PROJECTILE = UINT32_MAX;
+    static constexpr size_t MAX_PROJECTILES = 65536; // spawn() refuses more
+    static constexpr size_t GRAIN = 512;             // Projectiles per job chunk
+    static constexpr double BUDGET_MS = 1.0;         // A step of 10k live projectiles should fit
+
+    // What is fired; the defaults are the player's shots
+    struct Shot {
+        CollisionLayer owner = CollisionLayer::Player;
+        CollisionMask targets = collisionBit(CollisionLayer::Enemy);
+        sf::Vector2f size{6.f, 6.f};
+        float lifetime = 2.f;  // Seconds
+        float damage = 1.f;
+        float gravity = 0.f;   // Pixels per second squared
+    };
+
+    struct Hit {
+        CollisionLayer target;
+        uint32_t targetIndex;  // The struck entity's index (its broadphase proxy's)
+        CollisionLayer owner;
+        sf::Vector2f point;    // The projectile's centre at contact, or the hitbox's
+        sf::Vector2f velocity; // Zero for hitboxes
+        float damage;
+    };
+
+    struct Stats {
+        size_t live = 0;
+        size_t spawned = 0;    // Between the last step and the one before
+        size_t hits = 0;       // Last step, hitboxes included
+        size_t blocked = 0;    // Stopped by terrain
+        size_t expired = 0;    // Lifetime over, or out of the level
+        size_t candidates = 0; // Terrain and entity boxes swept against
+    };
+
+    // Centre and velocity (pixels per second); NO_PROJECTILE when full
+    uint32_t spawn(const Shot& shot, const sf::Vector2f& centre, const sf::Vector2f& velocity);
+    // 'box' in world pixels; the shot's size, lifetime and gravity don't apply
+    void spawnHitbox(const Shot& shot, const sf::FloatRect& box);
+    void clear();
+    void reserve(size_t count);
+
+    size_t size() const { return posX.size(); }
+    size_t capacity() const { return posX.capacity(); }
+    bool empty() const { return posX.empty(); }
+
+    void step(const ProjectileWorld& world, float deltaTime);
+    const std::vector<Hit>& getHits() const { return hits; } // Last step's
+    const Stats& getStats() const { return stats; }
+
+    // A solid quad per projectile some view sees, tagged with those views; returns how many
+    size_t addToCrowd(CrowdRenderer& crowd, const ViewCulling::ViewSet& views, float alpha) const;
+
+    // Save states: the live projectiles and the hitboxes waiting for the next step
+    void saveState(SimSnapshot& snapshot) const;
+    bool loadState(SimSnapshot& snapshot);
+    void snapState(); // Onto the fixed-point grid (GAME_FIXED_POINT), after a step
+
+    // Hot data: the move reads and writes these
+    std::vector<float> posX, posY;     // Centres
+    std::vector<float> velX, velY;
+    std::vector<float> gravity;
+    std::vector<float> life;           // Seconds left
+    // Warm data: the sweeps
+    std::vector<float> prevX, prevY;   // Start of the last step's move, for interpolation
+    std::vector<float> halfW, halfH;
+    std::vector<CollisionMask> targets;
+    // Cold data: the hit itself
+    std::vector<CollisionLayer> owner;
+    std::vector<float> damage;
+
+private:
+    enum class Outcome : uint8_t { Flying, Hit, Blocked, Expired };
+
+    struct Hitbox {
+        sf::FloatRect box;
+        CollisionLayer owner;
+        CollisionMask targets;
+        float damage;
+    };
+
+    // Moves and tests [begin, end); returns the boxes tested
+    size_t sweep(const ProjectileWorld& world, size_t begin, size_t end, float deltaTime);
+    void record(const ProjectileWorld& world, CollisionLayer target, uint32_t targetIndex, CollisionLayer from,
+                const sf::Vector2f& point, const sf::Vector2f& velocity, float hitDamage);
+    void resize(size_t count);
+
+    // The sweeps' results, per projectile
+    std::vector<Outcome> outcome;
+    std::vector<uint32_t> hitProxy;
+    std::vector<float> hitTime;        // Fraction of the move
+
+    std::vector<Hitbox> hitboxes;
+    std::vector<uint32_t> proxies;     // Hitbox query scratch
+    std::vector<Hit> hits;
+    Stats stats;
+    size_t spawnedSinceStep = 0;
+};
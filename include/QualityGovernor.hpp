@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Holds a frame time target by stepping a quality level (0 = lowest) up and
+// down; what a level means is up to the caller (Game's QUALITY_PRESETS). Each
+// frame feeds in its CPU work time and the GPU time of a recent frame, and the
+// slower of the two, smoothed, is what's compared with the target. Hysteresis
+// keeps it from flapping: a level drops only after frames stay over DROP_SHARE
+// of the target for DROP_SECONDS and rises only after they stay under
+// RAISE_SHARE for the raise delay, with COOLDOWN_SECONDS between any two
+// changes. A rise that has to be taken back within BOUNCE_SECONDS doubles the
+// raise delay (up to MAX_RAISE_SECONDS), so a level that can't quite be held
+// is retried less and less often. The level never rises past the ceiling,
+// the preset the player picked.
+class QualityGovernor {
+public:
+    static constexpr double DROP_SHARE = 1.05;
+    static constexpr double DROP_SECONDS = 0.5;
+    static constexpr double RAISE_SHARE = 0.7;
+    static constexpr double RAISE_SECONDS = 3.0;
+    static constexpr double MAX_RAISE_SECONDS = 48.0;
+    static constexpr double COOLDOWN_SECONDS = 1.0;
+    static constexpr double BOUNCE_SECONDS = 5.0;
+    static constexpr double SMOOTHING = 0.1; // Weight of the newest frame
+
+    struct Stats {
+        double cpuMs = 0.0;      // Last frame fed in
+        double gpuMs = 0.0;
+        double smoothedMs = 0.0; // What the target is compared with
+        bool gpuBound = false;
+        double raiseSeconds = RAISE_SECONDS; // Current raise delay
+        uint32_t drops = 0;
+        uint32_t raises = 0;
+    };
+
+    // Level and ceiling together; clears the timers and the raise back-off
+    void setPreset(size_t level);
+    size_t getLevel() const { return level; }
+    size_t getCeiling() const { return ceiling; }
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled; }
+    void setTargetMs(double ms) { targetMs = ms; }
+    double getTargetMs() const { return targetMs; }
+
+    // Once per frame; 'seconds' is the frame's length. Returns true when the level changed.
+    bool update(double cpuMs, double gpuMs, double seconds);
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    void resetTimers();
+
+    bool enabled = false;
+    double targetMs = 1000.0 / 60.0;
+    size_t level = 0;
+    size_t ceiling = 0;
+    bool hasSample = false;
+    double overSeconds = 0.0;
+    double underSeconds = 0.0;
+    double cooldown = 0.0;
+    double sinceRaise = BOUNCE_SECONDS; // Since the last rise, capped at BOUNCE_SECONDS
+    Stats stats;
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "RenderSnapshot.hpp"
+#include "RenderStats.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// World draw layers, back to front
+enum class RenderLayer : uint8_t {
+    Decorations,
+    Platforms,
+    Ladders,
+    Debug,       // Collision boxes, nav graph
+    Crowd,       // Enemies and NPCs
+    Player,
+    Foreground,  // In front of the actors
+};
+
+// One frame's world draws, ordered by a 32-bit key rather than by the order
+// they were added: the layer in the top byte, the texture (a per-frame id, in
+// first-seen order) in the next, a depth in the low 16 bits. Items are
+// triangle runs, copied in (a sprite becomes its six vertices), or one of the
+// RenderingSystem's passes. sort() radix-sorts the keys once, stably, so equal
+// keys keep their order; flush() records the items into a snapshot, where
+// neighbouring runs of one texture and category join into one draw
+// (RenderSnapshot::drawTriangles). Each item carries the split screen views
+// that see it and flush() runs once per view.
+class RenderQueue {
+public:
+    static constexpr uint8_t ALL_VIEWS = 0xFF;
+
+    struct Stats {
+        size_t items = 0;
+        size_t draws = 0; // After merging, for the first view flushed
+    };
+
+    static uint32_t makeKey(RenderLayer layer, uint8_t texture, uint16_t depth) {
+        return static_cast<uint32_t>(layer) << 24 | static_cast<uint32_t>(texture) << 16 | depth;
+    }
+
+    void clear();
+
+    void addTriangles(RenderLayer layer, uint16_t depth, const sf::Vertex* vertices, size_t vertexCount,
+                      const sf::Texture* texture, RenderCategory category, uint8_t views = ALL_VIEWS);
+    // The sprite's quad with its transform applied, as SpriteBatch builds it
+    void addSprite(RenderLayer layer, uint16_t depth, const sf::Sprite& sprite, RenderCategory category,
+                   uint8_t views = ALL_VIEWS);
+    // Drawn from the RenderingSystem's own state, in every view
+    void addPass(RenderLayer layer, uint16_t depth, RenderSnapshot::Pass pass);
+
+    void sort();
+    // Items seen by any of 'views', in key order; passes draw for view slot 'slot'
+    void flush(RenderSnapshot& snapshot, uint32_t slot, uint8_t views = ALL_VIEWS);
+
+    bool empty() const { return items.empty(); }
+    const Stats& getStats() const { return stats; }
+
+private:
+    enum class Kind : uint8_t { Triangles, Pass };
+
+    struct Item {
+        uint32_t key;
+        Kind kind;
+        RenderCategory category;
+        RenderSnapshot::Pass pass;
+        uint8_t views;
+        const sf::Texture* texture;
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+    };
+
+    uint8_t textureId(const sf::Texture* texture);
+
+    std::vector<Item> items;
+    std::vector<sf::Vertex> vertices;
+    std::vector<const sf::Texture*> textures; // Index + 1 is the id; 0 is untextured
+    std::vector<uint32_t> order;              // Item indices in key order after sort()
+    std::vector<uint32_t> sortScratch;
+    bool sorted = true;
+    bool flushedOnce = false;
+    Stats stats;
+};
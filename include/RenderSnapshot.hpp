@@ -0,0 +1,130 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "RenderStats.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// One frame of drawing, recorded on the game thread and replayed by
+// RenderingSystem::renderSnapshot, on the render thread when there is one.
+// Game objects (player, enemies, NPCs, UI text) are copied in as plain
+// drawables and vertices, so the replay never reads the live objects and the
+// next simulation step can run while this frame is drawn. What the
+// RenderingSystem owns itself (background layers, particles, the debug grid,
+// the decoration and platform tile caches) is recorded as a pass and drawn
+// from its own state, which the game thread only changes while no snapshot is
+// being rendered.
+//
+// Storage is kept across frames: reset() empties the snapshot without freeing,
+// and drawables are copy-assigned into the slots of earlier frames.
+class RenderSnapshot {
+public:
+    enum class Pass : uint8_t {
+        Background,
+        Particles,
+        DebugGrid,
+        Decorations,
+        Platforms,
+        Lighting,       // Multiplies the view's lightmap over what is drawn so far
+        PresentScene,   // End of the world; see RenderingSystem::setSceneResolution
+        CachedScene     // First, in place of the world: the one kept by an earlier snapshot
+    };
+
+    enum class Kind : uint8_t {
+        Clear,
+        View,
+        Pass,
+        Vertices,
+        Sprite,
+        Rectangle,
+        Circle,
+        Text
+    };
+
+    struct Command {
+        Kind kind;
+        RenderCategory category = RenderCategory::UI;
+        Pass pass = Pass::Background;
+        sf::PrimitiveType primitive = sf::PrimitiveType::Triangles;
+        uint32_t index = 0;  // Into the list for 'kind'; the first vertex for Vertices; the view slot for Pass
+        uint32_t count = 0;  // Vertices
+        bool mergeable = false; // Made by drawTriangles: nothing in 'states' but the texture
+        sf::RenderStates states;
+    };
+
+    void reset();
+
+    void clear(const sf::Color& color);
+    void setView(const sf::View& view);
+    // 'view' is the split screen slot the pass draws for (see RenderingSystem::renderBackgroundLayers)
+    void pass(Pass pass, uint32_t view = 0);
+
+    // Records commands [first, end) again, sharing their stored drawables and
+    // vertices: what one split screen view recorded, replayed for the next
+    size_t getCommandCount() const { return commands.size(); }
+    void repeat(size_t first, size_t end);
+
+    void draw(const sf::Sprite& sprite, RenderCategory category, const sf::RenderStates& states = sf::RenderStates::Default);
+    void draw(const sf::RectangleShape& shape, RenderCategory category,
+              const sf::RenderStates& states = sf::RenderStates::Default);
+    void draw(const sf::CircleShape& shape, RenderCategory category, const sf::RenderStates& states = sf::RenderStates::Default);
+    // The copy's glyphs are laid out here, so the replay never loads any
+    void draw(const sf::Text& text, RenderCategory category, const sf::RenderStates& states = sf::RenderStates::Default);
+    void draw(const sf::VertexArray& vertices, RenderCategory category,
+              const sf::RenderStates& states = sf::RenderStates::Default);
+    void draw(const sf::Vertex* vertices, size_t vertexCount, sf::PrimitiveType type, RenderCategory category,
+              const sf::RenderStates& states = sf::RenderStates::Default);
+    // Triangles moved by 'offset'; joins the previous command when it is a plain
+    // triangle list of the same texture and category, so runs become one draw
+    void drawTriangles(const sf::Vertex* vertices, size_t vertexCount, const sf::Texture* texture,
+                       RenderCategory category, const sf::Vector2f& offset = sf::Vector2f());
+
+    // While the world is paused: keepScene() has this frame's world rendered
+    // into a texture that outlives the frame, and later snapshots record the
+    // CachedScene pass instead of the world to show it again
+    void keepScene() { sceneKept = true; }
+    bool isSceneKept() const { return sceneKept; }
+
+    // Objects skipped by culling while recording, added to the render stats on replay
+    void countCulled(RenderCategory category, size_t count = 1);
+
+    const std::vector<Command>& getCommands() const { return commands; }
+    const sf::Color& getClearColor() const { return clearColor; }
+    const sf::View& getView(uint32_t index) const { return views[index]; }
+    const sf::Vertex* getVertices(uint32_t first) const { return vertices.data() + first; }
+    const sf::Sprite& getSprite(uint32_t index) const { return sprites[index]; }
+    const sf::RectangleShape& getRectangle(uint32_t index) const { return rectangles[index]; }
+    const sf::CircleShape& getCircle(uint32_t index) const { return circles[index]; }
+    const sf::Text& getText(uint32_t index) const { return texts[index]; }
+    size_t getCulled(RenderCategory category) const { return culled[static_cast<size_t>(category)]; }
+    size_t getVertexCount() const { return vertices.size(); }
+
+private:
+    // Copy-assigns into a slot left by an earlier frame when there is one
+    template <typename T>
+    static uint32_t store(std::vector<T>& slots, size_t& used, const T& item) {
+        if (used < slots.size()) {
+            slots[used] = item;
+        } else {
+            slots.push_back(item);
+        }
+        return static_cast<uint32_t>(used++);
+    }
+    void add(Kind kind, uint32_t index, RenderCategory category, const sf::RenderStates& states);
+
+    std::vector<Command> commands;
+    std::vector<sf::Vertex> vertices;
+    sf::Color clearColor = sf::Color::Black;
+    std::vector<sf::View> views;
+    std::vector<sf::Sprite> sprites;
+    std::vector<sf::RectangleShape> rectangles;
+    std::vector<sf::CircleShape> circles;
+    std::vector<sf::Text> texts;
+    size_t viewCount = 0;
+    size_t spriteCount = 0;
+    size_t rectangleCount = 0;
+    size_t circleCount = 0;
+    size_t textCount = 0;
+    bool sceneKept = false;
+    std::array<size_t, RenderStats::CATEGORY_COUNT> culled{};
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// What a draw was for; each gets its own row in the render stats
+enum class RenderCategory : uint8_t {
+    Background,
+    Decorations,
+    Platforms,
+    Ladders,
+    Enemies,
+    Player,
+    NPCs,
+    Particles,
+    Lighting,
+    Debug,
+    MiniMap,
+    UI,
+    Count
+};
+
+const char* getRenderCategoryName(RenderCategory category);
+
+// Counting draw submission. Every draw goes through draw() (via
+// RenderingSystem::submit), which issues it and counts draw calls, vertices,
+// texture changes and, via countCulled(), objects skipped by culling.
+// Vertex counts follow what SFML hands the GPU for each drawable type.
+// ImGui renders through its own backend and is not included.
+class RenderStats {
+public:
+    struct Counters {
+        size_t drawCalls = 0;
+        size_t vertices = 0;
+        size_t textureChanges = 0;
+        size_t culled = 0;
+
+        Counters& operator+=(const Counters& other);
+    };
+
+    static constexpr size_t CATEGORY_COUNT = static_cast<size_t>(RenderCategory::Count);
+    static constexpr size_t FRAME_HISTORY = 120;
+
+    struct Frame {
+        std::array<Counters, CATEGORY_COUNT> categories;
+
+        const Counters& operator[](RenderCategory category) const { return categories[static_cast<size_t>(category)]; }
+        Counters getTotal() const;
+    };
+
+    void draw(sf::RenderTarget& target, const sf::Shape& shape, RenderCategory category,
+              const sf::RenderStates& states = sf::RenderStates::Default);
+    void draw(sf::RenderTarget& target, const sf::Sprite& sprite, RenderCategory category,
+              const sf::RenderStates& states = sf::RenderStates::Default);
+    void draw(sf::RenderTarget& target, const sf::Text& text, RenderCategory category,
+              const sf::RenderStates& states = sf::RenderStates::Default);
+    void draw(sf::RenderTarget& target, const sf::VertexArray& vertices, RenderCategory category,
+              const sf::RenderStates& states = sf::RenderStates::Default);
+    void draw(sf::RenderTarget& target, const sf::VertexBuffer& buffer, RenderCategory category,
+              const sf::RenderStates& states = sf::RenderStates::Default);
+    void draw(sf::RenderTarget& target, const sf::Vertex* vertices, size_t vertexCount, sf::PrimitiveType type,
+              RenderCategory category, const sf::RenderStates& states = sf::RenderStates::Default);
+
+    void countCulled(RenderCategory category, size_t count = 1);
+
+    // Call once per frame; the finished frame goes into the history
+    void endFrame();
+
+    const Frame& getFrameInProgress() const { return current; }
+    size_t getFrameCount() const { return historyCount; }  // Up to FRAME_HISTORY
+    const Frame& getFrame(size_t age) const;                // 0 = last finished frame
+
+private:
+    void record(RenderCategory category, size_t drawCalls, size_t vertices, const sf::Texture* texture);
+
+    Frame current;
+    const sf::Texture* boundTexture = nullptr; // Last texture drawn with this frame
+    std::array<Frame, FRAME_HISTORY> history;
+    size_t historyNext = 0;
+    size_t historyCount = 0;
+};
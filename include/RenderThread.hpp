@@ -0,0 +1,79 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "RenderSnapshot.hpp"
+#include "imgui.h"
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Optional render thread. The game thread records each frame into a Frame and
+// submits it; the render thread owns the window's GL context and replays the
+// frame (snapshot, then the ImGui draw lists) while the game thread moves on
+// to the next simulation step. Two frames alternate, so the one being recorded
+// is never the one being drawn.
+//
+// The render thread also reads state the RenderingSystem, fonts and textures
+// own. The game thread must call waitIdle() before changing any of it (asset
+// uploads and hot reloads, level loads, ImGui widgets, the particle update);
+// submit() waits too. When the thread is not running, submit() renders on the
+// calling thread, so both modes share one path.
+class RenderThread {
+public:
+    struct Frame {
+        RenderSnapshot snapshot;
+        ImDrawData imguiDrawData;  // Points into imguiLists
+
+        // Deep-copies ImGui's output (ImGui reuses its lists on the next NewFrame)
+        void copyImGui(const ImDrawData* source);
+
+    private:
+        std::vector<std::unique_ptr<ImDrawList>> imguiLists; // Capacity kept across frames
+    };
+
+    using Presenter = std::function<void(Frame&)>;
+
+    struct Stats {
+        uint64_t frames = 0;     // Rendered on the thread since it started
+        double renderMs = 0.0;   // Last frame, including the present
+        double waitMs = 0.0;     // Game thread blocked in waitIdle/submit over the last frame
+    };
+
+    explicit RenderThread(Presenter presenter);
+    ~RenderThread(); // Stops the thread
+
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // Hands the window's GL context to a new thread; false if it can't be released
+    bool start(sf::RenderWindow& window);
+    // Finishes the frame in flight and gives the context back to the calling thread
+    void stop();
+    bool isRunning() const { return worker.joinable(); }
+
+    // The frame to record into
+    Frame& beginFrame() { return frames[writeIndex]; }
+    void submit();
+    void waitIdle();
+
+    // Read after waitIdle(); resets the wait total for the next frame
+    Stats takeStats();
+
+private:
+    void run();
+
+    Presenter presenter;
+    Frame frames[2];
+    size_t writeIndex = 0;
+    sf::RenderWindow* window = nullptr;
+    std::thread worker;
+
+    std::mutex mutex;
+    std::condition_variable wake;  // Frame submitted, or stopping
+    std::condition_variable idle;  // Frame finished
+    Frame* pending = nullptr;      // Submitted and not yet presented
+    bool stopping = false;
+    Stats stats;
+};
@@ -1,14 +1,33 @@
 #pragma once
 #include <SFML/Graphics.hpp>
+#include <array>
+#include <atomic>
 #include <vector>
 #include <memory>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <random>
+#include "AssetManager.hpp"
+#include "AsyncLogger.hpp"
+#include "TextureAtlas.hpp"
+#include "SpriteBatch.hpp"
+#include "CrowdRenderer.hpp"
+#include "ParticleSystem.hpp"
+#include "RenderStats.hpp"
+#include "GpuTimer.hpp"
+#include "RenderSnapshot.hpp"
+#include "RenderQueue.hpp"
+#include "DebugDraw.hpp"
+#include "LevelGeometry.hpp"
+#include "LevelLoader.hpp"
+#include "PointGrid.hpp"
+#include "TiledBackground.hpp"
+#include "ViewCulling.hpp"
 
 // Forward declarations
 class Player;
-class Enemy;
+class EnemyStore;
 class PhysicsSystem;
 
 
@@ -19,7 +38,11 @@ struct BackgroundLayer {
     bool tileVertically;
     bool isLoaded = false;
     std::unique_ptr<sf::Sprite> sprite;
+    AssetManager::TextureRef texture; // Keeps the sprite's texture resident
     sf::Vector2u textureSize;
+    // Set instead of the sprite for a layer streamed in tiles; textureSize is
+    // then the whole image's. Shared with the renderer's copy of the layer.
+    std::shared_ptr<TiledBackground> tiled;
     
     BackgroundLayer(const std::string& layerName, float speed, bool tileH, bool tileV)
         : name(layerName), parallaxSpeed(speed), tileHorizontally(tileH), tileVertically(tileV) {}
@@ -28,7 +51,8 @@ struct BackgroundLayer {
     BackgroundLayer(BackgroundLayer&& other) noexcept
         : name(std::move(other.name)), parallaxSpeed(other.parallaxSpeed),
           tileHorizontally(other.tileHorizontally), tileVertically(other.tileVertically),
-          isLoaded(other.isLoaded), sprite(std::move(other.sprite)), textureSize(other.textureSize) {}
+          isLoaded(other.isLoaded), sprite(std::move(other.sprite)), texture(std::move(other.texture)),
+          textureSize(other.textureSize), tiled(std::move(other.tiled)) {}
     
     // Move assignment operator
     BackgroundLayer& operator=(BackgroundLayer&& other) noexcept {
@@ -39,7 +63,9 @@ struct BackgroundLayer {
             tileVertically = other.tileVertically;
             isLoaded = other.isLoaded;
             sprite = std::move(other.sprite);
+            texture = std::move(other.texture);
             textureSize = other.textureSize;
+            tiled = std::move(other.tiled);
         }
         return *this;
     }
@@ -65,22 +91,90 @@ public:
     
     // Main rendering method
     void renderFrame();
+    // Replays a frame recorded on the game thread; its passes draw from this
+    // system's own state (see RenderSnapshot)
+    void renderSnapshot(sf::RenderWindow& window, const RenderSnapshot& snapshot);
     
     // Background rendering
     void renderBackground();
-    void renderBackgroundLayers();
+    // 'view' is the split screen slot: views share the layer cache and baked
+    // layers (they are the same size) but each keeps its own composite
+    void renderBackgroundLayers(size_t view = 0);
     void setBackgroundLayers(std::vector<BackgroundLayer>&& layers);
     void setBackgroundLayersRef(const std::vector<BackgroundLayer>& layers);
+    void invalidateBackgroundCache() { backgroundCacheDirty = true; }
+    // Redraws the still-camera composites only, e.g. when a tiled layer's tiles arrive
+    void invalidateBackgroundComposites();
+    // Parallax layers drawn, 0 = all. Fewer keep the backmost layer and the
+    // front ones and skip those in between, so the sky still fills the view.
+    void setBackgroundLayerLimit(size_t limit);
+    size_t getBackgroundLayerLimit() const { return backgroundLayerLimit; }
+    size_t getLastBackgroundDrawCalls() const { return lastBackgroundDrawCalls; }
+    
+    // Shader effects. With shaders each scrolling layer is one view-wide quad whose
+    // parallax offset and wrap are applied per pixel; without them layers rely on
+    // texture repeat. Either way a layer costs one draw. Also lets particle
+    // emitters run on the GPU.
+    void setUseShaders(bool use);
+    bool getUseShaders() const { return useShaders; }
+    bool areShadersActive() const { return useShaders && shadersAvailable; }
+    bool areShadersAvailable() const { return shadersAvailable; } // Known after the first background draw
+    
+    // Animated tiles. A tile file named <name>@<frames>x<fps>.png is a strip of
+    // that many frames side by side, loaded as the tile <name>.png. With shaders
+    // the tile caches bake an animated quad once, with its first frame and its
+    // frame count, rate and width packed into the vertex colour, and a vertex
+    // shader picks the frame from a time uniform: no CPU work per tile or frame.
+    // Without shaders animated tiles show their first frame.
+    size_t getAnimatedTileCount() const;
+    bool areTilesAnimated() const { return areShadersActive() && tileShaderReady; }
+    
+    // Colour grading, applied in the one full-screen pass that presents the
+    // world (the scene target is used even at native resolution while it's on).
+    // 'lut' is a 3D lookup table unwrapped into N slices of N x N side by side
+    // (N*N x N pixels, blue picks the slice), or null; 'tint' multiplies the
+    // graded colour and fades in and out once per 'dayLength' seconds (full at
+    // half the cycle; 0 keeps it on). 'lut' must outlive its use. Needs shaders.
+    void setColorGrade(const sf::Texture* lut, const sf::Color& tint, float dayLength);
+    bool isColorGradeActive() const;
+    
+    // Dynamic lights (LevelData::Light). The Lighting pass clears a lightmap of
+    // a quarter of the view's pixels to the ambient colour, adds the lights
+    // reaching the view (found through a grid) as one batch of additive quads,
+    // then multiplies it over the world drawn so far in a single draw. At most
+    // MAX_LIGHTS are drawn a frame over all views, the nearest to each view's
+    // centre first. A white ambient turns lighting off; Game then records no pass.
+    static constexpr size_t MAX_LIGHTS = 64;
+    static constexpr unsigned LIGHTMAP_DIVISOR = 4;
+    struct LightStats {
+        size_t drawn = 0;
+        size_t culled = 0;     // Out of every view
+        size_t overBudget = 0; // Visible, but past MAX_LIGHTS
+    };
+    void setLights(const std::vector<LevelData::Light>& lights, const sf::Color& ambient);
+    bool isLightingEnabled() const { return ambientLight != sf::Color::White; }
+    size_t getLightCount() const { return lights.size(); }
+    // Stats add up over a frame's views from the first, like renderPlatformCache's
+    void renderLighting(sf::RenderTarget& target, bool firstView = true);
+    const LightStats& getLightStats() const { return lightStats; }
+    
+    // Weather particles; Game updates them, renderParticles draws them over the background
+    ParticleSystem& getParticles() { return particles; }
+    const ParticleSystem& getParticles() const { return particles; }
+    void renderParticles();
     
     // Game object rendering
-    void renderPlatforms(const std::vector<sf::RectangleShape>& platforms);
-
     void renderPlayer(const Player& player);
-    void renderEnemies(const std::vector<Enemy>& enemies);
+    void renderEnemies(const EnemyStore& enemies);
     
     // Debug rendering
     void renderDebugGrid();
     void renderDebugBoxes();
+    // Debug lines, boxes and circles recorded here are drawn in one call by flushDebugDraw
+    DebugDraw& getDebugDraw() { return debugDraw; }
+    void flushDebugDraw(sf::RenderTarget& target) { debugDraw.flush(target, renderStats); }
+    void flushDebugDraw(RenderSnapshot& snapshot) { debugDraw.flush(snapshot); }
+    void flushDebugDraw(RenderQueue& queue) { debugDraw.flush(queue, RenderLayer::Debug); }
     
     // UI rendering
     void renderUI();
@@ -92,6 +186,10 @@ public:
     // Logging controls
     void setLoggingEnabled(bool enabled) { loggingEnabled = enabled; }
     bool isLoggingEnabled() const { return loggingEnabled; }
+    // Debug lines from the per-frame draw passes; off by default because
+    // formatting them allocates every frame and floods the log
+    void setFrameLoggingEnabled(bool enabled) { frameLoggingEnabled = enabled; }
+    bool isFrameLoggingEnabled() const { return frameLoggingEnabled; }
     void clearLogFile();
     
     // Settings
@@ -130,52 +228,208 @@ public:
     
     // Tile rendering functionality (moved from TileRenderer)
     bool loadTiles(const std::string& tilesDirectory);
-    void renderGround(sf::RenderWindow& window, const sf::RectangleShape& platform, bool randomize);
-    void renderPlat(sf::RenderWindow& window, const sf::RectangleShape& platform, bool randomize = true);
-    void renderPlatforms(sf::RenderWindow& window, const std::vector<sf::RectangleShape>& platforms, bool randomize);
+    // The same in two halves, so the PNG decode can run with other startup work:
+    // the sorted tile files of a directory (false, logged, if there are none),
+    // decoded on any thread with TextureAtlas::loadImage, then packed and
+    // uploaded here. Images that failed to decode are left empty and skipped.
+    static bool listTileFiles(const std::string& tilesDirectory, std::vector<std::string>& tileFiles);
+    bool loadTiles(const std::string& tilesDirectory, const std::vector<std::string>& tileFiles,
+                   std::vector<sf::Image>& images);
+    // Hot reload of one file: a tile of the loaded set is patched into its atlas
+    // page when its size is unchanged (cached chunks stay valid), otherwise the
+    // set is repacked. False if 'path' is not in the tiles directory.
+    bool reloadTile(const std::string& path);
+    void renderGround(sf::RenderWindow& window, const LevelGeometry& platforms, size_t platform, bool randomize);
+    void renderPlat(sf::RenderWindow& window, const LevelGeometry& platforms, size_t platform, bool randomize = true);
+    void renderPlatforms(sf::RenderWindow& window, const LevelGeometry& platforms, bool randomize);
     void renderTileGrid(sf::RenderWindow& window, const sf::Vector2f& position, const sf::Vector2f& size);
     
+    // Static platform tile cache. Tile quads are baked once into vertex arrays per
+    // 512px-wide chunk; each visible chunk then costs one draw per atlas page.
+    // renderPlatforms rebuilds it lazily when platforms or tile settings change.
+    // Split for snapshots: preparePlatforms rebuilds on the game thread, and the
+    // Platforms pass only draws (renderPlatformCache).
+    void preparePlatforms(const LevelGeometry& platforms, bool randomize = true);
+    // Culls chunks against the target's view; the stats add up over a frame's views from the first
+    void renderPlatformCache(sf::RenderTarget& target, bool firstView = true);
+    void buildPlatformCache(const LevelGeometry& platforms, bool randomize = true);
+    void updatePlatformCache(const LevelGeometry& platforms, const std::vector<size_t>& changedPlatforms);
+    void invalidatePlatformCache() { platformCacheDirty = true; }
+    size_t getPlatformChunkCount() const { return platformChunks.size(); }
+    size_t getLastPlatformDrawCalls() const { return lastPlatformDrawCalls; }
+    const ViewCulling::CullStats& getPlatformCullStats() const { return platformCullStats; }
+    
+    // Static level decorations (LevelData::decorationQuads), baked once per level
+    // into a vertex array per 512px chunk in the quads' back-to-front order, so a
+    // visible chunk is one draw (one per atlas page it uses). A quad takes the
+    // tile deco_<kind>_<part>.png, else deco_<kind>.png, from the tile set, and
+    // a flat colour per kind when there is neither.
+    void buildDecorationCache(const std::vector<LevelData::DecorationQuad>& quads);
+    // The editor moved decorations inside 'area' (old and new footprint): rebakes
+    // just the chunks there, or everything if the quads outgrew the chunked range
+    void updateDecorationCache(const std::vector<LevelData::DecorationQuad>& quads, const sf::FloatRect& area);
+    // A built cache, parked (by LevelCache) while its level isn't the current one.
+    // take leaves this one empty; restore puts one back, to be rebuilt by the
+    // next prepareDecorations if the tile set changed in between.
+    struct DecorationCache;
+    std::shared_ptr<DecorationCache> takeDecorationCache();
+    void restoreDecorationCache(std::shared_ptr<DecorationCache> cache);
+    void prepareDecorations(); // Rebuilds after the tile set changed; game thread
+    void renderDecorationCache(sf::RenderTarget& target, bool firstView = true);
+    size_t getDecorationQuadCount() const { return decorationQuads.size(); }
+    size_t getDecorationChunkCount() const { return decorationChunks.size(); }
+    const ViewCulling::CullStats& getDecorationCullStats() const { return decorationCullStats; }
+    
     // General rendering utilities
     void renderBackground(sf::RenderWindow& window, const sf::Sprite& background);
-    void renderEntity(sf::RenderWindow& window, const sf::Sprite& sprite, const sf::Vector2f& position);
-    void renderShape(sf::RenderWindow& window, const sf::Shape& shape);
+    void renderEntity(sf::RenderWindow& window, const sf::Sprite& sprite, const sf::Vector2f& position, RenderCategory category);
+    void renderShape(sf::RenderWindow& window, const sf::Shape& shape, RenderCategory category);
     
     // Tile settings
-    void setTileSize(int size) { tileSize = size; }
+    void setTileSize(int size) { tileSize = size; platformCacheDirty = true; }
     void setRandomSeed(unsigned int seed) { randomEngine.seed(seed); }
-    void setRandomizationEnabled(bool enabled) { randomizationEnabled = enabled; }
-    void setTileScale(float scale) { tileScale = scale; }
+    void setRandomizationEnabled(bool enabled) { randomizationEnabled = enabled; platformCacheDirty = true; }
+    void setTileScale(float scale) { tileScale = scale; platformCacheDirty = true; }
     
     // Getters
     int getTileSize() const { return tileSize; }
     bool isRandomizationEnabled() const { return randomizationEnabled; }
     float getTileScale() const { return tileScale; }
-    int getTileCount() const { return tileTextures.size(); }
-    bool isLoaded() const { return !tileTextures.empty(); }
+    int getTileCount() const { return tileSprites.size(); }
+    bool isLoaded() const { return !tileSprites.empty(); }
+    size_t getTileAtlasPageCount() const { return tileAtlas.getPageCount(); }
+    size_t getTileAtlasBytes() const { return tileAtlas.getResidentBytes(); }
+    // The render textures (background caches, scene target) as of the last
+    // endFrame, at 4 bytes a pixel; safe from any thread
+    size_t getRenderTargetBytes() const { return renderTargetBytes.load(std::memory_order_relaxed); }
     
     // Rendering state management
-    void setRenderTarget(sf::RenderWindow* window) { renderTarget = window; }
-    sf::RenderWindow* getRenderTarget() const { return renderTarget; }
+    void setRenderTarget(sf::RenderTarget* target) { renderTarget = target; }
+    sf::RenderTarget* getRenderTarget() const { return renderTarget; }
+    
+    // Render scale. With a scene resolution set, renderSnapshot draws what comes
+    // before the PresentScene pass (the world) into a render texture of that
+    // size and scales it up to the window by a whole factor, nearest filtered
+    // and centred on black; the rest (UI view, ImGui) draws at window
+    // resolution. World fill rate then no longer grows with the display.
+    // 0x0 draws everything straight to the window, except for a snapshot that
+    // keeps its world (RenderSnapshot::keepScene), rendered at window size.
+    void setSceneResolution(const sf::Vector2u& size) { sceneResolution = size; }
+    const sf::Vector2u& getSceneResolution() const { return sceneResolution; }
+    float getSceneUpscale() const { return lastSceneUpscale; } // Of the last frame; 0 when native
+    
+    // Draw submission: every draw in the game goes through here (or through
+    // getRenderStats() where only the stats are at hand) so it gets counted
+    template <typename Drawable>
+    void submit(sf::RenderTarget& target, const Drawable& drawable, RenderCategory category,
+                const sf::RenderStates& states = sf::RenderStates::Default) {
+        renderStats.draw(target, drawable, category, states);
+    }
+    void submit(sf::RenderTarget& target, const sf::Vertex* vertices, size_t vertexCount, sf::PrimitiveType type,
+                RenderCategory category, const sf::RenderStates& states = sf::RenderStates::Default) {
+        renderStats.draw(target, vertices, vertexCount, type, category, states);
+    }
+    RenderStats& getRenderStats() { return renderStats; }
+    const RenderStats& getRenderStats() const { return renderStats; }
     
-    // Batch rendering for performance
-    void beginBatch();
+    // Batch rendering for performance: sprites added between begin/end are drawn
+    // with one call per (layer, texture) when the batch ends
+    void beginBatch(RenderCategory category);
     void endBatch();
-    void addToBatch(const sf::Sprite& sprite, const sf::Vector2f& position);
+    void addToBatch(const sf::Sprite& sprite, const sf::Vector2f& position, int layer = 0);
+    void addToBatch(const sf::Vertex* triangles, size_t vertexCount, const sf::Texture& texture,
+                    const sf::Vector2f& offset, int layer = 0);
+    bool isBatching() const { return batchMode; }
+    
+    // Enemies and NPCs: one draw per atlas page for the whole crowd
+    CrowdRenderer& getCrowdRenderer() { return crowdRenderer; }
+    
+    // Call once per frame; the batch, crowd and render stats then report the finished frame
+    void endFrame() {
+        spriteBatch.endFrame(); crowdRenderer.endFrame(); renderStats.endFrame();
+        renderTargetBytes.store(measureRenderTargets(), std::memory_order_relaxed);
+    }
+    const SpriteBatch::Stats& getBatchStats() const { return spriteBatch.getLastFrameStats(); }
+    const CrowdRenderer::Stats& getCrowdStats() const { return crowdRenderer.getLastFrameStats(); }
+    // GPU time per pass; renderSnapshot charges its commands to it, the caller
+    // brackets the frame (beginFrame/endFrame) and times what it draws after
+    GpuTimer& getGpuTimer() { return gpuTimer; }
+    const GpuTimer& getGpuTimer() const { return gpuTimer; }
 
 
     
 private:
     
     // Logging system
-    std::ofstream logFile;
+    AsyncLogger::SinkId logSink = 0;
     bool loggingEnabled = true;
-    std::string logFileName = "rendering.log";
+    bool frameLoggingEnabled = false;
+    std::string logFileName = GAME_BINARY_LOG ? "rendering.blog" : "rendering.log";
     
     // Background system
     std::vector<BackgroundLayer> backgroundLayers;
+    
+    // Background cache, rebuilt when the layers or the view size change.
+    // Leading screen-fixed layers are baked into staticBackground; every other layer
+    // is one quad using texture repeat. While a view's camera is still, the whole
+    // stack is reused from that view's composite.
+    struct BackgroundLayerCache {
+        float scale = 0.0f;
+        sf::Vector2f scaledSize;
+        bool alignToGround = false; // background4 follows the ground platforms
+        bool screenFixed = false;
+    };
+    std::vector<BackgroundLayerCache> backgroundCache;
+    size_t staticLayerCount = 0;
+    std::unique_ptr<sf::RenderTexture> staticBackground;
+    struct BackgroundComposite {
+        std::unique_ptr<sf::RenderTexture> texture; // Made the first time this view's camera settles
+        bool unavailable = false;                   // Render textures failed; drawn directly
+        sf::Vector2f viewCenter;                    // Of what 'texture' holds
+        sf::Vector2f lastViewCenter;                // The view's previous frame
+        bool valid = false;
+    };
+    std::array<BackgroundComposite, ViewCulling::ViewSet::MAX_VIEWS> backgroundComposites;
+    sf::Vector2f cachedBackgroundViewSize;
+    bool backgroundCacheDirty = true;
+    size_t backgroundLayerLimit = 0;
+    bool isBackgroundLayerDrawn(size_t index) const;
+    size_t lastBackgroundDrawCalls = 0;
     bool useBackgroundPlaceholder = true;
     sf::RectangleShape backgroundPlaceholder;
     
+    // Shader effects, set up on the first draw when a GL context is current
+    sf::Shader parallaxShader;
+    sf::Shader tileShader;     // Animated tile frames
+    sf::Shader gradeShader;    // Colour grading at present
+    bool tileShaderReady = false;
+    bool gradeShaderReady = false;
+    sf::Clock effectsClock;    // Time uniform of the tile and grade shaders
+    bool effectsInitialized = false;
+    bool shadersAvailable = false;
+    bool useShaders = true;
+    ParticleSystem particles;
+    
+    // Colour grading (setColorGrade)
+    const sf::Texture* gradeLut = nullptr;
+    float gradeLutSize = 0.f; // Slices, 0 without a usable LUT
+    sf::Color gradeTint = sf::Color::White;
+    float gradeDayLength = 0.f;
+    static constexpr float EFFECTS_TIME_WRAP = 3600.f; // Shader time restarts after this many seconds
+    
+    // Lighting (setLights); the lightmap is shared by the views, each filling it in turn
+    std::vector<LevelData::Light> lights;
+    PointGrid lightGrid;           // Light indices at their centres
+    float maxLightRadius = 0.f;    // How far past the view a light centre can reach it from
+    sf::Color ambientLight = sf::Color::White;
+    std::unique_ptr<sf::RenderTexture> lightmap;
+    sf::Texture lightFalloff;      // White at the centre, fading out to the edge of the quad
+    bool lightingUnavailable = false; // Render textures failed; the world stays unlit
+    std::vector<uint32_t> visibleLights;
+    std::vector<sf::Vertex> lightVertices;
+    LightStats lightStats;
+    bool ensureLightmap(const sf::Vector2u& size);
+    
     // Sprite management
     std::unique_ptr<sf::Sprite> playerSprite;
     std::unique_ptr<sf::Sprite> enemySprite;
@@ -199,9 +453,83 @@ private:
     sf::Color gridAxesColor = sf::Color(255, 255, 255, 96);
     
     // Tile management (from TileRenderer)
-    std::vector<std::unique_ptr<sf::Texture>> tileTextures;
+    TextureAtlas tileAtlas;          // All tile images packed into a few pages
+    std::vector<int> tileRegions;    // Atlas region per tile index
     std::vector<std::unique_ptr<sf::Sprite>> tileSprites;
     std::vector<std::string> tileFilenames; // Store filenames of loaded tiles
+    // Frames of each tile (parallel to tileRegions); a strip of 'frames' across its region
+    struct TileAnimation {
+        uint8_t frames = 1;
+        uint8_t fps = 0;
+    };
+    std::vector<TileAnimation> tileAnimations;
+    std::string loadedTilesDirectory;       // Of the current set, for reloadTile
+    
+    // Indices of the named tiles, resolved once per loadTiles
+    int leftTileIndex = 0;
+    int rightTileIndex = 0;
+    int middleTileIndex = 0;
+    int blackTileIndex = 0;
+    std::vector<int> snowTileIndices;
+    
+    // Platform tile cache
+    struct TileQuad {
+        int tileIndex;
+        sf::Vector2f position;
+    };
+    
+    struct TileBatch {
+        size_t page; // Atlas page texture
+        sf::VertexArray vertices;
+        bool animated = false; // Drawn with tileShader; vertex colours hold the animation
+    };
+    
+    struct TileChunk {
+        std::vector<size_t> platforms; // Platforms whose tiles may land in this chunk
+        std::vector<TileBatch> batches; // One vertex array per atlas page (usually one)
+        sf::FloatRect bounds;
+    };
+    
+    // Autotiled cells: each platform's final tile indices, row-major from its
+    // top-left cell, computed once per build (autotilePlatform), not per draw
+    struct PlatformCells {
+        size_t first = 0; // Into cellTiles
+        int columns = 0;
+        int rows = 0;
+        bool alignRight = false; // Last column flush with the platform's right side
+    };
+    
+    std::vector<TileChunk> platformChunks;
+    std::vector<sf::FloatRect> cachedPlatformBounds;
+    std::vector<PlatformCells> platformCells; // Parallel to cachedPlatformBounds
+    std::vector<int> cellTiles;
+    std::vector<int> cellTileScratch;         // The uncached path's cells
+    std::vector<TileQuad> tileQuadScratch;
+    std::vector<sf::Vertex> platformVertexScratch; // Untextured fallback quads
+    float platformChunkOrigin = 0.0f;
+    bool cachedRandomize = true;
+    bool platformsAnimated = false;   // The platform cache was baked for tileShader
+    bool platformCacheDirty = true;
+    size_t lastPlatformDrawCalls = 0;
+    ViewCulling::CullStats platformCullStats;
+    static constexpr float PLATFORM_CHUNK_WIDTH = 512.0f;
+    
+    // Decoration cache
+    struct DecorationChunk {
+        std::vector<TileBatch> batches; // Textured quads, one vertex array per atlas page
+        sf::VertexArray untextured = sf::VertexArray(sf::PrimitiveType::Triangles);
+        sf::FloatRect bounds;
+    };
+    
+    std::vector<LevelData::DecorationQuad> decorationQuads;
+    std::vector<DecorationChunk> decorationChunks;
+    float decorationChunkOrigin = 0.0f;
+    bool decorationCacheDirty = false;
+    bool decorationsAnimated = false;
+    uint32_t tileSetVersion = 0; // Bumped when the tiles reload, so parked caches know they are stale
+    ViewCulling::CullStats decorationCullStats;
+    // Tile per decoration kind and part, -1 for a flat colour; resolved with the special tiles
+    std::array<std::array<int, 4>, 4> decorationTiles{};
     
     // Tile settings
     int tileSize = 16;
@@ -213,40 +541,80 @@ private:
     std::uniform_int_distribution<int> tileDistribution;
     
     // Rendering state
-    sf::RenderWindow* renderTarget = nullptr;
+    sf::RenderTarget* renderTarget = nullptr;
+    
+    // Render scale (render thread, but for the requested resolution)
+    sf::Vector2u sceneResolution;
+    std::unique_ptr<sf::RenderTexture> sceneTarget;
+    std::atomic<size_t> renderTargetBytes{0};
+    size_t measureRenderTargets() const;
+    float lastSceneUpscale = 0.f;
+    sf::RenderTarget& beginScene(sf::RenderWindow& window, const RenderSnapshot& snapshot);
+    void presentScene(sf::RenderWindow& window, bool rendered); // 'rendered': drawn this frame
     
     // Batch rendering
-    std::vector<std::pair<sf::Sprite, sf::Vector2f>> spriteBatch;
+    SpriteBatch spriteBatch;
+    CrowdRenderer crowdRenderer;
     bool batchMode = false;
+    RenderCategory batchCategory = RenderCategory::Enemies;
+    
+    RenderStats renderStats;
+    GpuTimer gpuTimer;
+    DebugDraw debugDraw;
     
     // Constants for background rendering (moved from Game class)
     static constexpr int WINDOW_WIDTH = 800;
     static constexpr int WINDOW_HEIGHT = 600;
     static constexpr float GROUND_HEIGHT = 100.f;
+    static constexpr float CULL_MARGIN = 32.f; // Slack for sprites drawn past their bounds
     
     // Helper methods
     void renderSpriteWithDirection(const sf::Sprite& sprite, const sf::Vector2f& position, bool facingLeft = false);
     void renderPlaceholderWithDirection(const sf::RectangleShape& placeholder, const sf::Vector2f& position, bool facingLeft = false);
     
     // Logging helper methods
-    void logDebug(const std::string& message);
-    void logInfo(const std::string& message);
-    void logWarning(const std::string& message);
-    void logError(const std::string& message);
-    std::string getCurrentTimestamp();
+    void logDebug(std::string_view message);
+    void logInfo(std::string_view message);
+    void logWarning(std::string_view message);
+    void logError(std::string_view message);
     
     // Helper methods (from TileRenderer)
     int getRandomTileIndex();
     void updateTileDistribution();
     sf::Sprite& getTileSprite(int index);
-    
-    // Tile positioning
-    struct TilePosition {
-        int x, y;
-        int tileIndex;
-    };
-    
-    std::vector<TilePosition> generateTileLayout(const sf::Vector2f& platformPos, 
-                                                const sf::Vector2f& platformSize, 
-                                                bool randomize);
+    void resolveSpecialTiles();
+    
+    // Background cache helpers
+    void rebuildBackgroundCache(const sf::Vector2f& viewSize);
+    bool ensureBackgroundComposite(BackgroundComposite& composite); // False if render textures fail
+    void drawBackgroundStack(sf::RenderTarget& target, const sf::View& view);
+    void drawBackgroundLayer(sf::RenderTarget& target, size_t index, const sf::View& view);
+    void drawTiledBackgroundLayer(sf::RenderTarget& target, size_t index, const sf::View& view);
+    void drawCachedTexture(sf::RenderTarget& target, const sf::RenderTexture& cache,
+                           const sf::Vector2f& position, const sf::Vector2f& size);
+    void initializeEffects();
+    
+    // The batch of 'batches' a tile's quads go in, and the texture rectangle
+    // (its first frame) and vertex colour to give them
+    TileBatch& getTileBatch(std::vector<TileBatch>& batches, int tile, bool animate, sf::FloatRect& texture,
+                            sf::Color& color) const;
+    void drawTileBatch(sf::RenderTarget& target, const TileBatch& batch, RenderCategory category);
+    
+    // Submit the tiles in tileQuadScratch, batching locally unless a batch is open
+    void drawTileQuads(sf::RenderTarget& target);
+    
+    // Platform tile cache helpers
+    // Appends the tile index of every cell of 'platform', chosen from the
+    // cell's neighbour mask; variants hash the cell, so the result is the same
+    // on every call
+    PlatformCells autotilePlatform(const sf::FloatRect& platform, bool randomize, std::vector<int>& out) const;
+    void autotilePlatforms(); // All of cachedPlatformBounds, with cachedRandomize
+    void collectPlatformTiles(const sf::FloatRect& platform, const int* tiles, const PlatformCells& cells,
+                              std::vector<TileQuad>& out) const;
+    void assignPlatformsToChunks();
+    void rebuildPlatformChunk(size_t chunk);
+    int platformChunkIndex(float x) const;
+    void rebuildDecorationCache();
+    size_t decorationChunkIndex(float x) const;
+    void appendDecorationQuad(const LevelData::DecorationQuad& quad); // To its chunk
 };
\ No newline at end of file
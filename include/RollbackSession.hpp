@@ -0,0 +1,107 @@
+#pragma once
+#include "SimSnapshot.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Rollback bookkeeping for two-peer netplay on the fixed-step simulation.
+// Every tick runs at once with the local buttons and a prediction of the
+// remote ones (the last the peer confirmed); a snapshot of the state before
+// each tick is kept. When the peer's real buttons for a tick arrive and differ
+// from what was predicted, Game restores that tick's snapshot and runs the
+// ticks since again (takeRollback / endRollback).
+//
+// Re-simulation has a hard budget: the session never runs more than
+// getWindow() ticks ahead of the peer's confirmed input, so a correction never
+// reaches further back than that. The window is MAX_ROLLBACK ticks while the
+// measured cost of a re-simulated tick fits BUDGET_MS, and shrinks when it
+// doesn't; at 0 the session stalls until the peer catches up (lockstep).
+//
+// Local input is delayed by a few ticks (inputDelay), which hides that much
+// latency without any rollback. Inputs travel as writeInputPacket /
+// readInputPacket payloads: every tick the peer hasn't acknowledged, run-length
+// coded, so a lost packet is covered by the next one.
+class RollbackSession {
+public:
+    static constexpr uint32_t MAX_ROLLBACK = 8;  // Ticks a correction may reach back
+    static constexpr double BUDGET_MS = 4.0;     // Re-simulation time per frame
+    static constexpr uint32_t MAX_INPUT_DELAY = 4;
+    static constexpr uint32_t HISTORY = 64;      // Input ring; must cover delay, window and packet span
+    static constexpr size_t MAX_PACKET = 16 + 2 * HISTORY;
+
+    struct Stats {
+        uint32_t tick = 0;              // Next tick to run
+        uint32_t remoteConfirmed = 0;   // Remote ticks known, from 0
+        uint32_t window = MAX_ROLLBACK;
+        uint64_t mispredictions = 0;
+        uint64_t rollbacks = 0;
+        uint64_t resimulatedTicks = 0;
+        uint32_t lastRollbackTicks = 0;
+        double lastRollbackMs = 0.0;
+        double maxRollbackMs = 0.0;
+        double tickCostMs = 0.0;        // Moving average of a re-simulated tick
+        uint64_t resimAllocations = 0;  // Heap allocations while re-simulating; should stay 0
+        uint64_t stalledFrames = 0;     // Frames that couldn't run a tick, waiting for the peer
+        uint64_t lostHistory = 0;       // Corrections older than the last level load
+        uint64_t packetsSent = 0;
+        uint64_t packetsReceived = 0;
+        size_t lastPacketBytes = 0;
+    };
+
+    // Both peers start at tick 0 from the same state with the same delay
+    void start(uint32_t inputDelay);
+    void stop() { active = false; }
+    bool isActive() const { return active; }
+
+    // The state was replaced (a level load): snapshots from before are no use
+    void resetHistory() { historyStart = tick; rollbackFrom = NO_ROLLBACK; }
+
+    // Forward ticks. canAdvance() is false while the peer's input lags more
+    // than the window; otherwise the caller saves the state into
+    // snapshotFor(getTick()), calls addLocalInput, runs the tick with
+    // getButtons(getTick()) and then advance().
+    bool canAdvance() const;
+    void noteStall() { stats.stalledFrames++; }
+    SimSnapshot& snapshotFor(uint32_t tick) { return snapshots[tick % SNAPSHOTS]; }
+    void addLocalInput(uint8_t buttons);
+    // Local and remote (confirmed or predicted) buttons of a tick, combined.
+    // Records the prediction, so confirmed input can be checked against it.
+    uint8_t getButtons(uint32_t tick);
+    void advance() { tick++; }
+    uint32_t getTick() const { return tick; }
+
+    // After readInputPacket: the earliest tick whose prediction was wrong.
+    // The caller loads snapshotFor(from), runs the ticks up to getTick() again
+    // (saving each one's snapshot first), then reports the time it took.
+    bool takeRollback(uint32_t& from);
+    void endRollback(uint32_t ticks, double ms, uint64_t allocations);
+
+    // The payload to send this frame; returns its size
+    size_t writeInputPacket(uint8_t* out, size_t capacity);
+    // False for a malformed payload
+    bool readInputPacket(const uint8_t* data, size_t size);
+
+    uint32_t getWindow() const;
+    uint32_t getInputDelay() const { return inputDelay; }
+    const Stats& getStats();
+
+private:
+    static constexpr uint32_t SNAPSHOTS = MAX_ROLLBACK + 2;
+    static constexpr uint32_t NO_ROLLBACK = UINT32_MAX;
+
+    uint8_t remoteFor(uint32_t tick) const; // Confirmed, or the last confirmed
+
+    bool active = false;
+    uint32_t inputDelay = 2;
+    uint32_t tick = 0;
+    uint32_t historyStart = 0;     // Oldest tick a rollback may go back to
+    uint32_t localNext = 0;        // Ticks with local input, from 0
+    uint32_t remoteNext = 0;       // Ticks with confirmed remote input, from 0
+    uint32_t remoteAcked = 0;      // Local ticks the peer has confirmed receiving
+    uint32_t rollbackFrom = NO_ROLLBACK;
+    std::array<uint8_t, HISTORY> localInput{};
+    std::array<uint8_t, HISTORY> remoteInput{};
+    std::array<uint8_t, HISTORY> predicted{};   // Remote buttons each run tick used
+    std::array<SimSnapshot, SNAPSHOTS> snapshots;
+    Stats stats;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "LevelLoader.hpp"
+
+// Seeded procedural levels for scaling tests: platforms, ladders, enemies,
+// NPCs and decorations in the counts asked for, over a level as wide as the
+// platform density calls for. The same Config always yields the same level
+// on every platform (the generator draws from its own integer RNG, not the
+// standard distributions), so a scaling curve measured on one machine can be
+// re-run on another. Used by the debug panel's Scene tab and by game_bench
+// (--preset / --scene).
+namespace SceneGenerator {
+
+struct Config {
+    uint32_t seed = 1;
+    size_t platforms = 1000;   // Including the ground
+    size_t ladders = 100;
+    size_t enemies = 1000;
+    size_t npcs = 20;
+    size_t decorations = 500;
+    size_t particles = 5000;   // Snow budget while the scene is loaded (not part of the level)
+    float density = 8.f;       // Platforms per 1000 px of level width
+    float width = 0.f;         // Level width in pixels; 0 = from the platform count and density
+    float tileSize = 30.f;     // Platforms and ladders snap to this grid
+};
+
+struct Preset {
+    const char* name;
+    Config config;
+};
+
+// "1k", "10k" and "100k": that many platforms and enemies, the rest in proportion
+size_t getPresetCount();
+const Preset& getPreset(size_t index);
+// False (and 'out' untouched) for an unknown name
+bool findPreset(const std::string& name, Config& out);
+
+// Level width 'config' produces
+float getLevelWidth(const Config& config);
+
+// Replaces 'out' with the generated level: a ground strip along the bottom of
+// a 600 px tall level, platforms scattered above it, ladders down from
+// platforms to the ground, enemies patrolling platforms, NPCs and
+// decorations on the ground, and the default triggers. No theme is set.
+void generate(const Config& config, LevelData& out);
+
+} // namespace SceneGenerator
@@ -0,0 +1,95 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Software mix bus for low-priority sound effects. OpenAL only gives the game a
+// handful of sources, so crowds of short, repetitive sounds (footsteps, hits)
+// are mixed here instead, into one stereo stream that SoundSystem plays on a
+// single streaming source. Samples are mono float at SAMPLE_RATE and shared by
+// every voice playing them; a voice is a read position, a step (its pitch) and
+// the left/right gains its gain and pan resolve to. mixBlock() adds every voice
+// into a BLOCK_FRAMES block four samples per instruction (SSE2 or NEON, scalar
+// fallback otherwise), then clamps and converts the block to 16-bit PCM.
+//
+// Not thread-safe: SoundSystem drives it from the audio thread only.
+class SfxMixer {
+public:
+    static constexpr uint32_t SAMPLE_RATE = 44100;
+    static constexpr size_t BLOCK_FRAMES = 1024;
+    static constexpr size_t MAX_VOICES = 256;
+
+    struct Sample {
+        std::vector<float> frames; // Mono, SAMPLE_RATE, -1..1
+    };
+    // Interleaved 16-bit PCM (1 or 2 channels) at any rate, downmixed and
+    // linearly resampled to the mixer's format; nullptr if empty
+    static std::shared_ptr<const Sample> makeSample(const int16_t* pcm, size_t frames, uint32_t channels,
+                                                    uint32_t sampleRate);
+
+    using VoiceHandle = uint64_t;
+    static constexpr VoiceHandle NO_VOICE = 0;
+
+    enum class PlayResult : uint8_t {
+        Started,
+        Restarted, // The owner was at its voice cap; its oldest voice was cut off
+        Dropped,   // Every voice is busy
+    };
+    // 'owner' groups voices for the instance cap and stop(owner); 'pan' is -1
+    // (left) to 1 (right) at constant power; 'pitch' scales the playback rate.
+    // maxInstances 0 = no cap. Playback begins 'startFrame' frames in; 'handle',
+    // when given, receives the voice's handle (NO_VOICE if it was dropped).
+    PlayResult play(std::shared_ptr<const Sample> sample, const void* owner, float gain, float pan, float pitch,
+                    int maxInstances, size_t startFrame = 0, VoiceHandle* handle = nullptr);
+    void stop();                   // Every voice
+    void stop(const void* owner);  // The owner's voices
+    size_t getActiveVoices() const { return voices.size(); }
+
+    // One voice by handle; a voice that ended (or was restarted for another
+    // play) no longer answers to it. Linear in the voice count.
+    bool isPlaying(VoiceHandle handle) const { return findVoice(handle) != nullptr; }
+    bool setVoiceMix(VoiceHandle handle, float gain, float pan); // False if it ended
+    void stopVoice(VoiceHandle handle);
+
+    // Mixes the next BLOCK_FRAMES frames of every voice into 'out' as
+    // interleaved stereo, and retires the voices that ran out
+    void mixBlock(int16_t* out);
+
+    struct Stats {
+        uint64_t blocks = 0;
+        float lastBlockMs = 0.0f;
+        float averageBlockMs = 0.0f; // Smoothed over recent blocks
+        size_t voicesLastBlock = 0;
+    };
+    const Stats& getStats() const { return stats; }
+
+    // Name of the kernel compiled into this build ("SSE2", "NEON" or "Scalar")
+    static const char* kernelName();
+
+private:
+    struct Voice {
+        std::shared_ptr<const Sample> sample;
+        const void* owner = nullptr;
+        double position = 0.0; // Frames into the sample
+        float step = 1.0f;     // Frames per output frame
+        float left = 0.0f;
+        float right = 0.0f;
+        uint64_t startOrder = 0; // Also its handle
+    };
+
+    static void setMix(Voice& voice, float gain, float pan);
+    const Voice* findVoice(VoiceHandle handle) const;
+    Voice* findVoice(VoiceHandle handle) {
+        return const_cast<Voice*>(static_cast<const SfxMixer*>(this)->findVoice(handle));
+    }
+    // Adds 'count' frames of 'voice' into the accumulators; returns false once it ran out
+    bool mixVoice(Voice& voice, size_t count);
+
+    std::vector<Voice> voices; // Dense; a finished voice is swap-removed
+    uint64_t voiceCounter = 0;
+    std::array<float, BLOCK_FRAMES> mixLeft{};
+    std::array<float, BLOCK_FRAMES> mixRight{};
+    Stats stats;
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Byte buffer for a save state of the simulation. Each system writes its own
+// state (saveState) and reads it back in the same order (loadState); the SoA
+// stores go in as whole arrays, one memcpy each, and come back the same way
+// into vectors that already have the size, so a restore doesn't allocate.
+// Only plain data goes in: no pointers, textures or other assets.
+//
+// The buffer keeps its capacity across clear(), so saving again is free of
+// allocations too once it has grown to the state's size.
+class SimSnapshot {
+public:
+    void clear() {
+        bytes.clear();
+        readOffset = 0;
+    }
+    void rewind() { readOffset = 0; }
+    bool empty() const { return bytes.empty(); }
+    size_t size() const { return bytes.size(); }
+
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "snapshots hold plain data only");
+        append(&value, sizeof(T));
+    }
+    template <typename T>
+    void writeArray(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>, "snapshots hold plain data only");
+        write(static_cast<uint32_t>(values.size()));
+        append(values.data(), values.size() * sizeof(T));
+    }
+    void writeString(const std::string& value) {
+        write(static_cast<uint32_t>(value.size()));
+        append(value.data(), value.size());
+    }
+
+    // False once the buffer runs out; the target is left as it was
+    template <typename T>
+    bool read(T& value) {
+        return take(&value, sizeof(T));
+    }
+    template <typename T>
+    bool readArray(std::vector<T>& values) {
+        uint32_t count = 0;
+        if (!read(count) || bytes.size() - readOffset < count * sizeof(T)) {
+            return false;
+        }
+        values.resize(count);
+        return take(values.data(), count * sizeof(T));
+    }
+    bool readString(std::string& value) {
+        uint32_t length = 0;
+        if (!read(length) || bytes.size() - readOffset < length) {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(bytes.data() + readOffset), length);
+        readOffset += length;
+        return true;
+    }
+
+private:
+    void append(const void* data, size_t size) {
+        if (size == 0) return;
+        const size_t offset = bytes.size();
+        bytes.resize(offset + size);
+        std::memcpy(bytes.data() + offset, data, size);
+    }
+    bool take(void* data, size_t size) {
+        if (bytes.size() - readOffset < size) {
+            return false;
+        }
+        if (size > 0) {
+            std::memcpy(data, bytes.data() + readOffset, size);
+        }
+        readOffset += size;
+        return true;
+    }
+
+    std::vector<uint8_t> bytes;
+    size_t readOffset = 0;
+};
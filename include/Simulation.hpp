@@ -0,0 +1,36 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "LevelGeometry.hpp"
+#include "Player.hpp"
+#include "EnemyStore.hpp"
+#include "NPC.hpp"
+#include "Physics.hpp"
+#include "JobSystem.hpp"
+
+// One fixed step of the world: player, NPCs, enemies and physics, in the order
+// Game has always run them. No window, audio or level flow here, so the same
+// step drives the game and the headless benchmark (tools/GameBench.cpp).
+struct SimulationWorld {
+    Player& player;
+    LevelGeometry& platforms;
+    EnemyStore& enemies;
+    NPC* npcs;            // Optional
+    PhysicsSystem& physics;
+    JobSystem& jobs;
+    bool updateEnemies = true;
+    sf::Vector2f focus;   // Centre of the simulation region (PhysicsSystem::updateRegions); peers must agree on it
+};
+
+namespace Simulation {
+
+constexpr size_t ENEMY_UPDATE_GRAIN = 64; // Enemies per job chunk
+
+// step() is stepPlayer() then stepWorld(); Game reacts to the player's own move in between
+void step(SimulationWorld& world, float deltaTime);
+void stepPlayer(SimulationWorld& world, float deltaTime);
+void stepWorld(SimulationWorld& world, float deltaTime);
+// End of stepWorld: with GAME_FIXED_POINT, the state handed on goes onto the fixed-point grid
+void snapState(SimulationWorld& world);
+
+} // namespace Simulation
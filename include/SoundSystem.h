@@ -8,10 +8,27 @@
 #include <AL/alc.h>
 #endif
 
+#include <cstddef>
+#include <cstdint>
+#include <SFML/Audio.hpp>
+#include <SFML/System/Vector2.hpp>
 #include <string>
 #include <unordered_map>
 #include <memory>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "SfxMixer.hpp"
+#include "SpscQueue.hpp"
 
+// All OpenAL playback runs on one audio thread. The public playback and volume
+// calls only push a command onto a lock-free SPSC queue, so they must all come
+// from a single (game) thread. Loading stays synchronous and happens at init,
+// except per-level music, which the audio thread opens itself.
 class SoundSystem {
 public:
     SoundSystem();
@@ -20,21 +37,101 @@ public:
     // Initialize the sound system
     bool initialize();
     
-    // Load audio files
+    // Load audio files (WAV, Ogg Vorbis or FLAC). Music is only probed here and
+    // streamed while it plays; sound effects are decoded into OpenAL buffers up front.
     bool loadMusic(const std::string& name, const std::string& filePath);
     bool loadSoundEffect(const std::string& name, const std::string& filePath);
     
+    // Hot reload: reloads every effect and music track loaded from 'path'. An
+    // effect's buffer is swapped on the audio thread (voices playing it stop);
+    // the current music restarts with the new track. Returns how many reloaded.
+    size_t reloadFile(const std::string& path);
+    
+    // First existing "<stem>.ogg", "<stem>.flac" or "<stem>.wav" (pack or disk)
+    static std::string resolveAudioPath(const std::string& stem);
+    
     // Playback control for background music
     void playMusic(const std::string& name, bool loop = true);
     void stopMusic();
     void pauseMusic();
     void resumeMusic();
     void setMusicVolume(float volume); // 0.0f to 1.0f
+    void setMusicPitch(float pitch);
+    
+    // Per-level music, by stem (resolveAudioPath). Nothing here touches the
+    // disk on the calling thread: the audio thread resolves, probes and opens
+    // the track. prefetchMusic buffers it on the idle deck, ready to start;
+    // crossfadeMusic switches to it (prefetching first if it wasn't) with an
+    // equal-power crossfade over 'seconds' (0 cuts). The track already playing
+    // is left alone.
+    void prefetchMusic(const std::string& stem);
+    void crossfadeMusic(const std::string& stem, float seconds, bool loop = true);
+    
+    // Playback control for sound effects. 'pan' is -1 (left) to 1 (right); OpenAL
+    // only pans mono effects on their own sources, the software bus pans all.
+    void playSoundEffect(const std::string& name, float pitch = 1.0f, float pan = 0.0f);
+    void stopSoundEffects();
     
-    // Playback control for sound effects
-    void playSoundEffect(const std::string& name);
+    // Positional effects: 'position' is in world pixels, heard from the listener.
+    // Full volume within FULL_VOLUME_DISTANCE, fading to silence at AUDIBLE_DISTANCE,
+    // panned by the horizontal offset. Out of range an effect holds no voice: it is
+    // kept as a virtual voice (its start time and position) and picks up where it
+    // would be if the listener comes within range before it would have ended.
+    // Playing ones follow the listener every audio tick.
+    static constexpr float FULL_VOLUME_DISTANCE = 256.0f;
+    static constexpr float AUDIBLE_DISTANCE = 1024.0f;
+    static constexpr float PAN_DISTANCE = 640.0f; // Horizontal offset panned fully to one side
+    void playSoundEffectAt(const std::string& name, const sf::Vector2f& position, float pitch = 1.0f);
+    void setListener(const sf::Vector2f& position); // Once a frame, e.g. the camera centre
     void setSoundEffectVolume(float volume); // 0.0f to 1.0f
     
+    // Voice policy for one effect. When every voice is busy, a new effect steals the
+    // lowest-priority voice (quietest, then oldest) whose priority doesn't exceed its own.
+    // Software-mixed effects never take a source: they play on the SfxMixer bus,
+    // which has SfxMixer::MAX_VOICES voices of its own and streams through one source, at
+    // the cost of up to MIX_STREAM_BUFFERS blocks of extra latency.
+    struct SoundEffectSettings {
+        int priority = 0;           // Higher wins when voices run out
+        int maxInstances = 4;       // Concurrent voices of this effect (0 = no limit)
+        float minInterval = 0.05f;  // Seconds; faster re-triggers are ignored
+        float volume = 1.0f;        // Scales the effects volume for this effect
+        bool softwareMix = false;   // Low-priority crowd sounds: mix on the bus instead
+    };
+    void setSoundEffectSettings(const std::string& name, const SoundEffectSettings& settings);
+    
+    struct VoiceStats {
+        int activeVoices = 0;
+        int mixedVoices = 0;      // On the software bus, not in activeVoices
+        int virtualVoices = 0;    // Positional effects out of range, holding no voice
+        uint64_t virtualized = 0; // Started out of range, or left it while playing
+        uint64_t played = 0;
+        uint64_t stolen = 0;      // Started by cutting off another voice
+        uint64_t dropped = 0;     // No voice could be freed for it
+        uint64_t rateLimited = 0; // Ignored by minInterval
+    };
+    VoiceStats getVoiceStats() const;
+    
+    // Audio thread load. Tick times cover command handling, voice refresh and music refill.
+    struct AudioThreadStats {
+        float lastTickMs = 0.0f;
+        float averageTickMs = 0.0f;   // Smoothed over recent ticks
+        float peakTickMs = 0.0f;      // Worst tick in the last second
+        uint64_t ticks = 0;
+        uint64_t commands = 0;
+        uint64_t commandsDropped = 0; // Queue was full when the game thread pushed
+        float mixBlockMs = 0.0f;      // Smoothed cost of one SfxMixer::BLOCK_FRAMES block
+        uint64_t mixBlocks = 0;
+    };
+    AudioThreadStats getAudioThreadStats() const;
+    
+    // Game thread. What OpenAL holds outside the heap: the loaded effects'
+    // buffers plus the music and software bus stream buffers. The heap side
+    // (mix samples, decode scratch) is charged to AllocationTracker's Audio tag.
+    size_t getBufferBytes() const;
+    
+    // Wake the audio thread so this frame's commands play without waiting for its poll
+    void update();
+    
     // General controls
     void setMasterVolume(float volume); // 0.0f to 1.0f
     void cleanup();
@@ -44,24 +141,216 @@ private:
     ALCdevice* device;
     ALCcontext* context;
     
-    // Audio source for background music
-    ALuint musicSource;
-    ALuint currentMusicBuffer;
-    
     // Pool of sources for sound effects
     static const int MAX_SOUND_SOURCES = 16;
     ALuint soundSources[MAX_SOUND_SOURCES];
     
-    // Storage for loaded audio buffers
-    std::unordered_map<std::string, ALuint> musicBuffers;
-    std::unordered_map<std::string, ALuint> soundBuffers;
+    // Loaded sound effects: fully decoded buffers (short effects only) plus policy.
+    // Entries are created by the game thread; everything but 'buffer', 'mixSample'
+    // and 'filePath' belongs to the audio thread. A loaded buffer (and its mix
+    // sample) is only replaced through a command.
+    struct SoundEffect {
+        ALuint buffer = 0;
+        std::shared_ptr<const SfxMixer::Sample> mixSample; // The same PCM, for the software bus
+        float getDuration() const {
+            return mixSample ? static_cast<float>(mixSample->frames.size()) / SfxMixer::SAMPLE_RATE : 0.0f;
+        }
+        std::string filePath; // Game thread, for reloadFile
+        size_t bufferBytes = 0; // Game thread: AL_SIZE of the last buffer loaded
+        SoundEffectSettings settings;
+        std::chrono::steady_clock::time_point lastTrigger;
+        bool triggered = false;
+    };
+    std::unordered_map<std::string, SoundEffect> soundEffects;
+    
+    // What each effect source is playing, as of the last audio tick (no per-play AL queries)
+    struct Voice {
+        ALuint source = 0;
+        const SoundEffect* effect = nullptr;
+        uint64_t startOrder = 0;
+        float attenuation = 1.0f; // Distance gain of a positional effect
+        bool busy = false;
+    };
+    std::array<Voice, MAX_SOUND_SOURCES> voices;
+    uint64_t voiceCounter = 0;
+    VoiceStats voiceStats;
+    
+    // Where startVoice() put an effect: a source, a bus voice, or nowhere
+    struct PlayedVoice {
+        Voice* source = nullptr;
+        uint64_t startOrder = 0; // The source's, to tell it wasn't stolen since
+        SfxMixer::VoiceHandle mixed = SfxMixer::NO_VOICE;
+        bool isPlaying() const { return source || mixed != SfxMixer::NO_VOICE; }
+    };
+    
+    // A positional effect until it would have ended; 'played' is empty while virtual
+    struct PositionalVoice {
+        SoundEffect* effect = nullptr;
+        sf::Vector2f position;
+        float pitch = 1.0f;
+        std::chrono::steady_clock::time_point start;
+        PlayedVoice played;
+    };
+    std::vector<PositionalVoice> positionalVoices;
+    sf::Vector2f listener; // Audio thread's copy
+    
+    struct Spatial {
+        float gain = 1.0f;
+        float pan = 0.0f;
+        bool audible = true;
+    };
+    Spatial spatialize(const sf::Vector2f& position) const;
+    
+    Voice* acquireVoice(const SoundEffect& effect);
+    float getEffectGain(const SoundEffect& effect) const { return effectsGain * effect.settings.volume; }
+    float getVoiceGain(const Voice& voice) const { return getEffectGain(*voice.effect) * voice.attenuation; }
+    
+    // Format and location of the PCM data inside a WAV file image
+    struct WavInfo {
+        uint16_t channels = 0;
+        uint32_t sampleRate = 0;
+        uint16_t bitsPerSample = 0;
+        size_t dataOffset = 0;
+        size_t dataSize = 0;
+        ALenum getFormat() const;
+    };
+    
+    // A registered music file; PCM is read from the pack mapping or the file on demand
+    struct MusicTrack {
+        std::string filePath;
+        WavInfo info;                     // For compressed tracks: 16-bit output format
+        const char* packedData = nullptr; // Whole file image when it lives in the asset pack
+        size_t packedSize = 0;
+        bool compressed = false;          // Ogg/FLAC, decoded through sf::InputSoundFile
+    };
+    // Shared so a track being streamed survives loadMusic() replacing it
+    std::unordered_map<std::string, std::shared_ptr<const MusicTrack>> musicTracks;
+    
+    // Streaming playback: a small ring of buffers queued on a deck's source and
+    // refilled by the audio thread as OpenAL finishes with them. Two decks, so
+    // the next track can be buffered while the current one plays and the two
+    // crossfaded.
+    static constexpr int MUSIC_STREAM_BUFFERS = 4;
+    static constexpr size_t MUSIC_CHUNK_BYTES = 64 * 1024;
+    
+    struct MusicDeck {
+        ALuint source = 0;
+        std::array<ALuint, MUSIC_STREAM_BUFFERS> buffers{};
+        std::shared_ptr<const MusicTrack> track;
+        std::ifstream file;    // Loose-file reader, positioned inside the data chunk
+        std::unique_ptr<sf::InputSoundFile> decoder; // Compressed tracks
+        size_t position = 0;   // Bytes of PCM consumed
+        bool loop = false;
+        bool active = false;   // Has queued data or more to decode
+        bool paused = false;
+        bool finished = false; // Decoder reached the end of a non-looping track
+        bool primed = false;   // Buffers queued, source not started yet (prefetched)
+        float share = 1.0f;    // Crossfade position; the source plays at musicGain * share
+    };
+    
+    std::array<MusicDeck, 2> musicDecks;
+    size_t currentDeck = 0; // Playing, or fading in
+    struct MusicFade {
+        std::chrono::steady_clock::time_point start;
+        float seconds = 0.0f;
+        bool active = false; // The other deck is fading out
+    };
+    MusicFade musicFade;
+    std::vector<char> musicChunk;           // Decode scratch
+    std::vector<std::int16_t> musicSamples; // Same, for compressed tracks
+    
+    // Software bus: SfxMixer blocks streamed through one more source. Blocks
+    // are only mixed while a mixed voice plays; the source drains and stops after.
+    static constexpr int MIX_STREAM_BUFFERS = 3;
+    SfxMixer mixer;
+    ALuint mixSource = 0;
+    std::array<ALuint, MIX_STREAM_BUFFERS> mixStreamBuffers{};
+    std::vector<ALuint> idleMixBuffers;      // Not queued on mixSource
+    std::vector<std::int16_t> mixBlock;      // Interleaved stereo scratch
+    
+    // Game thread -> audio thread commands. Plain data plus the track reference.
+    struct AudioCommand {
+        enum class Type : uint8_t {
+            PlayEffect, PlayEffectAt, SetListener, StopEffects, SetEffectSettings, SetEffectGain,
+            PlayMusic, StopMusic, PauseMusic, ResumeMusic, SetMusicGain, SetMusicPitch,
+            PrefetchMusic, CrossfadeMusic,
+            ReplaceEffectBuffer
+        };
+        Type type = Type::StopEffects;
+        SoundEffect* effect = nullptr;
+        std::shared_ptr<const MusicTrack> track;
+        std::string stem;                           // Music to resolve on the audio thread
+        SoundEffectSettings settings;
+        std::chrono::steady_clock::time_point time; // When the game thread issued it
+        float value = 0.0f;                         // Gain, pitch or crossfade seconds
+        float pan = 0.0f;
+        sf::Vector2f position;                      // Positional effect or listener
+        ALuint buffer = 0;                          // Replacement effect buffer
+        std::shared_ptr<const SfxMixer::Sample> sample; // And its mix sample
+        bool loop = false;
+    };
+    static constexpr size_t AUDIO_COMMAND_CAPACITY = 256;
+    static constexpr auto AUDIO_THREAD_POLL = std::chrono::milliseconds(5);
+    
+    SpscQueue<AudioCommand, AUDIO_COMMAND_CAPACITY> commandQueue;
+    uint64_t commandsDropped = 0; // Game thread only
+    std::string currentMusic;     // Game thread: last playMusic() not stopped since
+    bool currentMusicLoop = false;
+    
+    std::mutex audioMutex; // Only for sleeping and the stop flag; commands never take it
+    std::condition_variable audioCondition;
+    std::thread audioThread;
+    bool stopAudioThread = false;
+    
+    // Copies of the audio thread's counters for the debug panel
+    mutable std::mutex statsMutex;
+    VoiceStats publishedVoiceStats;
+    AudioThreadStats publishedThreadStats;
+    
+    void sendCommand(AudioCommand&& command);
+    void audioThreadLoop();
+    void executeCommand(AudioCommand& command);
+    void refreshVoices();
+    void streamMusic();
+    void streamMix();
+    // Rate limiting, then startVoice(); false if limited or no voice could be had
+    bool startEffect(SoundEffect& effect, float pitch, float pan, float attenuation,
+                     std::chrono::steady_clock::time_point time, PlayedVoice& played);
+    void startPositionalEffect(SoundEffect& effect, const sf::Vector2f& position, float pitch,
+                               std::chrono::steady_clock::time_point time);
+    // On the bus or a source, 'offset' seconds in; false if no voice could be had
+    bool startVoice(SoundEffect& effect, float pitch, float pan, float attenuation, float offset, PlayedVoice& played);
+    void stopVoice(PlayedVoice& played);
+    void updatePositionalVoices();
+    void startMusic(std::shared_ptr<const MusicTrack> track, bool loop);
+    // Opens the track on 'deck' and fills its ring without starting it
+    bool openMusic(MusicDeck& deck, std::shared_ptr<const MusicTrack> track, bool loop);
+    // The idle deck, unless it (or the current deck) already has 'filePath'; false if it can't be opened
+    bool prefetchMusicFile(const std::string& filePath, bool loop);
+    void crossfadeMusicFile(const std::string& filePath, float seconds, bool loop);
+    void updateMusicFade();
+    void finishMusicFade(); // Cuts the outgoing deck
+    void applyMusicGain(MusicDeck& deck);
+    void streamMusicDeck(MusicDeck& deck);
+    bool fillMusicBuffer(MusicDeck& deck, ALuint buffer);
+    bool fillCompressedMusicBuffer(MusicDeck& deck, ALuint buffer);
+    void resetMusicStream(MusicDeck& deck);
     
     // Utility functions
-    bool loadWavFile(const std::string& filePath, ALuint& buffer);
-    ALuint findAvailableSoundSource();
+    bool loadWavFile(const std::string& filePath, ALuint& buffer, std::shared_ptr<const SfxMixer::Sample>& mixSample);
+    bool loadCompressedFile(const std::string& filePath, ALuint& buffer,
+                            std::shared_ptr<const SfxMixer::Sample>& mixSample);
+    static bool isCompressedAudio(const std::string& filePath);
+    // Reads just the header (or opens the decoder) to describe a track for streaming
+    static bool probeMusic(const std::string& filePath, MusicTrack& track);
+    static bool openDecoder(const std::string& filePath, const char* packedData, size_t packedSize, sf::InputSoundFile& decoder);
+    // 'available' bytes of the file image are in memory; 'totalSize' is the whole file
+    static bool parseWav(const char* data, size_t available, size_t totalSize, const std::string& filePath, WavInfo& info);
     
-    // Volume controls
+    // Volume controls (game thread) and the gains they resolve to (audio thread)
     float masterVolume;
     float musicVolume;
     float soundEffectVolume;
+    float musicGain = 1.0f;
+    float effectsGain = 1.0f;
 }; 
\ No newline at end of file
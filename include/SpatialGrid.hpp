@@ -0,0 +1,67 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cstdint>
+
+// Static uniform grid over a set of rectangles (platforms).
+// Built once when the level geometry changes; queries return the indices of
+// every rectangle whose cells overlap the query area, in ascending index order
+// so callers see the same ordering as a plain linear scan.
+// Queries are const and keep no internal state, so they are safe to run from worker threads.
+//
+// The editor moves single rectangles without a rebuild: update() takes the
+// item out of its cells and onto a short list of moved items that queries
+// test directly against their bounds. The list only grows until the next build().
+class SpatialGrid {
+public:
+    explicit SpatialGrid(float cellSize = 128.0f);
+
+    // Rebuild the grid from scratch
+    void build(const std::vector<sf::FloatRect>& bounds);
+    void clear();
+
+    // Moves item 'index' to 'bounds' (index == getItemCount() adds one), or
+    // takes it out of the results altogether. Not safe against concurrent queries.
+    void update(size_t index, const sf::FloatRect& bounds);
+    void remove(size_t index);
+    size_t getMovedCount() const { return movedItems.size(); }
+
+    // Collect candidate indices overlapping the area (inclusive edges).
+    // Returns the number of candidates written to 'out' (which is cleared first).
+    size_t query(const sf::FloatRect& area, std::vector<size_t>& out) const;
+    // Same, for the cells the segment from 'from' to 'to' passes through
+    // (walked cell by cell, so a long ray visits a thin line of cells rather
+    // than its whole bounding box)
+    size_t querySegment(const sf::Vector2f& from, const sf::Vector2f& to, std::vector<size_t>& out) const;
+
+    void setCellSize(float size) { cellSize = size > 1.0f ? size : 1.0f; }
+    float getCellSize() const { return cellSize; }
+    int getColumns() const { return columns; }
+    int getRows() const { return rows; }
+    size_t getItemCount() const { return itemCount; }
+    bool isEmpty() const { return itemCount == 0; }
+
+private:
+    int cellX(float x) const;
+    int cellY(float y) const;
+    bool isDetached(uint32_t item) const { return item < detached.size() && detached[item]; }
+    void detach(size_t index);
+
+    float cellSize;
+    sf::Vector2f origin;
+    int columns = 0;
+    int rows = 0;
+    size_t itemCount = 0;
+
+    // Compressed cell storage: items of cell c are cellItems[cellStart[c] .. cellStart[c + 1])
+    std::vector<uint32_t> cellStart;
+    std::vector<uint32_t> cellItems;
+
+    // Items no longer in their cells, and where the moved ones are now
+    std::vector<uint8_t> detached;
+    std::vector<uint32_t> movedItems;
+    std::vector<sf::FloatRect> movedBounds;
+
+    // Upper bound on cells so a huge sparse level can't allocate unbounded memory
+    static constexpr size_t MAX_CELLS = 1 << 20;
+};
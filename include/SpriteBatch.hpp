@@ -0,0 +1,54 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "RenderStats.hpp"
+#include <cstdint>
+#include <vector>
+
+// Collects textured quads between begin() and end() and flushes them with one
+// draw call per (layer, texture) run. Sprites that share an atlas page therefore
+// cost a single draw. Within the same layer, sprites are grouped by texture, so
+// only the layer value orders overlapping sprites that use different textures.
+class SpriteBatch {
+public:
+    struct Stats {
+        size_t spritesSubmitted = 0;
+        size_t drawCalls = 0;
+        size_t vertices = 0;
+    };
+
+    void begin();
+    void end(sf::RenderTarget& target, RenderStats& renderStats, RenderCategory category);
+    bool isActive() const { return active; }
+
+    // Queue a sprite using its own transform, texture rect and color
+    void add(const sf::Sprite& sprite, int layer = 0);
+    // Queue a sprite as if it were positioned at 'position'
+    void add(const sf::Sprite& sprite, const sf::Vector2f& position, int layer = 0);
+    // Queue prebuilt triangles (e.g. cached text) sampling 'texture', moved by 'offset'.
+    // They stay together and in order, like one sprite.
+    void add(const sf::Vertex* triangles, size_t vertexCount, const sf::Texture& texture, const sf::Vector2f& offset,
+             int layer = 0);
+
+    // Totals for the frame in progress; endFrame() moves them to getLastFrameStats()
+    void endFrame();
+    const Stats& getFrameStats() const { return frameStats; }
+    const Stats& getLastFrameStats() const { return lastFrameStats; }
+
+private:
+    struct Entry {
+        int layer;
+        const sf::Texture* texture;
+        uint32_t order;        // Submission order keeps sorting stable
+        uint32_t firstVertex;  // Into 'quads'
+        uint32_t vertexCount;  // Six for a sprite
+    };
+
+    void addQuad(const sf::Sprite& sprite, const sf::Transform& transform, int layer);
+
+    bool active = false;
+    std::vector<Entry> entries;
+    std::vector<sf::Vertex> quads;     // Vertices in submission order
+    std::vector<sf::Vertex> vertices;  // Sorted vertices handed to the GPU
+    Stats frameStats;
+    Stats lastFrameStats;
+};
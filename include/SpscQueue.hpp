@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// Bounded lock-free single-producer/single-consumer ring. Exactly one thread
+// pushes and exactly one other thread pops; neither side ever blocks or
+// allocates after construction. Capacity must be a power of two.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscQueue() : slots(new T[Capacity]) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer only. Returns false when the ring is full; 'item' is left untouched.
+    bool push(T&& item) {
+        const size_t tail = tailPos.load(std::memory_order_relaxed);
+        if (tail - headPos.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        slots[tail & (Capacity - 1)] = std::move(item);
+        tailPos.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Returns false when there is nothing to pop.
+    bool pop(T& out) {
+        const size_t head = headPos.load(std::memory_order_relaxed);
+        if (head == tailPos.load(std::memory_order_acquire)) {
+            return false;
+        }
+        out = std::move(slots[head & (Capacity - 1)]);
+        headPos.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::unique_ptr<T[]> slots;
+    alignas(64) std::atomic<size_t> headPos{0};
+    alignas(64) std::atomic<size_t> tailPos{0};
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Phase breakdown of Game's startup, for the log and the debug panel. Main
+// thread phases run back to back (begin() ends the one before). The tasks of
+// a parallel stage are timed on whichever thread runs them, each into a slot
+// reserved up front, so recording needs no lock; tasks sharing a name are
+// reported as one span. Names must be string literals.
+class StartupProfile {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Phase {
+        const char* name = nullptr;
+        double startMs = 0.0; // Since the profile was created
+        double endMs = 0.0;
+        bool parallel = false;
+    };
+
+    StartupProfile() : origin(Clock::now()) {}
+
+    void begin(const char* name); // Main thread
+    void end();
+
+    // Slots for the next 'count' parallel tasks; returns the first
+    size_t reserveTasks(size_t count);
+    // From the task's thread once it is done ('start' taken when it began)
+    void recordTask(size_t slot, const char* name, Clock::time_point start);
+
+    // Once, when the first frame has been presented
+    void markFirstFrame();
+    bool hasFirstFrame() const { return firstFrameMs > 0.0; }
+    double getFirstFrameMs() const { return firstFrameMs; }
+
+    // A free-form line shown after the phases (e.g. decode throughput)
+    void addNote(std::string note) { notes.push_back(std::move(note)); }
+
+    // One line per phase, parallel tasks merged by name, the total, then the notes
+    std::vector<std::string> formatLines() const;
+
+private:
+    double sinceOrigin(Clock::time_point time) const {
+        return std::chrono::duration<double, std::milli>(time - origin).count();
+    }
+
+    Clock::time_point origin;
+    std::vector<Phase> phases;
+    size_t open = SIZE_MAX; // Running main thread phase
+    double firstFrameMs = 0.0;
+    std::vector<std::string> notes;
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cstdint>
+#include "CollisionLayers.hpp"
+
+// Sort-and-sweep broadphase for moving entities (player, enemies, NPCs),
+// separate from the static platform SpatialGrid. Proxies are kept sorted by
+// their left edge; since bodies barely move between frames, an insertion sort
+// restores the order in close to one pass, and a sweep along x then only tests
+// proxies whose x ranges overlap. The result is a list of overlapping pairs
+// (strict edges, like the rectsIntersect helpers) for the contact handlers.
+// Each proxy has a collision layer and mask; pairs the masks rule out (enemy
+// against enemy, say) are skipped before the y test and never listed.
+// query() finds the proxies overlapping an area that isn't a proxy itself
+// (a projectile's sweep): a binary search on the sorted order, then a walk
+// back over the proxies that start within the widest proxy's width of it.
+class SweepAndPrune {
+public:
+    using ProxyId = uint32_t;
+    using Layer = CollisionLayer;
+
+    struct Pair {
+        ProxyId a; // a < b
+        ProxyId b;
+    };
+
+    struct Stats {
+        size_t proxies = 0;
+        size_t pairs = 0;
+        size_t shifts = 0;   // Insertion-sort moves, low while the order is coherent
+        size_t tests = 0;    // y-overlap tests after the x sweep
+        size_t filtered = 0; // x-overlapping pairs the layer masks ruled out
+    };
+
+    // 'index' is the caller's own index for the entity (into its enemy or NPC list)
+    ProxyId add(Layer layer, uint32_t index, const sf::FloatRect& bounds);
+    ProxyId add(Layer layer, CollisionMask mask, uint32_t index, const sf::FloatRect& bounds);
+    void clear();
+
+    void setBounds(ProxyId id, const sf::FloatRect& bounds);
+    // Disabled proxies keep their slot but take part in no pairs
+    void setEnabled(ProxyId id, bool enabled) { this->enabled[id] = enabled ? 1 : 0; }
+    void setMask(ProxyId id, CollisionMask mask) { this->mask[id] = mask; }
+
+    size_t getProxyCount() const { return layer.size(); }
+    Layer getLayer(ProxyId id) const { return layer[id]; }
+    CollisionMask getMask(ProxyId id) const { return mask[id]; }
+    uint32_t getIndex(ProxyId id) const { return index[id]; }
+    sf::FloatRect getBounds(ProxyId id) const {
+        return sf::FloatRect(sf::Vector2f(minX[id], minY[id]), sf::Vector2f(maxX[id] - minX[id], maxY[id] - minY[id]));
+    }
+
+    // Re-sorts and sweeps; the returned list is valid until the next call
+    const std::vector<Pair>& updatePairs();
+    const std::vector<Pair>& getPairs() const { return pairs; }
+
+    // Enabled proxies on a layer in 'layers' overlapping 'area' (strict edges)
+    // into 'out', in ascending id order; returns the count. Uses the order the
+    // last updatePairs sorted, so bounds set since then may be missed. Const
+    // and stateless, so safe from worker threads.
+    size_t query(const sf::FloatRect& area, CollisionMask layers, std::vector<ProxyId>& out) const;
+
+    // True if 'pair' joins layers 'first' and 'second' (in either order); the
+    // entity indices are returned in the order the layers were asked for
+    bool match(const Pair& pair, Layer first, Layer second, uint32_t& firstIndex, uint32_t& secondIndex) const;
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    // Per-proxy data, indexed by ProxyId
+    std::vector<float> minX, minY, maxX, maxY;
+    std::vector<Layer> layer;
+    std::vector<CollisionMask> mask;
+    std::vector<uint32_t> index;
+    std::vector<uint8_t> enabled;
+
+    std::vector<ProxyId> order; // Proxies by ascending minX, kept across frames
+    std::vector<float> orderMinX; // minX along 'order', as of the last updatePairs, for query()'s search
+    float maxWidth = 0.f;       // Widest proxy since clear(), bounding query()'s walk back
+    std::vector<Pair> pairs;
+    Stats stats;
+};
@@ -0,0 +1,159 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "GpuTimer.hpp"
+#include "MemoryStats.hpp"
+
+// Session performance telemetry for "it stutters" reports from the field.
+// recordFrame() runs once per frame and files the frame's time into an
+// HDR-style histogram (1/16 ms steps up to 1 ms, then 8 steps per doubling),
+// keeps the worst frames with their top profiler zones and what was on screen,
+// and accumulates per-level, entity, render, GPU pass and asset-load figures. Everything
+// lives in fixed-size arrays, so a session of any length costs the same few KB
+// and recording never allocates. writeReport() saves it all as compact JSON
+// (Game writes game_telemetry.json next to the log on exit); loadSummary()
+// reads a report back for the debug panel's comparison against a baseline.
+class SessionTelemetry {
+public:
+    static constexpr uint32_t UNITS_PER_MS = 16;     // Histogram resolution below 1 ms
+    static constexpr size_t LINEAR_BUCKETS = 16;     // 0..1 ms in 1/16 ms steps
+    static constexpr size_t SUB_BUCKETS = 8;         // Per doubling above that (12.5% wide)
+    static constexpr size_t OCTAVES = 16;            // Up to 65 s
+    static constexpr size_t BUCKETS = LINEAR_BUCKETS + SUB_BUCKETS * OCTAVES;
+    static constexpr size_t WORST_FRAMES = 16;
+    static constexpr size_t WORST_ZONES = 4;         // Longest top-level profiler zones per worst frame
+    static constexpr size_t MAX_LEVELS = 16;         // Higher level ids share the last slot
+    static constexpr double HITCH_MS = 1000.0 / 30.0; // A frame that missed two 60 Hz vsyncs
+
+    // What the frame was doing, filled in by Game
+    struct FrameContext {
+        int level = 0;
+        uint32_t enemies = 0;
+        uint32_t npcs = 0;
+        uint32_t particles = 0;
+        uint32_t drawCalls = 0;   // Of the last presented frame
+        uint32_t vertices = 0;
+    };
+
+    struct Zone {
+        const char* name = nullptr; // A profiler zone literal
+        float ms = 0.0f;
+    };
+
+    struct WorstFrame {
+        uint64_t frame = 0;
+        float ms = 0.0f;
+        FrameContext context;
+        std::array<Zone, WORST_ZONES> zones{};
+    };
+
+    struct LevelStats {
+        uint64_t frames = 0;
+        uint64_t hitches = 0;
+        double totalMs = 0.0;
+        float maxMs = 0.0f;
+    };
+
+    // The headline numbers, from this session or read back from a report
+    struct Summary {
+        uint64_t frames = 0;
+        double seconds = 0.0;
+        double avgMs = 0.0;
+        double p50Ms = 0.0;
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+        uint64_t hitches = 0;
+        double avgDrawCalls = 0.0;
+        uint32_t peakDrawCalls = 0;
+        uint32_t peakEnemies = 0;
+        uint32_t peakParticles = 0;
+        double levelLoadMaxMs = 0.0;
+        double uploadMaxMs = 0.0;
+        double gpuAvgMs = 0.0;    // 0 without GPU timer queries
+        double gpuMaxMs = 0.0;
+        double peakMemoryMb = 0.0; // Heap plus estimates, at its highest
+    };
+
+    // Highest reading of each memory slot, and of the total on its own
+    struct MemoryPeak {
+        MemoryStats::Sample bytes;
+        uint64_t total = 0;
+    };
+
+    // Once per frame; the time is measured from the previous call, so the first only starts the clock
+    void recordFrame(const FrameContext& context);
+    void recordLevelLoad(double ms);
+    void recordUploads(double ms); // One frame's texture uploads
+    // A frame's GPU pass times; a frame already recorded (same index) is ignored,
+    // so the newest results can be passed every frame
+    void recordGpuFrame(const GpuTimer::Frame& frame);
+    // Once per frame, charged to 'level'
+    void recordMemory(int level, const MemoryStats::Sample& sample);
+    void reset();
+
+    uint64_t getFrames() const { return frames; }
+    // Upper bound of the bucket holding the given fraction of frames (0.99 = p99), capped at the max
+    double getPercentileMs(double fraction) const;
+    const std::array<uint64_t, BUCKETS>& getHistogram() const { return histogram; }
+    static double getBucketUpperMs(size_t bucket);
+    // Slowest first; only the first getWorstCount() are filled
+    const std::array<WorstFrame, WORST_FRAMES>& getWorstFrames() const { return worst; }
+    size_t getWorstCount() const { return worstCount; }
+    const MemoryPeak& getMemoryPeak() const { return memoryPeak; }
+    const MemoryPeak& getLevelMemoryPeak(int level) const { return levelMemoryPeaks[levelSlot(level)]; }
+    Summary summarize() const;
+
+    bool writeReport(const std::string& path, std::string& error) const;
+    static bool loadSummary(const std::string& path, Summary& out, std::string& error);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static size_t bucketFor(double ms);
+    static size_t levelSlot(int level);
+    void recordWorst(float ms, const FrameContext& context);
+
+    Clock::time_point lastFrame{};
+    bool started = false;
+    uint64_t frames = 0;
+    double totalMs = 0.0;
+    float maxMs = 0.0f;
+    uint64_t hitches = 0;
+    std::array<uint64_t, BUCKETS> histogram{};
+    std::array<WorstFrame, WORST_FRAMES> worst{};
+    size_t worstCount = 0;
+    std::array<LevelStats, MAX_LEVELS> levels{};
+
+    // Entities and render stats
+    uint32_t peakEnemies = 0;
+    uint32_t peakNpcs = 0;
+    uint32_t peakParticles = 0;
+    uint64_t totalDrawCalls = 0;
+    uint32_t peakDrawCalls = 0;
+    uint64_t totalVertices = 0;
+    uint32_t peakVertices = 0;
+
+    // GPU passes
+    uint64_t gpuFrames = 0;
+    uint64_t lastGpuFrame = 0;
+    double gpuTotalMs = 0.0;
+    float gpuMaxMs = 0.0f;
+    std::array<double, GpuTimer::PASS_COUNT> gpuPassMs{};
+    std::array<float, GpuTimer::PASS_COUNT> gpuPassMaxMs{};
+
+    // Asset loading
+    uint32_t levelLoads = 0;
+    double levelLoadMs = 0.0;
+    float levelLoadMaxMs = 0.0f;
+    uint64_t uploadFrames = 0;
+    double uploadMs = 0.0;
+    float uploadMaxMs = 0.0f;
+
+    // Memory
+    MemoryPeak memoryPeak;
+    std::array<MemoryPeak, MAX_LEVELS> levelMemoryPeaks{};
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Packs many small images (tiles, animation frames) into a few large texture pages
+// so sprites that share a page can be batched into one draw. Uses the skyline
+// packer from imstb_rectpack.h (shipped with ImGui).
+//
+// Usage: add() every image, then build() once. Regions are stable after build();
+// page textures live as long as the atlas (or until clear()).
+class TextureAtlas {
+public:
+    struct Region {
+        size_t page = 0;
+        sf::IntRect rect; // Pixel rect inside the page texture
+    };
+
+    explicit TextureAtlas(unsigned pageSize = 2048, unsigned padding = 1);
+
+    // Queue an image for packing. Returns its region id, or -1 if it failed to load.
+    int addFromFile(const std::string& path);
+    // Decodes what addFromFile would queue; safe on any thread (no GL)
+    static bool loadImage(const std::string& path, sf::Image& image);
+    int add(sf::Image&& image);
+
+    // Pack all queued images into pages and upload them. Returns false if nothing
+    // could be uploaded. CPU-side images are released afterwards.
+    bool build();
+    void clear();
+
+    // Overwrite a built region's pixels in its page (hot reload); false unless
+    // the image is exactly the region's size, in which case a rebuild is needed
+    bool updateRegion(const Region& region, const sf::Image& image);
+
+    bool isBuilt() const { return built; }
+    size_t getRegionCount() const { return regions.size(); }
+    size_t getPageCount() const { return pages.size(); }
+    size_t getResidentBytes() const; // GPU size of the uploaded pages (RGBA8)
+    const Region& getRegion(int id) const { return regions[id]; }
+    const sf::Texture& getPageTexture(size_t page) const { return *pages[page]; }
+    const sf::Texture& getTexture(int id) const { return *pages[regions[id].page]; }
+
+private:
+    unsigned pageSize;
+    unsigned padding;
+    bool built = false;
+
+    std::vector<sf::Image> pendingImages;
+    std::vector<Region> regions;
+    std::vector<std::unique_ptr<sf::Texture>> pages; // unique_ptr keeps sprite references valid
+};
@@ -0,0 +1,117 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "JobSystem.hpp"
+
+// Small previews of image files for the Asset Manager, packed as fixed-size
+// cells into a few atlas pages. get() returns a resident thumbnail or queues
+// the file; a job on the Thumbnail lane decodes and downscales it, and update() uploads
+// finished thumbnails into free cells on the main thread. When every cell is
+// taken the least recently used one is recycled, so memory stays at the page
+// budget however many files are browsed. The same lane loads the
+// full-resolution image for the explicit preview.
+class ThumbnailCache {
+public:
+    struct Thumbnail {
+        const sf::Texture* page = nullptr;
+        sf::IntRect rect; // Inside the page; aspect kept, so it may be smaller than the cell
+    };
+
+    struct Stats {
+        size_t resident = 0;
+        size_t queued = 0;
+        size_t hits = 0;
+        size_t misses = 0;     // Requests queued
+        size_t evictions = 0;
+        size_t failures = 0;   // Files that could not be decoded
+    };
+
+    static constexpr unsigned DEFAULT_THUMBNAIL_SIZE = 64;
+    static constexpr unsigned DEFAULT_PAGE_SIZE = 1024;
+    static constexpr size_t DEFAULT_PAGE_COUNT = 4;     // 16 MB of RGBA at the defaults
+    static constexpr size_t MAX_QUEUED = 128;           // Older requests are dropped when scrolling fast
+    static constexpr size_t UPLOADS_PER_UPDATE = 32;
+
+    // 'jobs' must outlive the cache
+    explicit ThumbnailCache(JobSystem& jobs, unsigned thumbnailSize = DEFAULT_THUMBNAIL_SIZE,
+                            unsigned pageSize = DEFAULT_PAGE_SIZE, size_t pageCount = DEFAULT_PAGE_COUNT);
+    ~ThumbnailCache(); // Waits for its jobs to return
+
+    ThumbnailCache(const ThumbnailCache&) = delete;
+    ThumbnailCache& operator=(const ThumbnailCache&) = delete;
+
+    // Resident thumbnail (marked most recently used), or nullptr after queueing 'path'
+    const Thumbnail* get(const std::string& path);
+
+    // Loads 'path' at full resolution in a job, replacing an earlier request
+    void requestPreview(const std::string& path);
+    // True once the requested preview has been decoded; 'out' is empty if that failed
+    bool takePreview(sf::Image& out);
+
+    // Main thread, once per frame: uploads up to UPLOADS_PER_UPDATE finished thumbnails
+    void update();
+
+    void clear();
+    unsigned getThumbnailSize() const { return thumbnailSize; }
+    size_t getBudgetBytes() const { return static_cast<size_t>(pageSize) * pageSize * 4 * pageCount; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Cell {
+        std::string path;      // Empty while free
+        Thumbnail thumbnail;
+        uint32_t newer = NONE; // LRU links
+        uint32_t older = NONE;
+    };
+
+    struct Decoded {
+        std::string path;
+        sf::Image image;       // Downscaled; empty on failure
+    };
+
+    void serveRequest(); // One job: the preview if asked for, else the newest request
+    void submitJob();    // mutex held
+    sf::Image downscale(const sf::Image& source) const;
+    uint32_t allocateCell();
+    void unlink(uint32_t cell);
+    void pushNewest(uint32_t cell);
+
+    unsigned thumbnailSize;
+    unsigned pageSize;
+    size_t pageCount;
+    unsigned cellsPerRow;
+
+    // Main thread only
+    std::vector<std::unique_ptr<sf::Texture>> pages; // Created as cells are first needed
+    std::vector<Cell> cells;
+    std::unordered_map<std::string, uint32_t> cellsByPath;
+    std::unordered_set<std::string> failed;
+    uint32_t newest = NONE;
+    uint32_t oldest = NONE;
+    Stats stats;
+
+    JobSystem& jobs;
+
+    // Shared with the jobs, guarded by mutex
+    std::mutex mutex;
+    std::condition_variable jobsDone;      // The destructor waits for runningJobs to drain
+    std::deque<std::string> requests;      // Newest at the back, served first
+    std::unordered_set<std::string> queued; // Requested or decoding, not yet uploaded
+    std::vector<Decoded> decoded;
+    std::string previewRequest;
+    bool previewRequested = false;
+    bool previewReady = false;
+    sf::Image previewImage;
+    size_t runningJobs = 0;                 // Submitted and not yet returned
+    bool stopping = false;
+};
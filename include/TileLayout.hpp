@@ -0,0 +1,35 @@
+#pragma once
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <string>
+#include <string_view>
+
+// How asset_cooker splits a background painted wider than a texture can be
+// (<layer>.wide.png) and where the pieces go: a directory <layer>.tiles next
+// to the source holding LAYOUT_FILE (this layout as JSON), PREVIEW_FILE (the
+// whole image scaled down to fit PREVIEW_SIZE) and a <column>_<row>.png per
+// TILE_SIZE square, the last column and row cut at the image's edge.
+struct TileLayout {
+    static constexpr const char* SOURCE_SUFFIX = ".wide.png";
+    static constexpr const char* DIRECTORY_SUFFIX = ".tiles";
+    static constexpr const char* LAYOUT_FILE = "tiles.json";
+    static constexpr const char* PREVIEW_FILE = "preview.png";
+    static constexpr unsigned TILE_SIZE = 512;
+    static constexpr unsigned PREVIEW_SIZE = 1024;
+
+    sf::Vector2u size; // Of the source image
+    unsigned tileSize = TILE_SIZE;
+    unsigned columns = 0;
+    unsigned rows = 0;
+
+    static TileLayout forImage(const sf::Vector2u& size, unsigned tileSize = TILE_SIZE);
+    size_t getTileCount() const { return static_cast<size_t>(columns) * rows; }
+    sf::IntRect getTileRect(unsigned column, unsigned row) const; // In source pixels
+
+    std::string toJson() const;
+    static bool parse(std::string_view json, TileLayout& out, std::string& error);
+
+    static std::string getTilePath(const std::string& directory, unsigned column, unsigned row);
+    // "<dir>/<layer>.wide.png" -> "<dir>/<layer>.tiles"; empty for any other path
+    static std::string getDirectoryFor(const std::string& sourcePath);
+};
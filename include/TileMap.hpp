@@ -0,0 +1,91 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Narrowphase.hpp"
+
+// Dense tile layer over the level, in the grid the level was drawn on. Every
+// cell has a byte of flags and the index of the platform covering it, and the
+// solid, platform-top and ladder cells are also kept as packed bitsets (64
+// cells a word, each row padded to whole words). A query over a box masks the
+// words of the rows it touches, so it costs the cells touched, not the number
+// of platforms in the level, and empty stretches are skipped 64 cells at once.
+//
+// Only boxes that cover whole cells exactly go in; anything off the grid, or on
+// a cell another platform already has, is refused and stays a rectangle for
+// the caller to handle. Cell (c, r) spans [c * tile, (c + 1) * tile) from the
+// level origin; queries treat edges as inclusive, as SpatialGrid does.
+class TileMap {
+public:
+    enum CellFlags : uint8_t {
+        CellSolid = 1 << 0,        // Part of a platform, whatever its surface
+        CellTop = 1 << 1,          // Top row of its platform
+        CellOneWay = 1 << 2,
+        CellSlopeUpRight = 1 << 3,
+        CellSlopeUpLeft = 1 << 4,
+        CellLadder = 1 << 5,
+    };
+    static constexpr uint32_t NO_PLATFORM = UINT32_MAX;
+    static constexpr float MIN_TILE_SIZE = 8.f;
+
+    // Covers 'size' pixels from the origin with 'tileSize' cells, empty. Below
+    // MIN_TILE_SIZE (levels written in pixels, tile_size 1) the layer is off.
+    // Storage is kept across calls with the same dimensions.
+    void reset(float tileSize, const sf::Vector2f& size);
+    void clearPlatforms(); // Platform cells only; ladders stay
+    void clearLadders();
+
+    // Claims the cells 'box' covers for platform 'platform'; false, with
+    // nothing marked, if the box is off the grid or a cell is taken
+    bool addPlatform(uint32_t platform, const sf::FloatRect& box, Narrowphase::SurfaceType type);
+    bool addLadder(const sf::FloatRect& box);
+    // Gives back the cells 'box' covers if platform 'platform' holds them all;
+    // false, with nothing changed, otherwise (it was never on the layer)
+    bool removePlatform(uint32_t platform, const sf::FloatRect& box);
+    // Unmarks the ladder cells 'box' covers; overlapping ladders need adding again
+    bool removeLadder(const sf::FloatRect& box);
+
+    bool isEnabled() const { return columns > 0; }
+    float getTileSize() const { return tileSize; }
+    int getColumns() const { return columns; }
+    int getRows() const { return rows; }
+    uint8_t getFlags(int column, int row) const { return flags[index(column, row)]; }
+    uint32_t getPlatform(int column, int row) const { return platforms[index(column, row)]; }
+    uint8_t getFlagsAt(const sf::Vector2f& point) const; // 0 off the grid
+
+    bool anySolid(const sf::FloatRect& area) const;
+    bool anyLadder(const sf::FloatRect& area) const;
+    // Appends the platforms with a cell in 'area': once per run of cells in a
+    // row, so a platform spanning several rows can appear more than once
+    void collectPlatforms(const sf::FloatRect& area, std::vector<size_t>& out) const;
+    // Whether the top of a platform lies within 'distance' of 'bottom' under
+    // [left, right] (edges inclusive), the ground test isEntityOnGround makes
+    bool hasTopNear(float left, float right, float bottom, float distance) const;
+
+private:
+    struct Range {
+        int column0, column1, row0, row1;
+    };
+    // Cells touching [left, right] x [top, bottom] with inclusive edges, clamped; false if none
+    bool getRange(float left, float right, float top, float bottom, Range& range) const;
+    bool anyBit(const std::vector<uint64_t>& bits, const Range& range) const;
+    void setBits(std::vector<uint64_t>& bits, int column, int row, bool value);
+    size_t index(int column, int row) const {
+        return static_cast<size_t>(row) * static_cast<size_t>(columns) + static_cast<size_t>(column);
+    }
+    bool toCells(const sf::FloatRect& box, Range& cells) const; // Exact cover, or false
+
+    float tileSize = 0.f;
+    int columns = 0;
+    int rows = 0;
+    size_t wordsPerRow = 0;
+    std::vector<uint8_t> flags;       // Per cell, row-major
+    std::vector<uint32_t> platforms;  // Per cell, NO_PLATFORM where there is none
+    std::vector<uint64_t> solidBits;
+    std::vector<uint64_t> topBits;
+    std::vector<uint64_t> ladderBits;
+
+    // Upper bound on cells, as SpatialGrid's: a huge level leaves the layer off
+    static constexpr size_t MAX_CELLS = 1 << 22;
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include "AssetManager.hpp"
+#include "TileLayout.hpp"
+#include <SFML/Graphics/Rect.hpp>
+#include <string>
+#include <vector>
+
+// A background layer too wide for one texture, streamed from the tiles
+// asset_cooker split it into (see TileLayout). The preview is loaded when the
+// layer opens and stands in wherever a tile isn't resident yet; tiles are
+// decoded on the Streaming lane as the draws reach them.
+//
+// The renderer reports the tiles each draw covers (markVisible); update()
+// requests those, plus a column either side for the camera to scroll into,
+// and keeps the most recently drawn ones resident under a tile cap. A tile
+// let go of is only unpinned: the asset manager keeps it until its budget
+// needs the room, so scrolling back usually finds it still there.
+//
+// The render thread draws from it (getTile, markVisible) while the game
+// thread is waiting for it; update() runs once that thread is idle.
+class TiledBackground {
+public:
+    static constexpr size_t DEFAULT_RESIDENT_TILES = 32; // 32 MB of 512x512 RGBA
+
+    struct Stats {
+        size_t resident = 0;
+        size_t loading = 0;
+        size_t requests = 0;  // Since opening
+        size_t evictions = 0;
+        size_t failed = 0;
+    };
+
+    // 'directory' is the <layer>.tiles directory, resolved for opening
+    TiledBackground(AssetManager& assets, std::string directory);
+
+    // Reads the layout and loads the preview; false with the reason if either fails
+    bool open(std::string& error);
+
+    // Game thread, render thread idle: streams toward the tiles drawn since the
+    // last call. True when a tile arrived or left, so cached draws are stale.
+    bool update();
+    void setResidentLimit(size_t tiles) { residentLimit = tiles; }
+
+    const TileLayout& getLayout() const { return layout; }
+    const sf::Texture& getPreview() const { return preview.get(); }
+    // Null until resident
+    const sf::Texture* getTile(unsigned column, unsigned row) const;
+    // Render thread: the tiles a draw covered, in tile coordinates
+    void markVisible(const sf::IntRect& tiles);
+
+    const Stats& getStats() const { return stats; }
+
+    // Texture names, shared with the prefetch of a level's preview
+    static std::string getPreviewKey(const std::string& directory);
+
+private:
+    struct Tile {
+        AssetManager::TextureRef texture;
+        AssetManager::TextureLoad load;
+        uint64_t lastUse = 0;
+        bool failed = false;
+    };
+
+    std::string getTileKey(unsigned column, unsigned row) const;
+    void request(unsigned column, unsigned row, bool& changed, size_t& loading);
+    bool trim(const sf::IntRect& keep);
+
+    AssetManager& assets;
+    std::string directory;
+    TileLayout layout;
+    AssetManager::TextureRef preview;
+    std::vector<Tile> tiles; // Row-major
+    std::vector<uint32_t> residentTiles;
+    size_t residentLimit = DEFAULT_RESIDENT_TILES;
+    sf::IntRect visible;     // Union of the draws' tiles since the last update
+    bool anyVisible = false;
+    uint64_t clock = 0;
+    Stats stats;
+};
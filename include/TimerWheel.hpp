@@ -0,0 +1,102 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "HandlePool.hpp"
+
+class SimSnapshot;
+
+// Hierarchical timer wheel for gameplay timers and cooldowns. Time advances in
+// whole ticks of a fixed length; a timer is an event id and a word of data due
+// at some tick. Timers due within 64 ticks sit in the slot for their tick,
+// later ones in coarser wheels of 64 slots each (64^2, 64^3, 64^4 ticks) and
+// move down a level when their slot comes round. Scheduling and cancelling
+// are constant time, and a tick costs only the timers that fire or move down,
+// however many are pending, instead of every owner decrementing a float.
+//
+// Timers are ids from a HandlePool over a dense array, so a cancelled or fired
+// timer's id finds nothing and the whole wheel saves as plain data.
+class TimerWheel {
+public:
+    using TimerId = HandlePool::Handle;
+    static constexpr TimerId NO_TIMER = HandlePool::INVALID;
+
+    static constexpr uint32_t SLOT_BITS = 6;
+    static constexpr uint32_t SLOTS = 1u << SLOT_BITS;
+    static constexpr uint32_t LEVELS = 4;
+    static constexpr uint64_t MAX_DELAY = (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1; // Longer delays are re-filed as they come round
+
+    struct Expired {
+        TimerId id;
+        uint32_t event;
+        uint32_t data;
+    };
+
+    struct Stats {
+        size_t pending = 0;
+        size_t peak = 0;      // Most pending at once since the last clear
+        size_t fired = 0;     // Last advance
+        size_t cascaded = 0;  // Timers moved down a level in the last advance
+    };
+
+    explicit TimerWheel(float tickSeconds = 1.0f / 60.0f);
+
+    float getTickSeconds() const { return tickSeconds; }
+    // Ticks to cover 'seconds', rounded up and at least one
+    uint64_t ticksFor(float seconds) const;
+
+    // Fires 'delayTicks' (at least one) ticks from now
+    TimerId schedule(uint64_t delayTicks, uint32_t event, uint32_t data = 0);
+    TimerId scheduleIn(float seconds, uint32_t event, uint32_t data = 0) {
+        return schedule(ticksFor(seconds), event, data);
+    }
+    // False if the timer already fired or was cancelled
+    bool cancel(TimerId id);
+    bool isPending(TimerId id) const;
+    uint64_t remainingTicks(TimerId id) const; // 0 unless pending
+    float remainingSeconds(TimerId id) const { return remainingTicks(id) * tickSeconds; }
+
+    // Runs the whole ticks in the time since the last call (the remainder
+    // carries over), appending the timers that fire to 'expired' tick by tick
+    void advance(float deltaTime, std::vector<Expired>& expired);
+    void advanceTicks(uint64_t ticks, std::vector<Expired>& expired);
+
+    uint64_t now() const { return currentTick; }
+    size_t size() const { return timers.size(); }
+    const Stats& getStats() const { return stats; }
+    void clear(); // Cancels everything and drops the part tick carried over
+
+    // Save states: the clock, the timers and their ids
+    void saveState(SimSnapshot& snapshot) const;
+    bool loadState(SimSnapshot& snapshot);
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static constexpr uint32_t SLOT_MASK = SLOTS - 1;
+
+    struct Timer {
+        uint64_t due = 0;
+        TimerId id = NO_TIMER;
+        uint32_t event = 0;
+        uint32_t data = 0;
+        uint32_t bucket = NONE;  // Level * SLOTS + slot; NONE once unlinked
+        uint32_t prev = NONE;    // Neighbours in the bucket's list, by index into timers
+        uint32_t next = NONE;
+    };
+
+    void tick(std::vector<Expired>& expired);
+    void cascade(uint32_t level);
+    void place(uint32_t index);
+    void link(uint32_t index, uint32_t bucket);
+    void unlink(uint32_t index);
+    void remove(uint32_t index); // Swap-removes an unlinked timer
+
+    float tickSeconds;
+    float carry = 0.0f;                        // Time not yet a whole tick
+    uint64_t currentTick = 0;
+    std::vector<Timer> timers;                 // Dense; order is not due order
+    std::array<uint32_t, SLOTS * LEVELS> buckets; // First timer of each slot's list
+    HandlePool ids;                            // TimerId -> index into timers
+    Stats stats;
+};
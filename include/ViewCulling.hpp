@@ -0,0 +1,83 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+// View-rect culling helpers shared by the world renderers.
+// Bounds are axis-aligned world rects; views are assumed unrotated.
+namespace ViewCulling {
+
+// World-space rect covered by a view, grown by 'margin' on every side
+inline sf::FloatRect getViewBounds(const sf::View& view, float margin = 0.0f) {
+    sf::Vector2f size = view.getSize();
+    sf::Vector2f topLeft = view.getCenter() - size / 2.f;
+    return sf::FloatRect(topLeft - sf::Vector2f(margin, margin),
+                         size + sf::Vector2f(margin * 2.f, margin * 2.f));
+}
+
+// Inclusive overlap test (touching the view edge counts as visible)
+inline bool isVisible(const sf::FloatRect& bounds, const sf::FloatRect& viewBounds) {
+    return bounds.position.x <= viewBounds.position.x + viewBounds.size.x &&
+           bounds.position.x + bounds.size.x >= viewBounds.position.x &&
+           bounds.position.y <= viewBounds.position.y + viewBounds.size.y &&
+           bounds.position.y + bounds.size.y >= viewBounds.position.y;
+}
+
+// Views culled together (split screen): an object is tested once against
+// their union, and only the survivors against each view, for a mask with
+// bit i set when view i sees it. A single view converts implicitly.
+struct ViewSet {
+    static constexpr size_t MAX_VIEWS = 2;
+
+    std::array<sf::FloatRect, MAX_VIEWS> views{};
+    sf::FloatRect bounds; // Union of the views
+    size_t count = 0;
+
+    ViewSet() = default;
+    ViewSet(const sf::FloatRect& view) { add(view); }
+
+    void add(const sf::FloatRect& view) {
+        if (count == MAX_VIEWS) return;
+        views[count] = view;
+        if (count++ == 0) {
+            bounds = view;
+            return;
+        }
+        const sf::Vector2f topLeft(std::min(bounds.position.x, view.position.x), std::min(bounds.position.y, view.position.y));
+        const sf::Vector2f bottomRight(std::max(bounds.position.x + bounds.size.x, view.position.x + view.size.x),
+                                       std::max(bounds.position.y + bounds.size.y, view.position.y + view.size.y));
+        bounds = sf::FloatRect(topLeft, bottomRight - topLeft);
+    }
+
+    uint8_t allMask() const { return static_cast<uint8_t>((1u << count) - 1u); }
+
+    // 0 when no view sees 'box'
+    uint8_t visibleMask(const sf::FloatRect& box) const {
+        if (!isVisible(box, bounds)) return 0;
+        if (count == 1) return 1;
+        uint8_t mask = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (isVisible(box, views[i])) mask |= static_cast<uint8_t>(1u << i);
+        }
+        return mask;
+    }
+};
+
+// Per-category drawn/culled counters for the FPS overlay
+struct CullStats {
+    size_t drawn = 0;
+    size_t culled = 0;
+
+    void reset() { drawn = 0; culled = 0; }
+    void count(bool visible) {
+        if (visible) {
+            ++drawn;
+        } else {
+            ++culled;
+        }
+    }
+};
+
+} // namespace ViewCulling
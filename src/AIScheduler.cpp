@@ -0,0 +1,60 @@
+#include "AIScheduler.hpp"
+#include "SimSnapshot.hpp"
+
+void AIScheduler::resize(size_t count) {
+    const size_t previous = sinceThink.size();
+    sinceThink.resize(count, 0.0f);
+    lods.resize(count, Lod::Near);
+    // Golden-ratio phases spread first decisions evenly over the mid interval
+    for (size_t i = previous; i < count; ++i) {
+        const float phase = static_cast<float>(i) * 0.618034f;
+        sinceThink[i] = (phase - static_cast<float>(static_cast<size_t>(phase))) * settings.midInterval;
+    }
+    if (cursor >= count) {
+        cursor = 0;
+    }
+}
+
+void AIScheduler::clear() {
+    sinceThink.clear();
+    lods.clear();
+    cursor = 0;
+    stats = Stats();
+}
+
+void AIScheduler::remove(size_t agent) {
+    if (agent >= sinceThink.size()) {
+        return;
+    }
+    sinceThink[agent] = sinceThink.back();
+    lods[agent] = lods.back();
+    sinceThink.pop_back();
+    lods.pop_back();
+    if (cursor >= sinceThink.size()) {
+        cursor = 0;
+    }
+}
+
+void AIScheduler::saveState(SimSnapshot& snapshot) const {
+    snapshot.writeArray(sinceThink);
+    snapshot.writeArray(lods);
+    snapshot.write(static_cast<uint64_t>(cursor));
+    snapshot.write(focus);
+    snapshot.write(hasFocus);
+}
+
+bool AIScheduler::loadState(SimSnapshot& snapshot) {
+    uint64_t savedCursor = 0;
+    if (!(snapshot.readArray(sinceThink) && snapshot.readArray(lods) && snapshot.read(savedCursor) &&
+          snapshot.read(focus) && snapshot.read(hasFocus))) {
+        return false;
+    }
+    cursor = static_cast<size_t>(savedCursor);
+    return true;
+}
+
+AIScheduler::Stats AIScheduler::takeFrameTotals() {
+    Stats totals = frameTotals;
+    frameTotals = Stats();
+    return totals;
+}
@@ -0,0 +1,105 @@
+#include "AabbBatch.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AABB_BATCH_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AABB_BATCH_NEON 1
+#endif
+
+namespace AabbBatch {
+
+const char* kernelName() {
+#if defined(AABB_BATCH_SSE2)
+    return "SSE2";
+#elif defined(AABB_BATCH_NEON)
+    return "NEON";
+#else
+    return "Scalar";
+#endif
+}
+
+// Scalar test of boxes [start, count) against the query, appending hits
+static void scalarRange(float qMinX, float qMinY, float qMaxX, float qMaxY,
+                        const BoxArray& boxes, size_t start, std::vector<uint32_t>& hits) {
+    const size_t count = boxes.size();
+    for (size_t i = start; i < count; ++i) {
+        if (qMinX < boxes.maxX[i] && qMaxX > boxes.minX[i] &&
+            qMinY < boxes.maxY[i] && qMaxY > boxes.minY[i]) {
+            hits.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
+
+size_t overlapListScalar(const sf::FloatRect& box, const BoxArray& boxes, std::vector<uint32_t>& hits) {
+    hits.clear();
+    scalarRange(box.position.x, box.position.y,
+                box.position.x + box.size.x, box.position.y + box.size.y,
+                boxes, 0, hits);
+    return hits.size();
+}
+
+size_t overlapList(const sf::FloatRect& box, const BoxArray& boxes, std::vector<uint32_t>& hits) {
+    hits.clear();
+
+    const float qMinX = box.position.x;
+    const float qMinY = box.position.y;
+    const float qMaxX = box.position.x + box.size.x;
+    const float qMaxY = box.position.y + box.size.y;
+    const size_t count = boxes.size();
+    size_t i = 0;
+
+#if defined(AABB_BATCH_SSE2)
+    const __m128 vMinX = _mm_set1_ps(qMinX);
+    const __m128 vMinY = _mm_set1_ps(qMinY);
+    const __m128 vMaxX = _mm_set1_ps(qMaxX);
+    const __m128 vMaxY = _mm_set1_ps(qMaxY);
+    for (; i + 4 <= count; i += 4) {
+        __m128 mask = _mm_and_ps(
+            _mm_and_ps(_mm_cmplt_ps(vMinX, _mm_loadu_ps(&boxes.maxX[i])),
+                       _mm_cmpgt_ps(vMaxX, _mm_loadu_ps(&boxes.minX[i]))),
+            _mm_and_ps(_mm_cmplt_ps(vMinY, _mm_loadu_ps(&boxes.maxY[i])),
+                       _mm_cmpgt_ps(vMaxY, _mm_loadu_ps(&boxes.minY[i]))));
+        int bits = _mm_movemask_ps(mask);
+        if (bits == 0) {
+            continue;
+        }
+        // Compact the 4-bit mask into the hit list
+        const uint32_t base = static_cast<uint32_t>(i);
+        if (bits & 1) hits.push_back(base);
+        if (bits & 2) hits.push_back(base + 1);
+        if (bits & 4) hits.push_back(base + 2);
+        if (bits & 8) hits.push_back(base + 3);
+    }
+#elif defined(AABB_BATCH_NEON)
+    const float32x4_t vMinX = vdupq_n_f32(qMinX);
+    const float32x4_t vMinY = vdupq_n_f32(qMinY);
+    const float32x4_t vMaxX = vdupq_n_f32(qMaxX);
+    const float32x4_t vMaxY = vdupq_n_f32(qMaxY);
+    for (; i + 4 <= count; i += 4) {
+        uint32x4_t mask = vandq_u32(
+            vandq_u32(vcltq_f32(vMinX, vld1q_f32(&boxes.maxX[i])),
+                      vcgtq_f32(vMaxX, vld1q_f32(&boxes.minX[i]))),
+            vandq_u32(vcltq_f32(vMinY, vld1q_f32(&boxes.maxY[i])),
+                      vcgtq_f32(vMaxY, vld1q_f32(&boxes.minY[i]))));
+        // Quick reject when no lane is set
+        uint32x2_t folded = vorr_u32(vget_low_u32(mask), vget_high_u32(mask));
+        if ((vget_lane_u32(folded, 0) | vget_lane_u32(folded, 1)) == 0) {
+            continue;
+        }
+        uint32_t lanes[4];
+        vst1q_u32(lanes, mask);
+        const uint32_t base = static_cast<uint32_t>(i);
+        for (uint32_t k = 0; k < 4; ++k) {
+            if (lanes[k]) hits.push_back(base + k);
+        }
+    }
+#endif
+
+    // Remaining boxes (or everything without SIMD)
+    scalarRange(qMinX, qMinY, qMaxX, qMaxY, boxes, i, hits);
+    return hits.size();
+}
+
+} // namespace AabbBatch
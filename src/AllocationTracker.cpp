@@ -0,0 +1,155 @@
+#include "AllocationTracker.hpp"
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> allocationCount{0};
+std::atomic<uint64_t> allocatedBytes{0};
+std::atomic<uint64_t> freeCount{0};
+
+thread_local AllocationTracker::Tag threadTag = AllocationTracker::Tag::Untagged;
+
+#if GAME_MEMORY_TAGS
+// Keeps the block behind it aligned as malloc's was
+struct alignas(alignof(std::max_align_t) > 16 ? alignof(std::max_align_t) : 16) BlockHeader {
+    uint64_t size;
+    uint8_t tag;
+};
+constexpr size_t HEADER_SIZE = sizeof(BlockHeader);
+
+std::array<std::atomic<uint64_t>, AllocationTracker::TAG_COUNT> liveBytes{};
+#endif
+
+void* countedAlloc(std::size_t size, AllocationTracker::Tag tag) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+#if GAME_MEMORY_TAGS
+    void* block = std::malloc(size + HEADER_SIZE);
+    if (!block) {
+        return nullptr;
+    }
+    BlockHeader* header = static_cast<BlockHeader*>(block);
+    header->size = size;
+    header->tag = static_cast<uint8_t>(tag);
+    liveBytes[header->tag].fetch_add(size, std::memory_order_relaxed);
+    return static_cast<char*>(block) + HEADER_SIZE;
+#else
+    (void)tag;
+    return std::malloc(size ? size : 1);
+#endif
+}
+
+void* countedAlloc(std::size_t size) {
+    return countedAlloc(size, threadTag);
+}
+
+void countedFree(void* pointer) {
+    if (pointer) {
+        freeCount.fetch_add(1, std::memory_order_relaxed);
+#if GAME_MEMORY_TAGS
+        BlockHeader* header = reinterpret_cast<BlockHeader*>(static_cast<char*>(pointer) - HEADER_SIZE);
+        liveBytes[header->tag].fetch_sub(header->size, std::memory_order_relaxed);
+        std::free(header);
+#else
+        std::free(pointer);
+#endif
+    }
+}
+
+} // namespace
+
+namespace AllocationTracker {
+
+Counts getTotals() {
+    Counts counts;
+    counts.allocations = allocationCount.load(std::memory_order_relaxed);
+    counts.bytes = allocatedBytes.load(std::memory_order_relaxed);
+    counts.frees = freeCount.load(std::memory_order_relaxed);
+    return counts;
+}
+
+const char* getTagName(Tag tag) {
+    switch (tag) {
+        case Tag::Untagged: return "Untagged";
+        case Tag::Physics: return "Physics";
+        case Tag::Npcs: return "NPCs";
+        case Tag::Animation: return "Animation";
+        case Tag::Tiles: return "Tiles";
+        case Tag::Backgrounds: return "Backgrounds";
+        case Tag::Audio: return "Audio";
+        case Tag::ImGui: return "ImGui";
+        case Tag::Logging: return "Logging";
+        case Tag::Level: return "Level";
+        case Tag::Count: break;
+    }
+    return "?";
+}
+
+uint64_t getLiveBytes(Tag tag) {
+#if GAME_MEMORY_TAGS
+    return liveBytes[static_cast<size_t>(tag)].load(std::memory_order_relaxed);
+#else
+    (void)tag;
+    return 0;
+#endif
+}
+
+uint64_t getLiveBytes() {
+    uint64_t total = 0;
+    for (size_t i = 0; i < TAG_COUNT; ++i) {
+        total += getLiveBytes(static_cast<Tag>(i));
+    }
+    return total;
+}
+
+Tag getThreadTag() {
+    return threadTag;
+}
+
+void setThreadTag(Tag tag) {
+    threadTag = tag;
+}
+
+void* taggedAlloc(size_t size, Tag tag) {
+    return countedAlloc(size, tag);
+}
+
+void taggedFree(void* pointer) {
+    countedFree(pointer);
+}
+
+} // namespace AllocationTracker
+
+// Replacements for the global allocation functions. The aligned overloads are
+// left to the library; nothing in the game over-aligns heap objects.
+void* operator new(std::size_t size) {
+    if (void* pointer = countedAlloc(size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* pointer = countedAlloc(size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void operator delete(void* pointer) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { countedFree(pointer); }
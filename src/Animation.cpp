@@ -1,9 +1,7 @@
 #include "Animation.hpp"
-#include <filesystem>
 #include <algorithm>
 #include <iostream>
-
-namespace fs = std::filesystem;
+#include "DebugLog.hpp"
 
 Animation::Animation() 
     : currentState(AnimationState::Idle)
@@ -12,148 +10,67 @@ Animation::Animation()
     , currentTime(0.0f)
     , currentFrame(0)
     , shouldLoop(true)
-    , isPlaying(true) {
-    
-    createEmptySprite();
-}
-
-void Animation::createEmptySprite() {
-    // Try to load a simple texture file, or create a minimal texture
-    emptyTexture = std::make_unique<sf::Texture>();
-    
-    // Try to load a placeholder texture first
-    if (!emptyTexture->loadFromFile("assets/images/characters/player.png")) {
-        // If that fails, we'll just use an uninitialized texture
-        // The sprite will be invisible but won't crash
-        std::cerr << "Warning: Could not load placeholder texture for animation" << std::endl;
-    }
-    
-    emptySprite = std::make_unique<sf::Sprite>(*emptyTexture);
+    , isPlaying(true)
+    , sprite(std::make_unique<sf::Sprite>(AnimationClipCache::instance().getFallbackTexture())) {
 }
 
 Animation::~Animation() {
     // Cleanup handled by RAII
 }
 
-bool Animation::loadAnimation(AnimationState state, const std::string& directory) {
-    if (!fs::exists(directory) || !fs::is_directory(directory)) {
-        std::cerr << "Animation directory does not exist: " << directory << std::endl;
-        return false;
-    }
-    
-    AnimationData& animData = animations[state];
-    
-    if (loadFramesFromDirectory(directory, animData)) {
-        animData.isLoaded = true;
-        std::cout << "Successfully loaded " << animData.textures.size() 
-                  << " frames for animation state " << static_cast<int>(state) << std::endl;
-        return true;
+void AnimationPlayback::stepAll(size_t count, float* time, int32_t* frame, uint8_t* playing, const float* frameDuration,
+                                const int32_t* frameCount, const uint8_t* loop, float deltaTime) {
+    for (size_t i = 0; i < count; ++i) {
+        step(time[i], frame[i], playing[i], deltaTime, frameDuration[i], frameCount[i], loop[i] != 0);
     }
-    
-    return false;
 }
 
-bool Animation::loadFramesFromDirectory(const std::string& directory, AnimationData& animData) {
-    std::vector<std::string> frameFiles = getFrameFiles(directory);
-    
-    if (frameFiles.empty()) {
-        std::cerr << "No frame files found in directory: " << directory << std::endl;
+bool Animation::loadAnimation(AnimationState state, const std::string& directory) {
+    // Decoded once per process; every other instance shares the same clip
+    std::shared_ptr<const AnimationClip> clip = AnimationClipCache::instance().load(directory);
+    if (!clip || clip->getFrameCount() == 0) {
         return false;
     }
     
-    // Sort files to ensure correct frame order
-    std::sort(frameFiles.begin(), frameFiles.end());
-    
-    animData.textures.clear();
-    animData.sprites.clear();
-    
-    for (const auto& filename : frameFiles) {
-        auto texture = std::make_unique<sf::Texture>();
-        if (texture->loadFromFile(filename)) {
-            // Create sprite with the texture
-            auto sprite = std::make_unique<sf::Sprite>(*texture);
-            
-            // Apply current origin to the new sprite
-            sprite->setOrigin(spriteOrigin);
-            
-            // Add texture and sprite to vectors
-            animData.sprites.push_back(std::move(sprite));
-            animData.textures.push_back(std::move(texture));
-            
-            std::cout << "Loaded frame: " << filename << std::endl;
-        } else {
-            std::cerr << "Failed to load texture: " << filename << std::endl;
-        }
-    }
-    
-    return !animData.textures.empty();
-}
-
-std::vector<std::string> Animation::getFrameFiles(const std::string& directory) {
-    std::vector<std::string> frameFiles;
-    
-    try {
-        for (const auto& entry : fs::directory_iterator(directory)) {
-            if (entry.is_regular_file()) {
-                std::string filename = entry.path().filename().string();
-                std::string extension = entry.path().extension().string();
-                
-                // Convert extension to lowercase for comparison
-                std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
-                
-                // Check if it's an image file and not a spritesheet
-                if ((extension == ".png" || extension == ".jpg" || extension == ".jpeg") &&
-                    filename.find("spritesheet") == std::string::npos) {
-                    frameFiles.push_back(entry.path().string());
-                }
-            }
-        }
-    } catch (const fs::filesystem_error& e) {
-        std::cerr << "Filesystem error: " << e.what() << std::endl;
-    }
-    
-    return frameFiles;
+    ClipSlot& slot = clips[static_cast<size_t>(state)];
+    slot.frameCount = static_cast<int32_t>(clip->getFrameCount());
+    slot.frameDuration = frameTime;
+    slot.clip = std::move(clip);
+    return true;
 }
 
 void Animation::update(float deltaTime) {
-    if (!isPlaying || !hasAnimation(currentState)) {
-        return;
-    }
-    
-    const AnimationData& animData = animations[currentState];
-    if (animData.sprites.empty()) {
+    const ClipSlot& slot = getSlot(currentState);
+    if (slot.frameCount == 0) {
         return;
     }
     
-    currentTime += deltaTime;
+    AnimationPlayback::step(currentTime, currentFrame, isPlaying, deltaTime, slot.frameDuration, slot.frameCount,
+                            shouldLoop);
     
     // Debug animation timing
-    static int debugCounter = 0;
-    if (debugCounter++ % 60 == 0) {
-        std::cout << "Animation timing: currentTime=" << currentTime 
-                  << ", frameTime=" << frameTime 
-                  << ", currentFrame=" << currentFrame 
-                  << ", totalFrames=" << animData.sprites.size() << std::endl;
-    }
-    
-    if (currentTime >= frameTime) {
-        currentTime = 0.0f;
-        currentFrame++;
-        
-        if (currentFrame >= static_cast<int>(animData.sprites.size())) {
-            if (shouldLoop) {
-                currentFrame = 0;
-            } else {
-                currentFrame = static_cast<int>(animData.sprites.size()) - 1;
-                isPlaying = false;
-            }
+    if (GAME_TRACE_ENABLED(Animation)) {
+        static int debugCounter = 0;
+        if (debugCounter++ % 60 == 0) {
+            GAME_TRACE(Animation, "Animation timing: currentTime=" << currentTime 
+                       << ", frameTime=" << slot.frameDuration 
+                       << ", currentFrame=" << currentFrame 
+                       << ", totalFrames=" << slot.frameCount);
         }
-        
-        // Debug frame change
-        std::cout << "Switching to frame " << currentFrame << std::endl;
     }
 }
 
+void Animation::setFrameTime(float time) {
+    frameTime = std::max(time, AnimationPlayback::MIN_FRAME_TIME);
+    for (auto& slot : clips) {
+        slot.frameDuration = frameTime;
+    }
+}
+
+void Animation::setFrameTime(AnimationState state, float time) {
+    clips[static_cast<size_t>(state)].frameDuration = std::max(time, AnimationPlayback::MIN_FRAME_TIME);
+}
+
 void Animation::setState(AnimationState newState) {
     if (newState != currentState) {
         switchToState(newState);
@@ -167,47 +84,30 @@ void Animation::switchToState(AnimationState newState) {
     currentTime = 0.0f;
     isPlaying = true;
     
-    // Set appropriate loop settings for different animation types
-    switch (newState) {
-        case AnimationState::Idle:
-        case AnimationState::Walking:
-            shouldLoop = true;
-            break;
-        case AnimationState::Jumping:
-        case AnimationState::Attack:
-        case AnimationState::GetHit:
-        case AnimationState::Die:
-            shouldLoop = false;
-            break;
-    }
+    shouldLoop = AnimationPlayback::loopsByDefault(newState);
 }
 
 const sf::Sprite& Animation::getCurrentSprite() const {
-    if (!hasAnimation(currentState)) {
-        return *emptySprite;
-    }
-    
-    const AnimationData& animData = animations.at(currentState);
-    if (animData.sprites.empty()) {
-        return *emptySprite;
-    }
-    
-    int frameIndex = std::min(currentFrame, static_cast<int>(animData.sprites.size()) - 1);
-    return *animData.sprites[frameIndex];
+    const ClipSlot& slot = getSlot(currentState);
+    if (slot.frameCount == 0) {
+        sprite->setTexture(AnimationClipCache::instance().getFallbackTexture(), true);
+        sprite->setOrigin(origin);
+        return *sprite;
+    }
+    
+    const size_t frameIndex = static_cast<size_t>(std::clamp(currentFrame, 0, slot.frameCount - 1));
+    sprite->setTexture(slot.clip->getFrameTexture(frameIndex));
+    sprite->setTextureRect(slot.clip->getFrameRect(frameIndex));
+    sprite->setOrigin(origin - sf::Vector2f(slot.clip->getFrameOffset(frameIndex)));
+    return *sprite;
 }
 
 bool Animation::hasAnimation(AnimationState state) const {
-    auto it = animations.find(state);
-    return it != animations.end() && it->second.isLoaded && !it->second.sprites.empty();
+    return getSlot(state).frameCount > 0;
 }
 
 void Animation::setScale(float scaleX, float scaleY) {
-    for (auto& [state, animData] : animations) {
-        for (auto& sprite : animData.sprites) {
-            sprite->setScale(sf::Vector2f(scaleX, scaleY));
-        }
-    }
-    emptySprite->setScale(sf::Vector2f(scaleX, scaleY));
+    sprite->setScale(sf::Vector2f(scaleX, scaleY));
 }
 
 void Animation::reset() {
@@ -221,28 +121,10 @@ bool Animation::isFinished() const {
         return false;
     }
     
-    const AnimationData& animData = animations.at(currentState);
-    return currentFrame >= static_cast<int>(animData.sprites.size()) - 1 && !isPlaying;
-}
-
-void Animation::setOrigin(const sf::Vector2f& origin) {
-    spriteOrigin = origin;
-    
-    // Apply origin to empty sprite
-    if (emptySprite) {
-        emptySprite->setOrigin(origin);
-    }
-    
-    // Apply origin to all loaded animation sprites
-    for (auto& [state, animData] : animations) {
-        for (auto& sprite : animData.sprites) {
-            if (sprite) {
-                sprite->setOrigin(origin);
-            }
-        }
-    }
+    return currentFrame >= getSlot(currentState).frameCount - 1 && !isPlaying;
 }
 
-void Animation::applyOriginToSprite(sf::Sprite& sprite) const {
-    sprite.setOrigin(spriteOrigin);
-} 
\ No newline at end of file
+void Animation::setOrigin(const sf::Vector2f& newOrigin) {
+    origin = newOrigin;
+    sprite->setOrigin(origin);
+}
\ No newline at end of file
@@ -0,0 +1,421 @@
+#include "AnimationClip.hpp"
+#include "AssetPack.hpp"
+#include "AllocationTracker.hpp"
+#include "FileWatcher.hpp"
+#include "ImageCodec.hpp"
+#include "JsonValue.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Smallest rect holding every pixel that isn't fully transparent; a blank
+// image keeps its top-left pixel so it still has a region
+sf::IntRect opaqueBounds(const sf::Image& image) {
+    const sf::Vector2u size = image.getSize();
+    const uint8_t* pixels = image.getPixelsPtr();
+    unsigned left = size.x, top = size.y, right = 0, bottom = 0;
+    for (unsigned y = 0; y < size.y; ++y) {
+        const uint8_t* row = pixels + static_cast<size_t>(y) * size.x * 4;
+        for (unsigned x = 0; x < size.x; ++x) {
+            if (row[x * 4 + 3] != 0) {
+                left = std::min(left, x);
+                right = std::max(right, x + 1);
+                top = std::min(top, y);
+                bottom = y + 1;
+            }
+        }
+    }
+    if (right == 0) {
+        return sf::IntRect({0, 0}, {1, 1});
+    }
+    return sf::IntRect(sf::Vector2i(static_cast<int>(left), static_cast<int>(top)),
+                       sf::Vector2i(static_cast<int>(right - left), static_cast<int>(bottom - top)));
+}
+
+sf::Image crop(const sf::Image& image, const sf::IntRect& rect) {
+    const size_t sourceStride = static_cast<size_t>(image.getSize().x) * 4;
+    const size_t stride = static_cast<size_t>(rect.size.x) * 4;
+    std::vector<uint8_t> pixels(stride * rect.size.y);
+    const uint8_t* source = image.getPixelsPtr() + rect.position.y * sourceStride + rect.position.x * 4;
+    for (int y = 0; y < rect.size.y; ++y) {
+        std::memcpy(pixels.data() + y * stride, source + y * sourceStride, stride);
+    }
+    return sf::Image(sf::Vector2u(rect.size), pixels.data());
+}
+
+uint64_t hashImage(const sf::Image& image) {
+    // FNV-1a over the size and pixels
+    const sf::Vector2u size = image.getSize();
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&](const void* data, size_t bytes) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < bytes; ++i) {
+            hash ^= p[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(&size.x, sizeof(size.x));
+    mix(&size.y, sizeof(size.y));
+    mix(image.getPixelsPtr(), static_cast<size_t>(size.x) * size.y * 4);
+    return hash;
+}
+
+bool samePixels(const sf::Image& a, const sf::Image& b) {
+    return a.getSize() == b.getSize() &&
+           std::memcmp(a.getPixelsPtr(), b.getPixelsPtr(), static_cast<size_t>(a.getSize().x) * a.getSize().y * 4) == 0;
+}
+
+} // namespace
+
+AnimationClipCache& AnimationClipCache::instance() {
+    static AnimationClipCache cache;
+    return cache;
+}
+
+std::shared_ptr<const AnimationClip> AnimationClipCache::load(const std::string& directory) {
+    // "a/b/" and "a/./b" name the same clip; for "sheet.json#clip" only the sidecar path is normalised
+    const size_t separator = directory.find('#');
+    const std::string path = directory.substr(0, separator);
+    std::string key = fs::path(path).lexically_normal().generic_string();
+    if (separator != std::string::npos) {
+        key += directory.substr(separator);
+    }
+
+    AllocationTracker::ScopedTag memoryTag(AllocationTracker::Tag::Animation);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = clips.find(key);
+    if (it != clips.end()) {
+        return it->second;
+    }
+
+    if (separator != std::string::npos) {
+        // One decode of the sheet caches every clip it holds
+        loadSheet(key.substr(0, key.find('#')));
+        it = clips.find(key);
+        if (it != clips.end()) {
+            return it->second;
+        }
+        std::cerr << "No clip named " << directory.substr(separator + 1) << " in spritesheet " << path << std::endl;
+        clips.emplace(key, nullptr);
+        return nullptr;
+    }
+
+    auto clip = loadClip(directory);
+    clips.emplace(key, clip);
+    return clip;
+}
+
+std::shared_ptr<AnimationClip> AnimationClipCache::loadClip(const std::string& directory) {
+    if (!AssetPack::instance().hasDirectory(directory) && (!fs::exists(directory) || !fs::is_directory(directory))) {
+        std::cerr << "Animation directory does not exist: " << directory << std::endl;
+        return nullptr;
+    }
+
+    std::vector<std::string> frameFiles = getFrameFiles(directory);
+    if (frameFiles.empty()) {
+        std::cerr << "No frame files found in directory: " << directory << std::endl;
+        return nullptr;
+    }
+
+    // Sort files to ensure correct frame order
+    std::sort(frameFiles.begin(), frameFiles.end());
+
+    auto clip = std::make_shared<AnimationClip>();
+    clip->directory = directory;
+
+    // Trim each frame to its visible pixels and pack every distinct result once;
+    // identical frames (held poses, padded loops) point at the same region
+    std::vector<int> frameRegions;
+    std::vector<sf::Image> packed; // By region id, for comparing hash matches
+    std::unordered_multimap<uint64_t, int> regionsByHash;
+    size_t sourcePixels = 0, packedPixels = 0;
+    for (const auto& filename : frameFiles) {
+        sf::Image image;
+        if (!TextureAtlas::loadImage(filename, image)) {
+            std::cerr << "Failed to load texture: " << filename << std::endl;
+            continue;
+        }
+        const sf::IntRect bounds = opaqueBounds(image);
+        sf::Image trimmed = crop(image, bounds);
+        sourcePixels += static_cast<size_t>(image.getSize().x) * image.getSize().y;
+
+        const uint64_t hash = hashImage(trimmed);
+        int region = -1;
+        for (auto [it, end] = regionsByHash.equal_range(hash); it != end && region < 0; ++it) {
+            if (samePixels(packed[it->second], trimmed)) {
+                region = it->second;
+            }
+        }
+        if (region < 0) {
+            packedPixels += static_cast<size_t>(bounds.size.x) * bounds.size.y;
+            packed.push_back(trimmed);
+            region = clip->atlas.add(std::move(trimmed));
+            regionsByHash.emplace(hash, region);
+        }
+        frameRegions.push_back(region);
+        clip->trims.push_back(AnimationClip::Trim{bounds.position, image.getSize()});
+        clip->frameFiles.push_back(filename);
+    }
+
+    if (frameRegions.empty() || !clip->atlas.build()) {
+        return nullptr;
+    }
+
+    for (int region : frameRegions) {
+        clip->frames.push_back(clip->atlas.getRegion(region));
+    }
+
+    std::cout << "Packed " << frameRegions.size() << " frames of '" << directory << "' as " << packed.size()
+              << " distinct, trimmed to " << (sourcePixels ? packedPixels * 100 / sourcePixels : 0)
+              << "% of their pixels" << std::endl;
+    std::cout << "Cached animation clip '" << directory << "' with " << clip->frames.size() << " frames" << std::endl;
+    return clip;
+}
+
+void AnimationClipCache::loadSheet(const std::string& sidecar) {
+    // Prefer the mounted asset pack; loose files are the dev fallback
+    std::string text;
+    if (AssetPack::Blob blob = AssetPack::instance().find(sidecar)) {
+        text.assign(blob.data, blob.size);
+    } else {
+        std::ifstream file(sidecar, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Spritesheet sidecar does not exist: " << sidecar << std::endl;
+            return;
+        }
+        text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    JsonValue root;
+    std::string error;
+    if (!JsonValue::parse(text, root, error) || !root.isObject()) {
+        std::cerr << "Invalid spritesheet sidecar " << sidecar << ": "
+                  << (error.empty() ? "root is not an object" : error) << std::endl;
+        return;
+    }
+
+    // The image path is relative to the sidecar
+    const std::string image = (fs::path(sidecar).parent_path() / root["image"].asString()).lexically_normal().generic_string();
+    auto texture = std::make_shared<sf::Texture>();
+    sf::Image pixels;
+    if (!ImageCodec::load(image, pixels) || !texture->loadFromImage(pixels)) {
+        std::cerr << "Failed to load spritesheet: " << image << std::endl;
+        return;
+    }
+    sheets[image] = texture;
+
+    const int frameWidth = static_cast<int>(root["frame_width"].asNumber());
+    const int frameHeight = static_cast<int>(root["frame_height"].asNumber());
+    const int columns = frameWidth > 0 ? static_cast<int>(texture->getSize().x) / frameWidth : 0;
+    const int rows = frameHeight > 0 ? static_cast<int>(texture->getSize().y) / frameHeight : 0;
+    if (columns == 0 || rows == 0) {
+        std::cerr << "Spritesheet " << image << " has no whole " << frameWidth << "x" << frameHeight << " frames" << std::endl;
+        return;
+    }
+
+    size_t clipCount = 0;
+    for (const auto& [name, spec] : root["clips"].getMembers()) {
+        const int first = static_cast<int>(spec["first"].asNumber(-1));
+        const int count = static_cast<int>(spec["count"].asNumber());
+        if (first < 0 || count <= 0 || first + count > columns * rows) {
+            std::cerr << "Skipping clip " << name << " of " << sidecar << ": frames out of range" << std::endl;
+            continue;
+        }
+
+        auto clip = std::make_shared<AnimationClip>();
+        clip->directory = sidecar + "#" + name;
+        clip->sheet = texture;
+        for (int frame = first; frame < first + count; ++frame) {
+            TextureAtlas::Region region;
+            region.rect = sf::IntRect(sf::Vector2i((frame % columns) * frameWidth, (frame / columns) * frameHeight),
+                                      sf::Vector2i(frameWidth, frameHeight));
+            clip->frames.push_back(region);
+        }
+        clips[clip->directory] = std::move(clip);
+        ++clipCount;
+    }
+
+    std::cout << "Cached spritesheet '" << sidecar << "' with " << clipCount << " clips" << std::endl;
+}
+
+std::vector<std::string> AnimationClipCache::getFrameFiles(const std::string& directory) {
+    std::vector<std::string> frameFiles;
+
+    // Packed directories are listed from the pack index
+    const AssetPack& pack = AssetPack::instance();
+    if (pack.hasDirectory(directory)) {
+        for (auto& name : pack.listDirectory(directory)) {
+            AssetPack::Format format = AssetPack::formatFromExtension(name);
+            if ((format == AssetPack::Format::Png || format == AssetPack::Format::Jpeg) &&
+                fs::path(name).filename().string().find("spritesheet") == std::string::npos) {
+                frameFiles.push_back(std::move(name));
+            }
+        }
+        return frameFiles;
+    }
+
+    // Error codes rather than filesystem_error: a missing directory is an expected miss
+    std::error_code ec;
+    for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec)) {
+            std::string filename = it->path().filename().string();
+            std::string extension = it->path().extension().string();
+
+            // Convert extension to lowercase for comparison
+            std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+            // Check if it's an image file and not a spritesheet
+            if ((extension == ".png" || extension == ".jpg" || extension == ".jpeg") &&
+                filename.find("spritesheet") == std::string::npos) {
+                frameFiles.push_back(it->path().string());
+            }
+        }
+    }
+    if (ec) {
+        std::cerr << "Filesystem error: " << directory << ": " << ec.message() << std::endl;
+    }
+
+    return frameFiles;
+}
+
+const sf::Texture& AnimationClipCache::getFallbackTexture() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!fallbackTexture) {
+        fallbackTexture = std::make_unique<sf::Texture>();
+
+        // Try to load a placeholder texture first
+        sf::Image image;
+        if (!ImageCodec::load("assets/images/characters/player.png", image) || !fallbackTexture->loadFromImage(image)) {
+            // If that fails, we'll just use an uninitialized texture
+            // The sprite will be invisible but won't crash
+            std::cerr << "Warning: Could not load placeholder texture for animation" << std::endl;
+        }
+    }
+    return *fallbackTexture;
+}
+
+size_t AnimationClipCache::getClipCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::count_if(clips.begin(), clips.end(), [](const auto& entry) { return entry.second != nullptr; });
+}
+
+size_t AnimationClipCache::getFrameCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = 0;
+    for (const auto& [key, clip] : clips) {
+        if (clip && !clip->sheet) {
+            count += clip->frames.size();
+        }
+    }
+    return count;
+}
+
+size_t AnimationClipCache::getDuplicateFrameCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = 0;
+    for (const auto& [key, clip] : clips) {
+        if (clip && !clip->sheet) {
+            count += clip->frames.size() - clip->atlas.getRegionCount();
+        }
+    }
+    return count;
+}
+
+size_t AnimationClipCache::getTextureCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = 0;
+    std::unordered_set<const sf::Texture*> sheets; // Shared by all clips of a sheet
+    for (const auto& [key, clip] : clips) {
+        if (clip && clip->sheet) {
+            sheets.insert(clip->sheet.get());
+        } else if (clip) {
+            count += clip->atlas.getPageCount();
+        }
+    }
+    return count + sheets.size();
+}
+
+size_t AnimationClipCache::getTextureBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t bytes = 0;
+    std::unordered_set<const sf::Texture*> sheets;
+    for (const auto& [key, clip] : clips) {
+        if (clip && clip->sheet) {
+            if (sheets.insert(clip->sheet.get()).second) {
+                const sf::Vector2u size = clip->sheet->getSize();
+                bytes += static_cast<size_t>(size.x) * size.y * 4;
+            }
+        } else if (clip) {
+            bytes += clip->atlas.getResidentBytes();
+        }
+    }
+    return bytes;
+}
+
+size_t AnimationClipCache::reloadFile(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    sf::Image image;
+    bool decoded = false;
+    auto decode = [&]() {
+        if (!decoded) {
+            decoded = image.loadFromFile(path);
+        }
+        return decoded;
+    };
+
+    size_t updated = 0;
+    for (const auto& [key, clip] : clips) {
+        if (!clip) continue;
+        for (size_t i = 0; i < clip->frameFiles.size(); ++i) {
+            if (!FileWatcher::isSameFile(clip->frameFiles[i], path)) continue;
+            // The new pixels must fit the packed rect: same image size, nothing drawn outside the old trim
+            const AnimationClip::Trim& trim = clip->trims[i];
+            const sf::IntRect rect(trim.offset, clip->frames[i].rect.size);
+            const sf::IntRect bounds = decode() ? opaqueBounds(image) : sf::IntRect();
+            const sf::Vector2i boundsEnd = bounds.position + bounds.size;
+            const sf::Vector2i rectEnd = rect.position + rect.size;
+            if (!decoded || image.getSize() != trim.sourceSize || bounds.position.x < rect.position.x ||
+                bounds.position.y < rect.position.y || boundsEnd.x > rectEnd.x || boundsEnd.y > rectEnd.y) {
+                std::cerr << "Could not reload frame " << path << " of " << clip->directory
+                          << " (unreadable, resized or drawn outside its trimmed rect)" << std::endl;
+                continue;
+            }
+            // A deduplicated region is also shown by frames from other files
+            const bool shared = std::any_of(clip->frames.begin(), clip->frames.end(), [&](const auto& frame) {
+                return &frame != &clip->frames[i] && frame.page == clip->frames[i].page &&
+                       frame.rect == clip->frames[i].rect &&
+                       !FileWatcher::isSameFile(clip->frameFiles[&frame - clip->frames.data()], path);
+            });
+            if (shared) {
+                std::cerr << "Could not reload frame " << path << " of " << clip->directory
+                          << " (its pixels are shared with an identical frame)" << std::endl;
+            } else if (clip->atlas.updateRegion(clip->frames[i], crop(image, rect))) {
+                updated++;
+            }
+        }
+    }
+    for (const auto& [imagePath, texture] : sheets) {
+        if (!FileWatcher::isSameFile(imagePath, path)) continue;
+        if (decode() && image.getSize() == texture->getSize()) {
+            texture->update(image);
+            updated++;
+        } else {
+            std::cerr << "Could not reload spritesheet " << path << " (unreadable or resized)" << std::endl;
+        }
+    }
+    return updated;
+}
+
+void AnimationClipCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    clips.clear();
+    sheets.clear();
+}
@@ -0,0 +1,195 @@
+#include "AnimationSystem.hpp"
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+
+AnimationSystem::ClipSet AnimationSystem::createClipSet(float frameTime) {
+    ClipArray clips;
+    for (auto& clip : clips) {
+        clip.frameDuration = std::max(frameTime, AnimationPlayback::MIN_FRAME_TIME);
+    }
+    clipSets.push_back(std::move(clips));
+    return static_cast<ClipSet>(clipSets.size() - 1);
+}
+
+bool AnimationSystem::loadClip(ClipSet set, AnimationState state, const std::string& directory) {
+    // Decoded once per process; every clip set naming the directory shares it
+    std::shared_ptr<const AnimationClip> clip = AnimationClipCache::instance().load(directory);
+    if (!clip || clip->getFrameCount() == 0) {
+        return false;
+    }
+
+    Clip& slot = clipSets[set][static_cast<size_t>(state)];
+    slot.frameCount = static_cast<int32_t>(clip->getFrameCount());
+    slot.clip = std::move(clip);
+    return true;
+}
+
+uint32_t AnimationSystem::add(ClipSet set, AnimationState state, Playback playback) {
+    const uint32_t index = static_cast<uint32_t>(size());
+    time.push_back(0.0f);
+    frameDuration.push_back(0.0f);
+    timeScale.push_back(1.0f);
+    frame.push_back(0);
+    frameCount.push_back(1);
+    playing.push_back(0);
+    loop.push_back(0);
+    frameChanged.push_back(0);
+    clocked.push_back(playback == Playback::Clocked);
+    startTime.push_back(clock);
+    clipSetOf.push_back(set);
+    states.push_back(state);
+    framePages.push_back(nullptr);
+    frameRects.push_back(sf::IntRect());
+    frameOffsets.push_back(sf::Vector2i());
+    start(index, state);
+    return index;
+}
+
+void AnimationSystem::remove(uint32_t index) {
+    const size_t last = size() - 1;
+    if (index != last) {
+        time[index] = time[last];
+        frameDuration[index] = frameDuration[last];
+        timeScale[index] = timeScale[last];
+        frame[index] = frame[last];
+        frameCount[index] = frameCount[last];
+        playing[index] = playing[last];
+        loop[index] = loop[last];
+        frameChanged[index] = frameChanged[last];
+        clocked[index] = clocked[last];
+        startTime[index] = startTime[last];
+        clipSetOf[index] = clipSetOf[last];
+        states[index] = states[last];
+        framePages[index] = framePages[last];
+        frameRects[index] = frameRects[last];
+        frameOffsets[index] = frameOffsets[last];
+    }
+    time.pop_back();
+    frameDuration.pop_back();
+    timeScale.pop_back();
+    frame.pop_back();
+    frameCount.pop_back();
+    playing.pop_back();
+    loop.pop_back();
+    frameChanged.pop_back();
+    clocked.pop_back();
+    startTime.pop_back();
+    clipSetOf.pop_back();
+    states.pop_back();
+    framePages.pop_back();
+    frameRects.pop_back();
+    frameOffsets.pop_back();
+    changed.clear(); // Indices in it may have moved
+}
+
+void AnimationSystem::clear() {
+    time.clear();
+    frameDuration.clear();
+    timeScale.clear();
+    frame.clear();
+    frameCount.clear();
+    playing.clear();
+    loop.clear();
+    frameChanged.clear();
+    clocked.clear();
+    startTime.clear();
+    clipSetOf.clear();
+    states.clear();
+    framePages.clear();
+    frameRects.clear();
+    frameOffsets.clear();
+    changed.clear();
+}
+
+void AnimationSystem::setState(uint32_t index, AnimationState state) {
+    if (states[index] != state) {
+        start(index, state);
+    }
+}
+
+void AnimationSystem::start(uint32_t index, AnimationState state) {
+    const Clip& clip = clipSets[clipSetOf[index]][static_cast<size_t>(state)];
+    states[index] = state;
+    time[index] = 0.0f;
+    frame[index] = 0;
+    frameDuration[index] = clip.frameDuration;
+    // A state with no clip shows one still frame, so the step never divides by a zero count
+    frameCount[index] = std::max(clip.frameCount, 1);
+    playing[index] = clip.frameCount > 0;
+    loop[index] = AnimationPlayback::loopsByDefault(state);
+    startTime[index] = clock;
+    refreshFrame(index);
+}
+
+bool AnimationSystem::isFinished(uint32_t index) const {
+    if (clocked[index]) {
+        return !loop[index] && (!playing[index] || AnimationPlayback::finishedAt(clock - startTime[index],
+                                                                                  frameDuration[index],
+                                                                                  frameCount[index], false));
+    }
+    return !loop[index] && !playing[index] && frame[index] >= frameCount[index] - 1;
+}
+
+void AnimationSystem::update(float deltaTime, JobSystem* jobs) {
+    PROFILE_ZONE("AnimationSystem::update");
+    clock += deltaTime;
+
+    // Every instance only touches its own entries, so chunks can run anywhere
+    auto stepRange = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (clocked[i]) {
+                frameChanged[i] = 0;
+                continue;
+            }
+            const int32_t before = frame[i];
+            AnimationPlayback::step(time[i], frame[i], playing[i], deltaTime * timeScale[i], frameDuration[i],
+                                    frameCount[i], loop[i] != 0);
+            frameChanged[i] = frame[i] != before;
+        }
+    };
+    if (jobs) {
+        jobs->parallelFor(size(), UPDATE_GRAIN, stepRange);
+    } else {
+        stepRange(0, size());
+    }
+
+    // Most frames hold for several updates; only the ones that moved need new rects
+    changed.clear();
+    for (size_t i = 0; i < size(); ++i) {
+        if (frameChanged[i]) {
+            changed.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    for (uint32_t index : changed) {
+        refreshFrame(index);
+    }
+}
+
+void AnimationSystem::evaluate(uint32_t index) {
+    // A state without a clip never plays, and stays on its still frame
+    if (!clocked[index] || !playing[index]) {
+        return;
+    }
+    const int32_t current = AnimationPlayback::frameAt(clock - startTime[index], frameDuration[index],
+                                                       frameCount[index], loop[index] != 0);
+    if (current != frame[index]) {
+        frame[index] = current;
+        refreshFrame(index);
+    }
+}
+
+void AnimationSystem::refreshFrame(uint32_t index) {
+    const Clip& clip = clipSets[clipSetOf[index]][static_cast<size_t>(states[index])];
+    if (clip.frameCount == 0) {
+        const sf::Texture& fallback = AnimationClipCache::instance().getFallbackTexture();
+        framePages[index] = &fallback;
+        frameRects[index] = sf::IntRect(sf::Vector2i(0, 0), sf::Vector2i(fallback.getSize()));
+        frameOffsets[index] = sf::Vector2i();
+        return;
+    }
+    const size_t frameIndex = static_cast<size_t>(frame[index]);
+    framePages[index] = &clip.clip->getFrameTexture(frameIndex);
+    frameRects[index] = clip.clip->getFrameRect(frameIndex);
+    frameOffsets[index] = clip.clip->getFrameOffset(frameIndex);
+}
@@ -0,0 +1,364 @@
+#include "AssetBrowser.hpp"
+#include "AssetManager.hpp"
+#include "AssetManifest.hpp"
+#include "imgui.h"
+#include "imgui-SFML.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+void AssetBrowser::draw(bool* open) {
+    // Scan the asset root whenever the window is (re)opened
+    if (!scanned) {
+        scanDirectory("assets");
+        scanned = true;
+    }
+    collectScanResults();
+    
+    // Thumbnails decoded since last frame, and the preview once it has loaded
+    thumbnails.update();
+    if (thumbnails.takePreview(previewImage)) {
+        previewLoading = false;
+        previewAvailable = previewTexture.loadFromImage(previewImage);
+        previewImage = sf::Image(); // The texture has it now
+    }
+
+    if (ImGui::Begin("Asset Manager", open)) {
+        // Scan button to refresh the asset list
+        if (ImGui::Button("Scan Assets")) {
+            scanDirectory("assets");
+        }
+        
+        ImGui::SameLine();
+        
+        // Help tooltip
+        ImGui::TextDisabled("(?)");
+        if (ImGui::IsItemHovered()) {
+            ImGui::BeginTooltip();
+            ImGui::PushTextWrapPos(ImGui::GetFontSize() * 35.0f);
+            ImGui::TextUnformatted("Click to scan the assets directory for all files.\nDirectory contents are shown with [DIR] prefix.\nImage files are shown with  prefix.");
+            ImGui::PopTextWrapPos();
+            ImGui::EndTooltip();
+        }
+        
+        ImGui::Separator();
+        
+        // Split window into two columns - left for list, right for preview
+        ImGui::Columns(2, "assetColumns");
+        
+        // First column - Asset list
+        const size_t shown = search.getView().size();
+        if (assetIndex.isScanning()) {
+            ImGui::Text("Assets (%zu of %zu shown, scanning...)", shown, imageAssets.size());
+        } else {
+            ImGui::Text("Assets (%zu of %zu shown, %zu from index, %zu probed)", shown, imageAssets.size(),
+                        assetIndex.getReusedCount(), assetIndex.getProbedCount());
+        }
+        const ThumbnailCache::Stats& thumbnailStats = thumbnails.getStats();
+        ImGui::TextDisabled("Thumbnails: %zu resident, %zu queued, %zu evicted (%.0f MB budget)",
+                            thumbnailStats.resident, thumbnailStats.queued, thumbnailStats.evictions,
+                            thumbnails.getBudgetBytes() / (1024.0 * 1024.0));
+        ImGui::SetNextItemWidth(-FLT_MIN);
+        ImGui::InputTextWithHint("##AssetFilter", "Filter by name", filterText, sizeof(filterText));
+        search.setQuery(filterText);
+        ImGui::BeginChild("AssetList", ImVec2(0, 0), true);
+        
+        const ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY |
+                                      ImGuiTableFlags_SizingStretchProp;
+        if (ImGui::BeginTable("AssetTable", 3, flags)) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_DefaultSort, 4.0f,
+                                    static_cast<ImGuiID>(AssetSearchIndex::SortKey::Name));
+            ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_PreferSortDescending, 1.0f,
+                                    static_cast<ImGuiID>(AssetSearchIndex::SortKey::Size));
+            ImGui::TableSetupColumn("Dimensions", ImGuiTableColumnFlags_PreferSortDescending, 1.0f,
+                                    static_cast<ImGuiID>(AssetSearchIndex::SortKey::Dimensions));
+            ImGui::TableHeadersRow();
+            if (ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs()) {
+                if (sortSpecs->SpecsDirty && sortSpecs->SpecsCount > 0) {
+                    const ImGuiTableColumnSortSpecs& spec = sortSpecs->Specs[0];
+                    search.setSort(static_cast<AssetSearchIndex::SortKey>(spec.ColumnUserID),
+                                   spec.SortDirection != ImGuiSortDirection_Descending);
+                }
+                sortSpecs->SpecsDirty = false;
+            }
+            
+            // Only the rows in view are laid out, and only they ask for thumbnails
+            const std::vector<uint32_t>& view = search.getView();
+            const float rowHeight = THUMBNAIL_ROW_HEIGHT + ImGui::GetStyle().CellPadding.y * 2.0f;
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(view.size()), rowHeight);
+            while (clipper.Step()) {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                    ImageAssetInfo& asset = imageAssets[view[row]];
+                    
+                    // Display file name and status
+                    std::string label = asset.name;
+                    bool isImage = asset.name.find(" prefix.") != std::string::npos;
+                    bool isDir = asset.name.find("[DIR]") != std::string::npos;
+                    
+                    if (isImage && asset.isLoaded) {
+                        label += " [Loaded]";
+                    }
+                    
+                    ImGui::TableNextRow(ImGuiTableRowFlags_None, THUMBNAIL_ROW_HEIGHT);
+                    ImGui::TableNextColumn();
+                    
+                    // Thumbnail; empty until the cache has it
+                    ImGui::PushID(static_cast<int>(view[row]));
+                    const ThumbnailCache::Thumbnail* thumbnail = isImage ? thumbnails.get(asset.path) : nullptr;
+                    if (thumbnail) {
+                        const sf::Vector2f pageSize(thumbnail->page->getSize());
+                        const sf::IntRect& rect = thumbnail->rect;
+                        const float scale = THUMBNAIL_ROW_HEIGHT / static_cast<float>(std::max(rect.size.x, rect.size.y));
+                        ImGui::Image(thumbnail->page->getNativeHandle(), ImVec2(rect.size.x * scale, rect.size.y * scale),
+                                     ImVec2(rect.position.x / pageSize.x, rect.position.y / pageSize.y),
+                                     ImVec2((rect.position.x + rect.size.x) / pageSize.x,
+                                            (rect.position.y + rect.size.y) / pageSize.y));
+                    } else {
+                        ImGui::Dummy(ImVec2(THUMBNAIL_ROW_HEIGHT, THUMBNAIL_ROW_HEIGHT));
+                    }
+                    ImGui::SameLine(THUMBNAIL_ROW_HEIGHT + ImGui::GetStyle().ItemSpacing.x * 2.0f);
+                    
+                    // Set colors based on type
+                    if (isDir) {
+                        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.5f, 0.8f, 1.0f, 1.0f)); // Blue for directories
+                    } else if (isImage) {
+                        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.5f, 1.0f, 0.5f, 1.0f)); // Green for images
+                    } else {
+                        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 1.0f, 1.0f)); // White for other files
+                    }
+                    
+                    // Selectable item with highlight
+                    if (ImGui::Selectable(label.c_str(), selectedAsset == &asset, ImGuiSelectableFlags_SpanAllColumns,
+                                          ImVec2(0, THUMBNAIL_ROW_HEIGHT))) {
+                        selectedAsset = &asset;
+                        
+                        // The full-resolution image loads in the background (only for images)
+                        previewAvailable = false;
+                        previewLoading = isImage && asset.isLoaded;
+                        if (previewLoading) {
+                            thumbnails.requestPreview(asset.path);
+                        }
+                    }
+                    
+                    ImGui::PopStyleColor();
+                    
+                    ImGui::TableNextColumn();
+                    if (!isDir) {
+                        ImGui::Text("%.1f KB", static_cast<float>(asset.fileSize) / 1024.0f);
+                    }
+                    ImGui::TableNextColumn();
+                    if (isImage) {
+                        ImGui::Text("%ux%u", asset.dimensions.x, asset.dimensions.y);
+                    }
+                    ImGui::PopID();
+                }
+            }
+            ImGui::EndTable();
+        }
+        
+        ImGui::EndChild();
+        
+        // Second column - Asset details and preview
+        ImGui::NextColumn();
+        
+        if (selectedAsset) {
+            // Show asset details
+            ImGui::Text("File: %s", selectedAsset->name.c_str());
+            ImGui::Text("Path: %s", selectedAsset->path.c_str());
+            
+            bool isImage = selectedAsset->name.find(" prefix.") != std::string::npos;
+            bool isDir = selectedAsset->name.find("[DIR]") != std::string::npos;
+            
+            if (isDir) {
+                ImGui::Text("Type: Directory");
+                
+                // Add a button to navigate into this directory
+                if (ImGui::Button("Open Directory")) {
+                    scanDirectory(selectedAsset->path);
+                }
+            } else {
+                ImGui::Text("Type: %s", isImage ? "Image" : "File");
+                
+                if (isImage) {
+                    ImGui::Text("Dimensions: %ux%u", selectedAsset->dimensions.x, selectedAsset->dimensions.y);
+                }
+                
+                // Format file size nicely (KB/MB)
+                float fileSizeKB = static_cast<float>(selectedAsset->fileSize) / 1024.0f;
+                if (fileSizeKB < 1024.0f) {
+                    ImGui::Text("File size: %.2f KB", fileSizeKB);
+                } else {
+                    ImGui::Text("File size: %.2f MB", fileSizeKB / 1024.0f);
+                }
+                
+                if (isImage) {
+                    ImGui::Text("Status: %s", selectedAsset->isLoaded ? "Loaded" : "Not loaded");
+                    
+                    if (selectedAsset->isLoaded) {
+                        ImGui::Text("Load time: %.2f ms", static_cast<float>(selectedAsset->loadTime.asMilliseconds()));
+                    }
+                }
+            }
+            
+            ImGui::Separator();
+            
+            // Show preview if available
+            if (isImage && previewAvailable) {
+                // Calculate preview size maintaining aspect ratio
+                float aspectRatio = static_cast<float>(previewTexture.getSize().x) / 
+                                   static_cast<float>(previewTexture.getSize().y);
+                
+                float maxWidth = ImGui::GetContentRegionAvail().x;
+                float maxHeight = 200.0f; // Maximum preview height
+                
+                float width = maxWidth;
+                float height = width / aspectRatio;
+                
+                if (height > maxHeight) {
+                    height = maxHeight;
+                    width = height * aspectRatio;
+                }
+                
+                // Display the texture
+                ImGui::Text("Preview:");
+                ImGui::Image(previewTexture.getNativeHandle(), ImVec2(width, height));
+                
+                // Add load button for images
+                if (ImGui::Button("Load into Game")) {
+                    // Example of loading into the asset manager
+                    std::string assetName = selectedAsset->name;
+                    // Remove  prefix and any file extension
+                    assetName = assetName.substr(assetName.find("]") + 2);
+                    assetName = assetName.substr(0, assetName.find_last_of('.'));
+                    std::string error;
+                    if (assets.tryLoadTexture(assetName, selectedAsset->path, AssetManager::TextureCategory::Other, error)) {
+                        ImGui::OpenPopup("AssetLoaded");
+                    } else {
+                        std::cerr << "Failed to load asset: " << error << std::endl;
+                        ImGui::OpenPopup("AssetLoadError");
+                    }
+                }
+                
+                // Asset loaded popup
+                if (ImGui::BeginPopupModal("AssetLoaded", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+                    ImGui::Text("Asset loaded successfully!");
+                    if (ImGui::Button("OK", ImVec2(120, 0))) {
+                        ImGui::CloseCurrentPopup();
+                    }
+                    ImGui::EndPopup();
+                }
+                
+                // Asset load error popup
+                if (ImGui::BeginPopupModal("AssetLoadError", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+                    ImGui::Text("Failed to load asset into game!");
+                    if (ImGui::Button("OK", ImVec2(120, 0))) {
+                        ImGui::CloseCurrentPopup();
+                    }
+                    ImGui::EndPopup();
+                }
+            } else if (isImage && previewLoading) {
+                ImGui::TextDisabled("Loading preview...");
+            } else if (isImage) {
+                ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Preview not available");
+            }
+        } else {
+            ImGui::TextDisabled("Select an asset to view details");
+        }
+        
+        ImGui::Columns(1);
+        
+        // Add a back button to navigate up a directory
+        if (ImGui::Button("Back to Parent Directory")) {
+            // Get current directory path
+            std::string currentPath = selectedAsset ? selectedAsset->path : "assets";
+            
+            // Navigate to parent directory
+            fs::path path(currentPath);
+            fs::path parent = path.parent_path();
+            
+            // Don't go above the assets directory
+            if (parent.filename().string() == "assets" || 
+                parent.filename().string() == "images" || 
+                parent.string().find("assets") != std::string::npos) {
+                scanDirectory(parent.string());
+            } else {
+                scanDirectory("assets");
+            }
+        }
+    }
+    ImGui::End();
+    
+    // If window is closed, scan again when it next opens
+    if (!*open) {
+        scanned = false;
+    }
+}
+
+// Scan asset directory recursively to find image files. The walk runs on the
+// asset index's thread; collectScanResults() adds entries as they arrive.
+void AssetBrowser::scanDirectory(const std::string& requested) {
+    const std::string directory = requested; // May point into imageAssets, cleared below
+    imageAssets.clear();
+    search.clear();
+    selectedAsset = nullptr;
+    previewAvailable = false;
+    previewLoading = false;
+    
+    // Check if the directory exists
+    std::error_code ec;
+    if (!fs::exists(directory, ec)) {
+        std::cerr << "Directory does not exist: " << directory << std::endl;
+        
+        // Fall back to the asset root resolved at startup
+        const std::string& root = AssetManifest::getRoot();
+        if (root != directory && fs::exists(root, ec)) {
+            assetIndex.scan(root);
+        }
+        return;
+    }
+    
+    assetIndex.scan(directory);
+}
+
+void AssetBrowser::collectScanResults() {
+    assetScanResults.clear();
+    if (assetIndex.takeResults(assetScanResults) == 0) {
+        return;
+    }
+    
+    // selectedAsset points into imageAssets, which may reallocate
+    const std::string selectedPath = selectedAsset ? selectedAsset->path : std::string();
+    
+    for (const auto& entry : assetScanResults) {
+        const std::string name = fs::path(entry.path).filename().string();
+        ImageAssetInfo info;
+        info.path = entry.path;
+        info.fileSize = static_cast<size_t>(entry.fileSize);
+        info.dimensions = entry.dimensions;
+        // Dimensions come from the image header; a zero size means it couldn't be read
+        info.isLoaded = entry.isImage && entry.dimensions.x > 0 && entry.dimensions.y > 0;
+        info.loadTime = sf::microseconds(static_cast<int64_t>(entry.probeMilliseconds * 1000.0f));
+        if (entry.isDirectory) {
+            info.name = "[DIR] " + name;
+        } else if (info.isLoaded) {
+            info.name = " prefix. " + name;
+        } else {
+            info.name = name;
+        }
+        const uint64_t pixels = static_cast<uint64_t>(info.dimensions.x) * info.dimensions.y;
+        search.add(name, entry.isDirectory, info.fileSize, pixels);
+        imageAssets.push_back(std::move(info));
+    }
+    
+    selectedAsset = nullptr;
+    for (auto& asset : imageAssets) {
+        if (!selectedPath.empty() && asset.path == selectedPath) {
+            selectedAsset = &asset;
+            break;
+        }
+    }
+}
@@ -0,0 +1,270 @@
+#include "AssetIndex.hpp"
+#include "AssetPack.hpp"
+#include "MappedFile.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t PUBLISH_BATCH = 64; // Entries per hand-over to the window
+
+uint32_t readBigEndian16(const unsigned char* p) { return (p[0] << 8) | p[1]; }
+uint32_t readBigEndian32(const unsigned char* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+uint32_t readLittleEndian16(const unsigned char* p) { return p[0] | (p[1] << 8); }
+int32_t readLittleEndian32(const unsigned char* p) {
+    return static_cast<int32_t>(p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24));
+}
+
+bool probeJpegSize(const unsigned char* data, size_t size, sf::Vector2u& out) {
+    // Walk the marker segments up to the first start-of-frame
+    size_t pos = 2;
+    while (pos + 9 < size) {
+        if (data[pos] != 0xFF) {
+            return false;
+        }
+        const unsigned char marker = data[pos + 1];
+        if (marker == 0xFF) {
+            ++pos; // Fill byte
+            continue;
+        }
+        const bool startOfFrame = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+        if (startOfFrame) {
+            out = sf::Vector2u(readBigEndian16(data + pos + 7), readBigEndian16(data + pos + 5));
+            return true;
+        }
+        pos += 2 + readBigEndian16(data + pos + 2);
+    }
+    return false;
+}
+
+std::string lowercaseExtension(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension;
+}
+
+} // namespace
+
+AssetIndex::AssetIndex(JobSystem& jobs, std::string indexPath) : jobs(jobs), indexPath(std::move(indexPath)) {
+    load();
+}
+
+AssetIndex::~AssetIndex() {
+    cancelled.store(true, std::memory_order_relaxed);
+    waitForJob();
+}
+
+void AssetIndex::waitForJob() {
+    std::unique_lock<std::mutex> lock(mutex);
+    jobDone.wait(lock, [this] { return !jobQueued; });
+}
+
+bool AssetIndex::isImageExtension(const std::string& extension) {
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp" ||
+           extension == ".tga";
+}
+
+bool AssetIndex::probeImageSize(const char* bytes, size_t size, const std::string& extension, sf::Vector2u& out) {
+    const auto* data = reinterpret_cast<const unsigned char*>(bytes);
+    static const unsigned char PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (size >= 24 && std::memcmp(data, PNG_SIGNATURE, 8) == 0) {
+        // IHDR is always the first chunk
+        out = sf::Vector2u(readBigEndian32(data + 16), readBigEndian32(data + 20));
+        return true;
+    }
+    if (size >= 4 && data[0] == 0xFF && data[1] == 0xD8) {
+        return probeJpegSize(data, size, out);
+    }
+    if (size >= 26 && data[0] == 'B' && data[1] == 'M') {
+        // Negative heights mark top-down bitmaps
+        out = sf::Vector2u(static_cast<unsigned>(std::abs(readLittleEndian32(data + 18))),
+                           static_cast<unsigned>(std::abs(readLittleEndian32(data + 22))));
+        return true;
+    }
+    if (size >= 18 && extension == ".tga") {
+        // No signature; trust the extension
+        out = sf::Vector2u(readLittleEndian16(data + 12), readLittleEndian16(data + 14));
+        return true;
+    }
+    return false;
+}
+
+void AssetIndex::scan(const std::string& directory) {
+    cancelled.store(true, std::memory_order_relaxed);
+    waitForJob();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.clear();
+        jobQueued = true;
+    }
+    cancelled.store(false, std::memory_order_relaxed);
+    reusedCount.store(0, std::memory_order_relaxed);
+    probedCount.store(0, std::memory_order_relaxed);
+    scanning.store(true, std::memory_order_release);
+    jobs.submit(JobSystem::Lane::Cooking, [this, directory] { run(directory); });
+}
+
+size_t AssetIndex::takeResults(std::vector<Entry>& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const size_t count = pending.size();
+    out.insert(out.end(), std::make_move_iterator(pending.begin()), std::make_move_iterator(pending.end()));
+    pending.clear();
+    return count;
+}
+
+void AssetIndex::run(std::string directory) {
+    std::vector<Entry> batch;
+    try {
+        std::vector<fs::path> imageDirectories;
+        for (const auto& entry : fs::directory_iterator(directory)) {
+            if (cancelled.load(std::memory_order_relaxed)) break;
+            if (entry.is_directory()) {
+                Entry info;
+                info.path = entry.path().string();
+                info.isDirectory = true;
+                batch.push_back(std::move(info));
+                if (entry.path().string().find("images") != std::string::npos) {
+                    imageDirectories.push_back(entry.path());
+                }
+            } else if (entry.is_regular_file()) {
+                addFile(entry.path().string(), entry.file_size(), entry.last_write_time().time_since_epoch().count(),
+                        batch);
+            }
+        }
+        publish(batch);
+
+        // Only images below the image directories, as the window lists them
+        for (const auto& imageDirectory : imageDirectories) {
+            if (cancelled.load(std::memory_order_relaxed)) break;
+            for (const auto& entry : fs::recursive_directory_iterator(imageDirectory)) {
+                if (cancelled.load(std::memory_order_relaxed)) break;
+                if (entry.is_regular_file() && isImageExtension(lowercaseExtension(entry.path()))) {
+                    addFile(entry.path().string(), entry.file_size(),
+                            entry.last_write_time().time_since_epoch().count(), batch);
+                    if (batch.size() >= PUBLISH_BATCH) {
+                        publish(batch);
+                    }
+                }
+            }
+        }
+    } catch (const fs::filesystem_error& e) {
+        std::cerr << "Error scanning assets directory: " << e.what() << std::endl;
+    }
+    publish(batch);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (dirty && save()) {
+        dirty = false;
+    }
+    scanning.store(false, std::memory_order_release);
+    jobQueued = false;
+    jobDone.notify_all();
+}
+
+void AssetIndex::addFile(const std::string& path, uint64_t fileSize, int64_t modifiedTime, std::vector<Entry>& batch) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(path);
+        if (it != entries.end() && it->second.fileSize == fileSize && it->second.modifiedTime == modifiedTime) {
+            batch.push_back(it->second);
+            batch.back().reused = true;
+            batch.back().probeMilliseconds = 0.0f;
+            reusedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    // New or changed: one mapping serves the header probe and the content hash
+    const auto start = std::chrono::steady_clock::now();
+    Entry info;
+    info.path = path;
+    info.fileSize = fileSize;
+    info.modifiedTime = modifiedTime;
+    const std::string extension = lowercaseExtension(path);
+    info.isImage = isImageExtension(extension);
+    MappedFile file;
+    if (file.open(path)) {
+        info.contentHash = AssetPack::hashName(std::string_view(file.data(), file.size()));
+        if (info.isImage) {
+            probeImageSize(file.data(), file.size(), extension, info.dimensions);
+        }
+    }
+    info.probeMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    probedCount.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    entries[path] = info;
+    dirty = true;
+    batch.push_back(std::move(info));
+}
+
+void AssetIndex::publish(std::vector<Entry>& batch) {
+    if (batch.empty()) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.insert(pending.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+    batch.clear();
+}
+
+bool AssetIndex::load() {
+    std::ifstream file(indexPath, std::ios::binary);
+    if (!file.is_open()) {
+        return false; // First run
+    }
+    FileHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+        std::cerr << "Ignoring stale asset index " << indexPath << std::endl;
+        return false;
+    }
+    for (uint32_t i = 0; i < header.entryCount; ++i) {
+        FileEntry record{};
+        Entry entry;
+        if (!file.read(reinterpret_cast<char*>(&record), sizeof(record))) break;
+        entry.path.resize(record.pathLength);
+        if (!file.read(entry.path.data(), record.pathLength)) break;
+        entry.fileSize = record.fileSize;
+        entry.modifiedTime = record.modifiedTime;
+        entry.contentHash = record.contentHash;
+        entry.dimensions = sf::Vector2u(record.width, record.height);
+        entry.isImage = isImageExtension(lowercaseExtension(entry.path));
+        entries.emplace(entry.path, std::move(entry));
+    }
+    return true;
+}
+
+bool AssetIndex::save() const {
+    std::ofstream file(indexPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Could not write asset index " << indexPath << std::endl;
+        return false;
+    }
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& [path, entry] : entries) {
+        FileEntry record{};
+        record.fileSize = entry.fileSize;
+        record.modifiedTime = entry.modifiedTime;
+        record.contentHash = entry.contentHash;
+        record.width = entry.dimensions.x;
+        record.height = entry.dimensions.y;
+        record.pathLength = static_cast<uint32_t>(path.size());
+        file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        file.write(path.data(), static_cast<std::streamsize>(path.size()));
+    }
+    return static_cast<bool>(file);
+}
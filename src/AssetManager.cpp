@@ -1,85 +1,652 @@
 #include "../include/AssetManager.hpp"
+#include "../include/Profiler.hpp"
+#include "../include/AssetPack.hpp"
+#include "../include/FileWatcher.hpp"
+#include "../include/AllocationTracker.hpp"
+#include "../include/JobSystem.hpp"
+#include "../include/ImageCodec.hpp"
 #include <iostream>
-#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <thread>
 
-void AssetManager::loadTexture(const std::string& name, const std::string& filename) {
-    std::cout << "Attempting to load texture: " << filename << std::endl;
+namespace {
+
+// Area-averaged downscale. Colour is weighted by alpha so fully transparent
+// texels (often black) don't darken the edges of what they surround.
+sf::Image downscaleImage(const sf::Image& source, const sf::Vector2u& size) {
+    PROFILE_ZONE("AssetManager::downscale");
+    const sf::Vector2u from = source.getSize();
+    const uint8_t* pixels = source.getPixelsPtr();
+    std::vector<uint8_t> result(static_cast<size_t>(size.x) * size.y * 4);
+    for (unsigned y = 0; y < size.y; ++y) {
+        const unsigned y0 = static_cast<unsigned>(static_cast<uint64_t>(y) * from.y / size.y);
+        const unsigned y1 = std::max(y0 + 1, static_cast<unsigned>(static_cast<uint64_t>(y + 1) * from.y / size.y));
+        for (unsigned x = 0; x < size.x; ++x) {
+            const unsigned x0 = static_cast<unsigned>(static_cast<uint64_t>(x) * from.x / size.x);
+            const unsigned x1 = std::max(x0 + 1, static_cast<unsigned>(static_cast<uint64_t>(x + 1) * from.x / size.x));
+            uint64_t red = 0, green = 0, blue = 0, alpha = 0;
+            for (unsigned sy = y0; sy < y1; ++sy) {
+                const uint8_t* texel = pixels + (static_cast<size_t>(sy) * from.x + x0) * 4;
+                for (unsigned sx = x0; sx < x1; ++sx, texel += 4) {
+                    red += texel[0] * texel[3];
+                    green += texel[1] * texel[3];
+                    blue += texel[2] * texel[3];
+                    alpha += texel[3];
+                }
+            }
+            uint8_t* out = result.data() + (static_cast<size_t>(y) * size.x + x) * 4;
+            if (alpha > 0) {
+                out[0] = static_cast<uint8_t>(red / alpha);
+                out[1] = static_cast<uint8_t>(green / alpha);
+                out[2] = static_cast<uint8_t>(blue / alpha);
+            }
+            out[3] = static_cast<uint8_t>(alpha / (static_cast<uint64_t>(y1 - y0) * (x1 - x0)));
+        }
+    }
+    return sf::Image(size, result.data());
+}
+
+// Smallest size with the source's aspect that covers 'cover'; the source size
+// itself when that would enlarge it
+sf::Vector2u getCoveringSize(const sf::Vector2u& source, const sf::Vector2u& cover) {
+    const float scale = std::max(static_cast<float>(cover.x) / source.x, static_cast<float>(cover.y) / source.y);
+    if (scale >= 1.f) {
+        return source;
+    }
+    return sf::Vector2u(std::max(1u, static_cast<unsigned>(std::ceil(source.x * scale))),
+                        std::max(1u, static_cast<unsigned>(std::ceil(source.y * scale))));
+}
+
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    // FNV-1a
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Cache file of a processed image; empty if the source can't be identified
+std::string getProcessedCachePath(const std::string& directory, const std::string& filename,
+                                  const sf::Vector2u& coverSize) {
+    uint64_t sourceSize = 0;
+    int64_t modified = 0;
+    if (AssetPack::Blob blob = AssetPack::instance().find(filename)) {
+        sourceSize = blob.size; // The pack is rebuilt as a whole; size and name have to do
+    } else {
+        std::error_code ec;
+        sourceSize = std::filesystem::file_size(filename, ec);
+        if (ec) return std::string();
+        modified = std::filesystem::last_write_time(filename, ec).time_since_epoch().count();
+        if (ec) return std::string();
+    }
+    uint64_t key = hashBytes(14695981039346656037ull, filename.data(), filename.size());
+    key = hashBytes(key, &sourceSize, sizeof(sourceSize));
+    key = hashBytes(key, &modified, sizeof(modified));
+    key = hashBytes(key, &coverSize.x, sizeof(coverSize.x));
+    key = hashBytes(key, &coverSize.y, sizeof(coverSize.y));
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.png", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+// Whose memory a decode's image is charged to; UI and other textures stay
+// with whoever loads them
+AllocationTracker::Tag getMemoryTag(AssetManager::TextureCategory category) {
+    switch (category) {
+        case AssetManager::TextureCategory::Character: return AllocationTracker::Tag::Animation;
+        case AssetManager::TextureCategory::Background: return AllocationTracker::Tag::Backgrounds;
+        case AssetManager::TextureCategory::Tile: return AllocationTracker::Tag::Tiles;
+        default: return AllocationTracker::getThreadTag();
+    }
+}
+
+} // namespace
+
+AssetManager::~AssetManager() {
+    // Jobs still queued skip their decode, but they hold 'this' until they return
+    std::unique_lock<std::mutex> lock(loadMutex);
+    stopWorkers = true;
+    decodedCondition.wait(lock, [this] { return runningDecodes == 0; });
+}
+
+bool AssetManager::decodeImage(const std::string& filename, sf::Image& image, std::string& error) {
+    PROFILE_ZONE("AssetManager::decodeImage");
+    // Packed files decode straight from the mapping; pre-decoded ones only decompress
+    if (AssetPack::Blob blob = AssetPack::instance().find(filename)) {
+        if (!ImageCodec::decode(blob.data, blob.size, image)) {
+            error = "Failed to load texture from pack: " + filename;
+            return false;
+        }
+        return true;
+    }
     
-    // Check if file exists first
-    std::ifstream file(filename.c_str());
-    if (!file.good()) {
-        std::cout << "File does not exist or is not accessible: " << filename << std::endl;
-        throw std::runtime_error("AssetManager::loadTexture - File not found: " + filename);
+    // One metadata call covers both "missing" and "empty"; the decode is the only open
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(filename, ec);
+    if (ec) {
+        error = "File not found: " + filename;
+        return false;
+    }
+    if (size == 0) {
+        error = "Empty file: " + filename;
+        return false;
+    }
+    if (!ImageCodec::load(filename, image)) {
+        error = "Failed to load texture: " + filename;
+        return false;
+    }
+    return true;
+}
+
+bool AssetManager::decodeProcessed(const std::string& filename, const sf::Vector2u& coverSize,
+                                   const std::string& cacheDirectory, sf::Image& image, std::string& error) {
+    if (coverSize.x == 0 || coverSize.y == 0) {
+        return decodeImage(filename, image, error);
+    }
+    const std::string cachePath = cacheDirectory.empty() ? std::string()
+                                                         : getProcessedCachePath(cacheDirectory, filename, coverSize);
+    std::error_code ec;
+    if (!cachePath.empty() && std::filesystem::is_regular_file(cachePath, ec)) {
+        PROFILE_ZONE("AssetManager::decodeCached");
+        if (image.loadFromFile(cachePath)) {
+            return true;
+        }
+    }
+    if (!decodeImage(filename, image, error)) {
+        return false;
+    }
+    const sf::Vector2u size = getCoveringSize(image.getSize(), coverSize);
+    if (size == image.getSize()) {
+        return true;
+    }
+    image = downscaleImage(image, size);
+    if (!cachePath.empty()) {
+        // Written under a per-thread name and renamed, so a reader never sees half a file
+        std::filesystem::create_directories(cacheDirectory, ec);
+        const std::string partial = cachePath + "." +
+            std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".png";
+        if (image.saveToFile(partial)) {
+            std::filesystem::rename(partial, cachePath, ec);
+        }
+        if (ec) {
+            std::filesystem::remove(partial, ec);
+        }
+    }
+    return true;
+}
+
+void AssetManager::setDisplaySize(TextureCategory category, const sf::Vector2u& size) {
+    displaySizes[static_cast<size_t>(category)] = size;
+}
+
+const char* AssetManager::toString(TextureCategory category) {
+    switch (category) {
+        case TextureCategory::Character: return "Characters";
+        case TextureCategory::Background: return "Backgrounds";
+        case TextureCategory::Tile: return "Tiles";
+        case TextureCategory::UI: return "UI";
+        case TextureCategory::Other: return "Other";
+        case TextureCategory::Count: break;
+    }
+    return "Other";
+}
+
+void AssetManager::storeTexture(TextureHandle handle, std::unique_ptr<sf::Texture> texture, const std::string& source,
+                                TextureCategory category) {
+    std::shared_ptr<TextureEntry>& entry = textures.slots[handle.index];
+    if (entry) {
+        // Resident: replace the contents in place so sprites pointing at it stay valid
+        *entry->texture = std::move(*texture);
+    } else {
+        entry = std::make_shared<TextureEntry>();
+        entry->texture = std::move(texture);
+    }
+    const sf::Vector2u size = entry->texture->getSize();
+    entry->source = source;
+    entry->category = category;
+    entry->bytes = static_cast<size_t>(size.x) * size.y * 4;
+    entry->lastUse = ++useClock;
+    enforceTextureBudget(entry.get());
+}
+
+void AssetManager::enforceTextureBudget(const TextureEntry* keep) {
+    size_t resident = 0;
+    for (const auto& entry : textures.slots) {
+        if (entry) resident += entry->bytes;
     }
-    file.close();
     
-    // Check file size
-    std::ifstream fileSize(filename.c_str(), std::ios::binary | std::ios::ate);
-    std::streampos size = fileSize.tellg();
-    fileSize.close();
+    // Least recently used first; referenced textures (and the one just stored) stay.
+    // Evicted names stay interned, so their handles remain valid for a reload.
+    while (resident > textureBudget) {
+        size_t victim = textures.slots.size();
+        for (size_t i = 0; i < textures.slots.size(); ++i) {
+            const auto& entry = textures.slots[i];
+            if (!entry || entry.use_count() > 1 || entry.get() == keep) continue;
+            if (victim == textures.slots.size() || entry->lastUse < textures.slots[victim]->lastUse) {
+                victim = i;
+            }
+        }
+        if (victim == textures.slots.size()) {
+            std::cout << "Texture budget exceeded by referenced textures: " << resident << " of "
+                      << textureBudget << " bytes" << std::endl;
+            return;
+        }
+        std::cout << "Evicting texture " << textures.names[victim] << " (" << textures.slots[victim]->bytes
+                  << " bytes)" << std::endl;
+        resident -= textures.slots[victim]->bytes;
+        textures.slots[victim].reset();
+        evictionCount++;
+    }
+}
+
+void AssetManager::setTextureBudget(size_t bytes) {
+    textureBudget = bytes;
+    enforceTextureBudget(nullptr);
+}
+
+AssetManager::TextureStats AssetManager::getTextureStats() const {
+    TextureStats stats;
+    for (const auto& entry : textures.slots) {
+        if (!entry) continue;
+        const size_t category = static_cast<size_t>(entry->category);
+        stats.bytes[category] += entry->bytes;
+        stats.counts[category]++;
+        stats.residentBytes += entry->bytes;
+        if (entry.use_count() > 1) {
+            stats.referencedBytes += entry->bytes;
+        }
+    }
+    stats.evictions = evictionCount;
+    return stats;
+}
+
+void AssetManager::loadTexture(const std::string& name, const std::string& filename, TextureCategory category) {
+    std::string error;
+    if (!tryLoadTexture(name, filename, category, error)) {
+        throw std::runtime_error("AssetManager::loadTexture - " + error);
+    }
+}
+
+bool AssetManager::tryLoadTexture(const std::string& name, const std::string& filename, TextureCategory category,
+                                  std::string& error) {
+    PROFILE_ZONE("AssetManager::loadTexture");
+    std::cout << "Attempting to load texture: " << filename << std::endl;
     
-    if (size <= 0) {
-        std::cout << "File exists but is empty (0 bytes): " << filename << std::endl;
-        throw std::runtime_error("AssetManager::loadTexture - Empty file: " + filename);
+    AllocationTracker::ScopedTag memoryTag(getMemoryTag(category));
+    sf::Image image;
+    const sf::Vector2u coverSize = getDisplaySize(category);
+    if (!decodeProcessed(filename, coverSize, processedCacheDirectory, image, error)) {
+        std::cout << "Texture load failed: " << error << std::endl;
+        return false;
     }
     
     auto texture = std::make_unique<sf::Texture>();
-    if (!texture->loadFromFile(filename)) {
-        std::cout << "SFML failed to load texture from file: " << filename << std::endl;
-        throw std::runtime_error("AssetManager::loadTexture - Failed to load texture: " + filename);
+    if (!texture->loadFromImage(image)) {
+        std::cout << "SFML failed to upload texture: " << filename << std::endl;
+        error = "Failed to load texture: " + filename;
+        return false;
     }
     
     std::cout << "Successfully loaded texture: " << filename << std::endl;
-    textures[name] = std::move(texture);
+    storeTexture(internTexture(name), std::move(texture), filename, category);
+    return true;
+}
+
+AssetManager::TextureLoad AssetManager::loadTextureAsync(const std::string& name, const std::string& filename, bool repeated,
+                                                         TextureCategory category) {
+    auto request = std::make_shared<TextureRequest>();
+    request->name = name;
+    request->texture = internTexture(name);
+    request->filename = filename;
+    request->repeated = repeated;
+    request->category = category;
+    request->coverSize = getDisplaySize(category);
+    request->cacheDirectory = processedCacheDirectory;
+    
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        // A new batch starts whenever the previous one has fully drained
+        if (pendingRequests == 0) {
+            progress = LoadProgress();
+        }
+        progress.requested++;
+        pendingRequests++;
+        runningDecodes++;
+    }
+    if (jobSystem) {
+        jobSystem->submit(JobSystem::Lane::Streaming, [this, request] { decodeRequest(request); });
+    } else {
+        decodeRequest(request);
+    }
+    return TextureLoad(std::move(request));
+}
+
+size_t AssetManager::reloadTextureFile(const std::string& path) {
+    size_t count = 0;
+    for (size_t i = 0; i < textures.slots.size(); ++i) {
+        const auto& entry = textures.slots[i];
+        if (entry && FileWatcher::isSameFile(entry->source, path)) {
+            loadTextureAsync(textures.names[i], entry->source, entry->texture->isRepeated(), entry->category);
+            count++;
+        }
+    }
+    return count;
+}
+
+void AssetManager::decodeRequest(std::shared_ptr<TextureRequest> request) {
+    PROFILE_ZONE("AssetManager::decodeRequest");
+    bool cancelled = false;
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        cancelled = stopWorkers;
+    }
+    
+    if (!cancelled) {
+        std::string error;
+        AllocationTracker::ScopedTag memoryTag(getMemoryTag(request->category));
+        bool decoded = decodeProcessed(request->filename, request->coverSize, request->cacheDirectory, request->image, error);
+        
+        std::lock_guard<std::mutex> lock(loadMutex);
+        if (decoded) {
+            request->status = TextureRequest::Status::Decoded;
+        } else {
+            request->error = "AssetManager::loadTextureAsync - " + error;
+            request->status = TextureRequest::Status::Failed;
+        }
+        // Failures go through the upload queue too so the main thread accounts for them
+        decodedRequests.push_back(std::move(request));
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        runningDecodes--;
+    }
+    decodedCondition.notify_all();
+}
+
+void AssetManager::uploadRequest(TextureRequest& request) {
+    PROFILE_ZONE("AssetManager::uploadRequest");
+    if (request.status == TextureRequest::Status::Decoded) {
+        auto texture = std::make_unique<sf::Texture>();
+        if (texture->loadFromImage(request.image)) {
+            texture->setRepeated(request.repeated);
+            storeTexture(request.texture, std::move(texture), request.filename, request.category);
+            request.status = TextureRequest::Status::Ready;
+        } else {
+            request.error = "AssetManager::loadTextureAsync - Failed to upload texture: " + request.filename;
+            request.status = TextureRequest::Status::Failed;
+        }
+        request.image = sf::Image(); // Release the CPU copy
+    }
+    
+    if (request.status == TextureRequest::Status::Failed) {
+        std::cout << request.error << std::endl;
+    }
+}
+
+size_t AssetManager::processUploads(std::chrono::microseconds budget) {
+    PROFILE_ZONE("AssetManager::processUploads");
+    const auto start = std::chrono::steady_clock::now();
+    size_t uploaded = 0;
+    
+    while (true) {
+        std::shared_ptr<TextureRequest> request;
+        {
+            std::lock_guard<std::mutex> lock(loadMutex);
+            if (decodedRequests.empty()) {
+                break;
+            }
+            request = std::move(decodedRequests.front());
+            decodedRequests.pop_front();
+        }
+        
+        uploadRequest(*request);
+        
+        {
+            std::lock_guard<std::mutex> lock(loadMutex);
+            progress.completed++;
+            if (request->status == TextureRequest::Status::Failed) {
+                progress.failed++;
+            }
+            pendingRequests--;
+        }
+        uploaded++;
+        
+        if (std::chrono::steady_clock::now() - start >= budget) {
+            break;
+        }
+    }
+    return uploaded;
+}
+
+void AssetManager::finishPendingLoads() {
+    while (hasPendingLoads()) {
+        if (processUploads(std::chrono::hours(1)) == 0) {
+            std::unique_lock<std::mutex> lock(loadMutex);
+            decodedCondition.wait(lock, [this] { return !decodedRequests.empty() || pendingRequests == 0; });
+        }
+    }
+}
+
+bool AssetManager::hasPendingLoads() const {
+    std::lock_guard<std::mutex> lock(loadMutex);
+    return pendingRequests > 0;
+}
+
+AssetManager::LoadProgress AssetManager::getLoadProgress() const {
+    std::lock_guard<std::mutex> lock(loadMutex);
+    return progress;
+}
+
+AssetManager::TextureHandle AssetManager::internTexture(const AssetKey& key) {
+    return TextureHandle(textures.intern(key));
+}
+
+AssetManager::FontHandle AssetManager::internFont(const AssetKey& key) {
+    return FontHandle(fonts.intern(key));
+}
+
+AssetManager::SoundHandle AssetManager::internSound(const AssetKey& key) {
+    return SoundHandle(soundBuffers.intern(key));
+}
+
+sf::Texture* AssetManager::findTexture(TextureHandle handle) {
+    if (!hasTexture(handle)) {
+        return nullptr;
+    }
+    TextureEntry& entry = *textures.slots[handle.index];
+    entry.lastUse = ++useClock;
+    return entry.texture.get();
+}
+
+sf::Font* AssetManager::findFont(FontHandle handle) {
+    return handle.index < fonts.slots.size() && fonts.slots[handle.index] ? &fonts.slots[handle.index]->font : nullptr;
+}
+
+sf::SoundBuffer* AssetManager::findSoundBuffer(SoundHandle handle) {
+    return handle.index < soundBuffers.slots.size() ? soundBuffers.slots[handle.index].get() : nullptr;
+}
+
+bool AssetManager::hasTexture(TextureHandle handle) const {
+    return handle.index < textures.slots.size() && textures.slots[handle.index] != nullptr;
+}
+
+AssetManager::TextureRef AssetManager::acquireTexture(TextureHandle handle) {
+    if (!findTexture(handle)) {
+        return TextureRef();
+    }
+    return TextureRef(textures.slots[handle.index]);
 }
 
 sf::Texture& AssetManager::getTexture(const std::string& name) {
-    auto found = textures.find(name);
-    if (found == textures.end()) {
+    sf::Texture* texture = findTexture(name);
+    if (!texture) {
         throw std::runtime_error("AssetManager::getTexture - Texture not found: " + name);
     }
     
-    return *found->second;
+    return *texture;
+}
+
+sf::Texture* AssetManager::findTexture(const std::string& name) {
+    return findTexture(TextureHandle(textures.find(name)));
+}
+
+sf::Font* AssetManager::findFont(const std::string& name) {
+    return findFont(FontHandle(fonts.find(name)));
+}
+
+sf::SoundBuffer* AssetManager::findSoundBuffer(const std::string& name) {
+    return findSoundBuffer(SoundHandle(soundBuffers.find(name)));
+}
+
+bool AssetManager::hasTexture(const std::string& name) const {
+    return hasTexture(TextureHandle(textures.find(name)));
+}
+
+AssetManager::TextureRef AssetManager::acquireTexture(const std::string& name) {
+    TextureRef ref = acquireTexture(TextureHandle(textures.find(name)));
+    if (!ref) {
+        throw std::runtime_error("AssetManager::acquireTexture - Texture not found: " + name);
+    }
+    
+    return ref;
 }
 
 void AssetManager::loadFont(const std::string& name, const std::string& filename) {
-    auto font = std::make_unique<sf::Font>();
-    if (!font->openFromFile(filename)) {
-        throw std::runtime_error("AssetManager::loadFont - Failed to load font: " + filename);
+    std::string error;
+    if (!tryLoadFont(name, filename, error)) {
+        throw std::runtime_error("AssetManager::loadFont - " + error);
+    }
+}
+
+bool AssetManager::tryLoadFont(const std::string& name, const std::string& filename, std::string& error) {
+    const FontHandle handle = internFont(name);
+    if (fonts.slots[handle.index]) {
+        return true;
     }
+    PROFILE_ZONE("AssetManager::loadFont");
     
-    fonts[name] = std::move(font);
+    // The pack mapping (or the entry's own) outlives the font, which reads glyphs from it lazily
+    auto entry = std::make_unique<FontEntry>();
+    AssetPack::Blob blob = AssetPack::instance().find(filename);
+    const char* data = blob.data;
+    size_t size = blob.size;
+    if (!blob) {
+        if (!entry->file.open(filename)) {
+            error = "Failed to open font: " + filename;
+            return false;
+        }
+        data = entry->file.data();
+        size = entry->file.size();
+    }
+    if (!entry->font.openFromMemory(data, size)) {
+        error = "Failed to load font: " + filename;
+        return false;
+    }
+    entry->source = filename;
+    
+    fonts.slots[handle.index] = std::move(entry);
+    return true;
+}
+
+AssetManager::FontHandle AssetManager::loadFirstFont(const std::string& name, const std::vector<std::string>& candidates) {
+    std::string error;
+    FontHandle handle = tryLoadFirstFont(name, candidates, error);
+    if (!handle.isValid()) {
+        throw std::runtime_error("AssetManager::loadFirstFont - " + error);
+    }
+    return handle;
+}
+
+AssetManager::FontHandle AssetManager::tryLoadFirstFont(const std::string& name, const std::vector<std::string>& candidates,
+                                                        std::string& error) {
+    std::string errors;
+    for (const auto& filename : candidates) {
+        std::string candidateError;
+        if (tryLoadFont(name, filename, candidateError)) {
+            const FontHandle handle = internFont(name);
+            std::cout << "Loaded font " << name << ": " << fonts.slots[handle.index]->source << std::endl;
+            return handle;
+        }
+        errors += errors.empty() ? candidateError : "; " + candidateError;
+    }
+    error = "No font for " + name + (errors.empty() ? std::string() : ": " + errors);
+    return FontHandle();
+}
+
+void AssetManager::prewarmGlyphs(FontHandle handle, const std::string& characters, unsigned characterSize,
+                                 float outlineThickness) {
+    sf::Font* font = findFont(handle);
+    if (!font) {
+        return;
+    }
+    PROFILE_ZONE("AssetManager::prewarmGlyphs");
+    const sf::String codePoints = sf::String::fromUtf8(characters.begin(), characters.end());
+    for (char32_t codePoint : codePoints) {
+        font->getGlyph(codePoint, characterSize, false);
+        if (outlineThickness > 0.f) {
+            font->getGlyph(codePoint, characterSize, false, outlineThickness);
+        }
+    }
+}
+
+const std::string& AssetManager::getAsciiGlyphs() {
+    static const std::string ascii = [] {
+        std::string characters;
+        for (char c = ' '; c <= '~'; ++c) {
+            characters.push_back(c);
+        }
+        return characters;
+    }();
+    return ascii;
 }
 
 sf::Font& AssetManager::getFont(const std::string& name) {
-    auto found = fonts.find(name);
-    if (found == fonts.end()) {
+    sf::Font* font = findFont(name);
+    if (!font) {
         throw std::runtime_error("AssetManager::getFont - Font not found: " + name);
     }
     
-    return *found->second;
+    return *font;
 }
 
 void AssetManager::loadSoundBuffer(const std::string& name, const std::string& filename) {
+    std::string error;
+    if (!tryLoadSoundBuffer(name, filename, error)) {
+        throw std::runtime_error("AssetManager::loadSoundBuffer - " + error);
+    }
+}
+
+bool AssetManager::tryLoadSoundBuffer(const std::string& name, const std::string& filename, std::string& error) {
     auto buffer = std::make_unique<sf::SoundBuffer>();
-    if (!buffer->loadFromFile(filename)) {
-        throw std::runtime_error("AssetManager::loadSoundBuffer - Failed to load sound: " + filename);
+    AssetPack::Blob blob = AssetPack::instance().find(filename);
+    if (blob ? !buffer->loadFromMemory(blob.data, blob.size) : !buffer->loadFromFile(filename)) {
+        error = "Failed to load sound: " + filename;
+        return false;
     }
     
-    soundBuffers[name] = std::move(buffer);
+    soundBuffers.slots[internSound(name).index] = std::move(buffer);
+    return true;
 }
 
 sf::SoundBuffer& AssetManager::getSoundBuffer(const std::string& name) {
-    auto found = soundBuffers.find(name);
-    if (found == soundBuffers.end()) {
+    sf::SoundBuffer* buffer = findSoundBuffer(name);
+    if (!buffer) {
         throw std::runtime_error("AssetManager::getSoundBuffer - Sound buffer not found: " + name);
     }
     
-    return *found->second;
+    return *buffer;
 }
 
 void AssetManager::clear() {
-    textures.clear();
-    fonts.clear();
-    soundBuffers.clear();
+    // Names stay interned so handles remain valid; TextureRefs keep their own entries alive
+    for (auto& entry : textures.slots) entry.reset();
+    for (auto& font : fonts.slots) font.reset();
+    for (auto& buffer : soundBuffers.slots) buffer.reset();
 } 
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "AssetManifest.hpp"
+#include "AssetManifestData.hpp" // Generated by the asset_manifest tool
+#include <filesystem>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace AssetManifest {
+
+namespace {
+
+std::string root = "assets";
+
+} // namespace
+
+const Entry* find(std::string_view path) {
+    const uint64_t id = idOf(path);
+    // The table is never more than half full, so the probe ends at an empty slot
+    for (size_t slot = id & generated::SLOT_MASK;; slot = (slot + 1) & generated::SLOT_MASK) {
+        const uint32_t index = generated::SLOTS[slot];
+        if (index == 0) {
+            return nullptr;
+        }
+        const Entry& entry = generated::ENTRIES[index - 1];
+        if (entry.id == id && entry.path == path) {
+            return &entry;
+        }
+    }
+}
+
+size_t getEntryCount() {
+    return generated::ENTRY_COUNT;
+}
+
+bool resolveRoot() {
+    root = "assets";
+    if (AssetPack::instance().isMounted() || generated::ENTRY_COUNT == 0) {
+        return true;
+    }
+    // One listed file tells the directories apart
+    const std::string_view probe = generated::ENTRIES[0].path.substr(PREFIX.size());
+    for (const char* candidate : {"assets", "../assets", "../../assets", generated::SOURCE_ROOT}) {
+        std::error_code ec;
+        if (fs::is_regular_file(fs::path(candidate) / probe, ec)) {
+            root = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const std::string& getRoot() {
+    return root;
+}
+
+std::string resolve(std::string_view path) {
+    if (root == "assets" || path.compare(0, PREFIX.size(), PREFIX) != 0) {
+        return std::string(path);
+    }
+    return root + "/" + std::string(path.substr(PREFIX.size()));
+}
+
+} // namespace AssetManifest
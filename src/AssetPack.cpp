@@ -0,0 +1,203 @@
+#include "AssetPack.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+AssetPack& AssetPack::instance() {
+    static AssetPack pack;
+    return pack;
+}
+
+AssetPack::~AssetPack() {
+    unmount();
+}
+
+bool AssetPack::mount(const std::string& path) {
+    unmount();
+
+    if (!mapping.open(path) || mapping.size() < sizeof(FileHeader)) {
+        mapping.close();
+        return false;
+    }
+    base = mapping.data();
+    mappedSize = mapping.size();
+
+    // Validate the index before trusting any offsets in it
+    FileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    const size_t bundlesStart = sizeof(FileHeader) + static_cast<size_t>(header.entryCount) * sizeof(FileEntry);
+    const size_t filesStart = bundlesStart + static_cast<size_t>(header.bundleCount) * sizeof(BundleEntry);
+    const size_t indexEnd = filesStart + static_cast<size_t>(header.bundleFileCount) * sizeof(uint32_t);
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        indexEnd + header.stringTableSize > mappedSize) {
+        std::cerr << "Invalid asset pack: " << path << std::endl;
+        unmount();
+        return false;
+    }
+
+    entries = reinterpret_cast<const FileEntry*>(base + sizeof(FileHeader));
+    entryCount = header.entryCount;
+    bundles = reinterpret_cast<const BundleEntry*>(base + bundlesStart);
+    bundleCount = header.bundleCount;
+    bundleFiles = reinterpret_cast<const uint32_t*>(base + filesStart);
+    stringTable = base + indexEnd;
+    for (size_t i = 0; i < entryCount; ++i) {
+        const FileEntry& entry = entries[i];
+        if (entry.offset + entry.size > mappedSize || entry.nameOffset + entry.nameLength > header.stringTableSize) {
+            std::cerr << "Corrupt asset pack entry " << i << " in " << path << std::endl;
+            unmount();
+            return false;
+        }
+    }
+    for (size_t i = 0; i < bundleCount; ++i) {
+        const BundleEntry& bundle = bundles[i];
+        if (static_cast<uint64_t>(bundle.firstFile) + bundle.fileCount > header.bundleFileCount ||
+            bundle.offset + bundle.size > mappedSize) {
+            std::cerr << "Corrupt asset pack bundle " << i << " in " << path << std::endl;
+            unmount();
+            return false;
+        }
+    }
+    for (size_t i = 0; i < header.bundleFileCount; ++i) {
+        if (bundleFiles[i] >= entryCount) {
+            std::cerr << "Corrupt asset pack bundle file list in " << path << std::endl;
+            unmount();
+            return false;
+        }
+    }
+
+    mountedPath = path;
+    std::cout << "Mounted asset pack " << path << " (" << entryCount << " files)" << std::endl;
+    return true;
+}
+
+void AssetPack::unmount() {
+    mapping.close();
+    base = nullptr;
+    mappedSize = 0;
+    entries = nullptr;
+    entryCount = 0;
+    bundles = nullptr;
+    bundleCount = 0;
+    bundleFiles = nullptr;
+    stringTable = nullptr;
+    mountedPath.clear();
+}
+
+std::string_view AssetPack::entryName(const FileEntry& entry) const {
+    return std::string_view(stringTable + entry.nameOffset, entry.nameLength);
+}
+
+AssetPack::Blob AssetPack::find(const std::string& name) const {
+    Blob blob;
+    if (!base) return blob;
+
+    const std::string key = normalizeName(name);
+    const uint64_t hash = hashName(key);
+    const FileEntry* end = entries + entryCount;
+    const FileEntry* it = std::lower_bound(entries, end, hash,
+        [](const FileEntry& entry, uint64_t value) { return entry.nameHash < value; });
+    // Collisions are resolved by comparing the stored name
+    for (; it != end && it->nameHash == hash; ++it) {
+        if (entryName(*it) == key) {
+            blob.data = base + it->offset;
+            blob.size = static_cast<size_t>(it->size);
+            blob.format = static_cast<Format>(it->format);
+            break;
+        }
+    }
+    return blob;
+}
+
+AssetPack::Bundle AssetPack::findBundle(int level) const {
+    Bundle bundle;
+    const BundleEntry* end = bundles + bundleCount;
+    const BundleEntry* it = std::lower_bound(bundles, end, level,
+        [](const BundleEntry& entry, int value) { return static_cast<int64_t>(entry.level) < value; });
+    if (it != end && static_cast<int>(it->level) == level) {
+        bundle.level = level;
+        bundle.offset = it->offset;
+        bundle.size = it->size;
+        bundle.files = bundleFiles + it->firstFile;
+        bundle.fileCount = it->fileCount;
+    }
+    return bundle;
+}
+
+AssetPack::FileRange AssetPack::getFile(uint32_t index) const {
+    FileRange range;
+    if (index < entryCount) {
+        range.offset = entries[index].offset;
+        range.size = entries[index].size;
+    }
+    return range;
+}
+
+std::string_view AssetPack::getFileName(uint32_t index) const {
+    return index < entryCount ? entryName(entries[index]) : std::string_view();
+}
+
+std::vector<std::string> AssetPack::listDirectory(const std::string& directory) const {
+    std::vector<std::string> names;
+    if (!base) return names;
+
+    // Only used while loading, so a scan over the index is fine
+    const std::string prefix = normalizeName(directory) + "/";
+    for (size_t i = 0; i < entryCount; ++i) {
+        std::string_view name = entryName(entries[i]);
+        if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+            name.find('/', prefix.size()) == std::string_view::npos) {
+            names.emplace_back(name);
+        }
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+bool AssetPack::hasDirectory(const std::string& directory) const {
+    if (!base) return false;
+    const std::string prefix = normalizeName(directory) + "/";
+    for (size_t i = 0; i < entryCount; ++i) {
+        if (entryName(entries[i]).compare(0, prefix.size(), prefix) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string AssetPack::normalizeName(const std::string& path) {
+    std::string name = fs::path(path).lexically_normal().generic_string();
+    while (name.size() > 2 && name.compare(0, 2, "./") == 0) {
+        name.erase(0, 2);
+    }
+    while (!name.empty() && name.back() == '/') {
+        name.pop_back();
+    }
+    return name;
+}
+
+uint64_t AssetPack::hashName(std::string_view name) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+AssetPack::Format AssetPack::formatFromExtension(const std::string& path) {
+    std::string extension = fs::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == ".png") return Format::Png;
+    if (extension == ".jpg" || extension == ".jpeg") return Format::Jpeg;
+    if (extension == ".wav") return Format::Wav;
+    if (extension == ".ttf" || extension == ".otf") return Format::Font;
+    if (extension == ".ogg") return Format::Ogg;
+    if (extension == ".flac") return Format::Flac;
+    if (extension == ".json") return Format::Json;
+    return Format::Unknown;
+}
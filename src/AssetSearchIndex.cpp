@@ -0,0 +1,162 @@
+#include "AssetSearchIndex.hpp"
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+
+namespace {
+
+std::string toLower(const std::string& text) {
+    std::string lowered(text);
+    for (char& c : lowered) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return lowered;
+}
+
+uint32_t getTrigram(const std::string& text, size_t at) {
+    return static_cast<uint32_t>(static_cast<unsigned char>(text[at])) << 16 |
+           static_cast<uint32_t>(static_cast<unsigned char>(text[at + 1])) << 8 |
+           static_cast<uint32_t>(static_cast<unsigned char>(text[at + 2]));
+}
+
+} // namespace
+
+void AssetSearchIndex::clear() {
+    names.clear();
+    directories.clear();
+    sizes.clear();
+    pixels.clear();
+    trigrams.clear();
+    matches.clear();
+    view.clear();
+    std::fill(std::begin(orderValid), std::end(orderValid), false);
+    matchesDirty = true;
+    viewDirty = true;
+}
+
+void AssetSearchIndex::add(const std::string& name, bool isDirectory, uint64_t size, uint64_t pixelCount) {
+    const uint32_t entry = static_cast<uint32_t>(names.size());
+    names.push_back(toLower(name));
+    directories.push_back(isDirectory ? 1 : 0);
+    sizes.push_back(size);
+    pixels.push_back(pixelCount);
+
+    const std::string& lowered = names.back();
+    for (size_t i = 0; i + 3 <= lowered.size(); ++i) {
+        std::vector<uint32_t>& postings = trigrams[getTrigram(lowered, i)];
+        if (postings.empty() || postings.back() != entry) { // A name repeating a trigram lists once
+            postings.push_back(entry);
+        }
+    }
+    std::fill(std::begin(orderValid), std::end(orderValid), false);
+    matchesDirty = true;
+    viewDirty = true;
+}
+
+void AssetSearchIndex::setQuery(const std::string& text) {
+    std::string lowered = toLower(text);
+    if (lowered != query) {
+        query = std::move(lowered);
+        matchesDirty = true;
+        viewDirty = true;
+    }
+}
+
+void AssetSearchIndex::setSort(SortKey key, bool ascendingOrder) {
+    if (key != sortKey || ascendingOrder != ascending) {
+        sortKey = key;
+        ascending = ascendingOrder;
+        viewDirty = true;
+    }
+}
+
+const std::vector<uint32_t>& AssetSearchIndex::getOrder(SortKey key) {
+    const size_t slot = static_cast<size_t>(key);
+    std::vector<uint32_t>& order = orders[slot];
+    if (orderValid[slot]) {
+        return order;
+    }
+    order.resize(names.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    // Directories first, then the key; ties by name, then in the order added
+    auto byName = [this](uint32_t a, uint32_t b) {
+        if (directories[a] != directories[b]) return directories[a] > directories[b];
+        if (names[a] != names[b]) return names[a] < names[b];
+        return a < b;
+    };
+    switch (key) {
+        case SortKey::Size:
+            std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                return sizes[a] != sizes[b] ? sizes[a] < sizes[b] : byName(a, b);
+            });
+            break;
+        case SortKey::Dimensions:
+            std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                return pixels[a] != pixels[b] ? pixels[a] < pixels[b] : byName(a, b);
+            });
+            break;
+        default:
+            std::sort(order.begin(), order.end(), byName);
+            break;
+    }
+    orderValid[slot] = true;
+    return order;
+}
+
+void AssetSearchIndex::match() {
+    matches.assign(names.size(), query.empty() ? 1 : 0);
+    if (query.empty()) {
+        return;
+    }
+    if (query.size() < 3) {
+        for (size_t i = 0; i < names.size(); ++i) {
+            matches[i] = names[i].find(query) != std::string::npos;
+        }
+        return;
+    }
+    // Every match holds all the query's trigrams; check the fewest candidates
+    const std::vector<uint32_t>* rarest = nullptr;
+    for (size_t i = 0; i + 3 <= query.size(); ++i) {
+        const auto it = trigrams.find(getTrigram(query, i));
+        if (it == trigrams.end()) {
+            return; // Nothing holds this one
+        }
+        if (!rarest || it->second.size() < rarest->size()) {
+            rarest = &it->second;
+        }
+    }
+    for (uint32_t entry : *rarest) {
+        matches[entry] = names[entry].find(query) != std::string::npos;
+    }
+}
+
+const std::vector<uint32_t>& AssetSearchIndex::getView() {
+    if (matchesDirty) {
+        match();
+        matchesDirty = false;
+    }
+    if (!viewDirty) {
+        return view;
+    }
+    const std::vector<uint32_t>& order = getOrder(sortKey);
+    view.clear();
+    if (ascending) {
+        for (uint32_t entry : order) {
+            if (matches[entry]) view.push_back(entry);
+        }
+    } else {
+        // Directories stay first: each of the two runs is walked backwards
+        const auto files = std::partition_point(order.begin(), order.end(),
+                                                [this](uint32_t entry) { return directories[entry] != 0; });
+        for (auto it = std::make_reverse_iterator(files); it != order.rend(); ++it) {
+            if (matches[*it]) view.push_back(*it);
+        }
+        for (auto it = order.rbegin(); it != std::make_reverse_iterator(files); ++it) {
+            if (matches[*it]) view.push_back(*it);
+        }
+    }
+    viewDirty = false;
+    return view;
+}
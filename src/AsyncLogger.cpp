@@ -0,0 +1,314 @@
+#include "AsyncLogger.hpp"
+#include "AllocationTracker.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+AsyncLogger& AsyncLogger::instance() {
+    static AsyncLogger logger;
+    return logger;
+}
+
+AsyncLogger::AsyncLogger()
+    : ring([] {
+          AllocationTracker::ScopedTag memoryTag(AllocationTracker::Tag::Logging);
+          return std::unique_ptr<Slot[]>(new Slot[RING_CAPACITY]);
+      }()),
+      wallAnchor(std::chrono::system_clock::now()),
+      steadyAnchor(std::chrono::steady_clock::now()) {
+    for (size_t i = 0; i < RING_CAPACITY; ++i) {
+        ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    drainThread = std::thread(&AsyncLogger::drainLoop, this);
+}
+
+AsyncLogger::~AsyncLogger() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    drainThread.join();
+}
+
+AsyncLogger::SinkId AsyncLogger::openSink(const std::string& path, SinkFormat format) {
+    AllocationTracker::ScopedTag memoryTag(AllocationTracker::Tag::Logging);
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    for (size_t i = 0; i < sinks.size(); ++i) {
+        if (sinks[i]->path == path) {
+            return static_cast<SinkId>(i);
+        }
+    }
+
+    auto sink = std::make_unique<Sink>();
+    sink->path = path;
+    sink->format = format;
+    if (format == SinkFormat::Binary) {
+        sink->file.open(path, std::ios::out | std::ios::app | std::ios::binary);
+        writeSession(*sink); // Reaches the file with the first batch
+    } else {
+        sink->file.open(path, std::ios::out | std::ios::app);
+    }
+    sinks.push_back(std::move(sink));
+    return static_cast<SinkId>(sinks.size() - 1);
+}
+
+bool AsyncLogger::log(SinkId sink, Level level, std::string_view message) {
+    return push(sink, level, Command::Write, message);
+}
+
+bool AsyncLogger::truncate(SinkId sink) {
+    return push(sink, Level::Info, Command::Truncate, std::string_view());
+}
+
+AsyncLogger::FormatId AsyncLogger::registerFormat(const char* format) {
+    std::lock_guard<std::mutex> lock(formatMutex);
+    if (formatCount == MAX_FORMATS) {
+        return MAX_FORMATS;
+    }
+    formats[formatCount] = format;
+    return formatCount++;
+}
+
+const char* AsyncLogger::getFormat(FormatId format) const {
+    return format < MAX_FORMATS ? formats[format] : "{format table full}";
+}
+
+AsyncLogger::Slot* AsyncLogger::claim(SinkId sink, Level level, Command command, size_t& pos) {
+    // Bounded MPSC queue: each slot's sequence says whether it is free for position 'pos'
+    pos = enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    while (true) {
+        slot = &ring[pos & (RING_CAPACITY - 1)];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Ring is full - drop rather than block the caller
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->tick = std::chrono::steady_clock::now().time_since_epoch().count();
+    slot->sink = sink;
+    slot->level = level;
+    slot->command = command;
+    return slot;
+}
+
+bool AsyncLogger::push(SinkId sink, Level level, Command command, std::string_view message) {
+    size_t pos = 0;
+    Slot* slot = claim(sink, level, command, pos);
+    if (!slot) {
+        return false;
+    }
+
+    // Long messages are cut to the slot size and marked
+    size_t length = std::min(message.size(), MESSAGE_CAPACITY);
+    std::memcpy(slot->text.data(), message.data(), length);
+    if (message.size() > MESSAGE_CAPACITY) {
+        std::memcpy(slot->text.data() + MESSAGE_CAPACITY - 3, "...", 3);
+    }
+    slot->length = static_cast<uint16_t>(length);
+
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool AsyncLogger::pop(Slot& out) {
+    // Only the drain thread pops
+    size_t pos = dequeuePos.load(std::memory_order_relaxed);
+    Slot& slot = ring[pos & (RING_CAPACITY - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+        return false;
+    }
+
+    out.tick = slot.tick;
+    out.sink = slot.sink;
+    out.level = slot.level;
+    out.command = slot.command;
+    out.format = slot.format;
+    out.truncated = slot.truncated;
+    out.length = slot.length;
+    std::memcpy(out.text.data(), slot.text.data(), slot.length);
+
+    slot.sequence.store(pos + RING_CAPACITY, std::memory_order_release);
+    dequeuePos.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+int64_t AsyncLogger::toWallNs(std::chrono::steady_clock::rep tick) const {
+    auto sinceAnchor = std::chrono::steady_clock::duration(tick) - steadyAnchor.time_since_epoch();
+    auto wall = wallAnchor.time_since_epoch() + sinceAnchor;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(wall).count();
+}
+
+void AsyncLogger::formatTimestamp(std::chrono::steady_clock::rep tick, std::string& out) {
+    auto sinceAnchor = std::chrono::steady_clock::duration(tick) - steadyAnchor.time_since_epoch();
+    auto wall = wallAnchor + std::chrono::duration_cast<std::chrono::system_clock::duration>(sinceAnchor);
+    std::time_t seconds = std::chrono::system_clock::to_time_t(wall);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(wall.time_since_epoch()).count() % 1000;
+
+    // Records arrive in bursts within the same second, so the date part is cached
+    if (seconds != cachedSecond) {
+        char date[32];
+        std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", std::localtime(&seconds));
+        cachedSecond = seconds;
+        cachedSecondText = date;
+    }
+
+    char millis[8];
+    std::snprintf(millis, sizeof(millis), ".%03d", static_cast<int>(ms < 0 ? ms + 1000 : ms));
+    out += cachedSecondText;
+    out += millis;
+}
+
+namespace {
+
+template <typename T>
+void appendRaw(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+} // namespace
+
+void AsyncLogger::writeSession(Sink& sink) {
+    appendRaw(sink.buffer, LogFormat::RecordKind::Session);
+    sink.buffer.append(LogFormat::MAGIC, sizeof(LogFormat::MAGIC));
+    appendRaw(sink.buffer, LogFormat::VERSION);
+    sink.formatsWritten.clear();
+}
+
+void AsyncLogger::writeBinaryRecord(Sink& sink, const Slot& record) {
+    const int64_t wallNs = toWallNs(record.tick);
+    if (record.command == Command::Write) {
+        appendRaw(sink.buffer, LogFormat::RecordKind::Text);
+        appendRaw(sink.buffer, wallNs);
+        appendRaw(sink.buffer, static_cast<uint8_t>(record.level));
+        appendRaw(sink.buffer, record.length);
+        sink.buffer.append(record.text.data(), record.length);
+        return;
+    }
+
+    // The format text goes into the file once, ahead of its first record
+    const FormatId id = std::min<FormatId>(record.format, MAX_FORMATS);
+    if (id >= sink.formatsWritten.size()) {
+        sink.formatsWritten.resize(id + 1, false);
+    }
+    if (!sink.formatsWritten[id]) {
+        const char* format = getFormat(id);
+        const uint16_t length = static_cast<uint16_t>(std::min<size_t>(std::strlen(format), UINT16_MAX));
+        appendRaw(sink.buffer, LogFormat::RecordKind::Format);
+        appendRaw(sink.buffer, id);
+        appendRaw(sink.buffer, length);
+        sink.buffer.append(format, length);
+        sink.formatsWritten[id] = true;
+    }
+    appendRaw(sink.buffer, LogFormat::RecordKind::Structured);
+    appendRaw(sink.buffer, wallNs);
+    appendRaw(sink.buffer, static_cast<uint8_t>(record.level));
+    appendRaw(sink.buffer, static_cast<uint8_t>(record.truncated));
+    appendRaw(sink.buffer, id);
+    appendRaw(sink.buffer, record.length);
+    sink.buffer.append(record.text.data(), record.length);
+}
+
+size_t AsyncLogger::drainBatch() {
+    static const char* const levelNames[] = { "DEBUG", "INFO", "WARNING", "ERROR" };
+
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    Slot record;
+    size_t count = 0;
+
+    auto writeOut = [](Sink& sink) {
+        if (!sink.buffer.empty() && sink.file.is_open()) {
+            PROFILE_ZONE("AsyncLogger::flush");
+            sink.file.write(sink.buffer.data(), static_cast<std::streamsize>(sink.buffer.size()));
+            sink.file.flush();
+        }
+        sink.buffer.clear();
+    };
+
+    while (pop(record)) {
+        ++count;
+        if (record.sink >= sinks.size()) {
+            continue;
+        }
+        Sink& sink = *sinks[record.sink];
+
+        if (record.command == Command::Truncate) {
+            // Everything queued before the truncate is discarded with the old contents
+            sink.buffer.clear();
+            sink.file.close();
+            if (sink.format == SinkFormat::Binary) {
+                sink.file.open(sink.path, std::ios::out | std::ios::trunc | std::ios::binary);
+                writeSession(sink);
+            } else {
+                sink.file.open(sink.path, std::ios::out | std::ios::trunc);
+            }
+            continue;
+        }
+
+        if (sink.format == SinkFormat::Binary) {
+            writeBinaryRecord(sink, record);
+            writtenCount.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        sink.buffer += '[';
+        formatTimestamp(record.tick, sink.buffer);
+        sink.buffer += "] [";
+        sink.buffer += levelNames[static_cast<size_t>(record.level)];
+        sink.buffer += "] ";
+        if (record.command == Command::WriteFormatted) {
+            LogFormat::appendFormatted(getFormat(record.format), record.text.data(), record.length,
+                                       record.truncated, sink.buffer);
+        } else {
+            sink.buffer.append(record.text.data(), record.length);
+        }
+        sink.buffer += '\n';
+        writtenCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // One write per file per batch
+    for (auto& sink : sinks) {
+        writeOut(*sink);
+    }
+    return count;
+}
+
+void AsyncLogger::drainLoop() {
+    PROFILE_THREAD("Logger");
+    AllocationTracker::setThreadTag(AllocationTracker::Tag::Logging);
+    while (true) {
+        size_t drained = drainBatch();
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        drainedCondition.notify_all();
+        if (stopping) {
+            lock.unlock();
+            drainBatch();
+            drainedCondition.notify_all();
+            return;
+        }
+        if (drained == 0) {
+            // Producers never signal (that would cost them a syscall), so poll while idle
+            wakeCondition.wait_for(lock, IDLE_WAIT);
+        }
+    }
+}
+
+void AsyncLogger::flush() {
+    const size_t target = enqueuePos.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    wakeCondition.notify_all();
+    drainedCondition.wait(lock, [this, target] {
+        return dequeuePos.load(std::memory_order_acquire) >= target;
+    });
+}
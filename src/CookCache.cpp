@@ -0,0 +1,84 @@
+#include "CookCache.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+bool CookCache::load() {
+    entries.clear();
+    std::ifstream file(fs::path(directory) / DATABASE_NAME, std::ios::binary);
+    if (!file.is_open()) {
+        return false; // Nothing cooked yet
+    }
+    FileHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+        return false;
+    }
+    for (uint32_t i = 0; i < header.entryCount; ++i) {
+        FileEntry record{};
+        std::string name;
+        if (!file.read(reinterpret_cast<char*>(&record), sizeof(record))) break;
+        name.resize(record.nameLength);
+        if (!file.read(name.data(), record.nameLength)) break;
+        entries[std::move(name)] = Entry{record.sourceSize, record.sourceTime, record.sourceHash,
+                                         record.outputSize, record.cookVersion};
+    }
+    return true;
+}
+
+bool CookCache::save(std::string& error) const {
+    // Written aside and renamed over, so an interrupted cook leaves the old record
+    const fs::path path = fs::path(directory) / DATABASE_NAME;
+    const fs::path temporary = path.string() + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            error = "Cannot write " + temporary.string();
+            return false;
+        }
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.entryCount = static_cast<uint32_t>(entries.size());
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const auto& [name, entry] : entries) {
+            FileEntry record{};
+            record.sourceSize = entry.sourceSize;
+            record.sourceTime = entry.sourceTime;
+            record.sourceHash = entry.sourceHash;
+            record.outputSize = entry.outputSize;
+            record.cookVersion = entry.cookVersion;
+            record.nameLength = static_cast<uint32_t>(name.size());
+            file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+            file.write(name.data(), static_cast<std::streamsize>(name.size()));
+        }
+        if (!file) {
+            error = "Cannot write " + temporary.string();
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(temporary, path, ec);
+    if (ec) {
+        error = "Cannot replace " + path.string() + ": " + ec.message();
+        return false;
+    }
+    return true;
+}
+
+const CookCache::Entry* CookCache::find(const std::string& name) const {
+    auto it = entries.find(name);
+    return it != entries.end() ? &it->second : nullptr;
+}
+
+std::string CookCache::getOutputPath(const std::string& name) const {
+    return (fs::path(directory) / (name + ".cooked")).string();
+}
+
+bool CookCache::isCurrent(const std::string& name, uint64_t sourceSize, int64_t sourceTime, uint32_t cookVersion) const {
+    const Entry* entry = find(name);
+    return entry && entry->sourceSize == sourceSize && entry->sourceTime == sourceTime &&
+           entry->cookVersion == cookVersion;
+}
@@ -0,0 +1,103 @@
+#include "CrowdRenderer.hpp"
+#include "RenderSnapshot.hpp"
+#include "RenderQueue.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+
+void CrowdRenderer::begin() {
+    // Pages that stayed empty for a whole frame belong to textures no longer drawn
+    pages.erase(std::remove_if(pages.begin(), pages.end(), [](const Page& page) { return page.vertices.empty(); }),
+                pages.end());
+    for (auto& page : pages) {
+        page.vertices.clear();
+    }
+    lastPage = 0;
+    active = true;
+}
+
+CrowdRenderer::Page& CrowdRenderer::findPage(const sf::Texture* texture, RenderCategory category, uint8_t views) {
+    const auto matches = [&](const Page& page) {
+        return page.texture == texture && page.category == category && page.views == views;
+    };
+    if (lastPage < pages.size() && matches(pages[lastPage])) {
+        return pages[lastPage];
+    }
+    for (size_t i = 0; i < pages.size(); ++i) {
+        if (matches(pages[i])) {
+            lastPage = i;
+            return pages[i];
+        }
+    }
+    lastPage = pages.size();
+    pages.push_back(Page{texture, category, views, {}});
+    return pages.back();
+}
+
+void CrowdRenderer::add(const sf::Texture* page, RenderCategory category, const sf::FloatRect& bounds,
+                        const sf::IntRect& textureRect, bool flipX, const sf::Color& color, uint8_t views) {
+    if (!active) return;
+
+    float u0 = static_cast<float>(textureRect.position.x);
+    float u1 = u0 + static_cast<float>(textureRect.size.x);
+    const float v0 = static_cast<float>(textureRect.position.y);
+    const float v1 = v0 + static_cast<float>(textureRect.size.y);
+    if (flipX) {
+        std::swap(u0, u1);
+    }
+    const float x0 = bounds.position.x;
+    const float y0 = bounds.position.y;
+    const float x1 = x0 + bounds.size.x;
+    const float y1 = y0 + bounds.size.y;
+
+    // Written in place; the vector only grows until it reaches the crowd's size
+    std::vector<sf::Vertex>& vertices = findPage(page, category, views).vertices;
+    const size_t first = vertices.size();
+    vertices.resize(first + 6);
+    sf::Vertex* quad = vertices.data() + first;
+    quad[0] = sf::Vertex{{x0, y0}, color, {u0, v0}};
+    quad[1] = sf::Vertex{{x1, y0}, color, {u1, v0}};
+    quad[2] = sf::Vertex{{x0, y1}, color, {u0, v1}};
+    quad[3] = quad[2];
+    quad[4] = quad[1];
+    quad[5] = sf::Vertex{{x1, y1}, color, {u1, v1}};
+    frameStats.characters++;
+}
+
+void CrowdRenderer::end(sf::RenderTarget& target, RenderStats& renderStats) {
+    PROFILE_ZONE("CrowdRenderer::end");
+    active = false;
+    for (const auto& page : pages) {
+        if (page.vertices.empty()) continue;
+        sf::RenderStates states;
+        states.texture = page.texture;
+        renderStats.draw(target, page.vertices.data(), page.vertices.size(), sf::PrimitiveType::Triangles,
+                         page.category, states);
+        frameStats.drawCalls++;
+        frameStats.vertices += page.vertices.size();
+    }
+}
+
+void CrowdRenderer::end(RenderSnapshot& snapshot, uint8_t views) {
+    active = false;
+    for (const auto& page : pages) {
+        if (page.vertices.empty() || (page.views & views) == 0) continue;
+        snapshot.drawTriangles(page.vertices.data(), page.vertices.size(), page.texture, page.category);
+        frameStats.drawCalls++;
+        frameStats.vertices += page.vertices.size();
+    }
+}
+
+void CrowdRenderer::end(RenderQueue& queue, RenderLayer layer) {
+    active = false;
+    for (const auto& page : pages) {
+        if (page.vertices.empty()) continue;
+        queue.addTriangles(layer, 0, page.vertices.data(), page.vertices.size(), page.texture, page.category, page.views);
+        frameStats.drawCalls++;
+        frameStats.vertices += page.vertices.size();
+    }
+}
+
+void CrowdRenderer::endFrame() {
+    lastFrameStats = frameStats;
+    frameStats = Stats();
+}
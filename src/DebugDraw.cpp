@@ -0,0 +1,109 @@
+#include "DebugDraw.hpp"
+#include "RenderSnapshot.hpp"
+#include "RenderQueue.hpp"
+#include <algorithm>
+#include <cmath>
+
+void DebugDraw::quad(const sf::Vector2f& a, const sf::Vector2f& b, const sf::Vector2f& c, const sf::Vector2f& d,
+                     const sf::Color& color) {
+    // a-b-c-d in winding order, as two triangles
+    vertices.push_back(sf::Vertex{a, color});
+    vertices.push_back(sf::Vertex{b, color});
+    vertices.push_back(sf::Vertex{c, color});
+    vertices.push_back(sf::Vertex{a, color});
+    vertices.push_back(sf::Vertex{c, color});
+    vertices.push_back(sf::Vertex{d, color});
+}
+
+void DebugDraw::line(const sf::Vector2f& from, const sf::Vector2f& to, const sf::Color& color, float thickness) {
+    const sf::Vector2f delta = to - from;
+    const float length = std::sqrt(delta.x * delta.x + delta.y * delta.y);
+    if (length <= 0.f) {
+        return;
+    }
+    const sf::Vector2f normal(-delta.y / length * thickness * 0.5f, delta.x / length * thickness * 0.5f);
+    quad(from - normal, to - normal, to + normal, from + normal, color);
+    ++primitives;
+}
+
+void DebugDraw::outlineQuads(const sf::FloatRect& bounds, const sf::Color& outline, float thickness) {
+    const sf::Vector2f min = bounds.position;
+    const sf::Vector2f max = bounds.position + bounds.size;
+    const float t = std::min({thickness, bounds.size.x * 0.5f, bounds.size.y * 0.5f});
+    if (t <= 0.f) {
+        return;
+    }
+    // Top and bottom span the full width; the sides fill the gap between them
+    quad(min, {max.x, min.y}, {max.x, min.y + t}, {min.x, min.y + t}, outline);
+    quad({min.x, max.y - t}, {max.x, max.y - t}, max, {min.x, max.y}, outline);
+    quad({min.x, min.y + t}, {min.x + t, min.y + t}, {min.x + t, max.y - t}, {min.x, max.y - t}, outline);
+    quad({max.x - t, min.y + t}, {max.x, min.y + t}, {max.x, max.y - t}, {max.x - t, max.y - t}, outline);
+}
+
+void DebugDraw::rectOutline(const sf::FloatRect& bounds, const sf::Color& outline, float thickness) {
+    outlineQuads(bounds, outline, thickness);
+    ++primitives;
+}
+
+void DebugDraw::rect(const sf::FloatRect& bounds, const sf::Color& fill, const sf::Color& outline, float thickness) {
+    if (fill.a > 0) {
+        const sf::Vector2f min = bounds.position;
+        const sf::Vector2f max = bounds.position + bounds.size;
+        quad(min, {max.x, min.y}, max, {min.x, max.y}, fill);
+    }
+    if (outline.a > 0) {
+        outlineQuads(bounds, outline, thickness);
+    }
+    ++primitives;
+}
+
+void DebugDraw::circle(const sf::Vector2f& center, float radius, const sf::Color& fill, const sf::Color& outline,
+                       float thickness, unsigned segments) {
+    segments = std::max(segments, 3u);
+    const float inner = std::max(radius - thickness, 0.f);
+    const float step = 2.f * 3.14159265f / segments;
+    sf::Vector2f previous(radius, 0.f);
+    for (unsigned i = 1; i <= segments; ++i) {
+        const sf::Vector2f next(std::cos(step * i) * radius, std::sin(step * i) * radius);
+        if (fill.a > 0) {
+            const float scale = radius > 0.f ? inner / radius : 0.f;
+            vertices.push_back(sf::Vertex{center, fill});
+            vertices.push_back(sf::Vertex{center + previous * scale, fill});
+            vertices.push_back(sf::Vertex{center + next * scale, fill});
+        }
+        if (outline.a > 0 && radius > 0.f) {
+            const float scale = inner / radius;
+            quad(center + previous * scale, center + previous, center + next, center + next * scale, outline);
+        }
+        previous = next;
+    }
+    ++primitives;
+}
+
+void DebugDraw::flush(sf::RenderTarget& target, RenderStats& renderStats, RenderCategory category) {
+    lastFlushStats.primitives = primitives;
+    lastFlushStats.vertices = vertices.size();
+    if (!vertices.empty()) {
+        renderStats.draw(target, vertices.data(), vertices.size(), sf::PrimitiveType::Triangles, category);
+    }
+    clear();
+}
+
+void DebugDraw::flush(RenderSnapshot& snapshot, RenderCategory category) {
+    lastFlushStats.primitives = primitives;
+    lastFlushStats.vertices = vertices.size();
+    snapshot.draw(vertices.data(), vertices.size(), sf::PrimitiveType::Triangles, category);
+    clear();
+}
+
+void DebugDraw::flush(RenderQueue& queue, RenderLayer layer, RenderCategory category) {
+    lastFlushStats.primitives = primitives;
+    lastFlushStats.vertices = vertices.size();
+    queue.addTriangles(layer, 0, vertices.data(), vertices.size(), nullptr, category);
+    clear();
+}
+
+void DebugDraw::clear() {
+    vertices.clear();
+    primitives = 0;
+}
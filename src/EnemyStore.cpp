@@ -0,0 +1,323 @@
+#include "EnemyStore.hpp"
+#include "ViewCulling.hpp"
+#include "SimSnapshot.hpp"
+#include "FixedPoint.hpp"
+#include <algorithm>
+#include <cmath>
+
+void EnemyStore::resize(size_t count) {
+    posX.resize(count);
+    posY.resize(count);
+    velX.resize(count);
+    velY.resize(count);
+    direction.resize(count);
+    patrolStart.resize(count);
+    patrolWidth.resize(count);
+    speed.resize(count);
+    gravity.resize(count);
+    awake.resize(count, 1);
+    width.resize(count);
+    height.resize(count);
+    stepStartX.resize(count);
+    stepStartY.resize(count);
+    prevX.resize(count);
+    prevY.resize(count);
+    onGround.resize(count, 0);
+    restTicks.resize(count, 0);
+    support.resize(count, -1);
+    coarse.resize(count, 0);
+    coarseLeft.resize(count);
+    coarseRange.resize(count);
+    coarsePhase.resize(count);
+    type.resize(count);
+    color.resize(count);
+}
+
+void EnemyStore::clear() {
+    resize(0);
+}
+
+void EnemyStore::saveState(SimSnapshot& snapshot) const {
+    snapshot.writeArray(posX);
+    snapshot.writeArray(posY);
+    snapshot.writeArray(velX);
+    snapshot.writeArray(velY);
+    snapshot.writeArray(direction);
+    snapshot.writeArray(awake);
+    snapshot.writeArray(onGround);
+    snapshot.writeArray(restTicks);
+    snapshot.writeArray(coarse);
+    snapshot.writeArray(coarseLeft);
+    snapshot.writeArray(coarseRange);
+    snapshot.writeArray(coarsePhase);
+    snapshot.write(clock);
+}
+
+bool EnemyStore::loadState(SimSnapshot& snapshot) {
+    if (!(snapshot.readArray(posX) && snapshot.readArray(posY) &&
+          snapshot.readArray(velX) && snapshot.readArray(velY) &&
+          snapshot.readArray(direction) && snapshot.readArray(awake) &&
+          snapshot.readArray(onGround) && snapshot.readArray(restTicks) &&
+          snapshot.readArray(coarse) && snapshot.readArray(coarseLeft) &&
+          snapshot.readArray(coarseRange) && snapshot.readArray(coarsePhase) && snapshot.read(clock))) {
+        return false;
+    }
+    if (posX.size() != speed.size()) {
+        return false; // Another set of enemies; the spawn data wouldn't line up
+    }
+    std::copy(posX.begin(), posX.end(), stepStartX.begin());
+    std::copy(posY.begin(), posY.end(), stepStartY.begin());
+    std::copy(posX.begin(), posX.end(), prevX.begin());
+    std::copy(posY.begin(), posY.end(), prevY.begin());
+    return true;
+}
+
+void EnemyStore::snapState() {
+    FixedPoint::snap(posX.data(), posX.size());
+    FixedPoint::snap(posY.data(), posY.size());
+    FixedPoint::snap(velX.data(), velX.size());
+    FixedPoint::snap(velY.data(), velY.size());
+    if constexpr (FixedPoint::ENABLED) {
+        // The step is resolved by now, so it starts the next one from here
+        std::copy(posX.begin(), posX.end(), stepStartX.begin());
+        std::copy(posY.begin(), posY.end(), stepStartY.begin());
+    }
+}
+
+void EnemyStore::reserve(size_t count) {
+    posX.reserve(count);
+    posY.reserve(count);
+    velX.reserve(count);
+    velY.reserve(count);
+    direction.reserve(count);
+    patrolStart.reserve(count);
+    patrolWidth.reserve(count);
+    speed.reserve(count);
+    gravity.reserve(count);
+    awake.reserve(count);
+    width.reserve(count);
+    height.reserve(count);
+    stepStartX.reserve(count);
+    stepStartY.reserve(count);
+    prevX.reserve(count);
+    prevY.reserve(count);
+    onGround.reserve(count);
+    restTicks.reserve(count);
+    support.reserve(count);
+    coarse.reserve(count);
+    coarseLeft.reserve(count);
+    coarseRange.reserve(count);
+    coarsePhase.reserve(count);
+    type.reserve(count);
+    color.reserve(count);
+}
+
+uint32_t EnemyStore::spawn(const LevelData::EnemyType& enemyType, uint16_t typeIndex, const sf::Vector2f& position,
+                           float patrol, float speedScale) {
+    const size_t i = size();
+    resize(i + 1);
+    posX[i] = prevX[i] = stepStartX[i] = position.x;
+    posY[i] = prevY[i] = stepStartY[i] = position.y;
+    speed[i] = enemyType.speed * speedScale;
+    gravity[i] = enemyType.gravity;
+    direction[i] = 1.0f; // Every enemy starts out moving right
+    velX[i] = speed[i];
+    velY[i] = 0.0f;
+    // Patrols that would reach back past the left edge start a little in from it
+    patrolStart[i] = std::max(position.x, MIN_PATROL_START);
+    patrolWidth[i] = patrol;
+    width[i] = enemyType.size.x;
+    height[i] = enemyType.size.y;
+    type[i] = typeIndex;
+    color[i] = enemyType.color;
+    return static_cast<uint32_t>(i);
+}
+
+void EnemyStore::append(const EnemyStore& from, size_t fromIndex) {
+    resize(size() + 1);
+    assign(size() - 1, from, fromIndex);
+}
+
+void EnemyStore::assign(size_t i, const EnemyStore& from, size_t j) {
+    posX[i] = from.posX[j];
+    posY[i] = from.posY[j];
+    velX[i] = from.velX[j];
+    velY[i] = from.velY[j];
+    direction[i] = from.direction[j];
+    patrolStart[i] = from.patrolStart[j];
+    patrolWidth[i] = from.patrolWidth[j];
+    speed[i] = from.speed[j];
+    gravity[i] = from.gravity[j];
+    awake[i] = from.awake[j];
+    width[i] = from.width[j];
+    height[i] = from.height[j];
+    stepStartX[i] = from.stepStartX[j];
+    stepStartY[i] = from.stepStartY[j];
+    prevX[i] = from.prevX[j];
+    prevY[i] = from.prevY[j];
+    onGround[i] = from.onGround[j];
+    restTicks[i] = from.restTicks[j];
+    support[i] = -1; // Found again by its next sweep
+    coarse[i] = from.coarse[j];
+    coarseLeft[i] = from.coarseLeft[j];
+    coarseRange[i] = from.coarseRange[j];
+    coarsePhase[i] = from.coarsePhase[j];
+    type[i] = from.type[j];
+    color[i] = from.color[j];
+}
+
+void EnemyStore::storePreviousState() {
+    std::copy(posX.begin(), posX.end(), prevX.begin());
+    std::copy(posY.begin(), posY.end(), prevY.begin());
+}
+
+void EnemyStore::update(size_t begin, size_t end, float deltaTime, const LevelGeometry& platforms) {
+    end = std::min(end, size());
+    if (begin >= end) {
+        return;
+    }
+    // Velocities are per-step values; scale in case the step rate differs
+    updatePatrol(begin, end, deltaTime * TUNED_STEP_RATE);
+    // Platform collisions are resolved by PhysicsSystem; onGround is from the last sweep
+    updateEdges(begin, end, platforms);
+}
+
+void EnemyStore::demote(size_t i, float left, float range) {
+    range = std::max(range, 0.0f);
+    const float x = std::clamp(posX[i], left, left + range);
+    // Phase runs 0..range walking right, then range..2 * range walking back
+    const double phase = direction[i] > 0.0f ? x - left : 2.0f * range - (x - left);
+    const double loop = 2.0 * range;
+    coarse[i] = 1;
+    awake[i] = 0;
+    restTicks[i] = 0;
+    coarseLeft[i] = left;
+    coarseRange[i] = range;
+    coarsePhase[i] = loop > 0.0 ? static_cast<float>(std::fmod(phase - speed[i] * clock, loop)) : 0.0f;
+}
+
+double EnemyStore::getCoarsePhase(size_t i) const {
+    const double loop = 2.0 * coarseRange[i];
+    if (loop <= 0.0) {
+        return 0.0;
+    }
+    const double phase = std::fmod(coarsePhase[i] + speed[i] * clock, loop);
+    return phase < 0.0 ? phase + loop : phase;
+}
+
+sf::Vector2f EnemyStore::getCoarsePosition(size_t i) const {
+    const double phase = getCoarsePhase(i);
+    const double along = phase < coarseRange[i] ? phase : 2.0 * coarseRange[i] - phase;
+    return sf::Vector2f(coarseLeft[i] + static_cast<float>(along), posY[i]);
+}
+
+void EnemyStore::promote(size_t i) {
+    if (!coarse[i]) {
+        return;
+    }
+    posX[i] = getCoarsePosition(i).x;
+    direction[i] = getCoarsePhase(i) < coarseRange[i] ? 1.0f : -1.0f;
+    velX[i] = direction[i] * speed[i];
+    velY[i] = 0.0f;
+    // Picks up from here, with nothing to interpolate or sweep from
+    stepStartX[i] = prevX[i] = posX[i];
+    stepStartY[i] = prevY[i] = posY[i];
+    coarse[i] = 0;
+    awake[i] = 1;
+    restTicks[i] = 0;
+}
+
+void EnemyStore::updatePatrol(size_t begin, size_t end, float stepScale) {
+    // Selects rather than branches over plain arrays, so this loop vectorizes
+    float* const x = posX.data();
+    float* const y = posY.data();
+    float* const vx = velX.data();
+    float* const vy = velY.data();
+    float* const dir = direction.data();
+    float* const sx = stepStartX.data();
+    float* const sy = stepStartY.data();
+    const float* const start = patrolStart.data();
+    const float* const range = patrolWidth.data();
+    const float* const walk = speed.data();
+    const float* const fall = gravity.data();
+    const uint8_t* const run = awake.data();
+    for (size_t i = begin; i < end; ++i) {
+        // The physics sweep resolves this step's move from here
+        sx[i] = x[i];
+        sy[i] = y[i];
+
+        // Turn around at either end of the patrol
+        float heading = dir[i];
+        heading = (heading > 0.0f && x[i] >= start[i] + range[i]) ? -1.0f : heading;
+        heading = (heading < 0.0f && x[i] <= start[i]) ? 1.0f : heading;
+
+        const float newVelY = vy[i] + fall[i] * stepScale;
+        float newX = x[i] + heading * walk[i] * stepScale;
+        const float newY = y[i] + newVelY * stepScale;
+
+        // Never past the left edge, and back to the start if something knocked it off its patrol
+        const bool atEdge = newX < MIN_X;
+        newX = atEdge ? MIN_X : newX;
+        heading = atEdge ? 1.0f : heading;
+        const bool strayed = std::abs(newX - start[i]) > range[i] * 1.5f;
+        newX = strayed ? start[i] : newX;
+        heading = strayed ? 1.0f : heading;
+
+        const bool moving = run[i] != 0;
+        x[i] = moving ? newX : x[i];
+        y[i] = moving ? newY : y[i];
+        dir[i] = moving ? heading : dir[i];
+        vx[i] = moving ? heading * walk[i] : vx[i];
+        vy[i] = moving ? newVelY : vy[i];
+    }
+}
+
+void EnemyStore::updateEdges(size_t begin, size_t end, const LevelGeometry& platforms) {
+    for (size_t i = begin; i < end; ++i) {
+        if (!awake[i] || !onGround[i]) {
+            continue;
+        }
+        // Probe just past each side at foot level for a platform to stand on
+        const float leftCheck = posX[i] - 5.0f;
+        const float rightCheck = posX[i] + width[i] + 5.0f;
+        const float feet = posY[i] + height[i];
+        bool leftSupported = false;
+        bool rightSupported = false;
+        for (const sf::FloatRect& platform : platforms.getBounds()) {
+            const sf::Vector2f& position = platform.position;
+            if (std::abs(feet - position.y) >= 5.0f) {
+                continue;
+            }
+            const float right = position.x + platform.size.x;
+            leftSupported |= leftCheck >= position.x && leftCheck <= right;
+            rightSupported |= rightCheck >= position.x && rightCheck <= right;
+        }
+
+        // Reverse direction if about to walk off an edge
+        if (!leftSupported && direction[i] < 0.0f) {
+            direction[i] = 1.0f;
+        } else if (!rightSupported && direction[i] > 0.0f) {
+            direction[i] = -1.0f;
+        }
+        velX[i] = direction[i] * speed[i];
+    }
+}
+
+void EnemyStore::turnAround(size_t i, int wall) {
+    direction[i] = wall < 0 ? 1.0f : -1.0f;
+    velX[i] = direction[i] * speed[i];
+}
+
+size_t EnemyStore::addToCrowd(CrowdRenderer& crowd, const ViewCulling::ViewSet& views, float alpha) const {
+    size_t drawn = 0;
+    for (size_t i = 0; i < size(); ++i) {
+        const sf::FloatRect bounds(getRenderPosition(i, alpha), getSize(i));
+        const uint8_t seenBy = views.visibleMask(bounds);
+        if (seenBy == 0) {
+            continue;
+        }
+        crowd.add(nullptr, RenderCategory::Enemies, bounds, sf::IntRect(), false, color[i], seenBy);
+        ++drawn;
+    }
+    return drawn;
+}
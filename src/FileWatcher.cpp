@@ -0,0 +1,170 @@
+#include "FileWatcher.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+bool FileWatcher::start(const std::string& directory) {
+    stop();
+    std::error_code ec;
+    if (!fs::is_directory(directory, ec)) {
+        std::cerr << "FileWatcher: not a directory: " << directory << std::endl;
+        return false;
+    }
+    root = directory;
+    stopping.store(false, std::memory_order_relaxed);
+    worker = std::thread(&FileWatcher::run, this);
+    return true;
+}
+
+void FileWatcher::stop() {
+    if (!worker.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping.store(true, std::memory_order_relaxed);
+    }
+    wake.notify_all();
+    worker.join();
+    pending.clear();
+}
+
+size_t FileWatcher::takeChanges(std::vector<std::string>& out) {
+    const auto settled = std::chrono::steady_clock::now() - SETTLE_TIME;
+    size_t count = 0;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (it->second <= settled) {
+            out.push_back(it->first);
+            it = pending.erase(it);
+            count++;
+        } else {
+            ++it;
+        }
+    }
+    return count;
+}
+
+bool FileWatcher::isSameFile(const std::string& a, const std::string& b) {
+    if (a == b) {
+        return true;
+    }
+    std::error_code ec;
+    return fs::equivalent(a, b, ec) && !ec;
+}
+
+void FileWatcher::noteChange(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending[path] = std::chrono::steady_clock::now();
+}
+
+void FileWatcher::run() {
+    if (watchNative()) {
+        return;
+    }
+    polling.store(true, std::memory_order_relaxed);
+    watchPolling();
+}
+
+bool FileWatcher::watchNative() {
+#ifdef __linux__
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    // One watch per directory; inotify is not recursive
+    std::unordered_map<int, std::string> directories;
+    auto addWatch = [&](const std::string& directory) {
+        const int wd = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (wd >= 0) {
+            directories[wd] = directory;
+        }
+    };
+    addWatch(root);
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(root, ec); !ec && it != fs::recursive_directory_iterator();
+         it.increment(ec)) {
+        if (it->is_directory(ec)) {
+            addWatch(it->path().string());
+        }
+    }
+    if (directories.empty()) {
+        close(fd);
+        return false;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    while (!stopping.load(std::memory_order_relaxed)) {
+        // Short timeout so stop() is noticed without a wake-up pipe
+        pollfd descriptor{fd, POLLIN, 0};
+        if (poll(&descriptor, 1, 100) <= 0) {
+            continue;
+        }
+        const ssize_t length = read(fd, buffer, sizeof(buffer));
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            auto directory = directories.find(event->wd);
+            if (directory == directories.end() || event->len == 0) {
+                continue;
+            }
+            const std::string path = (fs::path(directory->second) / event->name).string();
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    addWatch(path); // Files saved into it before the watch lands are missed
+                }
+            } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                noteChange(path);
+            }
+        }
+    }
+    close(fd);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void FileWatcher::watchPolling() {
+    struct Stamp {
+        uintmax_t size;
+        fs::file_time_type modified;
+    };
+    std::unordered_map<std::string, Stamp> stamps;
+    bool first = true;
+
+    while (true) {
+        std::error_code ec;
+        for (auto it = fs::recursive_directory_iterator(root, ec); !ec && it != fs::recursive_directory_iterator();
+             it.increment(ec)) {
+            if (!it->is_regular_file(ec)) continue;
+            const Stamp stamp{it->file_size(ec), it->last_write_time(ec)};
+            auto [entry, added] = stamps.try_emplace(it->path().string(), stamp);
+            if (!added && (entry->second.size != stamp.size || entry->second.modified != stamp.modified)) {
+                entry->second = stamp;
+                noteChange(entry->first);
+            } else if (added && !first) {
+                noteChange(entry->first);
+            }
+        }
+        first = false;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (wake.wait_for(lock, POLL_INTERVAL, [this] { return stopping.load(std::memory_order_relaxed); })) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#include "FrameArena.hpp"
+#include <algorithm>
+#include <cstdint>
+
+FrameArena& FrameArena::instance() {
+    static FrameArena arena;
+    return arena;
+}
+
+FrameArena& FrameArena::level() {
+    static FrameArena arena(LEVEL_CAPACITY);
+    return arena;
+}
+
+FrameArena::FrameArena(size_t capacity) {
+    addBlock(capacity);
+}
+
+void FrameArena::addBlock(size_t minimumSize) {
+    const size_t previous = blocks.empty() ? 0 : blocks.back().size;
+    Block block;
+    block.size = std::max(minimumSize, previous * 2);
+    block.data = std::make_unique<std::byte[]>(block.size);
+    if (!blocks.empty()) {
+        usedInFullBlocks += offset;
+    }
+    blocks.push_back(std::move(block));
+    offset = 0;
+    blockAllocations++;
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment) {
+    const auto alignedOffset = [&](const Block& block) {
+        const uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+        return static_cast<size_t>(((base + offset + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base);
+    };
+
+    size_t start = alignedOffset(blocks.back());
+    if (start + bytes > blocks.back().size) {
+        addBlock(bytes + alignment);
+        start = alignedOffset(blocks.back());
+    }
+    offset = start + bytes;
+    peakBytes = std::max(peakBytes, usedInFullBlocks + offset);
+    return blocks.back().data.get() + start;
+}
+
+void FrameArena::deallocate(void* pointer, size_t bytes) {
+    std::byte* top = blocks.back().data.get() + offset;
+    if (static_cast<std::byte*>(pointer) + bytes == top) {
+        offset -= bytes;
+    }
+}
+
+void FrameArena::reset() {
+    // A frame that spilled into extra blocks gets one block big enough for all of it
+    if (blocks.size() > 1) {
+        size_t total = 0;
+        for (const auto& block : blocks) {
+            total += block.size;
+        }
+        blocks.clear();
+        usedInFullBlocks = 0;
+        addBlock(total);
+    }
+    offset = 0;
+    usedInFullBlocks = 0;
+}
+
+FrameArena::Stats FrameArena::getStats() const {
+    Stats stats;
+    stats.bytesUsed = usedInFullBlocks + offset;
+    stats.peakBytes = peakBytes;
+    for (const auto& block : blocks) {
+        stats.capacity += block.size;
+    }
+    stats.blockAllocations = blockAllocations;
+    return stats;
+}
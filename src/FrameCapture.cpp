@@ -0,0 +1,378 @@
+#include "FrameCapture.hpp"
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Window/Context.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+#if defined(_WIN32)
+#define FRAME_CAPTURE_APIENTRY __stdcall
+#else
+#define FRAME_CAPTURE_APIENTRY
+#endif
+
+// From gl.h / glext.h; only what the readback needs
+constexpr unsigned int GL_RGBA = 0x1908;
+constexpr unsigned int GL_UNSIGNED_BYTE = 0x1401;
+constexpr unsigned int GL_PIXEL_PACK_BUFFER = 0x88EB;
+constexpr unsigned int GL_STREAM_READ = 0x88E1;
+constexpr unsigned int GL_READ_ONLY = 0x88B8;
+constexpr unsigned int GL_SYNC_GPU_COMMANDS_COMPLETE = 0x9117;
+constexpr unsigned int GL_ALREADY_SIGNALED = 0x911A;
+constexpr unsigned int GL_CONDITION_SATISFIED = 0x911C;
+
+using GenBuffers = void(FRAME_CAPTURE_APIENTRY*)(int count, unsigned int* ids);
+using BindBuffer = void(FRAME_CAPTURE_APIENTRY*)(unsigned int target, unsigned int id);
+using BufferData = void(FRAME_CAPTURE_APIENTRY*)(unsigned int target, std::ptrdiff_t size, const void* data,
+                                                 unsigned int usage);
+using MapBuffer = void*(FRAME_CAPTURE_APIENTRY*)(unsigned int target, unsigned int access);
+using UnmapBuffer = unsigned char(FRAME_CAPTURE_APIENTRY*)(unsigned int target);
+using ReadPixels = void(FRAME_CAPTURE_APIENTRY*)(int x, int y, int width, int height, unsigned int format,
+                                                 unsigned int type, void* pixels);
+using FenceSync = void*(FRAME_CAPTURE_APIENTRY*)(unsigned int condition, unsigned int flags);
+using ClientWaitSync = unsigned int(FRAME_CAPTURE_APIENTRY*)(void* sync, unsigned int flags, uint64_t timeout);
+using DeleteSync = void(FRAME_CAPTURE_APIENTRY*)(void* sync);
+
+GenBuffers glGenBuffers = nullptr;
+BindBuffer glBindBuffer = nullptr;
+BufferData glBufferData = nullptr;
+MapBuffer glMapBuffer = nullptr;
+UnmapBuffer glUnmapBuffer = nullptr;
+ReadPixels glReadPixels = nullptr;
+FenceSync glFenceSync = nullptr; // Optional (GL 3.2 / ARB_sync)
+ClientWaitSync glClientWaitSync = nullptr;
+DeleteSync glDeleteSync = nullptr;
+
+template <typename Function>
+bool loadFunction(Function& function, const char* name) {
+    function = reinterpret_cast<Function>(sf::Context::getFunction(name));
+    return function != nullptr;
+}
+
+} // namespace
+
+FrameCapture::~FrameCapture() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobReady.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void FrameCapture::requestScreenshot(const std::string& path, const std::string& tracePath, std::string trace) {
+    std::lock_guard<std::mutex> lock(requestMutex);
+    screenshotRequested = true;
+    screenshotPath = path;
+    screenshotTracePath = tracePath;
+    screenshotTrace = std::move(trace);
+}
+
+bool FrameCapture::startRecording(const std::string& path) {
+    std::lock_guard<std::mutex> lock(requestMutex);
+    if (!requestedRecordingPath.empty()) {
+        return false;
+    }
+    requestedRecordingPath = path;
+    recording.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void FrameCapture::stopRecording() {
+    std::lock_guard<std::mutex> lock(requestMutex);
+    requestedRecordingPath.clear();
+    recording.store(false, std::memory_order_relaxed);
+}
+
+FrameCapture::Stats FrameCapture::getStats() const {
+    std::lock_guard<std::mutex> lock(jobMutex);
+    Stats result = stats;
+    result.queued = jobs.size();
+    return result;
+}
+
+std::string FrameCapture::getLastPath() const {
+    std::lock_guard<std::mutex> lock(jobMutex);
+    return lastPath;
+}
+
+bool FrameCapture::initialize() {
+    const sf::Context* context = sf::Context::getActiveContext();
+    if (!context) {
+        return false; // Try again once there is one
+    }
+    initialized = true;
+    const sf::ContextSettings& settings = context->getSettings();
+    const bool core = settings.majorVersion > 2 || (settings.majorVersion == 2 && settings.minorVersion >= 1);
+    if (!core && !sf::Context::isExtensionAvailable("GL_ARB_pixel_buffer_object")) {
+        return false;
+    }
+    if (!loadFunction(glGenBuffers, "glGenBuffers") || !loadFunction(glBindBuffer, "glBindBuffer") ||
+        !loadFunction(glBufferData, "glBufferData") || !loadFunction(glMapBuffer, "glMapBuffer") ||
+        !loadFunction(glUnmapBuffer, "glUnmapBuffer") || !loadFunction(glReadPixels, "glReadPixels")) {
+        return false;
+    }
+    // Without fences a readback is simply mapped once it is old enough
+    if (!loadFunction(glFenceSync, "glFenceSync") || !loadFunction(glClientWaitSync, "glClientWaitSync") ||
+        !loadFunction(glDeleteSync, "glDeleteSync")) {
+        glFenceSync = nullptr;
+    }
+    std::array<unsigned int, PBO_COUNT> ids{};
+    glGenBuffers(static_cast<int>(ids.size()), ids.data());
+    for (size_t i = 0; i < PBO_COUNT; ++i) {
+        readbacks[i].buffer = ids[i];
+    }
+    available.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void FrameCapture::captureFrame(sf::Vector2u size) {
+    if (!initialized) {
+        initialize();
+    }
+    if (!available.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    bool wantScreenshot = false;
+    Readback request;
+    std::string wantedRecording;
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        wantScreenshot = screenshotRequested;
+        if (wantScreenshot) {
+            request.path = screenshotPath;
+            request.tracePath = screenshotTracePath;
+            request.trace = std::move(screenshotTrace);
+        }
+        screenshotRequested = false;
+        wantedRecording = requestedRecordingPath;
+    }
+
+    // Collect what has landed, oldest first, so frames reach the encoder in order
+    ++frameCounter;
+    current = static_cast<size_t>(frameCounter % PBO_COUNT);
+    bool recordingInFlight = false;
+    for (size_t i = 0; i < PBO_COUNT; ++i) {
+        Readback& readback = readbacks[(current + i) % PBO_COUNT];
+        if (readback.pending) {
+            collect(readback);
+        }
+        recordingInFlight |= readback.pending && readback.kind == Kind::Recording;
+    }
+
+    // A recording ends (or is replaced) once its last frames are in
+    if (!recordingPath.empty() && wantedRecording != recordingPath && !recordingInFlight) {
+        Job finish;
+        finish.kind = Kind::Recording;
+        finish.size = recordingSize;
+        finish.path = recordingPath;
+        finish.finish = true;
+        finish.frames = recordingFrames;
+        finish.seconds = std::chrono::duration<double>(recordingLast - recordingStart).count();
+        push(std::move(finish));
+        recordingPath.clear();
+    }
+    if (recordingPath.empty() && !wantedRecording.empty() && !recordingInFlight) {
+        recordingPath = wantedRecording;
+        recordingFrames = 0;
+        recordingSize = size;
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stats.recordedFrames = 0;
+        stats.droppedFrames = 0;
+    }
+    const bool wantRecording = !recordingPath.empty() && recordingPath == wantedRecording;
+    if ((!wantScreenshot && !wantRecording) || size.x == 0 || size.y == 0) {
+        return;
+    }
+
+    Readback& readback = readbacks[current];
+    if (readback.pending || (wantRecording && !wantScreenshot && size != recordingSize)) {
+        // The GPU is behind (or the window was resized mid-recording): skip
+        // this frame rather than wait. A screenshot tries again next frame.
+        if (wantScreenshot) {
+            std::lock_guard<std::mutex> lock(requestMutex);
+            if (!screenshotRequested) {
+                screenshotRequested = true;
+                screenshotPath = request.path;
+                screenshotTracePath = request.tracePath;
+                screenshotTrace = std::move(request.trace);
+            }
+        }
+        if (wantRecording) {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            stats.droppedFrames++;
+        }
+        return;
+    }
+
+    // A frame wanted by both goes to the screenshot; the recording skips it
+    readback.kind = wantScreenshot ? Kind::Screenshot : Kind::Recording;
+    readback.path = wantScreenshot ? request.path : recordingPath;
+    readback.tracePath = std::move(request.tracePath);
+    readback.trace = std::move(request.trace);
+    readback.size = size;
+    const size_t bytes = static_cast<size_t>(size.x) * size.y * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+    if (readback.capacity != bytes) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<std::ptrdiff_t>(bytes), nullptr, GL_STREAM_READ);
+        readback.capacity = bytes;
+    }
+    // With a pack buffer bound the copy lands in it and the call returns at once
+    glReadPixels(0, 0, static_cast<int>(size.x), static_cast<int>(size.y), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback.fence = glFenceSync ? glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) : nullptr;
+    readback.frame = frameCounter;
+    readback.pending = true;
+    if (readback.kind == Kind::Recording) {
+        const auto now = std::chrono::steady_clock::now();
+        if (recordingFrames == 0) {
+            recordingStart = now;
+        }
+        recordingLast = now;
+        recordingFrames++;
+    } else if (wantRecording) {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stats.droppedFrames++;
+    }
+}
+
+bool FrameCapture::collect(Readback& readback) {
+    if (readback.fence) {
+        const unsigned int status = glClientWaitSync(readback.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            return false;
+        }
+        glDeleteSync(readback.fence);
+        readback.fence = nullptr;
+    } else if (frameCounter - readback.frame < PBO_COUNT - 1) {
+        return false; // Too recent to map without a stall
+    }
+    readback.pending = false;
+
+    Job job;
+    job.kind = readback.kind;
+    job.size = readback.size;
+    job.path = std::move(readback.path);
+    job.tracePath = std::move(readback.tracePath);
+    job.trace = std::move(readback.trace);
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        if (job.kind == Kind::Recording && jobs.size() >= MAX_QUEUED) {
+            stats.droppedFrames++; // The encoder can't keep up
+            return true;
+        }
+        if (!spareBuffers.empty()) {
+            job.pixels = std::move(spareBuffers.back());
+            spareBuffers.pop_back();
+        }
+    }
+    const size_t bytes = static_cast<size_t>(job.size.x) * job.size.y * 4;
+    job.pixels.resize(bytes);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+    const void* mapped = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (mapped) {
+        std::memcpy(job.pixels.data(), mapped, bytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!mapped) {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stats.failedWrites++;
+        return true;
+    }
+    push(std::move(job));
+    return true;
+}
+
+void FrameCapture::push(Job&& job) {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        if (!worker.joinable()) {
+            worker = std::thread(&FrameCapture::workerLoop, this);
+        }
+        jobs.push_back(std::move(job));
+    }
+    jobReady.notify_one();
+}
+
+void FrameCapture::workerLoop() {
+    std::unique_lock<std::mutex> lock(jobMutex);
+    for (;;) {
+        jobReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty()) {
+            break; // Stopping, and everything is written
+        }
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        encode(job);
+        lock.lock();
+        if (!job.pixels.empty() && spareBuffers.size() < MAX_QUEUED) {
+            spareBuffers.push_back(std::move(job.pixels));
+        }
+    }
+    if (recordingFile.is_open()) {
+        recordingFile.close(); // Shut down mid-recording; the frames so far stay
+    }
+}
+
+void FrameCapture::encode(Job& job) {
+    const size_t rowBytes = static_cast<size_t>(job.size.x) * 4;
+    bool written = true;
+    if (job.kind == Kind::Screenshot) {
+        // GL reads bottom row first; images are stored top row first
+        std::vector<uint8_t> row(rowBytes);
+        for (size_t top = 0, bottom = job.size.y - 1; top < bottom; ++top, --bottom) {
+            uint8_t* a = job.pixels.data() + top * rowBytes;
+            uint8_t* b = job.pixels.data() + bottom * rowBytes;
+            std::memcpy(row.data(), a, rowBytes);
+            std::memcpy(a, b, rowBytes);
+            std::memcpy(b, row.data(), rowBytes);
+        }
+        for (size_t i = 3; i < job.pixels.size(); i += 4) {
+            job.pixels[i] = 255; // The back buffer's alpha isn't meaningful
+        }
+        const sf::Image image(job.size, job.pixels.data());
+        written = image.saveToFile(job.path);
+        if (!job.tracePath.empty() && !job.trace.empty()) {
+            std::ofstream trace(job.tracePath);
+            trace << job.trace;
+            written = written && static_cast<bool>(trace);
+        }
+    } else if (job.finish) {
+        recordingFile.close();
+        // Raw frames carry no header; the sidecar says how to read them
+        std::ofstream info(job.path + ".txt");
+        const double fps = job.seconds > 0.0 && job.frames > 1 ? (job.frames - 1) / job.seconds : 60.0;
+        info << job.frames << " frames, " << job.size.x << "x" << job.size.y << " RGBA, " << job.seconds << " s\n"
+             << "ffmpeg -f rawvideo -pixel_format rgba -video_size " << job.size.x << "x" << job.size.y
+             << " -framerate " << fps << " -i \"" << job.path << "\" -pix_fmt yuv420p \"" << job.path << ".mp4\"\n";
+        written = static_cast<bool>(info);
+    } else {
+        if (!recordingFile.is_open()) {
+            recordingFile.open(job.path, std::ios::binary | std::ios::trunc);
+        }
+        for (size_t y = job.size.y; y-- > 0;) {
+            recordingFile.write(reinterpret_cast<const char*>(job.pixels.data() + y * rowBytes),
+                                static_cast<std::streamsize>(rowBytes));
+        }
+        written = static_cast<bool>(recordingFile);
+    }
+
+    std::lock_guard<std::mutex> lock(jobMutex);
+    if (!written) {
+        stats.failedWrites++;
+    } else if (job.kind == Kind::Screenshot) {
+        stats.screenshots++;
+        lastPath = job.path;
+    } else if (job.finish) {
+        lastPath = job.path;
+    } else {
+        stats.recordedFrames++;
+    }
+}
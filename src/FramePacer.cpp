@@ -0,0 +1,131 @@
+#include "FramePacer.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+void FramePacer::setMode(Mode newMode) {
+    mode = newMode;
+    reduced = false;
+    recoverFrames = 0;
+}
+
+void FramePacer::setTargetFps(unsigned fps) {
+    targetFps = std::max(fps, 1u);
+    reduced = false;
+    recoverFrames = 0;
+}
+
+unsigned FramePacer::getCurrentFps() const {
+    unsigned fps = 0;
+    switch (mode) {
+        case Mode::Limiter: fps = targetFps; break;
+        case Mode::Adaptive: fps = reduced ? std::max(targetFps / 2, 1u) : targetFps; break;
+        case Mode::VSync:
+        case Mode::Uncapped: break;
+    }
+    return throttleFps > 0 && (fps == 0 || throttleFps < fps) ? throttleFps : fps;
+}
+
+float FramePacer::smooth(float rawSeconds) {
+    recentDt[dtNext] = rawSeconds;
+    dtNext = (dtNext + 1) % SMOOTH_FRAMES;
+    dtCount = std::min(dtCount + 1, SMOOTH_FRAMES);
+    if (!smoothing) {
+        return rawSeconds;
+    }
+    // A moving average keeps the total time advanced, only spread over a few frames
+    float sum = 0.0f;
+    for (size_t i = 0; i < dtCount; ++i) {
+        sum += recentDt[i];
+    }
+    return sum / static_cast<float>(dtCount);
+}
+
+void FramePacer::waitUntil(Clock::time_point deadline) const {
+    PROFILE_ZONE("FramePacer::wait");
+    const auto spin = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(SPIN_MS));
+    if (deadline - Clock::now() > spin) {
+        std::this_thread::sleep_until(deadline - spin);
+    }
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+void FramePacer::updateAdaptive(double workMs) {
+    workAverageMs = workAverageMs == 0.0 ? workMs : workAverageMs + (workMs - workAverageMs) * 0.1;
+    const double fullBudgetMs = 1000.0 / targetFps;
+    if (!reduced) {
+        reduced = workAverageMs > fullBudgetMs * ADAPTIVE_DROP;
+        recoverFrames = 0;
+    } else if (workAverageMs < fullBudgetMs * ADAPTIVE_RECOVER) {
+        if (++recoverFrames >= ADAPTIVE_RECOVER_FRAMES) {
+            reduced = false;
+            recoverFrames = 0;
+        }
+    } else {
+        recoverFrames = 0;
+    }
+}
+
+void FramePacer::endFrame() {
+    Clock::time_point now = Clock::now();
+    lastWorkMs = std::chrono::duration<double, std::milli>(now - frameStart).count();
+    if (mode == Mode::Adaptive) {
+        updateAdaptive(lastWorkMs);
+    }
+
+    Clock::time_point nextStart = now;
+    const unsigned fps = getCurrentFps();
+    if (fps > 0) {
+        const auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps));
+        const Clock::time_point deadline = frameStart + interval;
+        if (deadline > now) {
+            waitUntil(deadline);
+            nextStart = deadline; // Keeps the cadence instead of drifting by each wake-up's lateness
+            now = Clock::now();
+        }
+        // Late frames start the next one from now rather than trying to catch up
+    }
+
+    intervalsMs[intervalNext] = std::chrono::duration<double, std::milli>(now - frameStart).count();
+    intervalNext = (intervalNext + 1) % HISTORY;
+    intervalCount = std::min(intervalCount + 1, HISTORY);
+    frameStart = nextStart;
+}
+
+FramePacer::Stats FramePacer::getStats() const {
+    Stats stats;
+    const unsigned fps = getCurrentFps();
+    stats.targetMs = fps > 0 ? 1000.0 / fps : 0.0;
+    stats.workMs = lastWorkMs;
+    stats.reduced = reduced;
+    stats.throttled = throttleFps > 0 && fps == throttleFps;
+    stats.samples = intervalCount;
+    if (intervalCount == 0) {
+        return stats;
+    }
+    for (size_t i = 0; i < intervalCount; ++i) {
+        stats.meanMs += intervalsMs[i];
+        stats.worstMs = std::max(stats.worstMs, intervalsMs[i]);
+    }
+    stats.meanMs /= intervalCount;
+    for (size_t i = 0; i < intervalCount; ++i) {
+        const double delta = intervalsMs[i] - stats.meanMs;
+        stats.varianceMs2 += delta * delta;
+    }
+    stats.varianceMs2 /= intervalCount;
+    stats.stdDevMs = std::sqrt(stats.varianceMs2);
+    return stats;
+}
+
+const char* FramePacer::modeName(Mode mode) {
+    switch (mode) {
+        case Mode::VSync: return "VSync";
+        case Mode::Limiter: return "Limiter";
+        case Mode::Uncapped: return "Uncapped";
+        case Mode::Adaptive: return "Adaptive";
+    }
+    return "?";
+}
@@ -1,4 +1,13 @@
 #include "Game.hpp"
+#include "Profiler.hpp"
+#include "DebugLog.hpp"
+#include "FrameArena.hpp"
+#include "AllocationTracker.hpp"
+#include "AssetPack.hpp"
+#include "AssetManifest.hpp"
+#include "ImageCodec.hpp"
+#include "LevelAssets.hpp"
+#include <algorithm>
 #include <iostream>
 #include <cstdint> // For uint8_t
 #include <sstream>
@@ -6,29 +15,138 @@
 #include <filesystem>
 #include <chrono>
 #include <ctime>
+#include <cmath>
+#include <random>
+#include <cfloat>
+#include <iterator>
 
 namespace fs = std::filesystem;
 
-// Helper function for rectangle intersection (for SFML 3.x compatibility)
-static bool rectsIntersect(const sf::FloatRect& a, const sf::FloatRect& b) {
-    return a.position.x < b.position.x + b.size.x &&
-           a.position.x + a.size.x > b.position.x &&
-           a.position.y < b.position.y + b.size.y &&
-           a.position.y + a.size.y > b.position.y;
+// NPC contact box: 80% of the sprite, centred
+static sf::FloatRect getNPCContactBox(const NPC::NPCData& npc) {
+    sf::FloatRect spriteBounds = npc.getSpriteBounds();
+    float width = spriteBounds.size.x * 0.8f;
+    float height = spriteBounds.size.y * 0.8f;
+    float offsetX = (spriteBounds.size.x - width) / 2.0f;
+    float offsetY = (spriteBounds.size.y - height) / 2.0f;
+    return sf::FloatRect(sf::Vector2f(spriteBounds.position.x + offsetX, spriteBounds.position.y + offsetY),
+                         sf::Vector2f(width, height));
+}
+
+// Sizes and outlines the HUD texts use, prewarmed in the UI font
+struct TextStyle {
+    unsigned size;
+    float outline;
+};
+static constexpr TextStyle UI_TEXT_STYLES[] = {
+    {48, 2.f},  // Game over
+    {36, 2.f},  // Level
+    {24, 2.f},  // FPS
+    {24, 1.f},  // Restart
+    {18, 1.f},  // Loading progress
+    {14, 1.f},  // Culling counts
+};
+
+// Scene resolutions for the render scale setting (RenderingSystem::setSceneResolution);
+// the world view is 800x600, and the art's own pixels are half that with 2x tiles
+struct RenderScaleMode {
+    const char* name;
+    sf::Vector2u sceneResolution; // 0x0: window resolution
+};
+static const RenderScaleMode RENDER_SCALE_MODES[] = {
+    {"Native", sf::Vector2u(0, 0)},
+    {"800x600", sf::Vector2u(800, 600)},
+    {"400x300 (art pixels)", sf::Vector2u(400, 300)},
+};
+
+// Quality presets, lowest first: QualityGovernor's levels and the settings panel's choices
+struct QualityPreset {
+    const char* name;
+    size_t renderScaleMode;  // Into RENDER_SCALE_MODES
+    float particleBudget;    // Share of each emitter's budget
+    size_t backgroundLayers; // Parallax layers drawn, 0 = all
+    float aiDistance;        // Share of the AI LOD distances
+};
+static const QualityPreset QUALITY_PRESETS[] = {
+    {"Low", 2, 0.35f, 2, 0.5f},
+    {"Medium", 1, 0.65f, 3, 0.75f},
+    {"High", 0, 1.0f, 0, 1.0f},
+};
+
+// Resampled background images (AssetManager::setProcessedCacheDirectory)
+static const char* const PROCESSED_TEXTURE_CACHE = "texture_cache";
+
+static const char* const TILES_DIRECTORY = LevelAssets::TILES_DIRECTORY;
+
+// Texture name of a level's main background (loaded up front by preloadLevel)
+static std::string getLevelBackgroundKey(int level) {
+    return "background_level" + std::to_string(level);
+}
+
+// LevelAssets::Exists over the asset manifest
+static bool isListedAsset(const std::string& path) {
+    return AssetManifest::contains(path);
+}
+
+// The listed files directly inside 'directory' (LevelAssets::ListDirectory)
+static void listListedDirectory(const std::string& directory, std::vector<std::string>& files) {
+    const AssetPack& pack = AssetPack::instance();
+    if (pack.hasDirectory(directory)) {
+        for (auto& name : pack.listDirectory(directory)) {
+            files.push_back(std::move(name));
+        }
+        return;
+    }
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(AssetManifest::resolve(directory), ec)) {
+        const std::string name = directory + "/" + entry.path().filename().string();
+        if (isListedAsset(name)) {
+            files.push_back(name);
+        }
+    }
+}
+
+// 'candidates' without the assets the manifest doesn't list, the rest resolved
+// under the asset root; paths outside assets/ (system fonts) are kept as they are
+static std::vector<std::string> getListedCandidates(const std::vector<std::string>& candidates) {
+    std::vector<std::string> listed;
+    for (const auto& candidate : candidates) {
+        if (candidate.compare(0, AssetManifest::PREFIX.size(), AssetManifest::PREFIX) != 0) {
+            listed.push_back(candidate);
+        } else if (AssetManifest::contains(candidate)) {
+            listed.push_back(AssetManifest::resolve(candidate));
+        }
+    }
+    return listed;
+}
+
+// The level's background, or the first listed of its fallbacks
+static std::string getLevelBackgroundPath(const LevelData& level) {
+    const std::string path = LevelAssets::getBackgroundPath(level, isListedAsset);
+    return path.empty() ? path : AssetManifest::resolve(path);
+}
+
+// Loads a character texture the manifest lists; false (and no file access) if it isn't
+static bool loadListedCharacter(AssetManager& assets, const std::string& name, std::string_view path,
+                                std::string& error) {
+    if (!AssetManifest::contains(path)) {
+        error = "Not in the asset manifest: " + std::string(path);
+        return false;
+    }
+    if (!assets.tryLoadTexture(name, AssetManifest::resolve(path), AssetManager::TextureCategory::Character, error)) {
+        error = "Failed to load " + name + " sprite: " + error;
+        return false;
+    }
+    return true;
 }
 
 Game::Game() : window(sf::VideoMode(sf::Vector2u(WINDOW_WIDTH, WINDOW_HEIGHT)), "Platform Puzzle Game"),
                player(50.f, WINDOW_HEIGHT - GROUND_HEIGHT - 80.f, physicsSystem), // Pass physicsSystem reference
                playerHit(false),
-               playerHitCooldown(0.f),
                currentState(GameState::Playing),
-               gameOverText(defaultFont, sf::String("GAME OVER"), 48),
-               restartText(defaultFont, sf::String("Press ENTER to restart"), 24),
-               fpsText(defaultFont, sf::String("FPS: 0"), 16),
                showMiniMap(true),
                currentLevel(1),
-               transitionTimer(0.f),
-               levelText(defaultFont, sf::String("Level 1"), 36),
+               hud(defaultFont),
                playerPosition(50.f, WINDOW_HEIGHT / 2.f),
                playerSpeed(200.f),
                isRunning(true),
@@ -52,23 +170,57 @@ Game::Game() : window(sf::VideoMode(sf::Vector2u(WINDOW_WIDTH, WINDOW_HEIGHT)),
                showImGuiDemo(false),
                useImGuiInterface(true),
                showAssetManager(false),
-               previewAvailable(false),
                isMusicEnabled(true),
                isSoundEffectsEnabled(false),
                musicVolume(0.4f),
                soundEffectVolume(1.0f) {
     
+    PROFILE_THREAD("Main");
+    
     // Initialize logging system
-    gameLogFile.open(gameLogFileName, std::ios::out | std::ios::app);
-    if (gameLogFile.is_open()) {
-        logInfo("Game initialized - starting new session");
-    }
+    gameLogSink = AsyncLogger::instance().openSink(gameLogFileName, GAME_BINARY_LOG
+        ? AsyncLogger::SinkFormat::Binary : AsyncLogger::SinkFormat::Text);
+    logInfo("Game initialized - starting new session");
+    
+    // The Telemetry tab compares against a baseline saved in an earlier session, if any
+    std::string telemetryError;
+    hasTelemetryBaseline = SessionTelemetry::loadSummary(getTelemetryPath(TELEMETRY_BASELINE_FILE),
+                                                         telemetryBaseline, telemetryError);
     
     // Initialize sprite pointers with shared empty texture (created in loadAssets)
     // This is required because sf::Sprite has no default constructor in SFML 3.x
                
-    window.setFramerateLimit(FPS);
-    
+    framePacer.setTargetFps(FPS);
+    applyFramePacing();
+    
+    // Enemy physics passes are split across the job system's workers
+    physicsSystem.setJobSystem(&jobSystem);
+    
+    // The player reads the controls each step takes from inputSystem
+    player.setScriptedInput(&tickInput);
+    player.setEventQueue(&gameEvents);
+    physicsSystem.setEventQueue(&gameEvents);
+    
+    // Background layers decode on the job system's Streaming lane from here on;
+    // they are resampled at load to the size the window shows them at
+    startupProfile.begin("Background prefetch");
+    assets.setJobSystem(&jobSystem);
+    assets.setProcessedCacheDirectory(PROCESSED_TEXTURE_CACHE);
+    // The level's bundle is read ahead of the decodes queued behind it
+    levelBundles.setJobSystem(&jobSystem);
+    levelBundles.hold(currentLevel);
+    updateBackgroundDisplaySize();
+    initializeBackgroundLayers();
+    prefetchBackgroundLayers(currentLevel);
+    
+    // Levels are data files; everything below sizes itself from levelData
+    runStartupTasks();
+    collectLevelAssets();
+    platformColor = levelData.platformColor;
+    applyColorGrade();
+    renderingSystem.setLights(levelData.lights, levelData.ambientLight);
+    
+    startupProfile.begin("Views and particles");
 
     
     // Initialize view for scrolling
@@ -79,60 +231,116 @@ Game::Game() : window(sf::VideoMode(sf::Vector2u(WINDOW_WIDTH, WINDOW_HEIGHT)),
     uiView.setSize(sf::Vector2f(WINDOW_WIDTH, WINDOW_HEIGHT));
     uiView.setCenter(sf::Vector2f(WINDOW_WIDTH / 2.f, WINDOW_HEIGHT / 2.f));
     
-    // Initialize mini-map view
-    miniMapView.setSize(sf::Vector2f(LEVEL_WIDTH, WINDOW_HEIGHT));
-    miniMapView.setCenter(sf::Vector2f(LEVEL_WIDTH / 2.f, WINDOW_HEIGHT / 2.f));
-    
-    // Set viewport for mini-map view (fixed for SFML 3.x)
-    sf::Vector2f viewportPos(
-        1.0f - (float)(MINI_MAP_WIDTH + MINI_MAP_MARGIN) / WINDOW_WIDTH,
-        1.0f - (float)(MINI_MAP_HEIGHT + MINI_MAP_MARGIN) / WINDOW_HEIGHT
-    );
-    sf::Vector2f viewportSize(
-        (float)MINI_MAP_WIDTH / WINDOW_WIDTH,
-        (float)MINI_MAP_HEIGHT / WINDOW_HEIGHT
-    );
-    miniMapView.setViewport(sf::FloatRect(viewportPos, viewportSize));
+    // Mini-map cache: the map plus room for its outline
+    miniMapTextureValid = miniMapTexture.resize(sf::Vector2u(MINI_MAP_WIDTH + 2 * MINI_MAP_OUTLINE,
+                                                             MINI_MAP_HEIGHT + 2 * MINI_MAP_OUTLINE));
+    if (!miniMapTextureValid) {
+        logError("Failed to create the mini-map texture; the mini-map will be hidden");
+    }
+    
+    // Every level is a winter one, so the snow runs throughout
+    ParticleSystem::EmitterConfig snow;
+    snow.name = "snow";
+    snow.budget = SNOW_BUDGET;
+    snow.rate = 1200.f;
+    snow.sizeMin = 0.8f;
+    snow.sizeMax = 2.5f;
+    snow.gpuSimulated = true;
+    snowEmitter = renderingSystem.getParticles().addEmitter(snow);
+    qualityLevel = std::size(QUALITY_PRESETS) - 1; // High: what everything above starts at
+    qualityGovernor.setPreset(qualityLevel);
     
     window.setView(gameView);
     
     // Initialize NPC manager
-    npcManager = std::make_unique<NPC>(assets, renderingSystem);
+    {
+        AllocationTracker::ScopedTag memoryTag(AllocationTracker::Tag::Npcs);
+        npcManager = std::make_unique<NPC>(assets, renderingSystem);
+        npcManager->setJobSystem(&jobSystem);
+    }
     
-    // Load game assets
+    // Load game assets: uploads what the startup tasks and prefetch decoded,
+    // plus the character sprites and fonts
+    startupProfile.begin("Assets");
     loadAssets();
+    // Packed data takes precedence over loose files, so edits only show without a pack
+    if (!AssetPack::instance().isMounted()) {
+        assetRootDir = AssetManifest::getRoot();
+        assetWatcher.start(assetRootDir);
+    }
     
-    initializePlatforms();
+    startupProfile.begin("Sectors, NPCs and UI");
+    initializeSectors();
     initializeNPCs();  // Initialize NPCs after loading assets
-    initializeEnemies();
+    createHud();
     initializeUI();
-    initializeMiniMap();
     
     // Initialize ImGui
+    startupProfile.begin("ImGui");
     initializeImGui();
     
-    // Initialize FPS text
-    fpsText.setFillColor(sf::Color::White);
-    fpsText.setOutlineColor(sf::Color::Black);
-    fpsText.setOutlineThickness(2.0f);
-    fpsText.setCharacterSize(24); // Larger text
-    fpsText.setPosition(sf::Vector2f(WINDOW_WIDTH - 115, 8)); // Better centered within the background
-
-    // Initialize FPS background
-    fpsBackground.setSize(sf::Vector2f(120, 35)); // Larger background
-    fpsBackground.setPosition(sf::Vector2f(WINDOW_WIDTH - 125, 5));
-    fpsBackground.setFillColor(sf::Color(0, 0, 0, 200)); // More opaque background
-    fpsBackground.setOutlineColor(sf::Color(200, 200, 200)); // Lighter outline
-    fpsBackground.setOutlineThickness(2.0f); // Thicker outline
+    // Line between the split screen halves
+    splitDivider.setSize(sf::Vector2f(2.f, WINDOW_HEIGHT));
+    splitDivider.setPosition(sf::Vector2f(WINDOW_WIDTH / 2.f - 1.f, 0.f));
+    splitDivider.setFillColor(sf::Color::Black);
     
     // Initialize physics system
-    physicsSystem.initialize();
-    physicsSystem.initializePlayer(player);
-    physicsSystem.initializePlatforms(platforms);
-    physicsSystem.initializeEnemies(enemies);
+    startupProfile.begin("Physics");
+    {
+        AllocationTracker::ScopedTag memoryTag(AllocationTracker::Tag::Physics);
+        physicsSystem.initialize();
+        physicsSystem.initializePlayer(player);
+        physicsSystem.initializePlatforms(platforms);
+        physicsSystem.initializeEnemies(enemies);
+    }
+    startupProfile.end(); // The rest, up to the first frame, shows in "Time to first frame"
+}
+
+// Startup work that only opens devices, reads files and decodes them runs at
+// once on the job system: the audio device and its sounds, the level files
+// and the tile PNGs. Everything that needs the GL context (texture uploads,
+// font glyphs, ImGui) stays on the main thread, after it.
+void Game::runStartupTasks() {
+    startupProfile.begin("Startup tasks");
+    const std::string tilesPath = AssetManifest::resolve(TILES_DIRECTORY);
+    startupTiles = DecodedTiles();
+    if (RenderingSystem::listTileFiles(tilesPath, startupTiles.files)) {
+        startupTiles.directory = tilesPath;
+        startupTiles.images.resize(startupTiles.files.size());
+    }
     
-    // Initialize all systems
-    initializeAudio();
+    // Audio and the level file come first so they start straight away
+    enum : size_t { AudioTask, LevelTask, FIXED_TASKS };
+    const size_t taskCount = FIXED_TASKS + startupTiles.files.size();
+    const size_t firstSlot = startupProfile.reserveTasks(taskCount);
+    // Each task writes only its own members (or tile image)
+    jobSystem.parallelFor(taskCount, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const StartupProfile::Clock::time_point start = StartupProfile::Clock::now();
+            if (i == AudioTask) {
+                AllocationTracker::ScopedTag memoryTag(AllocationTracker::Tag::Audio);
+                initializeAudio();
+                startupProfile.recordTask(firstSlot + i, "Audio", start);
+            } else if (i == LevelTask) {
+                while (LevelLoader::levelExists(levelCount + 1)) {
+                    levelCount++;
+                }
+                AllocationTracker::ScopedTag memoryTag(AllocationTracker::Tag::Level);
+                loadLevelData(currentLevel);
+                startupProfile.recordTask(firstSlot + i, "Level parse", start);
+            } else {
+                const size_t tile = i - FIXED_TASKS;
+                AllocationTracker::ScopedTag memoryTag(AllocationTracker::Tag::Tiles);
+                TextureAtlas::loadImage(startupTiles.files[tile], startupTiles.images[tile]);
+                startupProfile.recordTask(firstSlot + i, "Tile decode", start);
+            }
+        }
+    });
+    // The startup track plays already; a level with its own swaps to it
+    if (isMusicEnabled) {
+        soundSystem.crossfadeMusic(LevelAssets::getMusicStem(levelData), 0.0f);
+    }
+    startupProfile.end();
 }
 
 void Game::initializeAudio() {
@@ -142,7 +350,8 @@ void Game::initializeAudio() {
     }
 
     // Load background music
-    if (!soundSystem.loadMusic("background", "assets/audio/music/background.wav")) {
+    // Prefers background.ogg/.flac when present, falling back to the WAV
+    if (!soundSystem.loadMusic("background", SoundSystem::resolveAudioPath("assets/audio/music/background"))) {
         logWarning("Failed to load background music");
     } else {
         logInfo("Successfully loaded background music");
@@ -150,18 +359,32 @@ void Game::initializeAudio() {
     
     // Load sound effects
     const std::vector<std::pair<std::string, std::string>> soundEffects = {
-        {"jump", "assets/audio/sfx/jump.wav"},
-        {"land", "assets/audio/sfx/land.wav"},
-        {"hit", "assets/audio/sfx/hit.wav"},
-        {"collect", "assets/audio/sfx/collect.wav"}
+        {"jump", "assets/audio/sfx/jump"},
+        {"land", "assets/audio/sfx/land"},
+        {"hit", "assets/audio/sfx/hit"},
+        {"collect", "assets/audio/sfx/collect"}
     };
     
-    for (const auto& [name, path] : soundEffects) {
-        if (!soundSystem.loadSoundEffect(name, path)) {
+    for (const auto& [name, stem] : soundEffects) {
+        if (!soundSystem.loadSoundEffect(name, SoundSystem::resolveAudioPath(stem))) {
             logWarning("Failed to load sound effect: " + name);
         }
     }
     
+    // Movement sounds fire often; keep them from crowding out hits and pickups
+    SoundSystem::SoundEffectSettings movement;
+    movement.maxInstances = 2;
+    movement.minInterval = 0.1f;
+    soundSystem.setSoundEffectSettings("jump", movement);
+    // Landings can wait a block or two; mixed in software they never take a source
+    SoundSystem::SoundEffectSettings footfall = movement;
+    footfall.softwareMix = true;
+    soundSystem.setSoundEffectSettings("land", footfall);
+    SoundSystem::SoundEffectSettings important;
+    important.priority = 1;
+    soundSystem.setSoundEffectSettings("hit", important);
+    soundSystem.setSoundEffectSettings("collect", important);
+    
     // Set initial volumes
     soundSystem.setMasterVolume(1.0f);
     soundSystem.setMusicVolume(musicVolume);
@@ -175,131 +398,244 @@ void Game::initializeAudio() {
 }
 
 void Game::update() {
+    PROFILE_ZONE("Game::update");
+    // Everything allocated from the frame arena last frame is dead now
+    FrameArena::instance().reset();
     if (!window.isOpen()) {
         return;
     }
     
-    float deltaTime = clock.restart().asSeconds() * gameSpeed;
+    // Clamp long frames so a stall doesn't turn into a burst of catch-up steps
+    // and average it over a few frames so a single hitch is spread out
+    float frameTime = framePacer.smooth(std::min(clock.restart().asSeconds(), MAX_FRAME_TIME));
+    
+    // Hand last frame's audio commands to the audio thread
+    soundSystem.update();
+    
+    // The peer's input first, so a rollback it causes runs before this frame's steps
+    updateNetplay();
+    
+    // Advance the simulation in fixed steps, independent of the render rate. With
+    // the render thread on, this overlaps the previous frame's draw and present.
+    // Skipped in debug panel mode and while paused in the background.
+    const bool simPaused = currentState == GameState::DebugPanel || isBackgroundPaused();
+    if (!simPaused && replayMode == ReplayMode::Playing) {
+        // A replay runs the recorded steps of each frame, whatever the time says
+        uint8_t replayTicks = 0;
+        float replayAlpha = 0.0f;
+        if (replay.nextFrame(replayTicks, replayAlpha)) {
+            for (uint8_t tick = 0; tick < replayTicks; ++tick) {
+                storePreviousState();
+                tickInput = InputSystem::toPlayerInput(replay.nextTick());
+                fixedUpdate(fixedTimeStep);
+            }
+            lastSubStepCount = replayTicks;
+            interpolationAlpha = replayAlpha;
+        } else {
+            stopReplayPlayback();
+        }
+    } else if (!simPaused) {
+        // Netplay runs at real speed on both peers, and corrects a misprediction before stepping on
+        timeAccumulator += frameTime * (netplay.isActive() ? 1.0f : gameSpeed);
+        uint32_t rollbackFrom = 0;
+        if (netplay.takeRollback(rollbackFrom)) {
+            rollbackNetplay(rollbackFrom);
+        }
+        int subSteps = 0;
+        while (timeAccumulator >= fixedTimeStep && subSteps < maxSubSteps) {
+            if (netplay.isActive() && !netplay.canAdvance()) {
+                // Too far ahead of the peer's input; wait for it rather than bank the time
+                netplay.noteStall();
+                break;
+            }
+            storePreviousState();
+            tickInput = inputSystem.takeTick();
+            if (replayMode == ReplayMode::Recording) {
+                replay.addTick(InputSystem::fromPlayerInput(tickInput));
+            }
+            if (netplay.isActive()) {
+                tickInput = beginNetplayTick(tickInput);
+            }
+            fixedUpdate(fixedTimeStep);
+            if (netplay.isActive()) {
+                netplay.advance();
+            }
+            timeAccumulator -= fixedTimeStep;
+            subSteps++;
+        }
+        if (netplay.isActive()) {
+            sendNetplayInputs();
+        }
+        
+        // Hit the step cap - drop the backlog instead of spiralling
+        if (timeAccumulator >= fixedTimeStep) {
+            timeAccumulator = std::fmod(timeAccumulator, fixedTimeStep);
+        }
+        lastSubStepCount = subSteps;
+        interpolationAlpha = timeAccumulator / fixedTimeStep;
+        if (replayMode == ReplayMode::Recording) {
+            replay.endFrame(interpolationAlpha);
+        }
+    }
+    if (!simPaused) {
+        // Update view position from the interpolated player position. A replay
+        // follows too: the next step's focus (AI level of detail, regions,
+        // streaming) is the view centre, as it was while recording.
+        sf::Vector2f playerRenderPos = player.getRenderPosition(interpolationAlpha);
+        gameView.setCenter(sf::Vector2f(getCameraX(playerRenderPos.x), gameView.getCenter().y));
+    }
+    if (splitScreen) {
+        updateSplitViews(frameTime);
+    }
     
-    // Process ImGui
-    if (useImGuiInterface) {
+    // The rest touches what the render thread reads (textures, fonts, particles,
+    // the platform cache, ImGui), so the previous frame has to be out first
+    renderThread.waitIdle();
+    plotFrameCounters();
+    updateQuality(frameTime);
+    
+    // The steps' gameplay events, handled together now nothing is being drawn
+    dispatchGameEvents();
+    
+    // Process ImGui, only while one of its windows is open; otherwise neither
+    // NewFrame nor Render runs and the frame carries no draw lists
+    const bool imguiWasActive = imguiFrameActive;
+    imguiFrameActive = isToolingVisible();
+    if (imguiFrameActive) {
+        if (!imguiWasActive) {
+            // Input wasn't forwarded while hidden; don't replay stale keys or a long dt
+            ImGui::GetIO().ClearInputKeys();
+            ImGui::GetIO().ClearInputMouse();
+            imguiClock.restart();
+        }
         updateImGui();
+        if (ImGui::IsAnyItemActive()) {
+            sceneCacheDirty = true; // A slider being dragged may change the world
+        }
     }
     
     // Calculate FPS
     updateFPS();
     
-    // Skip game updates when in debug panel mode
-    if (currentState == GameState::DebugPanel) {
+    // Hot-reloaded textures join the async loads below and are swapped in on upload
+    reloadChangedAssets();
+    
+    // Load the neighbouring level in the background as the player nears an edge
+    if (currentState == GameState::Playing || currentState == GameState::LevelTransition) {
+        updateLevelPreload();
+    }
+    
+    // Upload textures decoded in the background, a few milliseconds' worth per frame
+    if (assets.hasPendingLoads()) {
+        const auto uploadStart = std::chrono::steady_clock::now();
+        if (assets.processUploads(ASSET_UPLOAD_BUDGET) > 0) {
+            sceneCacheDirty = true;
+        }
+        telemetry.recordUploads(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - uploadStart).count());
+    }
+    if (currentState == GameState::LevelTransition) {
+        updateLoadingText();
+    }
+    
+    // Tiled background layers stream toward the tiles the last frame drew
+    for (auto& layer : backgroundLayers) {
+        if (layer.tiled && layer.tiled->update()) {
+            renderingSystem.invalidateBackgroundComposites();
+            sceneCacheDirty = true;
+        }
+    }
+    
+    // Skip game updates when in debug panel mode or paused in the background
+    if (simPaused) {
         return;
     }
     
-    // Update view position regardless of game state
-    float viewX = std::max(WINDOW_WIDTH / 2.f, 
-                      std::min(player.getPosition().x, LEVEL_WIDTH - WINDOW_WIDTH / 2.f));
-    gameView.setCenter(sf::Vector2f(viewX, gameView.getCenter().y));
+    // Weather follows the camera, so it steps after the view has moved
+    const sf::FloatRect worldBounds = getWorldViews(0.f).bounds; // Both halves with split screen
+    renderingSystem.getParticles().update(frameTime * gameSpeed, worldBounds);
+    
+    // Stream sectors in and out around the camera. Netplay keeps the whole level
+    // in: peers swapping sectors at different ticks would no longer agree.
+    const float streamLeft = netplay.isActive() ? 0.f : worldBounds.position.x;
+    const float streamRight = netplay.isActive() ? levelData.size.x : worldBounds.position.x + worldBounds.size.x;
+    if (levelStreamer.update(streamLeft, streamRight)) {
+        applyActiveSectors();
+    }
+    
+    // Path requests share one search budget per frame
+    pathfinder.update(NAV_EXPANSIONS_PER_FRAME);
     
     if (currentState == GameState::Playing) {
-        // Update player
-        sf::Vector2f oldPosition = player.getPosition();
-        player.update(deltaTime, platforms, ladders);  // Pass required arguments
-        sf::Vector2f newPosition = player.getPosition();
-        
-        // Play jump sound effect if player has jumped
-        if (newPosition.y < oldPosition.y && player.isJumping() && isSoundEffectsEnabled) {
-            soundSystem.playSoundEffect("jump");
-        }
+        // Update UI
+        updateUI();
         
-        // Play land sound effect if player has landed
-        if (oldPosition.y < newPosition.y && !player.isJumping() && isSoundEffectsEnabled) {
-            soundSystem.playSoundEffect("land");
+        // Update mini-map
+        updateMiniMap();
+    } else if (currentState == GameState::GameOver) {
+        // In game over state (either from death or completion); the texts
+        // stay centred in uiView by the HUD layer, so nothing moves them here
+        updateMiniMap();
+        updateUI();
+    }
+}
+
+void Game::storePreviousState() {
+    player.storePreviousState();
+    enemies.storePreviousState();
+    if (npcManager) {
+        npcManager->storePreviousPositions();
+    }
+}
+
+void Game::fixedUpdate(float deltaTime) {
+    PROFILE_ZONE("Game::fixedUpdate");
+    // Timers run on simulation time, so they pause and replay with it
+    expiredTimers.clear();
+    gameTimers.advance(deltaTime, expiredTimers);
+    for (const TimerWheel::Expired& expired : expiredTimers) {
+        if (expired.event == static_cast<uint32_t>(GameTimer::HitCooldown)) {
+            playerHit = false;
         }
+    }
+    
+    if (currentState == GameState::Playing) {
+        SimulationWorld world{player, platforms, enemies, npcManager.get(), physicsSystem, jobSystem, showEnemies};
         
-        // Update NPCs
-        npcManager->updateAll(deltaTime);
-        // Update NPC physics
-        physicsSystem.updateNPCs(const_cast<std::vector<NPC::NPCData>&>(npcManager->getAllNPCs()));
+        // Update player (jumping and landing are reported as events)
+        Simulation::stepPlayer(world, deltaTime);
         
-        // Update enemies only if they're visible
-        if (showEnemies) {
-            for (auto& enemy : enemies) {
-                enemy.update(platforms);
-            }
+        // NPCs, enemies (only if they're visible) and physics. NPC AI level of detail and the
+        // simulation region; netplay needs a focus both peers agree on, not the interpolated camera
+        world.focus = netplay.isActive() ? sf::Vector2f(getCameraX(player.getPosition().x), gameView.getCenter().y)
+                                         : gameView.getCenter();
+        if (npcManager) {
+            npcManager->setAIFocus(world.focus);
         }
-        
-        // Update physics system
-        physicsSystem.update(deltaTime, player, enemies);
+        Simulation::stepWorld(world, deltaTime);
+        updateEntityBroadphase();
         
         // Check for player-enemy collisions only if enemies are visible
         if (showEnemies) {
             checkPlayerEnemyCollision();
         }
         
+        // Shots and hitboxes, against the proxies just updated and the platform grid
+        stepProjectiles(deltaTime);
+        
         // Check for player-NPC collisions
         checkPlayerNPCCollision();
         
-        // Check if game is over
-        checkGameOver();
-        
-        // Check if level is complete (reached right edge)
-        checkLevelCompletion();
-        
-        // Check if player should go to previous level (reached left edge)
-        if (currentLevel > 1 && player.getPosition().x <= 10.f && player.isOnGround()) {
-            // Player has reached the left edge of the level
-            currentState = GameState::LevelTransition;
-            transitionTimer = LEVEL_TRANSITION_DURATION;
-            
-            // Set up level transition text
-            levelText.setString("Going to Level " + std::to_string(currentLevel - 1));
-            
-            // Center the text
-            sf::FloatRect levelBounds = levelText.getGlobalBounds();
-            levelText.setPosition(sf::Vector2f(
-                WINDOW_WIDTH / 2.f - levelBounds.size.x / 2.f,
-                WINDOW_HEIGHT / 2.f - levelBounds.size.y / 2.f
-            ));
-        }
-        
-        // Update UI
-        updateUI();
-        
-        // Update mini-map
-        updateMiniMap();
-        
-        window.setView(gameView);
+        // The level's exits and fall zone, and any scripted zones
+        updateTriggers();
     } else if (currentState == GameState::LevelTransition) {
-        // Handle level transition timer
-        transitionTimer -= deltaTime;
-        if (transitionTimer <= 0) {
-            // Check if we're going forward or backward
-            if (player.getPosition().x >= LEVEL_WIDTH - player.getSize().x - 50.f) {
+        // Stay on the transition screen for its time, and until the prefetch is in
+        if (!gameTimers.isPending(transitionTimer) && !assets.hasPendingLoads()) {
+            if (transitionLevel > currentLevel) {
                 nextLevel();
-            } else if (player.getPosition().x <= 10.f) {
+            } else if (transitionLevel < currentLevel) {
                 previousLevel();
             }
         }
-    } else if (currentState == GameState::GameOver) {
-        // In game over state (either from death or completion)
-        // Keep updating certain elements for visual continuity
-        updateFPS();
-        updateMiniMap();
-        
-        // Keep the view centered on the final position
-        window.setView(gameView);
-        
-        // Update UI elements
-        updateUI();
-        
-        // Update game over text position to stay centered in view
-        sf::Vector2f viewCenter = gameView.getCenter();
-        sf::FloatRect gameOverBounds = gameOverText.getGlobalBounds();
-        gameOverText.setPosition(sf::Vector2f(
-            viewCenter.x - gameOverBounds.size.x / 2.f,
-            viewCenter.y - gameOverBounds.size.y / 2.f - 40.f
-        ));
-        
-        sf::FloatRect restartBounds = restartText.getGlobalBounds();
     }
 }
 
@@ -311,7 +647,7 @@ void Game::loadAssets() {
         useEnemyPlaceholder = true;
         
         // Initialize placeholder shapes for drawing - make sure it covers the full screen
-        backgroundPlaceholder.setSize(sf::Vector2f(LEVEL_WIDTH, WINDOW_HEIGHT));
+        backgroundPlaceholder.setSize(sf::Vector2f(levelData.size.x, WINDOW_HEIGHT));
         backgroundPlaceholder.setFillColor(sf::Color(100, 180, 100)); // Green
         backgroundPlaceholder.setPosition(sf::Vector2f(0, 0));
         
@@ -321,123 +657,79 @@ void Game::loadAssets() {
         enemyPlaceholder.setSize(sf::Vector2f(32, 32));
         enemyPlaceholder.setFillColor(sf::Color::Red);
         
-        // Initialize and load layered background system
-        try {
-            initializeBackgroundLayers();
-            loadBackgroundLayers();
-        } catch (const std::exception& e) {
-            logError("Failed to load layered backgrounds: " + std::string(e.what()));
-            // We'll use the background placeholder instead
+        // Initialize and load layered background system; missing layers fall
+        // back to the background placeholder
+        initializeBackgroundLayers();
+        loadBackgroundLayers();
+        
+        // Load character sprites; the placeholders stay if they aren't listed
+        std::string characterError;
+        if (loadListedCharacter(assets, "player", "assets/images/characters/player.png", characterError)) {
+            playerTexture = assets.acquireTexture("player");
+            playerSprite = std::make_unique<sf::Sprite>(playerTexture.get());
+            usePlayerPlaceholder = false;
+        } else {
+            logError(characterError);
         }
-        
-        // Load character sprites
-        try {
-            // Try multiple paths to find the player sprite
-            std::vector<std::string> playerPaths = {
-                "../assets/images/characters/player.png",
-                "assets/images/characters/player.png",
-                "./assets/images/characters/player.png"
-            };
-            
-            bool playerLoaded = false;
-            for (const auto& path : playerPaths) {
-                try {
-                    assets.loadTexture("player", path);
-                    playerLoaded = true;
-                    logInfo("Successfully loaded player sprite from: " + path);
-                    break;
-                } catch (const std::exception& e) {
-                    logWarning("Failed to load player sprite from " + path + ": " + std::string(e.what()));
-                }
-            }
-            
-            if (playerLoaded) {
-                playerSprite = std::make_unique<sf::Sprite>(assets.getTexture("player"));
-                usePlayerPlaceholder = false;
-            } else {
-                logError("Failed to load player sprite from any path");
-                // We'll use the player placeholder instead
-            }
-        } catch (const std::exception& e) {
-            logError("Failed to load player sprite: " + std::string(e.what()));
-            // We'll use the player placeholder instead
+        if (loadListedCharacter(assets, "enemy", "assets/images/enemies/enemy.png", characterError)) {
+            enemyTexture = assets.acquireTexture("enemy");
+            enemySprite = std::make_unique<sf::Sprite>(enemyTexture.get());
+            useEnemyPlaceholder = false;
+        } else {
+            logError(characterError);
         }
         
-        // Load enemy sprites
-        try {
-            // Try multiple paths to find the enemy sprite
-            std::vector<std::string> enemyPaths = {
-                "../assets/images/enemies/enemy.png",
-                "assets/images/enemies/enemy.png",
-                "./assets/images/enemies/enemy.png"
-            };
-            
-            bool enemyLoaded = false;
-            for (const auto& path : enemyPaths) {
-                try {
-                    assets.loadTexture("enemy", path);
-                    enemyLoaded = true;
-                    logInfo("Successfully loaded enemy sprite from: " + path);
-                    break;
-                } catch (const std::exception& e) {
-                    logWarning("Failed to load enemy sprite from " + path + ": " + std::string(e.what()));
-                }
+        // Load fonts once and rasterize the glyphs the HUD and speech bubbles
+        // draw, so text never adds glyphs mid-frame
+        std::string error;
+        uiFont = assets.tryLoadFirstFont("ui_font", getListedCandidates({
+            "assets/fonts/pixel.ttf",
+            "assets/fonts/arial.ttf",
+            "assets/fonts/roboto.ttf",
+            "/Library/Fonts/arial.ttf",
+            "/System/Library/Fonts/Supplemental/arial.ttf"
+        }), error);
+        if (uiFont.isValid()) {
+            for (const TextStyle& style : UI_TEXT_STYLES) {
+                assets.prewarmGlyphs(uiFont, AssetManager::getAsciiGlyphs(), style.size, style.outline);
             }
-            
-            if (enemyLoaded) {
-                enemySprite = std::make_unique<sf::Sprite>(assets.getTexture("enemy"));
-                useEnemyPlaceholder = false;
-            } else {
-                logError("Failed to load enemy sprite from any path");
-                // We'll use the enemy placeholder instead
-            }
-        } catch (const std::exception& e) {
-            logError("Failed to load enemy sprite: " + std::string(e.what()));
-            // We'll use the enemy placeholder instead
+        } else {
+            logWarning("Failed to load font: " + error);
         }
-        
-        // Load fonts
-        try {
-            assets.loadFont("pixel_font", "assets/fonts/pixel.ttf");
-        } catch (const std::exception& e) {
-            logWarning("Failed to load font: " + std::string(e.what()));
-            // Font errors are handled in initializeUI with fallbacks
+        debugFont = assets.tryLoadFirstFont("debug_font",
+                                            getListedCandidates({"assets/fonts/arial.ttf", "assets/fonts/pixel.ttf"}), error);
+        if (debugFont.isValid()) {
+            assets.prewarmGlyphs(debugFont, AssetManager::getAsciiGlyphs(), Player::DEBUG_TEXT_SIZE);
+            player.setDebugFont(assets.findFont(debugFont));
+        } else {
+            logWarning("Failed to load debug font: " + error);
         }
-        
-        // Load sounds
-        try {
-            assets.loadSoundBuffer("jump", "assets/audio/sfx/jump.wav");
-            assets.loadSoundBuffer("hit", "assets/audio/sfx/hit.wav");
-        } catch (const std::exception& e) {
-            logWarning("Failed to load sound: " + std::string(e.what()));
-            // Game can continue without sounds
+        if (npcManager) {
+            npcManager->prewarmMessageGlyphs();
         }
         
-        // Load platform tiles
-        try {
-            std::vector<std::string> tilePaths = {
-                "assets/images/platformer/tiles",
-                "./assets/images/platformer/tiles",
-                "../assets/images/platformer/tiles"
-            };
-            
-            bool tilesLoaded = false;
-            for (const auto& path : tilePaths) {
-                            if (renderingSystem.loadTiles(path)) {
-                logInfo("Successfully loaded platform tiles from: " + path);
-                tilesLoaded = true;
-                break;
-            } else {
-                logWarning("Failed to load tiles from: " + path);
+        // Load sounds; the game can continue without them
+        for (const auto& [name, path] : {std::pair{"jump", "assets/audio/sfx/jump.wav"},
+                                         std::pair{"hit", "assets/audio/sfx/hit.wav"}}) {
+            if (!assets.tryLoadSoundBuffer(name, AssetManifest::resolve(path), error)) {
+                logWarning("Failed to load sound: " + error);
             }
-            }
-            
-            if (!tilesLoaded) {
-                logWarning("No platform tiles loaded - platforms will use solid colors");
-            }
-        } catch (const std::exception& e) {
-            logWarning("Failed to load platform tiles: " + std::string(e.what()));
-            // Game can continue without tiles
+        }
+        
+        // Load platform tiles; at startup runStartupTasks has decoded them already
+        const std::string tilesPath = AssetManifest::resolve(TILES_DIRECTORY);
+        bool tilesLoaded = false;
+        {
+            AllocationTracker::ScopedTag memoryTag(AllocationTracker::Tag::Tiles);
+            tilesLoaded = startupTiles.directory == tilesPath
+                ? renderingSystem.loadTiles(tilesPath, startupTiles.files, startupTiles.images)
+                : renderingSystem.loadTiles(tilesPath);
+            startupTiles = DecodedTiles();
+        }
+        if (tilesLoaded) {
+            logInfo("Successfully loaded platform tiles from: " + tilesPath);
+        } else {
+            logWarning("No platform tiles loaded - platforms will use solid colors");
         }
         
     } catch (const std::exception& e) {
@@ -446,217 +738,168 @@ void Game::loadAssets() {
     }
 }
 
+void Game::createHud() {
+    // In draw order; the state picks which are shown (see drawHud)
+    using Placement = HudLayer::Placement;
+    HudLayer::TextStyle style;
+    hud.setViewSize(uiView.getSize());
+    
+    // FPS in a box in the top-right corner, culling counts below it
+    fpsBackground = hud.addBox(sf::FloatRect(sf::Vector2f(WINDOW_WIDTH - 125, 5), sf::Vector2f(120, 35)),
+                               sf::Color(0, 0, 0, 200), sf::Color(200, 200, 200), 2.0f, 24);
+    style.characterSize = 24;
+    style.outlineThickness = 2.0f;
+    fpsText = hud.addText("FPS: 0", style, Placement::Absolute, sf::Vector2f(WINDOW_WIDTH - 115, 8));
+    style.characterSize = 14;
+    style.outlineThickness = 1.0f;
+    cullText = hud.addText("", style, Placement::Absolute, sf::Vector2f(WINDOW_WIDTH - 175, 45));
+    
+    // Level indicator at the top (centred in the window on the transition screen)
+    style.characterSize = 36;
+    style.outlineThickness = 2.0f;
+    levelText = hud.addText("Level 1", style, Placement::TopCentred, sf::Vector2f(0.f, 20.f));
+    
+    // Game over and restart prompt around the middle
+    style.characterSize = 48;
+    style.fill = sf::Color::Red;
+    style.letterSpacing = 2.0f;
+    gameOverText = hud.addText("GAME OVER", style, Placement::Centred, sf::Vector2f(0.f, -40.f));
+    style.characterSize = 24;
+    style.fill = sf::Color::White;
+    style.outlineThickness = 1.0f;
+    style.letterSpacing = 1.5f;
+    restartText = hud.addText("Press ENTER to restart", style, Placement::Centred, sf::Vector2f(0.f, 40.f));
+    
+    // Loading progress sits under the centred transition text
+    style.characterSize = 18;
+    style.letterSpacing = 1.0f;
+    loadingText = hud.addText("", style, Placement::TopCentred, sf::Vector2f(0.f, WINDOW_HEIGHT / 2.f + 40.f));
+}
+
 void Game::initializeUI() {
-    // Try to load the pixel art font first
-    bool fontLoaded = false;
-    
-    if (font.openFromFile("assets/fonts/pixel.ttf")) {
-        fontLoaded = true;
-    } else {
-        // Fallback to other fonts if pixel font not found
-        if (font.openFromFile("assets/fonts/arial.ttf")) {
-            fontLoaded = true;
-        } else if (font.openFromFile("assets/fonts/roboto.ttf")) {
-            fontLoaded = true;
-        } else if (font.openFromFile("/Library/Fonts/arial.ttf")) {
-            fontLoaded = true;
-        } else if (font.openFromFile("/System/Library/Fonts/Supplemental/arial.ttf")) {
-            fontLoaded = true;
-        }
-    }
-    
-    if (fontLoaded) {
-        // Set the font for all text elements
-        gameOverText.setFont(font);
-        restartText.setFont(font);
-        levelText.setFont(font); 
-        fpsText.setFont(font);
-    }
-    
-    // Make FPS text more visible - use larger size and bright color
-    fpsText.setFillColor(sf::Color::White);  // White is more visible
-    fpsText.setOutlineColor(sf::Color::Black);
-    fpsText.setOutlineThickness(2.0f);
-    fpsText.setCharacterSize(24); // Larger text
-    
-    // Configure level text
-    levelText.setString("Level " + std::to_string(currentLevel));
-    levelText.setFillColor(sf::Color::White);
-    levelText.setOutlineColor(sf::Color::Black);
-    levelText.setOutlineThickness(2.0f);
-    
-    // Center level text at the top of the screen
-    sf::FloatRect levelBounds = levelText.getGlobalBounds();
-    levelText.setPosition(sf::Vector2f(
-        WINDOW_WIDTH / 2.f - levelBounds.size.x / 2.f,
-        20.f
-    ));
-    
-    // Configure game over text
-    gameOverText.setFillColor(sf::Color::Red);
-    gameOverText.setOutlineColor(sf::Color::Black);
-    gameOverText.setOutlineThickness(2.0f);
-    gameOverText.setLetterSpacing(2.0f);
-    
-    // Center game over text
-    sf::FloatRect gameOverBounds = gameOverText.getGlobalBounds();
-    gameOverText.setPosition(sf::Vector2f(
-        WINDOW_WIDTH / 2.f - gameOverBounds.size.x / 2.f,
-        WINDOW_HEIGHT / 2.f - gameOverBounds.size.y / 2.f - 40.f
-    ));
+    // The font is opened once by loadAssets; texts keep the default until then
+    if (const sf::Font* font = assets.findFont(uiFont)) {
+        hud.setFont(*font);
+    }
     
-    // Configure restart text
-    restartText.setFillColor(sf::Color::White);
-    restartText.setOutlineColor(sf::Color::Black);
-    restartText.setOutlineThickness(1.0f);
-    restartText.setLetterSpacing(1.5f);
-    
-    // Position restart text below game over text
-    sf::FloatRect restartBounds = restartText.getGlobalBounds();
-    restartText.setPosition(sf::Vector2f(
-        WINDOW_WIDTH / 2.f - restartBounds.size.x / 2.f,
-        WINDOW_HEIGHT / 2.f - restartBounds.size.y / 2.f + 40.f
-    ));
+    // Level text back at the top; game over in red (a completed game turns it green)
+    hud.setString(levelText, "Level " + std::to_string(currentLevel));
+    hud.setPlacement(levelText, HudLayer::Placement::TopCentred, sf::Vector2f(0.f, 20.f));
+    hud.setFillColor(gameOverText, sf::Color::Red);
 }
 
 void Game::updateUI() {
     // No UI updates needed since health system is removed
 }
 
-void Game::initializePlatforms() {
-    // Clear existing platforms
-    platforms.clear();
-    
-    // Create the ground platform for puzzle-based gameplay
-    sf::RectangleShape ground;
-    ground.setSize(sf::Vector2f(LEVEL_WIDTH, GROUND_HEIGHT));
-    ground.setPosition(sf::Vector2f(0, WINDOW_HEIGHT - GROUND_HEIGHT));
-    ground.setFillColor(platformColor);
-    platforms.push_back(ground);
-    
-    // Add a platform in the middle of the level
-    sf::RectangleShape middlePlatform;
-    middlePlatform.setSize(sf::Vector2f(200.f, 20.f)); // Width: 200, Height: 20
-    middlePlatform.setPosition(sf::Vector2f(LEVEL_WIDTH / 2.f - 100.f, WINDOW_HEIGHT / 2.f + 20.f)); // Centered horizontally and vertically
-    middlePlatform.setFillColor(platformColor);
-    platforms.push_back(middlePlatform);
-    
-    // Reinitialize physics system with the platforms
-    physicsSystem.initialize();
-    physicsSystem.initializePlatforms(platforms);
-}
-
-
-
-
-
-
-
-void Game::initializeEnemies() {
-    // Clear existing enemies first
-    enemies.clear();
-    
-    // Different enemy patterns based on level theme
-    if (currentLevel == 1) {
-        // Level 1 - Snow Mountain - enemies concentrated in middle section
-        initializeSnowEnemies();
-    } else {
-        // Level 2+ - Snow Forest - forest-like enemy pattern adapted for snow
-        initializeSnowForestEnemies();
+void Game::initializeSectors(bool decorationsRestored) {
+    // Only the sectors around the player are built now; the rest stream in as the camera moves
+    // (netplay takes the whole level at once, see update)
+    // The previous level's sector tables and nav graph live in the level
+    // arena: they let go of it, and it is freed in one reset
+    levelStreamer.clear();
+    navGraph.clear();
+    entityBroadphase.clear(); // Rebuilt with this level's triggers
+    projectiles.clear();
+    playerTriggers.clear();
+    FrameArena::level().reset();
+    levelStreamer.setLevel(levelData, platformColor);
+    if (!decorationsRestored) {
+        renderingSystem.buildDecorationCache(levelData.decorationQuads); // Whole level: static, culled per chunk
     }
-    
-    // Apply level difficulty scaling - enemies get faster in higher levels
-    float speedMultiplier = 1.0f + (currentLevel * 0.1f); // 10% faster per level
-    
-    // Force enemies to start moving right and scale speed
-    for (auto& enemy : enemies) {
-        // Set a positive initial velocity and reset position if too close to left edge
-        sf::Vector2f pos = enemy.getPosition();
-        if (pos.x < 50.0f) {
-            pos.x = 100.0f; // Move away from edge
-            enemy.setPosition(pos);
-        }
-        
-        // Start velocity to the right and scale by level
-        enemy.setVelocity(sf::Vector2f(2.0f * speedMultiplier, 0.0f));
+    navGraph.build(levelData.platforms);
+    pathfinder.setGraph(&navGraph);
+    const float viewX = getCameraX(player.getPosition().x);
+    if (netplay.isActive()) {
+        levelStreamer.loadNow(0.f, levelData.size.x);
+    } else {
+        levelStreamer.loadNow(viewX - WINDOW_WIDTH / 2.f, viewX + WINDOW_WIDTH / 2.f);
     }
+    applyActiveSectors();
     
-    // Debug info
-    logDebug("Total enemies created: " + std::to_string(enemies.size()));
+    const LevelStreamer::Stats stats = levelStreamer.getStats();
+    GAME_LOG(Debug, "Level split into {} sectors, {} active: {} platforms, {} enemies",
+             stats.sectorCount, stats.activeSectors, platforms.size(), enemies.size());
 }
 
+void Game::applyActiveSectors() {
+    levelStreamer.collect(platforms, ladders, enemies);
+    netplay.resetHistory(); // Snapshots from before hold another set of enemies
+    
+    // Physics, the tile cache and the mini-map only see the active sectors
+    AllocationTracker::ScopedTag memoryTag(AllocationTracker::Tag::Physics);
+    physicsSystem.setTileGrid(levelData.tileSize, levelData.size);
+    physicsSystem.initializePlatforms(platforms);
+    physicsSystem.initializeLadders(ladders);
+    physicsSystem.initializeEnemies(enemies);
+    renderingSystem.buildPlatformCache(platforms);
+    initializeMiniMap();
+}
 
+float Game::getCameraX(float playerX, float halfWidth) const {
+    return std::max(halfWidth, std::min(playerX, levelData.size.x - halfWidth));
+}
 
-void Game::initializeSnowEnemies() {
-    // Snow level has fewer ground enemies due to the cold
-    enemies.push_back(Enemy(500.f, WINDOW_HEIGHT - GROUND_HEIGHT - 30.f, 150.f));
-    
-    // First section climbing area has few enemies
-    enemies.push_back(Enemy(280.f, 370.f, 60.f));
-    
-    // Middle section - icy platforms have more enemies
-    for (int i = 0; i < 4; i++) {
-        float x = 850.f + i * 350.f;
-        enemies.push_back(Enemy(x, 220.f, 100.f));
+void Game::setSplitScreen(bool enabled) {
+    splitScreen = enabled;
+    sceneCacheDirty = true;
+    if (enabled) {
+        partnerCameraX = gameView.getCenter().x;
+        updateSplitViews(0.f);
     }
-    
-    // Final descending section
-    enemies.push_back(Enemy(2300.f, 170.f, 80.f));
-    enemies.push_back(Enemy(2500.f, 220.f, 80.f));
+    logDebug("Split screen " + std::string(enabled ? "enabled" : "disabled"));
 }
 
-void Game::initializeSnowForestEnemies() {
-    // Snow Forest enemies - similar to forest but adapted for snow theme
-    
-    // Enemy on ground
-    enemies.push_back(Enemy(400.f, WINDOW_HEIGHT - GROUND_HEIGHT - 30.f, 180.f));
-    
-    // Enemy on first platform
-    enemies.push_back(Enemy(380.f, 370.f, 80.f));
-    
-    // Enemy on second platform
-    enemies.push_back(Enemy(180.f, 270.f, 80.f));
-    
-    // Middle section enemies - slightly different positions than forest
-    enemies.push_back(Enemy(1000.f, 320.f, 100.f));
-    enemies.push_back(Enemy(1420.f, 220.f, 120.f));  // Adjusted for new platform positions
-    enemies.push_back(Enemy(1820.f, 350.f, 120.f));
-    
-    // End section enemy
-    enemies.push_back(Enemy(2620.f, 290.f, 120.f));  // Adjusted for new platform height
+void Game::updateSplitViews(float frameTime) {
+    // The partner pans with A/D (not player controls) or the second gamepad's stick
+    float pan = 0.f;
+    if (window.hasFocus()) {
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A)) pan -= 1.f;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D)) pan += 1.f;
+    }
+    if (sf::Joystick::isConnected(1)) {
+        const float stick = sf::Joystick::getAxisPosition(1, sf::Joystick::Axis::X) / 100.f;
+        if (std::abs(stick) > 0.2f) pan += stick;
+    }
+    const float halfWidth = WINDOW_WIDTH / 4.f;
+    partnerCameraX = getCameraX(partnerCameraX + pan * PARTNER_PAN_SPEED * frameTime, halfWidth);
+    
+    const float centers[ViewCulling::ViewSet::MAX_VIEWS] = {
+        getCameraX(player.getRenderPosition(interpolationAlpha).x, halfWidth), partnerCameraX};
+    for (size_t i = 0; i < splitViews.size(); ++i) {
+        splitViews[i].setSize(sf::Vector2f(WINDOW_WIDTH / 2.f, WINDOW_HEIGHT));
+        splitViews[i].setCenter(sf::Vector2f(centers[i], gameView.getCenter().y));
+        splitViews[i].setViewport(sf::FloatRect(sf::Vector2f(0.5f * static_cast<float>(i), 0.f), sf::Vector2f(0.5f, 1.f)));
+    }
 }
 
-void Game::checkGameOver() {
-    // Only check for game over if player is not jumping
-    if (player.isJumping()) {
-        return;
+ViewCulling::ViewSet Game::getWorldViews(float margin) const {
+    if (!splitScreen) {
+        return ViewCulling::getViewBounds(gameView, margin);
     }
-    
-    // Only reset game when player falls off the level completely and is not jumping
-    float fallThreshold = WINDOW_HEIGHT + 200.0f; // Give extra room below window
-    
-    if (player.getPosition().y > fallThreshold && !player.isJumping()) {
-        currentState = GameState::GameOver;
-        
-        // Position game over text
-        sf::FloatRect gameOverBounds = gameOverText.getGlobalBounds();
-        gameOverText.setPosition(sf::Vector2f(
-            WINDOW_WIDTH / 2.f - gameOverBounds.size.x / 2.f,
-            WINDOW_HEIGHT / 2.f - gameOverBounds.size.y / 2.f - 40.f
-        ));
-        
-        // Position restart text
-        sf::FloatRect restartBounds = restartText.getGlobalBounds();
-        restartText.setPosition(sf::Vector2f(
-            WINDOW_WIDTH / 2.f - restartBounds.size.x / 2.f,
-            WINDOW_HEIGHT / 2.f - restartBounds.size.y / 2.f + 40.f
-        ));
+    ViewCulling::ViewSet views;
+    for (const sf::View& view : splitViews) {
+        views.add(ViewCulling::getViewBounds(view, margin));
     }
+    return views;
 }
 
 void Game::resetGame() {
+    // Rebuilds the tile cache and UI text the frame in flight draws
+    renderThread.waitIdle();
+    
+    // Restarts come from a key press the replay (or the peer) doesn't hold, so a session ends here
+    if (replayMode == ReplayMode::Recording) {
+        stopReplayRecording();
+    } else if (replayMode == ReplayMode::Playing) {
+        stopReplayPlayback();
+    }
+    if (netplay.isActive()) {
+        stopNetplay();
+    }
+    
     // Reset player
-    player.reset(50.f, WINDOW_HEIGHT - GROUND_HEIGHT - 40.f); // Start player higher above the ground
+    player.reset(levelData.spawn.x, levelData.spawn.y); // Start player higher above the ground
     
     // Set player collision box
     player.setCollisionBoxSize(sf::Vector2f(56.f, 56.f)); // Scaled up from 28x28 to match 4x scale
@@ -672,16 +915,15 @@ void Game::resetGame() {
     
     // Reset game state
     playerHit = false;
-    playerHitCooldown = 0.f;
+    gameTimers.cancel(hitCooldownTimer);
     currentState = GameState::Playing;
     
     // Reinitialize everything except NPCs
-    initializePlatforms();
-    initializeEnemies();
+    initializeSectors();
     initializeUI();
-    initializeMiniMap();
     
     // Initialize physics system with centered collision box
+    AllocationTracker::ScopedTag memoryTag(AllocationTracker::Tag::Physics);
     physicsSystem.initialize();
     physicsSystem.setPlayerCollisionSize(0.875f, 0.875f); // 28/32 = 0.875 (collision box is 28x28 on 32x32 sprite)
     physicsSystem.setPlayerCollisionOffset(0.0625f, 0.0625f); // 2/32 = 0.0625 (offset by 2 pixels on each side)
@@ -696,62 +938,161 @@ void Game::resetGame() {
 }
 
 void Game::checkPlayerEnemyCollision() {
+    // Still invulnerable from the previous hit; the cooldown timer clears it
     if (playerHit) {
-        playerHitCooldown -= 1.0f / FPS; // Decrement cooldown
-        if (playerHitCooldown <= 0) {
-            playerHit = false;
+        return;
+    }
+    
+    // Enemies touching the player, from the entity broadphase; the lowest index wins
+    size_t hitIndex = enemies.size();
+    uint32_t playerIndex, enemyIndex;
+    for (const auto& pair : entityBroadphase.getPairs()) {
+        if (entityBroadphase.match(pair, SweepAndPrune::Layer::Player, SweepAndPrune::Layer::Enemy, playerIndex, enemyIndex)) {
+            hitIndex = std::min<size_t>(hitIndex, enemyIndex);
         }
-        // Blink player during invulnerability
-        if (static_cast<int>(playerHitCooldown * 10) % 2 == 0) {
-            // This makes the player periodically invisible for blinking effect
-            return;
+    }
+    if (hitIndex == enemies.size()) {
+        return;
+    }
+    
+    // Player hit by enemy
+    hitPlayer(enemies.getBounds(hitIndex).position.x, static_cast<float>(hitIndex));
+}
+
+void Game::hitPlayer(float fromX, float value) {
+    playerHit = true;
+    hitCooldownTimer = gameTimers.scheduleIn(HIT_COOLDOWN, static_cast<uint32_t>(GameTimer::HitCooldown));
+    gameEvents.emit(GameEventType::PlayerHit, player.getPosition(), value);
+    
+    // Push player away from enemy
+    if (player.getPosition().x < fromX) {
+        // Push player left
+        player.setPosition(sf::Vector2f(player.getPosition().x - 50.f, player.getPosition().y - 30.f));
+    } else {
+        // Push player right
+        player.setPosition(sf::Vector2f(player.getPosition().x + 50.f, player.getPosition().y - 30.f));
+    }
+    
+    // The checks that run next see where the player was pushed to
+    entityBroadphase.setBounds(0, player.getGlobalBounds());
+    entityBroadphase.updatePairs();
+}
+
+void Game::stepProjectiles(float deltaTime) {
+    // Shots may leave the level by a screen's height upwards before they expire
+    const sf::FloatRect levelBounds(sf::Vector2f(0.f, -static_cast<float>(WINDOW_HEIGHT)),
+                                    sf::Vector2f(levelData.size.x, levelData.size.y + WINDOW_HEIGHT));
+    const ProjectileWorld world{entityBroadphase, physicsSystem.getPlatformGrid(), platforms, levelBounds,
+                                &jobSystem, &gameEvents};
+    projectiles.step(world, deltaTime);
+    projectiles.snapState();
+    
+    // Enemies have no health yet: their EnemyStruck events are all there is to a hit.
+    // The player takes a shot like a touch, knocked along the shot's path.
+    for (const ProjectileSystem::Hit& hit : projectiles.getHits()) {
+        if (hit.target == CollisionLayer::Player && !playerHit) {
+            hitPlayer(hit.point.x - hit.velocity.x, -1.f);
+        }
+    }
+}
+
+void Game::fireTestVolley() {
+    constexpr int SHOTS = 9;
+    constexpr float SPEED = 900.f;
+    constexpr float SPREAD = 0.6f; // Radians across the fan
+    const sf::FloatRect bounds = player.getGlobalBounds();
+    const sf::Vector2f muzzle = bounds.position + bounds.size / 2.f;
+    const float facing = player.isFacingLeft() ? -1.f : 1.f;
+    const ProjectileSystem::Shot shot;
+    for (int i = 0; i < SHOTS; ++i) {
+        const float angle = SPREAD * (static_cast<float>(i) / (SHOTS - 1) - 0.5f);
+        projectiles.spawn(shot, muzzle, sf::Vector2f(facing * std::cos(angle), std::sin(angle)) * SPEED);
+    }
+}
+
+void Game::updateEntityBroadphase() {
+    PROFILE_ZONE("Game::updateEntityBroadphase");
+    using Layer = SweepAndPrune::Layer;
+    const std::vector<NPC::NPCData>* npcs = npcManager ? &npcManager->getAllNPCs() : nullptr;
+    const size_t npcCount = npcs ? npcs->size() : 0;
+    
+    // Proxies are laid out player, enemies, NPCs, triggers; rebuilt when the lists change size
+    // (initializeSectors clears them for a new level's triggers)
+    if (entityBroadphase.getProxyCount() == 0 || entityProxyEnemies != enemies.size() || entityProxyNPCs != npcCount) {
+        entityBroadphase.clear();
+        entityBroadphase.add(Layer::Player, 0, player.getGlobalBounds());
+        for (size_t i = 0; i < enemies.size(); ++i) {
+            entityBroadphase.add(Layer::Enemy, static_cast<uint32_t>(i), enemies.getBounds(i));
+        }
+        for (size_t i = 0; i < npcCount; ++i) {
+            entityBroadphase.add(Layer::NPC, static_cast<uint32_t>(i), sf::FloatRect());
+        }
+        // Triggers never move, so their bounds are set here only
+        for (size_t i = 0; i < levelData.triggers.size(); ++i) {
+            entityBroadphase.add(Layer::Trigger, static_cast<uint32_t>(i), levelData.triggers[i].bounds);
         }
+        entityProxyEnemies = enemies.size();
+        entityProxyNPCs = npcCount;
     }
     
-    // Check for collisions with enemies
-    for (const auto& enemy : enemies) {
-        if (!playerHit && rectsIntersect(player.getGlobalBounds(), enemy.getGlobalBounds())) {
-            // Player hit by enemy
-            playerHit = true;
-            playerHitCooldown = HIT_COOLDOWN;
-            
-            // Push player away from enemy
-            if (player.getPosition().x < enemy.getGlobalBounds().position.x) {
-                // Push player left
-                player.setPosition(sf::Vector2f(player.getPosition().x - 50.f, player.getPosition().y - 30.f));
-            } else {
-                // Push player right
-                player.setPosition(sf::Vector2f(player.getPosition().x + 50.f, player.getPosition().y - 30.f));
-            }
-            
-            break;
+    SweepAndPrune::ProxyId id = 0;
+    entityBroadphase.setBounds(id++, player.getGlobalBounds());
+    for (size_t i = 0; i < enemies.size(); ++i) {
+        entityBroadphase.setEnabled(id, showEnemies);
+        entityBroadphase.setBounds(id++, enemies.getBounds(i));
+    }
+    for (size_t i = 0; i < npcCount; ++i, ++id) {
+        const auto& npc = (*npcs)[i];
+        const bool active = npc.isActive && npc.hasSprite();
+        entityBroadphase.setEnabled(id, active);
+        if (active) {
+            entityBroadphase.setBounds(id, getNPCContactBox(npc));
         }
     }
+    entityBroadphase.updatePairs();
 }
 
 void Game::updateMiniMap() {
-    // Calculate scaling factors to properly fill mini-map
-    // Use slightly more aggressive scaling to fill the mini-map completely
-    float scaleX = (float)(MINI_MAP_WIDTH - 8) / LEVEL_WIDTH;
-    float scaleY = (float)(MINI_MAP_HEIGHT - 8) / WINDOW_HEIGHT;
-    
-    // Update player icon position
-    sf::Vector2f playerPos = player.getPosition();
-    sf::Vector2f miniPlayerPos(
-        playerPos.x * scaleX,
-        playerPos.y * scaleY
-    );
-    miniMapPlayerIcon.setPosition(miniPlayerPos);
+    // One quad per marker, in UI coordinates over the baked map
+    const sf::Vector2f origin(WINDOW_WIDTH - MINI_MAP_WIDTH - MINI_MAP_MARGIN + MINI_MAP_INSET,
+                              WINDOW_HEIGHT - MINI_MAP_HEIGHT - MINI_MAP_MARGIN + MINI_MAP_INSET);
+    const sf::Vector2f scale((MINI_MAP_WIDTH - 2.f * MINI_MAP_INSET) / miniMapSpan,
+                             (MINI_MAP_HEIGHT - 2.f * MINI_MAP_INSET) / WINDOW_HEIGHT);
+    const sf::FloatRect area(origin, sf::Vector2f(MINI_MAP_WIDTH - 2.f * MINI_MAP_INSET,
+                                                   MINI_MAP_HEIGHT - 2.f * MINI_MAP_INSET));
+    
+    miniMapMarkers.clear(); // Keeps its capacity
+    auto addMarker = [&](const sf::Vector2f& worldPos, float size, const sf::Color& color) {
+        const sf::Vector2f topLeft(origin.x + (worldPos.x - miniMapLeft) * scale.x, origin.y + worldPos.y * scale.y);
+        if (!area.contains(topLeft)) {
+            return;
+        }
+        const sf::Vector2f bottomRight(std::min(topLeft.x + size, area.position.x + area.size.x),
+                                       std::min(topLeft.y + size, area.position.y + area.size.y));
+        const sf::Vector2f topRight(bottomRight.x, topLeft.y);
+        const sf::Vector2f bottomLeft(topLeft.x, bottomRight.y);
+        miniMapMarkers.append(sf::Vertex{topLeft, color});
+        miniMapMarkers.append(sf::Vertex{topRight, color});
+        miniMapMarkers.append(sf::Vertex{bottomLeft, color});
+        miniMapMarkers.append(sf::Vertex{bottomLeft, color});
+        miniMapMarkers.append(sf::Vertex{topRight, color});
+        miniMapMarkers.append(sf::Vertex{bottomRight, color});
+    };
     
-    // Update enemy positions
-    for (size_t i = 0; i < enemies.size() && i < miniMapEnemies.size(); i++) {
-        sf::FloatRect bounds = enemies[i].getGlobalBounds();
-        sf::Vector2f miniEnemyPos(
-            bounds.position.x * scaleX,
-            bounds.position.y * scaleY
-        );
-        miniMapEnemies[i].setPosition(miniEnemyPos);
+    if (showEnemies) {
+        for (size_t i = 0; i < enemies.size(); ++i) {
+            addMarker(enemies.getCurrentPosition(i), 6.f, sf::Color::Red);
+        }
+    }
+    if (npcManager) {
+        for (const auto& npc : npcManager->getAllNPCs()) {
+            if (npc.isActive) {
+                addMarker(sf::Vector2f(npc.x, npc.y), 6.f, sf::Color::Cyan);
+            }
+        }
     }
+    // Player last so it stays on top
+    addMarker(player.getPosition(), 8.f, sf::Color::Yellow);
 }
 
 
@@ -773,7 +1114,16 @@ void Game::updateFPS() {
         // Update FPS text with one decimal place precision
         std::stringstream ss;
         ss << std::fixed << std::setprecision(1) << "FPS: " << currentFPS;
-        fpsText.setString(ss.str());
+        hud.setString(fpsText, ss.str());
+        
+        // Drawn / culled per category (NPCs are counted by the NPC manager)
+        const ViewCulling::CullStats npcStats = npcManager ? npcManager->getCullStats() : ViewCulling::CullStats();
+        std::stringstream cull;
+        cull << "Platforms " << platformCullStats.drawn << " / " << platformCullStats.culled << "\n"
+             << "Enemies   " << enemyCullStats.drawn << " / " << enemyCullStats.culled << "\n"
+             << "NPCs      " << npcStats.drawn << " / " << npcStats.culled << "\n"
+             << "Debug     " << debugBoxCullStats.drawn << " / " << debugBoxCullStats.culled;
+        hud.setString(cullText, cull.str());
         
         // Reset counters
         frameCount = 0;
@@ -781,255 +1131,527 @@ void Game::updateFPS() {
     }
 }
 
-void Game::drawFPS() {
-    // Make sure we're in UI view
-    window.setView(uiView);
-    
-    // Draw the background first
-    window.draw(fpsBackground);
-    
-    // Draw FPS text in the top-right corner
-    window.draw(fpsText);
+void Game::startReplayRecording() {
+    stopNetplay(); // A replay holds one player's controls
+    // Start from a known state: the current level from its spawn, tiles from a fresh seed
+    InputReplay::Header header;
+    header.level = currentLevel;
+    header.tileSeed = std::random_device()();
+    header.fixedTimeStep = fixedTimeStep;
+    renderingSystem.setRandomSeed(header.tileSeed);
+    renderingSystem.invalidatePlatformCache();
+    jumpToLevel(header.level);
+    timeAccumulator = 0.0f;
+    replay.begin(header);
+    replayMode = ReplayMode::Recording;
+    logInfo("Recording a replay of level " + std::to_string(header.level));
 }
 
-void Game::initializeMiniMap() {
-    // Create mini-map border
-    miniMapBorder.setSize(sf::Vector2f(MINI_MAP_WIDTH, MINI_MAP_HEIGHT));
-    miniMapBorder.setPosition(sf::Vector2f(
-        WINDOW_WIDTH - MINI_MAP_WIDTH - MINI_MAP_MARGIN,
-        WINDOW_HEIGHT - MINI_MAP_HEIGHT - MINI_MAP_MARGIN
-    ));
-    miniMapBorder.setFillColor(sf::Color(0, 0, 0, 100)); // Semi-transparent black
-    miniMapBorder.setOutlineColor(sf::Color::White);
-    miniMapBorder.setOutlineThickness(2.f);
-    
-    // Create player icon for mini-map - larger for better visibility
-    miniMapPlayerIcon.setSize(sf::Vector2f(8.f, 8.f));
-    miniMapPlayerIcon.setFillColor(sf::Color::Yellow);
-    
-    // Calculate scaling factors to properly fill mini-map
-    // Use slightly more aggressive scaling to fill the mini-map completely
-    float scaleX = (float)(MINI_MAP_WIDTH - 8) / LEVEL_WIDTH;
-    float scaleY = (float)(MINI_MAP_HEIGHT - 8) / WINDOW_HEIGHT;
-    
-    // Create platform representations for mini-map
-    miniMapPlatforms.clear();
-    for (const auto& platform : platforms) {
-        sf::RectangleShape miniPlatform;
-        
-        miniPlatform.setSize(sf::Vector2f(
-            platform.getSize().x * scaleX,
-            platform.getSize().y * scaleY
-        ));
-        
-        // Fix position setting for SFML 3.x
-        sf::Vector2f platformPos(
-            platform.getPosition().x * scaleX,
-            platform.getPosition().y * scaleY
-        );
-        miniPlatform.setPosition(platformPos);
-        
-        miniPlatform.setFillColor(sf::Color::Green);
-        miniMapPlatforms.push_back(miniPlatform);
+InputReplay::EndState Game::getReplayEndState() const {
+    InputReplay::EndState state;
+    state.playerX = player.getPosition().x;
+    state.playerY = player.getPosition().y;
+    state.playerVelX = player.getVelocity().x;
+    state.playerVelY = player.getVelocity().y;
+    state.enemyCount = static_cast<uint32_t>(enemies.size());
+    uint32_t hash = InputReplay::HASH_SEED;
+    hash = InputReplay::hashFloats(hash, enemies.posX.data(), enemies.size());
+    hash = InputReplay::hashFloats(hash, enemies.posY.data(), enemies.size());
+    hash = InputReplay::hashFloats(hash, enemies.velX.data(), enemies.size());
+    hash = InputReplay::hashFloats(hash, enemies.velY.data(), enemies.size());
+    state.enemyHash = hash;
+    return state;
+}
+
+void Game::stopReplayRecording() {
+    replayMode = ReplayMode::Off;
+    replay.setEndState(getReplayEndState());
+    std::string error;
+    if (replay.save(replayPath, error)) {
+        logInfo("Saved a replay of " + std::to_string(replay.getFrameCount()) + " frames (" +
+                std::to_string(replay.getTickCount()) + " steps) to " + replayPath);
+    } else {
+        logError("Failed to save the replay: " + error);
     }
-    
-    // Create ladder representations for mini-map
-    miniMapLadders.clear();
-    for (const auto& ladder : ladders) {
-        sf::RectangleShape miniLadder;
-        
-        miniLadder.setSize(sf::Vector2f(
-            ladder.getSize().x * scaleX,
-            ladder.getSize().y * scaleY
-        ));
-        
-        // Fix position setting for SFML 3.x
-        sf::Vector2f ladderPos(
-            ladder.getPosition().x * scaleX,
-            ladder.getPosition().y * scaleY
-        );
-        miniLadder.setPosition(ladderPos);
-        
-        miniLadder.setFillColor(sf::Color(139, 69, 19)); // Brown
-        miniMapLadders.push_back(miniLadder);
+}
+
+bool Game::playReplay(const std::string& path) {
+    std::string error;
+    if (!replay.load(path, error)) {
+        logError("Failed to load replay: " + error);
+        return false;
     }
-    
-    // Create enemy representations for mini-map
-    miniMapEnemies.clear();
-    for (const auto& enemy : enemies) {
-        sf::RectangleShape miniEnemy;
-        
-        sf::FloatRect bounds = enemy.getGlobalBounds();
-        miniEnemy.setSize(sf::Vector2f(8.f, 8.f)); // Larger for better visibility
-        
-        // Fix position setting for SFML 3.x
-        sf::Vector2f enemyPos(
-            bounds.position.x * scaleX,
-            bounds.position.y * scaleY
-        );
-        miniEnemy.setPosition(enemyPos);
-        
-        miniEnemy.setFillColor(sf::Color::Red);
-        miniMapEnemies.push_back(miniEnemy);
+    const InputReplay::Header& header = replay.getHeader();
+    if (header.level < 1 || header.level > levelCount) {
+        logError("Replay " + path + " is of level " + std::to_string(header.level) + ", which doesn't exist");
+        return false;
     }
+    replayMode = ReplayMode::Off; // jumpToLevel below must not end a recording in progress
+    stopNetplay();
+    fixedTimeStep = header.fixedTimeStep;
+    renderingSystem.setRandomSeed(header.tileSeed);
+    renderingSystem.invalidatePlatformCache();
+    jumpToLevel(header.level);
+    timeAccumulator = 0.0f;
+    inputSystem.releaseAll();
+    replayMode = ReplayMode::Playing;
+    logInfo("Playing replay " + path + ": level " + std::to_string(header.level) + ", " +
+            std::to_string(replay.getFrameCount()) + " frames");
+    return true;
 }
 
-void Game::checkLevelCompletion() {
-    // Only check for level completion if player is on ground
-    if (!player.isOnGround()) {
+void Game::stopReplayPlayback() {
+    replayMode = ReplayMode::Off;
+    logInfo("Replay stopped after " + std::to_string(replay.getFrameCursor()) + " of " +
+            std::to_string(replay.getFrameCount()) + " frames");
+    if (!replay.isFinished()) {
+        return; // Cut short, so there is nothing to compare
+    }
+    // Round trip: the playback has to end where the recording did
+    const InputReplay::EndState& recorded = replay.getEndState();
+    const InputReplay::EndState played = getReplayEndState();
+    if (played == recorded) {
+        logInfo("Replay ended in the recorded state");
         return;
     }
+    std::ostringstream message;
+    message << "Replay desynced: player at (" << played.playerX << ", " << played.playerY << ") moving ("
+            << played.playerVelX << ", " << played.playerVelY << "), recorded (" << recorded.playerX << ", "
+            << recorded.playerY << ") moving (" << recorded.playerVelX << ", " << recorded.playerVelY << "); "
+            << played.enemyCount << " enemies hashing to " << played.enemyHash << ", recorded "
+            << recorded.enemyCount << " hashing to " << recorded.enemyHash;
+    logWarning(message.str());
+}
+
+// Identifies what a save state can be restored into
+struct SimStateHeader {
+    int level;
+    float activeLeft;
+    float activeRight;
+    uint32_t enemies;
+    uint32_t npcs;
+};
+
+void Game::writeSimState(SimSnapshot& out) {
+    const LevelStreamer::Stats streaming = levelStreamer.getStats();
+    SimStateHeader header{currentLevel, streaming.activeLeft, streaming.activeRight,
+                          static_cast<uint32_t>(enemies.size()),
+                          static_cast<uint32_t>(npcManager ? npcManager->getAllNPCs().size() : 0)};
+    out.clear();
+    out.write(header);
+    out.write(currentState);
+    out.write(playerHit);
+    out.write(hitCooldownTimer);
+    out.write(transitionTimer);
+    out.write(transitionLevel);
+    out.writeArray(playerTriggers);
+    gameTimers.saveState(out);
+    out.write(gameView.getCenter());
+    out.write(interpolationAlpha);
+    player.saveState(out);
+    enemies.saveState(out);
+    projectiles.saveState(out);
+    physicsSystem.saveState(out);
+    if (npcManager) {
+        npcManager->saveState(out);
+    }
+}
+
+Game::SimStateRead Game::readSimState(SimSnapshot& in) {
+    in.rewind();
+    SimStateHeader header{};
+    in.read(header);
+    const LevelStreamer::Stats streaming = levelStreamer.getStats();
+    const size_t npcCount = npcManager ? npcManager->getAllNPCs().size() : 0;
+    if (header.level != currentLevel || header.activeLeft != streaming.activeLeft ||
+        header.activeRight != streaming.activeRight || header.enemies != enemies.size() ||
+        header.npcs != npcCount) {
+        // Other sectors mean other platforms and enemies; the state wouldn't line up
+        return SimStateRead::OtherSectors;
+    }
     
-    // Check if player has reached the end of the level (right edge)
-    if (player.getPosition().x >= LEVEL_WIDTH - player.getSize().x - 50.f) {
-        // Handle differently based on current level
-        if (currentLevel == 1) {
-            // Player has reached the end of level 1
-            currentState = GameState::LevelTransition;
-            transitionTimer = LEVEL_TRANSITION_DURATION;
-            
-            // Set up level transition text
-            levelText.setString("Level " + std::to_string(currentLevel) + " Completed!");
-            
-            // Center the text
-            sf::FloatRect levelBounds = levelText.getGlobalBounds();
-            levelText.setPosition(sf::Vector2f(
-                WINDOW_WIDTH / 2.f - levelBounds.size.x / 2.f,
-                WINDOW_HEIGHT / 2.f - levelBounds.size.y / 2.f
-            ));
-        } else if (currentLevel == 2) {
-            // Player has completed the final level
-            currentState = GameState::GameOver;
-            
-            // Update game over text to show victory
-            gameOverText.setString("CONGRATULATIONS!");
-            gameOverText.setFillColor(sf::Color::Green);
-            
-            // Position game over text
-            sf::FloatRect gameOverBounds = gameOverText.getGlobalBounds();
-            gameOverText.setPosition(sf::Vector2f(
-                WINDOW_WIDTH / 2.f - gameOverBounds.size.x / 2.f,
-                WINDOW_HEIGHT / 2.f - gameOverBounds.size.y / 2.f - 40.f
-            ));
-            
-            // Update restart text
-            restartText.setString("Press ENTER to play again");
-            sf::FloatRect restartBounds = restartText.getGlobalBounds();
-            restartText.setPosition(sf::Vector2f(
-                WINDOW_WIDTH / 2.f - restartBounds.size.x / 2.f,
-                WINDOW_HEIGHT / 2.f - restartBounds.size.y / 2.f + 40.f
-            ));
-            
-            // Log completion
-            logInfo("Player completed the final level!");
+    sf::Vector2f viewCenter;
+    bool ok = in.read(currentState) && in.read(playerHit) && in.read(hitCooldownTimer) &&
+              in.read(transitionTimer) && in.read(transitionLevel) && in.readArray(playerTriggers) &&
+              gameTimers.loadState(in) &&
+              in.read(viewCenter) && in.read(interpolationAlpha) &&
+              player.loadState(in) && enemies.loadState(in) && projectiles.loadState(in) &&
+              physicsSystem.loadState(in);
+    if (ok && npcManager) {
+        ok = npcManager->loadState(in);
+    }
+    if (!ok) {
+        return SimStateRead::Truncated;
+    }
+    gameView.setCenter(viewCenter);
+    return SimStateRead::Restored;
+}
+
+bool Game::saveSimState() {
+    const auto start = std::chrono::steady_clock::now();
+    writeSimState(quickSave);
+    quickSaveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    GAME_LOG(Info, "Saved state: {} bytes in {} ms", quickSave.size(), quickSaveMs);
+    return true;
+}
+
+bool Game::restoreSimState() {
+    if (quickSave.empty()) {
+        logWarning("No saved state to restore");
+        return false;
+    }
+    if (replayMode != ReplayMode::Off || netplay.isActive()) {
+        logWarning("Save states can't be restored while a replay or netplay is running");
+        return false;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const SimStateRead result = readSimState(quickSave);
+    if (result == SimStateRead::OtherSectors) {
+        logWarning("Saved state is of another level, or of other sectors, enemies or NPCs; not restoring");
+        return false;
+    }
+    if (result == SimStateRead::Truncated) {
+        // Some systems are already half-restored; start the level over
+        logError("Saved state is truncated; reloading the level");
+        quickSave.clear();
+        jumpToLevel(currentLevel);
+        return false;
+    }
+    timeAccumulator = 0.0f;
+    inputSystem.releaseAll();
+    quickRestoreMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    GAME_LOG(Info, "Restored state in {} ms", quickRestoreMs);
+    return true;
+}
+
+bool Game::hostNetplay(unsigned short port) {
+    NetTransport::MatchSettings match;
+    match.level = static_cast<uint32_t>(currentLevel);
+    match.tileSeed = std::random_device()();
+    match.fixedTimeStep = fixedTimeStep;
+    match.inputDelay = static_cast<uint32_t>(netplayInputDelay);
+    std::string error;
+    if (!netTransport.host(port, match, error)) {
+        logError("Netplay: " + error);
+        return false;
+    }
+    logInfo("Netplay: waiting for a peer on UDP port " + std::to_string(port));
+    return true;
+}
+
+bool Game::joinNetplay(const std::string& address, unsigned short port) {
+    std::string error;
+    if (!netTransport.join(address, port, error)) {
+        logError("Netplay: " + error);
+        return false;
+    }
+    logInfo("Netplay: joining " + address + ":" + std::to_string(port));
+    return true;
+}
+
+void Game::stopNetplay() {
+    if (netplay.isActive()) {
+        const RollbackSession::Stats& stats = netplay.getStats();
+        logInfo("Netplay ended at tick " + std::to_string(stats.tick) + ": " + std::to_string(stats.rollbacks) +
+                " rollbacks, " + std::to_string(stats.resimulatedTicks) + " ticks run again");
+    }
+    netplay.stop();
+    netTransport.close();
+}
+
+void Game::startNetplayMatch(const NetTransport::MatchSettings& match) {
+    // Both peers start from the same state: the host's level from its spawn, its tile seed and step
+    if (replayMode == ReplayMode::Recording) {
+        stopReplayRecording();
+    } else if (replayMode == ReplayMode::Playing) {
+        stopReplayPlayback();
+    }
+    fixedTimeStep = match.fixedTimeStep;
+    renderingSystem.setRandomSeed(match.tileSeed);
+    renderingSystem.invalidatePlatformCache();
+    netplay.start(match.inputDelay);
+    jumpToLevel(static_cast<int>(match.level));
+    timeAccumulator = 0.0f;
+    inputSystem.releaseAll();
+    logInfo("Netplay: playing level " + std::to_string(match.level) + " with " + netTransport.getPeerName() +
+            ", input delay " + std::to_string(netplay.getInputDelay()) + " ticks");
+}
+
+void Game::updateNetplay() {
+    if (netTransport.getState() == NetTransport::State::Closed) {
+        return;
+    }
+    netTransport.update();
+    for (NetTransport::Message message = netTransport.receive(); message != NetTransport::Message::None;
+         message = netTransport.receive()) {
+        if (message == NetTransport::Message::Welcome) {
+            startNetplayMatch(netTransport.getSettings());
+        } else if (message == NetTransport::Message::Inputs) {
+            netplay.readInputPacket(netTransport.getPayload(), netTransport.getPayloadSize());
         }
     }
+    if (netTransport.getState() == NetTransport::State::Closed) {
+        logWarning("Netplay: " + netTransport.getLastError());
+        stopNetplay();
+    }
 }
 
-void Game::nextLevel() {
-    // Only go to level 2 if we're on level 1
-    if (currentLevel >= 2) {
-        logWarning("Already at final level (2), cannot go to next level");
+PlayerInput Game::beginNetplayTick(const PlayerInput& local) {
+    const uint32_t tick = netplay.getTick();
+    writeSimState(netplay.snapshotFor(tick));
+    netplay.addLocalInput(InputSystem::fromPlayerInput(local));
+    return InputSystem::toPlayerInput(netplay.getButtons(tick));
+}
+
+void Game::rollbackNetplay(uint32_t from) {
+    PROFILE_ZONE("Game::rollbackNetplay");
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t allocations = AllocationTracker::getTotals().allocations;
+    const size_t events = gameEvents.getEvents().size();
+    if (readSimState(netplay.snapshotFor(from)) != SimStateRead::Restored) {
+        // History resets on every level load, so this is a bug rather than bad luck
+        logError("Netplay: the snapshot of tick " + std::to_string(from) + " doesn't fit the level; ending the match");
+        stopNetplay();
+        jumpToLevel(currentLevel);
+        return;
+    }
+    const uint32_t end = netplay.getTick();
+    const int level = currentLevel;
+    uint32_t ticks = 0;
+    for (uint32_t tick = from; tick < end && currentLevel == level; ++tick, ++ticks) {
+        if (tick > from) {
+            writeSimState(netplay.snapshotFor(tick));
+        }
+        storePreviousState();
+        tickInput = InputSystem::toPlayerInput(netplay.getButtons(tick));
+        fixedUpdate(fixedTimeStep);
+    }
+    // The predicted run already played these ticks' sounds and effects
+    gameEvents.discardFrom(events);
+    netplay.endRollback(ticks,
+                        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+                        AllocationTracker::getTotals().allocations - allocations);
+}
+
+void Game::sendNetplayInputs() {
+    const size_t size = netplay.writeInputPacket(netplayPacket.data(), netplayPacket.size());
+    if (size > 0) {
+        netTransport.sendInputs(netplayPacket.data(), size);
+    }
+}
+
+void Game::applyFramePacing() {
+    // Changing vsync makes the window's context current, so take it off the render thread
+    const bool restart = renderThread.isRunning();
+    if (restart) {
+        renderThread.stop();
+    }
+    // FramePacer does the limiting; SFML's own limiter only sleeps to the millisecond
+    window.setFramerateLimit(0);
+    window.setVerticalSyncEnabled(framePacer.wantsVSync());
+    if (restart) {
+        useRenderThread = renderThread.start(window);
+    }
+}
+
+void Game::applyBackgroundMode() {
+    framePacer.setThrottleFps(windowFocused ? 0u : static_cast<unsigned>(backgroundFps));
+    if (windowFocused) {
+        // The paused frames' long dts would otherwise be averaged into the first steps
+        framePacer.resetSmoothing();
+    }
+    logDebug(std::string("Window ") + (windowFocused ? "focused" : "in the background") +
+             (isBackgroundPaused() ? ", simulation paused" : ""));
+}
+
+void Game::drawHud(RenderSnapshot& snapshot) {
+    // The FPS counter only without ImGui (which shows FPS already); the level
+    // indicator too while playing, the state screens' texts always
+    const bool counters = !useImGuiInterface;
+    const bool playing = currentState == GameState::Playing;
+    const bool transition = currentState == GameState::LevelTransition;
+    const bool gameOver = currentState == GameState::GameOver;
+    hud.setVisible(fpsBackground, counters);
+    hud.setVisible(fpsText, counters);
+    hud.setVisible(cullText, counters);
+    hud.setVisible(levelText, (playing && counters) || transition);
+    hud.setVisible(loadingText, transition);
+    hud.setVisible(gameOverText, gameOver);
+    hud.setVisible(restartText, gameOver);
+    
+    snapshot.setView(uiView);
+    hud.draw(snapshot, RenderCategory::UI);
+}
+
+void Game::initializeMiniMap() {
+    // The mini-map shows the active sectors (the whole level when it fits)
+    const LevelStreamer::Stats streaming = levelStreamer.getStats();
+    miniMapLeft = streaming.activeLeft;
+    miniMapSpan = std::max(streaming.activeRight - streaming.activeLeft, 1.f);
+    if (!miniMapTextureValid) {
         return;
     }
     
-    // Increment level (will be 2)
-    currentLevel++;
-    
-    // Reset player position to left side of level
-    player.setPosition(sf::Vector2f(50.f, WINDOW_HEIGHT / 2.f));
-    
-    // Reset view
-    gameView.setCenter(sf::Vector2f(WINDOW_WIDTH / 2.f, WINDOW_HEIGHT / 2.f));
-    
-    // Reset game state
-    currentState = GameState::Playing;
-    
-    // Update level text
-    levelText.setString("Level " + std::to_string(currentLevel));
-    sf::FloatRect levelBounds = levelText.getGlobalBounds();
-    levelText.setPosition(sf::Vector2f(
-        WINDOW_WIDTH / 2.f - levelBounds.size.x / 2.f,
-        20.f
-    ));
+    // Bake the background and border first, in texture pixels
+    miniMapTexture.setView(miniMapTexture.getDefaultView());
+    miniMapTexture.clear(sf::Color::Transparent);
+    sf::RectangleShape border(sf::Vector2f(MINI_MAP_WIDTH, MINI_MAP_HEIGHT));
+    border.setPosition(sf::Vector2f(MINI_MAP_OUTLINE, MINI_MAP_OUTLINE));
+    border.setFillColor(MINI_MAP_FILL);
+    border.setOutlineColor(sf::Color::White);
+    border.setOutlineThickness(MINI_MAP_OUTLINE);
+    renderingSystem.submit(miniMapTexture, border, RenderCategory::MiniMap);
+    
+    // Then the level in world coordinates, through a view whose viewport is the
+    // inside of the border (which also clips anything past the active range)
+    const sf::Vector2f textureSize(miniMapTexture.getSize());
+    miniMapView.setSize(sf::Vector2f(miniMapSpan, WINDOW_HEIGHT));
+    miniMapView.setCenter(sf::Vector2f(miniMapLeft + miniMapSpan / 2.f, WINDOW_HEIGHT / 2.f));
+    miniMapView.setViewport(sf::FloatRect(
+        sf::Vector2f((MINI_MAP_OUTLINE + MINI_MAP_INSET) / textureSize.x, (MINI_MAP_OUTLINE + MINI_MAP_INSET) / textureSize.y),
+        sf::Vector2f((MINI_MAP_WIDTH - 2.f * MINI_MAP_INSET) / textureSize.x, (MINI_MAP_HEIGHT - 2.f * MINI_MAP_INSET) / textureSize.y)));
+    miniMapTexture.setView(miniMapView);
+    
+    // All platforms and ladders as one vertex array
+    levelVertices.clear();
+    for (size_t i = 0; i < platforms.size(); ++i) {
+        platforms.appendQuad(i, sf::Color::Green, levelVertices);
+    }
+    for (size_t i = 0; i < ladders.size(); ++i) {
+        ladders.appendQuad(i, sf::Color(139, 69, 19), levelVertices); // Brown
+    }
+    if (!levelVertices.empty()) {
+        renderingSystem.submit(miniMapTexture, levelVertices.data(), levelVertices.size(), sf::PrimitiveType::Triangles,
+                               RenderCategory::MiniMap);
+    }
+    miniMapTexture.display();
+}
 
-    // Initialize level-specific NPCs
-    initializeNPCs();
+void Game::updateTriggers() {
+    // The triggers the player overlaps now, from the pair list, against those of the last step
+    triggerHits.clear();
+    uint32_t playerIndex, triggerIndex;
+    for (const auto& pair : entityBroadphase.getPairs()) {
+        if (entityBroadphase.match(pair, SweepAndPrune::Layer::Player, SweepAndPrune::Layer::Trigger, playerIndex,
+                                   triggerIndex)) {
+            triggerHits.push_back(triggerIndex);
+        }
+    }
+    std::sort(triggerHits.begin(), triggerHits.end());
+    const sf::Vector2f position = player.getPosition();
+    size_t previous = 0;
+    for (uint32_t trigger : triggerHits) {
+        for (; previous < playerTriggers.size() && playerTriggers[previous] < trigger; ++previous) {
+            gameEvents.emit(GameEventType::TriggerExit, position, static_cast<float>(playerTriggers[previous]));
+        }
+        const bool stayed = previous < playerTriggers.size() && playerTriggers[previous] == trigger;
+        gameEvents.emit(stayed ? GameEventType::TriggerStay : GameEventType::TriggerEnter, position,
+                        static_cast<float>(trigger));
+        previous += stayed ? 1 : 0;
+    }
+    for (; previous < playerTriggers.size(); ++previous) {
+        gameEvents.emit(GameEventType::TriggerExit, position, static_cast<float>(playerTriggers[previous]));
+    }
+    playerTriggers.swap(triggerHits);
     
-    // Change background and theme for Snow Forest (Level 2)
-    try {
-        std::string levelBackgroundPath = "assets/images/backgrounds/snow_forest/snow_forest_background.png";
-        platformColor = sf::Color(180, 200, 240); // Slightly different blue for snow forest
-        std::vector<std::string> alternativePaths = {
-            "assets/images/backgrounds/snow_forest_background.png",
-            "assets/images/backgrounds/snow/snow_background.png",
-            "assets/images/backgrounds/background.png",
-            "../assets/images/backgrounds/background.png"
-        };
-        
-        // Try to load the level-specific background
-        bool loaded = false;
-        try {
-            assets.loadTexture("background", levelBackgroundPath);
-            logInfo("Successfully loaded background: " + levelBackgroundPath);
-            loaded = true;
-        } 
-        catch (const std::exception& e) {
-            logError("Failed to load primary background: " + std::string(e.what()));
-            
-            // Try alternative paths
-            for (const auto& path : alternativePaths) {
-                try {
-                    assets.loadTexture("background", path);
-                    logInfo("Successfully loaded alternative background: " + path);
-                    loaded = true;
+    // Actions, by trigger index; the first that changes the game state ends the step's checks
+    for (uint32_t index : playerTriggers) {
+        const LevelData::Trigger& trigger = levelData.triggers[index];
+        if (trigger.grounded && !player.isOnGround()) {
+            continue;
+        }
+        switch (trigger.action) {
+            case LevelData::TriggerAction::ExitNext:
+                if (currentLevel < levelCount) {
+                    currentState = GameState::LevelTransition;
+                    transitionLevel = currentLevel + 1;
+                    transitionTimer = gameTimers.scheduleIn(LEVEL_TRANSITION_DURATION,
+                                                            static_cast<uint32_t>(GameTimer::LevelTransition));
+                    gameEvents.emit(GameEventType::LevelComplete, position, static_cast<float>(transitionLevel));
+                } else {
+                    // Player has completed the final level
+                    currentState = GameState::GameOver;
+                    gameEvents.emit(GameEventType::GameComplete, position);
+                }
+                return;
+            case LevelData::TriggerAction::ExitBack:
+                if (currentLevel <= 1) {
                     break;
-                } catch (const std::exception& innerE) {
-                    logWarning("Failed to load alternative background from " + path + ": " + std::string(innerE.what()));
                 }
-            }
-        }
-        
-        // Reload the layered background system for the new level
-        if (loaded) {
-            loadBackgroundLayers();
-            logInfo("Reloaded layered backgrounds for level " + std::to_string(currentLevel));
+                currentState = GameState::LevelTransition;
+                transitionLevel = currentLevel - 1;
+                transitionTimer = gameTimers.scheduleIn(LEVEL_TRANSITION_DURATION,
+                                                        static_cast<uint32_t>(GameTimer::LevelTransition));
+                gameEvents.emit(GameEventType::LevelExitBack, position, static_cast<float>(transitionLevel));
+                return;
+            case LevelData::TriggerAction::Kill:
+                if (player.isJumping()) {
+                    break;
+                }
+                currentState = GameState::GameOver;
+                gameEvents.emit(GameEventType::PlayerDied, position);
+                return;
+            case LevelData::TriggerAction::Event:
+                break;
         }
-        else {
-            useBackgroundPlaceholder = true;
-            backgroundPlaceholder.setFillColor(sf::Color(200, 220, 255)); // Light blue for snow theme
+    }
+}
+
+void Game::dispatchGameEvents() {
+    PROFILE_ZONE("Game::dispatchGameEvents");
+    // Effects are heard from the camera and placed where their event happened
+    soundSystem.setListener(gameView.getCenter());
+    for (const GameEvent& event : gameEvents.getEvents()) {
+        switch (event.type) {
+            case GameEventType::Jumped:
+                if (isSoundEffectsEnabled) soundSystem.playSoundEffectAt("jump", event.position);
+                break;
+            case GameEventType::Landed:
+                if (isSoundEffectsEnabled) soundSystem.playSoundEffectAt("land", event.position);
+                break;
+            case GameEventType::PlayerHit:
+                if (isSoundEffectsEnabled) soundSystem.playSoundEffectAt("hit", event.position);
+                break;
+            case GameEventType::PlayerDied:
+                centerText(gameOverText, -40.f);
+                centerText(restartText, 40.f);
+                break;
+            case GameEventType::LevelComplete:
+            case GameEventType::LevelExitBack: {
+                const int level = static_cast<int>(event.value);
+                preloadLevel(level);
+                hud.setString(levelText, event.type == GameEventType::LevelComplete
+                                             ? "Level " + std::to_string(level - 1) + " Completed!"
+                                             : "Going to Level " + std::to_string(level));
+                centerText(levelText, 0.f);
+                break;
+            }
+            case GameEventType::GameComplete:
+                // Game over text shows the victory
+                hud.setString(gameOverText, "CONGRATULATIONS!");
+                hud.setFillColor(gameOverText, sf::Color::Green);
+                hud.setString(restartText, "Press ENTER to play again");
+                centerText(gameOverText, -40.f);
+                centerText(restartText, 40.f);
+                logInfo("Player completed the final level!");
+                break;
+            default:
+                break;
         }
-    } catch (const std::exception& e) {
-        logError("Failed to load background for level " + std::to_string(currentLevel) + ": " + std::string(e.what()));
-        useBackgroundPlaceholder = true;
-        backgroundPlaceholder.setFillColor(sf::Color(200, 220, 255)); // Light blue for snow theme
     }
-    
-    // Reinitialize game elements
-    initializePlatforms();
-    initializeEnemies();
-    initializeUI();
-    initializeMiniMap();
-    
-    // Add extra enemies for level 2
-    for (int i = 0; i < 2; i++) {
-        float x = 500.f + (i * 400.f);  // Space them out
-        float y = WINDOW_HEIGHT - 70.f; // On the ground
-        float patrolDistance = 180.f; // Fixed patrol distance for level 2
-        enemies.push_back(Enemy(x, y, patrolDistance));
+    gameEvents.clear();
+}
+
+void Game::centerText(HudLayer::WidgetId text, float offsetY) {
+    hud.setPlacement(text, HudLayer::Placement::Centred, sf::Vector2f(0.f, offsetY));
+}
+
+void Game::nextLevel() {
+    if (currentLevel >= levelCount) {
+        logWarning("Already at final level (" + std::to_string(levelCount) + "), cannot go to next level");
+        return;
     }
-    
-    // Puzzle-focused physics
-    physicsSystem.setGravity(15.0f);
-    physicsSystem.setJumpForce(200.f);
-    
-    // Initialize physics system
-    physicsSystem.initialize();
-    physicsSystem.initializePlayer(player);
-    physicsSystem.initializePlatforms(platforms);
-    physicsSystem.initializeEnemies(enemies);
-    
-    logInfo("Advanced to Snow Forest (Level 2)");
+    loadLevel(currentLevel + 1, LevelEntry::FromLeft);
 }
 
 void Game::previousLevel() {
@@ -1038,103 +1660,307 @@ void Game::previousLevel() {
         logWarning("Already at level 1, cannot go to previous level");
         return;
     }
+    // Going backwards, so arrive at the right side of the level
+    loadLevel(currentLevel - 1, LevelEntry::FromRight);
+}
+
+void Game::jumpToLevel(int level) {
+    sceneActive = false; // The level itself, even when it's the one the scene stood in for
+    loadLevel(level, LevelEntry::Spawn);
+}
+
+void Game::loadGeneratedScene() {
+    sceneActive = true;
+    loadLevel(currentLevel, LevelEntry::Spawn);
+}
+
+// Keeps the current level's look; the scene has no theme of its own. Its
+// empty source keeps it out of the level cache.
+void Game::generateScene() {
+    const auto start = std::chrono::steady_clock::now();
+    LevelData scene;
+    SceneGenerator::generate(sceneConfig, scene);
+    scene.background = levelData.background;
+    scene.backgroundFallbacks = levelData.backgroundFallbacks;
+    scene.music = levelData.music;
+    scene.platformColor = levelData.platformColor;
+    scene.colorGrade = levelData.colorGrade;
+    scene.gradeTint = levelData.gradeTint;
+    scene.dayLength = levelData.dayLength;
+    levelData = std::move(scene);
+    GAME_LOG(Info, "Generated scene (seed {}, {} px wide) in {} ms: {} platforms, {} ladders, {} enemies, {} NPCs, {} decorations",
+             sceneConfig.seed, static_cast<int>(levelData.size.x),
+             std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+             levelData.platforms.size(), levelData.ladders.size(), levelData.enemies.size(), levelData.npcs.size(),
+             levelData.decorations.size());
+}
+
+bool Game::loadLevelData(int level) {
+    std::string error;
+    // Preloaded data (the usual case at a transition) is swapped in
+    const bool preloaded = levelPreloader.has(level);
+    if (preloaded ? levelPreloader.take(level, levelData, error) : LevelLoader::loadLevel(level, levelData, error)) {
+        GAME_LOG(Info, "Loaded level {} ({}) from {}{}{} platforms, {} enemies, {} NPCs", level, levelData.name,
+                 levelData.source, preloaded ? " (preloaded): " : ": ", levelData.platforms.size(),
+                 levelData.enemies.size(), levelData.npcs.size());
+        return true;
+    }
     
-    // Decrement level (will be 1)
-    currentLevel--;
+    // Keep the game playable without its data: a bare ground strip
+    logError("Failed to load level " + std::to_string(level) + ": " + error);
+    levelData.clear();
+    levelData.size = sf::Vector2f(LEVEL_WIDTH, WINDOW_HEIGHT);
+    levelData.spawn = sf::Vector2f(50.f, WINDOW_HEIGHT - GROUND_HEIGHT - 40.f);
+    levelData.entryLeft = levelData.spawn;
+    levelData.entryRight = sf::Vector2f(LEVEL_WIDTH - 100.f, WINDOW_HEIGHT / 2.f);
+    LevelData::Platform ground;
+    ground.bounds = sf::FloatRect({0.f, WINDOW_HEIGHT - GROUND_HEIGHT}, {static_cast<float>(LEVEL_WIDTH), GROUND_HEIGHT});
+    levelData.platforms.push_back(ground);
+    return false;
+}
+
+void Game::loadLevel(int level, LevelEntry entry) {
+    const auto loadStart = std::chrono::steady_clock::now();
+    AllocationTracker::ScopedTag memoryTag(AllocationTracker::Tag::Level); // Subsystems below set their own
+    // Replaces textures, the tile cache and text the frame in flight draws
+    renderThread.waitIdle();
+    const int previousLevel = currentLevel;
+    currentLevel = std::min(std::max(level, 1), levelCount);
+    levelBundles.hold(currentLevel); // The level left (and any other preload) is released
+    netplay.resetHistory(); // No rolling back into the previous level
+    
+    // A level left recently is swapped back in, built; the one being left is parked
+    const bool changingLevel = currentLevel != previousLevel;
+    if (changingLevel) {
+        parkLevel(previousLevel);
+        sceneActive = false;
+    }
+    LevelCache::Entry cached; // Its texture refs hold the backgrounds until the layers take them
+    const bool warm = changingLevel && levelCache.take(currentLevel, cached);
+    if (sceneActive) {
+        generateScene(); // Again on a reload: the same config gives the same scene
+    } else if (warm) {
+        levelData = std::move(cached.data);
+        renderingSystem.restoreDecorationCache(std::move(cached.decorations));
+        GAME_LOG(Info, "Loaded level {} ({}) from the level cache", currentLevel, levelData.name);
+    } else {
+        loadLevelData(currentLevel);
+    }
+    collectLevelAssets();
+    platformColor = levelData.platformColor;
+    renderingSystem.getParticles().setBudget(snowEmitter, sceneActive ? sceneConfig.particles : SNOW_BUDGET);
+    if (isMusicEnabled) {
+        // Prefetched during the approach; the same track carries on
+        soundSystem.crossfadeMusic(LevelAssets::getMusicStem(levelData), LEVEL_MUSIC_CROSSFADE);
+    }
     
-    // Reset player position to right side of level (since we're going backwards)
-    player.setPosition(sf::Vector2f(LEVEL_WIDTH - 100.f, WINDOW_HEIGHT / 2.f));
+    // Place the player for how they arrived
+    switch (entry) {
+        case LevelEntry::Spawn:
+            player.reset(levelData.spawn.x, levelData.spawn.y);
+            player.setCollisionBoxSize(sf::Vector2f(28.f, 28.f));
+            playerHit = false;
+            gameTimers.clear(); // A fresh start (and a replay's) runs its timers from scratch
+            break;
+        case LevelEntry::FromLeft:
+            player.setPosition(levelData.entryLeft);
+            break;
+        case LevelEntry::FromRight:
+            player.setPosition(levelData.entryRight);
+            break;
+        case LevelEntry::Reload:
+            break;
+    }
     
-    // Reset view
+    // Reset view and game state
     gameView.setCenter(sf::Vector2f(WINDOW_WIDTH / 2.f, WINDOW_HEIGHT / 2.f));
-    
-    // Reset game state
     currentState = GameState::Playing;
     
-    // Update level text
-    levelText.setString("Level " + std::to_string(currentLevel));
-    sf::FloatRect levelBounds = levelText.getGlobalBounds();
-    levelText.setPosition(sf::Vector2f(
-        WINDOW_WIDTH / 2.f - levelBounds.size.x / 2.f,
-        20.f
-    ));
-
-    // Initialize level-specific NPCs
+    // Level-specific NPCs and theme
     initializeNPCs();
-    
-    // Change background and theme for Snow Mountain (Level 1)
-    try {
-        std::string levelBackgroundPath = "assets/images/backgrounds/snow/snow_background.png";
-        platformColor = sf::Color(200, 220, 255); // Light blue for snow mountain
-        std::vector<std::string> alternativePaths = {
-            "assets/images/backgrounds/snow_background.png",
-            "assets/images/backgrounds/background.png",
-            "../assets/images/backgrounds/background.png"
-        };
-        
-        // Try to load the level-specific background
-        bool loaded = false;
-        try {
-            assets.loadTexture("background", levelBackgroundPath);
-            logInfo("Successfully loaded background: " + levelBackgroundPath);
-            loaded = true;
-        } 
-        catch (const std::exception& e) {
-            logError("Failed to load primary background: " + std::string(e.what()));
-            
-            // Try alternative paths
-            for (const auto& path : alternativePaths) {
-                try {
-                    assets.loadTexture("background", path);
-                    logInfo("Successfully loaded alternative background: " + path);
-                    loaded = true;
-                    break;
-                } catch (const std::exception& innerE) {
-                    logWarning("Failed to load alternative background from " + path + ": " + std::string(innerE.what()));
-                }
-            }
-        }
-        
-        // Reload the layered background system for the new level
-        if (loaded) {
-            loadBackgroundLayers();
-            logInfo("Reloaded layered backgrounds for level " + std::to_string(currentLevel));
-        }
-        else {
-            useBackgroundPlaceholder = true;
-            backgroundPlaceholder.setFillColor(sf::Color(200, 220, 255)); // Light blue for snow theme
-        }
-    } catch (const std::exception& e) {
-        logError("Failed to load background for level " + std::to_string(currentLevel) + ": " + std::string(e.what()));
-        useBackgroundPlaceholder = true;
-        backgroundPlaceholder.setFillColor(sf::Color(200, 220, 255)); // Light blue for snow theme
+    {
+        AllocationTracker::ScopedTag backgroundTag(AllocationTracker::Tag::Backgrounds);
+        loadLevelBackground();
     }
     
-    // Reinitialize game elements
-    initializePlatforms();
-    initializeEnemies();
+    // Reinitialize game elements from the level data
+    initializeSectors(warm);
     initializeUI();
-    initializeMiniMap();
     
-    // Puzzle-focused physics
-    physicsSystem.setGravity(15.0f);
-    physicsSystem.setJumpForce(200.f);
+    // Level physics
+    physicsSystem.setGravity(levelData.gravity);
+    physicsSystem.setJumpForce(levelData.jumpForce);
     
     // Initialize physics system
-    physicsSystem.initialize();
-    physicsSystem.initializePlayer(player);
-    physicsSystem.initializePlatforms(platforms);
-    physicsSystem.initializeEnemies(enemies);
+    {
+        AllocationTracker::ScopedTag physicsTag(AllocationTracker::Tag::Physics);
+        physicsSystem.initialize();
+        physicsSystem.initializePlayer(player);
+        physicsSystem.initializePlatforms(platforms);
+        physicsSystem.initializeEnemies(enemies);
+        if (npcManager) {
+            physicsSystem.initializeNPCs(npcManager->getAllNPCs());
+        }
+    }
+    
+#if GAME_EDITOR
+    if (levelEditor) {
+        if (levelEditor->hasUnsavedChanges()) {
+            logWarning("Level editor: unsaved edits to level " + std::to_string(previousLevel) +
+                       (changingLevel ? " are kept only while it stays in the level cache" : " were discarded"));
+        }
+        levelEditor->reset(sceneActive ? std::string() : LevelLoader::getLevelPath(currentLevel));
+    }
+#endif
+    
+    telemetry.recordLevelLoad(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count());
+    GAME_LOG(Info, "Entered level {} ({})", currentLevel, levelData.name);
+}
+
+void Game::reloadChangedAssets() {
+    changedAssetFiles.clear();
+    if (assetWatcher.takeChanges(changedAssetFiles) == 0) {
+        return;
+    }
+    PROFILE_ZONE("Game::reloadChangedAssets");
+    
+    bool levelChanged = false;
+    for (const auto& path : changedAssetFiles) {
+        // A file can feed several consumers (a tile is also a loose texture), so ask each
+        size_t reloaded = assets.reloadTextureFile(path);
+        reloaded += AnimationClipCache::instance().reloadFile(path);
+        reloaded += soundSystem.reloadFile(path);
+        if (renderingSystem.reloadTile(path)) {
+            reloaded++;
+        }
+        if (FileWatcher::isSameFile(path, LevelLoader::getLevelPath(currentLevel)) ||
+            FileWatcher::isSameFile(path, LevelLoader::getCookedLevelPath(currentLevel))) {
+            levelChanged = true;
+            reloaded++;
+        }
+#if GAME_EDITOR
+        // The level editor's own save: the level already holds what was written
+        if (levelEditor && FileWatcher::isSameFile(path, LevelLoader::getLevelPath(currentLevel)) &&
+            levelEditor->takeSaved()) {
+            levelChanged = false;
+        }
+#endif
+        // A parked level whose file changed is loaded afresh when next entered
+        levelCache.eraseIf([&path](int level) {
+            return FileWatcher::isSameFile(path, LevelLoader::getLevelPath(level)) ||
+                   FileWatcher::isSameFile(path, LevelLoader::getCookedLevelPath(level));
+        });
+        const int preloaded = levelPreloader.getLevel();
+        if (preloaded != 0 && (FileWatcher::isSameFile(path, LevelLoader::getLevelPath(preloaded)) ||
+                               FileWatcher::isSameFile(path, LevelLoader::getCookedLevelPath(preloaded)))) {
+            levelPreloader.cancel(); // Stale; the next update requests it again
+            reloaded++;
+        }
+        if (reloaded > 0) {
+            hotReloadCount++;
+            sceneCacheDirty = true;
+            logInfo("Hot reload: " + path);
+        }
+    }
     
-    logInfo("Returned to Snow Mountain (Level 1)");
+    if (levelChanged) {
+        loadLevel(currentLevel, LevelEntry::Reload);
+    }
+}
+
+void Game::loadLevelBackground() {
+    backgroundPlaceholder.setSize(sf::Vector2f(levelData.size.x, WINDOW_HEIGHT));
+    // Try to load the level-specific background, then its fallbacks; a
+    // preload (or an earlier visit) may already have it resident
+    const std::string backgroundKey = getLevelBackgroundKey(currentLevel);
+    assets.finishPendingLoads();
+    bool loaded = assets.hasTexture(backgroundKey);
+    if (!loaded) {
+        const std::string path = getLevelBackgroundPath(levelData);
+        std::string error;
+        if (path.empty()) {
+            logWarning("No background of level " + std::to_string(currentLevel) + " is in the asset manifest");
+        } else if (assets.tryLoadTexture(backgroundKey, path, AssetManager::TextureCategory::Background, error)) {
+            logInfo("Successfully loaded background: " + path);
+            loaded = true;
+        } else {
+            logError("Failed to load background: " + error);
+        }
+    }
+    
+    // Reload the layered background system for the new level
+    if (loaded) {
+        loadBackgroundLayers();
+        GAME_LOG(Info, "Reloaded layered backgrounds for level {}", currentLevel);
+    }
+    // If we couldn't load a background texture, use the placeholder
+    else {
+        useBackgroundPlaceholder = true;
+        backgroundPlaceholder.setFillColor(sf::Color(200, 220, 255)); // Light blue for snow theme
+    }
+    applyColorGrade();
+    renderingSystem.setLights(levelData.lights, levelData.ambientLight);
+}
+
+void Game::applyColorGrade() {
+    // Released only after the renderer has the new one (the caller waited for the render thread)
+    AssetManager::TextureRef lut;
+    if (!levelData.colorGrade.empty()) {
+        const std::string key = "grade_" + levelData.colorGrade;
+        std::string error = "not in the asset manifest";
+        if (assets.hasTexture(key) ||
+            (AssetManifest::contains(levelData.colorGrade) &&
+             assets.tryLoadTexture(key, AssetManifest::resolve(levelData.colorGrade),
+                                   AssetManager::TextureCategory::Background, error))) {
+            lut = assets.acquireTexture(assets.internTexture(key));
+            lut.get().setSmooth(true); // Red and green blend between LUT cells in the shader's lookup
+        } else {
+            logWarning("Could not load colour grade " + levelData.colorGrade + " (" + error + ")");
+        }
+    }
+    renderingSystem.setColorGrade(lut ? &lut.get() : nullptr, levelData.gradeTint, levelData.dayLength);
+    colorGradeTexture = std::move(lut);
 }
 
 void Game::updateImGui() {
+    PROFILE_ZONE("Game::updateImGui");
     try {
         // SFML 3.0 ImGui update
         sf::Time deltaTime = imguiClock.restart();
         ImGui::SFML::Update(window, deltaTime);
         
+        // Tool windows stay up on their own when the settings window is closed
+        if (showAssetManager) {
+            showAssetManagerWindow();
+        }
+        
+        if (showLevelEditor) {
+            showLevelEditorWindow();
+        }
+        
+        if (showProfiler) {
+            showProfilerWindow();
+        }
+        
+        if (showMemory) {
+            showMemoryWindow();
+        }
+        
+        if (hitchToast) {
+            showHitchToast();
+        }
+        
+#if GAME_EDITOR
+        // Show ImGui demo window if enabled
+        if (showImGuiDemo) {
+            ImGui::ShowDemoWindow(&showImGuiDemo);
+        }
+#endif
+        
+        if (!useImGuiInterface) {
+            return;
+        }
+        
         // 1. Main game settings window
         ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
         ImGui::SetNextWindowSize(ImVec2(300, 400), ImGuiCond_FirstUseEver);
@@ -1155,6 +1981,49 @@ void Game::updateImGui() {
                         renderingSystem.setShowDebugGrid(showDebugGrid);
                     }
                     
+                    ImGui::Separator();
+                    ParticleSystem& particles = renderingSystem.getParticles();
+                    bool snow = particles.isActive(snowEmitter);
+                    if (ImGui::Checkbox("Snow", &snow)) {
+                        particles.setActive(snowEmitter, snow);
+                    }
+                    ImGui::SameLine();
+                    bool gpuSnow = particles.getConfig(snowEmitter).gpuSimulated;
+                    if (ImGui::Checkbox("Simulate on GPU", &gpuSnow)) {
+                        particles.setGpuSimulated(snowEmitter, gpuSnow);
+                    }
+                    const ParticleSystem::Stats& particleStats = particles.getStats();
+                    ImGui::Text("Particles: %zu CPU + %zu GPU, %zu drawn, %zu culled",
+                               particleStats.simulated, particleStats.gpu, particleStats.drawn, particleStats.culled);
+                    ImGui::Text("Particle update: %.2f ms (%s kernel)", particleStats.updateMs,
+                               ParticleSystem::kernelName());
+                    bool shaders = renderingSystem.getUseShaders();
+                    if (ImGui::Checkbox("Shader Effects", &shaders)) {
+                        renderingSystem.setUseShaders(shaders);
+                    }
+                    if (!renderingSystem.areShadersAvailable()) {
+                        ImGui::SameLine();
+                        ImGui::TextDisabled("(unavailable, CPU fallback)");
+                    }
+                    ImGui::Text("Animated tiles: %zu (%s), colour grading: %s", renderingSystem.getAnimatedTileCount(),
+                               renderingSystem.areTilesAnimated() ? "GPU" : "still",
+                               renderingSystem.isColorGradeActive() ? "on" : "off");
+                    if (ImGui::BeginCombo("Render Scale", RENDER_SCALE_MODES[renderScaleMode].name)) {
+                        for (size_t i = 0; i < std::size(RENDER_SCALE_MODES); ++i) {
+                            if (ImGui::Selectable(RENDER_SCALE_MODES[i].name, i == renderScaleMode)) {
+                                renderScaleMode = i;
+                                renderingSystem.setSceneResolution(RENDER_SCALE_MODES[i].sceneResolution);
+                                updateBackgroundDisplaySize();
+                                sceneCacheDirty = true;
+                            }
+                        }
+                        ImGui::EndCombo();
+                    }
+                    if (renderingSystem.getSceneUpscale() > 0.f) {
+                        ImGui::SameLine();
+                        ImGui::TextDisabled("(x%.4g)", renderingSystem.getSceneUpscale());
+                    }
+                    
                     if (showDebugGrid) {
                         if (ImGui::SliderFloat("Grid Size", &gridSize, 10.0f, 200.0f, "%.0f")) {
                             renderingSystem.setGridSize(gridSize);
@@ -1207,6 +2076,36 @@ void Game::updateImGui() {
                     }
                     
                     ImGui::Separator();
+                    // Quality: a preset, or with Auto the highest level the governor may raise to
+                    if (ImGui::BeginCombo("Quality", QUALITY_PRESETS[qualityGovernor.getCeiling()].name)) {
+                        for (size_t i = 0; i < std::size(QUALITY_PRESETS); ++i) {
+                            if (ImGui::Selectable(QUALITY_PRESETS[i].name, i == qualityGovernor.getCeiling())) {
+                                qualityGovernor.setPreset(i);
+                                applyQuality(i);
+                                updateBackgroundDisplaySize();
+                            }
+                        }
+                        ImGui::EndCombo();
+                    }
+                    bool autoQuality = qualityGovernor.isEnabled();
+                    if (ImGui::Checkbox("Auto Quality", &autoQuality)) {
+                        qualityGovernor.setEnabled(autoQuality);
+                        applyQuality(qualityGovernor.getLevel());
+                        updateBackgroundDisplaySize();
+                    }
+                    if (ImGui::IsItemHovered()) {
+                        ImGui::SetTooltip("Lowers render scale, particles, parallax layers and AI detail to hold the target frame time");
+                    }
+                    if (autoQuality) {
+                        float targetFps = static_cast<float>(1000.0 / qualityGovernor.getTargetMs());
+                        if (ImGui::SliderFloat("Target FPS", &targetFps, 30.0f, 144.0f, "%.0f")) {
+                            qualityGovernor.setTargetMs(1000.0 / targetFps);
+                        }
+                        const QualityGovernor::Stats& quality = qualityGovernor.getStats();
+                        ImGui::Text("Running %s: %.2f ms (CPU %.2f, GPU %.2f), %u drops, %u raises",
+                                   QUALITY_PRESETS[qualityLevel].name, quality.smoothedMs, quality.cpuMs, quality.gpuMs,
+                                   quality.drops, quality.raises);
+                    }
                     ImGui::SliderFloat("Sprite Scale", &spriteScale, 1.0f, 8.0f);
                     
                     // Color pickers
@@ -1221,45 +2120,251 @@ void Game::updateImGui() {
                         platformColor.b = static_cast<uint8_t>(platformColorArr[2] * 255);
                     }
                     
-                    // Background layers section
+                    // Background layers section
+                    ImGui::Separator();
+                    ImGui::Text("Background Layers");
+                    
+                    // Show background layer status
+                    ImGui::Text("Background: %s", useBackgroundPlaceholder ? "Using placeholder" : "Using layers");
+                    ImGui::Text("Loaded layers: %zu", backgroundLayers.size());
+                    
+                    // Layer information
+                    for (size_t i = 0; i < backgroundLayers.size(); i++) {
+                        const auto& layer = backgroundLayers[i];
+                        ImGui::Text("%s: %s (speed: %.1f)", 
+                                   layer.name.c_str(), 
+                                   layer.isLoaded ? "Loaded" : "Missing",
+                                   layer.parallaxSpeed);
+                        
+                        // Show layer controls if loaded
+                        if (layer.isLoaded) {
+                            ImGui::SameLine();
+                            std::string buttonLabel = "Reload##" + layer.name;
+                            if (ImGui::SmallButton(buttonLabel.c_str())) {
+                                // Reload just this layer
+                                loadBackgroundLayers(true);
+                            }
+                        }
+                    }
+                    
+                    // Reload all layers button
+                    if (ImGui::Button("Reload All Background Layers")) {
+                        loadBackgroundLayers(true);
+                    }
+                    
+                    ImGui::EndTabItem();
+                }
+                
+                // Gameplay tab
+                if (ImGui::BeginTabItem("Gameplay")) {
+                    ImGui::SliderFloat("Game Speed", &gameSpeed, 0.1f, 2.0f);
+                    
+                    // Simulation runs at a fixed rate; rendering can be capped independently
+                    float stepRate = 1.0f / fixedTimeStep;
+                    if (ImGui::SliderFloat("Simulation Rate (Hz)", &stepRate, 30.0f, 240.0f, "%.0f")) {
+                        fixedTimeStep = 1.0f / stepRate;
+                    }
+                    ImGui::SliderInt("Max Substeps", &maxSubSteps, 1, 10);
+                    
+                    // Frame pacing: how the loop waits out each frame, and the dt the steps see
+                    int pacingMode = static_cast<int>(framePacer.getMode());
+                    const char* pacingModes[] = {FramePacer::modeName(FramePacer::Mode::VSync),
+                                                 FramePacer::modeName(FramePacer::Mode::Limiter),
+                                                 FramePacer::modeName(FramePacer::Mode::Uncapped),
+                                                 FramePacer::modeName(FramePacer::Mode::Adaptive)};
+                    if (ImGui::Combo("Frame Pacing", &pacingMode, pacingModes, IM_ARRAYSIZE(pacingModes))) {
+                        framePacer.setMode(static_cast<FramePacer::Mode>(pacingMode));
+                        applyFramePacing();
+                    }
+                    if (ImGui::IsItemHovered()) {
+                        ImGui::SetTooltip("Adaptive limits like Limiter, dropping to half rate while frames overrun");
+                    }
+                    int targetFps = static_cast<int>(framePacer.getTargetFps());
+                    if (ImGui::SliderInt("Target FPS", &targetFps, 20, 240)) {
+                        framePacer.setTargetFps(static_cast<unsigned>(targetFps));
+                    }
+                    bool smoothDt = framePacer.isSmoothing();
+                    if (ImGui::Checkbox("Smooth Frame Time", &smoothDt)) {
+                        framePacer.setSmoothing(smoothDt);
+                    }
+                    const FramePacer::Stats pacing = framePacer.getStats();
+                    if (framePacer.getCurrentFps() > 0) {
+                        ImGui::Text("Pacing at %u fps%s, work %.2f ms", framePacer.getCurrentFps(),
+                                   pacing.throttled ? " (unfocused)" : pacing.reduced ? " (reduced)" : "", pacing.workMs);
+                    } else {
+                        ImGui::Text("Not limited by the game, work %.2f ms", pacing.workMs);
+                    }
+                    ImGui::Text("Substeps last frame: %d, alpha: %.2f", lastSubStepCount, interpolationAlpha);
+
+                    // Power modes while the window is unfocused or minimized
+                    int background = static_cast<int>(backgroundSim);
+                    const char* backgroundModes[] = {"Keep Running", "Pause"};
+                    if (ImGui::Combo("When Unfocused", &background, backgroundModes, IM_ARRAYSIZE(backgroundModes))) {
+                        backgroundSim = static_cast<BackgroundSim>(background);
+                        applyBackgroundMode();
+                    }
+                    if (ImGui::IsItemHovered()) {
+                        ImGui::SetTooltip("Netplay keeps running either way");
+                    }
+                    if (ImGui::SliderInt("Unfocused FPS", &backgroundFps, 0, 60, backgroundFps == 0 ? "Uncapped" : "%d")) {
+                        applyBackgroundMode();
+                    }
+                    ImGui::Checkbox("Skip Drawing While Minimized", &skipDrawWhenMinimized);
+                    ImGui::Checkbox("Sleep While Paused", &sleepWhenPaused);
+                    if (ImGui::IsItemHovered()) {
+                        ImGui::SetTooltip("Block on window events instead of polling while paused in the background");
+                    }
+
+                    // Draw and present on a second thread, overlapped with the next steps
+                    if (ImGui::Checkbox("Render Thread", &useRenderThread)) {
+                        if (useRenderThread) {
+                            useRenderThread = renderThread.start(window);
+                        } else {
+                            renderThread.stop();
+                        }
+                    }
+                    bool split = splitScreen;
+                    if (ImGui::Checkbox("Split Screen (F7)", &split)) {
+                        setSplitScreen(split);
+                    }
+                    if (ImGui::IsItemHovered()) {
+                        ImGui::SetTooltip("Second half follows a partner camera (A/D or a second gamepad)");
+                    }
+                    
+                    // Set here, after the wait for the frame in flight, so a replay never sees it change
+                    bool imguiBuffers = ImGui::SFML::GetRenderer() == ImGui::SFML::Renderer::BufferObjects;
+                    if (ImGui::Checkbox("ImGui Buffer Objects", &imguiBuffers)) {
+                        ImGui::SFML::SetRenderer(imguiBuffers ? ImGui::SFML::Renderer::BufferObjects
+                                                              : ImGui::SFML::Renderer::Legacy);
+                    }
+                    if (ImGui::IsItemHovered()) {
+                        ImGui::SetTooltip("Streams ImGui's vertices through VBO/IBO with a shader instead of client arrays");
+                    }
+                    if (renderThread.isRunning()) {
+                        ImGui::Text("Render: %.2f ms, game thread waited %.2f ms", renderThreadStats.renderMs,
+                                   renderThreadStats.waitMs);
+                    }
+                    ImGui::SliderFloat("Player Speed", &playerSpeed, 50.0f, 400.0f);
+                    
+                    // Controls: event-fed per step, optionally re-sampled just before each step
                     ImGui::Separator();
-                    ImGui::Text("Background Layers");
-                    
-                    // Show background layer status
-                    ImGui::Text("Background: %s", useBackgroundPlaceholder ? "Using placeholder" : "Using layers");
-                    ImGui::Text("Loaded layers: %zu", backgroundLayers.size());
+                    ImGui::Text("Input");
+                    bool lateLatch = inputSystem.isLateLatch();
+                    if (ImGui::Checkbox("Late Latch", &lateLatch)) {
+                        inputSystem.setLateLatch(lateLatch);
+                    }
+                    if (ImGui::IsItemHovered()) {
+                        ImGui::SetTooltip("Sample the keyboard right before each simulation step");
+                    }
+                    const InputSystem::Stats inputStats = inputSystem.takeStats();
+                    ImGui::Text("Key events: %zu, latency %.2f ms mean / %.2f ms max", inputStats.events,
+                               inputStats.meanLatencyMs, inputStats.maxLatencyMs);
+                    if (!inputSystem.isRecording()) {
+                        if (ImGui::Button("Record Input")) {
+                            inputSystem.startRecording();
+                        }
+                    } else if (ImGui::Button("Stop and Save")) {
+                        inputSystem.stopRecording();
+                        std::string error;
+                        if (inputSystem.saveRecording(inputRecordingPath, error)) {
+                            logInfo("Saved " + std::to_string(inputSystem.getRecordedTicks()) + " ticks of input to " +
+                                    inputRecordingPath + " (replay with game_bench --script)");
+                        } else {
+                            logError("Failed to save input recording: " + error);
+                        }
+                    }
+                    ImGui::SameLine();
+                    ImGui::Text("%zu ticks", inputSystem.getRecordedTicks());
                     
-                    // Layer information
-                    for (size_t i = 0; i < backgroundLayers.size(); i++) {
-                        const auto& layer = backgroundLayers[i];
-                        ImGui::Text("%s: %s (speed: %.1f)", 
-                                   layer.name.c_str(), 
-                                   layer.isLoaded ? "Loaded" : "Missing",
-                                   layer.parallaxSpeed);
-                        
-                        // Show layer controls if loaded
-                        if (layer.isLoaded) {
-                            ImGui::SameLine();
-                            std::string buttonLabel = "Reload##" + layer.name;
-                            if (ImGui::SmallButton(buttonLabel.c_str())) {
-                                // Reload just this layer
-                                loadBackgroundLayers();
-                            }
+                    // Whole sessions (level, tile seed, steps per frame) for exact playback
+                    if (replayMode == ReplayMode::Off) {
+                        if (ImGui::Button("Record Replay")) {
+                            startReplayRecording();
+                        }
+                        ImGui::SameLine();
+                        if (ImGui::Button("Play Replay")) {
+                            playReplay(replayPath);
+                        }
+                    } else if (replayMode == ReplayMode::Recording) {
+                        if (ImGui::Button("Stop and Save Replay")) {
+                            stopReplayRecording();
+                        }
+                        ImGui::SameLine();
+                        ImGui::Text("%zu frames", replay.getFrameCount());
+                    } else {
+                        if (ImGui::Button("Stop Replay")) {
+                            stopReplayPlayback();
                         }
+                        ImGui::SameLine();
+                        ImGui::Text("Frame %zu / %zu", replay.getFrameCursor(), replay.getFrameCount());
                     }
+                    ImGui::Text("Replay file: %s", replayPath.c_str());
                     
-                    // Reload all layers button
-                    if (ImGui::Button("Reload All Background Layers")) {
-                        loadBackgroundLayers();
+                    if (ImGui::Button("Save State (F6)")) {
+                        saveSimState();
+                    }
+                    ImGui::SameLine();
+                    ImGui::BeginDisabled(quickSave.empty());
+                    if (ImGui::Button("Restore State (F9)")) {
+                        restoreSimState();
+                    }
+                    ImGui::EndDisabled();
+                    if (!quickSave.empty()) {
+                        ImGui::Text("Save state: %.1f KB, saved in %.3f ms, restored in %.3f ms",
+                                    quickSave.size() / 1024.0, quickSaveMs, quickRestoreMs);
                     }
                     
-                    ImGui::EndTabItem();
-                }
-                
-                // Gameplay tab
-                if (ImGui::BeginTabItem("Gameplay")) {
-                    ImGui::SliderFloat("Game Speed", &gameSpeed, 0.1f, 2.0f);
-                    ImGui::SliderFloat("Player Speed", &playerSpeed, 50.0f, 400.0f);
+                    // Rollback netplay: both peers' buttons drive the player
+                    const NetTransport::State netState = netTransport.getState();
+                    if (netState == NetTransport::State::Closed) {
+                        ImGui::SetNextItemWidth(140.0f);
+                        ImGui::InputText("Address", netplayAddress, sizeof(netplayAddress));
+                        ImGui::SameLine();
+                        ImGui::SetNextItemWidth(100.0f);
+                        ImGui::InputInt("Port", &netplayPort);
+                        netplayPort = std::clamp(netplayPort, 1024, 65535);
+                        ImGui::SetNextItemWidth(140.0f);
+                        ImGui::SliderInt("Input Delay", &netplayInputDelay, 0,
+                                         static_cast<int>(RollbackSession::MAX_INPUT_DELAY), "%d ticks");
+                        if (ImGui::Button("Host Netplay")) {
+                            hostNetplay(static_cast<unsigned short>(netplayPort));
+                        }
+                        ImGui::SameLine();
+                        if (ImGui::Button("Join Netplay")) {
+                            joinNetplay(netplayAddress, static_cast<unsigned short>(netplayPort));
+                        }
+                    } else {
+                        if (ImGui::Button("Leave Netplay")) {
+                            stopNetplay();
+                        }
+                        ImGui::SameLine();
+                        if (netState == NetTransport::State::Hosting) {
+                            ImGui::Text("Waiting for a peer on port %d", netplayPort);
+                        } else if (netState == NetTransport::State::Joining) {
+                            ImGui::Text("Joining %s:%d", netplayAddress, netplayPort);
+                        } else {
+                            ImGui::Text("Playing with %s", netTransport.getPeerName().c_str());
+                        }
+                    }
+                    if (netplay.isActive()) {
+                        const RollbackSession::Stats& net = netplay.getStats();
+                        ImGui::Text("Tick %u, peer confirmed to %u (%d ahead), window %u ticks",
+                                    net.tick, net.remoteConfirmed,
+                                    static_cast<int>(net.tick) - static_cast<int>(net.remoteConfirmed), net.window);
+                        ImGui::Text("Rollbacks: %llu (%llu ticks run again, %llu mispredicted inputs)",
+                                    static_cast<unsigned long long>(net.rollbacks),
+                                    static_cast<unsigned long long>(net.resimulatedTicks),
+                                    static_cast<unsigned long long>(net.mispredictions));
+                        ImGui::Text("Last: %u ticks in %.2f ms, max %.2f ms, %.3f ms/tick (budget %.0f ms)",
+                                    net.lastRollbackTicks, net.lastRollbackMs, net.maxRollbackMs, net.tickCostMs,
+                                    RollbackSession::BUDGET_MS);
+                        ImGui::Text("Allocations while re-simulating: %llu", static_cast<unsigned long long>(net.resimAllocations));
+                        ImGui::Text("Stalled frames: %llu, lost history: %llu, packets %llu out / %llu in (last %zu B)",
+                                    static_cast<unsigned long long>(net.stalledFrames),
+                                    static_cast<unsigned long long>(net.lostHistory),
+                                    static_cast<unsigned long long>(net.packetsSent),
+                                    static_cast<unsigned long long>(net.packetsReceived), net.lastPacketBytes);
+                    }
                     
                     ImGui::Separator();
                     ImGui::Text("Testing Controls");
@@ -1268,15 +2373,108 @@ void Game::updateImGui() {
                         ImGui::SetTooltip("Toggle enemy visibility for easier testing");
                     }
                     
+                    // NPC AI scheduler: budget, LOD distances and last frame's work
+                    if (npcManager) {
+                        ImGui::Separator();
+                        ImGui::Text("NPC AI");
+                        AIScheduler::Settings& ai = npcManager->getAIScheduler().getSettings();
+                        int budget = static_cast<int>(ai.thinkBudget);
+                        if (ImGui::SliderInt("Decisions per Step", &budget, 1, 1024)) {
+                            ai.thinkBudget = static_cast<size_t>(budget);
+                        }
+                        ImGui::SliderFloat("Near Distance", &ai.nearDistance, 100.0f, 4000.0f, "%.0f");
+                        ImGui::SliderFloat("Far Distance", &ai.farDistance, ai.nearDistance, 8000.0f, "%.0f");
+                        ImGui::SliderFloat("Mid Interval (s)", &ai.midInterval, 0.0f, 2.0f, "%.2f");
+                        ImGui::SliderFloat("Far Interval (s)", &ai.farInterval, 0.0f, 5.0f, "%.2f");
+                        ImGui::Text("Agents: %zu near, %zu mid, %zu far", aiFrameStats.nearAgents,
+                                   aiFrameStats.midAgents, aiFrameStats.farAgents);
+                        ImGui::Text("Decisions last frame: %zu (%zu deferred), %.3f ms", aiFrameStats.thinks,
+                                   aiFrameStats.deferred, aiFrameStats.thinkNs / 1e6);
+                    }
+                    
+                    // Navigation graph and path requests
+                    ImGui::Separator();
+                    ImGui::Text("Navigation");
+                    ImGui::Checkbox("Show Navigation Graph", &showNavGraph);
+                    const NavGraph::Stats& navStats = navGraph.getStats();
+                    ImGui::Text("Graph: %zu nodes, %zu walk / %zu jump / %zu fall edges, built in %.2f ms",
+                               navStats.nodes, navStats.walkEdges, navStats.jumpEdges, navStats.fallEdges,
+                               navStats.buildMs);
+                    const NavPathfinder::Stats& pathStats = pathfinder.getStats();
+                    ImGui::Text("Paths: %zu requested, %zu pending, %zu searched, %zu cached",
+                               pathStats.requests, pathStats.pending, pathStats.solved, pathStats.cacheHits);
+                    ImGui::Text("Expansions last frame: %zu of %zu (peak %zu)", pathStats.expansions,
+                               NAV_EXPANSIONS_PER_FRAME, pathStats.maxExpansions);
+                    
                     ImGui::Separator();
                     ImGui::Text("Level Control");
                     
                     // Current level display
-                    ImGui::Text("Current Level: %d", currentLevel);
+                    ImGui::Text("Current Level: %d (%s)", currentLevel, levelData.name.c_str());
+                    ImGui::Text("Level data: %zu platforms, %zu ladders, %zu enemies, %zu NPCs",
+                               levelData.platforms.size(), levelData.ladders.size(),
+                               levelData.enemies.size(), levelData.npcs.size());
+                    const LevelStreamer::Stats streaming = levelStreamer.getStats();
+                    ImGui::Text("Sectors: %zu/%zu active, %zu loading (%.0f-%.0f px), %zu loads, %zu evictions",
+                               streaming.activeSectors, streaming.sectorCount, streaming.pendingSectors,
+                               streaming.activeLeft, streaming.activeRight, streaming.loads, streaming.evictions);
+                    ImGui::Text("Resident: %zu platforms, %zu ladders, %zu enemies",
+                               platforms.size(), ladders.size(), enemies.size());
+                    const LevelCache::Stats cacheStats = levelCache.getStats();
+                    ImGui::Text("Level cache: %zu/%zu levels, %.1f/%.1f MB pinned, %zu hits, %zu misses, %zu evictions",
+                               cacheStats.levels, LevelCache::MAX_LEVELS, cacheStats.textureBytes / (1024.0 * 1024.0),
+                               levelCache.getBudget() / (1024.0 * 1024.0), cacheStats.hits, cacheStats.misses,
+                               cacheStats.evictions);
+                    const ParticleSystem& particlePool = renderingSystem.getParticles();
+                    size_t particleBudget = 0;
+                    for (ParticleSystem::EmitterId id = 0; id < particlePool.getEmitterCount(); ++id) {
+                        particleBudget += particlePool.getConfig(id).budget;
+                    }
+                    ImGui::Text("Pools: %zu/%zu enemies, %zu/%zu particles (live/capacity)", enemies.size(),
+                               enemies.capacity(), particlePool.getStats().simulated, particleBudget);
+                    if (npcManager) {
+                        const NPC::PoolStats npcPool = npcManager->getPoolStats();
+                        ImGui::Text("NPC pool: %zu/%zu NPCs (%zu ids, peak %zu), %zu/%zu messages",
+                                   npcPool.handles.live, npcPool.npcCapacity, npcPool.handles.capacity,
+                                   npcPool.handles.peak, npcPool.messages, npcPool.messageCapacity);
+                    }
+                    ImGui::Text("Events: %zu last frame; %llu jumps, %llu landings, %llu hits, %llu deaths",
+                               gameEvents.getLastFrameCount(),
+                               static_cast<unsigned long long>(gameEvents.getTotal(GameEventType::Jumped)),
+                               static_cast<unsigned long long>(gameEvents.getTotal(GameEventType::Landed)),
+                               static_cast<unsigned long long>(gameEvents.getTotal(GameEventType::PlayerHit)),
+                               static_cast<unsigned long long>(gameEvents.getTotal(GameEventType::PlayerDied)));
+                    // Shots: the last step's outcomes, and every strike so far
+                    const ProjectileSystem::Stats& shots = projectiles.getStats();
+                    ImGui::Text("Projectiles: %zu/%zu live, %zu hits, %zu blocked, %zu expired, %zu boxes swept",
+                               projectiles.size(), projectiles.capacity(), shots.hits, shots.blocked, shots.expired,
+                               shots.candidates);
+                    ImGui::Text("Struck: %llu enemies, %llu player",
+                               static_cast<unsigned long long>(gameEvents.getTotal(GameEventType::EnemyStruck)),
+                               static_cast<unsigned long long>(gameEvents.getTotal(GameEventType::PlayerStruck)));
+                    if (ImGui::Button("Fire Test Volley")) {
+                        fireTestVolley();
+                    }
+                    if (ImGui::IsItemHovered()) {
+                        ImGui::SetTooltip("A fan of shots from the player; not recorded by replays or sent to a peer");
+                    }
+                    const TimerWheel::Stats& timerStats = gameTimers.getStats();
+                    ImGui::Text("Timers: %zu pending (peak %zu), tick %llu", timerStats.pending, timerStats.peak,
+                               static_cast<unsigned long long>(gameTimers.now()));
+                    if (npcManager) {
+                        const TimerWheel::Stats& npcTimers = npcManager->getTimerStats();
+                        const NPC::ScriptStats scripts = npcManager->getScriptStats();
+                        ImGui::Text("NPC timers: %zu pending (peak %zu)", npcTimers.pending, npcTimers.peak);
+                        ImGui::Text("NPC scripts: %zu running of %zu defined, %zu on timers, %zu on the player",
+                                   scripts.running, scripts.defined, scripts.waitingOnTimer, scripts.waitingOnPlayer);
+                    }
+                    ImGui::Text("Loaded from: %s", sceneActive ? "(generated scene)"
+                                                   : levelData.source.empty() ? "(built-in fallback)"
+                                                   : levelData.source.c_str());
                     
                     // Level selection
                     static int selectedLevel = currentLevel;
-                    if (ImGui::SliderInt("Select Level", &selectedLevel, 1, 2)) {
+                    if (ImGui::SliderInt("Select Level", &selectedLevel, 1, levelCount)) {
                         // Level will be changed when "Jump to Level" button is pressed
                     }
                     
@@ -1314,6 +2512,48 @@ void Game::updateImGui() {
                         resetGame();
                     }
                     
+                    // Seeded stress scenes for scaling tests (SceneGenerator)
+                    if (ImGui::CollapsingHeader("Generated Scene")) {
+                        for (size_t i = 0; i < SceneGenerator::getPresetCount(); ++i) {
+                            const SceneGenerator::Preset& preset = SceneGenerator::getPreset(i);
+                            if (i > 0) {
+                                ImGui::SameLine();
+                            }
+                            if (ImGui::Button(preset.name)) {
+                                const uint32_t seed = sceneConfig.seed;
+                                sceneConfig = preset.config;
+                                sceneConfig.seed = seed;
+                            }
+                        }
+                        ImGui::InputScalar("Seed", ImGuiDataType_U32, &sceneConfig.seed);
+                        auto editCount = [](const char* label, size_t& count) {
+                            int value = static_cast<int>(std::min<size_t>(count, 1000000));
+                            if (ImGui::InputInt(label, &value, 100, 1000)) {
+                                count = static_cast<size_t>(std::min(std::max(value, 0), 1000000));
+                            }
+                        };
+                        editCount("Platforms", sceneConfig.platforms);
+                        editCount("Ladders", sceneConfig.ladders);
+                        editCount("Enemies", sceneConfig.enemies);
+                        editCount("NPCs", sceneConfig.npcs);
+                        editCount("Decorations", sceneConfig.decorations);
+                        editCount("Particles", sceneConfig.particles);
+                        ImGui::SliderFloat("Density", &sceneConfig.density, 1.0f, 200.0f, "%.1f / 1000 px",
+                                           ImGuiSliderFlags_Logarithmic);
+                        ImGui::InputFloat("Width (0 = from density)", &sceneConfig.width, 1000.0f, 10000.0f, "%.0f");
+                        sceneConfig.width = std::max(sceneConfig.width, 0.0f);
+                        ImGui::Text("Level width: %.0f px", SceneGenerator::getLevelWidth(sceneConfig));
+                        if (ImGui::Button("Generate")) {
+                            loadGeneratedScene();
+                        }
+                        if (sceneActive) {
+                            ImGui::SameLine();
+                            if (ImGui::Button("Back to Level")) {
+                                jumpToLevel(currentLevel);
+                            }
+                        }
+                    }
+                    
                     ImGui::EndTabItem();
                 }
                 
@@ -1430,16 +2670,275 @@ void Game::updateImGui() {
                     if (ImGui::SliderFloat("Jump Force", &jumpForce, 100.0f, 1000.0f, "%.1f")) {
                         physicsSystem.setJumpForce(jumpForce);
                     }
+                    bool specializedStep = physicsSystem.isStepSpecialization();
+                    if (ImGui::Checkbox("Specialized Step", &specializedStep)) {
+                        physicsSystem.setStepSpecialization(specializedStep);
+                    }
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("(%s)", physicsSystem.getStepName());
+
+                    ImGui::Separator();
+                    ImGui::Spacing();
+
+                    // Broadphase statistics
+                    ImGui::Text("Broadphase:");
+                    const SpatialGrid& grid = physicsSystem.getPlatformGrid();
+                    const BroadphaseStats& stats = physicsSystem.getBroadphaseStats();
+                    size_t platformCount = physicsSystem.getPlatformPhysicsCount();
+                    float cellSize = physicsSystem.getBroadphaseCellSize();
+                    if (ImGui::SliderFloat("Cell Size", &cellSize, 16.0f, 1024.0f, "%.0f")) {
+                        physicsSystem.setBroadphaseCellSize(cellSize);
+                    }
+                    ImGui::Text("Grid: %d x %d cells, %zu platforms", grid.getColumns(), grid.getRows(), platformCount);
+                    ImGui::Text("Queries per frame: %zu", stats.queries);
+                    ImGui::Text("Candidates per frame: %zu (brute force: %zu)", stats.candidates, stats.queries * platformCount);
+                    ImGui::Text("Avg candidates per query: %.2f",
+                               stats.queries > 0 ? static_cast<float>(stats.candidates) / stats.queries : 0.0f);
+                    ImGui::Text("Last query candidates: %zu", stats.lastQueryCandidates);
+                    ImGui::Text("Filtered by collision layer: %zu", stats.filtered);
+                    ImGui::Text("Ground checks from cached supports: %zu (lost or moving: %zu)",
+                               stats.supportHits, stats.supportMisses);
+                    const TileMap& tiles = physicsSystem.getTileMap();
+                    if (tiles.isEnabled()) {
+                        ImGui::Text("Tile layer: %d x %d cells of %.0f px, %zu platforms on it, %zu loose",
+                                   tiles.getColumns(), tiles.getRows(), tiles.getTileSize(),
+                                   platformCount - physicsSystem.getLoosePlatformCount(),
+                                   physicsSystem.getLoosePlatformCount());
+                    } else {
+                        ImGui::Text("Tile layer: off");
+                    }
+
+                    ImGui::Spacing();
+                    ImGui::Text("Entity broadphase (sort and sweep):");
+                    const SweepAndPrune::Stats& entityStats = entityBroadphase.getStats();
+                    ImGui::Text("Proxies: %zu, pairs: %zu, filtered by layer: %zu", entityStats.proxies,
+                               entityStats.pairs, entityStats.filtered);
+                    ImGui::Text("Sort shifts: %zu, pair tests: %zu (brute force: %zu)", entityStats.shifts, entityStats.tests,
+                               entityStats.proxies * (entityStats.proxies > 0 ? entityStats.proxies - 1 : 0) / 2);
+
+                    ImGui::Separator();
+                    ImGui::Spacing();
+
+                    // Body sleeping
+                    bool sleeping = physicsSystem.isSleepingEnabled();
+                    if (ImGui::Checkbox("Body Sleeping", &sleeping)) {
+                        physicsSystem.setSleepingEnabled(sleeping);
+                    }
+                    float activationRadius = physicsSystem.getActivationRadius();
+                    if (ImGui::SliderFloat("Activation Radius", &activationRadius, 100.0f, 4000.0f, "%.0f")) {
+                        physicsSystem.setActivationRadius(activationRadius);
+                    }
+                    const SleepStats& sleepStats = physicsSystem.getSleepStats();
+                    ImGui::Text("Enemies: %zu awake, %zu asleep", sleepStats.awakeEnemies, sleepStats.sleepingEnemies);
+                    ImGui::Text("NPCs: %zu awake, %zu asleep", sleepStats.awakeNPCs, sleepStats.sleepingNPCs);
+                    if (ImGui::Button("Wake All")) {
+                        physicsSystem.wakeAll();
+                    }
+
+                    // Simulation region: enemies beyond it patrol analytically (0 = off)
+                    float regionRadius = physicsSystem.getRegionRadius();
+                    if (ImGui::SliderFloat("Simulation Region", &regionRadius, 0.0f, 8000.0f, "%.0f")) {
+                        physicsSystem.setRegionRadius(regionRadius);
+                    }
+                    ImGui::Text("Enemies outside it (coarse): %zu", sleepStats.coarseEnemies);
+
+                    ImGui::EndTabItem();
+                }
+                
+                // Render tab: draw submission counters per category, with history
+                if (ImGui::BeginTabItem("Render")) {
+                    const RenderStats& renderStats = renderingSystem.getRenderStats();
+                    const size_t frames = renderStats.getFrameCount();
+                    if (frames == 0) {
+                        ImGui::Text("No frames recorded yet");
+                    } else {
+                        // Total draw calls over the recorded frames, oldest first
+                        renderStatsDrawCalls.resize(frames);
+                        for (size_t i = 0; i < frames; ++i) {
+                            renderStatsDrawCalls[i] = static_cast<float>(renderStats.getFrame(frames - 1 - i).getTotal().drawCalls);
+                        }
+                        ImGui::PlotLines("Draw Calls", renderStatsDrawCalls.data(), static_cast<int>(frames), 0,
+                                         nullptr, 0.0f, FLT_MAX, ImVec2(0, 60));
+                        renderStatsFrameAge = std::min(renderStatsFrameAge, static_cast<int>(frames) - 1);
+                        ImGui::SliderInt("Frames Ago", &renderStatsFrameAge, 0, static_cast<int>(frames) - 1);
+                        
+                        const RenderStats::Frame& frame = renderStats.getFrame(static_cast<size_t>(renderStatsFrameAge));
+                        const ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp;
+                        if (ImGui::BeginTable("RenderStatsTable", 7, flags)) {
+                            ImGui::TableSetupColumn("Category");
+                            ImGui::TableSetupColumn("Draws");
+                            ImGui::TableSetupColumn("Vertices");
+                            ImGui::TableSetupColumn("Tex Changes");
+                            ImGui::TableSetupColumn("Culled");
+                            ImGui::TableSetupColumn("Avg Draws");
+                            ImGui::TableSetupColumn("Peak Draws");
+                            ImGui::TableHeadersRow();
+                            
+                            // Averages and peaks cover the whole history, not just the selected frame
+                            auto row = [&](const char* name, const RenderStats::Counters& counters, auto&& drawsOf) {
+                                size_t peak = 0;
+                                double sum = 0.0;
+                                for (size_t age = 0; age < frames; ++age) {
+                                    const size_t draws = drawsOf(renderStats.getFrame(age));
+                                    peak = std::max(peak, draws);
+                                    sum += draws;
+                                }
+                                ImGui::TableNextRow();
+                                ImGui::TableNextColumn(); ImGui::TextUnformatted(name);
+                                ImGui::TableNextColumn(); ImGui::Text("%zu", counters.drawCalls);
+                                ImGui::TableNextColumn(); ImGui::Text("%zu", counters.vertices);
+                                ImGui::TableNextColumn(); ImGui::Text("%zu", counters.textureChanges);
+                                ImGui::TableNextColumn(); ImGui::Text("%zu", counters.culled);
+                                ImGui::TableNextColumn(); ImGui::Text("%.1f", sum / frames);
+                                ImGui::TableNextColumn(); ImGui::Text("%zu", peak);
+                            };
+                            for (size_t c = 0; c < RenderStats::CATEGORY_COUNT; ++c) {
+                                const RenderCategory category = static_cast<RenderCategory>(c);
+                                row(getRenderCategoryName(category), frame[category],
+                                    [category](const RenderStats::Frame& f) { return f[category].drawCalls; });
+                            }
+                            row("Total", frame.getTotal(),
+                                [](const RenderStats::Frame& f) { return f.getTotal().drawCalls; });
+                            ImGui::EndTable();
+                        }
+                        ImGui::TextDisabled("ImGui's own draws are not included");
+                        const DebugDraw::Stats& debugDrawStats = renderingSystem.getDebugDraw().getLastFlushStats();
+                        ImGui::Text("Debug draw: %zu primitives, %zu vertices in one call",
+                                    debugDrawStats.primitives, debugDrawStats.vertices);
+                        if (npcManager) {
+                            const MessageBubbleCache::Stats& bubbleStats = npcManager->getBubbleStats();
+                            ImGui::Text("Message bubbles: %zu layouts cached, %zu hits, %zu built, %zu evicted",
+                                        bubbleStats.entries, bubbleStats.hits, bubbleStats.misses, bubbleStats.evictions);
+                        }
+                    }
                     
                     ImGui::EndTabItem();
                 }
                 
                 // Debug tab
                 if (ImGui::BeginTabItem("Debug")) {
+#if GAME_EDITOR
                     ImGui::Checkbox("Show ImGui Demo", &showImGuiDemo);
+#endif
+                    ImGui::Checkbox("Show Profiler (F2)", &showProfiler);
+                    ImGui::Checkbox("Show Memory", &showMemory);
+                    bool frameLogging = renderingSystem.isFrameLoggingEnabled();
+                    if (ImGui::Checkbox("Per-Frame Render Log", &frameLogging)) {
+                        renderingSystem.setFrameLoggingEnabled(frameLogging);
+                    }
+#if GAME_PROFILER
+                    if (!Profiler::isCapturing()) {
+                        if (ImGui::Button("Start Trace Capture (F5)")) {
+                            startProfilerCapture();
+                        }
+                        ImGui::SameLine();
+                        ImGui::SetNextItemWidth(120.0f);
+                        ImGui::SliderFloat("Seconds##capture", &captureSeconds, 1.0f, 30.0f, "%.0f");
+                    } else {
+                        const Profiler::CaptureStats capture = Profiler::getCaptureStats();
+                        if (ImGui::Button("Stop Trace Capture (F5)")) {
+                            stopProfilerCapture();
+                        }
+                        ImGui::SameLine();
+                        ImGui::Text("%.1f / %.0f s, %zu zones", capture.seconds, captureSeconds, capture.zones);
+                    }
+                    if (!lastCapturePath.empty()) {
+                        ImGui::Text("Last capture: %s", lastCapturePath.c_str());
+                    }
+#endif
+                    
+                    // Screenshots and recordings (PBO readback, encoded off the render thread)
+                    if (ImGui::Button("Screenshot (F12)")) {
+                        takeScreenshot();
+                    }
+                    ImGui::SameLine();
+                    if (ImGui::Button(frameCapture.isRecording() ? "Stop Recording (Shift+F12)"
+                                                                 : "Start Recording (Shift+F12)")) {
+                        toggleRecording();
+                    }
+#if GAME_PROFILER
+                    ImGui::Checkbox("Profiler trace with screenshots", &screenshotTrace);
+                    if (screenshotTrace) {
+                        ImGui::SameLine();
+                        ImGui::SetNextItemWidth(120.0f);
+                        ImGui::SliderInt("Frames##screenshotTrace", &screenshotTraceFrames, 1,
+                                         static_cast<int>(Profiler::FRAME_HISTORY));
+                    }
+                    // Traces of the frames around any that took far over budget, written as they happen
+                    bool detectHitches = hitchDetector.isEnabled();
+                    if (ImGui::Checkbox("Hitch traces", &detectHitches)) {
+                        hitchDetector.setEnabled(detectHitches);
+                    }
+                    if (detectHitches) {
+                        ImGui::SameLine();
+                        ImGui::SetNextItemWidth(120.0f);
+                        float hitchFactor = static_cast<float>(hitchDetector.getFactor());
+                        if (ImGui::SliderFloat("x budget##hitch", &hitchFactor, 1.5f, 8.0f, "%.1f")) {
+                            hitchDetector.setFactor(hitchFactor);
+                        }
+                        const HitchDetector::Stats hitchStats = hitchDetector.getStats();
+                        ImGui::Text("Hitches: %llu, %llu traces written, %llu skipped",
+                                    static_cast<unsigned long long>(hitchStats.hitches),
+                                    static_cast<unsigned long long>(hitchStats.written),
+                                    static_cast<unsigned long long>(hitchStats.skipped));
+                        if (hitchStats.failed > 0) {
+                            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%llu hitch traces failed",
+                                               static_cast<unsigned long long>(hitchStats.failed));
+                        }
+                    }
+#endif
+                    {
+                        const FrameCapture::Stats captureStats = frameCapture.getStats();
+                        ImGui::Text("Captures: %llu screenshots, %llu frames recorded, %llu dropped, %zu queued",
+                                    static_cast<unsigned long long>(captureStats.screenshots),
+                                    static_cast<unsigned long long>(captureStats.recordedFrames),
+                                    static_cast<unsigned long long>(captureStats.droppedFrames), captureStats.queued);
+                        if (captureStats.failedWrites > 0) {
+                            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%llu capture writes failed",
+                                               static_cast<unsigned long long>(captureStats.failedWrites));
+                        }
+                        const std::string lastShot = frameCapture.getLastPath();
+                        if (!lastShot.empty()) {
+                            ImGui::Text("Last written: %s", lastShot.c_str());
+                        }
+                    }
                     
                     ImGui::Text("FPS: %.1f", currentFPS);
+                    if (startupProfile.hasFirstFrame() && ImGui::TreeNode("Startup", "Startup: %.0f ms to first frame",
+                                                                          startupProfile.getFirstFrameMs())) {
+                        for (const std::string& line : startupProfile.formatLines()) {
+                            ImGui::TextUnformatted(line.c_str());
+                        }
+                        ImGui::TreePop();
+                    }
                     ImGui::Text("Player Position: %.1f, %.1f", player.getPosition().x, player.getPosition().y);
+                    // Hot-path trace channels (compiled out in release builds)
+#if GAME_LOG_LEVEL >= GAME_LOG_LEVEL_TRACE
+                    bool tracePhysics = DebugLog::isEnabled(DebugLog::Physics);
+                    bool traceAnimation = DebugLog::isEnabled(DebugLog::Animation);
+                    bool tracePlayer = DebugLog::isEnabled(DebugLog::Player);
+                    ImGui::Text("Trace Output:");
+                    if (ImGui::Checkbox("Physics##trace", &tracePhysics)) DebugLog::setEnabled(DebugLog::Physics, tracePhysics);
+                    ImGui::SameLine();
+                    if (ImGui::Checkbox("Animation##trace", &traceAnimation)) DebugLog::setEnabled(DebugLog::Animation, traceAnimation);
+                    ImGui::SameLine();
+                    if (ImGui::Checkbox("Player##trace", &tracePlayer)) DebugLog::setEnabled(DebugLog::Player, tracePlayer);
+#endif
+                    ImGui::Text("Culling (drawn/culled): platforms %zu/%zu, enemies %zu/%zu, debug %zu/%zu",
+                               platformCullStats.drawn, platformCullStats.culled,
+                               enemyCullStats.drawn, enemyCullStats.culled,
+                               debugBoxCullStats.drawn, debugBoxCullStats.culled);
+                    const SpriteBatch::Stats& batchStats = renderingSystem.getBatchStats();
+                    ImGui::Text("Sprite Batch: %zu sprites in %zu draw calls (%zu vertices)",
+                               batchStats.spritesSubmitted, batchStats.drawCalls, batchStats.vertices);
+                    const CrowdRenderer::Stats& crowdStats = renderingSystem.getCrowdStats();
+                    ImGui::Text("Crowd: %zu characters in %zu draw calls (%zu vertices)",
+                               crowdStats.characters, crowdStats.drawCalls, crowdStats.vertices);
+                    ImGui::Text("Log Records: %llu written, %llu dropped",
+                               static_cast<unsigned long long>(AsyncLogger::instance().getWrittenCount()),
+                               static_cast<unsigned long long>(AsyncLogger::instance().getDroppedCount()));
+                    ImGui::Text("Job Threads: %u (last batch %zu chunks, %zu steals total)",
+                               jobSystem.getThreadCount(), jobSystem.getLastChunkCount(), jobSystem.getStealCount());
                     
                     // Grid coordinate information
                     if (showDebugGrid) {
@@ -1471,6 +2970,62 @@ void Game::updateImGui() {
                     
                     // Asset status
                     ImGui::Text("Background: %s", useBackgroundPlaceholder ? "Using placeholder" : "Loaded");
+                    ImGui::Text("Background draw calls: %zu", renderingSystem.getLastBackgroundDrawCalls());
+                    ImGui::Text("Animation clips: %zu cached (%zu textures)",
+                               AnimationClipCache::instance().getClipCount(), AnimationClipCache::instance().getTextureCount());
+                    ImGui::Text("Animation frames: %zu, %zu sharing an identical frame's pixels",
+                               AnimationClipCache::instance().getFrameCount(),
+                               AnimationClipCache::instance().getDuplicateFrameCount());
+                    if (npcManager) {
+                        const AnimationSystem& npcAnimations = npcManager->getAnimationSystem();
+                        ImGui::Text("NPC animations: %zu playing, %zu stepped frames changed last update",
+                                   npcAnimations.size(), npcAnimations.getChangedFrames().size());
+                    }
+                    const AssetManager::TextureStats textureStats = assets.getTextureStats();
+                    ImGui::Text("Textures: %.1f / %.1f MB resident (%.1f MB pinned), %zu evicted",
+                               textureStats.residentBytes / (1024.0f * 1024.0f),
+                               assets.getTextureBudget() / (1024.0f * 1024.0f),
+                               textureStats.referencedBytes / (1024.0f * 1024.0f), textureStats.evictions);
+                    for (size_t i = 0; i < textureStats.bytes.size(); ++i) {
+                        ImGui::BulletText("%s: %zu textures, %.1f MB",
+                                          AssetManager::toString(static_cast<AssetManager::TextureCategory>(i)),
+                                          textureStats.counts[i], textureStats.bytes[i] / (1024.0f * 1024.0f));
+                    }
+                    if (AssetPack::instance().getBundleCount() > 0) {
+                        const LevelBundles::Stats bundleStats = levelBundles.getStats();
+                        ImGui::Text("Level bundles: %zu held, %zu files (%.1f MB); %zu reads, %.1f MB, last %.1f ms%s",
+                                   bundleStats.heldLevels, bundleStats.files, bundleStats.bytes / (1024.0f * 1024.0f),
+                                   bundleStats.reads, bundleStats.readBytes / (1024.0f * 1024.0f), bundleStats.lastReadMs,
+                                   levelBundles.isReading() ? " (reading)" : "");
+                    } else {
+                        ImGui::TextDisabled("Level bundles: none (%s)",
+                                            AssetPack::instance().isMounted() ? "pack built without levels" : "no pack");
+                    }
+                    for (const auto& layer : backgroundLayers) {
+                        if (!layer.tiled) continue;
+                        const TiledBackground::Stats& tileStats = layer.tiled->getStats();
+                        const TileLayout& layout = layer.tiled->getLayout();
+                        ImGui::Text("Tiled %s: %ux%u in %zu tiles; %zu resident, %zu loading, %zu requested, %zu evicted%s",
+                                   layer.name.c_str(), layout.size.x, layout.size.y, layout.getTileCount(),
+                                   tileStats.resident, tileStats.loading, tileStats.requests, tileStats.evictions,
+                                   tileStats.failed > 0 ? " (some failed)" : "");
+                    }
+                    if (ImGui::TreeNode("LevelAssets", "Level %d needs %zu asset files", currentLevel, levelAssets.size())) {
+                        for (const std::string& path : levelAssets) {
+                            ImGui::BulletText("%s", path.c_str());
+                        }
+                        ImGui::TreePop();
+                    }
+                    // Owned by their caches rather than the asset manager, so not under its budget
+                    ImGui::TextDisabled("Outside the budget: animations %.1f MB, tile atlas %.1f MB",
+                                        AnimationClipCache::instance().getTextureBytes() / (1024.0f * 1024.0f),
+                                        renderingSystem.getTileAtlasBytes() / (1024.0f * 1024.0f));
+                    if (assetWatcher.isWatching()) {
+                        ImGui::Text("Hot reload: watching %s (%s), %zu files reloaded", assetRootDir.c_str(),
+                                   assetWatcher.isPolling() ? "polling" : "native", hotReloadCount);
+                    } else {
+                        ImGui::TextDisabled("Hot reload: off");
+                    }
                     ImGui::Text("Player: %s", usePlayerPlaceholder ? "Using placeholder" : "Loaded");
                     ImGui::Text("Enemy: %s", useEnemyPlaceholder ? "Using placeholder" : "Loaded");
                     
@@ -1479,8 +3034,19 @@ void Game::updateImGui() {
                     // Platform tiles section
                     ImGui::Text("Platform Tiles");
                     ImGui::Text("Status: %s", renderingSystem.isLoaded() ? "Loaded" : "Not loaded");
+                    ImGui::Text("Decorations: %zu quads in %zu chunks", renderingSystem.getDecorationQuadCount(),
+                               renderingSystem.getDecorationChunkCount());
+                    ImGui::Text("Render queue: %zu items in %zu draws", renderQueue.getStats().items,
+                               renderQueue.getStats().draws);
+                    if (renderingSystem.isLightingEnabled()) {
+                        const RenderingSystem::LightStats& lightStats = renderingSystem.getLightStats();
+                        ImGui::Text("Lights: %zu drawn, %zu culled, %zu over budget (of %zu)", lightStats.drawn,
+                                   lightStats.culled, lightStats.overBudget, renderingSystem.getLightCount());
+                    }
                     if (renderingSystem.isLoaded()) {
-                        ImGui::Text("Tile count: %d", renderingSystem.getTileCount());
+                        ImGui::Text("Tile count: %d (%zu atlas pages)", renderingSystem.getTileCount(), renderingSystem.getTileAtlasPageCount());
+                        ImGui::Text("Platform chunks: %zu (%zu draw calls last frame)",
+                                   renderingSystem.getPlatformChunkCount(), renderingSystem.getLastPlatformDrawCalls());
                         
                         // Tile renderer settings
                         int tileSize = renderingSystem.getTileSize();
@@ -1494,31 +3060,25 @@ void Game::updateImGui() {
                         }
                         
                         if (ImGui::Button("Reload Tiles")) {
-                            std::vector<std::string> tilePaths = {
-                                "assets/images/platformer/tiles",
-                                "./assets/images/platformer/tiles",
-                                "../assets/images/platformer/tiles"
-                            };
-                            
-                            for (const auto& path : tilePaths) {
-                                if (renderingSystem.loadTiles(path)) {
-                                    logInfo("Reloaded platform tiles from: " + path);
-                                    break;
-                                }
+                            const std::string path = AssetManifest::resolve(TILES_DIRECTORY);
+                            if (renderingSystem.loadTiles(path)) {
+                                logInfo("Reloaded platform tiles from: " + path);
                             }
                         }
                     }
                     
                     ImGui::Separator();
                     
-                    // Asset manager button
+#if GAME_EDITOR
+                    // The window scans the asset root as it opens
                     if (ImGui::Button("Open Asset Manager")) {
                         showAssetManager = true;
-                        // Scan assets if we haven't done so yet
-                        if (imageAssets.empty()) {
-                            scanAssetDirectory("assets/images");
-                        }
                     }
+                    ImGui::SameLine();
+                    if (ImGui::Button("Open Level Editor")) {
+                        showLevelEditor = true;
+                    }
+#endif
                     
                     if (ImGui::Button("Reload Assets")) {
                         loadAssets();
@@ -1527,13 +3087,18 @@ void Game::updateImGui() {
                     ImGui::EndTabItem();
                 }
                 
+                if (ImGui::BeginTabItem("Telemetry")) {
+                    showTelemetryTab();
+                    ImGui::EndTabItem();
+                }
+                
                 // Add audio controls to ImGui
                 if (ImGui::CollapsingHeader("Audio Settings")) {
                     bool musicEnabled = isMusicEnabled;
                     if (ImGui::Checkbox("Enable Music", &musicEnabled)) {
                         isMusicEnabled = musicEnabled;
                         if (isMusicEnabled) {
-                            soundSystem.playMusic("background", true);
+                            soundSystem.crossfadeMusic(LevelAssets::getMusicStem(levelData), 0.0f);
                         } else {
                             soundSystem.stopMusic();
                         }
@@ -1555,621 +3120,391 @@ void Game::updateImGui() {
                         soundEffectVolume = sfx;
                         soundSystem.setSoundEffectVolume(soundEffectVolume);
                     }
-                }
-                
-                ImGui::EndTabBar();
-            }
-            
-            ImGui::Separator();
-            ImGui::Text("Press ESC or F1 to toggle interface");
-        }
-        ImGui::End();
-        
-        // Show asset manager window if enabled
-        if (showAssetManager) {
-            showAssetManagerWindow();
-        }
-        
-        // Show ImGui demo window if enabled
-        if (showImGuiDemo) {
-            ImGui::ShowDemoWindow(&showImGuiDemo);
-        }
-    } catch (const std::exception& e) {
-        logError("Exception in updateImGui: " + std::string(e.what()));
-    } catch (...) {
-        logError("Unknown exception in updateImGui");
-    }
-}
-
-// Function to draw debug visualization
-void Game::drawDebugBoxes() {
-    if (showBoundingBoxes) {
-        // Draw platform/ground collision boxes
-        for (size_t platformIdx = 0; platformIdx < physicsSystem.getPlatformPhysicsCount(); platformIdx++) {
-            sf::RectangleShape platformCollisionBox;
-            sf::FloatRect platformPhysicsBox = physicsSystem.getPlatformPhysicsComponent(platformIdx).collisionBox;
-            
-            platformCollisionBox.setSize(sf::Vector2f(platformPhysicsBox.size.x, platformPhysicsBox.size.y));
-            platformCollisionBox.setPosition(sf::Vector2f(platformPhysicsBox.position.x, platformPhysicsBox.position.y));
-            platformCollisionBox.setFillColor(sf::Color(0, 0, 255, 30)); // Semi-transparent blue
-            platformCollisionBox.setOutlineColor(sf::Color(0, 0, 255)); // Blue outline
-            platformCollisionBox.setOutlineThickness(1.0f);
-            window.draw(platformCollisionBox);
-        }
-
-        // Draw player collision box
-        sf::FloatRect playerBounds = player.getGlobalBounds();
-        float playerWidth = playerBounds.size.x * physicsSystem.getPlayerCollisionWidth();
-        float playerHeight = playerBounds.size.y * physicsSystem.getPlayerCollisionHeight();
-        float playerOffsetX = playerBounds.size.x * physicsSystem.getPlayerOffsetX();
-        float playerOffsetY = playerBounds.size.y * physicsSystem.getPlayerOffsetY();
-
-        sf::RectangleShape playerCollisionBox;
-        playerCollisionBox.setSize(sf::Vector2f(playerWidth, playerHeight));
-        playerCollisionBox.setPosition(sf::Vector2f(
-            playerBounds.position.x + playerOffsetX,
-            playerBounds.position.y + playerOffsetY
-        ));
-        playerCollisionBox.setFillColor(sf::Color(0, 255, 0, 30)); // Semi-transparent green
-        playerCollisionBox.setOutlineColor(sf::Color(0, 255, 0)); // Green outline
-        playerCollisionBox.setOutlineThickness(1.0f);
-        window.draw(playerCollisionBox);
-
-        // Draw NPC collision boxes
-        if (npcManager) {
-            const auto& npcs = npcManager->getAllNPCs();
-            for (const auto& npc : npcs) {
-                if (!npc.isActive || !npc.sprite) continue;
-
-                // Get the sprite's bounds
-                sf::FloatRect spriteBounds = npc.sprite->getGlobalBounds();
-                
-                // Calculate collision box dimensions (same as in checkPlayerNPCCollision)
-                float width = spriteBounds.size.x * 0.8f;  // 80% of sprite width
-                float height = spriteBounds.size.y * 0.8f;  // 80% of sprite height
-                float offsetX = (spriteBounds.size.x - width) / 2.0f;
-                float offsetY = (spriteBounds.size.y - height) / 2.0f;
-
-                // Create and draw the NPC collision box
-                sf::RectangleShape npcCollisionBox;
-                npcCollisionBox.setSize(sf::Vector2f(width, height));
-                npcCollisionBox.setPosition(sf::Vector2f(
-                    spriteBounds.position.x + offsetX,
-                    spriteBounds.position.y + offsetY
-                ));
-                npcCollisionBox.setFillColor(sf::Color(255, 165, 0, 30)); // Semi-transparent orange
-                npcCollisionBox.setOutlineColor(sf::Color(255, 165, 0)); // Orange outline
-                npcCollisionBox.setOutlineThickness(1.0f);
-                window.draw(npcCollisionBox);
-            }
-        }
-    }
-}
-
-// Run the game loop
-void Game::run() {
-    // Adjust player collision box - increase dimensions slightly for better visualization
-    player.setCollisionBoxSize(sf::Vector2f(28.f, 28.f));
-    
-    // Run the game loop
-    while (window.isOpen()) {
-        handleEvents();
-        update();
-        draw();
-    }
-}
-
-// Implementation of the asset manager window
-void Game::showAssetManagerWindow() {
-    // Auto-scan assets directory when window is opened if no assets are loaded
-    static bool firstOpen = true;
-    if (firstOpen) {
-        scanAssetDirectory("assets");
-        firstOpen = false;
-    }
-
-    if (ImGui::Begin("Asset Manager", &showAssetManager)) {
-        // Scan button to refresh the asset list
-        if (ImGui::Button("Scan Assets")) {
-            scanAssetDirectory("assets");
-        }
-        
-        ImGui::SameLine();
-        
-        // Help tooltip
-        ImGui::TextDisabled("(?)");
-        if (ImGui::IsItemHovered()) {
-            ImGui::BeginTooltip();
-            ImGui::PushTextWrapPos(ImGui::GetFontSize() * 35.0f);
-            ImGui::TextUnformatted("Click to scan the assets directory for all files.\nDirectory contents are shown with [DIR] prefix.\nImage files are shown with  prefix.");
-            ImGui::PopTextWrapPos();
-            ImGui::EndTooltip();
-        }
-        
-        ImGui::Separator();
-        
-        // Split window into two columns - left for list, right for preview
-        ImGui::Columns(2, "assetColumns");
-        
-        // First column - Asset list
-        ImGui::Text("Assets (%zu found)", imageAssets.size());
-        ImGui::BeginChild("AssetList", ImVec2(0, 0), true);
-        
-        for (auto& asset : imageAssets) {
-            // Display file name and status
-            std::string label = asset.name;
-            bool isImage = asset.name.find(" prefix.") != std::string::npos;
-            bool isDir = asset.name.find("[DIR]") != std::string::npos;
-            
-            if (isImage && asset.isLoaded) {
-                label += " [Loaded]";
-            }
-            
-            // Set colors based on type
-            if (isDir) {
-                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.5f, 0.8f, 1.0f, 1.0f)); // Blue for directories
-            } else if (isImage) {
-                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.5f, 1.0f, 0.5f, 1.0f)); // Green for images
-            } else {
-                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 1.0f, 1.0f)); // White for other files
-            }
-            
-            // Selectable item with highlight
-            if (ImGui::Selectable(label.c_str(), selectedAsset == &asset)) {
-                selectedAsset = &asset;
-                
-                // Load texture for preview if available (only for images)
-                previewAvailable = false;
-                if (selectedAsset && isImage && selectedAsset->isLoaded) {
-                    try {
-                        // Try to load the texture for preview
-                        if (previewTexture.loadFromFile(selectedAsset->path)) {
-                            previewAvailable = true;
-                        }
-                    } catch (const std::exception& e) {
-                        std::cerr << "Failed to load preview texture: " << e.what() << std::endl;
-                    }
-                }
-            }
-            
-            ImGui::PopStyleColor();
-        }
-        
-        ImGui::EndChild();
-        
-        // Second column - Asset details and preview
-        ImGui::NextColumn();
-        
-        if (selectedAsset) {
-            // Show asset details
-            ImGui::Text("File: %s", selectedAsset->name.c_str());
-            ImGui::Text("Path: %s", selectedAsset->path.c_str());
-            
-            bool isImage = selectedAsset->name.find(" prefix.") != std::string::npos;
-            bool isDir = selectedAsset->name.find("[DIR]") != std::string::npos;
-            
-            if (isDir) {
-                ImGui::Text("Type: Directory");
-                
-                // Add a button to navigate into this directory
-                if (ImGui::Button("Open Directory")) {
-                    scanAssetDirectory(selectedAsset->path);
-                }
-            } else {
-                ImGui::Text("Type: %s", isImage ? "Image" : "File");
-                
-                if (isImage) {
-                    ImGui::Text("Dimensions: %ux%u", selectedAsset->dimensions.x, selectedAsset->dimensions.y);
-                }
-                
-                // Format file size nicely (KB/MB)
-                float fileSizeKB = static_cast<float>(selectedAsset->fileSize) / 1024.0f;
-                if (fileSizeKB < 1024.0f) {
-                    ImGui::Text("File size: %.2f KB", fileSizeKB);
-                } else {
-                    ImGui::Text("File size: %.2f MB", fileSizeKB / 1024.0f);
-                }
-                
-                if (isImage) {
-                    ImGui::Text("Status: %s", selectedAsset->isLoaded ? "Loaded" : "Not loaded");
                     
-                    if (selectedAsset->isLoaded) {
-                        ImGui::Text("Load time: %.2f ms", static_cast<float>(selectedAsset->loadTime.asMilliseconds()));
-                    }
-                }
-            }
-            
-            ImGui::Separator();
-            
-            // Show preview if available
-            if (isImage && previewAvailable) {
-                // Calculate preview size maintaining aspect ratio
-                float aspectRatio = static_cast<float>(previewTexture.getSize().x) / 
-                                   static_cast<float>(previewTexture.getSize().y);
-                
-                float maxWidth = ImGui::GetContentRegionAvail().x;
-                float maxHeight = 200.0f; // Maximum preview height
-                
-                float width = maxWidth;
-                float height = width / aspectRatio;
-                
-                if (height > maxHeight) {
-                    height = maxHeight;
-                    width = height * aspectRatio;
-                }
-                
-                // Display the texture
-                ImGui::Text("Preview:");
-                ImGui::Image(previewTexture.getNativeHandle(), ImVec2(width, height));
-                
-                // Add load button for images
-                if (ImGui::Button("Load into Game")) {
-                    try {
-                        // Example of loading into the asset manager
-                        std::string assetName = selectedAsset->name;
-                        // Remove  prefix and any file extension
-                        assetName = assetName.substr(assetName.find("]") + 2);
-                        assetName = assetName.substr(0, assetName.find_last_of('.'));
-                        assets.loadTexture(assetName, selectedAsset->path);
-                        ImGui::OpenPopup("AssetLoaded");
-                    } catch (const std::exception& e) {
-                        std::cerr << "Failed to load asset: " << e.what() << std::endl;
-                        ImGui::OpenPopup("AssetLoadError");
-                    }
-                }
-                
-                // Asset loaded popup
-                if (ImGui::BeginPopupModal("AssetLoaded", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
-                    ImGui::Text("Asset loaded successfully!");
-                    if (ImGui::Button("OK", ImVec2(120, 0))) {
-                        ImGui::CloseCurrentPopup();
-                    }
-                    ImGui::EndPopup();
-                }
-                
-                // Asset load error popup
-                if (ImGui::BeginPopupModal("AssetLoadError", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
-                    ImGui::Text("Failed to load asset into game!");
-                    if (ImGui::Button("OK", ImVec2(120, 0))) {
-                        ImGui::CloseCurrentPopup();
-                    }
-                    ImGui::EndPopup();
+                    const SoundSystem::VoiceStats voiceStats = soundSystem.getVoiceStats();
+                    ImGui::Text("Voices: %d active, %d mixed, %d virtual, %llu played, %llu stolen, %llu dropped, %llu rate-limited, %llu virtualized",
+                               voiceStats.activeVoices, voiceStats.mixedVoices, voiceStats.virtualVoices,
+                               static_cast<unsigned long long>(voiceStats.played),
+                               static_cast<unsigned long long>(voiceStats.stolen),
+                               static_cast<unsigned long long>(voiceStats.dropped),
+                               static_cast<unsigned long long>(voiceStats.rateLimited),
+                               static_cast<unsigned long long>(voiceStats.virtualized));
+                    const SoundSystem::AudioThreadStats audioStats = soundSystem.getAudioThreadStats();
+                    ImGui::Text("Audio thread: %.3f ms/tick (avg %.3f, peak %.3f), %llu commands, %llu dropped",
+                               audioStats.lastTickMs, audioStats.averageTickMs, audioStats.peakTickMs,
+                               static_cast<unsigned long long>(audioStats.commands),
+                               static_cast<unsigned long long>(audioStats.commandsDropped));
+                    ImGui::Text("Effects bus: %.3f ms per %zu-frame block (%s), %llu blocks",
+                               audioStats.mixBlockMs, SfxMixer::BLOCK_FRAMES, SfxMixer::kernelName(),
+                               static_cast<unsigned long long>(audioStats.mixBlocks));
                 }
-            } else if (isImage) {
-                ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Preview not available");
+                
+                ImGui::EndTabBar();
             }
-        } else {
-            ImGui::TextDisabled("Select an asset to view details");
-        }
-        
-        ImGui::Columns(1);
-        
-        // Add a back button to navigate up a directory
-        if (ImGui::Button("Back to Parent Directory")) {
-            // Get current directory path
-            std::string currentPath = selectedAsset ? selectedAsset->path : "assets";
             
-            // Navigate to parent directory
-            fs::path path(currentPath);
-            fs::path parent = path.parent_path();
-            
-            // Don't go above the assets directory
-            if (parent.filename().string() == "assets" || 
-                parent.filename().string() == "images" || 
-                parent.string().find("assets") != std::string::npos) {
-                scanAssetDirectory(parent.string());
-            } else {
-                scanAssetDirectory("assets");
-            }
+            ImGui::Separator();
+            ImGui::Text("Press ESC or F1 to toggle interface");
         }
+        ImGui::End();
+    } catch (const std::exception& e) {
+        logError("Exception in updateImGui: " + std::string(e.what()));
+    } catch (...) {
+        logError("Unknown exception in updateImGui");
+    }
+}
+
+// Function to draw debug visualization
+void Game::collectVisiblePlatforms(const sf::FloatRect& viewBounds) {
+    visiblePlatforms.clear();
+    
+    // The physics broadphase grid indexes exactly these platforms; use it when in sync
+    const SpatialGrid& grid = physicsSystem.getPlatformGrid();
+    if (grid.getItemCount() == platforms.size() && physicsSystem.getPlatformPhysicsCount() == platforms.size()) {
+        grid.query(viewBounds, visiblePlatforms);
+        // The grid returns cell-level candidates; keep the ones that really overlap
+        visiblePlatforms.erase(std::remove_if(visiblePlatforms.begin(), visiblePlatforms.end(), [&](size_t i) {
+            return !ViewCulling::isVisible(platforms.getBounds(i), viewBounds);
+        }), visiblePlatforms.end());
+        return;
     }
-    ImGui::End();
     
-    // If window is closed, reset the firstOpen flag for next time
-    if (!showAssetManager) {
-        firstOpen = true;
+    for (size_t i = 0; i < platforms.size(); ++i) {
+        if (ViewCulling::isVisible(platforms.getBounds(i), viewBounds)) {
+            visiblePlatforms.push_back(i);
+        }
     }
 }
 
-// Scan asset directory recursively to find image files
-void Game::scanAssetDirectory(const std::string& directory) {
-    try {
-        logDebug("Scanning directory: " + directory);
-        imageAssets.clear();
-        
-        // Check if the directory exists
-        if (!fs::exists(directory)) {
-            std::cerr << "Directory does not exist: " << directory << std::endl;
-            
-            // Try with different relative paths
-            std::vector<std::string> pathsToTry = {
-                "./assets",
-                "../assets",
-                "assets",
-                "/Users/startup/my-game/assets"
-            };
-            
-            bool foundPath = false;
-            for (const auto& path : pathsToTry) {
-                logDebug("Trying alternative path: " + path);
-                if (fs::exists(path)) {
-                    logDebug("Found valid path: " + path);
-                    scanAssetDirectory(path);
-                    foundPath = true;
-                    break;
-                }
-            }
-            
-            if (!foundPath) {
-                std::cerr << "Could not find assets directory in any of the tried paths" << std::endl;
+void Game::drawDebugBoxes(RenderSnapshot& snapshot) {
+    PROFILE_ZONE("Game::drawDebugBoxes");
+    debugBoxCullStats.reset();
+    if (showBoundingBoxes) {
+        const sf::FloatRect viewBounds = getWorldViews(CULL_MARGIN).bounds;
+        DebugDraw& debugDraw = renderingSystem.getDebugDraw();
+        
+        // Platform/ground collision boxes (only the ones in view), semi-transparent blue
+        collectVisiblePlatforms(viewBounds);
+        debugBoxCullStats.drawn += visiblePlatforms.size();
+        debugBoxCullStats.culled += physicsSystem.getPlatformPhysicsCount() - std::min(visiblePlatforms.size(), physicsSystem.getPlatformPhysicsCount());
+        for (size_t platformIdx : visiblePlatforms) {
+            if (platformIdx >= physicsSystem.getPlatformPhysicsCount()) continue;
+            debugDraw.rect(physicsSystem.getPlatformPhysicsComponent(platformIdx).collisionBox,
+                           sf::Color(0, 0, 255, 30), sf::Color(0, 0, 255));
+            // Slopes also show the ramp they collide as
+            const Narrowphase::Surface& surface = physicsSystem.getPlatformSurface(platformIdx);
+            if (surface.type == Narrowphase::SurfaceType::SlopeUpRight || surface.type == Narrowphase::SurfaceType::SlopeUpLeft) {
+                const float left = surface.bounds.position.x;
+                const float right = left + surface.bounds.size.x;
+                debugDraw.line(sf::Vector2f(left, Narrowphase::getSurfaceTop(surface, left)),
+                               sf::Vector2f(right, Narrowphase::getSurfaceTop(surface, right)), sf::Color::Cyan, 2.f);
             }
-            return;
         }
-        
-        // List all entries in the directory first (non-recursive)
-        logDebug("Listing top-level entries in " + directory + ":");
-        
-        // Track directories for subdirectory display
-        std::vector<std::string> subdirectories;
-        
-        // First scan the top directory (non-recursive)
-        for (const auto& entry : fs::directory_iterator(directory)) {
-            std::string path = entry.path().string();
-            std::string name = entry.path().filename().string();
-            
-            logDebug("Found: " + path);
-            
-            if (entry.is_directory()) {
-                // Add to subdirectories list
-                subdirectories.push_back(path);
-                
-                // Create a directory entry in our assets list
-                ImageAssetInfo info;
-                info.path = path;
-                info.name = "[DIR] " + name;
-                info.fileSize = 0;
-                info.isLoaded = false;
-                info.dimensions = sf::Vector2u(0, 0);
-                imageAssets.push_back(info);
-            } else if (entry.is_regular_file()) {
-                std::string extension = entry.path().extension().string();
-                
-                // Convert extension to lowercase
-                std::transform(extension.begin(), extension.end(), extension.begin(), 
-                            [](unsigned char c) { return std::tolower(c); });
-                
-                // Add file to our assets list
-                ImageAssetInfo info;
-                info.path = path;
-                info.name = name;
-                info.fileSize = entry.file_size();
-                info.isLoaded = false;
-                info.dimensions = sf::Vector2u(0, 0);
-                
-                // Try to load the image if it's an image file
-                if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || 
-                    extension == ".bmp" || extension == ".tga") {
-                    sf::Clock loadTimer;
-                    sf::Texture texture;
-                    if (texture.loadFromFile(info.path)) {
-                        info.dimensions = texture.getSize();
-                        info.isLoaded = true;
-                        info.loadTime = loadTimer.getElapsedTime();
-                        info.name = " prefix. " + name;
-                    }
-                }
-                
-                imageAssets.push_back(info);
+
+        // Player collision box, green
+        debugDraw.rect(physicsSystem.getPlayerCollisionBox(player), sf::Color(0, 255, 0, 30), sf::Color(0, 255, 0));
+
+        // NPC collision boxes, orange
+        if (npcManager) {
+            const auto& npcs = npcManager->getAllNPCs();
+            for (const auto& npc : npcs) {
+                if (!npc.isActive || !npc.hasSprite()) continue;
+
+                const sf::FloatRect npcBox = getNPCContactBox(npc);
+                bool visible = ViewCulling::isVisible(npcBox, viewBounds);
+                debugBoxCullStats.count(visible);
+                if (!visible) continue;
+                debugDraw.rect(npcBox, sf::Color(255, 165, 0, 30), sf::Color(255, 165, 0));
             }
         }
         
-        // Now recursively scan image subdirectories
-        for (const auto& subdir : subdirectories) {
-            if (subdir.find("images") != std::string::npos) {
-                logDebug("Scanning image subdirectory: " + subdir);
-                
-                for (const auto& entry : fs::recursive_directory_iterator(subdir)) {
-                    if (entry.is_regular_file()) {
-                        std::string extension = entry.path().extension().string();
-                        
-                        // Convert extension to lowercase
-                        std::transform(extension.begin(), extension.end(), extension.begin(), 
-                                    [](unsigned char c) { return std::tolower(c); });
-                        
-                        // Check if this is an image file
-                        if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || 
-                            extension == ".bmp" || extension == ".tga") {
-                            
-                            ImageAssetInfo info;
-                            info.path = entry.path().string();
-                            info.name = " prefix. " + entry.path().filename().string();
-                            info.fileSize = entry.file_size();
-                            info.isLoaded = false;
-                            info.loadTime = sf::Time::Zero;
-                            
-                            // Try to load the image to get dimensions
-                            sf::Clock loadTimer;
-                            sf::Texture texture;
-                            if (texture.loadFromFile(info.path)) {
-                                info.dimensions = texture.getSize();
-                                info.isLoaded = true;
-                                info.loadTime = loadTimer.getElapsedTime();
-                            } else {
-                                info.dimensions = sf::Vector2u(0, 0);
-                            }
-                            
-                            imageAssets.push_back(info);
-                        }
-                    }
-                }
+        // Trigger zones, magenta outlines
+        for (const LevelData::Trigger& trigger : levelData.triggers) {
+            if (ViewCulling::isVisible(trigger.bounds, viewBounds)) {
+                debugDraw.rectOutline(trigger.bounds, sf::Color::Magenta);
             }
         }
-        
-        // Sort assets by name
-        std::sort(imageAssets.begin(), imageAssets.end(), 
-                 [](const ImageAssetInfo& a, const ImageAssetInfo& b) {
-                     // Directories come first, then files
-                     bool aIsDir = a.name.find("[DIR]") != std::string::npos;
-                     bool bIsDir = b.name.find("[DIR]") != std::string::npos;
-                     
-                     if (aIsDir && !bIsDir) return true;
-                     if (!aIsDir && bIsDir) return false;
-                     
-                     // Then sort by name
-                     return a.name < b.name;
-                 });
-        
-        logDebug("Asset scan complete. Found " + std::to_string(imageAssets.size()) + " items.");
-                 
-    } catch (const std::exception& e) {
-        std::cerr << "Error scanning assets directory: " << e.what() << std::endl;
     }
-} 
-// Method to synchronize platforms with their physics components
-void Game::syncPlatformsWithPhysics() {
-    // Make sure we have physics components for each platform
-    if (platforms.size() != physicsSystem.getPlatformPhysicsCount()) {
-        logWarning("Platform count mismatch. Platforms: " + std::to_string(platforms.size()) + 
-                  ", Physics components: " + std::to_string(physicsSystem.getPlatformPhysicsCount()));
-        return;
+    if (showNavGraph && !navGraph.empty()) {
+        drawNavGraph(renderingSystem.getDebugDraw(), getWorldViews(CULL_MARGIN).bounds);
     }
-    
-    // For each platform, update its position and size to match the collision box
-    for (size_t i = 0; i < platforms.size(); ++i) {
-        const auto& physicsBox = physicsSystem.getPlatformPhysicsComponent(i).collisionBox;
-        platforms[i].setPosition(physicsBox.position);
-        platforms[i].setSize(physicsBox.size);
+#if GAME_EDITOR
+    if (showLevelEditor && levelEditor) {
+        levelEditor->drawOverlay(renderingSystem.getDebugDraw(), levelData);
     }
-    
-    logDebug("Synchronized " + std::to_string(platforms.size()) + " platforms with physics components");
+#endif
+    // Anything else recorded this frame goes out in the same draw
+    renderingSystem.flushDebugDraw(renderQueue);
+    snapshot.countCulled(RenderCategory::Debug, debugBoxCullStats.culled);
 }
 
-void Game::jumpToLevel(int level) {
-    // Ensure level is valid (only 1 or 2)
-    level = std::min(std::max(level, 1), 2);
-    
-    // Set the current level
-    currentLevel = level;
-    
-    // Reset player position
-    player.reset(50.f, WINDOW_HEIGHT - GROUND_HEIGHT - 40.f);
+void Game::drawNavGraph(DebugDraw& debugDraw, const sf::FloatRect& viewBounds) {
+    // Surfaces in white, then edges touching the view: walk green, jump yellow, fall red
+    for (uint32_t n = 0; n < navGraph.getNodeCount(); ++n) {
+        const NavGraph::Node& node = navGraph.getNode(n);
+        const sf::FloatRect span(sf::Vector2f(node.left, std::min(node.topLeft, node.topRight)),
+                                 sf::Vector2f(node.right - node.left, std::abs(node.topRight - node.topLeft) + 1.f));
+        if (!ViewCulling::isVisible(span, viewBounds)) continue;
+        debugDraw.line(sf::Vector2f(node.left, node.topLeft), sf::Vector2f(node.right, node.topRight),
+                       sf::Color::White, 2.f);
+        for (const NavGraph::Edge* edge = navGraph.edgesBegin(n); edge != navGraph.edgesEnd(n); ++edge) {
+            const sf::Color color = edge->type == NavGraph::EdgeType::Walk ? sf::Color::Green
+                                  : edge->type == NavGraph::EdgeType::Jump ? sf::Color::Yellow
+                                                                           : sf::Color::Red;
+            debugDraw.line(edge->takeoff, edge->landing, color);
+            debugDraw.circle(edge->landing, 3.f, color, color, 1.f, 8);
+        }
+    }
+}
+
+// Run the game loop
+void Game::run() {
+    // Adjust player collision box - increase dimensions slightly for better visualization
     player.setCollisionBoxSize(sf::Vector2f(28.f, 28.f));
     
-    // Reset view
-    gameView.setCenter(sf::Vector2f(WINDOW_WIDTH / 2.f, WINDOW_HEIGHT / 2.f));
-    
-    // Reset game state
-    currentState = GameState::Playing;
-    playerHit = false;
-    playerHitCooldown = 0.f;
-    
-    // Update level text
-    levelText.setString("Level " + std::to_string(currentLevel));
-    sf::FloatRect levelBounds = levelText.getGlobalBounds();
-    levelText.setPosition(sf::Vector2f(
-        WINDOW_WIDTH / 2.f - levelBounds.size.x / 2.f,
-        20.f
-    ));
+    // Run the game loop
+    while (window.isOpen()) {
+        PROFILE_FRAME();
+        recordTelemetry();
+        checkHitches();
+        if (Profiler::isCapturing() &&
+            (Profiler::getCaptureStats().seconds >= captureSeconds || Profiler::isCaptureFull())) {
+            stopProfilerCapture();
+        }
+        handleEvents();
+        update();
+        if (windowMinimized && skipDrawWhenMinimized) {
+            // Nothing is on screen; just close the ImGui frame update opened
+            if (imguiFrameActive) {
+                ImGui::EndFrame();
+            }
+        } else {
+            draw();
+        }
+        framePacer.endFrame();
+        if (!startupProfile.hasFirstFrame()) {
+            renderThread.waitIdle(); // Presented, not just recorded
+            startupProfile.markFirstFrame();
+            // Summed decode time across threads, so MB/s is per decoding thread
+            const ImageCodec::Stats decodes = ImageCodec::getStats();
+            char note[160];
+            std::snprintf(note, sizeof(note), "Image decode: raw %llu (%.1f MB, %.0f MB/s), PNG %llu (%.1f MB, %.0f MB/s)",
+                          static_cast<unsigned long long>(decodes.rawImages), decodes.rawBytes / (1024.0 * 1024.0),
+                          ImageCodec::getMegabytesPerSecond(decodes.rawBytes, decodes.rawNs),
+                          static_cast<unsigned long long>(decodes.codecImages), decodes.codecBytes / (1024.0 * 1024.0),
+                          ImageCodec::getMegabytesPerSecond(decodes.codecBytes, decodes.codecNs));
+            startupProfile.addNote(note);
+            logInfo("Startup phases:");
+            for (const std::string& line : startupProfile.formatLines()) {
+                logInfo(line);
+            }
+        }
+    }
+}
 
-    // Clear NPCs before reinitializing
-    if (npcManager) {
-        npcManager->clearNPCs();
+// Created on first open, so sessions that never look pay nothing for it
+void Game::showAssetManagerWindow() {
+#if GAME_EDITOR
+    if (!assetBrowser) {
+        assetBrowser = std::make_unique<AssetBrowser>(assets, jobSystem);
+    }
+    assetBrowser->draw(&showAssetManager);
+#endif
+}
+
+void Game::showLevelEditorWindow() {
+#if GAME_EDITOR
+    if (!levelEditor) {
+        levelEditor = std::make_unique<LevelEditor>();
+        levelEditor->reset(sceneActive ? std::string() : LevelLoader::getLevelPath(currentLevel));
+    }
+    // Runs after the render thread went idle, so the edits may touch its caches
+    const sf::Vector2f mouseWorld = window.mapPixelToCoords(sf::Mouse::getPosition(window), gameView);
+    const bool locked = netplay.isActive() || replayMode != ReplayMode::Off; // Edits would desync them
+    levelEditor->draw(&showLevelEditor, levelData, mouseWorld, locked);
+    applyLevelEdits();
+#endif
+}
+
+// Brings what is derived from the level up to date with the editor's edits.
+// A moved or resized record only touches what lies under its old and new
+// footprint; adding or removing a platform or ladder renumbers the records,
+// so the streamer buckets them again and the active sectors are rebuilt.
+void Game::applyLevelEdits() {
+#if GAME_EDITOR
+    levelEditor->takeEdits(levelEdits);
+    if (levelEdits.empty()) {
+        return;
+    }
+    PROFILE_ZONE("Game::applyLevelEdits");
+    
+    bool regroup = false;        // Platforms or ladders added or removed
+    bool rebuildNavGraph = false;
+    for (const LevelEditor::Edit& edit : levelEdits) {
+        if (edit.type != LevelEditor::Edit::Type::Change &&
+            (edit.layer == LevelEditor::Layer::Platforms || edit.layer == LevelEditor::Layer::Ladders)) {
+            regroup = true;
+            rebuildNavGraph = rebuildNavGraph || edit.layer == LevelEditor::Layer::Platforms;
+        }
     }
     
-    // Change background and theme based on level
-    try {
-        // Different backgrounds for each level
-        std::string levelBackgroundPath;
-        std::vector<std::string> alternativePaths;
-        
-        if (currentLevel == 1) {
-            // Level 1 - Snow Mountain
-            levelBackgroundPath = "assets/images/backgrounds/snow/snow_background.png";
-            platformColor = sf::Color(200, 220, 255); // Light blue for snow mountain
-            alternativePaths = {
-                "assets/images/backgrounds/snow_background.png",
-                "assets/images/backgrounds/background.png",
-                "../assets/images/backgrounds/background.png"
-            };
-        } else {
-            // Level 2 - Snow Forest
-            levelBackgroundPath = "assets/images/backgrounds/snow_forest/snow_forest_background.png";
-            platformColor = sf::Color(180, 200, 240); // Slightly different blue for snow forest
-            alternativePaths = {
-                "assets/images/backgrounds/snow_forest_background.png",
-                "assets/images/backgrounds/snow/snow_background.png",
-                "assets/images/backgrounds/background.png",
-                "../assets/images/backgrounds/background.png"
-            };
+    auto grow = [](sf::FloatRect& area, const sf::FloatRect& box) {
+        if (box.size.x <= 0.f && box.size.y <= 0.f) return;
+        if (area.size.x <= 0.f && area.size.y <= 0.f) {
+            area = box;
+            return;
         }
-        
-        // Try to load the level-specific background
-        bool loaded = false;
-        try {
-            assets.loadTexture("background", levelBackgroundPath);
-            logInfo("Successfully loaded background: " + levelBackgroundPath);
-            loaded = true;
-        } 
-        catch (const std::exception& e) {
-            logError("Failed to load primary background: " + std::string(e.what()));
-            
-            // Try alternative paths
-            for (const auto& path : alternativePaths) {
-                try {
-                    assets.loadTexture("background", path);
-                    logInfo("Successfully loaded alternative background: " + path);
-                    loaded = true;
-                    break;
-                } catch (const std::exception& innerE) {
-                    logWarning("Failed to load alternative background from " + path + ": " + std::string(innerE.what()));
+        const sf::Vector2f low(std::min(area.position.x, box.position.x), std::min(area.position.y, box.position.y));
+        const sf::Vector2f high(std::max(area.position.x + area.size.x, box.position.x + box.size.x),
+                                std::max(area.position.y + area.size.y, box.position.y + box.size.y));
+        area = sf::FloatRect(low, high - low);
+    };
+    bool collectDue = false; // A record entered or left the active sectors
+    std::vector<size_t> changedPlatforms;
+    sf::FloatRect miniMapArea;
+    sf::FloatRect decorationArea;
+    bool decorationsChanged = false;
+    for (const LevelEditor::Edit& edit : levelEdits) {
+        const uint32_t index = static_cast<uint32_t>(edit.index);
+        switch (edit.layer) {
+            case LevelEditor::Layer::Platforms: {
+                if (regroup) break;
+                const LevelData::Platform& platform = levelData.platforms[index];
+                if (levelStreamer.movePlatform(index, platform.bounds, platform.slope)) {
+                    collectDue = true;
+                } else if (const int active = levelStreamer.findActivePlatform(index); active >= 0) {
+                    platforms.setBounds(active, platform.bounds);
+                    platforms.setSlope(active, platform.slope);
+                    physicsSystem.updatePlatform(active, platform.bounds, platform.slope);
+                    changedPlatforms.push_back(static_cast<size_t>(active));
+                    grow(miniMapArea, edit.before);
+                    grow(miniMapArea, edit.after);
+                }
+                navGraph.updatePlatform(levelData.platforms, index);
+                break;
+            }
+            case LevelEditor::Layer::Ladders: {
+                if (regroup) break;
+                const sf::FloatRect& bounds = levelData.ladders[index].bounds;
+                if (levelStreamer.moveLadder(index, bounds)) {
+                    collectDue = true;
+                } else if (const int active = levelStreamer.findActiveLadder(index); active >= 0) {
+                    ladders.setBounds(active, bounds);
+                    physicsSystem.updateLadder(ladders, edit.before, edit.after);
+                    grow(miniMapArea, edit.before);
+                    grow(miniMapArea, edit.after);
                 }
+                break;
             }
+            case LevelEditor::Layer::Decorations:
+                decorationsChanged = true;
+                grow(decorationArea, edit.before);
+                grow(decorationArea, edit.after);
+                break;
+            case LevelEditor::Layer::Spawns:
+                break; // Read when the level (re)starts
         }
-        
-        // Reload the layered background system for the new level
-        if (loaded) {
-            loadBackgroundLayers();
-            logInfo("Reloaded layered backgrounds for level " + std::to_string(currentLevel));
+    }
+    
+    if (decorationsChanged) {
+        LevelLoader::resolveDecorations(levelData);
+        renderingSystem.updateDecorationCache(levelData.decorationQuads, decorationArea);
+    }
+    if (regroup) {
+        levelStreamer.setGeometry(levelData);
+        if (rebuildNavGraph) {
+            navGraph.build(levelData.platforms);
+        }
+        collectDue = true;
+    }
+    if (collectDue) {
+        applyActiveSectors();
+    } else {
+        if (!changedPlatforms.empty()) {
+            renderingSystem.updatePlatformCache(platforms, changedPlatforms);
         }
-        // If we couldn't load a background texture, use the placeholder
-        else {
-            useBackgroundPlaceholder = true;
-            backgroundPlaceholder.setFillColor(sf::Color(200, 220, 255)); // Light blue for snow theme
+        if (miniMapArea.size.x > 0.f || miniMapArea.size.y > 0.f) {
+            redrawMiniMap(miniMapArea);
         }
-    } catch (const std::exception& e) {
-        logError("Failed to load background for level " + std::to_string(currentLevel) + ": " + std::string(e.what()));
-        useBackgroundPlaceholder = true;
-        backgroundPlaceholder.setFillColor(sf::Color(200, 220, 255)); // Light blue for snow theme
     }
-    
-    // Reinitialize game elements with new variations based on level
-    initializePlatforms();
-    initializeEnemies();
-    initializeUI();
-    initializeMiniMap();
-    
-    // Apply level-specific physics and difficulty
-    if (currentLevel == 2) {
-        // Add extra enemies for level 2
-        for (int i = 0; i < 2; i++) {
-            float x = 500.f + (i * 400.f);  // Space them out
-            float y = WINDOW_HEIGHT - 70.f; // On the ground
-            float patrolDistance = 180.f; // Fixed patrol distance for level 2
-            enemies.push_back(Enemy(x, y, patrolDistance));
+    sceneCacheDirty = true;
+#endif
+}
+
+void Game::redrawMiniMap(const sf::FloatRect& area) {
+    if (!miniMapTextureValid) {
+        return;
+    }
+    // The texture pixels showing 'area', a pixel wider for rounding, kept inside the border
+    const float inside = MINI_MAP_OUTLINE + MINI_MAP_INSET;
+    const sf::Vector2i from = miniMapTexture.mapCoordsToPixel(area.position, miniMapView);
+    const sf::Vector2i to = miniMapTexture.mapCoordsToPixel(area.position + area.size, miniMapView);
+    const float left = std::max(static_cast<float>(std::min(from.x, to.x) - 1), inside);
+    const float top = std::max(static_cast<float>(std::min(from.y, to.y) - 1), inside);
+    const float right = std::min(static_cast<float>(std::max(from.x, to.x) + 2), MINI_MAP_OUTLINE + MINI_MAP_WIDTH - MINI_MAP_INSET);
+    const float bottom = std::min(static_cast<float>(std::max(from.y, to.y) + 2), MINI_MAP_OUTLINE + MINI_MAP_HEIGHT - MINI_MAP_INSET);
+    if (right <= left || bottom <= top) {
+        return;
+    }
+    const sf::Vector2f textureSize(miniMapTexture.getSize());
+    const sf::FloatRect scissor(sf::Vector2f(left / textureSize.x, top / textureSize.y),
+                                sf::Vector2f((right - left) / textureSize.x, (bottom - top) / textureSize.y));
+    
+    // Put the background back (replacing, not blending over, what was there)
+    miniMapTexture.setView(miniMapTexture.getDefaultView());
+    sf::RectangleShape fill(sf::Vector2f(right - left, bottom - top));
+    fill.setPosition(sf::Vector2f(left, top));
+    fill.setFillColor(MINI_MAP_FILL);
+    renderingSystem.submit(miniMapTexture, fill, RenderCategory::MiniMap, sf::RenderStates(sf::BlendNone));
+    
+    // Then whatever lies there, clipped to the same pixels
+    sf::View view = miniMapView;
+    view.setScissor(scissor);
+    miniMapTexture.setView(view);
+    const sf::Vector2f worldFrom = miniMapTexture.mapPixelToCoords(sf::Vector2i(static_cast<int>(left), static_cast<int>(top)), view);
+    const sf::Vector2f worldTo = miniMapTexture.mapPixelToCoords(sf::Vector2i(static_cast<int>(right), static_cast<int>(bottom)), view);
+    const sf::FloatRect world(worldFrom, worldTo - worldFrom);
+    levelVertices.clear();
+    for (size_t i = 0; i < platforms.size(); ++i) {
+        if (platforms.getBounds(i).findIntersection(world)) {
+            platforms.appendQuad(i, sf::Color::Green, levelVertices);
+        }
+    }
+    for (size_t i = 0; i < ladders.size(); ++i) {
+        if (ladders.getBounds(i).findIntersection(world)) {
+            ladders.appendQuad(i, sf::Color(139, 69, 19), levelVertices); // Brown
         }
     }
+    if (!levelVertices.empty()) {
+        renderingSystem.submit(miniMapTexture, levelVertices.data(), levelVertices.size(), sf::PrimitiveType::Triangles,
+                               RenderCategory::MiniMap);
+    }
+    miniMapTexture.display();
+    miniMapTexture.setView(miniMapView);
+}
+
+// Method to synchronize platforms with their physics components
+void Game::syncPlatformsWithPhysics() {
+    // Make sure we have physics components for each platform
+    if (platforms.size() != physicsSystem.getPlatformPhysicsCount()) {
+        logWarning("Platform count mismatch. Platforms: " + std::to_string(platforms.size()) + 
+                  ", Physics components: " + std::to_string(physicsSystem.getPlatformPhysicsCount()));
+        return;
+    }
     
-    // Puzzle-focused physics - minimal jumping, ground-based movement
-    physicsSystem.setGravity(15.0f);  // Higher gravity to keep player grounded
-    physicsSystem.setJumpForce(200.f); // Much lower jump force for puzzle gameplay
+    // For each platform, update its position and size to match the collision box
+    std::vector<size_t> changedPlatforms;
+    for (size_t i = 0; i < platforms.size(); ++i) {
+        sf::FloatRect physicsBox = physicsSystem.getPlatformPhysicsComponent(i).collisionBox;
+        if (platforms.getBounds(i) != physicsBox) {
+            changedPlatforms.push_back(i);
+            platforms.setBounds(i, physicsBox);
+        }
+    }
     
-    // Initialize physics system
-    physicsSystem.initialize();
-    physicsSystem.initializePlayer(player);
-    physicsSystem.initializePlatforms(platforms);
-    physicsSystem.initializeEnemies(enemies);
+    // Only the tile chunks under moved platforms are rebuilt
+    renderingSystem.updatePlatformCache(platforms, changedPlatforms);
     
-    logInfo("Jumped to level " + std::to_string(currentLevel));
+    GAME_LOG(Debug, "Synchronized {} platforms with physics components", platforms.size());
 }
 
 // Initialize background layers with default configuration
@@ -2182,85 +3517,260 @@ void Game::initializeBackgroundLayers() {
     // All layers now move at the same speed (1.0f) to avoid dizzying parallax effects
     
     // Background1 layer - moves with camera (furthest back)
-    backgroundLayers.emplace_back("background1", 0.0f, true, true);
+    backgroundLayers.emplace_back(LevelAssets::BACKGROUND_LAYERS[0], 0.0f, true, true);
     
     // Background2 layer - moves with camera (behind background3 and background4)
-    backgroundLayers.emplace_back("background2", 0.0f, true, false);
+    backgroundLayers.emplace_back(LevelAssets::BACKGROUND_LAYERS[1], 0.0f, true, false);
     
     // Background3 layer - moves with camera (behind background4, in front of background2)
-    backgroundLayers.emplace_back("background3", 0.0f, true, false);
+    backgroundLayers.emplace_back(LevelAssets::BACKGROUND_LAYERS[2], 0.0f, true, false);
     
     // Background4 layer - moves with camera (closest to viewer, on top of all other layers)
-    backgroundLayers.emplace_back("background4", 0.0f, true, false);
+    backgroundLayers.emplace_back(LevelAssets::BACKGROUND_LAYERS[3], 0.0f, true, false);
+    
+    GAME_LOG(Info, "Initialized {} background layers", backgroundLayers.size());
+}
+
+// The file of a background layer: the most specific candidate the manifest
+// lists, empty if it lists none
+std::string Game::getBackgroundLayerPath(const std::string& layerName, int level) const {
+    const std::string path = LevelAssets::getBackgroundLayerPath(layerName, level, isListedAsset);
+    return path.empty() ? path : AssetManifest::resolve(path);
+}
+
+std::string Game::getTiledLayerDirectory(const std::string& layerName, int level) const {
+    const std::string directory = LevelAssets::getTiledLayerPath(layerName, level, isListedAsset);
+    return directory.empty() ? directory : AssetManifest::resolve(directory);
+}
+
+void Game::updateBackgroundDisplaySize() {
+    const sf::Vector2u sceneResolution = renderingSystem.getSceneResolution();
+    const sf::Vector2u size = sceneResolution.x > 0 ? sceneResolution : window.getSize();
+    if (size == assets.getDisplaySize(AssetManager::TextureCategory::Background)) {
+        return;
+    }
+    assets.setDisplaySize(AssetManager::TextureCategory::Background, size);
+    logInfo("Background display size " + std::to_string(size.x) + "x" + std::to_string(size.y));
+    if (!backgroundLayers.empty()) {
+        loadBackgroundLayers(true);
+    }
+}
+
+// After the wait for the render thread, so its stats and the GPU times are the last frame's
+void Game::updateQuality(float frameTime) {
+    // Time blocked on the render thread, or on the display when presenting
+    // inline, is the GPU's (or vsync's) and not CPU work
+    renderThreadStats = renderThread.takeStats();
+    const double waitMs = renderThread.isRunning() ? renderThreadStats.waitMs : displayMs;
+    const double cpuMs = std::max(framePacer.getStats().workMs - waitMs, 0.0);
+    if (qualityGovernor.update(cpuMs, presentedGpuFrame.totalMs, frameTime)) {
+        applyQuality(qualityGovernor.getLevel());
+        const QualityGovernor::Stats& stats = qualityGovernor.getStats();
+        logInfo(std::string("Quality ") + QUALITY_PRESETS[qualityLevel].name + " (" +
+                std::to_string(stats.smoothedMs) + " ms against " + std::to_string(qualityGovernor.getTargetMs()) +
+                " ms, " + (stats.gpuBound ? "GPU" : "CPU") + " bound)");
+    }
+    // AI decisions are part of the simulation, which netplay and replays need deterministic
+    if (npcManager) {
+        const bool deterministic = netplay.isActive() || replayMode != ReplayMode::Off;
+        npcManager->getAIScheduler().getSettings().distanceScale =
+            deterministic ? 1.0f : QUALITY_PRESETS[qualityLevel].aiDistance;
+    }
+}
+
+// Render thread idle. The governor's changes keep the background textures at
+// the size they were resampled to; a preset picked in the panel resamples them.
+void Game::applyQuality(size_t level) {
+    qualityLevel = std::min(level, std::size(QUALITY_PRESETS) - 1);
+    const QualityPreset& preset = QUALITY_PRESETS[qualityLevel];
+    if (renderScaleMode != preset.renderScaleMode) {
+        renderScaleMode = preset.renderScaleMode;
+        renderingSystem.setSceneResolution(RENDER_SCALE_MODES[renderScaleMode].sceneResolution);
+        sceneCacheDirty = true;
+    }
+    renderingSystem.getParticles().setBudgetScale(preset.particleBudget);
+    renderingSystem.setBackgroundLayerLimit(preset.backgroundLayers);
+}
+
+// Start decoding a level's background layers in the background (level transition)
+void Game::prefetchBackgroundLayers(int level) {
+    for (const auto& layer : backgroundLayers) {
+        // A tiled layer opens on its preview; the tiles stream in once it's drawn
+        const std::string tiledDirectory = getTiledLayerDirectory(layer.name, level);
+        if (!tiledDirectory.empty()) {
+            const std::string previewKey = TiledBackground::getPreviewKey(tiledDirectory);
+            if (!assets.hasTexture(previewKey)) {
+                assets.loadTextureAsync(previewKey, tiledDirectory + "/" + TileLayout::PREVIEW_FILE, false,
+                                        AssetManager::TextureCategory::Background);
+            }
+            continue;
+        }
+        std::string textureKey = "bg_" + layer.name + "_level" + std::to_string(level);
+        if (assets.hasTexture(textureKey)) {
+            continue;
+        }
+        const std::string path = getBackgroundLayerPath(layer.name, level);
+        if (!path.empty()) {
+            assets.loadTextureAsync(textureKey, path, layer.tileHorizontally || layer.tileVertically,
+                                    AssetManager::TextureCategory::Background);
+        }
+    }
+    GAME_LOG(Info, "Prefetching background layers for level {}", level);
+}
+
+void Game::parkLevel(int level) {
+    if (levelData.source.empty()) {
+        return; // The stand-in for a level that failed to load
+    }
+    LevelCache::Entry entry;
+    entry.level = level;
+    entry.data = std::move(levelData);
+    entry.decorations = renderingSystem.takeDecorationCache();
+    // Referenced, the backgrounds are no longer the first textures the budget evicts
+    if (AssetManager::TextureRef background = assets.acquireTexture(assets.internTexture(getLevelBackgroundKey(level)))) {
+        entry.textures.push_back(std::move(background));
+    }
+    for (const auto& layer : backgroundLayers) {
+        if (layer.texture) {
+            entry.textures.push_back(layer.texture);
+        }
+    }
+    levelCache.store(std::move(entry));
+}
+
+// Derived from the level data, as asset_packer does for the pack's bundle; a
+// bundle listing other files was packed from other data or assets
+void Game::collectLevelAssets() {
+    LevelAssets::collect(levelData, currentLevel, isListedAsset, listListedDirectory, levelAssets);
+    const AssetPack& pack = AssetPack::instance();
+    const AssetPack::Bundle bundle = pack.findBundle(currentLevel);
+    if (!bundle || sceneActive || levelData.source.empty()) {
+        return;
+    }
+    std::vector<std::string_view> bundled;
+    for (size_t i = 0; i < bundle.fileCount; ++i) {
+        bundled.push_back(pack.getFileName(bundle.files[i]));
+    }
+    std::sort(bundled.begin(), bundled.end());
+    if (!std::equal(bundled.begin(), bundled.end(), levelAssets.begin(), levelAssets.end())) {
+        logWarning("Level " + std::to_string(currentLevel) + " needs " + std::to_string(levelAssets.size()) +
+                   " asset files but its pack bundle lists " + std::to_string(bundled.size()) +
+                   "; rebuild the asset pack");
+    }
+}
+
+void Game::preloadLevel(int level) {
+    // A level kept warm has nothing to read; only its music is prefetched, once
+    if (const LevelData* cached = levelCache.peek(level)) {
+        if (preloadedBackgroundLevel != level) {
+            preloadedBackgroundLevel = level;
+            if (isMusicEnabled) {
+                soundSystem.prefetchMusic(LevelAssets::getMusicStem(*cached));
+            }
+        }
+        return;
+    }
+    if (levelPreloader.request(level)) {
+        levelBundles.hold(currentLevel, level);
+        prefetchBackgroundLayers(level);
+        preloadedBackgroundLevel = 0;
+        GAME_LOG(Info, "Preloading level {}", level);
+    }
+    // The main background and music are named by the level data, so they follow once that is in
+    if (preloadedBackgroundLevel != level) {
+        if (const LevelData* next = levelPreloader.peek(level)) {
+            preloadedBackgroundLevel = level;
+            const std::string key = getLevelBackgroundKey(level);
+            const std::string path = getLevelBackgroundPath(*next);
+            if (!path.empty() && !assets.hasTexture(key)) {
+                assets.loadTextureAsync(key, path, false, AssetManager::TextureCategory::Background);
+            }
+            if (isMusicEnabled) {
+                soundSystem.prefetchMusic(LevelAssets::getMusicStem(*next));
+            }
+        }
+    }
+}
+
+void Game::updateLevelPreload() {
+    const float x = player.getPosition().x;
+    if (currentLevel < levelCount && x >= levelData.size.x - LEVEL_PRELOAD_DISTANCE) {
+        preloadLevel(currentLevel + 1);
+    } else if (currentLevel > 1 && x <= LEVEL_PRELOAD_DISTANCE) {
+        preloadLevel(currentLevel - 1);
+    }
+}
+
+void Game::updateLoadingText() {
+    AssetManager::LoadProgress progress = assets.getLoadProgress();
+    if (!assets.hasPendingLoads() || progress.requested == 0) {
+        hud.setString(loadingText, "");
+        return;
+    }
     
-    logInfo("Initialized " + std::to_string(backgroundLayers.size()) + " background layers");
+    // Unchanged progress leaves the text's layout alone
+    hud.setString(loadingText, "Loading " + std::to_string(progress.completed) + "/" +
+                                   std::to_string(progress.requested) + " (" +
+                                   std::to_string(static_cast<int>(progress.getFraction() * 100.f)) + "%)");
 }
 
 // Load background layer textures
-void Game::loadBackgroundLayers() {
+void Game::loadBackgroundLayers(bool reloadFromDisk) {
+    // Let any prefetch land first so it can't replace a texture we are about to use
+    assets.finishPendingLoads();
+    
     useBackgroundPlaceholder = true; // Start with placeholder
     int loadedLayers = 0;
     
     for (auto& layer : backgroundLayers) {
-        // Define potential paths for each layer
-        std::vector<std::string> layerPaths;
-        
-        if (layer.name == "background1") {
-            layerPaths = {
-                "assets/images/backgrounds/" + std::to_string(currentLevel) + "/background1.png",
-                "assets/images/backgrounds/background1.png",
-                (currentLevel == 1) ? "assets/images/backgrounds/snow/background1.png" : "assets/images/backgrounds/snow_forest/background1.png",
-                "assets/images/backgrounds/snow/background1.png"
-            };
-        } else if (layer.name == "background2") {
-            layerPaths = {
-                "assets/images/backgrounds/" + std::to_string(currentLevel) + "/background2.png",
-                "assets/images/backgrounds/background2.png",
-                (currentLevel == 1) ? "assets/images/backgrounds/snow/background2.png" : "assets/images/backgrounds/snow_forest/background2.png",
-                "assets/images/backgrounds/snow/background2.png"
-            };
-        } else if (layer.name == "background3") {
-            layerPaths = {
-                "assets/images/backgrounds/" + std::to_string(currentLevel) + "/background3.png",
-                "assets/images/backgrounds/background3.png",
-                (currentLevel == 1) ? "assets/images/backgrounds/snow/background3.png" : "assets/images/backgrounds/snow_forest/background3.png",
-                "assets/images/backgrounds/snow/background3.png"
-            };
-        } else if (layer.name == "background4") {
-            layerPaths = {
-                "assets/images/backgrounds/" + std::to_string(currentLevel) + "/background4.png",
-                "assets/images/backgrounds/background4.png",
-                (currentLevel == 1) ? "assets/images/backgrounds/snow/background4.png" : "assets/images/backgrounds/snow_forest/background4.png",
-                "assets/images/backgrounds/snow/background4.png",
-                // Fallback to the original background texture
-                "assets/images/backgrounds/background.png",
-                "../assets/images/backgrounds/background.png"
-            };
-        }
-        
-        // Try to load the layer texture
-        bool layerLoaded = false;
-        for (const auto& path : layerPaths) {
-            try {
-                // Use level-specific texture keys to avoid caching issues
-                std::string textureKey = "bg_" + layer.name + "_level" + std::to_string(currentLevel);
-                assets.loadTexture(textureKey, path);
-                layer.sprite = std::make_unique<sf::Sprite>(assets.getTexture(textureKey));
-                layer.textureSize = assets.getTexture(textureKey).getSize();
+        // The level's tiled version of the layer, when it has one, in place of its image
+        layer.tiled.reset();
+        const std::string tiledDirectory = getTiledLayerDirectory(layer.name, currentLevel);
+        if (!tiledDirectory.empty()) {
+            auto tiled = std::make_shared<TiledBackground>(assets, tiledDirectory);
+            std::string error;
+            if (tiled->open(error)) {
+                layer.sprite.reset();
+                layer.texture.reset();
+                layer.textureSize = tiled->getLayout().size;
+                layer.tiled = std::move(tiled);
                 layer.isLoaded = true;
-                layerLoaded = true;
                 loadedLayers++;
-                logInfo("Successfully loaded " + layer.name + " layer from: " + path);
-                logInfo("  Texture size: " + std::to_string(layer.textureSize.x) + "x" + std::to_string(layer.textureSize.y));
-                break;
-            } catch (const std::exception& e) {
-                logWarning("Failed to load " + layer.name + " from " + path + ": " + std::string(e.what()));
-                // Continue to next path
+                logInfo("Streaming " + layer.name + " layer in " + std::to_string(layer.tiled->getLayout().getTileCount()) +
+                        " tiles from: " + tiledDirectory);
+                continue;
             }
+            logWarning("Could not open tiled " + layer.name + " layer (" + error + "), using its image");
         }
         
-        if (!layerLoaded) {
-            logWarning("Could not load " + layer.name + " layer, will skip in rendering");
+        // Use level-specific texture keys to avoid caching issues
+        std::string textureKey = "bg_" + layer.name + "_level" + std::to_string(currentLevel);
+        // Prefetched during the level transition (or loaded on an earlier visit)
+        const bool cached = !reloadFromDisk && assets.hasTexture(textureKey);
+        const std::string path = cached ? std::string() : getBackgroundLayerPath(layer.name, currentLevel);
+        
+        std::string error = "not in the asset manifest";
+        const bool available = cached ||
+            (!path.empty() && assets.tryLoadTexture(textureKey, path, AssetManager::TextureCategory::Background, error));
+        if (available) {
+            // The previous level's texture is released here and becomes evictable
+            layer.texture = assets.acquireTexture(assets.internTexture(textureKey));
+            // Tiled layers are drawn as one quad that wraps the texture
+            layer.texture.get().setRepeated(layer.tileHorizontally || layer.tileVertically);
+            // Untiled layers are also drawn smaller than loaded (into the view-sized
+            // background cache); tiled ones go without, as mip selection would
+            // seam where the parallax shader wraps
+            if (!layer.tileHorizontally && !layer.tileVertically) {
+                (void)layer.texture.get().generateMipmap();
+            }
+            layer.sprite = std::make_unique<sf::Sprite>(layer.texture.get());
+            layer.textureSize = layer.texture.get().getSize();
+            layer.isLoaded = true;
+            loadedLayers++;
+            logInfo("Successfully loaded " + layer.name + " layer from: " + (path.empty() ? "cache" : path));
+            logInfo("  Texture size: " + std::to_string(layer.textureSize.x) + "x" + std::to_string(layer.textureSize.y));
+        } else {
+            logWarning("Could not load " + layer.name + " layer (" + error + "), will skip in rendering");
         }
     }
     
@@ -2279,61 +3789,48 @@ void Game::loadBackgroundLayers() {
 
 
 
-// Logging methods implementation
+// Logging methods implementation (queued; the logger thread does the file I/O)
 void Game::logDebug(const std::string& message) {
-    if (loggingEnabled && gameLogFile.is_open()) {
-        gameLogFile << "[" << getCurrentTimestamp() << "] [DEBUG] " << message << std::endl;
-        gameLogFile.flush();
+    if (loggingEnabled) {
+        AsyncLogger::instance().log(gameLogSink, AsyncLogger::Level::Debug, message);
     }
 }
 
 void Game::logInfo(const std::string& message) {
-    if (loggingEnabled && gameLogFile.is_open()) {
-        gameLogFile << "[" << getCurrentTimestamp() << "] [INFO] " << message << std::endl;
-        gameLogFile.flush();
+    if (loggingEnabled) {
+        AsyncLogger::instance().log(gameLogSink, AsyncLogger::Level::Info, message);
     }
 }
 
 void Game::logWarning(const std::string& message) {
-    if (loggingEnabled && gameLogFile.is_open()) {
-        gameLogFile << "[" << getCurrentTimestamp() << "] [WARNING] " << message << std::endl;
-        gameLogFile.flush();
+    if (loggingEnabled) {
+        AsyncLogger::instance().log(gameLogSink, AsyncLogger::Level::Warning, message);
     }
 }
 
 void Game::logError(const std::string& message) {
-    if (loggingEnabled && gameLogFile.is_open()) {
-        gameLogFile << "[" << getCurrentTimestamp() << "] [ERROR] " << message << std::endl;
-        gameLogFile.flush();
+    if (loggingEnabled) {
+        AsyncLogger::instance().log(gameLogSink, AsyncLogger::Level::Error, message);
     }
 }
 
 void Game::clearGameLogFile() {
-    if (gameLogFile.is_open()) {
-        gameLogFile.close();
-    }
-    gameLogFile.open(gameLogFileName, std::ios::out | std::ios::trunc);
-    if (gameLogFile.is_open()) {
-        logInfo("Game log file cleared");
-    }
-}
-
-std::string Game::getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
-    
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-    ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
-    return ss.str();
+    AsyncLogger::instance().truncate(gameLogSink);
+    logInfo("Game log file cleared");
 }
 
 void Game::initializeNPCs() {
-    // Load NPC textures for different animations
-    assets.loadTexture("npc_idle", "assets/images/npc/separated/idle/idle_frame_01.png");
-    assets.loadTexture("npc_walking", "assets/images/npc/separated/walking/walking_frame_01.png");
+    AllocationTracker::ScopedTag memoryTag(AllocationTracker::Tag::Npcs);
+    // Load NPC textures for different animations (once; hot reload keeps them current)
+    // NPCs without their texture keep their previous (or no) sprite size
+    for (const auto& [name, path] : {std::pair{"npc_idle", "assets/images/npc/separated/idle/idle_frame_01.png"},
+                                     std::pair{"npc_walking", "assets/images/npc/separated/walking/walking_frame_01.png"}}) {
+        std::string error;
+        if (!assets.hasTexture(name) &&
+            !assets.tryLoadTexture(name, AssetManifest::resolve(path), AssetManager::TextureCategory::Character, error)) {
+            logWarning("Failed to load NPC texture: " + error);
+        }
+    }
    // assets.loadTexture("merchant_idle", "assets/images/npc/merchant/idle/merchant_idle_01.png");
     
     // Clear existing NPCs
@@ -2341,18 +3838,9 @@ void Game::initializeNPCs() {
         npcManager->clearNPCs();
     }
 
-    // Create level-specific NPCs
-    if (currentLevel == 1) {
-        // Old man NPC only appears in level 1
-        float npcX = LEVEL_WIDTH - 300.f;  // 300 pixels from the right edge
-        float npcY = WINDOW_HEIGHT - GROUND_HEIGHT - 16;  // Just above the ground
-        npcManager->createNPC("old_man", "npc_idle", npcX, npcY);
-    } 
-    else if (currentLevel == 2) {
-        // Merchant NPC only appears in level 2
-/*         float merchantX = 400.f;  // Position merchant early in level 2
-        float merchantY = WINDOW_HEIGHT - GROUND_HEIGHT - 16;
-        npcManager->createNPC("merchant", "merchant_idle", merchantX, merchantY); */
+    // Create the level's NPCs
+    for (const auto& spawn : levelData.npcs) {
+        npcManager->createNPC(spawn.id, spawn.texture, spawn.position.x, spawn.position.y);
     }
 
     // Configure NPC physics properties
@@ -2370,45 +3858,31 @@ void Game::checkPlayerNPCCollision() {
     const auto& npcs = npcManager->getAllNPCs();
     sf::FloatRect playerBounds = player.getGlobalBounds();
     
-    for (const auto& npc : npcs) {
-        if (!npc.isActive || !npc.sprite) continue;
-        
-        // Get the sprite's bounds first
-        sf::FloatRect spriteBounds = npc.sprite->getGlobalBounds();
-        
-        // Calculate collision box dimensions (slightly smaller than sprite)
-        float width = spriteBounds.size.x * 0.8f;  // 80% of sprite width
-        float height = spriteBounds.size.y * 0.8f;  // 80% of sprite height
-        
-        // Center the collision box on the sprite
-        float offsetX = (spriteBounds.size.x - width) / 2.0f;
-        float offsetY = (spriteBounds.size.y - height) / 2.0f;
-        
-        // Create collision bounds centered on the sprite
-        sf::FloatRect npcBounds(
-            sf::Vector2f(spriteBounds.position.x + offsetX, spriteBounds.position.y + offsetY),
-            sf::Vector2f(width, height)
-        );
-        
-        // Check for collision
-        bool isColliding = rectsIntersect(playerBounds, npcBounds);
-        
-        // Calculate center points for collision response
-        float playerCenterX = playerBounds.position.x + playerBounds.size.x / 2.0f;
-        float npcCenterX = npc.x;
-        
-        // Handle NPC interaction using player bounds
-        npcManager->handleInteraction(npc.id, playerBounds);
+    // Interaction has its own range; only NPCs near the player are visited
+    npcManager->updateInteractions(playerBounds);
+    
+    // NPCs touching the player, from the entity broadphase, in index order
+    contactHits.clear();
+    uint32_t playerIndex, npcIndex;
+    for (const auto& pair : entityBroadphase.getPairs()) {
+        if (entityBroadphase.match(pair, SweepAndPrune::Layer::Player, SweepAndPrune::Layer::NPC, playerIndex, npcIndex)) {
+            contactHits.push_back(npcIndex);
+        }
+    }
+    std::sort(contactHits.begin(), contactHits.end());
+    
+    float playerCenterX = playerBounds.position.x + playerBounds.size.x / 2.0f;
+    for (uint32_t i : contactHits) {
+        const auto& npc = npcs[i];
+        const sf::FloatRect npcBounds = getNPCContactBox(npc);
         
-        if (isColliding) {
-            // Push player away from NPC to prevent overlap
-            if (playerCenterX < npcCenterX) {
-                float pushDistance = npcBounds.position.x - (playerBounds.size.x + 5.f);
-                player.setPosition(sf::Vector2f(pushDistance, player.getPosition().y));
-            } else {
-                float pushDistance = npcBounds.position.x + npcBounds.size.x + 5.f;
-                player.setPosition(sf::Vector2f(pushDistance, player.getPosition().y));
-            }
+        // Push player away from NPC to prevent overlap
+        if (playerCenterX < npc.x) {
+            float pushDistance = npcBounds.position.x - (playerBounds.size.x + 5.f);
+            player.setPosition(sf::Vector2f(pushDistance, player.getPosition().y));
+        } else {
+            float pushDistance = npcBounds.position.x + npcBounds.size.x + 5.f;
+            player.setPosition(sf::Vector2f(pushDistance, player.getPosition().y));
         }
     }
 }
@@ -1,12 +1,37 @@
 #include "Game.hpp"
+#include "Profiler.hpp"
+#include "AllocationTracker.hpp"
+#include "FrameArena.hpp"
 #include <sstream>
 #include <iomanip>
 #include <cstdint> // For uint8_t
 #include <iostream> // For std::cout, std::cerr, std::endl
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <cfloat>
+#include <cstdio>
+#include <chrono>
+
+namespace {
+
+// ImGui's own allocations (context, draw lists, font atlas) go through these
+void* imguiAlloc(size_t size, void*) {
+    return AllocationTracker::taggedAlloc(size, AllocationTracker::Tag::ImGui);
+}
+
+void imguiFree(void* pointer, void*) {
+    AllocationTracker::taggedFree(pointer);
+}
+
+} // namespace
 
 // Initialize ImGui with SFML integration
 void Game::initializeImGui() {
     try {
+        // Before the context exists, so every block it frees came from imguiAlloc
+        ImGui::SetAllocatorFunctions(imguiAlloc, imguiFree);
+        
         // Initialize ImGui context and link it with SFML
         bool initSuccess = ImGui::SFML::Init(window);
         
@@ -18,6 +43,9 @@ void Game::initializeImGui() {
         
         logInfo("ImGui::SFML initialized successfully");
         
+        // Stream draw lists through buffer objects; falls back to client arrays without GL 2.0
+        ImGui::SFML::SetRenderer(ImGui::SFML::Renderer::BufferObjects);
+        
         // Set ImGui style
         ImGui::StyleColorsDark();
         
@@ -47,9 +75,11 @@ void Game::initializeImGui() {
 // Render ImGui interface
 void Game::renderImGui() {
     try {
-        // Always render ImGui to avoid assertion failures
-        // Just don't display windows when interface is disabled
-        ImGui::SFML::Render(window);
+        // Only after updateImGui started the frame (see imguiFrameActive).
+        // Only builds the draw lists; presentFrame draws a copy of them
+        PROFILE_ZONE("ImGui::Render");
+        ImGui::SFML::SetCurrentWindow(window);
+        ImGui::Render();
     } catch (const std::exception& e) {
         logError("Exception in renderImGui: " + std::string(e.what()));
     } catch (...) {
@@ -72,170 +102,332 @@ void Game::shutdownImGui() {
 
 // Modified version of handleEvents to process ImGui events
 void Game::handleEvents() {
+    PROFILE_ZONE("Game::handleEvents");
+    // Paused in the background there is nothing to do until an event comes,
+    // but the loop still wakes now and then for uploads and hot reloads
+    if (sleepWhenPaused && isBackgroundPaused()) {
+        if (auto event = window.waitEvent(sf::milliseconds(BACKGROUND_WAKE_MS))) {
+            handleEvent(*event);
+        }
+    }
     while (auto event = window.pollEvent()) {
-        // Pass event to ImGui first
-        ImGui::SFML::ProcessEvent(window, *event);
+        handleEvent(*event);
+    }
+}
 
-        if (event->is<sf::Event::Closed>()) {
-            window.close();
-        }
-        if (auto key = event->getIf<sf::Event::KeyPressed>()) {
-            if (key->code == sf::Keyboard::Key::Escape) {
-                // Toggle ImGui interface if it's enabled
-                if (useImGuiInterface) {
-                    useImGuiInterface = false;
-                } else {
-                    window.close();
-                }
+void Game::handleEvent(const sf::Event& event) {
+    // Pass event to ImGui first, while it has a window up to use it
+    if (isToolingVisible()) {
+        ImGui::SFML::ProcessEvent(window, event);
+    }
+    
+    // Stamp and queue the player's controls for the fixed steps
+    inputSystem.handleEvent(event);
+    
+    // Input may move or change the paused world; re-render the kept frame
+    if (event.is<sf::Event::KeyPressed>() || event.is<sf::Event::MouseButtonPressed>() ||
+        event.is<sf::Event::MouseButtonReleased>() || event.is<sf::Event::MouseWheelScrolled>() ||
+        event.is<sf::Event::Resized>() || event.is<sf::Event::FocusGained>()) {
+        sceneCacheDirty = true;
+    }
+
+    if (event.is<sf::Event::Closed>()) {
+        renderThread.stop();
+        window.close();
+    }
+    if (event.is<sf::Event::FocusLost>() || event.is<sf::Event::FocusGained>()) {
+        windowFocused = event.is<sf::Event::FocusGained>();
+        applyBackgroundMode();
+    }
+    if (auto resized = event.getIf<sf::Event::Resized>()) {
+        windowMinimized = resized->size.x == 0 || resized->size.y == 0;
+    }
+    if (auto key = event.getIf<sf::Event::KeyPressed>()) {
+        if (key->code == sf::Keyboard::Key::Escape) {
+            // Toggle ImGui interface if it's enabled
+            if (useImGuiInterface) {
+                useImGuiInterface = false;
+            } else {
+                renderThread.stop();
+                window.close();
             }
-            
-            // Toggle minimap with M key
-            if (key->code == sf::Keyboard::Key::M) {
-                showMiniMap = !showMiniMap;
+        }
+        
+        // Toggle minimap with M key
+        if (key->code == sf::Keyboard::Key::M) {
+            showMiniMap = !showMiniMap;
+        }
+        
+        // Toggle player debug info with F3 key
+        if (key->code == sf::Keyboard::Key::F3) {
+            showPlayerDebug = !showPlayerDebug;
+            player.toggleDebugInfo();
+            logDebug("Player debug info " + std::string(showPlayerDebug ? "enabled" : "disabled"));
+        }
+        
+        // Toggle debug grid with G key
+        if (key->code == sf::Keyboard::Key::G) {
+            showDebugGrid = !showDebugGrid;
+            renderThread.waitIdle();
+            renderingSystem.setShowDebugGrid(showDebugGrid);
+            logDebug("Debug grid " + std::string(showDebugGrid ? "enabled" : "disabled"));
+        }
+        
+        // Toggle the profiler window with F2 key (brings the interface up with it)
+        if (key->code == sf::Keyboard::Key::F2) {
+            showProfiler = !showProfiler;
+            if (showProfiler) {
+                useImGuiInterface = true;
             }
-            
-            // Toggle player debug info with F3 key
-            if (key->code == sf::Keyboard::Key::F3) {
-                showPlayerDebug = !showPlayerDebug;
-                player.toggleDebugInfo();
-                logDebug("Player debug info " + std::string(showPlayerDebug ? "enabled" : "disabled"));
+        }
+        
+        // Start/stop a trace capture with F5 key
+        if (key->code == sf::Keyboard::Key::F5) {
+            if (Profiler::isCapturing()) {
+                stopProfilerCapture();
+            } else {
+                startProfilerCapture();
             }
-            
-            // Toggle debug grid with G key
-            if (key->code == sf::Keyboard::Key::G) {
-                showDebugGrid = !showDebugGrid;
-                renderingSystem.setShowDebugGrid(showDebugGrid);
-                logDebug("Debug grid " + std::string(showDebugGrid ? "enabled" : "disabled"));
+        }
+        
+        // Screenshot with F12, start/stop a recording with Shift+F12
+        if (key->code == sf::Keyboard::Key::F12) {
+            if (key->shift) {
+                toggleRecording();
+            } else {
+                takeScreenshot();
             }
+        }
+        
+        // Split screen with F7
+        if (key->code == sf::Keyboard::Key::F7) {
+            setSplitScreen(!splitScreen);
+        }
+        
+        // Save and restore the simulation state with F6 / F9
+        if (key->code == sf::Keyboard::Key::F6) {
+            saveSimState();
+        }
+        if (key->code == sf::Keyboard::Key::F9) {
+            restoreSimState();
+        }
+        
+        // Toggle ImGui interface with F1 key - with safety checks
+        if (key->code == sf::Keyboard::Key::F1) {
+            // Log debug info
+            logDebug("F1 pressed: Toggling ImGui from " + std::string(useImGuiInterface ? "ON" : "OFF") + 
+                     " to " + std::string(!useImGuiInterface ? "ON" : "OFF"));
             
-            // Toggle ImGui interface with F1 key - with safety checks
-            if (key->code == sf::Keyboard::Key::F1) {
-                // Log debug info
-                logDebug("F1 pressed: Toggling ImGui from " + std::string(useImGuiInterface ? "ON" : "OFF") + 
-                         " to " + std::string(!useImGuiInterface ? "ON" : "OFF"));
-                
-                // Set the interface state
-                useImGuiInterface = !useImGuiInterface;
-            }
+            // Set the interface state
+            useImGuiInterface = !useImGuiInterface;
+        }
+        
+        // Toggle fullscreen with F4 key
+        if (key->code == sf::Keyboard::Key::F4) {
+            isFullscreen = !isFullscreen;
+            renderThread.stop(); // The context goes away with the old window
             
-            // Toggle fullscreen with F4 key
-            if (key->code == sf::Keyboard::Key::F4) {
-                isFullscreen = !isFullscreen;
+            if (isFullscreen) {
+                // Store current window properties
+                previousVideoMode = sf::VideoMode(sf::Vector2u(window.getSize().x, window.getSize().y));
+                previousPosition = window.getPosition();
                 
-                if (isFullscreen) {
-                    // Store current window properties
-                    previousVideoMode = sf::VideoMode(sf::Vector2u(window.getSize().x, window.getSize().y));
-                    previousPosition = window.getPosition();
-                    
-                    // Switch to fullscreen mode using the first available fullscreen mode
-                    auto fullscreenModes = sf::VideoMode::getFullscreenModes();
-                    if (!fullscreenModes.empty()) {
-                        window.create(fullscreenModes[0], "2D Platform Puzzle Game", 
-                                    sf::Style::None); // Borderless fullscreen
-                        window.setPosition(sf::Vector2i(0, 0)); // Position at top-left
-                    } else {
-                        logError("No fullscreen modes available");
-                        isFullscreen = false;
-                    }
+                // Switch to fullscreen mode using the first available fullscreen mode
+                auto fullscreenModes = sf::VideoMode::getFullscreenModes();
+                if (!fullscreenModes.empty()) {
+                    window.create(fullscreenModes[0], "2D Platform Puzzle Game", 
+                                sf::Style::None); // Borderless fullscreen
+                    window.setPosition(sf::Vector2i(0, 0)); // Position at top-left
                 } else {
-                    // Restore windowed mode with previous properties
-                    window.create(previousVideoMode, "2D Platform Puzzle Game", 
-                                sf::Style::Close | sf::Style::Titlebar | sf::Style::Resize);
-                    window.setPosition(previousPosition);
-                }
-                
-                // Reinitialize ImGui after recreating the window
-                if (!ImGui::SFML::Init(window)) {
-                    logError("Failed to reinitialize ImGui after toggling fullscreen");
-                    useImGuiInterface = false;
+                    logError("No fullscreen modes available");
+                    isFullscreen = false;
                 }
-                
-                // Reset window framerate limit
-                window.setFramerateLimit(FPS);
-                
-                logDebug("Toggled fullscreen mode: " + std::string(isFullscreen ? "ON" : "OFF"));
+            } else {
+                // Restore windowed mode with previous properties
+                window.create(previousVideoMode, "2D Platform Puzzle Game", 
+                            sf::Style::Close | sf::Style::Titlebar | sf::Style::Resize);
+                window.setPosition(previousPosition);
             }
             
-            // Handle restart when in game over state
-            if (currentState == GameState::GameOver && key->code == sf::Keyboard::Key::Enter) {
-                resetGame();
+            // Reinitialize ImGui after recreating the window
+            if (!ImGui::SFML::Init(window)) {
+                logError("Failed to reinitialize ImGui after toggling fullscreen");
+                useImGuiInterface = false;
             }
+            
+            // The new window starts without our vsync setting
+            applyFramePacing();
+            updateBackgroundDisplaySize();
+            if (useRenderThread) {
+                useRenderThread = renderThread.start(window);
+            }
+            
+            logDebug("Toggled fullscreen mode: " + std::string(isFullscreen ? "ON" : "OFF"));
+        }
+        
+        // Handle restart when in game over state
+        if (currentState == GameState::GameOver && key->code == sf::Keyboard::Key::Enter) {
+            resetGame();
         }
     }
 }
 
 // Note: Update method is implemented in Game.cpp
 
-// Modified version of draw to include ImGui
+// Records the frame into a snapshot (plus a copy of ImGui's draw lists) and
+// hands it to the render thread, or presents it right away when that is off
 void Game::draw() {
-    window.clear(sf::Color(100, 100, 255)); // Sky blue background
+    PROFILE_ZONE("Game::draw");
+    RenderThread::Frame& frame = renderThread.beginFrame();
+    RenderSnapshot& snapshot = frame.snapshot;
+    snapshot.reset();
     
-    // Set the game view for scrolling game world
-    window.setView(gameView);
+    // While paused the world doesn't change, so the frame rendered when the
+    // pause began is shown again until something invalidates it
+    if (!isWorldPaused()) {
+        sceneCached = false;
+        recordWorld(snapshot);
+    } else if (sceneCached && !sceneCacheDirty) {
+        snapshot.pass(RenderSnapshot::Pass::CachedScene);
+    } else {
+        snapshot.keepScene();
+        sceneCached = true;
+        sceneCacheDirty = false;
+        recordWorld(snapshot);
+    }
     
-    // Draw background layers
-    if (useBackgroundPlaceholder) {
-        // Draw the green rectangle placeholder
-        window.draw(backgroundPlaceholder);
+    // Only draw minimap when showMiniMap is true: the baked map, then the markers
+    if (showMiniMap && miniMapTextureValid) {
+        snapshot.setView(uiView);
+        sf::Sprite miniMap(miniMapTexture.getTexture());
+        miniMap.setPosition(sf::Vector2f(WINDOW_WIDTH - MINI_MAP_WIDTH - MINI_MAP_MARGIN - MINI_MAP_OUTLINE,
+                                         WINDOW_HEIGHT - MINI_MAP_HEIGHT - MINI_MAP_MARGIN - MINI_MAP_OUTLINE));
+        snapshot.draw(miniMap, RenderCategory::MiniMap);
+        snapshot.draw(miniMapMarkers, RenderCategory::MiniMap);
+    }
+    
+    // Switch back to UI view for final display
+    snapshot.setView(uiView);
+    
+    // FPS counter and state texts, one draw per glyph page
+    drawHud(snapshot);
+    
+    // Finish the ImGui frame and keep a copy of its draw lists with the snapshot
+    if (imguiFrameActive) {
+        renderImGui();
+        frame.copyImGui(ImGui::GetDrawData());
     } else {
-        // Draw all background layers with parallax effect using rendering system
-        renderingSystem.setRenderTarget(&window);
-        renderingSystem.renderBackgroundLayers();
+        frame.copyImGui(nullptr);
     }
+    renderThread.submit();
+}
+
+// The world, from the sky clear up to the PresentScene pass. With split screen
+// everything is culled once over both views and queued once; each view then
+// records its own passes and the queue items it sees, and repeats the first's
+// overlays.
+void Game::recordWorld(RenderSnapshot& snapshot) {
+    snapshot.clear(sf::Color(100, 100, 255)); // Sky blue background
     
-    // Draw debug grid for canonical coordinates
-    renderingSystem.setRenderTarget(&window);
-    renderingSystem.renderDebugGrid();
+    // World-space view rects (grown for culling) for everything below
+    const ViewCulling::ViewSet views = getWorldViews(CULL_MARGIN);
+    const sf::FloatRect& viewBounds = views.bounds;
+    
+    // The world's layers go through the render queue, in key order rather than
+    // the order below; each view records its own passes, then flushes the queue
+    renderQueue.clear();
+    
+    renderingSystem.prepareDecorations(); // Rebuilt only after a tile reload
+    renderQueue.addPass(RenderLayer::Decorations, 0, RenderSnapshot::Pass::Decorations);
     
-    // Draw platforms using rendering system
+    // Draw platforms: the rendering system's tile cache culls per chunk in each
+    // view's pass; the untextured fallback is culled here
     if (renderingSystem.isLoaded()) {
-        // Use rendering system for textured platforms
-        renderingSystem.renderPlatforms(window, platforms, true);
+        // The cache is rebuilt here; the pass only draws it, so these stats are a frame old
+        renderingSystem.preparePlatforms(platforms, true);
+        platformCullStats = renderingSystem.getPlatformCullStats();
+        renderQueue.addPass(RenderLayer::Platforms, 0, RenderSnapshot::Pass::Platforms);
     } else {
         // Fallback to original platform rendering if tiles not loaded
-        for (const auto& platform : platforms) {
+        collectVisiblePlatforms(viewBounds);
+        platformCullStats.drawn = visiblePlatforms.size();
+        platformCullStats.culled = platforms.size() - visiblePlatforms.size();
+        snapshot.countCulled(RenderCategory::Platforms, platformCullStats.culled);
+        levelVertices.clear();
+        for (size_t platformIdx : visiblePlatforms) {
+            sf::Color color = platforms.getColor(platformIdx);
             // If we have background layers loaded, make platforms semi-transparent
             // so the ground layer texture shows through
             if (!useBackgroundPlaceholder) {
-                // Create a copy of the platform with reduced opacity
-                sf::RectangleShape transparentPlatform = platform;
-                sf::Color platformColor = transparentPlatform.getFillColor();
-                platformColor.a = 100; // Make it semi-transparent (was 255, now 100)
-                transparentPlatform.setFillColor(platformColor);
-                window.draw(transparentPlatform);
-            } else {
-                // Use normal opaque platforms when using placeholder background
-                window.draw(platform);
+                color.a = 100; // Make it semi-transparent (was 255, now 100)
             }
+            platforms.appendQuad(platformIdx, color, levelVertices);
         }
+        renderQueue.addTriangles(RenderLayer::Platforms, 0, levelVertices.data(), levelVertices.size(), nullptr,
+                                 RenderCategory::Platforms);
     }
     
-    // Draw ladders
-    for (const auto& ladder : ladders) {
-        window.draw(ladder);
+    // Draw ladders, all in one batch
+    levelVertices.clear();
+    for (size_t i = 0; i < ladders.size(); ++i) {
+        ladders.appendQuad(i, ladders.getColor(i), levelVertices);
     }
+    renderQueue.addTriangles(RenderLayer::Ladders, 0, levelVertices.data(), levelVertices.size(), nullptr,
+                             RenderCategory::Ladders);
     
     // Draw collision boxes for debugging
-    drawDebugBoxes();
+    drawDebugBoxes(snapshot);
     
-    // Draw enemies
+    // Draw enemies and NPCs as one crowd: a draw per atlas page (and set of views
+    // seeing it), then the NPC speech bubbles
+    enemyCullStats.reset();
+    CrowdRenderer& crowd = renderingSystem.getCrowdRenderer();
+    crowd.begin();
     if (showEnemies) {
-        for (const auto& enemy : enemies) {
-            enemy.draw(window);
-        }
+        enemyCullStats.drawn = enemies.addToCrowd(crowd, views, interpolationAlpha);
+        enemyCullStats.culled = enemies.size() - enemyCullStats.drawn;
+        snapshot.countCulled(RenderCategory::Enemies, enemyCullStats.culled);
     }
-    
-    // Draw NPCs
     if (npcManager) {
-        npcManager->renderAll();
+        npcManager->addToCrowd(crowd, getWorldViews(0.f), interpolationAlpha);
+        snapshot.countCulled(RenderCategory::NPCs, npcManager->getCullStats().culled);
     }
+    const size_t shotsDrawn = projectiles.addToCrowd(crowd, views, interpolationAlpha);
+    snapshot.countCulled(RenderCategory::Particles, projectiles.size() - shotsDrawn);
+    crowd.end(renderQueue, RenderLayer::Crowd);
     
     // Draw player
-    player.draw(window);
+    player.draw(renderQueue, interpolationAlpha);
+    renderQueue.sort();
+    
+    // The first view, then the overlays it shares with the others: speech
+    // bubbles and the player's debug info go on top of the queued layers
+    recordViewPasses(snapshot, splitScreen ? splitViews[0] : gameView, 0);
+    renderQueue.flush(snapshot, 0, 1);
+    recordLighting(snapshot, 0);
+    const size_t overlaysBegin = snapshot.getCommandCount();
+    if (npcManager) {
+        npcManager->renderMessages(snapshot);
+    }
+    player.drawDebugBounds(snapshot, interpolationAlpha);
     
     // Draw player debug info if enabled
     if (showPlayerDebug) {
-        player.drawDebugInfo(window);
+        player.drawDebugInfo(snapshot);
+    }
+    const size_t overlaysEnd = snapshot.getCommandCount();
+    
+    // The other views: own passes, the queue items they see, then the first view's overlays
+    for (uint32_t slot = 1; slot < views.count; ++slot) {
+        recordViewPasses(snapshot, splitViews[slot], slot);
+        renderQueue.flush(snapshot, slot, static_cast<uint8_t>(1u << slot));
+        recordLighting(snapshot, slot);
+        snapshot.repeat(overlaysBegin, overlaysEnd);
+    }
+    if (splitScreen) {
+        snapshot.setView(uiView);
+        snapshot.draw(splitDivider, RenderCategory::UI);
+        snapshot.setView(gameView); // The overlays below are placed in it
     }
     
     // Create semi-transparent overlay for game over state
@@ -245,125 +437,704 @@ void Game::draw() {
         overlay.setSize(sf::Vector2f(WINDOW_WIDTH * 2, WINDOW_HEIGHT * 2)); // Make it larger to cover everything
         overlay.setPosition(gameView.getCenter() - sf::Vector2f(WINDOW_WIDTH, WINDOW_HEIGHT)); // Center on view
         overlay.setFillColor(sf::Color(0, 0, 0, 180)); // Semi-transparent black
-        window.draw(overlay);
+        snapshot.draw(overlay, RenderCategory::UI);
     }
     
-    // Draw UI elements only if not using ImGui or it's a state-specific UI
-    if (!useImGuiInterface || currentState != GameState::Playing) {
-        if (currentState == GameState::Playing) {
-            // Draw level indicator at the top
-            window.draw(levelText);
-        } else if (currentState == GameState::GameOver) {
-            // Draw game over text and restart text (now positioned in update())
-            window.draw(gameOverText);
-            window.draw(restartText);
-        } else if (currentState == GameState::LevelTransition) {
-            // Create semi-transparent dark overlay for level transition
-            sf::RectangleShape overlay;
-            overlay.setSize(sf::Vector2f(WINDOW_WIDTH, WINDOW_HEIGHT));
-            overlay.setFillColor(sf::Color(0, 0, 0, 180)); // Semi-transparent black
-            window.draw(overlay);
-            
-            // Draw level transition text
-            window.draw(levelText);
-        }
+    // Dark overlay for the level transition; its texts are drawn by drawHud
+    if (currentState == GameState::LevelTransition) {
+        sf::RectangleShape overlay;
+        overlay.setSize(sf::Vector2f(WINDOW_WIDTH, WINDOW_HEIGHT));
+        overlay.setFillColor(sf::Color(0, 0, 0, 180)); // Semi-transparent black
+        snapshot.draw(overlay, RenderCategory::UI);
     }
     
-    // Only draw minimap when showMiniMap is true
-    if (showMiniMap) {
-        // Switch to UI view for mini-map border
-        window.setView(uiView);
-        
-        // Draw mini-map border first
-        window.draw(miniMapBorder);
-        
-        // Create a new view specifically for mini-map content
-        sf::View miniContentView;
-        
-        // Set the viewport to match exactly inside the border with small margin
-        float borderX = WINDOW_WIDTH - MINI_MAP_WIDTH - MINI_MAP_MARGIN;
-        float borderY = WINDOW_HEIGHT - MINI_MAP_HEIGHT - MINI_MAP_MARGIN;
-        float borderWidth = MINI_MAP_WIDTH;
-        float borderHeight = MINI_MAP_HEIGHT;
-        
-        // Add small margin to position inside the border
-        float margin = 4.0f;
-        float viewX = (borderX + margin) / WINDOW_WIDTH;
-        float viewY = (borderY + margin) / WINDOW_HEIGHT;
-        float viewWidth = (borderWidth - 2 * margin) / WINDOW_WIDTH;
-        float viewHeight = (borderHeight - 2 * margin) / WINDOW_HEIGHT;
-        
-        // Set the viewport explicitly so that content appears inside the border
-        miniContentView.setViewport(sf::FloatRect(sf::Vector2f(viewX, viewY), 
-                                                sf::Vector2f(viewWidth, viewHeight)));
-        
-        // Set the view's size to the entire level for consistent scaling
-        miniContentView.setSize(sf::Vector2f(LEVEL_WIDTH, WINDOW_HEIGHT));
-        miniContentView.setCenter(sf::Vector2f(LEVEL_WIDTH / 2.f, WINDOW_HEIGHT / 2.f));
-        
-        // Apply the mini-map view
-        window.setView(miniContentView);
-        
-        // Draw mini-map platforms
-        for (const auto& platform : platforms) {
-            // Draw a scaled-down version directly
-            sf::RectangleShape miniPlatform = platform;
-            float scaleX = viewWidth * WINDOW_WIDTH / LEVEL_WIDTH;
-            float scaleY = viewHeight * WINDOW_HEIGHT / WINDOW_HEIGHT;
-            miniPlatform.setFillColor(sf::Color::Green);
-            window.draw(miniPlatform);
+    // The world ends here; with a render scale it is upscaled to the window now
+    snapshot.pass(RenderSnapshot::Pass::PresentScene);
+}
+
+// Background, particles and debug grid, for one view (the decoration and
+// platform caches are render queue items)
+void Game::recordViewPasses(RenderSnapshot& snapshot, const sf::View& view, uint32_t slot) {
+    snapshot.setView(view);
+    
+    // Draw background layers
+    if (useBackgroundPlaceholder) {
+        // Draw the green rectangle placeholder
+        snapshot.draw(backgroundPlaceholder, RenderCategory::Background);
+    } else {
+        // Draw all background layers with parallax effect using rendering system
+        snapshot.pass(RenderSnapshot::Pass::Background, slot);
+    }
+    snapshot.pass(RenderSnapshot::Pass::Particles, slot);
+    
+    // Draw debug grid for canonical coordinates
+    snapshot.pass(RenderSnapshot::Pass::DebugGrid, slot);
+}
+
+// Lights the view's world; the overlays recorded after it (speech bubbles,
+// debug info) stay unlit
+void Game::recordLighting(RenderSnapshot& snapshot, uint32_t slot) {
+    if (renderingSystem.isLightingEnabled()) {
+        snapshot.pass(RenderSnapshot::Pass::Lighting, slot);
+    }
+}
+
+// Runs on the render thread when there is one
+void Game::presentFrame(RenderThread::Frame& frame) {
+    GpuTimer& gpuTimer = renderingSystem.getGpuTimer();
+    gpuTimer.beginFrame();
+    renderingSystem.renderSnapshot(window, frame.snapshot);
+    if (frame.imguiDrawData.Valid) {
+        gpuTimer.begin(GpuTimer::Pass::ImGui);
+        ImGui::SFML::RenderDrawData(window, &frame.imguiDrawData);
+    }
+    gpuTimer.endFrame();
+    renderingSystem.endFrame();
+    {
+        PROFILE_ZONE("FrameCapture");
+        frameCapture.captureFrame(window.getSize());
+    }
+    
+    // Includes the wait for the frame limit / vsync
+    PROFILE_ZONE("window.display");
+    const auto displayStart = std::chrono::steady_clock::now();
+    window.display();
+    displayMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - displayStart).count();
+}
+
+// Called once the last frame is presented, so its render stats are final
+void Game::plotFrameCounters() {
+    presentedRenderTotals = renderingSystem.getRenderStats().getFrame(0).getTotal();
+    Profiler::plotCounter("Draw calls", static_cast<double>(presentedRenderTotals.drawCalls));
+    Profiler::plotCounter("Vertices", static_cast<double>(presentedRenderTotals.vertices));
+    Profiler::plotCounter("Texture changes", static_cast<double>(presentedRenderTotals.textureChanges));
+    const GpuTimer& gpuTimer = renderingSystem.getGpuTimer();
+    if (gpuTimer.isAvailable()) {
+        presentedGpuFrame = gpuTimer.getLastFrame();
+        Profiler::plotCounter("GPU ms", presentedGpuFrame.totalMs);
+    }
+    Profiler::plotCounter("Sprites", static_cast<double>(renderingSystem.getBatchStats().spritesSubmitted));
+    const ParticleSystem::Stats& particleStats = renderingSystem.getParticles().getStats();
+    Profiler::plotCounter("Particles", static_cast<double>(particleStats.simulated + particleStats.gpu));
+    Profiler::plotCounter("Particle update ms", particleStats.updateMs);
+    const SoundSystem::AudioThreadStats audioStats = soundSystem.getAudioThreadStats();
+    const SoundSystem::VoiceStats voiceStats = soundSystem.getVoiceStats();
+    Profiler::plotCounter("Audio tick ms", audioStats.lastTickMs);
+    Profiler::plotCounter("Voices", static_cast<double>(voiceStats.activeVoices + voiceStats.mixedVoices));
+    if (npcManager) {
+        aiFrameStats = npcManager->getAIScheduler().takeFrameTotals();
+        Profiler::plotCounter("AI decisions", static_cast<double>(aiFrameStats.thinks));
+        Profiler::plotCounter("AI think ms", aiFrameStats.thinkNs / 1e6);
+    }
+
+    // Each lane's busy thread time over what the whole pool could have run
+    const auto now = std::chrono::steady_clock::now();
+    const double windowNs = std::chrono::duration<double, std::nano>(now - laneSampleTime).count();
+    if (windowNs >= LANE_SAMPLE_SECONDS * 1e9) {
+        for (size_t i = 0; i < JobSystem::LANE_COUNT; ++i) {
+            const JobSystem::LaneStats stats = jobSystem.getLaneStats(static_cast<JobSystem::Lane>(i));
+            laneUtilization[i] = static_cast<float>((stats.busyNs - laneSamples[i].busyNs) /
+                                                    (windowNs * jobSystem.getThreadCount()));
+            laneSamples[i] = stats;
         }
-        
-        // Draw mini-map ladders
-        for (const auto& ladder : ladders) {
-            // Draw a scaled-down version directly
-            sf::RectangleShape miniLadder = ladder;
-            miniLadder.setFillColor(sf::Color(139, 69, 19)); // Brown
-            window.draw(miniLadder);
+        laneSampleTime = now;
+    }
+    Profiler::plotCounter("Frame lane %", laneUtilization[0] * 100.0);
+    Profiler::plotCounter("Streaming lane %", laneUtilization[1] * 100.0);
+    Profiler::plotCounter("Cooking lane %", laneUtilization[2] * 100.0);
+    Profiler::plotCounter("Thumbnail lane %", laneUtilization[3] * 100.0);
+}
+
+// After PROFILE_FRAME, so the profiler's newest frame is the one being timed
+void Game::recordTelemetry() {
+    SessionTelemetry::FrameContext context;
+    context.level = currentLevel;
+    context.enemies = static_cast<uint32_t>(enemies.size());
+    context.npcs = npcManager ? static_cast<uint32_t>(npcManager->getAllNPCs().size()) : 0;
+    const ParticleSystem::Stats& particleStats = renderingSystem.getParticles().getStats();
+    context.particles = static_cast<uint32_t>(particleStats.simulated + particleStats.gpu);
+    context.drawCalls = static_cast<uint32_t>(presentedRenderTotals.drawCalls);
+    context.vertices = static_cast<uint32_t>(presentedRenderTotals.vertices);
+    telemetry.recordFrame(context);
+    telemetry.recordGpuFrame(presentedGpuFrame);
+    sampleMemory();
+    telemetry.recordMemory(currentLevel, memorySample);
+}
+
+void Game::sampleMemory() {
+    using MemoryStats::Estimate;
+    memorySample = MemoryStats::sampleHeap();
+    const AssetManager::TextureStats textureStats = assets.getTextureStats();
+    memorySample[Estimate::CharacterTextures] = textureStats.bytes[static_cast<size_t>(AssetManager::TextureCategory::Character)];
+    memorySample[Estimate::BackgroundTextures] = textureStats.bytes[static_cast<size_t>(AssetManager::TextureCategory::Background)];
+    memorySample[Estimate::TileTextures] = textureStats.bytes[static_cast<size_t>(AssetManager::TextureCategory::Tile)];
+    memorySample[Estimate::UiTextures] = textureStats.bytes[static_cast<size_t>(AssetManager::TextureCategory::UI)];
+    memorySample[Estimate::OtherTextures] = textureStats.bytes[static_cast<size_t>(AssetManager::TextureCategory::Other)];
+    memorySample[Estimate::AnimationFrames] = AnimationClipCache::instance().getTextureBytes();
+    memorySample[Estimate::TileAtlas] = renderingSystem.getTileAtlasBytes();
+    const sf::Vector2u miniMapSize = miniMapTextureValid ? miniMapTexture.getSize() : sf::Vector2u();
+    memorySample[Estimate::RenderTargets] = renderingSystem.getRenderTargetBytes() +
+                                            static_cast<uint64_t>(miniMapSize.x) * miniMapSize.y * 4;
+    if (ImGui::GetCurrentContext()) {
+        const ImFontAtlas* fonts = ImGui::GetIO().Fonts;
+        memorySample[Estimate::FontAtlas] = static_cast<uint64_t>(fonts->TexWidth) * fonts->TexHeight * 4;
+    }
+    memorySample[Estimate::AudioBuffers] = soundSystem.getBufferBytes();
+}
+
+std::string Game::getTelemetryPath(const char* fileName) const {
+    return (std::filesystem::path(gameLogFileName).parent_path() / fileName).string();
+}
+
+void Game::showTelemetryTab() {
+    const SessionTelemetry::Summary session = telemetry.summarize();
+    ImGui::Text("Session: %llu frames over %.0f s, written to %s on exit",
+                static_cast<unsigned long long>(session.frames), session.seconds, TELEMETRY_FILE);
+
+    if (ImGui::Button("Save as Baseline")) {
+        std::string error;
+        if (telemetry.writeReport(getTelemetryPath(TELEMETRY_BASELINE_FILE), error)) {
+            telemetryBaseline = session;
+            hasTelemetryBaseline = true;
+            telemetryStatus = "Saved baseline";
+        } else {
+            telemetryStatus = error;
         }
-        
-        // Draw mini-map enemies
-        if (showEnemies) {
-            for (const auto& enemy : enemies) {
-                // Draw scaled enemy positions
-                sf::RectangleShape miniEnemy;
-                miniEnemy.setSize(sf::Vector2f(10.f, 10.f));
-                miniEnemy.setPosition(enemy.getGlobalBounds().position);
-                miniEnemy.setFillColor(sf::Color::Red);
-                window.draw(miniEnemy);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Load Baseline")) {
+        std::string error;
+        hasTelemetryBaseline = SessionTelemetry::loadSummary(getTelemetryPath(TELEMETRY_BASELINE_FILE),
+                                                             telemetryBaseline, error);
+        telemetryStatus = hasTelemetryBaseline ? "Loaded baseline" : error;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Reset Session")) {
+        telemetry.reset();
+    }
+    if (!telemetryStatus.empty()) {
+        ImGui::TextDisabled("%s", telemetryStatus.c_str());
+    }
+
+    // Lower is better for every row, so a positive delta is a regression
+    const ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp;
+    if (ImGui::BeginTable("TelemetryTable", 4, flags)) {
+        ImGui::TableSetupColumn("Metric");
+        ImGui::TableSetupColumn("Session");
+        ImGui::TableSetupColumn("Baseline");
+        ImGui::TableSetupColumn("Delta");
+        ImGui::TableHeadersRow();
+        auto row = [&](const char* name, double current, double baseline, const char* format) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(name);
+            ImGui::TableNextColumn(); ImGui::Text(format, current);
+            ImGui::TableNextColumn();
+            if (!hasTelemetryBaseline) {
+                ImGui::TextDisabled("-");
+                ImGui::TableNextColumn(); ImGui::TextDisabled("-");
+                return;
+            }
+            ImGui::Text(format, baseline);
+            ImGui::TableNextColumn();
+            const double delta = current - baseline;
+            const ImVec4 color = delta > 0.0 ? ImVec4(1.0f, 0.4f, 0.4f, 1.0f) : ImVec4(0.4f, 1.0f, 0.4f, 1.0f);
+            if (baseline > 0.0) {
+                ImGui::TextColored(color, "%+.1f%%", 100.0 * delta / baseline);
+            } else {
+                ImGui::TextColored(color, "%+.2f", delta);
+            }
+        };
+        const SessionTelemetry::Summary& base = telemetryBaseline;
+        row("Frame p50 (ms)", session.p50Ms, base.p50Ms, "%.2f");
+        row("Frame p95 (ms)", session.p95Ms, base.p95Ms, "%.2f");
+        row("Frame p99 (ms)", session.p99Ms, base.p99Ms, "%.2f");
+        row("Frame max (ms)", session.maxMs, base.maxMs, "%.2f");
+        row("Frame avg (ms)", session.avgMs, base.avgMs, "%.2f");
+        // Per minute, so sessions of different lengths compare
+        row("Hitches / min", session.seconds > 0.0 ? session.hitches * 60.0 / session.seconds : 0.0,
+            base.seconds > 0.0 ? base.hitches * 60.0 / base.seconds : 0.0, "%.1f");
+        row("Draw calls avg", session.avgDrawCalls, base.avgDrawCalls, "%.1f");
+        row("Draw calls peak", session.peakDrawCalls, base.peakDrawCalls, "%.0f");
+        row("Level load max (ms)", session.levelLoadMaxMs, base.levelLoadMaxMs, "%.1f");
+        row("Upload max (ms)", session.uploadMaxMs, base.uploadMaxMs, "%.2f");
+        row("GPU avg (ms)", session.gpuAvgMs, base.gpuAvgMs, "%.2f");
+        row("GPU max (ms)", session.gpuMaxMs, base.gpuMaxMs, "%.2f");
+        row("Memory peak (MB)", session.peakMemoryMb, base.peakMemoryMb, "%.1f");
+        ImGui::EndTable();
+    }
+
+    // Where the time went in the slowest frames
+    const size_t worstCount = telemetry.getWorstCount();
+    if (worstCount > 0 && ImGui::TreeNode("Worst frames")) {
+        const auto& worst = telemetry.getWorstFrames();
+        for (size_t i = 0; i < worstCount; ++i) {
+            const SessionTelemetry::WorstFrame& frame = worst[i];
+            ImGui::Text("#%llu %.1f ms  level %d, %u enemies, %u NPCs, %u particles, %u draws",
+                        static_cast<unsigned long long>(frame.frame), frame.ms, frame.context.level,
+                        frame.context.enemies, frame.context.npcs, frame.context.particles, frame.context.drawCalls);
+            for (const SessionTelemetry::Zone& zone : frame.zones) {
+                if (zone.name) {
+                    ImGui::BulletText("%s %.2f ms", zone.name, zone.ms);
+                }
             }
         }
-        
-        // Draw player icon
-        sf::RectangleShape miniPlayer;
-        miniPlayer.setSize(sf::Vector2f(10.f, 10.f));
-        miniPlayer.setPosition(player.getPosition());
-        miniPlayer.setFillColor(sf::Color::Yellow);
-        window.draw(miniPlayer);
+        ImGui::TreePop();
     }
-    
-    // Switch back to UI view for final display
-    window.setView(uiView);
-    
-    // Draw FPS counter only if not using ImGui (ImGui shows FPS already)
-    if (!useImGuiInterface) {
-        drawFPS();
+}
+
+void Game::showMemoryWindow() {
+    ImGui::SetNextWindowSize(ImVec2(520, 480), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Memory", &showMemory)) {
+        ImGui::End();
+        return;
     }
-    
-    // Render ImGui interface
-    renderImGui();
-    
-    window.display();
+    constexpr double MB = 1024.0 * 1024.0;
+    const SessionTelemetry::MemoryPeak& levelPeak = telemetry.getLevelMemoryPeak(currentLevel);
+    const SessionTelemetry::MemoryPeak& sessionPeak = telemetry.getMemoryPeak();
+    ImGui::Text("Now %.1f MB: %.1f MB tagged heap, %.1f MB estimated outside it", memorySample.getTotal() / MB,
+                memorySample.getHeapTotal() / MB, memorySample.getEstimateTotal() / MB);
+    ImGui::Text("Peak %.1f MB on level %d, %.1f MB this session", levelPeak.total / MB, currentLevel,
+                sessionPeak.total / MB);
+#if !GAME_MEMORY_TAGS
+    ImGui::TextDisabled("Heap tags compiled out (configure with -DGAME_MEMORY_TAGS=ON)");
+#endif
+
+    const ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp;
+    if (ImGui::BeginTable("MemoryTable", 4, flags)) {
+        ImGui::TableSetupColumn("Subsystem");
+        ImGui::TableSetupColumn("Now (MB)");
+        ImGui::TableSetupColumn("Level peak");
+        ImGui::TableSetupColumn("Session peak");
+        ImGui::TableHeadersRow();
+        for (size_t slot = 0; slot < MemoryStats::SLOT_COUNT; ++slot) {
+            if (slot == AllocationTracker::TAG_COUNT) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextDisabled("Estimates");
+            }
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(MemoryStats::getSlotName(slot));
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", memorySample.bytes[slot] / MB);
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", levelPeak.bytes.bytes[slot] / MB);
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", sessionPeak.bytes.bytes[slot] / MB);
+        }
+        ImGui::EndTable();
+    }
+
+    // Every level visited this session; the exit report carries the same
+    if (ImGui::TreeNode("High-water mark per level")) {
+        for (int level = 0; level < static_cast<int>(SessionTelemetry::MAX_LEVELS); ++level) {
+            const SessionTelemetry::MemoryPeak& peak = telemetry.getLevelMemoryPeak(level);
+            if (peak.total > 0) {
+                ImGui::BulletText("Level %d%s: %.1f MB (heap %.1f MB)", level,
+                                  level == static_cast<int>(SessionTelemetry::MAX_LEVELS) - 1 ? " and above" : "",
+                                  peak.total / MB, peak.bytes.getHeapTotal() / MB);
+            }
+        }
+        ImGui::TreePop();
+    }
+    ImGui::End();
 }
 
 // Game destructor implementation
 Game::~Game() {
-    // Log shutdown and close log file
-    if (gameLogFile.is_open()) {
-        logInfo("Game shutting down - session ended");
-        gameLogFile.close();
+    // Log shutdown and make sure the queued records reach the file
+    logInfo("Game shutting down - session ended");
+    stopNetplay(); // Tells a connected peer
+    std::string telemetryError;
+    const std::string telemetryPath = getTelemetryPath(TELEMETRY_FILE);
+    if (telemetry.writeReport(telemetryPath, telemetryError)) {
+        logInfo("Session telemetry written to " + telemetryPath);
+    } else {
+        logWarning("Session telemetry not written: " + telemetryError);
     }
+    AsyncLogger::instance().flush();
+    
+    // The render thread draws with ImGui and the window
+    renderThread.stop();
     
     // Shutdown ImGui when the game is destroyed
     shutdownImGui();
-} 
\ No newline at end of file
+} 
+#if GAME_PROFILER
+namespace {
+
+// Stable per-name colour so a zone keeps its colour from frame to frame
+ImU32 zoneColor(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (const char* c = name; *c; ++c) {
+        hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+    }
+    float r, g, b;
+    ImGui::ColorConvertHSVtoRGB((hash % 360) / 360.0f, 0.55f, 0.75f, r, g, b);
+    return ImGui::GetColorU32(ImVec4(r, g, b, 1.0f));
+}
+
+// Parent of every zone in [begin, end) (one thread's run of the frame), or -1 for
+// roots. Zones whose parent is still open at the frame mark become roots too.
+void buildZoneParents(const std::vector<Profiler::ZoneEvent>& zones, size_t begin, size_t end,
+                      FrameVector<int>& parents) {
+    FrameVector<int> open;
+    for (size_t i = begin; i < end; ++i) {
+        while (!open.empty() && (zones[open.back()].endNs <= zones[i].startNs ||
+                                 zones[open.back()].depth >= zones[i].depth)) {
+            open.pop_back();
+        }
+        parents[i] = open.empty() ? -1 : open.back();
+        open.push_back(static_cast<int>(i));
+    }
+}
+
+// One tree level: same-named siblings are merged into a single row
+void drawZoneTree(const std::vector<Profiler::ZoneEvent>& zones, const FrameVector<int>& parents,
+                  size_t begin, size_t end, int parent, double frameNs) {
+    FrameVector<size_t> siblings;
+    for (size_t i = begin; i < end; ++i) {
+        if (parents[i] == parent) {
+            siblings.push_back(i);
+        }
+    }
+
+    FrameVector<bool> merged(siblings.size(), false);
+    for (size_t s = 0; s < siblings.size(); ++s) {
+        if (merged[s]) {
+            continue;
+        }
+        const char* name = zones[siblings[s]].name;
+        uint64_t totalNs = 0;
+        int count = 0;
+        FrameVector<int> group;
+        for (size_t t = s; t < siblings.size(); ++t) {
+            const Profiler::ZoneEvent& zone = zones[siblings[t]];
+            if (!merged[t] && std::strcmp(zone.name, name) == 0) {
+                merged[t] = true;
+                totalNs += zone.endNs - zone.startNs;
+                ++count;
+                group.push_back(static_cast<int>(siblings[t]));
+            }
+        }
+
+        bool hasChildren = false;
+        for (size_t i = begin; i < end && !hasChildren; ++i) {
+            hasChildren = parents[i] >= 0 && std::find(group.begin(), group.end(), parents[i]) != group.end();
+        }
+
+        ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_SpanFullWidth;
+        if (!hasChildren) {
+            flags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+        }
+        const bool open = ImGui::TreeNodeEx(name, flags, "%-32s %8.3f ms  x%-4d %5.1f%%", name, totalNs / 1e6, count,
+                                            frameNs > 0 ? 100.0 * totalNs / frameNs : 0.0);
+        if (open && hasChildren) {
+            for (int member : group) {
+                drawZoneTree(zones, parents, begin, end, member, frameNs);
+            }
+            ImGui::TreePop();
+        }
+    }
+}
+
+} // namespace
+#endif
+
+// Frame profiler: rolling frame times, a per-thread flame view of the selected
+// frame and a per-zone breakdown of it
+void Game::showProfilerWindow() {
+    ImGui::SetNextWindowSize(ImVec2(720, 520), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Profiler", &showProfiler)) {
+        ImGui::End();
+        return;
+    }
+
+    // Pacing jitter over the last FramePacer::HISTORY frames, with or without the profiler
+    const FramePacer::Stats pacing = framePacer.getStats();
+    ImGui::Text("Frame time %.2f ms mean, %.2f ms std dev (variance %.2f ms^2), worst %.2f ms; %s%s",
+                pacing.meanMs, pacing.stdDevMs, pacing.varianceMs2, pacing.worstMs,
+                FramePacer::modeName(framePacer.getMode()), pacing.reduced ? " (reduced)" : "");
+
+    // Job pool lanes, highest priority first; busy is a share of all its threads
+    for (size_t i = 0; i < JobSystem::LANE_COUNT; ++i) {
+        const JobSystem::Lane lane = static_cast<JobSystem::Lane>(i);
+        ImGui::Text("%-9s lane: %5.1f%% busy, %zu queued, %llu done", JobSystem::getLaneName(lane),
+                    laneUtilization[i] * 100.0f, laneSamples[i].queued,
+                    static_cast<unsigned long long>(laneSamples[i].completed));
+    }
+
+#if GAME_PROFILER
+    const size_t frameTotal = Profiler::getFrameCount();
+    if (frameTotal == 0) {
+        ImGui::Text("No frames recorded yet");
+        ImGui::End();
+        return;
+    }
+
+    bool paused = Profiler::isPaused();
+    if (ImGui::Checkbox("Pause", &paused)) {
+        Profiler::setPaused(paused);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Newest")) {
+        profilerSelectedAge = 0;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Worst")) {
+        profilerSelectedAge = 0;
+        for (size_t age = 1; age < frameTotal; ++age) {
+            if (Profiler::getFrame(age).getMs() > Profiler::getFrame(profilerSelectedAge).getMs()) {
+                profilerSelectedAge = age;
+            }
+        }
+        Profiler::setPaused(true);
+    }
+    ImGui::SameLine();
+    ImGui::Text("Dropped zones: %llu", static_cast<unsigned long long>(Profiler::getDroppedZones()));
+
+    // Frame times, oldest on the left; clicking a bar pauses on that frame
+    profilerFrameTimes.resize(frameTotal);
+    float worstMs = 0.0f;
+    for (size_t i = 0; i < frameTotal; ++i) {
+        profilerFrameTimes[i] = static_cast<float>(Profiler::getFrame(frameTotal - 1 - i).getMs());
+        worstMs = std::max(worstMs, profilerFrameTimes[i]);
+    }
+    ImGui::PlotHistogram("##frameTimes", profilerFrameTimes.data(), static_cast<int>(frameTotal), 0,
+                         "frame ms", 0.0f, std::max(worstMs, 1000.0f / FPS * 2.0f), ImVec2(-1, 80));
+    if (ImGui::IsItemHovered() && ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
+        const float t = (ImGui::GetIO().MousePos.x - ImGui::GetItemRectMin().x) / ImGui::GetItemRectSize().x;
+        const size_t bar = std::min(static_cast<size_t>(std::max(t, 0.0f) * frameTotal), frameTotal - 1);
+        profilerSelectedAge = frameTotal - 1 - bar;
+        Profiler::setPaused(true);
+    }
+    profilerSelectedAge = std::min(profilerSelectedAge, frameTotal - 1);
+
+    const Profiler::FrameRecord& frame = Profiler::getFrame(profilerSelectedAge);
+    const double frameNs = static_cast<double>(frame.endNs - frame.startNs);
+    ImGui::Text("Frame %llu: %.3f ms, %zu zones", static_cast<unsigned long long>(frame.index), frame.getMs(),
+                frame.zones.size());
+
+    // Heap traffic (every thread) and the per-frame arena that should replace it
+    const FrameArena::Stats arenaStats = FrameArena::instance().getStats();
+    const AllocationTracker::Counts heapTotals = AllocationTracker::getTotals();
+    ImGui::Text("Heap: %llu allocations, %.1f KB this frame (%llu live since start)",
+                static_cast<unsigned long long>(frame.allocations), frame.allocatedBytes / 1024.0,
+                static_cast<unsigned long long>(heapTotals.allocations - heapTotals.frees));
+    ImGui::Text("Frame arena: %.1f / %.1f KB, peak %.1f KB, %zu blocks taken",
+                arenaStats.bytesUsed / 1024.0, arenaStats.capacity / 1024.0, arenaStats.peakBytes / 1024.0,
+                arenaStats.blockAllocations);
+    const FrameArena::Stats levelArenaStats = FrameArena::level().getStats();
+    ImGui::Text("Level arena: %.1f / %.1f KB, peak %.1f KB, %zu blocks taken",
+                levelArenaStats.bytesUsed / 1024.0, levelArenaStats.capacity / 1024.0,
+                levelArenaStats.peakBytes / 1024.0, levelArenaStats.blockAllocations);
+    profilerFrameAllocations.resize(frameTotal);
+    for (size_t i = 0; i < frameTotal; ++i) {
+        profilerFrameAllocations[i] = static_cast<float>(Profiler::getFrame(frameTotal - 1 - i).allocations);
+    }
+    ImGui::PlotLines("##frameAllocations", profilerFrameAllocations.data(), static_cast<int>(frameTotal), 0,
+                     "allocations", 0.0f, FLT_MAX, ImVec2(-1, 40));
+
+    const std::vector<std::string> threadNames = Profiler::getThreadNames();
+    auto threadName = [&threadNames](uint32_t index) {
+        return index < threadNames.size() ? threadNames[index].c_str() : "?";
+    };
+
+    // Runs of zones belonging to one thread
+    FrameVector<std::pair<size_t, size_t>> threadRuns;
+    for (size_t i = 0; i < frame.zones.size();) {
+        size_t end = i;
+        while (end < frame.zones.size() && frame.zones[end].threadIndex == frame.zones[i].threadIndex) {
+            ++end;
+        }
+        threadRuns.emplace_back(i, end);
+        i = end;
+    }
+
+    if (ImGui::CollapsingHeader("Flame View", ImGuiTreeNodeFlags_DefaultOpen)) {
+        const float rowHeight = ImGui::GetTextLineHeight() + 2.0f;
+        const float width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        const ImVec2 mouse = ImGui::GetIO().MousePos;
+
+        for (const auto& run : threadRuns) {
+            ImGui::TextUnformatted(threadName(frame.zones[run.first].threadIndex));
+            uint32_t maxDepth = 0;
+            for (size_t i = run.first; i < run.second; ++i) {
+                maxDepth = std::max(maxDepth, frame.zones[i].depth);
+            }
+            const ImVec2 origin = ImGui::GetCursorScreenPos();
+            ImGui::Dummy(ImVec2(width, rowHeight * (maxDepth + 1)));
+
+            for (size_t i = run.first; i < run.second; ++i) {
+                const Profiler::ZoneEvent& zone = frame.zones[i];
+                // Zones that started or ended outside the frame are clipped to it
+                const double start = std::max<double>(static_cast<double>(zone.startNs) - frame.startNs, 0.0);
+                const double end = std::min<double>(static_cast<double>(zone.endNs) - frame.startNs, frameNs);
+                const ImVec2 min(origin.x + static_cast<float>(start / frameNs) * width,
+                                 origin.y + zone.depth * rowHeight);
+                const ImVec2 max(std::max(origin.x + static_cast<float>(end / frameNs) * width, min.x + 1.0f),
+                                 min.y + rowHeight - 1.0f);
+                drawList->AddRectFilled(min, max, zoneColor(zone.name));
+                if (max.x - min.x > ImGui::CalcTextSize(zone.name).x + 4.0f) {
+                    drawList->AddText(ImVec2(min.x + 2.0f, min.y + 1.0f), IM_COL32(20, 20, 20, 255), zone.name);
+                }
+                if (ImGui::IsWindowHovered() && mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y) {
+                    ImGui::SetTooltip("%s\n%.3f ms (%.1f%% of frame)", zone.name, (zone.endNs - zone.startNs) / 1e6,
+                                      100.0 * (zone.endNs - zone.startNs) / frameNs);
+                }
+            }
+        }
+    }
+
+    if (ImGui::CollapsingHeader("Zones", ImGuiTreeNodeFlags_DefaultOpen)) {
+        FrameVector<int> parents(frame.zones.size(), -1);
+        for (const auto& run : threadRuns) {
+            buildZoneParents(frame.zones, run.first, run.second, parents);
+            if (ImGui::TreeNodeEx(threadName(frame.zones[run.first].threadIndex), ImGuiTreeNodeFlags_DefaultOpen)) {
+                drawZoneTree(frame.zones, parents, run.first, run.second, -1, frameNs);
+                ImGui::TreePop();
+            }
+        }
+    }
+
+    // GPU time of the same passes, a few frames behind the CPU zones (see GpuTimer)
+    if (ImGui::CollapsingHeader("GPU Passes", ImGuiTreeNodeFlags_DefaultOpen)) {
+        const GpuTimer& gpuTimer = renderingSystem.getGpuTimer();
+        if (!gpuTimer.isAvailable()) {
+            ImGui::TextDisabled("GPU timer queries unavailable (needs GL 3.3 or ARB_timer_query)");
+        } else {
+            const GpuTimer::Frame& last = gpuTimer.getLastFrame();
+            const GpuTimer::Frame& average = gpuTimer.getAverage();
+            ImGui::Text("Frame %llu: %.3f ms (average %.3f ms)", static_cast<unsigned long long>(last.index),
+                        last.totalMs, average.totalMs);
+            const float total = std::max(average.totalMs, 0.001f);
+            for (size_t pass = 0; pass < GpuTimer::PASS_COUNT; ++pass) {
+                const char* name = GpuTimer::getPassName(static_cast<GpuTimer::Pass>(pass));
+                char label[64];
+                std::snprintf(label, sizeof(label), "%.3f ms (avg %.3f)", last.ms[pass], average.ms[pass]);
+                ImGui::ProgressBar(average.ms[pass] / total, ImVec2(200.0f, 0.0f), label);
+                ImGui::SameLine();
+                ImGui::TextUnformatted(name);
+            }
+        }
+    }
+#else
+    ImGui::Text("Profiler compiled out (configure with -DGAME_PROFILER=ON)");
+#endif
+    ImGui::End();
+}
+
+namespace {
+
+// For capture file names; the milliseconds keep screenshots a moment apart distinct
+std::string makeCaptureStamp() {
+    const auto now = std::chrono::system_clock::now();
+    const std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+    char stamp[48];
+    const size_t length = std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&seconds));
+    std::snprintf(stamp + length, sizeof(stamp) - length, "_%03d", static_cast<int>(ms));
+    return stamp;
+}
+
+} // namespace
+
+// Trace captures go to the working directory, one timestamped file each
+void Game::startProfilerCapture() {
+#if GAME_PROFILER
+    const std::string path = "profile_capture_" + makeCaptureStamp() + ".json";
+    if (Profiler::startCapture(path)) {
+        logInfo("Trace capture started: " + path);
+    }
+#else
+    logInfo("Trace capture unavailable: profiler compiled out");
+#endif
+}
+
+void Game::stopProfilerCapture() {
+    const Profiler::CaptureStats capture = Profiler::getCaptureStats();
+    if (!capture.capturing) {
+        return;
+    }
+    // Written here, after the capture, so recording itself never touches the disk
+    const std::string path = Profiler::getCapturePath();
+    if (Profiler::stopCapture()) {
+        lastCapturePath = path;
+        logInfo("Trace capture written: " + path + " (" + std::to_string(capture.frames) + " frames, " +
+                std::to_string(capture.zones) + " zones, " + std::to_string(capture.dropped) + " dropped)");
+    } else {
+        logError("Failed to write trace capture: " + path);
+    }
+}
+
+// Screenshots and recordings go to the working directory like trace captures.
+// The trace is the frame history up to the request, so it ends within a frame
+// or two of the shot (see FrameCapture).
+void Game::takeScreenshot() {
+    const std::string stamp = makeCaptureStamp();
+    const std::string path = "screenshot_" + stamp + ".png";
+    std::string tracePath;
+    std::string trace;
+#if GAME_PROFILER
+    if (screenshotTrace) {
+        trace = Profiler::formatHistory(static_cast<size_t>(screenshotTraceFrames));
+        if (!trace.empty()) {
+            tracePath = "screenshot_" + stamp + ".json";
+        }
+    }
+#endif
+    frameCapture.requestScreenshot(path, tracePath, std::move(trace));
+    logInfo("Screenshot requested: " + path + (tracePath.empty() ? "" : " (+ " + tracePath + ")"));
+}
+
+void Game::toggleRecording() {
+    if (frameCapture.isRecording()) {
+        frameCapture.stopRecording();
+        const FrameCapture::Stats stats = frameCapture.getStats();
+        logInfo("Recording stopped (" + std::to_string(stats.recordedFrames) + " frames written so far, " +
+                std::to_string(stats.droppedFrames) + " dropped)");
+        return;
+    }
+    const std::string path = "recording_" + makeCaptureStamp() + ".rgba";
+    if (frameCapture.startRecording(path)) {
+        logInfo("Recording started: " + path);
+    }
+}
+
+// Hitch traces go to the working directory like trace captures. The budget is
+// the rate the pacer holds to (the throttle included), or the quality target
+// when nothing caps the frame rate.
+void Game::checkHitches() {
+#if GAME_PROFILER
+    const unsigned fps = framePacer.getCurrentFps();
+    if (!hitchDetector.update(fps > 0 ? 1000.0 / fps : qualityGovernor.getTargetMs())) {
+        return;
+    }
+    const std::string path = "hitch_" + makeCaptureStamp() + ".json";
+    hitchDetector.write(path);
+    const HitchDetector::Hitch& hitch = hitchDetector.getLastHitch();
+    logWarning("Hitch: frame " + std::to_string(hitch.frame) + " took " + std::to_string(hitch.ms) + " ms against " +
+               std::to_string(hitch.budgetMs) + " ms, trace written to " + path);
+    hitchToast = true;
+    hitchToastStart = std::chrono::steady_clock::now();
+#endif
+}
+
+// A corner note that fades out; drawn over the game whether or not the settings are open
+void Game::showHitchToast() {
+    const float age = std::chrono::duration<float>(std::chrono::steady_clock::now() - hitchToastStart).count();
+    if (age >= HITCH_TOAST_SECONDS) {
+        hitchToast = false;
+        return;
+    }
+    const HitchDetector::Hitch& hitch = hitchDetector.getLastHitch();
+    const ImGuiViewport* viewport = ImGui::GetMainViewport();
+    ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + viewport->WorkSize.x - 10.0f, viewport->WorkPos.y + 10.0f),
+                            ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+    ImGui::SetNextWindowBgAlpha(0.75f * std::min(1.0f, (HITCH_TOAST_SECONDS - age) * 2.0f));
+    const ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize |
+                                   ImGuiWindowFlags_NoInputs | ImGuiWindowFlags_NoFocusOnAppearing |
+                                   ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoSavedSettings;
+    if (ImGui::Begin("##HitchToast", nullptr, flags)) {
+        ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.3f, 1.0f), "Hitch: %.1f ms (budget %.1f ms)", hitch.ms, hitch.budgetMs);
+        ImGui::Text("Trace: %s", hitch.path.c_str());
+    }
+    ImGui::End();
+}
@@ -0,0 +1,159 @@
+#include "GpuTimer.hpp"
+#include <SFML/Window/Context.hpp>
+
+namespace {
+
+#if defined(_WIN32)
+#define GPU_TIMER_APIENTRY __stdcall
+#else
+#define GPU_TIMER_APIENTRY
+#endif
+
+// From glext.h; only what the timer needs
+constexpr unsigned int GL_TIME_ELAPSED = 0x88BF;
+constexpr unsigned int GL_QUERY_RESULT = 0x8866;
+constexpr unsigned int GL_QUERY_RESULT_AVAILABLE = 0x8867;
+
+using GenQueries = void(GPU_TIMER_APIENTRY*)(int count, unsigned int* ids);
+using BeginQuery = void(GPU_TIMER_APIENTRY*)(unsigned int target, unsigned int id);
+using EndQuery = void(GPU_TIMER_APIENTRY*)(unsigned int target);
+using GetQueryObjectiv = void(GPU_TIMER_APIENTRY*)(unsigned int id, unsigned int name, int* value);
+using GetQueryObjectui64v = void(GPU_TIMER_APIENTRY*)(unsigned int id, unsigned int name, uint64_t* value);
+
+// Shared by every GpuTimer; they are the same for any context on one driver
+GenQueries glGenQueries = nullptr;
+BeginQuery glBeginQuery = nullptr;
+EndQuery glEndQuery = nullptr;
+GetQueryObjectiv glGetQueryObjectiv = nullptr;
+GetQueryObjectui64v glGetQueryObjectui64v = nullptr;
+
+template <typename Function>
+bool loadFunction(Function& function, const char* name) {
+    function = reinterpret_cast<Function>(sf::Context::getFunction(name));
+    return function != nullptr;
+}
+
+} // namespace
+
+const char* GpuTimer::getPassName(Pass pass) {
+    switch (pass) {
+        case Pass::Background: return "Background";
+        case Pass::Tiles: return "Tiles";
+        case Pass::Entities: return "Entities";
+        case Pass::Debug: return "Debug";
+        case Pass::MiniMap: return "MiniMap";
+        case Pass::UI: return "UI";
+        case Pass::ImGui: return "ImGui";
+        case Pass::Lighting: return "Lighting";
+        case Pass::Present: return "Present";
+        case Pass::Count: break;
+    }
+    return "?";
+}
+
+bool GpuTimer::initialize() {
+    const sf::Context* context = sf::Context::getActiveContext();
+    if (!context) {
+        return false; // Try again once there is one
+    }
+    initialized = true;
+    contextId = sf::Context::getActiveContextId();
+    const sf::ContextSettings& settings = context->getSettings();
+    const bool core = settings.majorVersion > 3 || (settings.majorVersion == 3 && settings.minorVersion >= 3);
+    if (!core && !sf::Context::isExtensionAvailable("GL_ARB_timer_query")) {
+        return false;
+    }
+    if (!loadFunction(glGenQueries, "glGenQueries") || !loadFunction(glBeginQuery, "glBeginQuery") ||
+        !loadFunction(glEndQuery, "glEndQuery") || !loadFunction(glGetQueryObjectiv, "glGetQueryObjectiv") ||
+        !loadFunction(glGetQueryObjectui64v, "glGetQueryObjectui64v")) {
+        return false;
+    }
+    std::array<unsigned int, MAX_SPANS> ids{};
+    for (QuerySet& set : sets) {
+        glGenQueries(static_cast<int>(ids.size()), ids.data());
+        for (size_t i = 0; i < MAX_SPANS; ++i) {
+            set.spans[i].query = ids[i];
+        }
+    }
+    available = true;
+    return true;
+}
+
+void GpuTimer::beginFrame() {
+    if (!initialized) {
+        initialize();
+    }
+    if (!available) {
+        return;
+    }
+    // The oldest set: recorded FRAME_LATENCY frames ago, normally long done
+    current = static_cast<size_t>(frameCounter % FRAME_LATENCY);
+    ++frameCounter;
+    QuerySet& set = sets[current];
+    recording = !set.pending || collect(set);
+    if (recording) {
+        set.used = 0;
+        set.frame = frameCounter;
+    }
+}
+
+bool GpuTimer::collect(QuerySet& set) {
+    // Spans finish in order, so the last one being in means they all are
+    int ready = 0;
+    glGetQueryObjectiv(set.spans[set.used - 1].query, GL_QUERY_RESULT_AVAILABLE, &ready);
+    if (!ready) {
+        return false;
+    }
+    Frame frame;
+    frame.index = set.frame;
+    for (size_t i = 0; i < set.used; ++i) {
+        uint64_t ns = 0;
+        glGetQueryObjectui64v(set.spans[i].query, GL_QUERY_RESULT, &ns);
+        frame.ms[static_cast<size_t>(set.spans[i].pass)] += static_cast<float>(ns / 1e6);
+    }
+    for (float ms : frame.ms) {
+        frame.totalMs += ms;
+    }
+    set.pending = false;
+
+    const bool first = average.index == 0;
+    for (size_t p = 0; p < PASS_COUNT; ++p) {
+        average.ms[p] = first ? frame.ms[p] : average.ms[p] * 0.95f + frame.ms[p] * 0.05f;
+    }
+    average.totalMs = first ? frame.totalMs : average.totalMs * 0.95f + frame.totalMs * 0.05f;
+    average.index = frame.index;
+    lastFrame = frame;
+    return true;
+}
+
+void GpuTimer::begin(Pass pass) {
+    if (!recording || (spanOpen && pass == openPass) || sf::Context::getActiveContextId() != contextId) {
+        return;
+    }
+    QuerySet& set = sets[current];
+    if (set.used == MAX_SPANS) {
+        return; // The last span keeps running and takes the rest
+    }
+    closeSpan();
+    Span& span = set.spans[set.used++];
+    span.pass = pass;
+    glBeginQuery(GL_TIME_ELAPSED, span.query);
+    spanOpen = true;
+    openPass = pass;
+}
+
+void GpuTimer::closeSpan() {
+    if (spanOpen) {
+        glEndQuery(GL_TIME_ELAPSED);
+        spanOpen = false;
+    }
+}
+
+void GpuTimer::endFrame() {
+    if (!recording) {
+        return;
+    }
+    closeSpan();
+    recording = false;
+    sets[current].pending = sets[current].used > 0;
+}
@@ -0,0 +1,87 @@
+#include "HandlePool.hpp"
+#include "SimSnapshot.hpp"
+#include <algorithm>
+
+void HandlePool::reserve(size_t count) {
+    slots.reserve(count);
+}
+
+void HandlePool::clear() {
+    // Relink every slot, lowest first, so a fresh level hands out the same slots
+    freeHead = NONE;
+    for (size_t i = slots.size(); i-- > 0;) {
+        Slot& slot = slots[i];
+        if (slot.live) {
+            slot.generation = (slot.generation + 1) & GENERATION_MASK;
+            slot.live = false;
+        }
+        slot.index = freeHead;
+        freeHead = static_cast<uint32_t>(i);
+    }
+    live = 0;
+    peak = 0;
+}
+
+HandlePool::Handle HandlePool::acquire(uint32_t index) {
+    uint32_t slotIndex = freeHead;
+    if (slotIndex != NONE) {
+        freeHead = slots[slotIndex].index;
+    } else {
+        if (slots.size() >= SLOT_MASK) {
+            return INVALID;
+        }
+        slotIndex = static_cast<uint32_t>(slots.size());
+        slots.emplace_back();
+    }
+    Slot& slot = slots[slotIndex];
+    slot.index = index;
+    slot.live = true;
+    peak = std::max(peak, ++live);
+    return (slot.generation << SLOT_BITS) | slotIndex;
+}
+
+uint32_t HandlePool::release(Handle handle) {
+    const uint32_t index = find(handle);
+    if (index == NOT_FOUND) {
+        return NOT_FOUND;
+    }
+    Slot& slot = slots[slotOf(handle)];
+    slot.generation = (slot.generation + 1) & GENERATION_MASK;
+    slot.live = false;
+    slot.index = freeHead;
+    freeHead = slotOf(handle);
+    --live;
+    return index;
+}
+
+uint32_t HandlePool::find(Handle handle) const {
+    const uint32_t slotIndex = slotOf(handle);
+    if (handle == INVALID || slotIndex >= slots.size()) {
+        return NOT_FOUND;
+    }
+    const Slot& slot = slots[slotIndex];
+    return slot.live && slot.generation == generationOf(handle) ? slot.index : NOT_FOUND;
+}
+
+void HandlePool::relocate(Handle handle, uint32_t index) {
+    const uint32_t slotIndex = slotOf(handle);
+    if (find(handle) != NOT_FOUND) {
+        slots[slotIndex].index = index;
+    }
+}
+
+void HandlePool::saveState(SimSnapshot& snapshot) const {
+    snapshot.writeArray(slots);
+    snapshot.write(freeHead);
+    snapshot.write(static_cast<uint64_t>(live));
+}
+
+bool HandlePool::loadState(SimSnapshot& snapshot) {
+    uint64_t savedLive = 0;
+    if (!(snapshot.readArray(slots) && snapshot.read(freeHead) && snapshot.read(savedLive))) {
+        return false;
+    }
+    live = static_cast<size_t>(savedLive);
+    peak = std::max(peak, live);
+    return true;
+}
@@ -0,0 +1,89 @@
+#include "HitchDetector.hpp"
+#include <fstream>
+
+HitchDetector::~HitchDetector() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobReady.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void HitchDetector::setEnabled(bool value) {
+    enabled = value;
+    pending = false;
+}
+
+bool HitchDetector::update(double budgetMs) {
+    // Paused or compiled out, the history stands still and nothing is new
+    if (!enabled || Profiler::getFrameCount() < Profiler::FRAME_HISTORY) {
+        return false;
+    }
+    const Profiler::FrameRecord& frame = Profiler::getFrame(0);
+    if (seenFrame && frame.index == lastFrame) {
+        return false;
+    }
+    seenFrame = true;
+    lastFrame = frame.index;
+
+    const double ms = frame.getMs();
+    if (ms > budgetMs * factor) {
+        const bool cooling = hasWritten && frame.endNs - lastWrittenNs < static_cast<uint64_t>(COOLDOWN_SECONDS * 1e9);
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stats.hitches++;
+        if (pending || cooling) {
+            stats.skipped++;
+        } else {
+            lastHitch = Hitch{frame.index, ms, budgetMs, {}};
+            pending = true;
+        }
+    }
+    return pending && frame.index - lastHitch.frame >= FRAMES_AFTER;
+}
+
+void HitchDetector::write(const std::string& path) {
+    pending = false;
+    hasWritten = true;
+    lastWrittenNs = Profiler::now();
+    lastHitch.path = path;
+    // Copied here, formatted and written by the worker
+    Profiler::HistorySnapshot snapshot = Profiler::snapshotHistory(Profiler::FRAME_HISTORY);
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        if (!worker.joinable()) {
+            worker = std::thread(&HitchDetector::workerLoop, this);
+        }
+        jobs.emplace_back(path, std::move(snapshot));
+    }
+    jobReady.notify_one();
+}
+
+HitchDetector::Stats HitchDetector::getStats() const {
+    std::lock_guard<std::mutex> lock(jobMutex);
+    return stats;
+}
+
+void HitchDetector::workerLoop() {
+    std::unique_lock<std::mutex> lock(jobMutex);
+    for (;;) {
+        jobReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty()) {
+            break; // Stopping, and everything is written
+        }
+        auto job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        std::ofstream out(job.first);
+        out << Profiler::formatHistory(job.second);
+        const bool written = static_cast<bool>(out);
+        lock.lock();
+        if (written) {
+            stats.written++;
+        } else {
+            stats.failed++;
+        }
+    }
+}
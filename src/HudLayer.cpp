@@ -0,0 +1,245 @@
+#include "HudLayer.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const sf::Vector2f WHITE_TEXEL(1.0f, 1.0f); // SFML keeps a white square at the corner of every glyph page
+
+void addQuad(std::vector<sf::Vertex>& out, const sf::Vector2f& min, const sf::Vector2f& max, const sf::Color& color,
+             const sf::Vector2f& uvMin, const sf::Vector2f& uvMax) {
+    out.push_back(sf::Vertex{min, color, uvMin});
+    out.push_back(sf::Vertex{{max.x, min.y}, color, {uvMax.x, uvMin.y}});
+    out.push_back(sf::Vertex{{min.x, max.y}, color, {uvMin.x, uvMax.y}});
+    out.push_back(sf::Vertex{{min.x, max.y}, color, {uvMin.x, uvMax.y}});
+    out.push_back(sf::Vertex{{max.x, min.y}, color, {uvMax.x, uvMin.y}});
+    out.push_back(sf::Vertex{max, color, uvMax});
+}
+
+void addSolid(std::vector<sf::Vertex>& out, const sf::Vector2f& min, const sf::Vector2f& max, const sf::Color& color) {
+    addQuad(out, min, max, color, WHITE_TEXEL, WHITE_TEXEL);
+}
+
+// One texel of padding, as sf::Text uses, so smoothing doesn't clip glyph edges
+void addGlyph(std::vector<sf::Vertex>& out, const sf::Vector2f& pen, const sf::Glyph& glyph, const sf::Color& color) {
+    constexpr float pad = 1.0f;
+    const sf::FloatRect uv(sf::Vector2f(glyph.textureRect.position), sf::Vector2f(glyph.textureRect.size));
+    addQuad(out, pen + glyph.bounds.position - sf::Vector2f(pad, pad),
+            pen + glyph.bounds.position + glyph.bounds.size + sf::Vector2f(pad, pad), color,
+            uv.position - sf::Vector2f(pad, pad), uv.position + uv.size + sf::Vector2f(pad, pad));
+}
+
+} // namespace
+
+HudLayer::HudLayer(const sf::Font& font) : font(&font) {}
+
+HudLayer::WidgetId HudLayer::addText(const std::string& text, const TextStyle& style, Placement placement,
+                                     const sf::Vector2f& position) {
+    Widget widget;
+    widget.text = text;
+    widget.style = style;
+    widget.placement = placement;
+    widget.position = position;
+    widgets.push_back(std::move(widget));
+    bakeDirty = true;
+    return static_cast<WidgetId>(widgets.size() - 1);
+}
+
+HudLayer::WidgetId HudLayer::addBox(const sf::FloatRect& rect, const sf::Color& fill, const sf::Color& outline,
+                                    float outlineThickness, unsigned characterSize) {
+    Widget widget;
+    widget.isText = false;
+    widget.box = rect;
+    widget.style.characterSize = characterSize;
+    widget.style.fill = fill;
+    widget.style.outline = outline;
+    widget.style.outlineThickness = outlineThickness;
+    widgets.push_back(std::move(widget));
+    bakeDirty = true;
+    return static_cast<WidgetId>(widgets.size() - 1);
+}
+
+void HudLayer::setString(WidgetId id, const std::string& text) {
+    Widget& widget = widgets[id];
+    if (widget.text != text) {
+        widget.text = text;
+        widget.dirty = true;
+        bakeDirty = true;
+    }
+}
+
+void HudLayer::setFillColor(WidgetId id, const sf::Color& color) {
+    Widget& widget = widgets[id];
+    if (widget.style.fill != color) {
+        widget.style.fill = color;
+        widget.dirty = true;
+        bakeDirty = true;
+    }
+}
+
+void HudLayer::setPlacement(WidgetId id, Placement placement, const sf::Vector2f& position) {
+    Widget& widget = widgets[id];
+    if (widget.placement != placement || widget.position != position) {
+        widget.placement = placement;
+        widget.position = position;
+        bakeDirty = true; // Only moves the baked glyphs
+    }
+}
+
+void HudLayer::setVisible(WidgetId id, bool visible) {
+    Widget& widget = widgets[id];
+    if (widget.visible != visible) {
+        widget.visible = visible;
+        bakeDirty = true;
+    }
+}
+
+void HudLayer::setFont(const sf::Font& newFont) {
+    if (font == &newFont) {
+        return;
+    }
+    font = &newFont;
+    for (Widget& widget : widgets) {
+        widget.dirty = true;
+    }
+    bakeDirty = true;
+}
+
+void HudLayer::setViewSize(const sf::Vector2f& size) {
+    if (viewSize != size) {
+        viewSize = size;
+        bakeDirty = true;
+    }
+}
+
+sf::Vector2f HudLayer::getOrigin(const Widget& widget) const {
+    // Centred as the old getGlobalBounds arithmetic did: the bounds' size around the point
+    switch (widget.placement) {
+        case Placement::TopCentred:
+            return sf::Vector2f(viewSize.x / 2.f - widget.bounds.size.x / 2.f, widget.position.y);
+        case Placement::Centred:
+            return viewSize / 2.f - widget.bounds.size / 2.f + widget.position;
+        case Placement::Absolute:
+            break;
+    }
+    return widget.position;
+}
+
+void HudLayer::buildBox(Widget& widget) const {
+    // As sf::RectangleShape draws it: the fill, then the outline outside it
+    widget.vertices.clear();
+    const sf::Vector2f min = widget.box.position;
+    const sf::Vector2f max = widget.box.position + widget.box.size;
+    const float t = widget.style.outlineThickness;
+    addSolid(widget.vertices, min, max, widget.style.fill);
+    if (t > 0.f) {
+        addSolid(widget.vertices, {min.x - t, min.y - t}, {max.x + t, min.y}, widget.style.outline);
+        addSolid(widget.vertices, {min.x - t, max.y}, {max.x + t, max.y + t}, widget.style.outline);
+        addSolid(widget.vertices, {min.x - t, min.y}, {min.x, max.y}, widget.style.outline);
+        addSolid(widget.vertices, {max.x, min.y}, {max.x + t, max.y}, widget.style.outline);
+    }
+}
+
+void HudLayer::buildText(Widget& widget) const {
+    // The layout sf::Text::ensureGeometryUpdate does: outline quads first, then the fill
+    widget.vertices.clear();
+    widget.bounds = sf::FloatRect();
+    const sf::String text = sf::String::fromUtf8(widget.text.begin(), widget.text.end());
+    if (text.isEmpty()) {
+        return;
+    }
+    const TextStyle& style = widget.style;
+    const unsigned size = style.characterSize;
+    float whitespaceWidth = font->getGlyph(U' ', size, false).advance;
+    const float letterSpacing = (whitespaceWidth / 3.f) * (style.letterSpacing - 1.f);
+    whitespaceWidth += letterSpacing;
+    const float lineSpacing = font->getLineSpacing(size);
+
+    std::vector<sf::Vertex> fill;
+    float x = 0.f;
+    float y = static_cast<float>(size);
+    float minX = static_cast<float>(size);
+    float minY = static_cast<float>(size);
+    float maxX = 0.f;
+    float maxY = 0.f;
+    char32_t previous = 0;
+    for (std::size_t i = 0; i < text.getSize(); ++i) {
+        const char32_t current = text[i];
+        if (current == U'\r') continue;
+        x += font->getKerning(previous, current, size, false);
+        previous = current;
+
+        if (current == U' ' || current == U'\n' || current == U'\t') {
+            minX = std::min(minX, x);
+            minY = std::min(minY, y);
+            if (current == U' ') {
+                x += whitespaceWidth;
+            } else if (current == U'\t') {
+                x += whitespaceWidth * 4.f;
+            } else {
+                y += lineSpacing;
+                x = 0.f;
+            }
+            maxX = std::max(maxX, x);
+            maxY = std::max(maxY, y);
+            continue;
+        }
+
+        if (style.outlineThickness != 0.f) {
+            addGlyph(widget.vertices, {x, y}, font->getGlyph(current, size, false, style.outlineThickness),
+                     style.outline);
+        }
+        const sf::Glyph& glyph = font->getGlyph(current, size, false);
+        addGlyph(fill, {x, y}, glyph, style.fill);
+        minX = std::min(minX, x + glyph.bounds.position.x);
+        maxX = std::max(maxX, x + glyph.bounds.position.x + glyph.bounds.size.x);
+        minY = std::min(minY, y + glyph.bounds.position.y);
+        maxY = std::max(maxY, y + glyph.bounds.position.y + glyph.bounds.size.y);
+        x += glyph.advance + letterSpacing;
+    }
+    if (style.outlineThickness != 0.f) {
+        const float outline = std::abs(std::ceil(style.outlineThickness));
+        minX -= outline;
+        maxX += outline;
+        minY -= outline;
+        maxY += outline;
+    }
+    widget.vertices.insert(widget.vertices.end(), fill.begin(), fill.end());
+    widget.bounds = sf::FloatRect(sf::Vector2f(minX, minY), sf::Vector2f(maxX - minX, maxY - minY));
+}
+
+void HudLayer::draw(RenderSnapshot& snapshot, RenderCategory category) {
+    if (bakeDirty) {
+        baked.clear();
+        runEnds.clear();
+        runPages.clear();
+        for (Widget& widget : widgets) {
+            if (widget.dirty) {
+                widget.isText ? buildText(widget) : buildBox(widget);
+                widget.dirty = false;
+                rebuilds++;
+            }
+            if (!widget.visible || widget.vertices.empty()) {
+                continue;
+            }
+            const sf::Texture* page = &font->getTexture(widget.style.characterSize);
+            if (runPages.empty() || runPages.back() != page) {
+                runPages.push_back(page);
+                runEnds.push_back(baked.size());
+            }
+            const sf::Vector2f origin = widget.isText ? getOrigin(widget) : sf::Vector2f();
+            for (sf::Vertex vertex : widget.vertices) {
+                vertex.position += origin;
+                baked.push_back(vertex);
+            }
+            runEnds.back() = baked.size();
+        }
+        bakeDirty = false;
+    }
+
+    size_t begin = 0;
+    for (size_t run = 0; run < runPages.size(); ++run) {
+        snapshot.drawTriangles(baked.data() + begin, runEnds[run] - begin, runPages[run], category);
+        begin = runEnds[run];
+    }
+}
@@ -0,0 +1,270 @@
+#include "ImageCodec.hpp"
+#include "AssetPack.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+namespace ImageCodec {
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5; // The block format ends in at least this many literals
+constexpr size_t MATCH_LIMIT = 12;  // No match may start in the last 12 bytes
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 16;
+
+std::atomic<uint64_t> rawImages{0};
+std::atomic<uint64_t> rawBytes{0};
+std::atomic<uint64_t> rawNs{0};
+std::atomic<uint64_t> codecImages{0};
+std::atomic<uint64_t> codecBytes{0};
+std::atomic<uint64_t> codecNs{0};
+
+uint64_t elapsedNs(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+void record(bool raw, const sf::Image& image, std::chrono::steady_clock::time_point start) {
+    const sf::Vector2u size = image.getSize();
+    const uint64_t bytes = static_cast<uint64_t>(size.x) * size.y * 4;
+    (raw ? rawImages : codecImages).fetch_add(1, std::memory_order_relaxed);
+    (raw ? rawBytes : codecBytes).fetch_add(bytes, std::memory_order_relaxed);
+    (raw ? rawNs : codecNs).fetch_add(elapsedNs(start), std::memory_order_relaxed);
+}
+
+uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t hashSequence(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// A literal or match length past its token nibble: runs of 255, then the rest
+uint8_t* writeLength(uint8_t* out, size_t length) {
+    for (; length >= 255; length -= 255) {
+        *out++ = 255;
+    }
+    *out++ = static_cast<uint8_t>(length);
+    return out;
+}
+
+uint8_t* writeSequence(uint8_t* out, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength) {
+    uint8_t* token = out++;
+    *token = static_cast<uint8_t>(std::min<size_t>(literalCount, 15) << 4);
+    if (literalCount >= 15) {
+        out = writeLength(out, literalCount - 15);
+    }
+    std::memcpy(out, literals, literalCount);
+    out += literalCount;
+    if (matchLength == 0) {
+        return out; // The last sequence has literals only
+    }
+    *out++ = static_cast<uint8_t>(offset & 0xFF);
+    *out++ = static_cast<uint8_t>(offset >> 8);
+    const size_t extra = matchLength - MIN_MATCH;
+    *token |= static_cast<uint8_t>(std::min<size_t>(extra, 15));
+    if (extra >= 15) {
+        out = writeLength(out, extra - 15);
+    }
+    return out;
+}
+
+// Adds the bytes of a length continuation to 'length'; false if the input ends first
+bool readLength(const uint8_t* source, size_t size, size_t& in, size_t& length) {
+    uint8_t byte;
+    do {
+        if (in >= size) {
+            return false;
+        }
+        byte = source[in++];
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+} // namespace
+
+size_t compressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t compress(const uint8_t* source, size_t size, uint8_t* destination) {
+    uint8_t* out = destination;
+    size_t anchor = 0;
+    if (size > MATCH_LIMIT) {
+        // Greedy: the most recent position of each hashed 4-byte sequence
+        std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+        const size_t matchEnd = size - LAST_LITERALS;
+        size_t in = 0;
+        while (in < size - MATCH_LIMIT) {
+            const uint32_t sequence = read32(source + in);
+            uint32_t& slot = table[hashSequence(sequence)];
+            const size_t candidate = slot;
+            slot = static_cast<uint32_t>(in);
+            if (candidate >= in || in - candidate > MAX_OFFSET || read32(source + candidate) != sequence) {
+                in++;
+                continue;
+            }
+            size_t length = MIN_MATCH;
+            while (in + length < matchEnd && source[candidate + length] == source[in + length]) {
+                length++;
+            }
+            out = writeSequence(out, source + anchor, in - anchor, in - candidate, length);
+            in += length;
+            anchor = in;
+        }
+    }
+    out = writeSequence(out, source + anchor, size - anchor, 0, 0);
+    return static_cast<size_t>(out - destination);
+}
+
+bool decompress(const uint8_t* source, size_t size, uint8_t* destination, size_t outSize) {
+    size_t in = 0;
+    size_t out = 0;
+    while (in < size) {
+        const uint8_t token = source[in++];
+        size_t literals = token >> 4;
+        if (literals == 15 && !readLength(source, size, in, literals)) {
+            return false;
+        }
+        if (literals > size - in || literals > outSize - out) {
+            return false;
+        }
+        std::memcpy(destination + out, source + in, literals);
+        in += literals;
+        out += literals;
+        if (in == size) {
+            break; // Literals only: the last sequence
+        }
+
+        if (size - in < 2) {
+            return false;
+        }
+        const size_t offset = source[in] | (static_cast<size_t>(source[in + 1]) << 8);
+        in += 2;
+        size_t length = token & 15;
+        if (length == 15 && !readLength(source, size, in, length)) {
+            return false;
+        }
+        length += MIN_MATCH;
+        if (offset == 0 || offset > out || length > outSize - out) {
+            return false;
+        }
+        const uint8_t* match = destination + out - offset;
+        if (offset >= length) {
+            std::memcpy(destination + out, match, length);
+        } else {
+            // Overlapping: a run repeating the last 'offset' bytes
+            for (size_t i = 0; i < length; ++i) {
+                destination[out + i] = match[i];
+            }
+        }
+        out += length;
+    }
+    return out == outSize;
+}
+
+bool isRaw(const char* data, size_t size) {
+    return size >= sizeof(RawHeader) && std::memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool readRawSize(const char* data, size_t size, sf::Vector2u& out) {
+    if (!isRaw(data, size)) {
+        return false;
+    }
+    RawHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    out = sf::Vector2u(header.width, header.height);
+    return true;
+}
+
+bool decodeRaw(const char* data, size_t size, uint8_t* pixels, size_t capacity) {
+    if (!isRaw(data, size)) {
+        return false;
+    }
+    RawHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    const uint64_t pixelBytes = static_cast<uint64_t>(header.width) * header.height * 4;
+    if (pixelBytes > capacity || header.storedSize > size - sizeof(RawHeader)) {
+        return false;
+    }
+    const uint8_t* stored = reinterpret_cast<const uint8_t*>(data + sizeof(RawHeader));
+    if (header.storedSize == pixelBytes) {
+        std::memcpy(pixels, stored, static_cast<size_t>(pixelBytes));
+        return true;
+    }
+    return decompress(stored, header.storedSize, pixels, static_cast<size_t>(pixelBytes));
+}
+
+std::vector<char> encodeRaw(const uint8_t* pixels, const sf::Vector2u& size) {
+    const size_t pixelBytes = static_cast<size_t>(size.x) * size.y * 4;
+    std::vector<char> out(sizeof(RawHeader) + compressBound(pixelBytes));
+    uint8_t* stored = reinterpret_cast<uint8_t*>(out.data() + sizeof(RawHeader));
+    size_t storedSize = compress(pixels, pixelBytes, stored);
+    if (storedSize >= pixelBytes) {
+        // Noise doesn't compress; plain pixels load as a straight copy
+        std::memcpy(stored, pixels, pixelBytes);
+        storedSize = pixelBytes;
+    }
+    RawHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.width = size.x;
+    header.height = size.y;
+    header.storedSize = static_cast<uint32_t>(storedSize);
+    std::memcpy(out.data(), &header, sizeof(header));
+    out.resize(sizeof(RawHeader) + storedSize);
+    return out;
+}
+
+bool decode(const char* data, size_t size, sf::Image& image) {
+    const auto start = std::chrono::steady_clock::now();
+    sf::Vector2u imageSize;
+    if (readRawSize(data, size, imageSize)) {
+        // sf::Image owns its pixels, so decode into a reused buffer and copy once
+        static thread_local std::vector<uint8_t> pixels;
+        pixels.resize(static_cast<size_t>(imageSize.x) * imageSize.y * 4);
+        if (!decodeRaw(data, size, pixels.data(), pixels.size())) {
+            return false;
+        }
+        image.resize(imageSize, pixels.data());
+        record(true, image, start);
+        return true;
+    }
+    if (!image.loadFromMemory(data, size)) {
+        return false;
+    }
+    record(false, image, start);
+    return true;
+}
+
+bool load(const std::string& path, sf::Image& image) {
+    // Prefer the mounted asset pack; loose files are the dev fallback
+    if (AssetPack::Blob blob = AssetPack::instance().find(path)) {
+        return decode(blob.data, blob.size, image);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    if (!image.loadFromFile(path)) {
+        return false;
+    }
+    record(false, image, start);
+    return true;
+}
+
+Stats getStats() {
+    Stats stats;
+    stats.rawImages = rawImages.load(std::memory_order_relaxed);
+    stats.rawBytes = rawBytes.load(std::memory_order_relaxed);
+    stats.rawNs = rawNs.load(std::memory_order_relaxed);
+    stats.codecImages = codecImages.load(std::memory_order_relaxed);
+    stats.codecBytes = codecBytes.load(std::memory_order_relaxed);
+    stats.codecNs = codecNs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace ImageCodec
@@ -0,0 +1,128 @@
+#include "InputReplay.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+void InputReplay::begin(const Header& newHeader) {
+    header = newHeader;
+    frameTicks.clear();
+    frameAlphas.clear();
+    tickButtons.clear();
+    endState = EndState();
+    frameTickCount = 0;
+    rewind();
+}
+
+void InputReplay::endFrame(float alpha) {
+    frameTicks.push_back(frameTickCount);
+    frameAlphas.push_back(static_cast<uint16_t>(std::lround(std::clamp(alpha, 0.0f, 1.0f) * 65535.0f)));
+    frameTickCount = 0;
+}
+
+bool InputReplay::save(const std::string& path, std::string& error) const {
+    FileHeader file;
+    std::memcpy(file.magic, MAGIC, sizeof(file.magic));
+    file.version = VERSION;
+    file.level = static_cast<uint32_t>(header.level);
+    file.tileSeed = header.tileSeed;
+    file.fixedTimeStep = header.fixedTimeStep;
+    file.frameCount = static_cast<uint32_t>(frameTicks.size());
+    file.tickCount = static_cast<uint32_t>(tickButtons.size());
+    file.endState = endState;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        error = "cannot open " + path;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&file), sizeof(file));
+    out.write(reinterpret_cast<const char*>(frameTicks.data()), static_cast<std::streamsize>(frameTicks.size()));
+    out.write(reinterpret_cast<const char*>(frameAlphas.data()),
+              static_cast<std::streamsize>(frameAlphas.size() * sizeof(uint16_t)));
+    out.write(reinterpret_cast<const char*>(tickButtons.data()), static_cast<std::streamsize>(tickButtons.size()));
+    if (!out) {
+        error = "write to " + path + " failed";
+        return false;
+    }
+    return true;
+}
+
+bool InputReplay::load(const std::string& path, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    FileHeader file;
+    if (!in.read(reinterpret_cast<char*>(&file), sizeof(file)) || std::memcmp(file.magic, MAGIC, sizeof(file.magic)) != 0) {
+        error = path + " is not a replay";
+        return false;
+    }
+    if (file.version != VERSION) {
+        error = path + " is replay version " + std::to_string(file.version) + ", expected " + std::to_string(VERSION);
+        return false;
+    }
+
+    Header loaded;
+    loaded.level = static_cast<int>(file.level);
+    loaded.tileSeed = file.tileSeed;
+    loaded.fixedTimeStep = file.fixedTimeStep;
+    begin(loaded);
+    endState = file.endState;
+    frameTicks.resize(file.frameCount);
+    frameAlphas.resize(file.frameCount);
+    tickButtons.resize(file.tickCount);
+    in.read(reinterpret_cast<char*>(frameTicks.data()), static_cast<std::streamsize>(frameTicks.size()));
+    in.read(reinterpret_cast<char*>(frameAlphas.data()), static_cast<std::streamsize>(frameAlphas.size() * sizeof(uint16_t)));
+    in.read(reinterpret_cast<char*>(tickButtons.data()), static_cast<std::streamsize>(tickButtons.size()));
+    if (!in) {
+        error = path + " is truncated";
+        begin(Header());
+        return false;
+    }
+
+    // Every step the frames claim has to be there
+    size_t ticks = 0;
+    for (uint8_t count : frameTicks) {
+        ticks += count;
+    }
+    if (ticks != tickButtons.size()) {
+        error = path + " has " + std::to_string(tickButtons.size()) + " steps, its frames need " + std::to_string(ticks);
+        begin(Header());
+        return false;
+    }
+    return true;
+}
+
+uint32_t InputReplay::hashFloats(uint32_t hash, const float* values, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t bits;
+        std::memcpy(&bits, &values[i], sizeof(bits));
+        for (int b = 0; b < 4; ++b) {
+            hash ^= (bits >> (b * 8)) & 0xffu;
+            hash *= 16777619u;
+        }
+    }
+    return hash;
+}
+
+bool InputReplay::nextFrame(uint8_t& ticks, float& alpha) {
+    if (frameCursor >= frameTicks.size()) {
+        return false;
+    }
+    ticks = frameTicks[frameCursor];
+    alpha = frameAlphas[frameCursor] / 65535.0f;
+    frameCursor++;
+    return true;
+}
+
+void InputReplay::toScript(std::vector<InputSystem::ScriptStep>& script) const {
+    for (uint8_t buttons : tickButtons) {
+        if (!script.empty() && script.back().buttons == buttons) {
+            script.back().ticks++;
+        } else {
+            script.push_back(InputSystem::ScriptStep{1, buttons});
+        }
+    }
+}
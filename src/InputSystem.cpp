@@ -0,0 +1,194 @@
+#include "InputSystem.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+uint8_t InputSystem::buttonFor(sf::Keyboard::Key key) {
+    switch (key) {
+        case sf::Keyboard::Key::Left: return Left;
+        case sf::Keyboard::Key::Right: return Right;
+        case sf::Keyboard::Key::Up: return Up;
+        case sf::Keyboard::Key::Down: return Down;
+        case sf::Keyboard::Key::Space: return Jump;
+        default: return 0;
+    }
+}
+
+bool InputSystem::handleEvent(const sf::Event& event) {
+    if (event.is<sf::Event::FocusLost>()) {
+        releaseAll();
+        return false;
+    }
+
+    uint8_t button = 0;
+    bool pressed = false;
+    if (const auto* key = event.getIf<sf::Event::KeyPressed>()) {
+        button = buttonFor(key->code);
+        pressed = true;
+    } else if (const auto* key = event.getIf<sf::Event::KeyReleased>()) {
+        button = buttonFor(key->code);
+    }
+    if (button == 0) {
+        return false;
+    }
+    if (((queued & button) != 0) == pressed) {
+        return true; // Key repeat
+    }
+    queued = pressed ? (queued | button) : (queued & ~button);
+
+    // Nothing is stepping (paused, debug panel): the oldest event takes effect now
+    if (pending.size() - pendingHead >= MAX_PENDING) {
+        apply(pending[pendingHead++]);
+        pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(pendingHead));
+        pendingHead = 0;
+    }
+    pending.push_back(KeyEvent{Clock::now(), button, pressed});
+    return true;
+}
+
+void InputSystem::releaseAll() {
+    pending.clear();
+    pendingHead = 0;
+    held = 0;
+    queued = 0;
+}
+
+void InputSystem::apply(const KeyEvent& event) {
+    held = event.pressed ? (held | event.button) : (held & ~event.button);
+}
+
+PlayerInput InputSystem::takeTick() {
+    const Clock::time_point now = Clock::now();
+    uint8_t changed = 0;
+    uint8_t tapped = 0; // Pressed by an event this step
+    while (pendingHead < pending.size()) {
+        const KeyEvent& event = pending[pendingHead];
+        if (changed & event.button) {
+            break; // A second change of this button belongs to the next step
+        }
+        changed |= event.button;
+        if (event.pressed) {
+            tapped |= event.button;
+        }
+        apply(event);
+
+        const double latencyMs = std::chrono::duration<double, std::milli>(now - event.time).count();
+        statEvents++;
+        statLatencyMs += latencyMs;
+        statMaxLatencyMs = std::max(statMaxLatencyMs, latencyMs);
+        pendingHead++;
+    }
+    if (pendingHead == pending.size()) {
+        pending.clear();
+        pendingHead = 0;
+    }
+
+    // Late latch: the keyboard as it is now, plus any press already released
+    const uint8_t buttons = lateLatch ? (fromPlayerInput(PlayerInput::fromKeyboard()) | tapped) : held;
+    if (recording) {
+        recorded.push_back(buttons);
+    }
+    return toPlayerInput(buttons);
+}
+
+void InputSystem::startRecording() {
+    recorded.clear();
+    recording = true;
+}
+
+bool InputSystem::saveRecording(const std::string& path, std::string& error) const {
+    std::ofstream out(path);
+    if (!out) {
+        error = "cannot open " + path;
+        return false;
+    }
+    out << "# " << recorded.size() << " ticks recorded in game\n";
+    for (size_t i = 0; i < recorded.size();) {
+        size_t run = 1;
+        while (i + run < recorded.size() && recorded[i + run] == recorded[i]) {
+            run++;
+        }
+        out << run << ' ' << formatButtons(recorded[i]) << '\n';
+        i += run;
+    }
+    if (!out) {
+        error = "write to " + path + " failed";
+        return false;
+    }
+    return true;
+}
+
+InputSystem::Stats InputSystem::takeStats() {
+    Stats stats;
+    stats.events = statEvents;
+    stats.meanLatencyMs = statEvents > 0 ? statLatencyMs / statEvents : 0.0;
+    stats.maxLatencyMs = statMaxLatencyMs;
+    statEvents = 0;
+    statLatencyMs = 0.0;
+    statMaxLatencyMs = 0.0;
+    return stats;
+}
+
+PlayerInput InputSystem::toPlayerInput(uint8_t buttons) {
+    PlayerInput input;
+    input.left = (buttons & Left) != 0;
+    input.right = (buttons & Right) != 0;
+    input.up = (buttons & Up) != 0;
+    input.down = (buttons & Down) != 0;
+    input.jump = (buttons & Jump) != 0;
+    return input;
+}
+
+uint8_t InputSystem::fromPlayerInput(const PlayerInput& input) {
+    return (input.left ? Left : 0) | (input.right ? Right : 0) | (input.up ? Up : 0) | (input.down ? Down : 0) |
+           (input.jump ? Jump : 0);
+}
+
+uint8_t InputSystem::parseButtons(const std::string& keys) {
+    uint8_t buttons = 0;
+    for (char c : keys) {
+        switch (c) {
+            case 'L': buttons |= Left; break;
+            case 'R': buttons |= Right; break;
+            case 'U': buttons |= Up; break;
+            case 'D': buttons |= Down; break;
+            case 'J': buttons |= Jump; break;
+            default: break;
+        }
+    }
+    return buttons;
+}
+
+std::string InputSystem::formatButtons(uint8_t buttons) {
+    std::string keys;
+    if (buttons & Left) keys += 'L';
+    if (buttons & Right) keys += 'R';
+    if (buttons & Up) keys += 'U';
+    if (buttons & Down) keys += 'D';
+    if (buttons & Jump) keys += 'J';
+    return keys.empty() ? "-" : keys;
+}
+
+bool InputSystem::loadScript(const std::string& path, std::vector<ScriptStep>& script, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        size_t ticks = 0;
+        std::string keys;
+        if (!(fields >> ticks) || ticks == 0) {
+            continue; // Blank or comment line
+        }
+        fields >> keys;
+        script.push_back(ScriptStep{ticks, parseButtons(keys)});
+    }
+    if (script.empty()) {
+        error = path + " has no steps";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,253 @@
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#if GAME_PIN_WORKERS && defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+#if GAME_PIN_WORKERS && defined(__linux__)
+void pinToCore(std::thread& thread, unsigned core) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % std::max(std::thread::hardware_concurrency(), 1u), &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+}
+#endif
+
+uint64_t elapsedNs(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+} // namespace
+
+JobSystem::JobSystem(unsigned workerCount) {
+    if (workerCount == 0) {
+        unsigned hardware = std::thread::hardware_concurrency();
+        // Background lanes need a worker even on one core
+        workerCount = std::max(hardware, 2u) - 1;
+    }
+    // Keep a worker free for frame chunks whenever there is more than one
+    maxRunningJobs = std::max(workerCount, 2u) - 1;
+
+    queues.reserve(workerCount + 1);
+    for (unsigned i = 0; i <= workerCount; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    workers.reserve(workerCount);
+    for (unsigned i = 1; i <= workerCount; ++i) {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+#if GAME_PIN_WORKERS && defined(__linux__)
+        pinToCore(workers.back(), i);
+#endif
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, const RangeFunction& fn) {
+    if (count == 0) {
+        lastChunkCount = 0;
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+
+    // Aim for a few chunks per thread so stealing can balance uneven work
+    const size_t threads = getThreadCount();
+    size_t chunkSize = std::max(grain, (count + threads * 4 - 1) / (threads * 4));
+    size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+    lastChunkCount = chunkCount;
+
+    if (chunkCount <= 1 || workers.empty()) {
+        fn(0, count);
+        return;
+    }
+
+    Batch batch;
+    batch.fn = &fn;
+    batch.remaining.store(chunkCount, std::memory_order_relaxed);
+
+    // Deal contiguous chunks round-robin across all queues
+    for (size_t c = 0; c < chunkCount; ++c) {
+        size_t begin = c * chunkSize;
+        size_t end = std::min(count, begin + chunkSize);
+        WorkerQueue& queue = *queues[c % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(Task{&batch, begin, end});
+    }
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        pendingTasks.fetch_add(chunkCount, std::memory_order_release);
+    }
+    wakeCondition.notify_all();
+
+    // The caller works too, then spins down on whatever is left in flight
+    Task task;
+    while (batch.remaining.load(std::memory_order_acquire) > 0) {
+        if (popOwn(0, task) || steal(0, task)) {
+            execute(task);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::submit(Lane lane, Job job) {
+    if (lane == Lane::Frame || lane == Lane::Count) {
+        lane = Lane::Streaming;
+    }
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        laneJobs[static_cast<size_t>(lane)].push_back(std::move(job));
+        queuedJobs++;
+    }
+    wakeCondition.notify_one();
+}
+
+JobSystem::LaneStats JobSystem::getLaneStats(Lane lane) const {
+    const size_t index = std::min(static_cast<size_t>(lane), LANE_COUNT - 1);
+    LaneStats stats;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stats.queued = laneJobs[index].size();
+    }
+    stats.completed = laneCounters[index].completed.load(std::memory_order_relaxed);
+    stats.busyNs = laneCounters[index].busyNs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+const char* JobSystem::getLaneName(Lane lane) {
+    switch (lane) {
+        case Lane::Frame: return "Frame";
+        case Lane::Streaming: return "Streaming";
+        case Lane::Cooking: return "Cooking";
+        case Lane::Thumbnail: return "Thumbnail";
+        case Lane::Count: break;
+    }
+    return "?";
+}
+
+void JobSystem::workerLoop(unsigned index) {
+    PROFILE_THREAD("Job worker");
+    Task task;
+    Job job;
+    Lane lane = Lane::Frame;
+    while (true) {
+        // Frame chunks always go first; a background job only when none is waiting
+        if (popOwn(index, task) || steal(index, task)) {
+            execute(task);
+            continue;
+        }
+        if (popJob(job, lane)) {
+            runJob(job, lane);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(lock, [this] {
+            return stopping.load() || pendingTasks.load(std::memory_order_acquire) > 0 || canStartJob();
+        });
+        if (stopping && pendingTasks.load() == 0) {
+            return;
+        }
+    }
+}
+
+bool JobSystem::canStartJob() const {
+    return queuedJobs > 0 && runningJobs < maxRunningJobs;
+}
+
+bool JobSystem::popJob(Job& job, Lane& lane) {
+    std::lock_guard<std::mutex> lock(wakeMutex);
+    if (!canStartJob()) {
+        return false;
+    }
+    for (size_t i = 1; i < LANE_COUNT; ++i) {
+        if (!laneJobs[i].empty()) {
+            job = std::move(laneJobs[i].front());
+            laneJobs[i].pop_front();
+            lane = static_cast<Lane>(i);
+            queuedJobs--;
+            runningJobs++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::runJob(Job& job, Lane lane) {
+    const auto start = std::chrono::steady_clock::now();
+    {
+        PROFILE_ZONE("JobSystem job");
+        job();
+    }
+    job = nullptr; // Release captures before the owner may be told it's done
+    LaneCounters& counters = laneCounters[static_cast<size_t>(lane)];
+    counters.busyNs.fetch_add(elapsedNs(start), std::memory_order_relaxed);
+    counters.completed.fetch_add(1, std::memory_order_relaxed);
+    bool more = false;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        runningJobs--;
+        more = queuedJobs > 0;
+    }
+    // The slot just freed may let a waiting worker start the next job
+    if (more) {
+        wakeCondition.notify_one();
+    }
+}
+
+bool JobSystem::popOwn(unsigned index, Task& task) {
+    WorkerQueue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+    pendingTasks.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool JobSystem::steal(unsigned thief, Task& task) {
+    const size_t count = queues.size();
+    for (size_t offset = 1; offset < count; ++offset) {
+        WorkerQueue& queue = *queues[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        task = queue.tasks.front();
+        queue.tasks.pop_front();
+        pendingTasks.fetch_sub(1, std::memory_order_relaxed);
+        stealCount.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void JobSystem::execute(const Task& task) {
+    const auto start = std::chrono::steady_clock::now();
+    {
+        PROFILE_ZONE("JobSystem task");
+        (*task.batch->fn)(task.begin, task.end);
+    }
+    LaneCounters& counters = laneCounters[static_cast<size_t>(Lane::Frame)];
+    counters.busyNs.fetch_add(elapsedNs(start), std::memory_order_relaxed);
+    counters.completed.fetch_add(1, std::memory_order_relaxed);
+    task.batch->remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
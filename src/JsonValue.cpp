@@ -0,0 +1,271 @@
+#include "JsonValue.hpp"
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+const JsonValue& nullValue() {
+    static const JsonValue value;
+    return value;
+}
+} // namespace
+
+// Recursive-descent parser; depth is capped so a hostile file can't blow the stack
+class JsonParser {
+public:
+    explicit JsonParser(std::string_view text) : text(text) {}
+
+    bool parseDocument(JsonValue& out, std::string& error) {
+        skipWhitespace();
+        if (!parseValue(out, 0)) {
+            error = message;
+            return false;
+        }
+        skipWhitespace();
+        if (pos != text.size()) {
+            fail("unexpected trailing characters");
+            error = message;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr int MAX_DEPTH = 128;
+
+    std::string_view text;
+    size_t pos = 0;
+    std::string message;
+
+    bool fail(const char* what) {
+        if (message.empty()) {
+            // Report a line number; offsets are useless for hand-edited files
+            size_t line = 1;
+            for (size_t i = 0; i < pos && i < text.size(); ++i) {
+                if (text[i] == '\n') {
+                    ++line;
+                }
+            }
+            message = std::string(what) + " at line " + std::to_string(line);
+        }
+        return false;
+    }
+
+    void skipWhitespace() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) {
+            ++pos;
+        }
+    }
+
+    bool consume(std::string_view literal) {
+        if (text.substr(pos, literal.size()) != literal) {
+            return false;
+        }
+        pos += literal.size();
+        return true;
+    }
+
+    bool parseValue(JsonValue& out, int depth) {
+        if (depth > MAX_DEPTH) {
+            return fail("nesting too deep");
+        }
+        if (pos >= text.size()) {
+            return fail("unexpected end of input");
+        }
+        switch (text[pos]) {
+            case '{': return parseObject(out, depth);
+            case '[': return parseArray(out, depth);
+            case '"':
+                out.type = JsonValue::Type::String;
+                return parseString(out.stringValue);
+            case 't':
+                out.type = JsonValue::Type::Bool;
+                out.boolValue = true;
+                return consume("true") || fail("invalid literal");
+            case 'f':
+                out.type = JsonValue::Type::Bool;
+                out.boolValue = false;
+                return consume("false") || fail("invalid literal");
+            case 'n':
+                out.type = JsonValue::Type::Null;
+                return consume("null") || fail("invalid literal");
+            default:
+                return parseNumber(out);
+        }
+    }
+
+    bool parseObject(JsonValue& out, int depth) {
+        out.type = JsonValue::Type::Object;
+        ++pos; // '{'
+        skipWhitespace();
+        if (pos < text.size() && text[pos] == '}') {
+            ++pos;
+            return true;
+        }
+        while (true) {
+            skipWhitespace();
+            if (pos >= text.size() || text[pos] != '"') {
+                return fail("expected member name");
+            }
+            out.members.emplace_back();
+            if (!parseString(out.members.back().first)) {
+                return false;
+            }
+            skipWhitespace();
+            if (pos >= text.size() || text[pos] != ':') {
+                return fail("expected ':'");
+            }
+            ++pos;
+            skipWhitespace();
+            if (!parseValue(out.members.back().second, depth + 1)) {
+                return false;
+            }
+            skipWhitespace();
+            if (pos < text.size() && text[pos] == ',') {
+                ++pos;
+                continue;
+            }
+            if (pos < text.size() && text[pos] == '}') {
+                ++pos;
+                return true;
+            }
+            return fail("expected ',' or '}'");
+        }
+    }
+
+    bool parseArray(JsonValue& out, int depth) {
+        out.type = JsonValue::Type::Array;
+        ++pos; // '['
+        skipWhitespace();
+        if (pos < text.size() && text[pos] == ']') {
+            ++pos;
+            return true;
+        }
+        while (true) {
+            skipWhitespace();
+            out.elements.emplace_back();
+            if (!parseValue(out.elements.back(), depth + 1)) {
+                return false;
+            }
+            skipWhitespace();
+            if (pos < text.size() && text[pos] == ',') {
+                ++pos;
+                continue;
+            }
+            if (pos < text.size() && text[pos] == ']') {
+                ++pos;
+                return true;
+            }
+            return fail("expected ',' or ']'");
+        }
+    }
+
+    static void appendUtf8(std::string& out, unsigned codepoint) {
+        if (codepoint < 0x80) {
+            out += static_cast<char>(codepoint);
+        } else if (codepoint < 0x800) {
+            out += static_cast<char>(0xC0 | (codepoint >> 6));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else {
+            out += static_cast<char>(0xE0 | (codepoint >> 12));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+    }
+
+    bool parseString(std::string& out) {
+        ++pos; // opening quote
+        while (pos < text.size()) {
+            char c = text[pos++];
+            if (c == '"') {
+                return true;
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) {
+                break;
+            }
+            char escape = text[pos++];
+            switch (escape) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    if (pos + 4 > text.size()) {
+                        return fail("truncated \\u escape");
+                    }
+                    char digits[5] = {};
+                    std::memcpy(digits, text.data() + pos, 4);
+                    char* end = nullptr;
+                    unsigned long codepoint = std::strtoul(digits, &end, 16);
+                    if (end != digits + 4) {
+                        return fail("invalid \\u escape");
+                    }
+                    pos += 4;
+                    appendUtf8(out, static_cast<unsigned>(codepoint)); // Surrogate pairs are not combined
+                    break;
+                }
+                default:
+                    return fail("invalid escape");
+            }
+        }
+        return fail("unterminated string");
+    }
+
+    bool parseNumber(JsonValue& out) {
+        const size_t start = pos;
+        while (pos < text.size() && std::strchr("+-0123456789.eE", text[pos]) != nullptr) {
+            ++pos;
+        }
+        if (pos == start || pos - start >= 64) {
+            return fail("invalid value");
+        }
+        // strtod needs a terminated buffer; numbers in data files are short
+        char buffer[64];
+        std::memcpy(buffer, text.data() + start, pos - start);
+        buffer[pos - start] = '\0';
+        char* end = nullptr;
+        out.type = JsonValue::Type::Number;
+        out.numberValue = std::strtod(buffer, &end);
+        if (end != buffer + (pos - start)) {
+            pos = start;
+            return fail("invalid number");
+        }
+        return true;
+    }
+};
+
+bool JsonValue::parse(std::string_view text, JsonValue& out, std::string& error) {
+    out = JsonValue();
+    JsonParser parser(text);
+    return parser.parseDocument(out, error);
+}
+
+const JsonValue& JsonValue::operator[](size_t index) const {
+    return (type == Type::Array && index < elements.size()) ? elements[index] : nullValue();
+}
+
+bool JsonValue::has(std::string_view key) const {
+    for (const auto& member : members) {
+        if (member.first == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const JsonValue& JsonValue::operator[](std::string_view key) const {
+    // Linear scan: data-file objects have a handful of members
+    for (const auto& member : members) {
+        if (member.first == key) {
+            return member.second;
+        }
+    }
+    return nullValue();
+}
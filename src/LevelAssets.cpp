@@ -0,0 +1,95 @@
+#include "LevelAssets.hpp"
+#include <algorithm>
+
+namespace LevelAssets {
+
+std::string findFirst(const std::vector<std::string>& candidates, const Exists& exists) {
+    for (const auto& candidate : candidates) {
+        if (exists(candidate)) {
+            return candidate;
+        }
+    }
+    return std::string();
+}
+
+std::string getBackgroundPath(const LevelData& data, const Exists& exists) {
+    std::vector<std::string> candidates;
+    if (!data.background.empty()) {
+        candidates.push_back(data.background);
+    }
+    candidates.insert(candidates.end(), data.backgroundFallbacks.begin(), data.backgroundFallbacks.end());
+    return findFirst(candidates, exists);
+}
+
+// The most specific candidate that exists: the level's own directory, the
+// shared one, then its theme's
+std::string getBackgroundLayerPath(const std::string& layer, int level, const Exists& exists) {
+    const std::string levelDirectory = "assets/images/backgrounds/" + std::to_string(level) + "/";
+    const std::string themeDirectory = (level == 1) ? "assets/images/backgrounds/snow/" : "assets/images/backgrounds/snow_forest/";
+    std::vector<std::string> candidates = {
+        levelDirectory + layer + ".png",
+        "assets/images/backgrounds/" + layer + ".png",
+        themeDirectory + layer + ".png",
+        "assets/images/backgrounds/snow/" + layer + ".png"
+    };
+    if (layer == "background4") {
+        // Fallback to the original background texture
+        candidates.push_back("assets/images/backgrounds/background.png");
+    }
+    return findFirst(candidates, exists);
+}
+
+std::string getTiledLayerPath(const std::string& layer, int level, const Exists& exists) {
+    const std::string directory = "assets/images/backgrounds/" + std::to_string(level) + "/" + layer +
+                                  TileLayout::DIRECTORY_SUFFIX;
+    return exists(directory + "/" + TileLayout::LAYOUT_FILE) ? directory : std::string();
+}
+
+std::string getMusicStem(const LevelData& data) {
+    return data.music.empty() ? std::string(DEFAULT_MUSIC) : data.music;
+}
+
+std::string getMusicPath(const LevelData& data, const Exists& exists) {
+    // SoundSystem::resolveAudioPath's order
+    const std::string stem = getMusicStem(data);
+    return findFirst({stem + ".ogg", stem + ".flac", stem + ".wav"}, exists);
+}
+
+void collect(const LevelData& data, int level, const Exists& exists, const ListDirectory& list,
+             std::vector<std::string>& out) {
+    out.clear();
+    auto add = [&](const std::string& path) {
+        if (!path.empty()) {
+            out.push_back(path);
+        }
+    };
+    for (const std::string& path : {LevelLoader::getCookedLevelPath(level), LevelLoader::getLevelPath(level)}) {
+        if (exists(path)) {
+            out.push_back(path);
+        }
+    }
+    add(getBackgroundPath(data, exists));
+    for (const char* layer : BACKGROUND_LAYERS) {
+        const std::string tiled = getTiledLayerPath(layer, level, exists);
+        if (!tiled.empty()) {
+            list(tiled, out); // Layout, preview and every tile
+        } else {
+            add(getBackgroundLayerPath(layer, level, exists));
+        }
+    }
+    if (!data.colorGrade.empty() && exists(data.colorGrade)) {
+        out.push_back(data.colorGrade);
+    }
+    add(getMusicPath(data, exists));
+    if (!data.platforms.empty()) {
+        list(TILES_DIRECTORY, out);
+    }
+    if (!data.npcs.empty()) {
+        list(NPC_IDLE_CLIP, out);
+        list(NPC_WALKING_CLIP, out);
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+} // namespace LevelAssets
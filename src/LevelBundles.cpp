@@ -0,0 +1,177 @@
+#include "LevelBundles.hpp"
+#include "AssetPack.hpp"
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+constexpr uint64_t PAGE_STEP = 4096;           // Touch stride; one byte per page faults it in
+constexpr uint64_t MERGE_GAP = 64 * 1024;      // Gaps up to this are read through rather than skipped
+
+bool contains(const AssetPack::Bundle& bundle, const AssetPack::FileRange& file) {
+    return file.offset >= bundle.offset && file.offset + file.size <= bundle.offset + bundle.size;
+}
+
+} // namespace
+
+LevelBundles::~LevelBundles() {
+    // Reads still queued skip their pass, but they hold 'this' until they return
+    std::unique_lock<std::mutex> lock(mutex);
+    stopping = true;
+    idle.wait(lock, [this] { return runningReads == 0; });
+}
+
+void LevelBundles::hold(int current, int next) {
+    const AssetPack& pack = AssetPack::instance();
+    if (fileRefs.size() != pack.getEntryCount()) {
+        // Mounted (or remounted) since the last hold: nothing held is in this pack
+        fileRefs.assign(pack.getEntryCount(), 0);
+        held.clear();
+    }
+
+    std::vector<int> wanted;
+    for (int level : {current, next}) {
+        if (level > 0 && std::find(wanted.begin(), wanted.end(), level) == wanted.end() && pack.findBundle(level)) {
+            wanted.push_back(level);
+        }
+    }
+    for (int level : held) {
+        if (std::find(wanted.begin(), wanted.end(), level) == wanted.end()) {
+            release(level);
+        }
+    }
+    std::vector<Range> reads;
+    for (int level : wanted) {
+        if (std::find(held.begin(), held.end(), level) == held.end()) {
+            acquire(level, reads);
+        }
+    }
+    held = std::move(wanted);
+    if (reads.empty()) {
+        return;
+    }
+
+    // One pass front to back, small gaps (alignment, a shared file nobody new needs) read through
+    std::sort(reads.begin(), reads.end(), [](const Range& a, const Range& b) { return a.offset < b.offset; });
+    std::vector<Range> merged;
+    for (const Range& range : reads) {
+        if (!merged.empty() && range.offset <= merged.back().offset + merged.back().size + MERGE_GAP) {
+            merged.back().size = std::max(merged.back().size, range.offset + range.size - merged.back().offset);
+        } else {
+            merged.push_back(range);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        runningReads++;
+    }
+    if (jobSystem) {
+        jobSystem->submit(JobSystem::Lane::Streaming, [this, merged = std::move(merged)]() mutable {
+            read(std::move(merged));
+        });
+    } else {
+        read(std::move(merged));
+    }
+}
+
+void LevelBundles::acquire(int level, std::vector<Range>& reads) {
+    const AssetPack& pack = AssetPack::instance();
+    const AssetPack::Bundle bundle = pack.findBundle(level);
+    if (bundle.size > 0) {
+        reads.push_back(Range{bundle.offset, bundle.size});
+    }
+    // Shared files only when no held bundle has brought them in already
+    for (size_t i = 0; i < bundle.fileCount; ++i) {
+        const uint32_t file = bundle.files[i];
+        const AssetPack::FileRange range = pack.getFile(file);
+        if (fileRefs[file]++ == 0 && !contains(bundle, range) && range.size > 0) {
+            reads.push_back(Range{range.offset, range.size});
+        }
+    }
+}
+
+void LevelBundles::release(int level) {
+    const AssetPack& pack = AssetPack::instance();
+    const AssetPack::Bundle bundle = pack.findBundle(level);
+    for (size_t i = 0; i < bundle.fileCount; ++i) {
+        const uint32_t file = bundle.files[i];
+        if (fileRefs[file] > 0 && --fileRefs[file] == 0) {
+            const AssetPack::FileRange range = pack.getFile(file);
+            if (!contains(bundle, range)) {
+                pack.dontNeed(range.offset, range.size);
+            }
+        }
+    }
+    pack.dontNeed(bundle.offset, bundle.size);
+}
+
+void LevelBundles::read(std::vector<Range> ranges) {
+    PROFILE_ZONE("LevelBundles::read");
+    bool cancelled = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancelled = stopping;
+    }
+
+    uint64_t bytes = 0;
+    double ms = 0.0;
+    if (!cancelled) {
+        const auto start = std::chrono::steady_clock::now();
+        const AssetPack& pack = AssetPack::instance();
+        // All the hints first so the OS can queue the whole read, then fault it in in order
+        for (const Range& range : ranges) {
+            pack.willNeed(range.offset, range.size);
+        }
+        const char* data = pack.getData();
+        unsigned char sum = 0;
+        for (const Range& range : ranges) {
+            for (uint64_t offset = range.offset; offset < range.offset + range.size; offset += PAGE_STEP) {
+                sum ^= static_cast<unsigned char>(data[offset]);
+            }
+            bytes += range.size;
+        }
+        volatile unsigned char sink = sum; // Keeps the reads
+        (void)sink;
+        ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!cancelled) {
+            readBytes += bytes;
+            readCount++;
+            lastReadMs = ms;
+        }
+        runningReads--;
+    }
+    idle.notify_all();
+}
+
+bool LevelBundles::isHeld(int level) const {
+    return std::find(held.begin(), held.end(), level) != held.end();
+}
+
+bool LevelBundles::isReading() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return runningReads > 0;
+}
+
+LevelBundles::Stats LevelBundles::getStats() const {
+    Stats stats;
+    stats.heldLevels = held.size();
+    const AssetPack& pack = AssetPack::instance();
+    for (size_t i = 0; i < fileRefs.size(); ++i) {
+        if (fileRefs[i] > 0) {
+            stats.files++;
+            stats.bytes += pack.getFile(static_cast<uint32_t>(i)).size;
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.readBytes = readBytes;
+    stats.reads = readCount;
+    stats.lastReadMs = lastReadMs;
+    return stats;
+}
@@ -0,0 +1,84 @@
+#include "LevelCache.hpp"
+#include <algorithm>
+#include <utility>
+
+size_t LevelCache::measure(const Entry& entry) {
+    // RGBA8, as AssetManager estimates it; a texture pinned twice counts once
+    std::vector<const sf::Texture*> seen;
+    size_t bytes = 0;
+    for (const auto& ref : entry.textures) {
+        if (!ref || std::find(seen.begin(), seen.end(), &ref.get()) != seen.end()) continue;
+        seen.push_back(&ref.get());
+        const sf::Vector2u size = ref.get().getSize();
+        bytes += static_cast<size_t>(size.x) * size.y * 4;
+    }
+    return bytes;
+}
+
+void LevelCache::store(Entry&& entry) {
+    erase(entry.level);
+    Slot slot;
+    slot.textureBytes = measure(entry);
+    slot.entry = std::move(entry);
+    textureBytes += slot.textureBytes;
+    entries.push_back(std::move(slot));
+    enforceBudget();
+}
+
+bool LevelCache::take(int level, Entry& out) {
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].entry.level == level) {
+            out = std::move(entries[i].entry);
+            removeAt(i);
+            hits++;
+            return true;
+        }
+    }
+    misses++;
+    return false;
+}
+
+const LevelData* LevelCache::peek(int level) const {
+    for (const auto& slot : entries) {
+        if (slot.entry.level == level) {
+            return &slot.entry.data;
+        }
+    }
+    return nullptr;
+}
+
+void LevelCache::erase(int level) {
+    eraseIf([level](int held) { return held == level; });
+}
+
+void LevelCache::clear() {
+    entries.clear();
+    textureBytes = 0;
+}
+
+void LevelCache::removeAt(size_t index) {
+    textureBytes -= entries[index].textureBytes;
+    entries.erase(entries.begin() + static_cast<std::ptrdiff_t>(index));
+}
+
+void LevelCache::setBudget(size_t bytes) {
+    budget = bytes;
+    enforceBudget();
+}
+
+void LevelCache::enforceBudget() {
+    while (!entries.empty() && (entries.size() > MAX_LEVELS || textureBytes > budget)) {
+        removeAt(0);
+        evictions++;
+    }
+}
+
+LevelCache::Stats LevelCache::getStats() const {
+    Stats stats;
+    stats.levels = entries.size();
+    stats.textureBytes = textureBytes;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.evictions = evictions;
+    return stats;
+}
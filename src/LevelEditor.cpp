@@ -0,0 +1,475 @@
+#include "LevelEditor.hpp"
+#include "DebugDraw.hpp"
+#include "TileMap.hpp"
+#include "imgui.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+
+namespace {
+
+const char* const LAYER_NAMES[] = {"Platforms", "Ladders", "Decorations", "Spawns"};
+const char* const SLOPE_NAMES[] = {"None", "Left", "Right"};
+const char* const DECORATION_NAMES[] = {"Other", "Tree", "Cabin", "Snowman"};
+const char* const SPAWN_NAMES[] = {"Player spawn", "Entry left", "Entry right"};
+
+constexpr float PIXEL_GRID = 10.f; // Snap step for levels drawn in pixels (tile_size 1)
+
+sf::Vector2f& spawnPosition(LevelData& level, size_t index) {
+    switch (index) {
+        case 0: return level.spawn;
+        case 1: return level.entryLeft;
+        case 2: return level.entryRight;
+    }
+    index -= LevelEditor::SPAWN_POINTS;
+    return index < level.enemies.size() ? level.enemies[index].position
+                                        : level.npcs[index - level.enemies.size()].position;
+}
+
+sf::Vector2f spawnPosition(const LevelData& level, size_t index) {
+    return spawnPosition(const_cast<LevelData&>(level), index);
+}
+
+} // namespace
+
+void LevelEditor::reset(const std::string& path) {
+    savePath = path;
+    selected = -1;
+    hovered = -1;
+    dragging = false;
+    gridSize = 0.f;
+    edits.clear();
+    unsaved = false;
+    status.clear();
+}
+
+size_t LevelEditor::getCount(const LevelData& level, Layer layer) {
+    switch (layer) {
+        case Layer::Platforms: return level.platforms.size();
+        case Layer::Ladders: return level.ladders.size();
+        case Layer::Decorations: return level.decorations.size();
+        case Layer::Spawns: return SPAWN_POINTS + level.enemies.size() + level.npcs.size();
+    }
+    return 0;
+}
+
+sf::FloatRect LevelEditor::getBounds(const LevelData& level, Layer layer, size_t index) {
+    switch (layer) {
+        case Layer::Platforms: return level.platforms[index].bounds;
+        case Layer::Ladders: return level.ladders[index].bounds;
+        case Layer::Decorations: return LevelLoader::getDecorationBounds(level, level.decorations[index]);
+        case Layer::Spawns: {
+            const sf::Vector2f position = spawnPosition(level, index);
+            const size_t enemy = index - SPAWN_POINTS;
+            if (index >= SPAWN_POINTS && enemy < level.enemies.size()) {
+                const uint16_t type = level.enemies[enemy].type;
+                return sf::FloatRect(position, level.enemyTypes[type < level.enemyTypes.size() ? type : 0].size);
+            }
+            return sf::FloatRect(position, sf::Vector2f(MARKER_SIZE, MARKER_SIZE));
+        }
+    }
+    return sf::FloatRect();
+}
+
+void LevelEditor::setBounds(LevelData& level, Layer layer, size_t index, const sf::FloatRect& bounds) {
+    switch (layer) {
+        case Layer::Platforms: level.platforms[index].bounds = bounds; break;
+        case Layer::Ladders: level.ladders[index].bounds = bounds; break;
+        case Layer::Decorations:
+            level.decorations[index].position = bounds.position;
+            level.decorations[index].height = bounds.size.y;
+            break;
+        case Layer::Spawns: spawnPosition(level, index) = bounds.position; break;
+    }
+}
+
+std::string LevelEditor::getLabel(const LevelData& level, Layer layer, size_t index) {
+    const sf::FloatRect bounds = getBounds(level, layer, index);
+    char text[96];
+    const char* name = LAYER_NAMES[static_cast<size_t>(layer)];
+    if (layer == Layer::Decorations) {
+        name = DECORATION_NAMES[static_cast<size_t>(level.decorations[index].kind)];
+    } else if (layer == Layer::Spawns) {
+        name = index < SPAWN_POINTS ? SPAWN_NAMES[index]
+             : index - SPAWN_POINTS < level.enemies.size() ? "Enemy"
+             : level.npcs[index - SPAWN_POINTS - level.enemies.size()].id.c_str();
+    }
+    std::snprintf(text, sizeof(text), "%zu  %s  (%.0f, %.0f)", index, name, bounds.position.x, bounds.position.y);
+    return text;
+}
+
+float LevelEditor::snap(float value) const {
+    return snapping && gridSize > 0.f ? std::round(value / gridSize) * gridSize : value;
+}
+
+int LevelEditor::pick(const LevelData& level, const sf::Vector2f& point) const {
+    // Last drawn first, so what is on top wins
+    for (size_t i = getCount(level, layer); i-- > 0;) {
+        const sf::FloatRect bounds = getBounds(level, layer, i);
+        if (point.x >= bounds.position.x && point.x <= bounds.position.x + bounds.size.x &&
+            point.y >= bounds.position.y && point.y <= bounds.position.y + bounds.size.y) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void LevelEditor::change(LevelData& level, size_t index, const sf::FloatRect& bounds) {
+    Edit edit;
+    edit.layer = layer;
+    edit.index = index;
+    edit.before = getBounds(level, layer, index);
+    setBounds(level, layer, index, bounds);
+    edit.after = getBounds(level, layer, index);
+    if (edit.after != edit.before) {
+        edits.push_back(edit);
+        unsaved = true;
+    }
+}
+
+void LevelEditor::touch(LevelData& level, size_t index) {
+    Edit edit;
+    edit.layer = layer;
+    edit.index = index;
+    edit.before = edit.after = getBounds(level, layer, index);
+    edits.push_back(edit);
+    unsaved = true;
+}
+
+void LevelEditor::add(LevelData& level, const sf::Vector2f& position, int copyOf) {
+    // New records are a few grid cells big; copies sit one grid step to the right
+    const float cell = std::max(gridSize, 1.f);
+    const sf::Vector2f at = copyOf >= 0 ? getBounds(level, layer, copyOf).position + sf::Vector2f(cell, 0.f) : snap(position);
+    switch (layer) {
+        case Layer::Platforms: {
+            LevelData::Platform platform = copyOf >= 0 ? level.platforms[copyOf] : LevelData::Platform();
+            platform.bounds.position = at;
+            if (copyOf < 0) {
+                platform.bounds.size = sf::Vector2f(std::max(snap(120.f), cell), std::max(snap(30.f), cell));
+            }
+            level.platforms.push_back(platform);
+            break;
+        }
+        case Layer::Ladders: {
+            LevelData::Ladder ladder = copyOf >= 0 ? level.ladders[copyOf] : LevelData::Ladder();
+            ladder.bounds.position = at;
+            if (copyOf < 0) {
+                ladder.bounds.size = sf::Vector2f(std::max(snap(30.f), cell), std::max(snap(120.f), cell));
+            }
+            level.ladders.push_back(ladder);
+            break;
+        }
+        case Layer::Decorations: {
+            LevelData::Decoration decoration = copyOf >= 0 ? level.decorations[copyOf] : LevelData::Decoration();
+            decoration.position = at;
+            if (copyOf < 0) {
+                decoration.kind = LevelData::DecorationKind::Tree;
+                decoration.height = 3.f * level.tileSize;
+            }
+            level.decorations.push_back(decoration);
+            break;
+        }
+        case Layer::Spawns: {
+            // New spawn points are enemies; a copy of an enemy keeps its type and patrol
+            const size_t enemy = copyOf >= 0 ? static_cast<size_t>(copyOf) - SPAWN_POINTS : level.enemies.size();
+            LevelData::EnemySpawn spawn = enemy < level.enemies.size() ? level.enemies[enemy] : LevelData::EnemySpawn();
+            if (enemy >= level.enemies.size()) {
+                spawn.patrolWidth = level.enemyTypes[0].patrolWidth;
+            }
+            spawn.position = at;
+            level.enemies.push_back(spawn);
+            selected = static_cast<int>(SPAWN_POINTS + level.enemies.size() - 1);
+            break;
+        }
+    }
+    if (layer != Layer::Spawns) {
+        selected = static_cast<int>(getCount(level, layer) - 1);
+    }
+
+    Edit edit;
+    edit.type = Edit::Type::Add;
+    edit.layer = layer;
+    edit.index = static_cast<size_t>(selected);
+    edit.after = getBounds(level, layer, edit.index);
+    edits.push_back(edit);
+    unsaved = true;
+}
+
+void LevelEditor::remove(LevelData& level, size_t index) {
+    if (layer == Layer::Spawns && index < SPAWN_POINTS) {
+        return; // The level always has these
+    }
+    Edit edit;
+    edit.type = Edit::Type::Remove;
+    edit.layer = layer;
+    edit.index = index;
+    edit.before = getBounds(level, layer, index);
+    switch (layer) {
+        case Layer::Platforms: level.platforms.erase(level.platforms.begin() + index); break;
+        case Layer::Ladders: level.ladders.erase(level.ladders.begin() + index); break;
+        case Layer::Decorations: level.decorations.erase(level.decorations.begin() + index); break;
+        case Layer::Spawns: {
+            const size_t enemy = index - SPAWN_POINTS;
+            if (enemy < level.enemies.size()) {
+                level.enemies.erase(level.enemies.begin() + enemy);
+            } else {
+                level.npcs.erase(level.npcs.begin() + (enemy - level.enemies.size()));
+            }
+            break;
+        }
+    }
+    edits.push_back(edit);
+    selected = -1;
+    dragging = false;
+    unsaved = true;
+}
+
+void LevelEditor::save(const LevelData& level) {
+    std::string error;
+    if (savePath.empty()) {
+        status = "No level file to save to";
+    } else if (LevelLoader::saveToFile(level, savePath, error)) {
+        status = "Saved " + savePath;
+        unsaved = false;
+        saved = true;
+    } else {
+        status = error;
+    }
+}
+
+void LevelEditor::takeEdits(std::vector<Edit>& out) {
+    out.clear();
+    out.swap(edits);
+}
+
+bool LevelEditor::takeSaved() {
+    const bool wasSaved = saved;
+    saved = false;
+    return wasSaved;
+}
+
+void LevelEditor::draw(bool* open, LevelData& level, const sf::Vector2f& mouseWorld, bool locked) {
+    if (gridSize <= 0.f) {
+        // The level's own grid keeps platforms whole tiles, so they stay on the physics tile layer
+        gridSize = level.tileSize >= TileMap::MIN_TILE_SIZE ? level.tileSize : PIXEL_GRID;
+    }
+    if (selected >= static_cast<int>(getCount(level, layer))) {
+        selected = -1;
+    }
+
+    // In the world: click picks, dragging moves (snapped), Delete removes
+    const ImGuiIO& io = ImGui::GetIO();
+    hovered = -1;
+    if (!io.WantCaptureMouse) {
+        lastWorldMouse = mouseWorld;
+        hovered = pick(level, mouseWorld);
+        if (!locked && ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
+            selected = hovered;
+            dragging = selected >= 0;
+            if (dragging) {
+                dragOffset = mouseWorld - getBounds(level, layer, static_cast<size_t>(selected)).position;
+            }
+        }
+    }
+    if (dragging) {
+        if (locked || selected < 0 || !ImGui::IsMouseDown(ImGuiMouseButton_Left)) {
+            dragging = false;
+        } else {
+            const sf::FloatRect bounds = getBounds(level, layer, static_cast<size_t>(selected));
+            const sf::Vector2f position = snap(mouseWorld - dragOffset);
+            if (position != bounds.position) {
+                change(level, static_cast<size_t>(selected), sf::FloatRect(position, bounds.size));
+            }
+        }
+    }
+    if (!locked && selected >= 0 && !io.WantCaptureKeyboard && ImGui::IsKeyPressed(ImGuiKey_Delete)) {
+        remove(level, static_cast<size_t>(selected));
+    }
+
+    ImGui::SetNextWindowSize(ImVec2(360, 520), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Level Editor", open)) {
+        ImGui::Text("%s%s", level.name.c_str(), unsaved ? " (unsaved)" : "");
+        if (locked) {
+            ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f), "Editing is off during netplay and replays");
+        }
+        ImGui::BeginDisabled(locked);
+
+        for (size_t l = 0; l < std::size(LAYER_NAMES); ++l) {
+            if (l > 0) ImGui::SameLine();
+            if (ImGui::RadioButton(LAYER_NAMES[l], layer == static_cast<Layer>(l))) {
+                layer = static_cast<Layer>(l);
+                selected = -1;
+                dragging = false;
+            }
+        }
+        ImGui::Checkbox("Snap", &snapping);
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(80.0f);
+        if (ImGui::InputFloat("Grid", &gridSize, 0.0f, 0.0f, "%.0f")) {
+            gridSize = std::max(gridSize, 1.0f);
+        }
+
+        if (ImGui::Button("Add")) {
+            add(level, lastWorldMouse, -1);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("At the last place the cursor was in the world");
+        }
+        const bool fixedSpawn = layer == Layer::Spawns && selected >= 0 &&
+                                static_cast<size_t>(selected) < SPAWN_POINTS;
+        const bool isNpc = layer == Layer::Spawns && selected >= 0 &&
+                           static_cast<size_t>(selected) >= SPAWN_POINTS + level.enemies.size();
+        ImGui::BeginDisabled(selected < 0 || fixedSpawn);
+        ImGui::SameLine();
+        ImGui::BeginDisabled(isNpc); // NPC ids are unique
+        if (ImGui::Button("Duplicate")) {
+            add(level, lastWorldMouse, selected);
+        }
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        if (ImGui::Button("Delete")) {
+            remove(level, static_cast<size_t>(selected));
+        }
+        ImGui::EndDisabled();
+
+        ImGui::Separator();
+        drawList(level);
+        drawProperties(level);
+
+        ImGui::Separator();
+        if (ImGui::Button("Save")) {
+            save(level);
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("%s", status.empty() ? savePath.c_str() : status.c_str());
+        ImGui::EndDisabled();
+    }
+    ImGui::End();
+}
+
+void LevelEditor::drawList(const LevelData& level) {
+    const size_t count = getCount(level, layer);
+    ImGui::Text("%zu %s", count, LAYER_NAMES[static_cast<size_t>(layer)]);
+    ImGui::BeginChild("LevelEditorRecords", ImVec2(0, 180), ImGuiChildFlags_Borders);
+    // Clipped: only the visible rows are built, however large the level
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(count));
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+            ImGui::PushID(i);
+            if (ImGui::Selectable(getLabel(level, layer, static_cast<size_t>(i)).c_str(), selected == i)) {
+                selected = i;
+            }
+            ImGui::PopID();
+        }
+    }
+    ImGui::EndChild();
+}
+
+void LevelEditor::drawProperties(LevelData& level) {
+    if (selected < 0) {
+        ImGui::TextDisabled("Click a record in the world or the list");
+        return;
+    }
+    const size_t index = static_cast<size_t>(selected);
+    const sf::FloatRect bounds = getBounds(level, layer, index);
+
+    float position[2] = {bounds.position.x, bounds.position.y};
+    if (ImGui::DragFloat2("Position", position, 1.0f)) {
+        change(level, index, sf::FloatRect(sf::Vector2f(position[0], position[1]), bounds.size));
+    }
+    if (layer == Layer::Platforms || layer == Layer::Ladders) {
+        float size[2] = {bounds.size.x, bounds.size.y};
+        if (ImGui::DragFloat2("Size", size, 1.0f, 1.0f, FLT_MAX)) {
+            change(level, index, sf::FloatRect(bounds.position,
+                                               sf::Vector2f(std::max(size[0], 1.0f), std::max(size[1], 1.0f))));
+        }
+    }
+
+    switch (layer) {
+        case Layer::Platforms: {
+            int slope = static_cast<int>(level.platforms[index].slope);
+            if (ImGui::Combo("Slope", &slope, SLOPE_NAMES, static_cast<int>(std::size(SLOPE_NAMES)))) {
+                level.platforms[index].slope = static_cast<LevelData::Slope>(slope);
+                touch(level, index);
+            }
+            break;
+        }
+        case Layer::Ladders:
+            break;
+        case Layer::Decorations: {
+            LevelData::Decoration& decoration = level.decorations[index];
+            int kind = static_cast<int>(decoration.kind);
+            if (ImGui::Combo("Kind", &kind, DECORATION_NAMES, static_cast<int>(std::size(DECORATION_NAMES)))) {
+                const sf::FloatRect before = getBounds(level, layer, index);
+                decoration.kind = static_cast<LevelData::DecorationKind>(kind);
+                Edit edit; // The width follows the kind
+                edit.layer = layer;
+                edit.index = index;
+                edit.before = before;
+                edit.after = getBounds(level, layer, index);
+                edits.push_back(edit);
+                unsaved = true;
+            }
+            float height = decoration.height;
+            if (ImGui::DragFloat("Height", &height, 1.0f, 1.0f, FLT_MAX)) {
+                change(level, index, sf::FloatRect(bounds.position, sf::Vector2f(bounds.size.x, std::max(height, 1.0f))));
+            }
+            break;
+        }
+        case Layer::Spawns: {
+            const size_t enemy = index - SPAWN_POINTS;
+            if (index < SPAWN_POINTS || enemy >= level.enemies.size()) {
+                break;
+            }
+            LevelData::EnemySpawn& spawn = level.enemies[enemy];
+            if (ImGui::DragFloat("Patrol", &spawn.patrolWidth, 1.0f, 0.0f, FLT_MAX)) {
+                touch(level, index);
+            }
+            const char* typeName = level.enemyTypes[spawn.type < level.enemyTypes.size() ? spawn.type : 0].name.c_str();
+            if (ImGui::BeginCombo("Type", typeName)) {
+                for (size_t t = 0; t < level.enemyTypes.size(); ++t) {
+                    if (ImGui::Selectable(level.enemyTypes[t].name.c_str(), spawn.type == t)) {
+                        const sf::FloatRect before = getBounds(level, layer, index);
+                        spawn.type = static_cast<uint16_t>(t);
+                        Edit edit; // The marker takes the type's size
+                        edit.layer = layer;
+                        edit.index = index;
+                        edit.before = before;
+                        edit.after = getBounds(level, layer, index);
+                        edits.push_back(edit);
+                        unsaved = true;
+                    }
+                }
+                ImGui::EndCombo();
+            }
+            break;
+        }
+    }
+    if (layer == Layer::Spawns) {
+        ImGui::TextDisabled("Spawn changes take effect once saved, when the level restarts");
+    }
+}
+
+void LevelEditor::drawOverlay(DebugDraw& debugDraw, const LevelData& level) const {
+    // Spawn points have nothing else showing where they are
+    if (layer == Layer::Spawns) {
+        const size_t count = getCount(level, layer);
+        for (size_t i = 0; i < count; ++i) {
+            const sf::Color color = i == 0 ? sf::Color::Green
+                                  : i < SPAWN_POINTS ? sf::Color::Cyan
+                                  : i - SPAWN_POINTS < level.enemies.size() ? sf::Color::Red
+                                                                            : sf::Color(255, 165, 0);
+            debugDraw.rectOutline(getBounds(level, layer, i), color, 2.f);
+        }
+    }
+    if (hovered >= 0 && hovered != selected && static_cast<size_t>(hovered) < getCount(level, layer)) {
+        debugDraw.rectOutline(getBounds(level, layer, static_cast<size_t>(hovered)), sf::Color::White);
+    }
+    if (selected >= 0 && static_cast<size_t>(selected) < getCount(level, layer)) {
+        debugDraw.rect(getBounds(level, layer, static_cast<size_t>(selected)), sf::Color(255, 255, 0, 40),
+                       sf::Color::Yellow, 2.f);
+    }
+}
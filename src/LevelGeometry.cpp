@@ -0,0 +1,32 @@
+#include "LevelGeometry.hpp"
+
+void LevelGeometry::clear() {
+    bounds.clear();
+    slopes.clear();
+    colors.clear();
+}
+
+void LevelGeometry::reserve(size_t count) {
+    bounds.reserve(count);
+    slopes.reserve(count);
+    colors.reserve(count);
+}
+
+void LevelGeometry::add(const sf::FloatRect& box, const sf::Color& color, LevelData::Slope slope) {
+    bounds.push_back(box);
+    slopes.push_back(slope);
+    colors.push_back(color);
+}
+
+void LevelGeometry::appendQuad(size_t i, const sf::Color& color, std::vector<sf::Vertex>& out) const {
+    const sf::Vector2f topLeft = bounds[i].position;
+    const sf::Vector2f bottomRight = topLeft + bounds[i].size;
+    const sf::Vector2f topRight(bottomRight.x, topLeft.y);
+    const sf::Vector2f bottomLeft(topLeft.x, bottomRight.y);
+    out.push_back(sf::Vertex{topLeft, color});
+    out.push_back(sf::Vertex{topRight, color});
+    out.push_back(sf::Vertex{bottomLeft, color});
+    out.push_back(sf::Vertex{bottomLeft, color});
+    out.push_back(sf::Vertex{topRight, color});
+    out.push_back(sf::Vertex{bottomRight, color});
+}
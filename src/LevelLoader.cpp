@@ -0,0 +1,767 @@
+#include "LevelLoader.hpp"
+#include "AssetPack.hpp"
+#include "CookedLevel.hpp"
+#include "JsonValue.hpp"
+#include "MappedFile.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+void LevelData::clear() {
+    // clear() keeps capacity, which is what makes level reloads allocation-free
+    name.clear();
+    source.clear();
+    size = {};
+    tileSize = 30.f;
+    spawn = {};
+    entryLeft = {};
+    entryRight = {};
+    background.clear();
+    backgroundFallbacks.clear();
+    music.clear();
+    platformColor = sf::Color(200, 220, 255);
+    colorGrade.clear();
+    gradeTint = sf::Color::White;
+    dayLength = 0.f;
+    ambientLight = sf::Color::White;
+    gravity = 15.f;
+    jumpForce = 200.f;
+    enemySpeed = 1.f;
+    platforms.clear();
+    ladders.clear();
+    decorations.clear();
+    decorationQuads.clear();
+    enemyTypes.resize(1);
+    enemyTypes[0] = EnemyType();
+    enemies.clear();
+    npcs.clear();
+    triggers.clear();
+    lights.clear();
+}
+
+namespace {
+
+constexpr float DEFAULT_TILE_SIZE = 30.f;
+
+sf::Vector2f readPoint(const JsonValue& value, float scale, sf::Vector2f fallback) {
+    if (!value.isObject()) {
+        return fallback;
+    }
+    return sf::Vector2f(value["x"].asFloat(fallback.x / scale) * scale,
+                        value["y"].asFloat(fallback.y / scale) * scale);
+}
+
+sf::Color readColor(const JsonValue& value, sf::Color fallback) {
+    if (value.size() < 3) {
+        return fallback;
+    }
+    auto channel = [&value](size_t i, uint8_t fallbackChannel) {
+        double c = value[i].asNumber(fallbackChannel);
+        return static_cast<uint8_t>(c < 0.0 ? 0.0 : (c > 255.0 ? 255.0 : c));
+    };
+    return sf::Color(channel(0, fallback.r), channel(1, fallback.g), channel(2, fallback.b), channel(3, fallback.a));
+}
+
+LevelData::Slope readSlope(const JsonValue& value) {
+    const std::string& slope = value.asString();
+    if (slope == "left") return LevelData::Slope::Left;
+    if (slope == "right") return LevelData::Slope::Right;
+    return LevelData::Slope::None;
+}
+
+LevelData::DecorationKind readDecorationKind(const JsonValue& value) {
+    const std::string& kind = value.asString();
+    if (kind == "tree") return LevelData::DecorationKind::Tree;
+    if (kind == "cabin") return LevelData::DecorationKind::Cabin;
+    if (kind == "snowman") return LevelData::DecorationKind::Snowman;
+    return LevelData::DecorationKind::Other;
+}
+
+// A decoration's footprint in grid cells: its width, and its height when the level gives none
+sf::Vector2f decorationCells(LevelData::DecorationKind kind) {
+    switch (kind) {
+        case LevelData::DecorationKind::Tree: return sf::Vector2f(1.f, 3.f);
+        case LevelData::DecorationKind::Cabin: return sf::Vector2f(2.f, 2.f);
+        default: return sf::Vector2f(1.f, 1.f);
+    }
+}
+
+// Draw layer, back to front: the cabin behind the trees, snowmen in front
+uint8_t decorationDepth(LevelData::DecorationKind kind) {
+    switch (kind) {
+        case LevelData::DecorationKind::Cabin: return 0;
+        case LevelData::DecorationKind::Snowman: return 2;
+        default: return 1;
+    }
+}
+
+constexpr int MAX_DECORATION_ROWS = 16; // Taller trees stretch their middle cells
+
+LevelData::TriggerAction readTriggerAction(const JsonValue& value) {
+    const std::string& action = value.asString();
+    if (action == "exit_next") return LevelData::TriggerAction::ExitNext;
+    if (action == "exit_back") return LevelData::TriggerAction::ExitBack;
+    if (action == "kill") return LevelData::TriggerAction::Kill;
+    return LevelData::TriggerAction::Event;
+}
+
+const char* triggerActionName(LevelData::TriggerAction action) {
+    switch (action) {
+        case LevelData::TriggerAction::ExitNext: return "exit_next";
+        case LevelData::TriggerAction::ExitBack: return "exit_back";
+        case LevelData::TriggerAction::Kill: return "kill";
+        default: return "event";
+    }
+}
+
+const char* decorationKindName(LevelData::DecorationKind kind) {
+    switch (kind) {
+        case LevelData::DecorationKind::Tree: return "tree";
+        case LevelData::DecorationKind::Cabin: return "cabin";
+        case LevelData::DecorationKind::Snowman: return "snowman";
+        default: return "other";
+    }
+}
+
+// Shortest form that reads back as the same float
+std::string jsonNumber(float value) {
+    char buffer[32];
+    for (int digits = 6; digits <= 9; ++digits) {
+        std::snprintf(buffer, sizeof(buffer), "%.*g", digits, static_cast<double>(value));
+        if (std::strtof(buffer, nullptr) == value) {
+            break;
+        }
+    }
+    return buffer;
+}
+
+std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    return out + '"';
+}
+
+std::string jsonColor(const sf::Color& color) {
+    std::string out = "[" + std::to_string(color.r) + ", " + std::to_string(color.g) + ", " + std::to_string(color.b);
+    if (color.a != 255) {
+        out += ", " + std::to_string(color.a);
+    }
+    return out + "]";
+}
+
+// Bounds-checked view of one record array inside the cooked file
+template <typename Record>
+const Record* cookedArray(const char* data, size_t size, const CookedLevel::ArrayRef& ref) {
+    if (ref.count == 0) {
+        return nullptr;
+    }
+    if (ref.offset % alignof(Record) != 0 || ref.offset > size ||
+        static_cast<uint64_t>(ref.count) * sizeof(Record) > size - ref.offset) {
+        return nullptr;
+    }
+    return reinterpret_cast<const Record*>(data + ref.offset);
+}
+
+} // namespace
+
+namespace LevelLoader {
+
+std::string getLevelPath(int level) {
+    return "assets/levels/level" + std::to_string(level) + ".json";
+}
+
+std::string getCookedLevelPath(int level) {
+    return "assets/levels/level" + std::to_string(level) + ".lvl";
+}
+
+bool levelExists(int level) {
+    std::error_code ec;
+    for (const std::string& path : {getCookedLevelPath(level), getLevelPath(level)}) {
+        if (AssetPack::instance().find(path) || std::filesystem::is_regular_file(path, ec)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool loadLevel(int level, LevelData& out, std::string& error) {
+    const std::string jsonPath = getLevelPath(level);
+    const std::string cookedPath = getCookedLevelPath(level);
+
+    // A loose cooked file older than its JSON is stale (edited since the last cook)
+    bool useCooked = static_cast<bool>(AssetPack::instance().find(cookedPath));
+    if (!useCooked) {
+        std::error_code ec;
+        auto cookedTime = std::filesystem::last_write_time(cookedPath, ec);
+        if (!ec) {
+            std::error_code jsonEc;
+            auto jsonTime = std::filesystem::last_write_time(jsonPath, jsonEc);
+            useCooked = jsonEc || cookedTime >= jsonTime;
+        }
+    }
+
+    std::string cookedError;
+    if (useCooked && loadCookedFromFile(cookedPath, out, cookedError)) {
+        return true;
+    }
+    if (loadFromFile(jsonPath, out, error)) {
+        return true;
+    }
+    if (!cookedError.empty()) {
+        error = cookedError + "; " + error;
+    }
+    return false;
+}
+
+bool loadFromFile(const std::string& path, LevelData& out, std::string& error) {
+    // Prefer the mounted asset pack; loose files are the dev fallback
+    if (AssetPack::Blob blob = AssetPack::instance().find(path)) {
+        if (!loadFromMemory(blob.data, blob.size, out, error)) {
+            error = path + ": " + error;
+            return false;
+        }
+        out.source = path;
+        return true;
+    }
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        out.clear();
+        error = "Failed to open level file: " + path;
+        return false;
+    }
+    std::string text(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(text.data(), static_cast<std::streamsize>(text.size()));
+    if (!loadFromMemory(text.data(), text.size(), out, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    out.source = path;
+    return true;
+}
+
+bool loadFromMemory(const char* data, size_t size, LevelData& out, std::string& error) {
+    out.clear();
+
+    JsonValue root;
+    if (!JsonValue::parse(std::string_view(data, size), root, error)) {
+        return false;
+    }
+    if (!root.isObject()) {
+        error = "level root is not an object";
+        return false;
+    }
+
+    const float scale = root["tile_size"].asFloat(DEFAULT_TILE_SIZE);
+    out.tileSize = scale;
+    out.name = root["name"].asString(std::string());
+    out.size = sf::Vector2f(root["width"].asFloat() * scale, root["height"].asFloat() * scale);
+    if (out.size.x <= 0.f || out.size.y <= 0.f) {
+        error = "level has no width/height";
+        return false;
+    }
+    out.spawn = readPoint(root["spawn"], scale, sf::Vector2f(50.f, out.size.y / 2.f));
+    out.entryLeft = readPoint(root["entry_left"], scale, out.spawn);
+    out.entryRight = readPoint(root["entry_right"], scale, sf::Vector2f(out.size.x - 100.f, out.spawn.y));
+
+    const JsonValue& theme = root["theme"];
+    out.background = theme["background"].asString(std::string());
+    for (const JsonValue& path : theme["background_fallbacks"].getElements()) {
+        out.backgroundFallbacks.push_back(path.asString());
+    }
+    out.platformColor = readColor(theme["platform_color"], out.platformColor);
+    out.music = theme["music"].asString(std::string());
+    out.colorGrade = theme["color_grade"].asString(std::string());
+    out.gradeTint = readColor(theme["grade_tint"], out.gradeTint);
+    out.dayLength = std::max(theme["day_length"].asFloat(out.dayLength), 0.f);
+    out.ambientLight = readColor(theme["ambient_light"], out.ambientLight);
+
+    const JsonValue& physics = root["physics"];
+    out.gravity = physics["gravity"].asFloat(out.gravity);
+    out.jumpForce = physics["jump_force"].asFloat(out.jumpForce);
+    out.enemySpeed = root["enemy_speed"].asFloat(out.enemySpeed);
+
+    // Archetypes first so enemy entries can name them
+    for (const auto& [name, entry] : root["enemy_types"].getMembers()) {
+        LevelData::EnemyType* type = nullptr;
+        for (auto& existing : out.enemyTypes) {
+            if (existing.name == name) {
+                type = &existing;
+            }
+        }
+        if (!type) {
+            out.enemyTypes.emplace_back();
+            type = &out.enemyTypes.back();
+            type->name = name;
+        }
+        type->size = sf::Vector2f(entry["width"].asFloat(type->size.x / scale) * scale,
+                                  entry["height"].asFloat(type->size.y / scale) * scale);
+        type->speed = entry["speed"].asFloat(type->speed);
+        type->gravity = entry["gravity"].asFloat(type->gravity);
+        type->patrolWidth = entry["patrol"].asFloat(type->patrolWidth / scale) * scale;
+        type->color = readColor(entry["color"], type->color);
+    }
+
+    // Size every array before filling it so each is allocated at most once
+    const JsonValue& layers = root["layers"];
+    const JsonValue& terrain = layers["terrain"];
+    const JsonValue& ladders = layers["ladders"];
+    const JsonValue& decorations = layers["decoration"];
+    const JsonValue& enemies = layers["enemies"];
+    const JsonValue& npcs = layers["npcs"];
+    const JsonValue& triggers = layers["triggers"];
+    const JsonValue& lights = layers["lights"];
+    out.platforms.reserve(terrain.size());
+    out.ladders.reserve(ladders.size());
+    out.decorations.reserve(decorations.size());
+    out.enemies.reserve(enemies.size());
+    out.npcs.reserve(npcs.size());
+    out.lights.reserve(lights.size());
+
+    for (const JsonValue& entry : terrain.getElements()) {
+        if (entry["type"].asString("platform") != "platform") {
+            continue;
+        }
+        LevelData::Platform platform;
+        platform.bounds = sf::FloatRect({entry["x"].asFloat() * scale, entry["y"].asFloat() * scale},
+                                        {entry["width"].asFloat(1.f) * scale, entry["height"].asFloat(1.f) * scale});
+        platform.slope = readSlope(entry["slope_type"]);
+        out.platforms.push_back(platform);
+    }
+    for (const JsonValue& entry : ladders.getElements()) {
+        LevelData::Ladder ladder;
+        ladder.bounds = sf::FloatRect({entry["x"].asFloat() * scale, entry["y"].asFloat() * scale},
+                                      {entry["width"].asFloat(1.f) * scale, entry["height"].asFloat(1.f) * scale});
+        out.ladders.push_back(ladder);
+    }
+    for (const JsonValue& entry : decorations.getElements()) {
+        LevelData::Decoration decoration;
+        decoration.kind = readDecorationKind(entry["type"]);
+        decoration.position = sf::Vector2f(entry["x"].asFloat() * scale, entry["y"].asFloat() * scale);
+        decoration.height = entry["height"].asFloat(decorationCells(decoration.kind).y) * scale;
+        out.decorations.push_back(decoration);
+    }
+    for (const JsonValue& entry : enemies.getElements()) {
+        LevelData::EnemySpawn enemy;
+        const std::string& typeName = entry["type"].asString();
+        for (size_t t = 0; t < out.enemyTypes.size(); ++t) {
+            if (out.enemyTypes[t].name == typeName) {
+                enemy.type = static_cast<uint16_t>(t);
+            }
+        }
+        const float defaultPatrol = out.enemyTypes[enemy.type].patrolWidth;
+        enemy.position = sf::Vector2f(entry["x"].asFloat() * scale, entry["y"].asFloat() * scale);
+        enemy.patrolWidth = entry["patrol"].asFloat(defaultPatrol / scale) * scale;
+        out.enemies.push_back(enemy);
+    }
+    for (const JsonValue& entry : npcs.getElements()) {
+        LevelData::NpcSpawn npc;
+        npc.id = entry["id"].asString();
+        npc.texture = entry["texture"].asString("npc_idle");
+        npc.position = sf::Vector2f(entry["x"].asFloat() * scale, entry["y"].asFloat() * scale);
+        if (!npc.id.empty()) {
+            out.npcs.push_back(std::move(npc));
+        }
+    }
+    if (triggers.isArray()) {
+        out.triggers.reserve(triggers.size());
+        for (const JsonValue& entry : triggers.getElements()) {
+            LevelData::Trigger trigger;
+            trigger.id = entry["id"].asString(std::string());
+            trigger.bounds = sf::FloatRect({entry["x"].asFloat() * scale, entry["y"].asFloat() * scale},
+                                           {entry["width"].asFloat(1.f) * scale, entry["height"].asFloat(1.f) * scale});
+            trigger.action = readTriggerAction(entry["action"]);
+            trigger.grounded = entry["grounded"].asBool(false);
+            out.triggers.push_back(std::move(trigger));
+        }
+    } else {
+        addDefaultTriggers(out);
+    }
+    for (const JsonValue& entry : lights.getElements()) {
+        LevelData::Light light;
+        light.position = sf::Vector2f(entry["x"].asFloat() * scale, entry["y"].asFloat() * scale);
+        light.radius = entry["radius"].asFloat(light.radius / scale) * scale;
+        light.color = readColor(entry["color"], light.color);
+        if (light.radius > 0.f) {
+            out.lights.push_back(light);
+        }
+    }
+    resolveDecorations(out);
+    return true;
+}
+
+bool saveToFile(const LevelData& level, const std::string& path, std::string& error) {
+    const float scale = level.tileSize > 0.f ? level.tileSize : DEFAULT_TILE_SIZE;
+    auto unit = [scale](float pixels) { return jsonNumber(pixels / scale); };
+    auto point = [&unit](const sf::Vector2f& p) { return "{ \"x\": " + unit(p.x) + ", \"y\": " + unit(p.y) + " }"; };
+    auto box = [&unit](const sf::FloatRect& r) {
+        return "\"x\": " + unit(r.position.x) + ", \"y\": " + unit(r.position.y) + ", \"width\": " +
+               unit(r.size.x) + ", \"height\": " + unit(r.size.y);
+    };
+    // Records one per line, as the levels are written by hand
+    auto list = [](std::ostream& out, const char* name, size_t count, const auto& record, bool last) {
+        out << "    \"" << name << "\": [";
+        for (size_t i = 0; i < count; ++i) {
+            out << (i == 0 ? "\n" : ",\n") << "      " << record(i);
+        }
+        out << (count > 0 ? "\n    ]" : "]") << (last ? "\n" : ",\n");
+    };
+
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            error = "Failed to open " + temporary + " for writing";
+            return false;
+        }
+        out << "{\n";
+        out << "  \"name\": " << jsonString(level.name) << ",\n";
+        out << "  \"tile_size\": " << jsonNumber(scale) << ",\n";
+        out << "  \"width\": " << unit(level.size.x) << ",\n";
+        out << "  \"height\": " << unit(level.size.y) << ",\n";
+        out << "  \"spawn\": " << point(level.spawn) << ",\n";
+        out << "  \"entry_left\": " << point(level.entryLeft) << ",\n";
+        out << "  \"entry_right\": " << point(level.entryRight) << ",\n";
+
+        out << "  \"theme\": {\n";
+        out << "    \"background\": " << jsonString(level.background) << ",\n";
+        out << "    \"background_fallbacks\": [";
+        for (size_t i = 0; i < level.backgroundFallbacks.size(); ++i) {
+            out << (i == 0 ? "" : ", ") << jsonString(level.backgroundFallbacks[i]);
+        }
+        out << "],\n";
+        out << "    \"platform_color\": " << jsonColor(level.platformColor) << ",\n";
+        out << "    \"music\": " << jsonString(level.music) << ",\n";
+        out << "    \"color_grade\": " << jsonString(level.colorGrade) << ",\n";
+        out << "    \"grade_tint\": " << jsonColor(level.gradeTint) << ",\n";
+        out << "    \"day_length\": " << jsonNumber(level.dayLength) << ",\n";
+        out << "    \"ambient_light\": " << jsonColor(level.ambientLight) << "\n";
+        out << "  },\n";
+        out << "  \"physics\": { \"gravity\": " << jsonNumber(level.gravity) << ", \"jump_force\": "
+            << jsonNumber(level.jumpForce) << " },\n";
+        out << "  \"enemy_speed\": " << jsonNumber(level.enemySpeed) << ",\n";
+
+        out << "  \"enemy_types\": {";
+        for (size_t t = 0; t < level.enemyTypes.size(); ++t) {
+            const LevelData::EnemyType& type = level.enemyTypes[t];
+            out << (t == 0 ? "\n" : ",\n") << "    " << jsonString(type.name) << ": { \"width\": " << unit(type.size.x)
+                << ", \"height\": " << unit(type.size.y) << ", \"speed\": " << jsonNumber(type.speed)
+                << ", \"gravity\": " << jsonNumber(type.gravity) << ", \"patrol\": " << unit(type.patrolWidth)
+                << ", \"color\": " << jsonColor(type.color) << " }";
+        }
+        out << (level.enemyTypes.empty() ? "},\n" : "\n  },\n");
+
+        out << "  \"layers\": {\n";
+        list(out, "terrain", level.platforms.size(), [&](size_t i) {
+            const LevelData::Platform& platform = level.platforms[i];
+            const char* slope = platform.slope == LevelData::Slope::Left ? "\"left\""
+                              : platform.slope == LevelData::Slope::Right ? "\"right\"" : "null";
+            return "{ \"type\": \"platform\", " + box(platform.bounds) + ", \"slope_type\": " + slope + " }";
+        }, false);
+        list(out, "ladders", level.ladders.size(), [&](size_t i) {
+            return "{ " + box(level.ladders[i].bounds) + " }";
+        }, false);
+        list(out, "decoration", level.decorations.size(), [&](size_t i) {
+            const LevelData::Decoration& decoration = level.decorations[i];
+            return std::string("{ \"type\": \"") + decorationKindName(decoration.kind) + "\", \"x\": " +
+                   unit(decoration.position.x) + ", \"y\": " + unit(decoration.position.y) + ", \"height\": " +
+                   unit(decoration.height) + " }";
+        }, false);
+        list(out, "enemies", level.enemies.size(), [&](size_t i) {
+            const LevelData::EnemySpawn& enemy = level.enemies[i];
+            const std::string& type = enemy.type < level.enemyTypes.size() ? level.enemyTypes[enemy.type].name
+                                                                             : level.enemyTypes.front().name;
+            return "{ \"x\": " + unit(enemy.position.x) + ", \"y\": " + unit(enemy.position.y) + ", \"patrol\": " +
+                   unit(enemy.patrolWidth) + ", \"type\": " + jsonString(type) + " }";
+        }, false);
+        list(out, "npcs", level.npcs.size(), [&](size_t i) {
+            const LevelData::NpcSpawn& npc = level.npcs[i];
+            return "{ \"id\": " + jsonString(npc.id) + ", \"texture\": " + jsonString(npc.texture) + ", \"x\": " +
+                   unit(npc.position.x) + ", \"y\": " + unit(npc.position.y) + " }";
+        }, false);
+        list(out, "triggers", level.triggers.size(), [&](size_t i) {
+            const LevelData::Trigger& trigger = level.triggers[i];
+            return "{ \"id\": " + jsonString(trigger.id) + ", " + box(trigger.bounds) + ", \"action\": \"" +
+                   triggerActionName(trigger.action) + "\", \"grounded\": " + (trigger.grounded ? "true" : "false") +
+                   " }";
+        }, false);
+        list(out, "lights", level.lights.size(), [&](size_t i) {
+            const LevelData::Light& light = level.lights[i];
+            return "{ \"x\": " + unit(light.position.x) + ", \"y\": " + unit(light.position.y) + ", \"radius\": " +
+                   unit(light.radius) + ", \"color\": " + jsonColor(light.color) + " }";
+        }, true);
+        out << "  }\n";
+        out << "}\n";
+        if (!out.good()) {
+            error = "Failed to write " + temporary;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temporary, path, ec);
+    if (ec) {
+        std::filesystem::remove(temporary, ec);
+        error = "Failed to replace " + path + ": " + ec.message();
+        return false;
+    }
+    return true;
+}
+
+bool loadCookedFromFile(const std::string& path, LevelData& out, std::string& error) {
+    // Packed files are already mapped; loose ones get a mapping for the duration of the load
+    MappedFile file;
+    const char* data = nullptr;
+    size_t size = 0;
+    if (AssetPack::Blob blob = AssetPack::instance().find(path)) {
+        data = blob.data;
+        size = blob.size;
+    } else if (file.open(path)) {
+        data = file.data();
+        size = file.size();
+    } else {
+        out.clear();
+        error = "Failed to open cooked level: " + path;
+        return false;
+    }
+
+    if (!loadCookedFromMemory(data, size, out, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    out.source = path;
+    return true;
+}
+
+bool loadCookedFromMemory(const char* data, size_t size, LevelData& out, std::string& error) {
+    using namespace CookedLevel;
+    out.clear();
+
+    Header header;
+    if (size < sizeof(Header)) {
+        error = "cooked level is truncated";
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(Header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        error = "not a cooked level";
+        return false;
+    }
+    if (header.version != VERSION) {
+        error = "cooked level version " + std::to_string(header.version) + ", expected " + std::to_string(VERSION);
+        return false;
+    }
+    if (header.stringTableOffset > size || header.stringTableSize > size - header.stringTableOffset) {
+        error = "cooked level string table out of range";
+        return false;
+    }
+
+    // Validate every array before touching any of them
+    const char* strings = data + header.stringTableOffset;
+    const StringRef* fallbacks = cookedArray<StringRef>(data, size, header.backgroundFallbacks);
+    const PlatformRecord* platforms = cookedArray<PlatformRecord>(data, size, header.platforms);
+    const LadderRecord* ladders = cookedArray<LadderRecord>(data, size, header.ladders);
+    const DecorationRecord* decorations = cookedArray<DecorationRecord>(data, size, header.decorations);
+    const DecorationQuadRecord* decorationQuads = cookedArray<DecorationQuadRecord>(data, size, header.decorationQuads);
+    const EnemyTypeRecord* enemyTypes = cookedArray<EnemyTypeRecord>(data, size, header.enemyTypes);
+    const EnemyRecord* enemies = cookedArray<EnemyRecord>(data, size, header.enemies);
+    const NpcRecord* npcs = cookedArray<NpcRecord>(data, size, header.npcs);
+    const TriggerRecord* triggers = cookedArray<TriggerRecord>(data, size, header.triggers);
+    const LightRecord* lights = cookedArray<LightRecord>(data, size, header.lights);
+    if ((header.backgroundFallbacks.count && !fallbacks) || (header.platforms.count && !platforms) ||
+        (header.ladders.count && !ladders) || (header.decorations.count && !decorations) ||
+        (header.decorationQuads.count && !decorationQuads) ||
+        (header.enemyTypes.count && !enemyTypes) || (header.enemies.count && !enemies) ||
+        (header.npcs.count && !npcs) || (header.triggers.count && !triggers) || (header.lights.count && !lights)) {
+        error = "cooked level array out of range";
+        return false;
+    }
+    bool stringsValid = true;
+    auto readString = [&](const StringRef& ref) {
+        if (ref.offset > header.stringTableSize || ref.length > header.stringTableSize - ref.offset) {
+            stringsValid = false;
+            return std::string();
+        }
+        return std::string(strings + ref.offset, ref.length);
+    };
+
+    out.name = readString(header.name);
+    out.size = sf::Vector2f(header.width, header.height);
+    out.tileSize = header.tileSize;
+    out.spawn = sf::Vector2f(header.spawn[0], header.spawn[1]);
+    out.entryLeft = sf::Vector2f(header.entryLeft[0], header.entryLeft[1]);
+    out.entryRight = sf::Vector2f(header.entryRight[0], header.entryRight[1]);
+    out.background = readString(header.background);
+    out.music = readString(header.music);
+    out.colorGrade = readString(header.colorGrade);
+    out.gradeTint = sf::Color(header.gradeTint[0], header.gradeTint[1], header.gradeTint[2], header.gradeTint[3]);
+    out.dayLength = header.dayLength;
+    out.ambientLight = sf::Color(header.ambientLight[0], header.ambientLight[1], header.ambientLight[2],
+                                 header.ambientLight[3]);
+    out.platformColor = sf::Color(header.platformColor[0], header.platformColor[1],
+                                  header.platformColor[2], header.platformColor[3]);
+    out.gravity = header.gravity;
+    out.jumpForce = header.jumpForce;
+    out.enemySpeed = header.enemySpeed;
+
+    out.backgroundFallbacks.reserve(header.backgroundFallbacks.count);
+    for (uint32_t i = 0; i < header.backgroundFallbacks.count; ++i) {
+        out.backgroundFallbacks.push_back(readString(fallbacks[i]));
+    }
+    out.platforms.resize(header.platforms.count);
+    for (uint32_t i = 0; i < header.platforms.count; ++i) {
+        const PlatformRecord& record = platforms[i];
+        out.platforms[i].bounds = sf::FloatRect({record.x, record.y}, {record.width, record.height});
+        out.platforms[i].slope = static_cast<LevelData::Slope>(record.slope);
+    }
+    out.ladders.resize(header.ladders.count);
+    for (uint32_t i = 0; i < header.ladders.count; ++i) {
+        const LadderRecord& record = ladders[i];
+        out.ladders[i].bounds = sf::FloatRect({record.x, record.y}, {record.width, record.height});
+    }
+    out.decorations.resize(header.decorations.count);
+    for (uint32_t i = 0; i < header.decorations.count; ++i) {
+        const DecorationRecord& record = decorations[i];
+        out.decorations[i].position = sf::Vector2f(record.x, record.y);
+        out.decorations[i].height = record.height;
+        out.decorations[i].kind = static_cast<LevelData::DecorationKind>(record.kind);
+    }
+    out.decorationQuads.resize(header.decorationQuads.count);
+    for (uint32_t i = 0; i < header.decorationQuads.count; ++i) {
+        const DecorationQuadRecord& record = decorationQuads[i];
+        LevelData::DecorationQuad& quad = out.decorationQuads[i];
+        quad.bounds = sf::FloatRect({record.x, record.y}, {record.width, record.height});
+        // Out-of-range enums would index the renderer's tile tables
+        quad.kind = record.kind <= static_cast<uint8_t>(LevelData::DecorationKind::Snowman)
+            ? static_cast<LevelData::DecorationKind>(record.kind) : LevelData::DecorationKind::Other;
+        quad.part = record.part <= static_cast<uint8_t>(LevelData::DecorationPart::Bottom)
+            ? static_cast<LevelData::DecorationPart>(record.part) : LevelData::DecorationPart::Whole;
+        quad.depth = record.depth;
+    }
+    // The cooker always writes the default type first
+    if (header.enemyTypes.count > 0) {
+        out.enemyTypes.resize(header.enemyTypes.count);
+    }
+    for (uint32_t i = 0; i < header.enemyTypes.count; ++i) {
+        const EnemyTypeRecord& record = enemyTypes[i];
+        LevelData::EnemyType& type = out.enemyTypes[i];
+        type.name = readString(record.name);
+        type.size = sf::Vector2f(record.width, record.height);
+        type.speed = record.speed;
+        type.gravity = record.gravity;
+        type.patrolWidth = record.patrolWidth;
+        type.color = sf::Color(record.color[0], record.color[1], record.color[2], record.color[3]);
+    }
+    out.enemies.resize(header.enemies.count);
+    for (uint32_t i = 0; i < header.enemies.count; ++i) {
+        const EnemyRecord& record = enemies[i];
+        out.enemies[i].position = sf::Vector2f(record.x, record.y);
+        out.enemies[i].patrolWidth = record.patrolWidth;
+        out.enemies[i].type = record.type < out.enemyTypes.size() ? record.type : 0;
+    }
+    out.npcs.resize(header.npcs.count);
+    for (uint32_t i = 0; i < header.npcs.count; ++i) {
+        const NpcRecord& record = npcs[i];
+        out.npcs[i].id = readString(record.id);
+        out.npcs[i].texture = readString(record.texture);
+        out.npcs[i].position = sf::Vector2f(record.x, record.y);
+    }
+    out.triggers.resize(header.triggers.count);
+    for (uint32_t i = 0; i < header.triggers.count; ++i) {
+        const TriggerRecord& record = triggers[i];
+        LevelData::Trigger& trigger = out.triggers[i];
+        trigger.id = readString(record.id);
+        trigger.bounds = sf::FloatRect({record.x, record.y}, {record.width, record.height});
+        trigger.action = record.action <= static_cast<uint8_t>(LevelData::TriggerAction::Kill)
+            ? static_cast<LevelData::TriggerAction>(record.action) : LevelData::TriggerAction::Event;
+        trigger.grounded = record.grounded != 0;
+    }
+    out.lights.resize(header.lights.count);
+    for (uint32_t i = 0; i < header.lights.count; ++i) {
+        const LightRecord& record = lights[i];
+        out.lights[i].position = sf::Vector2f(record.x, record.y);
+        out.lights[i].radius = record.radius;
+        out.lights[i].color = sf::Color(record.color[0], record.color[1], record.color[2], record.color[3]);
+    }
+
+    if (!stringsValid || out.size.x <= 0.f || out.size.y <= 0.f) {
+        out.clear();
+        error = "cooked level is corrupt";
+        return false;
+    }
+    return true;
+}
+
+void addDefaultTriggers(LevelData& level) {
+    // Far past the level on the open sides, so nothing gets round them
+    const float margin = std::max(level.size.x, level.size.y);
+    auto add = [&level](const char* id, const sf::FloatRect& bounds, LevelData::TriggerAction action, bool grounded) {
+        LevelData::Trigger trigger;
+        trigger.id = id;
+        trigger.bounds = bounds;
+        trigger.action = action;
+        trigger.grounded = grounded;
+        level.triggers.push_back(std::move(trigger));
+    };
+    add("fall", sf::FloatRect({-margin, level.size.y + 200.f}, {level.size.x + 2.f * margin, margin}),
+        LevelData::TriggerAction::Kill, false);
+    add("exit_right", sf::FloatRect({level.size.x - 50.f, -margin}, {50.f + margin, level.size.y + 2.f * margin}),
+        LevelData::TriggerAction::ExitNext, true);
+    add("exit_left", sf::FloatRect({-margin, -margin}, {margin + 10.f, level.size.y + 2.f * margin}),
+        LevelData::TriggerAction::ExitBack, true);
+}
+
+sf::FloatRect getDecorationBounds(const LevelData& level, const LevelData::Decoration& decoration) {
+    return sf::FloatRect(decoration.position,
+                         sf::Vector2f(decorationCells(decoration.kind).x * level.tileSize, decoration.height));
+}
+
+void resolveDecorations(LevelData& level) {
+    level.decorationQuads.clear();
+    for (const LevelData::Decoration& decoration : level.decorations) {
+        if (!(decoration.height > 0.f)) {
+            continue;
+        }
+        const float width = decorationCells(decoration.kind).x * level.tileSize;
+        int rows = 1;
+        if (decoration.kind == LevelData::DecorationKind::Tree && level.tileSize > 0.f) {
+            rows = std::clamp(static_cast<int>(std::lround(decoration.height / level.tileSize)), 1, MAX_DECORATION_ROWS);
+        }
+        const float rowHeight = decoration.height / static_cast<float>(rows);
+        for (int row = 0; row < rows; ++row) {
+            LevelData::DecorationQuad quad;
+            quad.bounds = sf::FloatRect({decoration.position.x, decoration.position.y + row * rowHeight},
+                                        {width, rowHeight});
+            quad.kind = decoration.kind;
+            quad.part = rows == 1 ? LevelData::DecorationPart::Whole
+                : row == 0 ? LevelData::DecorationPart::Top
+                : row == rows - 1 ? LevelData::DecorationPart::Bottom
+                : LevelData::DecorationPart::Middle;
+            quad.depth = decorationDepth(decoration.kind);
+            level.decorationQuads.push_back(quad);
+        }
+    }
+    // Once, here: the renderer bakes quads in this order
+    std::stable_sort(level.decorationQuads.begin(), level.decorationQuads.end(),
+                     [](const LevelData::DecorationQuad& a, const LevelData::DecorationQuad& b) {
+                         return a.depth < b.depth;
+                     });
+}
+
+} // namespace LevelLoader
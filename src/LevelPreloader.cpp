@@ -0,0 +1,106 @@
+#include "LevelPreloader.hpp"
+#include "Profiler.hpp"
+#include "AllocationTracker.hpp"
+#include <chrono>
+#include <utility>
+
+LevelPreloader::LevelPreloader() {
+    loader = std::thread(&LevelPreloader::loaderLoop, this);
+}
+
+LevelPreloader::~LevelPreloader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        queuedLevel = 0;
+    }
+    loadCondition.notify_all();
+    if (loader.joinable()) {
+        loader.join();
+    }
+}
+
+void LevelPreloader::waitIdle(std::unique_lock<std::mutex>& lock) {
+    idleCondition.wait(lock, [this] { return queuedLevel == 0 && !busy; });
+}
+
+bool LevelPreloader::request(int level) {
+    if (has(level)) {
+        return false;
+    }
+    {
+        // Loads aren't interruptible (a single file); a superseded one finishes first
+        std::unique_lock<std::mutex> lock(mutex);
+        queuedLevel = 0;
+        waitIdle(lock);
+        queuedLevel = level;
+    }
+    heldLevel = level;
+    loadCondition.notify_one();
+    return true;
+}
+
+void LevelPreloader::cancel() {
+    std::unique_lock<std::mutex> lock(mutex);
+    queuedLevel = 0;
+    waitIdle(lock);
+    heldLevel = 0;
+}
+
+bool LevelPreloader::isReady() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return heldLevel != 0 && queuedLevel == 0 && !busy;
+}
+
+const LevelData* LevelPreloader::peek(int level) const {
+    return has(level) && isReady() && loaded ? &data : nullptr;
+}
+
+double LevelPreloader::getLoadMs() const {
+    return isReady() ? loadMs : 0.0;
+}
+
+bool LevelPreloader::take(int level, LevelData& out, std::string& error) {
+    if (!has(level)) {
+        error = "level " + std::to_string(level) + " was not preloaded";
+        return false;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    waitIdle(lock);
+    heldLevel = 0;
+    if (!loaded) {
+        error = loadError;
+        out.clear();
+        return false;
+    }
+    std::swap(out, data);
+    return true;
+}
+
+void LevelPreloader::loaderLoop() {
+    PROFILE_THREAD("Level preloader");
+    AllocationTracker::setThreadTag(AllocationTracker::Tag::Level);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        loadCondition.wait(lock, [this] { return stopping || queuedLevel != 0; });
+        if (stopping) {
+            return;
+        }
+        const int level = queuedLevel;
+        queuedLevel = 0;
+        busy = true;
+        lock.unlock();
+
+        {
+            PROFILE_ZONE("LevelPreloader::load");
+            const auto start = std::chrono::steady_clock::now();
+            loadError.clear();
+            loaded = LevelLoader::loadLevel(level, data, loadError);
+            loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        lock.lock();
+        busy = false;
+        idleCondition.notify_all();
+    }
+}
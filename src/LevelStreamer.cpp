@@ -0,0 +1,363 @@
+#include "LevelStreamer.hpp"
+#include "Profiler.hpp"
+#include "AllocationTracker.hpp"
+#include <algorithm>
+#include <cmath>
+
+LevelStreamer::LevelStreamer() {
+    loader = std::thread(&LevelStreamer::loaderLoop, this);
+}
+
+LevelStreamer::~LevelStreamer() {
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        stopping = true;
+        requests.clear();
+    }
+    loadCondition.notify_all();
+    if (loader.joinable()) {
+        loader.join();
+    }
+}
+
+void LevelStreamer::clear() {
+    // Cancel queued loads and wait out the one in flight before touching sources
+    {
+        std::unique_lock<std::mutex> lock(loadMutex);
+        requests.clear();
+        idleCondition.wait(lock, [this] { return !loaderBusy; });
+        finished.clear();
+    }
+
+    // Swapped out rather than cleared, so no capacity is left pointing into the arena
+    LevelVector<sf::FloatRect>().swap(platformBounds);
+    LevelVector<LevelData::Slope>().swap(platformSlopes);
+    LevelVector<sf::FloatRect>().swap(ladderBounds);
+    LevelVector<SectorSource>().swap(sources);
+    LevelVector<LevelData::EnemyType>().swap(enemyTypes);
+    LevelVector<Sector>().swap(sectors);
+    LevelVector<uint32_t>().swap(platformStamps);
+    LevelVector<uint32_t>().swap(ladderStamps);
+    activeEnemyOrigins.clear();
+    activePlatforms.clear();
+    activeLadders.clear();
+    loads = 0;
+    evictions = 0;
+}
+
+void LevelStreamer::setLevel(const LevelData& level, const sf::Color& color) {
+    clear();
+
+    platformColor = color;
+    enemyTypes.assign(level.enemyTypes.begin(), level.enemyTypes.end());
+    enemySpeed = level.enemySpeed;
+    levelWidth = std::max(level.size.x, 1.f);
+
+    const size_t sectorCount = static_cast<size_t>(std::ceil(levelWidth / SECTOR_WIDTH));
+    sources.resize(sectorCount);
+    sectors.resize(sectorCount);
+
+    collectStamp = 0;
+    bucketGeometry(level);
+
+    // Enemies belong to their spawn sector only
+    for (const auto& spawn : level.enemies) {
+        sources[sectorIndex(spawn.position.x)].enemies.push_back(spawn);
+    }
+}
+
+void LevelStreamer::bucketGeometry(const LevelData& level) {
+    // Platforms and ladders go in every sector they overlap
+    platformBounds.reserve(level.platforms.size());
+    platformSlopes.reserve(level.platforms.size());
+    ladderBounds.reserve(level.ladders.size());
+    for (const auto& platform : level.platforms) {
+        const uint32_t index = static_cast<uint32_t>(platformBounds.size());
+        platformBounds.push_back(platform.bounds);
+        platformSlopes.push_back(platform.slope);
+        const int first = sectorIndex(platform.bounds.position.x);
+        const int last = sectorIndex(platform.bounds.position.x + platform.bounds.size.x);
+        for (int s = first; s <= last; ++s) {
+            sources[s].platforms.push_back(index);
+        }
+    }
+    for (const auto& ladder : level.ladders) {
+        const uint32_t index = static_cast<uint32_t>(ladderBounds.size());
+        ladderBounds.push_back(ladder.bounds);
+        const int first = sectorIndex(ladder.bounds.position.x);
+        const int last = sectorIndex(ladder.bounds.position.x + ladder.bounds.size.x);
+        for (int s = first; s <= last; ++s) {
+            sources[s].ladders.push_back(index);
+        }
+    }
+    platformStamps.assign(platformBounds.size(), collectStamp);
+    ladderStamps.assign(ladderBounds.size(), collectStamp);
+}
+
+void LevelStreamer::setGeometry(const LevelData& level) {
+    // Cleared, not swapped out: the arena storage is reused while it fits
+    platformBounds.clear();
+    platformSlopes.clear();
+    ladderBounds.clear();
+    for (SectorSource& source : sources) {
+        source.platforms.clear();
+        source.ladders.clear();
+    }
+    bucketGeometry(level);
+}
+
+bool LevelStreamer::isResident(const sf::FloatRect& bounds) const {
+    const int last = sectorIndex(bounds.position.x + bounds.size.x);
+    for (int s = sectorIndex(bounds.position.x); s <= last; ++s) {
+        if (sectors[s].state == SectorState::Active) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void LevelStreamer::rebucket(LevelVector<uint32_t> SectorSource::*list, uint32_t index, const sf::FloatRect& from,
+                             const sf::FloatRect& to) {
+    const int oldFirst = sectorIndex(from.position.x);
+    const int oldLast = sectorIndex(from.position.x + from.size.x);
+    const int newFirst = sectorIndex(to.position.x);
+    const int newLast = sectorIndex(to.position.x + to.size.x);
+    for (int s = oldFirst; s <= oldLast; ++s) {
+        if (s < newFirst || s > newLast) {
+            LevelVector<uint32_t>& records = sources[s].*list;
+            records.erase(std::remove(records.begin(), records.end(), index), records.end());
+        }
+    }
+    for (int s = newFirst; s <= newLast; ++s) {
+        if (s < oldFirst || s > oldLast) {
+            (sources[s].*list).push_back(index);
+        }
+    }
+}
+
+bool LevelStreamer::movePlatform(uint32_t index, const sf::FloatRect& bounds, LevelData::Slope slope) {
+    if (index >= platformBounds.size() || sectors.empty()) {
+        return false;
+    }
+    const bool wasResident = isResident(platformBounds[index]);
+    rebucket(&SectorSource::platforms, index, platformBounds[index], bounds);
+    platformBounds[index] = bounds;
+    platformSlopes[index] = slope;
+    return wasResident != isResident(bounds);
+}
+
+bool LevelStreamer::moveLadder(uint32_t index, const sf::FloatRect& bounds) {
+    if (index >= ladderBounds.size() || sectors.empty()) {
+        return false;
+    }
+    const bool wasResident = isResident(ladderBounds[index]);
+    rebucket(&SectorSource::ladders, index, ladderBounds[index], bounds);
+    ladderBounds[index] = bounds;
+    return wasResident != isResident(bounds);
+}
+
+int LevelStreamer::findActivePlatform(uint32_t index) const {
+    auto found = std::find(activePlatforms.begin(), activePlatforms.end(), index);
+    return found != activePlatforms.end() ? static_cast<int>(found - activePlatforms.begin()) : -1;
+}
+
+int LevelStreamer::findActiveLadder(uint32_t index) const {
+    auto found = std::find(activeLadders.begin(), activeLadders.end(), index);
+    return found != activeLadders.end() ? static_cast<int>(found - activeLadders.begin()) : -1;
+}
+
+int LevelStreamer::sectorIndex(float x) const {
+    const int index = static_cast<int>(std::floor(x / SECTOR_WIDTH));
+    return std::clamp(index, 0, std::max(static_cast<int>(sectors.size()) - 1, 0));
+}
+
+std::unique_ptr<LevelStreamer::SectorContent> LevelStreamer::buildSector(uint32_t sector) const {
+    PROFILE_ZONE("LevelStreamer::buildSector");
+    const SectorSource& source = sources[sector];
+    auto content = std::make_unique<SectorContent>();
+
+    content->enemies.reserve(source.enemies.size());
+    for (const auto& spawn : source.enemies) {
+        // Keep enemies off the left edge and start them moving right, scaled by level
+        sf::Vector2f position = spawn.position;
+        if (position.x < 50.0f) {
+            position.x = 100.0f;
+        }
+        const uint16_t type = spawn.type < enemyTypes.size() ? spawn.type : 0;
+        content->enemies.spawn(enemyTypes[type], type, position, spawn.patrolWidth, enemySpeed);
+    }
+    return content;
+}
+
+void LevelStreamer::adopt(uint32_t sector, std::unique_ptr<SectorContent> content) {
+    Sector& target = sectors[sector];
+    if (!target.enemiesSpawned) {
+        target.enemies = std::move(content->enemies);
+        target.enemiesSpawned = true;
+    }
+    content->enemies.clear();
+    target.content = std::move(content);
+    target.state = SectorState::Active;
+    ++loads;
+}
+
+void LevelStreamer::evict(uint32_t sector) {
+    // Any load still in flight is dropped when it arrives
+    sectors[sector].content.reset();
+    sectors[sector].state = SectorState::Unloaded;
+    ++evictions;
+}
+
+void LevelStreamer::loadNow(float left, float right) {
+    if (sectors.empty()) {
+        return;
+    }
+    const int first = sectorIndex(left - LOAD_MARGIN);
+    const int last = sectorIndex(right + LOAD_MARGIN);
+    for (int s = first; s <= last; ++s) {
+        if (sectors[s].state != SectorState::Active) {
+            adopt(static_cast<uint32_t>(s), buildSector(static_cast<uint32_t>(s)));
+        }
+    }
+}
+
+bool LevelStreamer::update(float left, float right) {
+    if (sectors.empty()) {
+        return false;
+    }
+    bool changed = false;
+
+    // Adopt loads that are still wanted
+    std::vector<FinishedLoad> done;
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        done.swap(finished);
+    }
+    for (auto& load : done) {
+        if (sectors[load.sector].state == SectorState::Pending) {
+            adopt(load.sector, std::move(load.content));
+            changed = true;
+        }
+    }
+
+    // Request near sectors, evict far ones; the band between keeps its state
+    const int wantFirst = sectorIndex(left - LOAD_MARGIN);
+    const int wantLast = sectorIndex(right + LOAD_MARGIN);
+    const int keepFirst = sectorIndex(left - EVICT_MARGIN);
+    const int keepLast = sectorIndex(right + EVICT_MARGIN);
+    bool requested = false;
+    for (int s = 0; s < static_cast<int>(sectors.size()); ++s) {
+        Sector& sector = sectors[s];
+        if (s >= wantFirst && s <= wantLast) {
+            if (sector.state == SectorState::Unloaded) {
+                sector.state = SectorState::Pending;
+                std::lock_guard<std::mutex> lock(loadMutex);
+                requests.push_back(static_cast<uint32_t>(s));
+                requested = true;
+            }
+        } else if ((s < keepFirst || s > keepLast) && sector.state != SectorState::Unloaded) {
+            changed |= sector.state == SectorState::Active;
+            evict(static_cast<uint32_t>(s));
+        }
+    }
+    if (requested) {
+        loadCondition.notify_one();
+    }
+
+    // The loader fell behind (or the camera jumped): never leave the view without ground
+    for (int s = sectorIndex(left); s <= sectorIndex(right); ++s) {
+        if (sectors[s].state != SectorState::Active) {
+            adopt(static_cast<uint32_t>(s), buildSector(static_cast<uint32_t>(s)));
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void LevelStreamer::collect(LevelGeometry& platforms, LevelGeometry& ladders, EnemyStore& enemies) {
+    // Park the enemies simulated since the last collect
+    for (size_t i = 0; i < enemies.size() && i < activeEnemyOrigins.size(); ++i) {
+        const EnemyOrigin& origin = activeEnemyOrigins[i];
+        sectors[origin.sector].enemies.assign(origin.slot, enemies, i);
+    }
+
+    platforms.clear();
+    ladders.clear();
+    enemies.clear();
+    activeEnemyOrigins.clear();
+    activePlatforms.clear();
+    activeLadders.clear();
+    ++collectStamp;
+
+    for (uint32_t s = 0; s < sectors.size(); ++s) {
+        Sector& sector = sectors[s];
+        if (sector.state != SectorState::Active) {
+            continue;
+        }
+        const SectorSource& source = sources[s];
+        for (uint32_t platform : source.platforms) {
+            uint32_t& stamp = platformStamps[platform];
+            if (stamp != collectStamp) {
+                stamp = collectStamp;
+                platforms.add(platformBounds[platform], platformColor, platformSlopes[platform]);
+                activePlatforms.push_back(platform);
+            }
+        }
+        for (uint32_t ladder : source.ladders) {
+            uint32_t& stamp = ladderStamps[ladder];
+            if (stamp != collectStamp) {
+                stamp = collectStamp;
+                ladders.add(ladderBounds[ladder], LADDER_COLOR);
+                activeLadders.push_back(ladder);
+            }
+        }
+        for (uint32_t slot = 0; slot < sector.enemies.size(); ++slot) {
+            enemies.append(sector.enemies, slot);
+            activeEnemyOrigins.push_back(EnemyOrigin{s, slot});
+        }
+    }
+}
+
+LevelStreamer::Stats LevelStreamer::getStats() const {
+    Stats stats;
+    stats.sectorCount = sectors.size();
+    stats.loads = loads;
+    stats.evictions = evictions;
+    bool any = false;
+    for (size_t s = 0; s < sectors.size(); ++s) {
+        if (sectors[s].state == SectorState::Pending) {
+            ++stats.pendingSectors;
+        } else if (sectors[s].state == SectorState::Active) {
+            const float left = s * SECTOR_WIDTH;
+            const float right = std::min(left + SECTOR_WIDTH, levelWidth);
+            stats.activeLeft = any ? std::min(stats.activeLeft, left) : left;
+            stats.activeRight = any ? std::max(stats.activeRight, right) : right;
+            any = true;
+            ++stats.activeSectors;
+        }
+    }
+    return stats;
+}
+
+void LevelStreamer::loaderLoop() {
+    PROFILE_THREAD("Level streamer");
+    AllocationTracker::setThreadTag(AllocationTracker::Tag::Level);
+    std::unique_lock<std::mutex> lock(loadMutex);
+    while (true) {
+        loadCondition.wait(lock, [this] { return stopping || !requests.empty(); });
+        if (stopping) {
+            return;
+        }
+        const uint32_t sector = requests.front();
+        requests.pop_front();
+        loaderBusy = true;
+        lock.unlock();
+
+        std::unique_ptr<SectorContent> content = buildSector(sector);
+
+        lock.lock();
+        loaderBusy = false;
+        finished.push_back(FinishedLoad{sector, std::move(content)});
+        idleCondition.notify_all();
+    }
+}
@@ -0,0 +1,84 @@
+#include "LogFormat.hpp"
+#include <cinttypes>
+#include <cstdio>
+
+namespace LogFormat {
+
+namespace {
+
+// Appends the argument at 'offset' and moves past it; false at the end or on a bad type byte
+bool appendArgument(const char* payload, size_t size, size_t& offset, std::string& out) {
+    if (offset >= size) {
+        return false;
+    }
+    const ArgType type = static_cast<ArgType>(payload[offset++]);
+    char number[32];
+    auto read = [&](void* value, size_t bytes) {
+        if (offset + bytes > size) {
+            return false;
+        }
+        std::memcpy(value, payload + offset, bytes);
+        offset += bytes;
+        return true;
+    };
+    switch (type) {
+        case ArgType::Int: {
+            int64_t value = 0;
+            if (!read(&value, sizeof(value))) return false;
+            std::snprintf(number, sizeof(number), "%" PRId64, value);
+            out += number;
+            return true;
+        }
+        case ArgType::Uint: {
+            uint64_t value = 0;
+            if (!read(&value, sizeof(value))) return false;
+            std::snprintf(number, sizeof(number), "%" PRIu64, value);
+            out += number;
+            return true;
+        }
+        case ArgType::Double: {
+            double value = 0.0;
+            if (!read(&value, sizeof(value))) return false;
+            std::snprintf(number, sizeof(number), "%g", value);
+            out += number;
+            return true;
+        }
+        case ArgType::Bool: {
+            bool value = false;
+            if (!read(&value, sizeof(value))) return false;
+            out += value ? "true" : "false";
+            return true;
+        }
+        case ArgType::String: {
+            uint16_t length = 0;
+            if (!read(&length, sizeof(length)) || offset + length > size) return false;
+            out.append(payload + offset, length);
+            offset += length;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+void appendFormatted(const char* format, const char* payload, size_t size, bool truncated, std::string& out) {
+    size_t offset = 0;
+    for (const char* c = format; *c; ++c) {
+        if (c[0] == '{' && c[1] == '}') {
+            if (!appendArgument(payload, size, offset, out)) {
+                out += "{?}";
+            }
+            ++c;
+        } else if ((c[0] == '{' && c[1] == '{') || (c[0] == '}' && c[1] == '}')) {
+            out += *c++;
+        } else {
+            out += *c;
+        }
+    }
+    if (truncated) {
+        out += "...";
+    }
+}
+
+} // namespace LogFormat
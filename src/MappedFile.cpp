@@ -0,0 +1,116 @@
+#include "MappedFile.hpp"
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        base = other.base;
+        mappedSize = other.mappedSize;
+        other.base = nullptr;
+        other.mappedSize = 0;
+#ifdef _WIN32
+        fileHandle = other.fileHandle;
+        mappingHandle = other.mappingHandle;
+        other.fileHandle = nullptr;
+        other.mappingHandle = nullptr;
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    base = static_cast<const char*>(view);
+    mappedSize = static_cast<size_t>(size.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void* view = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps the file alive
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    base = static_cast<const char*>(view);
+    mappedSize = static_cast<size_t>(info.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::close() {
+    if (!base) return;
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+    CloseHandle(static_cast<HANDLE>(mappingHandle));
+    CloseHandle(static_cast<HANDLE>(fileHandle));
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    ::munmap(const_cast<char*>(base), mappedSize);
+#endif
+    base = nullptr;
+    mappedSize = 0;
+}
+
+#ifdef _WIN32
+void MappedFile::willNeed(size_t, size_t) const {}
+void MappedFile::dontNeed(size_t, size_t) const {}
+#else
+void MappedFile::willNeed(size_t offset, size_t size) const {
+    if (!base || offset >= mappedSize) return;
+    // madvise wants a page-aligned start; the view itself is page-aligned
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t start = offset / page * page;
+    const size_t end = std::min(offset + size, mappedSize);
+    ::madvise(const_cast<char*>(base) + start, end - start, MADV_WILLNEED);
+}
+
+void MappedFile::dontNeed(size_t offset, size_t size) const {
+    if (!base || offset >= mappedSize) return;
+    // Only whole pages, so neighbouring data keeps its pages
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t start = (offset + page - 1) / page * page;
+    const size_t end = std::min(offset + size, mappedSize) / page * page;
+    if (end > start) {
+        ::madvise(const_cast<char*>(base) + start, end - start, MADV_DONTNEED);
+    }
+}
+#endif
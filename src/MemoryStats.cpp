@@ -0,0 +1,57 @@
+#include "MemoryStats.hpp"
+
+namespace MemoryStats {
+
+namespace {
+
+const char* getEstimateName(Estimate estimate) {
+    switch (estimate) {
+        case Estimate::CharacterTextures: return "Character textures";
+        case Estimate::BackgroundTextures: return "Background textures";
+        case Estimate::TileTextures: return "Tile textures";
+        case Estimate::UiTextures: return "UI textures";
+        case Estimate::OtherTextures: return "Other textures";
+        case Estimate::AnimationFrames: return "Animation frames";
+        case Estimate::TileAtlas: return "Tile atlas";
+        case Estimate::RenderTargets: return "Render targets";
+        case Estimate::FontAtlas: return "ImGui font atlas";
+        case Estimate::AudioBuffers: return "Audio buffers";
+        case Estimate::Count: break;
+    }
+    return "?";
+}
+
+} // namespace
+
+uint64_t Sample::getHeapTotal() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < AllocationTracker::TAG_COUNT; ++i) {
+        total += bytes[i];
+    }
+    return total;
+}
+
+uint64_t Sample::getEstimateTotal() const {
+    uint64_t total = 0;
+    for (size_t i = AllocationTracker::TAG_COUNT; i < SLOT_COUNT; ++i) {
+        total += bytes[i];
+    }
+    return total;
+}
+
+Sample sampleHeap() {
+    Sample sample;
+    for (size_t i = 0; i < AllocationTracker::TAG_COUNT; ++i) {
+        sample.bytes[i] = AllocationTracker::getLiveBytes(static_cast<AllocationTracker::Tag>(i));
+    }
+    return sample;
+}
+
+const char* getSlotName(size_t slot) {
+    if (!isEstimate(slot)) {
+        return AllocationTracker::getTagName(static_cast<AllocationTracker::Tag>(slot));
+    }
+    return slot < SLOT_COUNT ? getEstimateName(static_cast<Estimate>(slot - AllocationTracker::TAG_COUNT)) : "?";
+}
+
+} // namespace MemoryStats
@@ -0,0 +1,197 @@
+#include "MessageBubbleCache.hpp"
+#include <algorithm>
+
+namespace {
+
+// Same look as the sf::RectangleShape + sf::Text bubbles these replace
+constexpr float PADDING = 20.0f;          // Box size around the text
+constexpr float TEXT_INSET = 10.0f;       // Text top below the box top
+constexpr float MIN_BOX_WIDTH = 180.0f;
+constexpr float MIN_BOX_HEIGHT = 60.0f;   // Tall enough for Chinese characters
+constexpr float OUTLINE = 2.0f;
+constexpr float VERTICAL_OFFSET = 50.0f;  // Gap between the box and its anchor
+constexpr float LINE_SPACING = 1.2f;
+const sf::Color FILL_COLOR(255, 255, 255, 230);
+const sf::Color OUTLINE_COLOR = sf::Color::Black;
+const sf::Color TEXT_COLOR = sf::Color::Black;
+const sf::Vector2f WHITE_TEXEL(1.0f, 1.0f); // SFML keeps a white square at the corner of every glyph page
+
+void addQuad(std::vector<sf::Vertex>& out, const sf::Vector2f& min, const sf::Vector2f& max, const sf::Color& color,
+             const sf::Vector2f& uvMin, const sf::Vector2f& uvMax) {
+    out.push_back(sf::Vertex{min, color, uvMin});
+    out.push_back(sf::Vertex{{max.x, min.y}, color, {uvMax.x, uvMin.y}});
+    out.push_back(sf::Vertex{{min.x, max.y}, color, {uvMin.x, uvMax.y}});
+    out.push_back(sf::Vertex{{min.x, max.y}, color, {uvMin.x, uvMax.y}});
+    out.push_back(sf::Vertex{{max.x, min.y}, color, {uvMax.x, uvMin.y}});
+    out.push_back(sf::Vertex{max, color, uvMax});
+}
+
+void addSolid(std::vector<sf::Vertex>& out, const sf::Vector2f& min, const sf::Vector2f& max, const sf::Color& color) {
+    addQuad(out, min, max, color, WHITE_TEXEL, WHITE_TEXEL);
+}
+
+} // namespace
+
+MessageBubbleCache::MessageBubbleCache(const sf::Font& font, size_t capacity)
+    : font(font), capacity(std::max<size_t>(capacity, 1)) {}
+
+void MessageBubbleCache::makeKey(const std::string& message, unsigned characterSize) {
+    keyScratch.assign(message);
+    keyScratch.push_back('\0');
+    keyScratch.append(reinterpret_cast<const char*>(&characterSize), sizeof(characterSize));
+}
+
+void MessageBubbleCache::unlink(uint32_t slot) {
+    Entry& entry = entries[slot];
+    if (entry.newer != NONE) entries[entry.newer].older = entry.older; else newest = entry.older;
+    if (entry.older != NONE) entries[entry.older].newer = entry.newer; else oldest = entry.newer;
+    entry.newer = entry.older = NONE;
+}
+
+void MessageBubbleCache::pushNewest(uint32_t slot) {
+    Entry& entry = entries[slot];
+    entry.older = newest;
+    entry.newer = NONE;
+    if (newest != NONE) entries[newest].newer = slot;
+    newest = slot;
+    if (oldest == NONE) oldest = slot;
+}
+
+MessageBubbleCache::Handle MessageBubbleCache::acquire(const std::string& message, unsigned characterSize) {
+    makeKey(message, characterSize);
+    auto it = slotsByKey.find(keyScratch);
+    if (it != slotsByKey.end()) {
+        stats.hits++;
+        unlink(it->second);
+        pushNewest(it->second);
+        return Handle{it->second, entries[it->second].generation};
+    }
+
+    // Miss: take a fresh slot, or recycle the least recently used one
+    stats.misses++;
+    uint32_t slot;
+    if (entries.size() < capacity) {
+        slot = static_cast<uint32_t>(entries.size());
+        entries.emplace_back();
+    } else {
+        slot = oldest;
+        unlink(slot);
+        if (!entries[slot].key.empty()) { // Cleared slots hold nothing to evict
+            slotsByKey.erase(entries[slot].key);
+            entries[slot].generation++;
+            stats.evictions++;
+        }
+    }
+    Entry& entry = entries[slot];
+    entry.key = keyScratch;
+    buildLayout(message, characterSize, entry.layout);
+    slotsByKey.emplace(entry.key, slot);
+    pushNewest(slot);
+    stats.entries = slotsByKey.size();
+    return Handle{slot, entry.generation};
+}
+
+const MessageBubbleCache::Layout& MessageBubbleCache::get(Handle& handle, const std::string& message,
+                                                          unsigned characterSize) {
+    if (handle.slot < entries.size() && entries[handle.slot].generation == handle.generation) {
+        stats.hits++;
+        unlink(handle.slot);
+        pushNewest(handle.slot);
+    } else {
+        handle = acquire(message, characterSize);
+    }
+    return entries[handle.slot].layout;
+}
+
+void MessageBubbleCache::clear() {
+    // Slots stay allocated (and linked, so they are recycled first); bumping
+    // the generations makes outstanding handles re-acquire
+    for (Entry& entry : entries) {
+        entry.generation++;
+        entry.key.clear();
+        entry.layout.vertices.clear();
+    }
+    slotsByKey.clear();
+    stats = Stats();
+}
+
+void MessageBubbleCache::buildLayout(const std::string& message, unsigned characterSize, Layout& layout) const {
+    layout.vertices.clear();
+    layout.characterSize = characterSize;
+
+    // Glyph quads laid out the way sf::Text does it, relative to the text origin
+    std::vector<sf::Vertex> glyphs;
+    const sf::String text = sf::String::fromUtf8(message.begin(), message.end());
+    const float whitespaceWidth = font.getGlyph(U' ', characterSize, false).advance;
+    const float lineSpacing = font.getLineSpacing(characterSize) * LINE_SPACING;
+    float x = 0.0f;
+    float y = static_cast<float>(characterSize);
+    float minX = static_cast<float>(characterSize);
+    float minY = static_cast<float>(characterSize);
+    float maxX = 0.0f;
+    float maxY = 0.0f;
+    char32_t previous = 0;
+    for (std::size_t i = 0; i < text.getSize(); ++i) {
+        const char32_t current = text[i];
+        if (current == U'\r') continue;
+        x += font.getKerning(previous, current, characterSize, false);
+        previous = current;
+
+        if (current == U' ' || current == U'\n' || current == U'\t') {
+            minX = std::min(minX, x);
+            minY = std::min(minY, y);
+            if (current == U' ') {
+                x += whitespaceWidth;
+            } else if (current == U'\t') {
+                x += whitespaceWidth * 4.0f;
+            } else {
+                y += lineSpacing;
+                x = 0.0f;
+            }
+            maxX = std::max(maxX, x);
+            maxY = std::max(maxY, y);
+            continue;
+        }
+
+        const sf::Glyph& glyph = font.getGlyph(current, characterSize, false);
+        const float left = glyph.bounds.position.x;
+        const float top = glyph.bounds.position.y;
+        const float right = left + glyph.bounds.size.x;
+        const float bottom = top + glyph.bounds.size.y;
+        const sf::FloatRect uv(sf::Vector2f(glyph.textureRect.position), sf::Vector2f(glyph.textureRect.size));
+        // One texel of padding, as sf::Text uses, so smoothing doesn't clip glyph edges
+        constexpr float pad = 1.0f;
+        addQuad(glyphs, {x + left - pad, y + top - pad}, {x + right + pad, y + bottom + pad}, TEXT_COLOR,
+                {uv.position.x - pad, uv.position.y - pad},
+                {uv.position.x + uv.size.x + pad, uv.position.y + uv.size.y + pad});
+        minX = std::min(minX, x + left);
+        maxX = std::max(maxX, x + right);
+        minY = std::min(minY, y + top);
+        maxY = std::max(maxY, y + bottom);
+        x += glyph.advance;
+    }
+    const sf::Vector2f textSize = text.isEmpty() ? sf::Vector2f() : sf::Vector2f(maxX - minX, maxY - minY);
+
+    // Box centred above the anchor, its bottom VERTICAL_OFFSET up; the outline sits outside it
+    const float boxWidth = std::max(MIN_BOX_WIDTH, textSize.x + PADDING * 2.0f);
+    const float boxHeight = std::max(MIN_BOX_HEIGHT, textSize.y + PADDING * 2.0f);
+    const sf::Vector2f boxMin(-boxWidth / 2.0f, -(boxHeight + VERTICAL_OFFSET));
+    const sf::Vector2f boxMax(boxWidth / 2.0f, -VERTICAL_OFFSET);
+    const sf::Vector2f outerMin(boxMin.x - OUTLINE, boxMin.y - OUTLINE);
+    const sf::Vector2f outerMax(boxMax.x + OUTLINE, boxMax.y + OUTLINE);
+
+    layout.vertices.reserve(6 * 5 + glyphs.size());
+    addSolid(layout.vertices, boxMin, boxMax, FILL_COLOR);
+    addSolid(layout.vertices, outerMin, {outerMax.x, boxMin.y}, OUTLINE_COLOR);
+    addSolid(layout.vertices, {outerMin.x, boxMax.y}, outerMax, OUTLINE_COLOR);
+    addSolid(layout.vertices, {outerMin.x, boxMin.y}, {boxMin.x, boxMax.y}, OUTLINE_COLOR);
+    addSolid(layout.vertices, {boxMax.x, boxMin.y}, {outerMax.x, boxMax.y}, OUTLINE_COLOR);
+
+    // Text centred horizontally, its origin TEXT_INSET plus half its height below the outline's top
+    const sf::Vector2f textOrigin(-textSize.x / 2.0f, outerMin.y + TEXT_INSET + textSize.y / 2.0f);
+    for (sf::Vertex vertex : glyphs) {
+        vertex.position += textOrigin;
+        layout.vertices.push_back(vertex);
+    }
+    layout.bounds = sf::FloatRect(outerMin, outerMax - outerMin);
+}
@@ -1,11 +1,17 @@
 #include "../include/NPC.hpp"
+#include "../include/Profiler.hpp"
+#include "../include/SimSnapshot.hpp"
+#include "../include/FixedPoint.hpp"
+#include "../include/LevelAssets.hpp"
 #include <cmath>
 #include <algorithm>
-#include <unordered_map>
 #include <iostream>
 
 // Constants
-static const float VERTICAL_OFFSET = 50.0f;  // Distance above NPC for message box
+static const unsigned MESSAGE_TEXT_SIZE = 24;
+static const char* const GREETING = "你好";
+static const float NPC_SCALE = 2.0f;         // Sprites are drawn at twice their texture size
+static const sf::Vector2f NPC_ORIGIN(16.f, 16.f);  // Centre of a 32x32 frame, in texture pixels
 
 // Helper function for rectangle intersection (for SFML 3.x compatibility)
 static bool rectsIntersect(const sf::FloatRect& a, const sf::FloatRect& b) {
@@ -15,139 +21,294 @@ static bool rectsIntersect(const sf::FloatRect& a, const sf::FloatRect& b) {
            a.position.y + a.size.y > b.position.y;
 }
 
-NPC::NPC(AssetManager& assetManager, RenderingSystem& renderSystem) 
-    : nextId(0), assetManager(assetManager), renderSystem(renderSystem) {
-    
-    // Try to load a font that supports Chinese characters
-    std::vector<std::string> fontPaths = {
-        "assets/fonts/NotoSansSC-Regular.ttf",  // Noto Sans SC font (supports Chinese)
-        "/System/Library/Fonts/PingFang.ttc",   // System Chinese font on macOS
-        "/System/Library/Fonts/STHeiti Light.ttc", // Alternative system Chinese font
-        "assets/fonts/pixel.ttf"  // Fallback to pixel font
-    };
-    
-    bool fontLoaded = false;
-    for (const auto& path : fontPaths) {
-        if (messageFont.openFromFile(path)) {
-            std::cout << "Successfully loaded font: " << path << std::endl;
-            fontLoaded = true;
-            break;
+namespace NPCSystem {
+
+const char* toString(NPCState state) {
+    switch (state) {
+        case NPCState::Idle: return "idle";
+        case NPCState::Walking: return "walking";
+        case NPCState::Talking: return "talking";
+    }
+    return "idle";
+}
+
+bool parseNPCState(const std::string& name, NPCState& state) {
+    for (NPCState candidate : {NPCState::Idle, NPCState::Walking, NPCState::Talking}) {
+        if (name == toString(candidate)) {
+            state = candidate;
+            return true;
         }
     }
-    
-    if (!fontLoaded) {
-        std::cerr << "Error: Could not load any suitable font!" << std::endl;
+    return false;
+}
+
+} // namespace NPCSystem
+
+static const char* const MESSAGE_FONT = "message_font";
+
+// A font that supports Chinese characters, opened once by the asset manager
+static const sf::Font& loadMessageFont(AssetManager& assetManager) {
+    std::string error;
+    AssetManager::FontHandle font = assetManager.tryLoadFirstFont(MESSAGE_FONT, {
+        "assets/fonts/NotoSansSC-Regular.ttf",     // Noto Sans SC font (supports Chinese)
+        "/System/Library/Fonts/PingFang.ttc",      // System Chinese font on macOS
+        "/System/Library/Fonts/STHeiti Light.ttc", // Alternative system Chinese font
+        "assets/fonts/pixel.ttf"                   // Fallback to pixel font
+    }, error);
+    if (!font.isValid()) {
+        std::cerr << "Error: Could not load any suitable font! " << error << std::endl;
+        static const sf::Font none; // Bubbles draw without text
+        return none;
     }
+    return *assetManager.findFont(font);
+}
+
+NPC::NPC(AssetManager& assetManager, RenderingSystem& renderSystem) 
+    : assetManager(assetManager), renderSystem(renderSystem),
+      messageFont(loadMessageFont(assetManager)) {
+    // Greet the player on arrival, for as long as they stay
+    greetingScript = defineScript(NPCScript().waitPlayerNear().say(GREETING, 3.0f).waitPlayerAway().loop());
+}
+
+void NPC::prewarmMessageGlyphs() {
+    std::string glyphs = AssetManager::getAsciiGlyphs();
+    for (const NPCScript& script : scripts) {
+        for (const std::string& line : script.getLines()) {
+            glyphs += line;
+        }
+    }
+    assetManager.prewarmGlyphs(assetManager.internFont(MESSAGE_FONT), glyphs, MESSAGE_TEXT_SIZE);
 }
 
 NPC::~NPC() {}
 
+uint32_t NPC::spawn(NPCData& npc, const std::string& name) {
+    const uint32_t index = static_cast<uint32_t>(npcs.size());
+    npc.id = static_cast<int>(handles.acquire(index));
+    spatialIndex.insert(index, sf::Vector2f(npc.x, npc.y));
+    npcs.push_back(npc);
+    // Names past the live count are kept as spare buffers
+    if (names.size() > index) {
+        names[index].assign(name);
+    } else {
+        names.push_back(name);
+    }
+    return index;
+}
+
 int NPC::createNPC(const std::string& name, const std::string& textureName, float x, float y) {
     NPCData npc;
-    npc.id = nextId++;
-    npc.name = name;
     npc.x = x;
     npc.y = y;
-    npc.health = 100.0f;
-    npc.isActive = true;
-    npc.currentState = "idle";
-    npc.facingLeft = false;
-    npc.isInteracting = false;
+    npc.prevX = x;
+    npc.prevY = y;
+    npc.homeX = x;
     
-    // Initialize animation
-    npc.animation = std::make_unique<Animation>();
-    npc.animation->loadAnimation(AnimationState::Idle, "assets/images/npc/separated/idle");
-    npc.animation->loadAnimation(AnimationState::Walking, "assets/images/npc/separated/walking");
-    npc.animation->setFrameTime(0.2f); // 200ms per frame
-    npc.animation->setScale(2.0f, 2.0f);
-    npc.animation->setOrigin(sf::Vector2f(16.f, 16.f)); // Center of 32x32 sprite
-    npc.animation->setState(AnimationState::Idle);
-    
-    // Create sprite for collision and initial setup
-    sf::Texture& texture = assetManager.getTexture(textureName);
-    npc.sprite = std::make_unique<sf::Sprite>(texture);
-    
-    // Center the sprite origin
-    sf::FloatRect bounds = npc.sprite->getLocalBounds();
-    npc.sprite->setOrigin(sf::Vector2f(bounds.size.x / 2.f, bounds.size.y / 2.f));
-    npc.sprite->setScale(sf::Vector2f(2.0f, 2.0f));
-    npc.sprite->setPosition(sf::Vector2f(x, y));
+    // Every NPC plays the same clips; only its playback state is per NPC
+    if (npcClips == AnimationSystem::NO_CLIP_SET) {
+        npcClips = animations.createClipSet(0.2f); // 200ms per frame
+        animations.loadClip(npcClips, AnimationState::Idle, LevelAssets::NPC_IDLE_CLIP);
+        animations.loadClip(npcClips, AnimationState::Walking, LevelAssets::NPC_WALKING_CLIP);
+    }
+    // On the clock: the frame is worked out when the NPC is drawn, so off-screen NPCs cost nothing
+    npc.animation = animations.add(npcClips, AnimationState::Idle, AnimationSystem::Playback::Clocked);
+    animationOwners.push_back(static_cast<uint32_t>(npcs.size()));
     
-    // Initialize collision bounds
+    // Collision size from the texture
+    setSpriteSize(npc, textureName);
     updateCollisionBounds(npc);
     
-    // Add to NPCs vector
-    int id = npc.id;
-    npcs.push_back(std::move(npc));
-    return id;
+    spawn(npc, name);
+    runScript(npc.id, greetingScript);
+    return npc.id;
 }
 
 void NPC::addNPC(const std::string& name, float x, float y) {
     NPCData npc;
-    npc.id = nextId++;
-    npc.name = name;
     npc.x = x;
     npc.y = y;
-    npc.health = 100.0f;
-    npc.isActive = true;
-    npc.currentState = "idle";
-    npc.facingLeft = false;
-    npcs.push_back(std::move(npc));
+    npc.prevX = x;
+    npc.prevY = y;
+    npc.homeX = x;
+    spawn(npc, name);
 }
 
 void NPC::removeNPC(int id) {
-    npcs.erase(
-        std::remove_if(npcs.begin(), npcs.end(),
-            [id](const NPCData& npc) { return npc.id == id; }),
-        npcs.end()
-    );
+    const uint32_t index = handles.release(static_cast<HandlePool::Handle>(id));
+    if (index == HandlePool::NOT_FOUND) return;
+    
+    releaseMessage(npcs[index]);
+    endScript(npcs[index]);
+    
+    // Swap-remove the animation and repoint whichever NPC owned the last one
+    if (npcs[index].animation != NPCSystem::NO_ANIMATION) {
+        const uint32_t slot = npcs[index].animation;
+        animations.remove(slot);
+        animationOwners[slot] = animationOwners.back();
+        animationOwners.pop_back();
+        if (slot < animationOwners.size()) {
+            npcs[animationOwners[slot]].animation = slot;
+        }
+    }
+    
+    // Swap-remove the NPC itself; the last one takes its index everywhere
+    const uint32_t last = static_cast<uint32_t>(npcs.size() - 1);
+    spatialIndex.remove(index);
+    talkingNPCs.erase(std::remove(talkingNPCs.begin(), talkingNPCs.end(), index), talkingNPCs.end());
+    aiScheduler.remove(index);
+    if (index != last) {
+        spatialIndex.remove(last);
+        npcs[index] = npcs[last];
+        std::swap(names[index], names[last]);
+        spatialIndex.insert(index, sf::Vector2f(npcs[index].x, npcs[index].y));
+        std::replace(talkingNPCs.begin(), talkingNPCs.end(), last, index);
+        handles.relocate(static_cast<HandlePool::Handle>(npcs[index].id), index);
+        if (npcs[index].animation != NPCSystem::NO_ANIMATION) {
+            animationOwners[npcs[index].animation] = index;
+        }
+    }
+    npcs.pop_back();
+}
+
+void NPC::rebuildSpatialIndex() {
+    spatialIndex.clear();
+    talkingNPCs.clear();
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        spatialIndex.insert(static_cast<uint32_t>(i), sf::Vector2f(npcs[i].x, npcs[i].y));
+        if (npcs[i].isInteracting) {
+            talkingNPCs.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
+
+void NPC::saveState(SimSnapshot& snapshot) const {
+    snapshot.writeArray(npcs);
+    handles.saveState(snapshot);
+    aiScheduler.saveState(snapshot);
+    snapshot.write(static_cast<uint32_t>(messageCount));
+    for (size_t i = 0; i < messageCount; ++i) {
+        const NPCSystem::NPCMessage& message = messages[i];
+        snapshot.write(message.npcId);
+        snapshot.writeString(message.message);
+        snapshot.write(message.timer);
+    }
+    snapshot.writeArray(running);
+    scriptHandles.saveState(snapshot);
+    timers.saveState(snapshot);
+}
+
+bool NPC::loadState(SimSnapshot& snapshot) {
+    uint32_t count = 0;
+    if (!(snapshot.readArray(npcs) && handles.loadState(snapshot) && aiScheduler.loadState(snapshot) &&
+          snapshot.read(count))) {
+        return false;
+    }
+    if (messages.size() < count) {
+        messages.resize(count);
+    }
+    messageCount = count;
+    for (size_t i = 0; i < messageCount; ++i) {
+        NPCSystem::NPCMessage& message = messages[i];
+        if (!(snapshot.read(message.npcId) && snapshot.readString(message.message) && snapshot.read(message.timer))) {
+            return false;
+        }
+        message.bubble = MessageBubbleCache::Handle(); // Laid out again on the next draw
+    }
+    if (!(snapshot.readArray(running) && scriptHandles.loadState(snapshot) && timers.loadState(snapshot))) {
+        return false;
+    }
+    rebuildSpatialIndex();
+    return true;
+}
+
+void NPC::updateSpatialIndex() {
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        spatialIndex.move(static_cast<uint32_t>(i), sf::Vector2f(npcs[i].x, npcs[i].y));
+    }
+}
+
+void NPC::releaseMessage(NPCData& npc) {
+    if (npc.message == NPCSystem::NO_MESSAGE) return;
+    
+    // Swap with the last live message, so the freed entry's text buffer stays
+    // as a spare; the moved message's NPC is found by id
+    const uint32_t slot = npc.message;
+    timers.cancel(messages[slot].timer); // Already gone when the message timed out
+    const uint32_t last = static_cast<uint32_t>(--messageCount);
+    if (slot != last) {
+        std::swap(messages[slot], messages[last]);
+        if (NPCData* owner = getNPCById(messages[slot].npcId)) {
+            owner->message = slot;
+        }
+    }
+    npc.message = NPCSystem::NO_MESSAGE;
+}
+
+void NPC::setSpriteSize(NPCData& npc, const std::string& textureName) {
+    const sf::Texture* texture = assetManager.findTexture(textureName);
+    if (!texture) {
+        // Keeps its previous size; a new NPC stays without a sprite
+        std::cerr << "NPC texture not loaded: " << textureName << std::endl;
+        return;
+    }
+    const sf::Vector2u size = texture->getSize();
+    npc.spriteWidth = size.x * NPC_SCALE;
+    npc.spriteHeight = size.y * NPC_SCALE;
+    // Collision boxes are 80% of the sprite
+    maxCollisionHalfExtent = std::max(maxCollisionHalfExtent, std::max(npc.spriteWidth, npc.spriteHeight) * 0.4f);
 }
 
 void NPC::updateAll(float deltaTime) {
-    for (auto& npc : npcs) {
-        if (!npc.isActive) continue;
-        
-        // Update message timer
-        if (npc.messageTimer > 0) {
-            npc.messageTimer -= deltaTime;
-            if (npc.messageTimer <= 0) {
-                // Clear both message and visual elements together
-                npc.currentMessage = "";
-                npc.messageBox.reset();
-                npc.messageText.reset();
+    PROFILE_ZONE("NPC::updateAll");
+    
+    // Decisions on the scheduler's budget; movement below still runs every update
+    aiScheduler.resize(npcs.size());
+    aiScheduler.update(deltaTime,
+        [this](size_t i) { return sf::Vector2f(npcs[i].x, npcs[i].y); },
+        [this](size_t i, float elapsed) {
+            if (npcs[i].isActive) {
+                updateNPCState(npcs[i], elapsed);
+            }
+        });
+    
+    // Messages and script waits whose time is up; the rest cost nothing until theirs is
+    expiredTimers.clear();
+    timers.advance(deltaTime, expiredTimers);
+    for (const TimerWheel::Expired& expired : expiredTimers) {
+        if (expired.event == static_cast<uint32_t>(TimerEvent::MessageExpired)) {
+            if (NPCData* npc = getNPCById(static_cast<int>(expired.data))) {
+                releaseMessage(*npc);
+            }
+        } else {
+            const uint32_t index = scriptHandles.find(expired.data);
+            if (index == HandlePool::NOT_FOUND) continue;
+            if (NPCData* npc = getNPCById(running[index].npcId)) {
+                resumeScript(*npc);
             }
         }
+    }
+    
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        NPCData& npc = npcs[i];
+        if (!npc.isActive) continue;
         
         // If NPC is interacting, force idle state and skip movement
         if (npc.isInteracting) {
-            npc.currentState = "idle";
-            updateNPCAnimation(npc, deltaTime);
+            npc.state = NPCSystem::NPCState::Idle;
+            updateNPCAnimation(npc, aiScheduler.getLod(i) != AIScheduler::Lod::Far);
             
-            // Update sprite position and scale even when idle
-            if (npc.sprite) {
-                npc.sprite->setPosition(sf::Vector2f(npc.x, npc.y));
-                sf::Vector2f scale = npc.sprite->getScale();
-                scale.x = std::abs(scale.x) * (npc.facingLeft ? -1.f : 1.f);
-                npc.sprite->setScale(scale);
-                // Update collision bounds even when idle
+            // Update collision bounds even when idle
+            if (npc.hasSprite()) {
                 updateCollisionBounds(npc);
             }
             continue;  // Skip the rest of the update for this NPC
         }
         
-        // Update NPC state
-        updateNPCState(npc);
-        
-        // Store initial position if not set
-        static std::unordered_map<int, float> initialPositions;
-        if (initialPositions.find(npc.id) == initialPositions.end()) {
-            initialPositions[npc.id] = npc.x;
-        }
-        
-        float initialX = initialPositions[npc.id];
+        // Kept per NPC (not keyed by id) so NPCs of a reloaded level start fresh
+        float initialX = npc.homeX;
         
         // Only move if in walking state
-        if (npc.currentState == "walking") {
+        if (npc.state == NPCSystem::NPCState::Walking) {
             static const float WALK_SPEED = 50.0f; // pixels per second
             static const float WALK_DISTANCE = 100.0f; // pixels
             
@@ -170,76 +331,120 @@ void NPC::updateAll(float deltaTime) {
             }
         }
         
-        // Update animation state
-        updateNPCAnimation(npc, deltaTime);
+        // Update animation state (Far NPCs keep theirs)
+        updateNPCAnimation(npc, aiScheduler.getLod(i) != AIScheduler::Lod::Far);
         
-        // Update sprite position and scale
-        if (npc.sprite) {
-            npc.sprite->setPosition(sf::Vector2f(npc.x, npc.y));
-            sf::Vector2f scale = npc.sprite->getScale();
-            scale.x = std::abs(scale.x) * (npc.facingLeft ? -1.f : 1.f);
-            npc.sprite->setScale(scale);
-            // Always update collision bounds after moving
+        // Always update collision bounds after moving
+        if (npc.hasSprite()) {
             updateCollisionBounds(npc);
         }
+        spatialIndex.move(static_cast<uint32_t>(i), sf::Vector2f(npc.x, npc.y));
+    }
+    
+    // Clips were picked above; this only moves the clock NPC frames are evaluated from
+    animations.update(deltaTime, jobSystem);
+}
+
+void NPC::storePreviousPositions() {
+    for (auto& npc : npcs) {
+        npc.prevX = npc.x;
+        npc.prevY = npc.y;
+    }
+}
+
+void NPC::snapState() {
+    if constexpr (FixedPoint::ENABLED) {
+        for (auto& npc : npcs) {
+            npc.x = FixedPoint::snap(npc.x);
+            npc.y = FixedPoint::snap(npc.y);
+        }
     }
 }
 
-void NPC::renderAll() {
+void NPC::renderAll(RenderSnapshot& snapshot, const sf::FloatRect& viewBounds, float alpha) {
+    PROFILE_ZONE("NPC::renderAll");
+    CrowdRenderer& crowd = renderSystem.getCrowdRenderer();
+    crowd.begin();
+    addToCrowd(crowd, viewBounds, alpha);
+    crowd.end(snapshot);
+    snapshot.countCulled(RenderCategory::NPCs, cullStats.culled);
+    renderMessages(snapshot);
+}
+
+void NPC::addToCrowd(CrowdRenderer& crowd, const ViewCulling::ViewSet& views, float alpha) {
+    PROFILE_ZONE("NPC::addToCrowd");
+    cullStats.reset();
+    visibleBubbles.clear();
+    
     for (const auto& npc : npcs) {
-        if (!npc.isActive || !npc.animation) continue;
+        if (!npc.isActive || npc.animation == NPCSystem::NO_ANIMATION) continue;
         
-        // Get the current animation frame sprite
-        const sf::Sprite& animatedSprite = npc.animation->getCurrentSprite();
+        // Interpolate between the last two simulation steps
+        sf::Vector2f renderPos(npc.prevX + (npc.x - npc.prevX) * alpha,
+                               npc.prevY + (npc.y - npc.prevY) * alpha);
         
-        // Create a copy of the sprite to modify position and scale
-        sf::Sprite renderSprite = animatedSprite;
-        renderSprite.setPosition(sf::Vector2f(npc.x, npc.y));
+        // The frame's (trimmed) rect placed around the sprite origin at its offset in the
+        // untrimmed frame; facing left mirrors it about the origin, as the old negative
+        // x scale did, with the U coordinates swapped
+        auto frameBounds = [&](const sf::IntRect& rect, const sf::Vector2i& offset) {
+            const sf::Vector2f frameSize(static_cast<float>(rect.size.x), static_cast<float>(rect.size.y));
+            const sf::Vector2f start(static_cast<float>(offset.x), static_cast<float>(offset.y));
+            const float left = npc.facingLeft ? renderPos.x - (start.x + frameSize.x - NPC_ORIGIN.x) * NPC_SCALE
+                                              : renderPos.x + (start.x - NPC_ORIGIN.x) * NPC_SCALE;
+            return sf::FloatRect(sf::Vector2f(left, renderPos.y + (start.y - NPC_ORIGIN.y) * NPC_SCALE),
+                                 frameSize * NPC_SCALE);
+        };
+        // Culled with the frame last evaluated; only NPCs that are drawn bring theirs up to date
+        sf::FloatRect bounds = frameBounds(animations.getFrameRect(npc.animation),
+                                           animations.getFrameOffset(npc.animation));
         
-        // Set the scale based on facing direction
-        sf::Vector2f scale = renderSprite.getScale();
-        scale.x = std::abs(scale.x) * (npc.facingLeft ? -1.f : 1.f);
-        renderSprite.setScale(scale);
-        
-        // Render the animated sprite
-        renderSystem.renderEntity(*renderSystem.getRenderTarget(), renderSprite, sf::Vector2f(npc.x, npc.y));
+        // Skip NPCs whose sprite and message box are both off-screen
+        const MessageBubbleCache::Layout* bubble = nullptr;
+        if (npc.message != NPCSystem::NO_MESSAGE) {
+            NPCSystem::NPCMessage& message = messages[npc.message];
+            bubble = &bubbles.get(message.bubble, message.message, MESSAGE_TEXT_SIZE);
+        }
+        uint8_t seenBy = views.visibleMask(bounds);
+        if (seenBy != views.allMask() && bubble) {
+            const sf::FloatRect bubbleBounds(bubble->bounds.position + renderPos, bubble->bounds.size);
+            seenBy |= views.visibleMask(bubbleBounds);
+        }
+        cullStats.count(seenBy != 0);
+        if (seenBy == 0) {
+            continue;
+        }
         
-        // Render message box and text if there is one
-        if (!npc.currentMessage.empty() && npc.messageBox && npc.messageText) {
-            // Position the message box above the NPC
-            sf::Vector2f boxPos(npc.x, npc.y);
-            npc.messageBox->setPosition(boxPos);
-            
-            // Draw the box first
-            renderSystem.getRenderTarget()->draw(*npc.messageBox);
-            
-            // Get the actual box bounds
-            sf::FloatRect boxBounds = npc.messageBox->getGlobalBounds();
-            sf::FloatRect textBounds = npc.messageText->getLocalBounds();
-            
-            // Calculate the box's actual position (accounting for origin offset)
-            float actualBoxTop = boxPos.y - (boxBounds.size.y + VERTICAL_OFFSET);
-            
-            // Add padding inside the box
-            const float PADDING = 10.0f;
-            
-            // Calculate text position to be centered inside the box with padding
-            float textX = boxPos.x - (textBounds.size.x / 2.0f);
-            float textY = actualBoxTop + PADDING + (textBounds.size.y / 2.0f);
-            
-            // Set text position and draw it
-            npc.messageText->setPosition(sf::Vector2f(textX, textY));
-            renderSystem.getRenderTarget()->draw(*npc.messageText);
+        animations.evaluate(npc.animation);
+        const sf::IntRect& rect = animations.getFrameRect(npc.animation);
+        bounds = frameBounds(rect, animations.getFrameOffset(npc.animation));
+        crowd.add(&animations.getFramePage(npc.animation), RenderCategory::NPCs, bounds, rect, npc.facingLeft,
+                  sf::Color::White, seenBy);
+        if (bubble) {
+            visibleBubbles.push_back(VisibleBubble{bubble, renderPos});
         }
     }
 }
 
+void NPC::renderMessages(RenderSnapshot& snapshot) {
+    // Bubbles (laid out once, just offset here) go above the crowd, merged into one draw
+    for (const auto& visible : visibleBubbles) {
+        snapshot.drawTriangles(visible.layout->vertices.data(), visible.layout->vertices.size(),
+                               &bubbles.getTexture(visible.layout->characterSize), RenderCategory::NPCs,
+                               visible.anchor);
+    }
+    visibleBubbles.clear();
+}
+
 void NPC::setNPCPosition(int id, float x, float y) {
     if (auto* npc = getNPCById(id)) {
         npc->x = x;
         npc->y = y;
-        if (npc->sprite) {
-            npc->sprite->setPosition(sf::Vector2f(x, y));
+        npc->prevX = x;  // Teleport, don't interpolate
+        npc->prevY = y;
+        npc->awake = true;
+        npc->restTicks = 0;
+        spatialIndex.move(static_cast<uint32_t>(npc - npcs.data()), sf::Vector2f(x, y));
+        if (npc->hasSprite()) {
             updateCollisionBounds(*npc);  // Update collision bounds when position changes
         }
     }
@@ -247,34 +452,28 @@ void NPC::setNPCPosition(int id, float x, float y) {
 
 void NPC::setNPCTexture(int id, const std::string& textureName) {
     if (auto* npc = getNPCById(id)) {
-        sf::Texture& texture = assetManager.getTexture(textureName);
-        if (!npc->sprite) {
-            npc->sprite = std::make_unique<sf::Sprite>(texture);
-        } else {
-            npc->sprite->setTexture(texture);
-        }
-        
-        // Maintain the origin at center
-        sf::FloatRect bounds = npc->sprite->getLocalBounds();
-        npc->sprite->setOrigin(sf::Vector2f(bounds.size.x / 2.f, bounds.size.y / 2.f));
-        npc->sprite->setPosition(sf::Vector2f(npc->x, npc->y));
+        // Bounds stay centred on the NPC
+        setSpriteSize(*npc, textureName);
+        updateCollisionBounds(*npc);
     }
 }
 
 void NPC::setNPCFacing(int id, bool facingLeft) {
     if (auto* npc = getNPCById(id)) {
         npc->facingLeft = facingLeft;
-        if (npc->sprite) {
-            sf::Vector2f scale = npc->sprite->getScale();
-            scale.x = std::abs(scale.x) * (facingLeft ? -1.f : 1.f);
-            npc->sprite->setScale(scale);
-        }
     }
 }
 
-void NPC::setNPCState(int id, const std::string& state) {
+void NPC::setNPCState(int id, NPCSystem::NPCState state) {
     if (auto* npc = getNPCById(id)) {
-        npc->currentState = state;
+        npc->state = state;
+    }
+}
+
+void NPC::setNPCState(int id, const std::string& state) {
+    NPCSystem::NPCState parsed;
+    if (NPCSystem::parseNPCState(state, parsed)) {
+        setNPCState(id, parsed);
     }
 }
 
@@ -295,43 +494,23 @@ const std::vector<NPC::NPCData>& NPC::getAllNPCs() const {
 }
 
 NPC::NPCData* NPC::getNPCById(int id) {
-    auto it = std::find_if(npcs.begin(), npcs.end(),
-        [id](const NPCData& npc) { return npc.id == id; });
-    return it != npcs.end() ? &(*it) : nullptr;
+    const uint32_t index = handles.find(static_cast<HandlePool::Handle>(id));
+    return index != HandlePool::NOT_FOUND ? &npcs[index] : nullptr;
 }
 
-std::vector<std::reference_wrapper<const NPC::NPCData>> NPC::getNPCsInRange(float x, float y, float radius) const {
-    std::vector<std::reference_wrapper<const NPCData>> nearbyNPCs;
-    float radiusSquared = radius * radius;  // Pre-calculate squared radius
-    
-    for (const auto& npc : npcs) {
-        if (!npc.isActive) continue;
-        
-        // Use the calculateDistance helper function
-        float distance = calculateDistance(x, y, npc.x, npc.y);
-        if (distance <= radius) {
-            nearbyNPCs.push_back(std::ref(npc));
-        }
-    }
-    
-    return nearbyNPCs;
-}
-
-void NPC::updateAI(float deltaTime) {
-    // TODO: Implement AI behavior
-    // This should be customized based on your game's requirements
-    // Example behaviors:
-    // - Patrolling
-    // - Following paths
-    // - Responding to player proximity
-    // - Engaging in dialogue
+size_t NPC::getNPCsInRange(float x, float y, float radius, std::vector<uint32_t>& out) const {
+    out.clear();
+    forEachNPCInRange(x, y, radius, [&out](size_t index, const NPCData&) {
+        out.push_back(static_cast<uint32_t>(index));
+    });
+    return out.size();
 }
 
 void NPC::updateCollisionBounds(NPCData& npc) {
-    if (!npc.sprite) return;
+    if (!npc.hasSprite()) return;
     
     // Get the sprite's bounds
-    sf::FloatRect spriteBounds = npc.sprite->getGlobalBounds();
+    sf::FloatRect spriteBounds = npc.getSpriteBounds();
     
     // Calculate collision box dimensions (80% of sprite size)
     float width = spriteBounds.size.x * 0.8f;
@@ -354,7 +533,38 @@ void NPC::updateCollisionBounds(NPCData& npc) {
 
 void NPC::handleInteraction(int npcId, const sf::FloatRect& playerBounds) {
     NPCData* npc = getNPCById(npcId);
-    if (!npc || !npc->isActive || !npc->sprite) return;
+    if (!npc) return;
+    const uint32_t index = static_cast<uint32_t>(npc - npcs.data());
+    interactAt(index, playerBounds);
+    if (npc->isInteracting && std::find(talkingNPCs.begin(), talkingNPCs.end(), index) == talkingNPCs.end()) {
+        talkingNPCs.push_back(index);
+    }
+}
+
+void NPC::updateInteractions(const sf::FloatRect& playerBounds) {
+    PROFILE_ZONE("NPC::updateInteractions");
+    // Talking NPCs are always checked so walking away ends the conversation;
+    // anyone else can only start one if their box is within reach of the player
+    const float reach = maxCollisionHalfExtent + 10.0f;  // MAINTAIN_INTERACTION_TOLERANCE
+    const sf::FloatRect area(playerBounds.position - sf::Vector2f(reach, reach),
+                             playerBounds.size + sf::Vector2f(reach * 2.0f, reach * 2.0f));
+    interactionScratch = talkingNPCs;
+    spatialIndex.forEachCandidate(area, [this](uint32_t index) { interactionScratch.push_back(index); });
+    std::sort(interactionScratch.begin(), interactionScratch.end());
+    interactionScratch.erase(std::unique(interactionScratch.begin(), interactionScratch.end()), interactionScratch.end());
+    
+    talkingNPCs.clear();
+    for (uint32_t index : interactionScratch) {
+        interactAt(index, playerBounds);
+        if (npcs[index].isInteracting) {
+            talkingNPCs.push_back(index);
+        }
+    }
+}
+
+void NPC::interactAt(size_t index, const sf::FloatRect& playerBounds) {
+    NPCData* npc = &npcs[index];
+    if (!npc->isActive || !npc->hasSprite()) return;
     
     // Update collision bounds to ensure they're current
     updateCollisionBounds(*npc);
@@ -369,22 +579,15 @@ void NPC::handleInteraction(int npcId, const sf::FloatRect& playerBounds) {
     
     // Check for collision using the helper function with expanded bounds
     if (rectsIntersect(expandedNPCBounds, playerBounds)) {
-        // If not already interacting, start interaction
+        // If not already interacting, start interaction; what is said is up to the NPC's script
         if (!npc->isInteracting) {
             npc->isInteracting = true;
-            displayMessage(npcId, "你好", 3.0f);
             
             // Update facing direction based on player position relative to NPC center
             float npcCenterX = npc->x;
             float playerCenterX = playerBounds.position.x + playerBounds.size.x/2;
             npc->facingLeft = (playerCenterX < npcCenterX);
-            
-            // Update sprite scale immediately to face player
-            if (npc->sprite) {
-                sf::Vector2f scale = npc->sprite->getScale();
-                scale.x = std::abs(scale.x) * (npc->facingLeft ? -1.f : 1.f);
-                npc->sprite->setScale(scale);
-            }
+            notifyScript(*npc, ScriptWait::PlayerNear);
         }
     } else {
         // Add a larger tolerance for maintaining interaction (10 pixels)
@@ -398,96 +601,207 @@ void NPC::handleInteraction(int npcId, const sf::FloatRect& playerBounds) {
         // Only end interaction if player is outside the expanded maintenance bounds
         if (npc->isInteracting && !rectsIntersect(expandedNPCBounds, playerBounds)) {
             npc->isInteracting = false;
-            npc->currentMessage = "";
-            npc->messageTimer = 0;
+            releaseMessage(*npc);
+            notifyScript(*npc, ScriptWait::PlayerAway);
         }
     }
 }
 
 void NPC::displayMessage(int npcId, const std::string& message, float duration) {
     if (auto* npc = getNPCById(npcId)) {
-        npc->currentMessage = message;
-        npc->messageTimer = duration;
-        
-        // Create message box with appropriate size for text
-        const float PADDING = 20.0f;  // Increased padding for Chinese characters
-        const float MIN_BOX_WIDTH = 180.0f;
-        const float MIN_BOX_HEIGHT = 60.0f;  // Increased height for Chinese characters
-        
-        // Create text object with font and UTF-8 string
-        npc->messageText = std::make_unique<sf::Text>(messageFont, "", 24);  // Initialize with font
-        npc->messageText->setString(sf::String::fromUtf8(message.begin(), message.end()));
-        npc->messageText->setFillColor(sf::Color::Black);
-        npc->messageText->setLineSpacing(1.2f);
-        
-        // Get text bounds for sizing the box
-        sf::FloatRect textBounds = npc->messageText->getLocalBounds();
-        float boxWidth = std::max(MIN_BOX_WIDTH, textBounds.size.x + PADDING * 2);
-        float boxHeight = std::max(MIN_BOX_HEIGHT, textBounds.size.y + PADDING * 2);
+        // The bubble's geometry is laid out once per distinct string and shared.
+        // Left to the first get() while recording a frame: laying it out loads
+        // glyphs into the font's texture, which the render thread may be drawing.
+        MessageBubbleCache::Handle bubble;
         
-        // Create and configure message box
-        npc->messageBox = std::make_unique<sf::RectangleShape>(sf::Vector2f(boxWidth, boxHeight));
-        npc->messageBox->setFillColor(sf::Color(255, 255, 255, 230));
-        npc->messageBox->setOutlineColor(sf::Color::Black);
-        npc->messageBox->setOutlineThickness(2.0f);
-        
-        // Set the origin for the message box (center bottom)
-        npc->messageBox->setOrigin(sf::Vector2f(boxWidth / 2.0f, boxHeight + VERTICAL_OFFSET));
+        // Reuse the NPC's slot (and restart its timer) if it is already talking, else a spare entry
+        if (npc->message != NPCSystem::NO_MESSAGE) {
+            timers.cancel(messages[npc->message].timer);
+        } else {
+            npc->message = static_cast<uint32_t>(messageCount++);
+            if (npc->message == messages.size()) {
+                messages.emplace_back();
+            }
+        }
+        NPCSystem::NPCMessage& entry = messages[npc->message];
+        entry.npcId = npcId;
+        entry.message.assign(message);  // Reuses the entry's buffer
+        entry.timer = timers.scheduleIn(duration, static_cast<uint32_t>(TimerEvent::MessageExpired),
+                                        static_cast<uint32_t>(npcId));
+        entry.bubble = bubble;
     }
 }
 
-float NPC::calculateDistance(float x1, float y1, float x2, float y2) const {
-    float dx = x2 - x1;
-    float dy = y2 - y1;
-    return std::sqrt(dx * dx + dy * dy);
-}
-
-void NPC::updateNPCAnimation(NPCData& npc, float deltaTime) {
-    if (!npc.animation) return;
+void NPC::updateNPCAnimation(const NPCData& npc, bool animate) {
+    if (npc.animation == NPCSystem::NO_ANIMATION) return;
     
-    // Update animation state based on NPC state
-    if (npc.currentState == "walking") {
-        npc.animation->setState(AnimationState::Walking);
-    } else {
-        npc.animation->setState(AnimationState::Idle);
-    }
+    // Far NPCs keep their clip; its frame follows the clock whether or not anyone looks
+    if (!animate) return;
     
-    // Update animation timing
-    npc.animation->update(deltaTime);
+    // Update animation state based on NPC state
+    animations.setState(npc.animation, npc.state == NPCSystem::NPCState::Walking ? AnimationState::Walking
+                                                                                : AnimationState::Idle);
 }
 
-void NPC::updateNPCState(NPCData& npc) {
+void NPC::updateNPCState(NPCData& npc, float elapsed) {
     // Skip state updates if interacting
     if (npc.isInteracting) {
         return;
     }
 
-    // Simple state machine for NPC behavior
-    static std::unordered_map<int, float> stateTimers;
+    // Simple state machine for NPC behavior (NPCs start idle)
     static const float IDLE_DURATION = 2.0f;  // seconds
     static const float WALK_DURATION = 4.0f;  // seconds
     
-    // Initialize timer if not set
-    if (stateTimers.find(npc.id) == stateTimers.end()) {
-        stateTimers[npc.id] = 0.0f;
-        npc.currentState = "idle";
-    }
-    
-    // Update timer
-    stateTimers[npc.id] += 1.0f/60.0f;  // Assuming 60 FPS
+    // Update timer by the time since this NPC's last decision
+    npc.stateTimer += elapsed;
     
     // State transitions
-    if (npc.currentState == "idle" && stateTimers[npc.id] >= IDLE_DURATION) {
-        npc.currentState = "walking";
-        stateTimers[npc.id] = 0.0f;
+    if (npc.state == NPCSystem::NPCState::Idle && npc.stateTimer >= IDLE_DURATION) {
+        npc.state = NPCSystem::NPCState::Walking;
+        npc.stateTimer = 0.0f;
     }
-    else if (npc.currentState == "walking" && stateTimers[npc.id] >= WALK_DURATION) {
-        npc.currentState = "idle";
-        stateTimers[npc.id] = 0.0f;
+    else if (npc.state == NPCSystem::NPCState::Walking && npc.stateTimer >= WALK_DURATION) {
+        npc.state = NPCSystem::NPCState::Idle;
+        npc.stateTimer = 0.0f;
     }
 }
 
 void NPC::clearNPCs() {
+    // Capacity, name and message buffers stay for the next level's NPCs
     npcs.clear();
-    nextId = 0;
-} 
\ No newline at end of file
+    animations.clear();
+    animationOwners.clear();
+    messageCount = 0;
+    timers.clear();
+    running.clear();
+    scriptHandles.clear();
+    spatialIndex.clear();
+    talkingNPCs.clear();
+    aiScheduler.clear();
+    handles.clear();
+    maxCollisionHalfExtent = 0.0f;
+}
+
+NPC::PoolStats NPC::getPoolStats() const {
+    PoolStats pool;
+    pool.handles = handles.getStats();
+    pool.npcCapacity = npcs.capacity();
+    pool.messages = messageCount;
+    pool.messageCapacity = messages.size();
+    return pool;
+} 
+NPC::ScriptId NPC::defineScript(const NPCScript& script) {
+    scripts.push_back(script);
+    return static_cast<ScriptId>(scripts.size() - 1);
+}
+
+NPC::ScriptHandle NPC::runScript(int npcId, ScriptId script) {
+    NPCData* npc = getNPCById(npcId);
+    if (!npc || script >= scripts.size()) {
+        return NPCSystem::NO_SCRIPT;
+    }
+    endScript(*npc);
+    const uint32_t index = static_cast<uint32_t>(running.size());
+    const ScriptHandle handle = scriptHandles.acquire(index);
+    if (handle == HandlePool::INVALID) {
+        return NPCSystem::NO_SCRIPT;
+    }
+    running.push_back(RunningScript{handle, script, npcId, 0, TimerWheel::NO_TIMER, ScriptWait::None});
+    npc->script = handle;
+    resumeScript(*npc);
+    return handle;
+}
+
+void NPC::stopScript(int npcId) {
+    if (NPCData* npc = getNPCById(npcId)) {
+        endScript(*npc);
+    }
+}
+
+void NPC::resumeScript(NPCData& npc) {
+    const uint32_t index = scriptHandles.find(npc.script);
+    if (index == HandlePool::NOT_FOUND) {
+        npc.script = NPCSystem::NO_SCRIPT;
+        return;
+    }
+    RunningScript& run = running[index];
+    run.wait = ScriptWait::None;
+    run.timer = TimerWheel::NO_TIMER;
+    const NPCScript& script = scripts[run.script];
+    const std::vector<NPCScript::Step>& steps = script.getSteps();
+    
+    // Run until something to wait on; a loop that never waits is stopped after one pass
+    for (size_t executed = 0; executed <= steps.size(); ++executed) {
+        if (run.step >= steps.size()) {
+            endScript(npc);
+            return;
+        }
+        const NPCScript::Step& step = steps[run.step++];
+        switch (step.op) {
+            case NPCScript::Op::Say:
+                displayMessage(npc.id, script.getLines()[step.line], step.seconds);
+                break;
+            case NPCScript::Op::Wait:
+                run.timer = timers.scheduleIn(step.seconds, static_cast<uint32_t>(TimerEvent::ScriptResume), npc.script);
+                run.wait = ScriptWait::Timer;
+                return;
+            case NPCScript::Op::WaitPlayerNear:
+                if (!npc.isInteracting) {
+                    run.wait = ScriptWait::PlayerNear;
+                    return;
+                }
+                break;
+            case NPCScript::Op::WaitPlayerAway:
+                if (npc.isInteracting) {
+                    run.wait = ScriptWait::PlayerAway;
+                    return;
+                }
+                break;
+            case NPCScript::Op::SetState:
+                npc.state = step.state;
+                npc.stateTimer = 0.0f;
+                break;
+            case NPCScript::Op::Loop:
+                run.step = 0;
+                break;
+        }
+    }
+    std::cerr << "NPC script " << run.script << " loops without waiting; stopped" << std::endl;
+    endScript(npc);
+}
+
+void NPC::notifyScript(NPCData& npc, ScriptWait event) {
+    const uint32_t index = scriptHandles.find(npc.script);
+    if (index != HandlePool::NOT_FOUND && running[index].wait == event) {
+        resumeScript(npc);
+    }
+}
+
+void NPC::endScript(NPCData& npc) {
+    const uint32_t index = scriptHandles.release(npc.script);
+    npc.script = NPCSystem::NO_SCRIPT;
+    if (index == HandlePool::NOT_FOUND) return;
+    timers.cancel(running[index].timer);
+    
+    // Swap-remove; the last script's handle follows it
+    if (index != running.size() - 1) {
+        running[index] = running.back();
+        scriptHandles.relocate(running[index].handle, index);
+    }
+    running.pop_back();
+}
+
+NPC::ScriptStats NPC::getScriptStats() const {
+    ScriptStats stats;
+    stats.defined = scripts.size();
+    stats.running = running.size();
+    for (const RunningScript& run : running) {
+        if (run.wait == ScriptWait::Timer) {
+            stats.waitingOnTimer++;
+        } else if (run.wait == ScriptWait::PlayerNear || run.wait == ScriptWait::PlayerAway) {
+            stats.waitingOnPlayer++;
+        }
+    }
+    return stats;
+}
@@ -0,0 +1,48 @@
+#include "NPCScript.hpp"
+
+NPCScript& NPCScript::say(const std::string& line, float seconds) {
+    Step step;
+    step.op = Op::Say;
+    step.seconds = seconds;
+    step.line = static_cast<uint32_t>(lines.size());
+    lines.push_back(line);
+    steps.push_back(step);
+    return *this;
+}
+
+NPCScript& NPCScript::wait(float seconds) {
+    Step step;
+    step.op = Op::Wait;
+    step.seconds = seconds;
+    steps.push_back(step);
+    return *this;
+}
+
+NPCScript& NPCScript::waitPlayerNear() {
+    Step step;
+    step.op = Op::WaitPlayerNear;
+    steps.push_back(step);
+    return *this;
+}
+
+NPCScript& NPCScript::waitPlayerAway() {
+    Step step;
+    step.op = Op::WaitPlayerAway;
+    steps.push_back(step);
+    return *this;
+}
+
+NPCScript& NPCScript::setState(NPCSystem::NPCState state) {
+    Step step;
+    step.op = Op::SetState;
+    step.state = state;
+    steps.push_back(step);
+    return *this;
+}
+
+NPCScript& NPCScript::loop() {
+    Step step;
+    step.op = Op::Loop;
+    steps.push_back(step);
+    return *this;
+}
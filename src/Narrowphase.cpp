@@ -0,0 +1,193 @@
+#include "Narrowphase.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Narrowphase {
+
+namespace {
+
+bool isSlope(SurfaceType type) {
+    return type == SurfaceType::SlopeUpRight || type == SurfaceType::SlopeUpLeft;
+}
+
+template <bool SolidsAreOneWay>
+bool blocksSides(const Surface& surface) {
+    if constexpr (SolidsAreOneWay) {
+        (void)surface;
+        return false;
+    } else {
+        return surface.type == SurfaceType::Solid;
+    }
+}
+
+} // namespace
+
+float getSurfaceTop(const Surface& surface, float x) {
+    const sf::FloatRect& b = surface.bounds;
+    if (!isSlope(surface.type) || b.size.x <= 0.f) {
+        return b.position.y;
+    }
+    const float t = std::clamp((x - b.position.x) / b.size.x, 0.f, 1.f);
+    const float drop = surface.type == SurfaceType::SlopeUpRight ? 1.f - t : t;
+    return b.position.y + b.size.y * drop;
+}
+
+sf::FloatRect getSweepBounds(const sf::FloatRect& body, const sf::Vector2f& move) {
+    const float left = body.position.x + std::min(move.x, 0.f);
+    const float top = body.position.y + std::min(move.y, 0.f) - LANDING_TOLERANCE;
+    const float right = body.position.x + body.size.x + std::max(move.x, 0.f);
+    // Below the feet: contact distance plus however far a slope can fall away under one step
+    const float bottom = body.position.y + body.size.y + std::max(move.y, 0.f) + CONTACT_DISTANCE + std::abs(move.x);
+    return sf::FloatRect(sf::Vector2f(left, top), sf::Vector2f(right - left, bottom - top));
+}
+
+bool timeOfImpact(const sf::FloatRect& body, const sf::Vector2f& move, const sf::FloatRect& box,
+                  float& time, sf::Vector2f& normal) {
+    // Box grown by the body's size, so the body's top-left corner is a ray
+    const float minX = box.position.x - body.size.x;
+    const float maxX = box.position.x + box.size.x;
+    const float minY = box.position.y - body.size.y;
+    const float maxY = box.position.y + box.size.y;
+    const sf::Vector2f p = body.position;
+    if (p.x > minX && p.x < maxX && p.y > minY && p.y < maxY) {
+        return false; // Already inside
+    }
+
+    // Entry and exit times through each slab
+    auto slab = [](float origin, float delta, float low, float high, float& entry, float& exit) {
+        if (delta == 0.f) {
+            entry = -std::numeric_limits<float>::infinity();
+            exit = std::numeric_limits<float>::infinity();
+            return origin > low && origin < high;
+        }
+        const float t0 = (low - origin) / delta;
+        const float t1 = (high - origin) / delta;
+        entry = std::min(t0, t1);
+        exit = std::max(t0, t1);
+        return true;
+    };
+    float entryX, exitX, entryY, exitY;
+    if (!slab(p.x, move.x, minX, maxX, entryX, exitX) || !slab(p.y, move.y, minY, maxY, entryY, exitY)) {
+        return false;
+    }
+    const float entry = std::max(entryX, entryY);
+    const float exit = std::min(exitX, exitY);
+    if (entry >= exit || entry < 0.f || entry > 1.f) {
+        return false;
+    }
+
+    time = entry;
+    if (entryX > entryY) {
+        normal = sf::Vector2f(move.x > 0.f ? -1.f : 1.f, 0.f);
+    } else {
+        normal = sf::Vector2f(0.f, move.y > 0.f ? -1.f : 1.f);
+    }
+    return true;
+}
+
+SweepResult sweep(const sf::FloatRect& body, const sf::Vector2f& move, bool wasGrounded,
+                  const std::vector<Surface>& surfaces, const std::vector<size_t>& candidates,
+                  bool solidsAreOneWay) {
+    return solidsAreOneWay ? sweep<true>(body, move, wasGrounded, surfaces, candidates)
+                           : sweep<false>(body, move, wasGrounded, surfaces, candidates);
+}
+
+template <bool SolidsAreOneWay>
+SweepResult sweep(const sf::FloatRect& body, const sf::Vector2f& move, bool wasGrounded,
+                  const std::vector<Surface>& surfaces, const std::vector<size_t>& candidates) {
+    SweepResult result;
+    const float width = body.size.x;
+    const float height = body.size.y;
+    sf::Vector2f position = body.position;
+    sf::Vector2f remaining = move;
+
+    // Boxes: advance to the first face hit, then slide along it with what's left
+    for (int slide = 0; slide < MAX_SLIDES && (remaining.x != 0.f || remaining.y != 0.f); ++slide) {
+        const sf::FloatRect current(position, body.size);
+        float firstTime = 1.f;
+        sf::Vector2f firstNormal;
+        int firstSurface = -1;
+        for (size_t c : candidates) {
+            const Surface& surface = surfaces[c];
+            if (isSlope(surface.type)) continue;
+            float time;
+            sf::Vector2f normal;
+            if (!timeOfImpact(current, remaining, surface.bounds, time, normal)) continue;
+            if (!blocksSides<SolidsAreOneWay>(surface) && normal.y >= 0.f) continue; // One-way: top face only
+            if (firstSurface < 0 || time < firstTime) {
+                firstTime = time;
+                firstNormal = normal;
+                firstSurface = static_cast<int>(c);
+            }
+        }
+        if (firstSurface < 0) {
+            position += remaining;
+            break;
+        }
+
+        position += remaining * firstTime + firstNormal * SKIN;
+        remaining *= 1.f - firstTime;
+        if (firstNormal.x != 0.f) {
+            remaining.x = 0.f;
+            result.wall = firstNormal.x < 0.f ? 1 : -1;
+        } else {
+            remaining.y = 0.f;
+            if (firstNormal.y > 0.f) {
+                result.hitCeiling = true;
+            } else {
+                result.onGround = true;
+                result.ground = firstSurface;
+            }
+        }
+    }
+
+    // Support: settle onto the highest top under the feet. Rising bodies skip
+    // this, so jumping off a ledge or up through a one-way platform works.
+    if (move.y >= 0.f && !result.hitCeiling) {
+        const float left = position.x;
+        const float right = position.x + width;
+        const float startBottom = body.position.y + height;
+        const float bottom = position.y + height;
+        const float footX = position.x + width * 0.5f;
+        int ground = -1;
+        float groundTop = 0.f;
+        for (size_t c : candidates) {
+            const Surface& surface = surfaces[c];
+            const sf::FloatRect& b = surface.bounds;
+            if (left >= b.position.x + b.size.x || right <= b.position.x) continue;
+
+            float top = b.position.y;
+            bool supports = false;
+            if (isSlope(surface.type)) {
+                if (footX < b.position.x || footX > b.position.x + b.size.x || b.size.x <= 0.f) continue;
+                top = getSurfaceTop(surface, footX);
+                // One step along the ramp raises (or drops) the surface by this much
+                const float rise = std::abs(move.x) * b.size.y / b.size.x;
+                const float reach = CONTACT_DISTANCE + (wasGrounded ? rise : 0.f);
+                supports = startBottom <= top + LANDING_TOLERANCE + rise && bottom + reach >= top;
+            } else {
+                supports = bottom <= top + LANDING_TOLERANCE && bottom + CONTACT_DISTANCE >= top;
+            }
+            if (supports && (ground < 0 || top < groundTop)) {
+                ground = static_cast<int>(c);
+                groundTop = top;
+            }
+        }
+        if (ground >= 0) {
+            position.y = groundTop - height - SKIN;
+            result.onGround = true;
+            result.ground = ground;
+        }
+    }
+
+    result.position = position;
+    return result;
+}
+
+template SweepResult sweep<false>(const sf::FloatRect&, const sf::Vector2f&, bool, const std::vector<Surface>&,
+                                  const std::vector<size_t>&);
+template SweepResult sweep<true>(const sf::FloatRect&, const sf::Vector2f&, bool, const std::vector<Surface>&,
+                                 const std::vector<size_t>&);
+
+} // namespace Narrowphase
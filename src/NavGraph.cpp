@@ -0,0 +1,254 @@
+#include "NavGraph.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+float distance(const sf::Vector2f& a, const sf::Vector2f& b) {
+    const float dx = b.x - a.x;
+    const float dy = b.y - a.y;
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Vertical extent of the query around a node: jumps rise this far, falls drop any distance
+constexpr float FALL_DEPTH = 1.0e5f;
+
+} // namespace
+
+float NavGraph::Node::topAt(float x) const {
+    if (right <= left) return topLeft;
+    const float t = std::clamp((x - left) / (right - left), 0.f, 1.f);
+    return topLeft + (topRight - topLeft) * t;
+}
+
+void NavGraph::clear() {
+    LevelVector<Node>().swap(nodes);
+    LevelVector<Edge>().swap(edges);
+    grid.clear();
+    stats = Stats();
+}
+
+void NavGraph::build(const std::vector<LevelData::Platform>& platforms) {
+    build(platforms, settings);
+}
+
+void NavGraph::build(const std::vector<LevelData::Platform>& platforms, const Settings& newSettings) {
+    PROFILE_ZONE("NavGraph::build");
+    const auto start = std::chrono::steady_clock::now();
+    clear();
+    settings = newSettings;
+
+    // One node per platform top
+    nodes.reserve(platforms.size());
+    std::vector<sf::FloatRect> surfaces;
+    surfaces.reserve(platforms.size());
+    for (size_t i = 0; i < platforms.size(); ++i) {
+        if (platforms[i].bounds.size.x <= 0.f) continue;
+        nodes.push_back(makeNode(platforms[i], static_cast<uint32_t>(i)));
+        surfaces.push_back(surfaceOf(nodes.back()));
+    }
+    grid.build(surfaces);
+
+    std::vector<size_t> candidates;
+    for (uint32_t n = 0; n < nodes.size(); ++n) {
+        nodes[n].firstEdge = static_cast<uint32_t>(edges.size());
+        addEdges(n, candidates);
+        nodes[n].edgeCount = static_cast<uint32_t>(edges.size()) - nodes[n].firstEdge;
+    }
+
+    countEdges();
+    stats.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+NavGraph::Node NavGraph::makeNode(const LevelData::Platform& platform, uint32_t index) {
+    // A ramp rises toward the side its slope names
+    const sf::FloatRect& bounds = platform.bounds;
+    Node node;
+    node.left = bounds.position.x;
+    node.right = bounds.position.x + bounds.size.x;
+    node.topLeft = node.topRight = bounds.position.y;
+    const float bottom = bounds.position.y + bounds.size.y;
+    if (platform.slope == LevelData::Slope::Right) {
+        node.topLeft = bottom;
+    } else if (platform.slope == LevelData::Slope::Left) {
+        node.topRight = bottom;
+    }
+    node.platform = index;
+    return node;
+}
+
+sf::FloatRect NavGraph::surfaceOf(const Node& node) {
+    const float top = std::min(node.topLeft, node.topRight);
+    return sf::FloatRect(sf::Vector2f(node.left, top),
+                         sf::Vector2f(node.right - node.left, std::abs(node.topRight - node.topLeft)));
+}
+
+void NavGraph::countEdges() {
+    stats.nodes = nodes.size();
+    stats.walkEdges = stats.jumpEdges = stats.fallEdges = 0;
+    for (const Edge& edge : edges) {
+        switch (edge.type) {
+            case EdgeType::Walk: stats.walkEdges++; break;
+            case EdgeType::Jump: stats.jumpEdges++; break;
+            case EdgeType::Fall: stats.fallEdges++; break;
+        }
+    }
+}
+
+void NavGraph::updatePlatform(const std::vector<LevelData::Platform>& platforms, uint32_t platform) {
+    PROFILE_ZONE("NavGraph::updatePlatform");
+    const auto start = std::chrono::steady_clock::now();
+    // Nodes are in platform order; a platform too thin for a node stays without one
+    auto found = std::lower_bound(nodes.begin(), nodes.end(), platform,
+                                  [](const Node& node, uint32_t index) { return node.platform < index; });
+    if (platform >= platforms.size() || found == nodes.end() || found->platform != platform ||
+        platforms[platform].bounds.size.x <= 0.f) {
+        return;
+    }
+    const uint32_t changed = static_cast<uint32_t>(found - nodes.begin());
+    const sf::FloatRect before = surfaceOf(nodes[changed]);
+    Node& node = nodes[changed];
+    const uint32_t firstEdge = node.firstEdge;
+    const uint32_t edgeCount = node.edgeCount;
+    node = makeNode(platforms[platform], platform);
+    node.firstEdge = firstEdge;
+    node.edgeCount = edgeCount;
+    const sf::FloatRect after = surfaceOf(node);
+    grid.update(changed, after);
+
+    // Whose edge query (see addEdges) reaches the old or the new surface:
+    // within reach sideways, above it by any fall or below it by up to a jump
+    const float reach = std::max(settings.maxJumpDistance, settings.maxFallReach) + settings.walkGap;
+    std::vector<uint8_t> dirty(nodes.size(), 0);
+    dirty[changed] = 1;
+    for (const sf::FloatRect& surface : {before, after}) {
+        grid.query(sf::FloatRect(sf::Vector2f(surface.position.x - reach, surface.position.y - FALL_DEPTH),
+                                 sf::Vector2f(surface.size.x + reach * 2.f,
+                                              surface.size.y + FALL_DEPTH + settings.maxJumpHeight)),
+                   queryScratch);
+        for (size_t n : queryScratch) {
+            dirty[n] = 1;
+        }
+    }
+
+    // Regroup: clean nodes copy their edges over, dirty ones find theirs again
+    edgeScratch.assign(edges.begin(), edges.end());
+    edges.clear();
+    std::vector<size_t> candidates;
+    size_t rebuilt = 0;
+    for (uint32_t n = 0; n < nodes.size(); ++n) {
+        const uint32_t previousFirst = nodes[n].firstEdge;
+        const uint32_t previousCount = nodes[n].edgeCount;
+        nodes[n].firstEdge = static_cast<uint32_t>(edges.size());
+        if (dirty[n]) {
+            addEdges(n, candidates);
+            rebuilt++;
+        } else {
+            edges.insert(edges.end(), edgeScratch.begin() + previousFirst,
+                         edgeScratch.begin() + previousFirst + previousCount);
+        }
+        nodes[n].edgeCount = static_cast<uint32_t>(edges.size()) - nodes[n].firstEdge;
+    }
+    countEdges();
+    stats.updatedNodes = rebuilt;
+    stats.updateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void NavGraph::addEdges(uint32_t from, std::vector<size_t>& candidates) {
+    const Node& a = nodes[from];
+    const float reach = std::max(settings.maxJumpDistance, settings.maxFallReach) + settings.walkGap;
+    const float top = std::min(a.topLeft, a.topRight);
+    const float bottom = std::max(a.topLeft, a.topRight);
+    grid.query(sf::FloatRect(sf::Vector2f(a.left - reach, top - settings.maxJumpHeight),
+                             sf::Vector2f(a.right - a.left + reach * 2.f, bottom - top + settings.maxJumpHeight + FALL_DEPTH)),
+               candidates);
+
+    for (size_t c : candidates) {
+        const uint32_t to = static_cast<uint32_t>(c);
+        if (to == from) continue;
+        const Node& b = nodes[to];
+
+        // Off either end of 'a', onto the first part of 'b' beyond it
+        for (int side = -1; side <= 1; side += 2) {
+            const float edgeX = side < 0 ? a.left : a.right;
+            if (side > 0 ? b.right <= a.right : b.left >= a.left) continue;
+            const float landX = side > 0 ? std::max(b.left, a.right) : std::min(b.right, a.left);
+            const float gap = side > 0 ? std::max(0.f, b.left - a.right) : std::max(0.f, a.left - b.right);
+            const sf::Vector2f takeoff(edgeX, a.topAt(edgeX));
+            const sf::Vector2f landing(landX, b.topAt(landX));
+            const float drop = landing.y - takeoff.y; // Positive when 'b' is lower
+
+            if (gap <= settings.walkGap && std::abs(drop) <= settings.stepHeight) {
+                addEdge(from, to, takeoff, landing);
+            } else if (drop > settings.stepHeight) {
+                if (gap <= settings.maxFallReach || gap <= settings.maxJumpDistance) {
+                    addEdge(from, to, takeoff, landing);
+                }
+            } else if (gap > 0.f && -drop <= settings.maxJumpHeight && gap <= settings.maxJumpDistance) {
+                // Higher and apart; a higher 'b' overhanging this end is reached from beside it instead
+                addEdge(from, to, takeoff, landing);
+            }
+        }
+
+        // Up onto a platform above 'a', jumping from just beside either of its ends
+        for (int side = -1; side <= 1; side += 2) {
+            const float endX = side < 0 ? b.left : b.right;
+            const float takeoffX = endX + side * settings.clearance;
+            if (takeoffX < a.left || takeoffX > a.right) continue;
+            const sf::Vector2f takeoff(takeoffX, a.topAt(takeoffX));
+            const sf::Vector2f landing(endX, b.topAt(endX));
+            const float rise = takeoff.y - landing.y;
+            if (rise > settings.stepHeight && rise <= settings.maxJumpHeight) {
+                addEdge(from, to, takeoff, landing);
+            }
+        }
+    }
+}
+
+void NavGraph::addEdge(uint32_t from, uint32_t to, const sf::Vector2f& takeoff, const sf::Vector2f& landing) {
+    Edge edge;
+    edge.to = to;
+    edge.takeoff = takeoff;
+    edge.landing = landing;
+    const float drop = landing.y - takeoff.y;
+    const float gap = std::abs(landing.x - takeoff.x);
+    if (gap <= settings.walkGap && std::abs(drop) <= settings.stepHeight) {
+        edge.type = EdgeType::Walk;
+    } else if (drop > settings.stepHeight && gap <= settings.maxFallReach) {
+        edge.type = EdgeType::Fall;
+    } else {
+        edge.type = EdgeType::Jump;
+    }
+
+    // Never below the straight line between the centres, so A*'s distance heuristic stays admissible
+    const float transition = distance(takeoff, landing) * (edge.type == EdgeType::Jump ? settings.jumpCostScale : 1.f);
+    edge.cost = distance(nodes[from].center(), takeoff) + transition + distance(landing, nodes[to].center());
+
+    // Keep only the cheapest way from 'from' to 'to'
+    for (uint32_t e = nodes[from].firstEdge; e < edges.size(); ++e) {
+        if (edges[e].to == to) {
+            if (edge.cost < edges[e].cost) edges[e] = edge;
+            return;
+        }
+    }
+    edges.push_back(edge);
+}
+
+uint32_t NavGraph::findNode(const sf::Vector2f& feet, float tolerance) const {
+    grid.query(sf::FloatRect(sf::Vector2f(feet.x, feet.y - tolerance), sf::Vector2f(0.f, tolerance * 2.f)),
+               queryScratch);
+    uint32_t best = NO_NODE;
+    float bestOffset = tolerance;
+    for (size_t c : queryScratch) {
+        const Node& node = nodes[c];
+        if (feet.x < node.left || feet.x > node.right) continue;
+        const float offset = std::abs(node.topAt(feet.x) - feet.y);
+        if (offset <= bestOffset) {
+            best = static_cast<uint32_t>(c);
+            bestOffset = offset;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,224 @@
+#include "NavPathfinder.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+
+void NavPathfinder::setGraph(const NavGraph* newGraph) {
+    graph = newGraph;
+    const size_t nodeCount = graph ? graph->getNodeCount() : 0;
+    costSoFar.assign(nodeCount, 0.f);
+    parent.assign(nodeCount, NavGraph::NO_NODE);
+    stamp.assign(nodeCount, 0);
+    closed.assign(nodeCount, 0);
+    searchStamp = 0;
+    open.clear();
+    queue.clear();
+    queueHead = 0;
+    searching = false;
+    results.resize(MAX_RESULTS);
+    for (Result& result : results) {
+        result.id = NO_REQUEST;
+        result.path.clear();
+    }
+    for (CacheEntry& entry : cache) {
+        entry.start = entry.goal = NavGraph::NO_NODE;
+        entry.path.clear();
+    }
+    stats = Stats();
+}
+
+float NavPathfinder::heuristic(uint32_t node) const {
+    // Straight-line distance between centres; edge costs never undercut it
+    const sf::Vector2f center = graph->getNode(node).center();
+    const float dx = goalCenter.x - center.x;
+    const float dy = goalCenter.y - center.y;
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+void NavPathfinder::beginSearch(uint32_t start, uint32_t goal) {
+    if (++searchStamp == 0) {
+        // Wrapped: old stamps could match again
+        std::fill(stamp.begin(), stamp.end(), 0);
+        std::fill(closed.begin(), closed.end(), 0);
+        searchStamp = 1;
+    }
+    searchGoal = goal;
+    goalCenter = graph->getNode(goal).center();
+    open.clear();
+    costSoFar[start] = 0.f;
+    parent[start] = NavGraph::NO_NODE;
+    stamp[start] = searchStamp;
+    open.push_back(OpenEntry{heuristic(start), start});
+}
+
+bool NavPathfinder::stepSearch(size_t& budget, bool& found) {
+    while (!open.empty()) {
+        if (budget == 0) {
+            return false;
+        }
+        std::pop_heap(open.begin(), open.end());
+        const uint32_t node = open.back().node;
+        open.pop_back();
+        if (closed[node] == searchStamp) continue; // Stale entry, reached more cheaply since
+        if (node == searchGoal) {
+            found = true;
+            return true;
+        }
+        closed[node] = searchStamp;
+        --budget;
+        ++stats.expansions;
+
+        for (const NavGraph::Edge* edge = graph->edgesBegin(node); edge != graph->edgesEnd(node); ++edge) {
+            const uint32_t to = edge->to;
+            if (closed[to] == searchStamp) continue;
+            const float cost = costSoFar[node] + edge->cost;
+            if (stamp[to] != searchStamp || cost < costSoFar[to]) {
+                stamp[to] = searchStamp;
+                costSoFar[to] = cost;
+                parent[to] = node;
+                open.push_back(OpenEntry{cost + heuristic(to), to});
+                std::push_heap(open.begin(), open.end());
+            }
+        }
+    }
+    found = false;
+    return true;
+}
+
+void NavPathfinder::tracePath(std::vector<uint32_t>& path) const {
+    path.clear();
+    for (uint32_t node = searchGoal; node != NavGraph::NO_NODE; node = parent[node]) {
+        path.push_back(node);
+    }
+    std::reverse(path.begin(), path.end());
+}
+
+NavPathfinder::CacheEntry& NavPathfinder::cacheSlot(uint32_t start, uint32_t goal) {
+    const uint32_t hash = start * 2654435761u ^ goal * 40503u;
+    return cache[hash % CACHE_SIZE];
+}
+
+bool NavPathfinder::findPath(uint32_t start, uint32_t goal, std::vector<uint32_t>& path, size_t maxExpansions) {
+    path.clear();
+    if (!graph || start >= graph->getNodeCount() || goal >= graph->getNodeCount()) {
+        return false;
+    }
+    CacheEntry& entry = cacheSlot(start, goal);
+    if (entry.start == start && entry.goal == goal) {
+        stats.cacheHits++;
+        path.assign(entry.path.begin(), entry.path.end());
+        return entry.found;
+    }
+
+    // Shares the search state with the queue, whose current search restarts
+    searching = false;
+    beginSearch(start, goal);
+    bool found = false;
+    if (!stepSearch(maxExpansions, found)) {
+        return false; // Over the bound; not cached, a larger bound may succeed
+    }
+    if (found) {
+        tracePath(path);
+    }
+    entry.start = start;
+    entry.goal = goal;
+    entry.found = found;
+    entry.path.assign(path.begin(), path.end());
+    return found;
+}
+
+NavPathfinder::RequestId NavPathfinder::request(uint32_t start, uint32_t goal) {
+    RequestId id = nextRequest++;
+    if (id == NO_REQUEST) {
+        id = nextRequest++;
+    }
+    stats.requests++;
+    if (results.size() != MAX_RESULTS) {
+        results.resize(MAX_RESULTS);
+    }
+    Result& result = results[id % MAX_RESULTS];
+    result.id = id;
+    result.status = Status::Pending;
+
+    if (!graph || start >= graph->getNodeCount() || goal >= graph->getNodeCount()) {
+        pathScratch.clear();
+        finish(id, false, pathScratch);
+        return id;
+    }
+    const CacheEntry& entry = cacheSlot(start, goal);
+    if (entry.start == start && entry.goal == goal) {
+        stats.cacheHits++;
+        finish(id, entry.found, entry.path);
+        return id;
+    }
+    queue.push_back(Query{id, start, goal});
+    stats.pending = queue.size() - queueHead;
+    return id;
+}
+
+void NavPathfinder::update(size_t budget) {
+    PROFILE_ZONE("NavPathfinder::update");
+    stats.expansions = 0;
+    while (budget > 0 && queueHead < queue.size()) {
+        const Query query = queue[queueHead];
+        // Already answered (a duplicate finished first and filled the cache)
+        CacheEntry& entry = cacheSlot(query.start, query.goal);
+        if (!searching && entry.start == query.start && entry.goal == query.goal) {
+            stats.cacheHits++;
+            finish(query.id, entry.found, entry.path);
+            ++queueHead;
+            continue;
+        }
+        if (!searching) {
+            beginSearch(query.start, query.goal);
+            searching = true;
+        }
+        bool found = false;
+        if (!stepSearch(budget, found)) {
+            break; // Out of budget; carries on next update
+        }
+        pathScratch.clear();
+        if (found) {
+            tracePath(pathScratch);
+        }
+        entry.start = query.start;
+        entry.goal = query.goal;
+        entry.found = found;
+        entry.path.assign(pathScratch.begin(), pathScratch.end());
+        finish(query.id, found, pathScratch);
+        stats.solved++;
+        searching = false;
+        ++queueHead;
+    }
+    if (queueHead == queue.size()) {
+        queue.clear();
+        queueHead = 0;
+    }
+    stats.pending = queue.size() - queueHead;
+    stats.maxExpansions = std::max(stats.maxExpansions, stats.expansions);
+}
+
+void NavPathfinder::finish(RequestId id, bool found, const std::vector<uint32_t>& path) {
+    Result& result = results[id % MAX_RESULTS];
+    if (result.id != id) {
+        return; // Its slot went to a newer request
+    }
+    result.status = found ? Status::Found : Status::NotFound;
+    result.path.assign(path.begin(), path.end());
+}
+
+NavPathfinder::Status NavPathfinder::poll(RequestId id, std::vector<uint32_t>& path) {
+    if (id == NO_REQUEST || results.size() != MAX_RESULTS) {
+        return Status::Unknown;
+    }
+    Result& result = results[id % MAX_RESULTS];
+    if (result.id != id) {
+        return Status::Unknown;
+    }
+    if (result.status == Status::Pending) {
+        return Status::Pending;
+    }
+    path.assign(result.path.begin(), result.path.end());
+    result.id = NO_REQUEST;
+    return result.status;
+}
@@ -0,0 +1,169 @@
+#include "NetTransport.hpp"
+#include <cstring>
+
+namespace {
+
+constexpr uint32_t PROTOCOL_VERSION = 1;
+
+void writeU32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint32_t readU32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | static_cast<uint32_t>(in[1]) << 8 |
+           static_cast<uint32_t>(in[2]) << 16 | static_cast<uint32_t>(in[3]) << 24;
+}
+
+} // namespace
+
+bool NetTransport::host(unsigned short port, const MatchSettings& match, std::string& error) {
+    close();
+    if (socket.bind(port) != sf::Socket::Status::Done) {
+        error = "can't bind UDP port " + std::to_string(port);
+        return false;
+    }
+    socket.setBlocking(false);
+    settings = match;
+    state = State::Hosting;
+    return true;
+}
+
+bool NetTransport::join(const std::string& address, unsigned short port, std::string& error) {
+    close();
+    peer = sf::IpAddress::resolve(address);
+    if (!peer) {
+        error = "can't resolve " + address;
+        return false;
+    }
+    if (socket.bind(sf::Socket::AnyPort) != sf::Socket::Status::Done) {
+        error = "can't open a UDP socket";
+        return false;
+    }
+    socket.setBlocking(false);
+    peerPort = port;
+    state = State::Joining;
+    lastHeard = Clock::now();
+    sendHello();
+    return true;
+}
+
+void NetTransport::close() {
+    if (state == State::Connected) {
+        const uint8_t bye = Bye;
+        sendRaw(&bye, 1);
+    }
+    socket.unbind();
+    state = State::Closed;
+    peer.reset();
+    peerPort = 0;
+    received = 0;
+}
+
+void NetTransport::update() {
+    const Clock::time_point now = Clock::now();
+    if (state == State::Joining &&
+        std::chrono::duration<double>(now - lastHello).count() >= HELLO_INTERVAL_SECONDS) {
+        sendHello();
+    }
+    if ((state == State::Joining || state == State::Connected) &&
+        std::chrono::duration<double>(now - lastHeard).count() >= TIMEOUT_SECONDS) {
+        lastError = state == State::Joining ? "no answer from the host" : "the peer stopped responding";
+        state = State::Closed; // Not close(): there is nobody to say bye to
+        socket.unbind();
+    }
+}
+
+NetTransport::Message NetTransport::receive() {
+    while (state != State::Closed) {
+        std::optional<sf::IpAddress> sender;
+        unsigned short senderPort = 0;
+        received = 0;
+        if (socket.receive(buffer.data(), buffer.size(), received, sender, senderPort) != sf::Socket::Status::Done) {
+            return Message::None;
+        }
+        if (received == 0 || !sender) continue;
+        const bool fromPeer = peer && *sender == *peer && senderPort == peerPort;
+
+        switch (buffer[0]) {
+            case Hello:
+                // The host takes the first peer that speaks its protocol; a repeated hello means the welcome was lost
+                if (received < 5 || readU32(buffer.data() + 1) != PROTOCOL_VERSION) break;
+                if (state == State::Hosting) {
+                    peer = sender;
+                    peerPort = senderPort;
+                    state = State::Connected;
+                    lastHeard = Clock::now();
+                    sendWelcome();
+                    return Message::Welcome;
+                }
+                if (fromPeer) {
+                    lastHeard = Clock::now();
+                    sendWelcome();
+                }
+                break;
+            case Welcome:
+                if (state != State::Joining || !fromPeer || received < 17) break;
+                settings.level = readU32(buffer.data() + 1);
+                settings.tileSeed = readU32(buffer.data() + 5);
+                {
+                    const uint32_t stepBits = readU32(buffer.data() + 9);
+                    std::memcpy(&settings.fixedTimeStep, &stepBits, sizeof(float));
+                }
+                settings.inputDelay = readU32(buffer.data() + 13);
+                state = State::Connected;
+                lastHeard = Clock::now();
+                return Message::Welcome;
+            case Inputs:
+                if (state != State::Connected || !fromPeer) break;
+                lastHeard = Clock::now();
+                return Message::Inputs;
+            case Bye:
+                if (state != State::Connected || !fromPeer) break;
+                lastError = "the peer left";
+                state = State::Closed;
+                socket.unbind();
+                return Message::Bye;
+            default:
+                break;
+        }
+    }
+    return Message::None;
+}
+
+bool NetTransport::sendInputs(const uint8_t* payload, size_t size) {
+    if (state != State::Connected || size + 1 > MAX_DATAGRAM) return false;
+    std::array<uint8_t, MAX_DATAGRAM> datagram;
+    datagram[0] = Inputs;
+    std::memcpy(datagram.data() + 1, payload, size);
+    return sendRaw(datagram.data(), size + 1);
+}
+
+std::string NetTransport::getPeerName() const {
+    if (!peer) return "";
+    return peer->toString() + ":" + std::to_string(peerPort);
+}
+
+bool NetTransport::sendRaw(const void* data, size_t size) {
+    if (!peer) return false;
+    return socket.send(data, size, *peer, peerPort) == sf::Socket::Status::Done;
+}
+
+void NetTransport::sendHello() {
+    uint8_t hello[5] = {Hello};
+    writeU32(hello + 1, PROTOCOL_VERSION);
+    sendRaw(hello, sizeof(hello));
+    lastHello = Clock::now();
+}
+
+void NetTransport::sendWelcome() {
+    uint8_t welcome[17] = {Welcome};
+    writeU32(welcome + 1, settings.level);
+    writeU32(welcome + 5, settings.tileSeed);
+    uint32_t stepBits = 0;
+    std::memcpy(&stepBits, &settings.fixedTimeStep, sizeof(float));
+    writeU32(welcome + 9, stepBits);
+    writeU32(welcome + 13, settings.inputDelay);
+    sendRaw(welcome, sizeof(welcome));
+}
@@ -0,0 +1,476 @@
+#include "ParticleSystem.hpp"
+#include "Profiler.hpp"
+#include "ViewCulling.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PARTICLE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PARTICLE_NEON 1
+#endif
+
+namespace {
+
+constexpr float PI = 3.14159265f;
+constexpr float TWO_PI = 2.0f * PI;
+constexpr unsigned FLAKE_TEXTURE_SIZE = 16;
+constexpr float SPAWN_BAND = 16.f; // Height above the view new particles are spread over
+
+// Parabolic sine, within 0.06 of sin() on [-pi, pi]; plenty for sway, and it vectorizes
+constexpr float SIN_B = 4.0f / PI;
+constexpr float SIN_C = -4.0f / (PI * PI);
+
+// Sideways sway is an oscillating speed, so the GPU path (which can only evaluate
+// positions) uses its integral: amplitude / frequency * (cos(phase) - cos(phase + frequency * t))
+const char* const GPU_VERTEX_SHADER = R"(
+uniform float time;
+uniform vec2 fieldOrigin; // World top-left of the field the particles wrap in
+uniform vec2 fieldSize;
+uniform vec2 velocityMin;
+uniform vec2 velocityMax;
+uniform vec2 sway;        // Peak sideways speed, frequency
+uniform vec2 radius;      // Min, max
+uniform vec4 tint;
+void main() {
+    vec4 particle = gl_Color; // Phase, fall speed, size, sideways speed
+    float phase = (particle.r * 2.0 - 1.0) * 3.14159265;
+    vec2 velocity = mix(velocityMin, velocityMax, particle.ag);
+    float drift = sway.x / max(sway.y, 0.001) * (cos(phase) - cos(phase + sway.y * time));
+    vec2 position = gl_Vertex.xy * fieldSize + velocity * time + vec2(drift, 0.0);
+    position = fieldOrigin + mod(position - fieldOrigin, fieldSize);
+    position += gl_MultiTexCoord0.xy * mix(radius.x, radius.y, particle.b);
+    gl_Position = gl_ModelViewProjectionMatrix * vec4(position, 0.0, 1.0);
+    gl_TexCoord[0] = gl_MultiTexCoord0;
+    gl_FrontColor = vec4(tint.rgb, tint.a * (0.5 + 0.5 * particle.b));
+}
+)";
+
+const char* const GPU_FRAGMENT_SHADER = R"(
+void main() {
+    float edge = length(gl_TexCoord[0].xy);
+    gl_FragColor = vec4(gl_Color.rgb, gl_Color.a * (1.0 - smoothstep(0.4, 1.0, edge)));
+}
+)";
+
+// x += (vx + amplitude * sin(phase)) * dt, y += vy * dt, phase advances by 'step'
+// and wraps back into [-pi, pi)
+void integrate(float* x, float* y, const float* velocityX, const float* velocityY, float* phase, size_t count,
+               float dt, float amplitude, float step) {
+    size_t i = 0;
+#if defined(PARTICLE_SSE2)
+    const __m128 vDt = _mm_set1_ps(dt);
+    const __m128 vAmplitude = _mm_set1_ps(amplitude);
+    const __m128 vStep = _mm_set1_ps(step);
+    const __m128 vPi = _mm_set1_ps(PI);
+    const __m128 vTwoPi = _mm_set1_ps(TWO_PI);
+    const __m128 vSinB = _mm_set1_ps(SIN_B);
+    const __m128 vSinC = _mm_set1_ps(SIN_C);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    for (; i + 4 <= count; i += 4) {
+        __m128 p = _mm_loadu_ps(phase + i);
+        const __m128 sine = _mm_add_ps(_mm_mul_ps(vSinB, p), _mm_mul_ps(vSinC, _mm_mul_ps(p, _mm_and_ps(p, absMask))));
+        const __m128 speedX = _mm_add_ps(_mm_loadu_ps(velocityX + i), _mm_mul_ps(vAmplitude, sine));
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(speedX, vDt)));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(_mm_loadu_ps(velocityY + i), vDt)));
+        p = _mm_add_ps(p, vStep);
+        p = _mm_sub_ps(p, _mm_and_ps(_mm_cmpge_ps(p, vPi), vTwoPi));
+        _mm_storeu_ps(phase + i, p);
+    }
+#elif defined(PARTICLE_NEON)
+    const float32x4_t vDt = vdupq_n_f32(dt);
+    const float32x4_t vAmplitude = vdupq_n_f32(amplitude);
+    const float32x4_t vStep = vdupq_n_f32(step);
+    const float32x4_t vPi = vdupq_n_f32(PI);
+    const uint32x4_t vTwoPiBits = vreinterpretq_u32_f32(vdupq_n_f32(TWO_PI));
+    const float32x4_t vSinB = vdupq_n_f32(SIN_B);
+    const float32x4_t vSinC = vdupq_n_f32(SIN_C);
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t p = vld1q_f32(phase + i);
+        const float32x4_t sine = vaddq_f32(vmulq_f32(vSinB, p), vmulq_f32(vSinC, vmulq_f32(p, vabsq_f32(p))));
+        const float32x4_t speedX = vaddq_f32(vld1q_f32(velocityX + i), vmulq_f32(vAmplitude, sine));
+        vst1q_f32(x + i, vaddq_f32(vld1q_f32(x + i), vmulq_f32(speedX, vDt)));
+        vst1q_f32(y + i, vaddq_f32(vld1q_f32(y + i), vmulq_f32(vld1q_f32(velocityY + i), vDt)));
+        p = vaddq_f32(p, vStep);
+        p = vsubq_f32(p, vreinterpretq_f32_u32(vandq_u32(vcgeq_f32(p, vPi), vTwoPiBits)));
+        vst1q_f32(phase + i, p);
+    }
+#endif
+    for (; i < count; ++i) {
+        const float p = phase[i];
+        const float sine = SIN_B * p + SIN_C * (p * std::fabs(p));
+        x[i] += (velocityX[i] + amplitude * sine) * dt;
+        y[i] += velocityY[i] * dt;
+        phase[i] = p + step >= PI ? p + step - TWO_PI : p + step;
+    }
+}
+
+// Particles on screen once the field has settled: spawn rate times the time to cross the view
+size_t steadyCount(const ParticleSystem::EmitterConfig& config, size_t budget, float viewHeight) {
+    const float fallSpeed = std::max(1.f, (config.velocityMin.y + config.velocityMax.y) * 0.5f);
+    return std::min(budget, static_cast<size_t>(config.rate * viewHeight / fallSpeed));
+}
+
+} // namespace
+
+void ParticleSystem::Particles::reserve(size_t n) {
+    x.reserve(n);
+    y.reserve(n);
+    velocityX.reserve(n);
+    velocityY.reserve(n);
+    phase.reserve(n);
+    size.reserve(n);
+}
+
+void ParticleSystem::Particles::clear() {
+    x.clear();
+    y.clear();
+    velocityX.clear();
+    velocityY.clear();
+    phase.clear();
+    size.clear();
+}
+
+void ParticleSystem::Particles::swapRemove(size_t i) {
+    x[i] = x.back();
+    y[i] = y.back();
+    velocityX[i] = velocityX.back();
+    velocityY[i] = velocityY.back();
+    phase[i] = phase.back();
+    size[i] = size.back();
+    x.pop_back();
+    y.pop_back();
+    velocityX.pop_back();
+    velocityY.pop_back();
+    phase.pop_back();
+    size.pop_back();
+}
+
+ParticleSystem::ParticleSystem() : random(std::random_device{}()) {}
+
+ParticleSystem::~ParticleSystem() = default;
+
+const char* ParticleSystem::kernelName() {
+#if defined(PARTICLE_SSE2)
+    return "SSE2";
+#elif defined(PARTICLE_NEON)
+    return "NEON";
+#else
+    return "Scalar";
+#endif
+}
+
+ParticleSystem::EmitterId ParticleSystem::addEmitter(const EmitterConfig& config) {
+    auto emitter = std::make_unique<Emitter>();
+    emitter->config = config;
+    emitter->config.sizeMax = std::max(config.sizeMax, config.sizeMin);
+    emitter->particles.reserve(config.budget);
+    emitters.push_back(std::move(emitter));
+    return emitters.size() - 1;
+}
+
+void ParticleSystem::clear() {
+    emitters.clear();
+    stats = Stats();
+}
+
+void ParticleSystem::setActive(EmitterId id, bool active) {
+    Emitter& emitter = *emitters[id];
+    emitter.active = active;
+    if (!active) {
+        emitter.particles.clear();
+        emitter.warmed = false;
+    }
+}
+
+void ParticleSystem::setGpuSimulated(EmitterId id, bool gpu) {
+    emitters[id]->config.gpuSimulated = gpu;
+}
+
+bool ParticleSystem::isGpuSimulated(EmitterId id) const {
+    return emitters[id]->config.gpuSimulated && shadersAllowed && gpuReady;
+}
+
+size_t ParticleSystem::getBudget(const EmitterConfig& config) const {
+    return static_cast<size_t>(static_cast<float>(config.budget) * budgetScale);
+}
+
+void ParticleSystem::setBudgetScale(float scale) {
+    scale = std::min(std::max(scale, 0.f), 1.f);
+    if (scale == budgetScale) return;
+    budgetScale = scale;
+    for (const std::unique_ptr<Emitter>& emitter : emitters) {
+        const size_t budget = getBudget(emitter->config);
+        while (emitter->particles.count() > budget) {
+            emitter->particles.swapRemove(emitter->particles.count() - 1);
+        }
+        emitter->gpuStale = true;
+    }
+}
+
+void ParticleSystem::setBudget(EmitterId id, size_t budget) {
+    Emitter& emitter = *emitters[id];
+    if (emitter.config.budget == budget) return;
+    emitter.config.budget = budget;
+    emitter.particles.reserve(budget);
+    const size_t scaled = getBudget(emitter.config);
+    while (emitter.particles.count() > scaled) {
+        emitter.particles.swapRemove(emitter.particles.count() - 1);
+    }
+    emitter.gpuStale = true;
+}
+
+void ParticleSystem::update(float dt, const sf::FloatRect& view) {
+    PROFILE_ZONE("ParticleSystem::update");
+    const auto start = std::chrono::steady_clock::now();
+    stats.emitters = emitters.size();
+    stats.simulated = 0;
+    stats.gpu = 0;
+    stats.spawned = 0;
+
+    for (EmitterId id = 0; id < emitters.size(); ++id) {
+        Emitter& emitter = *emitters[id];
+        if (!emitter.active) {
+            continue;
+        }
+        if (isGpuSimulated(id)) {
+            // The shader owns this emitter; a switch back to the CPU starts a fresh field
+            emitter.particles.clear();
+            emitter.warmed = false;
+            stats.gpu += emitter.gpuVertices.getVertexCount() / 6;
+            continue;
+        }
+
+        const EmitterConfig& config = emitter.config;
+        Particles& particles = emitter.particles;
+        if (!emitter.warmed) {
+            // Fill the whole view at the settled density so the field doesn't start empty
+            spawn(emitter, steadyCount(config, getBudget(config), view.size.y), view, true);
+            emitter.warmed = true;
+        }
+
+        emitter.spawnDebt += config.rate * dt;
+        size_t count = static_cast<size_t>(emitter.spawnDebt);
+        emitter.spawnDebt -= static_cast<float>(count);
+        const size_t budget = getBudget(config);
+        const size_t room = budget - std::min(budget, particles.count());
+        if (count > room) {
+            count = room;
+            emitter.spawnDebt = 0.f; // At the budget: don't save up a burst for later
+        }
+        spawn(emitter, count, view, false);
+        stats.spawned += count;
+
+        integrate(particles.x.data(), particles.y.data(), particles.velocityX.data(), particles.velocityY.data(),
+                  particles.phase.data(), particles.count(), dt, config.swayAmplitude, config.swayFrequency * dt);
+        retire(emitter, view);
+        stats.simulated += particles.count();
+    }
+
+    stats.updateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ParticleSystem::spawn(Emitter& emitter, size_t count, const sf::FloatRect& view, bool anywhere) {
+    const EmitterConfig& config = emitter.config;
+    Particles& particles = emitter.particles;
+    const float margin = config.sizeMax;
+    std::uniform_real_distribution<float> spawnX(view.position.x - margin, view.position.x + view.size.x + margin);
+    std::uniform_real_distribution<float> spawnY(anywhere ? view.position.y : view.position.y - margin - SPAWN_BAND,
+                                                 anywhere ? view.position.y + view.size.y : view.position.y - margin);
+    std::uniform_real_distribution<float> speedX(config.velocityMin.x, config.velocityMax.x);
+    std::uniform_real_distribution<float> speedY(config.velocityMin.y, config.velocityMax.y);
+    std::uniform_real_distribution<float> phase(-PI, PI);
+    std::uniform_real_distribution<float> size(config.sizeMin, config.sizeMax);
+    for (size_t i = 0; i < count; ++i) {
+        particles.x.push_back(spawnX(random));
+        particles.y.push_back(spawnY(random));
+        particles.velocityX.push_back(speedX(random));
+        particles.velocityY.push_back(speedY(random));
+        particles.phase.push_back(phase(random));
+        particles.size.push_back(size(random));
+    }
+}
+
+void ParticleSystem::retire(Emitter& emitter, const sf::FloatRect& view) {
+    Particles& particles = emitter.particles;
+    const float margin = emitter.config.sizeMax;
+    const float left = view.position.x - margin;
+    const float width = view.size.x + margin * 2.f;
+    const float bottom = view.position.y + view.size.y + margin;
+    // Backwards, so the particle swapped into slot i has already been visited
+    for (size_t i = particles.count(); i-- > 0;) {
+        if (particles.y[i] > bottom) {
+            particles.swapRemove(i);
+            continue;
+        }
+        // Wrap around the view's sides; fmod covers a camera that jumped (level load)
+        float& x = particles.x[i];
+        if (x < left || x > left + width) {
+            x = left + std::fmod(x - left, width);
+            if (x < left) {
+                x += width;
+            }
+        }
+    }
+}
+
+void ParticleSystem::initializeGpu() {
+    gpuInitialized = true;
+
+    // Soft round dot, the same falloff as the GPU fragment shader
+    sf::Image image(sf::Vector2u(FLAKE_TEXTURE_SIZE, FLAKE_TEXTURE_SIZE), sf::Color::Transparent);
+    const float half = FLAKE_TEXTURE_SIZE / 2.f;
+    for (unsigned y = 0; y < FLAKE_TEXTURE_SIZE; ++y) {
+        for (unsigned x = 0; x < FLAKE_TEXTURE_SIZE; ++x) {
+            const float edge = std::hypot(x + 0.5f - half, y + 0.5f - half) / half;
+            const float t = std::clamp((edge - 0.4f) / 0.6f, 0.f, 1.f);
+            const float alpha = 1.f - t * t * (3.f - 2.f * t);
+            image.setPixel(sf::Vector2u(x, y), sf::Color(255, 255, 255, static_cast<std::uint8_t>(alpha * 255.f)));
+        }
+    }
+    if (flakeTexture.loadFromImage(image)) {
+        flakeTexture.setSmooth(true);
+    } else {
+        std::cerr << "ParticleSystem: could not create the flake texture; particles are drawn square" << std::endl;
+    }
+
+    if (!sf::Shader::isAvailable() || !sf::VertexBuffer::isAvailable()) {
+        return;
+    }
+    if (!gpuShader.loadFromMemory(GPU_VERTEX_SHADER, GPU_FRAGMENT_SHADER)) {
+        std::cerr << "ParticleSystem: shader failed to compile; particles are simulated on the CPU" << std::endl;
+        return;
+    }
+    gpuReady = true;
+}
+
+bool ParticleSystem::buildGpuVertices(Emitter& emitter, const sf::Vector2f& viewSize) {
+    // Two triangles per particle. Positions are fractions of the field, texture
+    // coordinates the corner (-1..1), and the colour carries the particle's
+    // phase, fall speed, size and sideways speed for the vertex shader.
+    static const sf::Vector2f CORNERS[6] = {{-1.f, -1.f}, {1.f, -1.f}, {-1.f, 1.f}, {1.f, -1.f}, {1.f, 1.f}, {-1.f, 1.f}};
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    std::uniform_int_distribution<int> byte(0, 255);
+    emitter.gpuStale = false;
+    const size_t count = steadyCount(emitter.config, getBudget(emitter.config), viewSize.y);
+    std::vector<sf::Vertex> vertices;
+    vertices.reserve(count * 6);
+    for (size_t i = 0; i < count; ++i) {
+        const sf::Vector2f position(unit(random), unit(random));
+        const sf::Color particle(static_cast<std::uint8_t>(byte(random)), static_cast<std::uint8_t>(byte(random)),
+                                 static_cast<std::uint8_t>(byte(random)), static_cast<std::uint8_t>(byte(random)));
+        for (const sf::Vector2f& corner : CORNERS) {
+            vertices.push_back(sf::Vertex{position, particle, corner});
+        }
+    }
+    if (vertices.empty() || !emitter.gpuVertices.create(vertices.size()) || !emitter.gpuVertices.update(vertices.data())) {
+        std::cerr << "ParticleSystem: could not fill a vertex buffer for " << emitter.config.name << std::endl;
+        emitter.gpuVertices = sf::VertexBuffer(sf::PrimitiveType::Triangles, sf::VertexBuffer::Usage::Static);
+        return false;
+    }
+    return true;
+}
+
+void ParticleSystem::draw(sf::RenderTarget& target, RenderStats& renderStats, bool allowShaders) {
+    PROFILE_ZONE("ParticleSystem::draw");
+    if (!gpuInitialized) {
+        initializeGpu();
+    }
+    shadersAllowed = allowShaders;
+    stats.drawn = 0;
+    stats.culled = 0;
+
+    const sf::View& view = target.getView();
+    const sf::FloatRect viewBounds = ViewCulling::getViewBounds(view);
+    for (EmitterId id = 0; id < emitters.size(); ++id) {
+        Emitter& emitter = *emitters[id];
+        if (!emitter.active) {
+            continue;
+        }
+        if (isGpuSimulated(id)) {
+            drawGpu(emitter, target, renderStats, view);
+        } else if (emitter.warmed) {
+            drawCpu(emitter, target, renderStats, viewBounds);
+        }
+    }
+}
+
+void ParticleSystem::drawCpu(Emitter& emitter, sf::RenderTarget& target, RenderStats& renderStats,
+                             const sf::FloatRect& view) {
+    const EmitterConfig& config = emitter.config;
+    const Particles& particles = emitter.particles;
+    const float left = view.position.x;
+    const float right = view.position.x + view.size.x;
+    const float top = view.position.y;
+    const float bottom = view.position.y + view.size.y;
+    const float textureSize = static_cast<float>(flakeTexture.getSize().x);
+    const float sizeRange = config.sizeMax - config.sizeMin;
+
+    // Resized down afterwards, which keeps the capacity for the next frame
+    sf::VertexArray& vertices = emitter.vertices;
+    vertices.resize(particles.count() * 6);
+    size_t used = 0;
+    for (size_t i = 0; i < particles.count(); ++i) {
+        const float x = particles.x[i];
+        const float y = particles.y[i];
+        const float r = particles.size[i];
+        if (x + r < left || x - r > right || y + r < top || y - r > bottom) {
+            stats.culled++;
+            continue;
+        }
+        // Smaller particles read as further away, so they are fainter
+        const float depth = sizeRange > 0.f ? (r - config.sizeMin) / sizeRange : 1.f;
+        sf::Color color = config.color;
+        color.a = static_cast<std::uint8_t>(config.color.a * (0.5f + 0.5f * depth));
+
+        sf::Vertex* quad = &vertices[used];
+        quad[0] = sf::Vertex{sf::Vector2f(x - r, y - r), color, sf::Vector2f(0.f, 0.f)};
+        quad[1] = sf::Vertex{sf::Vector2f(x + r, y - r), color, sf::Vector2f(textureSize, 0.f)};
+        quad[2] = sf::Vertex{sf::Vector2f(x - r, y + r), color, sf::Vector2f(0.f, textureSize)};
+        quad[3] = quad[1];
+        quad[4] = sf::Vertex{sf::Vector2f(x + r, y + r), color, sf::Vector2f(textureSize, textureSize)};
+        quad[5] = quad[2];
+        used += 6;
+    }
+    vertices.resize(used);
+    if (used == 0) {
+        return;
+    }
+
+    sf::RenderStates states;
+    if (textureSize > 0.f) {
+        states.texture = &flakeTexture;
+    }
+    renderStats.draw(target, vertices, RenderCategory::Particles, states);
+    stats.drawn += used / 6;
+}
+
+void ParticleSystem::drawGpu(Emitter& emitter, sf::RenderTarget& target, RenderStats& renderStats,
+                             const sf::View& view) {
+    if ((emitter.gpuVertices.getVertexCount() == 0 || emitter.gpuStale) && !buildGpuVertices(emitter, view.getSize())) {
+        gpuReady = false; // Back to the CPU from the next update
+        return;
+    }
+
+    // Particles wrap within a field one particle wider than the view, so none pops at the edges
+    const EmitterConfig& config = emitter.config;
+    const sf::Vector2f margin(config.sizeMax, config.sizeMax);
+    const sf::Vector2f topLeft = view.getCenter() - view.getSize() / 2.f;
+    gpuShader.setUniform("time", std::fmod(gpuClock.getElapsedTime().asSeconds(), TIME_WRAP));
+    gpuShader.setUniform("fieldOrigin", sf::Glsl::Vec2(topLeft - margin));
+    gpuShader.setUniform("fieldSize", sf::Glsl::Vec2(view.getSize() + margin * 2.f));
+    gpuShader.setUniform("velocityMin", sf::Glsl::Vec2(config.velocityMin));
+    gpuShader.setUniform("velocityMax", sf::Glsl::Vec2(config.velocityMax));
+    gpuShader.setUniform("sway", sf::Glsl::Vec2(config.swayAmplitude, config.swayFrequency));
+    gpuShader.setUniform("radius", sf::Glsl::Vec2(config.sizeMin, config.sizeMax));
+    gpuShader.setUniform("tint", sf::Glsl::Vec4(config.color));
+
+    sf::RenderStates states;
+    states.shader = &gpuShader;
+    renderStats.draw(target, emitter.gpuVertices, RenderCategory::Particles, states);
+    stats.drawn += emitter.gpuVertices.getVertexCount() / 6;
+}
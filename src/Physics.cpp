@@ -1,39 +1,62 @@
 #include "Physics.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include "DebugLog.hpp"
 #include <SFML/Graphics.hpp>
 #include "NPC.hpp"
+#include "SimSnapshot.hpp"
+#include "GameEvents.hpp"
 
-// Helper function for rectangle intersection (SFML 3.x compatibility)
-static bool rectsIntersect(const sf::FloatRect& a, const sf::FloatRect& b) {
-    return a.position.x < b.position.x + b.size.x &&
-           a.position.x + a.size.x > b.position.x &&
-           a.position.y < b.position.y + b.size.y &&
-           a.position.y + a.size.y > b.position.y;
+namespace {
+
+// What an NPC's collision shape is taken relative to
+sf::FloatRect getNPCSpriteBounds(const NPCSystem::NPCData& npc) {
+    if (npc.hasSprite()) {
+        return npc.getSpriteBounds();
+    }
+    return sf::FloatRect(sf::Vector2f(npc.x, npc.y), sf::Vector2f(32.f, 32.f)); // Default size if no sprite
+}
+
+float distanceSquared(const sf::FloatRect& box, const sf::Vector2f& point) {
+    const float dx = std::max({box.position.x - point.x, 0.0f, point.x - (box.position.x + box.size.x)});
+    const float dy = std::max({box.position.y - point.y, 0.0f, point.y - (box.position.y + box.size.y)});
+    return dx * dx + dy * dy;
 }
 
+// Everywhere an enemy's patrol can take it: the patrol span at its height, and where it is now
+sf::FloatRect getPatrolArea(const EnemyStore& enemies, size_t i) {
+    const float left = std::min(enemies.patrolStart[i], enemies.posX[i]);
+    const float right = std::max(enemies.patrolStart[i] + enemies.patrolWidth[i], enemies.posX[i]) + enemies.width[i];
+    return sf::FloatRect(sf::Vector2f(left, enemies.posY[i]), sf::Vector2f(right - left, enemies.height[i]));
+}
+
+} // namespace
+
+// What a specialized step takes as given for the level. The generic one reads
+// the settings each time, so the debug panel can change them mid-level.
+template <bool Generic, bool Gravity, bool OneWay, bool Bounce>
+struct PhysicsSystem::StepPolicy {
+    static constexpr bool GENERIC = Generic;
+    static constexpr bool GRAVITY = Gravity; // The player falls
+    static constexpr bool ONE_WAY = OneWay;  // useOneWayPlatforms
+    static constexpr bool BOUNCE = Bounce;   // The player's or the enemies' bounce factor is nonzero
+};
+
 PhysicsSystem::PhysicsSystem() : 
     gravity(10.0f),
     terminalVelocity(600.0f),
     jumpForce(15.0f * 60.0f),
-    playerCollisionWidth(1.0f),
-    playerCollisionHeight(1.0f),
-    playerOffsetX(0.0f),
-    playerOffsetY(0.0f),
     playerBounceFactor(0.0f),
-    enemyCollisionWidth(1.0f),
-    enemyCollisionHeight(1.0f),
-    enemyOffsetX(0.0f),
-    enemyOffsetY(0.0f),
     enemyBounceFactor(0.1f),
-    npcCollisionWidth(1.0f),
-    npcCollisionHeight(1.0f),
-    npcOffsetX(0.0f),
-    npcOffsetY(0.0f),
     npcBounceFactor(0.0f),
     platformFriction(0.3f),
     useOneWayPlatforms(false),
     windowWidth(800),
     windowHeight(600) {
+    playerShape.centered = true; // Center the collision box on the sprite
+    selectStep();
 }
 
 PhysicsSystem::~PhysicsSystem() {
@@ -42,428 +65,894 @@ PhysicsSystem::~PhysicsSystem() {
 
 void PhysicsSystem::initialize() {
     // Clear all physics components
-    platformPhysics.clear();
-    enemyPhysics.clear();
-    npcPhysics.clear();
-    
-    // Initialize player physics
-    playerPhysics.hasGravity = true;
-    playerPhysics.isStatic = false;
-    playerPhysics.bounceFactor = playerBounceFactor;
-    playerPhysics.friction = 0.0f; // Player has no friction
+    releaseBodies(platformBodies);
+    platformGrid.clear();
+    tileMap.clearPlatforms();
+    looseGrid.clear();
+    loosePlatforms.clear();
+    selectStep();
+}
+
+void PhysicsSystem::releaseBodies(std::vector<PhysicsBodyStore::Handle>& handles) {
+    for (auto handle : handles) {
+        bodies.destroy(handle);
+    }
+    handles.clear();
 }
 
 void PhysicsSystem::initializePlayer(Player& player) {
     // Initialize player physics component
-    sf::FloatRect playerBounds = player.getGlobalBounds();
-    float width = playerBounds.size.x * playerCollisionWidth;
-    float height = playerBounds.size.y * playerCollisionHeight;
-    
-    // Center the collision box on the sprite
-    float offsetX = (playerBounds.size.x - width) / 2.0f;
-    float offsetY = (playerBounds.size.y - height) / 2.0f;
-    
-    playerPhysics.collisionBox = sf::FloatRect(
-        sf::Vector2f(playerBounds.position.x + offsetX, playerBounds.position.y + offsetY),
-        sf::Vector2f(width, height)
-    );
+    const sf::FloatRect playerBounds = player.getGlobalBounds();
+    playerBox.update(playerShape, playerBounds.size);
+    playerCollisionBox = playerBox.at(playerBounds.position);
+    playerSupport = -1;
     
     // Initialize with zero velocity since we'll position player properly
-    playerPhysics.velocity = sf::Vector2f(0.0f, 0.0f);
-    player.setVelocity(playerPhysics.velocity);
+    player.setVelocity(sf::Vector2f(0.0f, 0.0f));
     
     // Ensure player is positioned correctly relative to ground
     float groundLevel = windowHeight - 100.0f; // Match Game::GROUND_HEIGHT
     float desiredBottom = groundLevel - 1.0f; // Position slightly above ground
-    float newY = desiredBottom - height; // Use collision height for accurate positioning
+    float newY = desiredBottom - playerBox.localBox.size.y; // Use collision height for accurate positioning
     player.setPosition(sf::Vector2f(player.getPosition().x, newY));
 }
 
-void PhysicsSystem::initializePlatforms(const std::vector<sf::RectangleShape>& platforms) {
-    platformPhysics.clear();
+static Narrowphase::SurfaceType getSurfaceType(LevelData::Slope slope) {
+    switch (slope) {
+        case LevelData::Slope::Left:  return Narrowphase::SurfaceType::SlopeUpLeft;
+        case LevelData::Slope::Right: return Narrowphase::SurfaceType::SlopeUpRight;
+        default:                      return Narrowphase::SurfaceType::Solid;
+    }
+}
+
+void PhysicsSystem::initializePlatforms(const LevelGeometry& platforms) {
+    releaseBodies(platformBodies);
+    platformBodies.reserve(platforms.size());
+    platformTypes.clear();
+    platformTypes.reserve(platforms.size());
     
-    for (const auto& platform : platforms) {
+    for (size_t i = 0; i < platforms.size(); ++i) {
+        platformTypes.push_back(getSurfaceType(platforms.getSlope(i)));
         PhysicsComponent pc;
-        pc.collisionBox = platform.getGlobalBounds();
+        pc.collisionBox = platforms.getBounds(i);
         pc.hasGravity = false;
         pc.isStatic = true;
         pc.friction = platformFriction;
-        platformPhysics.push_back(pc);
+        pc.layer = CollisionLayer::Solid;
+        pc.mask = defaultCollisionMask(CollisionLayer::Solid);
+        platformBodies.push_back(bodies.create(pc));
     }
+    
+    rebuildPlatformGrid();
+    forgetSupports();
+    wakeAll(); // Whatever a sleeper rested on may be gone
 }
 
-void PhysicsSystem::initializeEnemies(const std::vector<Enemy>& enemies) {
-    enemyPhysics.clear();
+void PhysicsSystem::rebuildPlatformGrid() {
+    std::vector<sf::FloatRect> bounds;
+    bounds.reserve(platformBodies.size());
+    platformBoxes.clear();
+    platformBoxes.reserve(platformBodies.size());
+    platformSurfaces.clear();
+    platformSurfaces.reserve(platformBodies.size());
+    for (size_t i = 0; i < platformBodies.size(); ++i) {
+        bounds.push_back(bodies.getBox(platformBodies[i]));
+        platformBoxes.push(bounds.back());
+        platformSurfaces.push_back(Narrowphase::Surface{bounds.back(), platformTypes[i]});
+    }
+    platformGrid.build(bounds);
     
-    for (const auto& enemy : enemies) {
-        PhysicsComponent pc;
-        sf::FloatRect bounds = enemy.getGlobalBounds();
-        // Adjust collision box based on settings
-        float width = bounds.size.x * enemyCollisionWidth;
-        float height = bounds.size.y * enemyCollisionHeight;
-        
-        // Apply custom offsets instead of automatic centering
-        float offsetX = bounds.size.x * enemyOffsetX; 
-        float offsetY = bounds.size.y * enemyOffsetY;
-        
-        pc.collisionBox = sf::FloatRect(
-            sf::Vector2f(bounds.position.x + offsetX, bounds.position.y + offsetY),
-            sf::Vector2f(width, height)
-        );
-        pc.hasGravity = true;
-        pc.isStatic = false;
-        pc.bounceFactor = enemyBounceFactor;
-        pc.friction = 0.0f;
-        
-        enemyPhysics.push_back(pc);
+    // Whatever sits on the level grid (with the default Solid filter) goes on the tile layer
+    tileMap.clearPlatforms();
+    loosePlatforms.clear();
+    std::vector<sf::FloatRect> looseBounds;
+    for (size_t i = 0; i < platformBodies.size(); ++i) {
+        const auto platform = platformBodies[i];
+        const bool solid = bodies.layer[platform] == CollisionLayer::Solid &&
+                           bodies.mask[platform] == defaultCollisionMask(CollisionLayer::Solid);
+        if (!solid || !tileMap.addPlatform(static_cast<uint32_t>(i), bounds[i], platformTypes[i])) {
+            loosePlatforms.push_back(static_cast<uint32_t>(i));
+            looseBounds.push_back(bounds[i]);
+        }
     }
+    looseGrid.setCellSize(platformGrid.getCellSize());
+    looseGrid.build(looseBounds);
 }
 
-void PhysicsSystem::initializeNPCs(const std::vector<NPCSystem::NPCData>& npcs) {
-    npcPhysics.clear();
-    
-    for (const auto& npc : npcs) {
-        PhysicsComponent pc;
-        
-        // Get sprite bounds if available
-        sf::FloatRect bounds;
-        if (npc.sprite) {
-            bounds = npc.sprite->getGlobalBounds();
-        } else {
-            // Default size if no sprite
-            bounds = sf::FloatRect(
-                sf::Vector2f(npc.x, npc.y),
-                sf::Vector2f(32.f, 32.f)
-            );
+void PhysicsSystem::setTileGrid(float tileSize, const sf::Vector2f& levelSize) {
+    tileMap.reset(tileSize, levelSize);
+    looseLadders.clear();
+    rebuildPlatformGrid();
+}
+
+void PhysicsSystem::initializeLadders(const LevelGeometry& ladders) {
+    tileMap.clearLadders();
+    looseLadders.clear();
+    for (size_t i = 0; i < ladders.size(); ++i) {
+        if (!tileMap.addLadder(ladders.getBounds(i))) {
+            looseLadders.push_back(ladders.getBounds(i));
         }
-        
-        // Adjust collision box based on settings
-        float width = bounds.size.x * npcCollisionWidth;
-        float height = bounds.size.y * npcCollisionHeight;
-        
-        // Apply custom offsets
-        float offsetX = bounds.size.x * npcOffsetX;
-        float offsetY = bounds.size.y * npcOffsetY;
-        
-        pc.collisionBox = sf::FloatRect(
-            sf::Vector2f(bounds.position.x + offsetX, bounds.position.y + offsetY),
-            sf::Vector2f(width, height)
-        );
-        
-        pc.hasGravity = true;
-        pc.isStatic = true; // NPCs are static by default
-        pc.bounceFactor = npcBounceFactor;
-        pc.friction = 0.0f;
-        
-        npcPhysics.push_back(pc);
     }
 }
 
-void PhysicsSystem::update(float deltaTime, Player& player, std::vector<Enemy>& enemies) {
-    // Update player physics component
-    sf::FloatRect playerBounds = player.getGlobalBounds();
-    float width = playerBounds.size.x * playerCollisionWidth;
-    float height = playerBounds.size.y * playerCollisionHeight;
-    
-    // Center the collision box on the sprite
-    float offsetX = (playerBounds.size.x - width) / 2.0f;
-    float offsetY = (playerBounds.size.y - height) / 2.0f;
-    
-    playerPhysics.collisionBox = sf::FloatRect(
-        sf::Vector2f(playerBounds.position.x + offsetX, playerBounds.position.y + offsetY),
-        sf::Vector2f(width, height)
-    );
-    
-    // Copy player's velocity to physics system to ensure jumps are processed
-    playerPhysics.velocity = player.getVelocity();
+void PhysicsSystem::updatePlatform(size_t index, const sf::FloatRect& bounds, LevelData::Slope slope) {
+    if (index >= platformBodies.size()) {
+        return;
+    }
+    const auto platform = platformBodies[index];
+    const sf::FloatRect previous = bodies.getBox(platform);
+    platformTypes[index] = getSurfaceType(slope);
+    bodies.setBox(platform, bounds);
+    platformBoxes.minX[index] = bounds.position.x;
+    platformBoxes.minY[index] = bounds.position.y;
+    platformBoxes.maxX[index] = bounds.position.x + bounds.size.x;
+    platformBoxes.maxY[index] = bounds.position.y + bounds.size.y;
+    platformSurfaces[index] = Narrowphase::Surface{bounds, platformTypes[index]};
+    platformGrid.update(index, bounds);
+
+    // Off the tile layer (or out of the loose grid), then back on whichever takes it now
+    const uint32_t item = static_cast<uint32_t>(index);
+    auto loose = std::find(loosePlatforms.begin(), loosePlatforms.end(), item);
+    tileMap.removePlatform(item, previous);
+    const bool solid = bodies.layer[platform] == CollisionLayer::Solid &&
+                       bodies.mask[platform] == defaultCollisionMask(CollisionLayer::Solid);
+    if (solid && tileMap.addPlatform(item, bounds, platformTypes[index])) {
+        if (loose != loosePlatforms.end()) {
+            looseGrid.remove(static_cast<size_t>(loose - loosePlatforms.begin()));
+        }
+    } else if (loose != loosePlatforms.end()) {
+        looseGrid.update(static_cast<size_t>(loose - loosePlatforms.begin()), bounds);
+    } else {
+        loosePlatforms.push_back(item);
+        looseGrid.update(loosePlatforms.size() - 1, bounds);
+    }
+    forgetSupports();
+    wakeAll(); // Whatever rested on it may be floating now
+}
+
+void PhysicsSystem::updateLadder(const LevelGeometry& ladders, const sf::FloatRect& from, const sf::FloatRect& to) {
+    auto loose = std::find(looseLadders.begin(), looseLadders.end(), from);
+    if (loose != looseLadders.end()) {
+        looseLadders.erase(loose);
+    } else if (tileMap.removeLadder(from)) {
+        // Ladder cells are shared: put back whatever else covered the old ones
+        for (size_t i = 0; i < ladders.size(); ++i) {
+            const sf::FloatRect& ladder = ladders.getBounds(i);
+            if (ladder.findIntersection(from)) {
+                tileMap.addLadder(ladder);
+            }
+        }
+    }
+    if (!tileMap.addLadder(to)) {
+        looseLadders.push_back(to);
+    }
+}
+
+bool PhysicsSystem::isOnLadder(const sf::FloatRect& box) const {
+    if (tileMap.anyLadder(box)) {
+        return true;
+    }
+    for (const sf::FloatRect& ladder : looseLadders) {
+        if (box.position.x <= ladder.position.x + ladder.size.x && box.position.x + box.size.x >= ladder.position.x &&
+            box.position.y <= ladder.position.y + ladder.size.y && box.position.y + box.size.y >= ladder.position.y) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PhysicsSystem::setBroadphaseCellSize(float size) {
+    platformGrid.setCellSize(size);
+    rebuildPlatformGrid();
+}
+
+const std::vector<size_t>& PhysicsSystem::queryPlatforms(const sf::FloatRect& area, CollisionLayer layer,
+                                                         CollisionMask mask, QueryScratch& scratch,
+                                                         bool withTiles) const {
+    if (tileMap.isEnabled()) {
+        // Cells touched for the tile layer, the loose grid for the rest, merged in ascending order
+        scratch.candidates.clear();
+        if (withTiles) {
+            tileMap.collectPlatforms(area, scratch.candidates);
+        }
+        looseGrid.query(area, scratch.loose);
+        for (size_t item : scratch.loose) {
+            scratch.candidates.push_back(loosePlatforms[item]);
+        }
+        std::sort(scratch.candidates.begin(), scratch.candidates.end());
+        scratch.candidates.erase(std::unique(scratch.candidates.begin(), scratch.candidates.end()),
+                                 scratch.candidates.end());
+    } else {
+        platformGrid.query(area, scratch.candidates);
+    }
+    // Pair filter: platforms this body can never touch don't reach the narrowphase
+    const size_t found = scratch.candidates.size();
+    scratch.candidates.erase(std::remove_if(scratch.candidates.begin(), scratch.candidates.end(),
+                                            [&](size_t p) {
+                                                const auto platform = platformBodies[p];
+                                                return !canCollide(layer, mask, bodies.layer[platform],
+                                                                   bodies.mask[platform]);
+                                            }),
+                             scratch.candidates.end());
+    const size_t count = scratch.candidates.size();
+    scratch.stats.filtered += found - count;
+    scratch.stats.queries++;
+    scratch.stats.candidates += count;
+    scratch.stats.lastQueryCandidates = count;
+    return scratch.candidates;
+}
+
+template <class Policy>
+Narrowphase::SweepResult PhysicsSystem::sweepBody(const sf::FloatRect& end, const sf::Vector2f& move, bool wasGrounded,
+                                                  CollisionLayer layer, CollisionMask mask,
+                                                  QueryScratch& scratch) const {
+    const sf::FloatRect start(end.position - move, end.size);
+    const auto& candidates = queryPlatforms(Narrowphase::getSweepBounds(start, move), layer, mask, scratch);
+    if constexpr (Policy::GENERIC) {
+        return Narrowphase::sweep(start, move, wasGrounded, platformSurfaces, candidates, useOneWayPlatforms);
+    } else {
+        return Narrowphase::sweep<Policy::ONE_WAY>(start, move, wasGrounded, platformSurfaces, candidates);
+    }
+}
+
+template <class Policy>
+Narrowphase::SweepResult PhysicsSystem::resolveBody(const sf::FloatRect& end, const sf::Vector2f& move,
+                                                    bool wasGrounded, int32_t& support, CollisionLayer layer,
+                                                    CollisionMask mask, QueryScratch& scratch) const {
+    // With no move the sweep is only its support pass, which would pick the same top again
+    if (wasGrounded && move.x == 0.f && move.y == 0.f && isRestingOn(support, end)) {
+        scratch.stats.supportHits++;
+        Narrowphase::SweepResult hit;
+        hit.position = sf::Vector2f(end.position.x,
+                                    platformSurfaces[support].bounds.position.y - end.size.y - Narrowphase::SKIN);
+        hit.onGround = true;
+        hit.ground = support;
+        return hit;
+    }
+    if (wasGrounded) {
+        scratch.stats.supportMisses++;
+    }
+    const Narrowphase::SweepResult hit = sweepBody<Policy>(end, move, wasGrounded, layer, mask, scratch);
+    support = hit.onGround ? hit.ground : -1;
+    return hit;
+}
+
+bool PhysicsSystem::isRestingOn(int32_t platform, const sf::FloatRect& box) const {
+    if (platform < 0 || static_cast<size_t>(platform) >= platformSurfaces.size()) {
+        return false;
+    }
+    // Slopes move the feet with x; only flat tops are taken on trust
+    const Narrowphase::Surface& surface = platformSurfaces[platform];
+    if (surface.type != Narrowphase::SurfaceType::Solid && surface.type != Narrowphase::SurfaceType::OneWay) {
+        return false;
+    }
+    const sf::FloatRect& b = surface.bounds;
+    constexpr float tolerance = 0.01f;
+    return box.position.x < b.position.x + b.size.x && box.position.x + box.size.x > b.position.x &&
+           std::abs(box.position.y + box.size.y + Narrowphase::SKIN - b.position.y) <= tolerance;
+}
+
+void PhysicsSystem::forgetSupports() {
+    playerSupport = -1;
+    if (enemyStore) {
+        std::fill(enemyStore->support.begin(), enemyStore->support.end(), -1);
+    }
+    if (npcStore) {
+        for (auto& npc : *npcStore) {
+            npc.support = -1;
+        }
+    }
+}
+
+const std::vector<uint32_t>& PhysicsSystem::findPlatformHits(const sf::FloatRect& box, CollisionLayer layer,
+                                                             CollisionMask mask, QueryScratch& scratch) const {
+    // Broadphase candidates, then one batch overlap test over all of them
+    const auto& candidates = queryPlatforms(box, layer, mask, scratch);
     
-    // Check ground state first, but be more lenient during jumps
-    bool playerOnGround = false;
-    if (!player.isJumping() || playerPhysics.velocity.y > 0) {
-        // Only check for ground when not jumping up
-        playerOnGround = isEntityOnGround(playerPhysics, player.getPosition(), 5.0f);
+    scratch.boxes.clear();
+    for (size_t c : candidates) {
+        scratch.boxes.push(bodies.getBox(platformBodies[c]));
     }
+    AabbBatch::overlapList(box, scratch.boxes, scratch.hits);
     
-    // Update player's ground state only if not actively jumping upward
-    if (!player.isJumping() || playerPhysics.velocity.y >= 0) {
-        player.setOnGround(playerOnGround);
+    // Map hit slots back to platform indices (still ascending)
+    for (auto& hit : scratch.hits) {
+        hit = static_cast<uint32_t>(candidates[hit]);
     }
+    return scratch.hits;
+}
+
+void PhysicsSystem::filterCandidates(CollisionMask mask, QueryScratch& scratch) const {
+    const size_t found = scratch.candidates.size();
+    scratch.candidates.erase(std::remove_if(scratch.candidates.begin(), scratch.candidates.end(),
+                                            [&](size_t p) {
+                                                return (mask & collisionBit(bodies.layer[platformBodies[p]])) == 0;
+                                            }),
+                             scratch.candidates.end());
+    scratch.stats.filtered += found - scratch.candidates.size();
+    scratch.stats.queries++;
+    scratch.stats.candidates += scratch.candidates.size();
+    scratch.stats.lastQueryCandidates = scratch.candidates.size();
+}
+
+bool PhysicsSystem::raycast(const sf::Vector2f& origin, const sf::Vector2f& direction, float maxDistance,
+                            QueryHit& hit, CollisionMask mask) const {
+    const float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+    if (length <= 0.0f || maxDistance <= 0.0f) {
+        return false;
+    }
+    const sf::Vector2f move = direction * (maxDistance / length);
+    platformGrid.querySegment(origin, origin + move, mainScratch.candidates);
+    filterCandidates(mask, mainScratch);
     
-    if (playerPhysics.hasGravity && !playerOnGround) {
-        // Apply gravity
-        playerPhysics.velocity.y += gravity * deltaTime;
-        
-        // Clamp to terminal velocity
-        if (playerPhysics.velocity.y > terminalVelocity) {
-            playerPhysics.velocity.y = terminalVelocity;
+    // A ray is a sweep of a zero-sized box
+    const sf::FloatRect point(origin, sf::Vector2f(0.0f, 0.0f));
+    float best = 2.0f;
+    for (size_t p : mainScratch.candidates) {
+        float time;
+        sf::Vector2f normal;
+        if (Narrowphase::timeOfImpact(point, move, bodies.getBox(platformBodies[p]), time, normal) && time < best) {
+            best = time;
+            hit.platform = p;
+            hit.normal = normal;
         }
-    } else if (playerOnGround) {
-        // When on ground, respect the player's vertical velocity
-        // This allows jumps to be initiated
-        if (playerPhysics.velocity.y < 0) {
-            // Maintain the jump velocity
-            std::cout << "Physics system preserving jump velocity: " << playerPhysics.velocity.y << std::endl;
-        } else {
-            // Reset vertical velocity when on ground and not jumping
-            playerPhysics.velocity.y = 0;
-            if (!player.isJumping()) {
-                player.setJumping(false); // Only reset jump state if not actively jumping
-            }
+    }
+    if (best > 1.0f) {
+        return false;
+    }
+    hit.distance = best * maxDistance;
+    hit.point = origin + move * best;
+    return true;
+}
+
+size_t PhysicsSystem::overlapBox(const sf::FloatRect& box, std::vector<uint32_t>& out, CollisionMask mask) const {
+    out.clear();
+    platformGrid.query(box, mainScratch.candidates);
+    filterCandidates(mask, mainScratch);
+    for (size_t p : mainScratch.candidates) {
+        const sf::FloatRect platform = bodies.getBox(platformBodies[p]);
+        if (box.position.x < platform.position.x + platform.size.x && box.position.x + box.size.x > platform.position.x &&
+            box.position.y < platform.position.y + platform.size.y && box.position.y + box.size.y > platform.position.y) {
+            out.push_back(static_cast<uint32_t>(p));
         }
-    } 
-    
-    // Update enemy physics
-    for (size_t i = 0; i < enemies.size() && i < enemyPhysics.size(); ++i) {
-        sf::FloatRect enemyBounds = enemies[i].getGlobalBounds();
-        float width = enemyBounds.size.x * enemyCollisionWidth;
-        float height = enemyBounds.size.y * enemyCollisionHeight;
-        
-        // Apply custom offsets instead of automatic centering
-        float offsetX = enemyBounds.size.x * enemyOffsetX;
-        float offsetY = enemyBounds.size.y * enemyOffsetY;
-        
-        enemyPhysics[i].collisionBox = sf::FloatRect(
-            sf::Vector2f(enemyBounds.position.x + offsetX, enemyBounds.position.y + offsetY),
-            sf::Vector2f(width, height)
-        );
-        
-        // Apply gravity to enemies
-        if (enemyPhysics[i].hasGravity) {
-            enemyPhysics[i].velocity.y += gravity * deltaTime;
-            
-            // Clamp to terminal velocity
-            if (enemyPhysics[i].velocity.y > terminalVelocity) {
-                enemyPhysics[i].velocity.y = terminalVelocity;
+    }
+    return out.size();
+}
+
+bool PhysicsSystem::sweepBox(const sf::FloatRect& box, const sf::Vector2f& move, QueryHit& hit,
+                             CollisionMask mask) const {
+    platformGrid.query(Narrowphase::getSweepBounds(box, move), mainScratch.candidates);
+    filterCandidates(mask, mainScratch);
+    float best = 2.0f;
+    for (size_t p : mainScratch.candidates) {
+        float time;
+        sf::Vector2f normal;
+        if (Narrowphase::timeOfImpact(box, move, bodies.getBox(platformBodies[p]), time, normal) && time < best) {
+            best = time;
+            hit.platform = p;
+            hit.normal = normal;
+        }
+    }
+    if (best > 1.0f) {
+        return false;
+    }
+    const float length = std::sqrt(move.x * move.x + move.y * move.y);
+    hit.distance = best * length;
+    hit.point = box.position + move * best;
+    return true;
+}
+
+void PhysicsSystem::forEachEnemyRange(size_t count, const JobSystem::RangeFunction& fn) {
+    if (jobSystem) {
+        jobSystem->parallelFor(count, ENEMY_GRAIN, fn);
+    } else {
+        fn(0, count);
+    }
+}
+
+void PhysicsSystem::mergeStats(const BroadphaseStats& stats) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    mainScratch.stats.queries += stats.queries;
+    mainScratch.stats.candidates += stats.candidates;
+    mainScratch.stats.filtered += stats.filtered;
+    mainScratch.stats.supportHits += stats.supportHits;
+    mainScratch.stats.supportMisses += stats.supportMisses;
+    mainScratch.stats.lastQueryCandidates = stats.lastQueryCandidates;
+}
+
+bool PhysicsSystem::isNearPlayer(const sf::FloatRect& box) const {
+    // Strict edges, as PhysicsBodyStore::overlaps
+    const sf::FloatRect& player = playerCollisionBox;
+    if (box.position.x < player.position.x + player.size.x && box.position.x + box.size.x > player.position.x &&
+        box.position.y < player.position.y + player.size.y && box.position.y + box.size.y > player.position.y) {
+        return true;
+    }
+    const float dx = box.position.x + box.size.x * 0.5f - playerCenter.x;
+    const float dy = box.position.y + box.size.y * 0.5f - playerCenter.y;
+    return dx * dx + dy * dy <= activationRadius * activationRadius;
+}
+
+void PhysicsSystem::updateEnemyRest(EnemyStore& enemies, size_t index, bool resting) {
+    if (!resting || !sleepingEnabled) {
+        enemies.restTicks[index] = 0;
+        return;
+    }
+    if (++enemies.restTicks[index] >= SLEEP_TICKS) {
+        enemies.setAwake(index, false);
+    }
+}
+
+void PhysicsSystem::updateNPCRest(NPCSystem::NPCData& npc, bool resting) {
+    if (!resting || !sleepingEnabled) {
+        npc.restTicks = 0;
+        return;
+    }
+    if (++npc.restTicks >= SLEEP_TICKS) {
+        npc.awake = false;
+    }
+}
+
+void PhysicsSystem::selectStep() {
+    if (!stepSpecialization) {
+        useGenericStep();
+        return;
+    }
+    // Indexed by gravity * 4 + one-way * 2 + bounce
+    static constexpr StepFunction SPECIALIZED[8] = {
+        &PhysicsSystem::step<StepPolicy<false, false, false, false>>,
+        &PhysicsSystem::step<StepPolicy<false, false, false, true>>,
+        &PhysicsSystem::step<StepPolicy<false, false, true, false>>,
+        &PhysicsSystem::step<StepPolicy<false, false, true, true>>,
+        &PhysicsSystem::step<StepPolicy<false, true, false, false>>,
+        &PhysicsSystem::step<StepPolicy<false, true, false, true>>,
+        &PhysicsSystem::step<StepPolicy<false, true, true, false>>,
+        &PhysicsSystem::step<StepPolicy<false, true, true, true>>,
+    };
+    static constexpr const char* NAMES[8] = {
+        "no gravity", "no gravity, bounce", "no gravity, one-way", "no gravity, one-way, bounce",
+        "gravity", "gravity, bounce", "gravity, one-way", "gravity, one-way, bounce",
+    };
+    const bool bounce = playerBounceFactor != 0.0f || enemyBounceFactor != 0.0f;
+    const size_t index = (playerGravity ? 4 : 0) + (useOneWayPlatforms ? 2 : 0) + (bounce ? 1 : 0);
+    stepFunction = SPECIALIZED[index];
+    stepName = NAMES[index];
+}
+
+void PhysicsSystem::useGenericStep() {
+    stepFunction = &PhysicsSystem::step<StepPolicy<true, true, false, true>>;
+    stepName = "generic";
+}
+
+void PhysicsSystem::setStepSpecialization(bool enabled) {
+    stepSpecialization = enabled;
+    selectStep();
+}
+
+void PhysicsSystem::setPlayerBounceFactor(float f) {
+    if (f != playerBounceFactor) {
+        playerBounceFactor = f;
+        useGenericStep();
+    }
+}
+
+void PhysicsSystem::setPlayerGravity(bool enabled) {
+    if (enabled != playerGravity) {
+        playerGravity = enabled;
+        useGenericStep();
+    }
+}
+
+void PhysicsSystem::setEnemyBounceFactor(float f) {
+    if (f != enemyBounceFactor) {
+        enemyBounceFactor = f;
+        useGenericStep();
+    }
+}
+
+void PhysicsSystem::setUseOneWayPlatforms(bool use) {
+    if (use != useOneWayPlatforms) {
+        useOneWayPlatforms = use;
+        useGenericStep();
+    }
+}
+
+void PhysicsSystem::setSleepingEnabled(bool enabled) {
+    sleepingEnabled = enabled;
+    if (!enabled) {
+        wakeAll();
+    }
+}
+
+void PhysicsSystem::wakeEnemy(size_t index) {
+    // Coarse enemies wake when updateRegions promotes them
+    if (enemyStore && index < enemyStore->size() && !enemyStore->coarse[index]) {
+        enemyStore->setAwake(index, true);
+        enemyStore->restTicks[index] = 0;
+    }
+}
+
+void PhysicsSystem::wakeNPC(size_t index) {
+    if (npcStore && index < npcStore->size()) {
+        (*npcStore)[index].awake = true;
+        (*npcStore)[index].restTicks = 0;
+    }
+}
+
+bool PhysicsSystem::isNPCAsleep(size_t index) const {
+    return npcStore && index < npcStore->size() && !(*npcStore)[index].awake;
+}
+
+void PhysicsSystem::wakeAll() {
+    for (size_t i = 0; enemyStore && i < enemyStore->size(); ++i) {
+        wakeEnemy(i);
+    }
+    for (size_t i = 0; npcStore && i < npcStore->size(); ++i) {
+        wakeNPC(i);
+    }
+}
+
+void PhysicsSystem::updateRegions(EnemyStore& enemies, const sf::Vector2f& focus, float deltaTime) {
+    PROFILE_ZONE("PhysicsSystem::updateRegions");
+    enemies.advanceClock(deltaTime);
+    const bool enabled = regionRadius > 0.0f;
+    const float promoteRadius = regionRadius * regionRadius;
+    const float demoteRadius = promoteRadius * REGION_HYSTERESIS * REGION_HYSTERESIS;
+    for (size_t i = 0; i < enemies.size(); ++i) {
+        if (enemies.coarse[i]) {
+            // Judged by its whole patrol, so it's back before it could walk into range
+            const sf::FloatRect patrol(sf::Vector2f(enemies.coarseLeft[i], enemies.posY[i]),
+                                       sf::Vector2f(enemies.coarseRange[i] + enemies.width[i], enemies.height[i]));
+            if (!enabled || distanceSquared(patrol, focus) <= promoteRadius) {
+                enemies.promote(i);
             }
+        } else if (enabled && enemies.onGround[i] && distanceSquared(getPatrolArea(enemies, i), focus) > demoteRadius) {
+            demoteEnemy(enemies, i);
         }
     }
+}
+
+void PhysicsSystem::demoteEnemy(EnemyStore& enemies, size_t i) {
+    // The patrol step also turns back where the floor ends (EnemyStore::updateEdges
+    // probes EDGE px past each side), so the coarse patrol keeps to the run of
+    // touching platforms under its feet
+    constexpr float EDGE = 5.0f;
+    const float width = enemies.width[i];
+    const float feet = enemies.posY[i] + enemies.height[i];
+    const sf::FloatRect area = getPatrolArea(enemies, i);
+    const sf::FloatRect strip(sf::Vector2f(area.position.x - EDGE * 2.0f, feet - EDGE),
+                              sf::Vector2f(area.size.x + EDGE * 4.0f, EDGE * 2.0f));
+    overlapBox(strip, floorHits);
+    floorSpans.clear();
+    for (uint32_t p : floorHits) {
+        const sf::FloatRect platform = bodies.getBox(platformBodies[p]);
+        if (std::abs(feet - platform.position.y) < EDGE) {
+            floorSpans.push_back(sf::Vector2f(platform.position.x, platform.position.x + platform.size.x));
+        }
+    }
+    std::sort(floorSpans.begin(), floorSpans.end(),
+              [](const sf::Vector2f& a, const sf::Vector2f& b) { return a.x < b.x; });
     
-    // Resolve collisions
-    resolveCollisions(player, enemies);
+    // Merge touching platforms into runs, up to the one under its centre
+    const float center = enemies.posX[i] + width * 0.5f;
+    float floorLeft = 0.0f;
+    float floorRight = 0.0f;
+    bool found = false;
+    for (size_t s = 0; s < floorSpans.size(); ++s) {
+        const sf::Vector2f& span = floorSpans[s];
+        if (s == 0 || span.x > floorRight) {
+            if (found) break;
+            floorLeft = span.x;
+        }
+        floorRight = s == 0 ? span.y : std::max(floorRight, span.y);
+        found = floorLeft <= center && center <= floorRight;
+    }
+    if (!found) {
+        return; // Not standing on anything it can patrol; stays in the simulation
+    }
     
-    // Apply physics to entities
-    applyPhysicsToEntities(player, enemies);
+    const float left = std::max({enemies.patrolStart[i], floorLeft + EDGE, EnemyStore::MIN_X});
+    const float right = std::min(enemies.patrolStart[i] + enemies.patrolWidth[i], floorRight - width - EDGE);
+    enemies.demote(i, left, right - left);
 }
 
-void PhysicsSystem::updateNPCs(std::vector<NPCSystem::NPCData>& npcs) {
-    // Update NPC physics components
-    for (size_t i = 0; i < npcs.size() && i < npcPhysics.size(); ++i) {
-        if (!npcs[i].isActive) continue;
-        
-        // Get sprite bounds if available
-        sf::FloatRect bounds;
-        if (npcs[i].sprite) {
-            bounds = npcs[i].sprite->getGlobalBounds();
+void PhysicsSystem::saveState(SimSnapshot& snapshot) const {
+    bodies.saveState(snapshot);
+    snapshot.writeArray(platformBodies);
+    snapshot.writeArray(platformTypes);
+    snapshot.write(playerCollisionBox);
+    snapshot.write(playerSupport);
+    snapshot.write(playerCenter);
+    snapshot.write(playerAcceleration);
+}
+
+bool PhysicsSystem::loadState(SimSnapshot& snapshot) {
+    if (!(bodies.loadState(snapshot) && snapshot.readArray(platformBodies) && snapshot.readArray(platformTypes) &&
+          snapshot.read(playerCollisionBox) && snapshot.read(playerSupport) && snapshot.read(playerCenter) &&
+          snapshot.read(playerAcceleration))) {
+        return false;
+    }
+    rebuildPlatformGrid();
+    return true;
+}
+
+void PhysicsSystem::initializeEnemies(EnemyStore& enemies) {
+    enemyStore = &enemies;
+    for (size_t i = 0; i < enemies.size(); ++i) {
+        wakeEnemy(i);
+        // One box per enemy type: the type fixes the size
+        const uint16_t type = enemies.type[i];
+        if (type >= enemyBoxes.size()) {
+            enemyBoxes.resize(type + 1);
+        }
+        enemyBoxes[type].update(enemyShape, enemies.getSize(i));
+    }
+}
+
+void PhysicsSystem::initializeNPCs(std::vector<NPCSystem::NPCData>& npcs) {
+    npcStore = &npcs;
+    for (auto& npc : npcs) {
+        npc.box.update(npcShape, getNPCSpriteBounds(npc).size);
+        npc.support = -1;
+        npc.awake = true;
+        npc.restTicks = 0;
+    }
+}
+
+void PhysicsSystem::update(float deltaTime, Player& player, EnemyStore& enemies) {
+    PROFILE_ZONE("PhysicsSystem::update");
+    // Collision boxes: the derived local boxes, re-derived only after a shape change
+    const sf::FloatRect playerBounds = player.getGlobalBounds();
+    playerBox.update(playerShape, playerBounds.size);
+    playerCollisionBox = playerBox.at(playerBounds.position);
+    for (ShapeCache& enemyBox : enemyBoxes) {
+        enemyBox.update(enemyShape, enemyBox.spriteSize);
+    }
+    playerCenter = playerCollisionBox.position + playerCollisionBox.size / 2.0f;
+    
+    // Sweeps, player gravity and the hand-back to the entities, as compiled for this level
+    (this->*stepFunction)(deltaTime, player, enemies);
+    
+    // Publish this frame's sleep counts (the NPC half was counted by updateNPCs)
+    for (size_t i = 0; i < enemies.size(); ++i) {
+        if (enemies.coarse[i]) {
+            sleepStats.coarseEnemies++;
+        } else if (enemies.awake[i]) {
+            sleepStats.awakeEnemies++;
         } else {
-            bounds = sf::FloatRect(
-                sf::Vector2f(npcs[i].x, npcs[i].y),
-                sf::Vector2f(32.f, 32.f)
-            );
+            sleepStats.sleepingEnemies++;
         }
+    }
+    lastSleepStats = sleepStats;
+    sleepStats = SleepStats();
+    
+    // Publish this frame's broadphase counters (includes the NPC pass run before update)
+    lastBroadphaseStats = mainScratch.stats;
+    mainScratch.stats = BroadphaseStats();
+}
+
+void PhysicsSystem::updateNPCs(std::vector<NPCSystem::NPCData>& npcs, float deltaTime) {
+    PROFILE_ZONE("PhysicsSystem::updateNPCs");
+    // The records are swept in place; each keeps its box, support and sleep state
+    for (auto& npc : npcs) {
+        if (!npc.isActive) continue;
         
-        // Update collision box
-        float width = bounds.size.x * npcCollisionWidth;
-        float height = bounds.size.y * npcCollisionHeight;
-        float offsetX = bounds.size.x * npcOffsetX;
-        float offsetY = bounds.size.y * npcOffsetY;
+        // The cached local box plus the sprite's position; a shape change re-derives it once
+        const sf::FloatRect bounds = getNPCSpriteBounds(npc);
+        const bool reshaped = npc.box.update(npcShape, bounds.size);
+        const sf::FloatRect box = npc.box.at(bounds.position);
+        const float height = box.size.y;
         
-        npcPhysics[i].collisionBox = sf::FloatRect(
-            sf::Vector2f(bounds.position.x + offsetX, bounds.position.y + offsetY),
-            sf::Vector2f(width, height)
-        );
+        // A sleeper stays put until the player gets close or its own logic moves (or reshapes) it
+        if (!npc.awake) {
+            const bool moved = reshaped || npc.x != npc.prevX || npc.y != npc.prevY;
+            if (!moved && !isNearPlayer(box)) {
+                sleepStats.sleepingNPCs++;
+                continue;
+            }
+            npc.awake = true;
+            npc.restTicks = 0;
+        }
+        sleepStats.awakeNPCs++;
+        const float startY = npc.y;
         
         // Check for ground collision
-        bool npcOnGround = isEntityOnGround(npcPhysics[i], sf::Vector2f(npcs[i].x, npcs[i].y), 5.0f);
+        bool npcOnGround = isOnGroundAt(sf::Vector2f(npc.x, npc.y), box.size, Narrowphase::CONTACT_DISTANCE,
+                                        CollisionLayer::NPC, npcCollisionMask, &npc.support);
         
         // Apply gravity if not on ground
-        if (!npcOnGround && npcPhysics[i].hasGravity) {
-            npcs[i].y += gravity * 0.016f; // Using a fixed timestep for stability
+        if (!npcOnGround) {
+            npc.y += gravity * deltaTime;
         }
         
-        // Check platform collisions
-        for (const auto& platform : platformPhysics) {
-            if (checkCollision(npcPhysics[i], platform)) {
-                // Position NPC on top of platform
-                float newY = platform.collisionBox.position.y - height - 0.1f;
-                npcs[i].y = newY;
-                break;
-            }
+        // Check platform collisions - rest on the first platform hit
+        const auto& hits = findPlatformHits(box, CollisionLayer::NPC, npcCollisionMask, mainScratch);
+        if (!hits.empty()) {
+            // Position NPC on top of platform
+            npc.y = bodies.posY[platformBodies[hits.front()]] - height - 0.1f;
         }
         
-        // Update sprite position
-        if (npcs[i].sprite) {
-            npcs[i].sprite->setPosition(sf::Vector2f(npcs[i].x, npcs[i].y));
-        }
+        const bool supported = npcOnGround || !hits.empty();
+        updateNPCRest(npc, supported && std::abs(npc.y - startY) < SLEEP_VELOCITY && !isNearPlayer(box));
     }
 }
 
-bool PhysicsSystem::isEntityOnGround(const PhysicsComponent& entityPhysics, const sf::Vector2f& position, float checkDistance) const {
+bool PhysicsSystem::isEntityOnGround(const PhysicsComponent& entityPhysics, const sf::Vector2f& position,
+                                     float checkDistance, int32_t* support) const {
+    return isOnGroundAt(position, entityPhysics.collisionBox.size, checkDistance, entityPhysics.layer,
+                        entityPhysics.mask, support);
+}
+
+bool PhysicsSystem::isStandingOn(size_t platform, const sf::Vector2f& position, const sf::Vector2f& size,
+                                 float checkDistance) const {
+    const auto body = platformBodies[platform];
+    const float platformTop = bodies.posY[body];
+    const float platformLeft = bodies.posX[body];
+    const float platformRight = platformLeft + bodies.width[body];
+    const float entityBottom = position.y + size.y;
+    
+    // Above the platform horizontally, and at the right height for it
+    return position.x + size.x >= platformLeft && position.x <= platformRight &&
+           entityBottom >= platformTop - checkDistance && entityBottom <= platformTop + checkDistance;
+}
+
+bool PhysicsSystem::isOnGroundAt(const sf::Vector2f& position, const sf::Vector2f& size, float checkDistance,
+                                 CollisionLayer layer, CollisionMask mask, int32_t* support) const {
+    // The platform it stood on last time settles most checks on its own
+    if (support && *support >= 0) {
+        if (static_cast<size_t>(*support) < platformBodies.size() &&
+            isStandingOn(static_cast<size_t>(*support), position, size, checkDistance)) {
+            mainScratch.stats.supportHits++;
+            return true;
+        }
+        mainScratch.stats.supportMisses++;
+        *support = -1;
+    }
+    
     // First check main ground platform
     float groundLevel = windowHeight - 100.0f; // Match Game::GROUND_HEIGHT
-    float entityBottom = position.y + entityPhysics.collisionBox.size.y;
-    
-    // Use a smaller check distance for more stable detection
-    float actualCheckDistance = 2.0f; // Reduced from the passed-in value for more stability
+    float entityBottom = position.y + size.y;
+    const float actualCheckDistance = checkDistance;
     
     // Check if entity is at ground level
     if (entityBottom >= groundLevel - actualCheckDistance && entityBottom <= groundLevel + actualCheckDistance) {
         return true;
     }
     
-    // Then check all other platforms
-    for (const auto& platform : platformPhysics) {
-        float platformTop = platform.collisionBox.position.y;
-        float platformLeft = platform.collisionBox.position.x;
-        float platformRight = platformLeft + platform.collisionBox.size.x;
-        
-        // Check if entity is above the platform horizontally
-        if (position.x + entityPhysics.collisionBox.size.x >= platformLeft && 
-            position.x <= platformRight) {
-            
-            // Check if entity is at the right height for the platform
-            if (entityBottom >= platformTop - actualCheckDistance && 
-                entityBottom <= platformTop + actualCheckDistance) {
-                return true;
+    // Platform tops on the tile layer: one masked bitset row per height in reach
+    const bool tiles = tileMap.isEnabled();
+    if (tiles && canCollide(layer, mask, CollisionLayer::Solid, defaultCollisionMask(CollisionLayer::Solid)) &&
+        tileMap.hasTopNear(position.x, position.x + size.x, entityBottom, actualCheckDistance)) {
+        return true;
+    }
+    
+    // Then check the other platforms near the entity's feet
+    sf::FloatRect feetArea(
+        sf::Vector2f(position.x, entityBottom - actualCheckDistance),
+        sf::Vector2f(size.x, actualCheckDistance * 2.0f)
+    );
+    for (size_t p : queryPlatforms(feetArea, layer, mask, mainScratch, !tiles)) {
+        if (isStandingOn(p, position, size, actualCheckDistance)) {
+            if (support) {
+                *support = static_cast<int32_t>(p);
             }
+            return true;
         }
     }
     
     return false;
 }
 
-void PhysicsSystem::resolveCollisions(Player& player, std::vector<Enemy>& enemies) {
-    // Check player collision with platforms
-    for (size_t i = 0; i < platformPhysics.size(); i++) {
-        const auto& platform = platformPhysics[i];
-        
-        if (checkCollision(playerPhysics, platform)) {
-            // Get previous position (before applying velocity)
-            sf::Vector2f prevPos = sf::Vector2f(
-                player.getPosition().x - player.getVelocity().x,
-                player.getPosition().y - player.getVelocity().y
-            );
-            
-            // Handle collision with platform
-            if (playerPhysics.velocity.y > 0 && 
-                prevPos.y + playerPhysics.collisionBox.size.y <= platform.collisionBox.position.y + 5) {
-                // Player is falling - land on platform
-                playerPhysics.velocity.y = 0;
-                player.setOnGround(true);
-                player.setJumping(false); // Reset jump state when landing
-                
-                // Position player on top of platform with a small offset to prevent sinking
-                float newY = platform.collisionBox.position.y - playerPhysics.collisionBox.size.y - 0.1f;
-                player.setPosition(sf::Vector2f(player.getPosition().x, newY));
-                
-                // Apply platform friction to horizontal velocity
-                playerPhysics.velocity.x *= (1.0f - platform.friction);
-            } else if (playerPhysics.velocity.y < 0 && !useOneWayPlatforms) {
-                // Player is jumping - hit bottom of platform
-                playerPhysics.velocity.y = -playerPhysics.velocity.y * playerPhysics.bounceFactor;
-            }
+template <class Policy>
+void PhysicsSystem::step(float deltaTime, Player& player, EnemyStore& enemies) {
+    // Sweep everything against the level (enemies integrate their own gravity)
+    sf::Vector2f velocity = player.getVelocity();
+    resolvePlayer<Policy>(player, velocity);
+    // Enemy ranges run in parallel; each enemy only writes its own entries
+    // of the store, and queries use thread-local scratch
+    forEachEnemyRange(enemies.size(), [&](size_t begin, size_t end) {
+        static thread_local QueryScratch scratch;
+        scratch.stats = BroadphaseStats();
+        resolveEnemies<Policy>(enemies, begin, end, scratch);
+        mergeStats(scratch.stats);
+    });
+    
+    // Player gravity, from whatever the sweep left it standing on
+    bool falls;
+    if constexpr (Policy::GENERIC) {
+        falls = playerGravity;
+    } else {
+        falls = Policy::GRAVITY;
+    }
+    if (player.isOnGround()) {
+        // Keep a jump that starts this step, otherwise rest on the ground
+        if (velocity.y > 0) {
+            velocity.y = 0;
         }
+    } else if (falls && velocity.y >= 0) {
+        // A rising player's velocity is its own jump's to change
+        velocity.y = std::min(velocity.y + gravity * deltaTime, terminalVelocity);
     }
+    player.setVelocity(velocity);
     
-    // Check enemy collisions with platforms
-    for (size_t i = 0; i < enemyPhysics.size() && i < enemies.size(); ++i) {
-        bool enemyOnGround = false;
-        
-        for (const auto& platform : platformPhysics) {
-            if (checkCollision(enemyPhysics[i], platform)) {
-                // Get previous position (before applying velocity)
-                sf::Vector2f prevPos = sf::Vector2f(
-                    enemies[i].getPosition().x - enemies[i].getVelocity().x,
-                    enemies[i].getPosition().y - enemies[i].getVelocity().y
-                );
-                
-                // Handle collision with platform
-                if (enemyPhysics[i].velocity.y > 0 && 
-                    prevPos.y + enemyPhysics[i].collisionBox.size.y <= platform.collisionBox.position.y + 5) {
-                    // Enemy is falling - land on platform
-                    enemyPhysics[i].velocity.y = 0;
-                    enemyOnGround = true;
-                    
-                    // Position enemy on top of platform with a small offset to prevent sinking
-                    float newY = platform.collisionBox.position.y - enemyPhysics[i].collisionBox.size.y - 0.1f;
-                    enemies[i].setPosition(sf::Vector2f(enemies[i].getPosition().x, newY));
-                    
-                    // Apply platform friction to horizontal velocity
-                    enemyPhysics[i].velocity.x *= (1.0f - platform.friction);
-                } else if (enemyPhysics[i].velocity.y < 0 && !useOneWayPlatforms) {
-                    // Enemy is jumping - hit bottom of platform
-                    enemyPhysics[i].velocity.y = -enemyPhysics[i].velocity.y * enemyPhysics[i].bounceFactor;
-                }
-            }
+    applyPhysicsToEntities(enemies);
+}
+
+template <class Policy>
+void PhysicsSystem::resolvePlayer(Player& player, sf::Vector2f& velocity) {
+    // One sweep over the move it made this step
+    const sf::FloatRect end = playerCollisionBox;
+    const Narrowphase::SweepResult hit =
+        resolveBody<Policy>(end, player.getPosition() - player.getStepStart(), player.isOnGround(), playerSupport,
+                            CollisionLayer::Player, playerCollisionMask, mainScratch);
+    player.setPosition(player.getPosition() + (hit.position - end.position));
+    playerCollisionBox.position = hit.position;
+    
+    if (hit.onGround && velocity.y >= 0) {
+        if (events && !player.isOnGround()) {
+            events->emit(GameEventType::Landed, player.getPosition(), velocity.y);
         }
-        
-        // Special case: If enemy is below the ground platform, force them above it
-        if (!enemyOnGround && enemies[i].getPosition().y > windowHeight - 90) {
-            enemies[i].setPosition(sf::Vector2f(enemies[i].getPosition().x, windowHeight - 90));
-            enemyPhysics[i].velocity.y = 0;
+        velocity.y = 0;
+        player.setJumping(false); // Reset jump state when landing
+    } else if (hit.hitCeiling && velocity.y < 0) {
+        // Head hit the underside of a platform
+        if constexpr (Policy::GENERIC || Policy::BOUNCE) {
+            velocity.y = -velocity.y * playerBounceFactor;
+        } else {
+            velocity.y = 0;
         }
     }
+    if (hit.wall != 0) {
+        velocity.x = 0;
+    }
+    player.setOnGround(hit.onGround);
+    player.markStepResolved();
 }
 
-bool PhysicsSystem::checkCollision(const PhysicsComponent& a, const PhysicsComponent& b) {
-    // Check if collision boxes intersect
-    return rectsIntersect(a.collisionBox, b.collisionBox);
-}
-
-void PhysicsSystem::applyPhysicsToEntities(Player& player, std::vector<Enemy>& enemies) {
-    // If player is jumping (negative Y velocity), preserve that
-    if (player.getVelocity().y < 0) {
-        // Keep player's jump velocity
-        std::cout << "Preserving player jump velocity: " << player.getVelocity().y << std::endl;
-    } else {
-        // Otherwise apply physics system velocity
-        sf::Vector2f playerVel = player.getVelocity();
-        playerVel.y = playerPhysics.velocity.y;
-        player.setVelocity(playerVel);
-    }
-    
-    // Add a check to prevent player from sinking into ground
-    if (player.isOnGround() && player.getVelocity().y > 0) {
-        sf::Vector2f playerVel = player.getVelocity();
-        playerVel.y = 0;
-        player.setVelocity(playerVel);
-    }
-    
-    // Apply enemy physics - only vertical velocity to preserve AI movement
-    for (size_t i = 0; i < enemies.size() && i < enemyPhysics.size(); ++i) {
-        sf::Vector2f enemyVel = enemies[i].getVelocity();
-        enemyVel.y = enemyPhysics[i].velocity.y;
-        
-        // Ensure enemy X velocity is preserved based on their AI movement direction
-        // We don't want to overwrite their horizontal movement logic
-        bool movingRight = enemyVel.x > 0;
-        
-        // Update the velocity
-        enemies[i].setVelocity(enemyVel);
-        
-        // Comprehensive check for stuck enemies at screen edges
-        sf::Vector2f pos = enemies[i].getPosition();
+template <class Policy>
+void PhysicsSystem::resolveEnemies(EnemyStore& enemies, size_t begin, size_t end, QueryScratch& scratch) {
+    for (size_t i = begin; i < end; ++i) {
+        const sf::FloatRect box = getEnemyCollisionBox(enemies, i);
+        if (!enemies.awake[i]) {
+            if (enemies.coarse[i] || !isNearPlayer(box)) continue;
+            enemies.setAwake(i, true); // Its AI resumes next step
+            enemies.restTicks[i] = 0;
+        }
+        const Narrowphase::SweepResult hit =
+            resolveBody<Policy>(box, enemies.getPosition(i) - enemies.getStepStart(i), enemies.isOnGround(i),
+                                enemies.support[i], CollisionLayer::Enemy, enemyCollisionMask, scratch);
+        enemies.setPosition(i, enemies.getPosition(i) + (hit.position - box.position));
         
-        // Fix enemies stuck at left edge
-        if (pos.x < 10.0f) {
-            pos.x = 20.0f; // Move them away from edge
-            enemies[i].setPosition(pos);
-            
-            // Force them to move right
-            enemyVel.x = std::abs(enemyVel.x);
-            if (enemyVel.x < 2.0f) enemyVel.x = 2.0f; // Ensure minimum velocity
-            enemies[i].setVelocity(enemyVel);
-            
-            std::cout << "Fixed stuck enemy " << i << " at position: " << pos.x << ", " << pos.y << std::endl;
+        float& velY = enemies.velY[i];
+        if constexpr (Policy::GENERIC || Policy::BOUNCE) {
+            if (hit.onGround && velY > 0) {
+                velY = 0;
+            } else if (hit.hitCeiling && velY < 0) {
+                velY = -velY * enemyBounceFactor;
+            }
+        } else if ((hit.onGround && velY > 0) || (hit.hitCeiling && velY < 0)) {
+            velY = 0;
+        }
+        enemies.setOnGround(i, hit.onGround);
+        if (hit.wall != 0) {
+            enemies.turnAround(i, hit.wall);
         }
+        enemies.markStepResolved(i);
+        updateEnemyRest(enemies, i, hit.onGround && std::abs(velY) < SLEEP_VELOCITY &&
+                                     !isNearPlayer(getEnemyCollisionBox(enemies, i)));
+    }
+}
+
+void PhysicsSystem::applyPhysicsToEntities(EnemyStore& enemies) {
+    // The step already wrote the player's velocity, and the sweep already wrote the enemies' vertical velocity; the patrol owns horizontal movement
+    for (size_t i = 0; i < enemies.size(); ++i) {
+        if (!enemies.awake[i]) continue;
         
-        // Check for potential edge case where physics and enemy AI disagree on movement
-        if ((movingRight && enemyVel.x < 0) || (!movingRight && enemyVel.x > 0)) {
-            // There's a conflict - respect the enemy AI's direction but ensure non-zero velocity
-            float absVel = std::abs(enemyVel.x);
-            if (absVel < 2.0f) absVel = 2.0f; // Minimum velocity
-            
-            enemyVel.x = movingRight ? absVel : -absVel;
-            enemies[i].setVelocity(enemyVel);
+        // Fix enemies stuck at left edge: move them away and send them right
+        if (enemies.posX[i] < EnemyStore::MIN_X) {
+            enemies.posX[i] = EnemyStore::MIN_PATROL_START;
+            enemies.direction[i] = 1.0f;
+            enemies.velX[i] = enemies.speed[i];
+            GAME_TRACE(Physics, "Fixed stuck enemy " << i << " at position: " << enemies.posX[i] << ", " << enemies.posY[i]);
         }
     }
 }
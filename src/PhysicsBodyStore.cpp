@@ -0,0 +1,118 @@
+#include "PhysicsBodyStore.hpp"
+#include "SimSnapshot.hpp"
+#include "FixedPoint.hpp"
+
+PhysicsBodyStore::Handle PhysicsBodyStore::create(const PhysicsComponent& init) {
+    Handle handle;
+    if (!freeList.empty()) {
+        // Reuse a released slot so existing handles never move
+        handle = freeList.back();
+        freeList.pop_back();
+    } else {
+        handle = static_cast<Handle>(flags.size());
+        posX.push_back(0.0f);
+        posY.push_back(0.0f);
+        width.push_back(0.0f);
+        height.push_back(0.0f);
+        velX.push_back(0.0f);
+        velY.push_back(0.0f);
+        flags.push_back(0);
+        bounce.push_back(0.0f);
+        friction.push_back(0.0f);
+        restTicks.push_back(0);
+        layer.push_back(CollisionLayer::Solid);
+        mask.push_back(COLLIDE_NOTHING);
+    }
+
+    flags[handle] = FlagAlive;
+    restTicks[handle] = 0;
+    set(handle, init);
+    liveCount++;
+    return handle;
+}
+
+void PhysicsBodyStore::destroy(Handle handle) {
+    if (!isValid(handle)) {
+        return;
+    }
+    flags[handle] = 0;
+    freeList.push_back(handle);
+    liveCount--;
+}
+
+void PhysicsBodyStore::clear() {
+    posX.clear();
+    posY.clear();
+    width.clear();
+    height.clear();
+    velX.clear();
+    velY.clear();
+    flags.clear();
+    bounce.clear();
+    friction.clear();
+    restTicks.clear();
+    layer.clear();
+    mask.clear();
+    freeList.clear();
+    liveCount = 0;
+}
+
+PhysicsComponent PhysicsBodyStore::get(Handle handle) const {
+    PhysicsComponent pc;
+    pc.collisionBox = getBox(handle);
+    pc.velocity = getVelocity(handle);
+    pc.hasGravity = hasGravity(handle);
+    pc.isStatic = isStatic(handle);
+    pc.bounceFactor = bounce[handle];
+    pc.friction = friction[handle];
+    pc.layer = layer[handle];
+    pc.mask = mask[handle];
+    return pc;
+}
+
+void PhysicsBodyStore::set(Handle handle, const PhysicsComponent& component) {
+    setBox(handle, component.collisionBox);
+    setVelocity(handle, component.velocity);
+    setFlag(handle, FlagGravity, component.hasGravity);
+    setFlag(handle, FlagStatic, component.isStatic);
+    bounce[handle] = component.bounceFactor;
+    friction[handle] = component.friction;
+    layer[handle] = component.layer;
+    mask[handle] = component.mask;
+}
+
+void PhysicsBodyStore::saveState(SimSnapshot& snapshot) const {
+    snapshot.writeArray(posX);
+    snapshot.writeArray(posY);
+    snapshot.writeArray(width);
+    snapshot.writeArray(height);
+    snapshot.writeArray(velX);
+    snapshot.writeArray(velY);
+    snapshot.writeArray(flags);
+    snapshot.writeArray(restTicks);
+    snapshot.writeArray(freeList);
+    snapshot.write(static_cast<uint64_t>(liveCount));
+}
+
+bool PhysicsBodyStore::loadState(SimSnapshot& snapshot) {
+    uint64_t live = 0;
+    if (!(snapshot.readArray(posX) && snapshot.readArray(posY) &&
+          snapshot.readArray(width) && snapshot.readArray(height) &&
+          snapshot.readArray(velX) && snapshot.readArray(velY) &&
+          snapshot.readArray(flags) && snapshot.readArray(restTicks) &&
+          snapshot.readArray(freeList) && snapshot.read(live))) {
+        return false;
+    }
+    if (flags.size() != layer.size()) {
+        return false; // Other bodies; their materials wouldn't line up
+    }
+    liveCount = static_cast<size_t>(live);
+    return true;
+}
+
+void PhysicsBodyStore::snapState() {
+    FixedPoint::snap(posX.data(), posX.size());
+    FixedPoint::snap(posY.data(), posY.size());
+    FixedPoint::snap(velX.data(), velX.size());
+    FixedPoint::snap(velY.data(), velY.size());
+}
@@ -1,25 +1,32 @@
 #include "Player.hpp"
+#include "Profiler.hpp"
 #include "Physics.hpp"
+#include "RenderSnapshot.hpp"
+#include "RenderQueue.hpp"
+#include "SimSnapshot.hpp"
+#include "FixedPoint.hpp"
+#include "GameEvents.hpp"
 #include <iostream>
+#include "DebugLog.hpp"
 #include <sstream>
 #include <iomanip>
 
-// Helper function for rectangle intersection (SFML 3.x compatibility)
-static bool rectsIntersect(const sf::FloatRect& a, const sf::FloatRect& b) {
-    return a.position.x < b.position.x + b.size.x &&
-           a.position.x + a.size.x > b.position.x &&
-           a.position.y < b.position.y + b.size.y &&
-           a.position.y + a.size.y > b.position.y;
-}
+static const char* const PLAYER_SHEET = "assets/images/characters/FinnSprite.json";  // Spritesheet sidecar
 
-// Add this helper method at the top of the file after the existing rectsIntersect helper
-static bool checkGroundBelow(const sf::Vector2f& position, const sf::Vector2f& size, float groundY, float checkDistance) {
-    float playerBottom = position.y + size.y;
-    return (playerBottom >= groundY - checkDistance && playerBottom <= groundY + checkDistance);
+PlayerInput PlayerInput::fromKeyboard() {
+    PlayerInput input;
+    input.left = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left);
+    input.right = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right);
+    input.up = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Up);
+    input.down = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Down);
+    input.jump = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Space);
+    return input;
 }
 
-Player::Player(float x, float y, PhysicsSystem& physics) : physicsSystem(physics), animationsLoaded(false) {
+Player::Player(float x, float y, PhysicsSystem& physics, bool loadAnimations) : physicsSystem(physics), animationsLoaded(false) {
     position = sf::Vector2f(x, y);
+    previousPosition = position;
+    stepStart = position;
     
     // Set up collision box to match sprite dimensions (scaled up for 4x sprite scale)
     collisionBox.setSize(sf::Vector2f(56.f, 56.f)); // Scaled up from 28x28 to match 4x scale
@@ -43,7 +50,9 @@ Player::Player(float x, float y, PhysicsSystem& physics) : physicsSystem(physics
     facingLeft = false; // Start facing right
     
     // Initialize animations
-    initializeAnimations();
+    if (loadAnimations) {
+        initializeAnimations();
+    }
 }
 
 void Player::setPosition(const sf::Vector2f& pos) {
@@ -63,14 +72,59 @@ void Player::setCollisionBoxOffset(const sf::Vector2f& offset) {
     collisionBox.setPosition(position + collisionOffset);
 }
 
+void Player::saveState(SimSnapshot& snapshot) const {
+    snapshot.write(position);
+    snapshot.write(previousPosition);
+    snapshot.write(stepStart);
+    snapshot.write(collisionBox.getSize());
+    snapshot.write(collisionOffset);
+    snapshot.write(velocity);
+    snapshot.write(mIsJumping);
+    snapshot.write(onGround);
+    snapshot.write(onLadder);
+    snapshot.write(facingLeft);
+    snapshot.write(input);
+}
+
+bool Player::loadState(SimSnapshot& snapshot) {
+    sf::Vector2f boxSize;
+    if (!(snapshot.read(position) && snapshot.read(previousPosition) && snapshot.read(stepStart) &&
+          snapshot.read(boxSize) && snapshot.read(collisionOffset) && snapshot.read(velocity) &&
+          snapshot.read(mIsJumping) && snapshot.read(onGround) && snapshot.read(onLadder) &&
+          snapshot.read(facingLeft) && snapshot.read(input))) {
+        return false;
+    }
+    collisionBox.setSize(boxSize);
+    collisionBox.setPosition(position + collisionOffset);
+    return true;
+}
+
+void Player::snapState() {
+    if constexpr (FixedPoint::ENABLED) {
+        position = sf::Vector2f(FixedPoint::snap(position.x), FixedPoint::snap(position.y));
+        velocity = sf::Vector2f(FixedPoint::snap(velocity.x), FixedPoint::snap(velocity.y));
+        stepStart = position; // The step is resolved by now
+        collisionBox.setPosition(position + collisionOffset);
+    }
+}
+
 void Player::handleInput() {
+    input = scriptedInput ? *scriptedInput : PlayerInput::fromKeyboard();
+    
+    // A ladder is grabbed with up or down while the body's centre line is on
+    // one (a tile lookup), and let go by moving off it
+    const sf::FloatRect box = collisionBox.getGlobalBounds();
+    const sf::FloatRect centreLine(sf::Vector2f(box.position.x + box.size.x / 2.f, box.position.y),
+                                   sf::Vector2f(0.f, box.size.y));
+    onLadder = physicsSystem.isOnLadder(centreLine) && (onLadder || input.up || input.down);
+    
     // Handle left and right movement
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left)) {
+    if (input.left) {
         physicsSystem.setPlayerAcceleration(-1.0f);
         velocity.x = PLAYER_SPEED * physicsSystem.getPlayerAcceleration();
         facingLeft = true; // Update facing direction
     }
-    else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right)) {
+    else if (input.right) {
         physicsSystem.setPlayerAcceleration(1.0f);
         velocity.x = PLAYER_SPEED * physicsSystem.getPlayerAcceleration();
         facingLeft = false; // Update facing direction
@@ -82,15 +136,15 @@ void Player::handleInput() {
     }
 
     // Debug space key press
-    bool spacePressed = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Space);
+    bool spacePressed = input.jump;
 
     // Handle climbing or jumping
     if (onLadder) {
         // Vertical movement on ladder
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Up)) {
+        if (input.up) {
             velocity.y = -CLIMB_SPEED;
         }
-        else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Down)) {
+        else if (input.down) {
             velocity.y = CLIMB_SPEED;
         }
         else {
@@ -99,47 +153,28 @@ void Player::handleInput() {
     }
     else if (spacePressed && onGround) {
         // Debug output before jump
-        std::cout << "Jump initiated:" << std::endl;
-        std::cout << "  Position before jump: (" << position.x << ", " << position.y << ")" << std::endl;
-        std::cout << "  Ground state: " << (onGround ? "true" : "false") << std::endl;
-        std::cout << "  Current velocity: (" << velocity.x << ", " << velocity.y << ")" << std::endl;
+        GAME_TRACE(Player, "Jump initiated:\n"
+                   << "  Position before jump: (" << position.x << ", " << position.y << ")\n"
+                   << "  Ground state: " << (onGround ? "true" : "false") << "\n"
+                   << "  Current velocity: (" << velocity.x << ", " << velocity.y << ")");
         
         velocity.y = JUMP_FORCE;
         mIsJumping = true;
         onGround = false;
+        if (events) {
+            events->emit(GameEventType::Jumped, position);
+        }
         
         // Debug output after jump
-        std::cout << "  New velocity: (" << velocity.x << ", " << velocity.y << ")" << std::endl;
-        std::cout << "  Jump force applied: " << JUMP_FORCE << std::endl;
+        GAME_TRACE(Player, "  New velocity: (" << velocity.x << ", " << velocity.y << ")\n"
+                   << "  Jump force applied: " << JUMP_FORCE);
     }
 }
 
-bool Player::checkPlatformAbove(const std::vector<sf::RectangleShape>& platforms) {
-    // Check if there's a platform right above the player that they can step onto
-    for (const auto& platform : platforms) {
-        float playerTop = position.y;
-        float platformBottom = platform.getPosition().y + platform.getSize().y;
-        
-        // If platform is just above player's head (within 10 pixels)
-        if (std::abs(playerTop - platformBottom) < 10.0f) {
-            // Check if player's position overlaps with the platform horizontally
-            float playerLeft = position.x;
-            float playerRight = playerLeft + collisionBox.getSize().x;
-            float platformLeft = platform.getPosition().x;
-            float platformRight = platformLeft + platform.getSize().x;
-            
-            if (playerRight > platformLeft && playerLeft < platformRight) {
-                return true;
-            }
-        }
-    }
-    return false;
-}
-
-void Player::update(float deltaTime, const std::vector<sf::RectangleShape>& platforms, const std::vector<sf::RectangleShape>& ladders) {
-    // Store previous position and state for collision resolution
-    sf::Vector2f prevPosition = position;
-    bool wasOnGround = onGround;
+void Player::update(float deltaTime, const LevelGeometry& platforms) {
+    PROFILE_ZONE("Player::update");
+    // The physics sweep resolves this step's move from here
+    stepStart = position;
     
     // Update debug info before state changes
     debugInfo.timeInCurrentState += deltaTime;
@@ -148,8 +183,8 @@ void Player::update(float deltaTime, const std::vector<sf::RectangleShape>& plat
         debugInfo.timeInCurrentState = 0.0f;
         
         // Debug output for state changes
-        std::cout << "Player state changed - OnGround: " << onGround 
-                  << ", Jumping: " << mIsJumping << std::endl;
+        GAME_TRACE(Player, "Player state changed - OnGround: " << onGround 
+                   << ", Jumping: " << mIsJumping);
     }
     debugInfo.prevOnGround = onGround;
     debugInfo.prevIsJumping = mIsJumping;
@@ -161,14 +196,17 @@ void Player::update(float deltaTime, const std::vector<sf::RectangleShape>& plat
     // Process input before movement
     handleInput();
     
+    // Vertical motion is expressed in per-step units; scale in case the step rate differs
+    float stepScale = deltaTime * TUNED_STEP_RATE;
+    
     // Apply gravity only when not on ladder and not on ground
     if (!onLadder && !onGround) {
-        velocity.y += GRAVITY;
+        velocity.y += GRAVITY * stepScale;
     }
     
     // Update position
     position.x += velocity.x * deltaTime + 0.5f * physicsSystem.getPlayerAcceleration()*deltaTime*deltaTime;
-    position.y += velocity.y;
+    position.y += velocity.y * stepScale;
     
     // Keep player from going off the left edge only
     if (position.x < 0) {
@@ -178,75 +216,67 @@ void Player::update(float deltaTime, const std::vector<sf::RectangleShape>& plat
     // Update collision box position
     collisionBox.setPosition(position + collisionOffset);
     
-    // Handle platform side collisions
-    for (const auto& platform : platforms) {
-        if (rectsIntersect(collisionBox.getGlobalBounds(), platform.getGlobalBounds())) {
-            if (onLadder) continue;
-            
-            float platformTop = platform.getPosition().y;
-            float playerBottom = position.y + collisionBox.getSize().y;
-            
-            // Only do side collision if we're not landing on top
-            if (std::abs(playerBottom - platformTop) > 5.0f) {
-                if (velocity.x > 0) {  // Moving right
-                    position.x = platform.getPosition().x - collisionBox.getSize().x - 0.5f;
-                } else if (velocity.x < 0) {  // Moving left
-                    position.x = platform.getPosition().x + platform.getSize().x + 0.5f;
-                }
-                velocity.x = 0;
-                collisionBox.setPosition(position + collisionOffset);
-            }
-        }
-    }
+    // Platform collisions are resolved by PhysicsSystem, which sweeps this move
     
     // Update animations
     updateAnimation(deltaTime);
 }
 
-void Player::draw(sf::RenderWindow& window) {
+sf::Sprite Player::makeRenderSprite(float alpha) const {
+    sf::Vector2f renderPosition = getRenderPosition(alpha);
+    sf::Sprite animatedSprite = playerAnimation.getCurrentSprite();
+    
+    // Apply scale first
+    if (facingLeft) {
+        animatedSprite.setScale(sf::Vector2f(-4.0f, 4.0f));  // Negative X scale for flipping
+    } else {
+        animatedSprite.setScale(sf::Vector2f(4.0f, 4.0f));
+    }
+    
+    // Position sprite to align with collision box
+    // Since the sprite origin is at bottom center (16, 32) and scaled 4x,
+    // we need to position it at the bottom center of the collision box
+    sf::Vector2f spritePos;
+    spritePos.x = renderPosition.x + collisionOffset.x + (collisionBox.getSize().x / 2.f);
+    spritePos.y = renderPosition.y + collisionOffset.y + collisionBox.getSize().y - 4.0f; // Slight adjustment to align with ground
+    animatedSprite.setPosition(spritePos);
+    return animatedSprite;
+}
+
+void Player::draw(RenderQueue& queue, float alpha) {
     // Draw the animated sprite if available
     if (animationsLoaded) {
-        sf::Sprite animatedSprite = playerAnimation.getCurrentSprite();
-        
-        // Apply scale first
-        if (facingLeft) {
-            animatedSprite.setScale(sf::Vector2f(-4.0f, 4.0f));  // Negative X scale for flipping
-        } else {
-            animatedSprite.setScale(sf::Vector2f(4.0f, 4.0f));
-        }
-        
-        // Position sprite to align with collision box
-        // Since the sprite origin is at bottom center (16, 32) and scaled 4x,
-        // we need to position it at the bottom center of the collision box
-        sf::Vector2f spritePos;
-        spritePos.x = position.x + collisionOffset.x + (collisionBox.getSize().x / 2.f);
-        spritePos.y = position.y + collisionOffset.y + collisionBox.getSize().y - 4.0f; // Slight adjustment to align with ground
-        animatedSprite.setPosition(spritePos);
-        
-        window.draw(animatedSprite);
-        
-        // Debug: Draw sprite bounds
-        if (showDebugInfo) {
-            sf::FloatRect spriteBounds = animatedSprite.getGlobalBounds();
-            sf::RectangleShape spriteBoundsRect;
-            spriteBoundsRect.setSize(sf::Vector2f(spriteBounds.size.x, spriteBounds.size.y));
-            spriteBoundsRect.setPosition(sf::Vector2f(spriteBounds.position.x, spriteBounds.position.y));
-            spriteBoundsRect.setFillColor(sf::Color::Transparent);
-            spriteBoundsRect.setOutlineColor(sf::Color::Yellow);
-            spriteBoundsRect.setOutlineThickness(1.0f);
-            window.draw(spriteBoundsRect);
-        }
+        queue.addSprite(RenderLayer::Player, 0, makeRenderSprite(alpha), RenderCategory::Player);
+    }
+}
+
+void Player::drawDebugBounds(RenderSnapshot& snapshot, float alpha) {
+    if (!showDebugInfo) {
+        return;
     }
     
-    // Draw debug visualization if enabled
-    if (showDebugInfo) {
-        // Draw collision box
-        window.draw(collisionBox);
+    // Draw sprite bounds
+    if (animationsLoaded) {
+        sf::FloatRect spriteBounds = makeRenderSprite(alpha).getGlobalBounds();
+        sf::RectangleShape spriteBoundsRect;
+        spriteBoundsRect.setSize(sf::Vector2f(spriteBounds.size.x, spriteBounds.size.y));
+        spriteBoundsRect.setPosition(sf::Vector2f(spriteBounds.position.x, spriteBounds.position.y));
+        spriteBoundsRect.setFillColor(sf::Color::Transparent);
+        spriteBoundsRect.setOutlineColor(sf::Color::Yellow);
+        spriteBoundsRect.setOutlineThickness(1.0f);
+        snapshot.draw(spriteBoundsRect, RenderCategory::Debug);
     }
+    
+    // Draw collision box at the interpolated position
+    sf::RenderStates states;
+    states.transform.translate(getRenderPosition(alpha) - position);
+    snapshot.draw(collisionBox, RenderCategory::Debug, states);
 }
 
 void Player::reset(float x, float y) {
     position = sf::Vector2f(x, y);
+    previousPosition = position; // Don't interpolate across a reset
+    stepStart = position;
     collisionBox.setPosition(position + collisionOffset);
     velocity = sf::Vector2f(0.f, 0.f);
     mIsJumping = false;
@@ -267,17 +297,15 @@ void Player::reset(float x, float y) {
 void Player::initializeAnimations() {
     std::cout << "Initializing player animations..." << std::endl;
     
-    // Load idle animation
-    bool idleLoaded = playerAnimation.loadAnimation(AnimationState::Idle, 
-        "assets/images/characters/separated_finn/idle");
-    
-    // Load walking animation
-    bool walkingLoaded = playerAnimation.loadAnimation(AnimationState::Walking, 
-        "assets/images/characters/separated_finn/walking");
-    
-    // Load jumping animation (if available)
-    bool jumpingLoaded = playerAnimation.loadAnimation(AnimationState::Jumping, 
-        "assets/images/characters/separated_finn/jump");
+    // Clips are sliced from the Finn spritesheet (one texture load); the
+    // per-frame directories are only the fallback when the sheet is missing
+    auto loadClip = [this](AnimationState state, const char* clip, const char* directory) {
+        return playerAnimation.loadAnimation(state, std::string(PLAYER_SHEET) + "#" + clip) ||
+               playerAnimation.loadAnimation(state, directory);
+    };
+    bool idleLoaded = loadClip(AnimationState::Idle, "idle", "assets/images/characters/separated_finn/idle");
+    bool walkingLoaded = loadClip(AnimationState::Walking, "walking", "assets/images/characters/separated_finn/walking");
+    bool jumpingLoaded = loadClip(AnimationState::Jumping, "jump", "assets/images/characters/separated_finn/jump");
     
     // Set animation properties
     playerAnimation.setFrameTime(0.15f); // 150ms per frame for smooth animation
@@ -311,9 +339,7 @@ void Player::updateAnimation(float deltaTime) {
     AnimationState targetState = AnimationState::Idle;
     
     // Check if player is moving horizontally (based on both input and actual velocity)
-    bool isMovingHorizontally = (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left) || 
-                               sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right)) &&
-                               std::abs(velocity.x) > 0.1f;
+    bool isMovingHorizontally = (input.left || input.right) && std::abs(velocity.x) > 0.1f;
     
     // Update animation state based on player state
     if (mIsJumping && !onGround) {
@@ -344,21 +370,14 @@ bool Player::hasAnimations() const {
     return animationsLoaded;
 }
 
-void Player::drawDebugInfo(sf::RenderWindow& window) {
-    if (!showDebugInfo) return;
-    
-    // Create debug text
-    sf::Font debugFont;
-    if (!debugFont.openFromFile("assets/fonts/Arial.ttf")) {
-        std::cout << "Error loading debug font!" << std::endl;
-        return;
-    }
+void Player::drawDebugInfo(RenderSnapshot& snapshot) {
+    if (!showDebugInfo || !debugFont) return;
     
     // Create debug overlay
     sf::RectangleShape overlay(sf::Vector2f(200, 150));
     overlay.setFillColor(sf::Color(0, 0, 0, 180));
     overlay.setPosition(sf::Vector2f(10, 10));
-    window.draw(overlay);
+    snapshot.draw(overlay, RenderCategory::Debug);
     
     // Prepare debug text
     std::ostringstream debugText;
@@ -372,10 +391,10 @@ void Player::drawDebugInfo(sf::RenderWindow& window) {
               << "Time in State: " << debugInfo.timeInCurrentState << "s";
     
     // Draw debug text
-    sf::Text text(debugFont, debugText.str(), 14);
+    sf::Text text(*debugFont, debugText.str(), DEBUG_TEXT_SIZE);
     text.setFillColor(sf::Color::White);
     text.setPosition(sf::Vector2f(15, 15));
-    window.draw(text);
+    snapshot.draw(text, RenderCategory::Debug);
     
     // Draw state transition indicators
     if (onGround != debugInfo.prevOnGround || mIsJumping != debugInfo.prevIsJumping) {
@@ -383,7 +402,7 @@ void Player::drawDebugInfo(sf::RenderWindow& window) {
         sf::CircleShape stateMarker(5);
         stateMarker.setFillColor(sf::Color::Yellow);
         stateMarker.setPosition(position + collisionOffset);
-        window.draw(stateMarker);
+        snapshot.draw(stateMarker, RenderCategory::Debug);
     }
     
     // Draw ground detection zone
@@ -395,7 +414,7 @@ void Player::drawDebugInfo(sf::RenderWindow& window) {
     groundZone.setFillColor(sf::Color(0, 255, 0, 80));
     groundZone.setOutlineColor(sf::Color::Green);
     groundZone.setOutlineThickness(1);
-    window.draw(groundZone);
+    snapshot.draw(groundZone, RenderCategory::Debug);
     
     // Draw collision box outline for reference
     sf::RectangleShape collisionBoxOutline;
@@ -404,5 +423,5 @@ void Player::drawDebugInfo(sf::RenderWindow& window) {
     collisionBoxOutline.setFillColor(sf::Color::Transparent);
     collisionBoxOutline.setOutlineColor(sf::Color::Yellow);
     collisionBoxOutline.setOutlineThickness(1);
-    window.draw(collisionBoxOutline);
+    snapshot.draw(collisionBoxOutline, RenderCategory::Debug);
 } 
\ No newline at end of file
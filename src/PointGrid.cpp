@@ -0,0 +1,70 @@
+#include "PointGrid.hpp"
+#include <algorithm>
+#include <cmath>
+
+PointGrid::PointGrid(float cellSize) : cellSize(std::max(cellSize, 1.0f)) {}
+
+void PointGrid::clear() {
+    cells.clear();
+    itemCell.clear();
+    itemSlot.clear();
+    itemCount = 0;
+}
+
+int32_t PointGrid::cellCoord(float value) const {
+    // Clamped so far-off or non-finite coordinates still land in some cell
+    const float cell = std::floor(value / cellSize);
+    if (!(cell > -1e9f)) return -1000000000;
+    if (cell > 1e9f) return 1000000000;
+    return static_cast<int32_t>(cell);
+}
+
+void PointGrid::link(uint32_t item, uint64_t cell) {
+    std::vector<uint32_t>& bucket = cells[cell];
+    itemCell[item] = cell;
+    itemSlot[item] = static_cast<uint32_t>(bucket.size());
+    bucket.push_back(item);
+}
+
+void PointGrid::unlink(uint32_t item) {
+    std::vector<uint32_t>& bucket = cells[itemCell[item]];
+    const uint32_t slot = itemSlot[item];
+    bucket[slot] = bucket.back();
+    itemSlot[bucket[slot]] = slot;
+    bucket.pop_back();
+    itemSlot[item] = NONE;
+}
+
+void PointGrid::insert(uint32_t item, const sf::Vector2f& position) {
+    if (item >= itemSlot.size()) {
+        itemCell.resize(item + 1, 0);
+        itemSlot.resize(item + 1, NONE);
+    }
+    if (itemSlot[item] != NONE) {
+        move(item, position);
+        return;
+    }
+    link(item, key(cellCoord(position.x), cellCoord(position.y)));
+    itemCount++;
+}
+
+void PointGrid::move(uint32_t item, const sf::Vector2f& position) {
+    if (item >= itemSlot.size() || itemSlot[item] == NONE) {
+        insert(item, position);
+        return;
+    }
+    const uint64_t cell = key(cellCoord(position.x), cellCoord(position.y));
+    if (cell == itemCell[item]) {
+        return;
+    }
+    unlink(item);
+    link(item, cell);
+}
+
+void PointGrid::remove(uint32_t item) {
+    if (item >= itemSlot.size() || itemSlot[item] == NONE) {
+        return;
+    }
+    unlink(item);
+    itemCount--;
+}
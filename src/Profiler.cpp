@@ -0,0 +1,390 @@
+#include "Profiler.hpp"
+#include "AllocationTracker.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+namespace Profiler {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const Clock::time_point epoch = Clock::now();
+
+struct ThreadBuffer {
+    std::mutex mutex;       // Owner thread vs the drain in frameMark
+    std::vector<ZoneEvent> events = std::vector<ZoneEvent>(THREAD_BUFFER_EVENTS);
+    uint64_t written = 0;   // Total events ever written
+    uint64_t drained = 0;   // Total events handed to a frame
+    uint32_t depth = 0;     // Owner thread only
+    uint32_t index = 0;
+    std::string name;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> threads; // Never shrinks; buffers outlive their threads
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+ThreadBuffer& localBuffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.threads.push_back(std::make_unique<ThreadBuffer>());
+        buffer = reg.threads.back().get();
+        buffer->index = static_cast<uint32_t>(reg.threads.size() - 1);
+        buffer->name = "Thread " + std::to_string(buffer->index);
+    }
+    return *buffer;
+}
+
+// Frame history, touched by the main thread only
+std::vector<FrameRecord> history(FRAME_HISTORY);
+size_t historyNext = 0;
+size_t historyCount = 0;
+uint64_t frameIndex = 0;
+uint64_t frameStart = 0;
+AllocationTracker::Counts frameStartAllocations;
+uint64_t droppedZones = 0;
+bool paused = false;
+std::vector<ZoneEvent> drainScratch;
+std::vector<CounterSample> frameCounters; // Plotted since the last frame mark
+
+// Capture state, main thread only. The vectors are reserved at startCapture
+// and never grow while recording.
+struct Capture {
+    bool active = false;
+    std::string path;
+    uint64_t startNs = 0;
+    uint64_t endNs = 0;
+    uint64_t frames = 0;
+    uint64_t dropped = 0;
+    std::vector<ZoneEvent> zones;
+    std::vector<CounterSample> counters;
+};
+Capture capture;
+
+void writeJsonString(std::ostream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out << '\\' << *c;
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", *c);
+            out << escaped;
+        } else {
+            out << *c;
+        }
+    }
+    out << '"';
+}
+
+// Trace timestamps are microseconds relative to the start of the trace
+double toTraceUs(uint64_t ns, uint64_t originNs) {
+    return ns >= originNs ? (ns - originNs) / 1000.0 : 0.0;
+}
+
+void writeThreadNames(std::ostream& out, const std::vector<std::string>& threadNames, bool& first) {
+    for (size_t i = 0; i < threadNames.size(); ++i) {
+        out << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << i
+            << ",\"args\":{\"name\":";
+        writeJsonString(out, threadNames[i].c_str());
+        out << "}}";
+        first = false;
+    }
+}
+
+// Zones begun before the origin are clipped to it; events become instants on their thread
+void writeZone(std::ostream& out, const ZoneEvent& zone, uint64_t originNs, bool& first) {
+    char number[64];
+    const double start = toTraceUs(zone.startNs, originNs);
+    if (zone.startNs == zone.endNs) {
+        std::snprintf(number, sizeof(number), "%.3f,\"s\":\"t\"", start);
+        out << (first ? "" : ",\n") << "{\"ph\":\"i\",\"name\":";
+    } else {
+        std::snprintf(number, sizeof(number), "%.3f,\"dur\":%.3f", start, toTraceUs(zone.endNs, originNs) - start);
+        out << (first ? "" : ",\n") << "{\"ph\":\"X\",\"name\":";
+    }
+    writeJsonString(out, zone.name);
+    out << ",\"pid\":1,\"tid\":" << zone.threadIndex << ",\"ts\":" << number << "}";
+    first = false;
+}
+
+void writeCounter(std::ostream& out, const CounterSample& counter, uint64_t originNs, bool& first) {
+    char number[64];
+    std::snprintf(number, sizeof(number), "%.3f", toTraceUs(counter.ns, originNs));
+    out << (first ? "" : ",\n") << "{\"ph\":\"C\",\"name\":";
+    writeJsonString(out, counter.name);
+    out << ",\"pid\":1,\"ts\":" << number << ",\"args\":{\"value\":" << counter.value << "}}";
+    first = false;
+}
+
+} // namespace
+
+uint64_t now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count());
+}
+
+void setThreadName(const char* name) {
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    buffer.name = name;
+}
+
+ScopedZone::ScopedZone(const char* name) : name(name), startNs(now()) {
+    depth = localBuffer().depth++;
+}
+
+void markEvent(const char* name) {
+    const uint64_t ns = now();
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events[buffer.written % THREAD_BUFFER_EVENTS] = ZoneEvent{name, ns, ns, buffer.index, buffer.depth};
+    buffer.written++;
+}
+
+ScopedZone::~ScopedZone() {
+    const uint64_t endNs = now();
+    ThreadBuffer& buffer = localBuffer();
+    buffer.depth--;
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events[buffer.written % THREAD_BUFFER_EVENTS] = ZoneEvent{name, startNs, endNs, buffer.index, depth};
+    buffer.written++;
+}
+
+void frameMark() {
+    const uint64_t endNs = now();
+    const AllocationTracker::Counts allocations = AllocationTracker::getTotals();
+    const uint64_t frameAllocations = allocations.allocations - frameStartAllocations.allocations;
+    const uint64_t frameBytes = allocations.bytes - frameStartAllocations.bytes;
+
+    // Drain every thread's buffer, oldest events first
+    drainScratch.clear();
+    {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> registryLock(reg.mutex);
+        for (auto& thread : reg.threads) {
+            std::lock_guard<std::mutex> lock(thread->mutex);
+            if (thread->written - thread->drained > THREAD_BUFFER_EVENTS) {
+                droppedZones += thread->written - thread->drained - THREAD_BUFFER_EVENTS;
+                thread->drained = thread->written - THREAD_BUFFER_EVENTS;
+            }
+            for (uint64_t i = thread->drained; i < thread->written; ++i) {
+                drainScratch.push_back(thread->events[i % THREAD_BUFFER_EVENTS]);
+            }
+            thread->drained = thread->written;
+        }
+    }
+
+    if (capture.active) {
+        for (const ZoneEvent& zone : drainScratch) {
+            if (zone.endNs < capture.startNs) {
+                continue; // Finished before the capture began
+            }
+            if (capture.zones.size() < capture.zones.capacity()) {
+                capture.zones.push_back(zone);
+            } else {
+                capture.dropped++;
+            }
+        }
+        if (frameStart >= capture.startNs && capture.zones.size() < capture.zones.capacity()) {
+            capture.zones.push_back(ZoneEvent{"Frame", frameStart, endNs, localBuffer().index, 0});
+        }
+        if (capture.counters.size() < capture.counters.capacity()) {
+            capture.counters.push_back(CounterSample{"Heap allocations", endNs, static_cast<double>(frameAllocations)});
+        }
+        capture.frames++;
+    }
+
+    if (!paused && frameStart != 0) {
+        FrameRecord& frame = history[historyNext];
+        frame.index = frameIndex;
+        frame.startNs = frameStart;
+        frame.endNs = endNs;
+        frame.allocations = frameAllocations;
+        frame.allocatedBytes = frameBytes;
+        frame.zones.swap(drainScratch); // Both keep their capacity
+        frame.counters.swap(frameCounters);
+        std::stable_sort(frame.zones.begin(), frame.zones.end(), [](const ZoneEvent& a, const ZoneEvent& b) {
+            return a.threadIndex != b.threadIndex ? a.threadIndex < b.threadIndex : a.startNs < b.startNs;
+        });
+        historyNext = (historyNext + 1) % FRAME_HISTORY;
+        historyCount = std::min(historyCount + 1, FRAME_HISTORY);
+    }
+    frameCounters.clear();
+    frameIndex++;
+    frameStart = endNs;
+    // Sampled after the drain so the profiler's own allocations aren't charged to the game
+    frameStartAllocations = AllocationTracker::getTotals();
+}
+
+void setPaused(bool value) {
+    paused = value;
+}
+
+bool isPaused() {
+    return paused;
+}
+
+size_t getFrameCount() {
+    return historyCount;
+}
+
+const FrameRecord& getFrame(size_t age) {
+    return history[(historyNext + FRAME_HISTORY - 1 - std::min(age, FRAME_HISTORY - 1)) % FRAME_HISTORY];
+}
+
+uint64_t getDroppedZones() {
+    return droppedZones;
+}
+
+std::vector<std::string> getThreadNames() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    std::vector<std::string> names;
+    names.reserve(reg.threads.size());
+    for (const auto& thread : reg.threads) {
+        names.push_back(thread->name);
+    }
+    return names;
+}
+
+void plotCounter(const char* name, double value) {
+#if GAME_PROFILER && GAME_TRACY
+    TracyPlot(name, value);
+#endif
+    const uint64_t ns = now();
+    if (!paused) {
+        frameCounters.push_back(CounterSample{name, ns, value});
+    }
+    if (!capture.active) {
+        return;
+    }
+    if (capture.counters.size() < capture.counters.capacity()) {
+        capture.counters.push_back(CounterSample{name, ns, value});
+    } else {
+        capture.dropped++;
+    }
+}
+
+bool startCapture(const std::string& path, size_t maxEvents) {
+    if (capture.active) {
+        return false;
+    }
+    capture.path = path;
+    capture.frames = 0;
+    capture.dropped = 0;
+    capture.zones.clear();
+    capture.zones.reserve(std::max<size_t>(maxEvents, 1));
+    capture.counters.clear();
+    capture.counters.reserve(std::max<size_t>(maxEvents / 8, 1));
+    capture.startNs = now();
+    capture.active = true;
+    return true;
+}
+
+bool stopCapture() {
+    if (!capture.active) {
+        return false;
+    }
+    capture.active = false;
+    capture.endNs = now();
+
+    std::ofstream out(capture.path);
+    if (!out) {
+        return false;
+    }
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    writeThreadNames(out, getThreadNames(), first);
+    for (const ZoneEvent& zone : capture.zones) {
+        writeZone(out, zone, capture.startNs, first);
+    }
+    for (const CounterSample& counter : capture.counters) {
+        writeCounter(out, counter, capture.startNs, first);
+    }
+    out << "\n]}\n";
+
+    // Give the memory back; a capture is a one-off
+    std::vector<ZoneEvent>().swap(capture.zones);
+    std::vector<CounterSample>().swap(capture.counters);
+    return static_cast<bool>(out);
+}
+
+HistorySnapshot snapshotHistory(size_t frames) {
+    HistorySnapshot snapshot;
+    frames = std::min(frames, historyCount);
+    snapshot.frames.reserve(frames);
+    for (size_t age = frames; age-- > 0;) {
+        snapshot.frames.push_back(getFrame(age));
+    }
+    snapshot.threadNames = getThreadNames();
+    snapshot.mainThread = localBuffer().index;
+    return snapshot;
+}
+
+std::string formatHistory(const HistorySnapshot& snapshot) {
+    if (snapshot.frames.empty()) {
+        return {};
+    }
+    const uint64_t originNs = snapshot.frames.front().startNs;
+    std::ostringstream out;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    writeThreadNames(out, snapshot.threadNames, first);
+    for (const FrameRecord& frame : snapshot.frames) {
+        writeZone(out, ZoneEvent{"Frame", frame.startNs, frame.endNs, snapshot.mainThread, 0}, originNs, first);
+        for (const ZoneEvent& zone : frame.zones) {
+            writeZone(out, zone, originNs, first);
+        }
+        for (const CounterSample& counter : frame.counters) {
+            writeCounter(out, counter, originNs, first);
+        }
+        writeCounter(out, CounterSample{"Heap allocations", frame.endNs, static_cast<double>(frame.allocations)},
+                     originNs, first);
+    }
+    out << "\n]}\n";
+    return out.str();
+}
+
+std::string formatHistory(size_t frames) {
+    return formatHistory(snapshotHistory(frames));
+}
+
+bool isCapturing() {
+    return capture.active;
+}
+
+const std::string& getCapturePath() {
+    return capture.path;
+}
+
+bool isCaptureFull() {
+    return capture.active && capture.zones.size() == capture.zones.capacity();
+}
+
+CaptureStats getCaptureStats() {
+    CaptureStats stats;
+    stats.capturing = capture.active;
+    stats.zones = capture.zones.size();
+    stats.capacity = capture.zones.capacity();
+    stats.counters = capture.counters.size();
+    stats.frames = capture.frames;
+    stats.dropped = capture.dropped;
+    stats.seconds = ((capture.active ? now() : capture.endNs) - capture.startNs) / 1e9;
+    return stats;
+}
+
+} // namespace Profiler
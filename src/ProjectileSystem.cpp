@@ -0,0 +1,294 @@
+#include "ProjectileSystem.hpp"
+#include "FixedPoint.hpp"
+#include "GameEvents.hpp"
+#include "JobSystem.hpp"
+#include "LevelGeometry.hpp"
+#include "Narrowphase.hpp"
+#include "Profiler.hpp"
+#include "SimSnapshot.hpp"
+#include "SpatialGrid.hpp"
+#include "SweepAndPrune.hpp"
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+bool overlaps(const sf::FloatRect& a, const sf::FloatRect& b) {
+    return a.position.x < b.position.x + b.size.x && a.position.x + a.size.x > b.position.x &&
+           a.position.y < b.position.y + b.size.y && a.position.y + a.size.y > b.position.y;
+}
+
+// Fraction of 'move' at which 'body' first touches 'box': 0 when it starts inside
+bool contact(const sf::FloatRect& body, const sf::Vector2f& move, const sf::FloatRect& box, float& time) {
+    if (overlaps(body, box)) {
+        time = 0.f;
+        return true;
+    }
+    sf::Vector2f normal;
+    return Narrowphase::timeOfImpact(body, move, box, time, normal);
+}
+
+GameEventType getStruckEvent(CollisionLayer target) {
+    switch (target) {
+        case CollisionLayer::Player: return GameEventType::PlayerStruck;
+        case CollisionLayer::NPC: return GameEventType::NPCStruck;
+        default: return GameEventType::EnemyStruck;
+    }
+}
+
+} // namespace
+
+uint32_t ProjectileSystem::spawn(const Shot& shot, const sf::Vector2f& centre, const sf::Vector2f& velocity) {
+    if (size() >= MAX_PROJECTILES) {
+        return NO_PROJECTILE;
+    }
+    posX.push_back(centre.x);
+    posY.push_back(centre.y);
+    velX.push_back(velocity.x);
+    velY.push_back(velocity.y);
+    gravity.push_back(shot.gravity);
+    life.push_back(shot.lifetime);
+    prevX.push_back(centre.x);
+    prevY.push_back(centre.y);
+    halfW.push_back(shot.size.x / 2.f);
+    halfH.push_back(shot.size.y / 2.f);
+    targets.push_back(shot.targets);
+    owner.push_back(shot.owner);
+    damage.push_back(shot.damage);
+    outcome.push_back(Outcome::Flying);
+    hitProxy.push_back(0);
+    hitTime.push_back(0.f);
+    spawnedSinceStep++;
+    return static_cast<uint32_t>(size() - 1);
+}
+
+void ProjectileSystem::spawnHitbox(const Shot& shot, const sf::FloatRect& box) {
+    hitboxes.push_back(Hitbox{box, shot.owner, shot.targets, shot.damage});
+}
+
+void ProjectileSystem::clear() {
+    resize(0);
+    hitboxes.clear();
+    hits.clear();
+    stats = Stats();
+    spawnedSinceStep = 0;
+}
+
+void ProjectileSystem::reserve(size_t count) {
+    for (auto* values : {&posX, &posY, &velX, &velY, &gravity, &life, &prevX, &prevY, &halfW, &halfH, &damage, &hitTime}) {
+        values->reserve(count);
+    }
+    targets.reserve(count);
+    owner.reserve(count);
+    outcome.reserve(count);
+    hitProxy.reserve(count);
+}
+
+void ProjectileSystem::resize(size_t count) {
+    for (auto* values : {&posX, &posY, &velX, &velY, &gravity, &life, &prevX, &prevY, &halfW, &halfH, &damage, &hitTime}) {
+        values->resize(count);
+    }
+    targets.resize(count);
+    owner.resize(count);
+    outcome.resize(count);
+    hitProxy.resize(count);
+}
+
+size_t ProjectileSystem::sweep(const ProjectileWorld& world, size_t begin, size_t end, float deltaTime) {
+    // Chunks write only their own projectiles' entries; the queries' scratch is per thread
+    static thread_local std::vector<size_t> platforms;
+    static thread_local std::vector<uint32_t> found;
+    size_t candidates = 0;
+    const sf::FloatRect& level = world.levelBounds;
+    for (size_t i = begin; i < end; ++i) {
+        prevX[i] = posX[i];
+        prevY[i] = posY[i];
+        velY[i] += gravity[i] * deltaTime;
+        const sf::Vector2f move(velX[i] * deltaTime, velY[i] * deltaTime);
+        posX[i] += move.x;
+        posY[i] += move.y;
+        life[i] -= deltaTime;
+
+        const sf::FloatRect body(sf::Vector2f(prevX[i] - halfW[i], prevY[i] - halfH[i]),
+                                 sf::Vector2f(halfW[i] * 2.f, halfH[i] * 2.f));
+        const sf::FloatRect area = Narrowphase::getSweepBounds(body, move);
+        Outcome result = Outcome::Flying;
+        float best = 2.f;
+        uint32_t target = 0;
+
+        // Terrain first: the nearest wall bounds how far the entities are looked for
+        world.terrainGrid.query(area, platforms);
+        candidates += platforms.size();
+        for (size_t p : platforms) {
+            float time;
+            if (contact(body, move, world.terrain.getBounds(p), time) && time < best) {
+                best = time;
+                result = Outcome::Blocked;
+            }
+        }
+        world.entities.query(area, targets[i], found);
+        candidates += found.size();
+        for (uint32_t id : found) {
+            float time;
+            // Ascending ids, so a tie keeps the lowest; a target touching the wall is still hit
+            if (contact(body, move, world.entities.getBounds(id), time) &&
+                (time < best || (time == best && result == Outcome::Blocked))) {
+                best = time;
+                result = Outcome::Hit;
+                target = id;
+            }
+        }
+
+        if (result == Outcome::Flying &&
+            (life[i] <= 0.f || posX[i] < level.position.x || posX[i] > level.position.x + level.size.x ||
+             posY[i] < level.position.y || posY[i] > level.position.y + level.size.y)) {
+            result = Outcome::Expired;
+        }
+        outcome[i] = result;
+        hitProxy[i] = target;
+        hitTime[i] = best;
+    }
+    return candidates;
+}
+
+void ProjectileSystem::step(const ProjectileWorld& world, float deltaTime) {
+    PROFILE_ZONE("ProjectileSystem::step");
+    stats = Stats();
+    stats.spawned = spawnedSinceStep;
+    spawnedSinceStep = 0;
+    hits.clear();
+
+    const size_t count = size();
+    std::atomic<size_t> candidates{0};
+    auto sweepRange = [&](size_t begin, size_t end) {
+        candidates.fetch_add(sweep(world, begin, end, deltaTime), std::memory_order_relaxed);
+    };
+    if (world.jobs) {
+        world.jobs->parallelFor(count, GRAIN, sweepRange);
+    } else {
+        sweepRange(0, count);
+    }
+    stats.candidates = candidates.load(std::memory_order_relaxed);
+
+    // Results in index order; the survivors are packed down over the rest
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        switch (outcome[i]) {
+            case Outcome::Hit: {
+                const sf::Vector2f move(posX[i] - prevX[i], posY[i] - prevY[i]);
+                const sf::Vector2f point = sf::Vector2f(prevX[i], prevY[i]) + move * hitTime[i];
+                const uint32_t id = hitProxy[i];
+                record(world, world.entities.getLayer(id), world.entities.getIndex(id), owner[i], point,
+                       sf::Vector2f(velX[i], velY[i]), damage[i]);
+                continue;
+            }
+            case Outcome::Blocked:
+                stats.blocked++;
+                continue;
+            case Outcome::Expired:
+                stats.expired++;
+                continue;
+            case Outcome::Flying:
+                break;
+        }
+        if (kept != i) {
+            posX[kept] = posX[i];
+            posY[kept] = posY[i];
+            velX[kept] = velX[i];
+            velY[kept] = velY[i];
+            gravity[kept] = gravity[i];
+            life[kept] = life[i];
+            prevX[kept] = prevX[i];
+            prevY[kept] = prevY[i];
+            halfW[kept] = halfW[i];
+            halfH[kept] = halfH[i];
+            targets[kept] = targets[i];
+            owner[kept] = owner[i];
+            damage[kept] = damage[i];
+        }
+        kept++;
+    }
+    resize(kept);
+
+    // Hitboxes hit everything they overlap, once
+    for (const Hitbox& hitbox : hitboxes) {
+        world.entities.query(hitbox.box, hitbox.targets, proxies);
+        for (uint32_t id : proxies) {
+            const sf::Vector2f centre = hitbox.box.position + hitbox.box.size / 2.f;
+            record(world, world.entities.getLayer(id), world.entities.getIndex(id), hitbox.owner, centre,
+                   sf::Vector2f(), hitbox.damage);
+        }
+    }
+    hitboxes.clear();
+    stats.live = size();
+}
+
+void ProjectileSystem::record(const ProjectileWorld& world, CollisionLayer target, uint32_t targetIndex,
+                              CollisionLayer from, const sf::Vector2f& point, const sf::Vector2f& velocity,
+                              float hitDamage) {
+    hits.push_back(Hit{target, targetIndex, from, point, velocity, hitDamage});
+    stats.hits++;
+    if (world.events) {
+        world.events->emit(getStruckEvent(target), point, static_cast<float>(targetIndex));
+    }
+}
+
+size_t ProjectileSystem::addToCrowd(CrowdRenderer& crowd, const ViewCulling::ViewSet& views, float alpha) const {
+    static const sf::Color PLAYER_SHOT(255, 230, 120);
+    static const sf::Color ENEMY_SHOT(255, 90, 70);
+    size_t drawn = 0;
+    for (size_t i = 0; i < size(); ++i) {
+        const sf::Vector2f centre(prevX[i] + (posX[i] - prevX[i]) * alpha, prevY[i] + (posY[i] - prevY[i]) * alpha);
+        const sf::FloatRect bounds(sf::Vector2f(centre.x - halfW[i], centre.y - halfH[i]),
+                                   sf::Vector2f(halfW[i] * 2.f, halfH[i] * 2.f));
+        const uint8_t seenBy = views.visibleMask(bounds);
+        if (seenBy == 0) {
+            continue;
+        }
+        crowd.add(nullptr, RenderCategory::Particles, bounds, sf::IntRect(), false,
+                  owner[i] == CollisionLayer::Player ? PLAYER_SHOT : ENEMY_SHOT, seenBy);
+        ++drawn;
+    }
+    return drawn;
+}
+
+void ProjectileSystem::saveState(SimSnapshot& snapshot) const {
+    snapshot.writeArray(posX);
+    snapshot.writeArray(posY);
+    snapshot.writeArray(velX);
+    snapshot.writeArray(velY);
+    snapshot.writeArray(gravity);
+    snapshot.writeArray(life);
+    snapshot.writeArray(halfW);
+    snapshot.writeArray(halfH);
+    snapshot.writeArray(targets);
+    snapshot.writeArray(owner);
+    snapshot.writeArray(damage);
+    snapshot.writeArray(hitboxes);
+}
+
+bool ProjectileSystem::loadState(SimSnapshot& snapshot) {
+    if (!(snapshot.readArray(posX) && snapshot.readArray(posY) && snapshot.readArray(velX) &&
+          snapshot.readArray(velY) && snapshot.readArray(gravity) && snapshot.readArray(life) &&
+          snapshot.readArray(halfW) && snapshot.readArray(halfH) && snapshot.readArray(targets) &&
+          snapshot.readArray(owner) && snapshot.readArray(damage) && snapshot.readArray(hitboxes))) {
+        return false;
+    }
+    const size_t count = posX.size();
+    prevX = posX;
+    prevY = posY;
+    outcome.assign(count, Outcome::Flying);
+    hitProxy.assign(count, 0);
+    hitTime.assign(count, 0.f);
+    hits.clear();
+    return posY.size() == count && velX.size() == count && velY.size() == count && gravity.size() == count &&
+           life.size() == count && halfW.size() == count && halfH.size() == count && targets.size() == count &&
+           owner.size() == count && damage.size() == count;
+}
+
+void ProjectileSystem::snapState() {
+    FixedPoint::snap(posX.data(), posX.size());
+    FixedPoint::snap(posY.data(), posY.size());
+    FixedPoint::snap(velX.data(), velX.size());
+    FixedPoint::snap(velY.data(), velY.size());
+}
@@ -0,0 +1,71 @@
+#include "QualityGovernor.hpp"
+#include <algorithm>
+
+void QualityGovernor::setPreset(size_t preset) {
+    level = ceiling = preset;
+    stats.raiseSeconds = RAISE_SECONDS;
+    resetTimers();
+}
+
+void QualityGovernor::setEnabled(bool enable) {
+    enabled = enable;
+    if (!enabled) {
+        level = ceiling; // Back to what the player picked
+    }
+    stats.raiseSeconds = RAISE_SECONDS;
+    resetTimers();
+}
+
+void QualityGovernor::resetTimers() {
+    overSeconds = 0.0;
+    underSeconds = 0.0;
+    cooldown = 0.0;
+    sinceRaise = BOUNCE_SECONDS;
+}
+
+bool QualityGovernor::update(double cpuMs, double gpuMs, double seconds) {
+    stats.cpuMs = cpuMs;
+    stats.gpuMs = gpuMs;
+    stats.gpuBound = gpuMs > cpuMs;
+    const double frameMs = std::max(cpuMs, gpuMs);
+    stats.smoothedMs = hasSample ? stats.smoothedMs + (frameMs - stats.smoothedMs) * SMOOTHING : frameMs;
+    hasSample = true;
+    if (!enabled || targetMs <= 0.0) {
+        return false;
+    }
+
+    cooldown = std::max(cooldown - seconds, 0.0);
+    sinceRaise = std::min(sinceRaise + seconds, BOUNCE_SECONDS);
+    if (stats.smoothedMs > targetMs * DROP_SHARE) {
+        overSeconds += seconds;
+        underSeconds = 0.0;
+    } else if (stats.smoothedMs < targetMs * RAISE_SHARE) {
+        underSeconds += seconds;
+        overSeconds = 0.0;
+    } else {
+        overSeconds = 0.0;
+        underSeconds = 0.0;
+    }
+    if (cooldown > 0.0) {
+        return false;
+    }
+
+    if (overSeconds >= DROP_SECONDS && level > 0) {
+        if (sinceRaise < BOUNCE_SECONDS) {
+            stats.raiseSeconds = std::min(stats.raiseSeconds * 2.0, MAX_RAISE_SECONDS);
+        }
+        --level;
+        stats.drops++;
+    } else if (underSeconds >= stats.raiseSeconds && level < ceiling) {
+        ++level;
+        stats.raises++;
+        sinceRaise = 0.0;
+    } else {
+        return false;
+    }
+    // The new level's frames start from scratch
+    overSeconds = 0.0;
+    underSeconds = 0.0;
+    cooldown = COOLDOWN_SECONDS;
+    return true;
+}
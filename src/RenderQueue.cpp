@@ -0,0 +1,118 @@
+#include "RenderQueue.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+void RenderQueue::clear() {
+    items.clear();
+    vertices.clear();
+    textures.clear();
+    order.clear();
+    sorted = true;
+    flushedOnce = false;
+    stats = Stats();
+}
+
+uint8_t RenderQueue::textureId(const sf::Texture* texture) {
+    if (!texture) return 0;
+    auto found = std::find(textures.begin(), textures.end(), texture);
+    if (found != textures.end()) {
+        return static_cast<uint8_t>(std::min<size_t>(found - textures.begin() + 1, 255));
+    }
+    // Past 254 textures the rest share the last id: still in layer order, only less merged
+    textures.push_back(texture);
+    return static_cast<uint8_t>(std::min<size_t>(textures.size(), 255));
+}
+
+void RenderQueue::addTriangles(RenderLayer layer, uint16_t depth, const sf::Vertex* source, size_t vertexCount,
+                               const sf::Texture* texture, RenderCategory category, uint8_t views) {
+    if (vertexCount == 0) return;
+    items.push_back(Item{makeKey(layer, textureId(texture), depth), Kind::Triangles, category,
+                         RenderSnapshot::Pass::Background, views, texture, static_cast<uint32_t>(vertices.size()),
+                         static_cast<uint32_t>(vertexCount)});
+    vertices.insert(vertices.end(), source, source + vertexCount);
+    sorted = false;
+}
+
+void RenderQueue::addSprite(RenderLayer layer, uint16_t depth, const sf::Sprite& sprite, RenderCategory category,
+                            uint8_t views) {
+    // Same corners and texture coordinates sf::Sprite builds (negative rect sizes flip)
+    const sf::Transform& transform = sprite.getTransform();
+    const sf::IntRect rect = sprite.getTextureRect();
+    const sf::Vector2f size(std::abs(static_cast<float>(rect.size.x)), std::abs(static_cast<float>(rect.size.y)));
+    const float left = static_cast<float>(rect.position.x);
+    const float top = static_cast<float>(rect.position.y);
+    const float right = left + rect.size.x;
+    const float bottom = top + rect.size.y;
+    const sf::Color color = sprite.getColor();
+
+    const sf::Vertex topLeft{transform.transformPoint(sf::Vector2f(0.f, 0.f)), color, sf::Vector2f(left, top)};
+    const sf::Vertex topRight{transform.transformPoint(sf::Vector2f(size.x, 0.f)), color, sf::Vector2f(right, top)};
+    const sf::Vertex bottomLeft{transform.transformPoint(sf::Vector2f(0.f, size.y)), color, sf::Vector2f(left, bottom)};
+    const sf::Vertex bottomRight{transform.transformPoint(size), color, sf::Vector2f(right, bottom)};
+    const std::array<sf::Vertex, 6> quad = {topLeft, topRight, bottomLeft, bottomLeft, topRight, bottomRight};
+    addTriangles(layer, depth, quad.data(), quad.size(), &sprite.getTexture(), category, views);
+}
+
+void RenderQueue::addPass(RenderLayer layer, uint16_t depth, RenderSnapshot::Pass pass) {
+    items.push_back(Item{makeKey(layer, 0, depth), Kind::Pass, RenderCategory::UI, pass, ALL_VIEWS, nullptr, 0, 0});
+    sorted = false;
+}
+
+void RenderQueue::sort() {
+    PROFILE_ZONE("RenderQueue::sort");
+    order.resize(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    sortScratch.resize(order.size());
+
+    // LSD radix sort, a byte a pass; counting keeps it stable. Passes where
+    // every key has the same byte (most of the depth bits, usually) are skipped.
+    for (int shift = 0; shift < 32; shift += 8) {
+        std::array<uint32_t, 257> offsets{};
+        for (uint32_t index : order) {
+            offsets[((items[index].key >> shift) & 0xFF) + 1]++;
+        }
+        if (std::any_of(offsets.begin() + 1, offsets.end(), [this](uint32_t count) { return count == items.size(); })) {
+            continue;
+        }
+        for (size_t b = 1; b < offsets.size(); ++b) {
+            offsets[b] += offsets[b - 1];
+        }
+        for (uint32_t index : order) {
+            sortScratch[offsets[(items[index].key >> shift) & 0xFF]++] = index;
+        }
+        order.swap(sortScratch);
+    }
+    sorted = true;
+}
+
+void RenderQueue::flush(RenderSnapshot& snapshot, uint32_t slot, uint8_t views) {
+    if (!sorted) {
+        sort();
+    }
+    const bool countDraws = !flushedOnce;
+    flushedOnce = true;
+
+    const Item* previous = nullptr;
+    for (uint32_t index : order) {
+        const Item& item = items[index];
+        if (item.kind == Kind::Pass) {
+            snapshot.pass(item.pass, slot);
+            previous = nullptr;
+            if (countDraws) stats.draws++;
+            continue;
+        }
+        if ((item.views & views) == 0) continue;
+        snapshot.drawTriangles(vertices.data() + item.firstVertex, item.vertexCount, item.texture, item.category);
+        if (countDraws && !(previous && previous->texture == item.texture && previous->category == item.category)) {
+            stats.draws++;
+        }
+        previous = &item;
+    }
+    if (countDraws) {
+        stats.items = items.size();
+    }
+}
@@ -0,0 +1,102 @@
+#include "RenderSnapshot.hpp"
+
+void RenderSnapshot::reset() {
+    commands.clear();
+    vertices.clear();
+    viewCount = spriteCount = rectangleCount = circleCount = textCount = 0;
+    sceneKept = false;
+    culled.fill(0);
+}
+
+void RenderSnapshot::add(Kind kind, uint32_t index, RenderCategory category, const sf::RenderStates& states) {
+    Command command;
+    command.kind = kind;
+    command.category = category;
+    command.index = index;
+    command.states = states;
+    commands.push_back(command);
+}
+
+void RenderSnapshot::clear(const sf::Color& color) {
+    clearColor = color;
+    add(Kind::Clear, 0, RenderCategory::Background, sf::RenderStates::Default);
+}
+
+void RenderSnapshot::setView(const sf::View& view) {
+    add(Kind::View, store(views, viewCount, view), RenderCategory::UI, sf::RenderStates::Default);
+}
+
+void RenderSnapshot::pass(Pass pass, uint32_t view) {
+    add(Kind::Pass, view, RenderCategory::Background, sf::RenderStates::Default);
+    commands.back().pass = pass;
+}
+
+void RenderSnapshot::repeat(size_t first, size_t end) {
+    commands.reserve(commands.size() + (end - first)); // push_back below never reallocates under commands[i]
+    for (size_t i = first; i < end; ++i) {
+        commands.push_back(commands[i]);
+        commands.back().mergeable = false; // Its vertices aren't at the end; nothing may join it
+    }
+}
+
+void RenderSnapshot::draw(const sf::Sprite& sprite, RenderCategory category, const sf::RenderStates& states) {
+    add(Kind::Sprite, store(sprites, spriteCount, sprite), category, states);
+}
+
+void RenderSnapshot::draw(const sf::RectangleShape& shape, RenderCategory category, const sf::RenderStates& states) {
+    add(Kind::Rectangle, store(rectangles, rectangleCount, shape), category, states);
+}
+
+void RenderSnapshot::draw(const sf::CircleShape& shape, RenderCategory category, const sf::RenderStates& states) {
+    add(Kind::Circle, store(circles, circleCount, shape), category, states);
+}
+
+void RenderSnapshot::draw(const sf::Text& text, RenderCategory category, const sf::RenderStates& states) {
+    const uint32_t index = store(texts, textCount, text);
+    texts[index].getLocalBounds(); // Builds the geometry, loading any missing glyphs, on this thread
+    add(Kind::Text, index, category, states);
+}
+
+void RenderSnapshot::draw(const sf::VertexArray& vertexArray, RenderCategory category, const sf::RenderStates& states) {
+    if (vertexArray.getVertexCount() > 0) {
+        draw(&vertexArray[0], vertexArray.getVertexCount(), vertexArray.getPrimitiveType(), category, states);
+    }
+}
+
+void RenderSnapshot::draw(const sf::Vertex* source, size_t vertexCount, sf::PrimitiveType type, RenderCategory category,
+                          const sf::RenderStates& states) {
+    if (vertexCount == 0) return;
+    const uint32_t first = static_cast<uint32_t>(vertices.size());
+    vertices.insert(vertices.end(), source, source + vertexCount);
+    add(Kind::Vertices, first, category, states);
+    commands.back().primitive = type;
+    commands.back().count = static_cast<uint32_t>(vertexCount);
+}
+
+void RenderSnapshot::drawTriangles(const sf::Vertex* source, size_t vertexCount, const sf::Texture* texture,
+                                   RenderCategory category, const sf::Vector2f& offset) {
+    if (vertexCount == 0) return;
+
+    Command* last = commands.empty() ? nullptr : &commands.back();
+    const bool merge = last && last->mergeable && last->category == category && last->states.texture == texture &&
+                       last->index + last->count == vertices.size();
+    const size_t first = vertices.size();
+    vertices.insert(vertices.end(), source, source + vertexCount);
+    for (size_t i = first; i < vertices.size(); ++i) {
+        vertices[i].position += offset;
+    }
+    if (merge) {
+        last->count += static_cast<uint32_t>(vertexCount);
+        return;
+    }
+
+    sf::RenderStates states;
+    states.texture = texture;
+    add(Kind::Vertices, static_cast<uint32_t>(first), category, states);
+    commands.back().count = static_cast<uint32_t>(vertexCount);
+    commands.back().mergeable = true;
+}
+
+void RenderSnapshot::countCulled(RenderCategory category, size_t count) {
+    culled[static_cast<size_t>(category)] += count;
+}
@@ -0,0 +1,109 @@
+#include "RenderStats.hpp"
+#include <algorithm>
+
+const char* getRenderCategoryName(RenderCategory category) {
+    switch (category) {
+        case RenderCategory::Background: return "Background";
+        case RenderCategory::Decorations: return "Decorations";
+        case RenderCategory::Platforms: return "Platforms";
+        case RenderCategory::Ladders: return "Ladders";
+        case RenderCategory::Enemies: return "Enemies";
+        case RenderCategory::Player: return "Player";
+        case RenderCategory::NPCs: return "NPCs";
+        case RenderCategory::Particles: return "Particles";
+        case RenderCategory::Lighting: return "Lighting";
+        case RenderCategory::Debug: return "Debug";
+        case RenderCategory::MiniMap: return "Mini-map";
+        case RenderCategory::UI: return "UI";
+        default: return "?";
+    }
+}
+
+RenderStats::Counters& RenderStats::Counters::operator+=(const Counters& other) {
+    drawCalls += other.drawCalls;
+    vertices += other.vertices;
+    textureChanges += other.textureChanges;
+    culled += other.culled;
+    return *this;
+}
+
+RenderStats::Counters RenderStats::Frame::getTotal() const {
+    Counters total;
+    for (const auto& counters : categories) {
+        total += counters;
+    }
+    return total;
+}
+
+void RenderStats::record(RenderCategory category, size_t drawCalls, size_t vertices, const sf::Texture* texture) {
+    Counters& counters = current.categories[static_cast<size_t>(category)];
+    counters.drawCalls += drawCalls;
+    counters.vertices += vertices;
+    if (texture != boundTexture) {
+        counters.textureChanges++;
+        boundTexture = texture;
+    }
+}
+
+void RenderStats::draw(sf::RenderTarget& target, const sf::Shape& shape, RenderCategory category,
+                       const sf::RenderStates& states) {
+    target.draw(shape, states);
+    // Fill is a fan over the points plus centre and closing point; the outline a separate strip
+    const size_t points = shape.getPointCount();
+    record(category, 1, points + 2, shape.getTexture());
+    if (shape.getOutlineThickness() != 0.f) {
+        record(category, 1, (points + 1) * 2, nullptr);
+    }
+}
+
+void RenderStats::draw(sf::RenderTarget& target, const sf::Sprite& sprite, RenderCategory category,
+                       const sf::RenderStates& states) {
+    target.draw(sprite, states);
+    record(category, 1, 4, &sprite.getTexture());
+}
+
+void RenderStats::draw(sf::RenderTarget& target, const sf::Text& text, RenderCategory category,
+                       const sf::RenderStates& states) {
+    target.draw(text, states);
+    // Six vertices per glyph, drawn again for the outline
+    const sf::Texture* glyphs = &text.getFont().getTexture(text.getCharacterSize());
+    const size_t vertices = text.getString().getSize() * 6;
+    record(category, 1, vertices, glyphs);
+    if (text.getOutlineThickness() != 0.f) {
+        record(category, 1, vertices, glyphs);
+    }
+}
+
+void RenderStats::draw(sf::RenderTarget& target, const sf::VertexArray& vertices, RenderCategory category,
+                       const sf::RenderStates& states) {
+    target.draw(vertices, states);
+    record(category, 1, vertices.getVertexCount(), states.texture);
+}
+
+void RenderStats::draw(sf::RenderTarget& target, const sf::VertexBuffer& buffer, RenderCategory category,
+                       const sf::RenderStates& states) {
+    target.draw(buffer, states);
+    record(category, 1, buffer.getVertexCount(), states.texture);
+}
+
+void RenderStats::draw(sf::RenderTarget& target, const sf::Vertex* vertices, size_t vertexCount,
+                       sf::PrimitiveType type, RenderCategory category, const sf::RenderStates& states) {
+    target.draw(vertices, vertexCount, type, states);
+    record(category, 1, vertexCount, states.texture);
+}
+
+void RenderStats::countCulled(RenderCategory category, size_t count) {
+    current.categories[static_cast<size_t>(category)].culled += count;
+}
+
+void RenderStats::endFrame() {
+    history[historyNext] = current;
+    historyNext = (historyNext + 1) % FRAME_HISTORY;
+    historyCount = std::min(historyCount + 1, FRAME_HISTORY);
+    current = Frame();
+    boundTexture = nullptr;
+}
+
+const RenderStats::Frame& RenderStats::getFrame(size_t age) const {
+    return history[(historyNext + FRAME_HISTORY - 1 - std::min(age, FRAME_HISTORY - 1)) % FRAME_HISTORY];
+}
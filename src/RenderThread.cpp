@@ -0,0 +1,143 @@
+#include "RenderThread.hpp"
+#include "Profiler.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// ImVector::operator= frees first; this keeps the destination's capacity
+template <typename T>
+void copyInto(ImVector<T>& destination, const ImVector<T>& source) {
+    destination.resize(source.Size);
+    if (source.Size > 0) {
+        std::memcpy(destination.Data, source.Data, static_cast<size_t>(source.Size) * sizeof(T));
+    }
+}
+
+} // namespace
+
+void RenderThread::Frame::copyImGui(const ImDrawData* source) {
+    imguiDrawData.Clear();
+    if (!source || !source->Valid) {
+        return;
+    }
+    while (imguiLists.size() < static_cast<size_t>(source->CmdListsCount)) {
+        imguiLists.push_back(std::make_unique<ImDrawList>(ImGui::GetDrawListSharedData()));
+    }
+    for (int i = 0; i < source->CmdListsCount; ++i) {
+        const ImDrawList& from = *source->CmdLists[i];
+        ImDrawList& to = *imguiLists[i];
+        copyInto(to.CmdBuffer, from.CmdBuffer);
+        copyInto(to.IdxBuffer, from.IdxBuffer);
+        copyInto(to.VtxBuffer, from.VtxBuffer);
+        to.Flags = from.Flags;
+        imguiDrawData.CmdLists.push_back(&to);
+    }
+    imguiDrawData.Valid = true;
+    imguiDrawData.CmdListsCount = source->CmdListsCount;
+    imguiDrawData.TotalIdxCount = source->TotalIdxCount;
+    imguiDrawData.TotalVtxCount = source->TotalVtxCount;
+    imguiDrawData.DisplayPos = source->DisplayPos;
+    imguiDrawData.DisplaySize = source->DisplaySize;
+    imguiDrawData.FramebufferScale = source->FramebufferScale;
+}
+
+RenderThread::RenderThread(Presenter presenter) : presenter(std::move(presenter)) {}
+
+RenderThread::~RenderThread() {
+    stop();
+}
+
+bool RenderThread::start(sf::RenderWindow& target) {
+    stop();
+    // A context can only be current on one thread
+    if (!target.setActive(false)) {
+        std::cerr << "RenderThread: could not release the window's GL context" << std::endl;
+        return false;
+    }
+    window = &target;
+    stopping = false;
+    worker = std::thread(&RenderThread::run, this);
+    return true;
+}
+
+void RenderThread::stop() {
+    if (!worker.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+    if (!window->setActive(true)) {
+        std::cerr << "RenderThread: could not take the window's GL context back" << std::endl;
+    }
+    window = nullptr;
+}
+
+void RenderThread::waitIdle() {
+    if (!worker.joinable()) {
+        return;
+    }
+    PROFILE_ZONE("RenderThread::waitIdle");
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return pending == nullptr; });
+    stats.waitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void RenderThread::submit() {
+    Frame& frame = frames[writeIndex];
+    writeIndex ^= 1;
+    if (!worker.joinable()) {
+        presenter(frame);
+        return;
+    }
+    waitIdle();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = &frame;
+    }
+    wake.notify_one();
+}
+
+RenderThread::Stats RenderThread::takeStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Stats taken = stats;
+    stats.waitMs = 0.0;
+    return taken;
+}
+
+void RenderThread::run() {
+    PROFILE_THREAD("Render");
+    if (!window->setActive(true)) {
+        std::cerr << "RenderThread: could not make the window's GL context current" << std::endl;
+    }
+    while (true) {
+        Frame* frame = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || pending != nullptr; });
+            if (!pending) {
+                break; // Stopping with nothing left to draw
+            }
+            frame = pending;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        presenter(*frame);
+        const double renderMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending = nullptr;
+            stats.frames++;
+            stats.renderMs = renderMs;
+        }
+        idle.notify_all();
+    }
+    (void)window->setActive(false);
+}
@@ -1,6 +1,9 @@
 #include "RenderingSystem.hpp"
+#include "Profiler.hpp"
 #include "Player.hpp"
-#include "Enemy.hpp"
+#include "EnemyStore.hpp"
+#include "AssetPack.hpp"
+#include "FileWatcher.hpp"
 #include <iostream>
 #include <chrono>
 #include <iomanip>
@@ -8,15 +11,166 @@
 #include <filesystem>
 #include <algorithm>
 #include <cstdint>
+#include <cmath>
 
 namespace fs = std::filesystem;
 
+// Per-frame and rebuild logging without building strings (see LOG_FORMAT)
+#define RENDER_LOG(level, format, ...) \
+    do { \
+        if (loggingEnabled) { \
+            LOG_FORMAT(logSink, level, format, __VA_ARGS__); \
+        } \
+    } while (0)
+
+namespace {
+
+// Scrolling background layer: parallax shift and wrap per pixel, so the quad itself
+// never moves in texture space and the texture needs no repeat mode
+const char* const PARALLAX_FRAGMENT_SHADER = R"(
+uniform sampler2D texture;
+uniform vec2 offset; // Parallax shift in normalized texture units
+uniform vec2 wrap;   // 1.0 on repeating axes
+void main() {
+    vec2 uv = gl_TexCoord[0].xy + offset;
+    uv = mix(uv, fract(uv), wrap);
+    gl_FragColor = gl_Color * texture2D(texture, uv);
+}
+)";
+
+// Animated tile quads: the vertex colour holds the frame count, frames per
+// second and frame width in atlas pixels, and the frames run across the strip
+const char* const TILE_VERTEX_SHADER = R"(
+uniform float time;
+void main() {
+    vec3 animation = floor(gl_Color.rgb * 255.0 + 0.5);
+    float frame = mod(floor(time * animation.g), max(animation.r, 1.0));
+    vec4 uv = gl_MultiTexCoord0;
+    uv.x += frame * animation.b;
+    gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;
+    gl_TexCoord[0] = gl_TextureMatrix[0] * uv;
+    gl_FrontColor = vec4(1.0);
+}
+)";
+
+const char* const TILE_FRAGMENT_SHADER = R"(
+uniform sampler2D texture;
+void main() {
+    gl_FragColor = gl_Color * texture2D(texture, gl_TexCoord[0].xy);
+}
+)";
+
+// Colour grading of the presented scene: a 3D LUT unwrapped into 'lutSize'
+// slices side by side (blue between two slices is blended), then the tint
+const char* const GRADE_FRAGMENT_SHADER = R"(
+uniform sampler2D texture;
+uniform sampler2D lut;
+uniform float lutSize; // 0 without a LUT
+uniform vec3 tint;
+vec3 grade(vec3 color) {
+    float blue = color.b * (lutSize - 1.0);
+    float slice = floor(blue);
+    vec2 texel = vec2(1.0 / (lutSize * lutSize), 1.0 / lutSize);
+    vec2 uv = (color.rg * (lutSize - 1.0) + 0.5) * texel;
+    vec3 low = texture2D(lut, uv + vec2(slice * lutSize * texel.x, 0.0)).rgb;
+    vec3 high = texture2D(lut, uv + vec2(min(slice + 1.0, lutSize - 1.0) * lutSize * texel.x, 0.0)).rgb;
+    return mix(low, high, blue - slice);
+}
+void main() {
+    vec4 color = texture2D(texture, gl_TexCoord[0].xy);
+    vec3 graded = lutSize > 0.0 ? grade(color.rgb) : color.rgb;
+    gl_FragColor = gl_Color * vec4(graded * tint, color.a);
+}
+)";
+
+// "<name>@<frames>x<fps>.png" is an animated strip of the tile <name>.png
+std::string parseTileName(const std::string& filename, uint8_t& frames, uint8_t& fps) {
+    frames = 1;
+    fps = 0;
+    const size_t at = filename.rfind('@');
+    const size_t extension = filename.rfind('.');
+    if (at == std::string::npos || extension == std::string::npos || extension < at) {
+        return filename;
+    }
+    unsigned count = 0;
+    unsigned rate = 0;
+    char separator = 0;
+    std::istringstream spec(filename.substr(at + 1, extension - at - 1));
+    if (!(spec >> count >> separator >> rate) || separator != 'x' || count < 1 || count > 255 || rate > 255) {
+        return filename;
+    }
+    frames = static_cast<uint8_t>(count);
+    fps = static_cast<uint8_t>(rate);
+    return filename.substr(0, at) + filename.substr(extension);
+}
+
+// Stand-in colour for a decoration quad the tile set has no tile for
+sf::Color decorationColor(const LevelData::DecorationQuad& quad) {
+    switch (quad.kind) {
+        case LevelData::DecorationKind::Tree:
+            return quad.part == LevelData::DecorationPart::Bottom ? sf::Color(110, 75, 45) : sf::Color(40, 110, 60);
+        case LevelData::DecorationKind::Cabin: return sf::Color(125, 85, 55);
+        case LevelData::DecorationKind::Snowman: return sf::Color(240, 245, 255);
+        default: return sf::Color(150, 150, 160);
+    }
+}
+
+// Neighbour bits of a platform cell, set where the platform continues
+enum CellNeighbours : unsigned {
+    NeighbourNorth = 1 << 0,
+    NeighbourEast = 1 << 1,
+    NeighbourSouth = 1 << 2,
+    NeighbourWest = 1 << 3,
+};
+
+// Mixes a platform's origin and one of its cells into a variant choice that
+// stays put across reloads and doesn't depend on the other platforms
+uint32_t hashCell(const sf::Vector2f& origin, int column, int row) {
+    uint32_t h = static_cast<uint32_t>(static_cast<int32_t>(std::floor(origin.x))) * 0x9E3779B1u;
+    h ^= static_cast<uint32_t>(static_cast<int32_t>(std::floor(origin.y))) * 0x85EBCA77u;
+    h ^= static_cast<uint32_t>(column) * 0xC2B2AE3Du + static_cast<uint32_t>(row) * 0x27D4EB2Fu;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return h;
+}
+
+GpuTimer::Pass gpuPassFor(RenderCategory category) {
+    switch (category) {
+        case RenderCategory::Background: return GpuTimer::Pass::Background;
+        case RenderCategory::Decorations:
+        case RenderCategory::Platforms:
+        case RenderCategory::Ladders: return GpuTimer::Pass::Tiles;
+        case RenderCategory::Enemies:
+        case RenderCategory::Player:
+        case RenderCategory::NPCs:
+        case RenderCategory::Particles: return GpuTimer::Pass::Entities;
+        case RenderCategory::Lighting: return GpuTimer::Pass::Lighting;
+        case RenderCategory::Debug: return GpuTimer::Pass::Debug;
+        case RenderCategory::MiniMap: return GpuTimer::Pass::MiniMap;
+        default: return GpuTimer::Pass::UI;
+    }
+}
+
+GpuTimer::Pass gpuPassFor(RenderSnapshot::Pass pass) {
+    switch (pass) {
+        case RenderSnapshot::Pass::Background: return GpuTimer::Pass::Background;
+        case RenderSnapshot::Pass::Particles: return GpuTimer::Pass::Entities;
+        case RenderSnapshot::Pass::DebugGrid: return GpuTimer::Pass::Debug;
+        case RenderSnapshot::Pass::Decorations:
+        case RenderSnapshot::Pass::Platforms: return GpuTimer::Pass::Tiles;
+        case RenderSnapshot::Pass::Lighting: return GpuTimer::Pass::Lighting;
+        default: return GpuTimer::Pass::Present;
+    }
+}
+
+} // namespace
+
 RenderingSystem::RenderingSystem() {
     // Initialize logging
-    logFile.open(logFileName, std::ios::out | std::ios::app);
-    if (logFile.is_open()) {
-        logInfo("RenderingSystem initialized");
-    }
+    logSink = AsyncLogger::instance().openSink(logFileName, GAME_BINARY_LOG
+        ? AsyncLogger::SinkFormat::Binary : AsyncLogger::SinkFormat::Text);
+    logInfo("RenderingSystem initialized");
     
     // Initialize placeholder shapes
     backgroundPlaceholder.setSize(sf::Vector2f(3000, 600)); // LEVEL_WIDTH x WINDOW_HEIGHT
@@ -37,10 +191,7 @@ RenderingSystem::RenderingSystem() {
 }
 
 RenderingSystem::~RenderingSystem() {
-    if (logFile.is_open()) {
-        logInfo("RenderingSystem shutting down");
-        logFile.close();
-    }
+    logInfo("RenderingSystem shutting down");
 }
 
 void RenderingSystem::renderFrame() {
@@ -87,119 +238,718 @@ void RenderingSystem::renderBackground() {
     if (!renderTarget) return;
     
     if (useBackgroundPlaceholder) {
-        renderTarget->draw(backgroundPlaceholder);
-        logDebug("Rendered background placeholder");
+        submit(*renderTarget, backgroundPlaceholder, RenderCategory::Background);
+        if (frameLoggingEnabled) {
+            logDebug("Rendered background placeholder");
+        }
     } else {
         renderBackgroundLayers();
-        logDebug("Rendered background layers");
+        if (frameLoggingEnabled) {
+            logDebug("Rendered background layers");
+        }
     }
+    renderParticles();
 }
 
-void RenderingSystem::renderBackgroundLayers() {
-    if (!renderTarget) return;
+void RenderingSystem::renderBackgroundLayers(size_t viewSlot) {
+    PROFILE_ZONE("RenderingSystem::renderBackgroundLayers");
+    if (!renderTarget || viewSlot >= backgroundComposites.size()) return;
+    if (!effectsInitialized) {
+        initializeEffects();
+    }
     
-    // Get the current view from the render target
-    sf::View currentView = renderTarget->getView();
-    sf::Vector2f viewCenter = currentView.getCenter();
-    sf::Vector2f viewSize = currentView.getSize();
+    const sf::View& view = renderTarget->getView();
+    if (backgroundCacheDirty || view.getSize() != cachedBackgroundViewSize) {
+        rebuildBackgroundCache(view.getSize());
+    }
+    lastBackgroundDrawCalls = 0;
     
-    // Calculate the visible area
-    float leftX = viewCenter.x - viewSize.x / 2.0f;
-    float rightX = viewCenter.x + viewSize.x / 2.0f;
-    float topY = viewCenter.y - viewSize.y / 2.0f;
-    float bottomY = viewCenter.y + viewSize.y / 2.0f;
+    const sf::Vector2f viewCenter = view.getCenter();
+    const sf::Vector2f viewTopLeft = viewCenter - view.getSize() / 2.0f;
+    BackgroundComposite& composite = backgroundComposites[viewSlot];
     
-    int layersRendered = 0;
+    // Camera still since the composite was made: the whole stack is one draw
+    if (composite.valid && viewCenter == composite.viewCenter) {
+        drawCachedTexture(*renderTarget, *composite.texture, viewTopLeft, view.getSize());
+        return;
+    }
     
-    // Draw layers from back to front (background1 -> background2 -> background3 -> background4)
-    for (auto& layer : backgroundLayers) {
-        if (!layer.isLoaded || !layer.sprite) continue;
+    // Camera settled (same spot as last frame): compose the stack once and reuse it
+    if (viewCenter == composite.lastViewCenter && ensureBackgroundComposite(composite)) {
+        // The composite is the view's size, so it fills it whatever the view's viewport
+        sf::View compositeView = view;
+        compositeView.setViewport(sf::FloatRect(sf::Vector2f(0.f, 0.f), sf::Vector2f(1.f, 1.f)));
+        composite.texture->setView(compositeView);
+        composite.texture->clear(sf::Color::Transparent);
+        drawBackgroundStack(*composite.texture, view);
+        composite.texture->display();
+        composite.viewCenter = viewCenter;
+        composite.valid = true;
         
-        // Calculate parallax offset
-        // For parallax, we want layers to move slower than the camera
-        // A speed of 0.0 means static (no movement), 1.0 means moves with camera
-        float parallaxOffsetX = (viewCenter.x - WINDOW_WIDTH / 2.0f) * layer.parallaxSpeed;
-        float parallaxOffsetY = (viewCenter.y - WINDOW_HEIGHT / 2.0f) * layer.parallaxSpeed;
+        lastBackgroundDrawCalls = 0; // Draws into the cache don't hit the window
+        drawCachedTexture(*renderTarget, *composite.texture, viewTopLeft, view.getSize());
+        return;
+    }
+    
+    // Camera moving: static base plus one repeated quad per scrolling layer
+    composite.lastViewCenter = viewCenter;
+    composite.valid = false;
+    drawBackgroundStack(*renderTarget, view);
+    
+    if (frameLoggingEnabled) {
+        RENDER_LOG(Debug, "Rendered {} background draws with parallax", lastBackgroundDrawCalls);
+    }
+}
+
+bool RenderingSystem::ensureBackgroundComposite(BackgroundComposite& composite) {
+    if (composite.texture || composite.unavailable) {
+        return composite.texture != nullptr;
+    }
+    const sf::Vector2u size(static_cast<unsigned>(std::ceil(cachedBackgroundViewSize.x)),
+                            static_cast<unsigned>(std::ceil(cachedBackgroundViewSize.y)));
+    composite.texture = std::make_unique<sf::RenderTexture>();
+    if (!composite.texture->resize(size)) {
+        composite.texture.reset();
+        composite.unavailable = true; // Not retried until the cache is rebuilt
+        return false;
+    }
+    return true;
+}
+
+void RenderingSystem::rebuildBackgroundCache(const sf::Vector2f& viewSize) {
+    backgroundCacheDirty = false;
+    cachedBackgroundViewSize = viewSize;
+    backgroundCache.assign(backgroundLayers.size(), BackgroundLayerCache());
+    staticLayerCount = 0;
+    bool staticRun = true;
+    
+    for (size_t i = 0; i < backgroundLayers.size(); ++i) {
+        const BackgroundLayer& layer = backgroundLayers[i];
+        BackgroundLayerCache& cache = backgroundCache[i];
+        if (!layer.isLoaded || (!layer.sprite && !layer.tiled) || layer.textureSize.x == 0 || layer.textureSize.y == 0) {
+            continue;
+        }
         
-        // Calculate uniform scale to maintain aspect ratio
+        // Uniform scale that fills the view completely (keeps aspect ratio); a
+        // tiled layer fills its height and scrolls along its width
         float scaleX = viewSize.x / layer.textureSize.x;
         float scaleY = viewSize.y / layer.textureSize.y;
+        cache.scale = layer.tiled ? scaleY : std::max(scaleX, scaleY);
+        cache.scaledSize = sf::Vector2f(layer.textureSize.x * cache.scale, layer.textureSize.y * cache.scale);
         
-        // Choose scaling strategy based on layer type
-        float uniformScale;
-        if (layer.name == "background1") {
-            // Background1 should completely fill the screen
-            uniformScale = std::max(scaleX, scaleY);
-        } else {
-            // Other layers can use different strategies
-            uniformScale = std::max(scaleX, scaleY); // Fill screen completely
-        }
+        // background4 is aligned with the ground platforms rather than the view top
+        cache.alignToGround = layer.name == "background4";
         
-        // Apply uniform scaling
-        layer.sprite->setScale(sf::Vector2f(uniformScale, uniformScale));
+        // Untiled layers with no parallax never move on screen
+        cache.screenFixed = !layer.tiled && !layer.tileHorizontally && layer.parallaxSpeed == 0.0f;
         
-        // Calculate scaled texture dimensions
-        float scaledWidth = layer.textureSize.x * uniformScale;
-        float scaledHeight = layer.textureSize.y * uniformScale;
+        // Leading screen-fixed layers are baked into one texture
+        if (staticRun && cache.screenFixed) {
+            staticLayerCount = i + 1;
+        } else {
+            staticRun = false;
+        }
+    }
+    
+    // Targets are view-sized; if render textures aren't available we draw directly
+    const sf::Vector2u targetSize(static_cast<unsigned>(std::ceil(viewSize.x)), static_cast<unsigned>(std::ceil(viewSize.y)));
+    
+    staticBackground.reset();
+    if (staticLayerCount > 0) {
+        auto target = std::make_unique<sf::RenderTexture>();
+        if (target->resize(targetSize)) {
+            // Screen-fixed layers sit at the view's top-left, so render them with a view at the origin
+            sf::View screenView(sf::FloatRect(sf::Vector2f(0.f, 0.f), viewSize));
+            target->setView(screenView);
+            target->clear(sf::Color::Transparent);
+            for (size_t i = 0; i < staticLayerCount; ++i) {
+                drawBackgroundLayer(*target, i, screenView);
+            }
+            target->display();
+            staticBackground = std::move(target);
+        }
+    }
+    
+    // Composites are the new size; each view makes its own when its camera next settles
+    for (BackgroundComposite& composite : backgroundComposites) {
+        composite = BackgroundComposite();
+    }
+    
+    logInfo("Background cache rebuilt: " + std::to_string(staticLayerCount) + " static layers baked, " +
+            std::to_string(backgroundLayers.size() - staticLayerCount) + " drawn as repeated quads");
+}
+
+void RenderingSystem::drawBackgroundStack(sf::RenderTarget& target, const sf::View& view) {
+    size_t first = 0;
+    if (staticBackground) {
+        drawCachedTexture(target, *staticBackground, view.getCenter() - view.getSize() / 2.0f, view.getSize());
+        first = staticLayerCount;
+    }
+    
+    // Draw layers from back to front (background1 -> background2 -> background3 -> background4)
+    for (size_t i = first; i < backgroundLayers.size() && i < backgroundCache.size(); ++i) {
+        drawBackgroundLayer(target, i, view);
+    }
+}
+
+void RenderingSystem::setBackgroundLayerLimit(size_t limit) {
+    if (limit == backgroundLayerLimit) return;
+    backgroundLayerLimit = limit;
+    backgroundCacheDirty = true; // Baked layers and composites hold the old set
+}
+
+bool RenderingSystem::isBackgroundLayerDrawn(size_t index) const {
+    const size_t count = backgroundLayers.size();
+    if (backgroundLayerLimit == 0 || backgroundLayerLimit >= count) return true;
+    return index == 0 || index >= count - (backgroundLayerLimit - 1);
+}
+
+void RenderingSystem::drawBackgroundLayer(sf::RenderTarget& target, size_t index, const sf::View& view) {
+    const BackgroundLayer& layer = backgroundLayers[index];
+    const BackgroundLayerCache& cache = backgroundCache[index];
+    if (!layer.isLoaded || (!layer.sprite && !layer.tiled) || cache.scale <= 0.0f || !isBackgroundLayerDrawn(index)) return;
+    if (layer.tiled) {
+        drawTiledBackgroundLayer(target, index, view);
+        return;
+    }
+    
+    sf::Vector2f viewCenter = view.getCenter();
+    sf::Vector2f viewSize = view.getSize();
+    float leftX = viewCenter.x - viewSize.x / 2.0f;
+    float rightX = viewCenter.x + viewSize.x / 2.0f;
+    float topY = viewCenter.y - viewSize.y / 2.0f;
+    float bottomY = viewCenter.y + viewSize.y / 2.0f;
+    
+    // Calculate parallax offset
+    // For parallax, we want layers to move slower than the camera
+    // A speed of 0.0 means static (no movement), 1.0 means moves with camera
+    float parallaxOffsetX = (viewCenter.x - WINDOW_WIDTH / 2.0f) * layer.parallaxSpeed;
+    float parallaxOffsetY = (viewCenter.y - WINDOW_HEIGHT / 2.0f) * layer.parallaxSpeed;
+    
+    // Quad corners in world space and matching texture coordinates. Tiled axes span the
+    // whole view; 'scroll' is their parallax shift in texture pixels, added to the
+    // coordinates here or applied per pixel by the parallax shader.
+    float x0, x1, y0, y1, u0, u1, v0, v1;
+    const sf::Vector2f textureSize(layer.textureSize);
+    sf::Vector2f scroll;
+    sf::Vector2f wrap;
+    
+    if (layer.tileHorizontally) {
+        x0 = leftX;
+        x1 = rightX;
+        u0 = leftX / cache.scale;
+        u1 = rightX / cache.scale;
+        scroll.x = parallaxOffsetX / cache.scale;
+        wrap.x = 1.0f;
         
-        if (layer.tileHorizontally) {
-            // Calculate starting positions for tiling
-            float startX = std::floor((leftX + parallaxOffsetX) / scaledWidth) * scaledWidth - parallaxOffsetX;
-            float startY;
-            
-            // Special positioning for background4 layer to align with actual ground platforms
-            if (layer.name == "background4") {
-                // Position background4 layer to align with the actual ground platforms
-                // The ground platforms are positioned at WINDOW_HEIGHT - GROUND_HEIGHT (y=540)
-                float groundLevel = WINDOW_HEIGHT - GROUND_HEIGHT; // This is where the platforms are (y=540)
-                
-                // Position the background4 texture to cover the ground platforms area
-                // We want the background4 texture to be positioned so it covers the platform area
-                // The platforms are 60px high starting at y=540, so we need to cover y=540 to y=600
-                startY = groundLevel - (scaledHeight * 0.8f); // Start 80% of texture height above ground level to ensure coverage
-                
-                // Apply parallax effect for background4 layer (it should move with camera)
-                startY += parallaxOffsetY;
-            } else {
-                // Normal positioning for other layers
-                startY = layer.tileVertically ? 
-                        std::floor((topY + parallaxOffsetY) / scaledHeight) * scaledHeight - parallaxOffsetY :
-                        topY + parallaxOffsetY;
+        if (cache.alignToGround) {
+            // Cover the ground platforms: start 80% of the texture height above ground level
+            float groundLevel = WINDOW_HEIGHT - GROUND_HEIGHT;
+            y0 = groundLevel - (cache.scaledSize.y * 0.8f) + parallaxOffsetY;
+            y1 = y0 + cache.scaledSize.y;
+            v0 = 0.0f;
+            v1 = textureSize.y;
+        } else if (layer.tileVertically) {
+            y0 = topY;
+            y1 = bottomY;
+            v0 = topY / cache.scale;
+            v1 = bottomY / cache.scale;
+            scroll.y = parallaxOffsetY / cache.scale;
+            wrap.y = 1.0f;
+        } else {
+            y0 = topY + parallaxOffsetY;
+            y1 = y0 + cache.scaledSize.y;
+            v0 = 0.0f;
+            v1 = textureSize.y;
+        }
+    } else {
+        // Single image, positioned with parallax
+        x0 = leftX + parallaxOffsetX;
+        y0 = topY + parallaxOffsetY;
+        x1 = x0 + cache.scaledSize.x;
+        y1 = y0 + cache.scaledSize.y;
+        u0 = 0.0f;
+        v0 = 0.0f;
+        u1 = textureSize.x;
+        v1 = textureSize.y;
+    }
+    
+    sf::RenderStates states;
+    states.texture = &layer.sprite->getTexture();
+    if (areShadersActive() && layer.tileHorizontally) {
+        // Shader wraps with fract(), so the texture's repeat mode doesn't matter
+        parallaxShader.setUniform("offset", sf::Glsl::Vec2(scroll.x / textureSize.x, scroll.y / textureSize.y));
+        parallaxShader.setUniform("wrap", sf::Glsl::Vec2(wrap));
+        states.shader = &parallaxShader;
+    } else {
+        u0 += scroll.x;
+        u1 += scroll.x;
+        v0 += scroll.y;
+        v1 += scroll.y;
+    }
+    
+    const sf::Vertex quad[4] = {
+        sf::Vertex{sf::Vector2f(x0, y0), sf::Color::White, sf::Vector2f(u0, v0)},
+        sf::Vertex{sf::Vector2f(x1, y0), sf::Color::White, sf::Vector2f(u1, v0)},
+        sf::Vertex{sf::Vector2f(x0, y1), sf::Color::White, sf::Vector2f(u0, v1)},
+        sf::Vertex{sf::Vector2f(x1, y1), sf::Color::White, sf::Vector2f(u1, v1)}
+    };
+    
+    submit(target, quad, 4, sf::PrimitiveType::TriangleStrip, RenderCategory::Background, states);
+    lastBackgroundDrawCalls++;
+}
+
+// Placed as a horizontally repeating layer is, without the repeat: source x is
+// (world x + parallax offset) / scale, and the image hangs from the view's top.
+// The preview covers the visible span in one quad wherever a tile is missing;
+// each resident tile is drawn over it.
+void RenderingSystem::drawTiledBackgroundLayer(sf::RenderTarget& target, size_t index, const sf::View& view) {
+    const BackgroundLayer& layer = backgroundLayers[index];
+    const BackgroundLayerCache& cache = backgroundCache[index];
+    TiledBackground& tiled = *layer.tiled;
+    const TileLayout& layout = tiled.getLayout();
+    
+    const sf::Vector2f viewCenter = view.getCenter();
+    const sf::Vector2f viewSize = view.getSize();
+    const float leftX = viewCenter.x - viewSize.x / 2.0f;
+    const float topY = viewCenter.y - viewSize.y / 2.0f;
+    const float parallaxOffsetX = (viewCenter.x - WINDOW_WIDTH / 2.0f) * layer.parallaxSpeed;
+    const float parallaxOffsetY = (viewCenter.y - WINDOW_HEIGHT / 2.0f) * layer.parallaxSpeed;
+    const sf::Vector2f origin(-parallaxOffsetX, topY + parallaxOffsetY); // World position of source pixel (0, 0)
+    
+    // The visible part of the source, then the tiles it touches
+    const sf::Vector2f sourceSize(layout.size);
+    const float sourceLeft = std::max((leftX - origin.x) / cache.scale, 0.0f);
+    const float sourceRight = std::min((leftX + viewSize.x - origin.x) / cache.scale, sourceSize.x);
+    const float sourceTop = std::max((topY - origin.y) / cache.scale, 0.0f);
+    const float sourceBottom = std::min((topY + viewSize.y - origin.y) / cache.scale, sourceSize.y);
+    if (sourceLeft >= sourceRight || sourceTop >= sourceBottom) return;
+    const float tileSize = static_cast<float>(layout.tileSize);
+    const int firstColumn = static_cast<int>(sourceLeft / tileSize);
+    const int lastColumn = std::min(static_cast<int>(sourceRight / tileSize), static_cast<int>(layout.columns) - 1);
+    const int firstRow = static_cast<int>(sourceTop / tileSize);
+    const int lastRow = std::min(static_cast<int>(sourceBottom / tileSize), static_cast<int>(layout.rows) - 1);
+    tiled.markVisible(sf::IntRect(sf::Vector2i(firstColumn, firstRow),
+                                  sf::Vector2i(lastColumn - firstColumn + 1, lastRow - firstRow + 1)));
+    
+    auto drawQuad = [&](const sf::Texture& texture, const sf::FloatRect& source, const sf::Vector2f& uvScale,
+                        const sf::Vector2f& uvOrigin) {
+        const float x0 = origin.x + source.position.x * cache.scale;
+        const float y0 = origin.y + source.position.y * cache.scale;
+        const float x1 = x0 + source.size.x * cache.scale;
+        const float y1 = y0 + source.size.y * cache.scale;
+        const float u0 = (source.position.x - uvOrigin.x) * uvScale.x;
+        const float v0 = (source.position.y - uvOrigin.y) * uvScale.y;
+        const float u1 = u0 + source.size.x * uvScale.x;
+        const float v1 = v0 + source.size.y * uvScale.y;
+        const sf::Vertex quad[4] = {
+            sf::Vertex{sf::Vector2f(x0, y0), sf::Color::White, sf::Vector2f(u0, v0)},
+            sf::Vertex{sf::Vector2f(x1, y0), sf::Color::White, sf::Vector2f(u1, v0)},
+            sf::Vertex{sf::Vector2f(x0, y1), sf::Color::White, sf::Vector2f(u0, v1)},
+            sf::Vertex{sf::Vector2f(x1, y1), sf::Color::White, sf::Vector2f(u1, v1)}
+        };
+        sf::RenderStates states;
+        states.texture = &texture;
+        submit(target, quad, 4, sf::PrimitiveType::TriangleStrip, RenderCategory::Background, states);
+        lastBackgroundDrawCalls++;
+    };
+    
+    bool complete = true;
+    for (int row = firstRow; row <= lastRow && complete; ++row) {
+        for (int column = firstColumn; column <= lastColumn && complete; ++column) {
+            complete = tiled.getTile(static_cast<unsigned>(column), static_cast<unsigned>(row)) != nullptr;
+        }
+    }
+    if (!complete) {
+        // The preview may have been resampled on load; its own size maps the source onto it
+        const sf::Texture& preview = tiled.getPreview();
+        const sf::Vector2f previewScale(preview.getSize().x / sourceSize.x, preview.getSize().y / sourceSize.y);
+        drawQuad(preview, sf::FloatRect(sf::Vector2f(sourceLeft, sourceTop),
+                                        sf::Vector2f(sourceRight - sourceLeft, sourceBottom - sourceTop)),
+                 previewScale, sf::Vector2f());
+    }
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            const sf::Texture* texture = tiled.getTile(static_cast<unsigned>(column), static_cast<unsigned>(row));
+            if (!texture) continue;
+            const sf::IntRect rect = layout.getTileRect(static_cast<unsigned>(column), static_cast<unsigned>(row));
+            const sf::FloatRect source(sf::Vector2f(rect.position), sf::Vector2f(rect.size));
+            drawQuad(*texture, source,
+                     sf::Vector2f(texture->getSize().x / source.size.x, texture->getSize().y / source.size.y),
+                     source.position);
+        }
+    }
+}
+
+void RenderingSystem::invalidateBackgroundComposites() {
+    for (BackgroundComposite& composite : backgroundComposites) {
+        composite.valid = false;
+    }
+}
+
+void RenderingSystem::drawCachedTexture(sf::RenderTarget& target, const sf::RenderTexture& cache,
+                                        const sf::Vector2f& position, const sf::Vector2f& size) {
+    sf::Sprite sprite(cache.getTexture());
+    sprite.setPosition(position);
+    sprite.setScale(sf::Vector2f(size.x / cache.getSize().x, size.y / cache.getSize().y));
+    submit(target, sprite, RenderCategory::Background);
+    lastBackgroundDrawCalls++;
+}
+
+void RenderingSystem::initializeEffects() {
+    effectsInitialized = true;
+    if (!sf::Shader::isAvailable()) {
+        logWarning("Shaders not available; backgrounds use the CPU path");
+        return;
+    }
+    if (!parallaxShader.loadFromMemory(PARALLAX_FRAGMENT_SHADER, sf::Shader::Type::Fragment)) {
+        logWarning("Parallax shader failed to compile; backgrounds use the CPU path");
+        return;
+    }
+    parallaxShader.setUniform("texture", sf::Shader::CurrentTexture);
+    shadersAvailable = true;
+    logInfo("Parallax shader ready");
+    
+    // Either of these failing only loses its effect
+    tileShaderReady = tileShader.loadFromMemory(TILE_VERTEX_SHADER, TILE_FRAGMENT_SHADER);
+    if (tileShaderReady) {
+        tileShader.setUniform("texture", sf::Shader::CurrentTexture);
+    } else {
+        logWarning("Tile shader failed to compile; animated tiles show their first frame");
+    }
+    gradeShaderReady = gradeShader.loadFromMemory(GRADE_FRAGMENT_SHADER, sf::Shader::Type::Fragment);
+    if (gradeShaderReady) {
+        gradeShader.setUniform("texture", sf::Shader::CurrentTexture);
+    } else {
+        logWarning("Colour grading shader failed to compile; levels are shown ungraded");
+    }
+}
+
+size_t RenderingSystem::getAnimatedTileCount() const {
+    return static_cast<size_t>(std::count_if(tileAnimations.begin(), tileAnimations.end(),
+                                             [](const TileAnimation& animation) { return animation.frames > 1; }));
+}
+
+void RenderingSystem::setColorGrade(const sf::Texture* lut, const sf::Color& tint, float dayLength) {
+    gradeLut = lut;
+    gradeLutSize = 0.f;
+    if (lut) {
+        // N*N x N: N slices of N x N
+        const sf::Vector2u size = lut->getSize();
+        if (size.y >= 2 && size.x == size.y * size.y) {
+            gradeLutSize = static_cast<float>(size.y);
+        } else {
+            logWarning("Colour grading LUT is " + std::to_string(size.x) + "x" + std::to_string(size.y) +
+                       ", not N*N x N; only the tint applies");
+        }
+    }
+    gradeTint = tint;
+    gradeDayLength = dayLength;
+}
+
+bool RenderingSystem::isColorGradeActive() const {
+    return areShadersActive() && gradeShaderReady && (gradeLutSize > 0.f || gradeTint != sf::Color::White);
+}
+
+void RenderingSystem::setLights(const std::vector<LevelData::Light>& levelLights, const sf::Color& ambient) {
+    lights = levelLights;
+    ambientLight = ambient;
+    lightGrid.clear();
+    maxLightRadius = 0.f;
+    for (size_t i = 0; i < lights.size(); ++i) {
+        lightGrid.insert(static_cast<uint32_t>(i), lights[i].position);
+        maxLightRadius = std::max(maxLightRadius, lights[i].radius);
+    }
+}
+
+bool RenderingSystem::ensureLightmap(const sf::Vector2u& size) {
+    if (lightingUnavailable) {
+        return false;
+    }
+    if (lightFalloff.getSize().x == 0) {
+        // Smooth (1 - d^2)^2 falloff; the lightmap's own filtering blurs what's left
+        constexpr unsigned FALLOFF_SIZE = 64;
+        sf::Image falloff(sf::Vector2u(FALLOFF_SIZE, FALLOFF_SIZE), sf::Color::Black);
+        const float centre = (FALLOFF_SIZE - 1) / 2.f;
+        for (unsigned y = 0; y < FALLOFF_SIZE; ++y) {
+            for (unsigned x = 0; x < FALLOFF_SIZE; ++x) {
+                const float dx = (x - centre) / centre;
+                const float dy = (y - centre) / centre;
+                const float falloffSquared = std::max(0.f, 1.f - (dx * dx + dy * dy));
+                const auto level = static_cast<uint8_t>(255.f * falloffSquared * falloffSquared);
+                falloff.setPixel(sf::Vector2u(x, y), sf::Color(level, level, level));
             }
-            
-            // Draw tiles
-            if (layer.tileVertically) {
-                // Tile both horizontally and vertically
-                for (float y = startY; y < bottomY + scaledHeight; y += scaledHeight) {
-                    for (float x = startX; x < rightX + scaledWidth; x += scaledWidth) {
-                        layer.sprite->setPosition(sf::Vector2f(x, y));
-                        renderTarget->draw(*layer.sprite);
-                    }
-                }
-            } else {
-                // Tile only horizontally
-                for (float x = startX; x < rightX + scaledWidth; x += scaledWidth) {
-                    layer.sprite->setPosition(sf::Vector2f(x, startY));
-                    renderTarget->draw(*layer.sprite);
+        }
+        if (!lightFalloff.loadFromImage(falloff)) {
+            logWarning("Light texture unavailable; lighting off");
+            lightingUnavailable = true;
+            return false;
+        }
+        lightFalloff.setSmooth(true);
+    }
+    if (!lightmap || lightmap->getSize() != size) {
+        lightmap = std::make_unique<sf::RenderTexture>();
+        if (!lightmap->resize(size)) {
+            logWarning("Lightmap unavailable; lighting off");
+            lightmap.reset();
+            lightingUnavailable = true;
+            return false;
+        }
+        lightmap->setSmooth(true); // Bilinear upscaling hides the low resolution
+    }
+    return true;
+}
+
+void RenderingSystem::renderLighting(sf::RenderTarget& target, bool firstView) {
+    PROFILE_ZONE("RenderingSystem::renderLighting");
+    if (firstView) {
+        lightStats = LightStats();
+    }
+    if (!isLightingEnabled()) {
+        return;
+    }
+    const sf::View& view = target.getView();
+    const sf::IntRect viewport = target.getViewport(view);
+    const sf::Vector2u size(std::max(1u, (static_cast<unsigned>(viewport.size.x) + LIGHTMAP_DIVISOR - 1) / LIGHTMAP_DIVISOR),
+                            std::max(1u, (static_cast<unsigned>(viewport.size.y) + LIGHTMAP_DIVISOR - 1) / LIGHTMAP_DIVISOR));
+    if (!ensureLightmap(size)) {
+        return;
+    }
+    
+    // Candidates from the cells the view grown by the largest radius touches, then an exact circle test
+    const sf::FloatRect viewBounds = ViewCulling::getViewBounds(view);
+    const sf::Vector2f reach(maxLightRadius, maxLightRadius);
+    visibleLights.clear();
+    lightGrid.forEachCandidate(sf::FloatRect(viewBounds.position - reach, viewBounds.size + reach * 2.f),
+                               [&](uint32_t index) {
+        const LevelData::Light& light = lights[index];
+        const float nearestX = std::clamp(light.position.x, viewBounds.position.x,
+                                          viewBounds.position.x + viewBounds.size.x);
+        const float nearestY = std::clamp(light.position.y, viewBounds.position.y,
+                                          viewBounds.position.y + viewBounds.size.y);
+        const sf::Vector2f offset = light.position - sf::Vector2f(nearestX, nearestY);
+        if (offset.x * offset.x + offset.y * offset.y < light.radius * light.radius) {
+            visibleLights.push_back(index);
+        }
+    });
+    lightStats.culled += lights.size() - visibleLights.size();
+    const size_t budget = MAX_LIGHTS - std::min(MAX_LIGHTS, lightStats.drawn);
+    if (visibleLights.size() > budget) {
+        const sf::Vector2f centre = view.getCenter();
+        auto distanceSquared = [&](uint32_t index) {
+            const sf::Vector2f offset = lights[index].position - centre;
+            return offset.x * offset.x + offset.y * offset.y;
+        };
+        std::nth_element(visibleLights.begin(), visibleLights.begin() + static_cast<std::ptrdiff_t>(budget),
+                         visibleLights.end(),
+                         [&](uint32_t a, uint32_t b) { return distanceSquared(a) < distanceSquared(b); });
+        lightStats.overBudget += visibleLights.size() - budget;
+        visibleLights.resize(budget);
+    }
+    lightStats.drawn += visibleLights.size();
+    
+    const sf::Vector2f texture(lightFalloff.getSize());
+    lightVertices.clear();
+    for (uint32_t index : visibleLights) {
+        const LevelData::Light& light = lights[index];
+        const sf::Vector2f min = light.position - sf::Vector2f(light.radius, light.radius);
+        const sf::Vector2f max = light.position + sf::Vector2f(light.radius, light.radius);
+        lightVertices.push_back(sf::Vertex{min, light.color, {0.f, 0.f}});
+        lightVertices.push_back(sf::Vertex{{max.x, min.y}, light.color, {texture.x, 0.f}});
+        lightVertices.push_back(sf::Vertex{{min.x, max.y}, light.color, {0.f, texture.y}});
+        lightVertices.push_back(sf::Vertex{{min.x, max.y}, light.color, {0.f, texture.y}});
+        lightVertices.push_back(sf::Vertex{{max.x, min.y}, light.color, {texture.x, 0.f}});
+        lightVertices.push_back(sf::Vertex{max, light.color, texture});
+    }
+    
+    // The same world rectangle as the view, over the whole lightmap
+    sf::View lightView(view.getCenter(), view.getSize());
+    lightView.setRotation(view.getRotation());
+    lightmap->setView(lightView);
+    lightmap->clear(ambientLight);
+    if (!lightVertices.empty()) {
+        sf::RenderStates states(sf::BlendAdd);
+        states.texture = &lightFalloff;
+        submit(*lightmap, lightVertices.data(), lightVertices.size(), sf::PrimitiveType::Triangles,
+               RenderCategory::Lighting, states);
+    }
+    lightmap->display();
+    
+    sf::Sprite composite(lightmap->getTexture());
+    composite.setOrigin(sf::Vector2f(size) / 2.f);
+    composite.setPosition(view.getCenter());
+    composite.setScale(sf::Vector2f(view.getSize().x / size.x, view.getSize().y / size.y));
+    composite.setRotation(view.getRotation());
+    submit(target, composite, RenderCategory::Lighting, sf::RenderStates(sf::BlendMultiply));
+}
+
+void RenderingSystem::setUseShaders(bool use) {
+    useShaders = use;
+    backgroundCacheDirty = true; // Baked layers and the composite were drawn the other way
+}
+
+void RenderingSystem::renderParticles() {
+    if (!renderTarget) return;
+    particles.draw(*renderTarget, renderStats, useShaders);
+}
+
+void RenderingSystem::renderSnapshot(sf::RenderWindow& window, const RenderSnapshot& snapshot) {
+    PROFILE_ZONE("RenderingSystem::renderSnapshot");
+    // Without any world recorded (CachedScene) the kept texture is left alone
+    const bool recordsWorld = snapshot.getCommands().empty() ||
+        snapshot.getCommands().front().kind != RenderSnapshot::Kind::Pass ||
+        snapshot.getCommands().front().pass != RenderSnapshot::Pass::CachedScene;
+    sf::RenderTarget* target = recordsWorld ? &beginScene(window, snapshot) : &window;
+    setRenderTarget(target);
+    for (const RenderSnapshot::Command& command : snapshot.getCommands()) {
+        // Clears and view changes stay in whichever GPU span is running
+        if (command.kind == RenderSnapshot::Kind::Pass) {
+            gpuTimer.begin(gpuPassFor(command.pass));
+        } else if (command.kind != RenderSnapshot::Kind::Clear && command.kind != RenderSnapshot::Kind::View) {
+            gpuTimer.begin(gpuPassFor(command.category));
+        }
+        switch (command.kind) {
+            case RenderSnapshot::Kind::Clear:
+                target->clear(snapshot.getClearColor());
+                break;
+            case RenderSnapshot::Kind::View:
+                target->setView(snapshot.getView(command.index));
+                break;
+            case RenderSnapshot::Kind::Pass:
+                switch (command.pass) {
+                    case RenderSnapshot::Pass::Background: renderBackgroundLayers(command.index); break;
+                    case RenderSnapshot::Pass::Particles: renderParticles(); break;
+                    case RenderSnapshot::Pass::DebugGrid: renderDebugGrid(); break;
+                    case RenderSnapshot::Pass::Decorations: renderDecorationCache(*target, command.index == 0); break;
+                    case RenderSnapshot::Pass::Platforms: renderPlatformCache(*target, command.index == 0); break;
+                    case RenderSnapshot::Pass::Lighting: renderLighting(*target, command.index == 0); break;
+                    case RenderSnapshot::Pass::PresentScene:
+                        if (target != &window) {
+                            presentScene(window, true);
+                            target = &window;
+                            setRenderTarget(target);
+                        }
+                        break;
+                    case RenderSnapshot::Pass::CachedScene:
+                        if (sceneTarget) {
+                            presentScene(window, false);
+                        } else {
+                            window.clear(sf::Color::Black);
+                        }
+                        break;
                 }
-            }
-        } else {
-            // Single image, positioned with parallax
-            layer.sprite->setPosition(sf::Vector2f(
-                leftX + parallaxOffsetX,
-                topY + parallaxOffsetY
-            ));
-            renderTarget->draw(*layer.sprite);
+                break;
+            case RenderSnapshot::Kind::Vertices:
+                submit(*target, snapshot.getVertices(command.index), command.count, command.primitive, command.category,
+                       command.states);
+                break;
+            case RenderSnapshot::Kind::Sprite:
+                submit(*target, snapshot.getSprite(command.index), command.category, command.states);
+                break;
+            case RenderSnapshot::Kind::Rectangle:
+                submit(*target, snapshot.getRectangle(command.index), command.category, command.states);
+                break;
+            case RenderSnapshot::Kind::Circle:
+                submit(*target, snapshot.getCircle(command.index), command.category, command.states);
+                break;
+            case RenderSnapshot::Kind::Text:
+                submit(*target, snapshot.getText(command.index), command.category, command.states);
+                break;
         }
-        
-        layersRendered++;
+    }
+    if (target != &window) {
+        gpuTimer.begin(GpuTimer::Pass::Present);
+        presentScene(window, true); // Snapshot without UI
+        setRenderTarget(&window);
+    }
+    for (size_t category = 0; category < RenderStats::CATEGORY_COUNT; ++category) {
+        const size_t culled = snapshot.getCulled(static_cast<RenderCategory>(category));
+        if (culled > 0) {
+            renderStats.countCulled(static_cast<RenderCategory>(category), culled);
+        }
+    }
+}
+
+size_t RenderingSystem::measureRenderTargets() const {
+    auto bytes = [](const std::unique_ptr<sf::RenderTexture>& texture) -> size_t {
+        if (!texture) {
+            return 0;
+        }
+        const sf::Vector2u size = texture->getSize();
+        return static_cast<size_t>(size.x) * size.y * 4;
+    };
+    size_t total = bytes(staticBackground) + bytes(sceneTarget) + bytes(lightmap);
+    for (const BackgroundComposite& composite : backgroundComposites) {
+        total += bytes(composite.texture);
+    }
+    return total;
+}
+
+sf::RenderTarget& RenderingSystem::beginScene(sf::RenderWindow& window, const RenderSnapshot& snapshot) {
+    // A kept or graded world is rendered at window resolution unless a render scale is set
+    const bool scaled = sceneResolution.x > 0 && sceneResolution.y > 0;
+    if (!scaled && !snapshot.isSceneKept() && !isColorGradeActive()) {
+        sceneTarget.reset();
+        lastSceneUpscale = 0.f;
+        return window;
+    }
+    const sf::Vector2u size = scaled ? sceneResolution : window.getSize();
+    if (!sceneTarget || sceneTarget->getSize() != size) {
+        sceneTarget = std::make_unique<sf::RenderTexture>();
+        if (!sceneTarget->resize(size)) {
+            logWarning("Scene target unavailable; rendering at window resolution");
+            sceneTarget.reset();
+            sceneResolution = sf::Vector2u();
+            return window;
+        }
+        sceneTarget->setSmooth(false); // Nearest filtering keeps pixel art sharp
+        logInfo("Scene target " + std::to_string(size.x) + "x" + std::to_string(size.y));
+    }
+    return *sceneTarget;
+}
+
+void RenderingSystem::presentScene(sf::RenderWindow& window, bool rendered) {
+    PROFILE_ZONE("RenderingSystem::presentScene");
+    if (rendered) {
+        sceneTarget->display();
     }
     
-    logDebug("Rendered " + std::to_string(layersRendered) + " background layers with parallax");
+    // Largest whole factor that fits; a window smaller than the scene shrinks it to fit
+    const sf::Vector2f windowSize(window.getSize());
+    const sf::Vector2f sceneSize(sceneTarget->getSize());
+    const float fit = std::min(windowSize.x / sceneSize.x, windowSize.y / sceneSize.y);
+    const float scale = fit >= 1.f ? std::floor(fit) : fit;
+    lastSceneUpscale = sceneResolution.x > 0 ? scale : 0.f;
+    
+    window.setView(sf::View(sf::FloatRect(sf::Vector2f(), windowSize)));
+    window.clear(sf::Color::Black);
+    sf::Sprite scene(sceneTarget->getTexture());
+    scene.setScale(sf::Vector2f(scale, scale));
+    scene.setPosition(sf::Vector2f(std::floor((windowSize.x - sceneSize.x * scale) / 2.f),
+                                   std::floor((windowSize.y - sceneSize.y * scale) / 2.f)));
+    sf::RenderStates states;
+    if (isColorGradeActive()) {
+        // The tint's share of the day: none at the start of the cycle, all of it halfway
+        float amount = 1.f;
+        if (gradeDayLength > 0.f) {
+            const float phase = std::fmod(effectsClock.getElapsedTime().asSeconds(), gradeDayLength) / gradeDayLength;
+            amount = 0.5f - 0.5f * std::cos(phase * 2.f * 3.14159265f);
+        }
+        const sf::Glsl::Vec4 tint(gradeTint);
+        gradeShader.setUniform("tint", sf::Glsl::Vec3(1.f + (tint.x - 1.f) * amount, 1.f + (tint.y - 1.f) * amount,
+                                                      1.f + (tint.z - 1.f) * amount));
+        gradeShader.setUniform("lutSize", gradeLutSize);
+        if (gradeLutSize > 0.f) {
+            gradeShader.setUniform("lut", *gradeLut);
+        }
+        states.shader = &gradeShader;
+    }
+    submit(window, scene, RenderCategory::Background, states);
 }
 
 void RenderingSystem::setBackgroundLayers(std::vector<BackgroundLayer>&& layers) {
     backgroundLayers = std::move(layers);
+    backgroundCacheDirty = true;
     logInfo("Background layers updated, count: " + std::to_string(backgroundLayers.size()));
 }
 
@@ -218,24 +968,256 @@ void RenderingSystem::setBackgroundLayersRef(const std::vector<BackgroundLayer>&
         if (layer.sprite && layer.isLoaded) {
             newLayer.sprite = std::make_unique<sf::Sprite>(*layer.sprite);
         }
+        newLayer.tiled = layer.tiled;
         
         backgroundLayers.push_back(std::move(newLayer));
     }
     
+    backgroundCacheDirty = true;
     logInfo("Background layers copied from reference, count: " + std::to_string(backgroundLayers.size()));
 }
 
-void RenderingSystem::renderPlatforms(sf::RenderWindow& window, const std::vector<sf::RectangleShape>& platforms, bool randomize) {
-    for (const auto& platform : platforms) {
-        // Check if this is the ground platform (positioned at the bottom of the window)
-        if (platform.getPosition().y >= WINDOW_HEIGHT - GROUND_HEIGHT) {
-            // Render ground platform with ground tiles
-            renderGround(window, platform, randomize);
-        } else {
-            // Render elevated platform with edge tiles
-            renderPlat(window, platform, randomize);
+void RenderingSystem::renderPlatforms(sf::RenderWindow& window, const LevelGeometry& platforms, bool randomize) {
+    PROFILE_ZONE("RenderingSystem::renderPlatforms");
+    if (tileSprites.empty()) {
+        // Fallback to plain coloured boxes if no tiles loaded, all in one draw
+        lastPlatformDrawCalls = 0;
+        platformCullStats.reset();
+        platformVertexScratch.clear();
+        const sf::FloatRect viewBounds = ViewCulling::getViewBounds(window.getView());
+        for (size_t i = 0; i < platforms.size(); ++i) {
+            bool visible = ViewCulling::isVisible(platforms.getBounds(i), viewBounds);
+            platformCullStats.count(visible);
+            if (visible) {
+                platforms.appendQuad(i, platforms.getColor(i), platformVertexScratch);
+            }
+        }
+        if (!platformVertexScratch.empty()) {
+            submit(window, platformVertexScratch.data(), platformVertexScratch.size(), sf::PrimitiveType::Triangles,
+                   RenderCategory::Platforms);
+            lastPlatformDrawCalls++;
+        }
+        renderStats.countCulled(RenderCategory::Platforms, platformCullStats.culled);
+        return;
+    }
+    
+    preparePlatforms(platforms, randomize);
+    renderPlatformCache(window);
+}
+
+void RenderingSystem::preparePlatforms(const LevelGeometry& platforms, bool randomize) {
+    // Shaders coming up (or being toggled) change how animated tiles are baked
+    const bool animate = areTilesAnimated();
+    if (platformCacheDirty || randomize != cachedRandomize || platforms.size() != cachedPlatformBounds.size() ||
+        animate != platformsAnimated) {
+        platformsAnimated = animate;
+        buildPlatformCache(platforms, randomize);
+    }
+}
+
+void RenderingSystem::renderPlatformCache(sf::RenderTarget& target, bool firstView) {
+    PROFILE_ZONE("RenderingSystem::renderPlatformCache");
+    if (firstView) {
+        lastPlatformDrawCalls = 0;
+        platformCullStats.reset();
+    }
+    const size_t culledBefore = platformCullStats.culled;
+    const sf::FloatRect viewBounds = ViewCulling::getViewBounds(target.getView());
+    
+    // Draw only the chunks that overlap the current view (stats count chunks)
+    for (const auto& chunk : platformChunks) {
+        if (chunk.batches.empty()) {
+            continue;
+        }
+        bool visible = ViewCulling::isVisible(chunk.bounds, viewBounds);
+        platformCullStats.count(visible);
+        if (!visible) {
+            continue;
+        }
+        
+        for (const auto& batch : chunk.batches) {
+            drawTileBatch(target, batch, RenderCategory::Platforms);
+            lastPlatformDrawCalls++;
+        }
+    }
+    renderStats.countCulled(RenderCategory::Platforms, platformCullStats.culled - culledBefore);
+}
+
+void RenderingSystem::buildDecorationCache(const std::vector<LevelData::DecorationQuad>& quads) {
+    decorationQuads = quads;
+    rebuildDecorationCache();
+}
+
+struct RenderingSystem::DecorationCache {
+    std::vector<LevelData::DecorationQuad> quads;
+    std::vector<DecorationChunk> chunks;
+    float chunkOrigin = 0.0f;
+    uint32_t tileSetVersion = 0;
+    bool animated = false;
+    bool built = false;
+};
+
+std::shared_ptr<RenderingSystem::DecorationCache> RenderingSystem::takeDecorationCache() {
+    auto cache = std::make_shared<DecorationCache>();
+    cache->quads.swap(decorationQuads);
+    cache->chunks.swap(decorationChunks);
+    cache->chunkOrigin = decorationChunkOrigin;
+    cache->tileSetVersion = tileSetVersion;
+    cache->animated = decorationsAnimated;
+    cache->built = !decorationCacheDirty;
+    decorationCacheDirty = false;
+    return cache;
+}
+
+void RenderingSystem::restoreDecorationCache(std::shared_ptr<DecorationCache> cache) {
+    if (!cache) {
+        return;
+    }
+    decorationQuads.swap(cache->quads);
+    decorationChunks.swap(cache->chunks);
+    decorationChunkOrigin = cache->chunkOrigin;
+    decorationsAnimated = cache->animated;
+    decorationCacheDirty = !cache->built || cache->tileSetVersion != tileSetVersion;
+}
+
+void RenderingSystem::prepareDecorations() {
+    const bool animate = areTilesAnimated();
+    if (decorationCacheDirty || animate != decorationsAnimated) {
+        decorationsAnimated = animate;
+        rebuildDecorationCache();
+    }
+}
+
+void RenderingSystem::rebuildDecorationCache() {
+    decorationChunks.clear();
+    decorationCacheDirty = false;
+    if (decorationQuads.empty()) {
+        return;
+    }
+    
+    // Each quad belongs to the chunk holding its left edge, as platform tiles do
+    float minX = decorationQuads.front().bounds.position.x;
+    float maxX = minX;
+    for (const auto& quad : decorationQuads) {
+        minX = std::min(minX, quad.bounds.position.x);
+        maxX = std::max(maxX, quad.bounds.position.x);
+    }
+    decorationChunkOrigin = minX;
+    const size_t chunkCount = static_cast<size_t>(std::floor((maxX - minX) / PLATFORM_CHUNK_WIDTH)) + 1;
+    decorationChunks.resize(chunkCount);
+    
+    // Appended in the quads' order, so each array draws back to front
+    for (const auto& quad : decorationQuads) {
+        appendDecorationQuad(quad);
+    }
+    
+    logInfo("Built decoration cache: " + std::to_string(decorationQuads.size()) + " quads in " +
+            std::to_string(decorationChunks.size()) + " chunks");
+}
+
+size_t RenderingSystem::decorationChunkIndex(float x) const {
+    const float offset = std::max(x - decorationChunkOrigin, 0.0f);
+    return std::min(static_cast<size_t>(offset / PLATFORM_CHUNK_WIDTH), decorationChunks.size() - 1);
+}
+
+void RenderingSystem::appendDecorationQuad(const LevelData::DecorationQuad& quad) {
+    DecorationChunk& chunk = decorationChunks[decorationChunkIndex(quad.bounds.position.x)];
+    
+    const int tile = tileSprites.empty() ? -1
+        : decorationTiles[static_cast<size_t>(quad.kind)][static_cast<size_t>(quad.part)];
+    sf::VertexArray* vertices = &chunk.untextured;
+    sf::Color color = decorationColor(quad);
+    sf::Vector2f uvMin, uvMax;
+    if (tile >= 0) {
+        sf::FloatRect texture;
+        vertices = &getTileBatch(chunk.batches, tile, decorationsAnimated, texture, color).vertices;
+        uvMin = texture.position;
+        uvMax = uvMin + texture.size;
+    }
+    
+    // The tile is stretched over the quad's cell(s)
+    const sf::Vector2f topLeft = quad.bounds.position;
+    const sf::Vector2f topRight(topLeft.x + quad.bounds.size.x, topLeft.y);
+    const sf::Vector2f bottomLeft(topLeft.x, topLeft.y + quad.bounds.size.y);
+    const sf::Vector2f bottomRight = topLeft + quad.bounds.size;
+    vertices->append(sf::Vertex{topLeft, color, uvMin});
+    vertices->append(sf::Vertex{topRight, color, sf::Vector2f(uvMax.x, uvMin.y)});
+    vertices->append(sf::Vertex{bottomLeft, color, sf::Vector2f(uvMin.x, uvMax.y)});
+    vertices->append(sf::Vertex{bottomLeft, color, sf::Vector2f(uvMin.x, uvMax.y)});
+    vertices->append(sf::Vertex{topRight, color, sf::Vector2f(uvMax.x, uvMin.y)});
+    vertices->append(sf::Vertex{bottomRight, color, uvMax});
+    
+    if (chunk.bounds.size.x <= 0.0f && chunk.bounds.size.y <= 0.0f) {
+        chunk.bounds = quad.bounds;
+    } else {
+        const sf::Vector2f minCorner(std::min(chunk.bounds.position.x, topLeft.x),
+                                     std::min(chunk.bounds.position.y, topLeft.y));
+        const sf::Vector2f maxCorner(std::max(chunk.bounds.position.x + chunk.bounds.size.x, bottomRight.x),
+                                     std::max(chunk.bounds.position.y + chunk.bounds.size.y, bottomRight.y));
+        chunk.bounds = sf::FloatRect(minCorner, maxCorner - minCorner);
+    }
+}
+
+void RenderingSystem::updateDecorationCache(const std::vector<LevelData::DecorationQuad>& quads,
+                                            const sf::FloatRect& area) {
+    // A quad past either end of the chunked range changes the chunking: build it all
+    bool inRange = !decorationCacheDirty && !decorationChunks.empty() && !quads.empty();
+    float minX = inRange ? quads.front().bounds.position.x : 0.0f;
+    float maxX = minX;
+    for (const auto& quad : quads) {
+        minX = std::min(minX, quad.bounds.position.x);
+        maxX = std::max(maxX, quad.bounds.position.x);
+    }
+    inRange = inRange && minX == decorationChunkOrigin &&
+              static_cast<size_t>(std::floor((maxX - minX) / PLATFORM_CHUNK_WIDTH)) + 1 == decorationChunks.size();
+    if (!inRange) {
+        buildDecorationCache(quads);
+        return;
+    }
+    
+    // Only the chunks holding left edges inside 'area' (the old and new footprint) are rebaked
+    decorationQuads = quads;
+    const size_t first = decorationChunkIndex(area.position.x);
+    const size_t last = decorationChunkIndex(area.position.x + area.size.x);
+    for (size_t c = first; c <= last; ++c) {
+        decorationChunks[c] = DecorationChunk();
+    }
+    for (const auto& quad : decorationQuads) {
+        const size_t c = decorationChunkIndex(quad.bounds.position.x);
+        if (c >= first && c <= last) {
+            appendDecorationQuad(quad);
+        }
+    }
+    
+    RENDER_LOG(Debug, "Rebuilt {} of {} decoration chunks", last - first + 1, decorationChunks.size());
+}
+
+void RenderingSystem::renderDecorationCache(sf::RenderTarget& target, bool firstView) {
+    PROFILE_ZONE("RenderingSystem::renderDecorationCache");
+    if (firstView) {
+        decorationCullStats.reset();
+    }
+    const size_t culledBefore = decorationCullStats.culled;
+    const sf::FloatRect viewBounds = ViewCulling::getViewBounds(target.getView());
+    
+    // Flat-coloured quads go first; a set has tiles for all decorations or, usually, none
+    for (const auto& chunk : decorationChunks) {
+        if (chunk.batches.empty() && chunk.untextured.getVertexCount() == 0) {
+            continue;
+        }
+        bool visible = ViewCulling::isVisible(chunk.bounds, viewBounds);
+        decorationCullStats.count(visible);
+        if (!visible) {
+            continue;
+        }
+        if (chunk.untextured.getVertexCount() > 0) {
+            submit(target, chunk.untextured, RenderCategory::Decorations);
+        }
+        for (const auto& batch : chunk.batches) {
+            drawTileBatch(target, batch, RenderCategory::Decorations);
         }
     }
+    renderStats.countCulled(RenderCategory::Decorations, decorationCullStats.culled - culledBefore);
 }
 
 void RenderingSystem::renderPlayer(const Player& player) {
@@ -264,52 +1246,77 @@ void RenderingSystem::renderPlayer(const Player& player) {
             animatedSprite.setPosition(player.getPosition());
         }
         
-        renderTarget->draw(animatedSprite);
-        logDebug("Rendered player animated sprite at position (" + 
-                std::to_string(player.getPosition().x) + ", " + 
-                std::to_string(player.getPosition().y) + ")");
+        submit(*renderTarget, animatedSprite, RenderCategory::Player);
+        if (frameLoggingEnabled) {
+            RENDER_LOG(Debug, "Rendered player animated sprite at position ({}, {})",
+                       player.getPosition().x, player.getPosition().y);
+        }
     } else if (usePlayerPlaceholder) {
         // Fallback to placeholder
         playerPlaceholder.setPosition(player.getPosition());
-        renderTarget->draw(playerPlaceholder);
-        logDebug("Rendered player placeholder at position (" + 
-                std::to_string(player.getPosition().x) + ", " + 
-                std::to_string(player.getPosition().y) + ")");
+        submit(*renderTarget, playerPlaceholder, RenderCategory::Player);
+        if (frameLoggingEnabled) {
+            RENDER_LOG(Debug, "Rendered player placeholder at position ({}, {})",
+                       player.getPosition().x, player.getPosition().y);
+        }
     } else if (playerSprite) {
         // Fallback to static sprite
         playerSprite->setPosition(player.getPosition());
         playerSprite->setScale(sf::Vector2f(spriteScale, spriteScale));
-        renderTarget->draw(*playerSprite);
-        logDebug("Rendered player static sprite at position (" + 
-                std::to_string(player.getPosition().x) + ", " + 
-                std::to_string(player.getPosition().y) + ")");
+        submit(*renderTarget, *playerSprite, RenderCategory::Player);
+        if (frameLoggingEnabled) {
+            RENDER_LOG(Debug, "Rendered player static sprite at position ({}, {})",
+                       player.getPosition().x, player.getPosition().y);
+        }
     } else {
         logWarning("Player rendering failed: no animations, sprite, or placeholder available");
     }
 }
 
-void RenderingSystem::renderEnemies(const std::vector<Enemy>& enemies) {
+void RenderingSystem::renderEnemies(const EnemyStore& enemies) {
     if (!renderTarget) return;
     
     if (!showEnemies) {
-        logDebug("Enemy rendering skipped (showEnemies = false)");
+        if (frameLoggingEnabled) {
+            logDebug("Enemy rendering skipped (showEnemies = false)");
+        }
         return;
     }
     
     int enemiesRendered = 0;
-    for (const auto& enemy : enemies) {
+    const sf::FloatRect viewBounds = ViewCulling::getViewBounds(renderTarget->getView(), CULL_MARGIN);
+    
+    // Enemies share one texture (or none), so the whole pass is a single crowd draw;
+    // left-walking enemies mirror their sprite through the texture coordinates
+    const bool ownsCrowd = !crowdRenderer.isActive();
+    if (ownsCrowd) {
+        crowdRenderer.begin();
+    }
+    for (size_t i = 0; i < enemies.size(); ++i) {
+        if (!ViewCulling::isVisible(enemies.getBounds(i), viewBounds)) {
+            renderStats.countCulled(RenderCategory::Enemies);
+            continue;
+        }
         if (useEnemyPlaceholder) {
-            enemyPlaceholder.setPosition(enemy.getPosition());
-            renderTarget->draw(enemyPlaceholder);
+            crowdRenderer.add(nullptr, RenderCategory::Enemies, sf::FloatRect(enemies.getPosition(i), enemyPlaceholder.getSize()),
+                              sf::IntRect(), false, enemyPlaceholder.getFillColor());
             enemiesRendered++;
         } else if (enemySprite) {
-            enemySprite->setPosition(enemy.getPosition());
-            enemySprite->setScale(sf::Vector2f(spriteScale, spriteScale));
-            renderTarget->draw(*enemySprite);
+            const sf::IntRect rect = enemySprite->getTextureRect();
+            const sf::Vector2f size(std::abs(static_cast<float>(rect.size.x)) * spriteScale,
+                                    std::abs(static_cast<float>(rect.size.y)) * spriteScale);
+            crowdRenderer.add(&enemySprite->getTexture(), RenderCategory::Enemies,
+                              sf::FloatRect(enemies.getPosition(i) - enemySprite->getOrigin() * spriteScale, size), rect,
+                              enemies.direction[i] < 0.0f, enemySprite->getColor());
             enemiesRendered++;
         }
     }
-    logDebug("Rendered " + std::to_string(enemiesRendered) + " enemies");
+    if (ownsCrowd) {
+        crowdRenderer.end(*renderTarget, renderStats);
+    }
+    if (frameLoggingEnabled) {
+        RENDER_LOG(Debug, "Rendered {} enemies", enemiesRendered);
+    }
 }
 
 void RenderingSystem::renderDebugGrid() {
@@ -319,7 +1326,9 @@ void RenderingSystem::renderDebugGrid() {
     }
     
     if (!showDebugGrid) {
-        logDebug("Debug grid rendering skipped (showDebugGrid = false)");
+        if (frameLoggingEnabled) {
+            logDebug("Debug grid rendering skipped (showDebugGrid = false)");
+        }
         return;
     }
     
@@ -392,40 +1401,51 @@ void RenderingSystem::renderDebugGrid() {
     
     // Draw the grid (in order: grid, major axes, then origin)
     if (gridLines.getVertexCount() > 0) {
-        renderTarget->draw(gridLines);
+        submit(*renderTarget, gridLines, RenderCategory::Debug);
     }
     if (axisLines.getVertexCount() > 0) {
-        renderTarget->draw(axisLines);
+        submit(*renderTarget, axisLines, RenderCategory::Debug);
     }
     if (originLines.getVertexCount() > 0) {
-        renderTarget->draw(originLines);
+        submit(*renderTarget, originLines, RenderCategory::Debug);
     }
     
-    logDebug("Debug grid rendered with " + std::to_string(gridLines.getVertexCount() + axisLines.getVertexCount() + originLines.getVertexCount()) + " vertices");
+    if (frameLoggingEnabled) {
+        RENDER_LOG(Debug, "Debug grid rendered with {} vertices",
+                   gridLines.getVertexCount() + axisLines.getVertexCount() + originLines.getVertexCount());
+    }
 }
 
 void RenderingSystem::renderDebugBoxes() {
     // Stub for debug box rendering
     // This would implement collision box visualization
-    logDebug("Debug boxes rendering called");
+    if (frameLoggingEnabled) {
+        logDebug("Debug boxes rendering called");
+    }
 }
 
 void RenderingSystem::renderUI() {
     // Stub for UI rendering
     // This would render health, level text, game over screens, etc.
-    logDebug("UI rendering called");
+    if (frameLoggingEnabled) {
+        logDebug("UI rendering called");
+    }
 }
 
 void RenderingSystem::renderFPS() {
     // Stub for FPS rendering
     // This would render the FPS counter
-    logDebug("FPS rendering called");
+    if (frameLoggingEnabled) {
+        logDebug("FPS rendering called");
+    }
 }
 
 void RenderingSystem::renderMiniMap() {
     // Stub for mini-map rendering
     // This would render the mini-map with player and enemy positions
-    logDebug("Mini-map rendering called");
+    if (frameLoggingEnabled) {
+        logDebug("Mini-map rendering called");
+    }
 }
 
 
@@ -448,13 +1468,8 @@ void RenderingSystem::setBackgroundPlaceholder(const sf::RectangleShape& placeho
 }
 
 void RenderingSystem::clearLogFile() {
-    if (logFile.is_open()) {
-        logFile.close();
-    }
-    logFile.open(logFileName, std::ios::out | std::ios::trunc);
-    if (logFile.is_open()) {
-        logInfo("Log file cleared");
-    }
+    AsyncLogger::instance().truncate(logSink);
+    logInfo("Log file cleared");
 }
 
 void RenderingSystem::renderSpriteWithDirection(const sf::Sprite& sprite, const sf::Vector2f& position, bool facingLeft) {
@@ -471,11 +1486,11 @@ void RenderingSystem::renderSpriteWithDirection(const sf::Sprite& sprite, const
         tempSprite.setScale(scale);
     }
     
-    renderTarget->draw(tempSprite);
-    logDebug("Rendered sprite with direction at (" + 
-            std::to_string(position.x) + ", " + 
-            std::to_string(position.y) + "), facing " + 
-            (facingLeft ? "left" : "right"));
+    submit(*renderTarget, tempSprite, RenderCategory::Player);
+    if (frameLoggingEnabled) {
+        RENDER_LOG(Debug, "Rendered sprite with direction at ({}, {}), facing {}", position.x, position.y,
+                   facingLeft ? "left" : "right");
+    }
 }
 
 void RenderingSystem::renderPlaceholderWithDirection(const sf::RectangleShape& placeholder, const sf::Vector2f& position, bool facingLeft) {
@@ -486,268 +1501,567 @@ void RenderingSystem::renderPlaceholderWithDirection(const sf::RectangleShape& p
     tempPlaceholder.setPosition(position);
     
     // Placeholders don't need direction changes, but this method maintains consistency
-    renderTarget->draw(tempPlaceholder);
-    logDebug("Rendered placeholder at (" + 
-            std::to_string(position.x) + ", " + 
-            std::to_string(position.y) + ")");
-}
-
-// Logging helper methods
-void RenderingSystem::logDebug(const std::string& message) {
-    if (loggingEnabled && logFile.is_open()) {
-        logFile << "[" << getCurrentTimestamp() << "] [DEBUG] " << message << std::endl;
-        logFile.flush();
+    submit(*renderTarget, tempPlaceholder, RenderCategory::Player);
+    if (frameLoggingEnabled) {
+        RENDER_LOG(Debug, "Rendered placeholder at ({}, {})", position.x, position.y);
     }
 }
 
-void RenderingSystem::logInfo(const std::string& message) {
-    if (loggingEnabled && logFile.is_open()) {
-        logFile << "[" << getCurrentTimestamp() << "] [INFO] " << message << std::endl;
-        logFile.flush();
+// Logging helper methods (queued; the logger thread does the file I/O)
+void RenderingSystem::logDebug(std::string_view message) {
+    if (loggingEnabled) {
+        AsyncLogger::instance().log(logSink, AsyncLogger::Level::Debug, message);
     }
 }
 
-void RenderingSystem::logWarning(const std::string& message) {
-    if (loggingEnabled && logFile.is_open()) {
-        logFile << "[" << getCurrentTimestamp() << "] [WARNING] " << message << std::endl;
-        logFile.flush();
+void RenderingSystem::logInfo(std::string_view message) {
+    if (loggingEnabled) {
+        AsyncLogger::instance().log(logSink, AsyncLogger::Level::Info, message);
     }
 }
 
-void RenderingSystem::logError(const std::string& message) {
-    if (loggingEnabled && logFile.is_open()) {
-        logFile << "[" << getCurrentTimestamp() << "] [ERROR] " << message << std::endl;
-        logFile.flush();
+void RenderingSystem::logWarning(std::string_view message) {
+    if (loggingEnabled) {
+        AsyncLogger::instance().log(logSink, AsyncLogger::Level::Warning, message);
     }
 }
 
-std::string RenderingSystem::getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
-    
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-    ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
-    return ss.str();
+void RenderingSystem::logError(std::string_view message) {
+    if (loggingEnabled) {
+        AsyncLogger::instance().log(logSink, AsyncLogger::Level::Error, message);
+    }
 }
 
 // ============================================================================
 // Tile Rendering System (moved from TileRenderer)
 // ============================================================================
 
-bool RenderingSystem::loadTiles(const std::string& tilesDirectory) {
-    tileTextures.clear();
-    tileSprites.clear();
-    tileFilenames.clear(); // Clear stored filenames
-    
-    logInfo("Loading tiles from: " + tilesDirectory);
-    
-    if (!fs::exists(tilesDirectory)) {
-        logError("Tiles directory does not exist: " + tilesDirectory);
+bool RenderingSystem::listTileFiles(const std::string& tilesDirectory, std::vector<std::string>& tileFiles) {
+    tileFiles.clear();
+    const AssetPack& pack = AssetPack::instance();
+    const bool packed = pack.hasDirectory(tilesDirectory);
+    std::error_code existsError;
+    if (!packed && !fs::exists(tilesDirectory, existsError)) {
+        std::cerr << "Tiles directory does not exist: " << tilesDirectory << std::endl;
         return false;
     }
     
     // Load all PNG files from the tiles directory
-    std::vector<std::string> tileFiles;
-    
-    try {
-        for (const auto& entry : fs::directory_iterator(tilesDirectory)) {
-            if (entry.is_regular_file()) {
-                std::string filename = entry.path().filename().string();
+    if (packed) {
+        // Listed from the pack index instead of the filesystem
+        for (auto& name : pack.listDirectory(tilesDirectory)) {
+            if (AssetPack::formatFromExtension(name) == AssetPack::Format::Png) {
+                tileFiles.push_back(std::move(name));
+            }
+        }
+    } else {
+        std::error_code ec;
+        for (fs::directory_iterator it(tilesDirectory, ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->is_regular_file(ec)) {
+                std::string filename = it->path().filename().string();
                 if (filename.size() >= 4 && filename.substr(filename.size() - 4) == ".png") {
-                    tileFiles.push_back(entry.path().string());
-                    tileFilenames.push_back(filename); // Store the filename
+                    tileFiles.push_back(it->path().string());
                 }
             }
         }
-    } catch (const std::exception& e) {
-        logError("Error reading tiles directory: " + std::string(e.what()));
-        return false;
+        if (ec) {
+            std::cerr << "Error reading tiles directory: " << ec.message() << std::endl;
+            return false;
+        }
     }
     
     // Sort files to ensure consistent loading order
     std::sort(tileFiles.begin(), tileFiles.end());
-    std::sort(tileFilenames.begin(), tileFilenames.end());
     
     if (tileFiles.empty()) {
-        logError("No PNG files found in tiles directory");
+        std::cerr << "No PNG files found in tiles directory" << std::endl;
         return false;
     }
+    return true;
+}
+
+bool RenderingSystem::loadTiles(const std::string& tilesDirectory) {
+    logInfo("Loading tiles from: " + tilesDirectory);
     
-    // Load each tile texture
-    for (const auto& filePath : tileFiles) {
-        auto texture = std::make_unique<sf::Texture>();
-        
-        if (texture->loadFromFile(filePath)) {
-            auto sprite = std::make_unique<sf::Sprite>(*texture);
-            sprite->setScale(sf::Vector2f(tileScale, tileScale));
-            
-            tileTextures.push_back(std::move(texture));
-            tileSprites.push_back(std::move(sprite));
-            
-            logInfo("Loaded tile: " + fs::path(filePath).filename().string());
-        } else {
+    std::vector<std::string> tileFiles;
+    if (!listTileFiles(tilesDirectory, tileFiles)) {
+        tileSprites.clear();
+        tileRegions.clear();
+        tileAtlas.clear();
+        tileFilenames.clear();
+        tileAnimations.clear();
+        return false;
+    }
+    std::vector<sf::Image> images(tileFiles.size());
+    for (size_t i = 0; i < tileFiles.size(); ++i) {
+        TextureAtlas::loadImage(tileFiles[i], images[i]);
+    }
+    return loadTiles(tilesDirectory, tileFiles, images);
+}
+
+bool RenderingSystem::loadTiles(const std::string& tilesDirectory, const std::vector<std::string>& tileFiles,
+                                std::vector<sf::Image>& images) {
+    tileSprites.clear();
+    tileRegions.clear();
+    tileAtlas.clear();
+    tileFilenames.clear(); // Clear stored filenames
+    tileAnimations.clear();
+    
+    // Add each decoded tile to the atlas (filenames stay aligned with tile indices)
+    for (size_t i = 0; i < tileFiles.size() && i < images.size(); ++i) {
+        const std::string& filePath = tileFiles[i];
+        if (images[i].getSize().x == 0) {
             logError("Failed to load tile: " + filePath);
+            continue;
+        }
+        TileAnimation animation;
+        const std::string filename = fs::path(filePath).filename().string();
+        const std::string name = parseTileName(filename, animation.frames, animation.fps);
+        // The shader gets the frame width through a colour channel
+        const unsigned frameWidth = images[i].getSize().x / animation.frames;
+        if (animation.frames > 1 && (frameWidth == 0 || frameWidth > 255 || animation.fps == 0)) {
+            logWarning("Animated tile " + filename + " needs a frame rate and frames 1-255 px wide; shown still");
+            animation = TileAnimation();
         }
+        tileRegions.push_back(tileAtlas.add(std::move(images[i])));
+        tileFilenames.push_back(name);
+        tileAnimations.push_back(animation);
+        logInfo("Loaded tile: " + filename);
     }
     
-    if (tileTextures.empty()) {
+    if (tileRegions.empty() || !tileAtlas.build()) {
         logError("No tiles were successfully loaded");
+        tileRegions.clear();
         return false;
     }
     
+    // Sprites reference their region of a shared atlas page (an animated tile's first frame)
+    for (size_t i = 0; i < tileRegions.size(); ++i) {
+        sf::IntRect rect = tileAtlas.getRegion(tileRegions[i]).rect;
+        rect.size.x /= tileAnimations[i].frames;
+        auto sprite = std::make_unique<sf::Sprite>(tileAtlas.getTexture(tileRegions[i]), rect);
+        sprite->setScale(sf::Vector2f(tileScale, tileScale));
+        tileSprites.push_back(std::move(sprite));
+    }
+    
+    loadedTilesDirectory = tilesDirectory;
+    logInfo("Packed " + std::to_string(tileRegions.size()) + " tiles (" + std::to_string(getAnimatedTileCount()) +
+            " animated) into " + std::to_string(tileAtlas.getPageCount()) + " atlas pages");
+    
     // Update the distribution for random tile selection
     updateTileDistribution();
+    resolveSpecialTiles();
+    platformCacheDirty = true;
+    decorationCacheDirty = true;
+    tileSetVersion++;
     
-    logInfo("Successfully loaded " + std::to_string(tileTextures.size()) + " tiles");
+    logInfo("Successfully loaded " + std::to_string(tileSprites.size()) + " tiles");
     return true;
 }
 
-void RenderingSystem::renderGround(sf::RenderWindow& window, const sf::RectangleShape& platform, bool randomize) {
-    if (tileTextures.empty()) {
-        // Fallback to original platform rendering if no tiles loaded
-        window.draw(platform);
-        return;
+bool RenderingSystem::reloadTile(const std::string& path) {
+    const fs::path file(path);
+    if (loadedTilesDirectory.empty() || file.extension() != ".png" ||
+        !FileWatcher::isSameFile(file.parent_path().string(), loadedTilesDirectory)) {
+        return false;
     }
     
-    sf::Vector2f platformPos = platform.getPosition();
-    sf::Vector2f platformSize = platform.getSize();
+    // An animated strip is listed under its tile name; a changed frame count repacks
+    TileAnimation animation;
+    const std::string filename = parseTileName(file.filename().string(), animation.frames, animation.fps);
+    auto tile = std::find(tileFilenames.begin(), tileFilenames.end(), filename);
+    sf::Image image;
+    if (tile != tileFilenames.end() && tileAnimations[tile - tileFilenames.begin()].frames == animation.frames &&
+        tileAnimations[tile - tileFilenames.begin()].fps == animation.fps && image.loadFromFile(path) &&
+        tileAtlas.updateRegion(tileAtlas.getRegion(tileRegions[tile - tileFilenames.begin()]), image)) {
+        logInfo("Reloaded tile in place: " + filename);
+        return true;
+    }
     
-    // Generate tile layout for this platform
-    auto tileLayout = generateTileLayout(platformPos, platformSize, randomize);
+    // New tile or a different size: the packing changes, so repack the set
+    const std::string directory = loadedTilesDirectory;
+    return loadTiles(directory);
+}
+
+void RenderingSystem::renderGround(sf::RenderWindow& window, const LevelGeometry& platforms, size_t platform, bool randomize) {
+    if (tileSprites.empty()) {
+        // Fallback to a plain coloured box if no tiles loaded
+        platformVertexScratch.clear();
+        platforms.appendQuad(platform, platforms.getColor(platform), platformVertexScratch);
+        submit(window, platformVertexScratch.data(), platformVertexScratch.size(), sf::PrimitiveType::Triangles,
+               RenderCategory::Platforms);
+        return;
+    }
     
-    // Render each tile
-    for (const auto& tilePos : tileLayout) {
-        sf::Sprite& sprite = getTileSprite(tilePos.tileIndex);
-        
-        float scaledTileSize = tileSize * tileScale;
-        sprite.setPosition(sf::Vector2f(
-            platformPos.x + tilePos.x * scaledTileSize,
-            platformPos.y + tilePos.y * scaledTileSize
-        ));
-        
-        window.draw(sprite);
+    // Uncached path (batched per atlas page); renderPlatforms uses the chunk cache.
+    // The cache's cells serve while they're current, otherwise tile it here.
+    const sf::FloatRect& bounds = platforms.getBounds(platform);
+    if (!platformCacheDirty && randomize == cachedRandomize && platform < platformCells.size() &&
+        cachedPlatformBounds[platform] == bounds) {
+        const PlatformCells& cells = platformCells[platform];
+        collectPlatformTiles(bounds, cellTiles.data() + cells.first, cells, tileQuadScratch);
+    } else {
+        cellTileScratch.clear();
+        const PlatformCells cells = autotilePlatform(bounds, randomize, cellTileScratch);
+        collectPlatformTiles(bounds, cellTileScratch.data(), cells, tileQuadScratch);
     }
+    drawTileQuads(window);
 }
 
-void RenderingSystem::renderPlat(sf::RenderWindow& window, const sf::RectangleShape& platform, bool randomize)
+void RenderingSystem::renderPlat(sf::RenderWindow& window, const LevelGeometry& platforms, size_t platform, bool randomize)
 {
-    if (tileTextures.empty()) {
-        window.draw(platform);
+    if (tileSprites.empty()) {
         logWarning("No tiles loaded, using fallback rendering");
+    }
+    renderGround(window, platforms, platform, randomize);
+}
+
+void RenderingSystem::drawTileQuads(sf::RenderTarget& target) {
+    // Join the caller's batch if one is open, otherwise flush this platform on its own
+    const bool ownsBatch = !batchMode;
+    if (ownsBatch) {
+        spriteBatch.begin();
+    }
+    for (const auto& quad : tileQuadScratch) {
+        sf::Sprite& sprite = getTileSprite(quad.tileIndex);
+        sprite.setScale(sf::Vector2f(tileScale, tileScale));
+        sprite.setPosition(quad.position);
+        spriteBatch.add(sprite);
+    }
+    if (ownsBatch) {
+        spriteBatch.end(target, renderStats, RenderCategory::Platforms);
+    }
+}
+
+RenderingSystem::PlatformCells RenderingSystem::autotilePlatform(const sf::FloatRect& platform, bool randomize,
+                                                                  std::vector<int>& out) const {
+    PlatformCells cells;
+    cells.first = out.size();
+    const float scaledTileSize = tileSize * tileScale;
+    if (tileSprites.empty() || !(scaledTileSize > 0.0f) || !(platform.size.x > 0.0f)) {
+        return cells;
+    }
+    
+    // Ground platforms (at the bottom of the window) are filled, snow on top and
+    // black below; elevated ones are a single row of edge and middle tiles
+    const bool ground = platform.position.y >= WINDOW_HEIGHT - GROUND_HEIGHT;
+    cells.columns = static_cast<int>(std::ceil(platform.size.x / scaledTileSize));
+    cells.rows = ground ? std::max(static_cast<int>(std::ceil(platform.size.y / scaledTileSize)), 0) : 1;
+    cells.alignRight = !ground && cells.columns > 1;
+    const bool variants = randomize && randomizationEnabled;
+    
+    out.reserve(out.size() + static_cast<size_t>(cells.columns) * static_cast<size_t>(cells.rows));
+    for (int row = 0; row < cells.rows; ++row) {
+        for (int column = 0; column < cells.columns; ++column) {
+            unsigned neighbours = 0;
+            if (row > 0) neighbours |= NeighbourNorth;
+            if (column < cells.columns - 1) neighbours |= NeighbourEast;
+            if (row < cells.rows - 1) neighbours |= NeighbourSouth;
+            if (column > 0) neighbours |= NeighbourWest;
+            
+            int tile;
+            if (ground) {
+                if (neighbours & NeighbourNorth) {
+                    tile = blackTileIndex;
+                } else {
+                    // Exposed top: a snow variant, hashed or in a repeating pattern
+                    const uint32_t variant = variants ? hashCell(platform.position, column, row)
+                                                      : static_cast<uint32_t>(column);
+                    tile = snowTileIndices[variant % snowTileIndices.size()];
+                }
+            } else if (!(neighbours & NeighbourWest)) {
+                tile = leftTileIndex;
+            } else if (!(neighbours & NeighbourEast)) {
+                tile = rightTileIndex;
+            } else {
+                tile = middleTileIndex;
+            }
+            out.push_back(tile);
+        }
+    }
+    return cells;
+}
+
+void RenderingSystem::autotilePlatforms() {
+    platformCells.clear();
+    cellTiles.clear();
+    for (const sf::FloatRect& bounds : cachedPlatformBounds) {
+        platformCells.push_back(autotilePlatform(bounds, cachedRandomize, cellTiles));
+    }
+}
+
+void RenderingSystem::collectPlatformTiles(const sf::FloatRect& platform, const int* tiles, const PlatformCells& cells,
+                                           std::vector<TileQuad>& out) const {
+    out.clear();
+    const float scaledTileSize = tileSize * tileScale;
+    for (int row = 0; row < cells.rows; ++row) {
+        for (int column = 0; column < cells.columns; ++column) {
+            TileQuad quad;
+            quad.tileIndex = tiles[row * cells.columns + column];
+            quad.position = sf::Vector2f(platform.position.x + column * scaledTileSize,
+                                         platform.position.y + row * scaledTileSize);
+            if (cells.alignRight && column == cells.columns - 1) {
+                quad.position.x = platform.position.x + platform.size.x - scaledTileSize;
+            }
+            out.push_back(quad);
+        }
+    }
+}
+
+int RenderingSystem::platformChunkIndex(float x) const {
+    int index = static_cast<int>(std::floor((x - platformChunkOrigin) / PLATFORM_CHUNK_WIDTH));
+    return std::clamp(index, 0, static_cast<int>(platformChunks.size()) - 1);
+}
+
+void RenderingSystem::buildPlatformCache(const LevelGeometry& platforms, bool randomize) {
+    platformChunks.clear();
+    cachedPlatformBounds.clear();
+    platformCells.clear();
+    cellTiles.clear();
+    cachedRandomize = randomize;
+    platformCacheDirty = false;
+    
+    if (platforms.empty() || tileSprites.empty()) {
         return;
     }
+    
+    // Chunks span the platforms' horizontal extent (tiles can overhang by one tile)
+    float minX = platforms.getBounds(0).position.x;
+    float maxX = minX;
+    for (const sf::FloatRect& bounds : platforms.getBounds()) {
+        cachedPlatformBounds.push_back(bounds);
+        minX = std::min(minX, bounds.position.x);
+        maxX = std::max(maxX, bounds.position.x + bounds.size.x);
+    }
+    maxX += tileSize * tileScale;
+    autotilePlatforms();
+    
+    platformChunkOrigin = minX;
+    size_t chunkCount = static_cast<size_t>(std::ceil((maxX - minX) / PLATFORM_CHUNK_WIDTH));
+    platformChunks.resize(std::max<size_t>(chunkCount, 1));
+    
+    assignPlatformsToChunks();
+    for (size_t c = 0; c < platformChunks.size(); ++c) {
+        rebuildPlatformChunk(c);
+    }
+    
+    logInfo("Built platform tile cache: " + std::to_string(platformChunks.size()) +
+            " chunks for " + std::to_string(platforms.size()) + " platforms");
+}
 
-    sf::Vector2f platformPos = platform.getPosition();
-    sf::Vector2f platformSize = platform.getSize();
-    float scaledTileSize = tileSize * tileScale;
-    int tilesX = static_cast<int>(std::ceil(platformSize.x / scaledTileSize));
+void RenderingSystem::updatePlatformCache(const LevelGeometry& platforms, const std::vector<size_t>& changedPlatforms) {
+    if (changedPlatforms.empty()) {
+        return;
+    }
+    if (platformCacheDirty || platforms.size() != cachedPlatformBounds.size() || platformChunks.empty()) {
+        buildPlatformCache(platforms, cachedRandomize);
+        return;
+    }
     
-    // Find indices for special tiles
-    int leftTileIndex = -1;
-    int rightTileIndex = -1;
-    int middleTileIndex = -1;
+    const float overhang = tileSize * tileScale;
+    const float cacheRight = platformChunkOrigin + platformChunks.size() * PLATFORM_CHUNK_WIDTH;
+    std::vector<bool> dirtyChunks(platformChunks.size(), false);
+    auto markChunks = [&](const sf::FloatRect& bounds) {
+        int first = platformChunkIndex(bounds.position.x);
+        int last = platformChunkIndex(bounds.position.x + bounds.size.x + overhang);
+        for (int c = first; c <= last; ++c) {
+            dirtyChunks[c] = true;
+        }
+    };
     
-    // Find the tile indices with exact filename matches
-    for (size_t i = 0; i < tileFilenames.size(); i++) {
-        const std::string& filename = tileFilenames[i];
-        if (filename == "tile_left.png") {
-            leftTileIndex = i;
-        } else if (filename == "tile_right.png") {
-            rightTileIndex = i;
-        } else if (filename == "tile_middle.png" || filename == "tile_00_snow.png") {
-            middleTileIndex = i;
+    // Rebuild the chunks under both the old and the new footprint of each platform
+    for (size_t i : changedPlatforms) {
+        if (i >= platforms.size()) {
+            continue;
+        }
+        const sf::FloatRect& bounds = platforms.getBounds(i);
+        if (bounds.position.x < platformChunkOrigin || bounds.position.x + bounds.size.x + overhang > cacheRight) {
+            // Moved outside the chunked range
+            buildPlatformCache(platforms, cachedRandomize);
+            return;
+        }
+        markChunks(cachedPlatformBounds[i]);
+        cachedPlatformBounds[i] = bounds;
+        markChunks(bounds);
+        
+        // Retile in place while the cell count holds; otherwise append (a full build compacts)
+        cellTileScratch.clear();
+        PlatformCells cells = autotilePlatform(bounds, cachedRandomize, cellTileScratch);
+        const PlatformCells& stored = platformCells[i];
+        cells.first = cells.columns * cells.rows == stored.columns * stored.rows ? stored.first : cellTiles.size();
+        if (cells.first == cellTiles.size()) {
+            cellTiles.resize(cellTiles.size() + cellTileScratch.size());
         }
+        std::copy(cellTileScratch.begin(), cellTileScratch.end(), cellTiles.begin() + cells.first);
+        platformCells[i] = cells;
     }
     
+    assignPlatformsToChunks();
+    size_t rebuilt = 0;
+    for (size_t c = 0; c < platformChunks.size(); ++c) {
+        if (dirtyChunks[c]) {
+            rebuildPlatformChunk(c);
+            rebuilt++;
+        }
+    }
+    
+    RENDER_LOG(Debug, "Rebuilt {} of {} platform chunks", rebuilt, platformChunks.size());
+}
 
-
-    // Render each tile
-    for (int x = 0; x < tilesX; x++) {
-        int tileIndex;
-        bool isEdgeTile = false;
-        
-        if (x == 0) {
-            tileIndex = leftTileIndex;  // Left edge
-            isEdgeTile = true;
-        } else if (x == tilesX - 1) {
-            tileIndex = rightTileIndex; // Right edge
-            isEdgeTile = true;
-        } else {
-            tileIndex = middleTileIndex; // Middle section
+void RenderingSystem::assignPlatformsToChunks() {
+    for (auto& chunk : platformChunks) {
+        chunk.platforms.clear();
+    }
+    
+    const float overhang = tileSize * tileScale;
+    for (size_t i = 0; i < cachedPlatformBounds.size(); ++i) {
+        const sf::FloatRect& bounds = cachedPlatformBounds[i];
+        int first = platformChunkIndex(bounds.position.x);
+        int last = platformChunkIndex(bounds.position.x + bounds.size.x + overhang);
+        for (int c = first; c <= last; ++c) {
+            platformChunks[c].platforms.push_back(i);
         }
+    }
+}
+
+RenderingSystem::TileBatch& RenderingSystem::getTileBatch(std::vector<TileBatch>& batches, int tile, bool animate,
+                                                          sf::FloatRect& texture, sf::Color& color) const {
+    const TextureAtlas::Region& region = tileAtlas.getRegion(tileRegions[tile]);
+    const TileAnimation& animation = tileAnimations[tile];
+    texture = sf::FloatRect(sf::Vector2f(region.rect.position), sf::Vector2f(region.rect.size));
+    texture.size.x = std::floor(texture.size.x / animation.frames);
+    // What TILE_VERTEX_SHADER reads back; the static tiles stay white, in batches without the shader
+    const bool animated = animate && animation.frames > 1;
+    color = animated ? sf::Color(animation.frames, animation.fps, static_cast<uint8_t>(texture.size.x))
+                     : sf::Color::White;
+    auto batch = std::find_if(batches.begin(), batches.end(), [&](const TileBatch& b) {
+        return b.page == region.page && b.animated == animated;
+    });
+    if (batch == batches.end()) {
+        batches.push_back(TileBatch{region.page, sf::VertexArray(sf::PrimitiveType::Triangles), animated});
+        batch = batches.end() - 1;
+    }
+    return *batch;
+}
+
+void RenderingSystem::drawTileBatch(sf::RenderTarget& target, const TileBatch& batch, RenderCategory category) {
+    sf::RenderStates states;
+    states.texture = &tileAtlas.getPageTexture(batch.page);
+    if (batch.animated) {
+        tileShader.setUniform("time", std::fmod(effectsClock.getElapsedTime().asSeconds(), EFFECTS_TIME_WRAP));
+        states.shader = &tileShader;
+    }
+    submit(target, batch.vertices, category, states);
+}
+
+void RenderingSystem::rebuildPlatformChunk(size_t chunkIndex) {
+    TileChunk& chunk = platformChunks[chunkIndex];
+    chunk.batches.clear();
+    
+    sf::Vector2f minCorner, maxCorner;
+    bool hasTiles = false;
+    
+    for (size_t p : chunk.platforms) {
+        // Tile indices were fixed when the platform was autotiled; this only places them
+        const PlatformCells& cells = platformCells[p];
+        collectPlatformTiles(cachedPlatformBounds[p], cellTiles.data() + cells.first, cells, tileQuadScratch);
         
-        // Get the sprite and ensure it's properly scaled
-        sf::Sprite& sprite = getTileSprite(tileIndex);
-        sprite.setScale(sf::Vector2f(tileScale, tileScale));
-        
-        // Calculate position
-        sf::Vector2f tilePos;
-        if (isEdgeTile) {
-            // For edge tiles, ensure they align perfectly with platform edges
-            tilePos.x = x == 0 ? platformPos.x : (platformPos.x + platformSize.x - scaledTileSize);
-            tilePos.y = platformPos.y;
-        } else {
-            // For middle tiles, space them evenly
-            tilePos.x = platformPos.x + x * scaledTileSize;
-            tilePos.y = platformPos.y;
+        for (const auto& quad : tileQuadScratch) {
+            // Each tile belongs to the chunk containing its left edge
+            if (platformChunkIndex(quad.position.x) != static_cast<int>(chunkIndex)) {
+                continue;
+            }
+            
+            const int tileIndex = std::clamp(quad.tileIndex, 0, static_cast<int>(tileRegions.size()) - 1);
+            sf::FloatRect texture;
+            sf::Color color;
+            TileBatch& batch = getTileBatch(chunk.batches, tileIndex, platformsAnimated, texture, color);
+            
+            // Same footprint the scaled sprite would cover, textured from the atlas region
+            const sf::Vector2f uvMin = texture.position;
+            const sf::Vector2f uvMax = uvMin + texture.size;
+            const sf::Vector2f size = texture.size * tileScale;
+            const sf::Vector2f topLeft = quad.position;
+            const sf::Vector2f topRight(topLeft.x + size.x, topLeft.y);
+            const sf::Vector2f bottomLeft(topLeft.x, topLeft.y + size.y);
+            const sf::Vector2f bottomRight = topLeft + size;
+            
+            sf::VertexArray& vertices = batch.vertices;
+            vertices.append(sf::Vertex{topLeft, color, uvMin});
+            vertices.append(sf::Vertex{topRight, color, sf::Vector2f(uvMax.x, uvMin.y)});
+            vertices.append(sf::Vertex{bottomLeft, color, sf::Vector2f(uvMin.x, uvMax.y)});
+            vertices.append(sf::Vertex{bottomLeft, color, sf::Vector2f(uvMin.x, uvMax.y)});
+            vertices.append(sf::Vertex{topRight, color, sf::Vector2f(uvMax.x, uvMin.y)});
+            vertices.append(sf::Vertex{bottomRight, color, uvMax});
+            
+            if (!hasTiles) {
+                minCorner = topLeft;
+                maxCorner = bottomRight;
+                hasTiles = true;
+            } else {
+                minCorner.x = std::min(minCorner.x, topLeft.x);
+                minCorner.y = std::min(minCorner.y, topLeft.y);
+                maxCorner.x = std::max(maxCorner.x, bottomRight.x);
+                maxCorner.y = std::max(maxCorner.y, bottomRight.y);
+            }
         }
-        
-        // Set position and render
-        sprite.setPosition(tilePos);
-        window.draw(sprite);
-        
-
     }
+    
+    chunk.bounds = hasTiles ? sf::FloatRect(minCorner, maxCorner - minCorner) : sf::FloatRect();
 }
 
 void RenderingSystem::renderBackground(sf::RenderWindow& window, const sf::Sprite& background) {
-    window.draw(background);
+    submit(window, background, RenderCategory::Background);
 }
 
-void RenderingSystem::renderEntity(sf::RenderWindow& window, const sf::Sprite& sprite, const sf::Vector2f& position) {
+void RenderingSystem::renderEntity(sf::RenderWindow& window, const sf::Sprite& sprite, const sf::Vector2f& position,
+                                   RenderCategory category) {
     sf::Sprite tempSprite = sprite;
     tempSprite.setPosition(position);
-    window.draw(tempSprite);
+    submit(window, tempSprite, category);
 }
 
-void RenderingSystem::renderShape(sf::RenderWindow& window, const sf::Shape& shape) {
-    window.draw(shape);
+void RenderingSystem::renderShape(sf::RenderWindow& window, const sf::Shape& shape, RenderCategory category) {
+    submit(window, shape, category);
 }
 
-void RenderingSystem::beginBatch() {
-    spriteBatch.clear();
+void RenderingSystem::beginBatch(RenderCategory category) {
+    spriteBatch.begin();
     batchMode = true;
+    batchCategory = category;
 }
 
 void RenderingSystem::endBatch() {
     if (renderTarget) {
-        for (const auto& [sprite, position] : spriteBatch) {
-            sf::Sprite tempSprite = sprite;
-            tempSprite.setPosition(position);
-            renderTarget->draw(tempSprite);
-        }
+        spriteBatch.end(*renderTarget, renderStats, batchCategory);
+    } else {
+        spriteBatch.begin(); // Drop the queued sprites
+        logWarning("endBatch() called without a render target");
     }
-    spriteBatch.clear();
     batchMode = false;
 }
 
-void RenderingSystem::addToBatch(const sf::Sprite& sprite, const sf::Vector2f& position) {
+void RenderingSystem::addToBatch(const sf::Sprite& sprite, const sf::Vector2f& position, int layer) {
     if (batchMode) {
-        spriteBatch.emplace_back(sprite, position);
+        spriteBatch.add(sprite, position, layer);
+    }
+}
+
+void RenderingSystem::addToBatch(const sf::Vertex* triangles, size_t vertexCount, const sf::Texture& texture,
+                                 const sf::Vector2f& offset, int layer) {
+    if (batchMode) {
+        spriteBatch.add(triangles, vertexCount, texture, offset, layer);
     }
 }
 
 int RenderingSystem::getRandomTileIndex() {
-    if (tileTextures.empty()) return 0;
+    if (tileSprites.empty()) return 0;
     return tileDistribution(randomEngine);
 }
 
 void RenderingSystem::updateTileDistribution() {
-    if (!tileTextures.empty()) {
-        tileDistribution = std::uniform_int_distribution<int>(0, static_cast<int>(tileTextures.size() - 1));
+    if (!tileSprites.empty()) {
+        tileDistribution = std::uniform_int_distribution<int>(0, static_cast<int>(tileSprites.size() - 1));
     }
 }
 
@@ -757,24 +2071,21 @@ sf::Sprite& RenderingSystem::getTileSprite(int index) {
     return *tileSprites[index];
 }
 
-std::vector<RenderingSystem::TilePosition> RenderingSystem::generateTileLayout(
-    const sf::Vector2f& platformPos, 
-    const sf::Vector2f& platformSize, 
-    bool randomize) {
-    
-    std::vector<TilePosition> layout;
+void RenderingSystem::resolveSpecialTiles() {
+    leftTileIndex = rightTileIndex = middleTileIndex = blackTileIndex = -1;
+    snowTileIndices.clear();
     
-    float scaledTileSize = tileSize * tileScale;
-    int tilesX = static_cast<int>(std::ceil(platformSize.x / scaledTileSize));
-    int tilesY = static_cast<int>(std::ceil(platformSize.y / scaledTileSize));
-    
-    // Find the black tile index and snow tile indices
-    int blackTileIndex = -1;
-    std::vector<int> snowTileIndices;
-    
-    // Find the indices for black and snow tiles
+    // Find the tile indices with exact filename matches
     for (size_t i = 0; i < tileFilenames.size(); i++) {
         const std::string& filename = tileFilenames[i];
+        if (filename == "tile_left.png") {
+            leftTileIndex = i;
+        } else if (filename == "tile_right.png") {
+            rightTileIndex = i;
+        } else if (filename == "tile_middle.png" || filename == "tile_00_snow.png") {
+            middleTileIndex = i;
+        }
+        
         if (filename == "tile_black.png") {
             blackTileIndex = i;
         } else if (filename.find("tile_00_") != std::string::npos) {
@@ -783,40 +2094,25 @@ std::vector<RenderingSystem::TilePosition> RenderingSystem::generateTileLayout(
     }
     
     // If we couldn't find our tiles, use the first tile as fallback
-    if (blackTileIndex == -1) blackTileIndex = 0;
-    if (snowTileIndices.empty()) snowTileIndices.push_back(0);
-    
-    // Create a deterministic seed based on platform position
-    std::mt19937 localRandom;
-    if (randomize && randomizationEnabled) {
-        uint32_t seed = static_cast<uint32_t>(platformPos.x * 1000 + platformPos.y * 1000);
-        localRandom.seed(seed);
-    }
-    
-    for (int y = 0; y < tilesY; y++) {
-        for (int x = 0; x < tilesX; x++) {
-            TilePosition tilePos;
-            tilePos.x = x;
-            tilePos.y = y;
-            
-            if (y == 0) {
-                // Top layer - use snow tiles
-                if (randomize && randomizationEnabled) {
-                    // Randomly select from snow tiles
-                    std::uniform_int_distribution<int> snowDist(0, snowTileIndices.size() - 1);
-                    tilePos.tileIndex = snowTileIndices[snowDist(localRandom)];
-                } else {
-                    // Use a pattern for snow tiles
-                    tilePos.tileIndex = snowTileIndices[x % snowTileIndices.size()];
-                }
-            } else {
-                // Under layers - use black tile
-                tilePos.tileIndex = blackTileIndex;
-            }
-            
-            layout.push_back(tilePos);
+    // Decoration tiles: deco_<kind>_<part>.png, else deco_<kind>.png, else none
+    static const char* const kindNames[] = {"other", "tree", "cabin", "snowman"};
+    static const char* const partNames[] = {"", "_top", "_middle", "_bottom"};
+    auto findTile = [this](const std::string& filename) {
+        auto tile = std::find(tileFilenames.begin(), tileFilenames.end(), filename);
+        return tile != tileFilenames.end() ? static_cast<int>(tile - tileFilenames.begin()) : -1;
+    };
+    for (size_t kind = 0; kind < decorationTiles.size(); ++kind) {
+        const int whole = findTile(std::string("deco_") + kindNames[kind] + ".png");
+        for (size_t part = 0; part < decorationTiles[kind].size(); ++part) {
+            const int tile = part == 0 ? whole : findTile(std::string("deco_") + kindNames[kind] + partNames[part] + ".png");
+            decorationTiles[kind][part] = tile >= 0 ? tile : whole;
         }
     }
     
-    return layout;
-}
\ No newline at end of file
+    if (leftTileIndex == -1) leftTileIndex = 0;
+    if (rightTileIndex == -1) rightTileIndex = 0;
+    if (middleTileIndex == -1) middleTileIndex = 0;
+    if (blackTileIndex == -1) blackTileIndex = 0;
+    if (snowTileIndices.empty()) snowTileIndices.push_back(0);
+}
+
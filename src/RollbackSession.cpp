@@ -0,0 +1,158 @@
+#include "RollbackSession.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+void writeU32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint32_t readU32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | static_cast<uint32_t>(in[1]) << 8 |
+           static_cast<uint32_t>(in[2]) << 16 | static_cast<uint32_t>(in[3]) << 24;
+}
+
+// Payload: ack (remote ticks we have), first (tick of the first run), tick
+// count, then (length, buttons) byte pairs
+constexpr size_t PACKET_HEADER = 10;
+
+} // namespace
+
+void RollbackSession::start(uint32_t delay) {
+    active = true;
+    inputDelay = std::min(delay, MAX_INPUT_DELAY);
+    tick = 0;
+    historyStart = 0;
+    // The first ticks of the delay have no input on either side
+    localNext = remoteNext = remoteAcked = inputDelay;
+    rollbackFrom = NO_ROLLBACK;
+    localInput.fill(0);
+    remoteInput.fill(0);
+    predicted.fill(0);
+    stats = Stats();
+}
+
+bool RollbackSession::canAdvance() const {
+    if (!active) return false;
+    // Unacknowledged local input has to stay in the ring until the peer has it
+    if (localNext + 1 - remoteAcked > HISTORY) return false;
+    return tick < remoteNext + getWindow();
+}
+
+void RollbackSession::addLocalInput(uint8_t buttons) {
+    localInput[localNext % HISTORY] = buttons;
+    localNext++;
+}
+
+uint8_t RollbackSession::remoteFor(uint32_t at) const {
+    if (at < remoteNext) {
+        return remoteInput[at % HISTORY];
+    }
+    return remoteNext > 0 ? remoteInput[(remoteNext - 1) % HISTORY] : 0;
+}
+
+uint8_t RollbackSession::getButtons(uint32_t at) {
+    const uint8_t remote = remoteFor(at);
+    predicted[at % HISTORY] = remote;
+    return localInput[at % HISTORY] | remote;
+}
+
+bool RollbackSession::takeRollback(uint32_t& from) {
+    if (!active || rollbackFrom == NO_ROLLBACK) {
+        return false;
+    }
+    const uint32_t earliest = rollbackFrom;
+    rollbackFrom = NO_ROLLBACK;
+    if (earliest < historyStart || earliest + SNAPSHOTS <= tick) {
+        stats.lostHistory++;
+        return false;
+    }
+    from = earliest;
+    return true;
+}
+
+void RollbackSession::endRollback(uint32_t ticks, double ms, uint64_t allocations) {
+    stats.rollbacks++;
+    stats.resimulatedTicks += ticks;
+    stats.lastRollbackTicks = ticks;
+    stats.lastRollbackMs = ms;
+    stats.maxRollbackMs = std::max(stats.maxRollbackMs, ms);
+    stats.resimAllocations += allocations;
+    if (ticks > 0) {
+        const double perTick = ms / ticks;
+        stats.tickCostMs = stats.tickCostMs > 0.0 ? stats.tickCostMs * 0.9 + perTick * 0.1 : perTick;
+    }
+}
+
+uint32_t RollbackSession::getWindow() const {
+    if (stats.tickCostMs <= 0.0) {
+        return MAX_ROLLBACK;
+    }
+    const double fits = std::floor(BUDGET_MS / stats.tickCostMs);
+    return static_cast<uint32_t>(std::min(fits, static_cast<double>(MAX_ROLLBACK)));
+}
+
+const RollbackSession::Stats& RollbackSession::getStats() {
+    stats.tick = tick;
+    stats.remoteConfirmed = remoteNext;
+    stats.window = getWindow();
+    return stats;
+}
+
+size_t RollbackSession::writeInputPacket(uint8_t* out, size_t capacity) {
+    if (capacity < PACKET_HEADER) return 0;
+    const uint32_t first = remoteAcked;
+    const uint32_t count = std::min(localNext - first, HISTORY);
+    writeU32(out, remoteNext);
+    writeU32(out + 4, first);
+    out[8] = static_cast<uint8_t>(count);
+    out[9] = static_cast<uint8_t>(count >> 8);
+    size_t size = PACKET_HEADER;
+    // Buttons change every few ticks at most, so runs make most packets a handful of bytes
+    uint32_t at = first;
+    while (at < first + count && size + 2 <= capacity) {
+        const uint8_t buttons = localInput[at % HISTORY];
+        uint32_t run = 1;
+        while (at + run < first + count && run < 255 && localInput[(at + run) % HISTORY] == buttons) {
+            run++;
+        }
+        out[size++] = static_cast<uint8_t>(run);
+        out[size++] = buttons;
+        at += run;
+    }
+    stats.packetsSent++;
+    stats.lastPacketBytes = size;
+    return size;
+}
+
+bool RollbackSession::readInputPacket(const uint8_t* data, size_t size) {
+    if (!active || size < PACKET_HEADER) return false;
+    const uint32_t ack = readU32(data);
+    uint32_t at = readU32(data + 4);
+    const uint32_t count = static_cast<uint32_t>(data[8]) | static_cast<uint32_t>(data[9]) << 8;
+    if (count > HISTORY || ack > localNext) return false;
+    remoteAcked = std::max(remoteAcked, ack);
+    stats.packetsReceived++;
+
+    const uint32_t end = at + count;
+    for (size_t offset = PACKET_HEADER; offset + 2 <= size && at < end; offset += 2) {
+        const uint32_t run = data[offset];
+        const uint8_t buttons = data[offset + 1];
+        if (run == 0) return false;
+        for (uint32_t i = 0; i < run && at < end; ++i, ++at) {
+            // Already known, or past a gap a later packet will fill
+            if (at < remoteNext) continue;
+            if (at > remoteNext || at >= tick + HISTORY / 2) return true;
+            remoteInput[at % HISTORY] = buttons;
+            if (at < tick && predicted[at % HISTORY] != buttons) {
+                stats.mispredictions++;
+                rollbackFrom = std::min(rollbackFrom, at);
+            }
+            remoteNext++;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,154 @@
+#include "SceneGenerator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace SceneGenerator {
+
+namespace {
+
+constexpr float LEVEL_HEIGHT = 600.f;  // Game::WINDOW_HEIGHT; the camera doesn't scroll vertically
+constexpr float GROUND_Y = 500.f;      // LEVEL_HEIGHT - Game::GROUND_HEIGHT
+constexpr float MIN_WIDTH = 1500.f;    // Game::LEVEL_WIDTH
+constexpr float PLATFORM_TOP = 150.f;  // Platforms lie between here and a jump above the ground
+constexpr float PLATFORM_BOTTOM = GROUND_Y - 60.f;
+constexpr float MIN_PLATFORM_WIDTH = 60.f;
+constexpr float MAX_PLATFORM_WIDTH = 300.f;
+constexpr float MAX_PATROL_SPAN = 400.f;
+
+// Denser presets keep the big levels within a couple of million pixels, where
+// a float still resolves well under a pixel
+const Preset PRESETS[] = {
+    {"1k", {1, 1000, 100, 1000, 20, 500, 5000, 8.f, 0.f, 30.f}},
+    {"10k", {1, 10000, 1000, 10000, 100, 5000, 20000, 16.f, 0.f, 30.f}},
+    {"100k", {1, 100000, 10000, 100000, 500, 50000, 50000, 64.f, 0.f, 30.f}},
+};
+
+// SplitMix64: the same sequence from the same seed everywhere
+class Random {
+public:
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+    // [min, max), from the top 24 bits so every value is exact in a float
+    float uniform(float min, float max) {
+        return min + (max - min) * static_cast<float>(next() >> 40) * (1.f / 16777216.f);
+    }
+    size_t index(size_t count) {
+        return count > 0 ? static_cast<size_t>(next() % count) : 0;
+    }
+
+private:
+    uint64_t state;
+};
+
+} // namespace
+
+size_t getPresetCount() {
+    return std::size(PRESETS);
+}
+
+const Preset& getPreset(size_t index) {
+    return PRESETS[std::min(index, std::size(PRESETS) - 1)];
+}
+
+bool findPreset(const std::string& name, Config& out) {
+    for (const Preset& preset : PRESETS) {
+        if (name == preset.name) {
+            out = preset.config;
+            return true;
+        }
+    }
+    return false;
+}
+
+float getLevelWidth(const Config& config) {
+    float width = config.width > 0.f ? config.width
+        : static_cast<float>(config.platforms) * 1000.f / std::max(config.density, 0.01f);
+    return std::max(width, MIN_WIDTH);
+}
+
+void generate(const Config& config, LevelData& out) {
+    out.clear();
+    Random random(config.seed);
+    const float width = getLevelWidth(config);
+    const float tile = std::max(config.tileSize, 1.f);
+    auto snap = [tile](float value) { return std::round(value / tile) * tile; };
+
+    out.name = "Generated scene (seed " + std::to_string(config.seed) + ")";
+    out.size = sf::Vector2f(width, LEVEL_HEIGHT);
+    out.tileSize = tile;
+    out.spawn = sf::Vector2f(50.f, GROUND_Y - 40.f);
+    out.entryLeft = out.spawn;
+    out.entryRight = sf::Vector2f(width - 100.f, GROUND_Y - 40.f);
+
+    // The ground, then platforms at random over the band above it
+    const size_t platformCount = std::max<size_t>(config.platforms, 1);
+    out.platforms.reserve(platformCount);
+    LevelData::Platform ground;
+    ground.bounds = sf::FloatRect({0.f, GROUND_Y}, {width, LEVEL_HEIGHT - GROUND_Y});
+    out.platforms.push_back(ground);
+    for (size_t i = 1; i < platformCount; ++i) {
+        LevelData::Platform platform;
+        const float platformWidth = std::max(snap(random.uniform(MIN_PLATFORM_WIDTH, MAX_PLATFORM_WIDTH)), tile);
+        const float x = std::min(snap(random.uniform(0.f, width)), width - platformWidth);
+        platform.bounds = sf::FloatRect({x, snap(random.uniform(PLATFORM_TOP, PLATFORM_BOTTOM))}, {platformWidth, tile});
+        out.platforms.push_back(platform);
+    }
+
+    // Ladders run from a platform's middle down to the ground
+    out.ladders.reserve(platformCount > 1 ? config.ladders : 0);
+    for (size_t i = 0; i < config.ladders && platformCount > 1; ++i) {
+        const sf::FloatRect& from = out.platforms[1 + random.index(platformCount - 1)].bounds;
+        LevelData::Ladder ladder;
+        const float x = snap(from.position.x + (from.size.x - tile) * 0.5f);
+        ladder.bounds = sf::FloatRect({x, from.position.y}, {tile, GROUND_Y - from.position.y});
+        out.ladders.push_back(ladder);
+    }
+
+    // Enemies patrol random platforms, the ground included
+    const LevelData::EnemyType& enemyType = out.enemyTypes[0];
+    out.enemies.reserve(config.enemies);
+    for (size_t i = 0; i < config.enemies; ++i) {
+        const sf::FloatRect& home = out.platforms[random.index(platformCount)].bounds;
+        const float span = std::min(home.size.x, MAX_PATROL_SPAN);
+        const float left = home.position.x + random.uniform(0.f, home.size.x - span);
+        LevelData::EnemySpawn enemy;
+        enemy.position = sf::Vector2f(left + span * 0.25f, home.position.y - enemyType.size.y);
+        enemy.patrolWidth = span * 0.5f;
+        out.enemies.push_back(enemy);
+    }
+
+    out.npcs.reserve(config.npcs);
+    for (size_t i = 0; i < config.npcs; ++i) {
+        LevelData::NpcSpawn npc;
+        npc.id = "npc" + std::to_string(i);
+        npc.texture = "npc_idle";
+        npc.position = sf::Vector2f(random.uniform(100.f, width - 100.f), GROUND_Y - 64.f);
+        out.npcs.push_back(npc);
+    }
+
+    // Mostly trees, standing on the ground
+    out.decorations.reserve(config.decorations);
+    for (size_t i = 0; i < config.decorations; ++i) {
+        LevelData::Decoration decoration;
+        const size_t roll = random.index(10);
+        decoration.kind = roll < 7 ? LevelData::DecorationKind::Tree
+            : roll < 9 ? LevelData::DecorationKind::Snowman
+            : LevelData::DecorationKind::Cabin;
+        const float rows = decoration.kind == LevelData::DecorationKind::Tree ? 3.f + random.index(4)
+            : decoration.kind == LevelData::DecorationKind::Cabin ? 4.f : 2.f;
+        decoration.height = rows * tile;
+        decoration.position = sf::Vector2f(snap(random.uniform(0.f, width - 4.f * tile)), GROUND_Y - decoration.height);
+        out.decorations.push_back(decoration);
+    }
+    LevelLoader::resolveDecorations(out);
+    LevelLoader::addDefaultTriggers(out);
+}
+
+} // namespace SceneGenerator
@@ -0,0 +1,258 @@
+#include "SfxMixer.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SFX_MIXER_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SFX_MIXER_NEON 1
+#endif
+
+const char* SfxMixer::kernelName() {
+#if defined(SFX_MIXER_SSE2)
+    return "SSE2";
+#elif defined(SFX_MIXER_NEON)
+    return "NEON";
+#else
+    return "Scalar";
+#endif
+}
+
+std::shared_ptr<const SfxMixer::Sample> SfxMixer::makeSample(const int16_t* pcm, size_t frames, uint32_t channels,
+                                                             uint32_t sampleRate) {
+    if (!pcm || frames == 0 || channels == 0 || sampleRate == 0) {
+        return nullptr;
+    }
+    // Downmix first, at the source rate
+    std::vector<float> mono(frames);
+    const float scale = 1.0f / (32768.0f * static_cast<float>(channels));
+    for (size_t frame = 0; frame < frames; ++frame) {
+        int32_t sum = 0;
+        for (uint32_t channel = 0; channel < channels; ++channel) {
+            sum += pcm[frame * channels + channel];
+        }
+        mono[frame] = static_cast<float>(sum) * scale;
+    }
+
+    auto sample = std::make_shared<Sample>();
+    if (sampleRate == SAMPLE_RATE) {
+        sample->frames = std::move(mono);
+        return sample;
+    }
+    // Linear interpolation is plenty for short effects
+    const double ratio = static_cast<double>(sampleRate) / SAMPLE_RATE;
+    const size_t length = static_cast<size_t>(std::ceil(static_cast<double>(frames) / ratio));
+    sample->frames.resize(length);
+    for (size_t i = 0; i < length; ++i) {
+        const double position = static_cast<double>(i) * ratio;
+        const size_t index = std::min(static_cast<size_t>(position), frames - 1);
+        const float next = index + 1 < frames ? mono[index + 1] : mono[index];
+        sample->frames[i] = mono[index] + (next - mono[index]) * static_cast<float>(position - static_cast<double>(index));
+    }
+    return sample;
+}
+
+SfxMixer::PlayResult SfxMixer::play(std::shared_ptr<const Sample> sample, const void* owner, float gain, float pan,
+                                    float pitch, int maxInstances, size_t startFrame, VoiceHandle* handle) {
+    if (handle) {
+        *handle = NO_VOICE;
+    }
+    if (!sample || startFrame >= sample->frames.size()) {
+        return PlayResult::Dropped;
+    }
+    if (voices.capacity() < MAX_VOICES) {
+        voices.reserve(MAX_VOICES); // Once; voices never reallocate while mixing
+    }
+
+    // At its cap an owner restarts its own oldest voice, as SoundSystem's sources do
+    Voice* target = nullptr;
+    PlayResult result = PlayResult::Started;
+    if (maxInstances > 0) {
+        int instances = 0;
+        for (Voice& voice : voices) {
+            if (voice.owner != owner) continue;
+            instances++;
+            if (!target || voice.startOrder < target->startOrder) {
+                target = &voice;
+            }
+        }
+        if (instances < maxInstances) {
+            target = nullptr;
+        } else {
+            result = PlayResult::Restarted;
+        }
+    }
+    if (!target) {
+        if (voices.size() >= MAX_VOICES) {
+            return PlayResult::Dropped;
+        }
+        target = &voices.emplace_back();
+    }
+
+    target->sample = std::move(sample);
+    target->owner = owner;
+    target->position = static_cast<double>(startFrame);
+    target->step = std::max(pitch, 0.01f);
+    setMix(*target, gain, pan);
+    target->startOrder = ++voiceCounter;
+    if (handle) {
+        *handle = target->startOrder;
+    }
+    return result;
+}
+
+void SfxMixer::setMix(Voice& voice, float gain, float pan) {
+    // Constant power: both sides at 1/sqrt(2) in the middle
+    const float angle = (std::min(std::max(pan, -1.0f), 1.0f) + 1.0f) * 0.785398163f;
+    voice.left = gain * std::cos(angle);
+    voice.right = gain * std::sin(angle);
+}
+
+const SfxMixer::Voice* SfxMixer::findVoice(VoiceHandle handle) const {
+    if (handle == NO_VOICE) {
+        return nullptr;
+    }
+    for (const Voice& voice : voices) {
+        if (voice.startOrder == handle) {
+            return &voice;
+        }
+    }
+    return nullptr;
+}
+
+bool SfxMixer::setVoiceMix(VoiceHandle handle, float gain, float pan) {
+    Voice* voice = findVoice(handle);
+    if (!voice) {
+        return false;
+    }
+    setMix(*voice, gain, pan);
+    return true;
+}
+
+void SfxMixer::stopVoice(VoiceHandle handle) {
+    if (Voice* voice = findVoice(handle)) {
+        *voice = std::move(voices.back());
+        voices.pop_back();
+    }
+}
+
+void SfxMixer::stop() {
+    voices.clear();
+}
+
+void SfxMixer::stop(const void* owner) {
+    voices.erase(std::remove_if(voices.begin(), voices.end(), [owner](const Voice& voice) { return voice.owner == owner; }),
+                 voices.end());
+}
+
+bool SfxMixer::mixVoice(Voice& voice, size_t count) {
+    const std::vector<float>& data = voice.sample->frames;
+    const size_t length = data.size();
+
+    if (voice.step != 1.0f) {
+        // Pitched: linear interpolation between neighbouring frames, one at a time
+        double position = voice.position;
+        for (size_t i = 0; i < count; ++i) {
+            const size_t index = static_cast<size_t>(position);
+            if (index >= length) break;
+            const float next = index + 1 < length ? data[index + 1] : 0.0f;
+            const float value = data[index] + (next - data[index]) * static_cast<float>(position - static_cast<double>(index));
+            mixLeft[i] += value * voice.left;
+            mixRight[i] += value * voice.right;
+            position += voice.step;
+        }
+        voice.position = position;
+        return static_cast<size_t>(position) < length;
+    }
+
+    // Unpitched voices sit on whole frames and read straight through
+    const size_t start = static_cast<size_t>(voice.position);
+    const size_t frames = std::min(count, length - std::min(start, length));
+    const float* source = data.data() + start;
+    float* left = mixLeft.data();
+    float* right = mixRight.data();
+    size_t i = 0;
+#if defined(SFX_MIXER_SSE2)
+    const __m128 gainLeft = _mm_set1_ps(voice.left);
+    const __m128 gainRight = _mm_set1_ps(voice.right);
+    for (; i + 4 <= frames; i += 4) {
+        const __m128 value = _mm_loadu_ps(source + i);
+        _mm_storeu_ps(left + i, _mm_add_ps(_mm_loadu_ps(left + i), _mm_mul_ps(value, gainLeft)));
+        _mm_storeu_ps(right + i, _mm_add_ps(_mm_loadu_ps(right + i), _mm_mul_ps(value, gainRight)));
+    }
+#elif defined(SFX_MIXER_NEON)
+    for (; i + 4 <= frames; i += 4) {
+        const float32x4_t value = vld1q_f32(source + i);
+        vst1q_f32(left + i, vmlaq_n_f32(vld1q_f32(left + i), value, voice.left));
+        vst1q_f32(right + i, vmlaq_n_f32(vld1q_f32(right + i), value, voice.right));
+    }
+#endif
+    // Remaining frames (or everything without SIMD)
+    for (; i < frames; ++i) {
+        left[i] += source[i] * voice.left;
+        right[i] += source[i] * voice.right;
+    }
+    voice.position = static_cast<double>(start + frames);
+    return start + frames < length;
+}
+
+void SfxMixer::mixBlock(int16_t* out) {
+    PROFILE_ZONE("SfxMixer::mixBlock");
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point blockStart = Clock::now();
+
+    mixLeft.fill(0.0f);
+    mixRight.fill(0.0f);
+    stats.voicesLastBlock = voices.size();
+    for (size_t v = 0; v < voices.size();) {
+        if (mixVoice(voices[v], BLOCK_FRAMES)) {
+            ++v;
+        } else {
+            voices[v] = std::move(voices.back());
+            voices.pop_back();
+        }
+    }
+
+    // Clamp, scale and interleave into 16-bit stereo; whole SIMD widths, as the block is
+    static_assert(BLOCK_FRAMES % 4 == 0, "mixBlock converts four frames at a time");
+    size_t i = 0;
+#if defined(SFX_MIXER_SSE2)
+    const __m128 low = _mm_set1_ps(-1.0f);
+    const __m128 high = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    for (; i + 4 <= BLOCK_FRAMES; i += 4) {
+        const __m128 left = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(&mixLeft[i]), low), high), scale);
+        const __m128 right = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(&mixRight[i]), low), high), scale);
+        const __m128i first = _mm_cvtps_epi32(_mm_unpacklo_ps(left, right));   // L0 R0 L1 R1
+        const __m128i second = _mm_cvtps_epi32(_mm_unpackhi_ps(left, right));  // L2 R2 L3 R3
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), _mm_packs_epi32(first, second));
+    }
+#elif defined(SFX_MIXER_NEON)
+    const float32x4_t low = vdupq_n_f32(-1.0f);
+    const float32x4_t high = vdupq_n_f32(1.0f);
+    for (; i + 4 <= BLOCK_FRAMES; i += 4) {
+        const float32x4_t left = vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(&mixLeft[i]), low), high), 32767.0f);
+        const float32x4_t right = vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(&mixRight[i]), low), high), 32767.0f);
+        const float32x4x2_t interleaved = vzipq_f32(left, right);
+        vst1q_s16(out + 2 * i, vcombine_s16(vqmovn_s32(vcvtq_s32_f32(interleaved.val[0])),
+                                            vqmovn_s32(vcvtq_s32_f32(interleaved.val[1]))));
+    }
+#else
+    auto toPcm = [](float value) {
+        return static_cast<int16_t>(std::lround(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f));
+    };
+    for (; i < BLOCK_FRAMES; ++i) {
+        out[2 * i] = toPcm(mixLeft[i]);
+        out[2 * i + 1] = toPcm(mixRight[i]);
+    }
+#endif
+
+    const float blockMs = std::chrono::duration<float, std::milli>(Clock::now() - blockStart).count();
+    stats.blocks++;
+    stats.lastBlockMs = blockMs;
+    stats.averageBlockMs = stats.blocks == 1 ? blockMs : stats.averageBlockMs * 0.95f + blockMs * 0.05f;
+}
@@ -0,0 +1,53 @@
+#include "Simulation.hpp"
+#include "Profiler.hpp"
+#include "FixedPoint.hpp"
+#include "AllocationTracker.hpp"
+
+namespace Simulation {
+
+void step(SimulationWorld& world, float deltaTime) {
+    stepPlayer(world, deltaTime);
+    stepWorld(world, deltaTime);
+}
+
+void stepPlayer(SimulationWorld& world, float deltaTime) {
+    world.player.update(deltaTime, world.platforms);
+}
+
+void stepWorld(SimulationWorld& world, float deltaTime) {
+    if (world.npcs) {
+        AllocationTracker::ScopedTag memoryTag(AllocationTracker::Tag::Npcs);
+        world.npcs->updateAll(deltaTime);
+        world.physics.updateNPCs(world.npcs->getAllNPCs(), deltaTime);
+        world.npcs->updateSpatialIndex();
+    }
+    AllocationTracker::ScopedTag memoryTag(AllocationTracker::Tag::Physics);
+    
+    // Each enemy only touches its own state, so chunks of the store update in
+    // parallel. Sleepers are skipped; PhysicsSystem clears and sets 'awake' itself.
+    if (world.updateEnemies) {
+        // Far enemies go coarse, near ones come back, before anything steps them
+        world.physics.updateRegions(world.enemies, world.focus, deltaTime);
+        PROFILE_ZONE("EnemyStore::update");
+        world.jobs.parallelFor(world.enemies.size(), ENEMY_UPDATE_GRAIN, [&](size_t begin, size_t end) {
+            world.enemies.update(begin, end, deltaTime, world.platforms);
+        });
+    }
+    
+    world.physics.update(deltaTime, world.player, world.enemies);
+    snapState(world);
+}
+
+void snapState(SimulationWorld& world) {
+    // Compiles to nothing unless GAME_FIXED_POINT
+    if constexpr (FixedPoint::ENABLED) {
+        world.player.snapState();
+        world.enemies.snapState();
+        world.physics.snapState();
+        if (world.npcs) {
+            world.npcs->snapState();
+        }
+    }
+}
+
+} // namespace Simulation
@@ -1,29 +1,36 @@
 #include "SoundSystem.h"
+#include "Profiler.hpp"
+#include "AssetPack.hpp"
+#include "FileWatcher.hpp"
+#include "AllocationTracker.hpp"
+#include "MappedFile.hpp"
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
 
-// WAV header structure
-struct WAVHeader {
-    char riff[4];          // "RIFF"
-    uint32_t fileSize;     // File size - 8
-    char wave[4];          // "WAVE"
-    char fmt[4];           // "fmt "
-    uint32_t fmtSize;      // Format chunk size
-    uint16_t format;       // Format tag
-    uint16_t channels;     // Number of channels
-    uint32_t sampleRate;   // Sample rate
-    uint32_t byteRate;     // Bytes per second
-    uint16_t blockAlign;   // Block alignment
-    uint16_t bitsPerSample;// Bits per sample
-};
+namespace {
+
+uint16_t readU16(const char* p) {
+    uint16_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t readU32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+} // namespace
 
 SoundSystem::SoundSystem()
     : device(nullptr)
     , context(nullptr)
-    , musicSource(0)
-    , currentMusicBuffer(0)
     , masterVolume(1.0f)
     , musicVolume(1.0f)
     , soundEffectVolume(1.0f) {
@@ -60,14 +67,16 @@ bool SoundSystem::initialize() {
     }
     std::cout << "Successfully made audio context current" << std::endl;
 
-    // Generate source for background music
-    alGenSources(1, &musicSource);
+    // Generate a source for each music deck
+    for (MusicDeck& deck : musicDecks) {
+        alGenSources(1, &deck.source);
+    }
     ALenum error = alGetError();
     if (error != AL_NO_ERROR) {
-        std::cerr << "Failed to generate music source: " << error << std::endl;
+        std::cerr << "Failed to generate music sources: " << error << std::endl;
         return false;
     }
-    std::cout << "Successfully generated music source" << std::endl;
+    std::cout << "Successfully generated music sources" << std::endl;
     
     // Generate sources for sound effects
     alGenSources(MAX_SOUND_SOURCES, soundSources);
@@ -78,19 +87,26 @@ bool SoundSystem::initialize() {
     }
     std::cout << "Successfully generated " << MAX_SOUND_SOURCES << " sound effect sources" << std::endl;
 
-    // Set initial properties for music source
-    alSourcef(musicSource, AL_GAIN, masterVolume * musicVolume);
-    alSourcei(musicSource, AL_LOOPING, AL_FALSE);
+    // Set initial properties for the music sources
+    musicGain = masterVolume * musicVolume;
+    effectsGain = masterVolume * soundEffectVolume;
+    for (MusicDeck& deck : musicDecks) {
+        applyMusicGain(deck);
+        alSourcei(deck.source, AL_LOOPING, AL_FALSE);
+    }
     error = alGetError();
     if (error != AL_NO_ERROR) {
         std::cerr << "Failed to set music source properties: " << error << std::endl;
         return false;
     }
 
-    // Set initial properties for sound effect sources
+    // Set initial properties for sound effect sources (listener-relative, so a position is a pan)
     for (int i = 0; i < MAX_SOUND_SOURCES; ++i) {
-        alSourcef(soundSources[i], AL_GAIN, masterVolume * soundEffectVolume);
+        alSourcef(soundSources[i], AL_GAIN, effectsGain);
         alSourcei(soundSources[i], AL_LOOPING, AL_FALSE);
+        alSourcei(soundSources[i], AL_SOURCE_RELATIVE, AL_TRUE);
+        voices[i] = Voice();
+        voices[i].source = soundSources[i];
     }
     error = alGetError();
     if (error != AL_NO_ERROR) {
@@ -98,56 +114,121 @@ bool SoundSystem::initialize() {
         return false;
     }
 
-    return true;
-}
-
-bool SoundSystem::loadWavFile(const std::string& filePath, ALuint& buffer) {
-    std::cout << "Loading WAV file: " << filePath << std::endl;
+    // Buffers for streamed music
+    for (MusicDeck& deck : musicDecks) {
+        alGenBuffers(MUSIC_STREAM_BUFFERS, deck.buffers.data());
+    }
+    error = alGetError();
+    if (error != AL_NO_ERROR) {
+        std::cerr << "Failed to generate music stream buffers: " << error << std::endl;
+        return false;
+    }
     
-    std::ifstream file(filePath, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open WAV file: " << filePath << std::endl;
+    // The software bus: one more source, fed mixed stereo blocks
+    alGenSources(1, &mixSource);
+    alGenBuffers(MIX_STREAM_BUFFERS, mixStreamBuffers.data());
+    error = alGetError();
+    if (error != AL_NO_ERROR) {
+        std::cerr << "Failed to generate the effects mix source: " << error << std::endl;
         return false;
     }
+    alSourcef(mixSource, AL_GAIN, effectsGain);
+    alSourcei(mixSource, AL_SOURCE_RELATIVE, AL_TRUE);
+    idleMixBuffers.assign(mixStreamBuffers.begin(), mixStreamBuffers.end());
+    mixBlock.resize(SfxMixer::BLOCK_FRAMES * 2);
+    std::cout << "Software effects bus: " << SfxMixer::MAX_VOICES << " voices, " << SfxMixer::kernelName()
+              << " mixing" << std::endl;
+    
+    // From here on every playback call on a source happens on the audio thread
+    stopAudioThread = false;
+    audioThread = std::thread(&SoundSystem::audioThreadLoop, this);
 
-    // Read WAV header
-    WAVHeader header;
-    file.read(reinterpret_cast<char*>(&header), sizeof(WAVHeader));
+    return true;
+}
 
-    // Verify RIFF header
-    if (strncmp(header.riff, "RIFF", 4) != 0 || strncmp(header.wave, "WAVE", 4) != 0) {
+bool SoundSystem::parseWav(const char* data, size_t available, size_t totalSize, const std::string& filePath, WavInfo& info) {
+    // RIFF container: "RIFF", size, "WAVE", then chunks of id, size and a body
+    // padded to an even length. Parsed in place; nothing is copied.
+    if (available < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0) {
         std::cerr << "Invalid WAV file format: " << filePath << std::endl;
-        std::cerr << "RIFF header: " << std::string(header.riff, 4) << std::endl;
-        std::cerr << "WAVE header: " << std::string(header.wave, 4) << std::endl;
         return false;
     }
-    std::cout << "WAV format verified: " << filePath << std::endl;
-    std::cout << "Channels: " << header.channels << std::endl;
-    std::cout << "Sample rate: " << header.sampleRate << std::endl;
-    std::cout << "Bits per sample: " << header.bitsPerSample << std::endl;
 
-    // Find data chunk
-    char chunkId[4];
-    uint32_t chunkSize;
-    while (file.read(chunkId, 4) && file.read(reinterpret_cast<char*>(&chunkSize), 4)) {
-        if (strncmp(chunkId, "data", 4) == 0) {
-            break;
+    bool foundFormat = false;
+    size_t position = 12;
+    while (position + 8 <= available) {
+        const char* chunk = data + position;
+        const uint32_t chunkSize = readU32(chunk + 4);
+        position += 8;
+        if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            if (chunkSize < 16 || position + 16 > available) {
+                std::cerr << "Truncated format chunk in WAV file: " << filePath << std::endl;
+                return false;
+            }
+            const uint16_t formatTag = readU16(data + position);
+            info.channels = readU16(data + position + 2);
+            info.sampleRate = readU32(data + position + 4);
+            info.bitsPerSample = readU16(data + position + 14);
+            foundFormat = true;
+            // PCM only (WAVE_FORMAT_EXTENSIBLE wraps PCM too); 8 or 16 bits, mono or stereo
+            if ((formatTag != 1 && formatTag != 0xFFFE) || (info.bitsPerSample != 8 && info.bitsPerSample != 16) ||
+                info.channels < 1 || info.channels > 2) {
+                std::cerr << "Unsupported WAV format in " << filePath << ": tag " << formatTag << ", "
+                          << info.channels << " channels, " << info.bitsPerSample << " bits" << std::endl;
+                return false;
+            }
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (!foundFormat) {
+                std::cerr << "Data chunk before format chunk in WAV file: " << filePath << std::endl;
+                return false;
+            }
+            if (chunkSize > totalSize - position) {
+                std::cerr << "Failed to read all audio data. Expected " << chunkSize << " bytes, got "
+                          << (totalSize - position) << std::endl;
+                return false;
+            }
+            info.dataOffset = position;
+            info.dataSize = chunkSize;
+            return true;
         }
-        // Skip this chunk
-        file.seekg(chunkSize, std::ios::cur);
+        // Skip this chunk and its pad byte
+        position += static_cast<size_t>(chunkSize) + (chunkSize & 1);
     }
 
-    if (strncmp(chunkId, "data", 4) != 0) {
-        std::cerr << "No data chunk found in WAV file: " << filePath << std::endl;
-        return false;
+    std::cerr << "No " << (foundFormat ? "data" : "format") << " chunk found in WAV file: " << filePath << std::endl;
+    return false;
+}
+
+ALenum SoundSystem::WavInfo::getFormat() const {
+    // Determine format based on channels and bits per sample
+    if (channels == 1) {
+        return (bitsPerSample == 8) ? AL_FORMAT_MONO8 : AL_FORMAT_MONO16;
+    }
+    return (bitsPerSample == 8) ? AL_FORMAT_STEREO8 : AL_FORMAT_STEREO16;
+}
+
+bool SoundSystem::loadWavFile(const std::string& filePath, ALuint& buffer,
+                              std::shared_ptr<const SfxMixer::Sample>& mixSample) {
+    std::cout << "Loading WAV file: " << filePath << std::endl;
+    
+    // Parsed in place from the pack mapping or the file's own; no copy before OpenAL's
+    const char* fileData = nullptr;
+    size_t fileSize = 0;
+    MappedFile looseFile;
+    if (AssetPack::Blob blob = AssetPack::instance().find(filePath)) {
+        fileData = blob.data;
+        fileSize = blob.size;
+    } else {
+        if (!looseFile.open(filePath)) {
+            std::cerr << "Failed to open WAV file: " << filePath << std::endl;
+            return false;
+        }
+        fileData = looseFile.data();
+        fileSize = looseFile.size();
     }
-    std::cout << "Found data chunk, size: " << chunkSize << " bytes" << std::endl;
 
-    // Read audio data
-    std::vector<char> data(chunkSize);
-    file.read(data.data(), chunkSize);
-    if (file.gcount() != chunkSize) {
-        std::cerr << "Failed to read all audio data. Expected " << chunkSize << " bytes, got " << file.gcount() << std::endl;
+    WavInfo info;
+    if (!parseWav(fileData, fileSize, fileSize, filePath, info)) {
         return false;
     }
 
@@ -159,70 +240,576 @@ bool SoundSystem::loadWavFile(const std::string& filePath, ALuint& buffer) {
         return false;
     }
     
-    // Determine format based on channels and bits per sample
-    ALenum format;
-    if (header.channels == 1) {
-        format = (header.bitsPerSample == 8) ? AL_FORMAT_MONO8 : AL_FORMAT_MONO16;
-    } else {
-        format = (header.bitsPerSample == 8) ? AL_FORMAT_STEREO8 : AL_FORMAT_STEREO16;
-    }
+    ALenum format = info.getFormat();
     std::cout << "Using format: " << (format == AL_FORMAT_MONO8 ? "MONO8" : 
                                     format == AL_FORMAT_MONO16 ? "MONO16" :
                                     format == AL_FORMAT_STEREO8 ? "STEREO8" : "STEREO16") << std::endl;
 
-    alBufferData(buffer, format, data.data(), chunkSize, header.sampleRate);
+    alBufferData(buffer, format, fileData + info.dataOffset, static_cast<ALsizei>(info.dataSize), static_cast<ALsizei>(info.sampleRate));
     error = alGetError();
     if (error != AL_NO_ERROR) {
         std::cerr << "Failed to fill OpenAL buffer: " << error << std::endl;
         alDeleteBuffers(1, &buffer);
         return false;
     }
+    
+    // The software bus mixes from its own float copy. Chunks start on even
+    // offsets, so 16-bit samples are read straight from the mapping.
+    const char* samples = fileData + info.dataOffset;
+    if (info.bitsPerSample == 16) {
+        const size_t count = info.dataSize / sizeof(std::int16_t);
+        mixSample = SfxMixer::makeSample(reinterpret_cast<const std::int16_t*>(samples), count / info.channels,
+                                         info.channels, info.sampleRate);
+    } else {
+        std::vector<std::int16_t> pcm(info.dataSize);
+        for (size_t i = 0; i < pcm.size(); ++i) {
+            pcm[i] = static_cast<std::int16_t>((static_cast<int>(static_cast<uint8_t>(samples[i])) - 128) * 256);
+        }
+        mixSample = SfxMixer::makeSample(pcm.data(), pcm.size() / info.channels, info.channels, info.sampleRate);
+    }
     std::cout << "Successfully loaded WAV file: " << filePath << std::endl;
 
     return true;
 }
 
+bool SoundSystem::isCompressedAudio(const std::string& filePath) {
+    AssetPack::Format format = AssetPack::formatFromExtension(filePath);
+    return format == AssetPack::Format::Ogg || format == AssetPack::Format::Flac;
+}
+
+std::string SoundSystem::resolveAudioPath(const std::string& stem) {
+    // Compressed variants win so shipping .ogg/.flac next to (or instead of) .wav just works
+    for (const char* extension : {".ogg", ".flac", ".wav"}) {
+        std::string path = stem + extension;
+        std::error_code ec;
+        if (AssetPack::instance().find(path) || std::filesystem::is_regular_file(path, ec)) {
+            return path;
+        }
+    }
+    return stem + ".wav";
+}
+
+bool SoundSystem::openDecoder(const std::string& filePath, const char* packedData, size_t packedSize, sf::InputSoundFile& decoder) {
+    bool opened = packedData ? decoder.openFromMemory(packedData, packedSize) : decoder.openFromFile(filePath);
+    if (!opened) {
+        std::cerr << "Failed to open compressed audio file: " << filePath << std::endl;
+        return false;
+    }
+    if (decoder.getChannelCount() < 1 || decoder.getChannelCount() > 2) {
+        std::cerr << "Unsupported channel count " << decoder.getChannelCount() << " in: " << filePath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool SoundSystem::loadCompressedFile(const std::string& filePath, ALuint& buffer,
+                                     std::shared_ptr<const SfxMixer::Sample>& mixSample) {
+    std::cout << "Loading compressed audio file: " << filePath << std::endl;
+    
+    AssetPack::Blob blob = AssetPack::instance().find(filePath);
+    sf::InputSoundFile decoder;
+    if (!openDecoder(filePath, blob.data, blob.size, decoder)) {
+        return false;
+    }
+    
+    // Decode the whole effect to 16-bit PCM once
+    std::vector<std::int16_t> samples(static_cast<size_t>(decoder.getSampleCount()));
+    const std::uint64_t decoded = decoder.read(samples.data(), samples.size());
+    if (decoded == 0) {
+        std::cerr << "No audio data decoded from: " << filePath << std::endl;
+        return false;
+    }
+    
+    WavInfo info;
+    info.channels = static_cast<uint16_t>(decoder.getChannelCount());
+    info.sampleRate = decoder.getSampleRate();
+    info.bitsPerSample = 16;
+    
+    alGenBuffers(1, &buffer);
+    ALenum error = alGetError();
+    if (error != AL_NO_ERROR) {
+        std::cerr << "Failed to generate OpenAL buffer: " << error << std::endl;
+        return false;
+    }
+    alBufferData(buffer, info.getFormat(), samples.data(), static_cast<ALsizei>(decoded * sizeof(std::int16_t)),
+                 static_cast<ALsizei>(info.sampleRate));
+    error = alGetError();
+    if (error != AL_NO_ERROR) {
+        std::cerr << "Failed to fill OpenAL buffer: " << error << std::endl;
+        alDeleteBuffers(1, &buffer);
+        return false;
+    }
+    mixSample = SfxMixer::makeSample(samples.data(), static_cast<size_t>(decoded) / info.channels, info.channels,
+                                     info.sampleRate);
+    std::cout << "Successfully loaded compressed audio file: " << filePath << std::endl;
+    return true;
+}
+
 bool SoundSystem::loadMusic(const std::string& name, const std::string& filePath) {
+    AllocationTracker::ScopedTag memoryTag(AllocationTracker::Tag::Audio);
     std::cout << "Loading music: " << name << " from " << filePath << std::endl;
-    ALuint buffer;
-    if (!loadWavFile(filePath, buffer)) {
+    MusicTrack track;
+    track.filePath = filePath;
+    if (!probeMusic(filePath, track)) {
         return false;
     }
     
-    // Store the buffer
-    musicBuffers[name] = buffer;
-    std::cout << "Successfully stored music buffer: " << name << std::endl;
+    // Store the track; a stream still playing the old one keeps its own reference
+    musicTracks[name] = std::make_shared<const MusicTrack>(std::move(track));
+    std::cout << "Successfully registered streamed music: " << name << std::endl;
+    return true;
+}
+
+bool SoundSystem::probeMusic(const std::string& filePath, MusicTrack& track) {
+    // Only the header is read here; the PCM data is streamed during playback
+    if (isCompressedAudio(filePath)) {
+        AssetPack::Blob blob = AssetPack::instance().find(filePath);
+        sf::InputSoundFile probe;
+        if (!openDecoder(filePath, blob.data, blob.size, probe)) {
+            return false;
+        }
+        track.packedData = blob.data;
+        track.packedSize = blob.size;
+        track.compressed = true;
+        track.info.channels = static_cast<uint16_t>(probe.getChannelCount());
+        track.info.sampleRate = probe.getSampleRate();
+        track.info.bitsPerSample = 16;
+        track.info.dataSize = static_cast<size_t>(probe.getSampleCount() * sizeof(std::int16_t));
+    } else if (AssetPack::Blob blob = AssetPack::instance().find(filePath)) {
+        track.packedData = blob.data;
+        track.packedSize = blob.size;
+        if (!parseWav(blob.data, blob.size, blob.size, filePath, track.info)) {
+            return false;
+        }
+    } else {
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open WAV file: " << filePath << std::endl;
+            return false;
+        }
+        const size_t totalSize = static_cast<size_t>(file.tellg());
+        std::vector<char> header(std::min(totalSize, MUSIC_CHUNK_BYTES));
+        file.seekg(0);
+        file.read(header.data(), static_cast<std::streamsize>(header.size()));
+        if (!parseWav(header.data(), static_cast<size_t>(file.gcount()), totalSize, filePath, track.info)) {
+            return false;
+        }
+    }
     return true;
 }
 
 bool SoundSystem::loadSoundEffect(const std::string& name, const std::string& filePath) {
+    AllocationTracker::ScopedTag memoryTag(AllocationTracker::Tag::Audio);
     std::cout << "Loading sound effect: " << name << " from " << filePath << std::endl;
     ALuint buffer;
-    if (!loadWavFile(filePath, buffer)) {
+    std::shared_ptr<const SfxMixer::Sample> mixSample;
+    // Compressed effects are decoded once here; playback never touches the decoder
+    if (!(isCompressedAudio(filePath) ? loadCompressedFile(filePath, buffer, mixSample)
+                                      : loadWavFile(filePath, buffer, mixSample))) {
         return false;
     }
     
-    // Store the buffer
-    soundBuffers[name] = buffer;
+    // Keeps any settings made for this name
+    ALint bufferSize = 0;
+    alGetBufferi(buffer, AL_SIZE, &bufferSize);
+    SoundEffect& effect = soundEffects[name];
+    const bool replacing = !effect.filePath.empty(); // 'buffer' itself may be mid-swap on the audio thread
+    effect.filePath = filePath;
+    effect.bufferBytes = static_cast<size_t>(std::max(bufferSize, 0));
+    if (replacing && audioThread.joinable()) {
+        // The audio thread may be playing the old buffer; it swaps and frees it
+        AudioCommand command;
+        command.type = AudioCommand::Type::ReplaceEffectBuffer;
+        command.effect = &effect;
+        command.buffer = buffer;
+        command.sample = std::move(mixSample);
+        sendCommand(std::move(command));
+    } else {
+        if (effect.buffer != 0) {
+            alDeleteBuffers(1, &effect.buffer);
+        }
+        effect.buffer = buffer;
+        effect.mixSample = std::move(mixSample);
+    }
     std::cout << "Successfully stored sound effect buffer: " << name << std::endl;
     return true;
 }
 
+size_t SoundSystem::getBufferBytes() const {
+    size_t bytes = 0;
+    for (const auto& [name, effect] : soundEffects) {
+        bytes += effect.bufferBytes;
+    }
+    // Stream buffers are allocated whole; 16-bit stereo at most
+    bytes += musicDecks.size() * MUSIC_STREAM_BUFFERS * MUSIC_CHUNK_BYTES;
+    bytes += MIX_STREAM_BUFFERS * SfxMixer::BLOCK_FRAMES * 2 * sizeof(int16_t);
+    return bytes;
+}
+
+size_t SoundSystem::reloadFile(const std::string& path) {
+    size_t reloaded = 0;
+    for (auto& [name, effect] : soundEffects) {
+        const std::string filePath = effect.filePath;
+        if (!filePath.empty() && FileWatcher::isSameFile(filePath, path) && loadSoundEffect(name, filePath)) {
+            reloaded++;
+        }
+    }
+    for (auto& [name, track] : musicTracks) {
+        const std::string filePath = track->filePath;
+        if (FileWatcher::isSameFile(filePath, path) && loadMusic(name, filePath)) {
+            reloaded++;
+            // The stream holds the old track; play the new one from the start
+            if (name == currentMusic) {
+                playMusic(name, currentMusicLoop);
+            }
+        }
+    }
+    return reloaded;
+}
+
+void SoundSystem::sendCommand(AudioCommand&& command) {
+    // The whole game-thread cost of a playback call; drop rather than wait when full
+    if (!commandQueue.push(std::move(command))) {
+        commandsDropped++;
+    }
+}
+
 void SoundSystem::playMusic(const std::string& name, bool loop) {
-    auto it = musicBuffers.find(name);
-    if (it == musicBuffers.end()) {
+    auto it = musicTracks.find(name);
+    if (it == musicTracks.end()) {
         std::cerr << "Music not found: " << name << std::endl;
         return;
     }
+    currentMusic = name;
+    currentMusicLoop = loop;
+    AudioCommand command;
+    command.type = AudioCommand::Type::PlayMusic;
+    command.track = it->second;
+    command.loop = loop;
+    sendCommand(std::move(command));
+}
+
+void SoundSystem::stopMusic() {
+    currentMusic.clear();
+    AudioCommand command;
+    command.type = AudioCommand::Type::StopMusic;
+    sendCommand(std::move(command));
+}
+
+void SoundSystem::prefetchMusic(const std::string& stem) {
+    AudioCommand command;
+    command.type = AudioCommand::Type::PrefetchMusic;
+    command.stem = stem;
+    sendCommand(std::move(command));
+}
+
+void SoundSystem::crossfadeMusic(const std::string& stem, float seconds, bool loop) {
+    currentMusic.clear(); // Not a registered track, so a reload leaves it playing
+    AudioCommand command;
+    command.type = AudioCommand::Type::CrossfadeMusic;
+    command.stem = stem;
+    command.value = seconds;
+    command.loop = loop;
+    sendCommand(std::move(command));
+}
+
+void SoundSystem::pauseMusic() {
+    AudioCommand command;
+    command.type = AudioCommand::Type::PauseMusic;
+    sendCommand(std::move(command));
+}
+
+void SoundSystem::resumeMusic() {
+    AudioCommand command;
+    command.type = AudioCommand::Type::ResumeMusic;
+    sendCommand(std::move(command));
+}
+
+void SoundSystem::setMusicPitch(float pitch) {
+    AudioCommand command;
+    command.type = AudioCommand::Type::SetMusicPitch;
+    command.value = pitch;
+    sendCommand(std::move(command));
+}
+
+void SoundSystem::setSoundEffectSettings(const std::string& name, const SoundEffectSettings& settings) {
+    // The entry is created here so the pointer exists; the audio thread applies the settings
+    AudioCommand command;
+    command.type = AudioCommand::Type::SetEffectSettings;
+    command.effect = &soundEffects[name];
+    command.settings = settings;
+    sendCommand(std::move(command));
+}
+
+void SoundSystem::playSoundEffect(const std::string& name, float pitch, float pan) {
+    auto it = soundEffects.find(name);
+    if (it == soundEffects.end() || it->second.buffer == 0) {
+        std::cerr << "Sound effect not found: " << name << std::endl;
+        return;
+    }
+    AudioCommand command;
+    command.type = AudioCommand::Type::PlayEffect;
+    command.effect = &it->second;
+    command.time = std::chrono::steady_clock::now(); // Rate limiting uses trigger time, not arrival
+    command.value = pitch;
+    command.pan = pan;
+    sendCommand(std::move(command));
+}
+
+void SoundSystem::playSoundEffectAt(const std::string& name, const sf::Vector2f& position, float pitch) {
+    auto it = soundEffects.find(name);
+    if (it == soundEffects.end() || it->second.buffer == 0) {
+        std::cerr << "Sound effect not found: " << name << std::endl;
+        return;
+    }
+    AudioCommand command;
+    command.type = AudioCommand::Type::PlayEffectAt;
+    command.effect = &it->second;
+    command.time = std::chrono::steady_clock::now(); // Also the time virtual voices resume from
+    command.value = pitch;
+    command.position = position;
+    sendCommand(std::move(command));
+}
 
-    // Stop currently playing music
-    stopMusic();
+void SoundSystem::setListener(const sf::Vector2f& position) {
+    AudioCommand command;
+    command.type = AudioCommand::Type::SetListener;
+    command.position = position;
+    sendCommand(std::move(command));
+}
+
+void SoundSystem::stopSoundEffects() {
+    AudioCommand command;
+    command.type = AudioCommand::Type::StopEffects;
+    sendCommand(std::move(command));
+}
+
+void SoundSystem::setMasterVolume(float volume) {
+    masterVolume = volume;
+    setMusicVolume(musicVolume);
+    setSoundEffectVolume(soundEffectVolume);
+}
+
+void SoundSystem::setMusicVolume(float volume) {
+    musicVolume = volume;
+    AudioCommand command;
+    command.type = AudioCommand::Type::SetMusicGain;
+    command.value = masterVolume * musicVolume;
+    sendCommand(std::move(command));
+}
+
+void SoundSystem::setSoundEffectVolume(float volume) {
+    soundEffectVolume = volume;
+    AudioCommand command;
+    command.type = AudioCommand::Type::SetEffectGain;
+    command.value = masterVolume * soundEffectVolume;
+    sendCommand(std::move(command));
+}
+
+void SoundSystem::update() {
+    // Commands are already queued; this just saves them waiting out the poll interval
+    audioCondition.notify_one();
+}
+
+SoundSystem::VoiceStats SoundSystem::getVoiceStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return publishedVoiceStats;
+}
+
+SoundSystem::AudioThreadStats SoundSystem::getAudioThreadStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    AudioThreadStats stats = publishedThreadStats;
+    stats.commandsDropped = commandsDropped;
+    return stats;
+}
+
+void SoundSystem::audioThreadLoop() {
+    PROFILE_THREAD("Audio");
+    AllocationTracker::setThreadTag(AllocationTracker::Tag::Audio);
+    using Clock = std::chrono::steady_clock;
+    AudioThreadStats stats;
+    float windowPeakMs = 0.0f;
+    Clock::time_point windowStart = Clock::now();
+    
+    std::unique_lock<std::mutex> lock(audioMutex);
+    while (!stopAudioThread) {
+        audioCondition.wait_for(lock, AUDIO_THREAD_POLL);
+        if (stopAudioThread) {
+            break;
+        }
+        lock.unlock();
+        
+        PROFILE_ZONE("Audio tick");
+        const Clock::time_point tickStart = Clock::now();
+        AudioCommand command;
+        while (commandQueue.pop(command)) {
+            executeCommand(command);
+            command.track.reset(); // Don't pin a replaced track until the next command
+            stats.commands++;
+        }
+        refreshVoices();
+        updatePositionalVoices();
+        streamMusic();
+        streamMix();
+        const Clock::time_point tickEnd = Clock::now();
+        
+        const float tickMs = std::chrono::duration<float, std::milli>(tickEnd - tickStart).count();
+        stats.ticks++;
+        stats.lastTickMs = tickMs;
+        stats.averageTickMs = stats.ticks == 1 ? tickMs : stats.averageTickMs * 0.95f + tickMs * 0.05f;
+        windowPeakMs = std::max(windowPeakMs, tickMs);
+        stats.mixBlockMs = mixer.getStats().averageBlockMs;
+        stats.mixBlocks = mixer.getStats().blocks;
+        voiceStats.mixedVoices = static_cast<int>(mixer.getActiveVoices());
+        if (tickEnd - windowStart >= std::chrono::seconds(1)) {
+            stats.peakTickMs = windowPeakMs;
+            windowPeakMs = 0.0f;
+            windowStart = tickEnd;
+        }
+        {
+            std::lock_guard<std::mutex> statsLock(statsMutex);
+            publishedVoiceStats = voiceStats;
+            publishedThreadStats = stats;
+        }
+        
+        lock.lock();
+    }
+}
+
+void SoundSystem::executeCommand(AudioCommand& command) {
+    switch (command.type) {
+        case AudioCommand::Type::PlayEffect: {
+            PlayedVoice played;
+            startEffect(*command.effect, command.value, command.pan, 1.0f, command.time, played);
+            break;
+        }
+        case AudioCommand::Type::PlayEffectAt:
+            startPositionalEffect(*command.effect, command.position, command.value, command.time);
+            break;
+        case AudioCommand::Type::SetListener:
+            listener = command.position;
+            break;
+        case AudioCommand::Type::StopEffects:
+            for (auto& voice : voices) {
+                if (voice.busy) {
+                    alSourceStop(voice.source);
+                    voice.busy = false;
+                    voice.effect = nullptr;
+                }
+            }
+            voiceStats.activeVoices = 0;
+            mixer.stop();
+            voiceStats.mixedVoices = 0;
+            positionalVoices.clear();
+            voiceStats.virtualVoices = 0;
+            break;
+        case AudioCommand::Type::SetEffectSettings:
+            command.effect->settings = command.settings;
+            // Voices already playing this effect pick up the new volume (mixed ones
+            // are short and keep theirs)
+            for (const auto& voice : voices) {
+                if (voice.busy && voice.effect == command.effect) {
+                    alSourcef(voice.source, AL_GAIN, getVoiceGain(voice));
+                }
+            }
+            break;
+        case AudioCommand::Type::SetEffectGain:
+            effectsGain = command.value;
+            alSourcef(mixSource, AL_GAIN, effectsGain);
+            for (const auto& voice : voices) {
+                float gain = effectsGain;
+                if (voice.busy && voice.effect) {
+                    gain = getVoiceGain(voice);
+                }
+                alSourcef(voice.source, AL_GAIN, gain);
+            }
+            break;
+        case AudioCommand::Type::PlayMusic:
+            startMusic(std::move(command.track), command.loop);
+            break;
+        case AudioCommand::Type::StopMusic:
+            musicFade.active = false;
+            for (MusicDeck& deck : musicDecks) {
+                resetMusicStream(deck);
+            }
+            if (ALenum error = alGetError(); error != AL_NO_ERROR) {
+                std::cerr << "Failed to stop music: " << error << std::endl;
+            }
+            break;
+        case AudioCommand::Type::PauseMusic:
+            finishMusicFade();
+            musicDecks[currentDeck].paused = true;
+            alSourcePause(musicDecks[currentDeck].source);
+            if (ALenum error = alGetError(); error != AL_NO_ERROR) {
+                std::cerr << "Failed to pause music: " << error << std::endl;
+            }
+            break;
+        case AudioCommand::Type::ResumeMusic: {
+            MusicDeck& deck = musicDecks[currentDeck];
+            ALint state;
+            alGetSourcei(deck.source, AL_SOURCE_STATE, &state);
+            if (state == AL_PAUSED) {
+                deck.paused = false;
+                alSourcePlay(deck.source);
+                if (ALenum error = alGetError(); error != AL_NO_ERROR) {
+                    std::cerr << "Failed to resume music: " << error << std::endl;
+                }
+            }
+            break;
+        }
+        case AudioCommand::Type::SetMusicGain:
+            musicGain = command.value;
+            for (MusicDeck& deck : musicDecks) {
+                applyMusicGain(deck);
+            }
+            break;
+        case AudioCommand::Type::SetMusicPitch:
+            for (MusicDeck& deck : musicDecks) {
+                alSourcef(deck.source, AL_PITCH, command.value);
+            }
+            break;
+        case AudioCommand::Type::PrefetchMusic:
+            prefetchMusicFile(resolveAudioPath(command.stem), true);
+            break;
+        case AudioCommand::Type::CrossfadeMusic:
+            crossfadeMusicFile(resolveAudioPath(command.stem), command.value, command.loop);
+            break;
+        case AudioCommand::Type::ReplaceEffectBuffer:
+            // A buffer can't be deleted while any source, even a stopped one, has it attached
+            for (auto& voice : voices) {
+                ALint attached = 0;
+                alGetSourcei(voice.source, AL_BUFFER, &attached);
+                if (static_cast<ALuint>(attached) == command.effect->buffer) {
+                    alSourceStop(voice.source);
+                    alSourcei(voice.source, AL_BUFFER, 0);
+                    voice.busy = false; // activeVoices is recounted by refreshVoices
+                    voice.effect = nullptr;
+                }
+            }
+            alDeleteBuffers(1, &command.effect->buffer);
+            command.effect->buffer = command.buffer;
+            mixer.stop(command.effect);
+            command.effect->mixSample = std::move(command.sample);
+            positionalVoices.erase(std::remove_if(positionalVoices.begin(), positionalVoices.end(),
+                                                  [&](const PositionalVoice& positional) {
+                                                      return positional.effect == command.effect;
+                                                  }),
+                                   positionalVoices.end());
+            break;
+    }
+}
 
-    // Attach new buffer and play
-    currentMusicBuffer = it->second;
-    alSourcei(musicSource, AL_BUFFER, currentMusicBuffer);
-    alSourcei(musicSource, AL_LOOPING, loop ? AL_TRUE : AL_FALSE);
-    alSourcePlay(musicSource);
+void SoundSystem::startMusic(std::shared_ptr<const MusicTrack> track, bool loop) {
+    // Stop currently playing music, and any track faded out or waiting on the other deck
+    musicFade.active = false;
+    resetMusicStream(musicDecks[1 - currentDeck]);
+    MusicDeck& deck = musicDecks[currentDeck];
+    if (!openMusic(deck, std::move(track), loop)) {
+        return;
+    }
+    applyMusicGain(deck);
+    deck.primed = false;
+    alSourcePlay(deck.source);
     
     // Check for errors
     ALenum error = alGetError();
@@ -230,104 +817,600 @@ void SoundSystem::playMusic(const std::string& name, bool loop) {
         std::cerr << "Failed to play music: " << error << std::endl;
         return;
     }
-    std::cout << "Started playing music: " << name << " (loop: " << (loop ? "true" : "false") << ")" << std::endl;
+    std::cout << "Started playing music: " << deck.track->filePath << " (loop: " << (loop ? "true" : "false") << ")" << std::endl;
 }
 
-void SoundSystem::stopMusic() {
-    alSourceStop(musicSource);
-    ALenum error = alGetError();
-    if (error != AL_NO_ERROR) {
-        std::cerr << "Failed to stop music: " << error << std::endl;
+bool SoundSystem::openMusic(MusicDeck& deck, std::shared_ptr<const MusicTrack> track, bool loop) {
+    resetMusicStream(deck);
+    deck.track = std::move(track);
+    deck.loop = loop; // Looping is done by the decoder; a queued source can't loop itself
+    if (deck.track->compressed) {
+        deck.decoder = std::make_unique<sf::InputSoundFile>();
+        if (!openDecoder(deck.track->filePath, deck.track->packedData, deck.track->packedSize, *deck.decoder)) {
+            resetMusicStream(deck);
+            return false;
+        }
+    } else if (!deck.track->packedData) {
+        deck.file.open(deck.track->filePath, std::ios::binary);
+        if (!deck.file.is_open()) {
+            std::cerr << "Failed to open music file: " << deck.track->filePath << std::endl;
+            resetMusicStream(deck);
+            return false;
+        }
+        deck.file.seekg(static_cast<std::streamoff>(deck.track->info.dataOffset));
+    }
+
+    // Fill the whole ring before starting so playback has a cushion
+    int queued = 0;
+    for (ALuint buffer : deck.buffers) {
+        if (!fillMusicBuffer(deck, buffer)) {
+            break;
+        }
+        alSourceQueueBuffers(deck.source, 1, &buffer);
+        queued++;
     }
+    if (queued == 0) {
+        std::cerr << "Failed to decode music: " << deck.track->filePath << std::endl;
+        resetMusicStream(deck);
+        return false;
+    }
+    deck.active = true;
+    deck.primed = true;
+    deck.share = 1.0f;
+    return true;
 }
 
-void SoundSystem::pauseMusic() {
-    alSourcePause(musicSource);
-    ALenum error = alGetError();
-    if (error != AL_NO_ERROR) {
-        std::cerr << "Failed to pause music: " << error << std::endl;
+bool SoundSystem::prefetchMusicFile(const std::string& filePath, bool loop) {
+    const MusicDeck& current = musicDecks[currentDeck];
+    if (current.active && current.track->filePath == filePath) {
+        return true;
+    }
+    // The idle deck may still be fading the last track out
+    finishMusicFade();
+    MusicDeck& idle = musicDecks[1 - currentDeck];
+    if (idle.primed && idle.track->filePath == filePath && idle.loop == loop) {
+        return true;
+    }
+    MusicTrack track;
+    track.filePath = filePath;
+    if (!probeMusic(filePath, track) || !openMusic(idle, std::make_shared<const MusicTrack>(std::move(track)), loop)) {
+        return false;
     }
+    std::cout << "Prefetched music: " << filePath << std::endl;
+    return true;
 }
 
-void SoundSystem::resumeMusic() {
-    ALint state;
-    alGetSourcei(musicSource, AL_SOURCE_STATE, &state);
-    if (state == AL_PAUSED) {
-        alSourcePlay(musicSource);
-        ALenum error = alGetError();
-        if (error != AL_NO_ERROR) {
-            std::cerr << "Failed to resume music: " << error << std::endl;
+void SoundSystem::crossfadeMusicFile(const std::string& filePath, float seconds, bool loop) {
+    MusicDeck& outgoing = musicDecks[currentDeck];
+    if (outgoing.active && outgoing.track->filePath == filePath) {
+        return; // Already playing; carry on without a restart
+    }
+    if (!prefetchMusicFile(filePath, loop)) {
+        return; // Keep whatever is playing
+    }
+    MusicDeck& incoming = musicDecks[1 - currentDeck];
+    
+    // A paused or silent deck has nothing to fade from
+    const bool fade = seconds > 0.0f && outgoing.active && !outgoing.paused;
+    currentDeck = 1 - currentDeck;
+    incoming.share = fade ? 0.0f : 1.0f;
+    applyMusicGain(incoming);
+    incoming.primed = false;
+    alSourcePlay(incoming.source);
+    if (fade) {
+        musicFade.start = std::chrono::steady_clock::now();
+        musicFade.seconds = seconds;
+        musicFade.active = true;
+    } else {
+        resetMusicStream(outgoing);
+    }
+    if (ALenum error = alGetError(); error != AL_NO_ERROR) {
+        std::cerr << "Failed to play music: " << error << std::endl;
+        return;
+    }
+    std::cout << "Crossfading to music: " << filePath << " (" << seconds << " s)" << std::endl;
+}
+
+void SoundSystem::updateMusicFade() {
+    if (!musicFade.active) {
+        return;
+    }
+    const float elapsed =
+        std::chrono::duration<float>(std::chrono::steady_clock::now() - musicFade.start).count();
+    const float t = std::min(elapsed / musicFade.seconds, 1.0f);
+    if (t >= 1.0f) {
+        finishMusicFade();
+        return;
+    }
+    // Equal power: cos² + sin² = 1, so the sum holds its loudness through the fade
+    const float angle = t * 1.57079633f;
+    MusicDeck& incoming = musicDecks[currentDeck];
+    MusicDeck& outgoing = musicDecks[1 - currentDeck];
+    incoming.share = std::sin(angle);
+    outgoing.share = std::cos(angle);
+    applyMusicGain(incoming);
+    applyMusicGain(outgoing);
+}
+
+void SoundSystem::finishMusicFade() {
+    if (!musicFade.active) {
+        return;
+    }
+    musicFade.active = false;
+    resetMusicStream(musicDecks[1 - currentDeck]);
+    MusicDeck& current = musicDecks[currentDeck];
+    current.share = 1.0f;
+    applyMusicGain(current);
+}
+
+void SoundSystem::applyMusicGain(MusicDeck& deck) {
+    alSourcef(deck.source, AL_GAIN, musicGain * deck.share);
+}
+
+void SoundSystem::resetMusicStream(MusicDeck& deck) {
+    // Audio thread (or after it stopped). Stopping marks every queued buffer
+    // processed, and detaching the buffer unqueues them all.
+    alSourceStop(deck.source);
+    alSourcei(deck.source, AL_BUFFER, 0);
+    if (deck.file.is_open()) {
+        deck.file.close();
+    }
+    deck.file.clear();
+    deck.decoder.reset();
+    deck.track = nullptr;
+    deck.position = 0;
+    deck.active = false;
+    deck.paused = false;
+    deck.finished = false;
+    deck.primed = false;
+}
+
+bool SoundSystem::fillMusicBuffer(MusicDeck& deck, ALuint buffer) {
+    // Audio thread
+    if (deck.decoder) {
+        return fillCompressedMusicBuffer(deck, buffer);
+    }
+    
+    const MusicTrack& track = *deck.track;
+    const WavInfo& info = track.info;
+    
+    // Whole sample frames only, so channels never swap across a chunk boundary
+    const size_t frameBytes = std::max<size_t>(1, info.channels * (info.bitsPerSample / 8));
+    const size_t chunkBytes = MUSIC_CHUNK_BYTES - MUSIC_CHUNK_BYTES % frameBytes;
+    musicChunk.resize(chunkBytes);
+    
+    size_t filled = 0;
+    while (filled < chunkBytes) {
+        size_t remaining = info.dataSize - deck.position;
+        if (remaining == 0) {
+            if (!deck.loop || info.dataSize == 0) {
+                deck.finished = true;
+                break;
+            }
+            // Wrap inside the chunk so the loop point has no gap
+            deck.position = 0;
+            if (!track.packedData) {
+                deck.file.clear();
+                deck.file.seekg(static_cast<std::streamoff>(info.dataOffset));
+            }
+            continue;
+        }
+        
+        size_t count = std::min(chunkBytes - filled, remaining);
+        if (track.packedData) {
+            std::memcpy(musicChunk.data() + filled, track.packedData + info.dataOffset + deck.position, count);
+        } else {
+            deck.file.read(musicChunk.data() + filled, static_cast<std::streamsize>(count));
+            count = static_cast<size_t>(deck.file.gcount());
+            if (count == 0) {
+                std::cerr << "Music file ended early: " << track.filePath << std::endl;
+                deck.finished = true;
+                break;
+            }
         }
+        filled += count;
+        deck.position += count;
+    }
+    
+    if (filled == 0) {
+        return false;
     }
+    alBufferData(buffer, info.getFormat(), musicChunk.data(), static_cast<ALsizei>(filled), static_cast<ALsizei>(info.sampleRate));
+    return alGetError() == AL_NO_ERROR;
 }
 
-ALuint SoundSystem::findAvailableSoundSource() {
-    for (int i = 0; i < MAX_SOUND_SOURCES; ++i) {
-        ALint state;
-        alGetSourcei(soundSources[i], AL_SOURCE_STATE, &state);
-        if (state != AL_PLAYING) {
-            return soundSources[i];
+bool SoundSystem::fillCompressedMusicBuffer(MusicDeck& deck, ALuint buffer) {
+    // Audio thread. The decoder emits interleaved 16-bit samples.
+    const WavInfo& info = deck.track->info;
+    const size_t chunkSamples = MUSIC_CHUNK_BYTES / sizeof(std::int16_t);
+    musicSamples.resize(chunkSamples - chunkSamples % info.channels);
+    
+    size_t filled = 0;
+    bool wrapped = false;
+    while (filled < musicSamples.size()) {
+        const std::uint64_t count = deck.decoder->read(musicSamples.data() + filled, musicSamples.size() - filled);
+        if (count > 0) {
+            filled += static_cast<size_t>(count);
+            deck.position += static_cast<size_t>(count * sizeof(std::int16_t));
+            wrapped = false;
+            continue;
+        }
+        // End of stream: rewind for loops (once, so an empty track can't spin here)
+        if (!deck.loop || wrapped) {
+            deck.finished = true;
+            break;
         }
+        deck.decoder->seek(0);
+        deck.position = 0;
+        wrapped = true;
     }
-    return 0; // No available source found
+    
+    if (filled == 0) {
+        return false;
+    }
+    alBufferData(buffer, info.getFormat(), musicSamples.data(), static_cast<ALsizei>(filled * sizeof(std::int16_t)),
+                 static_cast<ALsizei>(info.sampleRate));
+    return alGetError() == AL_NO_ERROR;
 }
 
-void SoundSystem::playSoundEffect(const std::string& name) {
-    auto it = soundBuffers.find(name);
-    if (it == soundBuffers.end()) {
-        std::cerr << "Sound effect not found: " << name << std::endl;
+void SoundSystem::streamMusic() {
+    for (MusicDeck& deck : musicDecks) {
+        streamMusicDeck(deck);
+    }
+    updateMusicFade();
+}
+
+void SoundSystem::streamMusicDeck(MusicDeck& deck) {
+    // A primed deck keeps its full ring until it starts
+    if (!deck.active || deck.paused || deck.primed) {
         return;
     }
+    
+    // Refill whatever OpenAL has finished playing
+    ALint processed = 0;
+    alGetSourcei(deck.source, AL_BUFFERS_PROCESSED, &processed);
+    while (processed-- > 0) {
+        ALuint buffer = 0;
+        alSourceUnqueueBuffers(deck.source, 1, &buffer);
+        if (!deck.finished && fillMusicBuffer(deck, buffer)) {
+            alSourceQueueBuffers(deck.source, 1, &buffer);
+        }
+    }
+    
+    ALint queued = 0;
+    ALint state = 0;
+    alGetSourcei(deck.source, AL_BUFFERS_QUEUED, &queued);
+    alGetSourcei(deck.source, AL_SOURCE_STATE, &state);
+    if (queued == 0) {
+        // Non-looping track played out
+        deck.active = false;
+    } else if (state != AL_PLAYING) {
+        // The source starved (we refilled too late); pick up where it stopped
+        alSourcePlay(deck.source);
+    }
+}
 
-    ALuint source = findAvailableSoundSource();
-    if (source == 0) {
-        std::cerr << "No available sound sources" << std::endl;
+void SoundSystem::streamMix() {
+    // Take back the blocks OpenAL finished with
+    ALint processed = 0;
+    alGetSourcei(mixSource, AL_BUFFERS_PROCESSED, &processed);
+    while (processed-- > 0) {
+        ALuint buffer = 0;
+        alSourceUnqueueBuffers(mixSource, 1, &buffer);
+        idleMixBuffers.push_back(buffer);
+    }
+    if (mixer.getActiveVoices() == 0) {
         return;
     }
+    
+    // Keep every buffer queued while voices play: MIX_STREAM_BUFFERS blocks of cushion
+    while (!idleMixBuffers.empty() && mixer.getActiveVoices() > 0) {
+        const ALuint buffer = idleMixBuffers.back();
+        idleMixBuffers.pop_back();
+        mixer.mixBlock(mixBlock.data());
+        alBufferData(buffer, AL_FORMAT_STEREO16, mixBlock.data(),
+                     static_cast<ALsizei>(mixBlock.size() * sizeof(std::int16_t)), SfxMixer::SAMPLE_RATE);
+        alSourceQueueBuffers(mixSource, 1, &buffer);
+    }
+    ALint state = 0;
+    alGetSourcei(mixSource, AL_SOURCE_STATE, &state);
+    if (state != AL_PLAYING) {
+        // First block after silence, or the source starved
+        alSourcePlay(mixSource);
+    }
+    if (ALenum error = alGetError(); error != AL_NO_ERROR) {
+        std::cerr << "Failed to stream the effects mix: " << error << std::endl;
+    }
+}
 
-    alSourcei(source, AL_BUFFER, it->second);
-    alSourcePlay(source);
+void SoundSystem::refreshVoices() {
+    // One state query per busy voice per tick instead of a scan on every play
+    voiceStats.activeVoices = 0;
+    for (auto& voice : voices) {
+        if (!voice.busy) {
+            continue;
+        }
+        ALint state;
+        alGetSourcei(voice.source, AL_SOURCE_STATE, &state);
+        if (state == AL_PLAYING || state == AL_PAUSED) {
+            voiceStats.activeVoices++;
+        } else {
+            voice.busy = false;
+            voice.effect = nullptr;
+        }
+    }
 }
 
-void SoundSystem::setMasterVolume(float volume) {
-    masterVolume = volume;
-    setMusicVolume(musicVolume);
-    setSoundEffectVolume(soundEffectVolume);
+SoundSystem::Voice* SoundSystem::acquireVoice(const SoundEffect& effect) {
+    Voice* freeVoice = nullptr;
+    Voice* oldestInstance = nullptr;
+    Voice* victim = nullptr;
+    int instances = 0;
+    
+    for (auto& voice : voices) {
+        if (!voice.busy) {
+            if (!freeVoice) freeVoice = &voice;
+            continue;
+        }
+        if (voice.effect == &effect) {
+            instances++;
+            if (!oldestInstance || voice.startOrder < oldestInstance->startOrder) {
+                oldestInstance = &voice;
+            }
+        }
+        // Steal candidates: never a voice that outranks the new effect
+        if (voice.effect && voice.effect->settings.priority <= effect.settings.priority) {
+            if (!victim) {
+                victim = &voice;
+                continue;
+            }
+            const SoundEffectSettings& a = voice.effect->settings;
+            const SoundEffectSettings& b = victim->effect->settings;
+            const float volumeA = a.volume * voice.attenuation;
+            const float volumeB = b.volume * victim->attenuation;
+            if (a.priority != b.priority ? a.priority < b.priority
+                : volumeA != volumeB ? volumeA < volumeB
+                : voice.startOrder < victim->startOrder) {
+                victim = &voice;
+            }
+        }
+    }
+    
+    // At its instance cap the effect restarts its own oldest voice
+    if (effect.settings.maxInstances > 0 && instances >= effect.settings.maxInstances) {
+        return oldestInstance;
+    }
+    return freeVoice ? freeVoice : victim;
 }
 
-void SoundSystem::setMusicVolume(float volume) {
-    musicVolume = volume;
-    alSourcef(musicSource, AL_GAIN, masterVolume * musicVolume);
+bool SoundSystem::startEffect(SoundEffect& effect, float pitch, float pan, float attenuation,
+                              std::chrono::steady_clock::time_point time, PlayedVoice& played) {
+    // Rate limit repeated triggers of the same effect
+    if (effect.triggered && time - effect.lastTrigger < std::chrono::duration<float>(effect.settings.minInterval)) {
+        voiceStats.rateLimited++;
+        return false;
+    }
+    if (!startVoice(effect, pitch, pan, attenuation, 0.0f, played)) {
+        PROFILE_EVENT("Voice dropped");
+        voiceStats.dropped++;
+        return false;
+    }
+    effect.lastTrigger = time;
+    effect.triggered = true;
+    voiceStats.played++;
+    return true;
 }
 
-void SoundSystem::setSoundEffectVolume(float volume) {
-    soundEffectVolume = volume;
-    for (int i = 0; i < MAX_SOUND_SOURCES; ++i) {
-        alSourcef(soundSources[i], AL_GAIN, masterVolume * soundEffectVolume);
+void SoundSystem::startPositionalEffect(SoundEffect& effect, const sf::Vector2f& position, float pitch,
+                                        std::chrono::steady_clock::time_point time) {
+    PositionalVoice positional;
+    positional.effect = &effect;
+    positional.position = position;
+    positional.pitch = pitch;
+    positional.start = time;
+    
+    const Spatial spatial = spatialize(position);
+    if (spatial.audible) {
+        if (startEffect(effect, pitch, spatial.pan, spatial.gain, time, positional.played)) {
+            positionalVoices.push_back(positional);
+        }
+        return;
+    }
+    // Out of range: only the bookkeeping, rate limited like a real trigger
+    if (effect.triggered && time - effect.lastTrigger < std::chrono::duration<float>(effect.settings.minInterval)) {
+        voiceStats.rateLimited++;
+        return;
+    }
+    effect.lastTrigger = time;
+    effect.triggered = true;
+    voiceStats.virtualized++;
+    positionalVoices.push_back(positional);
+}
+
+// On the unit circle in front of the listener, so the distance (and gain) stays the same
+static void setSourcePan(ALuint source, float pan) {
+    const float x = std::min(std::max(pan, -1.0f), 1.0f);
+    alSource3f(source, AL_POSITION, x, 0.0f, -std::sqrt(1.0f - x * x));
+}
+
+bool SoundSystem::startVoice(SoundEffect& effect, float pitch, float pan, float attenuation, float offset,
+                             PlayedVoice& played) {
+    played = PlayedVoice();
+    
+    // Crowd sounds go to the software bus and leave the sources to the rest
+    if (effect.settings.softwareMix && effect.mixSample) {
+        const size_t startFrame = static_cast<size_t>(offset * static_cast<float>(SfxMixer::SAMPLE_RATE));
+        const SfxMixer::PlayResult result = mixer.play(effect.mixSample, &effect, effect.settings.volume * attenuation,
+                                                       pan, pitch, effect.settings.maxInstances, startFrame,
+                                                       &played.mixed);
+        if (result == SfxMixer::PlayResult::Dropped) {
+            return false;
+        }
+        if (result == SfxMixer::PlayResult::Restarted) {
+            PROFILE_EVENT("Voice stolen");
+            voiceStats.stolen++;
+        }
+        voiceStats.mixedVoices = static_cast<int>(mixer.getActiveVoices());
+        return true;
+    }
+    
+    Voice* voice = acquireVoice(effect);
+    if (!voice) {
+        return false;
+    }
+    if (voice->busy) {
+        PROFILE_EVENT("Voice stolen");
+        alSourceStop(voice->source);
+        voiceStats.stolen++;
+    } else {
+        voiceStats.activeVoices++;
+    }
+    
+    voice->effect = &effect;
+    voice->startOrder = ++voiceCounter;
+    voice->attenuation = attenuation;
+    voice->busy = true;
+    played.source = voice;
+    played.startOrder = voice->startOrder;
+    
+    alSourcei(voice->source, AL_BUFFER, effect.buffer);
+    alSourcef(voice->source, AL_GAIN, getVoiceGain(*voice));
+    alSourcef(voice->source, AL_PITCH, pitch);
+    setSourcePan(voice->source, pan);
+    alSourcef(voice->source, AL_SEC_OFFSET, offset); // Applied by the play below
+    alSourcePlay(voice->source);
+    return true;
+}
+
+void SoundSystem::stopVoice(PlayedVoice& played) {
+    if (played.source) {
+        alSourceStop(played.source->source);
+        played.source->busy = false; // activeVoices is recounted by refreshVoices
+        played.source->effect = nullptr;
+    } else if (played.mixed != SfxMixer::NO_VOICE) {
+        mixer.stopVoice(played.mixed);
+    }
+    played = PlayedVoice();
+}
+
+SoundSystem::Spatial SoundSystem::spatialize(const sf::Vector2f& position) const {
+    const float dx = position.x - listener.x;
+    const float dy = position.y - listener.y;
+    const float distance = std::sqrt(dx * dx + dy * dy);
+    const float fade = std::min(std::max((distance - FULL_VOLUME_DISTANCE) / (AUDIBLE_DISTANCE - FULL_VOLUME_DISTANCE),
+                                         0.0f), 1.0f);
+    Spatial spatial;
+    spatial.gain = (1.0f - fade) * (1.0f - fade); // Squared, so the fade sounds even rather than sudden at the end
+    spatial.pan = std::min(std::max(dx / PAN_DISTANCE, -1.0f), 1.0f);
+    spatial.audible = distance < AUDIBLE_DISTANCE;
+    return spatial;
+}
+
+void SoundSystem::updatePositionalVoices() {
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    voiceStats.virtualVoices = 0;
+    for (size_t i = 0; i < positionalVoices.size();) {
+        PositionalVoice& positional = positionalVoices[i];
+        PlayedVoice& played = positional.played;
+        
+        // A playing voice ends with its source or bus voice (or when stolen);
+        // a virtual one when it would have played out
+        const float offset = std::chrono::duration<float>(now - positional.start).count() * positional.pitch;
+        bool alive = offset < positional.effect->getDuration();
+        if (played.source) {
+            alive = played.source->busy && played.source->startOrder == played.startOrder;
+        } else if (played.mixed != SfxMixer::NO_VOICE) {
+            alive = mixer.isPlaying(played.mixed);
+        }
+        if (!alive) {
+            positionalVoices[i] = positionalVoices.back();
+            positionalVoices.pop_back();
+            continue;
+        }
+        
+        const Spatial spatial = spatialize(positional.position);
+        if (!spatial.audible) {
+            if (played.isPlaying()) {
+                stopVoice(played);
+                voiceStats.virtualized++;
+            }
+        } else if (!played.isPlaying()) {
+            // Back in range: resume where it would be by now (stays virtual if no voice is free)
+            startVoice(*positional.effect, positional.pitch, spatial.pan, spatial.gain, offset, played);
+        } else if (played.source) {
+            played.source->attenuation = spatial.gain;
+            alSourcef(played.source->source, AL_GAIN, getVoiceGain(*played.source));
+            setSourcePan(played.source->source, spatial.pan);
+        } else {
+            mixer.setVoiceMix(played.mixed, positional.effect->settings.volume * spatial.gain, spatial.pan);
+        }
+        if (!played.isPlaying()) {
+            voiceStats.virtualVoices++;
+        }
+        ++i;
     }
 }
 
 void SoundSystem::cleanup() {
+    // Stop the audio thread before tearing down the sources it drives;
+    // commands still queued are dropped with it
+    if (audioThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(audioMutex);
+            stopAudioThread = true;
+        }
+        audioCondition.notify_all();
+        audioThread.join();
+    }
+    AudioCommand discarded;
+    while (commandQueue.pop(discarded)) {
+    }
+
     // Stop all playback
-    alSourceStop(musicSource);
+    musicFade.active = false;
+    for (MusicDeck& deck : musicDecks) {
+        resetMusicStream(deck);
+    }
     for (int i = 0; i < MAX_SOUND_SOURCES; ++i) {
         alSourceStop(soundSources[i]);
     }
+    mixer.stop();
+    alSourceStop(mixSource);
+    alSourcei(mixSource, AL_BUFFER, 0);
 
     // Delete sources
-    alDeleteSources(1, &musicSource);
+    for (MusicDeck& deck : musicDecks) {
+        alDeleteSources(1, &deck.source);
+        deck.source = 0;
+    }
     alDeleteSources(MAX_SOUND_SOURCES, soundSources);
+    alDeleteSources(1, &mixSource);
+    mixSource = 0;
 
     // Delete buffers
-    for (const auto& pair : musicBuffers) {
-        alDeleteBuffers(1, &pair.second);
+    for (MusicDeck& deck : musicDecks) {
+        if (deck.buffers[0] != 0) {
+            alDeleteBuffers(MUSIC_STREAM_BUFFERS, deck.buffers.data());
+            deck.buffers.fill(0);
+        }
     }
-    for (const auto& pair : soundBuffers) {
-        alDeleteBuffers(1, &pair.second);
+    if (mixStreamBuffers[0] != 0) {
+        alDeleteBuffers(MIX_STREAM_BUFFERS, mixStreamBuffers.data());
+        mixStreamBuffers.fill(0);
+    }
+    idleMixBuffers.clear();
+    for (const auto& pair : soundEffects) {
+        if (pair.second.buffer != 0) {
+            alDeleteBuffers(1, &pair.second.buffer);
+        }
     }
 
-    musicBuffers.clear();
-    soundBuffers.clear();
+    musicTracks.clear();
+    positionalVoices.clear();
+    soundEffects.clear();
+    for (auto& voice : voices) {
+        voice = Voice();
+    }
 
     // Cleanup OpenAL context and device
     if (context) {
@@ -0,0 +1,237 @@
+#include "SpatialGrid.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+SpatialGrid::SpatialGrid(float cellSize) : cellSize(cellSize > 1.0f ? cellSize : 1.0f) {
+}
+
+void SpatialGrid::clear() {
+    columns = 0;
+    rows = 0;
+    itemCount = 0;
+    cellStart.clear();
+    cellItems.clear();
+    detached.clear();
+    movedItems.clear();
+    movedBounds.clear();
+}
+
+void SpatialGrid::detach(size_t index) {
+    if (detached.size() <= index) {
+        detached.resize(std::max(index + 1, itemCount), 0);
+    }
+    detached[index] = 1;
+    itemCount = std::max(itemCount, index + 1);
+}
+
+void SpatialGrid::update(size_t index, const sf::FloatRect& bounds) {
+    detach(index);
+    auto moved = std::find(movedItems.begin(), movedItems.end(), static_cast<uint32_t>(index));
+    if (moved != movedItems.end()) {
+        movedBounds[moved - movedItems.begin()] = bounds;
+        return;
+    }
+    movedItems.push_back(static_cast<uint32_t>(index));
+    movedBounds.push_back(bounds);
+}
+
+void SpatialGrid::remove(size_t index) {
+    detach(index);
+    auto moved = std::find(movedItems.begin(), movedItems.end(), static_cast<uint32_t>(index));
+    if (moved != movedItems.end()) {
+        movedBounds.erase(movedBounds.begin() + (moved - movedItems.begin()));
+        movedItems.erase(moved);
+    }
+}
+
+int SpatialGrid::cellX(float x) const {
+    int cx = static_cast<int>(std::floor((x - origin.x) / cellSize));
+    return std::clamp(cx, 0, columns - 1);
+}
+
+int SpatialGrid::cellY(float y) const {
+    int cy = static_cast<int>(std::floor((y - origin.y) / cellSize));
+    return std::clamp(cy, 0, rows - 1);
+}
+
+void SpatialGrid::build(const std::vector<sf::FloatRect>& bounds) {
+    clear();
+    if (bounds.empty()) {
+        return;
+    }
+
+    // Grid covers the union of all rectangles
+    sf::Vector2f minCorner = bounds[0].position;
+    sf::Vector2f maxCorner = bounds[0].position + bounds[0].size;
+    for (const auto& rect : bounds) {
+        minCorner.x = std::min(minCorner.x, rect.position.x);
+        minCorner.y = std::min(minCorner.y, rect.position.y);
+        maxCorner.x = std::max(maxCorner.x, rect.position.x + rect.size.x);
+        maxCorner.y = std::max(maxCorner.y, rect.position.y + rect.size.y);
+    }
+    origin = minCorner;
+
+    // Grow the cells until the grid fits in the cell budget
+    while (true) {
+        columns = static_cast<int>((maxCorner.x - minCorner.x) / cellSize) + 1;
+        rows = static_cast<int>((maxCorner.y - minCorner.y) / cellSize) + 1;
+        if (static_cast<size_t>(columns) * static_cast<size_t>(rows) <= MAX_CELLS) {
+            break;
+        }
+        cellSize *= 2.0f;
+    }
+
+    const size_t cellCount = static_cast<size_t>(columns) * static_cast<size_t>(rows);
+    cellStart.assign(cellCount + 1, 0);
+
+    // First pass: count items per cell
+    for (const auto& rect : bounds) {
+        int x0 = cellX(rect.position.x), x1 = cellX(rect.position.x + rect.size.x);
+        int y0 = cellY(rect.position.y), y1 = cellY(rect.position.y + rect.size.y);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                cellStart[static_cast<size_t>(y) * columns + x + 1]++;
+            }
+        }
+    }
+    for (size_t c = 0; c < cellCount; ++c) {
+        cellStart[c + 1] += cellStart[c];
+    }
+
+    // Second pass: scatter item indices into their cells
+    cellItems.resize(cellStart[cellCount]);
+    std::vector<uint32_t> cursor(cellStart.begin(), cellStart.end() - 1);
+    for (size_t i = 0; i < bounds.size(); ++i) {
+        const auto& rect = bounds[i];
+        int x0 = cellX(rect.position.x), x1 = cellX(rect.position.x + rect.size.x);
+        int y0 = cellY(rect.position.y), y1 = cellY(rect.position.y + rect.size.y);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                cellItems[cursor[static_cast<size_t>(y) * columns + x]++] = static_cast<uint32_t>(i);
+            }
+        }
+    }
+
+    itemCount = bounds.size();
+}
+
+size_t SpatialGrid::query(const sf::FloatRect& area, std::vector<size_t>& out) const {
+    out.clear();
+    if (itemCount == 0) {
+        return 0;
+    }
+
+    // Queries that lie completely outside the grid only see moved items
+    const float gridRight = origin.x + columns * cellSize;
+    const float gridBottom = origin.y + rows * cellSize;
+    if (columns > 0 && !(area.position.x > gridRight || area.position.x + area.size.x < origin.x ||
+                         area.position.y > gridBottom || area.position.y + area.size.y < origin.y)) {
+        int x0 = cellX(area.position.x), x1 = cellX(area.position.x + area.size.x);
+        int y0 = cellY(area.position.y), y1 = cellY(area.position.y + area.size.y);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                size_t cell = static_cast<size_t>(y) * columns + x;
+                for (uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+                    if (!isDetached(cellItems[k])) {
+                        out.push_back(cellItems[k]);
+                    }
+                }
+            }
+        }
+    }
+    for (size_t m = 0; m < movedItems.size(); ++m) {
+        const sf::FloatRect& rect = movedBounds[m];
+        if (area.position.x <= rect.position.x + rect.size.x && area.position.x + area.size.x >= rect.position.x &&
+            area.position.y <= rect.position.y + rect.size.y && area.position.y + area.size.y >= rect.position.y) {
+            out.push_back(movedItems[m]);
+        }
+    }
+
+    // Keep linear-scan ordering so collision response stays deterministic, and
+    // drop duplicates from items that span several cells
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out.size();
+}
+
+size_t SpatialGrid::querySegment(const sf::Vector2f& from, const sf::Vector2f& to, std::vector<size_t>& out) const {
+    out.clear();
+    if (itemCount == 0) {
+        return 0;
+    }
+
+    // Moved items by the segment's bounding box; the cells are a superset anyway
+    const sf::Vector2f low(std::min(from.x, to.x), std::min(from.y, to.y));
+    const sf::Vector2f high(std::max(from.x, to.x), std::max(from.y, to.y));
+    for (size_t m = 0; m < movedItems.size(); ++m) {
+        const sf::FloatRect& rect = movedBounds[m];
+        if (low.x <= rect.position.x + rect.size.x && high.x >= rect.position.x &&
+            low.y <= rect.position.y + rect.size.y && high.y >= rect.position.y) {
+            out.push_back(movedItems[m]);
+        }
+    }
+    auto finish = [&out]() {
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+        return out.size();
+    };
+    if (columns == 0) {
+        return finish();
+    }
+
+    // Clip the segment to the grid, as fractions of from -> to
+    const sf::Vector2f delta = to - from;
+    const sf::Vector2f gridMax(origin.x + columns * cellSize, origin.y + rows * cellSize);
+    float enter = 0.0f;
+    float leave = 1.0f;
+    auto clip = [&](float start, float d, float low, float high) {
+        if (d == 0.0f) {
+            return start >= low && start <= high;
+        }
+        float t0 = (low - start) / d;
+        float t1 = (high - start) / d;
+        if (t0 > t1) std::swap(t0, t1);
+        enter = std::max(enter, t0);
+        leave = std::min(leave, t1);
+        return enter <= leave;
+    };
+    if (!clip(from.x, delta.x, origin.x, gridMax.x) || !clip(from.y, delta.y, origin.y, gridMax.y)) {
+        return finish();
+    }
+
+    // Walk the cells in order, stepping across whichever boundary comes first
+    const sf::Vector2f start = from + delta * enter;
+    const sf::Vector2f end = from + delta * leave;
+    int x = cellX(start.x), y = cellY(start.y);
+    const int endX = cellX(end.x), endY = cellY(end.y);
+    const int stepX = delta.x > 0.0f ? 1 : (delta.x < 0.0f ? -1 : 0);
+    const int stepY = delta.y > 0.0f ? 1 : (delta.y < 0.0f ? -1 : 0);
+    constexpr float NEVER = std::numeric_limits<float>::infinity();
+    const float spanX = stepX != 0 ? cellSize / std::abs(delta.x) : NEVER;
+    const float spanY = stepY != 0 ? cellSize / std::abs(delta.y) : NEVER;
+    float nextX = stepX != 0 ? (origin.x + (x + (stepX > 0 ? 1 : 0)) * cellSize - from.x) / delta.x : NEVER;
+    float nextY = stepY != 0 ? (origin.y + (y + (stepY > 0 ? 1 : 0)) * cellSize - from.y) / delta.y : NEVER;
+    for (int visited = 0; visited <= columns + rows; ++visited) {
+        const size_t cell = static_cast<size_t>(y) * columns + x;
+        for (uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+            if (!isDetached(cellItems[k])) {
+                out.push_back(cellItems[k]);
+            }
+        }
+        if (x == endX && y == endY) {
+            break;
+        }
+        if (nextX < nextY) {
+            x += stepX;
+            nextX += spanX;
+        } else {
+            y += stepY;
+            nextY += spanY;
+        }
+        if (x < 0 || x >= columns || y < 0 || y >= rows) {
+            break;
+        }
+    }
+    return finish();
+}
@@ -0,0 +1,110 @@
+#include "SpriteBatch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+void SpriteBatch::begin() {
+    entries.clear();
+    quads.clear();
+    active = true;
+}
+
+void SpriteBatch::add(const sf::Sprite& sprite, int layer) {
+    addQuad(sprite, sprite.getTransform(), layer);
+}
+
+void SpriteBatch::add(const sf::Sprite& sprite, const sf::Vector2f& position, int layer) {
+    // Move the sprite's transform so its position lands on 'position'
+    sf::Transform transform;
+    transform.translate(position - sprite.getPosition());
+    transform.combine(sprite.getTransform());
+    addQuad(sprite, transform, layer);
+}
+
+void SpriteBatch::addQuad(const sf::Sprite& sprite, const sf::Transform& transform, int layer) {
+    if (!active) return;
+
+    // Same corners and texture coordinates sf::Sprite builds (negative rect sizes flip)
+    const sf::IntRect rect = sprite.getTextureRect();
+    const sf::Vector2f size(std::abs(static_cast<float>(rect.size.x)), std::abs(static_cast<float>(rect.size.y)));
+    const float left = static_cast<float>(rect.position.x);
+    const float top = static_cast<float>(rect.position.y);
+    const float right = left + rect.size.x;
+    const float bottom = top + rect.size.y;
+    const sf::Color color = sprite.getColor();
+
+    const sf::Vertex topLeft{transform.transformPoint(sf::Vector2f(0.f, 0.f)), color, sf::Vector2f(left, top)};
+    const sf::Vertex topRight{transform.transformPoint(sf::Vector2f(size.x, 0.f)), color, sf::Vector2f(right, top)};
+    const sf::Vertex bottomLeft{transform.transformPoint(sf::Vector2f(0.f, size.y)), color, sf::Vector2f(left, bottom)};
+    const sf::Vertex bottomRight{transform.transformPoint(size), color, sf::Vector2f(right, bottom)};
+
+    entries.push_back(Entry{layer, &sprite.getTexture(), static_cast<uint32_t>(entries.size()),
+                            static_cast<uint32_t>(quads.size()), 6});
+    quads.push_back(topLeft);
+    quads.push_back(topRight);
+    quads.push_back(bottomLeft);
+    quads.push_back(bottomLeft);
+    quads.push_back(topRight);
+    quads.push_back(bottomRight);
+    frameStats.spritesSubmitted++;
+}
+
+void SpriteBatch::add(const sf::Vertex* triangles, size_t vertexCount, const sf::Texture& texture,
+                      const sf::Vector2f& offset, int layer) {
+    if (!active || vertexCount == 0) return;
+    entries.push_back(Entry{layer, &texture, static_cast<uint32_t>(entries.size()), static_cast<uint32_t>(quads.size()),
+                            static_cast<uint32_t>(vertexCount)});
+    for (size_t i = 0; i < vertexCount; ++i) {
+        sf::Vertex vertex = triangles[i];
+        vertex.position += offset;
+        quads.push_back(vertex);
+    }
+    frameStats.spritesSubmitted++;
+}
+
+void SpriteBatch::end(sf::RenderTarget& target, RenderStats& renderStats, RenderCategory category) {
+    active = false;
+    if (entries.empty()) return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        if (a.layer != b.layer) return a.layer < b.layer;
+        if (a.texture != b.texture) return std::less<const sf::Texture*>()(a.texture, b.texture);
+        return a.order < b.order;
+    });
+
+    vertices.clear();
+    vertices.reserve(quads.size());
+    for (const auto& entry : entries) {
+        vertices.insert(vertices.end(), quads.begin() + entry.firstVertex,
+                        quads.begin() + entry.firstVertex + entry.vertexCount);
+    }
+
+    // One draw per run of equal (layer, texture)
+    size_t runStart = 0;
+    size_t runVertex = 0;   // First vertex of the run
+    size_t runVertices = 0;
+    for (size_t i = 0; i <= entries.size(); ++i) {
+        if (i < entries.size() && (i == runStart || (entries[i].layer == entries[runStart].layer &&
+                                                     entries[i].texture == entries[runStart].texture))) {
+            runVertices += entries[i].vertexCount;
+            continue;
+        }
+        sf::RenderStates states;
+        states.texture = entries[runStart].texture;
+        renderStats.draw(target, vertices.data() + runVertex, runVertices, sf::PrimitiveType::Triangles,
+                         category, states);
+        frameStats.drawCalls++;
+        runStart = i;
+        runVertex += runVertices;
+        runVertices = i < entries.size() ? entries[i].vertexCount : 0;
+    }
+    frameStats.vertices += vertices.size();
+
+    entries.clear();
+    quads.clear();
+}
+
+void SpriteBatch::endFrame() {
+    lastFrameStats = frameStats;
+    frameStats = Stats();
+}
@@ -0,0 +1,78 @@
+#include "StartupProfile.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+void StartupProfile::begin(const char* name) {
+    end();
+    Phase phase;
+    phase.name = name;
+    phase.startMs = sinceOrigin(Clock::now());
+    open = phases.size();
+    phases.push_back(phase);
+}
+
+void StartupProfile::end() {
+    if (open == SIZE_MAX) return;
+    phases[open].endMs = sinceOrigin(Clock::now());
+    open = SIZE_MAX;
+}
+
+size_t StartupProfile::reserveTasks(size_t count) {
+    // Reserved in one go, so the tasks never make the vector reallocate under each other
+    const size_t first = phases.size();
+    phases.resize(first + count);
+    return first;
+}
+
+void StartupProfile::recordTask(size_t slot, const char* name, Clock::time_point start) {
+    Phase& phase = phases[slot];
+    phase.name = name;
+    phase.startMs = sinceOrigin(start);
+    phase.endMs = sinceOrigin(Clock::now());
+    phase.parallel = true;
+}
+
+void StartupProfile::markFirstFrame() {
+    end();
+    if (firstFrameMs == 0.0) {
+        firstFrameMs = sinceOrigin(Clock::now());
+    }
+}
+
+std::vector<std::string> StartupProfile::formatLines() const {
+    std::vector<std::string> lines;
+    std::vector<bool> merged(phases.size(), false);
+    char line[160];
+    for (size_t i = 0; i < phases.size(); ++i) {
+        if (merged[i] || !phases[i].name) continue;
+        const Phase& phase = phases[i];
+        if (!phase.parallel) {
+            std::snprintf(line, sizeof(line), "%-24s %8.1f ms", phase.name, phase.endMs - phase.startMs);
+            lines.push_back(line);
+            continue;
+        }
+        // A parallel task's line spans every task of its name; busy is their summed time
+        double start = phase.startMs, endMs = phase.endMs, busy = 0.0;
+        size_t count = 0;
+        for (size_t j = i; j < phases.size(); ++j) {
+            if (phases[j].parallel && phases[j].name && std::strcmp(phases[j].name, phase.name) == 0) {
+                start = std::min(start, phases[j].startMs);
+                endMs = std::max(endMs, phases[j].endMs);
+                busy += phases[j].endMs - phases[j].startMs;
+                count++;
+                merged[j] = true;
+            }
+        }
+        std::snprintf(line, sizeof(line), "  || %-19s %8.1f ms (%zu task%s, %.1f ms busy)", phase.name, endMs - start,
+                      count, count == 1 ? "" : "s", busy);
+        lines.push_back(line);
+    }
+    if (firstFrameMs > 0.0) {
+        std::snprintf(line, sizeof(line), "%-24s %8.1f ms", "Time to first frame", firstFrameMs);
+        lines.push_back(line);
+    }
+    lines.insert(lines.end(), notes.begin(), notes.end());
+    return lines;
+}
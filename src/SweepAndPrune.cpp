@@ -0,0 +1,126 @@
+#include "SweepAndPrune.hpp"
+#include <algorithm>
+
+SweepAndPrune::ProxyId SweepAndPrune::add(Layer proxyLayer, uint32_t proxyIndex, const sf::FloatRect& bounds) {
+    return add(proxyLayer, defaultCollisionMask(proxyLayer), proxyIndex, bounds);
+}
+
+SweepAndPrune::ProxyId SweepAndPrune::add(Layer proxyLayer, CollisionMask proxyMask, uint32_t proxyIndex,
+                                          const sf::FloatRect& bounds) {
+    const ProxyId id = static_cast<ProxyId>(layer.size());
+    minX.push_back(0.f);
+    minY.push_back(0.f);
+    maxX.push_back(0.f);
+    maxY.push_back(0.f);
+    layer.push_back(proxyLayer);
+    mask.push_back(proxyMask);
+    index.push_back(proxyIndex);
+    enabled.push_back(1);
+    setBounds(id, bounds);
+    // Appended out of order; the next updatePairs sorts it in
+    order.push_back(id);
+    return id;
+}
+
+void SweepAndPrune::clear() {
+    minX.clear();
+    minY.clear();
+    maxX.clear();
+    maxY.clear();
+    layer.clear();
+    mask.clear();
+    index.clear();
+    enabled.clear();
+    order.clear();
+    orderMinX.clear();
+    pairs.clear();
+    maxWidth = 0.f;
+    stats = Stats();
+}
+
+void SweepAndPrune::setBounds(ProxyId id, const sf::FloatRect& bounds) {
+    minX[id] = bounds.position.x;
+    minY[id] = bounds.position.y;
+    maxX[id] = bounds.position.x + bounds.size.x;
+    maxY[id] = bounds.position.y + bounds.size.y;
+    maxWidth = std::max(maxWidth, bounds.size.x);
+}
+
+const std::vector<SweepAndPrune::Pair>& SweepAndPrune::updatePairs() {
+    stats = Stats();
+    stats.proxies = order.size();
+
+    // Insertion sort by left edge: near-linear when last frame's order still mostly holds
+    for (size_t i = 1; i < order.size(); ++i) {
+        const ProxyId id = order[i];
+        const float key = minX[id];
+        size_t j = i;
+        while (j > 0 && minX[order[j - 1]] > key) {
+            order[j] = order[j - 1];
+            --j;
+        }
+        stats.shifts += i - j;
+        order[j] = id;
+    }
+    orderMinX.resize(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        orderMinX[i] = minX[order[i]];
+    }
+
+    // Sweep: each proxy is tested against the ones that start before it ends
+    pairs.clear();
+    for (size_t i = 0; i < order.size(); ++i) {
+        const ProxyId a = order[i];
+        if (!enabled[a]) continue;
+        for (size_t j = i + 1; j < order.size() && minX[order[j]] < maxX[a]; ++j) {
+            const ProxyId b = order[j];
+            if (!enabled[b] || maxX[b] <= minX[a]) continue; // Zero-width proxies touching at an edge
+            if (!canCollide(layer[a], mask[a], layer[b], mask[b])) {
+                stats.filtered++;
+                continue;
+            }
+            stats.tests++;
+            if (minY[a] < maxY[b] && maxY[a] > minY[b]) {
+                pairs.push_back(a < b ? Pair{a, b} : Pair{b, a});
+            }
+        }
+    }
+    stats.pairs = pairs.size();
+    return pairs;
+}
+
+size_t SweepAndPrune::query(const sf::FloatRect& area, CollisionMask layers, std::vector<ProxyId>& out) const {
+    out.clear();
+    const float left = area.position.x;
+    const float right = area.position.x + area.size.x;
+    const float top = area.position.y;
+    const float bottom = area.position.y + area.size.y;
+    // Everything from here on starts at or past the area's right edge
+    size_t i = std::lower_bound(orderMinX.begin(), orderMinX.end(), right) - orderMinX.begin();
+    // Walking back, nothing starting further left than this can still reach the area
+    const float reach = left - maxWidth;
+    while (i > 0 && orderMinX[--i] >= reach) {
+        const ProxyId id = order[i];
+        if (enabled[id] && (layers & collisionBit(layer[id])) != 0 && maxX[id] > left && minY[id] < bottom &&
+            maxY[id] > top) {
+            out.push_back(id);
+        }
+    }
+    std::sort(out.begin(), out.end());
+    return out.size();
+}
+
+bool SweepAndPrune::match(const Pair& pair, Layer first, Layer second, uint32_t& firstIndex,
+                          uint32_t& secondIndex) const {
+    if (layer[pair.a] == first && layer[pair.b] == second) {
+        firstIndex = index[pair.a];
+        secondIndex = index[pair.b];
+        return true;
+    }
+    if (layer[pair.a] == second && layer[pair.b] == first) {
+        firstIndex = index[pair.b];
+        secondIndex = index[pair.a];
+        return true;
+    }
+    return false;
+}
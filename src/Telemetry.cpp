@@ -0,0 +1,365 @@
+#include "Telemetry.hpp"
+#include "JsonValue.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+void writeJsonString(std::ostream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out << '\\' << *c;
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", *c);
+            out << escaped;
+        } else {
+            out << *c;
+        }
+    }
+    out << '"';
+}
+
+// Fixed three decimals keep the report small and diffable
+const char* ms3(double value, char (&buffer)[32]) {
+    std::snprintf(buffer, sizeof(buffer), "%.3f", value);
+    return buffer;
+}
+
+} // namespace
+
+size_t SessionTelemetry::bucketFor(double ms) {
+    const uint64_t units = static_cast<uint64_t>(std::max(0.0, ms) * UNITS_PER_MS);
+    if (units < LINEAR_BUCKETS) {
+        return static_cast<size_t>(units);
+    }
+    uint32_t msb = 0;
+    for (uint64_t v = units; v > 1; v >>= 1) {
+        ++msb;
+    }
+    const size_t octave = msb - 4; // LINEAR_BUCKETS is 2^4 units
+    if (octave >= OCTAVES) {
+        return BUCKETS - 1;
+    }
+    const size_t sub = static_cast<size_t>(units >> (msb - 3)) & (SUB_BUCKETS - 1);
+    return LINEAR_BUCKETS + octave * SUB_BUCKETS + sub;
+}
+
+double SessionTelemetry::getBucketUpperMs(size_t bucket) {
+    if (bucket < LINEAR_BUCKETS) {
+        return static_cast<double>(bucket + 1) / UNITS_PER_MS;
+    }
+    const size_t octave = (bucket - LINEAR_BUCKETS) / SUB_BUCKETS;
+    const size_t sub = (bucket - LINEAR_BUCKETS) % SUB_BUCKETS;
+    const uint64_t upper = static_cast<uint64_t>(SUB_BUCKETS + sub + 1) << (octave + 1);
+    return static_cast<double>(upper) / UNITS_PER_MS;
+}
+
+size_t SessionTelemetry::levelSlot(int level) {
+    return static_cast<size_t>(std::clamp(level, 0, static_cast<int>(MAX_LEVELS) - 1));
+}
+
+void SessionTelemetry::recordFrame(const FrameContext& context) {
+    const Clock::time_point now = Clock::now();
+    if (!started) {
+        started = true;
+        lastFrame = now;
+        return;
+    }
+    const float ms = std::chrono::duration<float, std::milli>(now - lastFrame).count();
+    lastFrame = now;
+
+    frames++;
+    totalMs += ms;
+    maxMs = std::max(maxMs, ms);
+    histogram[bucketFor(ms)]++;
+    const bool hitch = ms > HITCH_MS;
+    if (hitch) {
+        hitches++;
+    }
+
+    LevelStats& level = levels[levelSlot(context.level)];
+    level.frames++;
+    level.totalMs += ms;
+    level.maxMs = std::max(level.maxMs, ms);
+    if (hitch) {
+        level.hitches++;
+    }
+
+    peakEnemies = std::max(peakEnemies, context.enemies);
+    peakNpcs = std::max(peakNpcs, context.npcs);
+    peakParticles = std::max(peakParticles, context.particles);
+    totalDrawCalls += context.drawCalls;
+    peakDrawCalls = std::max(peakDrawCalls, context.drawCalls);
+    totalVertices += context.vertices;
+    peakVertices = std::max(peakVertices, context.vertices);
+
+    if (worstCount < WORST_FRAMES || ms > worst[worstCount - 1].ms) {
+        recordWorst(ms, context);
+    }
+}
+
+void SessionTelemetry::recordWorst(float ms, const FrameContext& context) {
+    // Slowest first; a full list drops its last entry
+    size_t slot = std::min(worstCount, WORST_FRAMES - 1);
+    while (slot > 0 && worst[slot - 1].ms < ms) {
+        worst[slot] = worst[slot - 1];
+        --slot;
+    }
+    worstCount = std::min(worstCount + 1, WORST_FRAMES);
+
+    WorstFrame& entry = worst[slot];
+    entry = WorstFrame();
+    entry.frame = frames;
+    entry.ms = ms;
+    entry.context = context;
+
+    // The profiler has just closed this frame; a paused history is some older one
+    if (Profiler::isPaused() || Profiler::getFrameCount() == 0) {
+        return;
+    }
+    for (const Profiler::ZoneEvent& zone : Profiler::getFrame(0).zones) {
+        if (zone.depth > 1) continue;
+        const float zoneMs = (zone.endNs - zone.startNs) / 1e6f;
+        size_t at = WORST_ZONES;
+        while (at > 0 && (entry.zones[at - 1].name == nullptr || entry.zones[at - 1].ms < zoneMs)) {
+            --at;
+        }
+        if (at == WORST_ZONES) continue;
+        for (size_t i = WORST_ZONES - 1; i > at; --i) {
+            entry.zones[i] = entry.zones[i - 1];
+        }
+        entry.zones[at] = Zone{zone.name, zoneMs};
+    }
+}
+
+void SessionTelemetry::recordLevelLoad(double ms) {
+    levelLoads++;
+    levelLoadMs += ms;
+    levelLoadMaxMs = std::max(levelLoadMaxMs, static_cast<float>(ms));
+}
+
+void SessionTelemetry::recordUploads(double ms) {
+    uploadFrames++;
+    uploadMs += ms;
+    uploadMaxMs = std::max(uploadMaxMs, static_cast<float>(ms));
+}
+
+void SessionTelemetry::recordGpuFrame(const GpuTimer::Frame& frame) {
+    if (frame.index == 0 || frame.index == lastGpuFrame) {
+        return;
+    }
+    lastGpuFrame = frame.index;
+    gpuFrames++;
+    gpuTotalMs += frame.totalMs;
+    gpuMaxMs = std::max(gpuMaxMs, frame.totalMs);
+    for (size_t pass = 0; pass < GpuTimer::PASS_COUNT; ++pass) {
+        gpuPassMs[pass] += frame.ms[pass];
+        gpuPassMaxMs[pass] = std::max(gpuPassMaxMs[pass], frame.ms[pass]);
+    }
+}
+
+void SessionTelemetry::recordMemory(int level, const MemoryStats::Sample& sample) {
+    const uint64_t total = sample.getTotal();
+    for (MemoryPeak* peak : {&memoryPeak, &levelMemoryPeaks[levelSlot(level)]}) {
+        for (size_t i = 0; i < MemoryStats::SLOT_COUNT; ++i) {
+            peak->bytes.bytes[i] = std::max(peak->bytes.bytes[i], sample.bytes[i]);
+        }
+        peak->total = std::max(peak->total, total);
+    }
+}
+
+void SessionTelemetry::reset() {
+    *this = SessionTelemetry(); // The next frame restarts the clock
+}
+
+double SessionTelemetry::getPercentileMs(double fraction) const {
+    if (frames == 0) {
+        return 0.0;
+    }
+    const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * frames)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += histogram[i];
+        if (seen >= target) {
+            return std::min(getBucketUpperMs(i), static_cast<double>(maxMs));
+        }
+    }
+    return maxMs;
+}
+
+SessionTelemetry::Summary SessionTelemetry::summarize() const {
+    Summary summary;
+    summary.frames = frames;
+    summary.seconds = totalMs / 1000.0;
+    summary.avgMs = frames > 0 ? totalMs / frames : 0.0;
+    summary.p50Ms = getPercentileMs(0.50);
+    summary.p95Ms = getPercentileMs(0.95);
+    summary.p99Ms = getPercentileMs(0.99);
+    summary.maxMs = maxMs;
+    summary.hitches = hitches;
+    summary.avgDrawCalls = frames > 0 ? static_cast<double>(totalDrawCalls) / frames : 0.0;
+    summary.peakDrawCalls = peakDrawCalls;
+    summary.peakEnemies = peakEnemies;
+    summary.peakParticles = peakParticles;
+    summary.levelLoadMaxMs = levelLoadMaxMs;
+    summary.uploadMaxMs = uploadMaxMs;
+    summary.gpuAvgMs = gpuFrames > 0 ? gpuTotalMs / gpuFrames : 0.0;
+    summary.gpuMaxMs = gpuMaxMs;
+    summary.peakMemoryMb = memoryPeak.total / (1024.0 * 1024.0);
+    return summary;
+}
+
+bool SessionTelemetry::writeReport(const std::string& path, std::string& error) const {
+    std::ofstream out(path);
+    if (!out) {
+        error = "Failed to open " + path;
+        return false;
+    }
+    char a[32], b[32], c[32];
+    const Summary summary = summarize();
+    out << "{\"version\":1,\n\"summary\":{\"frames\":" << summary.frames
+        << ",\"seconds\":" << ms3(summary.seconds, a)
+        << ",\"avgMs\":" << ms3(summary.avgMs, b)
+        << ",\"p50Ms\":" << ms3(summary.p50Ms, c);
+    out << ",\"p95Ms\":" << ms3(summary.p95Ms, a)
+        << ",\"p99Ms\":" << ms3(summary.p99Ms, b)
+        << ",\"maxMs\":" << ms3(summary.maxMs, c)
+        << ",\"hitches\":" << summary.hitches;
+    out << ",\"avgDrawCalls\":" << ms3(summary.avgDrawCalls, a)
+        << ",\"peakDrawCalls\":" << summary.peakDrawCalls
+        << ",\"peakEnemies\":" << summary.peakEnemies
+        << ",\"peakParticles\":" << summary.peakParticles
+        << ",\"levelLoadMaxMs\":" << ms3(summary.levelLoadMaxMs, b)
+        << ",\"uploadMaxMs\":" << ms3(summary.uploadMaxMs, c)
+        << ",\"gpuAvgMs\":" << ms3(summary.gpuAvgMs, a)
+        << ",\"gpuMaxMs\":" << ms3(summary.gpuMaxMs, b)
+        << ",\"peakMemoryMb\":" << ms3(summary.peakMemoryMb, c) << "},\n";
+
+    // Only the buckets in use, as [upper bound ms, frames]
+    out << "\"histogram\":[";
+    bool first = true;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        if (histogram[i] == 0) continue;
+        out << (first ? "" : ",") << "[" << ms3(getBucketUpperMs(i), a) << "," << histogram[i] << "]";
+        first = false;
+    }
+    out << "],\n\"worstFrames\":[";
+    for (size_t i = 0; i < worstCount; ++i) {
+        const WorstFrame& frame = worst[i];
+        out << (i == 0 ? "\n" : ",\n") << "{\"frame\":" << frame.frame << ",\"ms\":" << ms3(frame.ms, a)
+            << ",\"level\":" << frame.context.level << ",\"enemies\":" << frame.context.enemies
+            << ",\"npcs\":" << frame.context.npcs << ",\"particles\":" << frame.context.particles
+            << ",\"drawCalls\":" << frame.context.drawCalls << ",\"zones\":[";
+        for (size_t z = 0; z < WORST_ZONES && frame.zones[z].name; ++z) {
+            out << (z == 0 ? "" : ",") << "{\"name\":";
+            writeJsonString(out, frame.zones[z].name);
+            out << ",\"ms\":" << ms3(frame.zones[z].ms, a) << "}";
+        }
+        out << "]}";
+    }
+    out << "],\n\"levels\":[";
+    first = true;
+    for (size_t i = 0; i < MAX_LEVELS; ++i) {
+        const LevelStats& level = levels[i];
+        if (level.frames == 0) continue;
+        out << (first ? "" : ",") << "{\"level\":" << i << ",\"frames\":" << level.frames
+            << ",\"avgMs\":" << ms3(level.totalMs / level.frames, a) << ",\"maxMs\":" << ms3(level.maxMs, b)
+            << ",\"hitches\":" << level.hitches << "}";
+        first = false;
+    }
+    out << "],\n\"entities\":{\"peakEnemies\":" << peakEnemies << ",\"peakNpcs\":" << peakNpcs
+        << ",\"peakParticles\":" << peakParticles << "},\n";
+    out << "\"render\":{\"avgDrawCalls\":" << ms3(summary.avgDrawCalls, a) << ",\"peakDrawCalls\":" << peakDrawCalls
+        << ",\"avgVertices\":" << ms3(frames > 0 ? static_cast<double>(totalVertices) / frames : 0.0, b)
+        << ",\"peakVertices\":" << peakVertices << "},\n";
+    // Per pass, from the GPU timer queries; empty without them
+    out << "\"gpu\":{\"frames\":" << gpuFrames << ",\"passes\":[";
+    first = true;
+    for (size_t pass = 0; pass < GpuTimer::PASS_COUNT && gpuFrames > 0; ++pass) {
+        out << (first ? "" : ",") << "{\"name\":";
+        writeJsonString(out, GpuTimer::getPassName(static_cast<GpuTimer::Pass>(pass)));
+        out << ",\"avgMs\":" << ms3(gpuPassMs[pass] / gpuFrames, a) << ",\"maxMs\":" << ms3(gpuPassMaxMs[pass], b)
+            << "}";
+        first = false;
+    }
+    out << "]},\n";
+    out << "\"assets\":{\"levelLoads\":" << levelLoads << ",\"levelLoadMs\":" << ms3(levelLoadMs, a)
+        << ",\"levelLoadMaxMs\":" << ms3(levelLoadMaxMs, b) << ",\"uploadFrames\":" << uploadFrames
+        << ",\"uploadMs\":" << ms3(uploadMs, c);
+    out << ",\"uploadMaxMs\":" << ms3(uploadMaxMs, a) << "},\n";
+
+    // Peak bytes per slot (heap tags, then estimates), for the session and each level visited
+    auto writePeak = [&out](const MemoryPeak& peak) {
+        out << "\"total\":" << peak.total << ",\"bytes\":{";
+        for (size_t i = 0; i < MemoryStats::SLOT_COUNT; ++i) {
+            out << (i == 0 ? "" : ",");
+            writeJsonString(out, MemoryStats::getSlotName(i));
+            out << ":" << peak.bytes.bytes[i];
+        }
+        out << "}";
+    };
+    out << "\"memory\":{\"tagged\":" << (GAME_MEMORY_TAGS ? "true" : "false") << ",\"peak\":{";
+    writePeak(memoryPeak);
+    out << "},\"levels\":[";
+    first = true;
+    for (size_t i = 0; i < MAX_LEVELS; ++i) {
+        if (levelMemoryPeaks[i].total == 0) continue;
+        out << (first ? "\n" : ",\n") << "{\"level\":" << i << ",";
+        writePeak(levelMemoryPeaks[i]);
+        out << "}";
+        first = false;
+    }
+    out << "]}\n}\n";
+
+    if (!out) {
+        error = "Failed to write " + path;
+        return false;
+    }
+    return true;
+}
+
+bool SessionTelemetry::loadSummary(const std::string& path, Summary& out, std::string& error) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        error = "Failed to open " + path;
+        return false;
+    }
+    std::string text(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(text.data(), static_cast<std::streamsize>(text.size()));
+
+    JsonValue root;
+    if (!JsonValue::parse(text, root, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    if (root["version"].asNumber() != 1.0 || !root["summary"].isObject()) {
+        error = path + ": not a telemetry report";
+        return false;
+    }
+    const JsonValue& summary = root["summary"];
+    out = Summary();
+    out.frames = static_cast<uint64_t>(summary["frames"].asNumber());
+    out.seconds = summary["seconds"].asNumber();
+    out.avgMs = summary["avgMs"].asNumber();
+    out.p50Ms = summary["p50Ms"].asNumber();
+    out.p95Ms = summary["p95Ms"].asNumber();
+    out.p99Ms = summary["p99Ms"].asNumber();
+    out.maxMs = summary["maxMs"].asNumber();
+    out.hitches = static_cast<uint64_t>(summary["hitches"].asNumber());
+    out.avgDrawCalls = summary["avgDrawCalls"].asNumber();
+    out.peakDrawCalls = static_cast<uint32_t>(summary["peakDrawCalls"].asNumber());
+    out.peakEnemies = static_cast<uint32_t>(summary["peakEnemies"].asNumber());
+    out.peakParticles = static_cast<uint32_t>(summary["peakParticles"].asNumber());
+    out.levelLoadMaxMs = summary["levelLoadMaxMs"].asNumber();
+    out.uploadMaxMs = summary["uploadMaxMs"].asNumber();
+    out.gpuAvgMs = summary["gpuAvgMs"].asNumber();
+    out.gpuMaxMs = summary["gpuMaxMs"].asNumber();
+    out.peakMemoryMb = summary["peakMemoryMb"].asNumber(); // 0 in reports from before it
+    return true;
+}
@@ -0,0 +1,130 @@
+#include "TextureAtlas.hpp"
+#include "ImageCodec.hpp"
+#include <algorithm>
+
+// Private copy of the stb packer (ImGui compiles its own as static too)
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "imstb_rectpack.h"
+
+TextureAtlas::TextureAtlas(unsigned pageSize, unsigned padding)
+    : pageSize(std::max(pageSize, 64u)), padding(padding) {
+}
+
+size_t TextureAtlas::getResidentBytes() const {
+    size_t bytes = 0;
+    for (const auto& page : pages) {
+        const sf::Vector2u size = page->getSize();
+        bytes += static_cast<size_t>(size.x) * size.y * 4;
+    }
+    return bytes;
+}
+
+void TextureAtlas::clear() {
+    pendingImages.clear();
+    regions.clear();
+    pages.clear();
+    built = false;
+}
+
+bool TextureAtlas::updateRegion(const Region& region, const sf::Image& image) {
+    if (!built || region.page >= pages.size() || sf::Vector2i(image.getSize()) != region.rect.size) {
+        return false;
+    }
+    pages[region.page]->update(image, sf::Vector2u(region.rect.position));
+    return true;
+}
+
+bool TextureAtlas::loadImage(const std::string& path, sf::Image& image) {
+    return ImageCodec::load(path, image);
+}
+
+int TextureAtlas::addFromFile(const std::string& path) {
+    sf::Image image;
+    if (!loadImage(path, image)) {
+        return -1;
+    }
+    return add(std::move(image));
+}
+
+int TextureAtlas::add(sf::Image&& image) {
+    pendingImages.push_back(std::move(image));
+    regions.emplace_back();
+    built = false;
+    return static_cast<int>(regions.size() - 1);
+}
+
+bool TextureAtlas::build() {
+    pages.clear();
+
+    std::vector<int> remaining;
+    for (size_t i = 0; i < pendingImages.size(); ++i) {
+        sf::Vector2u size = pendingImages[i].getSize();
+        if (size.x + padding > pageSize || size.y + padding > pageSize) {
+            // Too big to share a page - give it one of its own
+            auto texture = std::make_unique<sf::Texture>();
+            if (texture->loadFromImage(pendingImages[i])) {
+                regions[i] = Region{pages.size(), sf::IntRect({0, 0}, sf::Vector2i(size))};
+                pages.push_back(std::move(texture));
+            }
+            continue;
+        }
+        remaining.push_back(static_cast<int>(i));
+    }
+
+    std::vector<stbrp_node> nodes(pageSize);
+    std::vector<stbrp_rect> rects;
+    while (!remaining.empty()) {
+        rects.clear();
+        for (int id : remaining) {
+            sf::Vector2u size = pendingImages[id].getSize();
+            stbrp_rect rect{};
+            rect.id = id;
+            rect.w = static_cast<stbrp_coord>(size.x + padding);
+            rect.h = static_cast<stbrp_coord>(size.y + padding);
+            rects.push_back(rect);
+        }
+
+        stbrp_context context;
+        stbrp_init_target(&context, static_cast<int>(pageSize), static_cast<int>(pageSize),
+                          nodes.data(), static_cast<int>(nodes.size()));
+        stbrp_pack_rects(&context, rects.data(), static_cast<int>(rects.size()));
+
+        // Trim the page to the area actually used
+        unsigned usedWidth = 0, usedHeight = 0;
+        for (const auto& rect : rects) {
+            if (rect.was_packed) {
+                usedWidth = std::max(usedWidth, static_cast<unsigned>(rect.x + rect.w));
+                usedHeight = std::max(usedHeight, static_cast<unsigned>(rect.y + rect.h));
+            }
+        }
+        if (usedWidth == 0 || usedHeight == 0) {
+            break; // Nothing fit; can't happen for images smaller than a page
+        }
+
+        sf::Image pageImage(sf::Vector2u(usedWidth, usedHeight), sf::Color::Transparent);
+        std::vector<int> leftover;
+        for (const auto& rect : rects) {
+            if (!rect.was_packed) {
+                leftover.push_back(rect.id);
+                continue;
+            }
+            const sf::Image& source = pendingImages[rect.id];
+            sf::Vector2i position(rect.x, rect.y);
+            if (pageImage.copy(source, sf::Vector2u(position))) {
+                regions[rect.id] = Region{pages.size(), sf::IntRect(position, sf::Vector2i(source.getSize()))};
+            }
+        }
+
+        auto texture = std::make_unique<sf::Texture>();
+        if (!texture->loadFromImage(pageImage)) {
+            return false;
+        }
+        pages.push_back(std::move(texture));
+        remaining.swap(leftover);
+    }
+
+    pendingImages.clear();
+    built = !pages.empty();
+    return built;
+}
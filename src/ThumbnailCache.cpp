@@ -0,0 +1,243 @@
+#include "ThumbnailCache.hpp"
+#include "ImageCodec.hpp"
+#include <algorithm>
+#include <iostream>
+
+ThumbnailCache::ThumbnailCache(JobSystem& jobs, unsigned thumbnailSize, unsigned pageSize, size_t pageCount)
+    : thumbnailSize(std::max(thumbnailSize, 1u))
+    , pageSize(std::max(pageSize, thumbnailSize))
+    , pageCount(std::max<size_t>(pageCount, 1))
+    , cellsPerRow(this->pageSize / this->thumbnailSize)
+    , jobs(jobs) {}
+
+ThumbnailCache::~ThumbnailCache() {
+    // Queued jobs find 'stopping' and return at once, but they still hold 'this'
+    std::unique_lock<std::mutex> lock(mutex);
+    stopping = true;
+    jobsDone.wait(lock, [this] { return runningJobs == 0; });
+}
+
+void ThumbnailCache::submitJob() {
+    runningJobs++;
+    jobs.submit(JobSystem::Lane::Thumbnail, [this] { serveRequest(); });
+}
+
+void ThumbnailCache::unlink(uint32_t cell) {
+    Cell& entry = cells[cell];
+    if (entry.newer != NONE) cells[entry.newer].older = entry.older; else newest = entry.older;
+    if (entry.older != NONE) cells[entry.older].newer = entry.newer; else oldest = entry.newer;
+    entry.newer = entry.older = NONE;
+}
+
+void ThumbnailCache::pushNewest(uint32_t cell) {
+    Cell& entry = cells[cell];
+    entry.older = newest;
+    entry.newer = NONE;
+    if (newest != NONE) cells[newest].newer = cell;
+    newest = cell;
+    if (oldest == NONE) oldest = cell;
+}
+
+const ThumbnailCache::Thumbnail* ThumbnailCache::get(const std::string& path) {
+    auto it = cellsByPath.find(path);
+    if (it != cellsByPath.end()) {
+        stats.hits++;
+        unlink(it->second);
+        pushNewest(it->second);
+        return &cells[it->second].thumbnail;
+    }
+    if (failed.count(path) != 0) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (queued.insert(path).second) {
+        stats.misses++;
+        requests.push_back(path);
+        if (requests.size() > MAX_QUEUED) {
+            queued.erase(requests.front());
+            requests.pop_front();
+        }
+        submitJob(); // A job left over by a dropped request just returns
+    }
+    return nullptr;
+}
+
+void ThumbnailCache::requestPreview(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    previewRequest = path;
+    previewRequested = true;
+    previewReady = false;
+    submitJob();
+}
+
+bool ThumbnailCache::takePreview(sf::Image& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!previewReady) {
+        return false;
+    }
+    out = std::move(previewImage);
+    previewImage = sf::Image();
+    previewReady = false;
+    return true;
+}
+
+void ThumbnailCache::serveRequest() {
+    std::string path;
+    bool preview = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // The preview was asked for explicitly, so it goes ahead of the thumbnails
+        if (!stopping && previewRequested) {
+            path = previewRequest;
+            previewRequested = false;
+            preview = true;
+        } else if (!stopping && !requests.empty()) {
+            path = std::move(requests.back());
+            requests.pop_back();
+        }
+    }
+
+    if (!path.empty()) {
+        sf::Image image;
+        const bool loaded = ImageCodec::load(path, image);
+        if (preview) {
+            std::lock_guard<std::mutex> lock(mutex);
+            // Dropped if another preview was requested meanwhile
+            if (!previewRequested && previewRequest == path) {
+                previewImage = loaded ? std::move(image) : sf::Image();
+                previewReady = true;
+            }
+        } else {
+            Decoded result{path, loaded ? downscale(image) : sf::Image()};
+            std::lock_guard<std::mutex> lock(mutex);
+            decoded.push_back(std::move(result));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    runningJobs--;
+    jobsDone.notify_all();
+}
+
+sf::Image ThumbnailCache::downscale(const sf::Image& source) const {
+    const sf::Vector2u size = source.getSize();
+    if (size.x == 0 || size.y == 0) {
+        return sf::Image();
+    }
+
+    // Fit inside the cell keeping the aspect; small images are not enlarged
+    const float scale = std::min({1.0f, static_cast<float>(thumbnailSize) / size.x,
+                                  static_cast<float>(thumbnailSize) / size.y});
+    const sf::Vector2u target(std::max(1u, static_cast<unsigned>(size.x * scale)),
+                              std::max(1u, static_cast<unsigned>(size.y * scale)));
+
+    // Box filter: every target pixel averages the source pixels it covers
+    const std::uint8_t* pixels = source.getPixelsPtr();
+    std::vector<std::uint8_t> out(static_cast<size_t>(target.x) * target.y * 4);
+    for (unsigned y = 0; y < target.y; ++y) {
+        const unsigned y0 = y * size.y / target.y;
+        const unsigned y1 = std::max(y0 + 1, (y + 1) * size.y / target.y);
+        for (unsigned x = 0; x < target.x; ++x) {
+            const unsigned x0 = x * size.x / target.x;
+            const unsigned x1 = std::max(x0 + 1, (x + 1) * size.x / target.x);
+            unsigned sum[4] = {0, 0, 0, 0};
+            for (unsigned sy = y0; sy < y1; ++sy) {
+                const std::uint8_t* row = pixels + (static_cast<size_t>(sy) * size.x + x0) * 4;
+                for (unsigned sx = x0; sx < x1; ++sx, row += 4) {
+                    sum[0] += row[0];
+                    sum[1] += row[1];
+                    sum[2] += row[2];
+                    sum[3] += row[3];
+                }
+            }
+            const unsigned count = (x1 - x0) * (y1 - y0);
+            std::uint8_t* dest = out.data() + (static_cast<size_t>(y) * target.x + x) * 4;
+            for (int c = 0; c < 4; ++c) {
+                dest[c] = static_cast<std::uint8_t>(sum[c] / count);
+            }
+        }
+    }
+    return sf::Image(target, out.data());
+}
+
+uint32_t ThumbnailCache::allocateCell() {
+    const size_t capacity = pageCount * cellsPerRow * cellsPerRow;
+    if (cells.size() < capacity) {
+        const uint32_t cell = static_cast<uint32_t>(cells.size());
+        const size_t page = cell / (cellsPerRow * cellsPerRow);
+        if (page >= pages.size()) {
+            auto texture = std::make_unique<sf::Texture>();
+            if (!texture->resize(sf::Vector2u(pageSize, pageSize))) {
+                return NONE;
+            }
+            pages.push_back(std::move(texture));
+        }
+        cells.emplace_back();
+        return cell;
+    }
+
+    // Budget reached: recycle the least recently used cell
+    const uint32_t cell = oldest;
+    unlink(cell);
+    cellsByPath.erase(cells[cell].path);
+    cells[cell].path.clear();
+    stats.evictions++;
+    return cell;
+}
+
+void ThumbnailCache::update() {
+    std::vector<Decoded> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const size_t count = std::min(decoded.size(), UPLOADS_PER_UPDATE);
+        ready.assign(std::make_move_iterator(decoded.begin()), std::make_move_iterator(decoded.begin() + count));
+        decoded.erase(decoded.begin(), decoded.begin() + count);
+        for (const auto& result : ready) {
+            queued.erase(result.path);
+        }
+        stats.queued = queued.size();
+    }
+
+    for (auto& result : ready) {
+        const sf::Vector2u size = result.image.getSize();
+        if (size.x == 0 || size.y == 0) {
+            failed.insert(result.path);
+            stats.failures++;
+            continue;
+        }
+        const uint32_t cell = allocateCell();
+        if (cell == NONE) {
+            std::cerr << "ThumbnailCache: could not create an atlas page" << std::endl;
+            return;
+        }
+
+        const unsigned cellsPerPage = cellsPerRow * cellsPerRow;
+        const size_t page = cell / cellsPerPage;
+        const unsigned index = cell % cellsPerPage;
+        const sf::Vector2u origin((index % cellsPerRow) * thumbnailSize, (index / cellsPerRow) * thumbnailSize);
+        pages[page]->update(result.image.getPixelsPtr(), size, origin);
+
+        Cell& entry = cells[cell];
+        entry.path = result.path;
+        entry.thumbnail.page = pages[page].get();
+        entry.thumbnail.rect = sf::IntRect(sf::Vector2i(origin), sf::Vector2i(size));
+        cellsByPath[entry.path] = cell;
+        pushNewest(cell);
+    }
+    stats.resident = cellsByPath.size();
+}
+
+void ThumbnailCache::clear() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.clear();
+        queued.clear();
+        decoded.clear();
+    }
+    cells.clear();
+    cellsByPath.clear();
+    failed.clear();
+    newest = oldest = NONE;
+    stats = Stats();
+}
@@ -0,0 +1,57 @@
+#include "TileLayout.hpp"
+#include "JsonValue.hpp"
+#include <algorithm>
+
+TileLayout TileLayout::forImage(const sf::Vector2u& size, unsigned tileSize) {
+    TileLayout layout;
+    layout.size = size;
+    layout.tileSize = std::max(1u, tileSize);
+    layout.columns = (size.x + layout.tileSize - 1) / layout.tileSize;
+    layout.rows = (size.y + layout.tileSize - 1) / layout.tileSize;
+    return layout;
+}
+
+sf::IntRect TileLayout::getTileRect(unsigned column, unsigned row) const {
+    const unsigned x = column * tileSize;
+    const unsigned y = row * tileSize;
+    return sf::IntRect(sf::Vector2i(static_cast<int>(x), static_cast<int>(y)),
+                       sf::Vector2i(static_cast<int>(std::min(tileSize, size.x - x)),
+                                    static_cast<int>(std::min(tileSize, size.y - y))));
+}
+
+std::string TileLayout::toJson() const {
+    return "{\"width\": " + std::to_string(size.x) + ", \"height\": " + std::to_string(size.y) +
+           ", \"tile\": " + std::to_string(tileSize) + ", \"columns\": " + std::to_string(columns) +
+           ", \"rows\": " + std::to_string(rows) + "}\n";
+}
+
+bool TileLayout::parse(std::string_view json, TileLayout& out, std::string& error) {
+    JsonValue document;
+    if (!JsonValue::parse(json, document, error)) {
+        return false;
+    }
+    const double width = document["width"].asNumber();
+    const double height = document["height"].asNumber();
+    const double tile = document["tile"].asNumber();
+    if (width < 1.0 || height < 1.0 || tile < 1.0 || width > 1e7 || height > 1e7 || tile > 1e5) {
+        error = "tile layout needs a positive width, height and tile size";
+        return false;
+    }
+    // The grid follows from the sizes; the stored columns and rows are for people
+    out = forImage(sf::Vector2u(static_cast<unsigned>(width), static_cast<unsigned>(height)),
+                   static_cast<unsigned>(tile));
+    return true;
+}
+
+std::string TileLayout::getTilePath(const std::string& directory, unsigned column, unsigned row) {
+    return directory + "/" + std::to_string(column) + "_" + std::to_string(row) + ".png";
+}
+
+std::string TileLayout::getDirectoryFor(const std::string& sourcePath) {
+    const std::string_view suffix(SOURCE_SUFFIX);
+    if (sourcePath.size() <= suffix.size() ||
+        sourcePath.compare(sourcePath.size() - suffix.size(), suffix.size(), suffix) != 0) {
+        return std::string();
+    }
+    return sourcePath.substr(0, sourcePath.size() - suffix.size()) + DIRECTORY_SUFFIX;
+}
@@ -0,0 +1,295 @@
+#include "TileMap.hpp"
+#include <algorithm>
+#include <cmath>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+int lowestBit(uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long bit;
+    _BitScanForward64(&bit, word);
+    return static_cast<int>(bit);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+// Bits column0..column1 of word 'word' in a row (both within the row's words)
+uint64_t wordMask(size_t word, int column0, int column1) {
+    uint64_t mask = ~uint64_t(0);
+    if (word == static_cast<size_t>(column0) >> 6) {
+        mask &= ~uint64_t(0) << (column0 & 63);
+    }
+    if (word == static_cast<size_t>(column1) >> 6) {
+        mask &= ~uint64_t(0) >> (63 - (column1 & 63));
+    }
+    return mask;
+}
+
+// floor(value / tile) as an int, clamped to [-1, limit] (NaN gives -1)
+int cellFloor(float value, float tile, int limit) {
+    const float cell = std::floor(value / tile);
+    if (!(cell >= -1.f)) return -1;
+    return cell > static_cast<float>(limit) ? limit : static_cast<int>(cell);
+}
+
+uint8_t surfaceFlag(Narrowphase::SurfaceType type) {
+    switch (type) {
+        case Narrowphase::SurfaceType::OneWay: return TileMap::CellOneWay;
+        case Narrowphase::SurfaceType::SlopeUpRight: return TileMap::CellSlopeUpRight;
+        case Narrowphase::SurfaceType::SlopeUpLeft: return TileMap::CellSlopeUpLeft;
+        default: return 0;
+    }
+}
+
+} // namespace
+
+void TileMap::reset(float tile, const sf::Vector2f& size) {
+    columns = rows = 0;
+    wordsPerRow = 0;
+    tileSize = tile;
+    if (!(tile >= MIN_TILE_SIZE) || !(size.x > 0.f) || !(size.y > 0.f)) {
+        return;
+    }
+    const double width = std::ceil(static_cast<double>(size.x) / tile);
+    const double height = std::ceil(static_cast<double>(size.y) / tile);
+    if (width * height > static_cast<double>(MAX_CELLS)) {
+        return;
+    }
+    columns = static_cast<int>(width);
+    rows = static_cast<int>(height);
+    wordsPerRow = (static_cast<size_t>(columns) + 63) / 64;
+    const size_t cells = static_cast<size_t>(columns) * static_cast<size_t>(rows);
+    flags.assign(cells, 0);
+    platforms.assign(cells, NO_PLATFORM);
+    solidBits.assign(wordsPerRow * static_cast<size_t>(rows), 0);
+    topBits.assign(solidBits.size(), 0);
+    ladderBits.assign(solidBits.size(), 0);
+}
+
+void TileMap::clearPlatforms() {
+    for (uint8_t& cell : flags) {
+        cell &= CellLadder;
+    }
+    std::fill(platforms.begin(), platforms.end(), NO_PLATFORM);
+    std::fill(solidBits.begin(), solidBits.end(), 0);
+    std::fill(topBits.begin(), topBits.end(), 0);
+}
+
+void TileMap::clearLadders() {
+    for (uint8_t& cell : flags) {
+        cell &= static_cast<uint8_t>(~CellLadder);
+    }
+    std::fill(ladderBits.begin(), ladderBits.end(), 0);
+}
+
+bool TileMap::toCells(const sf::FloatRect& box, Range& cells) const {
+    if (!isEnabled() || !(box.size.x > 0.f) || !(box.size.y > 0.f)) {
+        return false;
+    }
+    // Every edge has to land on a cell boundary exactly, so the cells answer
+    // the same comparisons the box would
+    const float left = std::round(box.position.x / tileSize);
+    const float top = std::round(box.position.y / tileSize);
+    const float right = std::round((box.position.x + box.size.x) / tileSize);
+    const float bottom = std::round((box.position.y + box.size.y) / tileSize);
+    if (left * tileSize != box.position.x || top * tileSize != box.position.y ||
+        right * tileSize != box.position.x + box.size.x || bottom * tileSize != box.position.y + box.size.y) {
+        return false;
+    }
+    if (left < 0.f || top < 0.f || right > static_cast<float>(columns) || bottom > static_cast<float>(rows)) {
+        return false;
+    }
+    cells = Range{static_cast<int>(left), static_cast<int>(right) - 1, static_cast<int>(top), static_cast<int>(bottom) - 1};
+    return true;
+}
+
+void TileMap::setBits(std::vector<uint64_t>& bits, int column, int row, bool value) {
+    uint64_t& word = bits[static_cast<size_t>(row) * wordsPerRow + (static_cast<size_t>(column) >> 6)];
+    const uint64_t bit = uint64_t(1) << (column & 63);
+    word = value ? (word | bit) : (word & ~bit);
+}
+
+bool TileMap::addPlatform(uint32_t platform, const sf::FloatRect& box, Narrowphase::SurfaceType type) {
+    Range cells;
+    if (!toCells(box, cells)) {
+        return false;
+    }
+    for (int row = cells.row0; row <= cells.row1; ++row) {
+        for (int column = cells.column0; column <= cells.column1; ++column) {
+            if (platforms[index(column, row)] != NO_PLATFORM) {
+                return false;
+            }
+        }
+    }
+    const uint8_t surface = surfaceFlag(type);
+    for (int row = cells.row0; row <= cells.row1; ++row) {
+        for (int column = cells.column0; column <= cells.column1; ++column) {
+            const size_t cell = index(column, row);
+            platforms[cell] = platform;
+            flags[cell] |= static_cast<uint8_t>(CellSolid | surface | (row == cells.row0 ? CellTop : 0));
+            setBits(solidBits, column, row, true);
+            if (row == cells.row0) {
+                setBits(topBits, column, row, true);
+            }
+        }
+    }
+    return true;
+}
+
+bool TileMap::removePlatform(uint32_t platform, const sf::FloatRect& box) {
+    Range cells;
+    if (!toCells(box, cells)) {
+        return false;
+    }
+    for (int row = cells.row0; row <= cells.row1; ++row) {
+        for (int column = cells.column0; column <= cells.column1; ++column) {
+            if (platforms[index(column, row)] != platform) {
+                return false;
+            }
+        }
+    }
+    for (int row = cells.row0; row <= cells.row1; ++row) {
+        for (int column = cells.column0; column <= cells.column1; ++column) {
+            const size_t cell = index(column, row);
+            platforms[cell] = NO_PLATFORM;
+            flags[cell] &= CellLadder;
+            setBits(solidBits, column, row, false);
+            setBits(topBits, column, row, false);
+        }
+    }
+    return true;
+}
+
+bool TileMap::addLadder(const sf::FloatRect& box) {
+    Range cells;
+    if (!toCells(box, cells)) {
+        return false;
+    }
+    for (int row = cells.row0; row <= cells.row1; ++row) {
+        for (int column = cells.column0; column <= cells.column1; ++column) {
+            flags[index(column, row)] |= CellLadder;
+            setBits(ladderBits, column, row, true);
+        }
+    }
+    return true;
+}
+
+uint8_t TileMap::getFlagsAt(const sf::Vector2f& point) const {
+    if (!isEnabled()) return 0;
+    const int column = cellFloor(point.x, tileSize, columns);
+    const int row = cellFloor(point.y, tileSize, rows);
+    if (column < 0 || column >= columns || row < 0 || row >= rows) {
+        return 0;
+    }
+    return flags[index(column, row)];
+}
+
+bool TileMap::getRange(float left, float right, float top, float bottom, Range& range) const {
+    if (!isEnabled()) return false;
+    // Cell c touches [left, right] when c * tile <= right and (c + 1) * tile >= left.
+    // The division only estimates; the products settle it.
+    auto first = [this](float low, int limit) {
+        int cell = std::max(cellFloor(low, tileSize, limit) - 1, 0);
+        while (cell < limit && static_cast<float>(cell + 1) * tileSize < low) cell++;
+        return cell;
+    };
+    auto last = [this](float high, int limit) {
+        int cell = std::min(cellFloor(high, tileSize, limit) + 1, limit - 1);
+        while (cell >= 0 && static_cast<float>(cell) * tileSize > high) cell--;
+        return cell;
+    };
+    range.column0 = first(left, columns);
+    range.column1 = last(right, columns);
+    range.row0 = first(top, rows);
+    range.row1 = last(bottom, rows);
+    return range.column0 <= range.column1 && range.row0 <= range.row1;
+}
+
+bool TileMap::anyBit(const std::vector<uint64_t>& bits, const Range& range) const {
+    const size_t word0 = static_cast<size_t>(range.column0) >> 6;
+    const size_t word1 = static_cast<size_t>(range.column1) >> 6;
+    for (int row = range.row0; row <= range.row1; ++row) {
+        const uint64_t* line = bits.data() + static_cast<size_t>(row) * wordsPerRow;
+        for (size_t word = word0; word <= word1; ++word) {
+            if (line[word] & wordMask(word, range.column0, range.column1)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool TileMap::anySolid(const sf::FloatRect& area) const {
+    Range range;
+    return getRange(area.position.x, area.position.x + area.size.x, area.position.y,
+                    area.position.y + area.size.y, range) &&
+           anyBit(solidBits, range);
+}
+
+bool TileMap::anyLadder(const sf::FloatRect& area) const {
+    Range range;
+    return getRange(area.position.x, area.position.x + area.size.x, area.position.y,
+                    area.position.y + area.size.y, range) &&
+           anyBit(ladderBits, range);
+}
+
+void TileMap::collectPlatforms(const sf::FloatRect& area, std::vector<size_t>& out) const {
+    Range range;
+    if (!getRange(area.position.x, area.position.x + area.size.x, area.position.y,
+                  area.position.y + area.size.y, range)) {
+        return;
+    }
+    const size_t word0 = static_cast<size_t>(range.column0) >> 6;
+    const size_t word1 = static_cast<size_t>(range.column1) >> 6;
+    for (int row = range.row0; row <= range.row1; ++row) {
+        const uint64_t* line = solidBits.data() + static_cast<size_t>(row) * wordsPerRow;
+        const uint32_t* cells = platforms.data() + index(0, row);
+        uint32_t previous = NO_PLATFORM;
+        for (size_t word = word0; word <= word1; ++word) {
+            uint64_t bits = line[word] & wordMask(word, range.column0, range.column1);
+            while (bits != 0) {
+                const uint32_t platform = cells[word * 64 + static_cast<size_t>(lowestBit(bits))];
+                bits &= bits - 1;
+                if (platform != previous) {
+                    out.push_back(platform);
+                    previous = platform;
+                }
+            }
+        }
+    }
+}
+
+bool TileMap::hasTopNear(float left, float right, float bottom, float distance) const {
+    Range range;
+    if (!getRange(left, right, bottom - distance, bottom + distance, range)) {
+        return false;
+    }
+    for (int row = range.row0; row <= range.row1; ++row) {
+        // The comparison isEntityOnGround makes against a platform's top
+        const float top = static_cast<float>(row) * tileSize;
+        if (!(bottom >= top - distance && bottom <= top + distance)) continue;
+        const Range line{range.column0, range.column1, row, row};
+        if (anyBit(topBits, line)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TileMap::removeLadder(const sf::FloatRect& box) {
+    Range cells;
+    if (!toCells(box, cells)) {
+        return false;
+    }
+    for (int row = cells.row0; row <= cells.row1; ++row) {
+        for (int column = cells.column0; column <= cells.column1; ++column) {
+            flags[index(column, row)] &= static_cast<uint8_t>(~CellLadder);
+            setBits(ladderBits, column, row, false);
+        }
+    }
+    return true;
+}
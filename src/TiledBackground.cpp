@@ -0,0 +1,174 @@
+#include "TiledBackground.hpp"
+#include "AssetPack.hpp"
+#include "MappedFile.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+
+namespace {
+
+sf::IntRect unite(const sf::IntRect& a, const sf::IntRect& b) {
+    const sf::Vector2i topLeft(std::min(a.position.x, b.position.x), std::min(a.position.y, b.position.y));
+    const sf::Vector2i bottomRight(std::max(a.position.x + a.size.x, b.position.x + b.size.x),
+                                   std::max(a.position.y + a.size.y, b.position.y + b.size.y));
+    return sf::IntRect(topLeft, bottomRight - topLeft);
+}
+
+bool contains(const sf::IntRect& rect, int x, int y) {
+    return x >= rect.position.x && x < rect.position.x + rect.size.x &&
+           y >= rect.position.y && y < rect.position.y + rect.size.y;
+}
+
+} // namespace
+
+TiledBackground::TiledBackground(AssetManager& assets, std::string directory)
+    : assets(assets), directory(std::move(directory)) {}
+
+bool TiledBackground::open(std::string& error) {
+    const std::string layoutPath = directory + "/" + TileLayout::LAYOUT_FILE;
+    MappedFile file;
+    std::string_view text;
+    if (AssetPack::Blob blob = AssetPack::instance().find(layoutPath)) {
+        text = std::string_view(blob.data, blob.size);
+    } else if (file.open(layoutPath)) {
+        text = std::string_view(file.data(), file.size());
+    } else {
+        error = "cannot open " + layoutPath;
+        return false;
+    }
+    if (!TileLayout::parse(text, layout, error)) {
+        error = layoutPath + ": " + error;
+        return false;
+    }
+
+    // Prefetched with the level, or loaded now; without it there's nothing to stand in for tiles
+    const std::string previewKey = getPreviewKey(directory);
+    if (!assets.hasTexture(previewKey) &&
+        !assets.tryLoadTexture(previewKey, directory + "/" + TileLayout::PREVIEW_FILE,
+                               AssetManager::TextureCategory::Background, error)) {
+        return false;
+    }
+    preview = assets.acquireTexture(previewKey);
+    preview.get().setSmooth(true);
+    tiles.assign(layout.getTileCount(), Tile());
+    return true;
+}
+
+const sf::Texture* TiledBackground::getTile(unsigned column, unsigned row) const {
+    if (column >= layout.columns || row >= layout.rows) {
+        return nullptr;
+    }
+    const Tile& tile = tiles[static_cast<size_t>(row) * layout.columns + column];
+    return tile.texture ? &tile.texture.get() : nullptr;
+}
+
+void TiledBackground::markVisible(const sf::IntRect& rect) {
+    visible = anyVisible ? unite(visible, rect) : rect;
+    anyVisible = true;
+}
+
+bool TiledBackground::update() {
+    PROFILE_ZONE("TiledBackground::update");
+    clock++;
+    bool changed = false;
+
+    // Decoded since the last update
+    size_t loading = 0;
+    for (uint32_t index = 0; index < tiles.size(); ++index) {
+        Tile& tile = tiles[index];
+        if (!tile.load.isValid()) {
+            continue;
+        }
+        if (tile.load.isReady()) {
+            // Empty if the budget evicted it before it was drawn; asked for again below
+            tile.texture = assets.acquireTexture(tile.load.getTexture());
+            tile.load = AssetManager::TextureLoad();
+            if (tile.texture) {
+                tile.texture.get().setSmooth(true);
+                residentTiles.push_back(index);
+                changed = true;
+            }
+        } else if (tile.load.isFailed()) {
+            tile.load = AssetManager::TextureLoad();
+            tile.failed = true; // The preview stays in its place
+            stats.failed++;
+        } else {
+            loading++;
+        }
+    }
+
+    if (anyVisible) {
+        // What was drawn, and a column either side for the camera to scroll into
+        const int left = std::max(visible.position.x - 1, 0);
+        const int right = std::min(visible.position.x + visible.size.x + 1, static_cast<int>(layout.columns));
+        const int top = std::max(visible.position.y, 0);
+        const int bottom = std::min(visible.position.y + visible.size.y, static_cast<int>(layout.rows));
+        const sf::IntRect wanted(sf::Vector2i(left, top), sf::Vector2i(right - left, bottom - top));
+        for (int row = top; row < bottom; ++row) {
+            for (int column = left; column < right; ++column) {
+                Tile& tile = tiles[static_cast<size_t>(row) * layout.columns + column];
+                tile.lastUse = clock;
+                if (!tile.texture && !tile.load.isValid() && !tile.failed) {
+                    request(static_cast<unsigned>(column), static_cast<unsigned>(row), changed, loading);
+                }
+            }
+        }
+        changed |= trim(wanted);
+        anyVisible = false;
+    }
+
+    stats.resident = residentTiles.size();
+    stats.loading = loading;
+    return changed;
+}
+
+void TiledBackground::request(unsigned column, unsigned row, bool& changed, size_t& loading) {
+    const uint32_t index = row * layout.columns + column;
+    Tile& tile = tiles[index];
+    const std::string key = getTileKey(column, row);
+    const AssetManager::TextureHandle handle = assets.internTexture(key);
+    // Unpinned earlier but not evicted yet
+    if (assets.hasTexture(handle)) {
+        tile.texture = assets.acquireTexture(handle);
+        residentTiles.push_back(index);
+        changed = true;
+        return;
+    }
+    tile.load = assets.loadTextureAsync(key, TileLayout::getTilePath(directory, column, row), false,
+                                        AssetManager::TextureCategory::Background);
+    stats.requests++;
+    loading++;
+}
+
+bool TiledBackground::trim(const sf::IntRect& keep) {
+    bool changed = false;
+    while (residentTiles.size() > residentLimit) {
+        // The least recently drawn outside what is wanted now; with none, the cap gives
+        size_t oldest = residentTiles.size();
+        for (size_t i = 0; i < residentTiles.size(); ++i) {
+            const uint32_t index = residentTiles[i];
+            const int column = static_cast<int>(index % layout.columns);
+            const int row = static_cast<int>(index / layout.columns);
+            if (!contains(keep, column, row) &&
+                (oldest == residentTiles.size() || tiles[index].lastUse < tiles[residentTiles[oldest]].lastUse)) {
+                oldest = i;
+            }
+        }
+        if (oldest == residentTiles.size()) {
+            break;
+        }
+        tiles[residentTiles[oldest]].texture.reset();
+        residentTiles[oldest] = residentTiles.back();
+        residentTiles.pop_back();
+        stats.evictions++;
+        changed = true;
+    }
+    return changed;
+}
+
+std::string TiledBackground::getPreviewKey(const std::string& directory) {
+    return "bg_tiles:" + directory;
+}
+
+std::string TiledBackground::getTileKey(unsigned column, unsigned row) const {
+    return "bg_tiles:" + directory + ":" + std::to_string(column) + "_" + std::to_string(row);
+}
@@ -0,0 +1,187 @@
+#include "TimerWheel.hpp"
+#include "SimSnapshot.hpp"
+#include <algorithm>
+#include <cmath>
+
+TimerWheel::TimerWheel(float tickSeconds) : tickSeconds(tickSeconds) {
+    buckets.fill(NONE);
+}
+
+uint64_t TimerWheel::ticksFor(float seconds) const {
+    // A hair under a whole tick counts as that tick, so 1.5 s at 60 Hz is 90 ticks, not 91
+    const float ticks = std::ceil(seconds / tickSeconds - 1e-3f);
+    return ticks < 1.0f ? 1 : static_cast<uint64_t>(ticks);
+}
+
+TimerWheel::TimerId TimerWheel::schedule(uint64_t delayTicks, uint32_t event, uint32_t data) {
+    const uint32_t index = static_cast<uint32_t>(timers.size());
+    const TimerId id = ids.acquire(index);
+    if (id == NO_TIMER) {
+        return NO_TIMER;
+    }
+    Timer timer;
+    timer.due = currentTick + std::max<uint64_t>(delayTicks, 1);
+    timer.id = id;
+    timer.event = event;
+    timer.data = data;
+    timers.push_back(timer);
+    place(index);
+    stats.pending = timers.size();
+    stats.peak = std::max(stats.peak, stats.pending);
+    return id;
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    const uint32_t index = ids.find(id);
+    if (index == HandlePool::NOT_FOUND) {
+        return false;
+    }
+    unlink(index);
+    remove(index);
+    return true;
+}
+
+bool TimerWheel::isPending(TimerId id) const {
+    return ids.find(id) != HandlePool::NOT_FOUND;
+}
+
+uint64_t TimerWheel::remainingTicks(TimerId id) const {
+    const uint32_t index = ids.find(id);
+    return index == HandlePool::NOT_FOUND ? 0 : timers[index].due - currentTick;
+}
+
+void TimerWheel::advance(float deltaTime, std::vector<Expired>& expired) {
+    carry += deltaTime;
+    const float ticks = std::floor(carry / tickSeconds + 1e-3f);
+    carry = std::max(0.0f, carry - ticks * tickSeconds);
+    advanceTicks(static_cast<uint64_t>(ticks), expired);
+}
+
+void TimerWheel::advanceTicks(uint64_t ticks, std::vector<Expired>& expired) {
+    stats.fired = 0;
+    stats.cascaded = 0;
+    if (timers.empty()) {
+        currentTick += ticks; // Nothing can be due or move down
+        return;
+    }
+    for (uint64_t i = 0; i < ticks; ++i) {
+        tick(expired);
+    }
+}
+
+void TimerWheel::tick(std::vector<Expired>& expired) {
+    ++currentTick;
+    if ((currentTick & SLOT_MASK) == 0) {
+        cascade(1);
+    }
+    // Everything in this slot is due now: cascading just moved the rest down
+    const uint32_t bucket = static_cast<uint32_t>(currentTick & SLOT_MASK);
+    while (buckets[bucket] != NONE) {
+        const uint32_t index = buckets[bucket];
+        const Timer& timer = timers[index];
+        expired.push_back(Expired{timer.id, timer.event, timer.data});
+        unlink(index);
+        remove(index);
+        stats.fired++;
+    }
+}
+
+void TimerWheel::cascade(uint32_t level) {
+    if (level >= LEVELS) return;
+    const uint32_t slot = static_cast<uint32_t>(currentTick >> (SLOT_BITS * level)) & SLOT_MASK;
+    if (slot == 0) {
+        cascade(level + 1); // The coarser wheel turned too; its timers land in this one first
+    }
+    const uint32_t bucket = level * SLOTS + slot;
+    while (buckets[bucket] != NONE) {
+        const uint32_t index = buckets[bucket];
+        unlink(index);
+        place(index); // Always a lower level, or for the overlong an earlier top slot
+        stats.cascaded++;
+    }
+}
+
+void TimerWheel::place(uint32_t index) {
+    const uint64_t delay = std::min(timers[index].due - currentTick, MAX_DELAY);
+    const uint64_t due = currentTick + delay;
+    uint32_t level = 0;
+    while (level + 1 < LEVELS && delay >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+    const uint32_t slot = static_cast<uint32_t>(due >> (SLOT_BITS * level)) & SLOT_MASK;
+    link(index, level * SLOTS + slot);
+}
+
+void TimerWheel::link(uint32_t index, uint32_t bucket) {
+    Timer& timer = timers[index];
+    timer.bucket = bucket;
+    timer.prev = NONE;
+    timer.next = buckets[bucket];
+    if (timer.next != NONE) {
+        timers[timer.next].prev = index;
+    }
+    buckets[bucket] = index;
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    Timer& timer = timers[index];
+    if (timer.bucket == NONE) return;
+    if (timer.prev != NONE) {
+        timers[timer.prev].next = timer.next;
+    } else {
+        buckets[timer.bucket] = timer.next;
+    }
+    if (timer.next != NONE) {
+        timers[timer.next].prev = timer.prev;
+    }
+    timer.bucket = timer.prev = timer.next = NONE;
+}
+
+void TimerWheel::remove(uint32_t index) {
+    ids.release(timers[index].id);
+    const uint32_t last = static_cast<uint32_t>(timers.size() - 1);
+    if (index != last) {
+        // Move the last timer into the hole and repoint its neighbours and id
+        timers[index] = timers[last];
+        const Timer& moved = timers[index];
+        if (moved.bucket != NONE) {
+            if (moved.prev != NONE) {
+                timers[moved.prev].next = index;
+            } else {
+                buckets[moved.bucket] = index;
+            }
+            if (moved.next != NONE) {
+                timers[moved.next].prev = index;
+            }
+        }
+        ids.relocate(moved.id, index);
+    }
+    timers.pop_back();
+    stats.pending = timers.size();
+}
+
+void TimerWheel::clear() {
+    timers.clear();
+    carry = 0.0f;
+    buckets.fill(NONE);
+    ids.clear();
+    stats = Stats();
+}
+
+void TimerWheel::saveState(SimSnapshot& snapshot) const {
+    snapshot.write(currentTick);
+    snapshot.write(carry);
+    snapshot.writeArray(timers);
+    snapshot.write(buckets);
+    ids.saveState(snapshot);
+}
+
+bool TimerWheel::loadState(SimSnapshot& snapshot) {
+    if (!(snapshot.read(currentTick) && snapshot.read(carry) && snapshot.readArray(timers) &&
+          snapshot.read(buckets) && ids.loadState(snapshot))) {
+        return false;
+    }
+    stats.pending = timers.size();
+    stats.peak = std::max(stats.peak, stats.pending);
+    return true;
+}
@@ -1,7 +1,37 @@
 #include "Game.hpp"
+#include "AssetManifest.hpp"
+#include "AssetPack.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
 
-int main() {
+// Usage: game [--replay file] [--host port] [--join address[:port]]
+int main(int argc, char** argv) {
+    // Read assets from the pack when one has been built; loose files otherwise
+    AssetPack::instance().mount("assets.pak");
+    // Loose files: find the directory the build's manifest lists them in, once
+    if (!AssetManifest::resolveRoot()) {
+        std::cerr << "Asset directory not found; assets will fall back to placeholders" << std::endl;
+    }
+    
     Game game;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--replay") == 0) {
+            game.playReplay(argv[++i]);
+        } else if (std::strcmp(argv[i], "--host") == 0) {
+            game.hostNetplay(static_cast<unsigned short>(std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--join") == 0) {
+            const std::string target = argv[++i];
+            const size_t colon = target.rfind(':');
+            if (colon == std::string::npos) {
+                game.joinNetplay(target, NetTransport::DEFAULT_PORT);
+            } else {
+                game.joinNetplay(target.substr(0, colon),
+                                 static_cast<unsigned short>(std::atoi(target.c_str() + colon + 1)));
+            }
+        }
+    }
     game.run();
     return 0;
 } 
\ No newline at end of file
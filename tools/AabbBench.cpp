@@ -0,0 +1,89 @@
+// Microbenchmark: scalar vs batch (SIMD) AABB overlap kernel.
+// Usage: aabb_bench [queries]
+#include "AabbBatch.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchResult {
+    double scalarMs;
+    double batchMs;
+    size_t hits;
+    bool matches;
+};
+
+BenchResult runBench(size_t boxCount, size_t queryCount, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> pos(0.0f, 20000.0f);
+    std::uniform_real_distribution<float> size(8.0f, 256.0f);
+
+    // Level-like distribution of platforms
+    AabbBatch::BoxArray boxes;
+    boxes.reserve(boxCount);
+    for (size_t i = 0; i < boxCount; ++i) {
+        boxes.push(sf::FloatRect(sf::Vector2f(pos(rng), pos(rng)), sf::Vector2f(size(rng), size(rng) * 0.25f)));
+    }
+
+    std::vector<sf::FloatRect> queries;
+    queries.reserve(queryCount);
+    for (size_t i = 0; i < queryCount; ++i) {
+        queries.push_back(sf::FloatRect(sf::Vector2f(pos(rng), pos(rng)), sf::Vector2f(56.0f, 56.0f)));
+    }
+
+    std::vector<uint32_t> scalarHits, batchHits;
+    size_t scalarTotal = 0, batchTotal = 0;
+    bool matches = true;
+
+    auto start = Clock::now();
+    for (const auto& q : queries) {
+        scalarTotal += AabbBatch::overlapListScalar(q, boxes, scalarHits);
+    }
+    auto mid = Clock::now();
+    for (const auto& q : queries) {
+        batchTotal += AabbBatch::overlapList(q, boxes, batchHits);
+    }
+    auto end = Clock::now();
+
+    // Verify on a subset so the check doesn't skew timings
+    for (size_t i = 0; i < queries.size() && i < 256; ++i) {
+        AabbBatch::overlapListScalar(queries[i], boxes, scalarHits);
+        AabbBatch::overlapList(queries[i], boxes, batchHits);
+        if (scalarHits != batchHits) {
+            matches = false;
+            break;
+        }
+    }
+
+    BenchResult result;
+    result.scalarMs = std::chrono::duration<double, std::milli>(mid - start).count();
+    result.batchMs = std::chrono::duration<double, std::milli>(end - mid).count();
+    result.hits = batchTotal;
+    result.matches = matches && scalarTotal == batchTotal;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t queries = argc > 1 ? static_cast<size_t>(std::strtoul(argv[1], nullptr, 10)) : 1000;
+    if (queries == 0) queries = 1000;
+
+    std::printf("AABB batch kernel: %s, %zu queries per size\n", AabbBatch::kernelName(), queries);
+    std::printf("%10s %12s %12s %9s %10s %s\n", "boxes", "scalar ms", "batch ms", "speedup", "hits", "check");
+
+    const size_t sizes[] = {1000, 10000, 100000};
+    int failures = 0;
+    for (size_t n : sizes) {
+        BenchResult r = runBench(n, queries, 1234u);
+        std::printf("%10zu %12.3f %12.3f %8.2fx %10zu %s\n", n, r.scalarMs, r.batchMs,
+                    r.batchMs > 0.0 ? r.scalarMs / r.batchMs : 0.0, r.hits, r.matches ? "ok" : "MISMATCH");
+        if (!r.matches) failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,372 @@
+// Cooks the asset tree into a cache directory, incrementally and on every core.
+// Usage: asset_cooker [--force] [--threads N] <assets dir> <cache dir> [name prefix, default "assets"]
+//
+// Every PNG is cooked into ImageCodec's raw payload (what asset_packer
+// --raw-images stores), recorded in the cache's CookCache database. A run
+// only stats the sources: one whose size and mtime match its record is left
+// alone, a changed one is hashed and cooked again only if its contents
+// differ. Outputs of sources that are gone are deleted. --force cooks
+// everything; --threads caps the workers (default: every core).
+//
+// Backgrounds painted wider than a texture (<layer>.wide.png) are split first
+// into the tile directory TileLayout describes, written next to the source
+// as the level cooker writes .lvl files, so the game, the manifest and the
+// pack see the tiles as ordinary assets; the image pass then cooks them too.
+#include "CookCache.hpp"
+#include "AssetPack.hpp"
+#include "ImageCodec.hpp"
+#include "JobSystem.hpp"
+#include "MappedFile.hpp"
+#include "TileLayout.hpp"
+#include <SFML/Graphics/Image.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Source {
+    std::string name;
+    fs::path path;
+    uint64_t size;
+    int64_t time;
+};
+
+enum class Result { Cooked, Touched, Failed };
+
+struct Cook {
+    const Source* source;
+    CookCache::Entry entry;
+    Result result = Result::Failed;
+    std::string error;
+};
+
+bool writeOutput(const std::string& path, const std::vector<char>& bytes, std::string& error) {
+    // Written aside and renamed over, so a cook that dies midway leaves no torn output
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file || !file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()))) {
+            error = "cannot write " + temporary;
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(temporary, path, ec);
+    if (ec) {
+        error = "cannot replace " + path + ": " + ec.message();
+        return false;
+    }
+    return true;
+}
+
+bool outputExists(const CookCache& cache, const std::string& name, uint64_t size) {
+    std::error_code ec;
+    return fs::file_size(cache.getOutputPath(name), ec) == size && !ec;
+}
+
+bool tilesExist(const Source& source) {
+    std::error_code ec;
+    return fs::is_regular_file(fs::path(TileLayout::getDirectoryFor(source.path.string())) / TileLayout::LAYOUT_FILE, ec);
+}
+
+bool endsWith(const std::string& text, std::string_view suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// PNGs under 'root', named as the pack names them; only their metadata is read
+void walk(const fs::path& root, const std::string& prefix, std::vector<Source>& wide, std::vector<Source>& images) {
+    wide.clear();
+    images.clear();
+    for (const auto& entry : fs::recursive_directory_iterator(root)) {
+        if (!entry.is_regular_file()) continue;
+        const std::string filename = entry.path().filename().string();
+        if (!filename.empty() && filename[0] == '.') continue;
+        const std::string name = AssetPack::normalizeName(prefix + "/" + fs::relative(entry.path(), root).generic_string());
+        if (AssetPack::formatFromExtension(name) != AssetPack::Format::Png) continue;
+        Source source{name, entry.path(), entry.file_size(),
+                      static_cast<int64_t>(entry.last_write_time().time_since_epoch().count())};
+        (endsWith(name, TileLayout::SOURCE_SUFFIX) ? wide : images).push_back(std::move(source));
+    }
+}
+
+// Hashes the source into 'cook'; true when it's only been touched since 'version' cooked it
+bool hashSource(const CookCache& cache, bool force, uint32_t version, bool outputPresent, const MappedFile& file,
+                Cook& cook) {
+    const Source& source = *cook.source;
+    cook.entry.sourceSize = source.size;
+    cook.entry.sourceTime = source.time;
+    cook.entry.sourceHash = AssetPack::hashName(std::string_view(file.data(), file.size()));
+    cook.entry.cookVersion = version;
+    const CookCache::Entry* previous = cache.find(source.name);
+    if (!force && previous && previous->sourceHash == cook.entry.sourceHash && previous->cookVersion == version &&
+        outputPresent) {
+        cook.entry.outputSize = previous->outputSize;
+        cook.result = Result::Touched;
+        return true;
+    }
+    return false;
+}
+
+// One wide image at a time, its tiles encoded across the workers. The layout
+// file goes last, so a directory without one is an unfinished split.
+void splitWideImage(const CookCache& cache, bool force, JobSystem& jobs, Cook& cook) {
+    const Source& source = *cook.source;
+    MappedFile file;
+    if (!file.open(source.path.string())) {
+        cook.error = "cannot read " + source.path.string();
+        return;
+    }
+    if (hashSource(cache, force, CookCache::TILE_SPLIT_VERSION, tilesExist(source), file, cook)) {
+        return;
+    }
+    sf::Image image;
+    if (!image.loadFromMemory(file.data(), file.size())) {
+        cook.error = "cannot decode " + source.path.string();
+        return;
+    }
+    const TileLayout layout = TileLayout::forImage(image.getSize());
+    const fs::path directory = TileLayout::getDirectoryFor(source.path.string());
+    std::error_code ec;
+    fs::remove_all(directory, ec); // A smaller image leaves no tiles behind
+    if (!fs::create_directories(directory, ec) && ec) {
+        cook.error = "cannot create " + directory.string() + ": " + ec.message();
+        return;
+    }
+
+    const uint8_t* pixels = image.getPixelsPtr();
+    const size_t stride = static_cast<size_t>(layout.size.x) * 4;
+    std::vector<uint8_t> written(layout.getTileCount() + 1, 0);
+    jobs.parallelFor(written.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (i == layout.getTileCount()) {
+                // The preview: a box filter down to fit PREVIEW_SIZE
+                const unsigned factor = std::max(1u, (std::max(layout.size.x, layout.size.y) + TileLayout::PREVIEW_SIZE - 1) /
+                                                         TileLayout::PREVIEW_SIZE);
+                const sf::Vector2u size(std::max(1u, layout.size.x / factor), std::max(1u, layout.size.y / factor));
+                std::vector<uint8_t> preview(static_cast<size_t>(size.x) * size.y * 4);
+                for (unsigned y = 0; y < size.y; ++y) {
+                    for (unsigned x = 0; x < size.x; ++x) {
+                        uint32_t sum[4] = {};
+                        for (unsigned dy = 0; dy < factor; ++dy) {
+                            const uint8_t* row = pixels + (static_cast<size_t>(y) * factor + dy) * stride +
+                                                 static_cast<size_t>(x) * factor * 4;
+                            for (unsigned dx = 0; dx < factor * 4; ++dx) {
+                                sum[dx % 4] += row[dx];
+                            }
+                        }
+                        for (unsigned c = 0; c < 4; ++c) {
+                            preview[(static_cast<size_t>(y) * size.x + x) * 4 + c] =
+                                static_cast<uint8_t>(sum[c] / (factor * factor));
+                        }
+                    }
+                }
+                written[i] = sf::Image(size, preview.data()).saveToFile(directory / TileLayout::PREVIEW_FILE);
+                continue;
+            }
+            const unsigned column = static_cast<unsigned>(i % layout.columns);
+            const unsigned row = static_cast<unsigned>(i / layout.columns);
+            const sf::IntRect rect = layout.getTileRect(column, row);
+            std::vector<uint8_t> tile(static_cast<size_t>(rect.size.x) * rect.size.y * 4);
+            for (int y = 0; y < rect.size.y; ++y) {
+                std::memcpy(tile.data() + static_cast<size_t>(y) * rect.size.x * 4,
+                            pixels + static_cast<size_t>(rect.position.y + y) * stride + static_cast<size_t>(rect.position.x) * 4,
+                            static_cast<size_t>(rect.size.x) * 4);
+            }
+            const sf::Vector2u size(static_cast<unsigned>(rect.size.x), static_cast<unsigned>(rect.size.y));
+            written[i] = sf::Image(size, tile.data()).saveToFile(TileLayout::getTilePath(directory.string(), column, row));
+        }
+    });
+    if (std::find(written.begin(), written.end(), 0) != written.end()) {
+        cook.error = "cannot write the tiles into " + directory.string();
+        return;
+    }
+    const std::string json = layout.toJson();
+    if (!writeOutput((directory / TileLayout::LAYOUT_FILE).string(), std::vector<char>(json.begin(), json.end()),
+                     cook.error)) {
+        return;
+    }
+    cook.entry.outputSize = 0; // The tiles are assets of their own
+    cook.result = Result::Cooked;
+}
+
+// On a worker; writes only 'cook' and its own output
+void cookImage(const CookCache& cache, bool force, Cook& cook) {
+    const Source& source = *cook.source;
+    MappedFile file;
+    if (!file.open(source.path.string())) {
+        cook.error = "cannot read " + source.path.string();
+        return;
+    }
+    // Touched but unchanged (a checkout, a re-save): the output stands
+    const CookCache::Entry* previous = cache.find(source.name);
+    if (hashSource(cache, force, CookCache::RAW_IMAGE_VERSION,
+                   previous && outputExists(cache, source.name, previous->outputSize), file, cook)) {
+        return;
+    }
+
+    sf::Image image;
+    if (!image.loadFromMemory(file.data(), file.size())) {
+        cook.error = "cannot decode " + source.path.string();
+        return;
+    }
+    const std::vector<char> payload = ImageCodec::encodeRaw(image.getPixelsPtr(), image.getSize());
+    if (!writeOutput(cache.getOutputPath(source.name), payload, cook.error)) {
+        return;
+    }
+    cook.entry.outputSize = payload.size();
+    cook.result = Result::Cooked;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool force = false;
+    unsigned threads = 0;
+    std::vector<const char*> args;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--force") == 0) {
+            force = true;
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    if (args.size() < 2) {
+        std::fprintf(stderr, "Usage: %s [--force] [--threads N] <assets dir> <cache dir> [name prefix]\n", argv[0]);
+        return 1;
+    }
+    const fs::path root = args[0];
+    const fs::path cacheDirectory = args[1];
+    const std::string prefix = args.size() > 2 ? args[2] : "assets";
+    const auto start = std::chrono::steady_clock::now();
+
+    std::error_code ec;
+    if (!fs::is_directory(root, ec)) {
+        std::fprintf(stderr, "Not a directory: %s\n", root.string().c_str());
+        return 1;
+    }
+    fs::create_directories(cacheDirectory, ec);
+    CookCache cache(cacheDirectory.string());
+    cache.load();
+
+    JobSystem jobs(threads > 0 ? std::max(1u, threads - 1) : 0);
+    std::vector<Source> wideSources;
+    std::vector<Source> sources;
+    walk(root, prefix, wideSources, sources);
+
+    // Wide images first; the tiles they're split into are sources of the image pass
+    std::vector<Cook> splits;
+    for (const Source& source : wideSources) {
+        if (force || !cache.isCurrent(source.name, source.size, source.time, CookCache::TILE_SPLIT_VERSION) ||
+            !tilesExist(source)) {
+            splits.push_back(Cook{&source, {}, Result::Failed, {}});
+            splitWideImage(cache, force, jobs, splits.back());
+        }
+    }
+    std::vector<Cook> cooks;
+    if (std::any_of(splits.begin(), splits.end(), [](const Cook& split) { return split.result == Result::Cooked; })) {
+        std::vector<Source> unchanged;
+        walk(root, prefix, unchanged, sources); // 'wideSources' backs the splits
+    }
+
+    // The stale ones: new, changed, cooked by another version, or missing their output
+    std::unordered_set<std::string> sourceNames;
+    for (const Source& source : wideSources) {
+        sourceNames.insert(source.name);
+    }
+    for (const Source& source : sources) {
+        sourceNames.insert(source.name);
+        const CookCache::Entry* entry = cache.find(source.name);
+        if (force || !cache.isCurrent(source.name, source.size, source.time, CookCache::RAW_IMAGE_VERSION) ||
+            !outputExists(cache, source.name, entry->outputSize)) {
+            cooks.push_back(Cook{&source, {}, Result::Failed, {}});
+            fs::create_directories(fs::path(cache.getOutputPath(source.name)).parent_path(), ec);
+        }
+    }
+
+    // One source per chunk: decode times vary too much for bigger ones to balance
+    jobs.parallelFor(cooks.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            cookImage(cache, force, cooks[i]);
+        }
+    });
+
+    size_t split = 0;
+    size_t cooked = 0;
+    size_t touched = 0;
+    size_t failed = 0;
+    uint64_t cookedBytes = 0;
+    for (const Cook& cook : splits) {
+        split += cook.result == Result::Cooked;
+    }
+    splits.insert(splits.end(), cooks.begin(), cooks.end());
+    for (const Cook& cook : splits) {
+        switch (cook.result) {
+            case Result::Cooked:
+                cooked++;
+                cookedBytes += cook.entry.outputSize;
+                cache.set(cook.source->name, cook.entry);
+                break;
+            case Result::Touched:
+                touched++;
+                cache.set(cook.source->name, cook.entry);
+                break;
+            case Result::Failed:
+                failed++;
+                cache.erase(cook.source->name);
+                std::fprintf(stderr, "Failed to cook %s: %s\n", cook.source->name.c_str(), cook.error.c_str());
+                break;
+        }
+    }
+    cooked -= split;
+
+    std::vector<std::string> removed;
+    for (const auto& [name, entry] : cache.getEntries()) {
+        if (sourceNames.count(name) == 0) {
+            removed.push_back(name);
+        }
+    }
+    for (const std::string& name : removed) {
+        if (endsWith(name, TileLayout::SOURCE_SUFFIX)) {
+            // The tiles of a wide image that's gone; the next run drops their cooked copies
+            const fs::path source = root / fs::path(name.substr(std::min(name.size(), prefix.size() + 1)));
+            fs::remove_all(TileLayout::getDirectoryFor(source.string()), ec);
+        } else {
+            fs::remove(cache.getOutputPath(name), ec);
+        }
+        cache.erase(name);
+    }
+
+    if (!splits.empty() || !removed.empty()) {
+        std::string error;
+        if (!cache.save(error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::printf("Cooked %zu of %zu images (%.1f MB) in %.0f ms on %u threads; %zu unchanged, %zu touched, %zu removed",
+                cooked, sources.size(), cookedBytes / (1024.0 * 1024.0), ms, jobs.getThreadCount(),
+                sources.size() - cooks.size(), touched, removed.size());
+    if (!wideSources.empty()) {
+        std::printf("; split %zu of %zu wide images into tiles", split, wideSources.size());
+    }
+    if (failed > 0) {
+        std::printf(", %zu failed\n", failed);
+        return 1;
+    }
+    std::printf("\n");
+    return 0;
+}
@@ -0,0 +1,152 @@
+// Generates the asset manifest header read by AssetManifest from a directory tree.
+// Usage: asset_manifest <assets dir> <output header> [name prefix, default "assets"]
+// The header is only rewritten when its contents change, so an unchanged asset
+// tree doesn't recompile the game.
+#include "AssetIndex.hpp"
+#include "AssetManifest.hpp"
+#include "AssetPack.hpp"
+#include "MappedFile.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct ManifestFile {
+    std::string name;
+    uint64_t id;
+    uint64_t size;
+    AssetPack::Format format;
+    sf::Vector2u dimensions;
+};
+
+const char* formatName(AssetPack::Format format) {
+    switch (format) {
+        case AssetPack::Format::Png: return "Png";
+        case AssetPack::Format::Jpeg: return "Jpeg";
+        case AssetPack::Format::Wav: return "Wav";
+        case AssetPack::Format::Font: return "Font";
+        case AssetPack::Format::Ogg: return "Ogg";
+        case AssetPack::Format::Flac: return "Flac";
+        case AssetPack::Format::Json: return "Json";
+        case AssetPack::Format::RawImage: return "RawImage";
+        default: return "Unknown";
+    }
+}
+
+std::string quoted(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "Usage: %s <assets dir> <output header> [name prefix]\n", argv[0]);
+        return 1;
+    }
+    const fs::path root = argv[1];
+    const fs::path output = argv[2];
+    const std::string prefix = argc > 3 ? argv[3] : "assets";
+
+    std::error_code ec;
+    if (!fs::is_directory(root, ec)) {
+        std::fprintf(stderr, "Not a directory: %s\n", root.string().c_str());
+        return 1;
+    }
+
+    std::vector<ManifestFile> files;
+    for (const auto& entry : fs::recursive_directory_iterator(root)) {
+        if (!entry.is_regular_file()) continue;
+        // Skip editor/OS droppings, as the packer does
+        const std::string filename = entry.path().filename().string();
+        if (!filename.empty() && filename[0] == '.') continue;
+
+        ManifestFile file;
+        file.name = AssetPack::normalizeName(prefix + "/" + fs::relative(entry.path(), root).generic_string());
+        file.id = AssetManifest::idOf(file.name);
+        file.size = entry.file_size();
+        file.format = AssetPack::formatFromExtension(file.name);
+
+        std::string extension = entry.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        MappedFile mapped;
+        if (AssetIndex::isImageExtension(extension) && mapped.open(entry.path().string())) {
+            AssetIndex::probeImageSize(mapped.data(), mapped.size(), extension, file.dimensions);
+        }
+        files.push_back(std::move(file));
+    }
+    // Sorted by name so the output only changes with the tree
+    std::sort(files.begin(), files.end(),
+              [](const ManifestFile& a, const ManifestFile& b) { return a.name < b.name; });
+
+    // Open addressing, at most half full, so lookups usually take one probe
+    size_t slotCount = 2;
+    while (slotCount < files.size() * 2) slotCount *= 2;
+    std::vector<uint32_t> slots(slotCount, 0);
+    for (size_t i = 0; i < files.size(); ++i) {
+        size_t slot = files[i].id & (slotCount - 1);
+        while (slots[slot] != 0) slot = (slot + 1) & (slotCount - 1);
+        slots[slot] = static_cast<uint32_t>(i + 1);
+    }
+
+    std::ostringstream out;
+    out << "// Generated by asset_manifest from " << fs::absolute(root).generic_string() << "; do not edit\n"
+        << "#pragma once\n"
+        << "#include \"AssetManifest.hpp\"\n\n"
+        << "namespace AssetManifest::generated {\n\n"
+        << "inline constexpr const char* SOURCE_ROOT = "
+        << quoted(fs::absolute(root).lexically_normal().generic_string()) << ";\n"
+        << "inline constexpr size_t ENTRY_COUNT = " << files.size() << ";\n\n"
+        << "// Sorted by path; an empty tree still gets one unreachable entry\n"
+        << "inline constexpr Entry ENTRIES[] = {\n";
+    for (const ManifestFile& file : files) {
+        out << "    {" << quoted(file.name) << ", 0x" << std::hex << file.id << std::dec << "ull, "
+            << file.size << "ull, AssetPack::Format::" << formatName(file.format) << ", "
+            << file.dimensions.x << ", " << file.dimensions.y << "},\n";
+    }
+    if (files.empty()) {
+        out << "    {\"\", 0, 0, AssetPack::Format::Unknown, 0, 0},\n";
+    }
+    out << "};\n\n"
+        << "// ENTRIES index + 1 by ID, 0 for an empty slot\n"
+        << "inline constexpr size_t SLOT_MASK = " << slotCount - 1 << ";\n"
+        << "inline constexpr uint32_t SLOTS[] = {";
+    for (size_t i = 0; i < slots.size(); ++i) {
+        out << (i % 16 == 0 ? "\n    " : " ") << slots[i] << ",";
+    }
+    out << "\n};\n\n"
+        << "static_assert(ENTRY_COUNT == 0 || idOf(ENTRIES[0].path) == ENTRIES[0].id, "
+        << "\"manifest IDs are out of date with AssetManifest::idOf\");\n\n"
+        << "} // namespace AssetManifest::generated\n";
+    const std::string contents = out.str();
+
+    {
+        std::ifstream existing(output, std::ios::binary);
+        if (existing && std::string(std::istreambuf_iterator<char>(existing), {}) == contents) {
+            return 0;
+        }
+    }
+    fs::create_directories(output.parent_path(), ec);
+    std::ofstream file(output, std::ios::binary | std::ios::trunc);
+    if (!file || !file.write(contents.data(), static_cast<std::streamsize>(contents.size()))) {
+        std::fprintf(stderr, "Failed to write %s\n", output.string().c_str());
+        return 1;
+    }
+    std::printf("Listed %zu assets in %s\n", files.size(), output.string().c_str());
+    return 0;
+}
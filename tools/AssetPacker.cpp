@@ -0,0 +1,333 @@
+// Builds the asset pack read by AssetPack from a directory tree.
+// Usage: asset_packer [--raw-images] [--cooked <cache dir>] <assets dir> <output.pak> [name prefix, default "assets"]
+// --raw-images stores PNGs pre-decoded (ImageCodec's raw payload) so the game
+// loads them without running the PNG decoder. With --cooked, the payloads
+// asset_cooker has cached for unchanged PNGs are taken as they are; only the
+// rest are decoded here.
+//
+// Each level found as levels/level<N>.json gets a bundle: its dependency
+// manifest (LevelAssets::collect over the packed files) becomes the bundle's
+// file list, and the payloads are laid out unbundled files first, then the
+// files several levels share, then every level's own files back to back.
+#include "AssetPack.hpp"
+#include "CookCache.hpp"
+#include "ImageCodec.hpp"
+#include "LevelAssets.hpp"
+#include "LevelLoader.hpp"
+#include "TileLayout.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct PackFile {
+    std::string name;
+    fs::path source;
+    uint64_t hash;
+    uint64_t size;
+    AssetPack::Format format;
+    std::vector<char> payload; // Encoded here instead of copied from 'source'
+    int level = 0;             // The one bundle using it; -1 when several do
+};
+
+struct LevelBundle {
+    int level;
+    std::vector<uint32_t> files; // Indices into the sorted files
+};
+
+constexpr uint64_t PAYLOAD_ALIGNMENT = 16;
+
+uint64_t alignUp(uint64_t value) {
+    return (value + PAYLOAD_ALIGNMENT - 1) & ~(PAYLOAD_ALIGNMENT - 1);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool rawImages = false;
+    const char* cookedDirectory = nullptr;
+    std::vector<const char*> args;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--raw-images") == 0) {
+            rawImages = true;
+        } else if (std::strcmp(argv[i], "--cooked") == 0 && i + 1 < argc) {
+            cookedDirectory = argv[++i];
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    if (args.size() < 2) {
+        std::fprintf(stderr, "Usage: %s [--raw-images] [--cooked <cache dir>] <assets dir> <output.pak> [name prefix]\n",
+                     argv[0]);
+        return 1;
+    }
+    const fs::path root = args[0];
+    const fs::path output = args[1];
+    const std::string prefix = args.size() > 2 ? args[2] : "assets";
+
+    std::error_code ec;
+    if (!fs::is_directory(root, ec)) {
+        std::fprintf(stderr, "Not a directory: %s\n", root.string().c_str());
+        return 1;
+    }
+
+    CookCache cooked(cookedDirectory ? cookedDirectory : "");
+    if (cookedDirectory && !cooked.load()) {
+        std::fprintf(stderr, "No cook database in %s; decoding every image\n", cookedDirectory);
+    }
+    size_t cookedImages = 0;
+
+    std::vector<PackFile> files;
+    uint64_t imageSourceBytes = 0;
+    uint64_t imageRawBytes = 0;
+    uint64_t imagePixelBytes = 0;
+    for (const auto& entry : fs::recursive_directory_iterator(root)) {
+        if (!entry.is_regular_file()) continue;
+        // Skip editor/OS droppings
+        const std::string filename = entry.path().filename().string();
+        if (!filename.empty() && filename[0] == '.') continue;
+        // Wide backgrounds ship as the tiles asset_cooker split them into
+        const std::string_view wideSuffix(TileLayout::SOURCE_SUFFIX);
+        if (filename.size() > wideSuffix.size() &&
+            filename.compare(filename.size() - wideSuffix.size(), wideSuffix.size(), wideSuffix) == 0) {
+            continue;
+        }
+
+        PackFile file;
+        file.name = AssetPack::normalizeName(prefix + "/" + fs::relative(entry.path(), root).generic_string());
+        file.source = entry.path();
+        file.hash = AssetPack::hashName(file.name);
+        file.size = entry.file_size();
+        file.format = AssetPack::formatFromExtension(file.name);
+        if (rawImages && file.format == AssetPack::Format::Png) {
+            const int64_t modifiedTime = entry.last_write_time().time_since_epoch().count();
+            sf::Vector2u imageSize;
+            if (cookedDirectory && cooked.isCurrent(file.name, file.size, modifiedTime, CookCache::RAW_IMAGE_VERSION)) {
+                std::ifstream in(cooked.getOutputPath(file.name), std::ios::binary);
+                file.payload.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+                if (file.payload.size() == cooked.find(file.name)->outputSize &&
+                    ImageCodec::readRawSize(file.payload.data(), file.payload.size(), imageSize)) {
+                    cookedImages++;
+                } else {
+                    file.payload.clear(); // Damaged; decoded below instead
+                }
+            }
+            if (file.payload.empty()) {
+                sf::Image image;
+                if (!image.loadFromFile(file.source)) {
+                    std::fprintf(stderr, "Cannot decode %s\n", file.source.string().c_str());
+                    return 1;
+                }
+                file.payload = ImageCodec::encodeRaw(image.getPixelsPtr(), image.getSize());
+                imageSize = image.getSize();
+            }
+            file.size = file.payload.size();
+            file.format = AssetPack::Format::RawImage;
+            imageSourceBytes += entry.file_size();
+            imageRawBytes += file.size;
+            imagePixelBytes += static_cast<uint64_t>(imageSize.x) * imageSize.y * 4;
+        }
+        files.push_back(std::move(file));
+    }
+
+    // The reader binary-searches by hash; names break ties so output is deterministic
+    std::sort(files.begin(), files.end(), [](const PackFile& a, const PackFile& b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.name < b.name;
+    });
+
+    // Bundles: each level's dependencies among the packed files
+    std::unordered_map<std::string, uint32_t> fileIndex;
+    for (size_t i = 0; i < files.size(); ++i) {
+        fileIndex.emplace(files[i].name, static_cast<uint32_t>(i));
+    }
+    const LevelAssets::Exists exists = [&](const std::string& path) {
+        return fileIndex.count(AssetPack::normalizeName(path)) != 0;
+    };
+    const LevelAssets::ListDirectory list = [&](const std::string& directory, std::vector<std::string>& out) {
+        const std::string prefixPath = AssetPack::normalizeName(directory) + "/";
+        for (const PackFile& file : files) {
+            if (file.name.compare(0, prefixPath.size(), prefixPath) == 0 &&
+                file.name.find('/', prefixPath.size()) == std::string::npos) {
+                out.push_back(file.name);
+            }
+        }
+    };
+    std::vector<LevelBundle> bundles;
+    std::vector<std::string> dependencies;
+    for (int level = 1; fs::is_regular_file(root / "levels" / ("level" + std::to_string(level) + ".json"), ec); ++level) {
+        const fs::path levelPath = root / "levels" / ("level" + std::to_string(level) + ".json");
+        LevelData data;
+        std::string error;
+        if (!LevelLoader::loadFromFile(levelPath.string(), data, error)) {
+            std::fprintf(stderr, "Skipping the bundle of level %d: %s\n", level, error.c_str());
+            continue;
+        }
+        LevelAssets::collect(data, level, exists, list, dependencies);
+        LevelBundle bundle{level, {}};
+        for (const std::string& dependency : dependencies) {
+            const auto found = fileIndex.find(AssetPack::normalizeName(dependency));
+            if (found == fileIndex.end() ||
+                std::find(bundle.files.begin(), bundle.files.end(), found->second) != bundle.files.end()) {
+                continue;
+            }
+            PackFile& file = files[found->second];
+            file.level = file.level == 0 ? level : -1;
+            bundle.files.push_back(found->second);
+        }
+        bundles.push_back(std::move(bundle));
+    }
+
+    // Payload order: unbundled, shared, then each level's own; by name within each
+    std::vector<uint32_t> layout(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        layout[i] = static_cast<uint32_t>(i);
+    }
+    auto group = [&](const PackFile& file) {
+        return file.level == 0 ? 0 : file.level < 0 ? 1 : 1 + file.level;
+    };
+    std::sort(layout.begin(), layout.end(), [&](uint32_t a, uint32_t b) {
+        const int groupA = group(files[a]);
+        const int groupB = group(files[b]);
+        return groupA != groupB ? groupA < groupB : files[a].name < files[b].name;
+    });
+
+    std::string stringTable;
+    std::vector<AssetPack::FileEntry> entries(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (files[i].name.size() > UINT16_MAX) {
+            std::fprintf(stderr, "Name too long: %s\n", files[i].name.c_str());
+            return 1;
+        }
+        entries[i].nameHash = files[i].hash;
+        entries[i].size = files[i].size;
+        entries[i].nameOffset = static_cast<uint32_t>(stringTable.size());
+        entries[i].nameLength = static_cast<uint16_t>(files[i].name.size());
+        entries[i].format = static_cast<uint16_t>(files[i].format);
+        stringTable += files[i].name;
+    }
+
+    std::vector<AssetPack::BundleEntry> bundleEntries(bundles.size());
+    std::vector<uint32_t> bundleFiles;
+    for (const LevelBundle& bundle : bundles) {
+        bundleFiles.insert(bundleFiles.end(), bundle.files.begin(), bundle.files.end());
+    }
+
+    AssetPack::FileHeader header;
+    std::memcpy(header.magic, AssetPack::MAGIC, sizeof(header.magic));
+    header.version = AssetPack::VERSION;
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    header.stringTableSize = static_cast<uint32_t>(stringTable.size());
+    header.bundleCount = static_cast<uint32_t>(bundleEntries.size());
+    header.bundleFileCount = static_cast<uint32_t>(bundleFiles.size());
+
+    // Payloads start after the index, each aligned so decoders can read in place
+    uint64_t offset = alignUp(sizeof(header) + entries.size() * sizeof(AssetPack::FileEntry) +
+                              bundleEntries.size() * sizeof(AssetPack::BundleEntry) +
+                              bundleFiles.size() * sizeof(uint32_t) + stringTable.size());
+    for (uint32_t i : layout) {
+        entries[i].offset = offset;
+        offset = alignUp(offset + entries[i].size);
+    }
+
+    // A bundle's range spans its own files; its list holds them and the shared ones, by offset
+    uint64_t ownBytes = 0;
+    uint64_t sharedBytes = 0;
+    size_t ownFiles = 0;
+    size_t sharedFiles = 0;
+    for (const PackFile& file : files) {
+        if (file.level < 0) {
+            sharedFiles++;
+            sharedBytes += file.size;
+        }
+    }
+    uint32_t firstFile = 0;
+    for (size_t b = 0; b < bundles.size(); ++b) {
+        LevelBundle& bundle = bundles[b];
+        std::sort(bundle.files.begin(), bundle.files.end(),
+                  [&](uint32_t a, uint32_t c) { return entries[a].offset < entries[c].offset; });
+        AssetPack::BundleEntry& entry = bundleEntries[b];
+        entry = AssetPack::BundleEntry{};
+        entry.level = static_cast<uint32_t>(bundle.level);
+        entry.firstFile = firstFile;
+        entry.fileCount = static_cast<uint32_t>(bundle.files.size());
+        for (uint32_t i : bundle.files) {
+            if (files[i].level != bundle.level) continue;
+            if (entry.size == 0) {
+                entry.offset = entries[i].offset;
+            }
+            entry.size = entries[i].offset + entries[i].size - entry.offset;
+            ownFiles++;
+            ownBytes += entries[i].size;
+        }
+        std::copy(bundle.files.begin(), bundle.files.end(), bundleFiles.begin() + firstFile);
+        firstFile += entry.fileCount;
+    }
+
+    const fs::path temporary = output.string() + ".tmp";
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::fprintf(stderr, "Cannot write %s\n", temporary.string().c_str());
+        return 1;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(AssetPack::FileEntry));
+    out.write(reinterpret_cast<const char*>(bundleEntries.data()), bundleEntries.size() * sizeof(AssetPack::BundleEntry));
+    out.write(reinterpret_cast<const char*>(bundleFiles.data()), bundleFiles.size() * sizeof(uint32_t));
+    out.write(stringTable.data(), stringTable.size());
+
+    uint64_t totalBytes = 0;
+    for (uint32_t i : layout) {
+        const uint64_t position = static_cast<uint64_t>(out.tellp());
+        out.write("\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0", static_cast<std::streamsize>(entries[i].offset - position));
+
+        if (!files[i].payload.empty()) {
+            out.write(files[i].payload.data(), static_cast<std::streamsize>(files[i].payload.size()));
+            totalBytes += files[i].payload.size();
+            continue;
+        }
+        std::ifstream in(files[i].source, std::ios::binary);
+        std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (data.size() != files[i].size) {
+            std::fprintf(stderr, "Short read: %s\n", files[i].source.string().c_str());
+            return 1;
+        }
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        totalBytes += data.size();
+    }
+    out.close();
+    if (!out) {
+        std::fprintf(stderr, "Write failed: %s\n", temporary.string().c_str());
+        return 1;
+    }
+
+    fs::rename(temporary, output, ec);
+    if (ec) {
+        std::fprintf(stderr, "Cannot replace %s: %s\n", output.string().c_str(), ec.message().c_str());
+        return 1;
+    }
+
+    std::printf("Packed %zu files (%.1f MB) into %s\n", files.size(), totalBytes / (1024.0 * 1024.0),
+                output.string().c_str());
+    if (!bundles.empty()) {
+        std::printf("Bundled %zu levels: %zu own files (%.1f MB), %zu shared (%.1f MB)\n", bundles.size(), ownFiles,
+                    ownBytes / (1024.0 * 1024.0), sharedFiles, sharedBytes / (1024.0 * 1024.0));
+    }
+    if (rawImages) {
+        std::printf("Images: %.1f MB of PNG -> %.1f MB raw (%.1f MB of pixels)\n", imageSourceBytes / (1024.0 * 1024.0),
+                    imageRawBytes / (1024.0 * 1024.0), imagePixelBytes / (1024.0 * 1024.0));
+        if (cookedDirectory) {
+            std::printf("Took %zu cooked images from %s\n", cookedImages, cookedDirectory);
+        }
+    }
+    return 0;
+}
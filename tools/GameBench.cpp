@@ -0,0 +1,909 @@
+// Headless simulation benchmark: runs the game's fixed step (Simulation::step)
+// with no window or audio, driven by a scripted input stream.
+// Usage: game_bench [--ticks N] [--warmup N] [--platforms N] [--enemies N] [--npcs N]
+//                   [--threads N] [--seed N] [--script file] [--replay file]
+//                   [--max-p99-ns N] [--max-allocs-per-tick N] [--no-determinism-check]
+//                   [--no-sleep] [--rollback N] [--tile-size N] [--region N]
+//                   [--preset 1k|10k|100k] [--scene] [--ladders N] [--density N] [--width N]
+//                   [--repeat N] [--json file] [--name scenario] [--projectiles N]
+//        game_bench --compare <baseline.json> <candidate.json> [--threshold percent]
+//
+// Script files hold "<ticks> <keys>" lines, keys being any of L R U D J (or - for
+// none); the script loops. Without one, a built-in walk/jump pattern is used.
+// The game's Record Input control saves a play session in this format; --replay
+// takes the steps of a binary session replay (the game's Record Replay) instead.
+// --rollback N runs every tick the way netplay's worst case does: save a
+// snapshot, step, then restore the one from N ticks back and step those N
+// again. The timings are then per frame (1 + N steps), checked against the
+// rollback budget, and the end state has to match a run without rollback.
+// --tile-size N snaps the platforms to an N pixel grid (N pixels tall) and
+// turns on the physics tile layer, the way tile-drawn levels run.
+// --region N sets the simulation region radius around the player (0 = off, every
+// enemy fully simulated), so sim cost can be measured against enemies out of view.
+// --scene lays the level out with SceneGenerator (the game's Generated Scene) instead
+// of the bench's own scatter, adding --ladders and taking the width from --density
+// or --width; --preset N starts from one of its presets. Options apply in order,
+// so "--preset 10k --enemies 500" changes only the enemy count.
+// --repeat N runs the bench N times and reports the median of each metric.
+// Draw calls are counted headlessly: each frame the player and the crowd are
+// recorded through a RenderQueue into a RenderSnapshot around the player, as
+// Game records them, and its draw commands are counted (outside the timing and
+// the allocation count). --json merges the result into a results file under
+// --name (default: from the layout and counts), replacing a scenario of that
+// name. --compare reads two such files and prints each scenario's metrics
+// side by side; a timing metric regresses when it grew by more than
+// --threshold (default 5%) or three times the noise of either side's runs
+// (scaled median absolute deviation), whichever is larger, and a counter when
+// it grew by more than 1%.
+// --projectiles N keeps N shots flying across the level, each tick topping up
+// the ones that hit or ran out, swept against the platforms and against the
+// player and enemies through a sort-and-sweep broadphase, as Game steps them.
+// The projectile step is timed on its own too, and its p99 has to fit
+// ProjectileSystem::BUDGET_MS.
+// Exits non-zero when a limit is exceeded, two identical runs diverge or a
+// comparison finds a regression.
+#include "Simulation.hpp"
+#include "InputSystem.hpp"
+#include "InputReplay.hpp"
+#include "AssetManager.hpp"
+#include "RenderingSystem.hpp"
+#include "AllocationTracker.hpp"
+#include "RollbackSession.hpp"
+#include "SimSnapshot.hpp"
+#include "FixedPoint.hpp"
+#include "SceneGenerator.hpp"
+#include "RenderQueue.hpp"
+#include "RenderSnapshot.hpp"
+#include "JsonValue.hpp"
+#include "ProjectileSystem.hpp"
+#include "SweepAndPrune.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float FIXED_STEP = 1.0f / 60.0f; // Game::fixedTimeStep
+constexpr float GROUND_Y = 500.0f;         // WINDOW_HEIGHT - GROUND_HEIGHT
+
+struct BenchConfig {
+    size_t ticks = 3600;
+    size_t warmup = 120;
+    size_t platforms = 500;
+    size_t enemies = 200;
+    size_t npcs = 8;
+    unsigned threads = 0; // 0 = JobSystem default
+    unsigned seed = 1234u;
+    std::string script;
+    std::string replay;
+    double maxP99Ns = 0.0;        // 0 = no limit
+    double maxAllocsPerTick = -1.0; // < 0 = no limit
+    bool checkDeterminism = true;
+    bool sleeping = true; // PhysicsSystem body sleeping
+    size_t rollback = 0;  // Ticks re-run after every tick
+    float tileSize = 0.f; // Physics tile layer; 0 = off
+    float region = 2400.f; // PhysicsSystem simulation region radius; 0 = off
+    bool scene = false;    // SceneGenerator layout
+    std::string preset;
+    size_t ladders = 0;    // With 'scene'
+    float density = 8.f;   // Likewise: platforms per 1000 px
+    float width = 0.f;     // Likewise: 0 = from the density
+    size_t repeat = 1;     // Runs; metrics are their medians
+    std::string json;      // Results file to merge into
+    std::string name;      // Scenario name in it
+    size_t projectiles = 0; // Live shots kept flying; 0 = none
+};
+
+using ScriptStep = InputSystem::ScriptStep;
+
+struct BenchResult {
+    double meanNs = 0.0;
+    double p50Ns = 0.0;
+    double p99Ns = 0.0;
+    double maxNs = 0.0;
+    double allocsPerTick = 0.0;
+    double drawCalls = 0.0;   // Per frame, recorded headlessly
+    uint64_t stateHash = 0;
+    size_t snapshotBytes = 0; // With --rollback
+    double projectileP99Ns = 0.0; // With --projectiles: the projectile step's alone
+};
+
+std::vector<ScriptStep> defaultScript() {
+    auto make = [](size_t ticks, const char* keys) { return ScriptStep{ticks, InputSystem::parseButtons(keys)}; };
+    // Walk right with a few jumps, stand, walk back
+    return {make(120, "R"), make(1, "RJ"), make(59, "R"), make(1, "RJ"), make(59, "R"),
+            make(30, "-"), make(90, "L"), make(1, "LJ"), make(59, "L"), make(60, "-")};
+}
+
+// What Game owns for one level, minus the window, audio and views
+class BenchWorld {
+public:
+    BenchWorld(const BenchConfig& config)
+        : jobs(config.threads),
+          npcManager(assets, rendering),
+          player(50.f, GROUND_Y - 80.f, physics, false) {
+        if (config.scene) {
+            buildScene(config);
+        } else {
+            scatter(config);
+        }
+
+        physics.setJobSystem(&jobs);
+        npcManager.setJobSystem(&jobs);
+        physics.setSleepingEnabled(config.sleeping);
+        physics.setRegionRadius(config.region);
+        physics.initialize();
+        physics.initializePlayer(player);
+        physics.setTileGrid(config.tileSize, sf::Vector2f(levelWidth, GROUND_Y + 100.f));
+        physics.initializePlatforms(platforms);
+        physics.initializeLadders(ladders);
+        physics.initializeEnemies(enemies);
+        physics.initializeNPCs(npcManager.getAllNPCs());
+        player.setScriptedInput(&input);
+
+        if (config.projectiles > 0) {
+            projectileCount = config.projectiles;
+            shotSeed = config.seed;
+            projectiles.reserve(projectileCount);
+            entities.add(SweepAndPrune::Layer::Player, 0, player.getGlobalBounds());
+            for (size_t i = 0; i < enemies.size(); ++i) {
+                entities.add(SweepAndPrune::Layer::Enemy, static_cast<uint32_t>(i), enemies.getBounds(i));
+            }
+        }
+    }
+
+    void tick(const PlayerInput& tickInput) {
+        input = tickInput;
+        player.storePreviousState();
+        enemies.storePreviousState();
+        npcManager.storePreviousPositions();
+        npcManager.setAIFocus(player.getPosition());
+
+        SimulationWorld world{player, platforms, enemies, &npcManager, physics, jobs, true, player.getPosition()};
+        Simulation::step(world, FIXED_STEP);
+        if (projectileCount > 0) {
+            stepProjectiles();
+        }
+    }
+
+    // Time spent in ProjectileSystem::step since the last call
+    double takeProjectileNs() {
+        const double ns = projectileNs;
+        projectileNs = 0.0;
+        return ns;
+    }
+
+    void saveState(SimSnapshot& snapshot) const {
+        snapshot.clear();
+        player.saveState(snapshot);
+        enemies.saveState(snapshot);
+        physics.saveState(snapshot);
+        npcManager.saveState(snapshot);
+        if (projectileCount > 0) {
+            projectiles.saveState(snapshot);
+            snapshot.write(shotsFired);
+        }
+    }
+    bool loadState(SimSnapshot& snapshot) {
+        snapshot.rewind();
+        return player.loadState(snapshot) && enemies.loadState(snapshot) && physics.loadState(snapshot) &&
+               npcManager.loadState(snapshot) &&
+               (projectileCount == 0 || (projectiles.loadState(snapshot) && snapshot.read(shotsFired)));
+    }
+
+    // Records the frame the way Game::recordWorld does for the crowd and the
+    // player, around the player in one 800x600 view; returns the draws recorded
+    size_t countDraws() {
+        const sf::View view(player.getPosition(), sf::Vector2f(800.f, 600.f));
+        const ViewCulling::ViewSet views = ViewCulling::getViewBounds(view, 32.f);
+        queue.clear();
+        CrowdRenderer& crowd = rendering.getCrowdRenderer();
+        crowd.begin();
+        enemies.addToCrowd(crowd, views, 1.f);
+        npcManager.addToCrowd(crowd, views, 1.f);
+        projectiles.addToCrowd(crowd, views, 1.f);
+        crowd.end(queue, RenderLayer::Crowd);
+        player.draw(queue, 1.f);
+        queue.sort();
+        snapshot.reset();
+        snapshot.setView(view);
+        queue.flush(snapshot, 0);
+        size_t draws = 0;
+        for (const RenderSnapshot::Command& command : snapshot.getCommands()) {
+            if (command.kind != RenderSnapshot::Kind::Clear && command.kind != RenderSnapshot::Kind::View &&
+                command.kind != RenderSnapshot::Kind::Pass) {
+                draws++;
+            }
+        }
+        return draws;
+    }
+
+    // FNV-1a over the positions everything ended up at
+    uint64_t hashState() const {
+        uint64_t hash = 1469598103934665603ull;
+        auto mix = [&hash](float value) {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            for (int i = 0; i < 4; ++i) {
+                hash ^= (bits >> (i * 8)) & 0xffu;
+                hash *= 1099511628211ull;
+            }
+        };
+        mix(player.getPosition().x);
+        mix(player.getPosition().y);
+        for (size_t i = 0; i < enemies.size(); ++i) {
+            mix(enemies.posX[i]);
+            mix(enemies.posY[i]);
+        }
+        for (const auto& npc : npcManager.getAllNPCs()) {
+            mix(npc.x);
+            mix(npc.y);
+        }
+        for (size_t i = 0; i < projectiles.size(); ++i) {
+            mix(projectiles.posX[i]);
+            mix(projectiles.posY[i]);
+        }
+        return hash;
+    }
+
+private:
+    // Tops the shots up to the count, then steps them the way Game::stepProjectiles does.
+    // Each shot comes from its serial number, so a rollback fires the same ones again.
+    void stepProjectiles() {
+        SweepAndPrune::ProxyId id = 0;
+        entities.setBounds(id++, player.getGlobalBounds());
+        for (size_t i = 0; i < enemies.size(); ++i) {
+            entities.setBounds(id++, enemies.getBounds(i));
+        }
+        entities.updatePairs();
+
+        const float levelHeight = GROUND_Y + 100.f;
+        while (projectiles.size() < projectileCount) {
+            uint64_t state = shotSeed * 0x9e3779b97f4a7c15ull + shotsFired++;
+            auto unit = [&state]() {
+                // splitmix64
+                uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+                return static_cast<float>((z ^ (z >> 31)) >> 40) / static_cast<float>(1u << 24);
+            };
+            ProjectileSystem::Shot shot;
+            shot.owner = unit() < 0.5f ? CollisionLayer::Player : CollisionLayer::Enemy;
+            shot.targets = shot.owner == CollisionLayer::Player ? collisionBit(CollisionLayer::Enemy)
+                                                                : collisionBit(CollisionLayer::Player);
+            shot.lifetime = 1.f + unit() * 2.f;
+            shot.gravity = unit() < 0.25f ? 600.f : 0.f;
+            const sf::Vector2f centre(unit() * levelWidth, 50.f + unit() * (GROUND_Y - 70.f));
+            const float angle = unit() * 6.2831853f;
+            const float speed = 300.f + unit() * 600.f;
+            projectiles.spawn(shot, centre, sf::Vector2f(std::cos(angle), std::sin(angle)) * speed);
+        }
+
+        const ProjectileWorld world{entities, physics.getPlatformGrid(), platforms,
+                                    sf::FloatRect(sf::Vector2f(0.f, -600.f), sf::Vector2f(levelWidth, levelHeight + 600.f)),
+                                    &jobs, nullptr};
+        const auto start = Clock::now();
+        projectiles.step(world, FIXED_STEP);
+        projectileNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        projectiles.snapState();
+    }
+
+    // The bench's own layout: platforms scattered over the band above the ground
+    void scatter(const BenchConfig& config) {
+        std::mt19937 rng(config.seed);
+        levelWidth = std::max(4000.f, config.platforms * 120.f);
+        std::uniform_real_distribution<float> xDist(0.f, levelWidth);
+        std::uniform_real_distribution<float> yDist(150.f, GROUND_Y - 60.f);
+        std::uniform_real_distribution<float> widthDist(60.f, 300.f);
+
+        platforms.reserve(config.platforms);
+        platforms.add(sf::FloatRect({0.f, GROUND_Y}, {levelWidth, 100.f}), sf::Color::White);
+        const float tile = config.tileSize;
+        auto snap = [tile](float value) { return tile > 0.f ? std::round(value / tile) * tile : value; };
+        for (size_t i = 1; i < config.platforms; ++i) {
+            const sf::Vector2f position(snap(xDist(rng)), snap(yDist(rng)));
+            const sf::Vector2f size(tile > 0.f ? std::max(snap(widthDist(rng)), tile) : widthDist(rng),
+                                    tile > 0.f ? tile : 20.f);
+            platforms.add(sf::FloatRect(position, size), sf::Color::White);
+        }
+
+        // Enemies patrol on random platforms (the ground when there are none)
+        std::uniform_int_distribution<size_t> platformDist(0, platforms.size() - 1);
+        const LevelData::EnemyType enemyType;
+        enemies.reserve(config.enemies);
+        for (size_t i = 0; i < config.enemies; ++i) {
+            const sf::FloatRect& home = platforms.getBounds(platformDist(rng));
+            const float width = std::min(home.size.x, 400.f);
+            const sf::Vector2f position(home.position.x + width * 0.25f, home.position.y - enemyType.size.y);
+            enemies.spawn(enemyType, 0, position, width * 0.5f);
+        }
+
+        for (size_t i = 0; i < config.npcs; ++i) {
+            npcManager.addNPC("npc" + std::to_string(i), xDist(rng), GROUND_Y - 64.f);
+        }
+    }
+
+    // The game's generated scene, minus what only draws (decorations, particles)
+    void buildScene(const BenchConfig& config) {
+        SceneGenerator::Config scene;
+        scene.seed = config.seed;
+        scene.platforms = config.platforms;
+        scene.ladders = config.ladders;
+        scene.enemies = config.enemies;
+        scene.npcs = config.npcs;
+        scene.decorations = 0;
+        scene.particles = 0;
+        scene.density = config.density;
+        scene.width = config.width;
+        if (config.tileSize > 0.f) {
+            scene.tileSize = config.tileSize;
+        }
+        LevelData level;
+        SceneGenerator::generate(scene, level);
+        levelWidth = level.size.x;
+
+        platforms.reserve(level.platforms.size());
+        for (const LevelData::Platform& platform : level.platforms) {
+            platforms.add(platform.bounds, sf::Color::White, platform.slope);
+        }
+        ladders.reserve(level.ladders.size());
+        for (const LevelData::Ladder& ladder : level.ladders) {
+            ladders.add(ladder.bounds, sf::Color::White);
+        }
+        enemies.reserve(level.enemies.size());
+        for (const LevelData::EnemySpawn& spawn : level.enemies) {
+            enemies.spawn(level.enemyTypes[spawn.type], spawn.type, spawn.position, spawn.patrolWidth);
+        }
+        for (const LevelData::NpcSpawn& npc : level.npcs) {
+            npcManager.addNPC(npc.id, npc.position.x, npc.position.y);
+        }
+    }
+
+    PhysicsSystem physics;
+    JobSystem jobs;
+    AssetManager assets;
+    RenderingSystem rendering;
+    NPC npcManager;
+    PlayerInput input;
+    Player player;
+    LevelGeometry platforms;
+    LevelGeometry ladders;
+    EnemyStore enemies;
+    RenderQueue queue;
+    RenderSnapshot snapshot;
+    float levelWidth = 0.f;
+    // With --projectiles
+    SweepAndPrune entities;
+    ProjectileSystem projectiles;
+    size_t projectileCount = 0;
+    uint64_t shotSeed = 0;
+    uint64_t shotsFired = 0;
+    double projectileNs = 0.0;
+};
+
+double percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+BenchResult runBench(const BenchConfig& config, const std::vector<ScriptStep>& script) {
+    BenchWorld world(config);
+
+    // Expand the looping script once so the timed loop only indexes
+    std::vector<PlayerInput> inputs;
+    inputs.reserve(config.warmup + config.ticks);
+    for (size_t step = 0; inputs.size() < config.warmup + config.ticks; step = (step + 1) % script.size()) {
+        for (size_t t = 0; t < script[step].ticks && inputs.size() < config.warmup + config.ticks; ++t) {
+            inputs.push_back(InputSystem::toPlayerInput(script[step].buttons));
+        }
+    }
+
+    // With --rollback, snapshots[t % size] holds the state before tick t
+    std::vector<SimSnapshot> snapshots(config.rollback > 0 ? config.rollback + 1 : 0);
+    bool restored = true;
+    auto frame = [&](size_t t) {
+        if (config.rollback == 0) {
+            world.tick(inputs[t]);
+            return;
+        }
+        world.saveState(snapshots[t % snapshots.size()]);
+        world.tick(inputs[t]);
+        if (t + 1 < config.rollback) return;
+        const size_t from = t + 1 - config.rollback;
+        restored = world.loadState(snapshots[from % snapshots.size()]) && restored;
+        for (size_t again = from; again <= t; ++again) {
+            if (again > from) {
+                world.saveState(snapshots[again % snapshots.size()]);
+            }
+            world.tick(inputs[again]);
+        }
+    };
+
+    for (size_t t = 0; t < config.warmup; ++t) {
+        frame(t);
+    }
+    world.takeProjectileNs();
+
+    std::vector<double> tickNs(config.ticks);
+    std::vector<double> projectileNs(config.projectiles > 0 ? config.ticks : 0);
+    // Every allocation in the process, from any thread, but the draw counting's
+    uint64_t drawCalls = 0;
+    uint64_t countingAllocations = 0;
+    const uint64_t allocationsBefore = AllocationTracker::getTotals().allocations;
+    for (size_t t = 0; t < config.ticks; ++t) {
+        const auto start = Clock::now();
+        frame(config.warmup + t);
+        tickNs[t] = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        if (!projectileNs.empty()) {
+            projectileNs[t] = world.takeProjectileNs();
+        }
+        const uint64_t countingBefore = AllocationTracker::getTotals().allocations;
+        drawCalls += world.countDraws();
+        countingAllocations += AllocationTracker::getTotals().allocations - countingBefore;
+    }
+    const uint64_t allocations = AllocationTracker::getTotals().allocations - allocationsBefore - countingAllocations;
+
+    BenchResult result;
+    for (double ns : tickNs) {
+        result.meanNs += ns;
+    }
+    result.meanNs /= std::max<size_t>(config.ticks, 1);
+    std::sort(tickNs.begin(), tickNs.end());
+    result.p50Ns = percentile(tickNs, 0.50);
+    result.p99Ns = percentile(tickNs, 0.99);
+    result.maxNs = tickNs.empty() ? 0.0 : tickNs.back();
+    result.allocsPerTick = static_cast<double>(allocations) / std::max<size_t>(config.ticks, 1);
+    result.drawCalls = static_cast<double>(drawCalls) / std::max<size_t>(config.ticks, 1);
+    result.stateHash = restored ? world.hashState() : 0;
+    result.snapshotBytes = snapshots.empty() ? 0 : snapshots[0].size();
+    std::sort(projectileNs.begin(), projectileNs.end());
+    result.projectileP99Ns = percentile(projectileNs, 0.99);
+    return result;
+}
+
+bool parseArgs(int argc, char** argv, BenchConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        auto number = [&](auto& out) {
+            if (!value) {
+                return false;
+            }
+            out = static_cast<std::remove_reference_t<decltype(out)>>(std::strtod(value, nullptr));
+            ++i;
+            return true;
+        };
+        bool ok = true;
+        if (arg == "--ticks") ok = number(config.ticks);
+        else if (arg == "--warmup") ok = number(config.warmup);
+        else if (arg == "--platforms") ok = number(config.platforms);
+        else if (arg == "--enemies") ok = number(config.enemies);
+        else if (arg == "--npcs") ok = number(config.npcs);
+        else if (arg == "--threads") ok = number(config.threads);
+        else if (arg == "--seed") ok = number(config.seed);
+        else if (arg == "--max-p99-ns") ok = number(config.maxP99Ns);
+        else if (arg == "--max-allocs-per-tick") ok = number(config.maxAllocsPerTick);
+        else if (arg == "--no-determinism-check") config.checkDeterminism = false;
+        else if (arg == "--no-sleep") config.sleeping = false;
+        else if (arg == "--rollback") ok = number(config.rollback);
+        else if (arg == "--tile-size") ok = number(config.tileSize);
+        else if (arg == "--region") ok = number(config.region);
+        else if (arg == "--scene") config.scene = true;
+        else if (arg == "--ladders") ok = number(config.ladders);
+        else if (arg == "--density") ok = number(config.density);
+        else if (arg == "--width") ok = number(config.width);
+        else if (arg == "--repeat") ok = number(config.repeat);
+        else if (arg == "--projectiles") ok = number(config.projectiles);
+        else if (arg == "--json" && value) { config.json = value; ++i; }
+        else if (arg == "--name" && value) { config.name = value; ++i; }
+        else if (arg == "--preset" && value) {
+            SceneGenerator::Config preset;
+            if (!SceneGenerator::findPreset(value, preset)) {
+                std::fprintf(stderr, "Unknown preset: %s\n", value);
+                return false;
+            }
+            config.scene = true;
+            config.preset = value;
+            config.platforms = preset.platforms;
+            config.ladders = preset.ladders;
+            config.enemies = preset.enemies;
+            config.npcs = preset.npcs;
+            config.density = preset.density;
+            config.width = preset.width;
+            ++i;
+        }
+        else if (arg == "--script" && value) { config.script = value; ++i; }
+        else if (arg == "--replay" && value) { config.replay = value; ++i; }
+        else ok = false;
+        if (!ok) {
+            std::fprintf(stderr, "Bad argument: %s\n", arg.c_str());
+            return false;
+        }
+    }
+    config.platforms = std::max<size_t>(config.platforms, 1); // The ground
+    config.repeat = std::max<size_t>(config.repeat, 1);
+    config.projectiles = std::min(config.projectiles, ProjectileSystem::MAX_PROJECTILES);
+    return true;
+}
+
+// Results files: {"version": 1, "scenarios": [{"name", "ticks", "metrics":
+// {<metric>: {"median", "samples": [one per run]}}}]}
+constexpr int RESULTS_VERSION = 1;
+
+struct MetricInfo {
+    const char* key;
+    bool timing; // Noisy: compared against the runs' spread
+    bool gated;  // Can fail a comparison
+};
+
+constexpr MetricInfo METRICS[] = {
+    {"mean_ns", true, true},
+    {"p50_ns", true, true},
+    {"p99_ns", true, true},
+    {"max_ns", true, false}, // One tick's outlier; shown, never fails
+    {"allocs_per_tick", false, true},
+    {"draw_calls", false, true},
+};
+constexpr size_t METRIC_COUNT = std::size(METRICS);
+
+struct Scenario {
+    std::string name;
+    size_t ticks = 0;
+    std::array<std::vector<double>, METRIC_COUNT> samples;
+};
+
+double metricOf(const BenchResult& result, size_t metric) {
+    switch (metric) {
+        case 0: return result.meanNs;
+        case 1: return result.p50Ns;
+        case 2: return result.p99Ns;
+        case 3: return result.maxNs;
+        case 4: return result.allocsPerTick;
+        default: return result.drawCalls;
+    }
+}
+
+double median(std::vector<double> values) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    const size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2.0;
+}
+
+// Median absolute deviation scaled to a standard deviation, relative to the median
+double relativeNoise(const std::vector<double>& values) {
+    const double centre = median(values);
+    if (values.size() < 2 || centre <= 0.0) {
+        return 0.0;
+    }
+    std::vector<double> deviations;
+    for (double value : values) {
+        deviations.push_back(std::abs(value - centre));
+    }
+    return 1.4826 * median(deviations) / centre;
+}
+
+std::string defaultScenarioName(const BenchConfig& config) {
+    std::string name = config.preset.empty() ? (config.scene ? "scene" : "scatter") : "preset-" + config.preset;
+    name += "-" + std::to_string(config.platforms) + "p-" + std::to_string(config.enemies) + "e-" +
+            std::to_string(config.npcs) + "n";
+    if (config.rollback > 0) {
+        name += "-rollback" + std::to_string(config.rollback);
+    }
+    if (config.tileSize > 0.f) {
+        name += "-tiles";
+    }
+    if (config.projectiles > 0) {
+        name += "-" + std::to_string(config.projectiles) + "shots";
+    }
+    return name;
+}
+
+bool readResults(const std::string& path, std::vector<Scenario>& out, std::string& error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    JsonValue root;
+    if (!JsonValue::parse(text, root, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    if (root["version"].asNumber() != RESULTS_VERSION) {
+        error = path + ": not a results file of version " + std::to_string(RESULTS_VERSION);
+        return false;
+    }
+    for (const JsonValue& entry : root["scenarios"].getElements()) {
+        Scenario scenario;
+        scenario.name = entry["name"].asString();
+        scenario.ticks = static_cast<size_t>(entry["ticks"].asNumber());
+        for (size_t m = 0; m < METRIC_COUNT; ++m) {
+            for (const JsonValue& sample : entry["metrics"][METRICS[m].key]["samples"].getElements()) {
+                scenario.samples[m].push_back(sample.asNumber());
+            }
+        }
+        out.push_back(std::move(scenario));
+    }
+    return true;
+}
+
+std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+// Replaces the scenario of the same name, or adds it; the file is rewritten whole
+bool writeResults(const std::string& path, const Scenario& scenario, std::string& error) {
+    std::vector<Scenario> scenarios;
+    std::string readError;
+    if (!readResults(path, scenarios, readError)) {
+        scenarios.clear(); // Missing or unreadable: start a new file
+    }
+    auto existing = std::find_if(scenarios.begin(), scenarios.end(),
+                                 [&](const Scenario& other) { return other.name == scenario.name; });
+    if (existing != scenarios.end()) {
+        *existing = scenario;
+    } else {
+        scenarios.push_back(scenario);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        error = "cannot write " + path;
+        return false;
+    }
+    char number[32];
+    auto format = [&number](double value) {
+        std::snprintf(number, sizeof(number), "%.6g", value);
+        return std::string(number);
+    };
+    out << "{\n  \"version\": " << RESULTS_VERSION << ",\n  \"scenarios\": [";
+    for (size_t s = 0; s < scenarios.size(); ++s) {
+        const Scenario& entry = scenarios[s];
+        out << (s == 0 ? "\n" : ",\n") << "    {\n      \"name\": " << jsonString(entry.name)
+            << ",\n      \"ticks\": " << entry.ticks << ",\n      \"metrics\": {";
+        for (size_t m = 0; m < METRIC_COUNT; ++m) {
+            out << (m == 0 ? "\n" : ",\n") << "        \"" << METRICS[m].key << "\": { \"median\": "
+                << format(median(entry.samples[m])) << ", \"samples\": [";
+            for (size_t i = 0; i < entry.samples[m].size(); ++i) {
+                out << (i == 0 ? "" : ", ") << format(entry.samples[m][i]);
+            }
+            out << "] }";
+        }
+        out << "\n      }\n    }";
+    }
+    out << "\n  ]\n}\n";
+    if (!out.good()) {
+        error = "failed writing " + path;
+        return false;
+    }
+    return true;
+}
+
+int compareResults(int argc, char** argv) {
+    if (argc < 4) {
+        std::fprintf(stderr, "Usage: %s --compare <baseline.json> <candidate.json> [--threshold percent]\n", argv[0]);
+        return 2;
+    }
+    double threshold = 5.0;
+    for (int i = 4; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = std::strtod(argv[++i], nullptr);
+        } else {
+            std::fprintf(stderr, "Bad argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    std::vector<Scenario> baseline;
+    std::vector<Scenario> candidate;
+    std::string error;
+    if (!readResults(argv[2], baseline, error) || !readResults(argv[3], candidate, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 2;
+    }
+
+    int regressions = 0;
+    size_t compared = 0;
+    for (const Scenario& after : candidate) {
+        auto before = std::find_if(baseline.begin(), baseline.end(),
+                                   [&](const Scenario& other) { return other.name == after.name; });
+        if (before == baseline.end()) {
+            std::printf("%s: not in the baseline\n", after.name.c_str());
+            continue;
+        }
+        compared++;
+        std::printf("%s (%zu vs %zu runs%s)\n", after.name.c_str(), before->samples[0].size(), after.samples[0].size(),
+                    before->ticks != after.ticks ? ", different tick counts" : "");
+        std::printf("  %-16s %14s %14s %9s %8s\n", "metric", "baseline", "candidate", "delta", "limit");
+        for (size_t m = 0; m < METRIC_COUNT; ++m) {
+            const MetricInfo& metric = METRICS[m];
+            const double base = median(before->samples[m]);
+            const double value = median(after.samples[m]);
+            const double delta = base > 0.0 ? (value - base) / base * 100.0 : (value > 0.0 ? 100.0 : 0.0);
+            double limit = 1.0;
+            bool regressed = false;
+            if (metric.timing) {
+                const double noise = std::max(relativeNoise(before->samples[m]), relativeNoise(after.samples[m]));
+                limit = std::max(threshold, 3.0 * noise * 100.0);
+                regressed = delta > limit;
+            } else {
+                regressed = value > base * 1.01 + 0.01; // Counters barely vary; allow rounding
+            }
+            const char* verdict = !regressed ? (delta < -limit ? "better" : "ok")
+                                             : (metric.gated ? "REGRESSION" : "worse");
+            std::printf("  %-16s %14.2f %14.2f %+8.1f%% %7.1f%% %s\n", metric.key, base, value, delta, limit, verdict);
+            if (regressed && metric.gated) {
+                regressions++;
+            }
+        }
+    }
+    if (compared == 0) {
+        std::printf("No scenario is in both files\n");
+        return 2;
+    }
+    std::printf("%d regression%s\n", regressions, regressions == 1 ? "" : "s");
+    return regressions == 0 ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "--compare") == 0) {
+        return compareResults(argc, argv);
+    }
+    BenchConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        return 2;
+    }
+    std::vector<ScriptStep> script;
+    if (!config.replay.empty()) {
+        InputReplay replay;
+        std::string error;
+        if (!replay.load(config.replay, error) || replay.getTickCount() == 0) {
+            std::fprintf(stderr, "Bad replay: %s\n", error.empty() ? "no steps" : error.c_str());
+            return 2;
+        }
+        replay.toScript(script);
+    } else if (config.script.empty()) {
+        script = defaultScript();
+    } else {
+        std::string error;
+        if (!InputSystem::loadScript(config.script, script, error)) {
+            std::fprintf(stderr, "Bad script: %s\n", error.c_str());
+            return 2;
+        }
+    }
+
+    std::printf("Headless sim: %zu ticks (+%zu warmup), %zu platforms, %zu enemies, %zu NPCs, seed %u%s%s\n",
+                config.ticks, config.warmup, config.platforms, config.enemies, config.npcs, config.seed,
+                FixedPoint::ENABLED ? ", fixed-point grid" : "", config.tileSize > 0.f ? ", tile layer" : "");
+    if (config.scene) {
+        SceneGenerator::Config scene;
+        scene.platforms = config.platforms;
+        scene.density = config.density;
+        scene.width = config.width;
+        std::printf("Generated scene%s%s: %zu ladders, %.0f px wide\n", config.preset.empty() ? "" : " ",
+                    config.preset.c_str(), config.ladders, SceneGenerator::getLevelWidth(scene));
+    }
+    std::vector<BenchResult> runs;
+    for (size_t run = 0; run < config.repeat; ++run) {
+        runs.push_back(runBench(config, script));
+    }
+    // Each metric's median across the runs; the state is the first run's
+    BenchResult result = runs.front();
+    Scenario scenario;
+    scenario.name = config.name.empty() ? defaultScenarioName(config) : config.name;
+    scenario.ticks = config.ticks;
+    for (size_t m = 0; m < METRIC_COUNT; ++m) {
+        for (const BenchResult& run : runs) {
+            scenario.samples[m].push_back(metricOf(run, m));
+        }
+    }
+    result.meanNs = median(scenario.samples[0]);
+    result.p50Ns = median(scenario.samples[1]);
+    result.p99Ns = median(scenario.samples[2]);
+    result.maxNs = median(scenario.samples[3]);
+    result.allocsPerTick = median(scenario.samples[4]);
+    result.drawCalls = median(scenario.samples[5]);
+
+    if (config.repeat > 1) {
+        std::printf("Median of %zu runs\n", config.repeat);
+    }
+    if (config.rollback > 0) {
+        std::printf("Rollback: every tick re-runs the last %zu; times are per frame of %zu steps\n", config.rollback,
+                    config.rollback + 1);
+    }
+    std::printf("%12s %12s %12s %12s %14s %12s %18s\n", "mean ns", "p50 ns", "p99 ns", "max ns", "allocs/tick",
+                "draws/frame", "state hash");
+    std::printf("%12.0f %12.0f %12.0f %12.0f %14.2f %12.1f %18llx\n", result.meanNs, result.p50Ns, result.p99Ns,
+                result.maxNs, result.allocsPerTick, result.drawCalls, static_cast<unsigned long long>(result.stateHash));
+
+    if (result.snapshotBytes > 0) {
+        std::printf("Snapshot: %zu bytes per tick\n", result.snapshotBytes);
+    }
+    if (config.projectiles > 0) {
+        std::vector<double> projectileP99s;
+        for (const BenchResult& run : runs) {
+            projectileP99s.push_back(run.projectileP99Ns);
+        }
+        result.projectileP99Ns = median(projectileP99s);
+        std::printf("Projectiles: %zu live, p99 step %.0f ns\n", config.projectiles, result.projectileP99Ns);
+    }
+
+    int failures = 0;
+    if (config.checkDeterminism) {
+        // Repeated runs already are second runs
+        if (runs.size() == 1) {
+            runs.push_back(runBench(config, script));
+        }
+        auto diverged = std::find_if(runs.begin(), runs.end(),
+                                     [&](const BenchResult& run) { return run.stateHash != result.stateHash; });
+        if (diverged != runs.end()) {
+            std::printf("FAIL: a second run ended in a different state (%llx)\n",
+                        static_cast<unsigned long long>(diverged->stateHash));
+            failures++;
+        }
+    }
+    if (config.rollback > 0) {
+        BenchConfig plain = config;
+        plain.rollback = 0;
+        const BenchResult reference = runBench(plain, script);
+        if (result.stateHash != reference.stateHash) {
+            std::printf("FAIL: re-simulating changed the outcome (%llx without rollback)\n",
+                        static_cast<unsigned long long>(reference.stateHash));
+            failures++;
+        }
+        if (result.p99Ns > RollbackSession::BUDGET_MS * 1e6) {
+            std::printf("FAIL: p99 frame %.2f ms exceeds the %.0f ms rollback budget\n", result.p99Ns / 1e6,
+                        RollbackSession::BUDGET_MS);
+            failures++;
+        }
+    }
+    if (config.projectiles > 0 && result.projectileP99Ns > ProjectileSystem::BUDGET_MS * 1e6) {
+        std::printf("FAIL: p99 projectile step %.2f ms exceeds the %.1f ms budget\n", result.projectileP99Ns / 1e6,
+                    ProjectileSystem::BUDGET_MS);
+        failures++;
+    }
+    if (config.maxP99Ns > 0.0 && result.p99Ns > config.maxP99Ns) {
+        std::printf("FAIL: p99 %.0f ns exceeds %.0f ns\n", result.p99Ns, config.maxP99Ns);
+        failures++;
+    }
+    if (config.maxAllocsPerTick >= 0.0 && result.allocsPerTick > config.maxAllocsPerTick) {
+        std::printf("FAIL: %.2f allocations per tick exceeds %.2f\n", result.allocsPerTick, config.maxAllocsPerTick);
+        failures++;
+    }
+    if (!config.json.empty()) {
+        std::string error;
+        if (!writeResults(config.json, scenario, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 2;
+        }
+        std::printf("Wrote \"%s\" to %s\n", scenario.name.c_str(), config.json.c_str());
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,245 @@
+// Cooks a JSON level into the binary format read by LevelLoader (see CookedLevel.hpp).
+// Usage: level_cooker <level.json> <level.lvl>
+#include "CookedLevel.hpp"
+#include "LevelLoader.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace CookedLevel;
+
+class CookedWriter {
+public:
+    CookedWriter() : bytes(sizeof(Header), '\0') {}
+
+    StringRef addString(const std::string& text) {
+        StringRef ref;
+        ref.offset = static_cast<uint32_t>(strings.size());
+        ref.length = static_cast<uint32_t>(text.size());
+        strings += text;
+        return ref;
+    }
+
+    template <typename Record>
+    ArrayRef addArray(const std::vector<Record>& records) {
+        ArrayRef ref;
+        ref.count = static_cast<uint32_t>(records.size());
+        if (records.empty()) {
+            return ref;
+        }
+        bytes.resize((bytes.size() + ALIGNMENT - 1) & ~static_cast<size_t>(ALIGNMENT - 1), '\0');
+        ref.offset = static_cast<uint32_t>(bytes.size());
+        const char* data = reinterpret_cast<const char*>(records.data());
+        bytes.insert(bytes.end(), data, data + records.size() * sizeof(Record));
+        return ref;
+    }
+
+    // The string table goes last; header offsets are patched in at the end
+    const std::vector<char>& finish(Header& header) {
+        header.stringTableOffset = static_cast<uint32_t>(bytes.size());
+        header.stringTableSize = static_cast<uint32_t>(strings.size());
+        bytes.insert(bytes.end(), strings.begin(), strings.end());
+        std::memcpy(bytes.data(), &header, sizeof(Header));
+        return bytes;
+    }
+
+private:
+    std::vector<char> bytes;
+    std::string strings;
+};
+
+std::vector<char> cook(const LevelData& level) {
+    CookedWriter writer;
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.width = level.size.x;
+    header.height = level.size.y;
+    header.tileSize = level.tileSize;
+    header.spawn[0] = level.spawn.x;
+    header.spawn[1] = level.spawn.y;
+    header.entryLeft[0] = level.entryLeft.x;
+    header.entryLeft[1] = level.entryLeft.y;
+    header.entryRight[0] = level.entryRight.x;
+    header.entryRight[1] = level.entryRight.y;
+    header.platformColor[0] = level.platformColor.r;
+    header.platformColor[1] = level.platformColor.g;
+    header.platformColor[2] = level.platformColor.b;
+    header.platformColor[3] = level.platformColor.a;
+    header.gravity = level.gravity;
+    header.jumpForce = level.jumpForce;
+    header.enemySpeed = level.enemySpeed;
+    header.name = writer.addString(level.name);
+    header.background = writer.addString(level.background);
+
+    std::vector<StringRef> fallbacks;
+    for (const auto& path : level.backgroundFallbacks) {
+        fallbacks.push_back(writer.addString(path));
+    }
+    header.backgroundFallbacks = writer.addArray(fallbacks);
+    header.music = writer.addString(level.music);
+    header.colorGrade = writer.addString(level.colorGrade);
+    header.gradeTint[0] = level.gradeTint.r;
+    header.gradeTint[1] = level.gradeTint.g;
+    header.gradeTint[2] = level.gradeTint.b;
+    header.gradeTint[3] = level.gradeTint.a;
+    header.dayLength = level.dayLength;
+    header.ambientLight[0] = level.ambientLight.r;
+    header.ambientLight[1] = level.ambientLight.g;
+    header.ambientLight[2] = level.ambientLight.b;
+    header.ambientLight[3] = level.ambientLight.a;
+
+    std::vector<PlatformRecord> platforms;
+    for (const auto& platform : level.platforms) {
+        PlatformRecord record{};
+        record.x = platform.bounds.position.x;
+        record.y = platform.bounds.position.y;
+        record.width = platform.bounds.size.x;
+        record.height = platform.bounds.size.y;
+        record.slope = static_cast<uint8_t>(platform.slope);
+        platforms.push_back(record);
+    }
+    header.platforms = writer.addArray(platforms);
+
+    std::vector<LadderRecord> ladders;
+    for (const auto& ladder : level.ladders) {
+        ladders.push_back(LadderRecord{ladder.bounds.position.x, ladder.bounds.position.y,
+                                       ladder.bounds.size.x, ladder.bounds.size.y});
+    }
+    header.ladders = writer.addArray(ladders);
+
+    std::vector<DecorationRecord> decorations;
+    for (const auto& decoration : level.decorations) {
+        DecorationRecord record{};
+        record.x = decoration.position.x;
+        record.y = decoration.position.y;
+        record.height = decoration.height;
+        record.kind = static_cast<uint8_t>(decoration.kind);
+        decorations.push_back(record);
+    }
+    header.decorations = writer.addArray(decorations);
+
+    std::vector<DecorationQuadRecord> decorationQuads;
+    for (const auto& quad : level.decorationQuads) {
+        DecorationQuadRecord record{};
+        record.x = quad.bounds.position.x;
+        record.y = quad.bounds.position.y;
+        record.width = quad.bounds.size.x;
+        record.height = quad.bounds.size.y;
+        record.kind = static_cast<uint8_t>(quad.kind);
+        record.part = static_cast<uint8_t>(quad.part);
+        record.depth = quad.depth;
+        decorationQuads.push_back(record);
+    }
+    header.decorationQuads = writer.addArray(decorationQuads);
+
+    std::vector<EnemyTypeRecord> enemyTypes;
+    for (const auto& type : level.enemyTypes) {
+        EnemyTypeRecord record{};
+        record.name = writer.addString(type.name);
+        record.width = type.size.x;
+        record.height = type.size.y;
+        record.speed = type.speed;
+        record.gravity = type.gravity;
+        record.patrolWidth = type.patrolWidth;
+        record.color[0] = type.color.r;
+        record.color[1] = type.color.g;
+        record.color[2] = type.color.b;
+        record.color[3] = type.color.a;
+        enemyTypes.push_back(record);
+    }
+    header.enemyTypes = writer.addArray(enemyTypes);
+
+    std::vector<EnemyRecord> enemies;
+    for (const auto& enemy : level.enemies) {
+        EnemyRecord record{};
+        record.x = enemy.position.x;
+        record.y = enemy.position.y;
+        record.patrolWidth = enemy.patrolWidth;
+        record.type = enemy.type;
+        enemies.push_back(record);
+    }
+    header.enemies = writer.addArray(enemies);
+
+    std::vector<NpcRecord> npcs;
+    for (const auto& npc : level.npcs) {
+        NpcRecord record{};
+        record.id = writer.addString(npc.id);
+        record.texture = writer.addString(npc.texture);
+        record.x = npc.position.x;
+        record.y = npc.position.y;
+        npcs.push_back(record);
+    }
+    header.npcs = writer.addArray(npcs);
+
+    std::vector<TriggerRecord> triggers;
+    for (const auto& trigger : level.triggers) {
+        TriggerRecord record{};
+        record.id = writer.addString(trigger.id);
+        record.x = trigger.bounds.position.x;
+        record.y = trigger.bounds.position.y;
+        record.width = trigger.bounds.size.x;
+        record.height = trigger.bounds.size.y;
+        record.action = static_cast<uint8_t>(trigger.action);
+        record.grounded = trigger.grounded ? 1 : 0;
+        triggers.push_back(record);
+    }
+    header.triggers = writer.addArray(triggers);
+
+    std::vector<LightRecord> lights;
+    for (const auto& light : level.lights) {
+        LightRecord record{};
+        record.x = light.position.x;
+        record.y = light.position.y;
+        record.radius = light.radius;
+        record.color[0] = light.color.r;
+        record.color[1] = light.color.g;
+        record.color[2] = light.color.b;
+        record.color[3] = light.color.a;
+        lights.push_back(record);
+    }
+    header.lights = writer.addArray(lights);
+
+    return writer.finish(header);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "Usage: %s <level.json> <level.lvl>\n", argv[0]);
+        return 1;
+    }
+
+    LevelData level;
+    std::string error;
+    if (!LevelLoader::loadFromFile(argv[1], level, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    const std::vector<char> bytes = cook(level);
+
+    // Read it back so a writer/reader mismatch fails the build, not the game
+    LevelData check;
+    if (!LevelLoader::loadCookedFromMemory(bytes.data(), bytes.size(), check, error) ||
+        check.platforms.size() != level.platforms.size() || check.npcs.size() != level.npcs.size() ||
+        check.decorationQuads.size() != level.decorationQuads.size() || check.triggers.size() != level.triggers.size()) {
+        std::fprintf(stderr, "Cooked level failed verification: %s\n", error.c_str());
+        return 1;
+    }
+
+    std::ofstream out(argv[2], std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    if (!out) {
+        std::fprintf(stderr, "Failed to write %s\n", argv[2]);
+        return 1;
+    }
+    std::printf("Cooked %s: %zu platforms, %zu enemies, %zu NPCs, %zu bytes\n", argv[1],
+                level.platforms.size(), level.enemies.size(), level.npcs.size(), bytes.size());
+    return 0;
+}
@@ -0,0 +1,161 @@
+// Turns a binary log (AsyncLogger::SinkFormat::Binary, see LogFormat.hpp) into
+// the same lines the text log would have held.
+// Usage: logdecode <log.blog> [min level: debug|info|warning|error]
+#include "LogFormat.hpp"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+const char* const LEVEL_NAMES[] = {"DEBUG", "INFO", "WARNING", "ERROR"};
+
+class Reader {
+public:
+    explicit Reader(const std::vector<char>& bytes) : bytes(bytes) {}
+
+    template <typename T>
+    bool read(T& value) {
+        if (offset + sizeof(T) > bytes.size()) {
+            return false;
+        }
+        std::memcpy(&value, bytes.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+    // Points into the file; 'length' bytes
+    const char* take(size_t length) {
+        if (offset + length > bytes.size()) {
+            return nullptr;
+        }
+        const char* data = bytes.data() + offset;
+        offset += length;
+        return data;
+    }
+    bool atEnd() const { return offset >= bytes.size(); }
+    size_t getOffset() const { return offset; }
+
+private:
+    const std::vector<char>& bytes;
+    size_t offset = 0;
+};
+
+void appendTimestamp(int64_t wallNs, std::string& out) {
+    const std::time_t seconds = static_cast<std::time_t>(wallNs / 1000000000);
+    const int ms = static_cast<int>((wallNs / 1000000) % 1000);
+    char text[48];
+    const size_t length = std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", std::localtime(&seconds));
+    std::snprintf(text + length, sizeof(text) - length, ".%03d", ms < 0 ? ms + 1000 : ms);
+    out += text;
+}
+
+int parseLevel(const char* name) {
+    for (int i = 0; i < static_cast<int>(std::size(LEVEL_NAMES)); ++i) {
+        std::string upper;
+        for (const char* c = name; *c; ++c) {
+            upper += static_cast<char>(*c >= 'a' && *c <= 'z' ? *c - 'a' + 'A' : *c);
+        }
+        if (upper == LEVEL_NAMES[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <log.blog> [debug|info|warning|error]\n", argv[0]);
+        return 1;
+    }
+    const int minLevel = argc > 2 ? parseLevel(argv[2]) : 0;
+    if (minLevel < 0) {
+        std::fprintf(stderr, "Unknown level: %s\n", argv[2]);
+        return 1;
+    }
+
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file) {
+        std::fprintf(stderr, "Failed to open %s\n", argv[1]);
+        return 1;
+    }
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    Reader reader(bytes);
+    std::unordered_map<uint32_t, std::string> formats; // Of the current session
+    std::string line;
+    size_t records = 0;
+    bool inSession = false;
+    while (!reader.atEnd()) {
+        const size_t recordStart = reader.getOffset();
+        uint8_t kind = 0;
+        reader.read(kind);
+        bool ok = false;
+        switch (static_cast<LogFormat::RecordKind>(kind)) {
+            case LogFormat::RecordKind::Session: {
+                const char* magic = reader.take(sizeof(LogFormat::MAGIC));
+                uint32_t version = 0;
+                ok = magic && std::memcmp(magic, LogFormat::MAGIC, sizeof(LogFormat::MAGIC)) == 0 &&
+                     reader.read(version) && version == LogFormat::VERSION;
+                formats.clear();
+                inSession = ok;
+                break;
+            }
+            case LogFormat::RecordKind::Format: {
+                uint32_t id = 0;
+                uint16_t length = 0;
+                const char* text = nullptr;
+                ok = inSession && reader.read(id) && reader.read(length) && (text = reader.take(length));
+                if (ok) {
+                    formats[id].assign(text, length);
+                }
+                break;
+            }
+            case LogFormat::RecordKind::Text:
+            case LogFormat::RecordKind::Structured: {
+                const bool structured = static_cast<LogFormat::RecordKind>(kind) == LogFormat::RecordKind::Structured;
+                int64_t wallNs = 0;
+                uint8_t level = 0;
+                uint8_t truncated = 0;
+                uint32_t id = 0;
+                uint16_t length = 0;
+                const char* data = nullptr;
+                ok = inSession && reader.read(wallNs) && reader.read(level) && level < std::size(LEVEL_NAMES) &&
+                     (!structured || (reader.read(truncated) && reader.read(id))) &&
+                     reader.read(length) && (data = reader.take(length));
+                if (!ok || level < minLevel) {
+                    break;
+                }
+                line.clear();
+                line += '[';
+                appendTimestamp(wallNs, line);
+                line += "] [";
+                line += LEVEL_NAMES[level];
+                line += "] ";
+                if (!structured) {
+                    line.append(data, length);
+                } else {
+                    const auto format = formats.find(id);
+                    LogFormat::appendFormatted(format != formats.end() ? format->second.c_str() : "{unknown format}",
+                                               data, length, truncated != 0, line);
+                }
+                line += '\n';
+                std::fwrite(line.data(), 1, line.size(), stdout);
+                records++;
+                break;
+            }
+        }
+        if (!ok) {
+            std::fprintf(stderr, "%s: bad record at byte %zu; stopping after %zu records\n", argv[1], recordStart,
+                         records);
+            return 1;
+        }
+    }
+    return 0;
+}